@@ -11,8 +11,18 @@
 #ifdef ENABLE_UNITTEST
 #include <gtest.h>
 #endif
+#include <mcld/ADT/SizeTraits.h>
+#include <mcld/Support/LinkStats.h>
+
 #include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MathExtras.h>
+
+#include <cassert>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
 
 namespace mcld {
 
@@ -33,7 +43,9 @@ public:
   typedef HashEntryTy entry_type;
 
 public:
-  unsigned int FullHashValue;
+  /// FullHashValue - the hash value of the entry. It is as wide as a pointer,
+  /// so the word-wide hash values are kept without enlarging the bucket.
+  size_t FullHashValue;
   entry_type *Entry;
 
 public:
@@ -62,6 +74,15 @@ public:
  *  example, on-device linkers needs a more light-weight hash function
  *  than static linkers. HashTableImpl also provides a template argument to
  *  change the hash functions.
+ *
+ *  The number of buckets is a power of two, and the home bucket of a hash
+ *  value is its low bits. Besides the buckets, a table keeps one control
+ *  byte per bucket: kEmpty, kDeleted, or seven high bits of the mixed hash
+ *  value of a filled bucket. A lookup reads the control
+ *  bytes of kGroupWidth buckets as one word, and only visits the buckets
+ *  whose control bytes match, so most mismatches never touch the buckets or
+ *  the entries. The first kGroupWidth control bytes are cloned after the
+ *  last one, so a group never wraps around.
  */
 template<typename HashEntryTy,
          typename HashFunctionTy>
@@ -70,6 +91,12 @@ class HashTableImpl
 private:
   static const unsigned int NumOfInitBuckets = 16;
 
+  /// the number of control bytes read at a time
+  static const unsigned int kGroupWidth = 8;
+
+  static const uint8_t kEmpty   = 0x80;
+  static const uint8_t kDeleted = 0xFE;
+
 public:
   typedef size_t size_type;
   typedef HashFunctionTy hasher;
@@ -99,6 +126,10 @@ public:
   const hasher& hash() const
   { return m_Hasher; }
 
+  /// prefetch - bring the control bytes and the home bucket of the hash
+  /// value pHash into the cache, for a lookup a little later
+  void prefetch(size_t pHash) const;
+
 protected:
   /// initialize the hash table.
   void init(unsigned int pInitSize);
@@ -109,16 +140,33 @@ protected:
   //  @return the index of the found bucket
   unsigned int lookUpBucketFor(const key_type& pKey);
 
+  /// lookUpBucketFor - the same, but pKey is hashed into pFullHash already
+  unsigned int lookUpBucketFor(const key_type& pKey, size_t pFullHash);
+
   /// findKey - finds an element with key pKey
   //  return the index of the element, or -1 when the element does not exist.
   int findKey(const key_type& pKey) const;
 
+  /// eraseBucket - make the bucket pIndex a tombstone
+  void eraseBucket(unsigned int pIndex);
+
   /// mayRehash - check the load_factor, compute the new size, and then doRehash
   void mayRehash();
 
   /// doRehash - re-new the hash table, and rehash all elements into the new buckets
   void doRehash(unsigned int pNewSize);
 
+  /// bucketOf - the home bucket of the hash value pHash
+  unsigned int bucketOf(size_t pHash) const;
+
+private:
+  /// setControl - set the control byte of the bucket pIndex
+  void setControl(unsigned int pIndex, uint8_t pControl);
+
+  /// loadGroup - the kGroupWidth control bytes from the bucket pIndex. The
+  /// first control byte is in the lowest bits.
+  uint64_t loadGroup(unsigned int pIndex) const;
+
 friend class ChainIteratorBase<Self>;
 friend class ChainIteratorBase<const Self>;
 friend class EntryIteratorBase<Self>;
@@ -131,6 +179,9 @@ protected:
   unsigned int m_NumOfTombstones;
   hasher m_Hasher;
 
+private:
+  // Array of control bytes, m_NumOfBuckets + kGroupWidth bytes
+  uint8_t* m_Controls;
 };
 
 #include "HashBase.tcc"
@@ -11,23 +11,61 @@
 // internal non-member functions
 inline static unsigned int compute_bucket_count(unsigned int pNumOfBuckets)
 {
-  static const unsigned int bucket_size[] =
-  {
-    1, 3, 17, 37, 67, 97, 197, 419, 977, 2593, 4099, 8209, 12289,
-    16411, 20483, 32771, 49157, 65537, 98317, 131101, 196613
-  };
-
-  const unsigned int buckets_count =
-      sizeof(bucket_size) / sizeof(bucket_size[0]);
-  unsigned int idx = 0;
-  do {
-    if (pNumOfBuckets < bucket_size[idx]) {
-      return bucket_size[idx];
-    }
-    ++idx;
-  } while(idx < buckets_count);
+  // the smallest power of two that is larger than pNumOfBuckets
+  unsigned int result = 1;
+  while (result <= pNumOfBuckets)
+    result <<= 1;
+  return result;
+}
+
+/// hash_match_byte - mark the bytes of pGroup that are equal to pByte. A
+//  byte right after a marked one may be marked falsely.
+inline static uint64_t hash_match_byte(uint64_t pGroup, uint8_t pByte)
+{
+  const uint64_t lsbs = 0x0101010101010101ULL;
+  uint64_t x = pGroup ^ (lsbs * pByte);
+  return (x - lsbs) & ~x & (lsbs << 7);
+}
+
+/// hash_match_empty - mark the kEmpty bytes of pGroup. kEmpty is the only
+//  control byte whose bit 7 is set and bit 1 is clear.
+inline static uint64_t hash_match_empty(uint64_t pGroup)
+{
+  return (pGroup & ~(pGroup << 6)) & 0x8080808080808080ULL;
+}
+
+/// hash_match_free - mark the kEmpty and kDeleted bytes of pGroup
+inline static uint64_t hash_match_free(uint64_t pGroup)
+{
+  return pGroup & 0x8080808080808080ULL;
+}
+
+/// hash_first_byte - the position of the first marked byte of pMask
+inline static unsigned int hash_first_byte(uint64_t pMask)
+{
+  return llvm::CountTrailingZeros_64(pMask) >> 3;
+}
+
+/// hash_fold - fold a hash value into 32 bits
+inline static uint32_t hash_fold(size_t pHash)
+{
+  uint64_t hash = pHash;
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+/// hash_control - the control byte of a filled bucket. The home bucket takes
+//  the low bits of a hash value, so the control byte takes the high bits of
+//  its Fibonacci product, which depend on all the bits.
+inline static uint8_t hash_control(size_t pHash)
+{
+  return static_cast<uint8_t>((hash_fold(pHash) * 0x9E3779B9U) >> 25);
+}
 
-  return (pNumOfBuckets+131101); // rare case. increase constantly
+/// hash_count_probes - count a lookup which probed pProbes groups in --stats
+inline static void hash_count_probes(unsigned int pProbes)
+{
+  if (mcld::LinkStats::isEnabled())
+    mcld::LinkStats::AddProbes(pProbes);
 }
 
 //===--------------------------------------------------------------------===//
@@ -57,7 +95,8 @@ HashTableImpl<HashEntryTy, HashFunctionTy>::HashTableImpl()
     m_NumOfBuckets(0),
     m_NumOfEntries(0),
     m_NumOfTombstones(0),
-    m_Hasher() {
+    m_Hasher(),
+    m_Controls(0) {
 }
 
 template<typename HashEntryTy,
@@ -74,6 +113,7 @@ HashTableImpl<HashEntryTy, HashFunctionTy>::HashTableImpl(
   m_NumOfBuckets = 0;
   m_NumOfEntries = 0;
   m_NumOfTombstones = 0;
+  m_Controls = 0;
 }
 
 template<typename HashEntryTy,
@@ -96,13 +136,16 @@ template<typename HashEntryTy,
          typename HashFunctionTy>
 void HashTableImpl<HashEntryTy, HashFunctionTy>::init(unsigned int pInitSize)
 {
-  m_NumOfBuckets = pInitSize? compute_bucket_count(pInitSize): NumOfInitBuckets;
-
+  m_NumOfBuckets = NumOfInitBuckets;
+  if (pInitSize >= NumOfInitBuckets)
+    m_NumOfBuckets = compute_bucket_count(pInitSize);
   m_NumOfEntries = 0;
   m_NumOfTombstones = 0;
 
   /** calloc also set bucket.Item = bucket_type::getEmptyStone() **/
   m_Buckets = (bucket_type*)calloc(m_NumOfBuckets, sizeof(bucket_type));
+  m_Controls = (uint8_t*)malloc(m_NumOfBuckets + kGroupWidth);
+  memset(m_Controls, kEmpty, m_NumOfBuckets + kGroupWidth);
 }
 
 /// clear - clear the hash table.
@@ -111,11 +154,61 @@ template<typename HashEntryTy,
 void HashTableImpl<HashEntryTy, HashFunctionTy>::clear()
 {
   free(m_Buckets);
+  free(m_Controls);
 
   m_Buckets = 0;
   m_NumOfBuckets = 0;
   m_NumOfEntries = 0;
   m_NumOfTombstones = 0;
+  m_Controls = 0;
+}
+
+/// bucketOf - the low bits of the folded hash value
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+inline unsigned int
+HashTableImpl<HashEntryTy, HashFunctionTy>::bucketOf(size_t pHash) const
+{
+  return hash_fold(pHash) & (m_NumOfBuckets - 1);
+}
+
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+inline void
+HashTableImpl<HashEntryTy, HashFunctionTy>::setControl(unsigned int pIndex,
+                                                       uint8_t pControl)
+{
+  m_Controls[pIndex] = pControl;
+  if (pIndex < kGroupWidth)
+    m_Controls[m_NumOfBuckets + pIndex] = pControl;
+}
+
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+inline uint64_t
+HashTableImpl<HashEntryTy, HashFunctionTy>::loadGroup(unsigned int pIndex) const
+{
+  uint64_t group;
+  memcpy(&group, m_Controls + pIndex, sizeof(group));
+  if (!llvm::sys::isLittleEndianHost())
+    group = bswap64(group);
+  return group;
+}
+
+/// prefetch - the control bytes of a group and its first bucket are read
+/// first by a lookup. A prefetch is only a hint, and never faults.
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+inline void
+HashTableImpl<HashEntryTy, HashFunctionTy>::prefetch(size_t pHash) const
+{
+  if (0 == m_NumOfBuckets)
+    return;
+#if defined(__GNUC__)
+  unsigned int index = bucketOf(pHash);
+  __builtin_prefetch(m_Controls + index);
+  __builtin_prefetch(m_Buckets + index);
+#endif
 }
 
 /// lookUpBucketFor - look up the bucket whose key is pKey
@@ -124,47 +217,66 @@ template<typename HashEntryTy,
 unsigned int
 HashTableImpl<HashEntryTy, HashFunctionTy>::lookUpBucketFor(
   const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey)
+{
+  return lookUpBucketFor(pKey, m_Hasher(pKey));
+}
+
+/// lookUpBucketFor - look up the bucket whose key is pKey of the hash value
+/// pFullHash
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+unsigned int
+HashTableImpl<HashEntryTy, HashFunctionTy>::lookUpBucketFor(
+  const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey,
+  size_t pFullHash)
 {
   if (0 == m_NumOfBuckets) {
     // NumOfBuckets is changed after init(pInitSize)
     init(NumOfInitBuckets);
   }
 
-  unsigned int full_hash = m_Hasher(pKey);
-  unsigned int index = full_hash % m_NumOfBuckets;
-
-  const unsigned int probe = 1;
-  int firstTombstone = -1;
-
-  // linear probing
-  while(true) {
-    bucket_type& bucket = m_Buckets[index];
-    // If we found an empty bucket, this key isn't in the table yet, return it.
-    if (bucket_type::getEmptyBucket() == bucket.Entry) {
-      if (-1 != firstTombstone) {
-        m_Buckets[firstTombstone].FullHashValue = full_hash;
-        return firstTombstone;
+  size_t full_hash = pFullHash;
+  uint8_t control = hash_control(full_hash);
+  unsigned int mask = m_NumOfBuckets - 1;
+  unsigned int index = bucketOf(full_hash);
+  int firstFree = -1;
+  unsigned int probes = 0;
+
+  // linear probing by groups
+  for (unsigned int probed = 0; probed < m_NumOfBuckets;
+       probed += kGroupWidth) {
+    uint64_t group = loadGroup(index);
+    ++probes;
+
+    uint64_t match = hash_match_byte(group, control);
+    for (; 0 != match; match &= match - 1) {
+      unsigned int pos = (index + hash_first_byte(match)) & mask;
+      bucket_type& bucket = m_Buckets[pos];
+      if (control == m_Controls[pos] &&
+          bucket.FullHashValue == full_hash &&
+          bucket.Entry->compare(pKey)) {
+        hash_count_probes(probes);
+        return pos;
       }
-
-      bucket.FullHashValue = full_hash;
-      return index;
     }
 
-    if (bucket_type::getTombstone() == bucket.Entry) {
-      if (-1 == firstTombstone) {
-        firstTombstone = index;
-      }
-    }
-    else if (bucket.FullHashValue == full_hash) {
-      if (bucket.Entry->compare(pKey)) {
-        return index;
-      }
-    }
+    // prefer the first tombstone on the way
+    uint64_t free_mask = hash_match_free(group);
+    if (-1 == firstFree && 0 != free_mask)
+      firstFree = (index + hash_first_byte(free_mask)) & mask;
+
+    // If we found an empty bucket, this key isn't in the table yet.
+    if (0 != hash_match_empty(group))
+      break;
 
-    index += probe;
-    if (index == m_NumOfBuckets)
-      index = 0;
+    index = (index + kGroupWidth) & mask;
   }
+
+  hash_count_probes(probes);
+  assert(-1 != firstFree && "HashTable is full");
+  m_Buckets[firstFree].FullHashValue = full_hash;
+  setControl(firstFree, control);
+  return firstFree;
 }
 
 template<typename HashEntryTy,
@@ -176,29 +288,45 @@ HashTableImpl<HashEntryTy, HashFunctionTy>::findKey(
   if (0 == m_NumOfBuckets)
     return -1;
 
-  unsigned int full_hash = m_Hasher(pKey);
-  unsigned int index = full_hash % m_NumOfBuckets;
-
-  const unsigned int probe = 1;
-  // linear probing
-  while (true) {
-    bucket_type &bucket = m_Buckets[index];
+  size_t full_hash = m_Hasher(pKey);
+  uint8_t control = hash_control(full_hash);
+  unsigned int mask = m_NumOfBuckets - 1;
+  unsigned int index = bucketOf(full_hash);
+  unsigned int probes = 0;
+
+  // linear probing by groups
+  for (unsigned int probed = 0; probed < m_NumOfBuckets;
+       probed += kGroupWidth) {
+    uint64_t group = loadGroup(index);
+    ++probes;
+
+    uint64_t match = hash_match_byte(group, control);
+    for (; 0 != match; match &= match - 1) {
+      unsigned int pos = (index + hash_first_byte(match)) & mask;
+      const bucket_type& bucket = m_Buckets[pos];
+      if (control == m_Controls[pos] &&
+          bucket.FullHashValue == full_hash &&
+          bucket.Entry->compare(pKey)) {
+        hash_count_probes(probes);
+        return pos;
+      }
+    }
 
-    if (bucket_type::getEmptyBucket() == bucket.Entry)
-      return -1;
+    if (0 != hash_match_empty(group))
+      break;
 
-    if (bucket_type::getTombstone() == bucket.Entry) {
-      // Ignore tombstones.
-    }
-    else if (full_hash == bucket.FullHashValue) {
-      // get string, compare, if match, return index
-      if (bucket.Entry->compare(pKey))
-        return index;
-    }
-    index += probe;
-    if (index == m_NumOfBuckets)
-      index = 0;
+    index = (index + kGroupWidth) & mask;
   }
+  hash_count_probes(probes);
+  return -1;
+}
+
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+void HashTableImpl<HashEntryTy, HashFunctionTy>::eraseBucket(unsigned int pIndex)
+{
+  m_Buckets[pIndex].Entry = bucket_type::getTombstone();
+  setControl(pIndex, kDeleted);
 }
 
 template<typename HashEntryTy,
@@ -224,40 +352,46 @@ template<typename HashEntryTy,
          typename HashFunctionTy>
 void HashTableImpl<HashEntryTy, HashFunctionTy>::doRehash(unsigned int pNewSize)
 {
-  bucket_type* new_table = (bucket_type*)calloc(pNewSize, sizeof(bucket_type));
+  // keep the number of buckets a power of two, and the load under 3/4
+  unsigned int new_size = NumOfInitBuckets;
+  while (new_size < pNewSize || (m_NumOfEntries<<2) > new_size*3)
+    new_size <<= 1;
+
+  if (mcld::LinkStats::isEnabled())
+    mcld::LinkStats::Add(mcld::LinkStats::HashRehashes);
+
+  bucket_type* old_table = m_Buckets;
+  uint8_t* old_controls = m_Controls;
+  unsigned int old_size = m_NumOfBuckets;
+
+  m_Buckets = (bucket_type*)calloc(new_size, sizeof(bucket_type));
+  m_Controls = (uint8_t*)malloc(new_size + kGroupWidth);
+  memset(m_Controls, kEmpty, new_size + kGroupWidth);
+  m_NumOfBuckets = new_size;
+  m_NumOfTombstones = 0;
 
   // Rehash all the items into their new buckets.  Luckily :) we already have
   // the hash values available, so we don't have to recall hash function again.
-  for (bucket_type *IB = m_Buckets, *E = m_Buckets+m_NumOfBuckets; IB != E; ++IB) {
+  unsigned int mask = new_size - 1;
+  for (bucket_type *IB = old_table, *E = old_table+old_size; IB != E; ++IB) {
     if (IB->Entry != bucket_type::getEmptyBucket() &&
         IB->Entry != bucket_type::getTombstone()) {
-      // Fast case, bucket available.
-      unsigned full_hash = IB->FullHashValue;
-      unsigned new_bucket = full_hash % pNewSize;
-      if (bucket_type::getEmptyBucket() == new_table[new_bucket].Entry) {
-        new_table[new_bucket].Entry = IB->Entry;
-        new_table[new_bucket].FullHashValue = full_hash;
-        continue;
-      }
-
-      // Otherwise probe for a spot.
-      const unsigned int probe = 1;
-      do {
-        new_bucket += probe;
-        if (new_bucket == pNewSize)
-          new_bucket = 0;
-      } while (new_table[new_bucket].Entry != bucket_type::getEmptyBucket());
-
-      // Finally found a slot.  Fill it in.
-      new_table[new_bucket].Entry = IB->Entry;
-      new_table[new_bucket].FullHashValue = full_hash;
+      size_t full_hash = IB->FullHashValue;
+      unsigned int index = bucketOf(full_hash);
+
+      // the new table has no tombstones, find the first empty bucket
+      uint64_t free_mask;
+      while (0 == (free_mask = hash_match_empty(loadGroup(index))))
+        index = (index + kGroupWidth) & mask;
+      index = (index + hash_first_byte(free_mask)) & mask;
+
+      m_Buckets[index].Entry = IB->Entry;
+      m_Buckets[index].FullHashValue = full_hash;
+      setControl(index, hash_control(full_hash));
     }
   }
 
-  free(m_Buckets);
-
-  m_Buckets = new_table;
-  m_NumOfBuckets = pNewSize;
-  m_NumOfTombstones = 0;
+  free(old_table);
+  free(old_controls);
 }
 
@@ -37,7 +37,7 @@ public:
   : m_pHashTable(pTable)
   {
     m_HashValue = pTable->hash()(pKey);
-    m_EndIndex = m_Index = m_HashValue % m_pHashTable->m_NumOfBuckets;
+    m_EndIndex = m_Index = m_pHashTable->bucketOf(m_HashValue);
     const unsigned int probe = 1;
     while(true) {
       bucket_type &bucket = m_pHashTable->m_Buckets[m_Index];
@@ -150,7 +150,7 @@ public:
 private:
   HashTableImplTy* m_pHashTable;
   unsigned int m_Index;
-  unsigned int m_HashValue;
+  size_t m_HashValue;
   unsigned int m_EndIndex;
 };
 
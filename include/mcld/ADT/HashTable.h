@@ -75,6 +75,9 @@ public:
   //  If the element already exists, return the element, and set pExist true.
   entry_type* insert(const key_type& pKey, bool& pExist);
 
+  /// insert - the same, but pKey is hashed into pFullHash already
+  entry_type* insert(const key_type& pKey, size_t pFullHash, bool& pExist);
+
   /// erase - remove the element with the same key
   size_type erase(const key_type& pKey);
 
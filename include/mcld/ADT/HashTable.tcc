@@ -65,7 +65,20 @@ HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::insert(
   const typename HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::key_type& pKey,
   bool& pExist)
 {
-  unsigned int index = BaseTy::lookUpBucketFor(pKey);
+  return insert(pKey, BaseTy::m_Hasher(pKey), pExist);
+}
+
+/// insert - insert a new element of the hash value pFullHash
+template<typename HashEntryTy,
+         typename HashFunctionTy,
+         typename EntryFactoryTy>
+typename HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::entry_type*
+HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::insert(
+  const typename HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::key_type& pKey,
+  size_t pFullHash,
+  bool& pExist)
+{
+  unsigned int index = BaseTy::lookUpBucketFor(pKey, pFullHash);
   bucket_type& bucket = BaseTy::m_Buckets[index];
   entry_type* entry = bucket.Entry;
   if (bucket_type::getEmptyBucket() != entry &&
@@ -99,9 +112,8 @@ HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::erase(
   if (-1 == (index = BaseTy::findKey(pKey)))
     return 0;
 
-  bucket_type& bucket = BaseTy::m_Buckets[index];
-  m_EntryFactory.destroy(bucket.Entry);
-  bucket.Entry = bucket_type::getTombstone();
+  m_EntryFactory.destroy(BaseTy::m_Buckets[index].Entry);
+  BaseTy::eraseBucket(index);
 
   --BaseTy::m_NumOfEntries;
   ++BaseTy::m_NumOfTombstones;
@@ -0,0 +1,109 @@
+//===- IndexTable.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_ADT_INDEX_TABLE_H
+#define MCLD_ADT_INDEX_TABLE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/Thread.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace mcld {
+
+/** \class IndexTable
+ *  \brief IndexTable maps 32-bit indices to the objects of a kind, so that the
+ *  objects can refer to each other by an index instead of a pointer.
+ *
+ *  Index 0 is NULL. The entries are kept in chunks of 2^ChunkBits, and a chunk
+ *  never moves, so at() takes no lock and can run alongside add(). The index
+ *  of a removed object is reused by the next add().
+ */
+template<typename DataType, unsigned int ChunkBits = 16>
+class IndexTable : private Uncopyable
+{
+public:
+  typedef uint32_t Index;
+
+  enum {
+    ChunkSize = 1u << ChunkBits,
+    NumOfChunks = 1u << (32 - ChunkBits)
+  };
+
+public:
+  IndexTable()
+    : m_Size(1), m_Live(0) {
+    std::memset(m_Chunks, 0, sizeof(m_Chunks));
+    m_Chunks[0] = new DataType*[ChunkSize];
+    m_Chunks[0][0] = NULL;
+  }
+
+  ~IndexTable() {
+    for (size_t chunk = 0; chunk < NumOfChunks && NULL != m_Chunks[chunk];
+         ++chunk)
+      delete [] m_Chunks[chunk];
+  }
+
+  /// add - give pEntry an index
+  Index add(DataType* pEntry) {
+    sys::ScopedLock lock(m_Lock);
+    Index index;
+    if (!m_FreeList.empty()) {
+      index = m_FreeList.back();
+      m_FreeList.pop_back();
+    }
+    else {
+      assert(0 != m_Size && "IndexTable runs out of indices");
+      index = m_Size++;
+      if (NULL == m_Chunks[index >> ChunkBits])
+        m_Chunks[index >> ChunkBits] = new DataType*[ChunkSize];
+    }
+    entry(index) = pEntry;
+    ++m_Live;
+    return index;
+  }
+
+  /// remove - release pIndex for the following add()
+  void remove(Index pIndex) {
+    if (0 == pIndex)
+      return;
+    sys::ScopedLock lock(m_Lock);
+    entry(pIndex) = NULL;
+    m_FreeList.push_back(pIndex);
+    --m_Live;
+  }
+
+  DataType* at(Index pIndex) const
+  { return m_Chunks[pIndex >> ChunkBits][pIndex & (ChunkSize - 1)]; }
+
+  /// size - the number of objects in the table
+  size_t size() const { return m_Live; }
+
+private:
+  DataType*& entry(Index pIndex)
+  { return m_Chunks[pIndex >> ChunkBits][pIndex & (ChunkSize - 1)]; }
+
+private:
+  DataType** m_Chunks[NumOfChunks];
+  std::vector<Index> m_FreeList;
+  Index m_Size;
+  size_t m_Live;
+  sys::Mutex m_Lock;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -121,6 +121,13 @@ inline uint64_t Align<64>(uint64_t pAddress)
 #undef bswap64
 #endif
 
+// GCC 4.3 and later, and clang, turn __builtin_bswap into one instruction,
+// such as bswap on x86 and rev on ARM.
+#if defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || \
+                          (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+#define MCLD_HAVE_BUILTIN_BSWAP 1
+#endif
+
 /// bswap16 - byte swap 16-bit version
 /// @ref binary utilities - elfcpp_swap
 inline uint16_t bswap16(uint16_t pData)
@@ -132,17 +139,23 @@ inline uint16_t bswap16(uint16_t pData)
 /// @ref elfcpp_swap
 inline uint32_t bswap32(uint32_t pData)
 {
+#if defined(MCLD_HAVE_BUILTIN_BSWAP)
+   return __builtin_bswap32(pData);
+#else
    return (((pData & 0xFF000000) >> 24) |
            ((pData & 0x00FF0000) >>  8) |
            ((pData & 0x0000FF00) <<  8) |
            ((pData & 0x000000FF) << 24));
-
+#endif
 }
 
 /// bswap64 - byte swap 64-bit version
 /// @ref binary utilities - elfcpp_swap
 inline uint64_t bswap64(uint64_t pData)
 {
+#if defined(MCLD_HAVE_BUILTIN_BSWAP)
+   return __builtin_bswap64(pData);
+#else
    return (((pData & 0xFF00000000000000ULL) >> 56) |
            ((pData & 0x00FF000000000000ULL) >> 40) |
            ((pData & 0x0000FF0000000000ULL) >> 24) |
@@ -151,6 +164,7 @@ inline uint64_t bswap64(uint64_t pData)
            ((pData & 0x0000000000FF0000ULL) << 24) |
            ((pData & 0x000000000000FF00ULL) << 40) |
            ((pData & 0x00000000000000FFULL) << 56));
+#endif
 }
 
 template <size_t SizeOfStr, typename FieldType>
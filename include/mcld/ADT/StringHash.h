@@ -16,6 +16,7 @@
 #include <llvm/Support/DataTypes.h>
 #include <llvm/Support/ErrorHandling.h>
 #include <cctype>
+#include <cstring>
 #include <functional>
 
 namespace mcld
@@ -34,7 +35,8 @@ enum StringHashType
   BP,
   FNV,
   AP,
-  ES
+  ES,
+  MURMUR
 };
 
 /** \class template<uint32_t TYPE> StringHash
@@ -338,6 +340,62 @@ struct StringHash<ES> : public std::unary_function<const llvm::StringRef&, uint3
   }
 };
 
+/** \class StringHash<MURMUR>
+ *  \brief MurmurHash64A by Austin Appleby.
+ *
+ *  MurmurHash64A reads a key eight bytes at a time, and distributes long
+ *  symbol names such as the mangled C++ names much better than the
+ *  byte-at-a-time functions above. The hash value is as wide as size_t.
+ *
+ *  The words are read in the byte order of the host, so the hash values
+ *  differ between hosts. Use StringHash<ELF> or StringHash<DJB> for the
+ *  values written into the output files.
+ */
+template<>
+struct StringHash<MURMUR> : public std::unary_function<const llvm::StringRef&, size_t>
+{
+  size_t operator()(const llvm::StringRef& pKey) const
+  {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    const char* data = pKey.data();
+    size_t len = pKey.size();
+    uint64_t hash_val = 0x8445d61a4e774912ULL ^ (len * m);
+
+    for (const char* end = data + (len & ~static_cast<size_t>(7));
+         data != end; data += 8) {
+      uint64_t k;
+      memcpy(&k, data, sizeof(k));
+      k *= m;
+      k ^= k >> r;
+      k *= m;
+      hash_val ^= k;
+      hash_val *= m;
+    }
+
+    switch (len & 7) {
+      case 7: hash_val ^= uint64_t(uint8_t(data[6])) << 48;
+      case 6: hash_val ^= uint64_t(uint8_t(data[5])) << 40;
+      case 5: hash_val ^= uint64_t(uint8_t(data[4])) << 32;
+      case 4: hash_val ^= uint64_t(uint8_t(data[3])) << 24;
+      case 3: hash_val ^= uint64_t(uint8_t(data[2])) << 16;
+      case 2: hash_val ^= uint64_t(uint8_t(data[1])) << 8;
+      case 1: hash_val ^= uint64_t(uint8_t(data[0]));
+              hash_val *= m;
+    }
+
+    hash_val ^= hash_val >> r;
+    hash_val *= m;
+    hash_val ^= hash_val >> r;
+
+    // fold the high half into a 32-bit size_t
+    if (sizeof(size_t) < sizeof(uint64_t))
+      hash_val ^= hash_val >> 32;
+    return static_cast<size_t>(hash_val);
+  }
+};
+
 /** \class template<uint32_t TYPE> StringCompare
  *  \brief the template StringCompare class, for specification
  */
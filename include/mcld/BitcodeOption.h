@@ -14,6 +14,9 @@
 
 #include <mcld/Support/Path.h>
 
+#include <utility>
+#include <vector>
+
 namespace mcld {
 
 /** \class BitcodeOption
@@ -21,6 +24,11 @@ namespace mcld {
  */
 class BitcodeOption
 {
+public:
+  /// Object - an object compiled from the bitcode, in the memory
+  typedef std::pair<void*, size_t> Object;
+  typedef std::vector<Object> ObjectList;
+
 public:
   BitcodeOption();
 
@@ -36,11 +44,30 @@ public:
 
   bool hasDefined() const;
 
+  /// addObject - link the object in pMemBuffer instead of the bitcode. The
+  /// memory is owned by the caller and must live until the link is done.
+  void addObject(void* pMemBuffer, size_t pSize)
+  { m_Objects.push_back(std::make_pair(pMemBuffer, pSize)); }
+
+  const ObjectList& objects() const { return m_Objects; }
+
+  bool hasObjects() const { return !m_Objects.empty(); }
+
+  /// setLTO - the bitcode inputs of the link are compiled by the link time
+  /// optimization into the objects.
+  void setLTO(bool pEnable = true) { m_bLTO = pEnable; }
+
+  bool isLTO() const { return m_bLTO; }
+
 private:
   int m_Position;
 
+  bool m_bLTO;
+
   sys::fs::Path m_Path;
 
+  ObjectList m_Objects;
+
 };
 
 } // namespace of mcld
@@ -0,0 +1,183 @@
+//===- LTOCodeGen.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_CODEGEN_LTO_CODEGEN_H
+#define MCLD_CODEGEN_LTO_CODEGEN_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/LD/NamePool.h>
+#include <mcld/Support/Path.h>
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSet.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+class DataLayout;
+class GlobalValue;
+class MemoryBuffer;
+class Module;
+
+namespace object {
+class Archive;
+class ObjectFile;
+} // namespace of object
+
+} // namespace of llvm
+
+namespace mcld {
+
+class LinkerConfig;
+class ResolveInfo;
+
+/** \class LTOCodeGen
+ *  \brief LTOCodeGen links the bitcode inputs of the link into a single
+ *  llvm::Module and optimizes it as a whole program.
+ *
+ *  The bitcode files and the bitcode members of the archives are read
+ *  lazily. Their global symbols are resolved in a NamePool together with the
+ *  symbols of the native objects and the shared objects, so only the
+ *  prevailing definition of a symbol is kept, and a bitcode member of an
+ *  archive joins only if it defines a symbol that is still undefined.
+ *
+ *  The definitions that no native input refers to, and that the output does
+ *  not export, are internalized before the LTO passes run. The resulting
+ *  module is compiled by SplitCodeGen, and the objects are linked in place of
+ *  the first bitcode input.
+ */
+class LTOCodeGen
+{
+public:
+  LTOCodeGen(const LinkerConfig& pConfig, llvm::Module& pModule);
+
+  ~LTOCodeGen();
+
+  /// addFile - add the input file pPath at pPosition on the command line. A
+  /// bitcode file joins the LTO, and the members of an archive are kept to
+  /// be pulled by run(). The symbols are resolved by run() in the order the
+  /// files are added.
+  /// @return false if pPath is bitcode, or has bitcode members, but can not
+  /// be read
+  bool addFile(const sys::fs::Path& pPath, unsigned int pPosition);
+
+  /// run - resolve the symbols of the inputs, pull the needed bitcode
+  /// members of the archives, link the prevailing definitions into the
+  /// module, and optimize it.
+  /// @return false if the bitcode can not be linked
+  bool run();
+
+  // -----  observers  ----- //
+  /// empty - is there no bitcode input?
+  bool empty() const { return m_Bitcodes.empty(); }
+
+  size_t numOfBitcodes() const { return m_Bitcodes.size(); }
+
+  /// position - the position of the first bitcode input
+  unsigned int position() const { return m_Position; }
+
+  /// path - the path of the first bitcode input
+  const sys::fs::Path& path() const { return m_Path; }
+
+private:
+  /// Bitcode - a bitcode file, or a bitcode member of an archive
+  struct Bitcode
+  {
+    std::string name;
+    llvm::Module* module;
+    bool isMember;
+    bool isLoaded;
+  };
+
+  typedef std::vector<Bitcode> BitcodeList;
+  typedef std::vector<std::pair<size_t, sys::fs::Path> > InputList;
+  typedef std::vector<llvm::object::Archive*> ArchiveList;
+  typedef llvm::DenseMap<const ResolveInfo*, size_t> OwnerMap;
+
+  // the owners of the definitions which are not in the bitcode inputs
+  enum {
+    NativeOwner = ~(size_t)0,
+    MainOwner   = ~(size_t)1
+  };
+
+private:
+  /// addBitcode - read the symbol table of the bitcode in pBuffer lazily.
+  /// LTOCodeGen takes pBuffer.
+  bool addBitcode(llvm::MemoryBuffer* pBuffer, const std::string& pName,
+                  bool pIsMember);
+
+  /// addArchive - add the members of the archive in pBuffer
+  bool addArchive(llvm::MemoryBuffer* pBuffer, const std::string& pName);
+
+  /// readNative - resolve the symbols of the native file pPath
+  void readNative(const sys::fs::Path& pPath);
+
+  /// addNative - resolve the symbols of the native object pObject, or of the
+  /// shared object if pIsDyn. The references of an archive member are only
+  /// recorded.
+  void addNative(const llvm::object::ObjectFile& pObject, bool pIsDyn,
+                 bool pIsMember);
+
+  /// load - resolve the global symbols of bitcode pIdx
+  void load(size_t pIdx);
+
+  /// insert - resolve the global pValue of bitcode pIdx
+  void insert(const llvm::GlobalValue& pValue, size_t pIdx,
+              const llvm::DataLayout& pLayout);
+
+  /// pullMembers - load the bitcode members which define the undefined
+  /// symbols, until no member is needed any more.
+  void pullMembers();
+
+  /// isNeeded - does bitcode pIdx define an undefined symbol?
+  bool isNeeded(size_t pIdx) const;
+
+  /// dropDefinitions - turn the definitions of pModule, the module of bitcode
+  /// pIdx, which do not prevail into declarations
+  void dropDefinitions(llvm::Module& pModule, size_t pIdx);
+
+  /// isPrevailing - is pValue of bitcode pIdx the prevailing definition?
+  bool isPrevailing(const llvm::GlobalValue& pValue, size_t pIdx) const;
+
+  /// isPreserved - must the definition pValue stay visible to the link?
+  bool isPreserved(const llvm::GlobalValue& pValue) const;
+
+  /// optimize - internalize the definitions and run the LTO passes
+  void optimize();
+
+private:
+  const LinkerConfig& m_Config;
+  llvm::Module& m_Module;
+  NamePool m_NamePool;
+  BitcodeList m_Bitcodes;
+  ArchiveList m_Archives;
+
+  // the bitcode files and the native files in the order of the command line.
+  // A native file is marked by NativeOwner.
+  InputList m_Inputs;
+
+  // the native members of the archives
+  std::vector<llvm::StringRef> m_NativeMembers;
+  OwnerMap m_Owners;
+
+  // the names the native inputs refer to
+  llvm::StringSet<> m_NativeRefs;
+
+  unsigned int m_Position;
+  sys::fs::Path m_Path;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -32,6 +32,7 @@ class MemoryArea;
 class IRBuilder;
 class LinkerConfig;
 class Linker;
+class LTOCodeGen;
 
 /** \class MCLinker
 *  \brief MCLinker provides a linking pass for standard compilation flow
@@ -65,9 +66,19 @@ public:
 
   virtual bool runOnMachineFunction(llvm::MachineFunction& pMFn);
 
+  /// AddLTOInputs - add the input files and the libraries of the namespecs
+  /// on the command line to pLTO, in the order of their positions.
+  /// @return false if a bitcode input can not be read
+  static bool AddLTOInputs(const LinkerConfig& pConfig, LTOCodeGen& pLTO);
+
 protected:
   void initializeInputTree(IRBuilder& pBuilder);
 
+  /// verifyDeterminism - link the inputs again with the serial scheduler and
+  /// compare the output with m_Output, for --verify-determinism.
+  /// @return false if the outputs differ or the serial link fails
+  bool verifyDeterminism();
+
 protected:
   LinkerConfig& m_Config;
   mcld::Module& m_Module;
@@ -0,0 +1,130 @@
+//===- SplitCodeGen.h -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_CODEGEN_SPLIT_CODEGEN_H
+#define MCLD_CODEGEN_SPLIT_CODEGEN_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/Support/Path.h>
+#include <mcld/Support/Thread.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Target/TargetOptions.h>
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class Module;
+
+} // namespace of llvm
+
+namespace mcld {
+
+class Target;
+class ThreadPool;
+class BitcodeOption;
+
+/** \class SplitCodeGen
+ *  \brief SplitCodeGen compiles a llvm::Module into objects in parallel.
+ *
+ *  The definitions of the module are cut into partitions of about the same
+ *  number of instructions. The local symbols become hidden global ones, so
+ *  the partitions can refer to each other. Every partition is written as
+ *  bitcode and read back into a LLVMContext of its own, since a LLVMContext
+ *  can be used by only one thread. Then every partition is compiled by a
+ *  TargetMachine of its own on the thread pool, into an object in the
+ *  memory.
+ *
+ *  A single partition is the module itself, compiled in place.
+ *
+ *  The objects are handed to the linker in the memory, in place of the
+ *  bitcode, and the definitions are removed from the given module, so the
+ *  passes running on it compile nothing.
+ *
+ *  With a cache directory, the object of a partition is keyed by the hash of
+ *  its bitcode and the target options. A partition found in the cache is
+ *  not compiled again.
+ */
+class SplitCodeGen
+{
+public:
+  SplitCodeGen(const mcld::Target& pTarget,
+               const std::string& pTriple,
+               const std::string& pCPU,
+               const std::string& pFeatures,
+               const llvm::TargetOptions& pOptions,
+               llvm::Reloc::Model pRelocModel,
+               llvm::CodeModel::Model pCodeModel,
+               llvm::CodeGenOpt::Level pOptLevel);
+
+  ~SplitCodeGen();
+
+  /// run - compile pModule as pNumOfParts partitions on pPool.
+  /// @return false if a partition can not be compiled.
+  bool run(ThreadPool& pPool, llvm::Module& pModule, unsigned int pNumOfParts);
+
+  /// addObjects - link the compiled objects in place of pBitcode.
+  void addObjects(BitcodeOption& pBitcode);
+
+  /// setCacheDir - look up the object of every partition in pDir before
+  /// compiling it, and store the compiled one.
+  void setCacheDir(const sys::fs::Path& pDir) { m_CacheDir = pDir; }
+
+  size_t size() const { return m_Objects.size(); }
+
+  /// compile - compile the bitcode of partition pIdx into its object. It is
+  /// called on the thread pool, once for every partition.
+  void compile(size_t pIdx);
+
+private:
+  /// split - write the partitions of pModule as bitcode into m_Objects.
+  void split(llvm::Module& pModule, unsigned int pNumOfParts);
+
+  /// strip - remove the compiled definitions from pModule.
+  void strip(llvm::Module& pModule);
+
+  /// emit - compile pModule into the object of partition pIdx.
+  void emit(llvm::Module& pModule, size_t pIdx);
+
+  /// getCachePath - the cache file of the object compiled from pBitcode
+  sys::fs::Path getCachePath(llvm::StringRef pBitcode) const;
+
+  /// loadCache - read the object of partition pIdx from pPath
+  bool loadCache(const sys::fs::Path& pPath, size_t pIdx);
+
+  /// storeCache - write the object of partition pIdx to pPath
+  bool storeCache(const sys::fs::Path& pPath, size_t pIdx) const;
+
+private:
+  const mcld::Target& m_Target;
+  std::string m_Triple;
+  std::string m_CPU;
+  std::string m_Features;
+  llvm::TargetOptions m_Options;
+  llvm::Reloc::Model m_RelocModel;
+  llvm::CodeModel::Model m_CodeModel;
+  llvm::CodeGenOpt::Level m_OptLevel;
+
+  // the bitcode of every partition, replaced by its object once compiled
+  std::vector<std::string> m_Objects;
+  std::vector<std::string> m_Errors;
+
+  sys::fs::Path m_CacheDir;
+  // the cache files which can not be written
+  std::vector<sys::fs::Path> m_Unstored;
+  sys::Mutex m_Lock;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -25,6 +25,13 @@
 
 #define MCLD_VERSION "RockBull - 2.0.0"
 
+/* Define to 1 to refer to the Fragments by 32-bit indices in FragmentRef */
+/* #undef MCLD_COMPACT_IR */
+
+/* Define to 1 to allocate the chunks and the slabs of the linker IR from
+   regions backed by 2MiB transparent huge pages */
+/* #undef MCLD_HUGE_PAGES */
+
 #define MCLD_REGION_CHUNK_SIZE 32
 #define MCLD_NUM_OF_INPUTS 32
 #define MCLD_SECTIONS_PER_INPUT 16
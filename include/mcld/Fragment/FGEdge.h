@@ -0,0 +1,52 @@
+//===- FGEdge.h -----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_FGEDGE_H
+#define MCLD_FGEDGE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+namespace mcld
+{
+
+class FGNode;
+
+/** \class FGEdge
+ *  \brief FGEdge is an edge for FragmentGraph. The weight is the number of
+ *  references from the source node to the target node.
+ */
+class FGEdge
+{
+public:
+  FGEdge(FGNode& pFrom, FGNode& pTo, uint32_t pWeight)
+    : m_pFrom(&pFrom), m_pTo(&pTo), m_Weight(pWeight) {
+  }
+
+  /// ----- observers ----- ///
+  FGNode&       getFrom()       { return *m_pFrom; }
+  const FGNode& getFrom() const { return *m_pFrom; }
+
+  FGNode&       getTo()       { return *m_pTo; }
+  const FGNode& getTo() const { return *m_pTo; }
+
+  uint32_t getWeight() const
+  { return m_Weight; }
+
+private:
+  FGNode* m_pFrom;
+  FGNode* m_pTo;
+  uint32_t m_Weight;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -45,8 +45,27 @@ public:
 
   virtual ~Fragment();
 
+  /// operator new - Fragments are allocated from an arena. Deleting a
+  /// Fragment only destroys it, and the memory of all Fragments is released
+  /// at once by Clear().
+  static void* operator new(size_t pSize);
+
+  static void operator delete(void* pPtr);
+
+  /// Clear - release the memory of all Fragments. All Fragments must have
+  /// been destroyed before.
+  static void Clear();
+
   Type getKind() const { return m_Kind; }
 
+#ifdef MCLD_COMPACT_IR
+  /// index - the index of this Fragment, which FragmentRef refers to
+  uint32_t index() const { return m_Index; }
+
+  /// Get - the Fragment of index pIndex. Index 0 is NULL.
+  static Fragment* Get(uint32_t pIndex);
+#endif
+
   const SectionData* getParent() const { return m_pParent; }
   SectionData*       getParent()       { return m_pParent; }
 
@@ -60,10 +79,9 @@ public:
 
   static bool classof(const Fragment *O) { return true; }
 
-  virtual size_t size() const {
-    assert(false && "Can not call abstract Fragment::size()!");
-    return 0;
-  }
+  /// size - the size of this Fragment. It switches on the kind of the
+  /// Fragment, so only stubs and target fragments make a virtual call.
+  size_t size() const;
 
 private:
   Fragment(const Fragment& );            // DO NOT IMPLEMENT
@@ -71,6 +89,9 @@ private:
 
 private:
   Type m_Kind;
+#ifdef MCLD_COMPACT_IR
+  uint32_t m_Index;
+#endif
   SectionData* m_pParent;
 
   uint64_t m_Offset;
@@ -48,6 +48,72 @@ public:
   typedef EdgeListType::const_iterator const_edge_iterator;
 
 
+public:
+  /** \class AdjacencyList
+   *  \brief AdjacencyList is the sparse reachability matrix of FragmentGraph
+   *   in the compressed sparse row (CSR) format.
+   *
+   *  References are added as (from, to) pairs. finalize() buckets them by the
+   *  source nodes and merges the duplicated pairs into weights. After that,
+   *  the targets of node X are m_Targets[m_RowBegin[X], m_RowBegin[X + 1]).
+   *  Both the memory and the time are linear to the number of references.
+   */
+  class AdjacencyList
+  {
+  public:
+    struct Target
+    {
+      uint32_t node;
+      uint32_t weight;
+    };
+
+    typedef std::vector<Target> TargetListType;
+    typedef TargetListType::const_iterator const_iterator;
+
+  public:
+    AdjacencyList();
+
+    /// add - add a reference from node pX to node pY.
+    void add(uint32_t pX, uint32_t pY);
+
+    /// finalize - build the rows of pN nodes. No reference can be added after
+    /// finalize().
+    void finalize(size_t pN);
+
+    /// at - the weight of the edge from node pX to node pY. Zero means the
+    /// two nodes are not connected.
+    uint32_t at(uint32_t pX, uint32_t pY) const;
+
+    const_iterator begin(uint32_t pX) const
+    { return m_Targets.begin() + m_RowBegin[pX]; }
+
+    const_iterator end(uint32_t pX) const
+    { return m_Targets.begin() + m_RowBegin[pX + 1]; }
+
+    uint32_t getN() const
+    { return m_N; }
+
+    size_t numOfEdges() const
+    { return m_Targets.size(); }
+
+  private:
+    typedef std::vector<uint32_t> IndexListType;
+
+    static bool compareTarget(const Target& pTarget, uint32_t pNode)
+    { return (pTarget.node < pNode); }
+
+  private:
+    // m_From, m_To - the references added before finalize()
+    IndexListType m_From;
+    IndexListType m_To;
+
+    // m_RowBegin - m_N + 1 offsets into m_Targets
+    IndexListType m_RowBegin;
+    TargetListType m_Targets;
+
+    size_t m_N;
+  };
+
 public:
   FragmentGraph();
   ~FragmentGraph();
@@ -66,6 +132,15 @@ public:
   /// @return false - the given node
   bool getEdges(FGNode& pNode, EdgeListType& pEdges);
 
+  /// getReachedNodes - find all nodes reachable from pRoots by a breadth-first
+  /// search. pReached[i] is true if the node of index i is reached. The roots
+  /// themselves are reached.
+  void getReachedNodes(const std::vector<FGNode*>& pRoots,
+                       std::vector<bool>& pReached) const;
+
+  /// isReachable - is pTo reachable from pFrom
+  bool isReachable(const FGNode& pFrom, const FGNode& pTo) const;
+
   /// ----- observers -----///
   /// getNode - given a fragment, finde the node which the fragment is belong to
   FGNode* getNode(const Fragment& pFrag);
@@ -106,42 +181,12 @@ private:
                     PtrHash,
                     EntryFactory<SymHashEntryType> > SymHashTableType;
 
-  /** \class ReachMatrix
-   *  \brief ReachMatrix is the reachability matrix which describes the relation
-   *   of Nodes in FragmentGraph
-   */
-  class ReachMatrix
-  {
-  public:
-    typedef std::vector<uint32_t> MatrixDataType;
-
-  public:
-    ReachMatrix(size_t pSize);
-    ~ReachMatrix();
-    uint32_t& at(uint32_t pX, uint32_t pY);
-    uint32_t at(uint32_t pX, uint32_t pY) const;
-
-    uint32_t getN() const
-    { return m_N; }
-
-    void print();
-
-  private:
-    // m_Data - the contents of the matrix. Here we use a one dimensional array
-    // to represent the two dimensional matrix
-    MatrixDataType m_Data;
-
-    // m_N - this is an m_N x m_N matrix
-    size_t m_N;
-  };
-
 private:
   FGNode* producePseudoNode();
   FGNode* produceRegularNode();
   void destroyPseudoNode();
   void destroyRegularNode();
 
-  void initMatrix();
 
   bool createRegularNodes(Module& pModule);
   bool setNodeSlots(Module& pModule);
@@ -161,13 +206,17 @@ private:
   /// the pseudo node which the contains it's fan-out is to the ResolveInfo
   SymHashTableType* m_pSymNodeMap;
 
-  ReachMatrix* m_pMatrix;
+  /// m_Matrix - the references between nodes
+  AdjacencyList m_Matrix;
+
+  /// m_NodeList - map the index of a node to the node
+  std::vector<FGNode*> m_NodeList;
 
   /// m_NumOfPNodes - number of pseudo nodes
   size_t m_NumOfPNodes;
   /// m_NumOfRNodes - number of regular nodes
   size_t m_NumOfRNodes;
-  /// m_NumOfEdges - number of edges
+  /// m_NumOfEdges - number of edges, known after construct()
   size_t m_NumOfEdges;
 };
 
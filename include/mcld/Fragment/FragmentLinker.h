@@ -18,6 +18,7 @@
 #endif
 
 #include <string>
+#include <vector>
 
 #include <mcld/LinkerConfig.h>
 #include <mcld/LD/LDFileFormat.h>
@@ -31,6 +32,7 @@ class Module;
 class TargetLDBackend;
 class LinkerConfig;
 class MemoryArea;
+class Relocator;
 
 /** \class FragmentLinker
  *  \brief FragmentLinker provides a pass to link object files.
@@ -53,17 +55,44 @@ public:
   /// data to output file.
   void syncRelocationResult(MemoryArea& pOutput);
 
+  /// IsStreamed - with --low-memory, --threads or --output-strategy=write,
+  /// the writer writes the results of the input relocations along with their
+  /// sections instead of syncRelocationResult().
+  static bool IsStreamed(const LinkerConfig& pConfig);
+
+  /// IsFused - with --fuse-relocations, pReloc is not applied by
+  /// applyRelocations() but applied and written at once by the writer or by
+  /// normalSyncRelocationResult().
+  static bool IsFused(const LinkerConfig& pConfig,
+                      const Relocator& pRelocator,
+                      const Relocation& pReloc);
+
+  /// SortByPlace - sort the finalized relocations pRelocs of one output
+  /// section by their places, so that their results are written through the
+  /// section in order. The relocations at the same place keep their order.
+  static void SortByPlace(std::vector<Relocation*>& pRelocs);
+
 private:
+  bool isFused(const Relocation& pReloc) const;
+
+  /// isCompressedTarget - pReloc applies to a section compressed by the
+  /// writer, which writes the result into the image before compression.
+  static bool isCompressedTarget(const Relocation& pReloc);
+
   /// normalSyncRelocationResult - sync relocation result when producing shared
   /// objects or executables
-  void normalSyncRelocationResult(MemoryArea& pOutput);
+  template<bool SWAP>
+  void normalSyncRelocationResult(uint8_t* pData);
 
   /// partialSyncRelocationResult - sync relocation result when doing partial
   /// link
-  void partialSyncRelocationResult(MemoryArea& pOutput);
+  template<bool SWAP>
+  void partialSyncRelocationResult(uint8_t* pData);
 
   /// writeRelocationResult - helper function of syncRelocationResult, write
-  /// relocation target data to output
+  /// relocation target data to output. SWAP tells if the byte order of the
+  /// target differs from the host's.
+  template<bool SWAP>
   void writeRelocationResult(Relocation& pReloc, uint8_t* pOutput);
 
 private:
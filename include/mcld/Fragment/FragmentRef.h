@@ -35,6 +35,10 @@ public:
   typedef ConstTraits<unsigned char>::pointer ConstAddress;
 
 public:
+  /// FragmentRef - an empty reference, which a symbol or a relocation holds
+  /// in place until it is assigned.
+  FragmentRef();
+
   /// Create - create a fragment reference for a given fragment.
   ///
   /// @param pFrag - the given fragment
@@ -56,6 +60,13 @@ public:
 
   FragmentRef& assign(Fragment& pFrag, Offset pOffset = 0);
 
+  /// assign - refer to pSection[pOffset] like Create(pSection, pOffset), but
+  /// in place. The reference is empty if pSection has no fragment there.
+  FragmentRef& assign(LDSection& pSection, Offset pOffset);
+
+  /// reset - refer to nothing
+  void reset() { setFragment(NULL, 0); }
+
   /// memcpy - copy memory
   /// copy memory from the fragment to the pDesc.
   /// @pDest - the destination address
@@ -68,10 +79,10 @@ public:
   bool isNull() const { return (this == Null()); }
 
   Fragment* frag()
-  { return m_pFragment; }
+  { return getFragment(); }
 
   const Fragment* frag() const
-  { return m_pFragment; }
+  { return getFragment(); }
 
   Offset offset() const
   { return m_Offset; }
@@ -94,13 +105,28 @@ private:
   friend class Chunk<FragmentRef, MCLD_SECTIONS_PER_INPUT>;
   friend class Relocation;
 
-  FragmentRef();
-
   FragmentRef(Fragment& pFrag, Offset pOffset = 0);
-  
+
+#ifdef MCLD_COMPACT_IR
+  Fragment* getFragment() const;
+
+  void setFragment(Fragment* pFrag, Offset pOffset);
+#else
+  Fragment* getFragment() const { return m_pFragment; }
+
+  void setFragment(Fragment* pFrag, Offset pOffset)
+  { m_pFragment = pFrag; m_Offset = pOffset; }
+#endif
+
 private:
+#ifdef MCLD_COMPACT_IR
+  // the index of the Fragment and a 32-bit offset in it
+  uint32_t m_FragIndex;
+  uint32_t m_Offset;
+#else
   Fragment* m_pFragment;
   Offset m_Offset;
+#endif
 
   static FragmentRef g_NullFragmentRef;
 
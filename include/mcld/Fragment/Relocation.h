@@ -29,6 +29,7 @@ class Relocation : public llvm::ilist_node<Relocation>
 friend class RelocationFactory;
 friend class GCFactoryListTraits<Relocation>;
 friend class Chunk<Relocation, MCLD_RELOCATIONS_PER_INPUT>;
+friend class OutputRelocSection;
 
 public:
   typedef uint64_t Address; // FIXME: use SizeTrait<T>::Address instead
@@ -45,13 +46,15 @@ private:
              Address pAddend,
              DWord pTargetData);
 
-  ~Relocation();
+  ~Relocation() { }
 
 public:
-  /// Initialize - set up the relocation factory
+  /// SetUp - set up the relocation factory of the current link. Every
+  /// LinkContext owns a factory, so the relocations of the links on
+  /// different threads are allocated apart.
   static void SetUp(const LinkerConfig& pConfig);
 
-  /// Clear - Clean up the relocation factory
+  /// Clear - Clean up the relocation factory of the current link
   static void Clear();
 
   /// Create - produce an empty relocation entry
@@ -64,9 +67,17 @@ public:
   static Relocation* Create(Type pType, FragmentRef& pFragRef,
                             Address pAddend = 0);
 
+  /// Create - produce a relocation entry applied to pFrag[pOffset]. Unlike
+  /// the above one, clients need not create a FragmentRef for the place.
+  static Relocation* Create(Type pType, Fragment& pFrag, uint64_t pOffset,
+                            Address pAddend = 0);
+
   /// Destroy - destroy a relocation entry
   static void Destroy(Relocation*& pRelocation);
 
+  /// ClearFinalized - forget the records of finalize(). Clear() also does.
+  static void ClearFinalized();
+
   /// type - relocation type
   Type type() const
   { return m_Type; }
@@ -98,6 +109,15 @@ public:
 
   void apply(Relocator& pRelocator);
 
+  /// finalize - record the place and the symbol value, which are fixed once
+  /// the symbol values are finalized after the layout. place() and
+  /// symValue() read the record afterwards, instead of walking from the
+  /// fragment and the symbol to the output section. It is not thread-safe.
+  void finalize();
+
+  bool isFinalized() const
+  { return (0 != m_Finalized); }
+
   /// updateAddend - A relocation with a section symbol must update addend
   /// before reading its value.
   void updateAddend();
@@ -110,8 +130,15 @@ public:
   void setSymInfo(ResolveInfo* pSym);
 
 private:
-  /// m_Type - the type of the relocation entries
-  Type m_Type;
+  /// computePlace - P, from the fragment of the place
+  Address computePlace() const;
+
+  /// computeSymValue - S, from the output symbol
+  Address computeSymValue() const;
+
+private:
+  // The members are ordered by size, so that the one-byte type does not pad
+  // the others.
 
   /// m_TargetData - target data of the place being relocated
   DWord m_TargetData;
@@ -124,6 +151,13 @@ private:
 
   /// m_Addend - the addend
   Address m_Addend;
+
+  /// m_Finalized - 1 + the index of the record of finalize(), or 0. It fits
+  /// in the padding after the members above.
+  uint32_t m_Finalized;
+
+  /// m_Type - the type of the relocation entries
+  Type m_Type;
 };
 
 } // namespace of mcld
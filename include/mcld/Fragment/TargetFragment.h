@@ -31,6 +31,12 @@ protected:
 public:
   virtual ~TargetFragment() {}
 
+  /// size - the size of the target fragment
+  virtual size_t size() const {
+    assert(false && "Can not call abstract TargetFragment::size()!");
+    return 0;
+  }
+
   static bool classof(const Fragment *F)
   { return F->getKind() == Fragment::Target; }
 
@@ -11,6 +11,7 @@
 #ifdef ENABLE_UNITTEST
 #include <gtest.h>
 #endif
+#include <set>
 #include <string>
 #include <mcld/Support/RealPath.h>
 #include <mcld/Support/FileSystem.h>
@@ -43,6 +44,44 @@ public:
     Both    = 0x3
   };
 
+  enum ICF {
+    ICF_None,
+    ICF_All,
+    ICF_Safe
+  };
+
+  enum PackDynRelocs {
+    PackDynRelocs_None,
+    PackDynRelocs_Relr,
+    PackDynRelocs_Android
+  };
+
+  enum CompressDebugSections {
+    CompressDebugSections_None,
+    CompressDebugSections_Zlib
+  };
+
+  enum BuildID {
+    BuildID_None,
+    BuildID_Fast,
+    BuildID_MD5,
+    BuildID_SHA1,
+    BuildID_UUID,
+    BuildID_Hex
+  };
+
+  enum OutputStrategy {
+    OutputStrategy_Map,
+    OutputStrategy_Preallocate,
+    OutputStrategy_Write
+  };
+
+  enum SortSection {
+    SortSection_None,
+    SortSection_Name,
+    SortSection_Alignment
+  };
+
   typedef std::vector<std::string> RpathList;
   typedef RpathList::iterator rpath_iterator;
   typedef RpathList::const_iterator const_rpath_iterator;
@@ -81,12 +120,84 @@ public:
   bool trace() const
   { return m_bTrace; }
 
+  /// time report - print the time spent in each phase
+  void setTimeReport(bool pEnable = true)
+  { m_bTimeReport = pEnable; }
+
+  bool timeReport() const
+  { return m_bTimeReport; }
+
+  /// perf counters - record the hardware counters of the phases with the
+  /// time report
+  void setPerfCounters(bool pEnable = true)
+  { m_bPerfCounters = pEnable; }
+
+  bool perfCounters() const
+  { return m_bPerfCounters; }
+
+  /// time trace - write the Chrome trace events of the link into the file
+  void setTimeTrace(const std::string& pFile)
+  { m_TimeTrace = pFile; }
+
+  const std::string& timeTrace() const
+  { return m_TimeTrace; }
+
+  bool hasTimeTrace() const
+  { return !m_TimeTrace.empty(); }
+
+  /// cost report - write what each input object costs the link into the
+  /// file, as JSON if the file ends in .json, or as CSV
+  void setCostReport(const std::string& pFile)
+  { m_CostReport = pFile; }
+
+  const std::string& costReport() const
+  { return m_CostReport; }
+
+  bool hasCostReport() const
+  { return !m_CostReport.empty(); }
+
+  /// print memory usage - print the memory of the factories after each phase
+  void setPrintMemoryUsage(bool pEnable = true)
+  { m_bPrintMemoryUsage = pEnable; }
+
+  bool printMemoryUsage() const
+  { return m_bPrintMemoryUsage; }
+
+  /// stats - print the counters of the work done in each phase
+  void setStats(bool pEnable = true)
+  { m_bStats = pEnable; }
+
+  bool stats() const
+  { return m_bStats; }
+
+  /// exit fast - exit the process right after the output is written, without
+  /// destroying the Module and the factories of the link
+  void setExitFast(bool pEnable = true)
+  { m_bExitFast = pEnable; }
+
+  bool exitFast() const
+  { return m_bExitFast; }
+
+  /// verify determinism - link again with the serial scheduler and compare
+  /// the output with the output of --threads
+  void setVerifyDeterminism(bool pEnable = true)
+  { m_bVerifyDeterminism = pEnable; }
+
+  bool verifyDeterminism() const
+  { return m_bVerifyDeterminism; }
+
   void setBsymbolic(bool pBsymbolic = true)
   { m_Bsymbolic = pBsymbolic; }
 
   bool Bsymbolic() const
   { return m_Bsymbolic; }
 
+  void setBsymbolicFunctions(bool pEnable = true)
+  { m_BsymbolicFunctions = pEnable; }
+
+  bool BsymbolicFunctions() const
+  { return m_BsymbolicFunctions; }
+
   void setPIE(bool pPIE = true)
   { m_bPIE = pPIE; }
 
@@ -117,6 +228,66 @@ public:
   bool hasDyld() const
   { return !m_Dyld.empty(); }
 
+  /// archive index cache - the directory of the cached armap indexes
+  void setArchiveIndexCache(const std::string& pDir)
+  { m_ArchiveIndexCache = pDir; }
+
+  const std::string& archiveIndexCache() const
+  { return m_ArchiveIndexCache; }
+
+  bool hasArchiveIndexCache() const
+  { return !m_ArchiveIndexCache.empty(); }
+
+  /// dynobj summary cache - the directory of the cached summaries of the
+  /// shared objects
+  void setDynObjSummaryCache(const std::string& pDir)
+  { m_DynObjSummaryCache = pDir; }
+
+  const std::string& dynObjSummaryCache() const
+  { return m_DynObjSummaryCache; }
+
+  bool hasDynObjSummaryCache() const
+  { return !m_DynObjSummaryCache.empty(); }
+
+  /// object summary cache - the directory of the cached summaries of the
+  /// relocatable objects
+  void setObjectSummaryCache(const std::string& pDir)
+  { m_ObjectSummaryCache = pDir; }
+
+  const std::string& objectSummaryCache() const
+  { return m_ObjectSummaryCache; }
+
+  bool hasObjectSummaryCache() const
+  { return !m_ObjectSummaryCache.empty(); }
+
+  /// LTO cache - the directory of the cached objects of the LTO partitions
+  void setLTOCacheDir(const std::string& pDir)
+  { m_LTOCacheDir = pDir; }
+
+  const std::string& ltoCacheDir() const
+  { return m_LTOCacheDir; }
+
+  bool hasLTOCacheDir() const
+  { return !m_LTOCacheDir.empty(); }
+
+  /// link cache - the directory of the cached outputs
+  void setLinkCache(const std::string& pDir)
+  { m_LinkCache = pDir; }
+
+  const std::string& linkCache() const
+  { return m_LinkCache; }
+
+  bool hasLinkCache() const
+  { return !m_LinkCache.empty(); }
+
+  /// command line key - the hash of the command line, which keys the cached
+  /// outputs and the state of --incremental
+  void setCommandLineKey(uint64_t pKey)
+  { m_CommandLineKey = pKey; }
+
+  uint64_t commandLineKey() const
+  { return m_CommandLineKey; }
+
   void setSOName(const std::string& pName);
 
   const std::string& soname() const
@@ -206,6 +377,14 @@ public:
   bool hasOrigin() const
   { return m_bOrigin; }
 
+  bool hasSeparateCode() const
+  { return m_bSeparateCode; }
+
+  /// hasDirect - -z direct records the library providing each dynamic
+  /// symbol in .SUNW_syminfo
+  bool hasDirect() const
+  { return m_bDirect; }
+
   uint64_t commPageSize() const
   { return m_CommPageSize; }
 
@@ -215,6 +394,23 @@ public:
   bool hasEhFrameHdr() const
   { return m_bCreateEhFrameHdr; }
 
+  // --gdb-index
+  void setGdbIndex(bool pEnable = true)
+  { m_bGdbIndex = pEnable; }
+
+  bool hasGdbIndex() const
+  { return m_bGdbIndex; }
+
+  // --separate-debug-file=<path>
+  void setSeparateDebugFile(const std::string& pFile)
+  { m_SeparateDebugFile = pFile; }
+
+  const std::string& separateDebugFile() const
+  { return m_SeparateDebugFile; }
+
+  bool hasSeparateDebugFile() const
+  { return !m_SeparateDebugFile.empty(); }
+
   // -n, --nmagic
   void setNMagic(bool pMagic = true)
   { m_bNMagic = pMagic; }
@@ -286,6 +482,243 @@ public:
   bool nostdlib() const
   { return m_bNoStdlib; }
 
+  // --threads=N, zero means one thread per processor
+  void setNumThreads(unsigned int pNum)
+  { m_NumThreads = pNum; }
+
+  unsigned int numThreads() const
+  { return m_NumThreads; }
+
+  bool isMultiThreads() const
+  { return (1 != m_NumThreads); }
+
+  // --thread-affinity, bind the threads to the processors node by node
+  void setThreadAffinity(bool pEnable = true)
+  { m_bThreadAffinity = pEnable; }
+
+  bool threadAffinity() const
+  { return m_bThreadAffinity; }
+
+  // --codegen-partitions=N, compile the bitcode as N partitions
+  void setCodeGenPartitions(unsigned int pNum)
+  { m_CodeGenPartitions = pNum; }
+
+  unsigned int codeGenPartitions() const
+  { return m_CodeGenPartitions; }
+
+  // --lto-jobs=N, compile the module of the LTO as N partitions. 0 means
+  // --codegen-partitions.
+  void setLTOJobs(unsigned int pNum)
+  { m_LTOJobs = pNum; }
+
+  unsigned int ltoJobs() const
+  { return (0 == m_LTOJobs) ? m_CodeGenPartitions : m_LTOJobs; }
+
+  // --map-whole-files, map every read-only input file at once
+  void setMapWholeFile(bool pEnable = true)
+  { m_bMapWholeFile = pEnable; }
+
+  bool mapWholeFile() const
+  { return m_bMapWholeFile; }
+
+  // --fuse-relocations, apply the independent relocations while writing them
+  // into the output
+  void setFuseRelocations(bool pEnable = true)
+  { m_bFuseRelocations = pEnable; }
+
+  bool fuseRelocations() const
+  { return m_bFuseRelocations; }
+
+  // --kernel-copy, let the kernel copy the large input fragments which no
+  // relocation changes from the input files into the output file
+  void setKernelCopy(bool pEnable = true)
+  { m_bKernelCopy = pEnable; }
+
+  bool kernelCopy() const
+  { return m_bKernelCopy; }
+
+  // --stream-partial-link, copy the relocation sections of a partial link
+  // (-r) into the output without reading them into Relocation
+  void setStreamPartialLink(bool pEnable = true)
+  { m_bStreamPartialLink = pEnable; }
+
+  bool streamPartialLink() const
+  { return m_bStreamPartialLink; }
+
+  // --low-memory, write the output section by section, and let the system
+  // reclaim the pages of each section and of its inputs once it is written.
+  // The relocations of the debug sections are also kept packed.
+  void setLowMemory(bool pEnable = true)
+  { m_bLowMemory = pEnable; }
+
+  bool isLowMemory() const
+  { return m_bLowMemory; }
+
+  // --gc-sections, --no-gc-sections
+  void setGCSections(bool pEnable = true)
+  { m_bGCSections = pEnable; }
+
+  bool GCSections() const
+  { return m_bGCSections; }
+
+  // --icf=[none,all,safe]
+  void setICFMode(ICF pMode)
+  { m_ICF = pMode; }
+
+  ICF getICFMode() const
+  { return m_ICF; }
+
+  // --pack-dyn-relocs=[none,relr,android]
+  void setPackDynRelocs(PackDynRelocs pMode)
+  { m_PackDynRelocs = pMode; }
+
+  PackDynRelocs getPackDynRelocs() const
+  { return m_PackDynRelocs; }
+
+  // --compress-debug-sections=[none,zlib]
+  void setCompressDebugSections(CompressDebugSections pMode)
+  { m_CompressDebugSections = pMode; }
+
+  CompressDebugSections getCompressDebugSections() const
+  { return m_CompressDebugSections; }
+
+  // --build-id[=fast,md5,sha1,uuid,0x<hex>,none]
+  void setBuildID(BuildID pStyle)
+  { m_BuildID = pStyle; }
+
+  BuildID getBuildID() const
+  { return m_BuildID; }
+
+  bool hasBuildID() const
+  { return (BuildID_None != m_BuildID); }
+
+  // the bytes of --build-id=0x<hex>
+  void setBuildIDValue(const std::string& pValue)
+  { m_BuildIDValue = pValue; }
+
+  const std::string& getBuildIDValue() const
+  { return m_BuildIDValue; }
+
+  // --output-strategy=[map,preallocate,write]
+  void setOutputStrategy(OutputStrategy pStrategy)
+  { m_OutputStrategy = pStrategy; }
+
+  OutputStrategy getOutputStrategy() const
+  { return m_OutputStrategy; }
+
+  // --sort-section=[name,alignment]
+  void setSortSection(SortSection pSort)
+  { m_SortSection = pSort; }
+
+  SortSection getSortSection() const
+  { return m_SortSection; }
+
+  // --symbol-ordering-file=<file>
+  void setSymbolOrderingFile(const std::string& pFile)
+  { m_SymbolOrderingFile = pFile; }
+
+  const std::string& symbolOrderingFile() const
+  { return m_SymbolOrderingFile; }
+
+  bool hasSymbolOrderingFile() const
+  { return !m_SymbolOrderingFile.empty(); }
+
+  // --call-graph-ordering
+  void setCallGraphOrdering(bool pEnable = true)
+  { m_bCallGraphOrdering = pEnable; }
+
+  bool callGraphOrdering() const
+  { return m_bCallGraphOrdering; }
+
+  // --call-graph-profile-file=<file>
+  void setCallGraphProfileFile(const std::string& pFile)
+  { m_CallGraphProfileFile = pFile; }
+
+  const std::string& callGraphProfileFile() const
+  { return m_CallGraphProfileFile; }
+
+  bool hasCallGraphProfileFile() const
+  { return !m_CallGraphProfileFile.empty(); }
+
+  // --small-data-profile-file=<file>
+  void setSmallDataProfileFile(const std::string& pFile)
+  { m_SmallDataProfileFile = pFile; }
+
+  const std::string& smallDataProfileFile() const
+  { return m_SmallDataProfileFile; }
+
+  bool hasSmallDataProfileFile() const
+  { return !m_SmallDataProfileFile.empty(); }
+
+  // --dynamic-list=<file>
+  void setDynamicList(const std::string& pFile)
+  { m_DynamicList = pFile; }
+
+  const std::string& dynamicList() const
+  { return m_DynamicList; }
+
+  bool hasDynamicList() const
+  { return !m_DynamicList.empty(); }
+
+  // --version-script=<file>
+  void setVersionScript(const std::string& pFile)
+  { m_VersionScript = pFile; }
+
+  const std::string& versionScript() const
+  { return m_VersionScript; }
+
+  bool hasVersionScript() const
+  { return !m_VersionScript.empty(); }
+
+  // --exclude-libs=lib1,lib2,...
+  typedef std::set<std::string> ExcludeLIBS;
+
+  const ExcludeLIBS& excludeLIBS() const { return m_ExcludeLIBS; }
+  ExcludeLIBS&       excludeLIBS()       { return m_ExcludeLIBS; }
+
+  /// isInExcludeLIBS - the symbols of the archive pInput are not exported.
+  /// An archive is named by its file name, such as libfoo.a, and ALL names
+  /// every archive.
+  bool isInExcludeLIBS(const Input& pInput) const;
+
+  // --huge-page-text
+  void setHugePageText(bool pEnable = true)
+  { m_bHugePageText = pEnable; }
+
+  bool hugePageText() const
+  { return m_bHugePageText; }
+
+  // --prelink-map=<file>
+  void setPrelinkMap(const std::string& pFile)
+  { m_PrelinkMap = pFile; }
+
+  const std::string& prelinkMap() const
+  { return m_PrelinkMap; }
+
+  bool hasPrelinkMap() const
+  { return !m_PrelinkMap.empty(); }
+
+  // --pack-data-pages
+  void setPackDataPages(bool pEnable = true)
+  { m_bPackDataPages = pEnable; }
+
+  bool packDataPages() const
+  { return m_bPackDataPages; }
+
+  // --incremental
+  void setIncremental(bool pEnable = true)
+  { m_bIncremental = pEnable; }
+
+  bool isIncremental() const
+  { return m_bIncremental; }
+
+  // --lazy-shared-symbols
+  void setLazySharedSymbols(bool pEnable = true)
+  { m_bLazySharedSymbols = pEnable; }
+
+  bool lazySharedSymbols() const
+  { return m_bLazySharedSymbols; }
+
   unsigned int getHashStyle() const { return m_HashStyle; }
 
   void setHashStyle(unsigned int pStyle)
@@ -300,6 +733,12 @@ public:
   const_rpath_iterator rpath_end  () const { return m_RpathList.end();   }
   rpath_iterator       rpath_end  ()       { return m_RpathList.end();   }
 
+  // -----  rpath-link  ----- //
+  /// getRpathLinkList - the directories searched for the DT_NEEDED
+  /// libraries of the shared objects before the -L directories
+  const RpathList& getRpathLinkList() const { return m_RpathLinkList; }
+  RpathList&       getRpathLinkList()       { return m_RpathLinkList; }
+
   // -----  filter and auxiliary filter  ----- //
   void setFilter(const std::string& pFilter)
   { m_Filter = pFilter; }
@@ -332,6 +771,12 @@ private:
   std::string m_Entry;
   std::string m_Dyld;
   std::string m_SOName;
+  std::string m_ArchiveIndexCache;
+  std::string m_DynObjSummaryCache;
+  std::string m_ObjectSummaryCache;
+  std::string m_LTOCacheDir;
+  std::string m_LinkCache;
+  uint64_t m_CommandLineKey;
   int8_t m_Verbose;            // --verbose[=0,1,2]
   uint16_t m_MaxErrorNum;      // --error-limit=N
   uint16_t m_MaxWarnNum;       // --warning-limit=N
@@ -352,12 +797,16 @@ private:
   bool m_bRelro         : 1;   // relro, norelro
   bool m_bNow           : 1;   // lazy, now
   bool m_bOrigin        : 1;   // origin
+  bool m_bSeparateCode  : 1;   // separate-code, noseparate-code
+  bool m_bDirect        : 1;   // direct, nodirect
   bool m_bTrace         : 1;   // --trace
   bool m_Bsymbolic      : 1;   // --Bsymbolic
+  bool m_BsymbolicFunctions : 1; // --Bsymbolic-functions
   bool m_Bgroup         : 1;
   bool m_bPIE           : 1;
   bool m_bColor         : 1;   // --color[=true,false,auto]
   bool m_bCreateEhFrameHdr : 1;    // --eh-frame-hdr
+  bool m_bGdbIndex : 1; // --gdb-index
   bool m_bNMagic : 1; // -n, --nmagic
   bool m_bOMagic : 1; // -N, --omagic
   bool m_bStripDebug : 1; // -S, --strip-debug
@@ -368,10 +817,49 @@ private:
   bool m_bFatalWarnings : 1; // --fatal-warnings
   bool m_bNewDTags: 1; // --enable-new-dtags
   bool m_bNoStdlib: 1; // -nostdlib
+  bool m_bMapWholeFile: 1; // --map-whole-files
+  bool m_bFuseRelocations: 1; // --fuse-relocations
+  bool m_bKernelCopy: 1; // --kernel-copy
+  bool m_bStreamPartialLink: 1; // --stream-partial-link
+  bool m_bLowMemory: 1; // --low-memory
+  bool m_bGCSections: 1; // --gc-sections
+  bool m_bCallGraphOrdering: 1; // --call-graph-ordering
+  bool m_bHugePageText: 1; // --huge-page-text
+  bool m_bPackDataPages: 1; // --pack-data-pages
+  bool m_bIncremental: 1; // --incremental
+  bool m_bLazySharedSymbols: 1; // --lazy-shared-symbols
+  bool m_bTimeReport: 1; // --time-report
+  bool m_bPerfCounters: 1; // --perf-counters
+  bool m_bPrintMemoryUsage: 1; // --print-memory-usage
+  bool m_bStats: 1; // --stats
+  bool m_bExitFast: 1; // --exit-fast
+  bool m_bVerifyDeterminism: 1; // --verify-determinism
+  bool m_bThreadAffinity: 1; // --thread-affinity
   StripSymbolMode m_StripSymbols;
+  ICF m_ICF;
+  PackDynRelocs m_PackDynRelocs;
+  CompressDebugSections m_CompressDebugSections;
+  BuildID m_BuildID;
+  OutputStrategy m_OutputStrategy;
+  SortSection m_SortSection;
   RpathList m_RpathList;
+  RpathList m_RpathLinkList;
   unsigned int m_HashStyle;
+  unsigned int m_NumThreads;   // --threads=N
+  unsigned int m_CodeGenPartitions; // --codegen-partitions=N
+  unsigned int m_LTOJobs; // --lto-jobs=N
   std::string m_Filter;
+  std::string m_SymbolOrderingFile; // --symbol-ordering-file
+  std::string m_CallGraphProfileFile; // --call-graph-profile-file
+  std::string m_SmallDataProfileFile; // --small-data-profile-file
+  std::string m_DynamicList; // --dynamic-list
+  std::string m_VersionScript; // --version-script
+  ExcludeLIBS m_ExcludeLIBS; // --exclude-libs
+  std::string m_TimeTrace; // --time-trace
+  std::string m_CostReport; // --cost-report
+  std::string m_PrelinkMap; // --prelink-map
+  std::string m_BuildIDValue; // --build-id=0x<hex>
+  std::string m_SeparateDebugFile; // --separate-debug-file
   AuxiliaryList m_AuxiliaryList;
 };
 
@@ -19,6 +19,7 @@
 
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/EhFrame.h>
+#include <mcld/LD/ExportFilter.h>
 #include <mcld/LD/LDSymbol.h>
 
 #include <mcld/Fragment/Fragment.h>
@@ -31,11 +32,14 @@
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/raw_mem_ostream.h>
 
+#include <vector>
+
 namespace mcld {
 
 class Module;
 class LinkerConfig;
 class InputTree;
+class MemoryAreaFactory;
 
 /** \class IRBuilder
  *  \brief IRBuilder provides an uniform API for creating sections and
@@ -67,11 +71,27 @@ public:
 public:
   IRBuilder(Module& pModule, const LinkerConfig& pConfig);
 
+  /// IRBuilder - read the input files through the MemoryAreas of
+  /// pMemoryFactory, which outlives the builder.
+  IRBuilder(Module& pModule,
+            const LinkerConfig& pConfig,
+            MemoryAreaFactory& pMemoryFactory);
+
   ~IRBuilder();
 
   const InputBuilder& getInputBuilder() const { return m_InputBuilder; }
   InputBuilder&       getInputBuilder()       { return m_InputBuilder; }
 
+  const LinkerConfig& getConfig() const { return m_Config; }
+
+  const Module& getModule() const { return m_Module; }
+  Module&       getModule()       { return m_Module; }
+
+  /// getExportFilter - the symbols that --dynamic-list and --version-script
+  /// export. It must be set up before any symbol is added.
+  const ExportFilter& getExportFilter() const { return m_ExportFilter; }
+  ExportFilter&       getExportFilter()       { return m_ExportFilter; }
+
 /// @}
 /// @name Input Files On The Command Line
 /// @{
@@ -400,7 +420,7 @@ public:
   /// @return The added symbol. If the insertion fails due to the resoluction,
   /// return NULL.
   LDSymbol* AddSymbol(Input& pInput,
-                      const std::string& pName,
+                      const llvm::StringRef& pName,
                       ResolveInfo::Type pType,
                       ResolveInfo::Desc pDesc,
                       ResolveInfo::Binding pBind,
@@ -468,18 +488,46 @@ public:
                                    uint32_t pOffset,
                                    Relocation::Address pAddend = 0);
 
+  /// \struct RelocEntry
+  /// RelocEntry is a decoded relocation entry for AddRelocations().
+  struct RelocEntry
+  {
+    Relocation::Type type;
+    LDSymbol* symbol;
+    uint32_t offset;
+    Relocation::Address addend;
+  };
+
+  typedef std::vector<RelocEntry> RelocEntryList;
+
+  /// AddRelocations - To add all relocation entries of a relocation section
+  /// at once.
+  ///
+  /// The result is the same as calling AddRelocation() for every entry in
+  /// order, but the target section is looked up once, the target fragments
+  /// are found by one forward walk if the offsets are ascending, and no
+  /// intermediate FragmentRef is created.
+  ///
+  /// @param [in] pSection The relocation section. pSection's link should point
+  ///                      to the target section.
+  /// @param [in] pEntries The decoded entries.
+  /// @return The number of added relocations.
+  static size_t AddRelocations(LDSection& pSection,
+                               const RelocEntryList& pEntries);
+
 private:
-  LDSymbol* addSymbolFromObject(const std::string& pName,
+  LDSymbol* addSymbolFromObject(const llvm::StringRef& pName,
                                 ResolveInfo::Type pType,
                                 ResolveInfo::Desc pDesc,
                                 ResolveInfo::Binding pBinding,
                                 ResolveInfo::SizeType pSize,
                                 LDSymbol::ValueType pValue,
                                 FragmentRef* pFragmentRef,
-                                ResolveInfo::Visibility pVisibility);
+                                ResolveInfo::Visibility pVisibility,
+                                unsigned int pOrdinal);
 
   LDSymbol* addSymbolFromDynObj(Input& pInput,
-                                const std::string& pName,
+                                const llvm::StringRef& pName,
                                 ResolveInfo::Type pType,
                                 ResolveInfo::Desc pDesc,
                                 ResolveInfo::Binding pBinding,
@@ -492,6 +540,8 @@ private:
   const LinkerConfig& m_Config;
 
   InputBuilder m_InputBuilder;
+
+  ExportFilter m_ExportFilter;
 };
 
 template<> LDSymbol*
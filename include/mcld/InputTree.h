@@ -18,6 +18,8 @@
 #include <mcld/Support/Path.h>
 
 #include <string>
+#include <vector>
+#include <cassert>
 
 
 namespace mcld {
@@ -73,6 +75,11 @@ public:
  *
  *  InputTree, of course, is uncopyable.
  *
+ *  After the inputs are resolved, freeze() lays the tree out as a preorder
+ *  array of inputs, in which the members of every group and archive are a
+ *  range of indexes. The later phases walk the array instead of chasing the
+ *  nodes, and the parallel ones can cut the work by indexes.
+ *
  *  @see Input
  */
 class InputTree : public BinaryTree<Input>
@@ -129,11 +136,30 @@ public:
     }
   };
 
+  /** \class Range
+   *  \brief Range is the members of a group or an archive in the flat form,
+   *  the indexes [begin, end) of flat(). The archive itself is at begin - 1.
+   */
+  struct Range {
+    enum Kind {
+      Group,
+      Archive
+    };
+
+    Kind kind;
+    size_t begin;
+    size_t end;
+  };
+
+  typedef std::vector<Input*> FlatList;
+  typedef std::vector<Range> RangeList;
+
 public:
   static Succeeder Afterward;
   static Includer  Downward;
 
 public:
+  InputTree();
 
   using BinTreeTy::merge;
 
@@ -156,6 +182,41 @@ public:
   InputTree& enterGroup(TreeIteratorBase pRoot,
                         const Mover& pMover);
 
+  template<size_t DIRECT, class Pos>
+  InputTree& merge(Pos pPosition, InputTree& pTree) {
+    m_bFrozen = false;
+    BinTreeTy::merge<DIRECT>(pPosition, pTree);
+    return *this;
+  }
+
+  // -----  flat form  ----- //
+  /// freeze - lay the inputs out in the order of dfs_iterator, and record
+  /// the members of every group and archive as a range. Any later
+  /// modification thaws the tree, and freeze() must be called again.
+  void freeze();
+
+  bool isFrozen() const { return m_bFrozen; }
+
+  /// flat - the inputs in the order of dfs_iterator, without the group nodes
+  const FlatList& flat() const {
+    assert(m_bFrozen && "the input tree is not frozen");
+    return m_Flat;
+  }
+
+  /// ranges - the groups and archives, a range before its nested ranges
+  const RangeList& ranges() const {
+    assert(m_bFrozen && "the input tree is not frozen");
+    return m_Ranges;
+  }
+
+private:
+  /// flatten - append the nodes from pNode on to the flat form
+  void flatten(NodeBase* pNode);
+
+private:
+  FlatList m_Flat;
+  RangeList m_Ranges;
+  bool m_bFrozen;
 };
 
 bool isGroup(const InputTree::iterator& pos);
@@ -174,6 +235,7 @@ template<size_t DIRECT>
 mcld::InputTree&
 mcld::InputTree::enterGroup(mcld::TreeIteratorBase pRoot)
 {
+  m_bFrozen = false;
   BinTreeTy::node_type* node = createNode();
   if (pRoot.isRoot())
     proxy::hook<TreeIteratorBase::Leftward>(pRoot.m_pNode,
@@ -188,6 +250,7 @@ template<size_t DIRECT>
 mcld::InputTree& mcld::InputTree::insert(mcld::TreeIteratorBase pRoot,
 	                                 mcld::Input& pInput)
 {
+  m_bFrozen = false;
   BinTreeTy::node_type* node = createNode();
   node->data = &pInput;
   if (pRoot.isRoot())
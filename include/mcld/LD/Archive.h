@@ -23,12 +23,14 @@
 
 namespace mcld {
 
+class ArchiveIndex;
 class Input;
 class InputFactory;
 class InputBuilder;
 class AttributeFactory;
 class ContextFactory;
 class MemoryAreaFactory;
+class ThreadPool;
 
 /** \class Archive
  *  \brief This class define the interfacee to Archive files
@@ -40,6 +42,7 @@ public:
   static const char   THIN_MAGIC[];        ///< magic of thin archive
   static const size_t MAGIC_LEN;           ///< length of magic string
   static const char   SVR4_SYMTAB_NAME[];  ///< SVR4 symtab entry name
+  static const char   SYM64_SYMTAB_NAME[]; ///< 64-bit symtab entry name
   static const char   STRTAB_NAME[];       ///< Name of string table
   static const char   PAD[];               ///< inter-file align padding
   static const char   MEMBER_MAGIC[];      ///< fmag field magic #
@@ -63,22 +66,25 @@ private:
     { return (X == Y); }
   };
 
+  /// MurmurHash3 - the 64-bit finalizer of MurmurHash3. The offsets of the
+  /// members over 4 GiB differ only in the high bits, so all 64 bits are
+  /// mixed.
   struct MurmurHash3
   {
-    size_t operator()(uint32_t pKey) const
+    size_t operator()(uint64_t pKey) const
     {
-      pKey ^= pKey >> 16;
-      pKey *= 0x85ebca6b;
-      pKey ^= pKey >> 13;
-      pKey *= 0xc2b2ae35;
-      pKey ^= pKey >> 16;
+      pKey ^= pKey >> 33;
+      pKey *= 0xff51afd7ed558ccdULL;
+      pKey ^= pKey >> 33;
+      pKey *= 0xc4ceb9fe1a85ec53ULL;
+      pKey ^= pKey >> 33;
       return pKey;
     }
   };
 
-  typedef HashEntry<uint32_t,
+  typedef HashEntry<uint64_t,
                     InputTree::iterator,
-                    OffsetCompare<uint32_t> > ObjectMemberEntryType;
+                    OffsetCompare<uint64_t> > ObjectMemberEntryType;
 public:
   typedef HashTable<ObjectMemberEntryType,
                     MurmurHash3,
@@ -112,7 +118,7 @@ public:
     };
 
     Symbol(const char* pName,
-           uint32_t pOffset,
+           uint64_t pOffset,
            enum Status pStatus)
      : name(pName), fileOffset(pOffset), status(pStatus)
     {}
@@ -122,12 +128,15 @@ public:
 
   public:
     std::string name;
-    uint32_t fileOffset;
+    uint64_t fileOffset;
     enum Status status;
   };
 
   typedef std::vector<Symbol*> SymTabType;
 
+  /// kNoSymbol - the index returned by findSymbol() for a missing name
+  static const size_t kNoSymbol = static_cast<size_t>(-1);
+
 public:
   Archive(Input& pInputFile, InputBuilder& pBuilder);
 
@@ -157,11 +166,11 @@ public:
   /// addObjectMember - add a object in the object member map
   /// @param pFileOffset - file offset in symtab represents a object file
   /// @param pIter - the iterator in the input tree built from this archive
-  bool addObjectMember(uint32_t pFileOffset, InputTree::iterator pIter);
+  bool addObjectMember(uint64_t pFileOffset, InputTree::iterator pIter);
 
   /// hasObjectMember - check if a object file is included or not
   /// @param pFileOffset - file offset in symtab represents a object file
-  bool hasObjectMember(uint32_t pFileOffset) const;
+  bool hasObjectMember(uint64_t pFileOffset) const;
 
   /// getArchiveMemberMap - get the map that contains the included archive files
   ArchiveMemberMapType& getArchiveMemberMap();
@@ -191,7 +200,8 @@ public:
   /// getSymbolTable - get the symtab
   const SymTabType& getSymbolTable() const;
 
-  /// setSymTabSize - set the memory size of symtab
+  /// setSymTabSize - set the memory size of symtab, or zero if the archive
+  /// has no armap member
   void setSymTabSize(size_t pSize);
 
   /// getSymTabSize - get the memory size of symtab
@@ -205,14 +215,18 @@ public:
   /// @param pFileOffset - file offset in symtab represents a object file
   void
   addSymbol(const char* pName,
-            uint32_t pFileOffset,
+            uint64_t pFileOffset,
             enum Symbol::Status pStatus = Archive::Symbol::Unknown);
 
+  /// findSymbol - the index of the first armap entry named pName, or
+  /// kNoSymbol if no member in this archive defines pName.
+  size_t findSymbol(const llvm::StringRef& pName) const;
+
   /// getSymbolName - get the symbol name with the given index
-  const std::string& getSymbolName(size_t pSymIdx) const;
+  llvm::StringRef getSymbolName(size_t pSymIdx) const;
 
   /// getObjFileOffset - get the file offset that represent a object file
-  uint32_t getObjFileOffset(size_t pSymIdx) const;
+  uint64_t getObjFileOffset(size_t pSymIdx) const;
 
   /// getSymbolStatus - get the status of a symbol
   enum Symbol::Status getSymbolStatus(size_t pSymIdx) const;
@@ -220,6 +234,21 @@ public:
   /// setSymbolStatus - set the status of a symbol
   void setSymbolStatus(size_t pSymIdx, enum Symbol::Status pStatus);
 
+  /// setIndex - use a cached armap index as the symtab. The symtab and the
+  /// extended name table are not read from the archive any more.
+  void setIndex(const ArchiveIndex& pIndex);
+
+  /// hasIndex - return true if the symtab is a cached armap index
+  bool hasIndex() const
+  { return (NULL != m_pIndex); }
+
+  /// getUndefCursor - the number of the undefined symbols in the NamePool that
+  /// have been looked up in this archive
+  size_t getUndefCursor() const;
+
+  /// setUndefCursor - set the number of the looked up undefined symbols
+  void setUndefCursor(size_t pCursor);
+
   /// getStrTable - get the extended name table
   std::string& getStrTable();
 
@@ -241,9 +270,22 @@ public:
                        const sys::fs::Path& pPath,
                        off_t pFileOffset = 0);
 
+  /// openMemberFiles - open the files of the members of a thin archive
+  /// concurrently on pPool. getMemberFile() finds the opened files later.
+  void openMemberFiles(ThreadPool& pPool,
+                       const std::vector<sys::fs::Path>& pPaths);
+
 private:
   typedef GCFactory<Symbol, 0> SymbolFactory;
 
+  typedef HashEntry<const llvm::StringRef,
+                    size_t,
+                    StringCompare<llvm::StringRef> > SymbolIndexEntryType;
+
+  typedef HashTable<SymbolIndexEntryType,
+                    StringHash<ELF>,
+                    EntryFactory<SymbolIndexEntryType> > SymbolIndexMapType;
+
 private:
   Input& m_ArchiveFile;
   InputTree *m_pInputTree;
@@ -251,6 +293,12 @@ private:
   ArchiveMemberMapType m_ArchiveMemberMap;
   SymbolFactory m_SymbolFactory;
   SymTabType m_SymTab;
+  SymbolIndexMapType m_SymbolIndexMap;
+  const ArchiveIndex* m_pIndex;
+
+  /// m_IndexStatus - the status of symbols in the cached index
+  std::vector<enum Symbol::Status> m_IndexStatus;
+  size_t m_UndefCursor;
   size_t m_SymTabSize;
   std::string m_StrTab;
   InputBuilder& m_Builder;
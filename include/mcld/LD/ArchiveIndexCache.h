@@ -0,0 +1,174 @@
+//===- ArchiveIndexCache.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_ARCHIVE_INDEX_CACHE_H
+#define MCLD_LD_ARCHIVE_INDEX_CACHE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Support/Path.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Archive;
+class FileHandle;
+
+/** \class ArchiveIndex
+ *  \brief ArchiveIndex is a read-only view of a cached armap index.
+ *
+ *  An index holds the armap symbols, a hash table from the symbol names to
+ *  the first symbol of each name, and the extended name table of an archive.
+ *  The layout of an index image is
+ *
+ *    Header | path | Entry[num_of_symbols] | uint32_t[num_of_buckets] |
+ *    extended name table | NUL-terminated symbol names
+ *
+ *  A bucket is zero if it is empty, or the index of a symbol plus one.
+ *  Collisions are resolved by linear probing. All fields are in the byte
+ *  order of the host, and the entries are 8-byte aligned.
+ */
+class ArchiveIndex
+{
+public:
+  struct Header
+  {
+    char     magic[8];
+    uint32_t byte_order;
+    uint32_t num_of_symbols;
+    uint32_t num_of_buckets;
+    uint32_t symtab_size;
+    uint32_t strtab_size;
+    uint32_t path_size;
+    uint64_t file_size;
+    uint64_t mod_time;
+  };
+
+  struct Entry
+  {
+    uint64_t file_offset;
+    uint32_t name;
+    uint32_t reserved;
+  };
+
+  static const char MAGIC[];
+
+public:
+  ArchiveIndex();
+
+  /// map - set up the view on pImage.
+  /// @return false if pImage is not a well-formed index
+  bool map(const void* pImage, size_t pSize);
+
+  /// findSymbol - find the first symbol named pName
+  /// @param pIdx - the index of the found symbol
+  bool findSymbol(const llvm::StringRef& pName, size_t& pIdx) const;
+
+  size_t numOfSymbols() const
+  { return m_pHeader->num_of_symbols; }
+
+  llvm::StringRef getSymbolName(size_t pIdx) const
+  { return llvm::StringRef(m_pNames + m_pEntries[pIdx].name); }
+
+  uint64_t getObjFileOffset(size_t pIdx) const
+  { return m_pEntries[pIdx].file_offset; }
+
+  size_t getSymTabSize() const
+  { return m_pHeader->symtab_size; }
+
+  llvm::StringRef getStrTable() const
+  { return llvm::StringRef(m_pStrTab, m_pHeader->strtab_size); }
+
+  llvm::StringRef getPath() const
+  { return llvm::StringRef(m_pPath, m_pHeader->path_size); }
+
+  uint64_t getFileSize() const
+  { return m_pHeader->file_size; }
+
+  uint64_t getModTime() const
+  { return m_pHeader->mod_time; }
+
+  /// emit - emit the index image of pArchive
+  static void emit(const Archive& pArchive,
+                   const llvm::StringRef& pPath,
+                   uint64_t pFileSize,
+                   uint64_t pModTime,
+                   std::string& pImage);
+
+private:
+  const Header* m_pHeader;
+  const char* m_pPath;
+  const Entry* m_pEntries;
+  const uint32_t* m_pBuckets;
+  const char* m_pStrTab;
+  const char* m_pNames;
+};
+
+/** \class ArchiveIndexCache
+ *  \brief ArchiveIndexCache keeps the armap indexes of archives in a
+ *  directory, so the links using the same archives need not decode their
+ *  armaps and extended name tables again.
+ *
+ *  An archive is keyed by its path, its size and its modification time. The
+ *  cache file of an archive is named by the hash of its real path, and is
+ *  replaced when the archive is changed. A cache file is written into a
+ *  temporary file and then renamed, so concurrent links never see a partial
+ *  index. The loaded indexes are mapped until the cache is destroyed.
+ */
+class ArchiveIndexCache
+{
+public:
+  explicit ArchiveIndexCache(const sys::fs::Path& pDir);
+
+  ~ArchiveIndexCache();
+
+  /// load - set up the symbol table and the extended name table of pArchive
+  /// by its cached index.
+  /// @return false if there is no valid index of pArchive
+  bool load(Archive& pArchive);
+
+  /// store - write the index of pArchive, whose symbol table and extended
+  /// name table are read.
+  bool store(const Archive& pArchive);
+
+private:
+  struct MappedIndex
+  {
+    FileHandle* handle;
+    void* image;
+    ArchiveIndex index;
+  };
+
+  typedef std::vector<MappedIndex*> IndexListType;
+
+private:
+  /// getKey - get the real path, size and modification time of pArchive.
+  /// @return false if pArchive can not be cached
+  bool getKey(const Archive& pArchive,
+              sys::fs::Path& pPath,
+              uint64_t& pFileSize,
+              uint64_t& pModTime) const;
+
+  /// getCachePath - the path of the cache file of the archive in pPath
+  sys::fs::Path getCachePath(const sys::fs::Path& pPath) const;
+
+private:
+  sys::fs::Path m_Dir;
+  IndexListType m_IndexList;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -123,13 +123,13 @@ private:
 
     struct Hash
     {
+      // symbols are compared by identity, so they are hashed by address
+      // instead of by name
       size_t operator() (const Key& KEY) const
       {
-        llvm::StringRef sym_name(KEY.symbol()->name());
-        StringHash<ELF> str_hasher;
-        return (size_t((uintptr_t)KEY.prototype())) ^
-               str_hasher(sym_name) ^
-               KEY.addend();
+        size_t hash = size_t((uintptr_t)KEY.prototype());
+        hash = hash * 31 + (size_t((uintptr_t)KEY.symbol()) >> 3);
+        return hash * 31 + size_t(KEY.addend());
       }
     };
 
@@ -20,6 +20,7 @@ namespace mcld
 {
 
 class Fragment;
+class SectionData;
 
 /** \class BranchIslandFactory
  *  \brief
@@ -45,6 +46,26 @@ public:
   /// @param pFragment - the fragment needs a branch isladn
   BranchIsland* find(const Fragment& pFragment);
 
+  /// findStub - find a stub built from pPrototype for pReloc in any island
+  /// within the branch range of pReloc, forward or backward
+  /// @param pBranchRange - the max distance that pReloc reaches, given by the
+  ///                       target for the type of pReloc
+  Stub* findStub(const Stub* pPrototype,
+                 const Relocation& pReloc,
+                 uint64_t pBranchRange);
+
+  /// plan - produce the islands of pSD at once after the initial layout, one
+  /// at the end of every interval of the branch range. Every branch then has
+  /// an island ahead in its range, and the stubs are assigned to the nearest
+  /// ones in one round of relaxation instead of growing new islands round
+  /// after round. The space of the stubs is reserved by the branch range,
+  /// which is shortened by the max size of an island.
+  /// @return the number of islands produced
+  size_t plan(SectionData& pSD);
+
+  /// hasStubs - is there any stub in the islands?
+  bool hasStubs() const;
+
 private:
   uint64_t m_MaxBranchRange;
   uint64_t m_MaxIslandSize;
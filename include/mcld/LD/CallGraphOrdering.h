@@ -0,0 +1,151 @@
+//===- CallGraphOrdering.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_CALL_GRAPH_ORDERING_H
+#define MCLD_LD_CALL_GRAPH_ORDERING_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class FGNode;
+class FragmentGraph;
+class LDSection;
+class LinkerConfig;
+class Module;
+
+namespace sys {
+namespace fs {
+class Path;
+} // namespace of fs
+} // namespace of sys
+
+/** \class CallGraphOrdering
+ *  \brief Reorder the functions of the executable output sections by the
+ *  call graph, for --call-graph-ordering.
+ *
+ *  The functions are the regular nodes of FragmentGraph, that is, the input
+ *  sections merged into the executable output sections. The weight of a call
+ *  edge is the number of the relocations from the caller to the callee, or
+ *  the count given by --call-graph-profile-file.
+ *
+ *  The functions are clustered by the C3 heuristic of Ottoni and Maher.
+ *  From the hottest function down, a function's cluster is appended to the
+ *  cluster of its heaviest caller, unless the merged cluster would be larger
+ *  than MaxClusterSize. The clusters are then placed by their densities, the
+ *  weight per byte, so the hot code is packed into the fewest pages.
+ *
+ *  CallGraphOrdering must run after mergeSections() and before the
+ *  relocations are scanned, since the fragment offsets change.
+ */
+class CallGraphOrdering
+{
+public:
+  enum { MaxClusterSize = 1024 * 1024 };
+
+  struct Edge
+  {
+    Edge(size_t pFrom, size_t pTo, uint64_t pWeight)
+      : from(pFrom), to(pTo), weight(pWeight) {
+    }
+
+    size_t from;
+    size_t to;
+    uint64_t weight;
+  };
+
+  typedef std::vector<Edge> EdgeListTy;
+
+public:
+  CallGraphOrdering(const LinkerConfig& pConfig, Module& pModule);
+
+  ~CallGraphOrdering();
+
+  /// readProfile - read the profile file
+  /// @return false if the file can not be read
+  bool readProfile(const sys::fs::Path& pPath);
+
+  /// parseProfile - add the `caller callee count' lines of pContent. Empty
+  /// lines are ignored, and the malformed lines are warned.
+  void parseProfile(llvm::StringRef pContent);
+
+  /// run - reorder the fragments of the executable output sections
+  void run();
+
+  /// Sort - cluster and order the functions of sizes pSizes connected by
+  /// pEdges. pOrder is the new order of the function indices.
+  static void Sort(const std::vector<uint64_t>& pSizes,
+                   const EdgeListTy& pEdges,
+                   std::vector<size_t>& pOrder);
+
+  // ----- observers ----- //
+  size_t numOfProfileEntries() const
+  { return m_Profile.size(); }
+
+private:
+  /// ProfileEntry - a line of the profile file
+  struct ProfileEntry
+  {
+    std::string caller;
+    std::string callee;
+    uint64_t count;
+  };
+
+  /// Function - a node of an executable output section
+  struct Function
+  {
+    FGNode* node;
+    LDSection* section;
+    uint64_t size;
+  };
+
+  typedef std::vector<ProfileEntry> ProfileListTy;
+  typedef std::vector<Function> FunctionListTy;
+  typedef llvm::DenseMap<const FGNode*, size_t> FunctionMapTy;
+
+private:
+  /// collectFunctions - collect the nodes of the executable output sections
+  void collectFunctions(FragmentGraph& pGraph);
+
+  /// getRelocationEdges - the edges of the relocation references
+  void getRelocationEdges(FragmentGraph& pGraph, EdgeListTy& pEdges) const;
+
+  /// getProfileEdges - the edges of the profile entries
+  void getProfileEdges(const FragmentGraph& pGraph, EdgeListTy& pEdges) const;
+
+  /// getFunction - the index of the function defining pName, or NoFunction
+  size_t getFunction(const FragmentGraph& pGraph,
+                     const std::string& pName) const;
+
+  /// reorder - move the fragments of the functions into pOrder
+  void reorder(const std::vector<size_t>& pOrder);
+
+private:
+  enum { NoFunction = ~(size_t)0 };
+
+private:
+  const LinkerConfig& m_Config;
+  Module& m_Module;
+  ProfileListTy m_Profile;
+  FunctionListTy m_Functions;
+  FunctionMapTy m_FunctionMap;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,68 @@
+//===- CommonBuckets.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_COMMON_BUCKETS_H
+#define MCLD_LD_COMMON_BUCKETS_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class LDSymbol;
+class SectionData;
+
+/** \class CommonBuckets
+ *  \brief CommonBuckets places the common symbols of one output section by
+ *  their alignments.
+ *
+ *  The symbols are put in the bucket of their alignment as they are added,
+ *  so no comparison sort is needed. allocate() lays out every bucket as one
+ *  FillFragment, from the largest alignment to the smallest, and keeps the
+ *  offsets of the symbols in the fragment in a side table. Since all symbols
+ *  of a bucket have the same alignment, only the sizes are padded, and the
+ *  buckets after the first one need no padding at all.
+ *
+ *  A symbol whose alignment is not a power of two gets its own fragment.
+ */
+class CommonBuckets
+{
+public:
+  CommonBuckets();
+
+  /// add - add a common symbol. The value of a common symbol is its
+  /// alignment.
+  void add(LDSymbol& pSymbol);
+
+  bool empty() const;
+
+  /// allocate - append the fragments of the added symbols to pSD and refer
+  /// the symbols to them.
+  /// @return the size appended to pSD, including the alignment paddings
+  uint64_t allocate(SectionData& pSD);
+
+private:
+  typedef std::vector<LDSymbol*> SymbolList;
+  typedef std::vector<uint64_t> OffsetList;
+
+  /// the buckets of alignments 2^0 to 2^(NumOfBuckets-1)
+  enum { NumOfBuckets = 64 };
+
+private:
+  SymbolList m_Buckets[NumOfBuckets];
+  SymbolList m_Others;
+  OffsetList m_Offsets;
+};
+
+} // namespace of mcld
+
+#endif
@@ -0,0 +1,111 @@
+//===- CompressedSections.h -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_COMPRESSED_SECTIONS_H
+#define MCLD_LD_COMPRESSED_SECTIONS_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class Input;
+class LDSection;
+class RegionFragment;
+class ThreadPool;
+
+/** \class CompressedSections
+ *  \brief CompressedSections keeps the SHF_COMPRESSED input sections.
+ *
+ *  A compressed input section is read as a region fragment of its
+ *  uncompressed size, so its symbols and the relocations against it use the
+ *  uncompressed offsets as usual. The memory of the fragment is allocated but
+ *  not touched until decompress() inflates all sections at once in parallel.
+ *  The sections ignored by then, such as the members of the discarded
+ *  groups, are never inflated.
+ *
+ *  The compressed stream of every section is kept, so the writer can copy
+ *  the stream of a zlib input section which is the only content of an output
+ *  section and is not changed by any relocation, instead of compressing the
+ *  same bytes again.
+ */
+class CompressedSections
+{
+public:
+  /// Type - the ELF ch_type
+  enum Type {
+    Zlib = 1,  ///< ELFCOMPRESS_ZLIB
+    Zstd = 2   ///< ELFCOMPRESS_ZSTD
+  };
+
+  /// Entry - a compressed input section
+  struct Entry
+  {
+    const Input* input;
+    const LDSection* section;
+    Type type;
+    const uint8_t* stream;    ///< the compressed stream, after the Elf_Chdr
+    size_t streamSize;
+    uint8_t* data;            ///< the uncompressed contents
+    size_t size;
+    bool isInflated;
+  };
+
+public:
+  CompressedSections();
+
+  ~CompressedSections();
+
+  /// IsSupported - can the sections compressed by pType be read?
+  static bool IsSupported(uint32_t pType);
+
+  /// append - add the section pSection of pInput, whose pStreamSize bytes of
+  /// pStream are inflated into pSize bytes.
+  /// @return the region fragment of the uncompressed contents
+  Fragment* append(const Input& pInput,
+                   const LDSection& pSection,
+                   Type pType,
+                   const uint8_t* pStream,
+                   size_t pStreamSize,
+                   size_t pSize);
+
+  /// decompress - inflate the sections which are not ignored and not
+  /// inflated yet. The sections are inflated in parallel by pPool.
+  /// @return false if a section can not be inflated. The section is reported
+  /// as a fatal error.
+  bool decompress(ThreadPool& pPool);
+
+  /// find - the entry of the fragment pFrag, or NULL if pFrag is not the
+  /// contents of a compressed section
+  const Entry* find(const Fragment& pFrag) const;
+
+  // -----  observers  ----- //
+  bool empty() const { return m_Entries.empty(); }
+
+  size_t size() const { return m_Entries.size(); }
+
+private:
+  typedef std::vector<Entry> EntryList;
+  typedef llvm::DenseMap<const Fragment*, size_t> FragmentMap;
+
+private:
+  EntryList m_Entries;
+  FragmentMap m_FragmentMap;
+};
+
+} // namespace of mcld
+
+#endif
+
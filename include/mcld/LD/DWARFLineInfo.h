@@ -12,17 +12,72 @@
 #include <gtest.h>
 #endif
 #include <mcld/LD/DiagnosticLineInfo.h>
+#include <mcld/Support/Thread.h>
+
+#include <map>
+#include <string>
+#include <vector>
 
 namespace mcld
 {
 
+class Fragment;
+class LDSection;
+
 /** \class DWARFLineInfo
  *  \brief DWARFLineInfo provides the conversion from address to line of code
  *  by DWARF format.
+ *
+ *  The .debug_line of an input is decoded at the first findLine() in the
+ *  input, and the rows are kept by input, so a link without diagnostics never
+ *  reads .debug_line. The addresses of a relocatable object are section
+ *  relative, so a row is kept as an offset in the fragment which the
+ *  relocation of the DW_LNE_set_address of its sequence refers to. The
+ *  fragments stay when the sections are merged and laid out, and so do the
+ *  rows.
  */
 class DWARFLineInfo : public DiagnosticLineInfo
 {
+public:
+  DWARFLineInfo();
+
+  ~DWARFLineInfo();
+
+  bool findLine(Input& pInput,
+                const FragmentRef& pPlace,
+                std::string& pFile,
+                unsigned int& pLine);
+
+private:
+  /// Row - a row of the line number matrix. A row of line 0 ends a sequence.
+  struct Row {
+    const Fragment* fragment;
+    uint64_t offset;
+    uint32_t file;
+    uint32_t line;
+  };
+
+  struct LineTable {
+    std::vector<std::string> files;
+    std::vector<Row> rows;
+  };
+
+  typedef std::map<const Input*, LineTable*> TableMap;
+
+private:
+  /// getTable - the line table of pInput, decoded at the first call
+  const LineTable& getTable(Input& pInput);
+
+  /// ReadTable - decode the line number programs of pDebugLine of pInput
+  static void ReadTable(Input& pInput,
+                        const LDSection& pDebugLine,
+                        LineTable& pTable);
+
+  static bool IsBefore(const Row& pX, const Row& pY);
 
+private:
+  TableMap m_Tables;
+  sys::Mutex m_Lock;
 };
 
 } // namespace of mcld
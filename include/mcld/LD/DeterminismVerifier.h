@@ -0,0 +1,69 @@
+//===- DeterminismVerifier.h ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_DETERMINISM_VERIFIER_H
+#define MCLD_LD_DETERMINISM_VERIFIER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+class LinkerConfig;
+
+/** \class DeterminismVerifier
+ *  \brief DeterminismVerifier compares the output of a parallel link with
+ *  the output of the same link by the serial scheduler, for
+ *  --verify-determinism.
+ *
+ *  Every section of the outputs is hashed by itself, and the sections with
+ *  different hashes are reported. For the first one, the first different
+ *  byte is located in the symbol and the relocation of the serial output
+ *  which cover it. The ELF header and the section header table are compared
+ *  as well. An output which is not ELF is compared as a whole.
+ */
+class DeterminismVerifier
+{
+public:
+  explicit DeterminismVerifier(const LinkerConfig& pConfig);
+
+  ~DeterminismVerifier();
+
+  /// verify - compare the output pActual of the link with pExpected, the
+  /// output of the serial link, and report the differences.
+  /// @return true if the outputs are identical
+  bool verify(const uint8_t* pExpected, size_t pExpectedSize,
+              const uint8_t* pActual, size_t pActualSize) const;
+
+private:
+  template<size_t SIZE>
+  bool doVerify(const uint8_t* pExpected, size_t pExpectedSize,
+                const uint8_t* pActual, size_t pActualSize) const;
+
+  /// reportPlace - report the symbol and the relocation of the serial
+  /// output pImage that cover the offset pOffset of section pIdx
+  template<size_t SIZE>
+  void reportPlace(const uint8_t* pImage, size_t pSize,
+                   unsigned int pIdx, uint64_t pOffset) const;
+
+  /// isValid - can the ELF header and the section headers of pImage be read?
+  template<size_t SIZE>
+  static bool isValid(const uint8_t* pImage, size_t pSize);
+
+private:
+  const LinkerConfig& m_Config;
+};
+
+} // namespace of mcld
+
+#endif
+
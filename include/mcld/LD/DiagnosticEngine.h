@@ -12,8 +12,10 @@
 #include <gtest.h>
 #endif
 #include <string>
+#include <vector>
 #include <llvm/Support/DataTypes.h>
 #include <mcld/LD/DiagnosticInfos.h>
+#include <mcld/Support/Thread.h>
 
 namespace mcld {
 
@@ -33,6 +35,21 @@ class DiagnosticLineInfo;
  *  DiagnosticEngine is a complex class, it is responsible for
  *  - remember the argument string for MsgHandler
  *  - choice the severity of a message by options
+ *
+ *  report() locks the engine until the returned MsgHandler emits the
+ *  message, so the threads of the linker report their messages one by one.
+ *  A message must not be reported while the arguments of another message
+ *  are being given in the same thread.
+ *
+ *  Between beginBuffer() and endBuffer(), the messages are not locked and
+ *  printed, but kept in a buffer of the reporting thread. Each message is
+ *  tagged with the phase and the ordinal of the thread, and endBuffer(), the
+ *  barrier of the parallel phase, prints them in the order of the phases and
+ *  the ordinals, which does not depend on the scheduling. Fatal messages are
+ *  never buffered, since they end the link.
+ *
+ *  A message which the printer ignores is dropped by report() at once, and
+ *  its MsgHandler does nothing with the arguments.
  */
 class DiagnosticEngine
 {
@@ -65,6 +82,10 @@ public:
 
   void setLineInfo(DiagnosticLineInfo& pLineInfo);
 
+  /// getLineInfo - the line information of the inputs, or NULL if the target
+  /// has none
+  DiagnosticLineInfo* getLineInfo() { return m_pLineInfo; }
+
   void setPrinter(DiagnosticPrinter& pPrinter, bool pShouldOwnPrinter = true);
 
   const DiagnosticPrinter* getPrinter() const { return m_pPrinter; }
@@ -83,8 +104,29 @@ public:
   // emit - process the message to printer
   bool emit();
 
-  // report - issue the message to the printer
-  MsgHandler report(uint16_t pID, Severity pSeverity);
+  // report - issue the message to the printer. With pInLoC, the message is
+  // described with the source location given by its arguments.
+  MsgHandler report(uint16_t pID, Severity pSeverity, bool pInLoC = false);
+
+  /// isIgnored - whether report() drops the message pID. The callers check
+  /// it before they look for the source location of a message.
+  bool isIgnored(uint16_t pID) const;
+
+  // -----  buffering  ----- //
+  /// beginBuffer - buffer the messages of a parallel phase. The phases begun
+  /// before endBuffer() are printed one after another.
+  void beginBuffer();
+
+  /// setOrdinal - tag the following messages of the calling thread with
+  /// pOrdinal, such as the index of an input or a relocation.
+  void setOrdinal(size_t pOrdinal);
+
+  /// endBuffer - print the buffered messages in order, and stop buffering.
+  /// It must be called when no other thread reports a message.
+  void endBuffer();
+
+  bool isBuffered() const
+  { return m_bBuffered; }
 
 private:
   friend class MsgHandler;
@@ -99,13 +141,15 @@ private:
   struct State
   {
   public:
-    State() : numArgs(0), ID(-1), severity(None), file(NULL) { }
+    State()
+      : numArgs(0), ID(-1), severity(None), inLoC(false), file(NULL) { }
     ~State() { }
 
     void reset() {
       numArgs = 0;
       ID = -1;
       severity = None;
+      inLoC = false;
       file = NULL;
     }
 
@@ -116,9 +160,26 @@ private:
     int8_t numArgs;
     uint16_t ID;
     Severity severity;
+    bool inLoC;
     Input* file;
   };
 
+  /// Message - a buffered message
+  struct Message
+  {
+    unsigned int phase;
+    size_t ordinal;
+    State state;
+  };
+
+  /// Buffer - the messages of a thread
+  struct Buffer
+  {
+    State state;  ///< the message being reported
+    size_t ordinal;
+    std::vector<Message> messages;
+  };
+
 private:
   State& state()
   { return m_State; }
@@ -136,6 +197,15 @@ private:
     return *m_pInfoMap;
   }
 
+  /// emit - emit the message of pState, the state of the engine or of the
+  /// buffer of the calling thread
+  bool emit(State& pState);
+
+  /// getBuffer - the buffer of the calling thread
+  Buffer& getBuffer();
+
+  static bool isBefore(const Message* pX, const Message* pY);
+
 private:
   const LinkerConfig* m_pConfig;
   DiagnosticLineInfo* m_pLineInfo;
@@ -144,6 +214,13 @@ private:
   bool m_OwnPrinter;
 
   State m_State;
+  sys::Mutex m_Mutex;
+
+  bool m_bBuffered;
+  unsigned int m_Phase;
+  sys::ThreadLocal m_CurBuffer;
+  std::vector<Buffer*> m_Buffers;  ///< guarded by m_BufferLock
+  sys::Mutex m_BufferLock;
 };
 
 } // namespace of mcld
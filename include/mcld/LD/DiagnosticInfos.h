@@ -44,8 +44,15 @@ public:
 
   llvm::StringRef getDescription(unsigned int pID, bool pLoC) const;
 
+  /// isIgnored - whether the printer of pEngine does nothing for the
+  /// message pID under the options
+  bool isIgnored(const DiagnosticEngine& pEngine, unsigned int pID) const;
+
   bool process(DiagnosticEngine& pEngine) const;
 
+private:
+  unsigned int getSeverity(unsigned int pID) const;
+
 private:
   const LinkerConfig& m_Config;
 };
@@ -12,15 +12,35 @@
 #include <gtest.h>
 #endif
 
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+
 namespace mcld
 {
 
+class FragmentRef;
+class Input;
+
 /** \class DiagnosticLineInfo
  *  \brief Map the address to the line of code.
+ *
+ *  The line information is only looked up when a diagnostic is issued, so
+ *  the implementations read the debugging information of an input at the
+ *  first lookup in it, and keep it for the following ones.
  */
 class DiagnosticLineInfo
 {
+public:
+  virtual ~DiagnosticLineInfo() { }
 
+  /// findLine - find the source file and the line of the code at pPlace,
+  /// a place in a section of pInput
+  /// @return false if there is no line information of the code
+  virtual bool findLine(Input& pInput,
+                        const FragmentRef& pPlace,
+                        std::string& pFile,
+                        unsigned int& pLine) = 0;
 };
 
 } // namespace of mcld
@@ -42,6 +42,12 @@ public:
   virtual void handleDiagnostic(DiagnosticEngine::Severity pSeverity,
                                 const Diagnostic& pInfo);
 
+  /// isIgnored - whether handleDiagnostic() does nothing for a message of
+  /// pSeverity. The messages ignored are dropped before their arguments are
+  /// given.
+  virtual bool isIgnored(DiagnosticEngine::Severity pSeverity) const
+  { return false; }
+
   unsigned int getNumErrors() const { return m_NumErrors; }
   unsigned int getNumWarnings() const { return m_NumWarnings; }
 
@@ -13,11 +13,15 @@
 #endif
 #include "mcld/LD/LDReader.h"
 #include <llvm/Support/system_error.h>
+#include <cstddef>
 
 namespace mcld {
 
 class TargetLDBackend;
 class Input;
+class Module;
+class NamePool;
+class ResolveInfo;
 
 /** \class DynObjReader
  *  \brief DynObjReader provides an common interface for different object
@@ -32,10 +36,40 @@ protected:
 public:
   virtual ~DynObjReader() { }
 
+  /// preload - read the headers and the symbol table of the file into memory
+  /// without creating any IR. This function may be called concurrently on
+  /// the files which have distinct MemoryAreas.
+  ///   @return true if the file is in my format.
+  virtual bool preload(Input& pFile) = 0;
+
+  /// numOfGlobalSymbols - the number of non-local symbols of the file, which
+  /// is known as soon as the section header table is read.
+  ///   @return 0 if the file is not in my format or has no symbol table.
+  virtual size_t numOfGlobalSymbols(Input& pFile) = 0;
+
   virtual bool readHeader(Input& pFile) = 0;
 
   virtual bool readSymbols(Input& pFile) = 0;
 
+  /// importSymbol - read the definition of the undefined symbol pInfo from
+  /// the libraries whose symbols are read lazily by readSymbols(). The
+  /// libraries are searched in the order of reading.
+  ///   @return true if a library defines the symbol.
+  virtual bool importSymbol(const ResolveInfo& pInfo)
+  { return false; }
+
+  /// importSymbols - import the undefined symbols appended to the undef list
+  /// of pPool, after all inputs are read. The lazily read libraries are
+  /// released, and importSymbol() imports nothing after it.
+  virtual void importSymbols(const NamePool& pPool)
+  { }
+
+  /// readDependencies - resolve the regular references which are still
+  /// undefined by the DT_NEEDED libraries of the shared objects of pModule
+  /// which are not inputs. The libraries are read only if such a reference
+  /// is left. By default, nothing is read.
+  virtual void readDependencies(Module& pModule)
+  { }
 };
 
 } // namespace of mcld
@@ -0,0 +1,206 @@
+//===- DynObjSummary.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_DYNOBJ_SUMMARY_H
+#define MCLD_LD_DYNOBJ_SUMMARY_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/Support/Path.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class FileHandle;
+class Input;
+
+/** \class DynObjSummary
+ *  \brief DynObjSummary is a read-only view of the summary of a shared
+ *  object: its SONAME and the symbols it exports or refers to, already
+ *  decoded in the terms of ResolveInfo.
+ *
+ *  The defined symbols are found by a minimal perfect hash of their names.
+ *  Every name hashes into a group, and the displacement of the group selects
+ *  the slot of the name, so a name is found by two hashes and one compare.
+ *  The layout of a summary image is
+ *
+ *    Header | path | soname | Entry[num_of_symbols] |
+ *    uint32_t[num_of_groups] | uint32_t[num_of_slots] | names
+ *
+ *  Every part starts at an 8-byte boundary. A slot is zero if it is empty,
+ *  or the index of a symbol plus one. All fields are in the byte order of
+ *  the host.
+ */
+class DynObjSummary
+{
+public:
+  struct Header
+  {
+    char     magic[8];
+    uint32_t byte_order;
+    uint32_t num_of_symbols;
+    uint32_t num_of_groups;
+    uint32_t num_of_slots;
+    uint32_t path_size;
+    uint32_t soname_size;
+    uint64_t file_size;
+    uint64_t mod_time;
+  };
+
+  struct Entry
+  {
+    uint32_t name;
+    uint8_t  type;
+    uint8_t  desc;
+    uint8_t  binding;
+    uint8_t  visibility;
+    uint64_t size;
+    uint64_t value;
+  };
+
+  /// Symbol - a symbol to emit, in the order of the symbol table
+  struct Symbol
+  {
+    llvm::StringRef name;
+    ResolveInfo::Type type;
+    ResolveInfo::Desc desc;
+    ResolveInfo::Binding binding;
+    ResolveInfo::Visibility visibility;
+    uint64_t size;
+    uint64_t value;
+  };
+
+  typedef std::vector<Symbol> SymbolList;
+
+  static const char MAGIC[];
+
+public:
+  DynObjSummary();
+
+  /// map - set up the view on pImage.
+  /// @return false if pImage is not a well-formed summary
+  bool map(const void* pImage, size_t pSize);
+
+  /// findDefined - find the first defined symbol named pName
+  /// @return the index of the symbol, or numOfSymbols() if there is none
+  size_t findDefined(const llvm::StringRef& pName) const;
+
+  size_t numOfSymbols() const
+  { return m_pHeader->num_of_symbols; }
+
+  llvm::StringRef getName(size_t pIdx) const
+  { return llvm::StringRef(m_pNames + m_pEntries[pIdx].name); }
+
+  const Entry& getEntry(size_t pIdx) const
+  { return m_pEntries[pIdx]; }
+
+  bool isUndefined(size_t pIdx) const
+  { return (ResolveInfo::Undefined == m_pEntries[pIdx].desc); }
+
+  llvm::StringRef getPath() const
+  { return llvm::StringRef(m_pPath, m_pHeader->path_size); }
+
+  llvm::StringRef getSOName() const
+  { return llvm::StringRef(m_pSOName, m_pHeader->soname_size); }
+
+  uint64_t getFileSize() const
+  { return m_pHeader->file_size; }
+
+  uint64_t getModTime() const
+  { return m_pHeader->mod_time; }
+
+  /// emit - emit the summary image of a shared object
+  /// @return false if the perfect hash can not be built
+  static bool emit(const SymbolList& pSymbols,
+                   const llvm::StringRef& pSOName,
+                   const llvm::StringRef& pPath,
+                   uint64_t pFileSize,
+                   uint64_t pModTime,
+                   std::string& pImage);
+
+private:
+  /// group - the group of pName
+  static uint32_t group(const llvm::StringRef& pName, uint32_t pNumOfGroups);
+
+  /// slot - the slot of pName displaced by pDisplacement
+  static uint32_t slot(const llvm::StringRef& pName,
+                       uint32_t pDisplacement,
+                       uint32_t pNumOfSlots);
+
+private:
+  const Header* m_pHeader;
+  const char* m_pPath;
+  const char* m_pSOName;
+  const Entry* m_pEntries;
+  const uint32_t* m_pGroups;
+  const uint32_t* m_pSlots;
+  const char* m_pNames;
+};
+
+/** \class DynObjSummaryCache
+ *  \brief DynObjSummaryCache keeps the summaries of shared objects in a
+ *  directory, so the links using the same shared objects need not read
+ *  their section headers, .dynamic and .dynsym again.
+ *
+ *  A shared object is keyed by its path, its size and its modification
+ *  time, like ArchiveIndexCache. The loaded summaries are mapped until the
+ *  cache is destroyed.
+ */
+class DynObjSummaryCache
+{
+public:
+  explicit DynObjSummaryCache(const sys::fs::Path& pDir);
+
+  ~DynObjSummaryCache();
+
+  /// load - map the summary of pInput
+  /// @return the summary, or NULL if there is no valid summary of pInput
+  const DynObjSummary* load(const Input& pInput);
+
+  /// store - write the summary of pInput from pSymbols
+  bool store(const Input& pInput,
+             const DynObjSummary::SymbolList& pSymbols,
+             const llvm::StringRef& pSOName);
+
+private:
+  struct MappedSummary
+  {
+    FileHandle* handle;
+    void* image;
+    DynObjSummary summary;
+  };
+
+  typedef std::vector<MappedSummary*> SummaryListType;
+
+private:
+  /// getKey - get the real path, size and modification time of pInput.
+  /// @return false if pInput can not be cached
+  bool getKey(const Input& pInput,
+              sys::fs::Path& pPath,
+              uint64_t& pFileSize,
+              uint64_t& pModTime) const;
+
+  /// getCachePath - the path of the summary of the file in pPath
+  sys::fs::Path getCachePath(const sys::fs::Path& pPath) const;
+
+private:
+  sys::fs::Path m_Dir;
+  SummaryListType m_SummaryList;
+};
+
+} // namespace of mcld
+
+#endif
+
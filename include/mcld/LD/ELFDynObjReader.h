@@ -14,6 +14,10 @@
 #include <mcld/LD/DynObjReader.h>
 #include <llvm/Support/system_error.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace mcld {
 
 class Input;
@@ -21,10 +25,39 @@ class LinkerConfig;
 class IRBuilder;
 class GNULDBackend;
 class ELFReaderIF;
+class ELFDynSymbolIndex;
+class DynObjSummary;
+class DynObjSummaryCache;
+class LDSection;
+class MemoryRegion;
+class Module;
+
+namespace sys {
+namespace fs {
+class Path;
+} // namespace of fs
+} // namespace of sys
 
 /** \class ELFDynObjReader
  *  \brief ELFDynObjReader reads ELF dynamic shared objects.
  *
+ *  With --lazy-shared-symbols, readSymbols() reads only the undefined
+ *  symbols of a library which has .gnu.hash or .hash, and keeps its .dynsym
+ *  mapped. The defined symbols are read by importSymbol() when they resolve
+ *  undefined references, so the NamePool never holds the unreferenced
+ *  symbols of big libraries such as libc.
+ *
+ *  With --dynobj-summary-cache, the SONAME and the decoded .dynsym of a
+ *  library are written to a summary in the cache directory the first time
+ *  the library is read. Later links map the summary instead of reading the
+ *  section headers, .dynamic and .dynsym of the library, and look up the
+ *  lazy symbols by the perfect hash of the summary.
+ *
+ *  The DT_NEEDED libraries of the shared objects are not inputs, and are
+ *  read by readDependencies() only if an executable has references which no
+ *  input defines. A library is found in the -rpath-link directories and
+ *  then in the -L directories, and only the summary of its .dynsym is kept,
+ *  once per link and in the summary cache.
  */
 class ELFDynObjReader : public DynObjReader
 {
@@ -38,13 +71,103 @@ public:
   bool isMyFormat(Input &pFile) const;
 
   // -----  readers  ----- //
+  bool preload(Input& pFile);
+
+  size_t numOfGlobalSymbols(Input& pFile);
+
   bool readHeader(Input& pFile);
 
   bool readSymbols(Input& pInput);
 
+  bool importSymbol(const ResolveInfo& pInfo);
+
+  void importSymbols(const NamePool& pPool);
+
+  void readDependencies(Module& pModule);
+
+private:
+  /// LazyLibrary - a library whose defined symbols are read by need
+  struct LazyLibrary
+  {
+    Input* input;
+    MemoryRegion* symtab;
+    MemoryRegion* strtab;
+    MemoryRegion* hashtab;
+    ELFDynSymbolIndex* index;
+    const DynObjSummary* summary;
+  };
+
+  typedef std::vector<LazyLibrary> LazyLibraryList;
+
+  typedef std::map<const Input*, const DynObjSummary*> SummaryMap;
+
+  typedef std::vector<std::string> NeededList;
+
+  typedef std::map<const Input*, NeededList> NeededMap;
+
+  /// Dependency - a DT_NEEDED library read by readDependencies(). The input
+  /// is NULL if the library can not be found or read.
+  struct Dependency
+  {
+    Input* input;
+    const DynObjSummary* summary;
+  };
+
+  typedef std::map<std::string, Dependency> DependencyMap;
+
+  /// OwnedSummary - the summary of a dependency built in the memory
+  struct OwnedSummary;
+
+  typedef std::vector<OwnedSummary*> OwnedSummaryList;
+
+private:
+  /// readLazySymbols - read the undefined symbols of pInput, and index the
+  /// others by its hash table.
+  /// @return false if pInput has no usable hash table
+  bool readLazySymbols(Input& pInput,
+                       LDSection& pSymTab,
+                       LDSection& pStrTab);
+
+  /// readSummarySymbols - read the symbols of pInput from its summary
+  void readSummarySymbols(Input& pInput, const DynObjSummary& pSummary);
+
+  /// addSummarySymbol - add the pIdx-th symbol of pSummary by m_Builder
+  void addSummarySymbol(Input& pInput,
+                        const DynObjSummary& pSummary,
+                        size_t pIdx);
+
+  /// storeSummary - write the summary of pInput into the cache
+  void storeSummary(Input& pInput,
+                    const MemoryRegion& pSymTab,
+                    const char* pStrTab);
+
+  /// getNeeded - the DT_NEEDED libraries of pInput
+  const NeededList& getNeeded(Input& pInput);
+
+  /// findDependency - find the DT_NEEDED library pName
+  bool findDependency(const std::string& pName, sys::fs::Path& pPath) const;
+
+  /// loadDependency - read the header and the symbol summary of the
+  /// DT_NEEDED library pName, or get it from the earlier reading
+  /// @return NULL if the library can not be found or read
+  const Dependency* loadDependency(const std::string& pName,
+                                   Module& pModule);
+
+  /// summarize - build the summary of the .dynsym of pInput in the memory
+  const DynObjSummary* summarize(Input& pInput);
+
 private:
   ELFReaderIF *m_pELFReader;
   IRBuilder& m_Builder;
+  const LinkerConfig& m_Config;
+  unsigned int m_BitClass;
+  bool m_bLazy;
+  LazyLibraryList m_LazyLibraries;
+  DynObjSummaryCache* m_pSummaryCache;
+  SummaryMap m_Summaries;
+  NeededMap m_Needed;
+  DependencyMap m_Dependencies;
+  OwnedSummaryList m_OwnedSummaries;
 };
 
 } // namespace of mcld
@@ -0,0 +1,107 @@
+//===- ELFDynSymbolIndex.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_ELF_DYNAMIC_SYMBOL_INDEX_H
+#define MCLD_ELF_DYNAMIC_SYMBOL_INDEX_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+/** \class ELFDynSymbolIndex
+ *  \brief ELFDynSymbolIndex looks up the symbols of a shared object by the
+ *  hash table the object carries for the dynamic linker, either .gnu.hash
+ *  (DT_GNU_HASH) or .hash (DT_HASH), without reading the other symbols of
+ *  .dynsym.
+ *
+ *  ELFDynSymbolIndex only refers to the mapped sections. The sections must
+ *  outlive the index. An index over a malformed table is not valid, and
+ *  finds nothing.
+ */
+class ELFDynSymbolIndex
+{
+public:
+  enum Kind {
+    SysV, ///< .hash
+    GNU   ///< .gnu.hash
+  };
+
+public:
+  /// ELFDynSymbolIndex
+  /// @param pBitClass - 32 or 64, the ELF class of the symbol table
+  ELFDynSymbolIndex(Kind pKind,
+                    unsigned int pBitClass,
+                    const uint8_t* pHashTab, size_t pHashSize,
+                    const uint8_t* pSymTab, size_t pSymSize,
+                    const char* pStrTab, size_t pStrSize);
+
+  /// isValid - the hash table is well-formed
+  bool isValid() const { return m_bValid; }
+
+  /// numOfSymbols - the number of the symbols in .dynsym
+  size_t numOfSymbols() const { return m_NumOfSymbols; }
+
+  /// isUndefined - the pIdx-th symbol is undefined in the object
+  bool isUndefined(size_t pIdx) const;
+
+  /// findDefined - find the symbol named pName which is defined in the
+  /// object, i.e., whose st_shndx is not SHN_UNDEF.
+  /// @return the index of the symbol in .dynsym, or 0 if there is none
+  size_t findDefined(const llvm::StringRef& pName) const;
+
+  /// SysVHash - the hash function of .hash
+  static uint32_t SysVHash(const llvm::StringRef& pName);
+
+  /// GNUHash - the hash function of .gnu.hash
+  static uint32_t GNUHash(const llvm::StringRef& pName);
+
+private:
+  size_t findSysV(const llvm::StringRef& pName) const;
+
+  size_t findGNU(const llvm::StringRef& pName) const;
+
+  /// isMatched - the pIdx-th symbol is named pName and defined
+  bool isMatched(size_t pIdx, const llvm::StringRef& pName) const;
+
+  /// symbol - the pIdx-th entry of .dynsym
+  const uint8_t* symbol(size_t pIdx) const;
+
+  uint32_t word(size_t pIdx) const;
+
+  uint64_t bloomWord(size_t pIdx) const;
+
+private:
+  Kind m_Kind;
+  unsigned int m_BitClass;
+  const uint8_t* m_pHashTab;
+  size_t m_HashSize;
+  const uint8_t* m_pSymTab;
+  size_t m_NumOfSymbols;
+  const char* m_pStrTab;
+  size_t m_StrSize;
+  bool m_bValid;
+
+  // the header of the hash table
+  uint32_t m_NumOfBuckets;
+  uint32_t m_NumOfChains;  ///< .hash only
+  uint32_t m_SymOffset;    ///< .gnu.hash only
+  uint32_t m_BloomSize;    ///< .gnu.hash only
+  uint32_t m_BloomShift;   ///< .gnu.hash only
+  size_t m_BucketOffset;   ///< in words
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,331 @@
+//===- ELFFile.h ----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_ELF_FILE_H
+#define MCLD_LD_ELF_FILE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/SizeTraits.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryView.h>
+
+#include <llvm/Support/DataTypes.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+
+#include <cstring>
+
+namespace mcld {
+namespace elf {
+
+//===----------------------------------------------------------------------===//
+// Fields
+//===----------------------------------------------------------------------===//
+inline uint8_t  SwapBytes(uint8_t pValue)  { return pValue; }
+inline uint16_t SwapBytes(uint16_t pValue) { return mcld::bswap16(pValue); }
+inline uint32_t SwapBytes(uint32_t pValue) { return mcld::bswap32(pValue); }
+inline uint64_t SwapBytes(uint64_t pValue) { return mcld::bswap64(pValue); }
+
+inline int32_t SwapBytes(int32_t pValue)
+{ return static_cast<int32_t>(mcld::bswap32(static_cast<uint32_t>(pValue))); }
+
+inline int64_t SwapBytes(int64_t pValue)
+{ return static_cast<int64_t>(mcld::bswap64(static_cast<uint64_t>(pValue))); }
+
+/** \class Field
+ *  \brief Field is a field of type T stored in the little endian if LITTLE is
+ *  true, or in the big endian otherwise.
+ *
+ *  The byte order of the host is known at compile time, so reading a field of
+ *  the same byte order is a plain load, and the other is a load and a swap.
+ */
+template<typename T, bool LITTLE>
+class Field
+{
+public:
+  typedef T value_type;
+
+public:
+  T value() const
+  {
+    if (LITTLE == llvm::sys::IsLittleEndianHost)
+      return m_Value;
+    return SwapBytes(m_Value);
+  }
+
+  operator T() const { return value(); }
+
+private:
+  T m_Value;
+};
+
+/** \class ELFTypes
+ *  \brief ELFTypes gives the field types of an ELF class. Xword and Sxword
+ *  are the fields which are words in ELF32 and extended words in ELF64, such
+ *  as sh_size and r_addend.
+ */
+template<unsigned int BITS, bool LITTLE>
+struct ELFTypes;
+
+template<bool LITTLE>
+struct ELFTypes<32, LITTLE>
+{
+  typedef Field<uint16_t, LITTLE> Half;
+  typedef Field<uint32_t, LITTLE> Word;
+  typedef Field<int32_t,  LITTLE> Sword;
+  typedef Field<uint32_t, LITTLE> Xword;
+  typedef Field<int32_t,  LITTLE> Sxword;
+  typedef Field<uint32_t, LITTLE> Addr;
+  typedef Field<uint32_t, LITTLE> Off;
+};
+
+template<bool LITTLE>
+struct ELFTypes<64, LITTLE>
+{
+  typedef Field<uint16_t, LITTLE> Half;
+  typedef Field<uint32_t, LITTLE> Word;
+  typedef Field<int32_t,  LITTLE> Sword;
+  typedef Field<uint64_t, LITTLE> Xword;
+  typedef Field<int64_t,  LITTLE> Sxword;
+  typedef Field<uint64_t, LITTLE> Addr;
+  typedef Field<uint64_t, LITTLE> Off;
+};
+
+//===----------------------------------------------------------------------===//
+// Structures
+//===----------------------------------------------------------------------===//
+template<unsigned int BITS, bool LITTLE>
+struct Ehdr
+{
+  typedef ELFTypes<BITS, LITTLE> Types;
+
+  unsigned char           e_ident[llvm::ELF::EI_NIDENT];
+  typename Types::Half    e_type;
+  typename Types::Half    e_machine;
+  typename Types::Word    e_version;
+  typename Types::Addr    e_entry;
+  typename Types::Off     e_phoff;
+  typename Types::Off     e_shoff;
+  typename Types::Word    e_flags;
+  typename Types::Half    e_ehsize;
+  typename Types::Half    e_phentsize;
+  typename Types::Half    e_phnum;
+  typename Types::Half    e_shentsize;
+  typename Types::Half    e_shnum;
+  typename Types::Half    e_shstrndx;
+};
+
+template<unsigned int BITS, bool LITTLE>
+struct Shdr
+{
+  typedef ELFTypes<BITS, LITTLE> Types;
+
+  typename Types::Word    sh_name;
+  typename Types::Word    sh_type;
+  typename Types::Xword   sh_flags;
+  typename Types::Addr    sh_addr;
+  typename Types::Off     sh_offset;
+  typename Types::Xword   sh_size;
+  typename Types::Word    sh_link;
+  typename Types::Word    sh_info;
+  typename Types::Xword   sh_addralign;
+  typename Types::Xword   sh_entsize;
+};
+
+/// Sym - the order of the fields differs between the classes
+template<unsigned int BITS, bool LITTLE>
+struct Sym;
+
+template<bool LITTLE>
+struct Sym<32, LITTLE>
+{
+  typedef ELFTypes<32, LITTLE> Types;
+
+  typename Types::Word    st_name;
+  typename Types::Addr    st_value;
+  typename Types::Word    st_size;
+  unsigned char           st_info;
+  unsigned char           st_other;
+  typename Types::Half    st_shndx;
+};
+
+template<bool LITTLE>
+struct Sym<64, LITTLE>
+{
+  typedef ELFTypes<64, LITTLE> Types;
+
+  typename Types::Word    st_name;
+  unsigned char           st_info;
+  unsigned char           st_other;
+  typename Types::Half    st_shndx;
+  typename Types::Addr    st_value;
+  typename Types::Xword   st_size;
+};
+
+/// RelInfo - decode r_info
+template<unsigned int BITS>
+struct RelInfo;
+
+template<>
+struct RelInfo<32>
+{
+  static uint32_t Sym(uint64_t pInfo)  { return (pInfo >> 8); }
+  static uint32_t Type(uint64_t pInfo) { return (pInfo & 0xFF); }
+};
+
+template<>
+struct RelInfo<64>
+{
+  static uint32_t Sym(uint64_t pInfo)  { return (pInfo >> 32); }
+  static uint32_t Type(uint64_t pInfo) { return (pInfo & 0xFFFFFFFF); }
+};
+
+template<unsigned int BITS, bool LITTLE>
+struct Rel
+{
+  typedef ELFTypes<BITS, LITTLE> Types;
+
+  typename Types::Addr    r_offset;
+  typename Types::Xword   r_info;
+
+  uint32_t getSymbol() const { return RelInfo<BITS>::Sym(r_info); }
+  uint32_t getType() const   { return RelInfo<BITS>::Type(r_info); }
+};
+
+template<unsigned int BITS, bool LITTLE>
+struct Rela
+{
+  typedef ELFTypes<BITS, LITTLE> Types;
+
+  typename Types::Addr    r_offset;
+  typename Types::Xword   r_info;
+  typename Types::Sxword  r_addend;
+
+  uint32_t getSymbol() const { return RelInfo<BITS>::Sym(r_info); }
+  uint32_t getType() const   { return RelInfo<BITS>::Type(r_info); }
+};
+
+template<unsigned int BITS, bool LITTLE>
+struct Dyn
+{
+  typedef ELFTypes<BITS, LITTLE> Types;
+
+  typename Types::Sxword  d_tag;
+  typename Types::Xword   d_val;
+};
+
+} // namespace of elf
+
+/** \class ELFFile
+ *  \brief ELFFile is a read-only view of the ELF file at an offset of a
+ *  MemoryArea, such as an input object or an archive member.
+ *
+ *  The structures are read in place through MemoryViews, so nothing is
+ *  copied if the file is mapped. Out-of-range tables are returned as NULL.
+ */
+template<unsigned int BITS, bool LITTLE>
+class ELFFile
+{
+public:
+  typedef elf::Ehdr<BITS, LITTLE> Ehdr;
+  typedef elf::Shdr<BITS, LITTLE> Shdr;
+  typedef elf::Sym<BITS, LITTLE>  Sym;
+  typedef elf::Rel<BITS, LITTLE>  Rel;
+  typedef elf::Rela<BITS, LITTLE> Rela;
+  typedef elf::Dyn<BITS, LITTLE>  Dyn;
+
+public:
+  ELFFile(MemoryArea& pArea, size_t pBase)
+    : m_pArea(&pArea), m_Base(pBase), m_pHeader(NULL), m_pShdrTab(NULL),
+      m_NumOfSections(0), m_ShStrNdx(0) {
+    m_pHeader = reinterpret_cast<const Ehdr*>(
+                                   m_pArea->view(m_Base, sizeof(Ehdr)).start());
+  }
+
+  /// isValid - is this an ELF file of the class and the byte order?
+  bool isValid() const
+  {
+    if (0 != memcmp(llvm::ELF::ElfMagic, m_pHeader->e_ident, 4))
+      return false;
+    unsigned char elf_class = (32 == BITS)? llvm::ELF::ELFCLASS32:
+                                            llvm::ELF::ELFCLASS64;
+    unsigned char elf_data = LITTLE? llvm::ELF::ELFDATA2LSB:
+                                     llvm::ELF::ELFDATA2MSB;
+    return (elf_class == m_pHeader->e_ident[llvm::ELF::EI_CLASS] &&
+            elf_data == m_pHeader->e_ident[llvm::ELF::EI_DATA]);
+  }
+
+  const Ehdr& header() const { return *m_pHeader; }
+
+  /// sectionHeaders - the section header table, or NULL if there is none.
+  /// If e_shnum or e_shstrndx overflows, the actual value is taken from the
+  /// first section header.
+  const Shdr* sectionHeaders()
+  {
+    if (NULL != m_pShdrTab)
+      return m_pShdrTab;
+
+    uint64_t shoff = m_pHeader->e_shoff;
+    if (0x0 == shoff || sizeof(Shdr) != m_pHeader->e_shentsize)
+      return NULL;
+
+    m_NumOfSections = m_pHeader->e_shnum;
+    m_ShStrNdx = m_pHeader->e_shstrndx;
+    if (llvm::ELF::SHN_UNDEF == m_NumOfSections ||
+        llvm::ELF::SHN_XINDEX == m_ShStrNdx) {
+      const Shdr* first = get<Shdr>(shoff, 1);
+      if (llvm::ELF::SHN_UNDEF == m_NumOfSections)
+        m_NumOfSections = first->sh_size;
+      if (llvm::ELF::SHN_XINDEX == m_ShStrNdx)
+        m_ShStrNdx = first->sh_link;
+    }
+
+    if (0 == m_NumOfSections)
+      return NULL;
+    m_pShdrTab = get<Shdr>(shoff, m_NumOfSections);
+    return m_pShdrTab;
+  }
+
+  /// numOfSections - the number of the section headers. Valid after
+  /// sectionHeaders().
+  size_t numOfSections() const { return m_NumOfSections; }
+
+  /// shstrndx - the index of the section name table. Valid after
+  /// sectionHeaders().
+  size_t shstrndx() const { return m_ShStrNdx; }
+
+  /// get - get the array of pNum T at pOffset of the file
+  template<typename T>
+  const T* get(uint64_t pOffset, size_t pNum) const
+  {
+    MemoryView view = m_pArea->view(m_Base + pOffset, pNum * sizeof(T));
+    return reinterpret_cast<const T*>(view.start());
+  }
+
+  /// contents - the contents of pSection
+  template<typename T>
+  const T* contents(const Shdr& pSection) const
+  {
+    return get<T>(pSection.sh_offset, pSection.sh_size / sizeof(T));
+  }
+
+private:
+  MemoryArea* m_pArea;
+  size_t m_Base;
+  const Ehdr* m_pHeader;
+  const Shdr* m_pShdrTab;
+  size_t m_NumOfSections;
+  size_t m_ShStrNdx;
+};
+
+} // namespace of mcld
+
+#endif
+
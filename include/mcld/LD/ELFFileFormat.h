@@ -183,6 +183,21 @@ public:
   bool hasGNUHashTab() const
   { return (NULL != f_pGNUHashTab) && (0 != f_pGNUHashTab->size()); }
 
+  bool hasRelrDyn() const
+  { return (NULL != f_pRelrDyn) && (0 != f_pRelrDyn->size()); }
+
+  bool hasNoteGNUBuildID() const
+  { return (NULL != f_pNoteGNUBuildID) && (0 != f_pNoteGNUBuildID->size()); }
+
+  bool hasSymInfo() const
+  { return (NULL != f_pSymInfo) && (0 != f_pSymInfo->size()); }
+
+  bool hasGdbIndex() const
+  { return (NULL != f_pGdbIndex) && (0 != f_pGdbIndex->size()); }
+
+  bool hasGNUDebugLink() const
+  { return (NULL != f_pGNUDebugLink) && (0 != f_pGNUDebugLink->size()); }
+
   // -----  access functions  ----- //
   /// @ref Special Sections, Ch. 4.17, System V ABI, 4th edition.
   LDSection& getNULLSection() {
@@ -647,6 +662,56 @@ public:
     return *f_pGNUHashTab;
   }
 
+  LDSection& getRelrDyn() {
+    assert(NULL != f_pRelrDyn);
+    return *f_pRelrDyn;
+  }
+
+  const LDSection& getRelrDyn() const {
+    assert(NULL != f_pRelrDyn);
+    return *f_pRelrDyn;
+  }
+
+  LDSection& getNoteGNUBuildID() {
+    assert(NULL != f_pNoteGNUBuildID);
+    return *f_pNoteGNUBuildID;
+  }
+
+  const LDSection& getNoteGNUBuildID() const {
+    assert(NULL != f_pNoteGNUBuildID);
+    return *f_pNoteGNUBuildID;
+  }
+
+  LDSection& getSymInfo() {
+    assert(NULL != f_pSymInfo);
+    return *f_pSymInfo;
+  }
+
+  const LDSection& getSymInfo() const {
+    assert(NULL != f_pSymInfo);
+    return *f_pSymInfo;
+  }
+
+  LDSection& getGdbIndex() {
+    assert(NULL != f_pGdbIndex);
+    return *f_pGdbIndex;
+  }
+
+  const LDSection& getGdbIndex() const {
+    assert(NULL != f_pGdbIndex);
+    return *f_pGdbIndex;
+  }
+
+  LDSection& getGNUDebugLink() {
+    assert(NULL != f_pGNUDebugLink);
+    return *f_pGNUDebugLink;
+  }
+
+  const LDSection& getGNUDebugLink() const {
+    assert(NULL != f_pGNUDebugLink);
+    return *f_pGNUDebugLink;
+  }
+
 protected:
   //         variable name         :  ELF
   /// @ref Special Sections, Ch. 4.17, System V ABI, 4th edition.
@@ -702,6 +767,11 @@ protected:
   LDSection* f_pStackNote;         // .note.GNU-stack
   LDSection* f_pDataRelRoLocal;    // .data.rel.ro.local
   LDSection* f_pGNUHashTab;        // .gnu.hash
+  LDSection* f_pRelrDyn;           // .relr.dyn
+  LDSection* f_pNoteGNUBuildID;    // .note.gnu.build-id
+  LDSection* f_pSymInfo;           // .SUNW_syminfo
+  LDSection* f_pGdbIndex;          // .gdb_index
+  LDSection* f_pGNUDebugLink;      // .gnu_debuglink
 };
 
 } // namespace of mcld
@@ -15,6 +15,10 @@
 #include <mcld/LD/ObjectReader.h>
 #include <mcld/ADT/Flags.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace mcld {
 
 class Module;
@@ -22,8 +26,14 @@ class Input;
 class IRBuilder;
 class GNULDBackend;
 class ELFReaderIF;
+class Fragment;
+class EhFrame;
 class EhFrameReader;
 class LinkerConfig;
+class MemoryArea;
+class ObjectSummary;
+class ObjectSummaryCache;
+class SectionData;
 
 /** \lclass ELFObjectReader
  *  \brief ELFObjectReader reads target-independent parts of ELF object file
@@ -49,6 +59,21 @@ public:
   bool isMyFormat(Input &pFile) const;
 
   // -----  readers  ----- //
+  bool preload(Input& pFile);
+
+  /// preload - preload the object at pFileOffset of pArea. This function may
+  /// be called concurrently, even on the same MemoryArea.
+  bool preload(MemoryArea& pArea, size_t pFileOffset);
+
+  size_t numOfGlobalSymbols(Input& pFile);
+
+  /// readSymbolNames - read the names of the defined non-local symbols of the
+  /// object at pFileOffset of pArea, such as an archive member. This function
+  /// may be called concurrently, even on the same MemoryArea.
+  bool readSymbolNames(MemoryArea& pArea,
+                       size_t pFileOffset,
+                       std::vector<std::string>& pNames);
+
   bool readHeader(Input& pFile);
 
   virtual bool readSections(Input& pFile);
@@ -60,6 +85,35 @@ public:
   /// This function should be called after symbol resolution.
   virtual bool readRelocations(Input& pFile);
 
+  /// readRelocations - read the relocation sections of pList. The regions
+  /// are requested and the relocations are created in the order of pList,
+  /// and the entries are decoded concurrently in between.
+  virtual bool readRelocations(const RelocSectionList& pList);
+
+private:
+  typedef std::map<const Input*, const ObjectSummary*> SummaryMap;
+
+private:
+  /// getSummary - the summary that pInput is read from, or NULL
+  const ObjectSummary* getSummary(const Input& pInput) const;
+
+  /// storeSummary - write the summary of pInput, whose first pSize bytes are
+  /// hashed to pHash, into the cache
+  void storeSummary(Input& pInput, uint64_t pHash, uint64_t pSize);
+
+  /// readSummaryEhFrame - create the entries of pEhFrame from the splits in
+  /// pSummary instead of parsing the section
+  bool readSummaryEhFrame(Input& pInput,
+                          const ObjectSummary& pSummary,
+                          EhFrame& pEhFrame);
+
+  /// findPackedTarget - the fragment that all entries of pSection apply to,
+  /// if the entries may be kept in a PackedRelocData, or NULL
+  Fragment* findPackedTarget(LDSection& pSection) const;
+
+  /// readCompressedSection - read the SHF_COMPRESSED section of pSD
+  bool readCompressedSection(Input& pInput, SectionData& pSD);
+
 private:
   ELFReaderIF* m_pELFReader;
   EhFrameReader* m_pEhFrameReader;
@@ -67,6 +121,8 @@ private:
   ReadFlag m_ReadFlag;
   GNULDBackend& m_Backend;
   const LinkerConfig& m_Config;
+  ObjectSummaryCache* m_pSummaryCache;
+  SummaryMap m_Summaries;
 };
 
 } // namespace of mcld
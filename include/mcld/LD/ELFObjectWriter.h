@@ -12,10 +12,17 @@
 #include <gtest.h>
 #endif
 #include <mcld/LD/ObjectWriter.h>
+#include <mcld/LD/Relocator.h>
+#include <mcld/LD/SectionData.h>
 #include <cassert>
 
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/DataTypes.h>
 #include <llvm/Support/system_error.h>
 
+#include <map>
+#include <vector>
+
 namespace mcld {
 
 class Module;
@@ -24,11 +31,13 @@ class GNULDBackend;
 class FragmentLinker;
 class Relocation;
 class LDSection;
-class SectionData;
 class RelocData;
 class Output;
 class MemoryRegion;
 class MemoryArea;
+class FileHandle;
+class Fragment;
+class PackedRelocData;
 
 /** \class ELFObjectWriter
  *  \brief ELFObjectWriter writes the target-independent parts of object files.
@@ -49,7 +58,105 @@ public:
   llvm::error_code writeObject(Module& pModule, MemoryArea& pOutput);
 
 private:
-  void writeSection(MemoryArea& pOutput, LDSection *section);
+  typedef std::vector<LDSection*> SectionList;
+  typedef std::vector<Relocation*> RelocList;
+  typedef std::map<const LDSection*, RelocList> RelocMap;
+  typedef std::vector<Relocator::Result> ResultList;
+  typedef std::vector<PackedRelocData*> PackedList;
+  typedef std::map<const LDSection*, PackedList> PackedMap;
+
+  struct EmitTask;
+  struct NamePoolTask;
+  struct RelocTask;
+
+private:
+  /// requestSection - the region of pSection in the output, or NULL if
+  /// pSection has nothing to write
+  MemoryRegion* requestSection(MemoryArea& pOutput, LDSection& pSection);
+
+  /// emitSection - write the contents of pSection into pRegion
+  void emitSection(LDSection& pSection, MemoryRegion& pRegion);
+
+  /// emitNamePools - emit the symbol tables and the string tables
+  void emitNamePools(Module& pModule, MemoryArea& pOutput);
+
+  /// writeSections - write the name pools and pSections. If the output is
+  /// streamed, the relocation results are written along with each section.
+  void writeSections(Module& pModule,
+                     const SectionList& pSections,
+                     MemoryArea& pOutput);
+
+  /// writeSectionsConcurrently - with --threads, emit the name pools and the
+  /// chunks of the sections on the thread pool, and then write the
+  /// relocation results of the sections on the thread pool.
+  void writeSectionsConcurrently(Module& pModule,
+                                 const SectionList& pSections,
+                                 MemoryArea& pOutput);
+
+  /// collectRelocations - append the input relocations to the lists of their
+  /// target sections in pRelocs, and sort each list by the places. The
+  /// relocations against the sections which are not in pRelocs are skipped.
+  void collectRelocations(Module& pModule, RelocMap& pRelocs) const;
+
+  /// applyRelocations - apply the fused relocations in pRelocs, which are
+  /// left to the writer by the FragmentLinker. The applied relocations and
+  /// their results are appended to pFused and pResults. It may run
+  /// concurrently for different sections.
+  void applyRelocations(const RelocList& pRelocs,
+                        RelocList& pFused,
+                        ResultList& pResults);
+
+  /// reportRelocations - report the failed relocations of applyRelocations()
+  void reportRelocations(const RelocList& pFused, const ResultList& pResults);
+
+  /// writeRelocations - write the results of pRelocs into pRegion, the
+  /// region of their target section
+  void writeRelocations(const RelocList& pRelocs, MemoryRegion& pRegion);
+
+  /// collectPackedRelocations - append the packed relocations to the lists
+  /// of their target sections in pPacked. The relocations against the
+  /// sections which are not in pPacked are skipped.
+  void collectPackedRelocations(Module& pModule, PackedMap& pPacked) const;
+
+  /// applyPackedRelocations - decode the packed relocations of pPacked block
+  /// by block, and apply them to pRegion, the written region of their target
+  /// section
+  void applyPackedRelocations(const PackedList& pPacked,
+                              MemoryRegion& pRegion);
+
+  /// flushSection - write the relocation results into the written section,
+  /// apply the packed relocations of the section, and write the section back
+  /// to the file. With --low-memory, also drop the input pages copied into
+  /// it.
+  void flushSection(const LDSection& pSection,
+                    const RelocList& pRelocs,
+                    const PackedList& pPacked,
+                    MemoryRegion* pRegion,
+                    MemoryArea& pOutput);
+
+  /// prepareOutput - with --output-strategy=preallocate or write, allocate
+  /// the final size of the output at once, and then map the whole output or
+  /// turn off the mapping of pOutput.
+  void prepareOutput(const Module& pModule,
+                     const SectionList& pSections,
+                     MemoryArea& pOutput);
+
+  /// collectKernelCopies - with --kernel-copy, pick the large region
+  /// fragments of pSections which are read from a file and are the target
+  /// of no relocation. They are left out of the emitted sections.
+  void collectKernelCopies(Module& pModule,
+                           const SectionList& pSections,
+                           const MemoryArea& pOutput);
+
+  /// copyByKernel - copy the fragments picked by collectKernelCopies() from
+  /// the input files into the output file, after the output is written back.
+  /// A range the kernel can not copy is written from the memory.
+  void copyByKernel(MemoryArea& pOutput);
+
+  /// compressSections - compress the output sections marked SHF_COMPRESSED
+  /// into an Elf_Chdr and a zlib stream, with the relocation results written
+  /// in, and reassign the file offsets of the sections after them.
+  void compressSections(Module& pModule);
 
   GNULDBackend&       target()        { return m_Backend; }
 
@@ -84,7 +191,7 @@ private:
 
   void emitRelocation(const LinkerConfig& pConfig,
                       const LDSection& pSection,
-                      MemoryRegion& pRegion) const;
+                      MemoryRegion& pRegion);
 
   // emitRel - emit ElfXX_Rel
   template<size_t SIZE>
@@ -109,6 +216,10 @@ private:
   // getSectInfo - compute ElfXX_Shdr::sh_info
   uint64_t getSectInfo(const LDSection& pSection) const;
 
+  /// numOfSectionHeaders - the number of the sections in the section header
+  /// table. The sections of --separate-debug-file are not in it.
+  size_t numOfSectionHeaders(const Module& pModule) const;
+
   template<size_t SIZE>
   uint64_t getLastStartOffset(const Module& pModule) const
   {
@@ -118,10 +229,41 @@ private:
 
   void emitSectionData(const SectionData& pSD, MemoryRegion& pRegion) const;
 
+  /// emitFragments - emit the fragments [pBegin, pEnd) of a section, the
+  /// first of which is at pOffset of pRegion
+  void emitFragments(SectionData::const_iterator pBegin,
+                     SectionData::const_iterator pEnd,
+                     size_t pOffset,
+                     MemoryRegion& pRegion) const;
+
+private:
+  typedef std::map<const LDSection*, std::vector<uint8_t> > CompressedMap;
+
+  /// KernelCopy - a fragment copied by the kernel
+  struct KernelCopy
+  {
+    const FileHandle* source;
+    size_t sourceOffset;
+    size_t offset;        ///< the file offset in the output
+    size_t size;
+    const uint8_t* data;  ///< the contents in the memory, for the fallback
+  };
+
+  typedef std::vector<KernelCopy> KernelCopyList;
+  typedef llvm::DenseSet<const Fragment*> FragmentSet;
+
 private:
   GNULDBackend& m_Backend;
 
   const LinkerConfig& m_Config;
+
+  /// m_CompressedData - the contents of the compressed sections
+  CompressedMap m_CompressedData;
+
+  /// m_KernelCopies - the fragments copied by the kernel, and the set of
+  /// them skipped by emitFragments()
+  KernelCopyList m_KernelCopies;
+  FragmentSet m_KernelCopied;
 };
 
 template<>
@@ -16,12 +16,16 @@
 #include <llvm/Support/ELF.h>
 #include <llvm/Support/Host.h>
 
+#include <mcld/GeneralOptions.h>
+#include <mcld/LD/ELFFile.h>
 #include <mcld/LD/ELFReaderIf.h>
 #include <mcld/LD/ResolveInfo.h>
 #include <mcld/Target/GNULDBackend.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MemoryArea.h>
 
+#include <vector>
+
 namespace mcld {
 
 //class Module;
@@ -30,24 +34,23 @@ class SectionData;
 class LDSection;
 
 /** \class ELFReader
- *  \brief ELFReader is a template scaffolding for partial specification.
+ *  \brief ELFReader reads the ELF files of a class and a byte order.
+ *
+ *  The ELF structures are read in place as ELFFile structures, whose fields
+ *  are swapped only if the byte order differs from the host's, so the 32-bit
+ *  and the 64-bit readers share one implementation.
  */
 template<size_t BIT, bool LITTLEENDIAN>
-class ELFReader
-{ };
-
-/** \class ELFReader<32, true>
- *  \brief ELFReader<32, true> is a 32-bit, little endian ELFReader.
- */
-template<>
-class ELFReader<32, true> : public ELFReaderIF
+class ELFReader : public ELFReaderIF
 {
 public:
-  typedef llvm::ELF::Elf32_Ehdr ELFHeader;
-  typedef llvm::ELF::Elf32_Shdr SectionHeader;
-  typedef llvm::ELF::Elf32_Sym  Symbol;
-  typedef llvm::ELF::Elf32_Rel  Rel;
-  typedef llvm::ELF::Elf32_Rela Rela;
+  typedef ELFFile<BIT, LITTLEENDIAN> File;
+  typedef typename File::Ehdr ELFHeader;
+  typedef typename File::Shdr SectionHeader;
+  typedef typename File::Sym  Symbol;
+  typedef typename File::Rel  Rel;
+  typedef typename File::Rela Rela;
+  typedef typename File::Dyn  Dyn;
 
 public:
   ELFReader(GNULDBackend& pBackend);
@@ -59,86 +62,35 @@ public:
   { return sizeof(ELFHeader); }
 
   /// isELF - is this a ELF file
-  bool isELF(void* pELFHeader) const;
+  bool isELF(const void* pELFHeader) const;
 
   /// isMyEndian - is this ELF file in the same endian to me?
-  bool isMyEndian(void* pELFHeader) const;
+  bool isMyEndian(const void* pELFHeader) const;
 
   /// isMyMachine - is this ELF file generated for the same machine.
-  bool isMyMachine(void* pELFHeader) const;
+  bool isMyMachine(const void* pELFHeader) const;
 
   /// fileType - the file type of this file
-  Input::Type fileType(void* pELFHeader) const;
+  Input::Type fileType(const void* pELFHeader) const;
 
-  /// readSectionHeaders - read ELF section header table and create LDSections
-  bool readSectionHeaders(Input& pInput, void* pELFHeader) const;
-
-  /// readRegularSection - read a regular section and create fragments.
-  bool readRegularSection(Input& pInput, SectionData& pSD) const;
-
-  /// readSymbols - read ELF symbols and create LDSymbol
-  bool readSymbols(Input& pInput,
-                   IRBuilder& pBuilder,
-                   const MemoryRegion& pRegion,
-                   const char* StrTab) const;
+  /// preloadTables - read the ELF header, the section header table, .shstrtab
+  /// and the symbol table of the file at pBase of pArea into pArea.
+  Input::Type preloadTables(MemoryArea& pArea, size_t pBase) const;
 
-  /// readSignature - read a symbol from the given Input and index in symtab
-  /// This is used to get the signature of a group section.
-  ResolveInfo* readSignature(Input& pInput,
-                                    LDSection& pSymTab,
-                                    uint32_t pSymIdx) const;
+  /// countGlobalSymbols - count the non-local symbols in the symbol table of
+  /// the file at pBase of pArea.
+  Input::Type countGlobalSymbols(MemoryArea& pArea,
+                                 size_t pBase,
+                                 size_t& pCount) const;
 
-  /// readRela - read ELF rela and create Relocation
-  bool readRela(Input& pInput,
-                LDSection& pSection,
-                const MemoryRegion& pRegion) const;
-
-  /// readRel - read ELF rel and create Relocation
-  bool readRel(Input& pInput,
-               LDSection& pSection,
-               const MemoryRegion& pRegion) const;
-
-  /// readDynamic - read ELF .dynamic in input dynobj
-  bool readDynamic(Input& pInput) const;
-};
-
-
-/** \class ELFReader<64, true>
- *  \brief ELFReader<64, true> is a 64-bit, little endian ELFReader.
- */
-template<>
-class ELFReader<64, true> : public ELFReaderIF
-{
-public:
-  typedef llvm::ELF::Elf64_Ehdr ELFHeader;
-  typedef llvm::ELF::Elf64_Shdr SectionHeader;
-  typedef llvm::ELF::Elf64_Sym  Symbol;
-  typedef llvm::ELF::Elf64_Rel  Rel;
-  typedef llvm::ELF::Elf64_Rela Rela;
-
-public:
-  ELFReader(GNULDBackend& pBackend);
-
-  ~ELFReader();
-
-  /// ELFHeaderSize - return the size of the ELFHeader
-  size_t getELFHeaderSize() const
-  { return sizeof(ELFHeader); }
-
-  /// isELF - is this a ELF file
-  bool isELF(void* pELFHeader) const;
-
-  /// isMyEndian - is this ELF file in the same endian to me?
-  bool isMyEndian(void* pELFHeader) const;
-
-  /// isMyMachine - is this ELF file generated for the same machine.
-  bool isMyMachine(void* pELFHeader) const;
-
-  /// fileType - the file type of this file
-  Input::Type fileType(void* pELFHeader) const;
+  /// readSymbolNames - read the names of the defined non-local symbols in
+  /// .symtab of the object at pBase of pArea.
+  Input::Type readSymbolNames(MemoryArea& pArea,
+                              size_t pBase,
+                              std::vector<std::string>& pNames) const;
 
   /// readSectionHeaders - read ELF section header table and create LDSections
-  bool readSectionHeaders(Input& pInput, void* pELFHeader) const;
+  bool readSectionHeaders(Input& pInput, const void* pELFHeader) const;
 
   /// readRegularSection - read a regular section and create fragments.
   bool readRegularSection(Input& pInput, SectionData& pSD) const;
@@ -149,11 +101,20 @@ public:
                    const MemoryRegion& pRegion,
                    const char* StrTab) const;
 
-  /// readSignature - read a symbol from the given Input and index in symtab
-  /// This is used to get the signature of a group section.
-  ResolveInfo* readSignature(Input& pInput,
-                                    LDSection& pSymTab,
-                                    uint32_t pSymIdx) const;
+  /// readSymbol - read the pIdx-th ELF symbol of pRegion and create its
+  /// LDSymbol
+  LDSymbol* readSymbol(Input& pInput,
+                       IRBuilder& pBuilder,
+                       const MemoryRegion& pRegion,
+                       const char* pStrTab,
+                       size_t pIdx) const;
+
+  /// decodeSymbol - decode the pIdx-th ELF symbol of pRegion
+  bool decodeSymbol(Input& pInput,
+                    const MemoryRegion& pRegion,
+                    const char* pStrTab,
+                    size_t pIdx,
+                    DecodedSymbol& pResult) const;
 
   /// readRela - read ELF rela and create Relocation
   bool readRela(Input& pInput,
@@ -165,8 +126,50 @@ public:
                LDSection& pSection,
                const MemoryRegion& pRegion) const;
 
+  /// decodeRela - decode the ELF rela of pRegion into pEntries
+  bool decodeRela(Input& pInput,
+                  const MemoryRegion& pRegion,
+                  IRBuilder::RelocEntryList& pEntries) const;
+
+  /// decodeRel - decode the ELF rel of pRegion into pEntries
+  bool decodeRel(Input& pInput,
+                 const MemoryRegion& pRegion,
+                 IRBuilder::RelocEntryList& pEntries) const;
+
   /// readDynamic - read ELF .dynamic in input dynobj
-  bool readDynamic(Input& pInput) const;
+  bool readDynamic(Input& pInput,
+                   std::vector<std::string>* pNeeded = NULL) const;
+
+  /// objectSize - the bytes of the object pInput that its section header
+  /// table and its sections take
+  uint64_t objectSize(Input& pInput) const;
+
+  /// summarize - fill pTables with the section headers, the symbol table and
+  /// the relocations of the object pInput
+  bool summarize(Input& pInput, ObjectSummary::Tables& pTables) const;
+
+private:
+  /// addSymbol - decode pSymbol and add it by pBuilder
+  LDSymbol* addSymbol(Input& pInput,
+                      IRBuilder& pBuilder,
+                      const Symbol& pSymbol,
+                      const char* pStrTab) const;
+
+  /// decode - decode pSymbol in the terms of ResolveInfo
+  void decode(Input& pInput,
+              const Symbol& pSymbol,
+              const char* pStrTab,
+              DecodedSymbol& pResult) const;
+
+  /// markReferredSymbols - set the bits of pReferred of the symbols which the
+  /// relocations of pInput refer to
+  void markReferredSymbols(Input& pInput, std::vector<bool>& pReferred) const;
+
+  /// isDiscardable - can the local symbol pSymbol be dropped in pMode if no
+  /// relocation refers to it?
+  bool isDiscardable(const Symbol& pSymbol,
+                     const char* pStrTab,
+                     GeneralOptions::StripSymbolMode pMode) const;
 };
 
 } // namespace of mcld
@@ -17,16 +17,23 @@
 #include <llvm/Support/Host.h>
 
 #include <mcld/Module.h>
+#include <mcld/IRBuilder.h>
 #include <mcld/LinkerConfig.h>
 #include <mcld/LD/LDContext.h>
+#include <mcld/LD/ObjectSummary.h>
+#include <mcld/LD/ResolveInfo.h>
 #include <mcld/Target/GNULDBackend.h>
 #include <mcld/Support/MsgHandling.h>
 
+#include <string>
+#include <vector>
+
 namespace mcld {
 
 class Module;
 class IRBuilder;
 class FragmentRef;
+class MemoryArea;
 class SectionData;
 class LDSection;
 
@@ -35,6 +42,20 @@ class LDSection;
  */
 class ELFReaderIF
 {
+public:
+  /// DecodedSymbol - an ELF symbol in the terms of ResolveInfo
+  struct DecodedSymbol
+  {
+    llvm::StringRef name;
+    ResolveInfo::Type type;
+    ResolveInfo::Desc desc;
+    ResolveInfo::Binding binding;
+    ResolveInfo::Visibility visibility;
+    uint64_t size;
+    uint64_t value;
+    LDSection* section;
+  };
+
 public:
   ELFReaderIF(GNULDBackend& pBackend)
     : m_Backend(pBackend)
@@ -46,24 +67,56 @@ public:
   virtual size_t getELFHeaderSize() const = 0;
 
   /// isELF - is this a ELF file
-  virtual bool isELF(void* pELFHeader) const = 0;
+  virtual bool isELF(const void* pELFHeader) const = 0;
 
   /// isMyEndian - is this ELF file in the same endian to me?
-  virtual bool isMyEndian(void* pELFHeader) const = 0;
+  virtual bool isMyEndian(const void* pELFHeader) const = 0;
 
   /// isMyMachine - is this ELF file generated for the same machine.
-  virtual bool isMyMachine(void* pELFHeader) const = 0;
+  virtual bool isMyMachine(const void* pELFHeader) const = 0;
 
   /// fileType - the file type of this file
-  virtual Input::Type fileType(void* pELFHeader) const = 0;
+  virtual Input::Type fileType(const void* pELFHeader) const = 0;
 
   /// target - the target backend
   const GNULDBackend& target() const { return m_Backend; }
   GNULDBackend&       target()       { return m_Backend; }
 
 
+  /// preloadTables - read the ELF header, the section header table, .shstrtab
+  /// and the symbol table (.symtab for objects, .dynsym for shared objects)
+  /// of the file at pBase of pArea into pArea, without creating any LDSection
+  /// or MemoryRegion. It is safe to call this function concurrently, since
+  /// MemoryArea::preload() is.
+  /// @return the file type of the file, or Input::Unknown if the file is not
+  /// an ELF file of this target.
+  virtual Input::Type preloadTables(MemoryArea& pArea, size_t pBase) const = 0;
+
+  /// countGlobalSymbols - count the non-local symbols in the symbol table
+  /// (.symtab for objects, .dynsym for shared objects) of the file at pBase
+  /// of pArea by the section header table, without creating any LDSection.
+  /// @param pCount - the number of non-local symbols, or 0 if the file has
+  /// no symbol table.
+  /// @return the file type of the file, or Input::Unknown if the file is not
+  /// an ELF file of this target.
+  virtual Input::Type countGlobalSymbols(MemoryArea& pArea,
+                                         size_t pBase,
+                                         size_t& pCount) const = 0;
+
+  /// readSymbolNames - read the names of the defined non-local symbols in
+  /// .symtab of the object at pBase of pArea, in the order of the symbol
+  /// table. The tables are read through MemoryArea::preload(), so this
+  /// function may be called concurrently as preloadTables().
+  /// @return the file type of the file, or Input::Unknown if the file is not
+  /// an ELF file of this target.
+  virtual Input::Type
+  readSymbolNames(MemoryArea& pArea,
+                  size_t pBase,
+                  std::vector<std::string>& pNames) const = 0;
+
   /// readSectionHeaders - read ELF section header table and create LDSections
-  virtual bool readSectionHeaders(Input& pInput, void* pELFHeader) const = 0;
+  virtual bool readSectionHeaders(Input& pInput,
+                                  const void* pELFHeader) const = 0;
 
   /// readRegularSection - read a regular section and create fragments.
   virtual bool readRegularSection(Input& pInput, SectionData& pSD) const = 0;
@@ -74,11 +127,23 @@ public:
                            const MemoryRegion& pRegion,
                            const char* StrTab) const = 0;
 
-  /// readSignature - read a symbol from the given Input and index in symtab
-  /// This is used to get the signature of a group section.
-  virtual ResolveInfo* readSignature(Input& pInput,
-                                     LDSection& pSymTab,
-                                     uint32_t pSymIdx) const = 0;
+  /// readSymbol - read the pIdx-th ELF symbol of pRegion and create its
+  /// LDSymbol. Unlike readSymbols(), the other symbols are not read.
+  /// @return the input LDSymbol, or NULL if the symbol is ignored
+  virtual LDSymbol* readSymbol(Input& pInput,
+                               IRBuilder& pBuilder,
+                               const MemoryRegion& pRegion,
+                               const char* pStrTab,
+                               size_t pIdx) const = 0;
+
+  /// decodeSymbol - decode the pIdx-th ELF symbol of pRegion without
+  /// creating any IR
+  /// @return false if pIdx is out of pRegion
+  virtual bool decodeSymbol(Input& pInput,
+                            const MemoryRegion& pRegion,
+                            const char* pStrTab,
+                            size_t pIdx,
+                            DecodedSymbol& pResult) const = 0;
 
   /// readRela - read ELF rela and create Relocation
   virtual bool readRela(Input& pInput,
@@ -90,8 +155,57 @@ public:
                        LDSection& pSection,
                        const MemoryRegion& pRegion) const = 0;
 
-  /// readDynamic - read ELF .dynamic in input dynobj
-  virtual bool readDynamic(Input& pInput) const = 0;
+  /// decodeRela - decode the ELF rela of pRegion into pEntries without
+  /// creating any Relocation. It may be called concurrently.
+  virtual bool decodeRela(Input& pInput,
+                          const MemoryRegion& pRegion,
+                          IRBuilder::RelocEntryList& pEntries) const = 0;
+
+  /// decodeRel - decode the ELF rel of pRegion into pEntries without
+  /// creating any Relocation. It may be called concurrently.
+  virtual bool decodeRel(Input& pInput,
+                         const MemoryRegion& pRegion,
+                         IRBuilder::RelocEntryList& pEntries) const = 0;
+
+  /// readDynamic - read ELF .dynamic in input dynobj. The DT_NEEDED
+  /// libraries are appended to pNeeded if it is given.
+  virtual bool readDynamic(Input& pInput,
+                           std::vector<std::string>* pNeeded = NULL) const = 0;
+
+  /// objectSize - the bytes of the object pInput that its section header
+  /// table and its sections take
+  virtual uint64_t objectSize(Input& pInput) const = 0;
+
+  /// summarize - fill pTables with the section headers, the symbol table and
+  /// the relocations of the object pInput. The splits of .eh_frame are left
+  /// to the caller.
+  virtual bool summarize(Input& pInput,
+                         ObjectSummary::Tables& pTables) const = 0;
+
+  /// readSummarySections - create the LDSections of pInput from pSummary
+  /// instead of its section header table
+  bool readSummarySections(Input& pInput, const ObjectSummary& pSummary) const;
+
+  /// readSummarySymbols - create the LDSymbols of pInput from pSummary as
+  /// readSymbols() does
+  bool readSummarySymbols(Input& pInput,
+                          IRBuilder& pBuilder,
+                          const ObjectSummary& pSummary) const;
+
+  /// decodeSummarySymbol - decode the pIdx-th symbol of pSummary as
+  /// decodeSymbol() does
+  /// @return false if pIdx is out of the symbol table
+  bool decodeSummarySymbol(Input& pInput,
+                           const ObjectSummary& pSummary,
+                           size_t pIdx,
+                           DecodedSymbol& pResult) const;
+
+  /// decodeSummaryRelocs - decode the entries of the relocation section
+  /// pSection of pSummary into pEntries. It may be called concurrently.
+  bool decodeSummaryRelocs(Input& pInput,
+                           const ObjectSummary& pSummary,
+                           const LDSection& pSection,
+                           IRBuilder::RelocEntryList& pEntries) const;
 
 protected:
   /// LinkInfo - some section needs sh_link and sh_info, remember them.
@@ -103,7 +217,32 @@ protected:
 
   typedef std::vector<LinkInfo> LinkInfoList;
 
+  /// SymbolFields - the fields of an ELF symbol in the host byte order
+  struct SymbolFields
+  {
+    const char* name;
+    uint8_t info;
+    uint8_t other;
+    uint16_t shndx;
+    uint64_t value;
+    uint64_t size;
+  };
+
 protected:
+  /// decodeFields - decode pFields in the terms of ResolveInfo
+  void decodeFields(Input& pInput,
+                    const SymbolFields& pFields,
+                    DecodedSymbol& pResult) const;
+
+  /// canDiscard - can the local symbol pFields be dropped in pMode if no
+  /// relocation refers to it?
+  bool canDiscard(const SymbolFields& pFields,
+                  GeneralOptions::StripSymbolMode pMode) const;
+
+  /// setUpLinks - set the links of the sections of pInput by pList
+  void setUpLinks(Input& pInput, const LinkInfoList& pList) const;
+
+
   ResolveInfo::Type getSymType(uint8_t pInfo, uint16_t pShndx) const;
 
   ResolveInfo::Desc getSymDesc(uint16_t pShndx, const Input& pInput) const;
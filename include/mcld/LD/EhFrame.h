@@ -16,10 +16,12 @@
 #include <mcld/Fragment/RegionFragment.h>
 #include <mcld/Support/Allocators.h>
 
+#include <set>
 #include <vector>
 
 namespace mcld {
 
+class Fragment;
 class LDSection;
 class SectionData;
 
@@ -67,12 +69,19 @@ public:
         const CIE& pCIE,
         uint32_t pDataStart);
 
-    const CIE& getCIE() const { return m_CIE; }
+    const CIE& getCIE() const { return *m_pCIE; }
+
+    /// setCIE - refer to another CIE identical to the current one
+    void setCIE(const CIE& pCIE) { m_pCIE = &pCIE; }
 
     uint32_t getDataStart() const { return m_DataStart; }
 
+    /// getCIEPointerOffset - the offset of the CIE Pointer field, which
+    /// is just before the data
+    uint32_t getCIEPointerOffset() const { return m_DataStart - 4; }
+
   private:
-    const CIE& m_CIE;
+    const CIE* m_pCIE;
     uint32_t m_DataStart;
   };
 
@@ -115,6 +124,11 @@ public:
   /// addFDE - add a FDE entry in EhFrame
   void addFDE(FDE& pFDE);
 
+  /// remove - remove and delete the CIEs and FDEs in pDropped, and lay out
+  /// the rest fragments again. No kept FDE may refer to a removed CIE.
+  /// @return the number of the removed bytes
+  uint64_t remove(const std::set<const Fragment*>& pDropped);
+
   // -----  CIE  ----- //
   const_cie_iterator cie_begin() const { return m_CIEs.begin(); }
   cie_iterator       cie_begin()       { return m_CIEs.begin(); }
@@ -20,6 +20,7 @@ namespace mcld {
 class LDSection;
 class MemoryArea;
 class MemoryRegion;
+class ThreadPool;
 
 /** \class EhFrameHdr
  *  \brief EhFrameHdr represents .eh_frame_hdr section.
@@ -34,6 +35,9 @@ class MemoryRegion;
  *  uint32_t : fde_count
  *  __________________________ when fde_count > 0
  *  <uint32_t, uint32_t>+ : binary search table
+ *
+ *  The initial locations of the FDEs are computed on the thread pool, and
+ *  the table is sorted by a parallel radix sort.
  */
 class EhFrameHdr
 {
@@ -47,13 +51,38 @@ public:
 
   /// emitOutput - write out eh_frame_hdr
   template<size_t size>
-  void emitOutput(MemoryArea& pOutput)
+  void emitOutput(MemoryArea& pOutput, ThreadPool& pThreads)
   { assert(false && "Call invalid EhFrameHdr::emitOutput"); }
 
 private:
+  /// PCEncoding - a decoded FDE encoding
+  struct PCEncoding
+  {
+    /// size - the bytes of the initial location to read
+    size_t size;
+
+    /// isSigned - the initial location is a signed value
+    bool isSigned;
+
+    /// application - DW_EH_PE_absptr, DW_EH_PE_pcrel, ...
+    uint8_t application;
+  };
+
+  /// PCBeginDecoder - the parallel_for body
+  struct PCBeginDecoder;
+
+private:
+  /// emit - write out eh_frame_hdr of an output of pAddrSize-byte addresses
+  void emit(MemoryArea& pOutput, ThreadPool& pThreads, size_t pAddrSize);
+
+  /// DecodePCEncoding - decode the FDE encoding pEncoding of a CIE
+  static PCEncoding DecodePCEncoding(uint8_t pEncoding, size_t pAddrSize);
+
   /// computePCBegin - return the address of FDE's pc
   /// @ref binutils gold: ehframe.cc:222
-  uint32_t computePCBegin(const EhFrame::FDE& pFDE, const MemoryRegion& pEhFrameRegion);
+  uint64_t computePCBegin(const EhFrame::FDE& pFDE,
+                          const PCEncoding& pEncoding,
+                          const MemoryRegion& pEhFrameRegion) const;
 
 private:
   /// .eh_frame_hdr section
@@ -68,10 +97,10 @@ private:
 //===----------------------------------------------------------------------===//
 /// emitOutput - write out eh_frame_hdr
 template<>
-void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput);
+void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput, ThreadPool& pThreads);
 
 template<>
-void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput);
+void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput, ThreadPool& pThreads);
 
 } // namespace of mcld
 
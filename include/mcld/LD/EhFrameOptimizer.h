@@ -0,0 +1,118 @@
+//===- EhFrameOptimizer.h -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_EH_FRAME_OPTIMIZER_H
+#define MCLD_LD_EH_FRAME_OPTIMIZER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/LD/EhFrame.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class LDSection;
+class LinkerConfig;
+class Module;
+class Relocation;
+
+/** \class EhFrameOptimizer
+ *  \brief Remove the dead FDEs and the duplicated CIEs of the parsed
+ *  .eh_frame input sections.
+ *
+ *  An FDE is dead if the function it describes is in a removed section,
+ *  that is, a discarded group section or a section removed by the garbage
+ *  collection. The relocation of its PC Begin is then either dropped when
+ *  the relocations are read, or refers to a LDFileFormat::Ignore section.
+ *  A CIE whose FDEs are all dead is dead as well.
+ *
+ *  A live CIE is dropped if an identical CIE comes before it in the input
+ *  order. Two CIEs are identical if their contents are the same and so are
+ *  their relocations, the personality routines. The FDEs of a dropped CIE
+ *  refer to the kept one, and their CIE Pointers are written again when
+ *  the output is emitted.
+ *
+ *  The relocations in the removed entries are removed, and the symbols
+ *  defined in them move to the next kept entry of the same section.
+ *
+ *  EhFrameOptimizer must run after readRelocations() and the garbage
+ *  collection, and before mergeSections().
+ */
+class EhFrameOptimizer
+{
+public:
+  EhFrameOptimizer(const LinkerConfig& pConfig, Module& pModule);
+
+  ~EhFrameOptimizer();
+
+  /// run - remove the dead FDEs and the duplicated CIEs
+  /// @return the number of the removed bytes
+  uint64_t run();
+
+private:
+  typedef std::map<const Fragment*, std::vector<Relocation*> > RelocMap;
+  typedef std::set<const Fragment*> FragmentSet;
+
+  struct Candidate
+  {
+    LDSection* sect;
+
+    /// relocs - the relocation sections of sect
+    std::vector<LDSection*> relocs;
+  };
+
+  typedef std::vector<Candidate> CandidateList;
+
+private:
+  /// findCandidates - collect the parsed .eh_frame sections
+  void findCandidates();
+
+  /// pruneFDEs - find the dead FDEs and CIEs of pCandidate
+  void pruneFDEs(Candidate& pCandidate, const RelocMap& pRelocs);
+
+  /// isDead - is the function described by pFDE removed?
+  bool isDead(const EhFrame::FDE& pFDE, const RelocMap& pRelocs) const;
+
+  /// mergeCIEs - find the duplicated CIEs of pCandidate
+  void mergeCIEs(Candidate& pCandidate, const RelocMap& pRelocs);
+
+  /// getKey - the contents and the relocations of pCIE
+  void getKey(const EhFrame::CIE& pCIE, const RelocMap& pRelocs,
+              std::string& pKey) const;
+
+  /// removeRelocations - remove the relocations in the dropped entries
+  void removeRelocations(Candidate& pCandidate);
+
+  /// redirectSymbols - move the symbols defined in the dropped entries
+  void redirectSymbols();
+
+private:
+  const LinkerConfig& m_Config;
+  Module& m_Module;
+
+  CandidateList m_Candidates;
+
+  /// m_Leaders - the kept CIEs by their keys
+  std::map<std::string, const EhFrame::CIE*> m_Leaders;
+
+  /// m_Dropped - the CIEs and FDEs to be removed
+  FragmentSet m_Dropped;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -13,6 +13,8 @@
 #endif
 #include <mcld/Support/MemoryRegion.h>
 
+#include <vector>
+
 namespace mcld {
 
 class Input;
@@ -23,7 +25,10 @@ class LDSection;
  *  \brief EhFrameReader reads .eh_frame section
  *
  *  EhFrameReader is responsible to parse the input eh_frame sections and create
- *  the corresponding CIE and FDE entries.
+ *  the corresponding CIE and FDE entries. Parsing a section splits it into
+ *  CIEs, FDEs and the terminator first, and then the entries are created
+ *  from the splits, so the splits of an object can be kept and the entries
+ *  created again without parsing.
  */
 class EhFrameReader
 {
@@ -31,6 +36,25 @@ public:
   typedef const uint8_t* ConstAddress;
   typedef       uint8_t* Address;
 
+  enum TokenKind {
+    CIE,
+    FDE,
+    Terminator,
+    Unknown,
+    NumOfTokenKinds
+  };
+
+  /// Split - a CIE, an FDE or the terminator of an .eh_frame section
+  struct Split {
+    TokenKind kind;
+    uint64_t offset;       ///< the offset in the section
+    uint64_t size;
+    size_t data_off;
+    uint8_t fde_encoding;  ///< the FDE encoding of a CIE
+  };
+
+  typedef std::vector<Split> SplitList;
+
 public:
   /// read - read an .eh_frame section and create the corresponding
   /// CIEs and FDEs
@@ -41,14 +65,19 @@ public:
   template<size_t BITCLASS, bool SAME_ENDIAN>
   bool read(Input& pInput, EhFrame& pEhFrame);
 
+  /// split - split the .eh_frame section pSection of pInput into pSplits
+  /// without creating any entry
+  /// @return false if the section can not be parsed. The splits before the
+  /// error are kept, and followed by an Unknown split.
+  template<size_t BITCLASS, bool SAME_ENDIAN>
+  bool split(Input& pInput, const LDSection& pSection, SplitList& pSplits);
+
+  /// build - create the CIEs, the FDEs and the terminator of pEhFrame from
+  /// pSplits
+  /// @return false if pSplits ends with an Unknown split
+  bool build(Input& pInput, EhFrame& pEhFrame, const SplitList& pSplits);
+
 private:
-  enum TokenKind {
-    CIE,
-    FDE,
-    Terminator,
-    Unknown,
-    NumOfTokenKinds
-  };
 
   enum State {
     Q0,
@@ -66,38 +95,51 @@ private:
   };
 
   /// Action - the transition function of autometa.
-  /// @param pEhFrame - the output .eh_frame section
-  /// @param pSection - the input .eh_frame section
-  /// @param pRegion - the memory region that needs to handle with.
-  typedef bool (*Action)(EhFrame& pEhFrame,
-                         MemoryRegion& pRegion,
-                         const Token& pToken);
+  /// @param pEntry - the pToken.size bytes of the entry
+  /// @param pToken - the token of the entry
+  /// @param pSplit - the split of the entry to complete
+  typedef bool (*Action)(ConstAddress pEntry,
+                         const Token& pToken,
+                         Split& pSplit);
 private:
   /// scan - scan pData from pHandler for a token.
   template<bool SAME_ENDIAN> Token
   scan(ConstAddress pHandler, uint64_t pOffset, const MemoryRegion& pData) const;
 
-  static bool addCIE(EhFrame& pEhFrame,
-                     MemoryRegion& pRegion,
-                     const Token& pToken);
+  /// parse - split the entries of pSection, parsing the CIEs by pAddCIE
+  bool parse(Input& pInput,
+             const LDSection& pSection,
+             Action pAddCIE,
+             SplitList& pSplits);
+
+  /// addCIE - parse a CIE of a BITCLASS-bit object
+  template<size_t BITCLASS>
+  static bool addCIE(ConstAddress pEntry, const Token& pToken, Split& pSplit);
 
-  static bool addFDE(EhFrame& pEhFrame,
-                     MemoryRegion& pRegion,
-                     const Token& pToken);
+  static bool addFDE(ConstAddress pEntry, const Token& pToken, Split& pSplit);
 
-  static bool addTerm(EhFrame& pEhFrame,
-                      MemoryRegion& pRegion,
-                      const Token& pToken);
+  static bool addTerm(ConstAddress pEntry, const Token& pToken, Split& pSplit);
 
-  static bool reject(EhFrame& pEhFrame,
-                     MemoryRegion& pRegion,
-                     const Token& pToken);
+  static bool reject(ConstAddress pEntry, const Token& pToken, Split& pSplit);
 
 };
 
 template<> bool
 EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame);
 
+template<> bool
+EhFrameReader::read<64, true>(Input& pInput, EhFrame& pEhFrame);
+
+template<> bool
+EhFrameReader::split<32, true>(Input& pInput,
+                               const LDSection& pSection,
+                               SplitList& pSplits);
+
+template<> bool
+EhFrameReader::split<64, true>(Input& pInput,
+                               const LDSection& pSection,
+                               SplitList& pSplits);
+
 template<> EhFrameReader::Token
 EhFrameReader::scan<true>(ConstAddress pHandler,
                           uint64_t pOffset,
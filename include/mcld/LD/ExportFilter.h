@@ -0,0 +1,106 @@
+//===- ExportFilter.h -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_EXPORT_FILTER_H
+#define MCLD_LD_EXPORT_FILTER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+namespace sys {
+namespace fs {
+class Path;
+} // namespace of fs
+} // namespace of sys
+
+/** \class ExportFilter
+ *  \brief The symbols that --dynamic-list and --version-script export.
+ *
+ *  A version script exports the symbols of its global: parts and hides the
+ *  symbols of its local: parts, e.g., `{ global: foo; bar_*; local: *; };'.
+ *  A dynamic list `{ foo; bar_*; };' exports the listed symbols and hides
+ *  all the others. A name matches before a pattern of `*', `?' and `[...]',
+ *  and a global rule before a local one of the same kind. The symbols that
+ *  match no rule are exported.
+ *
+ *  The hidden definitions are forcefully local, so they never enter the
+ *  dynamic symbol table and their references need no PLT or GOT entry.
+ *  Symbol versions are not created. The patterns of `extern "C++"' need the
+ *  demangled names and are not supported, and then no symbol is hidden.
+ */
+class ExportFilter
+{
+public:
+  ExportFilter();
+
+  ~ExportFilter();
+
+  /// readDynamicList - read the dynamic list file
+  /// @return false if the file can not be read
+  bool readDynamicList(const sys::fs::Path& pPath);
+
+  /// readVersionScript - read the version script file
+  /// @return false if the file can not be read
+  bool readVersionScript(const sys::fs::Path& pPath);
+
+  /// parseDynamicList - add the rules of the dynamic list pContent
+  void parseDynamicList(llvm::StringRef pContent);
+
+  /// parseVersionScript - add the rules of the version script pContent
+  void parseVersionScript(llvm::StringRef pContent);
+
+  /// isExported - can the definition of pName be exported?
+  bool isExported(llvm::StringRef pName) const;
+
+  // ----- observers ----- //
+  bool empty() const;
+
+  bool isDisabled() const
+  { return m_bDisabled; }
+
+private:
+  enum Scope {
+    Global,
+    Local
+  };
+
+  typedef llvm::StringMap<Scope> NameMap;
+  typedef std::vector<std::string> PatternList;
+
+private:
+  /// parse - add the rules of the symbol list pContent. The names out of
+  /// braces are version names and dependencies, and they are skipped.
+  void parse(llvm::StringRef pContent);
+
+  /// addRule - pName or a pattern of pName is in pScope
+  void addRule(llvm::StringRef pName, Scope pScope);
+
+  /// read - read the content of pPath into pContent
+  static bool read(const sys::fs::Path& pPath, std::string& pContent);
+
+private:
+  NameMap m_Names;
+  PatternList m_GlobalPatterns;
+  PatternList m_LocalPatterns;
+
+  /// m_bDisabled - a rule is not supported, and no symbol is hidden
+  bool m_bDisabled;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,70 @@
+//===- FragmentIndex.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_FRAGMENT_INDEX_H
+#define MCLD_LD_FRAGMENT_INDEX_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class SectionData;
+
+/** \class FragmentIndex
+ *  \brief FragmentIndex is a contiguous snapshot of the Fragments of a
+ *  SectionData and their offsets, which are the prefix sums of their sizes.
+ *
+ *  A lookup by offset is a binary search instead of a walk of the fragment
+ *  list. The index is valid until the fragments of the SectionData change.
+ */
+class FragmentIndex
+{
+public:
+  FragmentIndex();
+
+  explicit FragmentIndex(SectionData& pSD);
+
+  /// build - take a snapshot of pSD
+  void build(SectionData& pSD);
+
+  void clear();
+
+  bool empty() const { return m_Fragments.empty(); }
+
+  size_t size() const { return m_Fragments.size(); }
+
+  Fragment* fragment(size_t pIdx) const { return m_Fragments[pIdx]; }
+
+  /// offset - the offset of the pIdx-th fragment. offset(size()) is the size
+  /// of the section data.
+  uint64_t offset(size_t pIdx) const { return m_Offsets[pIdx]; }
+
+  /// find - the fragment of pOffset, the same one as FragmentRef::Create()
+  /// finds. pOffset becomes the offset in that fragment. Return NULL if
+  /// pOffset runs past the last fragment.
+  Fragment* find(uint64_t& pOffset) const;
+
+private:
+  typedef std::vector<Fragment*> FragmentList;
+  typedef std::vector<uint64_t> OffsetList;
+
+private:
+  FragmentList m_Fragments;
+  OffsetList m_Offsets;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -15,13 +15,20 @@
 #include <mcld/LD/ArchiveReader.h>
 #include <mcld/LD/Archive.h>
 
+#include <utility>
+#include <vector>
+
 namespace mcld {
 
 class Module;
 class Input;
 class ELFObjectReader;
+class DynObjReader;
 class MemoryAreaFactory;
 class Archive;
+class ArchiveIndexCache;
+class LinkerConfig;
+class ResolveInfo;
 
 /** \class GNUArchiveReader
  *  \brief GNUArchiveReader reads GNU archive files.
@@ -29,7 +36,13 @@ class Archive;
 class GNUArchiveReader : public ArchiveReader
 {
 public:
-  GNUArchiveReader(Module& pModule, ELFObjectReader& pELFObjectReader);
+  /// GNUArchiveReader
+  /// @param pDynObjReader - the reader of the shared libraries whose symbols
+  ///                        are read lazily, or NULL
+  GNUArchiveReader(Module& pModule,
+                   ELFObjectReader& pELFObjectReader,
+                   const LinkerConfig& pConfig,
+                   DynObjReader* pDynObjReader = NULL);
 
   ~GNUArchiveReader();
 
@@ -40,6 +53,11 @@ public:
   /// isMyFormat
   bool isMyFormat(Input& input) const;
 
+private:
+  /// CandidateList - the armap symbols selected in one round and their
+  /// undefined symbols
+  typedef std::vector<std::pair<size_t, const ResolveInfo*> > CandidateList;
+
 private:
   /// isArchive
   bool isArchive(const char* pStr) const;
@@ -50,6 +68,18 @@ private:
   /// isThinArchive
   bool isThinArchive(Input& input) const;
 
+  /// readMemberName - read the name of a member from its header, and the
+  /// offset of the member in a nested archive if any
+  void readMemberName(const Archive& pArchiveRoot,
+                      const Archive::MemberHeader& pHeader,
+                      std::string& pName,
+                      uint64_t& pNestedOffset) const;
+
+  /// getThinMemberPath - get the path of the member pName of a thin archive
+  void getThinMemberPath(const Input& pArchiveFile,
+                         const std::string& pName,
+                         sys::fs::Path& pPath) const;
+
   /// readMemberHeader - read the header of a member in a archive file and then
   /// return the corresponding archive member (it may be an input object or
   /// another archive)
@@ -61,26 +91,39 @@ private:
   /// @param pMemberSize   - the file size of this member
   Input* readMemberHeader(Archive& pArchiveRoot,
                           Input& pArchiveFile,
-                          uint32_t pFileOffset,
-                          uint32_t& pNestedOffset,
+                          uint64_t pFileOffset,
+                          uint64_t& pNestedOffset,
                           size_t& pMemberSize);
 
   /// readSymbolTable - read the archive symbol map (armap)
+  /// @return false if the archive has no armap
   bool readSymbolTable(Archive& pArchive);
 
   /// readStringTable - read the strtab for long file name of the archive
   bool readStringTable(Archive& pArchive);
 
-  /// shouldIncludeSymbol - given a sym name from armap and check if we should
-  /// include the corresponding archive member, and then return the decision
+  /// buildSymbolTable - build the armap of an archive without one from the
+  /// symbol tables of its members
+  void buildSymbolTable(Archive& pArchive);
+
+  /// shouldIncludeSymbol - given the resolved symbol of an armap entry, check
+  /// if we should include the corresponding archive member, and then return
+  /// the decision
   enum Archive::Symbol::Status
-  shouldIncludeSymbol(const llvm::StringRef& pSymName) const;
+  shouldIncludeSymbol(const ResolveInfo& pInfo) const;
+
+  /// preloadMembers - read the tables of the candidate members in parallel
+  void preloadMembers(Archive& pArchive, const CandidateList& pCandidates);
+
+  /// openThinMembers - open the files of the candidate members of a thin
+  /// archive concurrently
+  void openThinMembers(Archive& pArchive, const CandidateList& pCandidates);
 
   /// includeMember - include the object member in the given file offset, and
   /// return the size of the object
   /// @param pArchiveRoot - the archive root
   /// @param pFileOffset  - file offset of the member header in the archive
-  size_t includeMember(Archive& pArchiveRoot, uint32_t pFileOffset);
+  size_t includeMember(Archive& pArchiveRoot, uint64_t pFileOffset);
 
   /// includeAllMembers - include all object members. This is called if
   /// --whole-archive is the attribute for this archive file.
@@ -89,6 +132,11 @@ private:
 private:
   Module& m_Module;
   ELFObjectReader& m_ELFObjectReader;
+  const LinkerConfig& m_Config;
+  DynObjReader* m_pDynObjReader;
+
+  /// m_pIndexCache - the cache of armap indexes, or NULL if not cached
+  ArchiveIndexCache* m_pIndexCache;
 };
 
 } // namespace of mcld
@@ -0,0 +1,134 @@
+//===- GarbageCollection.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_GARBAGE_COLLECTION_H
+#define MCLD_LD_GARBAGE_COLLECTION_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/LD/ObjectReader.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace mcld {
+
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class TargetLDBackend;
+
+/** \class GarbageCollection
+ *  \brief Implementation of garbage collection for --gc-sections.
+ *
+ *  GarbageCollection removes the input sections that can not be reached from
+ *  the entry symbol, the exported symbols and the sections that must be kept.
+ *  An input section reaches the sections of the symbols its relocations refer
+ *  to. The removed sections and their relocation sections become
+ *  LDFileFormat::Ignore, and the symbols defined in them are removed from the
+ *  output symbol table.
+ *
+ *  GarbageCollection must run after readRelocations() and before
+ *  mergeSections(). If it is given an ObjectReader, the relocation sections
+ *  not read yet are read by rounds: the relocation sections of the sections
+ *  reached in a round are read together, and the sections they refer to are
+ *  followed in the next round. The relocations of the removed sections are
+ *  never read.
+ */
+class GarbageCollection
+{
+public:
+  typedef std::set<const LDSection*> SectionSetTy;
+  typedef std::vector<const LDSection*> SectionListTy;
+  typedef std::map<const LDSection*, SectionListTy> SectionReachedListMap;
+
+public:
+  /// @param pReader reads the relocation sections not read yet. If it is
+  /// NULL, all relocations must have been read.
+  GarbageCollection(const LinkerConfig& pConfig,
+                    const TargetLDBackend& pBackend,
+                    Module& pModule,
+                    ObjectReader* pReader = NULL);
+
+  ~GarbageCollection();
+
+  /// run - do garbage collection
+  bool run();
+
+  /// isKept - the section must be kept by its kind, flags or name, whether
+  /// it is reached or not
+  static bool isKept(const LDSection& pSection);
+
+private:
+  typedef std::map<const LDSection*, ObjectReader::RelocSectionList>
+                                                             PendingRelocMap;
+
+private:
+  /// setUpReachedSections - build the reached sections of every input
+  /// section from the relocations read, and record the relocation sections
+  /// not read yet by their target sections
+  void setUpReachedSections();
+
+  /// setUpReachedSections - build the reached sections from the relocations
+  /// of pRelocSect
+  void setUpReachedSections(const LDSection& pRelocSect);
+
+  /// setUpEhFrameReachedSections - an FDE does not keep its function alive.
+  /// Instead, the function keeps the LSDA referred by its FDE alive.
+  void setUpEhFrameReachedSections(const LDSection& pRelocSect);
+
+  /// getEntrySections - get the sections that must be kept
+  void getEntrySections(SectionListTy& pEntry);
+
+  /// findReferencedSections - mark all sections reachable from pEntry
+  /// @return false if a relocation section cannot be read
+  bool findReferencedSections(SectionListTy& pEntry);
+
+  /// readRelocations - read the relocation sections pList of the reached
+  /// sections, and append the sections they refer to to pEntry
+  bool readRelocations(const ObjectReader::RelocSectionList& pList,
+                       SectionListTy& pEntry);
+
+  /// stripSections - set the unreached sections to LDFileFormat::Ignore
+  void stripSections();
+
+  /// addReachedSection - pTo is reachable if pFrom is kept
+  void addReachedSection(const LDSection& pFrom, const LDSection& pTo);
+
+  /// addSymbolSection - append the section that defines pSymbol to pEntry
+  static void addSymbolSection(const LDSymbol* pSymbol,
+                               SectionListTy& pEntry);
+
+private:
+  /// m_SectionReachedListMap - map a section to the sections it refers to
+  SectionReachedListMap m_SectionReachedListMap;
+
+  /// m_ReferencedSections - the sections that are reached
+  SectionSetTy m_ReferencedSections;
+
+  /// m_PendingRelocs - the relocation sections not read yet, by the sections
+  /// they apply to
+  PendingRelocMap m_PendingRelocs;
+
+  /// m_LateReached - the sections referred by the relocations read after
+  /// their referrers are reached
+  SectionListTy m_LateReached;
+
+  const LinkerConfig& m_Config;
+  const TargetLDBackend& m_Backend;
+  Module& m_Module;
+  ObjectReader* m_pReader;
+};
+
+} // namespace of mcld
+
+#endif
+
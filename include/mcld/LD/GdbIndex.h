@@ -0,0 +1,153 @@
+//===- GdbIndex.h ---------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_GDB_INDEX_H
+#define MCLD_LD_GDB_INDEX_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class Input;
+class LDSection;
+class MemoryArea;
+class Module;
+class ThreadPool;
+
+/** \class GdbIndex
+ *  \brief GdbIndex represents the .gdb_index section of --gdb-index.
+ *
+ *  @ref gdb, Index Section Format, version 7
+ *  uint32_t : version
+ *  uint32_t : the offsets of the CU list, the types CU list, the address
+ *             area, the symbol table and the constant pool
+ *  <uint64_t, uint64_t>+ : CU list, the offsets and the lengths of the
+ *                          compile units in .debug_info
+ *  <uint64_t, uint64_t, uint32_t>+ : address area, the address ranges and
+ *                                    their compile units
+ *  <uint32_t, uint32_t>+ : symbol table, an open addressing hash table of
+ *                          the names and the CU vectors in the constant pool
+ *  constant pool : the CU vectors and the names
+ *
+ *  The compile units and the names of .debug_gnu_pubnames,
+ *  .debug_gnu_pubtypes, .debug_pubnames and .debug_pubtypes are read from
+ *  the objects on the thread pool before the input sections are merged, so
+ *  the fragments of .debug_info and of the code still tell their objects.
+ *  The size of the index is known then, and the offsets and the addresses are
+ *  filled in after the layout. The address ranges of an object are its
+ *  executable sections, which belong to its first compile unit.
+ */
+class GdbIndex
+{
+public:
+  explicit GdbIndex(LDSection& pGdbIndex);
+
+  ~GdbIndex();
+
+  /// read - read the compile units, the code and the public names of the
+  /// objects of pModule
+  void read(Module& pModule, ThreadPool& pThreads);
+
+  /// sizeOutput - compute the size of .gdb_index
+  void sizeOutput();
+
+  /// emitOutput - write out .gdb_index
+  void emitOutput(MemoryArea& pOutput);
+
+  // ----- observers ----- //
+  size_t numOfCompileUnits() const { return m_Units.size(); }
+
+  size_t numOfAddressRanges() const { return m_Ranges.size(); }
+
+  size_t numOfSymbols() const { return m_Symbols.size(); }
+
+  /// Hash - the hash of pName in the symbol table
+  static uint32_t Hash(const std::string& pName);
+
+private:
+  /// CompileUnit - a compile unit at offset in the .debug_info fragment info
+  struct CompileUnit
+  {
+    const Fragment* info;
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  /// AddressRange - the code of the fragment frag
+  struct AddressRange
+  {
+    const Fragment* frag;
+    uint64_t size;
+    uint32_t unit;
+  };
+
+  /// PubName - a public name of the unit-th compile unit of an object, with
+  /// the GDB_INDEX_SYMBOL_KIND and GDB_INDEX_SYMBOL_STATIC bits of attrs
+  struct PubName
+  {
+    std::string name;
+    uint32_t unit;
+    uint32_t attrs;
+  };
+
+  /// ObjectIndex - the parts of the index from an object
+  struct ObjectIndex
+  {
+    std::vector<CompileUnit> units;
+    std::vector<AddressRange> ranges;
+    std::vector<PubName> names;
+  };
+
+  /// Symbol - a name and its CU vector
+  struct Symbol
+  {
+    std::string name;
+    std::vector<uint32_t> units;
+  };
+
+  /// ObjectReader - the parallel_for body
+  struct ObjectReader;
+
+private:
+  /// ReadObject - read the parts of the index from pInput
+  static void ReadObject(Input& pInput, ObjectIndex& pIndex);
+
+  /// ReadPubNames - read the names of the pub section pSection of pInput
+  static void ReadPubNames(Input& pInput,
+                           const LDSection& pSection,
+                           bool pIsGNU,
+                           bool pIsType,
+                           ObjectIndex& pIndex);
+
+private:
+  LDSection& m_GdbIndex;
+
+  std::vector<CompileUnit> m_Units;
+  std::vector<AddressRange> m_Ranges;
+  std::vector<Symbol> m_Symbols;
+  llvm::StringMap<uint32_t> m_SymbolMap;
+
+  // the layout of the section
+  uint32_t m_NumOfSlots;
+  uint32_t m_AddressOffset;
+  uint32_t m_SymbolOffset;
+  uint32_t m_PoolOffset;
+};
+
+} // namespace of mcld
+
+#endif
+
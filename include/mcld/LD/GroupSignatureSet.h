@@ -0,0 +1,78 @@
+//===- GroupSignatureSet.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_GROUP_SIGNATURE_SET_H
+#define MCLD_LD_GROUP_SIGNATURE_SET_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+/** \class GroupSignatureSet
+ *  \brief GroupSignatureSet is the set of the signatures of the section
+ *  groups kept by the link, which decides the first group of a signature to
+ *  win.
+ *
+ *  The set does not copy the signatures. They are StringRefs into the string
+ *  tables of the inputs, which stay in the memory until the inputs are
+ *  destroyed. It is an open addressing table with linear probing, so an
+ *  insertion allocates nothing unless the table grows, and reserve() sizes
+ *  the table ahead.
+ */
+class GroupSignatureSet
+{
+public:
+  GroupSignatureSet();
+
+  /// reserve - make room for pNum signatures in total, so that the next
+  /// insertions up to pNum signatures never grow the table
+  void reserve(size_t pNum);
+
+  /// insert - add pSignature, which must live as long as the set
+  /// @return false if pSignature is already in the set
+  bool insert(llvm::StringRef pSignature);
+
+  bool count(llvm::StringRef pSignature) const;
+
+  size_t size() const { return m_NumOfEntries; }
+
+  bool empty() const { return (0 == m_NumOfEntries); }
+
+  void clear();
+
+private:
+  struct Bucket
+  {
+    const char* data;   ///< NULL if the bucket is empty
+    uint32_t size;
+    uint32_t hash;
+  };
+
+  typedef std::vector<Bucket> BucketList;
+
+private:
+  /// lookup - the bucket of pSignature, or the empty bucket to put it
+  size_t lookup(llvm::StringRef pSignature, uint32_t pHash) const;
+
+  void grow(size_t pNumOfBuckets);
+
+private:
+  BucketList m_Buckets;
+  size_t m_NumOfEntries;
+};
+
+} // namespace of mcld
+
+#endif
+
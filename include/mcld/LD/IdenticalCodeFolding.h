@@ -0,0 +1,128 @@
+//===- IdenticalCodeFolding.h ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_IDENTICAL_CODE_FOLDING_H
+#define MCLD_LD_IDENTICAL_CODE_FOLDING_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+namespace mcld {
+
+class Fragment;
+class LDSection;
+class LinkerConfig;
+class Module;
+class RegionFragment;
+class Relocation;
+
+/** \class IdenticalCodeFolding
+ *  \brief Implementation of identical code folding for --icf.
+ *
+ *  The candidates are the executable .text.* input sections that hold one
+ *  RegionFragment. Two candidates are identical if they have the same bytes,
+ *  the same relocations, and the relocations refer to the same targets or to
+ *  identical candidates.
+ *
+ *  The candidates are first grouped by their bytes and the relocations to
+ *  non-candidates. The groups are then refined by the groups of the
+ *  referred candidates until no group splits any more. Hashes of both steps
+ *  are computed in parallel, and the members of a group are always compared
+ *  completely, so hash collisions never fold different codes.
+ *
+ *  Every group is folded into its first member in the input order. The other
+ *  members become LDFileFormat::Ignore, and the symbols defined in them are
+ *  moved to the first member.
+ *
+ *  IdenticalCodeFolding must run after readRelocations() and before
+ *  mergeSections().
+ */
+class IdenticalCodeFolding
+{
+public:
+  IdenticalCodeFolding(const LinkerConfig& pConfig, Module& pModule);
+
+  ~IdenticalCodeFolding();
+
+  /// foldIdenticalCode - fold the identical candidates
+  /// @return the number of folded sections
+  size_t foldIdenticalCode();
+
+  /// isCtorOrDtor - is pName the Itanium C++ ABI name of a constructor or a
+  /// destructor? --icf=safe only folds the sections of those.
+  static bool isCtorOrDtor(llvm::StringRef pName);
+
+private:
+  struct FoldingCandidate
+  {
+    LDSection* sect;
+    RegionFragment* frag;
+
+    /// relocs - relocations applied to the section, sorted by offset
+    std::vector<const Relocation*> relocs;
+  };
+
+  typedef std::vector<FoldingCandidate> FoldingCandidates;
+  typedef std::map<const Fragment*, size_t> CandidateIndexMap;
+
+  typedef uint64_t (IdenticalCodeFolding::*HashFunc)(size_t) const;
+  typedef bool (IdenticalCodeFolding::*EqualsFunc)(size_t, size_t) const;
+
+  /// Hasher - the parallel_for body of the hash functions
+  struct Hasher;
+
+private:
+  /// findCandidates - collect the candidates and their relocations
+  void findCandidates();
+
+  /// removeUnsafeCandidates - --icf=safe only folds ctors and dtors
+  void removeUnsafeCandidates();
+
+  /// getCandidate - the index of the candidate that holds pFrag, or -1.
+  size_t getCandidate(const Fragment* pFrag) const;
+
+  /// hashConstant - hash the parts that do not depend on the classes
+  uint64_t hashConstant(size_t pIdx) const;
+
+  /// hashVariable - hash the classes of the referred candidates
+  uint64_t hashVariable(size_t pIdx) const;
+
+  bool equalsConstant(size_t pA, size_t pB) const;
+
+  bool equalsVariable(size_t pA, size_t pB) const;
+
+  /// partition - give the candidates with the same pHashes and pEquals new
+  /// classes.
+  /// @return the number of classes
+  size_t partition(const std::vector<uint64_t>& pHashes, EqualsFunc pEquals);
+
+  /// fold - fold every class into its first member
+  size_t fold();
+
+private:
+  const LinkerConfig& m_Config;
+  Module& m_Module;
+
+  FoldingCandidates m_Candidates;
+  CandidateIndexMap m_CandidateIndex;
+
+  /// m_Classes - the equivalence class of each candidate
+  std::vector<size_t> m_Classes;
+};
+
+} // namespace of mcld
+
+#endif
+
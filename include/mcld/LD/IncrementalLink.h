@@ -0,0 +1,199 @@
+//===- IncrementalLink.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_INCREMENTAL_LINK_H
+#define MCLD_LD_INCREMENTAL_LINK_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace mcld {
+
+class Input;
+class LinkerConfig;
+class Module;
+class RegionFragment;
+
+/** \class IncrementalLink
+ *  \brief IncrementalLink updates the output of the last link in place when
+ *  only the contents of some relocatable objects are changed.
+ *
+ *  After a full link with --incremental, the state of the link is saved
+ *  beside the output in <output>.inc: the key of the command line, the size
+ *  and the hash of the output, and the content hash of every input file.
+ *  For a relocatable object, its shape and every section are also recorded.
+ *  The shape is the digest of the section headers and the bytes around the
+ *  relocation places. A section is recorded with the hash of its contents,
+ *  and with the file offset of its contents in the output if they are copied
+ *  verbatim into the output.
+ *
+ *  On relink, the inputs are hashed in parallel. If no input is changed, the
+ *  output is up to date. If the changed inputs are relocatable objects of
+ *  the same shapes, and only their verbatim sections are changed, the new
+ *  contents are written into the output in place, except the bytes around
+ *  the relocation places, which are the same and hold the applied results.
+ *  The symbol tables and the relocation sections are compared by their
+ *  contents, so the symbols are resolved as before and no other part of the
+ *  output is changed. Otherwise, a full link is needed.
+ */
+class IncrementalLink
+{
+public:
+  enum {
+    /// the bytes around a relocation place that may be rewritten by the
+    /// relocation, including the relaxation of its instruction sequence
+    WindowBefore = 8,
+    WindowAfter = 16
+  };
+
+  /// Range - [begin, end) of the contents of a section
+  struct Range
+  {
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  typedef std::vector<Range> RangeList;
+
+  /// SectionShape - a section header of a relocatable object
+  struct SectionShape
+  {
+    uint32_t type;
+    uint64_t flag;
+    uint64_t offset;
+    uint64_t size;
+
+    /// windows - the sorted and disjoint ranges around the relocation places
+    RangeList windows;
+  };
+
+  /// Shape - the parsed section headers of a relocatable object
+  struct Shape
+  {
+    uint64_t digest;
+    std::vector<SectionShape> sections;
+  };
+
+public:
+  IncrementalLink(const LinkerConfig& pConfig,
+                  const std::string& pOutput,
+                  uint64_t pKey);
+
+  ~IncrementalLink();
+
+  /// update - bring the output of the last link up to date in place.
+  /// @return false if a full link is needed
+  bool update();
+
+  /// record - save the state of the full link of pModule, whose output has
+  /// been written.
+  bool record(Module& pModule);
+
+  // -----  observers  ----- //
+  const std::string& stateFile() const { return m_StateFile; }
+
+  /// Scan - parse the section headers and the relocations of the host-endian
+  /// relocatable object in the pSize bytes of pData.
+  /// @return false if pData is not such an object
+  static bool Scan(const uint8_t* pData, size_t pSize, Shape& pShape);
+
+private:
+  enum SectionKind {
+    /// Fixed - the contents must be the same
+    Fixed,
+    /// Verbatim - the contents are copied into the output at outOffset
+    Verbatim,
+    /// Discarded - the section is not in the output
+    Discarded
+  };
+
+  struct SectionRecord
+  {
+    uint32_t kind;
+    uint64_t hash;
+    uint64_t outOffset;
+  };
+
+  struct FileRecord
+  {
+    std::string path;
+    uint64_t hash;
+    bool isObject;
+    uint64_t shape;
+    std::vector<SectionRecord> sections;
+  };
+
+  typedef std::vector<FileRecord> FileList;
+
+  /// FileImage - a recorded file read by this run
+  struct FileImage
+  {
+    bool exists;
+    uint64_t hash;
+
+    /// scanned - the shape and the section hashes are computed
+    bool scanned;
+    Shape shape;
+    std::vector<uint64_t> sectionHashes;
+
+    /// contents - the bytes of a changed object
+    std::vector<uint8_t> contents;
+  };
+
+  typedef std::vector<FileImage> ImageList;
+
+  /// FragmentMap - the region fragments of the output by their contents
+  typedef std::map<const uint8_t*, const RegionFragment*> FragmentMap;
+
+  /// FileHasher - the parallel_for body of hashFiles()
+  struct FileHasher;
+
+private:
+  /// load - read the state file
+  bool load();
+
+  /// save - write the state file
+  bool save() const;
+
+  /// hashFiles - read and hash the files in parallel. The objects are
+  /// scanned if pScanAll or if they are changed, and the contents of the
+  /// changed objects are kept.
+  void hashFiles(bool pScanAll, ImageList& pImages) const;
+
+  /// recordObject - record the sections of the object pInput
+  void recordObject(Input& pInput, const FileImage& pImage,
+                    const FragmentMap& pFragments, FileRecord& pFile) const;
+
+  /// checkOutput - is the output the one recorded?
+  bool checkOutput() const;
+
+  /// recordOutput - record the size and the hash of the output
+  bool recordOutput();
+
+private:
+  const LinkerConfig& m_Config;
+  std::string m_Output;
+  std::string m_StateFile;
+  uint64_t m_Key;
+
+  uint64_t m_OutputSize;
+  uint64_t m_OutputHash;
+  FileList m_Files;
+};
+
+} // namespace of mcld
+
+#endif
+
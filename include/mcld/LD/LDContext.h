@@ -15,6 +15,7 @@
 #include <vector>
 #include <mcld/LD/LDFileFormat.h>
 #include <llvm/Support/DataTypes.h>
+#include <llvm/ADT/StringMap.h>
 #include <string>
 #include <cassert>
 
@@ -45,6 +46,10 @@ public:
   // -----  sections  ----- //
   LDContext& appendSection(LDSection& pSection);
 
+  /// reserveSections - make room for pNum sections in the section table
+  void reserveSections(size_t pNum)
+  { m_SectionTable.reserve(pNum); }
+
   const_sect_iterator sectBegin() const { return m_SectionTable.begin(); }
   sect_iterator       sectBegin()       { return m_SectionTable.begin(); }
 
@@ -72,6 +77,12 @@ public:
   void addSymbol(LDSymbol* pSym)
   { m_SymTab.push_back(pSym); }
 
+  const_sym_iterator symTabBegin() const { return m_SymTab.begin(); }
+  sym_iterator       symTabBegin()       { return m_SymTab.begin(); }
+
+  const_sym_iterator symTabEnd() const { return m_SymTab.end(); }
+  sym_iterator       symTabEnd()       { return m_SymTab.end(); }
+
   // -----  relocations  ----- //
   const_sect_iterator relocSectBegin() const { return m_RelocSections.begin(); }
   sect_iterator       relocSectBegin()       { return m_RelocSections.begin(); }
@@ -84,7 +95,8 @@ private:
   SymbolTable m_SymTab;
   SectionTable m_RelocSections;
 
-  // FIXME : maintain a map<section name, section index>
+  /// m_SectionIndex - the index of the first section of every name
+  llvm::StringMap<size_t> m_SectionIndex;
 };
 
 
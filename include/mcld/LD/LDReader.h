@@ -39,6 +39,11 @@ public:
 
   virtual bool isMyFormat(Input& pInput) const = 0;
 
+  /// Sniff - the type of pInput which the magic of its probe claims, by a
+  /// table of the known magics: Input::Object or Input::DynObj for ELF,
+  /// Input::Archive for an archive, or Input::Unknown. Only the reader of
+  /// that type needs to check the input by isMyFormat().
+  static unsigned int Sniff(Input& pInput);
 };
 
 } // namespace of mcld
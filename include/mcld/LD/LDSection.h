@@ -17,6 +17,7 @@
 #include <mcld/Support/Allocators.h>
 #include <mcld/Config/Config.h>
 #include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/SectionAtom.h>
 #include <string>
 
 namespace mcld {
@@ -31,6 +32,9 @@ class EhFrame;
  */
 class LDSection
 {
+public:
+  enum { NoOrder = ~0u };
+
 private:
   friend class Chunk<LDSection, MCLD_SECTIONS_PER_INPUT>;
 
@@ -61,7 +65,12 @@ public:
 
   /// name - the name of this section.
   const std::string& name() const
-  { return m_Name; }
+  { return m_pAtom->name(); }
+
+  /// atom - the interned name of this section. Two sections have the same
+  /// name if and only if they have the same atom.
+  const SectionAtom& atom() const
+  { return *m_pAtom; }
 
   /// kind - the kind of this section, such as Text, BSS, GOT, and so on.
   /// from LDFileFormat::Kind
@@ -82,6 +91,11 @@ public:
   uint32_t flag() const
   { return m_Flag; }
 
+  /// isCompressed - is the content an Elf_Chdr and the compressed data?
+  ///   In ELF, sh_flags has SHF_COMPRESSED.
+  bool isCompressed() const
+  { return (0x0 != (m_Flag & 0x800)); } // SHF_COMPRESSED
+
   /// size - An integer specifying the size in bytes of the virtual memory
   /// occupied by this section.
   ///   In ELF, if the type() is SHT_NOBITS, this function return zero.
@@ -112,6 +126,11 @@ public:
   uint32_t align() const
   { return m_Align; }
 
+  /// entSize - the size of the fixed-sized entries, e.g., the characters of
+  ///   a SHF_MERGE|SHF_STRINGS section, or zero.
+  uint64_t entSize() const
+  { return m_EntSize; }
+
   size_t index() const
   { return m_Index; }
 
@@ -129,6 +148,14 @@ public:
   size_t getInfo() const
   { return m_Info; }
 
+  /// order - the layout order of an output section cached by the backend,
+  /// or NoOrder if it is not computed yet.
+  unsigned int order() const
+  { return m_Order; }
+
+  bool hasOrder() const
+  { return (NoOrder != m_Order); }
+
   void setKind(LDFileFormat::Kind pKind)
   { m_Kind = pKind; }
 
@@ -144,6 +171,9 @@ public:
   void setAlign(uint32_t align)
   { m_Align = align; }
 
+  void setEntSize(uint64_t pEntSize)
+  { m_EntSize = pEntSize; }
+
   void setFlag(uint32_t flag)
   { m_Flag = flag; }
 
@@ -185,6 +215,13 @@ public:
   void setIndex(size_t pIndex)
   { m_Index = pIndex; }
 
+  void setOrder(unsigned int pOrder)
+  { m_Order = pOrder; }
+
+  /// resetOrder - forget the cached order, e.g., when the flags are changed
+  void resetOrder()
+  { m_Order = NoOrder; }
+
 private:
   union SectOrRelocData
   {
@@ -194,7 +231,7 @@ private:
   };
 
 private:
-  std::string m_Name;
+  const SectionAtom* m_pAtom;
 
   LDFileFormat::Kind m_Kind;
   uint32_t m_Type;
@@ -204,6 +241,7 @@ private:
   uint64_t m_Offset;
   uint64_t m_Addr;
   uint32_t m_Align;
+  uint64_t m_EntSize;
 
   size_t m_Info;
   LDSection* m_pLink;
@@ -214,6 +252,9 @@ private:
   /// m_Index - the index of the file
   size_t m_Index;
 
+  /// m_Order - the cached layout order
+  unsigned int m_Order;
+
 }; // end of LDSection
 
 } // end namespace mcld
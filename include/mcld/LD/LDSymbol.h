@@ -16,6 +16,7 @@
 
 #include <mcld/Config/Config.h>
 #include <mcld/ADT/Uncopyable.h>
+#include <mcld/Fragment/FragmentRef.h>
 #include <mcld/LD/ResolveInfo.h>
 #include <mcld/Support/Allocators.h>
 
@@ -23,8 +24,6 @@
 
 namespace mcld {
 
-class FragmentRef;
-
 /** \class LDSymbol
  *  \brief LDSymbol provides a consistent abstraction for different formats
  *  in different targets.
@@ -37,7 +36,9 @@ public:
   typedef uint64_t ValueType;
 
 public:
-  ~LDSymbol();
+  // an empty inline destructor lets the factory free its chunks without
+  // walking the symbols.
+  ~LDSymbol() { }
 
   // -----  factory method ----- //
   static LDSymbol* Create(ResolveInfo& pResolveInfo);
@@ -101,7 +102,7 @@ public:
   { return m_Value; }
 
   const FragmentRef* fragRef() const
-  { return m_pFragRef; }
+  { return hasFragRef() ? &m_FragRef : FragmentRef::Null(); }
 
   SizeType size() const
   { return m_pResolveInfo->size(); }
@@ -112,7 +113,8 @@ public:
   const ResolveInfo* resolveInfo() const 
   { return m_pResolveInfo; }
 
-  bool hasFragRef() const;
+  bool hasFragRef() const
+  { return (NULL != m_FragRef.frag()); }
 
   // -----  modifiers  ----- //
   void setSize(SizeType pSize) {
@@ -123,7 +125,9 @@ public:
   void setValue(ValueType pValue)
   { m_Value = pValue; }
  
-  void setFragmentRef(FragmentRef* pFragmentRef);
+  /// setFragmentRef - copy pFragmentRef into the symbol. A symbol holds its
+  /// FragmentRef in place, so pFragmentRef can be a temporary one.
+  void setFragmentRef(const FragmentRef* pFragmentRef);
 
   void setResolveInfo(const ResolveInfo& pInfo);
 
@@ -138,7 +142,7 @@ private:
 private:
   // -----  Symbol's fields  ----- //
   ResolveInfo* m_pResolveInfo;
-  FragmentRef* m_pFragRef;
+  FragmentRef m_FragRef;
   ValueType m_Value;
 
 };
@@ -0,0 +1,139 @@
+//===- LinkCache.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_LINK_CACHE_H
+#define MCLD_LD_LINK_CACHE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Support/Path.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class FileHandle;
+class LinkerConfig;
+class MemoryArea;
+class Module;
+
+/** \class LinkCache
+ *  \brief LinkCache keeps the outputs of the links in a directory by the
+ *  hashes of their command lines and their inputs, so a link repeated with
+ *  the same inputs copies the cached output instead of linking again.
+ *
+ *  The key of a link is the hash of the command line, the target triple,
+ *  the type of the output, the files named by the options, and the path and
+ *  the content hash of every file in the input tree, which is built but not
+ *  normalized yet. The members of an archive are keyed by the whole archive.
+ *  The cached output of a key is <dir>/<key>.out.
+ *
+ *  Hashing the inputs is the most of the work of a lookup, so the hashes are
+ *  also kept in <dir>/inputs.stamps with the device, the inode, the size and
+ *  the modification time of their files. A file having the same stamp is
+ *  not read again. A hash is trusted only if its file was modified before
+ *  the second the hash was computed in, so a file changed right after its
+ *  hashing is read again.
+ *
+ *  The files of the cache are written into temporary files and then renamed,
+ *  so concurrent links never see a partial file.
+ */
+class LinkCache
+{
+public:
+  /// Stamp - the stamp and the content hash of an input file
+  struct Stamp
+  {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    uint64_t modTime;
+    uint64_t hashTime;
+    uint64_t hash;
+  };
+
+  typedef std::map<std::string, Stamp> StampMap;
+
+public:
+  LinkCache(const LinkerConfig& pConfig, const sys::fs::Path& pDir);
+
+  ~LinkCache();
+
+  /// lookup - compute the key of the link of pModule, whose input tree is
+  /// built, and find its cached output.
+  /// @return true if the output is cached
+  bool lookup(const Module& pModule);
+
+  /// restore - write the cached output found by lookup() into pOutput
+  bool restore(MemoryArea& pOutput) const;
+
+  /// store - copy the output written in pOutput into the cache
+  bool store(MemoryArea& pOutput) const;
+
+  // -----  observers  ----- //
+  bool isHit() const { return (NULL != m_pCachedFile); }
+
+  uint64_t key() const { return m_Key; }
+
+  /// getCachePath - the path of the cached output of the key
+  sys::fs::Path getCachePath() const;
+
+  /// ParseStamps - parse the stamp file in pText into pStamps, dropping the
+  /// stamps whose hashes are not trusted.
+  static void ParseStamps(const std::string& pText, StampMap& pStamps);
+
+  /// PrintStamps - print pStamps in the format of the stamp file
+  static void PrintStamps(const StampMap& pStamps, std::string& pText);
+
+private:
+  /// InputFile - an input file to hash
+  struct InputFile
+  {
+    std::string path;
+    bool stamped;
+    Stamp stamp;
+    bool hashed;
+  };
+
+  typedef std::vector<InputFile> InputList;
+
+  /// InputHasher - the parallel_for body of hashInputs()
+  struct InputHasher;
+
+private:
+  /// hashInputs - hash the files whose stamps are changed in parallel
+  void hashInputs(InputList& pInputs) const;
+
+  /// loadStamps - read the stamp file
+  void loadStamps();
+
+  /// saveStamps - write the stamp file
+  bool saveStamps() const;
+
+private:
+  const LinkerConfig& m_Config;
+  sys::fs::Path m_Dir;
+  uint64_t m_Key;
+
+  /// m_bKeyed - all inputs are hashed into m_Key
+  bool m_bKeyed;
+
+  /// m_pCachedFile - the cached output kept opened since lookup()
+  FileHandle* m_pCachedFile;
+  StampMap m_Stamps;
+};
+
+} // namespace of mcld
+
+#endif
+
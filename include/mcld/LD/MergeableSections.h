@@ -0,0 +1,208 @@
+//===- MergeableSections.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_MERGEABLE_SECTIONS_H
+#define MCLD_LD_MERGEABLE_SECTIONS_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+namespace mcld {
+
+class Fragment;
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class PackedRelocData;
+class RegionFragment;
+class Relocation;
+class TargetLDBackend;
+
+/** \class MergeableSections
+ *  \brief Remove the duplicated pieces of the SHF_MERGE input sections.
+ *
+ *  A SHF_MERGE section is split into pieces, the null-terminated strings if
+ *  it is also SHF_STRINGS, or the fixed-size entries of sh_entsize bytes.
+ *  The candidates are grouped by their output sections, flags, entry sizes
+ *  and alignments, and a piece is dropped if an identical piece of the same
+ *  group comes before it in the input order.
+ *
+ *  The pieces are split and hashed in parallel, and are deduplicated in
+ *  shards of their hashes, so every shard is scanned by one thread and the
+ *  result never depends on the threads.
+ *
+ *  The kept pieces of a candidate are rebuilt into a RegionFragment for each
+ *  run of adjacent kept pieces. The symbols defined in a dropped piece are
+ *  moved into the kept one, and the relocations against the section symbol
+ *  are redirected to a new section symbol of the section holding the kept
+ *  piece. A relocation whose addend can not be redirected, a REL relocation
+ *  with the addend in a place the target does not know, pins its section:
+ *  the pieces of a pinned section are never dropped.
+ *
+ *  MergeableSections must run after readRelocations() and before
+ *  mergeSections().
+ */
+class MergeableSections
+{
+public:
+  enum { NumOfShards = 64 };
+
+  /// Piece - a string or an entry of a candidate
+  struct Piece
+  {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t hash;
+
+    /// leader - the index of the kept piece identical to this one
+    size_t leader;
+
+    /// frag, fragOffset - the place of a kept piece after the rewrite
+    Fragment* frag;
+    uint64_t fragOffset;
+  };
+
+  typedef std::vector<Piece> PieceList;
+
+public:
+  MergeableSections(const LinkerConfig& pConfig,
+                    TargetLDBackend& pBackend,
+                    Module& pModule);
+
+  ~MergeableSections();
+
+  /// merge - drop the duplicated pieces
+  /// @return the number of the dropped bytes
+  uint64_t merge();
+
+  /// Split - split the pSize bytes of pData into the pieces of entry size
+  /// pEntSize.
+  /// @return false if a string is not terminated
+  static bool Split(const uint8_t* pData,
+                    uint64_t pSize,
+                    uint64_t pEntSize,
+                    bool pIsString,
+                    PieceList& pPieces);
+
+private:
+  struct Candidate
+  {
+    LDSection* sect;
+    RegionFragment* frag;
+
+    /// group - the index of the output section, flags, entsize and align
+    size_t group;
+
+    /// first, last - the pieces of the candidate are [first, last) of
+    /// m_Pieces
+    size_t first;
+    size_t last;
+
+    /// pinned - the pieces of the candidate can not be dropped
+    bool pinned;
+
+    /// rewritten - some pieces of the candidate are dropped
+    bool rewritten;
+
+    /// sectSymbol - the section symbol of the rewritten section
+    LDSymbol* sectSymbol;
+  };
+
+  typedef std::vector<Candidate> CandidateList;
+  typedef std::map<const Fragment*, size_t> CandidateIndexMap;
+
+  /// Splitter, Deduplicator - the parallel_for bodies
+  struct Splitter;
+  struct Deduplicator;
+
+private:
+  /// findCandidates - collect the SHF_MERGE sections and their groups
+  void findCandidates();
+
+  /// pinCandidates - pin the candidates whose references can not be moved
+  void pinCandidates();
+
+  /// pinPackedRelocations - pinCandidates() for the packed relocations
+  void pinPackedRelocations(const PackedRelocData& pRelocs);
+
+  /// deduplicate - find the leaders of the pieces in shard pShard
+  void deduplicate(size_t pShard);
+
+  /// equals - are the pieces pA and pB of the same group identical?
+  bool equals(size_t pA, size_t pB) const;
+
+  /// rewrite - rebuild the fragments of a candidate from its kept pieces
+  /// @return the number of the dropped bytes
+  uint64_t rewrite(size_t pIdx);
+
+  /// redirectRelocations - move the relocations against the section symbols
+  void redirectRelocations();
+
+  /// redirectPackedRelocations - redirectRelocations() for the packed
+  /// relocations
+  void redirectPackedRelocations(PackedRelocData& pRelocs);
+
+  /// redirectSymbols - move the symbols defined in the candidates
+  void redirectSymbols();
+
+  /// getCandidate - the index of the candidate that holds pFrag, or -1.
+  size_t getCandidate(const Fragment* pFrag) const;
+
+  /// getPiece - the index of the piece of candidate pIdx at pOffset, or the
+  /// end of the pieces if pOffset is the size of the section.
+  size_t getPiece(size_t pIdx, uint64_t pOffset) const;
+
+  /// getSectionOffset - the offset in its section of pOffset bytes after
+  /// the start of piece pPiece after the rewrite.
+  uint64_t getSectionOffset(size_t pPiece, uint64_t pOffset) const;
+
+  /// getSectionSymbol - the section symbol referring to the start of the
+  /// candidate pIdx after the rewrite.
+  LDSymbol* getSectionSymbol(size_t pIdx);
+
+  /// getRedirection - the section symbol and the offset pOffset from it
+  /// that the target pTarget in candidate pIdx is moved to
+  LDSymbol* getRedirection(size_t pIdx, int64_t pTarget, uint64_t& pOffset);
+
+  /// getRelocTarget - the offset the relocation pReloc against the section
+  /// symbol refers to in its section.
+  /// @return false if the addend of pReloc can not be rewritten
+  bool getRelocTarget(const Relocation& pReloc, bool pIsRel,
+                      int64_t& pOffset) const;
+
+  /// getBytes - the contents of piece pIdx
+  llvm::StringRef getBytes(size_t pIdx) const;
+
+private:
+  const LinkerConfig& m_Config;
+  TargetLDBackend& m_Backend;
+  Module& m_Module;
+
+  CandidateList m_Candidates;
+  CandidateIndexMap m_CandidateIndex;
+  PieceList m_Pieces;
+
+  /// m_Owners - the candidate of each piece
+  std::vector<size_t> m_Owners;
+
+  /// m_Removed - the original fragments of the rewritten candidates
+  std::vector<RegionFragment*> m_Removed;
+};
+
+} // namespace of mcld
+
+#endif
+
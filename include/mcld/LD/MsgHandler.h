@@ -21,11 +21,14 @@ namespace mcld {
 
 /** \class MsgHandler
  *  \brief MsgHandler controls the timing to output message.
+ *
+ *  MsgHandler gives the arguments to pState, the state of the engine or of
+ *  the buffer of a thread. If pState is NULL, the message is dropped.
  */
 class MsgHandler
 {
 public:
-  MsgHandler(DiagnosticEngine& pEngine);
+  MsgHandler(DiagnosticEngine& pEngine, DiagnosticEngine::State* pState);
   ~MsgHandler();
 
   bool emit();
@@ -38,10 +41,11 @@ public:
 
 private:
   void flushCounts()
-  { m_Engine.state().numArgs = m_NumArgs; }
+  { m_pState->numArgs = m_NumArgs; }
 
 private:
   DiagnosticEngine& m_Engine;
+  DiagnosticEngine::State* m_pState;
   mutable unsigned int m_NumArgs;
 };
 
@@ -18,9 +18,10 @@
 #include <mcld/ADT/Uncopyable.h>
 #include <mcld/LD/Resolver.h>
 #include <mcld/LD/ResolveInfo.h>
-#include <mcld/Support/GCFactory.h>
+#include <mcld/LD/ResolveInfoFactory.h>
 
 #include <utility>
+#include <vector>
 
 #include <llvm/ADT/StringRef.h>
 
@@ -34,13 +35,30 @@ class SectionData;
  *  \brief Store symbol and search symbol by name. Can help symbol resolution.
  *
  *  - MCLinker is responsed for creating NamePool.
+ *
+ *  insertSymbol() resolves a symbol at once and must be called by one
+ *  thread.
+ *
+ *  A reader inserts the symbols of an input in batches. prefetch() hashes
+ *  the names of a batch and prefetches their buckets, so the cache misses
+ *  of the batch overlap, and insertSymbol() then takes the hash values
+ *  instead of hashing the names again.
  */
 class NamePool : private Uncopyable
 {
 public:
-  typedef HashTable<ResolveInfo, StringHash<ELF> > Table;
+  /// The symbols are hashed by MurmurHash64A. The SysV and GNU hashes of the
+  /// dynamic symbols are computed when .hash and .gnu.hash are emitted.
+  typedef HashTable<ResolveInfo,
+                    StringHash<MURMUR>,
+                    ResolveInfoFactory> Table;
   typedef size_t size_type;
 
+  typedef std::vector<ResolveInfo*> UndefListType;
+
+  /// the number of the names prefetched at a time
+  enum { BatchSize = 32 };
+
 public:
   explicit NamePool(size_type pSize = 3);
 
@@ -61,6 +79,7 @@ public:
   /// @param pOldInfo - if pOldInfo is not NULL, the old ResolveInfo being
   ///                   overriden is kept in pOldInfo.
   /// @param pResult the result of symbol resultion.
+  /// @param pOrdinal the ordinal of the input of the symbol
   /// @note pResult.override is true if the output LDSymbol also need to be
   ///       overriden
   void insertSymbol(const llvm::StringRef& pName,
@@ -71,7 +90,16 @@ public:
                     ResolveInfo::SizeType pSize,
                     ResolveInfo::Visibility pVisibility,
                     ResolveInfo* pOldInfo,
-                    Resolver::Result& pResult);
+                    Resolver::Result& pResult,
+                    unsigned int pOrdinal = ResolveInfo::NoOrdinal);
+
+  /// prefetch - hash the names of the next pNum symbols to be inserted, at
+  /// most BatchSize, and prefetch their buckets. insertSymbol() takes the
+  /// hash value of a name which is the same string in the memory. Some of
+  /// the symbols may be skipped or renamed, they are simply hashed again.
+  /// The names must live until the next prefetch(), and prefetch(NULL, 0)
+  /// forgets them.
+  void prefetch(const llvm::StringRef* pNames, size_t pNum);
 
   /// findSymbol - find the resolved output LDSymbol
   const LDSymbol* findSymbol(const llvm::StringRef& pName) const;
@@ -93,18 +121,58 @@ public:
   bool empty() const
   { return m_Table.empty(); }
 
+  /// getUndefList - the symbols in the order they become non-weak undefined
+  /// or first appear as weak undefined. A symbol may appear more than once,
+  /// and may have been defined after it was appended. Readers of archives use
+  /// this list as the work list of the symbols to be resolved.
+  const UndefListType& getUndefList() const
+  { return m_UndefList; }
+
   // -----  capacity  ----- //
+  /// reserve - make room for pN symbols, so the pool does not rehash until
+  /// it holds more than pN symbols. reserve() never shrinks the pool.
   void reserve(size_type pN);
 
   size_type capacity() const;
 
 private:
-  typedef GCFactory<ResolveInfo*, 128> FreeInfoSet;
+  /// Hint - a name of the batch of prefetch() and its hash value
+  struct Hint
+  {
+    const char* name;
+    size_t size;
+    size_t hash;
+  };
+
+private:
+  /// hashOf - the hash value of pName, which may be computed by prefetch()
+  size_t hashOf(const llvm::StringRef& pName);
+
+  /// doInsertSymbol - insert a symbol of the hash value pHash and resolve it
+  /// @return the symbol to be appended to the undef list, or NULL
+  ResolveInfo* doInsertSymbol(size_t pHash,
+                              const llvm::StringRef& pName,
+                              bool pIsDyn,
+                              ResolveInfo::Type pType,
+                              ResolveInfo::Desc pDesc,
+                              ResolveInfo::Binding pBinding,
+                              ResolveInfo::SizeType pSize,
+                              ResolveInfo::Visibility pVisibility,
+                              ResolveInfo* pOldInfo,
+                              Resolver::Result& pResult,
+                              unsigned int pOrdinal);
 
 private:
   Resolver* m_pResolver;
   Table m_Table;
-  FreeInfoSet m_FreeInfoSet;
+  /// m_LocalFactory - the factory of the ResolveInfos of createSymbol()
+  ResolveInfoFactory m_LocalFactory;
+  UndefListType m_UndefList;
+
+  /// the batch of prefetch(), from m_NextHint on not inserted yet
+  Hint m_Hints[BatchSize];
+  unsigned int m_NumOfHints;
+  unsigned int m_NextHint;
 };
 
 } // namespace of mcld
@@ -13,14 +13,16 @@
 #endif
 #include "mcld/LD/LDReader.h"
 #include <llvm/Support/system_error.h>
-#include <mcld/ADT/HashTable.h>
-#include <mcld/ADT/StringHash.h>
-#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/GroupSignatureSet.h>
+
+#include <utility>
+#include <vector>
 
 namespace mcld {
 
 class Module;
 class Input;
+class LDSection;
 
 /** \class ObjectReader
  *  \brief ObjectReader provides an common interface for different object
@@ -28,15 +30,27 @@ class Input;
  */
 class ObjectReader : public LDReader
 {
-protected:
-  typedef HashTable<ResolveInfo, StringHash<ELF> > GroupSignatureMap;
+public:
+  /// RelocSectionList - relocation sections and the files they belong to
+  typedef std::vector<std::pair<Input*, LDSection*> > RelocSectionList;
 
 protected:
   ObjectReader()
   { }
 
 public:
-  virtual ~ObjectReader() { f_GroupSignatureMap.clear(); }
+  virtual ~ObjectReader() { }
+
+  /// preload - read the headers and the symbol table of the file into memory
+  /// without creating any IR. This function may be called concurrently on
+  /// the files which have distinct MemoryAreas.
+  ///   @return true if the file is in my format.
+  virtual bool preload(Input& pFile) = 0;
+
+  /// numOfGlobalSymbols - the number of non-local symbols of the file, which
+  /// is known as soon as the section header table is read.
+  ///   @return 0 if the file is not in my format or has no symbol table.
+  virtual size_t numOfGlobalSymbols(Input& pFile) = 0;
 
   virtual bool readHeader(Input& pFile) = 0;
 
@@ -49,14 +63,22 @@ public:
   /// This function should be called after symbol resolution.
   virtual bool readRelocations(Input& pFile) = 0;
 
-  GroupSignatureMap& signatures()
-  { return f_GroupSignatureMap; }
+  /// readRelocations - read the relocation sections of pList, which may
+  /// belong to different files. The sections which are already read or
+  /// ignored are skipped.
+  ///
+  /// This function should be called after symbol resolution.
+  virtual bool readRelocations(const RelocSectionList& pList) = 0;
+
+  /// signatures - the signatures of the section groups kept by the link
+  GroupSignatureSet& signatures()
+  { return f_GroupSignatures; }
 
-  const GroupSignatureMap& signatures() const
-  { return f_GroupSignatureMap; }
+  const GroupSignatureSet& signatures() const
+  { return f_GroupSignatures; }
 
 protected:
-  GroupSignatureMap f_GroupSignatureMap;
+  GroupSignatureSet f_GroupSignatures;
 
 };
 
@@ -0,0 +1,229 @@
+//===- ObjectSummary.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_OBJECT_SUMMARY_H
+#define MCLD_LD_OBJECT_SUMMARY_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Support/Path.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class FileHandle;
+class Input;
+
+/** \class ObjectSummary
+ *  \brief ObjectSummary is a read-only view of the decoded tables of a
+ *  relocatable object: its section headers, its symbol table, its
+ *  relocations and the CIE/FDE splits of its .eh_frame sections.
+ *
+ *  The entries have the same layout for ELF32 and ELF64 and are in the byte
+ *  order of the host, so the reader creates the IR of an object from the
+ *  mapped summary instead of decoding the ELF structures. The entries refer
+ *  to the sections and the symbols by their indexes, which the reader turns
+ *  into pointers as it creates them. The layout of a summary image is
+ *
+ *    Header | Section[num_of_sections] | Symbol[num_of_symbols] |
+ *    Reloc[num_of_relocs] | EhFrameEntry[num_of_eh_entries] | names
+ *
+ *  Every part starts at an 8-byte boundary. The entries of a relocation
+ *  section are Reloc[first, first + num), and the splits of an .eh_frame
+ *  section are EhFrameEntry[first, first + num).
+ */
+class ObjectSummary
+{
+public:
+  struct Header
+  {
+    char     magic[8];
+    uint32_t byte_order;
+    uint32_t num_of_sections;
+    uint32_t num_of_symbols;
+    uint32_t num_of_relocs;
+    uint32_t num_of_eh_entries;
+    uint32_t names_size;
+    uint64_t file_size;
+    uint64_t hash;
+  };
+
+  struct Section
+  {
+    uint32_t name;
+    uint32_t type;
+    uint64_t flags;
+    uint64_t addralign;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t entsize;
+    uint32_t link;
+    uint32_t info;
+    uint32_t first;
+    uint32_t num;
+  };
+
+  struct Symbol
+  {
+    uint32_t name;
+    uint8_t  info;
+    uint8_t  other;
+    uint16_t shndx;
+    uint64_t value;
+    uint64_t size;
+  };
+
+  struct Reloc
+  {
+    uint64_t offset;
+    int64_t  addend;
+    uint32_t type;
+    uint32_t symbol;
+  };
+
+  /// EhFrameEntry - a CIE, an FDE or the terminator of an .eh_frame section.
+  /// The last entry of a section which failed to be split is Unknown.
+  struct EhFrameEntry
+  {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t data_off;
+    uint8_t  kind;
+    uint8_t  fde_encoding;
+    uint16_t reserved;
+  };
+
+  /// Tables - the tables of an object to emit
+  struct Tables
+  {
+    std::vector<Section> sections;
+    std::vector<Symbol> symbols;
+    std::vector<Reloc> relocs;
+    std::vector<EhFrameEntry> eh_entries;
+    std::string names;
+
+    /// addName - append pName to the names
+    /// @return the offset of pName in the names
+    uint32_t addName(const llvm::StringRef& pName);
+  };
+
+  static const char MAGIC[];
+
+public:
+  ObjectSummary();
+
+  /// map - set up the view on pImage.
+  /// @return false if pImage is not a well-formed summary
+  bool map(const void* pImage, size_t pSize);
+
+  size_t numOfSections() const
+  { return m_pHeader->num_of_sections; }
+
+  const Section& getSection(size_t pIdx) const
+  { return m_pSections[pIdx]; }
+
+  size_t numOfSymbols() const
+  { return m_pHeader->num_of_symbols; }
+
+  const Symbol& getSymbol(size_t pIdx) const
+  { return m_pSymbols[pIdx]; }
+
+  /// getRelocs - the entries of the pIdx-th section, a relocation section
+  const Reloc* getRelocs(size_t pIdx) const
+  { return m_pRelocs + m_pSections[pIdx].first; }
+
+  /// getEhFrameEntries - the splits of the pIdx-th section, an .eh_frame
+  const EhFrameEntry* getEhFrameEntries(size_t pIdx) const
+  { return m_pEhEntries + m_pSections[pIdx].first; }
+
+  /// getName - the name at pOffset of the names
+  const char* getName(uint32_t pOffset) const
+  { return m_pNames + pOffset; }
+
+  uint64_t getFileSize() const
+  { return m_pHeader->file_size; }
+
+  uint64_t getHash() const
+  { return m_pHeader->hash; }
+
+  /// emit - emit the summary image of the object whose content hash is
+  /// pHash
+  static void emit(const Tables& pTables,
+                   uint64_t pFileSize,
+                   uint64_t pHash,
+                   std::string& pImage);
+
+private:
+  const Header* m_pHeader;
+  const Section* m_pSections;
+  const Symbol* m_pSymbols;
+  const Reloc* m_pRelocs;
+  const EhFrameEntry* m_pEhEntries;
+  const char* m_pNames;
+};
+
+/** \class ObjectSummaryCache
+ *  \brief ObjectSummaryCache keeps the summaries of relocatable objects in a
+ *  directory, so the links sharing the same objects, and the relinks after
+ *  a few objects are changed, need not decode the unchanged objects again.
+ *
+ *  Unlike DynObjSummaryCache, an object is keyed by the hash of its
+ *  contents, so a rebuilt object of the same bytes and the same member of
+ *  different archives share one summary. The loaded summaries are mapped
+ *  until the cache is destroyed.
+ */
+class ObjectSummaryCache
+{
+public:
+  explicit ObjectSummaryCache(const sys::fs::Path& pDir);
+
+  ~ObjectSummaryCache();
+
+  /// Hash - the content hash of the first pSize bytes of pInput
+  /// @return false if pInput is shorter than pSize
+  static bool Hash(Input& pInput, uint64_t pSize, uint64_t& pHash);
+
+  /// load - map the summary of the object of pFileSize bytes whose content
+  /// hash is pHash
+  /// @return the summary, or NULL if there is no valid summary
+  const ObjectSummary* load(uint64_t pHash, uint64_t pFileSize);
+
+  /// store - write the summary of the object from pTables
+  bool store(uint64_t pHash,
+             uint64_t pFileSize,
+             const ObjectSummary::Tables& pTables);
+
+private:
+  struct MappedSummary
+  {
+    FileHandle* handle;
+    void* image;
+    ObjectSummary summary;
+  };
+
+  typedef std::vector<MappedSummary*> SummaryListType;
+
+private:
+  /// getCachePath - the path of the summary of the object hashed to pHash
+  sys::fs::Path getCachePath(uint64_t pHash) const;
+
+private:
+  sys::fs::Path m_Dir;
+  SummaryListType m_SummaryList;
+};
+
+} // namespace of mcld
+
+#endif
+
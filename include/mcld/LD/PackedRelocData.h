@@ -0,0 +1,89 @@
+//===- PackedRelocData.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_PACKED_RELOC_DATA_H
+#define MCLD_LD_PACKED_RELOC_DATA_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/IRBuilder.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class LDSymbol;
+
+/** \class PackedRelocData
+ *  \brief PackedRelocData keeps the entries of a relocation section packed
+ *  instead of creating a Relocation for each of them.
+ *
+ *  The entries are packed in blocks of BlockSize entries. In a block, an
+ *  entry is
+ *    - the SLEB128 delta of its offset from the offset of the previous one,
+ *    - the ULEB128 index of its type in the dictionary of the types,
+ *    - the ULEB128 index of its symbol in the dictionary of the symbols,
+ *    - the SLEB128 addend.
+ *  The first offset of a block is relative to 0, so every block is decoded
+ *  on its own. All entries apply to one target fragment.
+ */
+class PackedRelocData
+{
+public:
+  enum { BlockSize = 64 };
+
+  typedef IRBuilder::RelocEntry Entry;
+  typedef IRBuilder::RelocEntryList EntryList;
+
+public:
+  explicit PackedRelocData(Fragment& pTarget);
+
+  /// pack - replace the entries by pEntries. As IRBuilder::AddRelocations()
+  /// does, the entries against the discarded sections are dropped.
+  /// @return false if an entry is out of the target fragment. Then nothing is
+  /// kept.
+  bool pack(const EntryList& pEntries);
+
+  /// decode - decode the pIdx-th block into pEntries
+  void decode(size_t pIdx, EntryList& pEntries) const;
+
+  // -----  observers  ----- //
+  Fragment&       target()       { return *m_pTarget; }
+  const Fragment& target() const { return *m_pTarget; }
+
+  /// size - the number of the entries
+  size_t size() const { return m_Size; }
+
+  bool empty() const { return (0 == m_Size); }
+
+  size_t numOfBlocks() const { return m_Blocks.size(); }
+
+  /// memory - the bytes of the packed entries and the dictionaries
+  size_t memory() const;
+
+private:
+  void clear();
+
+private:
+  Fragment* m_pTarget;
+  size_t m_Size;
+  std::vector<uint8_t> m_Data;
+  std::vector<uint32_t> m_Blocks;  ///< the first byte of each block
+  std::vector<Relocation::Type> m_Types;
+  std::vector<LDSymbol*> m_Symbols;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,78 @@
+//===- PrelinkMap.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_PRELINK_MAP_H
+#define MCLD_LD_PRELINK_MAP_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+namespace sys {
+namespace fs {
+class Path;
+} // namespace of fs
+} // namespace of sys
+
+/** \class PrelinkMap
+ *  \brief The load addresses of the libraries of --prelink-map.
+ *
+ *  Every line of the map names a library and its base address, such as
+ *
+ *    libc.so      0xafd00000
+ *
+ *  A library is named by its file name or its DT_SONAME. Empty lines and
+ *  the text after `#' are ignored.
+ */
+class PrelinkMap
+{
+public:
+  enum { NotFound = ~(uint64_t)0 };
+
+public:
+  PrelinkMap();
+
+  ~PrelinkMap();
+
+  /// read - read the map file
+  /// @return false if the file can not be read, or has a bad line
+  bool read(const sys::fs::Path& pPath);
+
+  /// parse - add the libraries listed in pContent. If a line is not a name
+  /// and an address, pBadLine is its number from 1.
+  /// @return false if a line is bad
+  bool parse(llvm::StringRef pContent, size_t& pBadLine);
+
+  /// getBase - the base address of the library pName, or NotFound
+  uint64_t getBase(llvm::StringRef pName) const;
+
+  // ----- observers ----- //
+  bool empty() const
+  { return m_BaseMap.empty(); }
+
+  size_t numOfLibraries() const
+  { return m_BaseMap.size(); }
+
+private:
+  typedef llvm::StringMap<uint64_t> BaseMapType;
+
+private:
+  BaseMapType m_BaseMap;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -24,12 +24,16 @@
 namespace mcld {
 
 class LDSection;
+class PackedRelocData;
 
 /** \class RelocData
  *  \brief RelocData stores Relocation.
  *
  *  Since Relocations are created by GCFactory, we use GCFactoryListTraits for the
  *  RelocationList here to avoid iplist to delete Relocations.
+ *
+ *  With --low-memory, the entries which are only applied by the writer may be
+ *  kept in a PackedRelocData instead, and the list is empty.
  */
 class RelocData
 {
@@ -39,6 +43,10 @@ private:
   RelocData();
   explicit RelocData(LDSection &pSection);
 
+  /// ~RelocData - the Relocations belong to their factory, so the list is
+  /// dropped without walking it. The packed entries are deleted.
+  ~RelocData();
+
   RelocData(const RelocData &);            // DO NOT IMPLEMENT
   RelocData& operator=(const RelocData &); // DO NOT IMPLEMENT
 
@@ -74,6 +82,14 @@ public:
 
   RelocData& append(Relocation& pRelocation);
 
+  /// setPacked - keep the entries in pPacked, which is owned by RelocData
+  void setPacked(PackedRelocData* pPacked);
+
+  bool hasPacked() const { return (NULL != m_pPacked); }
+
+  const PackedRelocData* getPacked() const { return m_pPacked; }
+  PackedRelocData*       getPacked()       { return m_pPacked; }
+
   reference              front ()       { return m_Relocations.front();  }
   const_reference        front () const { return m_Relocations.front();  }
   reference              back  ()       { return m_Relocations.back();   }
@@ -91,6 +107,7 @@ public:
 private:
   RelocationListType m_Relocations;
   LDSection* m_pSection;
+  PackedRelocData* m_pPacked;
 
 };
 
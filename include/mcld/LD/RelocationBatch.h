@@ -0,0 +1,73 @@
+//===- RelocationBatch.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_RELOCATION_BATCH_H
+#define MCLD_LD_RELOCATION_BATCH_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/LD/Relocator.h>
+
+#include <vector>
+#include <cstddef>
+
+namespace mcld {
+
+/** \class RelocationBatch
+ *  \brief RelocationBatch groups a batch of relocations by their types.
+ *
+ *  The relocations of the same type form a run, and the relocations of a run
+ *  are in the order of the batch. A Relocator applies a run by a kernel which
+ *  is either a function object or a pointer to an applying function. If the
+ *  kernel is a function object calling the applying function directly, the
+ *  function can be inlined into the loop of the run.
+ */
+class RelocationBatch : private Uncopyable
+{
+public:
+  struct Run
+  {
+    Relocation::Type type;
+    size_t begin;
+    size_t size;
+  };
+
+  typedef std::vector<Run> RunList;
+  typedef RunList::const_iterator run_iterator;
+
+public:
+  RelocationBatch(Relocation* const* pRelocs, size_t pNum);
+
+  run_iterator run_begin() const { return m_Runs.begin(); }
+  run_iterator run_end()   const { return m_Runs.end();   }
+
+  size_t numOfRuns() const { return m_Runs.size(); }
+
+  /// apply - apply the relocations of pRun by pKernel, and store the result
+  /// of the i-th relocation of the batch in pResults[i]
+  template<typename Kernel, typename Parent>
+  void apply(const Run& pRun, Kernel pKernel, Parent& pParent,
+             Relocator::Result* pResults) const
+  {
+    const size_t* order = &m_Order[pRun.begin];
+    for (size_t i = 0; i < pRun.size; ++i)
+      pResults[order[i]] = pKernel(*m_pRelocs[order[i]], pParent);
+  }
+
+private:
+  Relocation* const* m_pRelocs;
+  std::vector<size_t> m_Order;
+  RunList m_Runs;
+};
+
+} // namespace of mcld
+
+#endif
+
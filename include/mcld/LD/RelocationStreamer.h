@@ -0,0 +1,134 @@
+//===- RelocationStreamer.h -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_RELOCATION_STREAMER_H
+#define MCLD_LD_RELOCATION_STREAMER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class GNULDBackend;
+class Input;
+class LDSection;
+class LinkerConfig;
+class MemoryArea;
+class MemoryRegion;
+class Module;
+
+/** \class RelocationStreamer
+ *  \brief RelocationStreamer copies the relocation sections of a partial
+ *  link (-r) into the output without decoding them into Relocation.
+ *
+ *  With --stream-partial-link, the object reader records the relocation
+ *  sections of an input instead of reading them, along with the first
+ *  fragment of their target sections. The output relocation sections are
+ *  sized by the entries of their inputs, and every entry is rewritten as it
+ *  is copied into the output: the offset of the input section in its output
+ *  section is added to r_offset, and the symbol index is changed to the
+ *  index of the output symbol.
+ *
+ *  A relocation against a section symbol refers to the symbol of the output
+ *  section instead, and the offset of the input section is added to its
+ *  addend. The explicit addends are rewritten with the entries, and the
+ *  implicit addends of SHT_REL are adjusted in the output by
+ *  syncImplicitAddends(). A relocation against a discarded section becomes
+ *  a NONE relocation.
+ */
+class RelocationStreamer
+{
+public:
+  RelocationStreamer(const LinkerConfig& pConfig, GNULDBackend& pBackend);
+
+  ~RelocationStreamer();
+
+  /// IsEnabled - is the partial link of pConfig streamed?
+  static bool IsEnabled(const LinkerConfig& pConfig);
+
+  /// addInput - record the relocation sections of pInput. It is called
+  /// instead of reading the relocations, before the sections are merged.
+  /// @return false if a relocation section cannot be read
+  bool addInput(Input& pInput);
+
+  /// sizeOutputs - create the output relocation sections and size them
+  void sizeOutputs(Module& pModule);
+
+  /// emit - write the entries of the output relocation section pSection
+  void emit(const LDSection& pSection, MemoryRegion& pRegion);
+
+  /// syncImplicitAddends - add the offsets of the input sections to the
+  /// implicit addends of the SHT_REL relocations against section symbols
+  void syncImplicitAddends(MemoryArea& pOutput);
+
+private:
+  /// Source - an input relocation section
+  struct Source
+  {
+    Input* input;
+    LDSection* section;
+    const MemoryRegion* region;
+
+    /// target - the first fragment of the target section, or NULL if the
+    /// target section is empty
+    const Fragment* target;
+  };
+
+  /// ImplicitAddend - pDelta is added to the addend at file offset pOffset
+  struct ImplicitAddend
+  {
+    uint64_t offset;
+    uint64_t delta;
+    uint32_t type;
+  };
+
+  /// Output - an output relocation section and its sources in order
+  struct Output
+  {
+    LDSection* section;
+    std::vector<size_t> sources;
+    std::vector<ImplicitAddend> addends;
+  };
+
+private:
+  /// emitRel - write the entries of pSource into pBuffer
+  /// @return the size of the entries
+  template<size_t SIZE>
+  uint64_t emitRel(const Source& pSource, Output& pOutput, uint8_t* pBuffer);
+
+  /// emitRela - write the entries of pSource into pBuffer
+  /// @return the size of the entries
+  template<size_t SIZE>
+  uint64_t emitRela(const Source& pSource, Output& pOutput, uint8_t* pBuffer);
+
+  /// getSymbolIndex - the output symbol of the pIdx-th symbol of pSource
+  /// @param [out] pDelta the offset added to the addend
+  /// @return false if the symbol is in a discarded section
+  bool getSymbolIndex(const Source& pSource, uint32_t pIdx,
+                      uint32_t& pIndex, uint64_t& pDelta) const;
+
+private:
+  const LinkerConfig& m_Config;
+  GNULDBackend& m_Backend;
+  Module* m_pModule;
+
+  std::vector<Source> m_Sources;
+  std::vector<Output> m_Outputs;
+  llvm::DenseMap<const LDSection*, size_t> m_OutputIndex;
+};
+
+} // namespace of mcld
+
+#endif
+
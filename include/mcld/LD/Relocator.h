@@ -47,6 +47,32 @@ public:
   /// apply - general apply function
   virtual Result applyRelocation(Relocation& pRelocation) = 0;
 
+  /// mayApplyConcurrently - can pRelocation be applied concurrently with the
+  /// other relocations? Such a relocation only reads the final addresses of
+  /// symbols and sections, and writes its own target data. The relocations
+  /// that consume GOT, PLT or dynamic relocation entries must be applied by
+  /// one thread in order. By default, no relocation is concurrent.
+  virtual bool mayApplyConcurrently(const Relocation& pRelocation) const
+  { return false; }
+
+  /// isDataAddend - is the whole target data the addend of a REL relocation
+  /// of type pType? The place of such a relocation can be redirected by
+  /// rewriting its target data. By default, no type is.
+  virtual bool isDataAddend(Type pType) const
+  { return false; }
+
+  /// applyBatch - apply pNum relocations which may be applied concurrently,
+  /// and store the result of pRelocs[i] in pResults[i]. By default, the
+  /// relocations are applied one by one. Targets can group them by types
+  /// with RelocationBatch.
+  virtual void applyBatch(Relocation* const* pRelocs,
+                          Result* pResults,
+                          size_t pNum);
+
+  /// report - issue the diagnostic of pResult, the result of applying
+  /// pRelocation.
+  void report(const Relocation& pRelocation, Result pResult) const;
+
   // ------ observers -----//
   virtual TargetLDBackend& getTarget() = 0;
 
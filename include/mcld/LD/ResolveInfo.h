@@ -15,6 +15,8 @@
 #include <llvm/Support/DataTypes.h>
 #include <llvm/ADT/StringRef.h>
 
+#include <cstddef>
+
 namespace mcld {
 
 class LDSymbol;
@@ -32,6 +34,13 @@ class LDSymbol;
  *  In order to save the memory and speed up the performance, FragmentLinker uses
  *  a bit field to store all attributes.
  *
+ *  The record is split into a hot head and a cold tail. The head holds what
+ *  the resolvers and the relocation scanners read for every symbol: the
+ *  output symbol, the bit field, the cached scan properties and the ordinal.
+ *  The name follows the head, and the size, which only the resolution of the
+ *  commons and the emission read, follows the name. A record with a short
+ *  name then fits in half a cache line.
+ *
  *  The maximum string length is (2^16 - 1)
  */
 class ResolveInfo
@@ -89,6 +98,9 @@ public:
     Protected    = 3
   };
 
+  /// the ordinal of a symbol which no input defines or refers to
+  enum { NoOrdinal = ~0u };
+
   // -----  For HashTable  ----- //
   typedef llvm::StringRef key_type;
 
@@ -96,6 +108,15 @@ public:
   // -----  factory method  ----- //
   static ResolveInfo* Create(const key_type& pKey);
 
+  /// Create - create a ResolveInfo named pKey in pPlace, which has at least
+  /// AllocSize(pKey) bytes. The result must not be passed to Destroy().
+  static ResolveInfo* Create(const key_type& pKey, void* pPlace);
+
+  /// AllocSize - the size of a ResolveInfo named pKey, including the cold
+  /// tail after the name
+  static size_t AllocSize(const key_type& pKey)
+  { return ColdOffset(pKey.size()) + sizeof(SizeType); }
+
   static void Destroy(ResolveInfo*& pInfo);
 
   static ResolveInfo* Null();
@@ -126,7 +147,10 @@ public:
   void setReserved(uint32_t pReserved);
 
   void setSize(SizeType pSize)
-  { m_Size = pSize; }
+  { coldSize() = pSize; m_ScanProps = 0; }
+
+  void setOrdinal(uint32_t pOrdinal)
+  { m_Ordinal = pOrdinal; }
 
   void override(const ResolveInfo& pForm);
 
@@ -140,8 +164,18 @@ public:
   void setLink(const ResolveInfo* pTarget) {
     m_Ptr.info_ptr = const_cast<ResolveInfo*>(pTarget);
     m_BitField |= indirect_flag;
+    m_ScanProps = 0;
   }
 
+  /// setRegularRef - a regular object refers to the symbol by a non-weak
+  /// undefined reference
+  void setRegularRef()
+  { m_bRegularRef = true; }
+
+  /// setScanProperties - cache the ScanProperty bits the target backend
+  /// computes from the attributes. A modifier of the attributes clears them.
+  void setScanProperties(uint16_t pProps) const
+  { m_ScanProps = pProps; }
 
   // -----  observers  ----- //
   bool isNull() const;
@@ -168,6 +202,11 @@ public:
 
   bool isIndirect() const;
 
+  /// isRegularRef - does a regular object refer to the symbol? An
+  /// --as-needed library defining the symbol after the reference is needed.
+  bool isRegularRef() const
+  { return m_bRegularRef; }
+
   uint32_t type() const;
 
   uint32_t desc() const;
@@ -194,7 +233,14 @@ public:
   { return m_Ptr.info_ptr; }
 
   SizeType size() const
-  { return m_Size; }
+  { return const_cast<ResolveInfo*>(this)->coldSize(); }
+
+  /// ordinal - the ordinal of the input of the winning definition, or of the
+  /// first reference if the symbol is not defined. Resolution breaks the
+  /// ties between definitions of the same kind by the ordinals, so the
+  /// result does not depend on the order the inputs are resolved in.
+  uint32_t ordinal() const
+  { return m_Ordinal; }
 
   const char* name() const
   { return m_Name; }
@@ -208,6 +254,16 @@ public:
   uint32_t bitfield() const
   { return m_BitField; }
 
+  /// resolveClass - the binding, the desc and the source of the symbol, which
+  /// decide how a resolver handles it. It is less than NumOfResolveClasses.
+  uint32_t resolveClass() const
+  { return (m_BitField & RESOLVE_CLASS_MASK); }
+
+  /// scanProperties - the cached ScanProperty bits, or 0 if they are not
+  /// computed since the attributes changed
+  uint16_t scanProperties() const
+  { return m_ScanProps; }
+
   // -----  For HashTable  ----- //
   bool compare(const key_type& pKey);
 
@@ -240,6 +296,8 @@ private:
   static const uint32_t NAME_LENGTH_OFFSET = 16;
   static const uint32_t INFO_MASK          = 0xF;
   static const uint32_t RESOLVE_MASK       = 0xFFFF;
+  static const uint32_t RESOLVE_CLASS_MASK = BINDING_MASK | DYN_MASK |
+                                             DESC_MASK;
 
   union SymOrInfo {
     LDSymbol*    sym_ptr;
@@ -247,6 +305,27 @@ private:
   };
 
 public:
+  static const uint32_t NumOfResolveClasses = 0x20;
+
+  /** \enum ScanProperty
+   *  \brief The properties the relocation scanners ask for a symbol. They
+   *  depend only on the attributes and the link options, so the backend
+   *  computes them once, instead of once per relocation.
+   */
+  enum ScanProperty {
+    ScanComputed          = 1 << 0,
+    ScanPreemptible       = 1 << 1,
+    ScanNeedsPLT          = 1 << 2,
+    ScanFinalValueKnown   = 1 << 3,
+    ScanCopyRelocCand     = 1 << 4,
+    // symbolNeedsDynRel of (has PLT, is absolute reloc), by 1 << (5 + index)
+    ScanDynRelOffset      = 5,
+    ScanDynRel            = 1 << ScanDynRelOffset,
+    ScanDynRelAbs         = 1 << (ScanDynRelOffset + 1),
+    ScanDynRelPLT         = 1 << (ScanDynRelOffset + 2),
+    ScanDynRelPLTAbs      = 1 << (ScanDynRelOffset + 3)
+  };
+
   static const uint32_t global_flag    = 0        << GLOBAL_OFFSET;
   static const uint32_t weak_flag      = 1        << GLOBAL_OFFSET;
   static const uint32_t regular_flag   = 0        << DYN_OFFSET;
@@ -270,8 +349,21 @@ private:
   ResolveInfo& operator=(const ResolveInfo& pCopy);
   ~ResolveInfo();
 
+  /// ColdOffset - the offset of the cold tail of a record whose name has
+  /// pNameSize characters. The tail is aligned for SizeType.
+  static size_t ColdOffset(size_t pNameSize) {
+    return (offsetof(ResolveInfo, m_Name) + pNameSize + 1 +
+            sizeof(SizeType) - 1) & ~(sizeof(SizeType) - 1);
+  }
+
+  /// coldSize - the size of the symbol in the cold tail
+  SizeType& coldSize() {
+    return *reinterpret_cast<SizeType*>(reinterpret_cast<char*>(this) +
+                                        ColdOffset(nameSize()));
+  }
+
 private:
-  SizeType m_Size;
+  // -----  hot head  ----- //
   SymOrInfo m_Ptr;
 
   /** m_BitField
@@ -279,6 +371,18 @@ private:
    * |length of m_Name|reserved|Symbol|Type |ELF visibility|Local|Com|Def|Dyn|Weak|
    */
   uint32_t m_BitField;
+
+  // the ScanProperty bits. They are a cache, so observers may set them.
+  mutable uint16_t m_ScanProps;
+
+  // all bits of m_BitField are in use. It fits in the padding after
+  // m_ScanProps.
+  bool m_bRegularRef;
+
+  uint32_t m_Ordinal;
+
+  // -----  the name and the cold tail  ----- //
+  // the SizeType size of the symbol follows the terminating null of m_Name
   char m_Name[];
 };
 
@@ -0,0 +1,88 @@
+//===- ResolveInfoFactory.h -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_RESOLVE_INFO_FACTORY_H
+#define MCLD_LD_RESOLVE_INFO_FACTORY_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/LD/ResolveInfo.h>
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace mcld {
+
+/** \class ResolveInfoFactory
+ *  \brief ResolveInfoFactory allocates ResolveInfos and their inline names
+ *  from slabs by bumping a pointer.
+ *
+ *  Every record is aligned to 8 bytes, and the records are laid out in the
+ *  order they are produced. destroy() only reclaims the memory of the last
+ *  produced record, such as the temporary ResolveInfo of a symbol being
+ *  resolved against an existing one. All slabs are freed when the factory is
+ *  destroyed.
+ *
+ *  ResolveInfoFactory can be used as the entry factory of a HashTable. It is
+ *  not thread-safe, so every thread that produces ResolveInfos concurrently
+ *  should have its own factory. The slabs are allocated from the PageHeap.
+ */
+class ResolveInfoFactory : private Uncopyable
+{
+public:
+  typedef ResolveInfo           entry_type;
+  typedef ResolveInfo::key_type key_type;
+
+public:
+  ResolveInfoFactory();
+
+  ~ResolveInfoFactory();
+
+  /// produce - create a ResolveInfo named pKey
+  entry_type* produce(const key_type& pKey);
+
+  /// destroy - set pEntry to NULL. If pEntry is the last produced record,
+  /// its memory is reused by the next record. Otherwise, the memory is freed
+  /// with the factory.
+  void destroy(entry_type*& pEntry);
+
+  /// numOfSlabs - the number of allocated slabs
+  size_t numOfSlabs() const
+  { return m_Slabs.size(); }
+
+private:
+  /// SlabListType - the slabs and their sizes
+  typedef std::vector<std::pair<char*, size_t> > SlabListType;
+
+  static const size_t SlabSize  = 64 * 1024;
+  static const size_t Alignment = 8;
+
+private:
+  static size_t align(size_t pSize)
+  { return (pSize + Alignment - 1) & ~(Alignment - 1); }
+
+  /// allocate - allocate pSize bytes aligned to Alignment
+  void* allocate(size_t pSize);
+
+  /// addBytes - count pSize bytes of a new slab
+  void addBytes(size_t pSize);
+
+private:
+  SlabListType m_Slabs;
+  char* m_pCurrent;
+  char* m_pEnd;
+  size_t m_Bytes;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,115 @@
+//===- SectionAtom.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_SECTION_ATOM_H
+#define MCLD_LD_SECTION_ATOM_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+
+namespace mcld {
+
+/** \class SectionAtom
+ *  \brief SectionAtom is an interned section name.
+ *
+ *  All sections of the same name share one atom, so the name is stored once
+ *  no matter how many input files have the section, and two names are equal
+ *  if and only if their atoms are the same. The well-known ELF sections have
+ *  predefined IDs, so the checks for them are integer compares.
+ *
+ *  The atoms live until the program exits. Intern() and Find() may be called
+ *  by any thread.
+ */
+class SectionAtom : private Uncopyable
+{
+public:
+  typedef uint32_t ID;
+
+  enum Predefined {
+    Null,           // ""
+    Text,
+    Data,
+    Bss,
+    Rodata,
+    Init,
+    Fini,
+    InitArray,
+    FiniArray,
+    PreInitArray,
+    Ctors,
+    Dtors,
+    Jcr,
+    DataRelRo,
+    DataRelRoLocal,
+    Tdata,
+    Tbss,
+    Got,
+    GotPlt,
+    Plt,
+    Dynamic,
+    DynSym,
+    DynStr,
+    Hash,
+    GNUHash,
+    Interp,
+    RelDyn,
+    RelaDyn,
+    RelPlt,
+    RelaPlt,
+    EhFrame,
+    EhFrameHdr,
+    GccExceptTable,
+    Comment,
+    NoteGNUStack,
+    NoteGNUBuildID,
+    SymTab,
+    StrTab,
+    ShStrTab,
+    NumOfPredefined
+  };
+
+public:
+  /// Intern - the atom of pName, which is created if it does not exist
+  static const SectionAtom& Intern(llvm::StringRef pName);
+
+  /// Find - the atom of pName, or NULL if no section has the name
+  static const SectionAtom* Find(llvm::StringRef pName);
+
+  /// Get - the atom of a predefined name
+  static const SectionAtom& Get(Predefined pID);
+
+  /// size - the number of atoms
+  static size_t size();
+
+  const std::string& name() const { return m_Name; }
+
+  ID id() const { return m_ID; }
+
+  bool is(Predefined pID) const { return (m_ID == (ID)pID); }
+
+private:
+  SectionAtom(llvm::StringRef pName, ID pID);
+
+  friend struct SectionAtomTable;
+
+private:
+  std::string m_Name;
+  ID m_ID;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,80 @@
+//===- SeparateDebugFile.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_SEPARATE_DEBUG_FILE_H
+#define MCLD_LD_SEPARATE_DEBUG_FILE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+class FileHandle;
+class LDSection;
+class LinkerConfig;
+class MemoryArea;
+class Module;
+class StringTable;
+
+/** \class SeparateDebugFile
+ *  \brief SeparateDebugFile writes the file of --separate-debug-file.
+ *
+ *  The debug sections are laid out after the section header table of the
+ *  output, so the writer emits them once, in parallel with the others, and
+ *  the relocations and the build ID are applied as usual. Then the debug
+ *  file is made of
+ *    - the ELF header of the output, without program headers,
+ *    - the contents of the non-alloc sections and .note.gnu.build-id of the
+ *      output. The other alloc sections become SHT_NOBITS.
+ *    - the debug sections, moved by the kernel (by a reflink if the file
+ *      system shares extents) at the same offset modulo the page size,
+ *    - the section header table of all the output sections.
+ *  At last the CRC of the debug file goes to .gnu_debuglink, and the output
+ *  is cut at the end of its section header table.
+ */
+class SeparateDebugFile
+{
+public:
+  /// SeparateDebugFile - the names of the sections of pModule are in
+  /// pShStrTab, and the CRC goes to the output section pGNUDebugLink
+  SeparateDebugFile(const LinkerConfig& pConfig,
+                    const Module& pModule,
+                    const StringTable& pShStrTab,
+                    const LDSection& pGNUDebugLink);
+
+  /// emit - write the debug file, and cut the debug sections off pOutput.
+  /// The sections in the section header table of pOutput stay in it.
+  /// @return false if the debug file can not be written
+  bool emit(MemoryArea& pOutput);
+
+  /// crc - the CRC-32 of the debug file in .gnu_debuglink
+  uint32_t crc() const { return m_CRC; }
+
+private:
+  template<size_t SIZE>
+  bool doEmit(MemoryArea& pOutput, FileHandle& pDebug);
+
+  /// computeCRC - compute the CRC of the pSize bytes of pDebug
+  bool computeCRC(FileHandle& pDebug, size_t pSize);
+
+private:
+  const LinkerConfig& m_Config;
+  const Module& m_Module;
+  const StringTable& m_ShStrTab;
+  const LDSection& m_GNUDebugLink;
+  uint32_t m_CRC;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,131 @@
+//===- SmallDataOrdering.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_SMALL_DATA_ORDERING_H
+#define MCLD_LD_SMALL_DATA_ORDERING_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class FGNode;
+class FragmentGraph;
+class LDSection;
+class LinkerConfig;
+class Module;
+class ResolveInfo;
+
+namespace sys {
+namespace fs {
+class Path;
+} // namespace of fs
+} // namespace of sys
+
+/** \class SmallDataOrdering
+ *  \brief Reorder the objects of .sdata and .sbss for the targets which
+ *  address the small data relative to a global pointer.
+ *
+ *  Only the objects in a window around the global pointer can be reached by
+ *  a single GP-relative instruction, so the objects are packed by their
+ *  access counts per byte. The access count of an object is the number of
+ *  the relocations referring to it, or the count given by
+ *  --small-data-profile-file. The objects which are never accessed are
+ *  placed from the smallest up, so the most of them fit in the window.
+ *
+ *  SmallDataOrdering must run after mergeSections() and before the
+ *  relocations are scanned, since the fragment offsets change.
+ */
+class SmallDataOrdering
+{
+public:
+  SmallDataOrdering(const LinkerConfig& pConfig, Module& pModule);
+
+  ~SmallDataOrdering();
+
+  /// readProfile - read the profile file
+  /// @return false if the file can not be read
+  bool readProfile(const sys::fs::Path& pPath);
+
+  /// parseProfile - add the `symbol count' lines of pContent. Empty lines are
+  /// ignored, and the malformed lines are warned.
+  void parseProfile(llvm::StringRef pContent);
+
+  /// run - reorder the fragments of the small data sections
+  void run();
+
+  /// Sort - order the objects of sizes pSizes accessed pCounts times. pOrder
+  /// is the new order of the object indices.
+  static void Sort(const std::vector<uint64_t>& pSizes,
+                   const std::vector<uint64_t>& pCounts,
+                   std::vector<size_t>& pOrder);
+
+  // ----- observers ----- //
+  size_t numOfProfileEntries() const
+  { return m_Profile.size(); }
+
+private:
+  /// ProfileEntry - a line of the profile file
+  struct ProfileEntry
+  {
+    std::string symbol;
+    uint64_t count;
+  };
+
+  /// Object - a node of a small data section
+  struct Object
+  {
+    FGNode* node;
+    LDSection* section;
+    uint64_t size;
+    uint64_t count;
+  };
+
+  typedef std::vector<ProfileEntry> ProfileListTy;
+  typedef std::vector<Object> ObjectListTy;
+  typedef llvm::DenseMap<const FGNode*, size_t> ObjectMapTy;
+
+private:
+  /// collectObjects - collect the nodes of pSection
+  void collectObjects(FragmentGraph& pGraph, LDSection& pSection);
+
+  /// getObject - the index of the object pSym is defined in, or NoObject
+  size_t getObject(const FragmentGraph& pGraph, const ResolveInfo* pSym) const;
+
+  /// countRelocations - count the relocations referring to the objects
+  void countRelocations(const FragmentGraph& pGraph);
+
+  /// countProfile - count the profile entries of the objects
+  void countProfile(const FragmentGraph& pGraph);
+
+  /// reorder - move the fragments of the objects into pOrder
+  void reorder(const std::vector<size_t>& pOrder);
+
+private:
+  enum { NoObject = ~(size_t)0 };
+
+private:
+  const LinkerConfig& m_Config;
+  Module& m_Module;
+  ProfileListTy m_Profile;
+  ObjectListTy m_Objects;
+  ObjectMapTy m_ObjectMap;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -114,21 +114,13 @@ public:
                        bool &pOverride) const;
 
 private:
+  /// getOrdinate - the row or the column of pInfo in the state table
   inline unsigned int getOrdinate(const ResolveInfo& pInfo) const {
-    if (pInfo.isAbsolute() && pInfo.isDyn())
-      return d_D_ORD;
-    if (pInfo.isAbsolute())
-      return D_ORD;
-    if (pInfo.isCommon() && pInfo.isDyn())
-      return Cs_ORD;
-    if (pInfo.isCommon() && pInfo.isDefine())
-      return C_ORD;
-    if (pInfo.isCommon() && pInfo.isWeak())
-      return w_C_ORD;
-    if (pInfo.isIndirect())
-      return Is_ORD;
-    return pInfo.info();
+    return OrdinateTable[pInfo.resolveClass()];
   }
+
+  /// OrdinateTable - the ordinates of the resolving classes
+  static const unsigned char OrdinateTable[ResolveInfo::NumOfResolveClasses];
 };
 
 } // namespace of mcld
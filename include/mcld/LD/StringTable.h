@@ -0,0 +1,92 @@
+//===- StringTable.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_STRING_TABLE_H
+#define MCLD_LD_STRING_TABLE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class ThreadPool;
+
+/** \class StringTable
+ *  \brief The contents of an ELF string table, .strtab, .dynstr or .shstrtab.
+ *
+ *  Every string is kept once. When the table is finalized, the strings are
+ *  sorted by their reversed bytes, so a string that is a suffix of another
+ *  one sorts right before it, and reuses the tail of the longer string
+ *  instead of being emitted by itself. "_ZN3foo3barEv" and "3barEv" are
+ *  emitted as one string, and the offset of "3barEv" points into it.
+ *
+ *  The first byte of the table is always the null character, so the empty
+ *  string is at offset 0. A string added after finalize() is appended at the
+ *  end without sharing.
+ */
+class StringTable
+{
+public:
+  StringTable();
+
+  ~StringTable();
+
+  /// add - add pString into the table
+  void add(llvm::StringRef pString);
+
+  /// finalize - assign the offsets of the strings, merging the tails.
+  void finalize(ThreadPool& pPool);
+
+  /// getOffset - the offset of pString, which must be added before
+  uint64_t getOffset(llvm::StringRef pString) const;
+
+  /// emit - write the table into pBuffer, which has size() bytes
+  void emit(char* pBuffer) const;
+
+  /// emit - write the table into pBuffer with the threads of pPool. Every
+  /// string of the table is at its own bytes, so they are copied in parallel.
+  void emit(char* pBuffer, ThreadPool& pPool) const;
+
+  /// clear - remove all strings
+  void clear();
+
+  // ----- observers ----- //
+  bool isFinalized() const { return m_bFinalized; }
+
+  bool empty() const { return m_Strings.empty(); }
+
+  size_t numOfStrings() const { return m_Strings.size(); }
+
+  /// size - the size in bytes of the finalized table
+  uint64_t size() const { return m_Size; }
+
+private:
+  typedef llvm::StringMap<uint64_t> StringMapType;
+  typedef std::vector<const StringMapType::MapEntryTy*> EntryList;
+
+private:
+  StringMapType m_Strings;
+
+  /// m_Heads - the strings emitted by themselves, which are not the tails of
+  /// other strings
+  EntryList m_Heads;
+
+  uint64_t m_Size;
+  bool m_bFinalized;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -35,10 +35,13 @@ public:
   void addPrototype(Stub* pPrototype);
 
   /// create - create a stub if needed, otherwise return NULL
+  /// @param pBranchRange - the max distance that pReloc reaches, forward or
+  ///                       backward
   Stub* create(Relocation& pReloc,
                uint64_t pTargetSymValue,
                IRBuilder& pBuilder,
-               BranchIslandFactory& pBRIslandFactory);
+               BranchIslandFactory& pBRIslandFactory,
+               uint64_t pBranchRange);
 
 private:
   /// findPrototype - find if there is a registered stub prototype for the given
@@ -0,0 +1,91 @@
+//===- SymbolOrdering.h ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_SYMBOL_ORDERING_H
+#define MCLD_LD_SYMBOL_ORDERING_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+class LDSection;
+class Module;
+
+namespace sys {
+namespace fs {
+class Path;
+} // namespace of fs
+} // namespace of sys
+
+/** \class SymbolOrdering
+ *  \brief The symbol order of --symbol-ordering-file.
+ *
+ *  The ordering file lists one symbol name per line. The priority of a
+ *  symbol is its first line number in the file, and the priority of an input
+ *  section is the smallest priority of the symbols defined in it. The
+ *  prioritized input sections are merged before the others, in the order of
+ *  their priorities, so the listed symbols are placed at the start of their
+ *  output sections. With -ffunction-sections, each function is an input
+ *  section by itself and is placed exactly as listed.
+ */
+class SymbolOrdering
+{
+public:
+  enum { NotOrdered = ~(size_t)0 };
+
+public:
+  SymbolOrdering();
+
+  ~SymbolOrdering();
+
+  /// read - read the ordering file
+  /// @return false if the file can not be read
+  bool read(const sys::fs::Path& pPath);
+
+  /// parse - add the symbols listed in pContent. Spaces around a name and
+  /// empty lines are ignored.
+  void parse(llvm::StringRef pContent);
+
+  /// computeSectionPriorities - find the input sections of pModule defining
+  /// the listed symbols. It must be called before the input sections are
+  /// merged.
+  void computeSectionPriorities(const Module& pModule);
+
+  /// getPriority - the priority of the symbol pName, or NotOrdered
+  size_t getPriority(llvm::StringRef pName) const;
+
+  /// getPriority - the priority of the input section pSection, or NotOrdered
+  size_t getPriority(const LDSection& pSection) const;
+
+  // ----- observers ----- //
+  bool empty() const
+  { return m_SymbolMap.empty(); }
+
+  size_t numOfSymbols() const
+  { return m_SymbolMap.size(); }
+
+private:
+  typedef llvm::StringMap<size_t> SymbolMapType;
+  typedef llvm::DenseMap<const LDSection*, size_t> SectionMapType;
+
+private:
+  SymbolMapType m_SymbolMap;
+  SectionMapType m_SectionMap;
+};
+
+} // namespace of mcld
+
+#endif
+
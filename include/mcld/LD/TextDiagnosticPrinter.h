@@ -34,6 +34,10 @@ public:
   virtual void handleDiagnostic(DiagnosticEngine::Severity pSeverity,
                                 const Diagnostic& pInfo);
 
+  /// isIgnored - the debug messages, the notes and the ignored messages are
+  /// only shown at the verbose levels 0, 1 and 2.
+  virtual bool isIgnored(DiagnosticEngine::Severity pSeverity) const;
+
   virtual void beginInput(const Input& pInput, const LinkerConfig& pConfig);
 
   virtual void endInput();
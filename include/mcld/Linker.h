@@ -12,6 +12,8 @@
 #include <gtest.h>
 #endif
 
+#include <llvm/Support/DataTypes.h>
+
 #include <string>
 
 namespace mcld {
@@ -27,6 +29,7 @@ class ObjectLinker;
 
 class FileHandle;
 class MemoryArea;
+class LinkCache;
 
 /** \class Linker
 *  \brief Linker is a modular linker.
@@ -57,11 +60,17 @@ public:
   /// to the file.
   bool emit(const std::string& pPath);
 
-  /// emit - To emit output mcld::Module in the pFileDescriptor.
+  /// emit - To emit output mcld::Module in the pFileDescriptor. If the file
+  /// is a pipe or a socket, the output is streamed to it in order.
   bool emit(int pFileDescriptor);
 
   bool reset();
 
+  /// clear - To clear the state of the last link, so that another
+  /// mcld::Module can be linked with the same LinkerConfig. Unlike reset(),
+  /// the target, the backend and the emulated options are kept.
+  bool clear();
+
 private:
   bool initTarget();
 
@@ -71,6 +80,24 @@ private:
 
   bool initOStream();
 
+  /// emitStream - emit the output into an anonymous file in the memory, and
+  /// then write it to the non-seekable pSink from the start to the end
+  bool emitStream(int pSink);
+
+  /// reportTime - print the time report and write the time trace
+  void reportTime();
+
+  /// reportMemory - print the memory of the factories after pPhase, or the
+  /// whole table at the end of the link if pPhase is NULL
+  void reportMemory(const char* pPhase);
+
+  /// reportStats - print the counters of the link
+  void reportStats();
+
+  /// reportCost - write the costs of the input objects. pEmitTime is the
+  /// time of emit() in microseconds.
+  void reportCost(uint64_t pEmitTime);
+
 private:
   LinkerConfig* m_pConfig;
   IRBuilder* m_pIRBuilder;
@@ -78,6 +105,7 @@ private:
   const Target* m_pTarget;
   TargetLDBackend* m_pBackend;
   ObjectLinker* m_pObjLinker;
+  LinkCache* m_pCache;
 };
 
 } // namespace of MC Linker
@@ -25,12 +25,21 @@
 
 namespace mcld {
 
+class LinkContext;
+class ThreadPool;
+class TimeReport;
+
 /** \class LinkerConfig
  *  \brief LinkerConfig is composed of argumments of MCLinker.
  *   options()        - the general options
  *   scripts()        - the script options
  *   bitcode()        - the bitcode being linked
  *   attribute()      - the attribute options
+ *   threads()        - the thread pool of --threads
+ *   timeReport()     - the time report of --time-report, --time-trace and
+ *                      --perf-counters
+ *   context()        - the diagnostics, the streams and the relocations of
+ *                      the link
  */
 class LinkerConfig
 {
@@ -99,6 +108,25 @@ public:
   bool isCodeDynamic() const { return (DynamicDependent == m_CodePosition); }
   bool isCodeStatic()  const { return (StaticDependent == m_CodePosition); }
 
+  /// threads - the thread pool shared by all parallel phases. The pool is
+  /// created with options().numThreads() threads at the first call.
+  ThreadPool& threads() const;
+
+  /// resetThreads - join the threads of the pool. The next call of threads()
+  /// creates a pool with the current options().numThreads().
+  void resetThreads();
+
+  /// timeReport - the time report shared by all phases. The report is
+  /// created at the first call.
+  /// @return NULL if none of --time-report, --time-trace and --perf-counters
+  /// is given
+  TimeReport* timeReport() const;
+
+  /// context - the state of the link reached by the free functions, such
+  /// as fatal() and mcld::outs(). It is made current in the thread that
+  /// creates the config.
+  LinkContext& context() const { return *m_pContext; }
+
   static const char* version();
 
 private:
@@ -111,6 +139,10 @@ private:
 
   CodeGenType m_CodeGenType;
   CodePosition m_CodePosition;
+
+  LinkContext* m_pContext;
+  mutable ThreadPool* m_pThreadPool;
+  mutable TimeReport* m_pTimeReport;
 };
 
 } // namespace of mcld
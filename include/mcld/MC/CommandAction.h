@@ -15,6 +15,7 @@
 #include <string>
 #include <mcld/Support/Path.h>
 #include <mcld/MC/InputAction.h>
+#include <mcld/BitcodeOption.h>
 
 namespace mcld {
 
@@ -59,14 +60,14 @@ private:
 class BitcodeAction : public InputAction
 {
 public:
-  BitcodeAction(unsigned int pPosition, const sys::fs::Path &pPath);
+  BitcodeAction(unsigned int pPosition, const BitcodeOption& pBitcode);
 
-  const sys::fs::Path& path() const { return m_Path; }
+  const sys::fs::Path& path() const { return m_Bitcode.getPath(); }
 
   bool activate(InputBuilder&) const;
 
 private:
-  sys::fs::Path m_Path;
+  const BitcodeOption& m_Bitcode;
 };
 
 /// StartGroupAction
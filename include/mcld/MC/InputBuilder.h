@@ -14,6 +14,7 @@
 
 #include <string>
 #include <stack>
+#include <vector>
 
 #include <mcld/InputTree.h>
 #include <mcld/MC/MCLDInput.h>
@@ -27,6 +28,7 @@ class ContextFactory;
 class MemoryAreaFactory;
 class AttrConstraint;
 class raw_mem_ostream;
+class ThreadPool;
 
 /** \class InputBuilder
  *  \brief InputBuilder recieves InputActions and build the InputTree.
@@ -38,6 +40,11 @@ class InputBuilder
 public:
   explicit InputBuilder(const LinkerConfig& pConfig);
 
+  /// InputBuilder - build the inputs on the MemoryAreas of pMemoryFactory,
+  /// which outlives the builder and may be shared by many links.
+  InputBuilder(const LinkerConfig& pConfig,
+               MemoryAreaFactory& pMemoryFactory);
+
   InputBuilder(const LinkerConfig& pConfig,
                InputFactory& pInputFactory,
                ContextFactory& pContextFactory,
@@ -75,6 +82,12 @@ public:
 
   bool setMemory(Input& pInput, void* pMemBuffer, size_t pSize);
 
+  /// openMemory - open the files of pPaths concurrently on pPool. The later
+  /// setMemory() of inputs on these paths gets the opened files.
+  void openMemory(ThreadPool& pPool,
+                  const std::vector<sys::fs::Path>& pPaths,
+                  FileHandle::OpenMode pMode);
+
   InputTree& enterGroup();
 
   InputTree& exitGroup();
@@ -99,7 +112,7 @@ private:
   std::stack<InputTree::iterator> m_ReturnStack;
 
   bool m_bOwnFactory;
-
+  bool m_bOwnMemFactory;
 };
 
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,74 @@
+//===- InputCost.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_MC_INPUT_COST_H
+#define MCLD_MC_INPUT_COST_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+
+#include <llvm/Support/DataTypes.h>
+
+namespace mcld {
+
+class Input;
+
+/** \class InputCost
+ *  \brief InputCost is what an input object costs the link, for
+ *  --cost-report.
+ *
+ *  The costs are created by the object reader for the object files and the
+ *  archive members it reads, and are accumulated by the phases which work on
+ *  one input at a time. The times are in microseconds.
+ */
+struct InputCost
+{
+  enum Phase {
+    Parse,
+    Scan,
+    Apply,
+    Emit,
+    NumOfPhases
+  };
+
+  InputCost();
+
+  /// name - the name of pPhase for the reports
+  static const char* name(Phase pPhase);
+
+  uint64_t mappedBytes;   ///< the bytes of the sections in the file
+  uint64_t sections;      ///< the sections read
+  uint64_t symbols;       ///< the symbols inserted into the symbol table
+  uint64_t relocations;   ///< the relocations scanned
+  uint64_t outputBytes;   ///< the bytes merged into the output sections
+  uint64_t time[NumOfPhases];
+};
+
+/** \class InputCostScope
+ *  \brief InputCostScope adds the time of its lifetime to a phase of the
+ *  cost of an input. It does nothing if the input has no cost.
+ */
+class InputCostScope : private Uncopyable
+{
+public:
+  InputCostScope(Input& pInput, InputCost::Phase pPhase);
+
+  ~InputCostScope();
+
+private:
+  InputCost* m_pCost;
+  InputCost::Phase m_Phase;
+  uint64_t m_Begin;
+};
+
+} // namespace of mcld
+
+#endif
+
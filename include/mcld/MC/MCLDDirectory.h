@@ -42,6 +42,12 @@ public:
   const std::string& name() const
   { return m_Name; }
 
+  /// find - find the entry whose file name is pFileName. All entries of the
+  /// directory are read into the path cache at the first lookup, and then
+  /// every lookup is a hash probe.
+  /// @return NULL if there is no such entry
+  sys::fs::Path* find(const std::string& pFileName);
+
 private:
   std::string m_Name;
   bool m_bInSysroot;
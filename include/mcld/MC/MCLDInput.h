@@ -18,11 +18,14 @@
 
 #include <mcld/Support/Path.h>
 
+#include <llvm/Support/DataTypes.h>
+
 namespace mcld {
 
 class MemoryArea;
 class AttributeProxy;
 class Attribute;
+class InputCost;
 class InputFactory;
 class LDContext;
 
@@ -41,9 +44,20 @@ public:
     CoreFile,
     Script,
     Archive,
-    External
+    External,
+    Bitcode
   };
 
+  /// the size of the probe, as large as the largest header sniffed by the
+  /// readers, the ELF64 header
+  enum { ProbeSize = 64 };
+
+  /// the ordinal of an input whose symbols are not read
+  enum { NoOrdinal = ~0u };
+
+  /// the home of an input which is not preloaded by a thread pool
+  enum { NoHome = ~0u };
+
 public:
   explicit Input(llvm::StringRef pName);
 
@@ -96,15 +110,23 @@ public:
   void setNeeded()
   { m_bNeeded = true; }
 
+  /// noExport - the symbols defined in the input are not exported, e.g.,
+  /// the input is a member of an --exclude-libs archive
+  bool noExport() const
+  { return m_bNoExport; }
+
+  void setNoExport()
+  { m_bNoExport = true; }
+
   off_t fileOffset() const
   { return m_fileOffset; }
 
   void setFileOffset(off_t pFileOffset)
-  { m_fileOffset = pFileOffset; }
+  { m_fileOffset = pFileOffset; m_bProbed = false; }
 
   // -----  memory area  ----- //
   void setMemArea(MemoryArea* pMemArea)
-  { m_pMemArea = pMemArea; }
+  { m_pMemArea = pMemArea; m_bProbed = false; }
 
   bool hasMemArea() const
   { return (NULL != m_pMemArea); }
@@ -112,6 +134,14 @@ public:
   const MemoryArea* memArea() const { return m_pMemArea; }
   MemoryArea*       memArea()       { return m_pMemArea; }
 
+  /// probe - the first ProbeSize bytes of the input at fileOffset(), read at
+  /// the first call and shared by the isMyFormat() of all readers. The bytes
+  /// past the end of the input are zeros.
+  const uint8_t* probe();
+
+  /// probeSize - the number of bytes of probe() read from the input
+  size_t probeSize();
+
   // -----  context  ----- //
   void setContext(LDContext* pContext)
   { m_pContext = pContext; }
@@ -122,15 +152,42 @@ public:
   const LDContext* context() const { return m_pContext; }
   LDContext*       context()       { return m_pContext; }
 
+  // -----  cost  ----- //
+  /// ordinal - the position of the input in the order its symbols are read.
+  /// The members of an archive are numbered in the order they are included.
+  unsigned int ordinal() const { return m_Ordinal; }
+
+  void setOrdinal(unsigned int pOrdinal) { m_Ordinal = pOrdinal; }
+
+  /// home - the thread of the pool which preloaded the input, or NoHome.
+  /// The later phases queue the work on the input to the same thread.
+  unsigned int home() const { return m_Home; }
+
+  void setHome(unsigned int pHome) { m_Home = pHome; }
+
+  /// setCost - Input takes pCost
+  void setCost(InputCost* pCost);
+
+  /// cost - the cost of the input for --cost-report, or NULL
+  const InputCost* cost() const { return m_pCost; }
+  InputCost*       cost()       { return m_pCost; }
+
 private:
   unsigned int m_Type;
   std::string m_Name;
   sys::fs::Path m_Path;
   Attribute *m_pAttr;
   bool m_bNeeded;
+  bool m_bNoExport;
   off_t m_fileOffset;
   MemoryArea* m_pMemArea;
   LDContext* m_pContext;
+  InputCost* m_pCost;
+  unsigned int m_Ordinal;
+  unsigned int m_Home;
+  uint8_t m_Probe[ProbeSize];
+  unsigned int m_ProbeSize;
+  bool m_bProbed;
 };
 
 } // namespace of mcld
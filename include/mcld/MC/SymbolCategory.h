@@ -19,8 +19,14 @@ namespace mcld
 
 class LDSymbol;
 class ResolveInfo;
+class ThreadPool;
+
 /** \class SymbolCategory
  *  \brief SymbolCategory groups output LDSymbol into different categories.
+ *
+ *  By default, every add() and arrange() moves the symbol into its category
+ *  at once. Between defer() and categorize(), the symbols are only appended,
+ *  and categorize() puts all of them into their categories in one pass.
  */
 class SymbolCategory
 {
@@ -47,6 +53,24 @@ public:
 
   SymbolCategory& changeLocalToDynamic(const LDSymbol& pSymbol);
 
+  /// removeIf - remove all symbols that pIsRemoved returns true. The other
+  /// symbols keep their order and their categories.
+  SymbolCategory& removeIf(bool (*pIsRemoved)(const LDSymbol&));
+
+  /// defer - stop arranging the symbols. Until categorize(), add() and
+  /// forceLocal() only append the symbol, and arrange() does nothing. The
+  /// categories are not valid in the meantime.
+  SymbolCategory& defer();
+
+  /// categorize - put all symbols into their categories by their current
+  /// ResolveInfos, and stop deferring. The symbols forced to be local stay
+  /// local. The symbols of a category keep their order. If pThreads is
+  /// given, the categories of the symbols are computed in parallel.
+  SymbolCategory& categorize(ThreadPool* pThreads = NULL);
+
+  bool isDeferred() const
+  { return m_bDeferred; }
+
   // -----  access  ----- //
   LDSymbol& at(size_t pPosition)
   { return *m_OutputSymbols.at(pPosition); }
@@ -171,12 +195,25 @@ private:
     static Type categorize(const ResolveInfo& pInfo);
   };
 
+  /// NotPinned - the pinned type of a symbol which is categorized by its
+  /// ResolveInfo
+  static const unsigned char NotPinned = 0xff;
+
+  typedef std::vector<unsigned char> TypeList;
+
+  struct Categorizer;
+
 private:
   SymbolCategory& add(LDSymbol& pSymbol, Category::Type pTarget);
 
 private:
   OutputSymbols m_OutputSymbols;
 
+  /// the types of the symbols which do not follow their ResolveInfos in the
+  /// deferred mode, such as the symbols forced to be local
+  TypeList m_Pinned;
+  bool m_bDeferred;
+
   Category* m_pFile;
   Category* m_pLocal;
   Category* m_pLocalDyn;
@@ -26,6 +26,8 @@ public:
     CombReloc,
     NoCombReloc,
     Defs,
+    Direct,
+    NoDirect,
     ExecStack,
     NoExecStack,
     InitFirst,
@@ -42,6 +44,8 @@ public:
     Lazy,
     Now,
     Origin,
+    SeparateCode,
+    NoSeparateCode,
     CommPageSize,
     MaxPageSize,
     Unknown
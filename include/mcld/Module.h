@@ -20,12 +20,14 @@
 #include <string>
 
 #include <llvm/ADT/ilist.h>
+#include <llvm/ADT/StringMap.h>
 
 #include <mcld/InputTree.h>
 #include <mcld/ADT/HashTable.h>
 #include <mcld/ADT/HashEntry.h>
 #include <mcld/Support/GCFactoryListTraits.h>
 #include <mcld/Fragment/Fragment.h>
+#include <mcld/LD/CompressedSections.h>
 #include <mcld/LD/NamePool.h>
 #include <mcld/LD/SectionSymbolSet.h>
 #include <mcld/MC/SymbolCategory.h>
@@ -105,9 +107,14 @@ public:
 /// @{
 
   // -----  sections  ----- //
+  /// getSectionTable - the sections may be reordered through the table. New
+  /// sections must be added by appendSection(), which indexes their names.
   const SectionTable& getSectionTable() const { return m_SectionTable; }
   SectionTable&       getSectionTable()       { return m_SectionTable; }
 
+  /// appendSection - append pSection to the section table
+  Module& appendSection(LDSection& pSection);
+
   iterator         begin()       { return m_SectionTable.begin(); }
   const_iterator   begin() const { return m_SectionTable.begin(); }
   iterator         end  ()       { return m_SectionTable.end();   }
@@ -119,12 +126,19 @@ public:
   size_t           size () const { return m_SectionTable.size();  }
   bool             empty() const { return m_SectionTable.empty(); }
 
+  /// getSection - the first appended section named pName
   LDSection*       getSection(const std::string& pName);
   const LDSection* getSection(const std::string& pName) const;
 
   LDSymbol*       getSectionSymbol(const LDSection* pSection);
   const LDSymbol* getSectionSymbol(const LDSection* pSection) const;
 
+  /// getCompressedSections - the SHF_COMPRESSED input sections
+  const CompressedSections& getCompressedSections() const
+  { return m_CompressedSections; }
+  CompressedSections&       getCompressedSections()
+  { return m_CompressedSections; }
+
 /// @}
 /// @name Symbol Accessors
 /// @{
@@ -149,15 +163,28 @@ public:
   const NamePool& getNamePool() const { return m_NamePool; }
   NamePool&       getNamePool()       { return m_NamePool; }
 
+  // -----  ordinals  ----- //
+  /// assignOrdinal - give pInput the ordinal after the inputs whose symbols
+  /// are read before it. It is called right before the symbols of pInput
+  /// are read.
+  void assignOrdinal(Input& pInput);
+
 private:
   std::string m_Name;
   ObjectList m_ObjectList;
   LibraryList m_LibraryList;
   InputTree m_MainTree;
   SectionTable m_SectionTable;
+
+  /// m_SectionIndex - the first appended section of every name
+  llvm::StringMap<LDSection*> m_SectionIndex;
+
+  CompressedSections m_CompressedSections;
+
   SymbolTable m_SymbolTable;
   NamePool m_NamePool;
   SectionSymbolSet m_SectSymbolSet;
+  unsigned int m_NumOfOrdinals;
 };
 
 } // namespace of mcld
@@ -13,10 +13,14 @@
 #endif
 #include <mcld/LD/LDFileFormat.h>
 #include <mcld/LD/EhFrame.h>
+#include <mcld/Object/SectionMap.h>
 
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/Support/DataTypes.h>
 
 #include <string>
+#include <vector>
 
 namespace mcld {
 
@@ -69,6 +73,34 @@ public:
   /// is not defined, return NULL.
   LDSection* MergeSection(LDSection& pInputSection);
 
+  typedef std::vector<LDSection*> SectionList;
+  typedef std::vector<const SectionMap::NamePair*> MappingList;
+
+  /// MergeSections - merge pInputs in order, as calling MergeSection() for
+  /// every one of them does. pMappings[i] is the SectionMap entry of
+  /// pInputs[i], which may be a null NamePair, and is looked up by the caller
+  /// so that the lookups can run in parallel.
+  ///
+  /// The output sections are found and created in the input order. With
+  /// deferOffsets(), the fragments are then moved by output section, and the
+  /// output sections are filled in parallel with --threads.
+  ///
+  /// @param [out] pOutputs pOutputs[i] is the output section of pInputs[i]
+  /// @return false if some input section cannot be merged
+  bool MergeSections(const SectionList& pInputs,
+                     const MappingList& pMappings,
+                     SectionList& pOutputs);
+
+  /// deferOffsets - let the following MergeSection() only move the
+  /// fragments. The offsets of the fragments and the sizes of the output
+  /// sections are left to updateOffsets().
+  void deferOffsets();
+
+  /// updateOffsets - compute the deferred offsets. The output sections are
+  /// independent of each other, so they are laid out in parallel with
+  /// --threads.
+  void updateOffsets();
+
   /// MoveSectionData - move the fragment of pFrom to pTo section data.
   static bool MoveSectionData(SectionData& pFrom, SectionData& pTo);
 
@@ -92,9 +124,55 @@ public:
   static uint64_t AppendFragment(Fragment& pFrag, SectionData& pSD,
                                  uint32_t pAlignConstraint = 1);
 
+private:
+  /// getOutputSection - get the output section pName of pInputSection, or
+  /// create it if it does not exist
+  LDSection* getOutputSection(const std::string& pName,
+                              const LDSection& pInputSection);
+
+  /// moveFragments - move the fragments of pFrom to pTo, and leave their
+  /// offsets to updateOffsets()
+  void moveFragments(SectionData& pFrom, SectionData& pTo);
+
+  /// addPending - remember where the fragments of pTo are not laid out yet
+  void addPending(SectionData& pTo);
+
+  /// SpliceFragments - move the fragments of pFrom to the end of pTo without
+  /// their offsets
+  static void SpliceFragments(SectionData& pFrom, SectionData& pTo);
+
+private:
+  /// PendingLayout - an output section whose fragments after the last one
+  /// are not laid out yet
+  struct PendingLayout
+  {
+    SectionData* data;
+    Fragment* last;
+    uint64_t base;
+  };
+
+  typedef std::vector<PendingLayout> PendingList;
+
+  /// FragmentMove - the input sections moved to an output section, in the
+  /// input order
+  struct FragmentMove
+  {
+    SectionData* to;
+    std::vector<SectionData*> from;
+  };
+
+  typedef std::vector<FragmentMove> MoveList;
+
+  struct OffsetUpdater;
+  struct FragmentMover;
+
 private:
   const LinkerConfig& m_Config;
   Module& m_Module;
+
+  bool m_bDeferOffsets;
+  PendingList m_Pending;
+  llvm::DenseSet<const SectionData*> m_PendingSet;
 };
 
 } // namespace of mcld
@@ -36,6 +36,10 @@ class ObjectWriter;
 class DynObjWriter;
 class ExecWriter;
 class BinaryWriter;
+class Input;
+class LDSection;
+class ObjectBuilder;
+class SymbolOrdering;
 
 /** \class ObjectLinker
  *  \brief ObjectLinker prepares parameters for FragmentLinker.
@@ -69,6 +73,10 @@ public:
   /// readRelocations - read all relocation entries
   bool readRelocations();
 
+  /// dataStrippingOpt - remove the input sections that are not needed, e.g.,
+  /// --gc-sections and --icf
+  bool dataStrippingOpt();
+
   /// mergeSections - put allinput sections into output sections
   bool mergeSections();
 
@@ -76,6 +84,14 @@ public:
   /// corresponding sections
   bool allocateCommonSymbols();
 
+  /// orderSmallData - reorder the small data objects of the GP-relative
+  /// targets by their accesses
+  bool orderSmallData();
+
+  /// orderFunctions - reorder the functions of the output sections by the
+  /// call graph, e.g., --call-graph-ordering
+  bool orderFunctions();
+
   /// addStandardSymbols - shared object and executable files need some
   /// standard symbols
   ///   @return if there are some input symbols with the same name to the
@@ -94,6 +110,10 @@ public:
   ///   script symbols, return false.
   bool addScriptSymbols();
 
+  /// readDependencies - resolve the references of an executable which are
+  /// still undefined by the DT_NEEDED libraries of its shared objects
+  void readDependencies();
+
   /// scanRelocations - scan all relocation entries by output symbols.
   bool scanRelocations();
 
@@ -156,6 +176,41 @@ public:
   const ObjectWriter*  getWriter () const { return m_pWriter;  }
   ObjectWriter*        getWriter ()       { return m_pWriter;  }
 
+private:
+  /// preloadInputs - read the headers and the symbol tables of inputs with
+  /// --threads worker threads before normalize() builds the IR.
+  void preloadInputs();
+
+  /// readExportFilter - read the symbols that --dynamic-list and
+  /// --version-script export before normalize() reads any symbol.
+  void readExportFilter();
+
+  /// reserveSymbols - size the NamePool by the symbol tables of the objects
+  /// and the shared objects before normalize() reads their symbols.
+  void reserveSymbols();
+
+  /// readInputRelocations - read the relocation sections of the objects
+  /// that are neither read nor ignored yet
+  bool readInputRelocations();
+
+  /// dropInputs - tell the system the pages of inputs are no longer needed
+  /// after their contents are emitted.
+  void dropInputs();
+
+  /// mergeOrderedSections - merge the input sections that are not merged in
+  /// the input order. If pBeforeRegular is true, merge the sections defining
+  /// the symbols of --symbol-ordering-file in the order of their priorities,
+  /// and then the SectionMap::Hot sections. Otherwise, merge the sections of
+  /// the groups after SectionMap::Regular.
+  bool mergeOrderedSections(ObjectBuilder& pBuilder,
+                            const SymbolOrdering& pOrdering,
+                            bool pBeforeRegular);
+
+  /// mergeSectionData - merge pSection of pInput by ObjectBuilder.
+  bool mergeSectionData(ObjectBuilder& pBuilder,
+                        const Input& pInput,
+                        LDSection& pSection);
+
 private:
   const LinkerConfig& m_Config;
   FragmentLinker* m_pLinker;
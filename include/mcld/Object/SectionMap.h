@@ -12,8 +12,9 @@
 #include <gtest.h>
 #endif
 
-#include <vector>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <llvm/Support/DataTypes.h>
 
@@ -22,17 +23,35 @@ namespace mcld {
 /** \class SectionMap
  *  \brief descirbe the mappings of input section's name (or prefix) to
  *         its associated output section's name and offset
+ *
+ *  An input name is mapped by the first appended mapping that matches it.
+ *  The mappings are also kept in a prefix trie, so find() walks the input
+ *  name once instead of comparing it with every mapping.
  */
 class SectionMap
 {
 public:
+  /// Group - the groups of the input sections in an output section. The
+  /// groups are placed in this order, e.g., .text.hot.* is placed before the
+  /// other .text sections, and .text.unlikely.* is placed at the end. An
+  /// input section keeps its input order in its group.
+  enum Group {
+    Hot,
+    Regular,
+    Startup,
+    Exit,
+    Unlikely
+  };
+
   // a mapping in SectionMap is the triple of
   // {input substr, output section's name, output section's offset}
   struct NamePair
   {
   public:
     NamePair();
-    NamePair(const std::string& pFrom, const std::string& pTo);
+    NamePair(const std::string& pFrom,
+             const std::string& pTo,
+             Group pGroup = Regular);
 
     bool isNull() const;
 
@@ -40,6 +59,7 @@ public:
     unsigned int hash;
     std::string from;
     std::string to;
+    Group group;
   };
 
   typedef std::vector<NamePair> NamePairList;
@@ -50,11 +70,15 @@ public:
   static NamePair NullName;
 
 public:
+  SectionMap();
+
   // get the possible output section name based on the mapping table
   // return NullPair if not found
   const NamePair& find(const std::string& pFrom) const;
   NamePair&       find(const std::string& pFrom);
 
+  // pHash is the hash() of pFrom. It is kept for compatibility, the trie
+  // does not need it.
   const NamePair& find(const std::string& pFrom, unsigned int pHash) const;
   NamePair&       find(const std::string& pFrom, unsigned int pHash);
 
@@ -66,6 +90,13 @@ public:
                    const std::string& pTo,
                    bool& pExist);
 
+  // add a mapping of a group other than Regular. The mapping matches the
+  // input name pFrom, or the names starting with pFrom and a dot.
+  NamePair& append(const std::string& pFrom,
+                   const std::string& pTo,
+                   Group pGroup,
+                   bool& pExist);
+
   const_iterator begin() const { return m_NamePairList.begin(); }
   iterator       begin()       { return m_NamePairList.begin(); }
   const_iterator end  () const { return m_NamePairList.end(); }
@@ -77,11 +108,41 @@ public:
   static unsigned int hash(const std::string& pString);
 
 private:
-  bool matched(const NamePair& pNamePair,
-               const std::string& pInput,
-               unsigned int pHash) const;
+  /// TrieNode - a node of the prefix trie. The node of depth N stands for
+  /// the first N characters of the mapping names.
+  struct TrieNode
+  {
+    TrieNode();
+
+    /// children - the (character, node index) pairs, sorted by character
+    std::vector<std::pair<char, unsigned int> > children;
+
+    /// mapping - the index of the first mapping of the prefix, or NoMapping
+    unsigned int mapping;
+  };
+
+  typedef std::vector<TrieNode> TrieNodeList;
+
+  enum { NoMapping = ~0u };
+
+private:
+  /// lookup - the index of the first mapping matching pInput, or NoMapping
+  unsigned int lookup(const std::string& pInput) const;
+
+  /// insert - add the mapping pIndex into the trie
+  void insert(unsigned int pIndex);
+
+  /// getChild - the child of pNode by pChar, or NoMapping
+  unsigned int getChild(unsigned int pNode, char pChar) const;
+
 private:
   NamePairList m_NamePairList;
+
+  /// m_Trie - the prefix trie of the mappings. m_Trie[0] is the root.
+  TrieNodeList m_Trie;
+
+  /// m_Wildcard - the index of the first `*' mapping, or NoMapping
+  unsigned int m_Wildcard;
 };
 
 } // namespace of mcld
@@ -0,0 +1,122 @@
+//===- SectionScript.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_OBJECT_SECTION_SCRIPT_H
+#define MCLD_OBJECT_SECTION_SCRIPT_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Object/SectionMap.h>
+#include <mcld/Support/GlobMatcher.h>
+
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+namespace sys {
+namespace fs {
+class Path;
+} // namespace of fs
+} // namespace of sys
+
+/** \class SectionScript
+ *  \brief The input section placement of the SECTIONS command of a linker
+ *  script.
+ *
+ *  An input section description `EXCLUDE_FILE(*crtend.o) *(.text .text.*)'
+ *  of an output section becomes a rule. An input section is placed by the
+ *  first rule whose file pattern matches the path of its input file, whose
+ *  excluded files do not, and whose section patterns match its name. The
+ *  patterns of all rules are compiled into three GlobMatchers, of the file
+ *  patterns, the excluded files and the section patterns, so find() reads a
+ *  name once whatever the number of the rules.
+ *
+ *  The patterns in SORT_BY_NAME(), SORT() and SORT_BY_ALIGNMENT() form a
+ *  rule of their own, and the sections of the rule are sorted. The output
+ *  addresses, the memory regions, the symbol assignments and the other
+ *  commands are skipped. The rules of /DISCARD/ are skipped, too, and the
+ *  sections are kept.
+ */
+class SectionScript
+{
+public:
+  enum SortPolicy {
+    Unsorted,
+    SortByName,
+    SortByAlignment
+  };
+
+  struct Rule
+  {
+    /// mapping - the output section of the rule, in the Regular group
+    SectionMap::NamePair mapping;
+    SortPolicy sort;
+  };
+
+  typedef std::vector<std::string> PatternList;
+
+  enum { NoRule = ~0u };
+
+public:
+  SectionScript();
+
+  ~SectionScript();
+
+  /// read - read the SECTIONS commands of the linker script pPath
+  /// @return false if the file can not be read
+  bool read(const sys::fs::Path& pPath);
+
+  /// parse - add the rules of the SECTIONS commands of pContent and compile
+  /// them
+  void parse(llvm::StringRef pContent);
+
+  /// append - add the rule placing the sections pSections of the files
+  /// pFile but pExcludes into pOutput. compile() must be called before
+  /// find().
+  void append(const std::string& pOutput,
+              llvm::StringRef pFile,
+              const PatternList& pExcludes,
+              const PatternList& pSections,
+              SortPolicy pSort = Unsorted);
+
+  /// compile - compile the patterns of the rules
+  void compile();
+
+  /// find - the rule of the section pSection of the input file pFile, or
+  /// NoRule
+  unsigned int find(llvm::StringRef pFile, llvm::StringRef pSection) const;
+
+  const Rule& getRule(unsigned int pIdx) const { return m_Rules[pIdx]; }
+
+  // ----- observers ----- //
+  bool empty() const { return m_Rules.empty(); }
+
+  size_t size() const { return m_Rules.size(); }
+
+  /// hasDiscard - is a /DISCARD/ output section skipped?
+  bool hasDiscard() const { return m_bDiscard; }
+
+private:
+  typedef std::vector<Rule> RuleList;
+
+private:
+  RuleList m_Rules;
+  GlobMatcher m_FileMatcher;
+  GlobMatcher m_ExcludeMatcher;
+  GlobMatcher m_SectionMatcher;
+  bool m_bDiscard;
+};
+
+} // namespace of mcld
+
+#endif
+
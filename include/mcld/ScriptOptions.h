@@ -17,6 +17,7 @@
 #include <mcld/ADT/StringHash.h>
 #include <mcld/ADT/HashTable.h>
 #include <mcld/Object/SectionMap.h>
+#include <mcld/Object/SectionScript.h>
 
 namespace mcld {
 
@@ -48,10 +49,15 @@ public:
   const SectionMap& sectionMap() const { return m_SectionMap; }
   SectionMap&       sectionMap()       { return m_SectionMap; }
 
+  /// sections - the input section placement of the linker script
+  const SectionScript& sections() const { return m_Sections; }
+  SectionScript&       sections()       { return m_Sections; }
+
 private:
   SymbolRenameMap m_SymbolRenames;
   AddressMap m_AddressMap;
   SectionMap m_SectionMap;
+  SectionScript m_Sections;
 };
 
 } // namespace of mcld
@@ -13,6 +13,8 @@
 #endif
 #include <mcld/ADT/Uncopyable.h>
 #include <mcld/ADT/TypeTraits.h>
+#include <mcld/Support/MemoryUsage.h>
+#include <mcld/Support/PageHeap.h>
 
 #include <cstddef>
 #include <cstdlib>
@@ -22,6 +24,8 @@ namespace mcld {
 /** \class Chunk
  *  \brief Chunk is the basic unit of the storage of the LinearAllocator
  *
+ *  The chunks are allocated from the PageHeap.
+ *
  *  @see LinearAllocator
  */
 template<typename DataType, size_t ChunkSize>
@@ -34,8 +38,17 @@ public:
   : next(0), bound(0)
   { }
 
+  static void* operator new(size_t pSize)
+  { return PageHeap::allocate(pSize); }
+
+  static void operator delete(void* pPtr, size_t pSize)
+  { PageHeap::deallocate(pPtr, pSize); }
+
   static size_t size() { return ChunkSize; }
 
+  /// bytes - the bytes allocated for a chunk
+  static size_t bytes() { return sizeof(Chunk); }
+
   static void construct(value_type* pPtr)
   { new (pPtr) value_type(); }
 
@@ -61,20 +74,29 @@ public:
   Chunk()
   : next(0), bound(0) {
     if (0 != m_Size)
-      data = (DataType*)malloc(sizeof(DataType)*m_Size);
+      data = (DataType*)PageHeap::allocate(sizeof(DataType)*m_Size);
     else
       data = 0;
   }
 
   ~Chunk() {
     if (data)
-      free(data);
+      PageHeap::deallocate(data, sizeof(DataType)*m_Size);
   }
 
+  static void* operator new(size_t pSize)
+  { return PageHeap::allocate(pSize); }
+
+  static void operator delete(void* pPtr, size_t pSize)
+  { PageHeap::deallocate(pPtr, pSize); }
+
   static size_t size() { return m_Size; }
 
   static void setSize(size_t pSize) { m_Size = pSize; }
 
+  /// bytes - the bytes allocated for a chunk
+  static size_t bytes() { return sizeof(Chunk) + sizeof(DataType) * m_Size; }
+
   static void construct(value_type* pPtr)
   { new (pPtr) value_type(); }
 
@@ -112,7 +134,8 @@ protected:
   LinearAllocatorBase()
     : m_pRoot(0),
       m_pCurrent(0),
-      m_AllocatedNum(0) {
+      m_AllocatedNum(0),
+      m_UsageKind(MemoryUsage::GCFactories) {
   }
 
   // LinearAllocatorBase does NOT mean to destroy the allocated memory.
@@ -167,6 +190,8 @@ public:
       getNewChunk();
     result = m_pCurrent->data + m_pCurrent->bound;
     m_pCurrent->bound += N;
+    if (MemoryUsage::isEnabled())
+      MemoryUsage::AddObjects(m_UsageKind, N);
     return result;
   }
 
@@ -180,6 +205,8 @@ public:
       getNewChunk();
     result = m_pCurrent->data + m_pCurrent->bound;
     ++m_pCurrent->bound;
+    if (MemoryUsage::isEnabled())
+      MemoryUsage::AddObjects(m_UsageKind);
     return result;
   }
 
@@ -196,6 +223,8 @@ public:
       return;
     m_pCurrent->bound -= N;
     pPtr = 0;
+    if (MemoryUsage::isEnabled())
+      MemoryUsage::RemoveObjects(m_UsageKind, N);
   }
 
   /// deallocate - clone function of deallocating one datum
@@ -206,6 +235,8 @@ public:
       return;
     m_pCurrent->bound -= 1;
     pPtr = 0;
+    if (MemoryUsage::isEnabled())
+      MemoryUsage::RemoveObjects(m_UsageKind);
   }
 
   /// isIn - whether the pPtr is in the current chunk?
@@ -233,13 +264,20 @@ public:
   /// clear - clear all chunks
   void clear() {
     chunk_type *cur = m_pRoot, *prev;
+    size_t num_of_chunks = 0, num_of_objects = 0;
     while (0 != cur) {
       prev = cur;
       cur = cur->next;
       for (unsigned int idx = 0; idx != prev->bound; ++idx)
         destroy(prev->data + idx);
+      num_of_objects += prev->bound;
+      ++num_of_chunks;
       delete prev;
     }
+    if (MemoryUsage::isEnabled()) {
+      MemoryUsage::Release(m_UsageKind, num_of_chunks * chunk_type::bytes());
+      MemoryUsage::RemoveObjects(m_UsageKind, num_of_objects);
+    }
     reset();
   }
 
@@ -252,10 +290,16 @@ public:
   { return m_AllocatedNum; }
 
 protected:
+  /// setUsageKind - count the memory of this allocator as pKind
+  void setUsageKind(MemoryUsage::Kind pKind)
+  { m_UsageKind = pKind; }
+
   inline void initialize() {
     m_pRoot = new chunk_type();
     m_pCurrent = m_pRoot;
     m_AllocatedNum += chunk_type::size();
+    if (MemoryUsage::isEnabled())
+      MemoryUsage::Allocate(m_UsageKind, chunk_type::bytes());
   }
 
   inline chunk_type *getNewChunk() {
@@ -263,6 +307,8 @@ protected:
     m_pCurrent->next = result;
     m_pCurrent = result;
     m_AllocatedNum += chunk_type::size();
+    if (MemoryUsage::isEnabled())
+      MemoryUsage::Allocate(m_UsageKind, chunk_type::bytes());
     return result;
   }
 
@@ -270,6 +316,7 @@ protected:
   chunk_type *m_pRoot;
   chunk_type *m_pCurrent;
   size_type   m_AllocatedNum;
+  MemoryUsage::Kind m_UsageKind;
 };
 
 /** \class LinearAllocator
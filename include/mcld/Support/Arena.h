@@ -0,0 +1,80 @@
+//===- Arena.h ------------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_ARENA_H
+#define MCLD_SUPPORT_ARENA_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/MemoryUsage.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace mcld {
+
+/** \class Arena
+ *  \brief Arena allocates objects of any size from slabs by bumping a
+ *  pointer, and releases all of them at once.
+ *
+ *  The objects in an Arena are never freed one by one. release() frees the
+ *  slabs without touching the objects, so the clients must have destroyed
+ *  the objects which own other resources before.
+ *
+ *  The slabs are allocated from the PageHeap. Arena is not thread-safe.
+ */
+class Arena : private Uncopyable
+{
+public:
+  explicit Arena(MemoryUsage::Kind pKind);
+
+  ~Arena();
+
+  /// allocate - allocate pSize bytes aligned to 8 bytes
+  void* allocate(size_t pSize);
+
+  /// release - free all slabs
+  void release();
+
+  /// numOfSlabs - the number of allocated slabs
+  size_t numOfSlabs() const
+  { return m_Slabs.size(); }
+
+  /// bytes - the bytes of all slabs
+  size_t bytes() const
+  { return m_Bytes; }
+
+private:
+  /// SlabListType - the slabs and their sizes
+  typedef std::vector<std::pair<char*, size_t> > SlabListType;
+
+  static const size_t SlabSize  = 64 * 1024;
+  static const size_t Alignment = 8;
+
+private:
+  static size_t align(size_t pSize)
+  { return (pSize + Alignment - 1) & ~(Alignment - 1); }
+
+  /// addSlab - allocate a slab of pSize bytes
+  char* addSlab(size_t pSize);
+
+private:
+  MemoryUsage::Kind m_Kind;
+  SlabListType m_Slabs;
+  char* m_pCurrent;
+  char* m_pEnd;
+  size_t m_Bytes;
+  size_t m_NumOfObjects;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,76 @@
+//===- Compression.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_COMPRESSION_H
+#define MCLD_SUPPORT_COMPRESSION_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+#include <cstddef>
+
+namespace mcld {
+
+class ThreadPool;
+
+namespace zlib {
+
+enum { DefaultChunkSize = 1 << 20 };
+
+/// isAvailable - is MCLinker built with zlib?
+bool isAvailable();
+
+/// compress - compress the pSize bytes of pData into a zlib stream.
+///
+/// The input is cut into chunks of pChunkSize bytes, and the chunks are
+/// deflated in parallel. Every chunk but the last one ends with a sync flush,
+/// so the raw deflate outputs of the chunks are concatenated into one deflate
+/// stream. The adler-32 checksums of the chunks are combined into the one of
+/// the whole input. The output only depends on pChunkSize, not on the number
+/// of threads.
+///
+/// @return false if zlib is not available or fails
+bool compress(ThreadPool& pPool,
+              const uint8_t* pData,
+              size_t pSize,
+              std::vector<uint8_t>& pResult,
+              size_t pChunkSize = DefaultChunkSize);
+
+/// uncompress - inflate the zlib stream of the pSize bytes of pData into the
+/// pResultSize bytes of pResult.
+/// @return false if zlib is not available, or the stream is broken or is not
+/// inflated into exactly pResultSize bytes
+bool uncompress(const uint8_t* pData,
+                size_t pSize,
+                uint8_t* pResult,
+                size_t pResultSize);
+
+} // namespace of zlib
+
+namespace zstd {
+
+/// isAvailable - is MCLinker built with zstd?
+bool isAvailable();
+
+/// uncompress - decompress the zstd frames of the pSize bytes of pData into
+/// the pResultSize bytes of pResult.
+/// @return false if zstd is not available, or the frames are broken or are
+/// not decompressed into exactly pResultSize bytes
+bool uncompress(const uint8_t* pData,
+                size_t pSize,
+                uint8_t* pResult,
+                size_t pResultSize);
+
+} // namespace of zstd
+} // namespace of mcld
+
+#endif
+
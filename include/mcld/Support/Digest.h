@@ -0,0 +1,79 @@
+//===- Digest.h -----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_DIGEST_H
+#define MCLD_SUPPORT_DIGEST_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+class ThreadPool;
+
+namespace digest {
+
+enum Kind {
+  Fast,   ///< xxHash64, stored in the little endian
+  MD5,
+  SHA1
+};
+
+enum { DefaultChunkSize = 1 << 20 };
+
+/// size - the number of bytes of a digest of pKind
+size_t size(Kind pKind);
+
+/// hash - hash the pSize bytes of pData into pResult, which holds size(pKind)
+/// bytes.
+void hash(Kind pKind, const uint8_t* pData, size_t pSize, uint8_t* pResult);
+
+/// fast - the xxHash64 of the pSize bytes of pData with the seed pSeed. The
+/// hash of a piece is the seed of the next one when several pieces are
+/// hashed together.
+uint64_t fast(const uint8_t* pData, size_t pSize, uint64_t pSeed = 0);
+
+/// treeHash - hash the pSize bytes of pData as a tree of two levels.
+///
+/// The input is cut into chunks of pChunkSize bytes, and the chunks are
+/// hashed in parallel. The digest of the concatenated digests of the chunks
+/// is the result. Like zlib::compress(), the result only depends on
+/// pChunkSize, not on the number of threads. It is not the plain digest of
+/// the input, but is as good as one to identify the input.
+void treeHash(ThreadPool& pPool,
+              Kind pKind,
+              const uint8_t* pData,
+              size_t pSize,
+              uint8_t* pResult,
+              size_t pChunkSize = DefaultChunkSize);
+
+/// crc32 - the CRC-32 of IEEE 802.3 of the pSize bytes of pData, continued
+/// from the CRC pCRC of the bytes before them. It is the CRC of zlib and of
+/// .gnu_debuglink.
+uint32_t crc32(const uint8_t* pData, size_t pSize, uint32_t pCRC = 0);
+
+/// crc32Combine - the CRC of the concatenation of A and B, from the CRC
+/// pCRCA of A, and the CRC pCRCB of the pSizeB bytes of B
+uint32_t crc32Combine(uint32_t pCRCA, uint32_t pCRCB, uint64_t pSizeB);
+
+/// crc32 - compute the CRC-32 of the chunks of pChunkSize bytes of pData in
+/// parallel, and then combine them. The result is the plain CRC-32.
+uint32_t crc32(ThreadPool& pPool,
+               const uint8_t* pData,
+               size_t pSize,
+               size_t pChunkSize = DefaultChunkSize);
+
+} // namespace of digest
+} // namespace of mcld
+
+#endif
+
@@ -69,6 +69,15 @@ public:
 
   typedef Flags<PermissionEnum> Permission;
 
+  enum Advice
+  {
+    NormalAccess,
+    SequentialAccess,
+    RandomAccess,
+    WillNeed,
+    DontNeed
+  };
+
 public:
   FileHandle();
 
@@ -83,6 +92,11 @@ public:
 
   bool delegate(int pFD, OpenMode pMode = Unknown);
 
+  /// openAnonymous - open a read-write file which lives in the memory and
+  /// has no path.
+  /// @return false if the system does not provide anonymous files.
+  bool openAnonymous();
+
   bool close();
 
   void setState(IOState pState);
@@ -92,14 +106,36 @@ public:
   // truncate - truncate the file up to the pSize.
   bool truncate(size_t pSize);
 
+  // allocate - reserve the blocks of the file up to pSize at once, so that
+  // writing the file never extends it. A smaller pSize truncates the file.
+  bool allocate(size_t pSize);
+
   bool read(void* pMemBuffer, size_t pStartOffset, size_t pLength);
 
   bool write(const void* pMemBuffer, size_t pStartOffset, size_t pLength);
 
+  /// copy - copy [pSourceOffset, pSourceOffset+pLength) of pSource into the
+  /// file at pStartOffset in the kernel, by copy_file_range() on Linux. The
+  /// file systems which share extents make a reflink instead of a copy.
+  /// @return false if the system can not copy the range, e.g., the files are
+  /// on different file systems. The state of the handler is not changed
+  /// then, and the caller should write the range by itself.
+  bool copy(const FileHandle& pSource, size_t pSourceOffset,
+            size_t pStartOffset, size_t pLength);
+
   bool mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength);
 
   bool munmap(void* pMemBuffer, size_t pLength);
 
+  /// advise - tell the system how [pStartOffset, pStartOffset+pLength) of
+  /// the file will be accessed. pLength 0 means to the end of the file.
+  /// An advice is only a hint, it never changes the state of the handler.
+  /// @return false if the system does not take the advice.
+  bool advise(Advice pAdvice, size_t pStartOffset = 0, size_t pLength = 0);
+
+  /// madvise - tell the system how a buffer mapped by mmap() will be accessed.
+  bool madvise(void* pMemBuffer, size_t pLength, Advice pAdvice);
+
   // -----  observers  ----- //
   const sys::fs::Path& path() const
   { return m_Path; }
@@ -129,6 +165,10 @@ public:
 
   bool isReadWrite() const;
 
+  /// isSeekable - can the file be accessed at any offset? Pipes, sockets
+  /// and terminals can only be written in order.
+  bool isSeekable() const;
+
   int error() const { return errno; }
 
 private:
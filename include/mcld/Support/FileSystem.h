@@ -19,6 +19,7 @@
 
 #include "mcld/Support/PathCache.h"
 #include <mcld/Config/Config.h>
+#include <llvm/Support/DataTypes.h>
 #include <string>
 #include <iosfwd>
 #include <locale>
@@ -73,6 +74,46 @@ inline bool operator!=(const FileStatus& rhs, const FileStatus& lhs ) {
   return !(rhs == lhs);
 }
 
+/** \class FileID
+ *  \brief FileID identifies a physical file by its device, its inode and the
+ *  time of its last modification.
+ *
+ *  Different paths, such as symbolic links, hard links and duplicated search
+ *  directories, may refer to the same physical file. They have the same
+ *  FileID. A file rewritten between two lookups gets a different FileID.
+ */
+class FileID
+{
+public:
+  FileID()
+    : m_Device(0), m_Inode(0), m_ModTime(0) {}
+
+  FileID(uint64_t pDevice, uint64_t pInode, uint64_t pModTime)
+    : m_Device(pDevice), m_Inode(pInode), m_ModTime(pModTime) {}
+
+  uint64_t device () const { return m_Device;  }
+  uint64_t inode  () const { return m_Inode;   }
+  uint64_t modTime() const { return m_ModTime; }
+
+  /// isValid - the system gives no inode if the file can not be found.
+  bool isValid() const { return (0 != m_Inode); }
+
+private:
+  uint64_t m_Device;
+  uint64_t m_Inode;
+  uint64_t m_ModTime;
+};
+
+inline bool operator==(const FileID& rhs, const FileID& lhs) {
+  return (rhs.inode()   == lhs.inode() &&
+          rhs.device()  == lhs.device() &&
+          rhs.modTime() == lhs.modTime());
+}
+
+inline bool operator!=(const FileID& rhs, const FileID& lhs) {
+  return !(rhs == lhs);
+}
+
 class Path;
 class DirIterator;
 class Directory;
@@ -101,7 +142,9 @@ extern std::string bitcode_extension;
 size_t canonicalize(std::string& pPathName);
 bool not_found_error(int perrno);
 void status(const Path& p, FileStatus& pFileStatus);
+void status(const Path& p, FileStatus& pFileStatus, FileID& pFileID);
 void symlink_status(const Path& p, FileStatus& pFileStatus);
+void file_id(const Path& p, FileID& pFileID);
 mcld::sys::fs::PathCache::entry_type* bring_one_into_cache(DirIterator& pIter);
 void open_dir(Directory& pDir);
 void close_dir(Directory& pDir);
@@ -112,6 +155,18 @@ int open(const Path& pPath, int pOFlag, int pPermission);
 ssize_t pread(int pFD, void* pBuf, size_t pCount, size_t pOffset);
 ssize_t pwrite(int pFD, const void* pBuf, size_t pCount, size_t pOffset);
 int ftruncate(int pFD, size_t pLength);
+int rename(const Path& pFrom, const Path& pTo);
+int unlink(const Path& pPath);
+
+/// mmap - map pLength bytes at pOffset of file pFD. A writable view is
+/// shared with the file, and a read-only view is private.
+/// @return NULL if the mapping fails
+void* mmap(int pFD, size_t pOffset, size_t pLength,
+           bool pReadable, bool pWritable);
+int munmap(void* pAddr, size_t pLength);
+
+/// map_granularity - the alignment of the file offsets of the views
+size_t map_granularity();
 
 } // namespace of detail
 } // namespace of fs
@@ -170,6 +170,12 @@ public:
     m_NumAllocData = 0;
   }
 
+  /// clear - destroy all data and release the chunks
+  void clear() {
+    Alloc::clear();
+    m_NumAllocData = 0;
+  }
+
   // -----  iterators  ----- //
   iterator begin()
   { return iterator(Alloc::m_pRoot, 0); }
@@ -0,0 +1,127 @@
+//===- GlobMatcher.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_GLOB_MATCHER_H
+#define MCLD_SUPPORT_GLOB_MATCHER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/StringRef.h>
+
+#include <bitset>
+#include <map>
+#include <vector>
+
+namespace mcld {
+
+/** \class GlobMatcher
+ *  \brief GlobMatcher matches a name against many shell patterns at once.
+ *
+ *  The patterns of `*', `?' and `[...]' are compiled together into one DFA
+ *  by the subset construction. The characters that no pattern tells apart
+ *  share one class, so a state has a transition per class. match() walks
+ *  the name once, whatever the number of the patterns, and stops as soon as
+ *  no pattern can match.
+ *
+ *  After compile(), match() only reads the DFA and may be called by many
+ *  threads. Adding a pattern drops the DFA until the next compile().
+ */
+class GlobMatcher
+{
+public:
+  typedef std::vector<unsigned int> IDList;
+
+public:
+  GlobMatcher();
+
+  /// add - add pPattern, which reports pID when it matches
+  void add(llvm::StringRef pPattern, unsigned int pID);
+
+  /// compile - build the DFA of the patterns added so far
+  void compile();
+
+  /// match - the IDs of the patterns matching pName, in increasing order
+  const IDList& match(llvm::StringRef pName) const;
+
+  bool isCompiled() const { return !m_States.empty(); }
+
+  bool empty() const { return m_Patterns.empty(); }
+
+  /// numOfStates - the number of the DFA states, including the dead one
+  size_t numOfStates() const { return m_States.size(); }
+
+private:
+  /// Element - `*', or a set of characters for `?', `[...]' or a character
+  struct Element
+  {
+    bool isStar;
+    std::bitset<256> chars;
+  };
+
+  struct Pattern
+  {
+    std::vector<Element> elements;
+    unsigned int id;
+    /// base - the NFA position of the first element. The position after
+    /// the last element is the accepting one.
+    unsigned int base;
+  };
+
+  /// State - a DFA state. The state 0 is dead.
+  struct State
+  {
+    /// next - the next state of each character class
+    std::vector<unsigned int> next;
+    /// accept - the index of the IDs the state accepts in m_Accepts
+    unsigned int accept;
+  };
+
+  /// PositionSet - the sorted NFA positions of a DFA state
+  typedef std::vector<unsigned int> PositionSet;
+
+  typedef std::map<PositionSet, unsigned int> StateMap;
+
+private:
+  /// parse - the elements of pPattern
+  static void parse(llvm::StringRef pPattern, std::vector<Element>& pElements);
+
+  /// computeClasses - group the characters into m_Classes
+  void computeClasses();
+
+  /// closure - add the positions past the `*'s of pSet, and sort pSet
+  void closure(PositionSet& pSet) const;
+
+  /// getElement - the element at NFA position pPos, or NULL if pPos is an
+  /// accepting position
+  const Element* getElement(unsigned int pPos) const;
+
+  /// getState - the DFA state of pSet, which is created if it is new
+  unsigned int getState(const PositionSet& pSet,
+                        StateMap& pStateMap,
+                        std::vector<PositionSet>& pSets);
+
+private:
+  std::vector<Pattern> m_Patterns;
+
+  /// m_Owners - the pattern of every NFA position
+  std::vector<unsigned int> m_Owners;
+
+  /// m_Classes - the character class of every character
+  unsigned int m_Classes[256];
+  unsigned int m_NumOfClasses;
+
+  std::vector<State> m_States;
+  std::vector<IDList> m_Accepts;
+  unsigned int m_Start;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -16,6 +16,7 @@
 #include <mcld/ADT/StringHash.h>
 #include <mcld/Support/Path.h>
 #include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
 #include <vector>
 
 namespace mcld
@@ -28,6 +29,10 @@ class MemoryArea;
  *  Special double-key associative container. Keys are Path and file handler,
  *  associative value is MemoryArea.
  *
+ *  A file may be reached through several paths, such as symbolic links and
+ *  duplicated search directories. If no record has the given path,
+ *  findFirst() looks for the record of the same physical file by its FileID.
+ *
  *  For high performance, HandleToArea is not designed to contain unique
  *  <key, value> pair. The key and value may be duplicated.
  *
@@ -39,6 +44,7 @@ class HandleToArea : private Uncopyable
 private:
   struct Bucket {
     unsigned int hash_value;
+    sys::fs::FileID id;
     FileHandle* handle;
     MemoryArea* area;
   };
@@ -109,6 +115,9 @@ public:
 
   ~HandleToArea() { }
 
+private:
+  const Bucket* findByID(const sys::fs::Path& pPath) const;
+
 private:
   HandleToAreaMap m_AreaMap;
 };
@@ -91,6 +91,25 @@ int64_t decode<int64_t>(const ByteType *pBuf, size_t &pSize);
 template<>
 int64_t decode<int64_t>(const ByteType *&pBuf);
 
+/*
+ * Skip pNum values encoded in LEB128 format, signed or unsigned, from the
+ * given buffer. Return the point just past the end of the last value, or NULL
+ * if the values run past pEnd. Eight bytes are checked at a time, so a run of
+ * short values is skipped in a few steps.
+ */
+const ByteType *skip(const ByteType *pBuf, const ByteType *pEnd,
+                     size_t pNum = 1);
+
+/*
+ * Read pNum integers encoded in ULEB128 format from the given buffer into
+ * pValues. Return the point just past the end of the last value, or NULL if
+ * the values run past pEnd. The values which end within the same eight bytes
+ * are decoded from one load; the values longer than eight bytes and the last
+ * bytes of the buffer are decoded byte by byte.
+ */
+const ByteType *decode(const ByteType *pBuf, const ByteType *pEnd,
+                       uint64_t *pValues, size_t pNum);
+
 /*
  * The functions below handle the signed byte stream. This helps the user to get
  * rid of annoying type conversions when using the LEB128 encoding/decoding APIs
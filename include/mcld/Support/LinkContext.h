@@ -0,0 +1,96 @@
+//===- LinkContext.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_LINK_CONTEXT_H
+#define MCLD_SUPPORT_LINK_CONTEXT_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/LD/DiagnosticEngine.h>
+
+namespace mcld {
+
+class raw_fd_ostream;
+class RelocationFactory;
+
+/** \class LinkContext
+ *  \brief LinkContext holds the mutable state of one link, which used to be
+ *  global to the process: the diagnostic engine behind fatal(), error() and
+ *  the other free functions of MsgHandling, the streams of mcld::outs() and
+ *  mcld::errs(), the counter of the inputs printed by --trace, and the
+ *  factory of the relocations.
+ *
+ *  Every thread has a current context, and the free functions are thin
+ *  wrappers over it, so several links can run on different threads of one
+ *  process. A LinkerConfig owns the context of its link, and makes it
+ *  current when it is created, and the Linker makes it current again when
+ *  it is called. The threads of ThreadPool and TaskQueue take the context of
+ *  the thread which gives them the tasks. A thread without a current context
+ *  uses the default context of the process.
+ */
+class LinkContext : private Uncopyable
+{
+public:
+  LinkContext();
+
+  ~LinkContext();
+
+  /// Current - the current context of the calling thread
+  static LinkContext& Current();
+
+  /// activate - make this context current in the calling thread
+  void activate();
+
+  /// SetCurrent - make pContext current in the calling thread. If pContext
+  /// is NULL, the calling thread uses the default context.
+  static void SetCurrent(LinkContext* pContext);
+
+  /// GetCurrent - the context set by SetCurrent(), or NULL if the calling
+  /// thread uses the default context
+  static LinkContext* GetCurrent();
+
+  // -----  state  ----- //
+  DiagnosticEngine& getDiagEngine() { return m_DiagEngine; }
+
+  /// outs - the standard output of the link
+  raw_fd_ostream& outs();
+
+  /// errs - the standard error of the link
+  raw_fd_ostream& errs();
+
+  /// setOuts - redirect the standard output of the link to pStream. The
+  /// caller keeps the ownership of pStream.
+  void setOuts(raw_fd_ostream& pStream) { m_pOuts = &pStream; }
+
+  /// setErrs - redirect the standard error of the link to pStream. The
+  /// caller keeps the ownership of pStream. The printer of the diagnostics
+  /// is not changed; give InitializeDiagnosticEngine() a printer of pStream.
+  void setErrs(raw_fd_ostream& pStream) { m_pErrs = &pStream; }
+
+  /// nextTraceID - the number of the next input printed by --trace
+  unsigned int nextTraceID() { return m_TraceCounter++; }
+
+  /// getRelocationFactory - the factory of the relocations of the link. It
+  /// is created by the first call, which Relocation::SetUp() makes before
+  /// any relocation is created.
+  RelocationFactory& getRelocationFactory();
+
+private:
+  DiagnosticEngine m_DiagEngine;
+  raw_fd_ostream* m_pOuts;
+  raw_fd_ostream* m_pErrs;
+  unsigned int m_TraceCounter;
+  RelocationFactory* m_pRelocFactory;
+};
+
+} // namespace of mcld
+
+#endif
+
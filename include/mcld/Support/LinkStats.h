@@ -0,0 +1,105 @@
+//===- LinkStats.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_LINK_STATS_H
+#define MCLD_SUPPORT_LINK_STATS_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/Support/DataTypes.h>
+
+namespace llvm {
+class raw_ostream;
+} // namespace of llvm
+
+namespace mcld {
+
+class Relocator;
+
+/** \class LinkStats
+ *  \brief LinkStats counts the work done in the phases of a link.
+ *
+ *  Like MemoryUsage, nothing is counted until Enable() is called, and the
+ *  counters are shared by all threads and guarded by a lock. The counters
+ *  are grouped by the phase that changes them when they are printed.
+ */
+class LinkStats
+{
+public:
+  enum Counter {
+    // inputs
+    ObjectInputs,
+    ArchiveInputs,
+    DynObjInputs,
+    ScriptInputs,
+    ArchiveLookups,          ///< undefined symbols looked up in the armaps
+    ArchiveMembersScanned,   ///< candidate members checked for inclusion
+    ArchiveMembersIncluded,
+    // symbol resolution
+    SymbolsInserted,
+    SymbolsResolved,         ///< inserted symbols which already existed
+    SymbolsOverridden,       ///< resolved symbols which replaced the old ones
+    HashLookups,
+    HashProbes,              ///< groups of buckets probed by the lookups
+    HashMaxProbes,           ///< the longest probe of a lookup
+    HashRehashes,
+    // relocations
+    Relocations,
+    GOTEntries,
+    PLTEntries,
+    // layout
+    RelaxationIterations,
+    BranchIslands,
+    Stubs,
+    // input and output
+    BytesMapped,
+    BytesCopied,
+    NumOfCounters
+  };
+
+public:
+  static void Enable(bool pEnable = true);
+
+  static bool isEnabled()
+  { return g_bEnabled; }
+
+  /// Add - add pNum to the counter
+  static void Add(Counter pCounter, uint64_t pNum = 1);
+
+  /// Set - set the counter to pValue
+  static void Set(Counter pCounter, uint64_t pValue);
+
+  /// AddProbes - count a lookup of a hash table which probed pProbes groups
+  static void AddProbes(uint64_t pProbes);
+
+  /// AddRelocation - count a relocation of pType
+  static void AddRelocation(uint8_t pType);
+
+  static uint64_t Get(Counter pCounter);
+
+  /// GetRelocations - the number of relocations of pType
+  static uint64_t GetRelocations(uint8_t pType);
+
+  static const char* GetName(Counter pCounter);
+
+  /// Reset - zero all counters
+  static void Reset();
+
+  /// Print - print the counters by phase. The relocation types are named by
+  /// pRelocator if it is not NULL.
+  static void Print(llvm::raw_ostream& pOS, const Relocator* pRelocator);
+
+private:
+  static bool g_bEnabled;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -13,8 +13,11 @@
 #endif
 
 #include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryView.h>
+#include <mcld/Support/Thread.h>
 #include <cstddef>
-#include <map>
+#include <vector>
 
 #if defined(ENABLE_UNITTEST)
 namespace mcldtest {
@@ -25,7 +28,6 @@ namespace mcldtest {
 namespace mcld {
 
 class Space;
-class FileHandle;
 class MemoryRegion;
 
 /** \class MemoryArea
@@ -68,6 +70,43 @@ public:
   // assign a MemoryRegion into the space.
   MemoryRegion* request(size_t pOffset, size_t pLength);
 
+  // view - get a read-only view of [pOffset, pOffset + pLength) which is
+  // valid until clear(). A view into the whole mapped file or the universal
+  // space is a slice of it, and allocates nothing. Otherwise the space of the
+  // view is pinned by a region until clear().
+  MemoryView view(size_t pOffset, size_t pLength);
+
+  // preload - read a range of the file into a space without creating any
+  // MemoryRegion. The following request() of the range will be served by the
+  // preloaded space.
+  // Since preload() does not touch the global region factory, it is safe to
+  // call preload() concurrently, even on the same MemoryArea, as long as no
+  // other method of the MemoryArea runs at the same time.
+  // @return the space holding the range, or NULL if the range is out of the
+  // file.
+  Space* preload(size_t pOffset, size_t pLength);
+
+  // mapWholeFile - map the whole file into one space once, and serve all
+  // following requests as slices of the space. The space is kept until
+  // clear(). A writable file is mapped up to its current size, so it should
+  // be allocated to its final size first.
+  // @return false if the file can not be mapped at once. MemoryArea then
+  // falls back to read or map the requested parts of the file.
+  bool mapWholeFile();
+
+  bool isWholeFileMapped() const { return (NULL != m_pWholeFile); }
+
+  // setMapping - if pEnable is false, request() never maps the file. The new
+  // spaces are read into the dynamic memory, and the spaces of a writable
+  // file are written back by a single write when they are released.
+  void setMapping(bool pEnable = true) { m_bMapping = pEnable; }
+
+  bool isMapping() const { return m_bMapping; }
+
+  // prefetch - ask the system to read the whole file ahead asynchronously.
+  // It returns at once and never changes the contents of the area.
+  void prefetch();
+
   // release - release a MemoryRegion.
   // release a MemoryRegion does not cause
   void release(MemoryRegion* pRegion);
@@ -75,46 +114,52 @@ public:
   // clear - release all memory regions.
   void clear();
 
+  // advise - tell the system how all spaces of the file will be accessed.
+  void advise(FileHandle::Advice pAdvice);
+
   const FileHandle* handler() const { return m_pFileHandle; }
   FileHandle*       handler()       { return m_pFileHandle; }
 
   bool hasHandler() const { return (NULL != m_pFileHandle); }
 
+  // size - the size of the file, or the end of the universal space if the
+  // area has no file handler, e.g., an input handed in from the memory.
+  size_t size() const;
+
   // -----  space list methods  ----- //
+  /// find - find a space that contains the whole range
+  /// [pOffset, pOffset + pLength).
   Space* find(size_t pOffset, size_t pLength);
 
   const Space* find(size_t pOffset, size_t pLength) const;
 
 private:
-  class Key {
-  public:
-    Key(size_t pOffset, size_t pLength)
-    : m_Offset(pOffset), m_Length(pLength)
-    { }
-
-    size_t offset() const { return m_Offset; }
+  /// SpaceList - spaces sorted by their start offsets.
+  /// Spaces may overlap because mapped spaces are aligned to pages, so we
+  /// also keep the size of the largest space. A space containing offset X
+  /// starts in [X - m_MaxSpaceSize, X], and a lookup only walks through the
+  /// spaces starting in that interval.
+  typedef std::vector<Space*> SpaceList;
 
-    size_t length() const { return m_Length; }
+  typedef std::vector<MemoryRegion*> RegionList;
 
-    struct Compare {
-      bool operator()(const Key& KEY1, const Key& KEY2) const
-      {
-        return KEY1.offset() + KEY1.length() <= KEY2.offset() ||
-               (KEY1.offset() < KEY2.offset() &&
-                (KEY1.offset() + KEY1.length() < KEY2.offset() + KEY2.length()));
-      }
-    };
+  void insert(Space& pSpace);
 
-  private:
-    size_t m_Offset;
-    size_t m_Length;
-  };
-
-  typedef std::multimap<Key, Space*, Key::Compare> SpaceMapType;
+  void erase(Space& pSpace);
 
 private:
-  SpaceMapType m_SpaceMap;
+  SpaceList m_SpaceList;
+  size_t m_MaxSpaceSize;
+  Space* m_pWholeFile;
   FileHandle* m_pFileHandle;
+
+  /// m_ViewRegions - the regions pinning the spaces of views
+  RegionList m_ViewRegions;
+
+  bool m_bMapping;
+
+  /// m_PreloadMutex - guards the space list against concurrent preload()
+  sys::Mutex m_PreloadMutex;
 };
 
 } // namespace of mcld
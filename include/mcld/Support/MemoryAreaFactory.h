@@ -17,9 +17,13 @@
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/HandleToArea.h>
 
+#include <vector>
+
 namespace mcld
 {
 
+class ThreadPool;
+
 /** \class MemoryAreaFactory
  *  \brief MemoryAreaFactory avoids creating duplicated MemoryAreas of the
  *   same file.
@@ -54,6 +58,13 @@ public:
                       FileHandle::OpenMode pMode,
                       FileHandle::Permission pPerm);
 
+  // open - open the files of pPaths concurrently on pPool, and keep their
+  // MemoryAreas for the later produce() of the same paths. The files which
+  // can not be opened are left to produce() to report.
+  void open(ThreadPool& pPool,
+            const std::vector<sys::fs::Path>& pPaths,
+            FileHandle::OpenMode pMode);
+
   // Create a MemoryArea with an universal space.
   // The created MemoryArea is not moderated by m_HandleToArea.
   MemoryArea* produce(void* pMemBuffer, size_t pSize);
@@ -0,0 +1,89 @@
+//===- MemoryUsage.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_MEMORY_USAGE_H
+#define MCLD_SUPPORT_MEMORY_USAGE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <cstddef>
+
+namespace llvm {
+class raw_ostream;
+} // namespace of llvm
+
+namespace mcld {
+
+/** \class MemoryUsage
+ *  \brief MemoryUsage counts the live and peak bytes and objects of the
+ *  factories of a process.
+ *
+ *  Nothing is counted until Enable() is called, so the factories only pay a
+ *  test of a flag by default. The counters are shared by all threads and
+ *  guarded by a lock. Memory allocated before Enable() and released after
+ *  it is not counted, and the counters never drop below zero.
+ */
+class MemoryUsage
+{
+public:
+  enum Kind {
+    GCFactories,    ///< the chunks of GCFactory and LinearAllocator
+    NamePools,      ///< the ResolveInfos of NamePool
+    Relocations,    ///< the chunks of RelocationFactory
+    Regions,        ///< the chunks of RegionFactory
+    Fragments,      ///< the slabs of the Fragments
+    HeapSpaces,     ///< the input and output Spaces read into the heap
+    MappedSpaces,   ///< the input and output Spaces mapped from the files
+    NumOfKinds
+  };
+
+  struct Counter
+  {
+    size_t bytes;
+    size_t peakBytes;
+    size_t objects;
+    size_t peakObjects;
+  };
+
+public:
+  static void Enable(bool pEnable = true);
+
+  static bool isEnabled()
+  { return g_bEnabled; }
+
+  /// Allocate - count pBytes more live bytes of pKind
+  static void Allocate(Kind pKind, size_t pBytes);
+
+  /// Release - count pBytes less live bytes of pKind
+  static void Release(Kind pKind, size_t pBytes);
+
+  /// AddObjects - count pNum more live objects of pKind
+  static void AddObjects(Kind pKind, size_t pNum = 1);
+
+  /// RemoveObjects - count pNum less live objects of pKind
+  static void RemoveObjects(Kind pKind, size_t pNum = 1);
+
+  static Counter Get(Kind pKind);
+
+  static const char* GetName(Kind pKind);
+
+  /// PrintSummary - print the live and peak bytes of all kinds in one line
+  static void PrintSummary(llvm::raw_ostream& pOS, const char* pPhase);
+
+  /// Print - print the counters of every kind as a table
+  static void Print(llvm::raw_ostream& pOS);
+
+private:
+  static bool g_bEnabled;
+};
+
+} // namespace of mcld
+
+#endif
+
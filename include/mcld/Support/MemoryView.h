@@ -0,0 +1,63 @@
+//===- MemoryView.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_MEMORY_VIEW_H
+#define MCLD_SUPPORT_MEMORY_VIEW_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Support/Space.h>
+#include <cstddef>
+
+namespace mcld {
+
+/** \class MemoryView
+ *  \brief MemoryView is a read-only range of the memory of a MemoryArea.
+ *
+ *  Unlike MemoryRegion, MemoryView is a value of a pointer and a length. It
+ *  is neither allocated nor released, and it is valid until the MemoryArea
+ *  giving it is cleared. Readers use it to peek at the headers and the tables
+ *  of the input files.
+ *
+ *  @see MemoryArea::view()
+ */
+class MemoryView
+{
+public:
+  typedef Space::ConstAddress ConstAddress;
+
+public:
+  MemoryView()
+    : m_Start(NULL), m_Length(0) {
+  }
+
+  MemoryView(ConstAddress pStart, size_t pLength)
+    : m_Start(pStart), m_Length(pLength) {
+  }
+
+  ConstAddress start() const { return m_Start; }
+
+  ConstAddress end() const { return m_Start + m_Length; }
+
+  size_t size() const { return m_Length; }
+
+  bool empty() const { return (0 == m_Length); }
+
+  ConstAddress getBuffer(size_t pOffset = 0) const
+  { return m_Start + pOffset; }
+
+private:
+  ConstAddress m_Start;
+  size_t m_Length;
+};
+
+} // namespace of mcld
+
+#endif
+
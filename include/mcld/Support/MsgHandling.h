@@ -19,6 +19,8 @@ class LinkerConfig;
 class DiagnosticPrinter;
 class DiagnosticLineInfo;
 
+/// The functions below work on the diagnostic engine of the current
+/// LinkContext of the calling thread.
 void InitializeDiagnosticEngine(const LinkerConfig& pConfig,
                                 DiagnosticPrinter* pPrinter = NULL);
 
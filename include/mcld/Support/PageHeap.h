@@ -0,0 +1,63 @@
+//===- PageHeap.h ---------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_PAGE_HEAP_H
+#define MCLD_SUPPORT_PAGE_HEAP_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <cstddef>
+
+namespace mcld {
+
+/** \class PageHeap
+ *  \brief PageHeap provides the chunks of the LinearAllocators and the slabs
+ *  of the Arenas and the ResolveInfoFactories.
+ *
+ *  If mcld is configured with MCLD_HUGE_PAGES, the blocks are carved from
+ *  anonymous regions aligned to 2MiB, which are advised to be backed by
+ *  transparent huge pages. The symbols, fragments and relocations of a link
+ *  then lie on a few huge pages instead of many 4KiB ones, and the passes
+ *  over them miss the TLB less. A freed block is kept for the next block of
+ *  the same size, and the regions are kept until the process exits. A block
+ *  larger than a quarter of a region has a mapping of its own. Otherwise, the
+ *  blocks come from malloc().
+ *
+ *  PageHeap is thread-safe.
+ */
+class PageHeap
+{
+public:
+  /// HugePageSize - the alignment of the regions
+  static const size_t HugePageSize = 2 * 1024 * 1024;
+
+  /// RegionSize - the size of a region shared by the small blocks
+  static const size_t RegionSize = 16 * HugePageSize;
+
+public:
+  /// allocate - allocate pSize bytes, aligned to the cache lines in the
+  /// regions and as malloc() otherwise
+  /// @return NULL if the memory is exhausted
+  static void* allocate(size_t pSize);
+
+  /// deallocate - free pPtr of pSize bytes, which is allocated by allocate()
+  static void deallocate(void* pPtr, size_t pSize);
+
+  /// isHugePage - are the blocks carved from the huge-page regions?
+  static bool isHugePage();
+
+  /// numOfRegions - the number of the mapped regions, including the ones of
+  /// the large blocks which are not freed yet
+  static size_t numOfRegions();
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -30,6 +30,41 @@ namespace {
 
 typedef HashTable<HashEntryType, StringHash<BKDR>, EntryFactory<HashEntryType> > PathCache;
 
+class FileStatus;
+class FileID;
+
+/// cached - the file system queries memoized for the whole process.
+///
+/// Resolving -l namespecs, the members of thin archives and the inputs asks
+/// the file system about the same paths again and again. The queries in
+/// this namespace ask the system once for every path, keyed by the path as
+/// it is given, and answer the later ones from the memory. One stat() gives
+/// both the status and the FileID of a path.
+///
+/// The answers are not refreshed by themselves. A file written by the
+/// linker must be forgotten after it is created, and a process which runs
+/// several links or changes its working directory clears the cache.
+///
+/// The queries are thread-safe.
+namespace cached {
+
+/// status - the status of pPath
+void status(const Path& pPath, FileStatus& pFileStatus);
+
+/// file_id - the FileID of pPath, invalid if pPath can not be found
+void file_id(const Path& pPath, FileID& pFileID);
+
+/// canonical - the canonical absolute form of pPath, as RealPath gives it.
+void canonical(const Path& pPath, Path& pResult);
+
+/// forget - drop what is known about pPath
+void forget(const Path& pPath);
+
+/// clear - drop everything
+void clear();
+
+} // namespace of cached
+
 } // namespace of fs
 } // namespace of sys
 } // namespace of mcld
@@ -0,0 +1,96 @@
+//===- PerfCounters.h -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_PERF_COUNTERS_H
+#define MCLD_SUPPORT_PERF_COUNTERS_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/Thread.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+/** \class PerfCounters
+ *  \brief PerfCounters reads the hardware performance counters of the
+ *  calling thread.
+ *
+ *  On Linux, the counters of a thread are opened by perf_event_open() as one
+ *  group the first time the thread reads them, so the counters of a worker
+ *  thread only count the work of that thread. They count in the user space
+ *  only, and are closed when PerfCounters is destroyed. A counter that the
+ *  kernel or the processor does not provide is marked invalid; on the other
+ *  systems, all counters are invalid.
+ *
+ *  read() may be called by any thread.
+ */
+class PerfCounters : private Uncopyable
+{
+public:
+  enum Kind {
+    Cycles,
+    Instructions,
+    LLCMisses,
+    DTLBMisses,
+    BranchMisses,
+    NumOfKinds
+  };
+
+  /// Sample - the counts of a thread. A span of work is the difference of
+  /// the samples before and after it.
+  struct Sample
+  {
+    Sample();
+
+    uint64_t value[NumOfKinds];
+    bool valid[NumOfKinds];
+
+    /// sub - the counts since pBefore
+    Sample sub(const Sample& pBefore) const;
+
+    /// add - accumulate pOther
+    void add(const Sample& pOther);
+  };
+
+public:
+  PerfCounters();
+
+  ~PerfCounters();
+
+  /// read - read the counters of the calling thread into pSample.
+  /// @return false if no counter is available to the thread
+  bool read(Sample& pSample);
+
+  /// isAvailable - are any counters available to the creator of the object?
+  bool isAvailable() const { return m_bAvailable; }
+
+  /// name - the name of pKind for the reports
+  static const char* name(Kind pKind);
+
+private:
+  struct Group;
+
+  /// getGroup - the counters of the calling thread
+  Group* getGroup();
+
+private:
+  sys::ThreadLocal m_Group;
+  sys::Mutex m_Lock;  ///< guards m_Groups
+  std::vector<Group*> m_Groups;
+  bool m_bAvailable;
+};
+
+} // namespace of mcld
+
+#endif
+
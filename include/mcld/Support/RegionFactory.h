@@ -31,6 +31,8 @@ public:
   typedef MemoryRegion::ConstAddress ConstAddress;
 
 public:
+  RegionFactory();
+
   MemoryRegion* produce(Address pVMAStart, size_t pSize);
 
   void destruct(MemoryRegion* pRegion);
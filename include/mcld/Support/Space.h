@@ -13,10 +13,10 @@
 #endif
 #include <llvm/Support/DataTypes.h>
 #include <mcld/ADT/TypeTraits.h>
+#include <mcld/Support/FileHandle.h>
 
 namespace mcld {
 
-class FileHandle;
 class MemoryRegion;
 
 /** \class Space
@@ -64,6 +64,11 @@ public:
   Type type() const
   { return m_Type; }
 
+  /// file - the file the space is read or mapped from, or NULL if the space
+  /// is an external memory
+  const FileHandle* file() const
+  { return m_pFile; }
+
   void addRegion(MemoryRegion& pRegion)
   { ++m_RegionCount; }
 
@@ -79,16 +84,37 @@ public:
   /// Create - Create a Space from FileHandler
   static Space* Create(FileHandle& pHandler, size_t pOffset, size_t pSize);
 
+  /// Create - Create a Space of pType from FileHandler, regardless of the
+  /// size of the space. pType is ALLOCATED_ARRAY or MMAPED.
+  static Space* Create(FileHandle& pHandler, size_t pOffset, size_t pSize,
+                       Type pType);
+
+  /// Create - Map the whole file of a FileHandler. A read-only file is mapped
+  /// privately, and a writable file is shared with the file.
+  /// @return NULL if the file can not be mapped, e.g., the file is a pipe, is
+  /// empty or is too big to be mapped.
+  static Space* Create(FileHandle& pHandler);
+
   static void Destroy(Space*& pSpace);
   
   static void Release(Space* pSpace, FileHandle& pHandler);
 
   static void Sync(Space* pSpace, FileHandle& pHandler);
 
+  /// Advise - tell the system how the space of pHandler will be accessed.
+  static void Advise(Space* pSpace, FileHandle& pHandler,
+                     FileHandle::Advice pAdvice);
+
+  /// Drop - let the system reclaim the pages entirely within
+  /// [pStart, pStart + pSize) of a read-only mapped space. They are read from
+  /// the file again if they are touched later. The other spaces are kept.
+  static void Drop(const Space* pSpace, ConstAddress pStart, size_t pSize);
+
 private:
   Address m_Data;
-  uint32_t m_StartOffset;
-  uint32_t m_Size;
+  size_t m_StartOffset;
+  size_t m_Size;
+  const FileHandle* m_pFile;
   uint16_t m_RegionCount;
   Type m_Type : 2;
 };
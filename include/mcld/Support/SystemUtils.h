@@ -26,6 +26,30 @@ typedef off_t Offset;
  */
 char *strerror(int pErrnum);
 
+/** \fn getpid
+ *  \brief the process ID of the calling process
+ */
+int getpid();
+
+/** \fn GetTimeInMicroseconds
+ *  \brief the time of a monotonic clock in microseconds. Only the
+ *  difference of two times is meaningful.
+ */
+uint64_t GetTimeInMicroseconds();
+
+/** \fn Exit
+ *  \brief terminate the process with pStatus at once. Neither the
+ *  destructors nor the atexit handlers are run, and the streams are not
+ *  flushed.
+ */
+void Exit(int pStatus);
+
+/** \fn GetRandomBytes
+ *  \brief fill pBuffer with pSize random bytes of the system.
+ *  @return false if the system gives no random bytes
+ */
+bool GetRandomBytes(void* pBuffer, size_t pSize);
+
 } // namespace of sys
 } // namespace of mcld
 
@@ -58,6 +58,8 @@ public:
   typedef DiagnosticLineInfo *(*DiagnosticLineInfoCtorTy)(const mcld::Target&,
                                                           const std::string&);
 
+  typedef void (*InitializeFnTy)();
+
 public:
   Target();
 
@@ -128,6 +130,9 @@ private:
   TargetLDBackendCtorTy TargetLDBackendCtorFn;
   DiagnosticLineInfoCtorTy DiagnosticLineInfoCtorFn;
 
+  /// registers the function pointers above on the first lookup of the target
+  InitializeFnTy InitializeFn;
+
   // -----  adapted llvm::Target  ----- //
   const llvm::Target* m_pT;
 };
@@ -220,7 +225,21 @@ public:
       T.DiagnosticLineInfoCtorFn = Fn;
   }
 
-  /// lookupTarget - Lookup a target based on a llvm::Target.
+  /// RegisterInitialization - Register the function which registers the
+  /// rest of the target. It is called by the first lookupTarget() of the
+  /// target, so that a program only initializes the target it links for.
+  ///
+  /// @param T - The target being registered
+  /// @param Fn - A function to register the rest of the target
+  static void RegisterInitialization(mcld::Target &T,
+                                     mcld::Target::InitializeFnTy Fn)
+  {
+    if (!T.InitializeFn)
+      T.InitializeFn = Fn;
+  }
+
+  /// lookupTarget - Lookup a target based on a llvm::Target. The target is
+  /// initialized on its first lookup.
   ///
   /// @param T - The llvm::Target to find
   static const mcld::Target *lookupTarget(const llvm::Target& T);
@@ -0,0 +1,82 @@
+//===- TaskQueue.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_TASK_QUEUE_H
+#define MCLD_SUPPORT_TASK_QUEUE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/Thread.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <deque>
+#include <cstddef>
+
+namespace mcld {
+
+/** \class TaskQueue
+ *  \brief TaskQueue runs tasks one by one in the posted order on a background
+ *  thread, so that a stage of a pipeline overlaps with the caller's work.
+ *
+ *  post() returns at once, and wait() blocks until the first N posted tasks
+ *  are finished. A serial TaskQueue, or one which can not create its thread,
+ *  runs every task in post(). The thread runs the tasks in the current
+ *  LinkContext of the creator of the queue.
+ */
+class TaskQueue : private Uncopyable
+{
+public:
+  typedef ThreadPool::Task Task;
+
+public:
+  explicit TaskQueue(bool pAsync = true);
+
+  /// destructor - finish all posted tasks and join the thread.
+  ~TaskQueue();
+
+  bool isAsync() const { return m_Thread.isRunning(); }
+
+  /// post - append pTask to the queue. The caller keeps the ownership of
+  /// pTask until it is finished.
+  void post(Task& pTask);
+
+  /// wait - wait until the first pNum posted tasks are finished.
+  void wait(size_t pNum);
+
+  /// wait - wait until all posted tasks are finished.
+  void wait();
+
+  size_t numOfPosted() const { return m_NumOfPosted; }
+
+private:
+  static void* Entry(void* pQueue);
+
+  void loop();
+
+private:
+  /// m_NumOfPosted - only the caller of post() touches it
+  size_t m_NumOfPosted;
+
+  // m_Lock guards the following members
+  sys::Mutex m_Lock;
+  std::deque<Task*> m_Tasks;
+  sys::Condition m_Posted;
+  sys::Condition m_Finished;
+  size_t m_NumOfFinished;
+  bool m_bStop;
+
+  /// m_pContext - the context of the creator of the queue
+  LinkContext* m_pContext;
+  sys::Thread m_Thread;
+};
+
+} // namespace of mcld
+
+#endif
+
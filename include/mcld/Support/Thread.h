@@ -0,0 +1,153 @@
+//===- Thread.h -----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_THREAD_H
+#define MCLD_SUPPORT_THREAD_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <cstddef>
+
+namespace mcld {
+namespace sys {
+
+class Condition;
+
+/** \class Mutex
+ *  \brief Mutex is a non-recursive mutual exclusion lock.
+ */
+class Mutex : private Uncopyable
+{
+  friend class Condition;
+public:
+  Mutex();
+
+  ~Mutex();
+
+  void lock();
+
+  void unlock();
+
+private:
+  void* m_pData;
+};
+
+/** \class ScopedLock
+ *  \brief ScopedLock locks the given Mutex in its lifetime.
+ */
+class ScopedLock : private Uncopyable
+{
+public:
+  explicit ScopedLock(Mutex& pMutex)
+    : m_Mutex(pMutex) { m_Mutex.lock(); }
+
+  ~ScopedLock() { m_Mutex.unlock(); }
+
+private:
+  Mutex& m_Mutex;
+};
+
+/** \class Condition
+ *  \brief Condition is a condition variable used with a Mutex.
+ */
+class Condition : private Uncopyable
+{
+public:
+  Condition();
+
+  ~Condition();
+
+  /// wait - atomically release pMutex and wait for a signal. pMutex must be
+  /// locked by the caller, and it is locked again when wait() returns.
+  void wait(Mutex& pMutex);
+
+  /// signal - wake up one waiting thread.
+  void signal();
+
+  /// broadcast - wake up all waiting threads.
+  void broadcast();
+
+private:
+  void* m_pData;
+};
+
+/** \class ThreadLocal
+ *  \brief ThreadLocal holds a pointer for each thread. The pointer of a
+ *  thread is NULL until the thread sets it.
+ */
+class ThreadLocal : private Uncopyable
+{
+public:
+  ThreadLocal();
+
+  /// destructor - the pointed objects are not deleted.
+  ~ThreadLocal();
+
+  void* get() const;
+
+  void set(void* pValue);
+
+private:
+  void* m_pData;
+};
+
+/** \class Thread
+ *  \brief Thread is a joinable thread of execution.
+ */
+class Thread : private Uncopyable
+{
+public:
+  typedef void* (*EntryType)(void*);
+
+public:
+  Thread();
+
+  /// destructor - a running thread must be joined before it is destroyed.
+  ~Thread();
+
+  /// start - run pEntry(pArg) in a new thread.
+  /// @return false if the system can not create the thread.
+  bool start(EntryType pEntry, void* pArg);
+
+  /// join - wait for the thread to terminate.
+  void join();
+
+  bool isRunning() const { return (NULL != m_pData); }
+
+private:
+  void* m_pData;
+};
+
+/// GetNumOfProcessors - return the number of online processors. Return 1 if
+/// the number can not be known.
+unsigned int GetNumOfProcessors();
+
+/// GetCurrentThreadID - return an ID of the calling thread, which is unique
+/// among the running threads.
+unsigned long GetCurrentThreadID();
+
+/// GetNumOfNodes - return the number of NUMA nodes. Return 1 if the nodes
+/// can not be known.
+unsigned int GetNumOfNodes();
+
+/// GetNodeOfProcessor - return the NUMA node of processor pCPU, numbered
+/// from 0 to GetNumOfNodes() - 1. Return 0 if the node can not be known.
+unsigned int GetNodeOfProcessor(unsigned int pCPU);
+
+/// BindCurrentThread - run the calling thread on processor pCPU only. The
+/// memory the thread touches first is then allocated on the node of pCPU.
+/// @return false if the system can not bind the thread.
+bool BindCurrentThread(unsigned int pCPU);
+
+} // namespace of sys
+} // namespace of mcld
+
+#endif
+
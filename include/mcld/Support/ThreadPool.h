@@ -0,0 +1,466 @@
+//===- ThreadPool.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_THREAD_POOL_H
+#define MCLD_SUPPORT_THREAD_POOL_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/Thread.h>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <vector>
+#include <cstddef>
+
+namespace mcld {
+
+class LinkContext;
+
+/** \class ThreadPool
+ *  \brief ThreadPool is a work-stealing pool of threads.
+ *
+ *  A ThreadPool of N threads owns N-1 worker threads, and the thread calling
+ *  run() is the N-th one, of ID 0. run() cuts a batch of tasks into N
+ *  consecutive blocks, one for the queue of each thread, or queues every
+ *  task to its home thread if the homes are given. Every thread takes tasks
+ *  from the front of its own queue, and steals tasks from the back of the
+ *  others when its own queue is empty. run() returns after all tasks are
+ *  finished.
+ *
+ *  With the thread affinity, every worker is bound to a processor, and the
+ *  workers of adjacent IDs are on the same NUMA node. A worker steals from
+ *  the threads of its own node first. The memory a worker touches first is
+ *  then local to its node, so a phase which queues the work on an input to
+ *  the thread which read the input works on node-local memory. The caller
+ *  of run() is not bound, since the threads it creates later would inherit
+ *  the binding.
+ *
+ *  The scheduler never changes the tasks, so any result that depends only on
+ *  what the tasks write, not on when they write it, is the same to a serial
+ *  run. parallel_for() and parallel_sort() are built on this guarantee.
+ *
+ *  A ThreadPool of one thread, or a nested run() called by a running task,
+ *  executes the tasks in order in the caller's thread.
+ *
+ *  The workers run the tasks in the current LinkContext of the caller of
+ *  run(), so the tasks report their messages to the link that runs them.
+ */
+class ThreadPool : private Uncopyable
+{
+public:
+  /** \class Task
+   *  \brief Task is a unit of work of ThreadPool.
+   */
+  class Task
+  {
+  public:
+    virtual ~Task() { }
+
+    virtual void run() = 0;
+  };
+
+  typedef std::vector<Task*> TaskList;
+
+  /// HomeList - the home thread of every task
+  typedef std::vector<unsigned int> HomeList;
+
+  /// NoHome - a task of no home is queued as run() without homes does
+  enum { NoHome = ~0u };
+
+public:
+  /// ThreadPool - create a pool of pNumThreads threads, including the caller
+  /// of run(). If pNumThreads is zero, use the number of processors. If
+  /// pAffinity is true, bind the workers to the processors.
+  explicit ThreadPool(unsigned int pNumThreads, bool pAffinity = false);
+
+  ~ThreadPool();
+
+  /// size - the number of threads, including the caller of run().
+  unsigned int size() const { return m_Size; }
+
+  bool isSerial() const { return (1 == m_Size); }
+
+  /// hasAffinity - are the workers bound to the processors?
+  bool hasAffinity() const { return m_bAffinity; }
+
+  /// run - execute all tasks in pTasks and wait for them.
+  void run(const TaskList& pTasks);
+
+  /// run - execute all tasks in pTasks and wait for them. pTasks[i] is
+  /// queued to the thread pHomes[i].
+  void run(const TaskList& pTasks, const HomeList& pHomes);
+
+  /// currentThread - the ID of the calling thread in the pool. The threads
+  /// out of the pool are 0, as the caller of run().
+  unsigned int currentThread() const;
+
+  /// GetCurrentNode - the NUMA node of the calling worker of any pool, or 0
+  /// if the calling thread is not a bound worker
+  static unsigned int GetCurrentNode();
+
+private:
+  struct Worker;
+
+  static void* WorkerEntry(void* pWorker);
+
+  /// execute - run() with the homes pHomes, or without homes if NULL
+  void execute(const TaskList& pTasks, const HomeList* pHomes);
+
+  /// setupVictims - order the queues to steal from of every thread, the
+  /// threads of the same node first
+  void setupVictims();
+
+  /// getTask - take a task from the queue of worker pID, or steal one.
+  Task* getTask(unsigned int pID);
+
+  /// drain - execute tasks until all queues are empty.
+  void drain(unsigned int pID);
+
+  void loop(unsigned int pID);
+
+private:
+  typedef std::deque<Task*> TaskQueue;
+
+  struct Queue
+  {
+    sys::Mutex mutex;
+    TaskQueue tasks;
+  };
+
+private:
+  unsigned int m_Size;
+  bool m_bAffinity;
+  std::vector<Queue*> m_Queues;
+  std::vector<Worker*> m_Workers;
+
+  /// m_Nodes - the node of every thread
+  std::vector<unsigned int> m_Nodes;
+
+  /// m_Victims - the other threads of every thread, in the stealing order
+  std::vector<std::vector<unsigned int> > m_Victims;
+
+  // m_Lock guards the following members
+  sys::Mutex m_Lock;
+  sys::Condition m_WakeUp;
+  sys::Condition m_Done;
+  size_t m_Generation;
+  LinkContext* m_pContext;  ///< the context of the caller of run()
+  size_t m_NumOfPending;
+  bool m_bRunning;
+  bool m_bStop;
+};
+
+//===----------------------------------------------------------------------===//
+// parallel_for
+//===----------------------------------------------------------------------===//
+template<typename Body>
+class ParallelForTask : public ThreadPool::Task
+{
+public:
+  ParallelForTask(Body& pBody, size_t pBegin, size_t pEnd)
+    : m_pBody(&pBody), m_Begin(pBegin), m_End(pEnd) { }
+
+  void run() {
+    for (size_t i = m_Begin; i < m_End; ++i)
+      (*m_pBody)(i);
+  }
+
+private:
+  Body* m_pBody;
+  size_t m_Begin;
+  size_t m_End;
+};
+
+/// parallel_for - call pBody(i) for every i in [pBegin, pEnd).
+/// The range is cut into chunks of at least pGrain indices. pBody must be
+/// safe to be called concurrently for different indices.
+template<typename Body>
+void parallel_for(ThreadPool& pPool, size_t pBegin, size_t pEnd,
+                  Body& pBody, size_t pGrain = 1)
+{
+  if (pEnd <= pBegin)
+    return;
+
+  size_t total = pEnd - pBegin;
+  if (0 == pGrain)
+    pGrain = 1;
+
+  if (pPool.isSerial() || total <= pGrain) {
+    for (size_t i = pBegin; i < pEnd; ++i)
+      pBody(i);
+    return;
+  }
+
+  // give every thread a few chunks that can be stolen for load balance.
+  size_t chunk = total / (pPool.size() * 4);
+  if (chunk < pGrain)
+    chunk = pGrain;
+
+  std::vector<ParallelForTask<Body> > tasks;
+  tasks.reserve(total / chunk + 1);
+  for (size_t begin = pBegin; begin < pEnd; begin += chunk)
+    tasks.push_back(ParallelForTask<Body>(pBody, begin,
+                                          std::min(begin + chunk, pEnd)));
+
+  ThreadPool::TaskList list(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i)
+    list[i] = &tasks[i];
+  pPool.run(list);
+}
+
+/// parallel_for - call pBody(i) for every i in [pBegin, pEnd), and queue i
+/// to the thread pHomes[i - pBegin] if the pool has the thread affinity. A
+/// chunk never spans two homes. Without the affinity, the homes are ignored.
+template<typename Body>
+void parallel_for(ThreadPool& pPool, size_t pBegin, size_t pEnd,
+                  Body& pBody, const ThreadPool::HomeList& pHomes,
+                  size_t pGrain = 1)
+{
+  if (!pPool.hasAffinity() || pHomes.size() < pEnd - pBegin) {
+    parallel_for(pPool, pBegin, pEnd, pBody, pGrain);
+    return;
+  }
+  if (pEnd <= pBegin)
+    return;
+
+  size_t total = pEnd - pBegin;
+  if (0 == pGrain)
+    pGrain = 1;
+
+  if (pPool.isSerial() || total <= pGrain) {
+    for (size_t i = pBegin; i < pEnd; ++i)
+      pBody(i);
+    return;
+  }
+
+  size_t chunk = total / (pPool.size() * 4);
+  if (chunk < pGrain)
+    chunk = pGrain;
+
+  std::vector<ParallelForTask<Body> > tasks;
+  ThreadPool::HomeList homes;
+  for (size_t begin = pBegin; begin < pEnd; ) {
+    unsigned int home = pHomes[begin - pBegin];
+    size_t end = begin + 1;
+    while (end < pEnd && end - begin < chunk && home == pHomes[end - pBegin])
+      ++end;
+    tasks.push_back(ParallelForTask<Body>(pBody, begin, end));
+    homes.push_back(home);
+    begin = end;
+  }
+
+  ThreadPool::TaskList list(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i)
+    list[i] = &tasks[i];
+  pPool.run(list, homes);
+}
+
+//===----------------------------------------------------------------------===//
+// parallel_sort
+//===----------------------------------------------------------------------===//
+template<typename RandomIt, typename Compare>
+class SortTask : public ThreadPool::Task
+{
+public:
+  SortTask(RandomIt pBegin, RandomIt pMiddle, RandomIt pEnd, Compare pComp)
+    : m_Begin(pBegin), m_Middle(pMiddle), m_End(pEnd), m_Comp(pComp) { }
+
+  void run() {
+    // sort [begin, end) if middle is end, otherwise merge the two halves.
+    if (m_Middle == m_End)
+      std::stable_sort(m_Begin, m_End, m_Comp);
+    else
+      std::inplace_merge(m_Begin, m_Middle, m_End, m_Comp);
+  }
+
+private:
+  RandomIt m_Begin;
+  RandomIt m_Middle;
+  RandomIt m_End;
+  Compare m_Comp;
+};
+
+/// parallel_sort - sort [pBegin, pEnd) in parallel.
+/// The result is always the same as std::stable_sort(pBegin, pEnd, pComp),
+/// no matter how many threads are used.
+template<typename RandomIt, typename Compare>
+void parallel_sort(ThreadPool& pPool, RandomIt pBegin, RandomIt pEnd,
+                   Compare pComp)
+{
+  typedef SortTask<RandomIt, Compare> Sort;
+
+  // small ranges are not worth the synchronization.
+  const size_t threshold = 4096;
+  size_t total = pEnd - pBegin;
+  if (pPool.isSerial() || total <= threshold) {
+    std::stable_sort(pBegin, pEnd, pComp);
+    return;
+  }
+
+  // cut the range into sorted runs
+  size_t num_runs = std::min<size_t>(pPool.size(), total / (threshold / 2));
+  std::vector<RandomIt> bounds(num_runs + 1);
+  for (size_t i = 0; i <= num_runs; ++i)
+    bounds[i] = pBegin + (total * i) / num_runs;
+
+  std::vector<Sort> tasks;
+  ThreadPool::TaskList list;
+  tasks.reserve(num_runs);
+  for (size_t i = 0; i < num_runs; ++i)
+    tasks.push_back(Sort(bounds[i], bounds[i + 1], bounds[i + 1], pComp));
+
+  // merge the adjacent runs, pair by pair, until only one run remains.
+  while (!tasks.empty()) {
+    list.resize(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i)
+      list[i] = &tasks[i];
+    pPool.run(list);
+
+    if (1 == bounds.size() - 1)
+      break;
+
+    std::vector<RandomIt> merged;
+    tasks.clear();
+    size_t i = 0;
+    for (; i + 2 < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+      tasks.push_back(Sort(bounds[i], bounds[i + 1], bounds[i + 2], pComp));
+    }
+    // the odd run is left for the next round
+    if (i + 1 < bounds.size())
+      merged.push_back(bounds[i]);
+    merged.push_back(bounds.back());
+    bounds.swap(merged);
+  }
+}
+
+template<typename RandomIt>
+void parallel_sort(ThreadPool& pPool, RandomIt pBegin, RandomIt pEnd)
+{
+  typedef typename std::iterator_traits<RandomIt>::value_type ValueType;
+  parallel_sort(pPool, pBegin, pEnd, std::less<ValueType>());
+}
+
+//===----------------------------------------------------------------------===//
+// parallel_radix_sort
+//===----------------------------------------------------------------------===//
+template<typename T, typename KeyOf>
+class RadixTask : public ThreadPool::Task
+{
+public:
+  enum { NumOfBuckets = 256 };
+
+  RadixTask(size_t pBegin, size_t pEnd, KeyOf pKey)
+    : from(NULL), to(NULL), shift(0), counting(true),
+      m_Begin(pBegin), m_End(pEnd), m_Key(pKey) { }
+
+  void run() {
+    // count the digits of [begin, end), or move the elements to the
+    // positions in the counters.
+    if (counting) {
+      std::fill(count, count + NumOfBuckets, 0);
+      for (size_t i = m_Begin; i < m_End; ++i)
+        ++count[digit(from[i])];
+      return;
+    }
+    for (size_t i = m_Begin; i < m_End; ++i)
+      to[count[digit(from[i])]++] = from[i];
+  }
+
+  const T* from;
+  T* to;
+  unsigned int shift;
+  bool counting;
+  size_t count[NumOfBuckets];
+
+private:
+  size_t digit(const T& pValue) const
+  { return (m_Key(pValue) >> shift) & (NumOfBuckets - 1); }
+
+private:
+  size_t m_Begin;
+  size_t m_End;
+  KeyOf m_Key;
+};
+
+/// parallel_radix_sort - sort pData by the 32-bit keys pKey(element) in
+/// parallel, with a LSD radix sort of four passes of 8 bits. A pass is
+/// skipped if all keys have the same digit.
+/// The result is always the same as std::stable_sort by the keys, no matter
+/// how many threads are used.
+template<typename T, typename KeyOf>
+void parallel_radix_sort(ThreadPool& pPool, std::vector<T>& pData, KeyOf pKey)
+{
+  typedef RadixTask<T, KeyOf> Radix;
+
+  size_t total = pData.size();
+  if (total < 2)
+    return;
+
+  // every thread counts and moves a chunk of its own
+  const size_t threshold = 4096;
+  size_t num_chunks = 1;
+  if (!pPool.isSerial() && total > threshold)
+    num_chunks = std::min<size_t>(pPool.size(), total / (threshold / 2));
+
+  std::vector<Radix> tasks;
+  tasks.reserve(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i)
+    tasks.push_back(Radix((total * i) / num_chunks,
+                          (total * (i + 1)) / num_chunks, pKey));
+  ThreadPool::TaskList list(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i)
+    list[i] = &tasks[i];
+
+  std::vector<T> buffer(total);
+  T* from = &pData[0];
+  T* to = &buffer[0];
+  for (unsigned int shift = 0; shift < 32; shift += 8) {
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      tasks[i].from = from;
+      tasks[i].to = to;
+      tasks[i].shift = shift;
+      tasks[i].counting = true;
+    }
+    pPool.run(list);
+
+    // the elements of bucket b go after those of the smaller buckets, and
+    // those of a chunk go after those of the previous chunks.
+    size_t pos = 0;
+    bool skip = false;
+    for (size_t b = 0; b < Radix::NumOfBuckets && !skip; ++b) {
+      size_t start = pos;
+      for (size_t i = 0; i < tasks.size(); ++i) {
+        size_t num = tasks[i].count[b];
+        tasks[i].count[b] = pos;
+        pos += num;
+      }
+      skip = (0 == start && total == pos);
+    }
+    if (skip)
+      continue;
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+      tasks[i].counting = false;
+    pPool.run(list);
+    std::swap(from, to);
+  }
+
+  if (from != &pData[0])
+    pData.swap(buffer);
+}
+
+} // namespace of mcld
+
+#endif
+
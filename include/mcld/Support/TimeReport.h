@@ -0,0 +1,124 @@
+//===- TimeReport.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_TIME_REPORT_H
+#define MCLD_SUPPORT_TIME_REPORT_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/PerfCounters.h>
+#include <mcld/Support/Thread.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+} // namespace of llvm
+
+namespace mcld {
+
+/** \class TimeReport
+ *  \brief TimeReport records the spans of time spent in the phases of a
+ *  link, and in the per-input and per-batch work of the thread pool.
+ *
+ *  A span without detail is a phase. print() shows the phases of the thread
+ *  which created the report as a nested table; a phase is nested in the
+ *  phases that enclose it in time. The spans with detail, such as the path
+ *  of an input, are summed up by name. writeTrace() writes all spans in the
+ *  Chrome trace event format, one track per thread.
+ *
+ *  With --perf-counters, every span also records the hardware counters of
+ *  its thread, and print() shows the IPC and the misses per thousand
+ *  instructions of the phases and of the work of the worker threads.
+ *
+ *  add() may be called by any thread.
+ */
+class TimeReport : private Uncopyable
+{
+public:
+  struct Span
+  {
+    const char* name;
+    std::string detail;
+    unsigned int thread;
+    uint64_t begin;
+    uint64_t end;
+    PerfCounters::Sample counters;
+  };
+
+  typedef std::vector<Span> SpanList;
+
+public:
+  /// TimeReport - if pPerfCounters, the spans record the hardware counters
+  explicit TimeReport(bool pPerfCounters = false);
+
+  ~TimeReport();
+
+  /// add - record the span [pBegin, pEnd) of the calling thread. The times
+  /// come from sys::GetTimeInMicroseconds(). pName must outlive the report.
+  /// pCounters, if any, are the counts of the calling thread in the span.
+  void add(const char* pName,
+           const std::string& pDetail,
+           uint64_t pBegin,
+           uint64_t pEnd,
+           const PerfCounters::Sample* pCounters = NULL);
+
+  const SpanList& spans() const { return m_Spans; }
+
+  /// counters - the hardware counters, or NULL without --perf-counters
+  PerfCounters* counters() const { return m_pCounters; }
+
+  /// print - print the nested table of the phases
+  void print(llvm::raw_ostream& pOS) const;
+
+  /// writeTrace - write the spans as Chrome trace event JSON
+  void writeTrace(llvm::raw_ostream& pOS) const;
+
+private:
+  /// getThread - the index of the calling thread. The creator of the report
+  /// is thread 0. m_Lock must be held.
+  unsigned int getThread();
+
+private:
+  sys::Mutex m_Lock;
+  SpanList m_Spans;
+  std::vector<unsigned long> m_Threads;
+  uint64_t m_Start;
+  PerfCounters* m_pCounters;
+};
+
+/** \class TimeScope
+ *  \brief TimeScope adds the span of its lifetime to a TimeReport. It does
+ *  nothing if the report is NULL.
+ */
+class TimeScope : private Uncopyable
+{
+public:
+  TimeScope(TimeReport* pReport, const char* pName);
+
+  TimeScope(TimeReport* pReport, const char* pName, const std::string& pDetail);
+
+  ~TimeScope();
+
+private:
+  TimeReport* m_pReport;
+  const char* m_pName;
+  std::string m_Detail;
+  uint64_t m_Begin;
+  PerfCounters::Sample m_Counters;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -60,12 +60,22 @@ private:
 
 /// outs() - This returns a reference to a raw_ostream for standard output.
 /// Use it like: outs() << "foo" << "bar";
+/// It is the standard output of the current LinkContext.
 mcld::raw_fd_ostream &outs();
 
 /// errs() - This returns a reference to a raw_ostream for standard error.
 /// Use it like: errs() << "foo" << "bar";
+/// It is the standard error of the current LinkContext.
 mcld::raw_fd_ostream &errs();
 
+/// process_outs() - the stream of the standard output of the process, which
+/// a LinkContext writes to unless it is redirected.
+mcld::raw_fd_ostream &process_outs();
+
+/// process_errs() - the stream of the standard error of the process, which
+/// a LinkContext writes to unless it is redirected.
+mcld::raw_fd_ostream &process_errs();
+
 } // namespace of mcld
 
 #endif
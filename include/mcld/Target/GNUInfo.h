@@ -65,6 +65,11 @@ public:
   /// here. If target favors the different size, please override this function
   virtual uint64_t abiPageSize() const { return 0x1000; }
 
+  /// relativeRelocType - the type of the relative dynamic relocations, such
+  /// as R_386_RELATIVE. -z combreloc puts them first in .rel.dyn. Return 0x0
+  /// if the target keeps its dynamic relocations in the order they are made.
+  virtual uint32_t relativeRelocType() const { return 0x0; }
+
 private:
   const llvm::Triple& m_Triple;
 };
@@ -13,6 +13,7 @@
 #endif
 #include <mcld/Target/TargetLDBackend.h>
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/Support/ELF.h>
 #include <mcld/ADT/HashTable.h>
 #include <mcld/ADT/HashEntry.h>
@@ -26,8 +27,10 @@
 #include <mcld/LD/ELFObjectWriter.h>
 #include <mcld/LD/ELFSegment.h>
 #include <mcld/LD/ELFSegmentFactory.h>
+#include <mcld/LD/StringTable.h>
 #include <mcld/Target/ELFDynamic.h>
 #include <mcld/Target/GNUInfo.h>
+#include <mcld/Target/OutputRelrSection.h>
 
 #include <mcld/Support/GCFactory.h>
 #include <mcld/Module.h>
@@ -39,6 +42,9 @@ class LinkerConfig;
 class IRBuilder;
 class Layout;
 class EhFrameHdr;
+class GdbIndex;
+class SeparateDebugFile;
+class RelocationStreamer;
 class BranchIslandFactory;
 class StubFactory;
 class GNUInfo;
@@ -55,6 +61,10 @@ protected:
 public:
   virtual ~GNULDBackend();
 
+  /// reset - clear the state of the last link. The file formats are kept,
+  /// and their standard sections are created again by initStdSections().
+  void reset();
+
   // -----  readers/writers  ----- //
   GNUArchiveReader* createArchiveReader(Module& pModule);
   ELFObjectReader* createObjectReader(IRBuilder& pBuilder);
@@ -70,6 +80,15 @@ public:
   const ELFFileFormat* getOutputFormat() const;
   ELFFileFormat*       getOutputFormat();
 
+  /// getStrTabNames - the strings of .strtab, .dynstr and .shstrtab. They are
+  /// finalized by sizeNamePools().
+  const StringTable& getStrTabNames() const    { return m_StrTabNames; }
+  StringTable&       getStrTabNames()          { return m_StrTabNames; }
+  const StringTable& getDynStrTabNames() const { return m_DynStrTabNames; }
+  StringTable&       getDynStrTabNames()       { return m_DynStrTabNames; }
+  const StringTable& getShStrTabNames() const  { return m_ShStrTabNames; }
+  StringTable&       getShStrTabNames()        { return m_ShStrTabNames; }
+
   // -----  target symbols ----- //
   /// initStandardSymbols - initialize standard symbols.
   /// Some section symbols is undefined in input object, and linkers must set
@@ -103,13 +122,75 @@ public:
   const GNUInfo& getInfo() const { return *m_pInfo; }
   GNUInfo&       getInfo()       { return *m_pInfo; }
 
+  /// getEntry - the default entry symbol of the target
+  const char* getEntry() const { return m_pInfo->entry(); }
+
   bool hasTextRel() const { return m_bHasTextRel; }
 
   bool hasStaticTLS() const { return m_bHasStaticTLS; }
 
+  /// isCombReloc - whether the dynamic relocations are combined by
+  /// -z combreloc. The relative relocations come first, and the others are
+  /// sorted by symbol and offset.
+  bool isCombReloc() const;
+
+  /// numOfRelativeRelocs - the value of DT_RELCOUNT or DT_RELACOUNT
+  size_t numOfRelativeRelocs() const { return m_NumOfRelativeRelocs; }
+
+  /// hasRelrDyn - whether some relative relocations are packed into
+  /// .relr.dyn by --pack-dyn-relocs
+  bool hasRelrDyn() const
+  { return (NULL != m_pRelrDyn) && !m_pRelrDyn->empty(); }
+
+  const OutputRelrSection& getRelrDyn() const
+  {
+    assert(NULL != m_pRelrDyn && ".relr.dyn section not exist");
+    return *m_pRelrDyn;
+  }
+
+  /// reserveRelrEntry - pack the relative relocation of pReloc into
+  /// .relr.dyn if --pack-dyn-relocs is given. Only the word-sized absolute
+  /// relocations against local symbols should be packed.
+  /// @return false if pReloc should reserve an entry in the dynamic
+  /// relocation section
+  bool reserveRelrEntry(const Relocation& pReloc);
+
+  /// isRelrEntry - whether the relative relocation of pReloc is packed
+  bool isRelrEntry(const Relocation& pReloc) const
+  { return (NULL != m_pRelrDyn) && m_pRelrDyn->hasEntry(pReloc); }
+
+  /// emitRelrDyn - emit .relr.dyn
+  void emitRelrDyn(MemoryRegion& pRegion) const;
+
+  /// getRelocStreamer - the relocation sections of a streamed partial link.
+  /// It is created at the first call.
+  RelocationStreamer& getRelocStreamer();
+
+  /// resetSectionOffset - reassign the file offsets of the output sections
+  /// from pSectBegin, after the writer changes their sizes, e.g., by
+  /// compressing them.
+  void resetSectionOffset(Module& pModule, Module::iterator pSectBegin)
+  { setOutputSectionOffset(pModule, pSectBegin, pModule.end()); }
+
   /// segmentStartAddr - this function returns the start address of the segment
   uint64_t segmentStartAddr() const;
 
+  /// isPrelinked - whether the output is laid out at its base address in
+  /// the map of --prelink-map
+  bool isPrelinked() const { return m_bPrelinked; }
+
+  /// isSeparateDebugSection - whether pSection goes to the file of
+  /// --separate-debug-file. These sections are laid out after the others.
+  bool isSeparateDebugSection(const LDSection& pSection) const;
+
+  /// numOfMainSections - the number of the sections in the section header
+  /// table of the output, or 0 if no section goes to the separate debug file
+  size_t numOfMainSections() const { return m_NumOfMainSections; }
+
+  /// mainFileSize - the size of the output without the sections of the
+  /// separate debug file, which follow its section header table
+  uint64_t mainFileSize() const { return m_MainFileSize; }
+
   /// partialScanRelocation - When doing partial linking, fix the relocation
   /// offset after section merge
   void partialScanRelocation(Relocation& pReloc,
@@ -125,6 +206,13 @@ public:
   virtual uint64_t emitSectionData(const LDSection& pSection,
                                    MemoryRegion& pRegion) const = 0;
 
+  /// emitNops - fill the pSize bytes of pBuffer, which is at the offset
+  /// pOffset of an executable section, with no-op instructions. By default,
+  /// the bytes are zero, which is the nop of Mips.
+  virtual void emitNops(uint8_t* pBuffer,
+                        uint64_t pOffset,
+                        uint64_t pSize) const;
+
   /// emitRegNamePools - emit regular name pools - .symtab, .strtab
   virtual void emitRegNamePools(const Module& pModule, MemoryArea& pOutput);
 
@@ -139,6 +227,9 @@ public:
   virtual void emitGNUHashTab(Module::SymbolTable& pSymtab,
                               MemoryArea& pOutput);
 
+  /// emitSymInfo - emit .SUNW_syminfo, the library of each .dynsym entry
+  void emitSymInfo(const Module& pModule, MemoryArea& pOutput);
+
   /// sizeInterp - compute the size of program interpreter's name
   /// In ELF executables, this is the length of dynamic linker's path name
   virtual void sizeInterp();
@@ -146,6 +237,28 @@ public:
   /// emitInterp - emit the .interp
   virtual void emitInterp(MemoryArea& pOutput);
 
+  /// sizeBuildID - compute the size of the .note.gnu.build-id
+  void sizeBuildID();
+
+  /// setupPrelink - find the base address of the output pModule in the map
+  /// of --prelink-map
+  void setupPrelink(const Module& pModule);
+
+  /// applyPrelink - write the results of the dynamic relocations which are
+  /// fixed by the base address of the prelinked output
+  void applyPrelink(MemoryArea& pOutput);
+
+  /// sizeGNUDebugLink - compute the size of the .gnu_debuglink
+  void sizeGNUDebugLink();
+
+  /// emitGNUDebugLink - emit the file name of --separate-debug-file in
+  /// .gnu_debuglink
+  void emitGNUDebugLink(MemoryArea& pOutput);
+
+  /// emitBuildID - hash the whole output into .note.gnu.build-id. It must be
+  /// the last write of the output.
+  void emitBuildID(MemoryArea& pOutput);
+
   /// getSectionOrder - compute the layout order of the section
   /// Layout calls this function to get the default order of the pSectHdr.
   /// If the pSectHdr.type() is LDFileFormat::Target, then getSectionOrder()
@@ -154,6 +267,9 @@ public:
   /// If targets favors certain order for general sections, please override
   /// this function.
   ///
+  /// The orders of the output sections are computed once by layout() and
+  /// cached in the sections.
+  ///
   /// @see getTargetSectionOrder
   virtual unsigned int getSectionOrder(const LDSection& pSectHdr) const;
 
@@ -183,6 +299,13 @@ public:
   /// abiPageSize - the abi page size of the target machine
   uint64_t abiPageSize() const;
 
+  /// hugePageSize - the huge page size of --huge-page-text
+  uint64_t hugePageSize() const;
+
+  /// isCodeSeparated - the executable sections are placed in their own
+  /// PT_LOAD segment, e.g., -z separate-code
+  bool isCodeSeparated() const;
+
   /// getSymbolIdx - get the symbol index of ouput symbol table
   size_t getSymbolIdx(const LDSymbol* pSymbol) const;
 
@@ -197,7 +320,6 @@ public:
 
   /// isSymbolPreemtible - whether the symbol can be preemted by other
   /// link unit
-  /// @ref Google gold linker, symtab.h:551
   bool isSymbolPreemptible(const ResolveInfo& pSym) const;
 
   virtual ResolveInfo::Desc getSymDesc(uint16_t pShndx) const {
@@ -205,7 +327,6 @@ public:
   }
 
   /// symbolNeedsDynRel - return whether the symbol needs a dynamic relocation
-  /// @ref Google gold linker, symtab.h:645
   bool symbolNeedsDynRel(const ResolveInfo& pSym,
                          bool pSymHasPLT,
                          bool isAbsReloc) const;
@@ -235,6 +356,12 @@ public:
   /// Target can override this function if needed.
   virtual uint64_t maxBranchOffset() { return (uint64_t)-1; }
 
+  /// maxBranchRange - return the max distance that a branch of the
+  /// relocation type pType reaches, forward or backward. The stubs in the
+  /// islands within that distance are shared by the branch.
+  virtual uint64_t maxBranchRange(uint32_t pType) const
+  { return (uint64_t)-1; }
+
 protected:
   uint64_t getSymbolSize(const LDSymbol& pSymbol) const;
 
@@ -247,6 +374,16 @@ protected:
   /// isTemporary - Whether pSymbol is a local label.
   virtual bool isTemporary(const LDSymbol& pSymbol) const;
 
+  /// hasSymbolName - whether the name of pSymbol is put into the string
+  /// table. By default, the section symbols have no names.
+  virtual bool hasSymbolName(const LDSymbol& pSymbol) const;
+
+  /// getDynsymOrder - the ordering key of dynamic symbol pSymbol. The symbols
+  /// with non-zero keys are put at the end of .dynsym in the increasing order
+  /// of their keys. The order of the others is decided by the generic code.
+  /// Target can override this function if its ABI requires the order.
+  virtual uint64_t getDynsymOrder(const LDSymbol& pSymbol) const;
+
   /// getHashBucketCount - calculate hash bucket count.
   /// @ref Google gold linker, dynobj.cc:791
   static unsigned getHashBucketCount(unsigned pNumOfSymbols, bool pIsGNUStyle);
@@ -255,6 +392,16 @@ protected:
   /// @ref binutils gold, dynobj.cc:1165
   unsigned getGNUHashMaskbitslog2(unsigned pNumOfSymbols) const;
 
+  /// chooseGNUHashBloom - choose the size and shift of the bloom filter of
+  /// .gnu.hash which has the fewest false positives for pHashes. pBase is the
+  /// mask bits in log2 getGNUHashMaskbitslog2() gives, and pShift1 is 5 for
+  /// 32-bit bloom words and 6 for 64-bit ones.
+  static void chooseGNUHashBloom(const std::vector<uint32_t>& pHashes,
+                                 uint32_t pBase,
+                                 uint32_t pShift1,
+                                 uint32_t& pMaskbitslog2,
+                                 uint32_t& pShift2);
+
   /// isDynamicSymbol
   /// @ref Google gold linker: symtab.cc:311
   bool isDynamicSymbol(const LDSymbol& pSymbol);
@@ -264,7 +411,6 @@ protected:
   bool isDynamicSymbol(const ResolveInfo& pResolveInfo);
 
   /// symbolNeedsPLT - return whether the symbol needs a PLT entry
-  /// @ref Google gold linker, symtab.h:596
   bool symbolNeedsPLT(const ResolveInfo& pSym) const;
 
   /// symbolNeedsCopyReloc - return whether the symbol needs a copy relocation
@@ -278,23 +424,60 @@ protected:
   /// emitSymbol32 - emit an ELF32 symbol
   void emitSymbol32(llvm::ELF::Elf32_Sym& pSym32,
                     LDSymbol& pSymbol,
-                    char* pStrtab,
-                    size_t pStrtabsize,
+                    const StringTable& pStrtab,
                     size_t pSymtabIdx);
 
   /// emitSymbol64 - emit an ELF64 symbol
   void emitSymbol64(llvm::ELF::Elf64_Sym& pSym64,
                     LDSymbol& pSymbol,
-                    char* pStrtab,
-                    size_t pStrtabsize,
+                    const StringTable& pStrtab,
                     size_t pSymtabIdx);
 
+  /// getRpathString - the DT_RPATH/DT_RUNPATH string, the -rpath list joined
+  /// by colons
+  std::string getRpathString() const;
+
   /// checkAndSetHasTextRel - check pSection flag to set HasTextRel
   void checkAndSetHasTextRel(const LDSection& pSection);
 
+  /// issueUndefRef - issue the undefined reference to the symbol of pReloc
+  /// in the relocation section pSection. If the message is not ignored, it
+  /// gives the source line of the place when the input has line information.
+  void issueUndefRef(const Relocation& pReloc,
+                     const LDSection& pSection,
+                     const Module& pModule);
+
   void setHasStaticTLS(bool pVal = true) { m_bHasStaticTLS = pVal; }
 
+  /// postProcessing - Backend can do any needed modification in the final stage
+  void postProcessing(MemoryArea& pOutput);
+
 private:
+  /// SymtabEmitter - the body of parallel_for to emit the i-th .symtab entry
+  struct SymtabEmitter;
+
+  /// computeSectionOrder - compute the layout order of the section from its
+  /// kind, flags and name
+  unsigned int computeSectionOrder(const LDSection& pSectHdr) const;
+
+  /// scanProperties - the ResolveInfo::ScanProperty bits of pSym, which are
+  /// computed once and cached in pSym until its attributes change
+  uint16_t scanProperties(const ResolveInfo& pSym) const;
+
+  /// computeScanProperties - evaluate the ScanProperty bits of pSym
+  uint16_t computeScanProperties(const ResolveInfo& pSym) const;
+
+  bool computePreemptible(const ResolveInfo& pSym) const;
+
+  bool computeNeedsDynRel(const ResolveInfo& pSym,
+                          bool pPreemptible,
+                          bool pSymHasPLT,
+                          bool isAbsReloc) const;
+
+  bool computeNeedsPLT(const ResolveInfo& pSym, bool pPreemptible) const;
+
+  bool computeFinalValueIsKnown(const ResolveInfo& pSym) const;
+
   /// createProgramHdrs - base on output sections to create the program headers
   void createProgramHdrs(Module& pModule);
 
@@ -306,6 +489,29 @@ private:
   ///  (i.e., offset, addresses, file/mem size, flag,  and alignment)
   void setupProgramHdrs();
 
+  /// combineDynRelocs - sort the dynamic relocations of pSection for
+  /// -z combreloc. It is called when the .dynsym indexes are known.
+  /// @return the number of relative relocations
+  size_t combineDynRelocs(LDSection& pSection);
+
+  /// initRelrDyn - initialize .relr.dyn if --pack-dyn-relocs is given
+  void initRelrDyn(LDSection& pSection);
+
+  /// sizeRelrDyn - size .relr.dyn by the addresses of the packed places, and
+  /// set up the layout of the following sections again.
+  void sizeRelrDyn(Module& pModule);
+
+  /// orderDynsyms - put the dynamic symbols in the order of getDynsymOrder()
+  void orderDynsyms(Module::SymbolTable& pSymtab);
+
+  /// hashDynsyms - compute the GNU hashes of the dynamic symbols to hash once
+  /// for .gnu.hash, and choose the bloom filter by them.
+  /// @return the number of the hashed symbols
+  size_t hashDynsyms(Module::SymbolTable& pSymtab);
+
+  /// getGNUHash - the GNU hash of pSymbol computed by hashDynsyms
+  uint32_t getGNUHash(const LDSymbol& pSymbol) const;
+
   /// getSegmentFlag - give a section flag and return the corresponding segment
   /// flag
   inline uint32_t getSegmentFlag(const uint32_t pSectionFlag)
@@ -336,9 +542,17 @@ private:
                                Module::iterator pSectBegin,
                                Module::iterator pSectEnd);
 
+  /// relayout - lay out the output sections after pSect again, when the size
+  /// of pSect is changed. The offsets and addresses of the sections before
+  /// it are kept.
+  void relayout(Module& pModule, Module::iterator pSect);
+
   /// layout - layout method
   void layout(Module& pModule);
 
+  /// preMergeSections - read the debugging information of --gdb-index
+  void preMergeSections(Module& pModule);
+
   /// preLayout - Backend can do any needed modification before layout
   void preLayout(Module& pModule, IRBuilder& pBuilder);
 
@@ -351,9 +565,6 @@ private:
   /// postLayout -Backend can do any needed modification after layout
   virtual void doPostLayout(Module& pModule, IRBuilder& pLinker) = 0;
 
-  /// postProcessing - Backend can do any needed modification in the final stage
-  void postProcessing(MemoryArea& pOutput);
-
   /// dynamic - the dynamic section of the target machine.
   virtual ELFDynamic& dynamic() = 0;
 
@@ -373,6 +584,11 @@ private:
   virtual bool doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished)
   { return false; }
 
+  /// relaxedSectionBegin - the first output section whose offset may be
+  /// changed by doRelax. The sections before it are not laid out again.
+  virtual Module::iterator relaxedSectionBegin(Module& pModule)
+  { return pModule.begin(); }
+
   /// getRelEntrySize - the size in BYTE of rel type relocation
   virtual size_t getRelEntrySize() = 0;
 
@@ -408,7 +624,8 @@ protected:
     SHO_BSS,                 // .bss
     SHO_LARGE_BSS,           // .lbss
     SHO_UNDEFINED,           // default order
-    SHO_STRTAB               // .strtab
+    SHO_STRTAB,              // .strtab
+    SHO_SEPARATE_DEBUG       // the sections of --separate-debug-file
   };
 
   typedef std::pair<LDSection*, unsigned int> SHOEntry;
@@ -419,12 +636,30 @@ protected:
     { return X.second < Y.second; }
   };
 
+  /// PackDataPages - reorder the writable sections in pList, which is sorted
+  /// by the orders, for --pack-data-pages with pages of pPageSize bytes
+  static void PackDataPages(std::vector<SHOEntry>& pList, uint64_t pPageSize);
+
   struct SymCompare
   {
     bool operator()(const LDSymbol* X, const LDSymbol* Y) const
     { return (X==Y); }
   };
 
+  // for -z combreloc
+  struct DynRelocKey
+  {
+    bool is_relative;
+    size_t sym_idx;
+    uint64_t offset;
+    Relocation* reloc;
+  };
+
+  struct DynRelocCompare
+  {
+    bool operator()(const DynRelocKey& X, const DynRelocKey& Y) const;
+  };
+
   // for gnu style hash table
   struct DynsymCompare
   {
@@ -433,6 +668,32 @@ protected:
     bool operator()(const LDSymbol* X, const LDSymbol* Y) const;
   };
 
+  // puts the unhashed dynsyms before the hashed ones
+  struct DynsymIsUnhashed
+  {
+    bool operator()(const LDSymbol* X) const
+    { return !DynsymCompare().needGNUHash(*X); }
+  };
+
+  // puts the dynsyms ordered by the target after the others
+  struct DynsymIsUnordered
+  {
+    const GNULDBackend* backend;
+
+    bool operator()(const LDSymbol* X) const
+    { return 0 == backend->getDynsymOrder(*X); }
+  };
+
+  struct DynsymOrderCompare
+  {
+    const GNULDBackend* backend;
+
+    bool operator()(const LDSymbol* X, const LDSymbol* Y) const
+    { return backend->getDynsymOrder(*X) < backend->getDynsymOrder(*Y); }
+  };
+
+  typedef llvm::DenseMap<const LDSymbol*, uint32_t> GNUHashMapType;
+
   struct SymPtrHash
   {
     size_t operator()(const LDSymbol* pKey) const
@@ -450,6 +711,7 @@ protected:
 
 protected:
   ELFObjectReader* m_pObjectReader;
+  ELFDynObjReader* m_pDynObjReader;
 
   // -----  file formats  ----- //
   ELFDynObjFileFormat* m_pDynObjFileFormat;
@@ -474,6 +736,28 @@ protected:
   // section .eh_frame_hdr
   EhFrameHdr* m_pEhFrameHdr;
 
+  // section .gdb_index
+  GdbIndex* m_pGdbIndex;
+
+  // the file of --separate-debug-file
+  SeparateDebugFile* m_pSeparateDebugFile;
+
+  // section .relr.dyn
+  OutputRelrSection* m_pRelrDyn;
+
+  // the relocation sections of --stream-partial-link
+  RelocationStreamer* m_pRelocStreamer;
+
+  // the strings of .strtab, .dynstr and .shstrtab
+  StringTable m_StrTabNames;
+  StringTable m_DynStrTabNames;
+  StringTable m_ShStrTabNames;
+
+  // the GNU hashes of the hashed dynsyms and the bloom filter of .gnu.hash
+  GNUHashMapType m_GNUHashes;
+  uint32_t m_GNUHashMaskbitslog2;
+  uint32_t m_GNUHashShift2;
+
   // ----- dynamic flags ----- //
   // DF_TEXTREL of DT_FLAGS
   bool m_bHasTextRel;
@@ -481,6 +765,17 @@ protected:
   // DF_STATIC_TLS of DT_FLAGS
   bool m_bHasStaticTLS;
 
+  // DT_RELCOUNT or DT_RELACOUNT
+  size_t m_NumOfRelativeRelocs;
+
+  // the base address of --prelink-map
+  uint64_t m_PrelinkBase;
+  bool m_bPrelinked;
+
+  // the main part of the output of --separate-debug-file
+  size_t m_NumOfMainSections;
+  uint64_t m_MainFileSize;
+
   // -----  standard symbols  ----- //
   // section symbols
   LDSymbol* f_pPreInitArrayStart;
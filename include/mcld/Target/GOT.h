@@ -15,6 +15,7 @@
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/SectionData.h>
 #include <mcld/Fragment/TargetFragment.h>
+#include <mcld/Target/SlotTable.h>
 
 namespace mcld {
 
@@ -62,6 +63,50 @@ public:
     uint64_t f_Value;
   };
 
+  /** \class Slot
+   *  \brief Slot is a GOT entry kept in a SlotTable. Its fragment is the
+   *  table, so a reference to the entry is the table plus getTableOffset().
+   */
+  template<size_t SIZE>
+  class Slot
+  {
+  public:
+    enum { EntrySize = SIZE };
+
+  public:
+    Slot(Fragment& pTable, size_t pIndex)
+      : m_pTable(&pTable), m_Index(pIndex), m_Value(0x0) {
+    }
+
+    uint64_t getValue() const
+    { return m_Value; }
+
+    void setValue(uint64_t pValue)
+    { m_Value = pValue; }
+
+    size_t index() const
+    { return m_Index; }
+
+    Fragment&       getTable()       { return *m_pTable; }
+    const Fragment& getTable() const { return *m_pTable; }
+
+    /// getTableOffset - the offset of this entry in its table
+    uint64_t getTableOffset() const
+    { return m_Index * EntrySize; }
+
+    /// getOffset - the offset of this entry in the section
+    uint64_t getOffset() const
+    { return m_pTable->getOffset() + getTableOffset(); }
+
+    size_t size() const
+    { return EntrySize; }
+
+  private:
+    Fragment* m_pTable;
+    size_t m_Index;
+    uint64_t m_Value;
+  };
+
 public:
   virtual ~GOT();
 
@@ -14,6 +14,8 @@
 
 #include <mcld/LD/RelocData.h>
 
+#include <vector>
+
 namespace mcld
 {
 
@@ -24,6 +26,12 @@ class RelocationFactory;
 
 /** \class OutputRelocSection
  *  \brief Dynamic relocation section for ARM .rel.dyn and .rel.plt
+ *
+ *  reserveEntry() only counts the entries while the relocations are scanned.
+ *  consumeEntry() takes the records from a contiguous block sized by the
+ *  entries reserved and not consumed yet, and appends them to the output
+ *  RelocData in the order they are consumed. Ordinarily one block holds all
+ *  the records consumed when the relocations are applied.
  */
 class OutputRelocSection
 {
@@ -32,8 +40,10 @@ public:
 
   ~OutputRelocSection();
 
+  /// reserveEntry - reserve pNum entries
   void reserveEntry(size_t pNum=1);
 
+  /// consumeEntry - get the next reserved entry
   Relocation* consumeEntry();
 
   /// addSymbolToDynSym - add local symbol to TLS category so that it'll be
@@ -42,12 +52,12 @@ public:
 
   // ----- observers ----- //
   bool empty()
-  { return m_pRelocData->empty(); }
+  { return (0 == m_NumOfReserved); }
 
   size_t numOfRelocs();
 
 private:
-  typedef RelocData::iterator RelocIterator;
+  typedef std::vector<Relocation*> BlockList;
 
 private:
   Module& m_Module;
@@ -56,11 +66,20 @@ private:
   /// relocations
   RelocData* m_pRelocData;
 
-  /// m_isVisit - First time visit the function getEntry() or not
-  bool m_isVisit;
+  /// m_NumOfReserved - the number of the reserved entries
+  size_t m_NumOfReserved;
+
+  /// m_NumOfConsumed - the number of the consumed entries
+  size_t m_NumOfConsumed;
+
+  /// m_Blocks - the allocated blocks of records
+  BlockList m_Blocks;
+
+  /// m_pFreeEntry - point to the first free record of the last block
+  Relocation* m_pFreeEntry;
 
-  /// m_ValidEntryIterator - point to the first valid entry
-  RelocIterator m_ValidEntryIterator;
+  /// m_NumOfFree - the number of the free records of the last block
+  size_t m_NumOfFree;
 };
 
 } // namespace of mcld
@@ -0,0 +1,109 @@
+//===- OutputRelrSection.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_OUTPUT_RELR_SECTION_H
+#define MCLD_OUTPUT_RELR_SECTION_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld
+{
+
+class LDSection;
+class MemoryRegion;
+class Relocation;
+
+/** \class OutputRelrSection
+ *  \brief The packed relative relocation section, .relr.dyn.
+ *
+ *  A RELR section only holds the places of the relative relocations, whose
+ *  addends are kept in the places. The places are sorted and encoded into a
+ *  list of words. An even word is the address of a place, and an odd word is
+ *  a bitmap of the following (EntrySize * 8 - 1) words, whose bit i marks the
+ *  word i words after the last address or bitmap.
+ *
+ *  The relocations are reserved while scanning, and their places are encoded
+ *  after layout. Only the places aligned to the entry size can be packed.
+ */
+class OutputRelrSection
+{
+public:
+  typedef std::vector<uint64_t> EntryList;
+
+public:
+  OutputRelrSection(LDSection& pSection, size_t pEntrySize);
+
+  ~OutputRelrSection();
+
+  /// reserveEntry - pack the relative relocation of pReloc.
+  /// @return false if the place of pReloc can not be packed, and pReloc
+  /// should reserve an entry in the dynamic relocation section.
+  bool reserveEntry(const Relocation& pReloc);
+
+  /// hasEntry - is the relative relocation of pReloc packed?
+  bool hasEntry(const Relocation& pReloc) const;
+
+  /// sizeOfEntries - the size of the entries of the places at their current
+  /// addresses
+  uint64_t sizeOfEntries() const;
+
+  /// finalizeEntries - encode the places at their final addresses
+  void finalizeEntries();
+
+  /// emit - emit the finalized entries. The rest of the section is filled by
+  /// empty bitmaps.
+  void emit(MemoryRegion& pRegion) const;
+
+  /// Encode - encode the sorted places pPlaces into pEntries
+  static void Encode(const std::vector<uint64_t>& pPlaces,
+                     size_t pEntrySize,
+                     EntryList& pEntries);
+
+  // ----- observers ----- //
+  bool empty() const
+  { return m_Relocs.empty(); }
+
+  size_t numOfRelocs() const
+  { return m_Relocs.size(); }
+
+  /// numOfEntries - the number of the finalized entries
+  size_t numOfEntries() const
+  { return m_Entries.size(); }
+
+  size_t getEntrySize() const
+  { return m_EntrySize; }
+
+  const LDSection& getSection() const
+  { return m_Section; }
+
+private:
+  typedef std::vector<const Relocation*> RelocList;
+  typedef llvm::DenseSet<const Relocation*> RelocSet;
+
+private:
+  /// getPlaces - get the sorted and unique places of the relocations
+  void getPlaces(std::vector<uint64_t>& pPlaces) const;
+
+private:
+  LDSection& m_Section;
+  size_t m_EntrySize;
+  RelocList m_Relocs;
+  RelocSet m_RelocSet;
+  EntryList m_Entries;
+};
+
+} // namespace of mcld
+
+#endif
+
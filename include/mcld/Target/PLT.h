@@ -15,6 +15,7 @@
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/SectionData.h>
 #include <mcld/Fragment/TargetFragment.h>
+#include <mcld/Target/SlotTable.h>
 
 namespace mcld {
 
@@ -76,6 +77,43 @@ public:
     { return EntrySize; }
   };
 
+  /** \class Slot
+   *  \brief Slot is a PLT entry kept in a SlotTable. The code of all the
+   *  entries of a table is emitted by the target as one image.
+   */
+  template<size_t SIZE>
+  class Slot
+  {
+  public:
+    enum { EntrySize = SIZE };
+
+  public:
+    Slot(Fragment& pTable, size_t pIndex)
+      : m_pTable(&pTable), m_Index(pIndex) {
+    }
+
+    size_t index() const
+    { return m_Index; }
+
+    Fragment&       getTable()       { return *m_pTable; }
+    const Fragment& getTable() const { return *m_pTable; }
+
+    /// getTableOffset - the offset of this entry in its table
+    uint64_t getTableOffset() const
+    { return m_Index * EntrySize; }
+
+    /// getOffset - the offset of this entry in the section
+    uint64_t getOffset() const
+    { return m_pTable->getOffset() + getTableOffset(); }
+
+    size_t size() const
+    { return EntrySize; }
+
+  private:
+    Fragment* m_pTable;
+    size_t m_Index;
+  };
+
 public:
   PLT(LDSection& pSection);
 
@@ -0,0 +1,81 @@
+//===- SlotTable.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_TARGET_SLOT_TABLE_H
+#define MCLD_TARGET_SLOT_TABLE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Fragment/TargetFragment.h>
+
+#include <deque>
+
+namespace mcld {
+
+class SectionData;
+
+/** \class SlotTable
+ *  \brief SlotTable is one fragment covering a run of fixed-size entries,
+ *  such as the GOT or the PLT entries of a section.
+ *
+ *  The entries of a SlotTable are not fragments by themselves. An entry
+ *  type SLOT is constructed by SLOT(Fragment& pTable, size_t pIndex) and
+ *  gives its size by SLOT::EntrySize. The offset of an entry in the table is
+ *  its index times the entry size, so layout walks one fragment for all the
+ *  entries, and sizing and emission are array operations.
+ *
+ *  The entries are kept in a deque, so the entries handed out never move
+ *  when more entries are reserved.
+ */
+template<typename SLOT>
+class SlotTable : public TargetFragment
+{
+public:
+  typedef SLOT slot_type;
+
+  enum { EntrySize = SLOT::EntrySize };
+
+private:
+  typedef std::deque<SLOT> SlotListType;
+
+public:
+  SlotTable(SectionData* pParent)
+    : TargetFragment(Fragment::Target, pParent) {
+  }
+
+  ~SlotTable() {}
+
+  /// reserve - append pNum empty entries
+  void reserve(size_t pNum = 1)
+  {
+    for (size_t i = 0; i < pNum; ++i)
+      m_Slots.push_back(SLOT(*this, m_Slots.size()));
+  }
+
+  size_t numOfSlots() const
+  { return m_Slots.size(); }
+
+  bool empty() const
+  { return m_Slots.empty(); }
+
+  SLOT&       at(size_t pIdx)       { return m_Slots[pIdx]; }
+  const SLOT& at(size_t pIdx) const { return m_Slots[pIdx]; }
+
+  // Override pure virtual function
+  size_t size() const
+  { return m_Slots.size() * EntrySize; }
+
+private:
+  SlotListType m_Slots;
+};
+
+} // namespace of mcld
+
+#endif
+
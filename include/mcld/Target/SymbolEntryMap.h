@@ -13,6 +13,7 @@
 #endif
 
 #include <vector>
+#include <cstddef>
 
 namespace mcld {
 
@@ -20,6 +21,11 @@ class ResolveInfo;
 
 /** \class SymbolEntryMap
  *  \brief SymbolEntryMap is a <const ResolveInfo*, ENTRY*> map.
+ *
+ *  The mappings are kept in the order they are recorded, and indexed by an
+ *  open-addressing hash table on the addresses of the symbols. A bucket is
+ *  zero if it is empty, or the index of a mapping plus one. If a symbol is
+ *  recorded twice, lookUp() returns its first entry.
  */
 template<typename ENTRY>
 class SymbolEntryMap
@@ -34,6 +40,7 @@ private:
   };
 
   typedef std::vector<Mapping> SymbolEntryPool;
+  typedef std::vector<size_t> BucketList;
 
 public:
   typedef typename SymbolEntryPool::iterator iterator;
@@ -53,39 +60,71 @@ public:
   const_iterator end  () const { return m_Pool.end();   }
   iterator       end  ()       { return m_Pool.end();   }
 
-  void reserve(size_t pSize) { m_Pool.reserve(pSize); }
+  void reserve(size_t pSize);
+
+private:
+  static size_t hash(const ResolveInfo* pSymbol) {
+    size_t addr = reinterpret_cast<size_t>(pSymbol);
+    return (addr >> 3) ^ (addr >> 13);
+  }
+
+  /// bucket - the bucket of pSymbol, or the empty bucket to put it in
+  size_t bucket(const ResolveInfo* pSymbol) const;
+
+  /// rehash - index all mappings by pNumOfBuckets buckets
+  void rehash(size_t pNumOfBuckets);
 
 private:
   SymbolEntryPool m_Pool;
+  BucketList m_Buckets;
 
 };
 
+template<typename EntryType>
+size_t SymbolEntryMap<EntryType>::bucket(const ResolveInfo* pSymbol) const
+{
+  size_t mask = m_Buckets.size() - 1;
+  size_t idx = hash(pSymbol) & mask;
+  while (0 != m_Buckets[idx] && m_Pool[m_Buckets[idx] - 1].symbol != pSymbol)
+    idx = (idx + 1) & mask;
+  return idx;
+}
+
+template<typename EntryType>
+void SymbolEntryMap<EntryType>::rehash(size_t pNumOfBuckets)
+{
+  m_Buckets.assign(pNumOfBuckets, 0x0);
+  for (size_t i = 0; i < m_Pool.size(); ++i) {
+    size_t idx = bucket(m_Pool[i].symbol);
+    if (0 == m_Buckets[idx])
+      m_Buckets[idx] = i + 1;
+  }
+}
+
 template<typename EntryType>
 const EntryType*
 SymbolEntryMap<EntryType>::lookUp(const ResolveInfo& pSymbol) const
 {
-  const_iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->symbol == &pSymbol) {
-      return mapping->entry;
-    }
-  }
+  if (m_Buckets.empty())
+    return NULL;
 
-  return NULL;
+  size_t idx = m_Buckets[bucket(&pSymbol)];
+  if (0 == idx)
+    return NULL;
+  return m_Pool[idx - 1].entry;
 }
 
 template<typename EntryType>
 EntryType*
 SymbolEntryMap<EntryType>::lookUp(const ResolveInfo& pSymbol)
 {
-  iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->symbol == &pSymbol) {
-      return mapping->entry;
-    }
-  }
+  if (m_Buckets.empty())
+    return NULL;
 
-  return NULL;
+  size_t idx = m_Buckets[bucket(&pSymbol)];
+  if (0 == idx)
+    return NULL;
+  return m_Pool[idx - 1].entry;
 }
 
 template<typename EntryType>
@@ -96,6 +135,28 @@ SymbolEntryMap<EntryType>::record(const ResolveInfo& pSymbol, EntryType& pEntry)
   mapping.symbol = &pSymbol;
   mapping.entry = &pEntry;
   m_Pool.push_back(mapping);
+
+  // keep the load factor under one half
+  if (2 * m_Pool.size() > m_Buckets.size()) {
+    rehash(m_Buckets.empty() ? 16 : 2 * m_Buckets.size());
+    return;
+  }
+
+  size_t idx = bucket(&pSymbol);
+  if (0 == m_Buckets[idx])
+    m_Buckets[idx] = m_Pool.size();
+}
+
+template<typename EntryType>
+void SymbolEntryMap<EntryType>::reserve(size_t pSize)
+{
+  m_Pool.reserve(pSize);
+
+  size_t num_of_buckets = m_Buckets.empty() ? 16 : m_Buckets.size();
+  while (2 * pSize > num_of_buckets)
+    num_of_buckets *= 2;
+  if (num_of_buckets != m_Buckets.size())
+    rehash(num_of_buckets);
 }
 
 } // namespace of mcld
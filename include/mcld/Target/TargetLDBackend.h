@@ -77,6 +77,15 @@ public:
                               Module& pModule,
                               LDSection& pSection) = 0;
 
+  /// preScanRelocation - the part of scanning which only reads the symbols
+  /// and modifies pReloc itself, such as updating the addend. It may be
+  /// called concurrently for different relocations. Then scanRelocation is
+  /// called in the order of the inputs for the relocations who need it.
+  /// @param pSection - the section of relocation applying target
+  /// @return false if pReloc reserves no entries, and needs no scanRelocation
+  virtual bool preScanRelocation(Relocation& pReloc, const LDSection& pSection)
+  { return true; }
+
   /// partialScanRelocation - When doing partial linking, backend can do any
   /// modification to relocation to fix the relocation offset after section
   /// merge
@@ -99,6 +108,10 @@ public:
   /// layout - layout method
   virtual void layout(Module& pModule) = 0;
 
+  /// preMergeSections - Backend can read the input sections before they are
+  /// merged into the output sections
+  virtual void preMergeSections(Module& pModule) { }
+
   /// preLayout - Backend can do any needed modification before layout
   virtual void preLayout(Module& pModule, IRBuilder& pBuilder) = 0;
 
@@ -152,6 +165,14 @@ public:
   /// In ELF executables, this is the length of dynamic linker's path name
   virtual void sizeInterp() = 0;
 
+  /// hasGPRelativeData - does the target address the small data (.sdata and
+  /// .sbss) relative to a global pointer?
+  virtual bool hasGPRelativeData() const { return false; }
+
+  /// getEntry - the name of the default entry symbol. It is used when the
+  /// entry is not given by -e.
+  virtual const char* getEntry() const = 0;
+
   // -----  relaxation  ----- //
   virtual bool initBRIslandFactory() = 0;
   virtual bool initStubFactory() = 0;
@@ -166,6 +187,10 @@ public:
   /// mayRelax - return true if the backend needs to do relaxation
   virtual bool mayRelax() = 0;
 
+  /// reset - clear the state of the last link, so that the backend can link
+  /// another Module with the same LinkerConfig.
+  virtual void reset() = 0;
+
 protected:
   const LinkerConfig& config() const { return m_Config; }
 
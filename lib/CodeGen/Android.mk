@@ -1,8 +1,10 @@
 LOCAL_PATH:= $(call my-dir)
 
 mcld_codegen_SRC_FILES := \
+  LTOCodeGen.cpp \
   MCLDTargetMachine.cpp \
-  MCLinker.cpp
+  MCLinker.cpp \
+  SplitCodeGen.cpp
 
 # For the host
 # =====================================================
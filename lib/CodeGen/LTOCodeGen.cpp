@@ -0,0 +1,510 @@
+//===- LTOCodeGen.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/CodeGen/LTOCodeGen.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/Support/MsgHandling.h>
+
+#include <llvm/ADT/OwningPtr.h>
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalAlias.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Linker.h>
+#include <llvm/Object/Archive.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/PassManager.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/system_error.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// Helper Functions
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// IsSpecial - the llvm.* globals describe the module, not the program
+bool IsSpecial(const llvm::GlobalValue& pValue)
+{
+  return pValue.getName().startswith("llvm.");
+}
+
+/// IsGlobal - is pValue resolved against the other inputs?
+bool IsGlobal(const llvm::GlobalValue& pValue)
+{
+  return !pValue.hasLocalLinkage() && !IsSpecial(pValue);
+}
+
+/// Declare - replace pAlias by a declaration of the same name.
+void Declare(llvm::GlobalAlias& pAlias)
+{
+  llvm::Module& module = *pAlias.getParent();
+  llvm::Type* type = pAlias.getType()->getElementType();
+  llvm::GlobalValue* decl = NULL;
+  if (llvm::FunctionType* func = llvm::dyn_cast<llvm::FunctionType>(type))
+    decl = llvm::Function::Create(func, llvm::GlobalValue::ExternalLinkage,
+                                  "", &module);
+  else
+    decl = new llvm::GlobalVariable(module, type, false,
+                                    llvm::GlobalValue::ExternalLinkage,
+                                    NULL, "");
+  decl->setVisibility(pAlias.getVisibility());
+  decl->takeName(&pAlias);
+  pAlias.replaceAllUsesWith(decl);
+  pAlias.eraseFromParent();
+}
+
+ResolveInfo::Visibility Visibility(const llvm::GlobalValue& pValue)
+{
+  switch (pValue.getVisibility()) {
+    case llvm::GlobalValue::HiddenVisibility:
+      return ResolveInfo::Hidden;
+    case llvm::GlobalValue::ProtectedVisibility:
+      return ResolveInfo::Protected;
+    default:
+      return ResolveInfo::Default;
+  }
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LTOCodeGen
+//===----------------------------------------------------------------------===//
+LTOCodeGen::LTOCodeGen(const LinkerConfig& pConfig, llvm::Module& pModule)
+  : m_Config(pConfig), m_Module(pModule), m_Position(0) {
+  // the module given on the command line is the first one resolved
+  llvm::DataLayout layout(&m_Module);
+  llvm::Module::iterator func, funcEnd = m_Module.end();
+  for (func = m_Module.begin(); func != funcEnd; ++func)
+    insert(*func, MainOwner, layout);
+  llvm::Module::global_iterator var, varEnd = m_Module.global_end();
+  for (var = m_Module.global_begin(); var != varEnd; ++var)
+    insert(*var, MainOwner, layout);
+  llvm::Module::alias_iterator alias, aliasEnd = m_Module.alias_end();
+  for (alias = m_Module.alias_begin(); alias != aliasEnd; ++alias)
+    insert(*alias, MainOwner, layout);
+}
+
+LTOCodeGen::~LTOCodeGen()
+{
+  BitcodeList::iterator bc, bcEnd = m_Bitcodes.end();
+  for (bc = m_Bitcodes.begin(); bc != bcEnd; ++bc)
+    delete bc->module;
+
+  // the lazy members refer to the buffers of the archives
+  ArchiveList::iterator ar, arEnd = m_Archives.end();
+  for (ar = m_Archives.begin(); ar != arEnd; ++ar)
+    delete *ar;
+}
+
+bool LTOCodeGen::addFile(const sys::fs::Path& pPath, unsigned int pPosition)
+{
+  llvm::OwningPtr<llvm::MemoryBuffer> buffer;
+  if (llvm::MemoryBuffer::getFile(pPath.native(), buffer)) {
+    // the link reports the input which can not be read
+    return true;
+  }
+
+  size_t num = m_Bitcodes.size();
+  bool result = true;
+  switch (llvm::sys::fs::identify_magic(buffer->getBuffer())) {
+    case llvm::sys::fs::file_magic::bitcode:
+      result = addBitcode(buffer.take(), pPath.native(), false);
+      if (result)
+        m_Inputs.push_back(std::make_pair(m_Bitcodes.size() - 1, pPath));
+      break;
+    case llvm::sys::fs::file_magic::archive:
+      result = addArchive(buffer.take(), pPath.native());
+      break;
+    case llvm::sys::fs::file_magic::elf_relocatable:
+    case llvm::sys::fs::file_magic::elf_shared_object:
+      // a native input is read again by run() only if there is bitcode
+      m_Inputs.push_back(std::make_pair((size_t)NativeOwner, pPath));
+      break;
+    default:
+      // a linker script or an unknown file is left to the link
+      break;
+  }
+
+  // the objects of the LTO are linked in place of the first bitcode input
+  if (0 == num && !m_Bitcodes.empty()) {
+    m_Position = pPosition;
+    m_Path = pPath;
+  }
+  return result;
+}
+
+bool LTOCodeGen::addBitcode(llvm::MemoryBuffer* pBuffer,
+                            const std::string& pName,
+                            bool pIsMember)
+{
+  std::string error_msg;
+  llvm::Module* module =
+    llvm::getLazyBitcodeModule(pBuffer, m_Module.getContext(), &error_msg);
+  if (NULL == module) {
+    delete pBuffer;
+    error(diag::err_cannot_read_lto_input) << pName << error_msg;
+    return false;
+  }
+
+  Bitcode bitcode = { pName, module, pIsMember, false };
+  m_Bitcodes.push_back(bitcode);
+  return true;
+}
+
+bool LTOCodeGen::addArchive(llvm::MemoryBuffer* pBuffer,
+                            const std::string& pName)
+{
+  llvm::error_code ec;
+  llvm::object::Archive* archive = new llvm::object::Archive(pBuffer, ec);
+  if (ec) {
+    delete archive;
+    return true;
+  }
+  m_Archives.push_back(archive);
+
+  bool result = true;
+  llvm::object::Archive::child_iterator child,
+                                        childEnd = archive->end_children();
+  for (child = archive->begin_children(); child != childEnd; ++child) {
+    llvm::StringRef data = child->getBuffer();
+    llvm::StringRef member_name;
+    if (child->getName(member_name))
+      continue;
+    std::string name = pName + "(" + member_name.str() + ")";
+
+    llvm::MemoryBuffer* member =
+      llvm::MemoryBuffer::getMemBuffer(data, name, false);
+    switch (llvm::sys::fs::identify_magic(data)) {
+      case llvm::sys::fs::file_magic::bitcode:
+        result = addBitcode(member, name, true) && result;
+        break;
+      case llvm::sys::fs::file_magic::elf_relocatable:
+        m_NativeMembers.push_back(data);
+        delete member;
+        break;
+      default:
+        delete member;
+        break;
+    }
+  }
+  return result;
+}
+
+void LTOCodeGen::readNative(const sys::fs::Path& pPath)
+{
+  llvm::OwningPtr<llvm::MemoryBuffer> buffer;
+  if (llvm::MemoryBuffer::getFile(pPath.native(), buffer))
+    return;
+
+  bool is_dyn = (llvm::sys::fs::file_magic::elf_shared_object ==
+                 llvm::sys::fs::identify_magic(buffer->getBuffer()));
+  llvm::OwningPtr<llvm::object::ObjectFile> object(
+    llvm::object::ObjectFile::createObjectFile(buffer.take()));
+  if (object)
+    addNative(*object, is_dyn, false);
+}
+
+void LTOCodeGen::addNative(const llvm::object::ObjectFile& pObject,
+                           bool pIsDyn,
+                           bool pIsMember)
+{
+  // a shared object is resolved by its dynamic symbols
+  llvm::error_code ec;
+  llvm::object::symbol_iterator sym = pIsDyn ?
+                                      pObject.begin_dynamic_symbols() :
+                                      pObject.begin_symbols();
+  llvm::object::symbol_iterator symEnd = pIsDyn ?
+                                         pObject.end_dynamic_symbols() :
+                                         pObject.end_symbols();
+
+  for (; sym != symEnd; sym.increment(ec)) {
+    if (ec)
+      break;
+    uint32_t flags = 0;
+    llvm::StringRef name;
+    if (sym->getFlags(flags) || sym->getName(name) || name.empty())
+      continue;
+    if (0x0 == (flags & llvm::object::SymbolRef::SF_Global))
+      continue;
+
+    if (0x0 != (flags & llvm::object::SymbolRef::SF_Undefined)) {
+      // a bitcode definition referred by a native input is kept visible.
+      // The members of the archives may not be linked at all, so their
+      // references are only recorded.
+      m_NativeRefs.insert(name);
+      if (pIsMember)
+        continue;
+    }
+    else if (pIsMember) {
+      continue;
+    }
+
+    ResolveInfo::Desc desc = ResolveInfo::Define;
+    if (0x0 != (flags & llvm::object::SymbolRef::SF_Undefined))
+      desc = ResolveInfo::Undefined;
+    else if (0x0 != (flags & llvm::object::SymbolRef::SF_Common))
+      desc = ResolveInfo::Common;
+    ResolveInfo::Binding binding = ResolveInfo::Global;
+    if (0x0 != (flags & llvm::object::SymbolRef::SF_Weak))
+      binding = ResolveInfo::Weak;
+
+    Resolver::Result result;
+    m_NamePool.insertSymbol(name, pIsDyn, ResolveInfo::NoType, desc, binding,
+                            0x0, ResolveInfo::Default, NULL, result);
+    if (ResolveInfo::Undefined != desc && result.overriden)
+      m_Owners[result.info] = NativeOwner;
+  }
+}
+
+void LTOCodeGen::load(size_t pIdx)
+{
+  Bitcode& bitcode = m_Bitcodes[pIdx];
+  bitcode.isLoaded = true;
+
+  llvm::Module& module = *bitcode.module;
+  llvm::DataLayout layout(&module);
+  llvm::Module::iterator func, funcEnd = module.end();
+  for (func = module.begin(); func != funcEnd; ++func)
+    insert(*func, pIdx, layout);
+  llvm::Module::global_iterator var, varEnd = module.global_end();
+  for (var = module.global_begin(); var != varEnd; ++var)
+    insert(*var, pIdx, layout);
+  llvm::Module::alias_iterator alias, aliasEnd = module.alias_end();
+  for (alias = module.alias_begin(); alias != aliasEnd; ++alias)
+    insert(*alias, pIdx, layout);
+}
+
+void LTOCodeGen::insert(const llvm::GlobalValue& pValue, size_t pIdx,
+                        const llvm::DataLayout& pLayout)
+{
+  if (!IsGlobal(pValue))
+    return;
+
+  ResolveInfo::Desc desc = ResolveInfo::Define;
+  ResolveInfo::Binding binding = ResolveInfo::Global;
+  if (pValue.isDeclaration()) {
+    desc = ResolveInfo::Undefined;
+    if (pValue.hasExternalWeakLinkage())
+      binding = ResolveInfo::Weak;
+  }
+  else if (pValue.hasCommonLinkage())
+    desc = ResolveInfo::Common;
+  else if (pValue.isWeakForLinker())
+    binding = ResolveInfo::Weak;
+
+  ResolveInfo::Type type = ResolveInfo::Object;
+  ResolveInfo::SizeType size = 0x0;
+  if (llvm::isa<llvm::Function>(pValue)) {
+    type = ResolveInfo::Function;
+  }
+  else if (const llvm::GlobalVariable* var =
+             llvm::dyn_cast<llvm::GlobalVariable>(&pValue)) {
+    if (var->isThreadLocal())
+      type = ResolveInfo::ThreadLocal;
+    // the resolver keeps the largest common block
+    size = pLayout.getTypeAllocSize(var->getType()->getElementType());
+  }
+
+  Resolver::Result result;
+  m_NamePool.insertSymbol(pValue.getName(), false, type, desc, binding, size,
+                          Visibility(pValue), NULL, result);
+  if (ResolveInfo::Undefined != desc && result.overriden)
+    m_Owners[result.info] = pIdx;
+}
+
+bool LTOCodeGen::isNeeded(size_t pIdx) const
+{
+  const llvm::Module& module = *m_Bitcodes[pIdx].module;
+  llvm::Module::const_iterator func, funcEnd = module.end();
+  for (func = module.begin(); func != funcEnd; ++func) {
+    if (!IsGlobal(*func) || func->isDeclaration())
+      continue;
+    const ResolveInfo* info = m_NamePool.findInfo(func->getName());
+    if (NULL != info && info->isUndef() && !info->isWeak())
+      return true;
+  }
+  llvm::Module::const_global_iterator var, varEnd = module.global_end();
+  for (var = module.global_begin(); var != varEnd; ++var) {
+    if (!IsGlobal(*var) || var->isDeclaration())
+      continue;
+    const ResolveInfo* info = m_NamePool.findInfo(var->getName());
+    if (NULL != info && info->isUndef() && !info->isWeak())
+      return true;
+  }
+  return false;
+}
+
+void LTOCodeGen::pullMembers()
+{
+  // loading a member may refer to the symbols of the members before it
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 0; i < m_Bitcodes.size(); ++i) {
+      if (m_Bitcodes[i].isLoaded || !isNeeded(i))
+        continue;
+      load(i);
+      changed = true;
+    }
+  }
+}
+
+bool LTOCodeGen::isPrevailing(const llvm::GlobalValue& pValue,
+                              size_t pIdx) const
+{
+  if (!IsGlobal(pValue))
+    return true;
+
+  const ResolveInfo* info = m_NamePool.findInfo(pValue.getName());
+  OwnerMap::const_iterator owner = m_Owners.find(info);
+  return (m_Owners.end() != owner && pIdx == owner->second);
+}
+
+void LTOCodeGen::dropDefinitions(llvm::Module& pModule, size_t pIdx)
+{
+  llvm::Module::alias_iterator alias, aliasEnd = pModule.alias_end();
+  for (alias = pModule.alias_begin(); alias != aliasEnd; ) {
+    llvm::GlobalAlias* a = &*(alias++);
+    if (!isPrevailing(*a, pIdx))
+      Declare(*a);
+  }
+
+  llvm::Module::iterator func, funcEnd = pModule.end();
+  for (func = pModule.begin(); func != funcEnd; ++func) {
+    if (!func->isDeclaration() && !isPrevailing(*func, pIdx))
+      func->deleteBody();
+  }
+
+  llvm::Module::global_iterator var, varEnd = pModule.global_end();
+  for (var = pModule.global_begin(); var != varEnd; ++var) {
+    if (var->isDeclaration() || isPrevailing(*var, pIdx))
+      continue;
+    var->setInitializer(NULL);
+    var->setLinkage(llvm::GlobalValue::ExternalLinkage);
+  }
+}
+
+bool LTOCodeGen::run()
+{
+  // resolve the inputs in the order of the command line
+  InputList::const_iterator input, inEnd = m_Inputs.end();
+  for (input = m_Inputs.begin(); input != inEnd; ++input) {
+    if (NativeOwner == input->first)
+      readNative(input->second);
+    else
+      load(input->first);
+  }
+
+  std::vector<llvm::StringRef>::const_iterator member,
+                                               mEnd = m_NativeMembers.end();
+  for (member = m_NativeMembers.begin(); member != mEnd; ++member) {
+    llvm::OwningPtr<llvm::object::ObjectFile> object(
+      llvm::object::ObjectFile::createObjectFile(
+        llvm::MemoryBuffer::getMemBuffer(*member, "", false)));
+    if (object)
+      addNative(*object, false, true);
+  }
+
+  pullMembers();
+
+  dropDefinitions(m_Module, MainOwner);
+
+  bool result = true;
+  for (size_t i = 0; i < m_Bitcodes.size(); ++i) {
+    Bitcode& bitcode = m_Bitcodes[i];
+    if (!bitcode.isLoaded)
+      continue;
+
+    // the bodies are read before the definitions are dropped, or they would
+    // be read again by the linker
+    std::string error_msg;
+    if (bitcode.module->MaterializeAllPermanently(&error_msg)) {
+      error(diag::err_cannot_read_lto_input) << bitcode.name << error_msg;
+      result = false;
+      continue;
+    }
+    dropDefinitions(*bitcode.module, i);
+
+    if (llvm::Linker::LinkModules(&m_Module, bitcode.module,
+                                  llvm::Linker::DestroySource, &error_msg)) {
+      error(diag::err_cannot_link_lto_input) << bitcode.name << error_msg;
+      result = false;
+    }
+    delete bitcode.module;
+    bitcode.module = NULL;
+  }
+
+  if (result)
+    optimize();
+  return result;
+}
+
+bool LTOCodeGen::isPreserved(const llvm::GlobalValue& pValue) const
+{
+  if (m_NativeRefs.count(pValue.getName()))
+    return true;
+
+  if (m_Config.options().hasEntry() &&
+      m_Config.options().entry() == pValue.getName())
+    return true;
+
+  // a shared object exports its default symbols, an executable only with
+  // --export-dynamic
+  if (LinkerConfig::Exec == m_Config.codeGenType() &&
+      !m_Config.options().exportDynamic())
+    return false;
+  return !pValue.hasHiddenVisibility();
+}
+
+void LTOCodeGen::optimize()
+{
+  // the names must live until the internalize pass runs
+  std::vector<std::string> names;
+  if (LinkerConfig::Object != m_Config.codeGenType()) {
+    llvm::Module::iterator func, funcEnd = m_Module.end();
+    for (func = m_Module.begin(); func != funcEnd; ++func) {
+      if (!func->isDeclaration() && isPreserved(*func))
+        names.push_back(func->getName().str());
+    }
+    llvm::Module::global_iterator var, varEnd = m_Module.global_end();
+    for (var = m_Module.global_begin(); var != varEnd; ++var) {
+      if (!var->isDeclaration() && isPreserved(*var))
+        names.push_back(var->getName().str());
+    }
+    llvm::Module::alias_iterator alias, aliasEnd = m_Module.alias_end();
+    for (alias = m_Module.alias_begin(); alias != aliasEnd; ++alias) {
+      if (isPreserved(*alias))
+        names.push_back(alias->getName().str());
+    }
+  }
+  std::vector<const char*> exports;
+  exports.reserve(names.size());
+  for (size_t i = 0; i < names.size(); ++i)
+    exports.push_back(names[i].c_str());
+
+  llvm::PassManager pm;
+  pm.add(new llvm::DataLayout(&m_Module));
+  // a relocatable output is linked again, so nothing is internalized
+  if (LinkerConfig::Object != m_Config.codeGenType())
+    pm.add(llvm::createInternalizePass(exports));
+
+  llvm::PassManagerBuilder builder;
+  builder.populateLTOPassManager(pm, false, true);
+  pm.run(m_Module);
+}
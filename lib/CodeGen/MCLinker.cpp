@@ -17,9 +17,12 @@
 #include <mcld/InputTree.h>
 #include <mcld/Linker.h>
 #include <mcld/IRBuilder.h>
+#include <mcld/CodeGen/LTOCodeGen.h>
 #include <mcld/MC/InputBuilder.h>
+#include <mcld/MC/MCLDInput.h>
 #include <mcld/MC/FileAction.h>
 #include <mcld/MC/CommandAction.h>
+#include <mcld/LD/DeterminismVerifier.h>
 #include <mcld/Object/ObjectLinker.h>
 #include <mcld/Support/CommandLine.h>
 #include <mcld/Support/FileSystem.h>
@@ -27,9 +30,12 @@
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/raw_ostream.h>
 #include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/SystemUtils.h>
 
 #include <llvm/IR/Module.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
 
 #include <algorithm>
 #include <vector>
@@ -48,6 +54,13 @@ static inline bool CompareAction(const InputAction* X, const InputAction* Y)
   return (X->position() < Y->position());
 }
 
+static inline bool
+ComparePosition(const std::pair<unsigned int, mcld::sys::fs::Path>& X,
+                const std::pair<unsigned int, mcld::sys::fs::Path>& Y)
+{
+  return (X.first < Y.first);
+}
+
 //===----------------------------------------------------------------------===//
 // Positional Options
 // There are four kinds of positional options:
@@ -228,6 +241,9 @@ bool MCLinker::doFinalization(llvm::Module &pM)
   if (!m_pLinker->emit(m_Output))
     return true;
 
+  if (m_Config.options().verifyDeterminism())
+    verifyDeterminism();
+
   return false;
 }
 
@@ -237,6 +253,54 @@ bool MCLinker::runOnMachineFunction(MachineFunction& pF)
   return false;
 }
 
+bool MCLinker::AddLTOInputs(const LinkerConfig& pConfig, LTOCodeGen& pLTO)
+{
+  typedef std::pair<unsigned int, sys::fs::Path> PositionalPath;
+  std::vector<PositionalPath> paths;
+
+  // -----  inputs  ----- //
+  cl::list<mcld::sys::fs::Path>::iterator input, inBegin, inEnd;
+  inBegin = ArgInputObjectFiles.begin();
+  inEnd = ArgInputObjectFiles.end();
+  for (input = inBegin; input != inEnd; ++input) {
+    unsigned int pos = ArgInputObjectFiles.getPosition(input - inBegin);
+    paths.push_back(std::make_pair(pos, *input));
+  }
+
+  // -----  namespecs  ----- //
+  // the namespecs which can not be found are reported by the link. A
+  // namespec after --Bstatic is searched as an archive.
+  cl::list<std::string>::iterator namespec, nsBegin, nsEnd;
+  nsBegin = ArgNameSpecList.begin();
+  nsEnd = ArgNameSpecList.end();
+  for (namespec = nsBegin; namespec != nsEnd; ++namespec) {
+    unsigned int pos = ArgNameSpecList.getPosition(namespec - nsBegin);
+    int last_static = -1, last_dynamic = -1;
+    for (size_t i = 0; i < ArgBStaticList.size(); ++i) {
+      if (ArgBStaticList.getPosition(i) < pos)
+        last_static = ArgBStaticList.getPosition(i);
+    }
+    for (size_t i = 0; i < ArgBDynamicList.size(); ++i) {
+      if (ArgBDynamicList.getPosition(i) < pos)
+        last_dynamic = ArgBDynamicList.getPosition(i);
+    }
+    Input::Type prefer = (last_static > last_dynamic) ? Input::Archive :
+                                                        Input::DynObj;
+    const sys::fs::Path* path =
+      pConfig.options().directories().find(*namespec, prefer);
+    if (NULL != path)
+      paths.push_back(std::make_pair(pos, *path));
+  }
+
+  std::stable_sort(paths.begin(), paths.end(), ComparePosition);
+
+  bool result = true;
+  std::vector<PositionalPath>::iterator it, itEnd = paths.end();
+  for (it = paths.begin(); it != itEnd; ++it)
+    result = pLTO.addFile(it->second, it->first) && result;
+  return result;
+}
+
 void MCLinker::initializeInputTree(IRBuilder& pBuilder)
 {
   if (0 == ArgInputObjectFiles.size() &&
@@ -372,7 +436,7 @@ void MCLinker::initializeInputTree(IRBuilder& pBuilder)
   // -----  bitcode  ----- //
   if (m_Config.bitcode().hasDefined()) {
     actions.push_back(new BitcodeAction(m_Config.bitcode().getPosition(),
-                                        m_Config.bitcode().getPath()));
+                                        m_Config.bitcode()));
   }
 
   // stable sort
@@ -389,3 +453,70 @@ void MCLinker::initializeInputTree(IRBuilder& pBuilder)
     report_fatal_error("no matched --start-group and --end-group");
 }
 
+
+bool MCLinker::verifyDeterminism()
+{
+  // the output of the link with --threads
+  size_t actual_size = m_Output.handler()->size();
+  MemoryRegion* actual = m_Output.request(0, actual_size);
+  if (NULL == actual)
+    return false;
+
+  // the serial link writes a temporary file beside the output
+  std::string serial_name;
+  llvm::raw_string_ostream os(serial_name);
+  os << m_Output.handler()->path().native() << '.' << sys::getpid()
+     << ".serial";
+  os.flush();
+  sys::fs::Path serial_path(serial_name);
+
+  // Link the same inputs into a new module. Linker::clear() destroys the
+  // sections, the symbols and the fragments of the first link, so m_Module
+  // only keeps its name after this.
+  unsigned int num_threads = m_Config.options().numThreads();
+  m_pLinker->clear();
+  m_Config.options().setNumThreads(1);
+  m_Config.resetThreads();
+
+  bool linked = false;
+  {
+    mcld::Module module(m_Module.name());
+    IRBuilder builder(module, m_Config);
+    initializeInputTree(builder);
+    linked = m_pLinker->link(module, builder) &&
+             m_pLinker->emit(serial_path.native());
+    m_pLinker->clear();
+  }
+
+  m_Config.options().setNumThreads(num_threads);
+  m_Config.resetThreads();
+
+  if (!linked) {
+    error(diag::err_cannot_verify_determinism) << m_Module.name();
+    m_Output.release(actual);
+    sys::fs::detail::unlink(serial_path);
+    return false;
+  }
+
+  // compare the outputs
+  bool result = false;
+  FileHandle file;
+  if (file.open(serial_path, FileHandle::ReadOnly)) {
+    MemoryArea* serial = new MemoryArea(file);
+    MemoryRegion* expected = serial->request(0, file.size());
+    if (NULL != expected) {
+      DeterminismVerifier verifier(m_Config);
+      result = verifier.verify(expected->start(), expected->size(),
+                               actual->start(), actual->size());
+      serial->release(expected);
+    }
+    delete serial;
+    file.close();
+  }
+  else
+    error(diag::err_cannot_verify_determinism) << m_Module.name();
+
+  m_Output.release(actual);
+  sys::fs::detail::unlink(serial_path);
+  return result;
+}
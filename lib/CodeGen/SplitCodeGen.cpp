@@ -0,0 +1,457 @@
+//===- SplitCodeGen.cpp ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/CodeGen/SplitCodeGen.h>
+
+#include <mcld/BitcodeOption.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/SystemUtils.h>
+#include <mcld/Support/TargetRegistry.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/OwningPtr.h>
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalAlias.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/PassManager.h>
+#include <llvm/Support/FormattedStream.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include <algorithm>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// Helper Functions
+//===----------------------------------------------------------------------===//
+namespace {
+
+typedef llvm::DenseMap<const llvm::GlobalValue*, unsigned int> PartitionMap;
+
+/// Unit - a definition placed into a partition as a whole
+struct Unit
+{
+  const llvm::GlobalValue* value;
+  size_t weight;
+};
+
+bool CompareWeight(const Unit& pX, const Unit& pY)
+{
+  return (pX.weight > pY.weight);
+}
+
+/// Weight - the number of instructions of pFunc, at least one
+size_t Weight(const llvm::Function& pFunc)
+{
+  size_t weight = 1;
+  llvm::Function::const_iterator bb, bbEnd = pFunc.end();
+  for (bb = pFunc.begin(); bb != bbEnd; ++bb)
+    weight += bb->size();
+  return weight;
+}
+
+/// IsSpecial - the llvm.* globals, such as llvm.global_ctors and llvm.used,
+/// describe the whole module. They are kept in the first partition.
+bool IsSpecial(const llvm::GlobalValue& pValue)
+{
+  return pValue.getName().startswith("llvm.");
+}
+
+/// Externalize - make the local pValue visible to the other partitions, but
+/// not out of the output.
+void Externalize(llvm::GlobalValue& pValue)
+{
+  if (!pValue.hasLocalLinkage())
+    return;
+
+  // keep the name apart from the globals of the other inputs
+  pValue.setName(pValue.getName() + ".part");
+  pValue.setLinkage(llvm::GlobalValue::ExternalLinkage);
+  pValue.setVisibility(llvm::GlobalValue::HiddenVisibility);
+}
+
+/// Declare - replace pAlias by a declaration of the same name.
+void Declare(llvm::GlobalAlias& pAlias)
+{
+  llvm::Module& module = *pAlias.getParent();
+  llvm::Type* type = pAlias.getType()->getElementType();
+  llvm::GlobalValue* decl = NULL;
+  if (llvm::FunctionType* func = llvm::dyn_cast<llvm::FunctionType>(type))
+    decl = llvm::Function::Create(func, llvm::GlobalValue::ExternalLinkage,
+                                  "", &module);
+  else
+    decl = new llvm::GlobalVariable(module, type, false,
+                                    llvm::GlobalValue::ExternalLinkage,
+                                    NULL, "");
+  decl->setVisibility(pAlias.getVisibility());
+  decl->takeName(&pAlias);
+  pAlias.replaceAllUsesWith(decl);
+  pAlias.eraseFromParent();
+}
+
+/// CompilePartition - the body of parallel_for over the partitions
+struct CompilePartition
+{
+  explicit CompilePartition(SplitCodeGen& pCodeGen)
+    : codegen(pCodeGen) { }
+
+  void operator()(size_t pIdx) { codegen.compile(pIdx); }
+
+  SplitCodeGen& codegen;
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// SplitCodeGen
+//===----------------------------------------------------------------------===//
+SplitCodeGen::SplitCodeGen(const mcld::Target& pTarget,
+                           const std::string& pTriple,
+                           const std::string& pCPU,
+                           const std::string& pFeatures,
+                           const llvm::TargetOptions& pOptions,
+                           llvm::Reloc::Model pRelocModel,
+                           llvm::CodeModel::Model pCodeModel,
+                           llvm::CodeGenOpt::Level pOptLevel)
+  : m_Target(pTarget),
+    m_Triple(pTriple),
+    m_CPU(pCPU),
+    m_Features(pFeatures),
+    m_Options(pOptions),
+    m_RelocModel(pRelocModel),
+    m_CodeModel(pCodeModel),
+    m_OptLevel(pOptLevel) {
+}
+
+SplitCodeGen::~SplitCodeGen()
+{
+}
+
+bool SplitCodeGen::run(ThreadPool& pPool,
+                       llvm::Module& pModule,
+                       unsigned int pNumOfParts)
+{
+  m_Unstored.clear();
+  if (pNumOfParts <= 1) {
+    // the only partition is the module itself. Compile it in place, with no
+    // clone. The bitcode is written only to key the cache.
+    m_Objects.assign(1, std::string());
+    m_Errors.assign(1, std::string());
+    sys::fs::Path cache_path;
+    if (!m_CacheDir.empty()) {
+      std::string bitcode;
+      llvm::raw_string_ostream os(bitcode);
+      llvm::WriteBitcodeToFile(&pModule, os);
+      os.flush();
+      cache_path = getCachePath(bitcode);
+    }
+    if (cache_path.empty() || !loadCache(cache_path, 0)) {
+      emit(pModule, 0);
+      if (!cache_path.empty() && m_Errors[0].empty() &&
+          !storeCache(cache_path, 0))
+        m_Unstored.push_back(cache_path);
+    }
+    strip(pModule);
+  }
+  else {
+    split(pModule, pNumOfParts);
+    strip(pModule);
+    m_Errors.assign(m_Objects.size(), std::string());
+
+    // LLVM guards its global state, such as the pass registry, only in the
+    // multi-threaded mode.
+    if (!pPool.isSerial())
+      llvm::llvm_start_multithreaded();
+
+    CompilePartition body(*this);
+    parallel_for(pPool, 0, m_Objects.size(), body);
+  }
+
+  std::vector<sys::fs::Path>::const_iterator path, pEnd = m_Unstored.end();
+  for (path = m_Unstored.begin(); path != pEnd; ++path)
+    debug(diag::debug_cannot_write_lto_cache) << *path;
+
+  bool result = true;
+  for (size_t i = 0; i < m_Errors.size(); ++i) {
+    if (m_Errors[i].empty())
+      continue;
+    error(diag::err_cannot_compile_partition) << i << m_Errors[i];
+    result = false;
+  }
+  return result;
+}
+
+void SplitCodeGen::addObjects(BitcodeOption& pBitcode)
+{
+  for (size_t i = 0; i < m_Objects.size(); ++i) {
+    if (!m_Objects[i].empty())
+      pBitcode.addObject(&m_Objects[i][0], m_Objects[i].size());
+  }
+}
+
+void SplitCodeGen::split(llvm::Module& pModule, unsigned int pNumOfParts)
+{
+  llvm::Module::iterator func, funcEnd = pModule.end();
+  llvm::Module::global_iterator var, varEnd = pModule.global_end();
+  llvm::Module::alias_iterator alias, aliasEnd = pModule.alias_end();
+
+  // the partitions refer to the local symbols of each other.
+  for (func = pModule.begin(); func != funcEnd; ++func)
+    Externalize(*func);
+  for (var = pModule.global_begin(); var != varEnd; ++var)
+    Externalize(*var);
+  for (alias = pModule.alias_begin(); alias != aliasEnd; ++alias)
+    Externalize(*alias);
+
+  // An alias must be in the same partition as its aliasee. Keep both of them
+  // in the first partition.
+  PartitionMap partition;
+  std::vector<size_t> loads(pNumOfParts, 0);
+  for (alias = pModule.alias_begin(); alias != aliasEnd; ++alias) {
+    partition[&*alias] = 0;
+    const llvm::GlobalValue* aliasee = alias->getAliasedGlobal();
+    if (NULL == aliasee || partition.count(aliasee))
+      continue;
+    partition[aliasee] = 0;
+    if (const llvm::Function* f = llvm::dyn_cast<llvm::Function>(aliasee))
+      loads[0] += Weight(*f);
+    else
+      loads[0] += 1;
+  }
+
+  // give the heaviest definition to the lightest partition.
+  std::vector<Unit> units;
+  for (func = pModule.begin(); func != funcEnd; ++func) {
+    if (func->isDeclaration() || partition.count(&*func))
+      continue;
+    Unit unit = { &*func, Weight(*func) };
+    units.push_back(unit);
+  }
+  for (var = pModule.global_begin(); var != varEnd; ++var) {
+    if (var->isDeclaration() || IsSpecial(*var) || partition.count(&*var))
+      continue;
+    Unit unit = { &*var, 1 };
+    units.push_back(unit);
+  }
+  std::stable_sort(units.begin(), units.end(), CompareWeight);
+
+  std::vector<Unit>::const_iterator unit, unitEnd = units.end();
+  for (unit = units.begin(); unit != unitEnd; ++unit) {
+    unsigned int lightest = std::min_element(loads.begin(), loads.end()) -
+                            loads.begin();
+    partition[unit->value] = lightest;
+    loads[lightest] += unit->weight;
+  }
+
+  // write every partition as bitcode.
+  m_Objects.assign(pNumOfParts, std::string());
+  for (unsigned int i = 0; i < pNumOfParts; ++i) {
+    llvm::ValueToValueMapTy vmap;
+    llvm::OwningPtr<llvm::Module> part(llvm::CloneModule(&pModule, vmap));
+
+    if (0 != i) {
+      for (alias = pModule.alias_begin(); alias != aliasEnd; ++alias)
+        Declare(*llvm::cast<llvm::GlobalAlias>(vmap[&*alias]));
+    }
+
+    for (func = pModule.begin(); func != funcEnd; ++func) {
+      if (!func->isDeclaration() && i != partition.lookup(&*func))
+        llvm::cast<llvm::Function>(vmap[&*func])->deleteBody();
+    }
+
+    for (var = pModule.global_begin(); var != varEnd; ++var) {
+      if (var->isDeclaration())
+        continue;
+      llvm::GlobalVariable* clone =
+                                 llvm::cast<llvm::GlobalVariable>(vmap[&*var]);
+      if (IsSpecial(*var)) {
+        if (0 != i)
+          clone->eraseFromParent();
+        continue;
+      }
+      if (i != partition.lookup(&*var)) {
+        clone->setInitializer(NULL);
+        clone->setLinkage(llvm::GlobalValue::ExternalLinkage);
+      }
+    }
+
+    llvm::raw_string_ostream os(m_Objects[i]);
+    llvm::WriteBitcodeToFile(part.get(), os);
+    os.flush();
+  }
+}
+
+void SplitCodeGen::strip(llvm::Module& pModule)
+{
+  // The definitions are compiled into the objects. Leave the declarations
+  // to the passes running on pModule.
+  llvm::Module::iterator func, funcEnd = pModule.end();
+  llvm::Module::global_iterator var, varEnd = pModule.global_end();
+  llvm::Module::alias_iterator alias, aliasEnd = pModule.alias_end();
+  for (alias = pModule.alias_begin(); alias != aliasEnd; ) {
+    llvm::GlobalAlias* a = &*(alias++);
+    a->replaceAllUsesWith(a->getAliasee());
+    a->eraseFromParent();
+  }
+  for (var = pModule.global_begin(); var != varEnd; ) {
+    llvm::GlobalVariable* v = &*(var++);
+    if (IsSpecial(*v)) {
+      v->eraseFromParent();
+    }
+    else if (!v->isDeclaration()) {
+      v->setInitializer(NULL);
+      v->setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+  }
+  for (func = pModule.begin(); func != funcEnd; ++func) {
+    if (!func->isDeclaration())
+      func->deleteBody();
+  }
+}
+
+void SplitCodeGen::compile(size_t pIdx)
+{
+  sys::fs::Path cache_path;
+  if (!m_CacheDir.empty()) {
+    cache_path = getCachePath(m_Objects[pIdx]);
+    if (loadCache(cache_path, pIdx))
+      return;
+  }
+
+  // the partition is read into a context of its own, which no other thread
+  // touches.
+  llvm::LLVMContext context;
+  llvm::OwningPtr<llvm::MemoryBuffer> buffer(
+    llvm::MemoryBuffer::getMemBuffer(m_Objects[pIdx], "", false));
+  std::string error;
+  llvm::OwningPtr<llvm::Module> module(
+    llvm::ParseBitcodeFile(buffer.get(), context, &error));
+  if (!module) {
+    m_Errors[pIdx] = error;
+    return;
+  }
+
+  emit(*module, pIdx);
+  if (!cache_path.empty() && m_Errors[pIdx].empty() &&
+      !storeCache(cache_path, pIdx)) {
+    // reported by run() on the main thread
+    sys::ScopedLock lock(m_Lock);
+    m_Unstored.push_back(cache_path);
+  }
+}
+
+void SplitCodeGen::emit(llvm::Module& pModule, size_t pIdx)
+{
+  llvm::OwningPtr<llvm::TargetMachine> tm(
+    m_Target.get()->createTargetMachine(m_Triple, m_CPU, m_Features,
+                                        m_Options, m_RelocModel, m_CodeModel,
+                                        m_OptLevel));
+  if (!tm) {
+    m_Errors[pIdx] = "cannot create the target machine";
+    return;
+  }
+
+  std::string object;
+  {
+    llvm::raw_string_ostream os(object);
+    llvm::formatted_raw_ostream fos(os);
+    llvm::PassManager pm;
+    if (const llvm::DataLayout* layout = tm->getDataLayout())
+      pm.add(new llvm::DataLayout(*layout));
+    else
+      pm.add(new llvm::DataLayout(&pModule));
+
+    if (tm->addPassesToEmitFile(pm, fos,
+                                llvm::TargetMachine::CGFT_ObjectFile)) {
+      m_Errors[pIdx] = "the target cannot emit an object";
+      return;
+    }
+    pm.run(pModule);
+  }
+  m_Objects[pIdx].swap(object);
+}
+
+sys::fs::Path SplitCodeGen::getCachePath(llvm::StringRef pBitcode) const
+{
+  // the same bitcode is compiled into another object by other options
+  uint64_t key = digest::fast(
+                   reinterpret_cast<const uint8_t*>(pBitcode.data()),
+                   pBitcode.size());
+  std::string options = m_Triple + '\0' + m_CPU + '\0' + m_Features;
+  key = digest::fast(reinterpret_cast<const uint8_t*>(options.data()),
+                     options.size(), key);
+  uint8_t models[] = { (uint8_t)m_RelocModel, (uint8_t)m_CodeModel,
+                       (uint8_t)m_OptLevel };
+  key = digest::fast(models, sizeof(models), key);
+
+  std::string name;
+  llvm::raw_string_ostream os(name);
+  os << "lto-";
+  os.write_hex(key);
+  os << ".o";
+  os.flush();
+
+  sys::fs::Path result(m_CacheDir);
+  result.append(name);
+  return result;
+}
+
+bool SplitCodeGen::loadCache(const sys::fs::Path& pPath, size_t pIdx)
+{
+  FileHandle file;
+  if (!file.open(pPath, FileHandle::ReadOnly) || 0 == file.size())
+    return false;
+
+  std::string object(file.size(), '\0');
+  bool result = file.read(&object[0], 0, object.size());
+  file.close();
+  if (result)
+    m_Objects[pIdx].swap(object);
+  return result;
+}
+
+bool SplitCodeGen::storeCache(const sys::fs::Path& pPath, size_t pIdx) const
+{
+  // write a temporary file of this partition, and rename it to the cache file
+  std::string tmp_name;
+  llvm::raw_string_ostream os(tmp_name);
+  os << pPath.native() << '.' << sys::getpid() << '.' << pIdx << ".tmp";
+  os.flush();
+  sys::fs::Path tmp_path(tmp_name);
+
+  FileHandle tmp;
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  if (!tmp.open(tmp_path, mode, perm))
+    return false;
+
+  bool result = tmp.write(m_Objects[pIdx].data(), 0, m_Objects[pIdx].size());
+  result = tmp.close() && result;
+  if (result)
+    result = (0 == sys::fs::detail::rename(tmp_path, pPath));
+
+  if (!result)
+    sys::fs::detail::unlink(tmp_path);
+  return result;
+}
@@ -14,7 +14,7 @@ using namespace mcld;
 // BitcodeOption
 //===----------------------------------------------------------------------===//
 BitcodeOption::BitcodeOption()
-  : m_Position(-1) {
+  : m_Position(-1), m_bLTO(false) {
 }
 
 BitcodeOption::~BitcodeOption()
@@ -8,9 +8,41 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/Environment.h>
 #include <mcld/Support/TargetSelect.h>
+#include <mcld/Support/TargetRegistry.h>
 
 #include <llvm/Support/TargetSelect.h>
 
+#include <iterator>
+
+namespace { // anonymous
+
+// Define the functions which register the target machines, the linkers, the
+// backends, the emulations and the diagnostic line infos of a target.
+#define MCLD_TARGET(TargetName) \
+  void Initialize##TargetName() { \
+    MCLDInitialize##TargetName##LDTarget(); \
+    MCLDInitialize##TargetName##MCLinker(); \
+    MCLDInitialize##TargetName##LDBackend(); \
+    MCLDInitialize##TargetName##Emulation(); \
+    MCLDInitialize##TargetName##DiagnosticLineInfo(); \
+  }
+#include "mcld/Config/Targets.def"
+
+/// RegisterLazily - register the targets of pTargetInfo, and defer the rest
+/// of them to their first lookup
+void RegisterLazily(void (*pTargetInfo)(), mcld::Target::InitializeFnTy pFn)
+{
+  size_t registered = mcld::TargetRegistry::size();
+  pTargetInfo();
+
+  mcld::TargetRegistry::iterator target = mcld::TargetRegistry::begin();
+  std::advance(target, registered);
+  for (; target != mcld::TargetRegistry::end(); ++target)
+    mcld::TargetRegistry::RegisterInitialization(**target, pFn);
+}
+
+} // anonymous namespace
+
 void mcld::Initialize()
 {
   static bool is_initialized = false;
@@ -18,10 +50,12 @@ void mcld::Initialize()
   if (is_initialized)
     return;
 
-  llvm::InitializeAllTargets();
-  mcld::InitializeAllTargets();
-  mcld::InitializeAllEmulations();
-  mcld::InitializeAllDiagnostics();
+  // Only the target infos are registered at startup, so that the triple can
+  // be looked up. A target is initialized when it is looked up.
+  llvm::InitializeAllTargetInfos();
+#define MCLD_TARGET(TargetName) \
+  RegisterLazily(MCLDInitialize##TargetName##LDTargetInfo, Initialize##TargetName);
+#include "mcld/Config/Targets.def"
 
   is_initialized = true;
 }
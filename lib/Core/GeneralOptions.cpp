@@ -16,6 +16,7 @@ using namespace mcld;
 //===----------------------------------------------------------------------===//
 GeneralOptions::GeneralOptions()
   : m_pDefaultBitcode(NULL),
+    m_CommandLineKey(0),
     m_Verbose(-1),
     m_MaxErrorNum(-1),
     m_MaxWarnNum(-1),
@@ -36,12 +37,16 @@ GeneralOptions::GeneralOptions()
     m_bRelro(false),
     m_bNow(false),
     m_bOrigin(false),
+    m_bSeparateCode(false),
+    m_bDirect(false),
     m_bTrace(false),
     m_Bsymbolic(false),
+    m_BsymbolicFunctions(false),
     m_Bgroup(false),
     m_bPIE(false),
     m_bColor(true),
     m_bCreateEhFrameHdr(false),
+    m_bGdbIndex(false),
     m_bNMagic(false),
     m_bOMagic(false),
     m_bStripDebug(false),
@@ -52,8 +57,35 @@ GeneralOptions::GeneralOptions()
     m_bFatalWarnings(false),
     m_bNewDTags(false),
     m_bNoStdlib(false),
+    m_bMapWholeFile(true),
+    m_bFuseRelocations(false),
+    m_bKernelCopy(false),
+    m_bStreamPartialLink(false),
+    m_bLowMemory(false),
+    m_bGCSections(false),
+    m_bCallGraphOrdering(false),
+    m_bHugePageText(false),
+    m_bPackDataPages(false),
+    m_bIncremental(false),
+    m_bLazySharedSymbols(false),
+    m_bTimeReport(false),
+    m_bPerfCounters(false),
+    m_bPrintMemoryUsage(false),
+    m_bStats(false),
+    m_bExitFast(false),
+    m_bVerifyDeterminism(false),
+    m_bThreadAffinity(false),
     m_StripSymbols(KeepAllSymbols),
-    m_HashStyle(SystemV) {
+    m_ICF(ICF_None),
+    m_PackDynRelocs(PackDynRelocs_None),
+    m_CompressDebugSections(CompressDebugSections_None),
+    m_BuildID(BuildID_None),
+    m_OutputStrategy(OutputStrategy_Map),
+    m_SortSection(SortSection_None),
+    m_HashStyle(SystemV),
+    m_NumThreads(1),
+    m_CodeGenPartitions(1),
+    m_LTOJobs(0) {
 }
 
 GeneralOptions::~GeneralOptions()
@@ -158,6 +190,18 @@ void GeneralOptions::addZOption(const ZOption& pOption)
     case ZOption::Origin:
       m_bOrigin = true;
       break;
+    case ZOption::Direct:
+      m_bDirect = true;
+      break;
+    case ZOption::NoDirect:
+      m_bDirect = false;
+      break;
+    case ZOption::SeparateCode:
+      m_bSeparateCode = true;
+      break;
+    case ZOption::NoSeparateCode:
+      m_bSeparateCode = false;
+      break;
     case ZOption::CommPageSize:
       m_CommPageSize = pOption.pageSize();
       break;
@@ -170,3 +214,16 @@ void GeneralOptions::addZOption(const ZOption& pOption)
       break;
   }
 }
+
+bool GeneralOptions::isInExcludeLIBS(const Input& pInput) const
+{
+  assert(Input::Archive == pInput.type());
+  if (m_ExcludeLIBS.empty())
+    return false;
+
+  // --exclude-libs ALL excludes the symbols of all archives
+  if (0 != m_ExcludeLIBS.count("ALL"))
+    return true;
+
+  return (0 != m_ExcludeLIBS.count(pInput.path().filename().native()));
+}
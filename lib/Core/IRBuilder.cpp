@@ -10,6 +10,7 @@
 #include <mcld/LD/ELFReader.h>
 #include <mcld/Object/ObjectBuilder.h>
 #include <mcld/LD/SectionData.h>
+#include <mcld/LD/FragmentIndex.h>
 #include <mcld/LD/EhFrame.h>
 #include <mcld/LD/RelocData.h>
 #include <mcld/Support/MsgHandling.h>
@@ -20,28 +21,93 @@ using namespace mcld;
 //===----------------------------------------------------------------------===//
 // Helper Functions
 //===----------------------------------------------------------------------===//
+/// GetELFSectionKindByName - the kind of the section given by the name rules.
+/// The rules are dispatched on the character after the leading dot, so that
+/// a name is compared with two prefixes at most, and the usual names like
+/// .text.* and .rodata.* with none.
+/// @return false if no name rule applies
+static bool GetELFSectionKindByName(llvm::StringRef pName,
+                                    LDFileFormat::Kind& pKind)
+{
+  if (pName.size() < 2 || '.' != pName[0])
+    return false;
+
+  switch (pName[1]) {
+  case 'c':
+    if (pName.startswith(".comment")) {
+      pKind = LDFileFormat::MetaData;
+      return true;
+    }
+    break;
+  case 'd':
+    if (pName.startswith(".debug")) {
+      pKind = LDFileFormat::Debug;
+      return true;
+    }
+    if (pName.startswith(".dynamic")) {
+      pKind = LDFileFormat::Note;
+      return true;
+    }
+    break;
+  case 'e':
+    // .eh_frame_hdr also starts with .eh_frame
+    if (pName.startswith(".eh_frame")) {
+      pKind = LDFileFormat::EhFrame;
+      return true;
+    }
+    break;
+  case 'g':
+    if (pName.startswith(".gnu.linkonce.wi.")) {
+      pKind = LDFileFormat::Debug;
+      return true;
+    }
+    if (pName.startswith(".gcc_except_table")) {
+      pKind = LDFileFormat::GCCExceptTable;
+      return true;
+    }
+    break;
+  case 'i':
+    if (pName.startswith(".interp")) {
+      pKind = LDFileFormat::Note;
+      return true;
+    }
+    break;
+  case 'l':
+    if (pName.startswith(".line")) {
+      pKind = LDFileFormat::Debug;
+      return true;
+    }
+    break;
+  case 'n':
+    if (pName.startswith(".note.GNU-stack")) {
+      pKind = LDFileFormat::StackNote;
+      return true;
+    }
+    break;
+  case 's':
+    if (pName.startswith(".stab")) {
+      pKind = LDFileFormat::Debug;
+      return true;
+    }
+    break;
+  case 'z':
+    if (pName.startswith(".zdebug")) {
+      pKind = LDFileFormat::Debug;
+      return true;
+    }
+    break;
+  default:
+    break;
+  }
+  return false;
+}
+
 LDFileFormat::Kind GetELFSectionKind(uint32_t pType, const char* pName)
 {
   // name rules
-  llvm::StringRef name(pName);
-  if (name.startswith(".debug") ||
-      name.startswith(".zdebug") ||
-      name.startswith(".gnu.linkonce.wi.") ||
-      name.startswith(".line") ||
-      name.startswith(".stab"))
-    return LDFileFormat::Debug;
-  if (name.startswith(".comment"))
-    return LDFileFormat::MetaData;
-  if (name.startswith(".interp") || name.startswith(".dynamic"))
-    return LDFileFormat::Note;
-  if (name.startswith(".eh_frame"))
-    return LDFileFormat::EhFrame;
-  if (name.startswith(".eh_frame_hdr"))
-    return LDFileFormat::EhFrameHdr;
-  if (name.startswith(".gcc_except_table"))
-    return LDFileFormat::GCCExceptTable;
-  if (name.startswith(".note.GNU-stack"))
-    return LDFileFormat::StackNote;
+  LDFileFormat::Kind kind;
+  if (GetELFSectionKindByName(pName, kind))
+    return kind;
 
   // type rules
   switch(pType) {
@@ -99,6 +165,35 @@ bool ShouldForceLocal(const ResolveInfo& pInfo, const LinkerConfig& pConfig)
   return false;
 }
 
+/// ShouldHide - the definitions that are not exported get hidden visibility,
+/// so that ShouldForceLocal() makes them local. They are the symbols of the
+/// members of --exclude-libs archives, and the symbols that --dynamic-list
+/// or the version script do not export.
+static bool ShouldHide(const Input& pInput,
+                       llvm::StringRef pName,
+                       ResolveInfo::Type pType,
+                       ResolveInfo::Desc pDesc,
+                       ResolveInfo::Binding pBinding,
+                       ResolveInfo::Visibility pVisibility,
+                       const ExportFilter& pFilter,
+                       const LinkerConfig& pConfig)
+{
+  if (LinkerConfig::Object == pConfig.codeGenType() ||
+      ResolveInfo::Local == pBinding ||
+      ResolveInfo::Section == pType ||
+      ResolveInfo::File == pType)
+    return false;
+
+  if (ResolveInfo::Define != pDesc && ResolveInfo::Common != pDesc)
+    return false;
+
+  if (ResolveInfo::Default != pVisibility &&
+      ResolveInfo::Protected != pVisibility)
+    return false;
+
+  return (pInput.noExport() || !pFilter.isExported(pName));
+}
+
 //===----------------------------------------------------------------------===//
 // IRBuilder
 //===----------------------------------------------------------------------===//
@@ -107,6 +202,14 @@ IRBuilder::IRBuilder(Module& pModule, const LinkerConfig& pConfig)
   m_InputBuilder.setCurrentTree(m_Module.getInputTree());
 }
 
+IRBuilder::IRBuilder(Module& pModule,
+                     const LinkerConfig& pConfig,
+                     MemoryAreaFactory& pMemoryFactory)
+  : m_Module(pModule), m_Config(pConfig),
+    m_InputBuilder(pConfig, pMemoryFactory) {
+  m_InputBuilder.setCurrentTree(m_Module.getInputTree());
+}
+
 IRBuilder::~IRBuilder()
 {
 }
@@ -431,7 +534,7 @@ uint64_t IRBuilder::AppendEhFrame(EhFrame::CIE& pCIE, EhFrame& pEhFrame)
 /// AddSymbol - To add a symbol in the input file and resolve the symbol
 /// immediately
 LDSymbol* IRBuilder::AddSymbol(Input& pInput,
-                               const std::string& pName,
+                               const llvm::StringRef& pName,
                                ResolveInfo::Type pType,
                                ResolveInfo::Desc pDesc,
                                ResolveInfo::Binding pBind,
@@ -441,7 +544,7 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
                                ResolveInfo::Visibility pVis)
 {
   // rename symbols
-  std::string name = pName;
+  llvm::StringRef name = pName;
   if (!m_Config.scripts().renameMap().empty() &&
       ResolveInfo::Undefined == pDesc) {
     // If the renameMap is not empty, some symbols should be renamed.
@@ -454,19 +557,25 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
 
   switch (pInput.type()) {
     case Input::Object: {
-
-      FragmentRef* frag = NULL;
-      if (NULL == pSection ||
-          ResolveInfo::Undefined == pDesc ||
-          ResolveInfo::Common    == pDesc ||
-          ResolveInfo::Absolute  == pBind ||
-          LDFileFormat::Ignore   == pSection->kind() ||
-          LDFileFormat::Group    == pSection->kind())
-        frag = FragmentRef::Null();
-      else
-        frag = FragmentRef::Create(*pSection, pValue);
-
-      LDSymbol* input_sym = addSymbolFromObject(name, pType, pDesc, pBind, pSize, pValue, frag, pVis);
+      // a hidden definition never enters the dynamic symbol table, and its
+      // references are bound in the output
+      if (ShouldHide(pInput, name, pType, pDesc, pBind, pVis,
+                     m_ExportFilter, m_Config))
+        pVis = ResolveInfo::Hidden;
+
+      // the symbols hold their FragmentRefs in place, so the reference is
+      // built on the stack instead of in the FragmentRef factory.
+      FragmentRef frag;
+      if (NULL != pSection &&
+          ResolveInfo::Undefined != pDesc &&
+          ResolveInfo::Common    != pDesc &&
+          ResolveInfo::Absolute  != pBind &&
+          LDFileFormat::Ignore   != pSection->kind() &&
+          LDFileFormat::Group    != pSection->kind())
+        frag.assign(*pSection, pValue);
+
+      LDSymbol* input_sym = addSymbolFromObject(name, pType, pDesc, pBind, pSize, pValue, &frag, pVis,
+                                                pInput.ordinal());
       pInput.context()->addSymbol(input_sym);
       return input_sym;
     }
@@ -481,14 +590,15 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
   return NULL;
 }
 
-LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
+LDSymbol* IRBuilder::addSymbolFromObject(const llvm::StringRef& pName,
                                          ResolveInfo::Type pType,
                                          ResolveInfo::Desc pDesc,
                                          ResolveInfo::Binding pBinding,
                                          ResolveInfo::SizeType pSize,
                                          LDSymbol::ValueType pValue,
                                          FragmentRef* pFragmentRef,
-                                         ResolveInfo::Visibility pVisibility)
+                                         ResolveInfo::Visibility pVisibility,
+                                         unsigned int pOrdinal)
 {
   // Step 1. calculate a Resolver::Result
   // resolved_result is a triple <resolved_info, existent, override>
@@ -505,6 +615,7 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
                                                                    pBinding,
                                                                    pSize,
                                                                    pVisibility);
+    resolved_result.info->setOrdinal(pOrdinal);
 
     // No matter if there is a symbol with the same name, insert the symbol
     // into output symbol table. So, we let the existent false.
@@ -515,7 +626,7 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
     // if the symbol is not local, insert and resolve it immediately
     m_Module.getNamePool().insertSymbol(pName, false, pType, pDesc, pBinding,
                                         pSize, pVisibility,
-                                        &old_info, resolved_result);
+                                        &old_info, resolved_result, pOrdinal);
   }
 
   // the return ResolveInfo should not NULL
@@ -587,7 +698,7 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
 }
 
 LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
-                                         const std::string& pName,
+                                         const llvm::StringRef& pName,
                                          ResolveInfo::Type pType,
                                          ResolveInfo::Desc pDesc,
                                          ResolveInfo::Binding pBinding,
@@ -616,12 +727,18 @@ LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
   Resolver::Result resolved_result;
   m_Module.getNamePool().insertSymbol(pName, true, pType, pDesc,
                                       pBinding, pSize, pVisibility,
-                                      NULL, resolved_result);
+                                      NULL, resolved_result, pInput.ordinal());
 
   // the return ResolveInfo should not NULL
   assert(NULL != resolved_result.info);
 
-  if (resolved_result.overriden || !resolved_result.existent)
+  // an --as-needed library is needed if its definition resolves a reference
+  // of a regular object. It is decided here, so DT_NEEDED never walks the
+  // symbols again.
+  if (resolved_result.overriden &&
+      resolved_result.info->isRegularRef() &&
+      resolved_result.info->isDyn() &&
+      !resolved_result.info->isUndef())
     pInput.setNeeded();
 
   // create a LDSymbol for the input file.
@@ -679,6 +796,92 @@ Relocation* IRBuilder::AddRelocation(LDSection& pSection,
   return relocation;
 }
 
+/// AddRelocations - add all relocation entries of a relocation section
+///
+/// All symbols should be read and resolved before calling this function.
+size_t IRBuilder::AddRelocations(LDSection& pSection,
+                                 const RelocEntryList& pEntries)
+{
+  if (pEntries.empty())
+    return 0;
+
+  // find the section data of the target section once. This is the same as
+  // FragmentRef::Create(LDSection&, uint64_t).
+  LDSection& target = *pSection.getLink();
+  SectionData* data = NULL;
+  switch (target.kind()) {
+    case LDFileFormat::Relocation:
+      break;
+    case LDFileFormat::EhFrame:
+      if (target.hasEhFrame())
+        data = &target.getEhFrame()->getSectionData();
+      break;
+    default:
+      data = target.getSectionData();
+      break;
+  }
+  if (NULL != data && data->empty())
+    data = NULL;
+
+  RelocData* reloc_data = pSection.getRelocData();
+  Fragment* frag = NULL;
+  uint64_t frag_start = 0;
+  FragmentIndex index;
+  size_t num = 0;
+
+  RelocEntryList::const_iterator entry, eEnd = pEntries.end();
+  for (entry = pEntries.begin(); entry != eEnd; ++entry) {
+    // FIXME: we should dicard sections and symbols first instead
+    // if the symbol is in the discarded input section, then we also need to
+    // discard this relocation.
+    ResolveInfo* resolve_info = entry->symbol->resolveInfo();
+    if (!entry->symbol->hasFragRef() &&
+        ResolveInfo::Section == resolve_info->type() &&
+        ResolveInfo::Undefined == resolve_info->desc())
+      continue;
+
+    Relocation* relocation = NULL;
+    if (NULL != data) {
+      // walk forward from the last fragment. If the offsets are not
+      // ascending, look the place up in the index instead of walking from the
+      // front again.
+      if (NULL == frag) {
+        frag = &data->front();
+        frag_start = 0;
+      }
+      else if (entry->offset < frag_start) {
+        if (index.empty())
+          index.build(*data);
+        uint64_t offset = entry->offset;
+        frag = index.find(offset);
+        frag_start = entry->offset - offset;
+      }
+      while (NULL != frag && frag_start + frag->size() < entry->offset) {
+        frag_start += frag->size();
+        frag = frag->getNextNode();
+      }
+    }
+
+    if (NULL != data && NULL != frag) {
+      relocation = Relocation::Create(entry->type,
+                                      *frag,
+                                      entry->offset - frag_start,
+                                      entry->addend);
+    }
+    else {
+      // the offset is out of the target section
+      relocation = Relocation::Create(entry->type,
+                                      *FragmentRef::Null(),
+                                      entry->addend);
+    }
+
+    relocation->setSymInfo(resolve_info);
+    reloc_data->append(*relocation);
+    ++num;
+  }
+  return num;
+}
+
 /// AddSymbol - define an output symbol and override it immediately
 template<> LDSymbol*
 IRBuilder::AddSymbol<IRBuilder::Force, IRBuilder::Unresolve>(
@@ -13,6 +13,10 @@ using namespace mcld;
 InputTree::Succeeder InputTree::Afterward;
 InputTree::Includer  InputTree::Downward;
 
+InputTree::InputTree()
+  : m_bFrozen(false) {
+}
+
 //===----------------------------------------------------------------------===//
 // InputTree
 //===----------------------------------------------------------------------===//
@@ -23,6 +27,7 @@ InputTree& InputTree::merge(TreeIteratorBase pRoot,
   if (this == &pTree)
     return *this;
 
+  m_bFrozen = false;
   if (!pTree.empty()) {
     pMover.connect(pRoot, iterator(pTree.m_Root.node.right));
     BinaryTreeBase<Input>::m_Root.summon(
@@ -36,6 +41,7 @@ InputTree& InputTree::merge(TreeIteratorBase pRoot,
 InputTree& InputTree::enterGroup(TreeIteratorBase pRoot,
                                  const InputTree::Mover& pMover)
 {
+  m_bFrozen = false;
   NodeBase* node = createNode();
   pMover.connect(pRoot, iterator(node));
   return *this;
@@ -45,12 +51,46 @@ InputTree& InputTree::insert(TreeIteratorBase pRoot,
                              const InputTree::Mover& pMover,
                              mcld::Input& pInput)
 {
+  m_bFrozen = false;
   BinaryTree<Input>::node_type* node = createNode();
   node->data = &pInput;
   pMover.connect(pRoot, iterator(node));
   return *this;
 }
 
+void InputTree::freeze()
+{
+  m_Flat.clear();
+  m_Ranges.clear();
+  m_Flat.reserve(size());
+  flatten(BinaryTreeBase<Input>::m_Root.node.left);
+  m_bFrozen = true;
+}
+
+void InputTree::flatten(NodeBase* pNode)
+{
+  // the positional successors are visited by the loop, and only the members
+  // of groups and archives by the recursion, which is as deep as the nesting.
+  NodeBase* root = &BinaryTreeBase<Input>::m_Root.node;
+  for (; root != pNode; pNode = pNode->right) {
+    Input* input = static_cast<node_type*>(pNode)->data;
+    if (NULL != input)
+      m_Flat.push_back(input);
+
+    if (root == pNode->left)
+      continue;
+
+    size_t idx = m_Ranges.size();
+    Range range;
+    range.kind = (NULL == input) ? Range::Group : Range::Archive;
+    range.begin = m_Flat.size();
+    range.end = m_Flat.size();
+    m_Ranges.push_back(range);
+    flatten(pNode->left);
+    m_Ranges[idx].end = m_Flat.size();
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // non-member functions
 //===----------------------------------------------------------------------===//
@@ -14,26 +14,40 @@
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/TargetRegistry.h>
 #include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/LinkContext.h>
+#include <mcld/Support/LinkStats.h>
 #include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MemoryUsage.h>
+#include <mcld/Support/SystemUtils.h>
+#include <mcld/Support/TimeReport.h>
 #include <mcld/Support/raw_ostream.h>
 
 #include <mcld/Object/ObjectLinker.h>
 #include <mcld/MC/InputBuilder.h>
+#include <mcld/MC/InputCost.h>
+#include <mcld/MC/MCLDInput.h>
 #include <mcld/Target/TargetLDBackend.h>
 #include <mcld/LD/LDSection.h>
+#include <mcld/LD/LinkCache.h>
 #include <mcld/LD/LDSymbol.h>
 #include <mcld/LD/SectionData.h>
 #include <mcld/LD/RelocData.h>
 #include <mcld/Fragment/Relocation.h>
+#include <mcld/Fragment/Fragment.h>
 #include <mcld/Fragment/FragmentRef.h>
 
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
 #include <cassert>
 
 using namespace mcld;
 
 Linker::Linker()
   : m_pConfig(NULL), m_pIRBuilder(NULL),
-    m_pTarget(NULL), m_pBackend(NULL), m_pObjLinker(NULL) {
+    m_pTarget(NULL), m_pBackend(NULL), m_pObjLinker(NULL), m_pCache(NULL) {
 }
 
 Linker::~Linker()
@@ -45,6 +59,17 @@ bool Linker::config(LinkerConfig& pConfig)
 {
   m_pConfig = &pConfig;
 
+  // the config may be created in another thread
+  m_pConfig->context().activate();
+
+  // count the memory of the factories from now on
+  if (m_pConfig->options().printMemoryUsage())
+    MemoryUsage::Enable();
+
+  // count the work of the link from now on
+  if (m_pConfig->options().stats())
+    LinkStats::Enable();
+
   if (!initTarget())
     return false;
 
@@ -60,6 +85,16 @@ bool Linker::config(LinkerConfig& pConfig)
   if (!initOStream())
     return false;
 
+  // --verify-determinism compares two real links, not a link and its copy
+  if (m_pConfig->options().hasLinkCache() &&
+      !m_pConfig->options().verifyDeterminism()) {
+    sys::fs::Path dir(m_pConfig->options().linkCache());
+    if (sys::fs::is_directory(dir))
+      m_pCache = new LinkCache(*m_pConfig, dir);
+    else
+      warning(diag::warn_bad_link_cache) << dir;
+  }
+
   return true;
 }
 
@@ -74,6 +109,9 @@ bool Linker::link(Module& pModule, IRBuilder& pBuilder)
 bool Linker::resolve(Module& pModule, IRBuilder& pBuilder)
 {
   assert(NULL != m_pConfig);
+  m_pConfig->context().activate();
+
+  TimeScope timer(m_pConfig->timeReport(), "resolve");
 
   m_pIRBuilder = &pBuilder;
   assert(m_pObjLinker!=NULL);
@@ -90,18 +128,52 @@ bool Linker::resolve(Module& pModule, IRBuilder& pBuilder)
   if (!Diagnose())
     return false;
 
+  // 3.a - look up the cached output
+  //   If the same inputs were linked by the same command line, the output is
+  //   copied from the cache by emit(), and nothing else is done.
+  if (NULL != m_pCache && m_pCache->lookup(pModule))
+    return true;
+
   // 4. - normalize the input tree
   //   read out sections and symbol/string tables (from the files) and
   //   set them in Module. When reading out the symbol, resolve their symbols
   //   immediately and set their ResolveInfo (i.e., Symbol Resolution).
-  m_pObjLinker->normalize();
+  {
+    TimeScope phase(m_pConfig->timeReport(), "normalize");
+    m_pObjLinker->normalize();
+    reportMemory("normalize");
+  }
+
+  // normalize() froze the input tree.
+  const InputTree::FlatList& inputs = pModule.getInputTree().flat();
+  if (LinkStats::isEnabled()) {
+    InputTree::FlatList::const_iterator input, inEnd = inputs.end();
+    for (input = inputs.begin(); input != inEnd; ++input) {
+      switch((*input)->type()) {
+      case Input::Object:
+        LinkStats::Add(LinkStats::ObjectInputs);
+        break;
+      case Input::Archive:
+        LinkStats::Add(LinkStats::ArchiveInputs);
+        break;
+      case Input::DynObj:
+        LinkStats::Add(LinkStats::DynObjInputs);
+        break;
+      case Input::Script:
+        LinkStats::Add(LinkStats::ScriptInputs);
+        break;
+      default:
+        break;
+      }
+    }
+  }
 
   if (m_pConfig->options().trace()) {
-    static int counter = 0;
     mcld::outs() << "** name\ttype\tpath\tsize (" << pModule.getInputTree().size() << ")\n";
-    InputTree::const_dfs_iterator input, inEnd = pModule.getInputTree().dfs_end();
-    for (input=pModule.getInputTree().dfs_begin(); input!=inEnd; ++input) {
-      mcld::outs() << counter++ << " *  " << (*input)->name();
+    InputTree::FlatList::const_iterator input, inEnd = inputs.end();
+    for (input = inputs.begin(); input != inEnd; ++input) {
+      mcld::outs() << m_pConfig->context().nextTraceID() << " *  "
+                   << (*input)->name();
       switch((*input)->type()) {
       case Input::Archive:
         mcld::outs() << "\tarchive\t(";
@@ -118,6 +190,9 @@ bool Linker::resolve(Module& pModule, IRBuilder& pBuilder)
       case Input::External:
         mcld::outs() << "\textern\t(";
         break;
+      case Input::Bitcode:
+        mcld::outs() << "\tbitcode\t(";
+        break;
       default:
         unreachable(diag::err_cannot_trace_file) << (*input)->type()
                                                  << (*input)->name()
@@ -149,25 +224,63 @@ bool Linker::resolve(Module& pModule, IRBuilder& pBuilder)
   //   For all relocation sections of each input file (in the tree),
   //   read out reloc entry info from the object file and accordingly
   //   initiate their reloc entries in SectOrRelocData of LDSection.
-  m_pObjLinker->readRelocations();
+  {
+    TimeScope phase(m_pConfig->timeReport(), "readRelocations");
+    m_pObjLinker->readRelocations();
+    reportMemory("readRelocations");
+  }
+
+  // 6.a - data stripping optimizations
+  //   Remove the unreachable input sections before they are merged.
+  {
+    TimeScope phase(m_pConfig->timeReport(), "dataStrippingOpt");
+    if (!m_pObjLinker->dataStrippingOpt())
+      return false;
+  }
 
   // 7. - merge all sections
   //   Push sections into Module's SectionTable.
   //   Merge sections that have the same name.
   //   Maintain them as fragments in the section.
-  if (!m_pObjLinker->mergeSections())
-    return false;
+  {
+    TimeScope phase(m_pConfig->timeReport(), "mergeSections");
+    if (!m_pObjLinker->mergeSections())
+      return false;
+    reportMemory("mergeSections");
+  }
 
   // 8. - allocateCommonSymbols
   //   Allocate fragments for common symbols to the corresponding sections.
   if (!m_pObjLinker->allocateCommonSymbols())
     return false;
+
+  // 8.a - function reordering
+  //   Reorder the functions of the executable sections by the call graph.
+  {
+    TimeScope phase(m_pConfig->timeReport(), "orderFunctions");
+    if (!m_pObjLinker->orderFunctions())
+      return false;
+  }
+
+  // 8.b - small data reordering
+  //   Pack the most accessed small data near the global pointer.
+  {
+    TimeScope phase(m_pConfig->timeReport(), "orderSmallData");
+    if (!m_pObjLinker->orderSmallData())
+      return false;
+  }
   return true;
 }
 
 bool Linker::layout()
 {
   assert(NULL != m_pConfig && NULL != m_pObjLinker);
+  m_pConfig->context().activate();
+
+  if (NULL != m_pCache && m_pCache->isHit())
+    return true;
+
+  TimeScope timer(m_pConfig->timeReport(), "layout");
 
   // 9. - add standard symbols, target-dependent symbols and script symbols
   // m_pObjLinker->addUndefSymbols();
@@ -176,32 +289,49 @@ bool Linker::layout()
       !m_pObjLinker->addScriptSymbols())
     return false;
 
+  // 9.b - resolve the references still undefined by the DT_NEEDED libraries
+  //   of the shared objects, which are read only if there are such ones
+  m_pObjLinker->readDependencies();
+
   // 10. - scan all relocation entries by output symbols.
   //   reserve GOT space for layout.
   //   the space info is needed by pre-layout to compute the section size
-  m_pObjLinker->scanRelocations();
+  {
+    TimeScope phase(m_pConfig->timeReport(), "scanRelocations");
+    m_pObjLinker->scanRelocations();
+    reportMemory("scanRelocations");
+  }
 
-  // 11.a - init relaxation stuff.
-  m_pObjLinker->initStubs();
+  {
+    TimeScope phase(m_pConfig->timeReport(), "layoutSections");
 
-  // 11.b - pre-layout
-  m_pObjLinker->prelayout();
+    // 11.a - init relaxation stuff.
+    m_pObjLinker->initStubs();
 
-  // 11.c - linear layout
-  //   Decide which sections will be left in. Sort the sections according to
-  //   a given order. Then, create program header accordingly.
-  //   Finally, set the offset for sections (@ref LDSection)
-  //   according to the new order.
-  m_pObjLinker->layout();
+    // 11.b - pre-layout
+    m_pObjLinker->prelayout();
 
-  // 11.d - post-layout (create segment, instruction relaxing)
-  m_pObjLinker->postlayout();
+    // 11.c - linear layout
+    //   Decide which sections will be left in. Sort the sections according
+    //   to a given order. Then, create program header accordingly.
+    //   Finally, set the offset for sections (@ref LDSection)
+    //   according to the new order.
+    m_pObjLinker->layout();
+
+    // 11.d - post-layout (create segment, instruction relaxing)
+    m_pObjLinker->postlayout();
+    reportMemory("layoutSections");
+  }
 
   // 12. - finalize symbol value
   m_pObjLinker->finalizeSymbolValue();
 
   // 13. - apply relocations
-  m_pObjLinker->relocation();
+  {
+    TimeScope phase(m_pConfig->timeReport(), "applyRelocations");
+    m_pObjLinker->relocation();
+    reportMemory("applyRelocations");
+  }
 
   if (!Diagnose())
     return false;
@@ -210,20 +340,227 @@ bool Linker::layout()
 
 bool Linker::emit(MemoryArea& pOutput)
 {
-  // 13. - write out output
-  m_pObjLinker->emitOutput(pOutput);
+  m_pConfig->context().activate();
 
-  // 14. - post processing
-  m_pObjLinker->postProcessing(pOutput);
+  if (NULL != m_pCache && m_pCache->isHit()) {
+    if (!m_pCache->restore(pOutput)) {
+      error(diag::err_cannot_restore_link_cache) << m_pCache->getCachePath();
+      return false;
+    }
+    reportTime();
+    reportMemory(NULL);
+    reportStats();
+    return true;
+  }
 
-  if (!Diagnose())
-    return false;
+  uint64_t emit_begin = sys::GetTimeInMicroseconds();
+  {
+    TimeScope timer(m_pConfig->timeReport(), "emit");
+
+    // 13. - write out output
+    m_pObjLinker->emitOutput(pOutput);
+
+    // 14. - post processing
+    {
+      TimeScope phase(m_pConfig->timeReport(), "postProcessing");
+      m_pObjLinker->postProcessing(pOutput);
+    }
+
+    if (!Diagnose())
+      return false;
+
+    // 15. - keep the output in the cache
+    if (NULL != m_pCache)
+      m_pCache->store(pOutput);
+  }
 
+  // 16. - report the time of the phases, the memory of the factories, the
+  // counters of the link and the costs of the inputs
+  reportTime();
+  reportMemory(NULL);
+  reportStats();
+  reportCost(sys::GetTimeInMicroseconds() - emit_begin);
   return true;
 }
 
+void Linker::reportTime()
+{
+  TimeReport* report = m_pConfig->timeReport();
+  if (NULL == report)
+    return;
+
+  if (m_pConfig->options().timeReport() ||
+      m_pConfig->options().perfCounters())
+    report->print(mcld::outs());
+
+  if (!m_pConfig->options().hasTimeTrace())
+    return;
+
+  std::string json;
+  llvm::raw_string_ostream os(json);
+  report->writeTrace(os);
+  os.flush();
+
+  FileHandle file;
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  bool result = file.open(m_pConfig->options().timeTrace(), mode, perm) &&
+                file.write(json.data(), 0, json.size());
+  if (file.isOpened())
+    result = file.close() && result;
+  if (!result)
+    warning(diag::warn_cannot_write_time_trace)
+                                           << m_pConfig->options().timeTrace();
+}
+
+void Linker::reportMemory(const char* pPhase)
+{
+  if (!m_pConfig->options().printMemoryUsage())
+    return;
+
+  if (NULL == pPhase)
+    MemoryUsage::Print(mcld::outs());
+  else
+    MemoryUsage::PrintSummary(mcld::outs(), pPhase);
+}
+
+void Linker::reportStats()
+{
+  if (!m_pConfig->options().stats())
+    return;
+
+  LinkStats::Print(mcld::outs(), m_pBackend->getRelocator());
+}
+
+namespace {
+
+/// GetInputLabel - the path of pInput, or archive(member) for a member of an
+/// archive
+std::string GetInputLabel(const Input& pInput)
+{
+  if (0 == pInput.fileOffset())
+    return pInput.path().native();
+  return pInput.path().native() + "(" + pInput.name() + ")";
+}
+
+/// WriteJSONString - write pStr as a JSON string
+void WriteJSONString(llvm::raw_ostream& pOS, const std::string& pStr)
+{
+  pOS << '"';
+  for (size_t i = 0; i < pStr.size(); ++i) {
+    unsigned char c = pStr[i];
+    if ('"' == c || '\\' == c)
+      pOS << '\\' << (char)c;
+    else if (c < 0x20)
+      pOS << llvm::format("\\u%04x", c);
+    else
+      pOS << (char)c;
+  }
+  pOS << '"';
+}
+
+/// WriteCSVString - write pStr as a CSV field
+void WriteCSVString(llvm::raw_ostream& pOS, const std::string& pStr)
+{
+  if (std::string::npos == pStr.find_first_of(",\"\n")) {
+    pOS << pStr;
+    return;
+  }
+  pOS << '"';
+  for (size_t i = 0; i < pStr.size(); ++i) {
+    if ('"' == pStr[i])
+      pOS << '"';
+    pOS << pStr[i];
+  }
+  pOS << '"';
+}
+
+} // anonymous namespace
+
+void Linker::reportCost(uint64_t pEmitTime)
+{
+  if (!m_pConfig->options().hasCostReport())
+    return;
+
+  // The writer emits the output sections, not the inputs, so the time of
+  // emit() is shared by the inputs in proportion to their output bytes.
+  Module& module = m_pIRBuilder->getModule();
+  uint64_t total_bytes = 0;
+  Module::obj_iterator obj, objEnd = module.obj_end();
+  for (obj = module.obj_begin(); obj != objEnd; ++obj) {
+    if (NULL != (*obj)->cost())
+      total_bytes += (*obj)->cost()->outputBytes;
+  }
+
+  const std::string& path = m_pConfig->options().costReport();
+  bool json = (path.size() >= 5 && 0 == path.compare(path.size() - 5, 5,
+                                                     ".json"));
+  std::string report;
+  llvm::raw_string_ostream os(report);
+  if (json)
+    os << "[";
+  else {
+    os << "input,mapped_bytes,sections,symbols,relocations";
+    for (unsigned int i = 0; i < InputCost::NumOfPhases; ++i)
+      os << "," << InputCost::name(static_cast<InputCost::Phase>(i)) << "_us";
+    os << ",output_bytes\n";
+  }
+
+  bool first = true;
+  for (obj = module.obj_begin(); obj != objEnd; ++obj) {
+    InputCost* cost = (*obj)->cost();
+    if (NULL == cost)
+      continue;
+    if (0 != total_bytes)
+      cost->time[InputCost::Emit] =
+        (uint64_t)((double)pEmitTime * cost->outputBytes / total_bytes);
+
+    if (json) {
+      os << (first ? "\n" : ",\n") << "{\"input\":";
+      WriteJSONString(os, GetInputLabel(**obj));
+      os << ",\"mapped_bytes\":" << cost->mappedBytes
+         << ",\"sections\":" << cost->sections
+         << ",\"symbols\":" << cost->symbols
+         << ",\"relocations\":" << cost->relocations;
+      for (unsigned int i = 0; i < InputCost::NumOfPhases; ++i) {
+        os << ",\"" << InputCost::name(static_cast<InputCost::Phase>(i))
+           << "_us\":" << cost->time[i];
+      }
+      os << ",\"output_bytes\":" << cost->outputBytes << "}";
+    }
+    else {
+      WriteCSVString(os, GetInputLabel(**obj));
+      os << "," << cost->mappedBytes
+         << "," << cost->sections
+         << "," << cost->symbols
+         << "," << cost->relocations;
+      for (unsigned int i = 0; i < InputCost::NumOfPhases; ++i)
+        os << "," << cost->time[i];
+      os << "," << cost->outputBytes << "\n";
+    }
+    first = false;
+  }
+  if (json)
+    os << "\n]\n";
+  os.flush();
+
+  FileHandle file;
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  bool result = file.open(path, mode, perm) &&
+                file.write(report.data(), 0, report.size());
+  if (file.isOpened())
+    result = file.close() && result;
+  if (!result)
+    warning(diag::warn_cannot_write_cost_report) << path;
+}
+
 bool Linker::emit(const std::string& pPath)
 {
+  m_pConfig->context().activate();
+
   FileHandle file;
   FileHandle::Permission perm = 0755;
   if (!file.open(pPath,
@@ -246,6 +583,9 @@ bool Linker::emit(int pFileDescriptor)
 {
   FileHandle file;
   file.delegate(pFileDescriptor);
+  if (file.isOpened() && !file.isSeekable())
+    return emitStream(pFileDescriptor);
+
   MemoryArea* output = new MemoryArea(file);
 
   bool result = emit(*output);
@@ -255,8 +595,45 @@ bool Linker::emit(int pFileDescriptor)
   return result;
 }
 
+bool Linker::emitStream(int pSink)
+{
+  // the writer emits the sections in parallel and patches the headers and
+  // the build ID at last, so the output is finished in an anonymous file
+  // before any byte of it is streamed. The file is never written to a disk.
+  FileHandle image;
+  if (!image.openAnonymous()) {
+    error(diag::err_cannot_open_output_stream) << pSink;
+    return false;
+  }
+
+  MemoryArea* output = new MemoryArea(image);
+  bool result = emit(*output);
+
+  if (result) {
+    // every section has to reach the file before it is streamed
+    output->clear();
+    MemoryRegion* region = output->request(0, image.size());
+    llvm::raw_fd_ostream os(pSink, false);
+    os.write(reinterpret_cast<const char*>(region->start()), region->size());
+    os.flush();
+    if (os.has_error()) {
+      error(diag::err_cannot_write_output_stream) << pSink;
+      os.clear_error();
+      result = false;
+    }
+  }
+
+  delete output;
+  image.close();
+  return result;
+}
+
 bool Linker::reset()
 {
+  // the relocations are cleared from the factory of the link
+  if (NULL != m_pConfig)
+    m_pConfig->context().activate();
+
   m_pConfig = NULL;
   m_pIRBuilder = NULL;
   m_pTarget = NULL;
@@ -273,10 +650,49 @@ bool Linker::reset()
   delete m_pObjLinker;
   m_pObjLinker = NULL;
 
+  delete m_pCache;
+  m_pCache = NULL;
+
   LDSection::Clear();
   LDSymbol::Clear();
   FragmentRef::Clear();
   Relocation::Clear();
+
+  // all Fragments are destroyed with their SectionData and the backend
+  Fragment::Clear();
+  return true;
+}
+
+bool Linker::clear()
+{
+  assert(NULL != m_pConfig && NULL != m_pBackend);
+  m_pIRBuilder = NULL;
+
+  // Because llvm::iplist will touch the removed node, we must clear
+  // RelocData before resetting target backend.
+  RelocData::Clear();
+  SectionData::Clear();
+  EhFrame::Clear();
+
+  m_pBackend->reset();
+
+  // ObjectLinker holds the readers and the FragmentLinker of the last module
+  delete m_pObjLinker;
+  m_pObjLinker = new ObjectLinker(*m_pConfig, *m_pBackend);
+
+  if (NULL != m_pCache) {
+    delete m_pCache;
+    m_pCache = new LinkCache(*m_pConfig,
+                             sys::fs::Path(m_pConfig->options().linkCache()));
+  }
+
+  LDSection::Clear();
+  LDSymbol::Clear();
+  FragmentRef::Clear();
+  Relocation::Clear();
+
+  // all Fragments are destroyed with their SectionData and the backend
+  Fragment::Clear();
   return true;
 }
 
@@ -9,7 +9,11 @@
 #include <mcld/LinkerConfig.h>
 #include <mcld/Config/Config.h>
 
+#include <mcld/LD/DiagnosticPrinter.h>
+#include <mcld/Support/LinkContext.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/Support/TimeReport.h>
 
 using namespace mcld;
 
@@ -23,9 +27,13 @@ LinkerConfig::LinkerConfig()
     m_Bitcode(),
     m_Attribute(),
     m_CodeGenType(Unknown),
-    m_CodePosition(DynamicDependent)
+    m_CodePosition(DynamicDependent),
+    m_pContext(new LinkContext()),
+    m_pThreadPool(NULL),
+    m_pTimeReport(NULL)
 {
   // FIXME: is here the right place to hold this?
+  m_pContext->activate();
   InitializeDiagnosticEngine(*this);
 }
 
@@ -36,16 +44,51 @@ LinkerConfig::LinkerConfig(const std::string& pTripleString)
     m_Bitcode(),
     m_Attribute(),
     m_CodeGenType(Unknown),
-    m_CodePosition(DynamicDependent)
+    m_CodePosition(DynamicDependent),
+    m_pContext(new LinkContext()),
+    m_pThreadPool(NULL),
+    m_pTimeReport(NULL)
 {
   // FIXME: is here the right place to hold this?
+  m_pContext->activate();
   InitializeDiagnosticEngine(*this);
 }
 
 LinkerConfig::~LinkerConfig()
 {
+  // the workers of the pool use the context until they are joined
+  delete m_pThreadPool;
+  delete m_pTimeReport;
+
   // FIXME: is here the right place to hold this?
-  FinalizeDiagnosticEngine();
+  m_pContext->getDiagEngine().getPrinter()->finish();
+  if (LinkContext::GetCurrent() == m_pContext)
+    LinkContext::SetCurrent(NULL);
+  delete m_pContext;
+}
+
+ThreadPool& LinkerConfig::threads() const
+{
+  if (NULL == m_pThreadPool)
+    m_pThreadPool = new ThreadPool(m_Options.numThreads(),
+                                   m_Options.threadAffinity());
+  return *m_pThreadPool;
+}
+
+void LinkerConfig::resetThreads()
+{
+  delete m_pThreadPool;
+  m_pThreadPool = NULL;
+}
+
+TimeReport* LinkerConfig::timeReport() const
+{
+  if (!m_Options.timeReport() && !m_Options.hasTimeTrace() &&
+      !m_Options.perfCounters())
+    return NULL;
+  if (NULL == m_pTimeReport)
+    m_pTimeReport = new TimeReport(m_Options.perfCounters());
+  return m_pTimeReport;
 }
 
 const char* LinkerConfig::version()
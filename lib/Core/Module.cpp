@@ -22,35 +22,37 @@ using namespace mcld;
 // Module
 //===----------------------------------------------------------------------===//
 Module::Module()
-  : m_NamePool(1024) {
+  : m_NamePool(1024), m_NumOfOrdinals(0) {
 }
 
 Module::Module(const std::string& pName)
-  : m_Name(pName), m_NamePool(1024) {
+  : m_Name(pName), m_NamePool(1024), m_NumOfOrdinals(0) {
 }
 
 Module::~Module()
 {
 }
 
+Module& Module::appendSection(LDSection& pSection)
+{
+  m_SectionTable.push_back(&pSection);
+  m_SectionIndex.insert(std::make_pair(pSection.name(), &pSection));
+  return *this;
+}
+
 // Following two functions will be obsolette when we have new section merger.
 LDSection* Module::getSection(const std::string& pName)
 {
-  iterator sect, sectEnd = end();
-  for (sect = begin(); sect != sectEnd; ++sect) {
-    if ((*sect)->name() == pName)
-      return *sect;
-  }
-  return NULL;
+  return m_SectionIndex.lookup(pName);
 }
 
 const LDSection* Module::getSection(const std::string& pName) const
 {
-  const_iterator sect, sectEnd = end();
-  for (sect = begin(); sect != sectEnd; ++sect) {
-    if ((*sect)->name() == pName)
-      return *sect;
-  }
-  return NULL;
+  return m_SectionIndex.lookup(pName);
 }
 
+
+void Module::assignOrdinal(Input& pInput)
+{
+  pInput.setOrdinal(m_NumOfOrdinals++);
+}
@@ -5,6 +5,7 @@ mcld_fragment_SRC_FILES := \
   FGNode.cpp \
   FillFragment.cpp \
   Fragment.cpp \
+  FragmentGraph.cpp \
   FragmentLinker.cpp \
   FragmentRef.cpp \
   NullFragment.cpp \
@@ -8,30 +8,75 @@
 //===----------------------------------------------------------------------===//
 
 #include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/AlignFragment.h>
+#include <mcld/Fragment/FillFragment.h>
+#include <mcld/Fragment/NullFragment.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Stub.h>
+#include <mcld/Fragment/TargetFragment.h>
 
 #include <llvm/Support/DataTypes.h>
+#include <llvm/Support/ManagedStatic.h>
+
+#include <mcld/ADT/IndexTable.h>
 
 #include <mcld/LD/SectionData.h>
+#include <mcld/Support/Arena.h>
+#include <mcld/Support/Thread.h>
+#include <mcld/Support/ThreadPool.h>
 
 using namespace mcld;
 
+namespace { // anonymous
+
+/// the arenas of the Fragments, one for each NUMA node of the bound workers,
+/// so the slabs are touched first on their nodes. They are never destroyed,
+/// since the SectionDatas left at exit still delete their Fragments.
+const unsigned int NumOfArenas = 8;
+
+sys::Mutex g_ArenaLock[NumOfArenas];
+
+Arena* g_pArena[NumOfArenas];
+
+#ifdef MCLD_COMPACT_IR
+llvm::ManagedStatic<IndexTable<Fragment> > g_FragmentTable;
+#endif
+
+} // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // Fragment
 //===----------------------------------------------------------------------===//
 Fragment::Fragment()
   : m_Kind(Type(~0)), m_pParent(NULL), m_Offset(~uint64_t(0)) {
+#ifdef MCLD_COMPACT_IR
+  m_Index = g_FragmentTable->add(this);
+#endif
 }
 
 Fragment::Fragment(Type pKind, SectionData *pParent)
   : m_Kind(pKind), m_pParent(pParent), m_Offset(~uint64_t(0)) {
+#ifdef MCLD_COMPACT_IR
+  m_Index = g_FragmentTable->add(this);
+#endif
   if (NULL != m_pParent)
     m_pParent->getFragmentList().push_back(this);
 }
 
 Fragment::~Fragment()
 {
+#ifdef MCLD_COMPACT_IR
+  g_FragmentTable->remove(m_Index);
+#endif
 }
 
+#ifdef MCLD_COMPACT_IR
+Fragment* Fragment::Get(uint32_t pIndex)
+{
+  return g_FragmentTable->at(pIndex);
+}
+#endif
+
 uint64_t Fragment::getOffset() const
 {
   assert(hasOffset() && "Cannot getOffset() before setting it up.");
@@ -43,3 +88,47 @@ bool Fragment::hasOffset() const
   return (m_Offset != ~uint64_t(0));
 }
 
+size_t Fragment::size() const
+{
+  switch (m_Kind) {
+    case Region:
+      return static_cast<const RegionFragment*>(this)->size();
+    case Fillment:
+      return static_cast<const FillFragment*>(this)->size();
+    case Null:
+      return static_cast<const NullFragment*>(this)->size();
+    case Alignment:
+      return static_cast<const AlignFragment*>(this)->size();
+    case Stub:
+      return static_cast<const mcld::Stub*>(this)->size();
+    case Target:
+      return static_cast<const TargetFragment*>(this)->size();
+    default:
+      assert(false && "Can not get the size of an unknown Fragment!");
+      return 0;
+  }
+}
+
+void* Fragment::operator new(size_t pSize)
+{
+  unsigned int idx = ThreadPool::GetCurrentNode() % NumOfArenas;
+  sys::ScopedLock lock(g_ArenaLock[idx]);
+  if (NULL == g_pArena[idx])
+    g_pArena[idx] = new Arena(MemoryUsage::Fragments);
+  return g_pArena[idx]->allocate(pSize);
+}
+
+void Fragment::operator delete(void* pPtr)
+{
+  // No action. The memory is released by Fragment::Clear().
+}
+
+void Fragment::Clear()
+{
+  for (unsigned int i = 0; i < NumOfArenas; ++i) {
+    sys::ScopedLock lock(g_ArenaLock[i]);
+    if (NULL != g_pArena[i])
+      g_pArena[i]->release();
+  }
+}
+
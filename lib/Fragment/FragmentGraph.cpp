@@ -22,6 +22,7 @@
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/ELF.h>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace mcld;
@@ -46,30 +47,76 @@ static int get_state(Fragment::Type pKind)
 }
 
 //===----------------------------------------------------------------------===//
-// ReachMatrix
+// AdjacencyList
 //===----------------------------------------------------------------------===//
-FragmentGraph::ReachMatrix::ReachMatrix(size_t pSize)
+FragmentGraph::AdjacencyList::AdjacencyList()
+  : m_RowBegin(1, 0x0), m_N(0x0) {
+}
+
+void FragmentGraph::AdjacencyList::add(uint32_t pX, uint32_t pY)
 {
-  assert(pSize != 0);
-  m_Data.assign(pSize * pSize, 0x0);
-  m_N = pSize;
+  m_From.push_back(pX);
+  m_To.push_back(pY);
 }
 
-uint32_t& FragmentGraph::ReachMatrix::at(uint32_t pX, uint32_t pY)
+void FragmentGraph::AdjacencyList::finalize(size_t pN)
 {
-  return m_Data[pX * m_N + pY];
+  m_N = pN;
+
+  // 1. count the references of every source node
+  IndexListType row_end(m_N + 1, 0x0);
+  for (size_t i = 0; i < m_From.size(); ++i) {
+    assert(m_From[i] < m_N && m_To[i] < m_N);
+    ++row_end[m_From[i] + 1];
+  }
+  for (size_t x = 0; x < m_N; ++x)
+    row_end[x + 1] += row_end[x];
+
+  // 2. bucket the targets by the source nodes
+  IndexListType targets(m_From.size());
+  IndexListType next(row_end.begin(), row_end.end() - 1);
+  for (size_t i = 0; i < m_From.size(); ++i)
+    targets[next[m_From[i]]++] = m_To[i];
+
+  // 3. merge the same targets of a row into one weighted target
+  m_Targets.clear();
+  m_Targets.reserve(targets.size());
+  m_RowBegin.assign(m_N + 1, 0x0);
+  for (size_t x = 0; x < m_N; ++x) {
+    m_RowBegin[x] = m_Targets.size();
+    std::sort(targets.begin() + row_end[x], targets.begin() + row_end[x + 1]);
+    for (size_t i = row_end[x]; i < row_end[x + 1]; ++i) {
+      if (m_Targets.size() > m_RowBegin[x] &&
+          targets[i] == m_Targets.back().node) {
+        ++m_Targets.back().weight;
+        continue;
+      }
+      Target target = { targets[i], 1 };
+      m_Targets.push_back(target);
+    }
+  }
+  m_RowBegin[m_N] = m_Targets.size();
+
+  // release the memory of the added references
+  IndexListType().swap(m_From);
+  IndexListType().swap(m_To);
 }
 
-uint32_t FragmentGraph::ReachMatrix::at(uint32_t pX, uint32_t pY) const
+uint32_t FragmentGraph::AdjacencyList::at(uint32_t pX, uint32_t pY) const
 {
-  return m_Data[pX * m_N + pY];
+  assert(pX < m_N);
+  const_iterator target = std::lower_bound(begin(pX), end(pX), pY,
+                                           compareTarget);
+  if (target == end(pX) || target->node != pY)
+    return 0x0;
+  return target->weight;
 }
 
 //===----------------------------------------------------------------------===//
 // FragmentGraph
 //===----------------------------------------------------------------------===//
 FragmentGraph::FragmentGraph()
- : m_pMatrix(NULL), m_NumOfPNodes(0x0), m_NumOfRNodes(0x0), m_NumOfEdges(0x0)
+ : m_NumOfPNodes(0x0), m_NumOfRNodes(0x0), m_NumOfEdges(0x0)
 {
   m_pPseudoNodeFactory = new NodeFactoryType();
   m_pRegularNodeFactory = new NodeFactoryType();
@@ -82,6 +129,7 @@ FragmentGraph::~FragmentGraph()
   delete m_pPseudoNodeFactory;
   delete m_pRegularNodeFactory;
   delete m_pFragNodeMap;
+  delete m_pSymNodeMap;
 }
 
 FGNode* FragmentGraph::getNode(const Fragment& pFrag)
@@ -120,6 +168,7 @@ FGNode* FragmentGraph::producePseudoNode()
 {
   FGNode* result = m_pPseudoNodeFactory->allocate();
   new (result) FGNode(m_NumOfPNodes + m_NumOfRNodes);
+  m_NodeList.push_back(result);
   ++m_NumOfPNodes;
   return result;
 }
@@ -128,6 +177,7 @@ FGNode* FragmentGraph::produceRegularNode()
 {
   FGNode* result = m_pRegularNodeFactory->allocate();
   new (result) FGNode(m_NumOfPNodes + m_NumOfRNodes);
+  m_NodeList.push_back(result);
   ++m_NumOfRNodes;
   return result;
 }
@@ -166,8 +216,8 @@ bool FragmentGraph::setNodeSlots(Module& pModule)
 
 bool FragmentGraph::createRegularEdges(Module& pModule)
 {
-  // The reference between nodes are presented by the relocations. Set the
-  // reachability matrix to present the connection
+  // The reference between nodes are presented by the relocations. Add the
+  // references to the reachability matrix to present the connection
 
   // Traverse all input relocations to set connection
   Module::obj_iterator input, inEnd = pModule.obj_end();
@@ -243,10 +293,7 @@ bool FragmentGraph::connect(Signal pSignal, Slot pSlot)
   FGNode* to = getNode(*pSlot->outSymbol()->fragRef()->frag());
   assert(NULL != to);
 
-  // maintain edge counter
-  if (0 == m_pMatrix->at(from->getIndex(), to->getIndex()))
-    ++m_NumOfEdges;
-  ++m_pMatrix->at(from->getIndex(), to->getIndex());
+  m_Matrix.add(from->getIndex(), to->getIndex());
   return true;
 }
 
@@ -255,10 +302,7 @@ bool FragmentGraph::connect(FGNode& pFrom, Slot pSlot)
   FGNode* to = getNode(*pSlot->outSymbol()->fragRef()->frag());
   assert(NULL != to);
 
-  // maintain edge counter
-  if (0 == m_pMatrix->at(pFrom.getIndex(), to->getIndex()))
-    ++m_NumOfEdges;
-  ++m_pMatrix->at(pFrom.getIndex(), to->getIndex());
+  m_Matrix.add(pFrom.getIndex(), to->getIndex());
   return true;
 }
 
@@ -363,25 +407,50 @@ bool FragmentGraph::createRegularNodes(Module& pModule)
   return true;
 }
 
-void FragmentGraph::initMatrix()
+bool FragmentGraph::getEdges(FGNode& pNode, EdgeListType& pEdges)
 {
-  m_pMatrix = new ReachMatrix(m_NumOfPNodes + m_NumOfRNodes);
+  // the targets of pNode are stored in its row
+  AdjacencyList::const_iterator it, itEnd = m_Matrix.end(pNode.getIndex());
+  for (it = m_Matrix.begin(pNode.getIndex()); it != itEnd; ++it)
+    pEdges.push_back(FGEdge(pNode, *m_NodeList[it->node], it->weight));
+
+  return true;
 }
 
-bool FragmentGraph::getEdges(FGNode& pNode, EdgeListType& pEdges)
+void FragmentGraph::getReachedNodes(const std::vector<FGNode*>& pRoots,
+                                    std::vector<bool>& pReached) const
 {
-  // Traverse all regular nodes to find the connection to pNode
-  node_iterator it, itEnd = m_pRegularNodeFactory->end();
-  for (it = m_pRegularNodeFactory->begin(); it != itEnd; ++it) {
-    FGNode& node_to = *it;
-    uint32_t weight = m_pMatrix->at(pNode.getIndex(), node_to.getIndex());
-    if (weight > 0) {
-      // build an Edge
-      pEdges.push_back(FGEdge(pNode, node_to, weight));
+  pReached.assign(m_NodeList.size(), false);
+
+  // breadth-first search. The visited nodes in the queue are never removed,
+  // so the queue is also the list of the reached nodes.
+  std::vector<uint32_t> queue;
+  queue.reserve(m_NodeList.size());
+  std::vector<FGNode*>::const_iterator root, rEnd = pRoots.end();
+  for (root = pRoots.begin(); root != rEnd; ++root) {
+    if (!pReached[(*root)->getIndex()]) {
+      pReached[(*root)->getIndex()] = true;
+      queue.push_back((*root)->getIndex());
     }
   }
 
-  return true;
+  for (size_t head = 0; head < queue.size(); ++head) {
+    AdjacencyList::const_iterator it, itEnd = m_Matrix.end(queue[head]);
+    for (it = m_Matrix.begin(queue[head]); it != itEnd; ++it) {
+      if (!pReached[it->node]) {
+        pReached[it->node] = true;
+        queue.push_back(it->node);
+      }
+    }
+  }
+}
+
+bool FragmentGraph::isReachable(const FGNode& pFrom, const FGNode& pTo) const
+{
+  std::vector<FGNode*> roots(1, m_NodeList[pFrom.getIndex()]);
+  std::vector<bool> reached;
+  getReachedNodes(roots, reached);
+  return reached[pTo.getIndex()];
 }
 
 bool FragmentGraph::construct(const LinkerConfig& pConfig, Module& pModule)
@@ -393,10 +462,6 @@ bool FragmentGraph::construct(const LinkerConfig& pConfig, Module& pModule)
   if (!createPseudoNodes(pModule))
     return false;
 
-  // after all nodes created, we know the number of the nodes and then can
-  // create the reachability matrix
-  initMatrix();
-
   // set slots - traverse all symbols to set the slots of regular nodes
   if(!setNodeSlots(pModule))
     return false;
@@ -407,6 +472,10 @@ bool FragmentGraph::construct(const LinkerConfig& pConfig, Module& pModule)
   if(!createPseudoEdges(pModule))
     return false;
 
+  // after all nodes and references are created, build the reachability
+  // matrix
+  m_Matrix.finalize(m_NumOfPNodes + m_NumOfRNodes);
+  m_NumOfEdges = m_Matrix.numOfEdges();
   return true;
 }
 
@@ -12,26 +12,37 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/Fragment/FragmentLinker.h>
 
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/Support/Host.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/Casting.h>
 
 #include <mcld/LinkerConfig.h>
 #include <mcld/Module.h>
+#include <mcld/MC/InputCost.h>
 #include <mcld/MC/MCLDInput.h>
 #include <mcld/LD/BranchIslandFactory.h>
 #include <mcld/LD/Resolver.h>
 #include <mcld/LD/LDContext.h>
 #include <mcld/LD/RelocationFactory.h>
 #include <mcld/LD/RelocData.h>
+#include <mcld/LD/Relocator.h>
+#include <mcld/LD/RelocationStreamer.h>
 #include <mcld/LD/SectionRules.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/Support/TimeReport.h>
 #include <mcld/Target/TargetLDBackend.h>
 #include <mcld/Fragment/Relocation.h>
 
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
@@ -52,51 +63,161 @@ FragmentLinker::~FragmentLinker()
 {
 }
 
-bool FragmentLinker::finalizeSymbols()
+namespace { // anonymous
+
+/// SymbolFinalizer - the body of parallel_for to set the value of the i-th
+/// output symbol. The layout is fixed, so the values are independent of
+/// each other.
+struct SymbolFinalizer
 {
-  Module::sym_iterator symbol, symEnd = m_Module.sym_end();
-  for (symbol = m_Module.sym_begin(); symbol != symEnd; ++symbol) {
+  Module::SymbolTable* symbols;
+  TargetLDBackend* backend;
 
-    if ((*symbol)->resolveInfo()->isAbsolute() ||
-        (*symbol)->resolveInfo()->type() == ResolveInfo::File) {
+  void operator()(size_t pIdx) {
+    LDSymbol& symbol = *symbols->begin()[pIdx];
+    if (symbol.resolveInfo()->isAbsolute() ||
+        symbol.resolveInfo()->type() == ResolveInfo::File) {
       // absolute symbols or symbols with function type should have
       // zero value
-      (*symbol)->setValue(0x0);
-      continue;
+      symbol.setValue(0x0);
+      return;
     }
 
-    if ((*symbol)->resolveInfo()->type() == ResolveInfo::ThreadLocal) {
-      m_Backend.finalizeTLSSymbol(**symbol);
-      continue;
+    if (symbol.resolveInfo()->type() == ResolveInfo::ThreadLocal) {
+      backend->finalizeTLSSymbol(symbol);
+      return;
     }
 
-    if ((*symbol)->hasFragRef()) {
+    if (symbol.hasFragRef()) {
       // set the virtual address of the symbol. If the output file is
       // relocatable object file, the section's virtual address becomes zero.
       // And the symbol's value become section relative offset.
-      uint64_t value = (*symbol)->fragRef()->getOutputOffset();
-      assert(NULL != (*symbol)->fragRef()->frag());
-      uint64_t addr = (*symbol)->fragRef()->frag()->getParent()->getSection().addr();
-      (*symbol)->setValue(value + addr);
-      continue;
+      uint64_t value = symbol.fragRef()->getOutputOffset();
+      assert(NULL != symbol.fragRef()->frag());
+      uint64_t addr = symbol.fragRef()->frag()->getParent()->getSection().addr();
+      symbol.setValue(value + addr);
     }
   }
+};
 
+} // anonymous namespace
+
+bool FragmentLinker::finalizeSymbols()
+{
+  SymbolFinalizer finalizer = { &m_Module.getSymbolTable(), &m_Backend };
+  parallel_for(m_Config.threads(), 0, m_Module.sym_size(), finalizer, 1024);
   return true;
 }
 
 //===----------------------------------------------------------------------===//
 // Relocation Operations
 //===----------------------------------------------------------------------===//
+//===----------------------------------------------------------------------===//
+// Relocation Application
+//===----------------------------------------------------------------------===//
+namespace { // anonymous
+
+/// RelocApplier - the body of parallel_for to apply the i-th batch of
+/// relocations
+struct RelocApplier
+{
+  static const size_t BatchSize = 256;
+
+  std::vector<Relocation*>* relocs;
+  std::vector<Relocator::Result>* results;
+  std::vector<unsigned char>* failed;
+  Relocator* relocator;
+  TimeReport* report;
+
+  void operator()(size_t pIdx) {
+    TimeScope timer(report, "apply relocation batch", llvm::utostr(pIdx));
+    getDiagnosticEngine().setOrdinal(pIdx);
+    size_t begin = pIdx * BatchSize;
+    size_t num = relocs->size() - begin;
+    if (num > BatchSize)
+      num = BatchSize;
+    Relocator::Result* result = &(*results)[begin];
+    relocator->applyBatch(&(*relocs)[begin], result, num);
+
+    // OK is zero, so a batch failed if any bit of its results is set. The
+    // reporting pass only walks the failed batches.
+    unsigned int any = 0x0;
+    for (size_t i = 0; i < num; ++i)
+      any |= result[i];
+    (*failed)[pIdx] = (0x0 != any);
+  }
+};
+
+/// RelocFailure - a relocation applied in order which failed. It is reported
+/// before the deferred relocation at position.
+struct RelocFailure
+{
+  Relocation* reloc;
+  Relocator::Result result;
+  size_t position;
+};
+
+/// ReportRelocations - report the failed relocations in the order of the
+/// inputs. pDeferred[i] is reported after the in-order failures at the
+/// positions up to i.
+void ReportRelocations(const Relocator& pRelocator,
+                       const std::vector<Relocation*>& pDeferred,
+                       const std::vector<Relocator::Result>& pResults,
+                       const std::vector<unsigned char>& pFailed,
+                       const std::vector<RelocFailure>& pFailures)
+{
+  size_t f = 0;
+  for (size_t b = 0; b < pFailed.size(); ++b) {
+    if (0x0 == pFailed[b])
+      continue;
+    size_t begin = b * RelocApplier::BatchSize;
+    size_t end = std::min(begin + RelocApplier::BatchSize, pDeferred.size());
+    for (size_t i = begin; i < end; ++i) {
+      if (Relocator::OK == pResults[i])
+        continue;
+      for (; f < pFailures.size() && pFailures[f].position <= i; ++f)
+        pRelocator.report(*pFailures[f].reloc, pFailures[f].result);
+      pRelocator.report(*pDeferred[i], pResults[i]);
+    }
+  }
+  for (; f < pFailures.size(); ++f)
+    pRelocator.report(*pFailures[f].reloc, pFailures[f].result);
+}
+
+} // anonymous namespace
+
 bool FragmentLinker::applyRelocations()
 {
   // when producing relocatables, no need to apply relocation
   if (LinkerConfig::Object == m_Config.codeGenType())
     return true;
 
-  // apply all relocations of all inputs
+  // apply all relocations of all inputs. The relocations of a section are
+  // allocated in the order of the list, so the list is walked linearly.
+  //
+  // Every relocation is finalized as it is met, so the target kernels, the
+  // batches and the writer read its place and symbol value from a record
+  // instead of walking the fragments and the symbols again.
+  //
+  // The relocations which consume GOT, PLT or dynamic relocation entries are
+  // applied in order here. The others are deferred and applied in batches,
+  // in parallel with --threads. The kernels only compute the results, and
+  // the failures of both kinds are reported in order afterwards. With
+  // --fuse-relocations, the others are left to the writer or
+  // normalSyncRelocationResult(), except the ones in the compressed
+  // sections, which are written by the writer before the sync.
+  Relocator& relocator = *m_Backend.getRelocator();
+  std::vector<Relocation*> deferred;
+  std::vector<RelocFailure> failures;
+
+  // with --thread-affinity, a batch is applied by the thread which preloaded
+  // the input of its first relocation
+  bool affinity = m_Config.options().isMultiThreads() &&
+                  m_Config.threads().hasAffinity();
+  ThreadPool::HomeList homes;
   Module::obj_iterator input, inEnd = m_Module.obj_end();
   for (input = m_Module.obj_begin(); input != inEnd; ++input) {
+    InputCostScope cost(**input, InputCost::Apply);
     LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
     for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
       // bypass the reloc section if
@@ -109,11 +230,42 @@ bool FragmentLinker::applyRelocations()
       RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
       for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
         Relocation* relocation = llvm::cast<Relocation>(reloc);
-        relocation->apply(*m_Backend.getRelocator());
+        relocation->finalize();
+        if (!relocator.mayApplyConcurrently(*relocation)) {
+          Relocator::Result result = relocator.applyRelocation(*relocation);
+          if (Relocator::OK != result) {
+            RelocFailure failure = { relocation, result, deferred.size() };
+            failures.push_back(failure);
+          }
+        }
+        else if (!isFused(*relocation)) {
+          if (affinity && 0 == deferred.size() % RelocApplier::BatchSize)
+            homes.push_back((*input)->home());
+          deferred.push_back(relocation);
+        }
       } // for all relocations
     } // for all relocation section
   } // for all inputs
 
+  std::vector<Relocator::Result> results(deferred.size(), Relocator::OK);
+  size_t num_batches = (deferred.size() + RelocApplier::BatchSize - 1) /
+                       RelocApplier::BatchSize;
+  std::vector<unsigned char> failed(num_batches, 0x0);
+  if (!deferred.empty()) {
+    RelocApplier applier = { &deferred, &results, &failed, &relocator,
+                             m_Config.timeReport() };
+    if (m_Config.options().isMultiThreads()) {
+      getDiagnosticEngine().beginBuffer();
+      parallel_for(m_Config.threads(), 0, num_batches, applier, homes);
+      getDiagnosticEngine().endBuffer();
+    }
+    else {
+      for (size_t i = 0; i < num_batches; ++i)
+        applier(i);
+    }
+  }
+  ReportRelocations(relocator, deferred, results, failed, failures);
+
   // apply relocations created by relaxation
   BranchIslandFactory* br_factory = m_Backend.getBRIslandFactory();
   BranchIslandFactory::iterator facIter, facEnd = br_factory->end();
@@ -121,55 +273,174 @@ bool FragmentLinker::applyRelocations()
     BranchIsland& island = *facIter;
     BranchIsland::reloc_iterator iter, iterEnd = island.reloc_end();
     for (iter = island.reloc_begin(); iter != iterEnd; ++iter)
-      (*iter)->apply(*m_Backend.getRelocator());
+      (*iter)->apply(relocator);
   }
   return true;
 }
 
+bool FragmentLinker::IsStreamed(const LinkerConfig& pConfig)
+{
+  // a relocatable output is written as it is
+  return (LinkerConfig::Object != pConfig.codeGenType() &&
+          (pConfig.options().isLowMemory() ||
+           pConfig.options().isMultiThreads() ||
+           GeneralOptions::OutputStrategy_Write ==
+             pConfig.options().getOutputStrategy()));
+}
 
-void FragmentLinker::syncRelocationResult(MemoryArea& pOutput)
+bool FragmentLinker::IsFused(const LinkerConfig& pConfig,
+                             const Relocator& pRelocator,
+                             const Relocation& pReloc)
 {
-  if (LinkerConfig::Object != m_Config.codeGenType())
-    normalSyncRelocationResult(pOutput);
-  else
-    partialSyncRelocationResult(pOutput);
-  return;
+  return (pConfig.options().fuseRelocations() &&
+          !isCompressedTarget(pReloc) &&
+          pRelocator.mayApplyConcurrently(pReloc));
 }
 
-void FragmentLinker::normalSyncRelocationResult(MemoryArea& pOutput)
+void FragmentLinker::SortByPlace(std::vector<Relocation*>& pRelocs)
 {
-  MemoryRegion* region = pOutput.request(0, pOutput.handler()->size());
+  // The inputs are mostly laid out in their order, so the list is often
+  // sorted already. Otherwise, the places are read once into the keys, and
+  // the index breaks the ties as a stable sort would.
+  size_t i = 1;
+  for (; i < pRelocs.size(); ++i) {
+    if (pRelocs[i]->place() < pRelocs[i - 1]->place())
+      break;
+  }
+  if (i >= pRelocs.size())
+    return;
+
+  typedef std::pair<Relocation::Address, size_t> Key;
+  std::vector<Key> keys(pRelocs.size());
+  for (i = 0; i < pRelocs.size(); ++i)
+    keys[i] = Key(pRelocs[i]->place(), i);
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<Relocation*> sorted(pRelocs.size());
+  for (i = 0; i < keys.size(); ++i)
+    sorted[i] = pRelocs[keys[i].second];
+  pRelocs.swap(sorted);
+}
+
+bool FragmentLinker::isFused(const Relocation& pReloc) const
+{
+  return IsFused(m_Config, *m_Backend.getRelocator(), pReloc);
+}
+
+bool FragmentLinker::isCompressedTarget(const Relocation& pReloc)
+{
+  return pReloc.targetRef().frag()->getParent()->getSection().isCompressed();
+}
+
+void FragmentLinker::syncRelocationResult(MemoryArea& pOutput)
+{
+  // the relocations of a streamed partial link are not read at all
+  if (RelocationStreamer::IsEnabled(m_Config))
+    return;
 
+  // the writer has written the results of a streamed output. Do not touch
+  // the whole file again unless there are stubs in the branch islands.
+  if (IsStreamed(m_Config) && !m_Backend.getBRIslandFactory()->hasStubs())
+    return;
+
+  MemoryRegion* region = pOutput.request(0, pOutput.handler()->size());
   uint8_t* data = region->getBuffer();
 
-  // sync all relocations of all inputs
-  Module::obj_iterator input, inEnd = m_Module.obj_end();
-  for (input = m_Module.obj_begin(); input != inEnd; ++input) {
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      // bypass the reloc section if
-      // 1. its section kind is changed to Ignore. (The target section is a
-      // discarded group section.)
-      // 2. it has no reloc data. (All symbols in the input relocs are in the
-      // discarded group sections)
-      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
-        continue;
-      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
-      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
-        Relocation* relocation = llvm::cast<Relocation>(reloc);
+  // choose the writer of the byte order once for all relocations
+  bool swap =
+    (llvm::sys::isLittleEndianHost() != m_Config.targets().isLittleEndian());
+  if (LinkerConfig::Object != m_Config.codeGenType()) {
+    if (swap)
+      normalSyncRelocationResult<true>(data);
+    else
+      normalSyncRelocationResult<false>(data);
+  }
+  else {
+    if (swap)
+      partialSyncRelocationResult<true>(data);
+    else
+      partialSyncRelocationResult<false>(data);
+  }
 
-        // bypass the relocation with NONE type. This is to avoid overwrite the
-        // target result by NONE type relocation if there is a place which has
-        // two relocations to apply to, and one of it is NONE type. The result
-        // we want is the value of the other relocation result. For example,
-        // in .exidx, there are usually an R_ARM_NONE and R_ARM_PREL31 apply to
-        // the same place
-        if (0x0 == relocation->type())
+  pOutput.clear();
+}
+
+template<bool SWAP>
+void FragmentLinker::normalSyncRelocationResult(uint8_t* pData)
+{
+  // sync all relocations of all inputs. The fused relocations are applied
+  // right before they are written. If the output is streamed, the writer has
+  // written them along with their sections.
+  //
+  // The relocations are bucketed by their output sections, and written
+  // section by section in the order of the places, so the writes stream
+  // through the output instead of jumping around it in the order of the
+  // inputs.
+  Relocator& relocator = *m_Backend.getRelocator();
+  if (!IsStreamed(m_Config)) {
+    typedef std::map<const LDSection*, std::vector<Relocation*> > RelocMap;
+    RelocMap relocs;
+    Module::obj_iterator input, inEnd = m_Module.obj_end();
+    for (input = m_Module.obj_begin(); input != inEnd; ++input) {
+      LDContext::sect_iterator rs,
+                               rsEnd = (*input)->context()->relocSectEnd();
+      for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+        // bypass the reloc section if
+        // 1. its section kind is changed to Ignore. (The target section is a
+        // discarded group section.)
+        // 2. it has no reloc data. (All symbols in the input relocs are in
+        // the discarded group sections)
+        if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
           continue;
-        writeRelocationResult(*relocation, data);
-      } // for all relocations
-    } // for all relocation section
-  } // for all inputs
+        RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+        for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd;
+             ++reloc) {
+          Relocation* relocation = llvm::cast<Relocation>(reloc);
+
+          // bypass the relocation with NONE type. This is to avoid overwrite
+          // the target result by NONE type relocation if there is a place
+          // which has two relocations to apply to, and one of it is NONE
+          // type. The result we want is the value of the other relocation
+          // result. For example, in .exidx, there are usually an R_ARM_NONE
+          // and R_ARM_PREL31 apply to the same place
+          if (0x0 == relocation->type())
+            continue;
+
+          // the writer has written the result into the compressed image
+          if (isCompressedTarget(*relocation))
+            continue;
+          relocs[&relocation->targetRef().frag()->getParent()->getSection()]
+            .push_back(relocation);
+        } // for all relocations
+      } // for all relocation section
+    } // for all inputs
+
+    // the output sections are in the order of the file
+    std::vector<std::vector<Relocation*>*> lists;
+    Module::iterator sect, sectEnd = m_Module.end();
+    for (sect = m_Module.begin(); sect != sectEnd; ++sect) {
+      RelocMap::iterator entry = relocs.find(*sect);
+      if (relocs.end() != entry)
+        lists.push_back(&entry->second);
+    }
+    // the lists are moved out after being written, so a section which is not
+    // in the module is still written at the end
+    RelocMap::iterator entry, eEnd = relocs.end();
+    for (entry = relocs.begin(); entry != eEnd; ++entry)
+      lists.push_back(&entry->second);
+
+    for (size_t i = 0; i < lists.size(); ++i) {
+      std::vector<Relocation*> list;
+      list.swap(*lists[i]);
+      SortByPlace(list);
+      std::vector<Relocation*>::iterator reloc, rEnd = list.end();
+      for (reloc = list.begin(); reloc != rEnd; ++reloc) {
+        if (isFused(**reloc))
+          (*reloc)->apply(relocator);
+        writeRelocationResult<SWAP>(**reloc, pData);
+      }
+    }
+  }
 
   // sync relocations created by relaxation
   BranchIslandFactory* br_factory = m_Backend.getBRIslandFactory();
@@ -179,19 +450,14 @@ void FragmentLinker::normalSyncRelocationResult(MemoryArea& pOutput)
     BranchIsland::reloc_iterator iter, iterEnd = island.reloc_end();
     for (iter = island.reloc_begin(); iter != iterEnd; ++iter) {
       Relocation* reloc = *iter;
-      writeRelocationResult(*reloc, data);
+      writeRelocationResult<SWAP>(*reloc, pData);
     }
   }
-
-  pOutput.clear();
 }
 
-void FragmentLinker::partialSyncRelocationResult(MemoryArea& pOutput)
+template<bool SWAP>
+void FragmentLinker::partialSyncRelocationResult(uint8_t* pData)
 {
-  MemoryRegion* region = pOutput.request(0, pOutput.handler()->size());
-
-  uint8_t* data = region->getBuffer();
-
   // traverse outputs' LDSection to get RelocData
   Module::iterator sectIter, sectEnd = m_Module.end();
   for (sectIter = m_Module.begin(); sectIter != sectEnd; ++sectIter) {
@@ -211,13 +477,12 @@ void FragmentLinker::partialSyncRelocationResult(MemoryArea& pOutput)
       // the same place
       if (0x0 == reloc->type())
         continue;
-      writeRelocationResult(*reloc, data);
+      writeRelocationResult<SWAP>(*reloc, pData);
     }
   }
-
-  pOutput.clear();
 }
 
+template<bool SWAP>
 void FragmentLinker::writeRelocationResult(Relocation& pReloc, uint8_t* pOutput)
 {
   // get output file offset
@@ -226,36 +491,36 @@ void FragmentLinker::writeRelocationResult(Relocation& pReloc, uint8_t* pOutput)
                  pReloc.targetRef().getOutputOffset();
 
   uint8_t* target_addr = pOutput + out_offset;
-  // byte swapping if target and host has different endian, and then write back
-  if(llvm::sys::isLittleEndianHost() != m_Config.targets().isLittleEndian()) {
-     uint64_t tmp_data = 0;
-
-     switch(pReloc.size(*m_Backend.getRelocator())) {
-       case 8u:
-         std::memcpy(target_addr, &pReloc.target(), 1);
-         break;
-
-       case 16u:
-         tmp_data = mcld::bswap16(pReloc.target());
-         std::memcpy(target_addr, &tmp_data, 2);
-         break;
-
-       case 32u:
-         tmp_data = mcld::bswap32(pReloc.target());
-         std::memcpy(target_addr, &tmp_data, 4);
-         break;
-
-       case 64u:
-         tmp_data = mcld::bswap64(pReloc.target());
-         std::memcpy(target_addr, &tmp_data, 8);
-         break;
-
-       default:
-         break;
-    }
-  }
-  else
+  if (!SWAP) {
     std::memcpy(target_addr, &pReloc.target(),
                                       pReloc.size(*m_Backend.getRelocator())/8);
+    return;
+  }
+
+  // byte swapping if target and host has different endian, and then write back
+  uint64_t tmp_data = 0;
+  switch(pReloc.size(*m_Backend.getRelocator())) {
+    case 8u:
+      std::memcpy(target_addr, &pReloc.target(), 1);
+      break;
+
+    case 16u:
+      tmp_data = mcld::bswap16(pReloc.target());
+      std::memcpy(target_addr, &tmp_data, 2);
+      break;
+
+    case 32u:
+      tmp_data = mcld::bswap32(pReloc.target());
+      std::memcpy(target_addr, &tmp_data, 4);
+      break;
+
+    case 64u:
+      tmp_data = mcld::bswap64(pReloc.target());
+      std::memcpy(target_addr, &tmp_data, 8);
+      break;
+
+    default:
+      break;
+  }
 }
 
@@ -35,22 +35,35 @@ FragmentRef FragmentRef::g_NullFragmentRef;
 // FragmentRef
 //===----------------------------------------------------------------------===//
 FragmentRef::FragmentRef()
-  : m_pFragment(NULL), m_Offset(0) {
+{
+  setFragment(NULL, 0);
 }
 
 FragmentRef::FragmentRef(Fragment& pFrag,
                          FragmentRef::Offset pOffset)
-  : m_pFragment(&pFrag), m_Offset(pOffset) {
+{
+  setFragment(&pFrag, pOffset);
 }
 
-/// Create - create a fragment reference for a given fragment.
-///
-/// @param pFrag - the given fragment
-/// @param pOffset - the offset, can be larger than the fragment, but can not
-///                  be larger than the section size.
-/// @return if the offset is legal, return the fragment reference. Otherwise,
-/// return NULL.
-FragmentRef* FragmentRef::Create(Fragment& pFrag, uint64_t pOffset)
+#ifdef MCLD_COMPACT_IR
+Fragment* FragmentRef::getFragment() const
+{
+  return Fragment::Get(m_FragIndex);
+}
+
+void FragmentRef::setFragment(Fragment* pFrag, FragmentRef::Offset pOffset)
+{
+  assert(pOffset <= 0xffffffffu && "the offset does not fit in 32 bits");
+  m_FragIndex = (NULL == pFrag) ? 0 : pFrag->index();
+  m_Offset = pOffset;
+}
+#endif
+
+namespace { // anonymous
+
+/// Locate - find the fragment of pFrag[pOffset], and set pOffset to the offset
+/// in it. Return NULL if the offset runs past the last fragment.
+Fragment* Locate(Fragment& pFrag, uint64_t& pOffset)
 {
   int64_t offset = pOffset;
   Fragment* frag = &pFrag;
@@ -62,17 +75,14 @@ FragmentRef* FragmentRef::Create(Fragment& pFrag, uint64_t pOffset)
     frag = frag->getNextNode();
   }
 
-
-  if (NULL == frag)
-    return Null();
-
-  FragmentRef* result = g_FragRefFactory->allocate();
-  new (result) FragmentRef(*frag, offset + frag->size());
-
-  return result;
+  if (NULL != frag)
+    pOffset = offset + frag->size();
+  return frag;
 }
 
-FragmentRef* FragmentRef::Create(LDSection& pSection, uint64_t pOffset)
+/// GetSectionData - the SectionData which the fragment references of
+/// pSection refer to
+SectionData* GetSectionData(LDSection& pSection)
 {
   SectionData* data = NULL;
   switch (pSection.kind()) {
@@ -88,9 +98,37 @@ FragmentRef* FragmentRef::Create(LDSection& pSection, uint64_t pOffset)
       break;
   }
 
-  if (NULL == data || data->empty()) {
+  if (NULL == data || data->empty())
+    return NULL;
+  return data;
+}
+
+} // anonymous namespace
+
+/// Create - create a fragment reference for a given fragment.
+///
+/// @param pFrag - the given fragment
+/// @param pOffset - the offset, can be larger than the fragment, but can not
+///                  be larger than the section size.
+/// @return if the offset is legal, return the fragment reference. Otherwise,
+/// return NULL.
+FragmentRef* FragmentRef::Create(Fragment& pFrag, uint64_t pOffset)
+{
+  Fragment* frag = Locate(pFrag, pOffset);
+  if (NULL == frag)
+    return Null();
+
+  FragmentRef* result = g_FragRefFactory->allocate();
+  new (result) FragmentRef(*frag, pOffset);
+
+  return result;
+}
+
+FragmentRef* FragmentRef::Create(LDSection& pSection, uint64_t pOffset)
+{
+  SectionData* data = GetSectionData(pSection);
+  if (NULL == data)
     return Null();
-  }
 
   return Create(data->front(), pOffset);
 }
@@ -107,27 +145,37 @@ FragmentRef* FragmentRef::Null()
 
 FragmentRef& FragmentRef::assign(const FragmentRef& pCopy)
 {
-  m_pFragment = const_cast<Fragment*>(pCopy.m_pFragment);
-  m_Offset = pCopy.m_Offset;
+  setFragment(pCopy.getFragment(), pCopy.m_Offset);
   return *this;
 }
 
 FragmentRef& FragmentRef::assign(Fragment& pFrag, FragmentRef::Offset pOffset)
 {
-  m_pFragment = &pFrag;
-  m_Offset = pOffset;
+  setFragment(&pFrag, pOffset);
+  return *this;
+}
+
+FragmentRef& FragmentRef::assign(LDSection& pSection, FragmentRef::Offset pOffset)
+{
+  SectionData* data = GetSectionData(pSection);
+  Fragment* frag = (NULL == data) ? NULL : Locate(data->front(), pOffset);
+  if (NULL == frag)
+    reset();
+  else
+    setFragment(frag, pOffset);
   return *this;
 }
 
 void FragmentRef::memcpy(void* pDest, size_t pNBytes, Offset pOffset) const
 {
   // check if the offset is still in a legal range.
-  if (NULL == m_pFragment)
+  Fragment* fragment = getFragment();
+  if (NULL == fragment)
     return;
   unsigned int total_offset = m_Offset + pOffset;
-  switch(m_pFragment->getKind()) {
+  switch(fragment->getKind()) {
     case Fragment::Region: {
-      RegionFragment* region_frag = static_cast<RegionFragment*>(m_pFragment);
+      RegionFragment* region_frag = static_cast<RegionFragment*>(fragment);
       unsigned int total_length = region_frag->getRegion().size();
       if (total_length < (total_offset+pNBytes))
         pNBytes = total_length - total_offset;
@@ -136,7 +184,7 @@ void FragmentRef::memcpy(void* pDest, size_t pNBytes, Offset pOffset) const
       return;
     }
     case Fragment::Stub: {
-      Stub* stub_frag = static_cast<Stub*>(m_pFragment);
+      Stub* stub_frag = static_cast<Stub*>(fragment);
       unsigned int total_length = stub_frag->size();
       if (total_length < (total_offset+pNBytes))
         pNBytes = total_length - total_offset;
@@ -152,12 +200,13 @@ void FragmentRef::memcpy(void* pDest, size_t pNBytes, Offset pOffset) const
 
 FragmentRef::Address FragmentRef::deref()
 {
-  if (NULL == m_pFragment)
+  Fragment* fragment = getFragment();
+  if (NULL == fragment)
     return NULL;
   Address base = NULL;
-  switch(m_pFragment->getKind()) {
+  switch(fragment->getKind()) {
     case Fragment::Region:
-      base = static_cast<RegionFragment*>(m_pFragment)->getRegion().getBuffer();
+      base = static_cast<RegionFragment*>(fragment)->getRegion().getBuffer();
       break;
     case Fragment::Alignment:
     case Fragment::Fillment:
@@ -169,12 +218,13 @@ FragmentRef::Address FragmentRef::deref()
 
 FragmentRef::ConstAddress FragmentRef::deref() const
 {
-  if (NULL == m_pFragment)
+  Fragment* fragment = getFragment();
+  if (NULL == fragment)
     return NULL;
   ConstAddress base = NULL;
-  switch(m_pFragment->getKind()) {
+  switch(fragment->getKind()) {
     case Fragment::Region:
-      base = static_cast<const RegionFragment*>(m_pFragment)->getRegion().getBuffer();
+      base = static_cast<const RegionFragment*>(fragment)->getRegion().getBuffer();
       break;
     case Fragment::Alignment:
     case Fragment::Fillment:
@@ -187,8 +237,9 @@ FragmentRef::ConstAddress FragmentRef::deref() const
 FragmentRef::Offset FragmentRef::getOutputOffset() const
 {
   Offset result = 0;
-  if (NULL != m_pFragment)
-    result = m_pFragment->getOffset();
+  Fragment* fragment = getFragment();
+  if (NULL != fragment)
+    result = fragment->getOffset();
   return (result + m_Offset);
 }
 
@@ -12,34 +12,57 @@
 #include <mcld/LD/LDSymbol.h>
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/SectionData.h>
+#include <mcld/Support/LinkContext.h>
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/LD/RelocationFactory.h>
 
 #include <llvm/Support/ManagedStatic.h>
 
+#include <vector>
+
 using namespace mcld;
 
-static llvm::ManagedStatic<RelocationFactory> g_RelocationFactory;
+namespace {
+
+/// Finalized - the place and the symbol value of a finalized relocation. The
+/// records are kept in the order of finalize(), which is the order the
+/// relocations are applied.
+struct Finalized
+{
+  Relocation::Address place;
+  Relocation::Address symValue;
+};
+
+/// GetFactory - the relocation factory of the current link
+inline RelocationFactory& GetFactory()
+{
+  return LinkContext::Current().getRelocationFactory();
+}
+
+} // anonymous namespace
+
+static llvm::ManagedStatic<std::vector<Finalized> > g_Finalized;
 
 //===----------------------------------------------------------------------===//
 // Relocation Factory Methods
 //===----------------------------------------------------------------------===//
-/// Initialize - set up the relocation factory
+/// SetUp - set up the relocation factory of the current link
 void Relocation::SetUp(const LinkerConfig& pConfig)
 {
-  g_RelocationFactory->setConfig(pConfig);
+  GetFactory().setConfig(pConfig);
 }
 
-/// Clear - Clean up the relocation factory
+/// Clear - Clean up the relocation factory of the current link
 void Relocation::Clear()
 {
-  g_RelocationFactory->clear();
+  GetFactory().clear();
+  ClearFinalized();
 }
 
 /// Create - produce an empty relocation entry
 Relocation* Relocation::Create()
 {
-  return g_RelocationFactory->produceEmptyEntry();
+  return GetFactory().produceEmptyEntry();
 }
 
 /// Create - produce a relocation entry
@@ -48,47 +71,77 @@ Relocation* Relocation::Create()
 /// @param pAddend  [in] the addend of the relocation entry
 Relocation* Relocation::Create(Type pType, FragmentRef& pFragRef, Address pAddend)
 {
-  return g_RelocationFactory->produce(pType, pFragRef, pAddend);
+  return GetFactory().produce(pType, pFragRef, pAddend);
+}
+
+/// Create - produce a relocation entry applied to pFrag[pOffset]
+Relocation* Relocation::Create(Type pType, Fragment& pFrag, uint64_t pOffset,
+                               Address pAddend)
+{
+  // the relocation keeps a copy of the place. No need to allocate one.
+  FragmentRef place(pFrag, pOffset);
+  return GetFactory().produce(pType, place, pAddend);
 }
 
 /// Destroy - destroy a relocation entry
 void Relocation::Destroy(Relocation*& pRelocation)
 {
-  g_RelocationFactory->destroy(pRelocation);
+  GetFactory().destroy(pRelocation);
   pRelocation = NULL;
 }
 
+/// ClearFinalized - forget the records of finalize()
+void Relocation::ClearFinalized()
+{
+  std::vector<Finalized>().swap(*g_Finalized);
+}
+
 //===----------------------------------------------------------------------===//
 // Relocation
 //===----------------------------------------------------------------------===//
 Relocation::Relocation()
-  : m_Type(0x0), m_TargetData(0x0), m_pSymInfo(NULL), m_Addend(0x0) {
+  : m_TargetData(0x0),
+    m_pSymInfo(NULL),
+    m_Addend(0x0),
+    m_Finalized(0),
+    m_Type(0x0) {
 }
 
 Relocation::Relocation(Relocation::Type pType,
                        FragmentRef* pTargetRef,
                        Relocation::Address pAddend,
                        Relocation::DWord pTargetData)
-  : m_Type(pType),
-    m_TargetData(pTargetData),
+  : m_TargetData(pTargetData),
     m_pSymInfo(NULL),
-    m_Addend(pAddend)
+    m_Addend(pAddend),
+    m_Finalized(0),
+    m_Type(pType)
 {
   if(NULL != pTargetRef)
      m_TargetAddress.assign(*pTargetRef->frag(), pTargetRef->offset()) ;
 }
 
-Relocation::~Relocation()
+Relocation::Address Relocation::place() const
 {
+  if (0 != m_Finalized)
+    return (*g_Finalized)[m_Finalized - 1].place;
+  return computePlace();
 }
 
-Relocation::Address Relocation::place() const
+Relocation::Address Relocation::symValue() const
+{
+  if (0 != m_Finalized)
+    return (*g_Finalized)[m_Finalized - 1].symValue;
+  return computeSymValue();
+}
+
+Relocation::Address Relocation::computePlace() const
 {
   Address sect_addr = m_TargetAddress.frag()->getParent()->getSection().addr();
   return sect_addr + m_TargetAddress.getOutputOffset();
 }
 
-Relocation::Address Relocation::symValue() const
+Relocation::Address Relocation::computeSymValue() const
 {
   if (m_pSymInfo->type() == ResolveInfo::Section &&
      m_pSymInfo->outSymbol()->hasFragRef()) {
@@ -97,35 +150,24 @@ Relocation::Address Relocation::symValue() const
   return m_pSymInfo->outSymbol()->value();
 }
 
-void Relocation::apply(Relocator& pRelocator)
+void Relocation::finalize()
 {
-  Relocator::Result result = pRelocator.applyRelocation(*this);
-
-  switch (result) {
-    case Relocator::OK: {
-      // do nothing
-      return;
-    }
-    case Relocator::Overflow: {
-      error(diag::result_overflow) << pRelocator.getName(type())
-                                   << symInfo()->name();
+  // the index is kept in 32 bits. The relocations beyond are not recorded.
+  std::vector<Finalized>& records = *g_Finalized;
+  if (0 == m_Finalized) {
+    if (records.size() >= 0xffffffffu)
       return;
-    }
-    case Relocator::BadReloc: {
-      error(diag::result_badreloc) << pRelocator.getName(type())
-                                   << symInfo()->name();
-      return;
-    }
-    case Relocator::Unsupport: {
-      fatal(diag::unsupported_relocation) << type()
-                                          << "mclinker@googlegroups.com";
-      return;
-    }
-    case Relocator::Unknown: {
-      fatal(diag::unknown_relocation) << type() << symInfo()->name();
-      return;
-    }
-  } // end of switch
+    records.push_back(Finalized());
+    m_Finalized = records.size();
+  }
+  Finalized& record = records[m_Finalized - 1];
+  record.place = computePlace();
+  record.symValue = (NULL == m_pSymInfo) ? 0x0 : computeSymValue();
+}
+
+void Relocation::apply(Relocator& pRelocator)
+{
+  pRelocator.report(*this, pRelocator.applyRelocation(*this));
 }
 
 void Relocation::setType(Type pType)
@@ -141,6 +183,9 @@ void Relocation::setAddend(Address pAddend)
 void Relocation::setSymInfo(ResolveInfo* pSym)
 {
   m_pSymInfo = pSym;
+  // the record follows the symbol
+  if (0 != m_Finalized)
+    (*g_Finalized)[m_Finalized - 1].symValue = computeSymValue();
 }
 
 Relocation::Size Relocation::size(Relocator& pRelocator) const
@@ -6,41 +6,68 @@ LOCAL_PATH:= $(call my-dir)
 
 mcld_ld_SRC_FILES := \
   Archive.cpp \
+  ArchiveIndexCache.cpp \
   ArchiveReader.cpp \
   BranchIsland.cpp  \
   BranchIslandFactory.cpp  \
+  CallGraphOrdering.cpp \
+  CommonBuckets.cpp \
+  CompressedSections.cpp \
   DWARFLineInfo.cpp \
+  DeterminismVerifier.cpp \
   Diagnostic.cpp  \
   DiagnosticEngine.cpp  \
   DiagnosticInfos.cpp \
   DiagnosticLineInfo.cpp  \
   DiagnosticPrinter.cpp \
   DynObjReader.cpp  \
+  DynObjSummary.cpp \
   ELFBinaryReader.cpp  \
   ELFSegment.cpp  \
   ELFSegmentFactory.cpp \
   EhFrame.cpp \
   EhFrameHdr.cpp  \
+  EhFrameOptimizer.cpp \
   EhFrameReader.cpp  \
+  ExportFilter.cpp \
+  FragmentIndex.cpp \
+  GarbageCollection.cpp \
+  GdbIndex.cpp \
   GroupReader.cpp \
+  GroupSignatureSet.cpp \
+  IdenticalCodeFolding.cpp \
+  IncrementalLink.cpp \
   LDContext.cpp \
   LDFileFormat.cpp  \
   LDReader.cpp  \
   LDSection.cpp \
   LDSymbol.cpp  \
+  LinkCache.cpp \
+  MergeableSections.cpp \
   MsgHandler.cpp  \
   NamePool.cpp  \
+  ObjectSummary.cpp \
   ObjectWriter.cpp  \
+  PackedRelocData.cpp \
+  PrelinkMap.cpp \
   RelocData.cpp  \
+  RelocationBatch.cpp \
   RelocationFactory.cpp \
+  RelocationStreamer.cpp \
   Relocator.cpp \
   ResolveInfo.cpp \
+  ResolveInfoFactory.cpp \
   Resolver.cpp  \
+  SectionAtom.cpp \
   SectionData.cpp \
   SectionRules.cpp \
   SectionSymbolSet.cpp \
+  SeparateDebugFile.cpp \
+  SmallDataOrdering.cpp \
   StaticResolver.cpp  \
+  StringTable.cpp \
   StubFactory.cpp  \
+  SymbolOrdering.cpp \
   TextDiagnosticPrinter.cpp
 
 # For the host
@@ -76,6 +103,7 @@ mcld_ld_variant_SRC_FILES := \
   GNUArchiveReader.cpp  \
   ELFDynObjFileFormat.cpp \
   ELFDynObjReader.cpp \
+  ELFDynSymbolIndex.cpp \
   ELFExecFileFormat.cpp \
   ELFFileFormat.cpp \
   ELFObjectReader.cpp \
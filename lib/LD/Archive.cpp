@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/Archive.h>
+#include <mcld/LD/ArchiveIndexCache.h>
 #include <mcld/MC/InputBuilder.h>
 #include <mcld/MC/MCLDInput.h>
 #include <mcld/MC/AttributeSet.h>
@@ -19,18 +20,22 @@ using namespace mcld;
 
 //===----------------------------------------------------------------------===//
 // Archive
-const char   Archive::MAGIC[]            = "!<arch>\n";
-const char   Archive::THIN_MAGIC[]       = "!<thin>\n";
-const size_t Archive::MAGIC_LEN          = sizeof(Archive::MAGIC) - 1;
-const char   Archive::SVR4_SYMTAB_NAME[] = "/               ";
-const char   Archive::STRTAB_NAME[]      = "//              ";
-const char   Archive::PAD[]              = "\n";
-const char   Archive::MEMBER_MAGIC[]     = "`\n";
+const char   Archive::MAGIC[]             = "!<arch>\n";
+const char   Archive::THIN_MAGIC[]        = "!<thin>\n";
+const size_t Archive::MAGIC_LEN           = sizeof(Archive::MAGIC) - 1;
+const char   Archive::SVR4_SYMTAB_NAME[]  = "/               ";
+const char   Archive::SYM64_SYMTAB_NAME[] = "/SYM64/         ";
+const char   Archive::STRTAB_NAME[]       = "//              ";
+const char   Archive::PAD[]               = "\n";
+const char   Archive::MEMBER_MAGIC[]      = "`\n";
 
 Archive::Archive(Input& pInputFile, InputBuilder& pBuilder)
  : m_ArchiveFile(pInputFile),
    m_pInputTree(NULL),
    m_SymbolFactory(32),
+   m_pIndex(NULL),
+   m_UndefCursor(0),
+   m_SymTabSize(0),
    m_Builder(pBuilder)
 {
   // FIXME: move creation of input tree out of Archive.
@@ -87,7 +92,7 @@ size_t Archive::numOfObjectMember() const
 /// addObjectMember - add a object in the object member map
 /// @param pFileOffset - file offset in symtab represents a object file
 /// @param pIter - the iterator in the input tree built from this archive
-bool Archive::addObjectMember(uint32_t pFileOffset, InputTree::iterator pIter)
+bool Archive::addObjectMember(uint64_t pFileOffset, InputTree::iterator pIter)
 {
   bool exist;
   ObjectMemberEntryType* entry = m_ObjectMemberMap.insert(pFileOffset, exist);
@@ -98,7 +103,7 @@ bool Archive::addObjectMember(uint32_t pFileOffset, InputTree::iterator pIter)
 
 /// hasObjectMember - check if a object file is included or not
 /// @param pFileOffset - file offset in symtab represents a object file
-bool Archive::hasObjectMember(uint32_t pFileOffset) const
+bool Archive::hasObjectMember(uint64_t pFileOffset) const
 {
   return (m_ObjectMemberMap.find(pFileOffset) != m_ObjectMemberMap.end());
 }
@@ -181,6 +186,8 @@ size_t Archive::getSymTabSize() const
 /// numOfSymbols - return the number of symbols in symtab
 size_t Archive::numOfSymbols() const
 {
+  if (hasIndex())
+    return m_pIndex->numOfSymbols();
   return m_SymTab.size();
 }
 
@@ -188,25 +195,52 @@ size_t Archive::numOfSymbols() const
 /// @param pName - symbol name
 /// @param pFileOffset - file offset in symtab represents a object file
 void Archive::addSymbol(const char* pName,
-                        uint32_t pFileOffset,
+                        uint64_t pFileOffset,
                         enum Archive::Symbol::Status pStatus)
 {
   Symbol* entry = m_SymbolFactory.allocate();
   new (entry) Symbol(pName, pFileOffset, pStatus);
   m_SymTab.push_back(entry);
+
+  // index the name by the first entry. Symbols never move in the factory, so
+  // the key can refer to the name of the entry.
+  bool exist;
+  SymbolIndexEntryType* index = m_SymbolIndexMap.insert(entry->name, exist);
+  if (!exist)
+    index->setValue(m_SymTab.size() - 1);
+}
+
+/// findSymbol - the index of the first armap entry named pName
+size_t Archive::findSymbol(const llvm::StringRef& pName) const
+{
+  if (hasIndex()) {
+    size_t idx;
+    if (!m_pIndex->findSymbol(pName, idx))
+      return kNoSymbol;
+    return idx;
+  }
+
+  SymbolIndexMapType::const_iterator it = m_SymbolIndexMap.find(pName);
+  if (it == m_SymbolIndexMap.end())
+    return kNoSymbol;
+  return it.getEntry()->value();
 }
 
 /// getSymbolName - get the symbol name with the given index
-const std::string& Archive::getSymbolName(size_t pSymIdx) const
+llvm::StringRef Archive::getSymbolName(size_t pSymIdx) const
 {
   assert(pSymIdx < numOfSymbols());
+  if (hasIndex())
+    return m_pIndex->getSymbolName(pSymIdx);
   return m_SymTab[pSymIdx]->name;
 }
 
 /// getObjFileOffset - get the file offset that represent a object file
-uint32_t Archive::getObjFileOffset(size_t pSymIdx) const
+uint64_t Archive::getObjFileOffset(size_t pSymIdx) const
 {
   assert(pSymIdx < numOfSymbols());
+  if (hasIndex())
+    return m_pIndex->getObjFileOffset(pSymIdx);
   return m_SymTab[pSymIdx]->fileOffset;
 }
 
@@ -214,6 +248,8 @@ uint32_t Archive::getObjFileOffset(size_t pSymIdx) const
 enum Archive::Symbol::Status Archive::getSymbolStatus(size_t pSymIdx) const
 {
   assert(pSymIdx < numOfSymbols());
+  if (hasIndex())
+    return m_IndexStatus[pSymIdx];
   return m_SymTab[pSymIdx]->status;
 }
 
@@ -222,7 +258,32 @@ void Archive::setSymbolStatus(size_t pSymIdx,
                               enum Archive::Symbol::Status pStatus)
 {
   assert(pSymIdx < numOfSymbols());
-  m_SymTab[pSymIdx]->status = pStatus;
+  if (hasIndex())
+    m_IndexStatus[pSymIdx] = pStatus;
+  else
+    m_SymTab[pSymIdx]->status = pStatus;
+}
+
+/// setIndex - use a cached armap index as the symtab
+void Archive::setIndex(const ArchiveIndex& pIndex)
+{
+  assert(m_SymTab.empty());
+  m_pIndex = &pIndex;
+  m_IndexStatus.assign(pIndex.numOfSymbols(), Symbol::Unknown);
+  m_SymTabSize = pIndex.getSymTabSize();
+  m_StrTab.assign(pIndex.getStrTable().data(), pIndex.getStrTable().size());
+}
+
+/// getUndefCursor - the number of the looked up undefined symbols
+size_t Archive::getUndefCursor() const
+{
+  return m_UndefCursor;
+}
+
+/// setUndefCursor - set the number of the looked up undefined symbols
+void Archive::setUndefCursor(size_t pCursor)
+{
+  m_UndefCursor = pCursor;
 }
 
 /// getStrTable - get the extended name table
@@ -275,3 +336,11 @@ Input* Archive::getMemberFile(Input& pArchiveFile,
   return member;
 }
 
+/// openMemberFiles - open the files of the members of a thin archive
+/// concurrently
+void Archive::openMemberFiles(ThreadPool& pPool,
+                              const std::vector<sys::fs::Path>& pPaths)
+{
+  m_Builder.openMemory(pPool, pPaths, FileHandle::ReadOnly);
+}
+
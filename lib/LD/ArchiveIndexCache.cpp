@@ -0,0 +1,301 @@
+//===- ArchiveIndexCache.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ArchiveIndexCache.h>
+
+#include <mcld/ADT/StringHash.h>
+#include <mcld/LD/Archive.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/RealPath.h>
+#include <mcld/Support/SystemUtils.h>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstring>
+
+using namespace mcld;
+
+static const uint32_t kByteOrder = 0x01020304;
+
+/// align8 - the offset of the next 8-byte aligned field
+static inline size_t align8(size_t pOffset)
+{
+  return (pOffset + 7) & ~static_cast<size_t>(7);
+}
+
+//===----------------------------------------------------------------------===//
+// ArchiveIndex
+//===----------------------------------------------------------------------===//
+const char ArchiveIndex::MAGIC[] = "MCLDAIX3";
+
+ArchiveIndex::ArchiveIndex()
+  : m_pHeader(NULL), m_pPath(NULL), m_pEntries(NULL), m_pBuckets(NULL),
+    m_pStrTab(NULL), m_pNames(NULL) {
+}
+
+bool ArchiveIndex::map(const void* pImage, size_t pSize)
+{
+  if (pSize < sizeof(Header))
+    return false;
+
+  const char* image = reinterpret_cast<const char*>(pImage);
+  const Header* header = reinterpret_cast<const Header*>(image);
+  if (0 != memcmp(header->magic, MAGIC, sizeof(header->magic)) ||
+      kByteOrder != header->byte_order)
+    return false;
+
+  // check the bound of every part before looking into it
+  uint64_t entries = align8(sizeof(Header) + header->path_size);
+  uint64_t buckets = entries +
+                     static_cast<uint64_t>(header->num_of_symbols) *
+                     sizeof(Entry);
+  uint64_t strtab = buckets +
+                    static_cast<uint64_t>(header->num_of_buckets) *
+                    sizeof(uint32_t);
+  uint64_t names = strtab + header->strtab_size;
+  if (names >= pSize || '\0' != image[pSize - 1])
+    return false;
+
+  if (0 != header->num_of_symbols &&
+      header->num_of_buckets <= header->num_of_symbols)
+    return false;
+
+  const Entry* entry = reinterpret_cast<const Entry*>(image + entries);
+  for (uint32_t i = 0; i < header->num_of_symbols; ++i) {
+    if (entry[i].name >= pSize - names)
+      return false;
+  }
+
+  const uint32_t* bucket = reinterpret_cast<const uint32_t*>(image + buckets);
+  for (uint32_t i = 0; i < header->num_of_buckets; ++i) {
+    if (bucket[i] > header->num_of_symbols)
+      return false;
+  }
+
+  m_pHeader  = header;
+  m_pPath    = image + sizeof(Header);
+  m_pEntries = entry;
+  m_pBuckets = bucket;
+  m_pStrTab  = image + strtab;
+  m_pNames   = image + names;
+  return true;
+}
+
+bool ArchiveIndex::findSymbol(const llvm::StringRef& pName, size_t& pIdx) const
+{
+  if (0 == m_pHeader->num_of_buckets)
+    return false;
+
+  StringHash<ELF> hash_func;
+  uint32_t bucket = hash_func(pName) % m_pHeader->num_of_buckets;
+  while (0 != m_pBuckets[bucket]) {
+    size_t idx = m_pBuckets[bucket] - 1;
+    if (pName == getSymbolName(idx)) {
+      pIdx = idx;
+      return true;
+    }
+    if (++bucket == m_pHeader->num_of_buckets)
+      bucket = 0;
+  }
+  return false;
+}
+
+void ArchiveIndex::emit(const Archive& pArchive,
+                        const llvm::StringRef& pPath,
+                        uint64_t pFileSize,
+                        uint64_t pModTime,
+                        std::string& pImage)
+{
+  // keep the fan-out of the hash table under one half
+  uint32_t num_of_symbols = pArchive.numOfSymbols();
+  uint32_t num_of_buckets = 0;
+  if (0 != num_of_symbols)
+    num_of_buckets = 2 * num_of_symbols + 1;
+
+  Header header;
+  memcpy(header.magic, MAGIC, sizeof(header.magic));
+  header.byte_order     = kByteOrder;
+  header.num_of_symbols = num_of_symbols;
+  header.num_of_buckets = num_of_buckets;
+  header.symtab_size    = pArchive.getSymTabSize();
+  header.strtab_size    = pArchive.getStrTable().size();
+  header.path_size      = pPath.size();
+  header.file_size      = pFileSize;
+  header.mod_time       = pModTime;
+
+  std::vector<Entry> entries(num_of_symbols);
+  std::vector<uint32_t> buckets(num_of_buckets, 0x0);
+  std::string names;
+  StringHash<ELF> hash_func;
+  for (uint32_t i = 0; i < num_of_symbols; ++i) {
+    llvm::StringRef name = pArchive.getSymbolName(i);
+    entries[i].name = names.size();
+    entries[i].file_offset = pArchive.getObjFileOffset(i);
+    names.append(name.data(), name.size());
+    names.push_back('\0');
+
+    // only the first symbol of a name can be found
+    if (i != pArchive.findSymbol(name))
+      continue;
+    uint32_t bucket = hash_func(name) % num_of_buckets;
+    while (0 != buckets[bucket]) {
+      if (++bucket == num_of_buckets)
+        bucket = 0;
+    }
+    buckets[bucket] = i + 1;
+  }
+  // the image always ends with a NUL
+  names.push_back('\0');
+
+  pImage.assign(reinterpret_cast<const char*>(&header), sizeof(Header));
+  pImage.append(pPath.data(), pPath.size());
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!entries.empty())
+    pImage.append(reinterpret_cast<const char*>(&entries[0]),
+                  entries.size() * sizeof(Entry));
+  if (!buckets.empty())
+    pImage.append(reinterpret_cast<const char*>(&buckets[0]),
+                  buckets.size() * sizeof(uint32_t));
+  pImage.append(pArchive.getStrTable());
+  pImage.append(names);
+}
+
+//===----------------------------------------------------------------------===//
+// ArchiveIndexCache
+//===----------------------------------------------------------------------===//
+ArchiveIndexCache::ArchiveIndexCache(const sys::fs::Path& pDir)
+  : m_Dir(pDir) {
+}
+
+ArchiveIndexCache::~ArchiveIndexCache()
+{
+  IndexListType::iterator it, itEnd = m_IndexList.end();
+  for (it = m_IndexList.begin(); it != itEnd; ++it) {
+    (*it)->handle->munmap((*it)->image, (*it)->handle->size());
+    (*it)->handle->close();
+    delete (*it)->handle;
+    delete *it;
+  }
+}
+
+bool ArchiveIndexCache::getKey(const Archive& pArchive,
+                               sys::fs::Path& pPath,
+                               uint64_t& pFileSize,
+                               uint64_t& pModTime) const
+{
+  // only the archives that are files by themselves are cached
+  const Input& ar_file = pArchive.getARFile();
+  if (0 != ar_file.fileOffset() || !ar_file.hasMemArea() ||
+      NULL == ar_file.memArea()->handler())
+    return false;
+
+  sys::fs::FileID id;
+  sys::fs::cached::file_id(ar_file.path(), id);
+  if (!id.isValid())
+    return false;
+
+  pPath = sys::fs::RealPath(ar_file.path());
+  pFileSize = ar_file.memArea()->handler()->size();
+  pModTime = id.modTime();
+  return true;
+}
+
+sys::fs::Path
+ArchiveIndexCache::getCachePath(const sys::fs::Path& pPath) const
+{
+  StringHash<ELF> hash_func;
+  std::string name;
+  llvm::raw_string_ostream os(name);
+  os << pPath.filename().native() << '-';
+  os.write_hex(hash_func(pPath.native()));
+  os << ".armap";
+  os.flush();
+
+  sys::fs::Path result(m_Dir);
+  result.append(name);
+  return result;
+}
+
+bool ArchiveIndexCache::load(Archive& pArchive)
+{
+  sys::fs::Path path;
+  uint64_t file_size, mod_time;
+  if (!getKey(pArchive, path, file_size, mod_time))
+    return false;
+
+  FileHandle* handle = new FileHandle();
+  void* image = NULL;
+  if (!handle->open(getCachePath(path), FileHandle::ReadOnly) ||
+      0 == handle->size() ||
+      !handle->mmap(image, 0, handle->size())) {
+    delete handle;
+    return false;
+  }
+
+  MappedIndex* mapped = new MappedIndex();
+  mapped->handle = handle;
+  mapped->image = image;
+  if (!mapped->index.map(image, handle->size()) ||
+      mapped->index.getPath() != llvm::StringRef(path.native()) ||
+      mapped->index.getFileSize() != file_size ||
+      mapped->index.getModTime() != mod_time) {
+    // a stale or broken index. It is replaced by store().
+    handle->munmap(image, handle->size());
+    delete handle;
+    delete mapped;
+    return false;
+  }
+
+  m_IndexList.push_back(mapped);
+  pArchive.setIndex(mapped->index);
+  return true;
+}
+
+bool ArchiveIndexCache::store(const Archive& pArchive)
+{
+  sys::fs::Path path;
+  uint64_t file_size, mod_time;
+  if (!getKey(pArchive, path, file_size, mod_time))
+    return false;
+
+  std::string image;
+  ArchiveIndex::emit(pArchive, path.native(), file_size, mod_time, image);
+
+  // write a temporary file of this process, and rename it to the cache file
+  sys::fs::Path cache_path = getCachePath(path);
+  std::string tmp_name;
+  llvm::raw_string_ostream os(tmp_name);
+  os << cache_path.native() << '.' << sys::getpid() << ".tmp";
+  os.flush();
+  sys::fs::Path tmp_path(tmp_name);
+
+  FileHandle tmp;
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  if (!tmp.open(tmp_path, mode, perm)) {
+    debug(diag::debug_cannot_write_archive_index) << cache_path;
+    return false;
+  }
+
+  bool result = tmp.write(image.data(), 0, image.size());
+  result = tmp.close() && result;
+  if (result)
+    result = (0 == sys::fs::detail::rename(tmp_path, cache_path));
+
+  if (!result) {
+    sys::fs::detail::unlink(tmp_path);
+    debug(diag::debug_cannot_write_archive_index) << cache_path;
+  }
+  return result;
+}
+
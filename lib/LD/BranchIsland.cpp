@@ -125,6 +125,7 @@ bool BranchIsland::addStub(const Stub* pPrototype,
                                                   0x0,
                                                   1u,
                                                   pStub.alignment() - 1);
+    align_frag->setEmitNops(true);
     align_frag->setParent(sd);
     sd->getFragmentList().insert(end(), align_frag);
     align_frag->setOffset(align_frag->getPrevNode()->getOffset() +
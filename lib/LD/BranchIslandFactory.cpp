@@ -8,6 +8,9 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/BranchIslandFactory.h>
 #include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/LinkStats.h>
 
 using namespace mcld;
 
@@ -68,6 +71,8 @@ BranchIsland* BranchIslandFactory::produce(Fragment& pFragment)
   new (island) BranchIsland(*frag,           // entry fragment to the island
                             m_MaxIslandSize, // the max size of the island
                             size() - 1u);     // index in the island factory
+  if (LinkStats::isEnabled())
+    LinkStats::Add(LinkStats::BranchIslands);
   return island;
 }
 
@@ -85,3 +90,68 @@ BranchIsland* BranchIslandFactory::find(const Fragment& pFragment)
   return NULL;
 }
 
+/// findStub - find a stub built from pPrototype for pReloc in any island
+/// within the branch range of pReloc
+Stub* BranchIslandFactory::findStub(const Stub* pPrototype,
+                                    const Relocation& pReloc,
+                                    uint64_t pBranchRange)
+{
+  const Fragment* frag = pReloc.targetRef().frag();
+  uint64_t source = frag->getOffset() + pReloc.targetRef().offset();
+  for (iterator it = begin(), ie = end(); it != ie; ++it) {
+    BranchIsland& island = *it;
+    if (0x0 == island.numOfStubs() ||
+        island.begin()->getParent() != frag->getParent())
+      continue;
+
+    // the whole island should be in the range
+    uint64_t distance = 0x0;
+    if (island.offset() > source)
+      distance = island.offset() + island.size() - source;
+    else
+      distance = source - island.offset();
+    if (distance > pBranchRange)
+      continue;
+
+    Stub* stub = island.findStub(pPrototype, pReloc);
+    if (NULL != stub)
+      return stub;
+  }
+  return NULL;
+}
+
+/// plan - produce the islands of pSD at the end of every interval of the
+/// branch range
+size_t BranchIslandFactory::plan(SectionData& pSD)
+{
+  if (pSD.empty())
+    return 0;
+
+  uint64_t size = pSD.back().getOffset() + pSD.back().size();
+  size_t num = 0;
+  SectionData::iterator frag = pSD.begin(), fragEnd = pSD.end();
+  for (uint64_t start = 0; start + m_MaxBranchRange < size;
+       start += m_MaxBranchRange) {
+    // the first fragment in [start, start + m_MaxBranchRange)
+    while (frag != fragEnd && frag->getOffset() < start)
+      ++frag;
+    if (frag == fragEnd)
+      break;
+    if (frag->getOffset() >= start + m_MaxBranchRange)
+      continue;
+
+    if (NULL == find(*frag) && NULL != produce(*frag))
+      ++num;
+  }
+  return num;
+}
+
+/// hasStubs - is there any stub in the islands?
+bool BranchIslandFactory::hasStubs() const
+{
+  for (const_iterator it = begin(), ie = end(); it != ie; ++it) {
+    if (0x0 != (*it).numOfStubs())
+      return true;
+  }
+  return false;
+}
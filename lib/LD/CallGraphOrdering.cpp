@@ -0,0 +1,359 @@
+//===- CallGraphOrdering.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/CallGraphOrdering.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/FGEdge.h>
+#include <mcld/Fragment/FGNode.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentGraph.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/NamePool.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/Path.h>
+
+#include <llvm/Support/ELF.h>
+
+#include <algorithm>
+
+using namespace mcld;
+
+namespace {
+
+/// Cluster - the functions placed together
+struct Cluster
+{
+  std::vector<size_t> functions;
+  uint64_t size;
+  uint64_t weight;
+};
+
+/// ClusterDensityCompare - the denser cluster is placed first
+struct ClusterDensityCompare
+{
+  ClusterDensityCompare(const std::vector<Cluster>& pClusters)
+    : clusters(pClusters) {
+  }
+
+  bool operator()(size_t pX, size_t pY) const
+  {
+    const Cluster& x = clusters[pX];
+    const Cluster& y = clusters[pY];
+    return ((double)x.weight / (double)x.size) >
+           ((double)y.weight / (double)y.size);
+  }
+
+  const std::vector<Cluster>& clusters;
+};
+
+/// HotnessCompare - the hotter function is visited first
+struct HotnessCompare
+{
+  HotnessCompare(const std::vector<uint64_t>& pHotness)
+    : hotness(pHotness) {
+  }
+
+  bool operator()(size_t pX, size_t pY) const
+  { return hotness[pX] > hotness[pY]; }
+
+  const std::vector<uint64_t>& hotness;
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// CallGraphOrdering
+//===----------------------------------------------------------------------===//
+CallGraphOrdering::CallGraphOrdering(const LinkerConfig& pConfig,
+                                     Module& pModule)
+  : m_Config(pConfig), m_Module(pModule) {
+}
+
+CallGraphOrdering::~CallGraphOrdering()
+{
+}
+
+bool CallGraphOrdering::readProfile(const sys::fs::Path& pPath)
+{
+  FileHandle file;
+  if (!file.open(pPath, FileHandle::ReadOnly))
+    return false;
+
+  std::string content(file.size(), '\0');
+  bool result = content.empty() ||
+                file.read(&content[0], 0, content.size());
+  file.close();
+
+  if (result)
+    parseProfile(content);
+  return result;
+}
+
+void CallGraphOrdering::parseProfile(llvm::StringRef pContent)
+{
+  while (!pContent.empty()) {
+    std::pair<llvm::StringRef, llvm::StringRef> line = pContent.split('\n');
+    llvm::StringRef rest = line.first.trim();
+    pContent = line.second;
+    if (rest.empty())
+      continue;
+
+    // caller callee count
+    llvm::StringRef fields[3];
+    for (size_t i = 0; i < 3; ++i) {
+      std::pair<llvm::StringRef, llvm::StringRef> field = rest.split(' ');
+      fields[i] = field.first;
+      rest = field.second.ltrim();
+    }
+
+    ProfileEntry entry;
+    if (fields[0].empty() || fields[1].empty() || !rest.empty() ||
+        fields[2].getAsInteger(10, entry.count)) {
+      warning(diag::warn_call_graph_profile_malformed_line)
+        << line.first.trim();
+      continue;
+    }
+    entry.caller = fields[0].str();
+    entry.callee = fields[1].str();
+    m_Profile.push_back(entry);
+  }
+}
+
+void CallGraphOrdering::run()
+{
+  FragmentGraph graph;
+  if (!graph.construct(m_Config, m_Module))
+    return;
+
+  collectFunctions(graph);
+
+  EdgeListTy edges;
+  if (m_Profile.empty())
+    getRelocationEdges(graph, edges);
+  else
+    getProfileEdges(graph, edges);
+
+  // keep the input order if nothing is called
+  if (edges.empty())
+    return;
+
+  std::vector<uint64_t> sizes;
+  sizes.reserve(m_Functions.size());
+  FunctionListTy::const_iterator func, fEnd = m_Functions.end();
+  for (func = m_Functions.begin(); func != fEnd; ++func)
+    sizes.push_back(func->size);
+
+  std::vector<size_t> order;
+  Sort(sizes, edges, order);
+  reorder(order);
+}
+
+void CallGraphOrdering::collectFunctions(FragmentGraph& pGraph)
+{
+  Module::iterator sect, sectEnd = m_Module.end();
+  for (sect = m_Module.begin(); sect != sectEnd; ++sect) {
+    if (LDFileFormat::Regular != (*sect)->kind() ||
+        0x0 == ((*sect)->flag() & llvm::ELF::SHF_EXECINSTR) ||
+        !(*sect)->hasSectionData())
+      continue;
+
+    // the fragments of a regular node are consecutive in the section
+    FGNode* last = NULL;
+    SectionData::iterator frag, fragEnd = (*sect)->getSectionData()->end();
+    for (frag = (*sect)->getSectionData()->begin(); frag != fragEnd; ++frag) {
+      FGNode* node = pGraph.getNode(*frag);
+      assert(NULL != node);
+      if (node != last) {
+        Function func = { node, *sect, 0x0 };
+        m_FunctionMap[node] = m_Functions.size();
+        m_Functions.push_back(func);
+        last = node;
+      }
+      // the size of an alignment depends on the offset, which is changed
+      if (Fragment::Alignment != frag->getKind())
+        m_Functions.back().size += frag->size();
+    }
+  }
+}
+
+void CallGraphOrdering::getRelocationEdges(FragmentGraph& pGraph,
+                                           EdgeListTy& pEdges) const
+{
+  FragmentGraph::EdgeListType fan_out;
+  for (size_t from = 0; from < m_Functions.size(); ++from) {
+    fan_out.clear();
+    pGraph.getEdges(*m_Functions[from].node, fan_out);
+
+    FragmentGraph::const_edge_iterator edge, eEnd = fan_out.end();
+    for (edge = fan_out.begin(); edge != eEnd; ++edge) {
+      FunctionMapTy::const_iterator to = m_FunctionMap.find(&edge->getTo());
+      if (m_FunctionMap.end() == to || from == to->second ||
+          m_Functions[from].section != m_Functions[to->second].section)
+        continue;
+      pEdges.push_back(Edge(from, to->second, edge->getWeight()));
+    }
+  }
+}
+
+void CallGraphOrdering::getProfileEdges(const FragmentGraph& pGraph,
+                                        EdgeListTy& pEdges) const
+{
+  ProfileListTy::const_iterator entry, eEnd = m_Profile.end();
+  for (entry = m_Profile.begin(); entry != eEnd; ++entry) {
+    size_t from = getFunction(pGraph, entry->caller);
+    size_t to = getFunction(pGraph, entry->callee);
+    if (NoFunction == from || NoFunction == to) {
+      warning(diag::warn_call_graph_profile_no_such_symbol)
+        << (NoFunction == from ? entry->caller : entry->callee);
+      continue;
+    }
+
+    // the functions in different output sections can not be placed together
+    if (from == to || 0x0 == entry->count ||
+        m_Functions[from].section != m_Functions[to].section)
+      continue;
+    pEdges.push_back(Edge(from, to, entry->count));
+  }
+}
+
+size_t CallGraphOrdering::getFunction(const FragmentGraph& pGraph,
+                                      const std::string& pName) const
+{
+  const ResolveInfo* info = m_Module.getNamePool().findInfo(pName);
+  if (NULL == info || !info->isDefine() || NULL == info->outSymbol() ||
+      !info->outSymbol()->hasFragRef())
+    return NoFunction;
+
+  const FGNode* node = pGraph.getNode(*info->outSymbol()->fragRef()->frag());
+  FunctionMapTy::const_iterator func = m_FunctionMap.find(node);
+  if (m_FunctionMap.end() == func)
+    return NoFunction;
+  return func->second;
+}
+
+void CallGraphOrdering::reorder(const std::vector<size_t>& pOrder)
+{
+  // move the fragments of every function to the end of its section. After
+  // all functions are moved, the sections are in the new order.
+  std::vector<size_t>::const_iterator it, itEnd = pOrder.end();
+  for (it = pOrder.begin(); it != itEnd; ++it) {
+    Function& func = m_Functions[*it];
+    SectionData::FragmentListType& frag_list =
+      func.section->getSectionData()->getFragmentList();
+    FGNode::frag_iterator frag, fragEnd = func.node->frag_end();
+    for (frag = func.node->frag_begin(); frag != fragEnd; ++frag)
+      frag_list.splice(frag_list.end(), frag_list,
+                       SectionData::iterator(*frag));
+  }
+
+  // reset the offsets of the fragments and the sizes of the sections
+  Module::iterator sect, sectEnd = m_Module.end();
+  for (sect = m_Module.begin(); sect != sectEnd; ++sect) {
+    if (LDFileFormat::Regular != (*sect)->kind() ||
+        0x0 == ((*sect)->flag() & llvm::ELF::SHF_EXECINSTR) ||
+        !(*sect)->hasSectionData())
+      continue;
+
+    uint64_t offset = 0x0;
+    SectionData::iterator frag, fragEnd = (*sect)->getSectionData()->end();
+    for (frag = (*sect)->getSectionData()->begin(); frag != fragEnd; ++frag) {
+      frag->setOffset(offset);
+      offset += frag->size();
+    }
+    (*sect)->setSize(offset);
+  }
+}
+
+void CallGraphOrdering::Sort(const std::vector<uint64_t>& pSizes,
+                             const EdgeListTy& pEdges,
+                             std::vector<size_t>& pOrder)
+{
+  const size_t num = pSizes.size();
+
+  // the hotness of a function is the total weight of its callers, and its
+  // heaviest caller is the one it is placed after
+  std::vector<uint64_t> hotness(num, 0x0);
+  std::vector<size_t> best_caller(num, NoFunction);
+  std::vector<uint64_t> best_weight(num, 0x0);
+  EdgeListTy::const_iterator edge, eEnd = pEdges.end();
+  for (edge = pEdges.begin(); edge != eEnd; ++edge) {
+    if (edge->from == edge->to)
+      continue;
+    hotness[edge->to] += edge->weight;
+    if (edge->weight > best_weight[edge->to]) {
+      best_weight[edge->to] = edge->weight;
+      best_caller[edge->to] = edge->from;
+    }
+  }
+
+  // every function is a cluster by itself at first
+  std::vector<Cluster> clusters(num);
+  std::vector<size_t> cluster_of(num);
+  for (size_t i = 0; i < num; ++i) {
+    clusters[i].functions.push_back(i);
+    // an empty function counts a byte, so every density is defined
+    clusters[i].size = std::max(pSizes[i], (uint64_t)1);
+    clusters[i].weight = hotness[i];
+    cluster_of[i] = i;
+  }
+
+  // append the cluster of a function to the cluster of its heaviest caller,
+  // from the hottest function down
+  std::vector<size_t> visit;
+  for (size_t i = 0; i < num; ++i) {
+    if (NoFunction != best_caller[i])
+      visit.push_back(i);
+  }
+  std::stable_sort(visit.begin(), visit.end(), HotnessCompare(hotness));
+
+  std::vector<size_t>::iterator func, fEnd = visit.end();
+  for (func = visit.begin(); func != fEnd; ++func) {
+    size_t to = cluster_of[best_caller[*func]];
+    size_t from = cluster_of[*func];
+    if (to == from ||
+        clusters[to].size + clusters[from].size > MaxClusterSize)
+      continue;
+
+    std::vector<size_t>& moved = clusters[from].functions;
+    std::vector<size_t>::iterator it, itEnd = moved.end();
+    for (it = moved.begin(); it != itEnd; ++it)
+      cluster_of[*it] = to;
+    clusters[to].functions.insert(clusters[to].functions.end(),
+                                  moved.begin(), moved.end());
+    clusters[to].size += clusters[from].size;
+    clusters[to].weight += clusters[from].weight;
+    std::vector<size_t>().swap(moved);
+  }
+
+  // place the clusters by their densities. The cold clusters keep the input
+  // order.
+  std::vector<size_t> sorted;
+  for (size_t i = 0; i < num; ++i) {
+    if (!clusters[i].functions.empty())
+      sorted.push_back(i);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   ClusterDensityCompare(clusters));
+
+  pOrder.clear();
+  pOrder.reserve(num);
+  std::vector<size_t>::iterator c, cEnd = sorted.end();
+  for (c = sorted.begin(); c != cEnd; ++c) {
+    pOrder.insert(pOrder.end(), clusters[*c].functions.begin(),
+                                clusters[*c].functions.end());
+  }
+}
+
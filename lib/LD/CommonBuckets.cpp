@@ -0,0 +1,93 @@
+//===- CommonBuckets.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/CommonBuckets.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Fragment/FillFragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Object/ObjectBuilder.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// CommonBuckets
+//===----------------------------------------------------------------------===//
+CommonBuckets::CommonBuckets()
+{
+}
+
+void CommonBuckets::add(LDSymbol& pSymbol)
+{
+  uint64_t align = pSymbol.value();
+  if (0 == align)
+    align = 1;
+
+  if (0 != (align & (align - 1))) {
+    m_Others.push_back(&pSymbol);
+    return;
+  }
+
+  unsigned int idx = 0;
+  while (1 != align) {
+    align >>= 1;
+    ++idx;
+  }
+  m_Buckets[idx].push_back(&pSymbol);
+}
+
+bool CommonBuckets::empty() const
+{
+  if (!m_Others.empty())
+    return false;
+  for (unsigned int idx = 0; idx < NumOfBuckets; ++idx) {
+    if (!m_Buckets[idx].empty())
+      return false;
+  }
+  return true;
+}
+
+uint64_t CommonBuckets::allocate(SectionData& pSD)
+{
+  uint64_t size = 0;
+
+  // from the largest alignment to the smallest
+  for (unsigned int idx = NumOfBuckets; idx-- > 0; ) {
+    SymbolList& bucket = m_Buckets[idx];
+    if (bucket.empty())
+      continue;
+
+    // the offsets of the symbols in the fragment of the bucket
+    uint64_t align = (uint64_t)1 << idx;
+    uint64_t offset = 0;
+    m_Offsets.clear();
+    m_Offsets.reserve(bucket.size());
+    SymbolList::iterator sym, symEnd = bucket.end();
+    for (sym = bucket.begin(); sym != symEnd; ++sym) {
+      offset = (offset + align - 1) & ~(align - 1);
+      m_Offsets.push_back(offset);
+      offset += (*sym)->size();
+    }
+
+    Fragment* frag = new FillFragment(0x0, 1, offset);
+    for (size_t i = 0; i < bucket.size(); ++i)
+      bucket[i]->setFragmentRef(FragmentRef::Create(*frag, m_Offsets[i]));
+    size += ObjectBuilder::AppendFragment(*frag, pSD, align);
+    bucket.clear();
+  }
+
+  SymbolList::iterator sym, symEnd = m_Others.end();
+  for (sym = m_Others.begin(); sym != symEnd; ++sym) {
+    Fragment* frag = new FillFragment(0x0, 1, (*sym)->size());
+    (*sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
+    size += ObjectBuilder::AppendFragment(*frag, pSD, (*sym)->value());
+  }
+  m_Others.clear();
+  m_Offsets.clear();
+  return size;
+}
@@ -0,0 +1,128 @@
+//===- CompressedSections.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/CompressedSections.h>
+
+#include <mcld/IRBuilder.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Compression.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
+
+using namespace mcld;
+
+namespace {
+
+/// Inflater - the body of parallel_for to inflate the i-th pending section
+struct Inflater
+{
+  std::vector<CompressedSections::Entry*>* entries;
+  std::vector<char>* succeeded;
+
+  void operator()(size_t pIdx) {
+    CompressedSections::Entry& entry = *(*entries)[pIdx];
+    if (CompressedSections::Zlib == entry.type)
+      (*succeeded)[pIdx] = zlib::uncompress(entry.stream, entry.streamSize,
+                                            entry.data, entry.size);
+    else
+      (*succeeded)[pIdx] = zstd::uncompress(entry.stream, entry.streamSize,
+                                            entry.data, entry.size);
+  }
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// CompressedSections
+//===----------------------------------------------------------------------===//
+CompressedSections::CompressedSections()
+{
+}
+
+CompressedSections::~CompressedSections()
+{
+  EntryList::iterator entry, eEnd = m_Entries.end();
+  for (entry = m_Entries.begin(); entry != eEnd; ++entry)
+    delete [] entry->data;
+}
+
+bool CompressedSections::IsSupported(uint32_t pType)
+{
+  if (Zlib == pType)
+    return zlib::isAvailable();
+  if (Zstd == pType)
+    return zstd::isAvailable();
+  return false;
+}
+
+Fragment* CompressedSections::append(const Input& pInput,
+                                     const LDSection& pSection,
+                                     Type pType,
+                                     const uint8_t* pStream,
+                                     size_t pStreamSize,
+                                     size_t pSize)
+{
+  // the pages of a large array are not committed until they are written, so
+  // a section that is never inflated costs no memory
+  Entry entry;
+  entry.input = &pInput;
+  entry.section = &pSection;
+  entry.type = pType;
+  entry.stream = pStream;
+  entry.streamSize = pStreamSize;
+  entry.data = (0 == pSize) ? NULL : new uint8_t[pSize];
+  entry.size = pSize;
+  entry.isInflated = (0 == pSize);
+
+  Fragment* frag = IRBuilder::CreateRegion(entry.data, pSize);
+  m_FragmentMap[frag] = m_Entries.size();
+  m_Entries.push_back(entry);
+  return frag;
+}
+
+bool CompressedSections::decompress(ThreadPool& pPool)
+{
+  std::vector<Entry*> pending;
+  EntryList::iterator entry, eEnd = m_Entries.end();
+  for (entry = m_Entries.begin(); entry != eEnd; ++entry) {
+    if (!entry->isInflated && LDFileFormat::Ignore != entry->section->kind())
+      pending.push_back(&*entry);
+  }
+  if (pending.empty())
+    return true;
+
+  // a section is inflated by one thread, so the sections are the tasks
+  std::vector<char> succeeded(pending.size(), 0);
+  Inflater inflater;
+  inflater.entries = &pending;
+  inflater.succeeded = &succeeded;
+  parallel_for(pPool, 0, pending.size(), inflater, 1);
+
+  bool result = true;
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (!succeeded[i]) {
+      fatal(diag::fatal_cannot_decompress_section)
+        << pending[i]->section->name() << pending[i]->input->path();
+      result = false;
+      continue;
+    }
+    pending[i]->isInflated = true;
+  }
+  return result;
+}
+
+const CompressedSections::Entry*
+CompressedSections::find(const Fragment& pFrag) const
+{
+  FragmentMap::const_iterator it = m_FragmentMap.find(&pFrag);
+  if (m_FragmentMap.end() == it)
+    return NULL;
+  return &m_Entries[it->second];
+}
@@ -7,9 +7,365 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/DWARFLineInfo.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/PackedRelocData.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/MemoryArea.h>
+
+#include <llvm/Support/Casting.h>
+
+#include <algorithm>
 
 using namespace mcld;
 
-//==========================
+//===----------------------------------------------------------------------===//
+// Helper Functions
+//===----------------------------------------------------------------------===//
+namespace {
+
+enum {
+  DW_LNS_copy             = 0x01,
+  DW_LNS_advance_pc       = 0x02,
+  DW_LNS_advance_line     = 0x03,
+  DW_LNS_set_file         = 0x04,
+  DW_LNS_const_add_pc     = 0x08,
+  DW_LNS_fixed_advance_pc = 0x09,
+  DW_LNE_end_sequence     = 0x01,
+  DW_LNE_set_address      = 0x02,
+  DW_LNE_define_file      = 0x03
+};
+
+/// LineReader - read the little endian values of .debug_line. Reading past
+/// the end gives zeros.
+class LineReader
+{
+public:
+  LineReader(const uint8_t* pStart, const uint8_t* pEnd)
+    : m_pStart(pStart), m_pCursor(pStart), m_pEnd(pEnd) {
+  }
+
+  bool atEnd() const { return m_pCursor >= m_pEnd; }
+
+  size_t offset() const { return m_pCursor - m_pStart; }
+
+  void seek(size_t pOffset)
+  { m_pCursor = std::min(m_pStart + pOffset, m_pEnd); }
+
+  uint64_t read(unsigned int pBytes) {
+    uint64_t result = 0x0;
+    for (unsigned int i = 0; i < pBytes && !atEnd(); ++i)
+      result |= static_cast<uint64_t>(*m_pCursor++) << (8 * i);
+    return result;
+  }
+
+  uint64_t readULEB() {
+    uint64_t result = 0x0;
+    unsigned int shift = 0;
+    while (!atEnd()) {
+      uint8_t byte = *m_pCursor++;
+      if (shift < 64)
+        result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+      if (0x0 == (byte & 0x80))
+        break;
+    }
+    return result;
+  }
+
+  int64_t readSLEB() {
+    int64_t result = 0;
+    unsigned int shift = 0;
+    uint8_t byte = 0x0;
+    while (!atEnd()) {
+      byte = *m_pCursor++;
+      if (shift < 64)
+        result |= static_cast<int64_t>(byte & 0x7f) << shift;
+      shift += 7;
+      if (0x0 == (byte & 0x80))
+        break;
+    }
+    if (shift < 64 && (byte & 0x40))
+      result |= -(static_cast<int64_t>(1) << shift);
+    return result;
+  }
+
+  const char* readString() {
+    const char* result = reinterpret_cast<const char*>(m_pCursor);
+    while (!atEnd() && 0x0 != *m_pCursor)
+      ++m_pCursor;
+    if (atEnd())
+      return "";
+    ++m_pCursor;
+    return result;
+  }
+
+private:
+  const uint8_t* m_pStart;
+  const uint8_t* m_pCursor;
+  const uint8_t* m_pEnd;
+};
+
+/// Location - the place which a relocation of .debug_line refers to
+struct Location {
+  const Fragment* fragment;
+  uint64_t offset;
+};
+
+typedef std::map<uint64_t, Location> LocationMap;
+
+/// ReadLocations - map the places of the relocations of pDebugLine to the
+/// places they refer to. The .debug_line of an input is read as one region
+/// fragment, so the offset of a place in its fragment is the offset in the
+/// section.
+void ReadLocations(const Input& pInput,
+                   const LDSection& pDebugLine,
+                   LocationMap& pLocations)
+{
+  LDContext::const_sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (&pDebugLine != (*rs)->getLink() || !(*rs)->hasRelocData())
+      continue;
+
+    RelocData::const_iterator reloc, rEnd = (*rs)->getRelocData()->end();
+    for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+      const Relocation* relocation = llvm::cast<Relocation>(reloc);
+      const LDSymbol* symbol = relocation->symInfo()->outSymbol();
+      if (NULL == symbol || !symbol->hasFragRef())
+        continue;
+
+      const FragmentRef* ref = symbol->fragRef();
+      Location location;
+      location.fragment = ref->frag();
+      location.offset = ref->offset() + relocation->addend();
+      pLocations[relocation->targetRef().offset()] = location;
+    }
+
+    if (!(*rs)->getRelocData()->hasPacked())
+      continue;
+
+    const PackedRelocData& packed = *(*rs)->getRelocData()->getPacked();
+    PackedRelocData::EntryList entries;
+    for (size_t b = 0; b < packed.numOfBlocks(); ++b) {
+      packed.decode(b, entries);
+      PackedRelocData::EntryList::const_iterator entry, eEnd = entries.end();
+      for (entry = entries.begin(); entry != eEnd; ++entry) {
+        const LDSymbol* symbol = entry->symbol->resolveInfo()->outSymbol();
+        if (NULL == symbol || !symbol->hasFragRef())
+          continue;
+
+        const FragmentRef* ref = symbol->fragRef();
+        Location location;
+        location.fragment = ref->frag();
+        location.offset = ref->offset() + entry->addend;
+        pLocations[entry->offset] = location;
+      }
+    }
+  }
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
 // DWARFLineInfo
+//===----------------------------------------------------------------------===//
+DWARFLineInfo::DWARFLineInfo()
+{
+}
+
+DWARFLineInfo::~DWARFLineInfo()
+{
+  TableMap::iterator table, tEnd = m_Tables.end();
+  for (table = m_Tables.begin(); table != tEnd; ++table)
+    delete table->second;
+}
+
+/// ReadTable - decode all line number programs in pDebugLine
+void DWARFLineInfo::ReadTable(Input& pInput,
+                              const LDSection& pDebugLine,
+                              LineTable& pTable)
+{
+  LocationMap locations;
+  ReadLocations(pInput, pDebugLine, locations);
+
+  MemoryView view = pInput.memArea()->view(
+                   pInput.fileOffset() + pDebugLine.offset(), pDebugLine.size());
+  LineReader reader(view.start(), view.end());
+
+  while (!reader.atEnd()) {
+    // the header of a line number program
+    unsigned int offset_size = 4;
+    uint64_t unit_length = reader.read(4);
+    if (0xffffffff == unit_length) {
+      offset_size = 8;
+      unit_length = reader.read(8);
+    }
+    size_t unit_end = reader.offset() + unit_length;
+    uint16_t version = reader.read(2);
+    uint64_t header_length = reader.read(offset_size);
+    size_t program_start = reader.offset() + header_length;
+    if (0 == unit_length || version < 2 || version > 4)
+      break;
+
+    uint8_t min_inst_length = reader.read(1);
+    if (version >= 4)
+      reader.read(1); // maximum_operations_per_instruction
+    reader.read(1); // default_is_stmt
+    int8_t line_base = static_cast<int8_t>(reader.read(1));
+    uint8_t line_range = reader.read(1);
+    uint8_t opcode_base = reader.read(1);
+    std::vector<uint8_t> opcode_lengths(opcode_base, 0);
+    for (unsigned int op = 1; op < opcode_base; ++op)
+      opcode_lengths[op] = reader.read(1);
+    if (0 == line_range)
+      break;
+
+    std::vector<std::string> dirs(1, std::string());
+    for (const char* dir = reader.readString(); '\0' != *dir;
+         dir = reader.readString())
+      dirs.push_back(dir);
+
+    // the file numbers of this program start at 1
+    size_t file_base = pTable.files.size() - 1;
+    for (const char* file = reader.readString(); '\0' != *file;
+         file = reader.readString()) {
+      uint64_t dir = reader.readULEB();
+      reader.readULEB(); // mtime
+      reader.readULEB(); // length
+      if ('/' == file[0] || 0 == dir || dir >= dirs.size())
+        pTable.files.push_back(file);
+      else
+        pTable.files.push_back(dirs[dir] + "/" + file);
+    }
+
+    // the line number program
+    reader.seek(program_start);
+    Row initial = { NULL, 0x0, static_cast<uint32_t>(file_base + 1), 1 };
+    Row row = initial;
+    while (reader.offset() < unit_end && !reader.atEnd()) {
+      uint8_t opcode = reader.read(1);
+      if (opcode >= opcode_base) {
+        uint8_t adjusted = opcode - opcode_base;
+        row.offset += (adjusted / line_range) * min_inst_length;
+        row.line += line_base + (adjusted % line_range);
+        if (NULL != row.fragment)
+          pTable.rows.push_back(row);
+        continue;
+      }
+
+      switch (opcode) {
+        case 0x0: { // the extended opcodes
+          uint64_t length = reader.readULEB();
+          size_t next = reader.offset() + length;
+          uint8_t sub_opcode = reader.read(1);
+          if (DW_LNE_end_sequence == sub_opcode) {
+            if (NULL != row.fragment) {
+              row.line = 0;
+              pTable.rows.push_back(row);
+            }
+            row = initial;
+          }
+          else if (DW_LNE_set_address == sub_opcode) {
+            size_t place = reader.offset();
+            row.offset = reader.read(length - 1);
+            LocationMap::iterator location = locations.find(place);
+            if (locations.end() != location) {
+              row.fragment = location->second.fragment;
+              row.offset += location->second.offset;
+            }
+            else
+              row.fragment = NULL;
+          }
+          else if (DW_LNE_define_file == sub_opcode) {
+            pTable.files.push_back(reader.readString());
+          }
+          reader.seek(next);
+          break;
+        }
+        case DW_LNS_copy:
+          if (NULL != row.fragment)
+            pTable.rows.push_back(row);
+          break;
+        case DW_LNS_advance_pc:
+          row.offset += reader.readULEB() * min_inst_length;
+          break;
+        case DW_LNS_advance_line:
+          row.line += reader.readSLEB();
+          break;
+        case DW_LNS_set_file:
+          row.file = file_base + reader.readULEB();
+          break;
+        case DW_LNS_const_add_pc:
+          row.offset += ((255 - opcode_base) / line_range) * min_inst_length;
+          break;
+        case DW_LNS_fixed_advance_pc:
+          row.offset += reader.read(2);
+          break;
+        default:
+          // skip the operands of the other standard opcodes
+          for (unsigned int i = 0; i < opcode_lengths[opcode]; ++i)
+            reader.readULEB();
+          break;
+      }
+    }
+    reader.seek(unit_end);
+  }
+}
+
+bool DWARFLineInfo::IsBefore(const Row& pX, const Row& pY)
+{
+  if (pX.fragment != pY.fragment)
+    return pX.fragment < pY.fragment;
+  return pX.offset < pY.offset;
+}
+
+const DWARFLineInfo::LineTable& DWARFLineInfo::getTable(Input& pInput)
+{
+  TableMap::iterator entry = m_Tables.find(&pInput);
+  if (m_Tables.end() != entry)
+    return *entry->second;
+
+  LineTable* table = new LineTable();
+  // file 0 is unknown
+  table->files.push_back(std::string());
+  const LDSection* debug_line = NULL;
+  if (pInput.hasContext() && pInput.hasMemArea())
+    debug_line = pInput.context()->getSection(".debug_line");
+  // a compressed .debug_line is not read from the file as it is
+  if (NULL != debug_line && 0x0 != debug_line->size() &&
+      !debug_line->isCompressed()) {
+    ReadTable(pInput, *debug_line, *table);
+    std::stable_sort(table->rows.begin(), table->rows.end(), IsBefore);
+  }
+  m_Tables[&pInput] = table;
+  return *table;
+}
+
+bool DWARFLineInfo::findLine(Input& pInput,
+                             const FragmentRef& pPlace,
+                             std::string& pFile,
+                             unsigned int& pLine)
+{
+  sys::ScopedLock lock(m_Lock);
+  const LineTable& table = getTable(pInput);
+
+  // the last row at or before pPlace
+  Row key = { pPlace.frag(), pPlace.offset(), 0, 0 };
+  std::vector<Row>::const_iterator row =
+    std::upper_bound(table.rows.begin(), table.rows.end(), key, IsBefore);
+  if (table.rows.begin() == row)
+    return false;
+  --row;
+  if (pPlace.frag() != row->fragment || 0 == row->line ||
+      row->file >= table.files.size())
+    return false;
 
+  pFile = table.files[row->file];
+  pLine = row->line;
+  return true;
+}
@@ -0,0 +1,334 @@
+//===- DeterminismVerifier.cpp --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/DeterminismVerifier.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/ADT/SizeTraits.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// helper_diff - the offset of the first different byte of pX and pY, or
+/// the size of the shorter one if one is a prefix of the other
+size_t helper_diff(const uint8_t* pX, size_t pXSize,
+                   const uint8_t* pY, size_t pYSize)
+{
+  size_t size = std::min(pXSize, pYSize);
+  for (size_t i = 0; i < size; ++i) {
+    if (pX[i] != pY[i])
+      return i;
+  }
+  return size;
+}
+
+/// helper_same - are the digests of pX and pY, which have pSize bytes, the
+/// same?
+bool helper_same(ThreadPool& pPool, const uint8_t* pX, const uint8_t* pY,
+                 size_t pSize)
+{
+  std::vector<uint8_t> x(digest::size(digest::Fast));
+  std::vector<uint8_t> y(digest::size(digest::Fast));
+  digest::treeHash(pPool, digest::Fast, pX, pSize, &x[0]);
+  digest::treeHash(pPool, digest::Fast, pY, pSize, &y[0]);
+  return (x == y);
+}
+
+/// helper_reloc_type - the type of the r_info of an ELF32 relocation
+uint32_t helper_reloc_type(uint32_t pInfo)
+{
+  return (pInfo & 0xff);
+}
+
+/// helper_reloc_type - the type of the r_info of an ELF64 relocation
+uint32_t helper_reloc_type(uint64_t pInfo)
+{
+  return (pInfo & 0xffffffff);
+}
+
+/// helper_get_name - the string at pOffset of the string table pStrtab of
+/// pImage, or an empty string if it is out of the table
+template<typename ElfXX_Shdr>
+std::string helper_get_name(const uint8_t* pImage,
+                            const ElfXX_Shdr& pStrtab,
+                            uint64_t pOffset)
+{
+  if (pOffset >= pStrtab.sh_size)
+    return std::string();
+  const char* str = reinterpret_cast<const char*>(pImage) +
+                    pStrtab.sh_offset + pOffset;
+  size_t max = pStrtab.sh_size - pOffset;
+  return std::string(str, strnlen(str, max));
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// DeterminismVerifier
+//===----------------------------------------------------------------------===//
+DeterminismVerifier::DeterminismVerifier(const LinkerConfig& pConfig)
+  : m_Config(pConfig) {
+}
+
+DeterminismVerifier::~DeterminismVerifier()
+{
+}
+
+bool DeterminismVerifier::verify(const uint8_t* pExpected,
+                                 size_t pExpectedSize,
+                                 const uint8_t* pActual,
+                                 size_t pActualSize) const
+{
+  using namespace llvm::ELF;
+
+  // the outputs of the same class are compared section by section
+  if (pExpectedSize >= EI_NIDENT && pActualSize >= EI_NIDENT &&
+      0 == memcmp(pExpected, ElfMagic, strlen(ElfMagic)) &&
+      0 == memcmp(pExpected, pActual, EI_NIDENT)) {
+    if (ELFCLASS32 == pExpected[EI_CLASS] &&
+        isValid<32>(pExpected, pExpectedSize) &&
+        isValid<32>(pActual, pActualSize))
+      return doVerify<32>(pExpected, pExpectedSize, pActual, pActualSize);
+
+    if (ELFCLASS64 == pExpected[EI_CLASS] &&
+        isValid<64>(pExpected, pExpectedSize) &&
+        isValid<64>(pActual, pActualSize))
+      return doVerify<64>(pExpected, pExpectedSize, pActual, pActualSize);
+  }
+
+  // a binary output or a broken one
+  size_t offset = helper_diff(pExpected, pExpectedSize, pActual, pActualSize);
+  if (pExpectedSize == pActualSize && offset == pExpectedSize)
+    return true;
+
+  error(diag::err_nondeterministic_output) << m_Config.threads().size()
+                                           << offset;
+  return false;
+}
+
+template<size_t SIZE>
+bool DeterminismVerifier::isValid(const uint8_t* pImage, size_t pSize)
+{
+  typedef typename ELFSizeTraits<SIZE>::Ehdr ElfXX_Ehdr;
+  typedef typename ELFSizeTraits<SIZE>::Shdr ElfXX_Shdr;
+
+  if (pSize < sizeof(ElfXX_Ehdr))
+    return false;
+
+  const ElfXX_Ehdr* ehdr = reinterpret_cast<const ElfXX_Ehdr*>(pImage);
+  if (0 == ehdr->e_shnum)
+    return true;
+
+  if (sizeof(ElfXX_Shdr) != ehdr->e_shentsize ||
+      ehdr->e_shoff > pSize ||
+      (pSize - ehdr->e_shoff) / sizeof(ElfXX_Shdr) < ehdr->e_shnum ||
+      ehdr->e_shstrndx >= ehdr->e_shnum)
+    return false;
+
+  const ElfXX_Shdr* shdr =
+                 reinterpret_cast<const ElfXX_Shdr*>(pImage + ehdr->e_shoff);
+  for (unsigned int i = 0; i < ehdr->e_shnum; ++i) {
+    if (llvm::ELF::SHT_NOBITS == shdr[i].sh_type)
+      continue;
+    if (shdr[i].sh_offset > pSize || shdr[i].sh_size > pSize - shdr[i].sh_offset)
+      return false;
+  }
+  return true;
+}
+
+template<size_t SIZE>
+bool DeterminismVerifier::doVerify(const uint8_t* pExpected,
+                                   size_t pExpectedSize,
+                                   const uint8_t* pActual,
+                                   size_t pActualSize) const
+{
+  typedef typename ELFSizeTraits<SIZE>::Ehdr ElfXX_Ehdr;
+  typedef typename ELFSizeTraits<SIZE>::Shdr ElfXX_Shdr;
+
+  ThreadPool& pool = m_Config.threads();
+  bool result = true;
+
+  if (pExpectedSize != pActualSize) {
+    error(diag::err_nondeterministic_size) << pool.size()
+                                           << pActualSize
+                                           << pExpectedSize;
+    result = false;
+  }
+
+  // the ELF header
+  size_t offset = helper_diff(pExpected, sizeof(ElfXX_Ehdr),
+                              pActual, sizeof(ElfXX_Ehdr));
+  if (sizeof(ElfXX_Ehdr) != offset) {
+    error(diag::err_nondeterministic_header) << pool.size()
+                                             << "ELF header"
+                                             << offset;
+    result = false;
+  }
+
+  const ElfXX_Ehdr* x_ehdr = reinterpret_cast<const ElfXX_Ehdr*>(pExpected);
+  const ElfXX_Ehdr* y_ehdr = reinterpret_cast<const ElfXX_Ehdr*>(pActual);
+  if (x_ehdr->e_shnum != y_ehdr->e_shnum)
+    return false;
+
+  const ElfXX_Shdr* x_shdr =
+             reinterpret_cast<const ElfXX_Shdr*>(pExpected + x_ehdr->e_shoff);
+  const ElfXX_Shdr* y_shdr =
+             reinterpret_cast<const ElfXX_Shdr*>(pActual + y_ehdr->e_shoff);
+  size_t shdr_size = x_ehdr->e_shnum * sizeof(ElfXX_Shdr);
+
+  // the section header table
+  offset = helper_diff(reinterpret_cast<const uint8_t*>(x_shdr), shdr_size,
+                       reinterpret_cast<const uint8_t*>(y_shdr), shdr_size);
+  if (shdr_size != offset) {
+    error(diag::err_nondeterministic_header) << pool.size()
+                                             << "section header table"
+                                             << offset;
+    result = false;
+  }
+
+  // the sections, each by its own hash
+  unsigned int num_of_diffs = 0;
+  unsigned int first = 0;
+  for (unsigned int i = 1; i < x_ehdr->e_shnum; ++i) {
+    if (llvm::ELF::SHT_NOBITS == x_shdr[i].sh_type ||
+        llvm::ELF::SHT_NOBITS == y_shdr[i].sh_type)
+      continue;
+
+    if (x_shdr[i].sh_size == y_shdr[i].sh_size &&
+        helper_same(pool, pExpected + x_shdr[i].sh_offset,
+                    pActual + y_shdr[i].sh_offset, x_shdr[i].sh_size))
+      continue;
+
+    if (0 == num_of_diffs)
+      first = i;
+    ++num_of_diffs;
+  }
+
+  if (0 == num_of_diffs) {
+    if (result)
+      note(diag::note_output_deterministic) << pool.size()
+                                            << x_ehdr->e_shnum;
+    return result;
+  }
+
+  // locate the first different byte of the first different section
+  offset = helper_diff(pExpected + x_shdr[first].sh_offset,
+                       x_shdr[first].sh_size,
+                       pActual + y_shdr[first].sh_offset,
+                       y_shdr[first].sh_size);
+  error(diag::err_nondeterministic_section)
+    << pool.size()
+    << helper_get_name(pExpected, x_shdr[x_ehdr->e_shstrndx],
+                       x_shdr[first].sh_name)
+    << offset
+    << num_of_diffs;
+  reportPlace<SIZE>(pExpected, pExpectedSize, first, offset);
+  return false;
+}
+
+template<size_t SIZE>
+void DeterminismVerifier::reportPlace(const uint8_t* pImage,
+                                      size_t pSize,
+                                      unsigned int pIdx,
+                                      uint64_t pOffset) const
+{
+  typedef typename ELFSizeTraits<SIZE>::Ehdr ElfXX_Ehdr;
+  typedef typename ELFSizeTraits<SIZE>::Shdr ElfXX_Shdr;
+  typedef typename ELFSizeTraits<SIZE>::Sym  ElfXX_Sym;
+  typedef typename ELFSizeTraits<SIZE>::Rel  ElfXX_Rel;
+  typedef typename ELFSizeTraits<SIZE>::Rela ElfXX_Rela;
+
+  const ElfXX_Ehdr* ehdr = reinterpret_cast<const ElfXX_Ehdr*>(pImage);
+  const ElfXX_Shdr* shdr =
+                 reinterpret_cast<const ElfXX_Shdr*>(pImage + ehdr->e_shoff);
+  const ElfXX_Shdr& shstrtab = shdr[ehdr->e_shstrndx];
+  const ElfXX_Shdr& sect = shdr[pIdx];
+
+  // the relocation entry if the section is a relocation section
+  if (llvm::ELF::SHT_REL == sect.sh_type ||
+      llvm::ELF::SHT_RELA == sect.sh_type) {
+    size_t entsize = (llvm::ELF::SHT_REL == sect.sh_type) ?
+                     sizeof(ElfXX_Rel) : sizeof(ElfXX_Rela);
+    error(diag::err_nondeterministic_reloc_entry)
+      << (unsigned long)(pOffset / entsize)
+      << helper_get_name(pImage, shstrtab, sect.sh_name);
+    return;
+  }
+
+  // the values of the symbols and the places of the relocations of an
+  // object are the offsets in their sections
+  bool is_object = (llvm::ELF::ET_REL == ehdr->e_type);
+  uint64_t place = is_object ? pOffset : sect.sh_addr + pOffset;
+
+  // the symbol of .symtab, or .dynsym if stripped, that covers the place
+  const ElfXX_Shdr* symtab = NULL;
+  for (unsigned int i = 1; i < ehdr->e_shnum; ++i) {
+    if (llvm::ELF::SHT_SYMTAB == shdr[i].sh_type) {
+      symtab = &shdr[i];
+      break;
+    }
+    if (llvm::ELF::SHT_DYNSYM == shdr[i].sh_type && NULL == symtab)
+      symtab = &shdr[i];
+  }
+  if (NULL != symtab && symtab->sh_link < ehdr->e_shnum) {
+    const ElfXX_Sym* syms =
+                reinterpret_cast<const ElfXX_Sym*>(pImage + symtab->sh_offset);
+    size_t num = symtab->sh_size / sizeof(ElfXX_Sym);
+    const ElfXX_Sym* best = NULL;
+    for (size_t i = 1; i < num; ++i) {
+      unsigned char type = syms[i].st_info & 0xf;
+      if (pIdx != syms[i].st_shndx ||
+          llvm::ELF::STT_SECTION == type ||
+          llvm::ELF::STT_FILE == type ||
+          syms[i].st_value > place)
+        continue;
+      if (NULL == best || syms[i].st_value > best->st_value)
+        best = &syms[i];
+    }
+    if (NULL != best) {
+      error(diag::err_nondeterministic_symbol)
+        << helper_get_name(pImage, shdr[symtab->sh_link], best->st_name)
+        << (unsigned long)(place - best->st_value);
+    }
+  }
+
+  // the relocation whose place covers the different byte
+  for (unsigned int i = 1; i < ehdr->e_shnum; ++i) {
+    if (llvm::ELF::SHT_REL != shdr[i].sh_type &&
+        llvm::ELF::SHT_RELA != shdr[i].sh_type)
+      continue;
+    if (is_object && pIdx != shdr[i].sh_info)
+      continue;
+
+    size_t entsize = (llvm::ELF::SHT_REL == shdr[i].sh_type) ?
+                     sizeof(ElfXX_Rel) : sizeof(ElfXX_Rela);
+    size_t num = shdr[i].sh_size / entsize;
+    const uint8_t* entry = pImage + shdr[i].sh_offset;
+    for (size_t j = 0; j < num; ++j, entry += entsize) {
+      // Rel and Rela begin with r_offset and r_info
+      const ElfXX_Rel* rel = reinterpret_cast<const ElfXX_Rel*>(entry);
+      if (place < rel->r_offset || place >= rel->r_offset + SIZE / 8)
+        continue;
+      error(diag::err_nondeterministic_reloc)
+        << helper_reloc_type(rel->r_info)
+        << (unsigned long)rel->r_offset
+        << helper_get_name(pImage, shstrtab, shdr[i].sh_name);
+      return;
+    }
+  }
+}
@@ -29,8 +29,9 @@ Diagnostic::~Diagnostic()
 // arguments. The result is appended at on the pOutStr.
 void Diagnostic::format(std::string& pOutStr) const
 {
-  // we've not implemented DWARF LOC messages yet. So, keep pIsLoC false 
-  llvm::StringRef desc = m_Engine.infoMap().getDescription(getID(), false);
+  // the messages reported with a source location use the LoC descriptions
+  llvm::StringRef desc =
+    m_Engine.infoMap().getDescription(getID(), m_Engine.state().inLoC);
 
   format(desc.begin(), desc.end(), pOutStr);
 }
@@ -12,6 +12,7 @@
 #include <mcld/LD/MsgHandler.h>
 #include <mcld/LinkerConfig.h>
 
+#include <algorithm>
 #include <cassert>
 
 using namespace mcld;
@@ -21,7 +22,7 @@ using namespace mcld;
 //===----------------------------------------------------------------------===//
 DiagnosticEngine::DiagnosticEngine()
   : m_pConfig(NULL), m_pLineInfo(NULL), m_pPrinter(NULL),
-    m_pInfoMap(NULL), m_OwnPrinter(false) {
+    m_pInfoMap(NULL), m_OwnPrinter(false), m_bBuffered(false), m_Phase(0) {
 }
 
 DiagnosticEngine::~DiagnosticEngine()
@@ -33,6 +34,10 @@ DiagnosticEngine::~DiagnosticEngine()
 
   // FIXME: design the destructive relation of LineInfo.
   delete m_pLineInfo;
+
+  std::vector<Buffer*>::iterator buffer, bEnd = m_Buffers.end();
+  for (buffer = m_Buffers.begin(); buffer != bEnd; ++buffer)
+    delete *buffer;
 }
 
 void DiagnosticEngine::reset(const LinkerConfig& pConfig)
@@ -66,13 +71,110 @@ bool DiagnosticEngine::emit()
   return emitted;
 }
 
+bool DiagnosticEngine::emit(State& pState)
+{
+  if (&m_State == &pState)
+    return emit();
+
+  Buffer& buffer = getBuffer();
+  assert(&buffer.state == &pState && "emit a message of another thread!");
+  buffer.messages.push_back(Message());
+  buffer.messages.back().phase = m_Phase;
+  buffer.messages.back().ordinal = buffer.ordinal;
+  buffer.messages.back().state = pState;
+  pState.reset();
+  return true;
+}
+
 MsgHandler
-DiagnosticEngine::report(uint16_t pID, DiagnosticEngine::Severity pSeverity)
+DiagnosticEngine::report(uint16_t pID,
+                         DiagnosticEngine::Severity pSeverity,
+                         bool pInLoC)
 {
+  // the fast path. No lock is taken and no argument is kept.
+  if (infoMap().isIgnored(*this, pID))
+    return MsgHandler(*this, NULL);
+
+  if (m_bBuffered && pSeverity > Fatal) {
+    State& state = getBuffer().state;
+    state.ID = pID;
+    state.severity = pSeverity;
+    state.inLoC = pInLoC;
+    return MsgHandler(*this, &state);
+  }
+
+  // unlocked by the MsgHandler after the message is emitted
+  m_Mutex.lock();
   m_State.ID = pID;
   m_State.severity = pSeverity;
+  m_State.inLoC = pInLoC;
 
-  MsgHandler result(*this);
+  MsgHandler result(*this, &m_State);
   return result;
 }
 
+bool DiagnosticEngine::isIgnored(uint16_t pID) const
+{
+  return infoMap().isIgnored(*this, pID);
+}
+
+DiagnosticEngine::Buffer& DiagnosticEngine::getBuffer()
+{
+  Buffer* buffer = static_cast<Buffer*>(m_CurBuffer.get());
+  if (NULL == buffer) {
+    buffer = new Buffer();
+    buffer->ordinal = 0;
+    m_CurBuffer.set(buffer);
+    sys::ScopedLock lock(m_BufferLock);
+    m_Buffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void DiagnosticEngine::beginBuffer()
+{
+  m_bBuffered = true;
+  ++m_Phase;
+}
+
+void DiagnosticEngine::setOrdinal(size_t pOrdinal)
+{
+  if (m_bBuffered)
+    getBuffer().ordinal = pOrdinal;
+}
+
+bool DiagnosticEngine::isBefore(const Message* pX, const Message* pY)
+{
+  if (pX->phase != pY->phase)
+    return (pX->phase < pY->phase);
+  return (pX->ordinal < pY->ordinal);
+}
+
+void DiagnosticEngine::endBuffer()
+{
+  m_bBuffered = false;
+
+  // An ordinal is reported by one thread, and the messages of a thread are
+  // kept in order, so the stable sort gives the order of a serial run.
+  std::vector<const Message*> messages;
+  std::vector<Buffer*>::iterator buffer, bEnd = m_Buffers.end();
+  for (buffer = m_Buffers.begin(); buffer != bEnd; ++buffer) {
+    std::vector<Message>::const_iterator msg, mEnd = (*buffer)->messages.end();
+    for (msg = (*buffer)->messages.begin(); msg != mEnd; ++msg)
+      messages.push_back(&*msg);
+  }
+  std::stable_sort(messages.begin(), messages.end(), isBefore);
+
+  std::vector<const Message*>::iterator msg, mEnd = messages.end();
+  for (msg = messages.begin(); msg != mEnd; ++msg) {
+    sys::ScopedLock lock(m_Mutex);
+    m_State = (*msg)->state;
+    emit();
+  }
+
+  for (buffer = m_Buffers.begin(); buffer != bEnd; ++buffer) {
+    (*buffer)->messages.clear();
+    (*buffer)->ordinal = 0;
+  }
+}
+
@@ -15,7 +15,6 @@
 #include <mcld/LD/DiagnosticInfos.h>
 #include <mcld/LD/DiagnosticPrinter.h>
 
-#include <algorithm>
 
 using namespace mcld;
 
@@ -32,9 +31,6 @@ public:
 public:
   llvm::StringRef getDescription() const
   { return llvm::StringRef(DescriptionStr, DescriptionLen); }
-
-  bool operator<(const DiagStaticInfo& pRHS) const
-  { return (ID < pRHS.ID); }
 };
 
 } // namespace anonymous
@@ -71,15 +67,20 @@ static const unsigned int DiagLoCInfoSize =
   sizeof(DiagLoCInfo)/sizeof(DiagLoCInfo[0])-1;
 
 
+/// getDiagInfo - the static info of pID. The tables are in the order of
+/// diag::ID, and DiagLoCInfo only lacks the common kinds at the beginning, so
+/// the info is found by its index instead of a search.
 static const DiagStaticInfo* getDiagInfo(unsigned int pID, bool pInLoC = false)
 {
   const DiagStaticInfo* static_info = (pInLoC)?DiagLoCInfo:DiagCommonInfo;
   unsigned int info_size = (pInLoC)?DiagLoCInfoSize:DiagCommonInfoSize;
+  unsigned int first = (pInLoC)?(DiagCommonInfoSize - DiagLoCInfoSize):0;
 
-  DiagStaticInfo key = { static_cast<uint16_t>(pID), DiagnosticEngine::None, 0, 0 };
-  const DiagStaticInfo *result = std::lower_bound(static_info, static_info + info_size, key);
+  if (pID < first || pID - first >= info_size)
+    return NULL;
 
-  if (result == (static_info + info_size) || result->ID != pID)
+  const DiagStaticInfo* result = static_info + (pID - first);
+  if (result->ID != pID)
     return NULL;
 
   return result;
@@ -101,18 +102,16 @@ llvm::StringRef DiagnosticInfos::getDescription(unsigned int pID, bool pInLoC) c
   return getDiagInfo(pID, pInLoC)->getDescription();
 }
 
-bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const
+/// getSeverity - the DiagnosticEngine::Severity of the message pID under the
+/// options
+unsigned int DiagnosticInfos::getSeverity(unsigned int pID) const
 {
-  Diagnostic info(pEngine);
-
-  unsigned int ID = info.getID();
-
-  // we are not implement LineInfo, so keep pIsLoC false.
-  const DiagStaticInfo* static_info = getDiagInfo(ID);
+  // a message has the same severity with or without a source location
+  const DiagStaticInfo* static_info = getDiagInfo(pID);
 
   DiagnosticEngine::Severity severity = static_info->Severity;
 
-  switch (ID) {
+  switch (pID) {
     case diag::multiple_definitions: {
       if (m_Config.options().hasMulDefs()) {
         severity = DiagnosticEngine::Ignore;
@@ -158,6 +157,23 @@ bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const
       severity = DiagnosticEngine::Fatal;
     }
   }
+  return severity;
+}
+
+bool DiagnosticInfos::isIgnored(const DiagnosticEngine& pEngine,
+                                unsigned int pID) const
+{
+  DiagnosticEngine::Severity severity =
+    static_cast<DiagnosticEngine::Severity>(getSeverity(pID));
+  return pEngine.getPrinter()->isIgnored(severity);
+}
+
+bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const
+{
+  Diagnostic info(pEngine);
+
+  DiagnosticEngine::Severity severity =
+    static_cast<DiagnosticEngine::Severity>(getSeverity(info.getID()));
 
   // finally, report it.
   pEngine.getPrinter()->handleDiagnostic(severity, info);
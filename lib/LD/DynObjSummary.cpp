@@ -0,0 +1,390 @@
+//===- DynObjSummary.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/DynObjSummary.h>
+
+#include <mcld/ADT/StringHash.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/RealPath.h>
+#include <mcld/Support/SystemUtils.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace mcld;
+
+static const uint32_t kByteOrder = 0x01020304;
+
+/// kMaxDisplacement - the displacements tried for a group before emit()
+/// gives up
+static const uint32_t kMaxDisplacement = 1u << 20;
+
+/// align8 - the offset of the next 8-byte aligned field
+static inline size_t align8(size_t pOffset)
+{
+  return (pOffset + 7) & ~static_cast<size_t>(7);
+}
+
+/// NameHash - the 64-bit hash of a symbol name. The group of a name comes
+/// from the high word, and the slots from the whole hash.
+static inline uint64_t NameHash(const llvm::StringRef& pName)
+{
+  return digest::fast(reinterpret_cast<const uint8_t*>(pName.data()),
+                      pName.size());
+}
+
+/// Mix - the finalizer of MurmurHash3, which spreads every bit of pValue
+static inline uint64_t Mix(uint64_t pValue)
+{
+  pValue ^= pValue >> 33;
+  pValue *= 0xff51afd7ed558ccdULL;
+  pValue ^= pValue >> 33;
+  pValue *= 0xc4ceb9fe1a85ec53ULL;
+  pValue ^= pValue >> 33;
+  return pValue;
+}
+
+//===----------------------------------------------------------------------===//
+// DynObjSummary
+//===----------------------------------------------------------------------===//
+const char DynObjSummary::MAGIC[] = "MCLDDSS2";
+
+DynObjSummary::DynObjSummary()
+  : m_pHeader(NULL), m_pPath(NULL), m_pSOName(NULL), m_pEntries(NULL),
+    m_pGroups(NULL), m_pSlots(NULL), m_pNames(NULL) {
+}
+
+uint32_t DynObjSummary::group(const llvm::StringRef& pName,
+                              uint32_t pNumOfGroups)
+{
+  return (NameHash(pName) >> 32) % pNumOfGroups;
+}
+
+uint32_t DynObjSummary::slot(const llvm::StringRef& pName,
+                             uint32_t pDisplacement,
+                             uint32_t pNumOfSlots)
+{
+  uint64_t hash = NameHash(pName) ^ (pDisplacement * 0x9e3779b97f4a7c15ULL);
+  return Mix(hash) % pNumOfSlots;
+}
+
+bool DynObjSummary::map(const void* pImage, size_t pSize)
+{
+  if (pSize < sizeof(Header))
+    return false;
+
+  const char* image = reinterpret_cast<const char*>(pImage);
+  const Header* header = reinterpret_cast<const Header*>(image);
+  if (0 != memcmp(header->magic, MAGIC, sizeof(header->magic)) ||
+      kByteOrder != header->byte_order)
+    return false;
+
+  // check the bound of every part before looking into it
+  uint64_t soname = sizeof(Header) + static_cast<uint64_t>(header->path_size);
+  uint64_t entries = align8(soname + header->soname_size);
+  uint64_t groups = align8(entries +
+                           static_cast<uint64_t>(header->num_of_symbols) *
+                           sizeof(Entry));
+  uint64_t slots = align8(groups +
+                          static_cast<uint64_t>(header->num_of_groups) *
+                          sizeof(uint32_t));
+  uint64_t names = align8(slots +
+                          static_cast<uint64_t>(header->num_of_slots) *
+                          sizeof(uint32_t));
+  if (names >= pSize || '\0' != image[pSize - 1])
+    return false;
+
+  if ((0 == header->num_of_groups) != (0 == header->num_of_slots))
+    return false;
+
+  const Entry* entry = reinterpret_cast<const Entry*>(image + entries);
+  for (uint32_t i = 0; i < header->num_of_symbols; ++i) {
+    if (entry[i].name >= pSize - names)
+      return false;
+  }
+
+  const uint32_t* slot = reinterpret_cast<const uint32_t*>(image + slots);
+  for (uint32_t i = 0; i < header->num_of_slots; ++i) {
+    if (slot[i] > header->num_of_symbols)
+      return false;
+  }
+
+  m_pHeader  = header;
+  m_pPath    = image + sizeof(Header);
+  m_pSOName  = image + soname;
+  m_pEntries = entry;
+  m_pGroups  = reinterpret_cast<const uint32_t*>(image + groups);
+  m_pSlots   = slot;
+  m_pNames   = image + names;
+  return true;
+}
+
+size_t DynObjSummary::findDefined(const llvm::StringRef& pName) const
+{
+  if (0 == m_pHeader->num_of_slots)
+    return numOfSymbols();
+
+  uint32_t displacement = m_pGroups[group(pName, m_pHeader->num_of_groups)];
+  uint32_t idx = m_pSlots[slot(pName, displacement, m_pHeader->num_of_slots)];
+  if (0 == idx || pName != getName(idx - 1))
+    return numOfSymbols();
+  return idx - 1;
+}
+
+bool DynObjSummary::emit(const SymbolList& pSymbols,
+                         const llvm::StringRef& pSOName,
+                         const llvm::StringRef& pPath,
+                         uint64_t pFileSize,
+                         uint64_t pModTime,
+                         std::string& pImage)
+{
+  // only the first defined symbol of a name can be found
+  std::vector<uint32_t> keys;
+  llvm::StringMap<uint32_t> seen;
+  for (uint32_t i = 0; i < pSymbols.size(); ++i) {
+    if (ResolveInfo::Undefined == pSymbols[i].desc)
+      continue;
+    if (seen.insert(std::make_pair(pSymbols[i].name, i)).second)
+      keys.push_back(i);
+  }
+
+  // about four names in a group, and a fifth of the slots are free
+  uint32_t num_of_keys = keys.size();
+  uint32_t num_of_groups = 0;
+  uint32_t num_of_slots = 0;
+  if (0 != num_of_keys) {
+    num_of_groups = num_of_keys / 4 + 1;
+    num_of_slots = num_of_keys + num_of_keys / 4 + 1;
+  }
+
+  // place the big groups first, while most of the slots are free
+  std::vector<std::vector<uint32_t> > members(num_of_groups);
+  for (uint32_t i = 0; i < num_of_keys; ++i)
+    members[group(pSymbols[keys[i]].name, num_of_groups)].push_back(keys[i]);
+
+  std::vector<std::pair<size_t, uint32_t> > order;
+  for (uint32_t g = 0; g < num_of_groups; ++g)
+    order.push_back(std::make_pair(members[g].size(), g));
+  std::sort(order.rbegin(), order.rend());
+
+  std::vector<uint32_t> groups(num_of_groups, 0x0);
+  std::vector<uint32_t> slots(num_of_slots, 0x0);
+  std::vector<uint32_t> placed;
+  for (size_t i = 0; i < order.size() && 0 != order[i].first; ++i) {
+    const std::vector<uint32_t>& group_members = members[order[i].second];
+    uint32_t d = 0;
+    for (; d < kMaxDisplacement; ++d) {
+      placed.clear();
+      std::vector<uint32_t>::const_iterator m, mEnd = group_members.end();
+      for (m = group_members.begin(); m != mEnd; ++m) {
+        uint32_t s = slot(pSymbols[*m].name, d, num_of_slots);
+        if (0 != slots[s] ||
+            placed.end() != std::find(placed.begin(), placed.end(), s))
+          break;
+        placed.push_back(s);
+      }
+      if (placed.size() == group_members.size())
+        break;
+    }
+    if (kMaxDisplacement == d)
+      return false;
+
+    groups[order[i].second] = d;
+    for (size_t j = 0; j < placed.size(); ++j)
+      slots[placed[j]] = group_members[j] + 1;
+  }
+
+  Header header;
+  memcpy(header.magic, MAGIC, sizeof(header.magic));
+  header.byte_order     = kByteOrder;
+  header.num_of_symbols = pSymbols.size();
+  header.num_of_groups  = num_of_groups;
+  header.num_of_slots   = num_of_slots;
+  header.path_size      = pPath.size();
+  header.soname_size    = pSOName.size();
+  header.file_size      = pFileSize;
+  header.mod_time       = pModTime;
+
+  std::vector<Entry> entries(pSymbols.size());
+  std::string names;
+  for (size_t i = 0; i < pSymbols.size(); ++i) {
+    entries[i].name       = names.size();
+    entries[i].type       = pSymbols[i].type;
+    entries[i].desc       = pSymbols[i].desc;
+    entries[i].binding    = pSymbols[i].binding;
+    entries[i].visibility = pSymbols[i].visibility;
+    entries[i].size       = pSymbols[i].size;
+    entries[i].value      = pSymbols[i].value;
+    names.append(pSymbols[i].name.data(), pSymbols[i].name.size());
+    names.push_back('\0');
+  }
+  // the image always ends with a NUL
+  names.push_back('\0');
+
+  pImage.assign(reinterpret_cast<const char*>(&header), sizeof(Header));
+  pImage.append(pPath.data(), pPath.size());
+  pImage.append(pSOName.data(), pSOName.size());
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!entries.empty())
+    pImage.append(reinterpret_cast<const char*>(&entries[0]),
+                  entries.size() * sizeof(Entry));
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!groups.empty())
+    pImage.append(reinterpret_cast<const char*>(&groups[0]),
+                  groups.size() * sizeof(uint32_t));
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!slots.empty())
+    pImage.append(reinterpret_cast<const char*>(&slots[0]),
+                  slots.size() * sizeof(uint32_t));
+  pImage.resize(align8(pImage.size()), '\0');
+  pImage.append(names);
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// DynObjSummaryCache
+//===----------------------------------------------------------------------===//
+DynObjSummaryCache::DynObjSummaryCache(const sys::fs::Path& pDir)
+  : m_Dir(pDir) {
+}
+
+DynObjSummaryCache::~DynObjSummaryCache()
+{
+  SummaryListType::iterator it, itEnd = m_SummaryList.end();
+  for (it = m_SummaryList.begin(); it != itEnd; ++it) {
+    (*it)->handle->munmap((*it)->image, (*it)->handle->size());
+    (*it)->handle->close();
+    delete (*it)->handle;
+    delete *it;
+  }
+}
+
+bool DynObjSummaryCache::getKey(const Input& pInput,
+                                sys::fs::Path& pPath,
+                                uint64_t& pFileSize,
+                                uint64_t& pModTime) const
+{
+  // only the shared objects that are files by themselves are cached
+  if (0 != pInput.fileOffset() || !pInput.hasMemArea() ||
+      NULL == pInput.memArea()->handler())
+    return false;
+
+  sys::fs::FileID id;
+  sys::fs::cached::file_id(pInput.path(), id);
+  if (!id.isValid())
+    return false;
+
+  pPath = sys::fs::RealPath(pInput.path());
+  pFileSize = pInput.memArea()->handler()->size();
+  pModTime = id.modTime();
+  return true;
+}
+
+sys::fs::Path
+DynObjSummaryCache::getCachePath(const sys::fs::Path& pPath) const
+{
+  StringHash<ELF> hash_func;
+  std::string name;
+  llvm::raw_string_ostream os(name);
+  os << pPath.filename().native() << '-';
+  os.write_hex(hash_func(pPath.native()));
+  os << ".dsym";
+  os.flush();
+
+  sys::fs::Path result(m_Dir);
+  result.append(name);
+  return result;
+}
+
+const DynObjSummary* DynObjSummaryCache::load(const Input& pInput)
+{
+  sys::fs::Path path;
+  uint64_t file_size, mod_time;
+  if (!getKey(pInput, path, file_size, mod_time))
+    return NULL;
+
+  FileHandle* handle = new FileHandle();
+  void* image = NULL;
+  if (!handle->open(getCachePath(path), FileHandle::ReadOnly) ||
+      0 == handle->size() ||
+      !handle->mmap(image, 0, handle->size())) {
+    delete handle;
+    return NULL;
+  }
+
+  MappedSummary* mapped = new MappedSummary();
+  mapped->handle = handle;
+  mapped->image = image;
+  if (!mapped->summary.map(image, handle->size()) ||
+      mapped->summary.getPath() != llvm::StringRef(path.native()) ||
+      mapped->summary.getFileSize() != file_size ||
+      mapped->summary.getModTime() != mod_time) {
+    // a stale or broken summary. It is replaced by store().
+    handle->munmap(image, handle->size());
+    delete handle;
+    delete mapped;
+    return NULL;
+  }
+
+  m_SummaryList.push_back(mapped);
+  return &mapped->summary;
+}
+
+bool DynObjSummaryCache::store(const Input& pInput,
+                               const DynObjSummary::SymbolList& pSymbols,
+                               const llvm::StringRef& pSOName)
+{
+  sys::fs::Path path;
+  uint64_t file_size, mod_time;
+  if (!getKey(pInput, path, file_size, mod_time))
+    return false;
+
+  sys::fs::Path cache_path = getCachePath(path);
+  std::string image;
+  if (!DynObjSummary::emit(pSymbols, pSOName, path.native(),
+                           file_size, mod_time, image)) {
+    debug(diag::debug_cannot_write_dynobj_summary) << cache_path;
+    return false;
+  }
+
+  // write a temporary file of this process, and rename it to the cache file
+  std::string tmp_name;
+  llvm::raw_string_ostream os(tmp_name);
+  os << cache_path.native() << '.' << sys::getpid() << ".tmp";
+  os.flush();
+  sys::fs::Path tmp_path(tmp_name);
+
+  FileHandle tmp;
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  if (!tmp.open(tmp_path, mode, perm)) {
+    debug(diag::debug_cannot_write_dynobj_summary) << cache_path;
+    return false;
+  }
+
+  bool result = tmp.write(image.data(), 0, image.size());
+  result = tmp.close() && result;
+  if (result)
+    result = (0 == sys::fs::detail::rename(tmp_path, cache_path));
+
+  if (!result) {
+    sys::fs::detail::unlink(tmp_path);
+    debug(diag::debug_cannot_write_dynobj_summary) << cache_path;
+  }
+  return result;
+}
+
@@ -87,5 +87,34 @@ void ELFDynObjFileFormat::initObjectFormat(ObjectBuilder& pBuilder,
                                            llvm::ELF::SHT_GNU_HASH,
                                            llvm::ELF::SHF_ALLOC,
                                            pBitClass / 8);
+  // FIXME: use llvm enum constant
+  f_pRelrDyn      = pBuilder.CreateSection(".relr.dyn",
+                                           LDFileFormat::Target,
+                                           0x13, // SHT_RELR
+                                           llvm::ELF::SHF_ALLOC,
+                                           pBitClass / 8);
+  f_pNoteGNUBuildID = pBuilder.CreateSection(".note.gnu.build-id",
+                                             LDFileFormat::Note,
+                                             llvm::ELF::SHT_NOTE,
+                                             llvm::ELF::SHF_ALLOC,
+                                             0x4);
+  // FIXME: use llvm enum constant
+  f_pSymInfo      = pBuilder.CreateSection(".SUNW_syminfo",
+                                           LDFileFormat::NamePool,
+                                           0x6ffffffc, // SHT_SUNW_syminfo
+                                           llvm::ELF::SHF_ALLOC,
+                                           0x4);
+  // written by GdbIndex, not by the section data
+  f_pGdbIndex     = pBuilder.CreateSection(".gdb_index",
+                                           LDFileFormat::MetaData,
+                                           llvm::ELF::SHT_PROGBITS,
+                                           0x0,
+                                           0x4);
+  // written with the separate debug file
+  f_pGNUDebugLink = pBuilder.CreateSection(".gnu_debuglink",
+                                           LDFileFormat::MetaData,
+                                           llvm::ELF::SHT_PROGBITS,
+                                           0x0,
+                                           0x4);
 }
 
@@ -10,19 +10,67 @@
 
 #include <mcld/LinkerConfig.h>
 #include <mcld/IRBuilder.h>
+#include <mcld/Module.h>
+#include <mcld/LD/DynObjSummary.h>
+#include <mcld/LD/ELFDynSymbolIndex.h>
 #include <mcld/LD/ELFReader.h>
+#include <mcld/LD/NamePool.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/MC/InputBuilder.h>
+#include <mcld/MC/MCLDDirectory.h>
 #include <mcld/MC/MCLDInput.h>
+#include <mcld/MC/SearchDirs.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
 #include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
 #include <mcld/Target/GNULDBackend.h>
 
 #include <llvm/ADT/Twine.h>
 #include <llvm/ADT/OwningPtr.h>
 #include <llvm/Support/ErrorHandling.h>
 
+#include <deque>
+#include <set>
 #include <string>
+#include <utility>
 
 using namespace mcld;
 
+/// OwnedSummary - the summary of a dependency built in the memory
+struct ELFDynObjReader::OwnedSummary
+{
+  std::string image;
+  DynObjSummary summary;
+};
+
+namespace {
+
+/// DecodeSymbols - decode the symbols of the .dynsym pSymTab of pInput
+void DecodeSymbols(const ELFReaderIF& pReader,
+                   Input& pInput,
+                   const MemoryRegion& pSymTab,
+                   const char* pStrTab,
+                   DynObjSummary::SymbolList& pSymbols)
+{
+  ELFReaderIF::DecodedSymbol decoded;
+  for (size_t idx = 1;
+       pReader.decodeSymbol(pInput, pSymTab, pStrTab, idx, decoded);
+       ++idx) {
+    DynObjSummary::Symbol symbol;
+    symbol.name       = decoded.name;
+    symbol.type       = decoded.type;
+    symbol.desc       = decoded.desc;
+    symbol.binding    = decoded.binding;
+    symbol.visibility = decoded.visibility;
+    symbol.size       = decoded.size;
+    symbol.value      = decoded.value;
+    pSymbols.push_back(symbol);
+  }
+}
+
+} // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // ELFDynObjReader
 //===----------------------------------------------------------------------===//
@@ -31,16 +79,37 @@ ELFDynObjReader::ELFDynObjReader(GNULDBackend& pBackend,
                                  const LinkerConfig& pConfig)
   : DynObjReader(),
     m_pELFReader(0),
-    m_Builder(pBuilder) {
+    m_Builder(pBuilder),
+    m_Config(pConfig),
+    m_BitClass(pConfig.targets().bitclass()),
+    m_bLazy(pConfig.options().lazySharedSymbols()),
+    m_pSummaryCache(NULL) {
   if (pConfig.targets().is32Bits() && pConfig.targets().isLittleEndian())
     m_pELFReader = new ELFReader<32, true>(pBackend);
   else if (pConfig.targets().is64Bits() && pConfig.targets().isLittleEndian())
     m_pELFReader = new ELFReader<64, true>(pBackend);
+  else if (pConfig.targets().is32Bits())
+    m_pELFReader = new ELFReader<32, false>(pBackend);
+  else if (pConfig.targets().is64Bits())
+    m_pELFReader = new ELFReader<64, false>(pBackend);
+
+  if (pConfig.options().hasDynObjSummaryCache()) {
+    sys::fs::Path dir(pConfig.options().dynObjSummaryCache());
+    if (sys::fs::is_directory(dir))
+      m_pSummaryCache = new DynObjSummaryCache(dir);
+    else
+      warning(diag::warn_bad_dynobj_summary_cache) << dir;
+  }
 }
 
 ELFDynObjReader::~ELFDynObjReader()
 {
   delete m_pELFReader;
+  // the summaries of the lazy libraries are unmapped with the cache
+  delete m_pSummaryCache;
+  OwnedSummaryList::iterator owned, oEnd = m_OwnedSummaries.end();
+  for (owned = m_OwnedSummaries.begin(); owned != oEnd; ++owned)
+    delete *owned;
 }
 
 /// isMyFormat
@@ -48,13 +117,12 @@ bool ELFDynObjReader::isMyFormat(Input &pInput) const
 {
   assert(pInput.hasMemArea());
 
-  // Don't warning about the frequently requests.
-  // MemoryArea has a list of cache to handle this.
+  // the readers share the probe of the input
   size_t hdr_size = m_pELFReader->getELFHeaderSize();
-  MemoryRegion* region = pInput.memArea()->request(pInput.fileOffset(),
-                                                   hdr_size);
+  if (pInput.probeSize() < hdr_size)
+    return false;
 
-  uint8_t* ELF_hdr = region->start();
+  const uint8_t* ELF_hdr = pInput.probe();
   bool result = true;
   if (!m_pELFReader->isELF(ELF_hdr))
     result = false;
@@ -64,25 +132,55 @@ bool ELFDynObjReader::isMyFormat(Input &pInput) const
     result = false;
   else if (Input::DynObj != m_pELFReader->fileType(ELF_hdr))
     result = false;
-  pInput.memArea()->release(region);
   return result;
 }
 
+/// preload - read ELF header, section header table and .dynsym into the
+/// memory of the input.
+bool ELFDynObjReader::preload(Input& pInput)
+{
+  assert(pInput.hasMemArea());
+  if (NULL == m_pELFReader)
+    return false;
+  return (Input::DynObj == m_pELFReader->preloadTables(*pInput.memArea(),
+                                                   pInput.fileOffset()));
+}
+
+/// numOfGlobalSymbols - the number of non-local symbols in .dynsym
+size_t ELFDynObjReader::numOfGlobalSymbols(Input& pInput)
+{
+  assert(pInput.hasMemArea());
+  size_t count = 0;
+  if (NULL == m_pELFReader ||
+      Input::DynObj != m_pELFReader->countGlobalSymbols(*pInput.memArea(),
+                                                        pInput.fileOffset(),
+                                                        count))
+    return 0;
+  return count;
+}
+
 /// readHeader
 bool ELFDynObjReader::readHeader(Input& pInput)
 {
   assert(pInput.hasMemArea());
 
-  size_t hdr_size = m_pELFReader->getELFHeaderSize();
-  MemoryRegion* region = pInput.memArea()->request(pInput.fileOffset(),
-                                                   hdr_size);
-  uint8_t* ELF_hdr = region->start();
+  // a summary has the SONAME, and readSymbols() needs no section
+  if (NULL != m_pSummaryCache) {
+    const DynObjSummary* summary = m_pSummaryCache->load(pInput);
+    if (NULL != summary) {
+      pInput.setName(summary->getSOName().str());
+      m_Summaries[&pInput] = summary;
+      return true;
+    }
+  }
+
+  // the ELF header is in the probe of the input
+  const uint8_t* ELF_hdr = pInput.probe();
 
   bool shdr_result = m_pELFReader->readSectionHeaders(pInput, ELF_hdr);
-  pInput.memArea()->release(region);
 
-  // read .dynamic to get the correct SONAME
-  bool dyn_result = m_pELFReader->readDynamic(pInput);
+  // read .dynamic to get the correct SONAME and the DT_NEEDED libraries
+  bool dyn_result = m_pELFReader->readDynamic(pInput, &m_Needed[&pInput]);
 
   return (shdr_result && dyn_result);
 }
@@ -92,6 +190,13 @@ bool ELFDynObjReader::readSymbols(Input& pInput)
 {
   assert(pInput.hasMemArea());
 
+  SummaryMap::iterator summary = m_Summaries.find(&pInput);
+  if (m_Summaries.end() != summary) {
+    readSummarySymbols(pInput, *summary->second);
+    m_Summaries.erase(summary);
+    return true;
+  }
+
   LDSection* symtab_shdr = pInput.context()->getSection(".dynsym");
   if (NULL == symtab_shdr) {
     note(diag::note_has_no_symtab) << pInput.name()
@@ -108,6 +213,9 @@ bool ELFDynObjReader::readSymbols(Input& pInput)
     return false;
   }
 
+  if (m_bLazy && readLazySymbols(pInput, *symtab_shdr, *strtab_shdr))
+    return true;
+
   MemoryRegion* symtab_region = pInput.memArea()->request(
               pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
 
@@ -116,9 +224,387 @@ bool ELFDynObjReader::readSymbols(Input& pInput)
   char* strtab = reinterpret_cast<char*>(strtab_region->start());
   bool result = m_pELFReader->readSymbols(pInput, m_Builder,
                                           *symtab_region, strtab);
+  if (NULL != m_pSummaryCache)
+    storeSummary(pInput, *symtab_region, strtab);
   pInput.memArea()->release(symtab_region);
   pInput.memArea()->release(strtab_region);
 
   return result;
 }
 
+/// readLazySymbols - read the undefined symbols of pInput, and index the
+/// defined ones by the hash table of pInput
+bool ELFDynObjReader::readLazySymbols(Input& pInput,
+                                      LDSection& pSymTab,
+                                      LDSection& pStrTab)
+{
+  // prefer .gnu.hash, whose bloom filter rejects most of the names quickly
+  LDSection* hash_shdr = NULL;
+  ELFDynSymbolIndex::Kind kind = ELFDynSymbolIndex::SysV;
+  LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+  for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+    if (NULL == *sect || &pSymTab != (*sect)->getLink())
+      continue;
+    if (llvm::ELF::SHT_GNU_HASH == (*sect)->type()) {
+      hash_shdr = *sect;
+      kind = ELFDynSymbolIndex::GNU;
+      break;
+    }
+    if (llvm::ELF::SHT_HASH == (*sect)->type())
+      hash_shdr = *sect;
+  }
+  if (NULL == hash_shdr)
+    return false;
+
+  MemoryArea& area = *pInput.memArea();
+  LazyLibrary library;
+  library.input = &pInput;
+  library.symtab = area.request(pInput.fileOffset() + pSymTab.offset(),
+                                pSymTab.size());
+  library.strtab = area.request(pInput.fileOffset() + pStrTab.offset(),
+                                pStrTab.size());
+  library.hashtab = area.request(pInput.fileOffset() + hash_shdr->offset(),
+                                 hash_shdr->size());
+  library.summary = NULL;
+  library.index = new ELFDynSymbolIndex(kind,
+                                        m_BitClass,
+                                        library.hashtab->start(),
+                                        library.hashtab->size(),
+                                        library.symtab->start(),
+                                        library.symtab->size(),
+                                        reinterpret_cast<const char*>(
+                                          library.strtab->start()),
+                                        library.strtab->size());
+  if (!library.index->isValid()) {
+    delete library.index;
+    area.release(library.symtab);
+    area.release(library.strtab);
+    area.release(library.hashtab);
+    return false;
+  }
+
+  // the undefined symbols of the library are still read at once, so the
+  // archives read later include the members defining them.
+  pInput.context()->addSymbol(LDSymbol::Null());
+  const char* strtab = reinterpret_cast<const char*>(library.strtab->start());
+  size_t num_of_symbols = library.index->numOfSymbols();
+  for (size_t idx = 1; idx < num_of_symbols; ++idx) {
+    if (library.index->isUndefined(idx))
+      m_pELFReader->readSymbol(pInput, m_Builder, *library.symtab, strtab, idx);
+  }
+
+  if (NULL != m_pSummaryCache)
+    storeSummary(pInput, *library.symtab, strtab);
+
+  m_LazyLibraries.push_back(library);
+  return true;
+}
+
+/// readSummarySymbols - read the symbols of pInput from its summary. The
+/// lazy libraries read only the undefined ones, and look up the others by
+/// the perfect hash of the summary.
+void ELFDynObjReader::readSummarySymbols(Input& pInput,
+                                         const DynObjSummary& pSummary)
+{
+  pInput.context()->addSymbol(LDSymbol::Null());
+  size_t num_of_symbols = pSummary.numOfSymbols();
+  for (size_t idx = 0; idx < num_of_symbols; ++idx) {
+    if (!m_bLazy || pSummary.isUndefined(idx))
+      addSummarySymbol(pInput, pSummary, idx);
+  }
+
+  if (!m_bLazy)
+    return;
+
+  LazyLibrary library;
+  library.input = &pInput;
+  library.symtab = NULL;
+  library.strtab = NULL;
+  library.hashtab = NULL;
+  library.index = NULL;
+  library.summary = &pSummary;
+  m_LazyLibraries.push_back(library);
+}
+
+/// addSummarySymbol - add the pIdx-th symbol of pSummary by m_Builder
+void ELFDynObjReader::addSummarySymbol(Input& pInput,
+                                       const DynObjSummary& pSummary,
+                                       size_t pIdx)
+{
+  const DynObjSummary::Entry& entry = pSummary.getEntry(pIdx);
+  m_Builder.AddSymbol(pInput,
+                      pSummary.getName(pIdx),
+                      static_cast<ResolveInfo::Type>(entry.type),
+                      static_cast<ResolveInfo::Desc>(entry.desc),
+                      static_cast<ResolveInfo::Binding>(entry.binding),
+                      entry.size,
+                      entry.value,
+                      NULL,
+                      static_cast<ResolveInfo::Visibility>(entry.visibility));
+}
+
+/// storeSummary - decode .dynsym of pInput and write the summary of pInput
+void ELFDynObjReader::storeSummary(Input& pInput,
+                                   const MemoryRegion& pSymTab,
+                                   const char* pStrTab)
+{
+  DynObjSummary::SymbolList symbols;
+  DecodeSymbols(*m_pELFReader, pInput, pSymTab, pStrTab, symbols);
+  m_pSummaryCache->store(pInput, symbols, pInput.name());
+}
+
+/// importSymbol - read the definition of pInfo from the first lazy library
+/// defining it
+bool ELFDynObjReader::importSymbol(const ResolveInfo& pInfo)
+{
+  llvm::StringRef name(pInfo.name(), pInfo.nameSize());
+  LazyLibraryList::iterator lib, libEnd = m_LazyLibraries.end();
+  for (lib = m_LazyLibraries.begin(); lib != libEnd; ++lib) {
+    if (NULL != lib->summary) {
+      size_t idx = lib->summary->findDefined(name);
+      if (lib->summary->numOfSymbols() == idx)
+        continue;
+
+      addSummarySymbol(*lib->input, *lib->summary, idx);
+      return true;
+    }
+
+    size_t idx = lib->index->findDefined(name);
+    if (0 == idx)
+      continue;
+
+    const char* strtab = reinterpret_cast<const char*>(lib->strtab->start());
+    m_pELFReader->readSymbol(*lib->input, m_Builder, *lib->symtab, strtab, idx);
+    return true;
+  }
+  return false;
+}
+
+/// importSymbols - import the undefined symbols, and release the lazy
+/// libraries
+void ELFDynObjReader::importSymbols(const NamePool& pPool)
+{
+  if (m_LazyLibraries.empty())
+    return;
+
+  // importing a definition never appends to the undef list
+  const NamePool::UndefListType& undefs = pPool.getUndefList();
+  NamePool::UndefListType::const_iterator undef, uEnd = undefs.end();
+  for (undef = undefs.begin(); undef != uEnd; ++undef) {
+    if ((*undef)->isUndef())
+      importSymbol(**undef);
+  }
+
+  LazyLibraryList::iterator lib, libEnd = m_LazyLibraries.end();
+  for (lib = m_LazyLibraries.begin(); lib != libEnd; ++lib) {
+    if (NULL != lib->summary)
+      continue;
+    delete lib->index;
+    lib->input->memArea()->release(lib->symtab);
+    lib->input->memArea()->release(lib->strtab);
+    lib->input->memArea()->release(lib->hashtab);
+  }
+  m_LazyLibraries.clear();
+}
+
+//===----------------------------------------------------------------------===//
+// DT_NEEDED dependencies
+//===----------------------------------------------------------------------===//
+/// readDependencies - resolve the regular references which are still
+/// undefined by the DT_NEEDED libraries which are not inputs
+void ELFDynObjReader::readDependencies(Module& pModule)
+{
+  // the weak references may stay undefined, and the references of the
+  // shared objects are resolved by their own dependencies at run time
+  std::vector<ResolveInfo*> undefs;
+  const NamePool::UndefListType& list = pModule.getNamePool().getUndefList();
+  NamePool::UndefListType::const_iterator undef, uEnd = list.end();
+  for (undef = list.begin(); undef != uEnd; ++undef) {
+    if ((*undef)->isUndef() && !(*undef)->isDyn() && !(*undef)->isWeak() &&
+        !(*undef)->isNull())
+      undefs.push_back(*undef);
+  }
+  if (undefs.empty())
+    return;
+
+  // the libraries are visited breadth first, as the dynamic linker loads
+  // them, and no more after the last reference is resolved
+  typedef std::pair<Input*, std::string> NeededEntry;
+  std::set<std::string> visited;
+  std::deque<NeededEntry> queue;
+  Module::lib_iterator lib, libEnd = pModule.lib_end();
+  for (lib = pModule.lib_begin(); lib != libEnd; ++lib)
+    visited.insert((*lib)->name());
+  for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
+    const NeededList& needed = getNeeded(**lib);
+    for (size_t i = 0; i < needed.size(); ++i)
+      queue.push_back(NeededEntry(*lib, needed[i]));
+  }
+
+  while (!queue.empty() && !undefs.empty()) {
+    NeededEntry entry = queue.front();
+    queue.pop_front();
+    if (!visited.insert(entry.second).second)
+      continue;
+
+    const Dependency* dep = loadDependency(entry.second, pModule);
+    if (NULL == dep) {
+      warning(diag::warn_cannot_find_needed_library) << entry.second
+                                                     << entry.first->name();
+      continue;
+    }
+    visited.insert(dep->input->name());
+
+    bool used = false;
+    size_t kept = 0;
+    for (size_t i = 0; i < undefs.size(); ++i) {
+      llvm::StringRef name(undefs[i]->name(), undefs[i]->nameSize());
+      size_t idx = dep->summary->findDefined(name);
+      if (dep->summary->numOfSymbols() == idx) {
+        undefs[kept++] = undefs[i];
+        continue;
+      }
+      addSummarySymbol(*dep->input, *dep->summary, idx);
+      used = true;
+    }
+    undefs.resize(kept);
+
+    // with --add-needed, a library resolving a reference gets its own
+    // DT_NEEDED, as the one of its parent
+    const Attribute* attr = entry.first->attribute();
+    if (used && NULL != attr && attr->isAddNeeded())
+      pModule.getLibraryList().push_back(dep->input);
+
+    const NeededList& needed = getNeeded(*dep->input);
+    for (size_t i = 0; i < needed.size(); ++i)
+      queue.push_back(NeededEntry(dep->input, needed[i]));
+  }
+}
+
+/// getNeeded - the DT_NEEDED libraries of pInput
+const ELFDynObjReader::NeededList& ELFDynObjReader::getNeeded(Input& pInput)
+{
+  NeededMap::iterator entry = m_Needed.find(&pInput);
+  if (m_Needed.end() != entry)
+    return entry->second;
+
+  // a library read from its summary has not read its .dynamic
+  NeededList& needed = m_Needed[&pInput];
+  if (m_pELFReader->readSectionHeaders(pInput, pInput.probe()))
+    m_pELFReader->readDynamic(pInput, &needed);
+  return needed;
+}
+
+/// findDependency - find pName in the -rpath-link directories, and then in
+/// the -L directories
+bool ELFDynObjReader::findDependency(const std::string& pName,
+                                     sys::fs::Path& pPath) const
+{
+  if (std::string::npos != pName.find('/')) {
+    pPath.assign(pName);
+    return sys::fs::exists(pPath);
+  }
+
+  const GeneralOptions::RpathList& links =
+    m_Config.options().getRpathLinkList();
+  GeneralOptions::const_rpath_iterator link, linkEnd = links.end();
+  for (link = links.begin(); link != linkEnd; ++link) {
+    sys::fs::Path path(*link);
+    path.append(pName);
+    if (sys::fs::exists(path)) {
+      pPath = path;
+      return true;
+    }
+  }
+
+  const SearchDirs& dirs = m_Config.options().directories();
+  SearchDirs::const_iterator dir, dirEnd = dirs.end();
+  for (dir = dirs.begin(); dir != dirEnd; ++dir) {
+    sys::fs::Path path((*dir)->path());
+    path.append(pName);
+    if (sys::fs::exists(path)) {
+      pPath = path;
+      return true;
+    }
+  }
+  return false;
+}
+
+/// loadDependency - read the header and the summary of pName once per link
+const ELFDynObjReader::Dependency*
+ELFDynObjReader::loadDependency(const std::string& pName, Module& pModule)
+{
+  DependencyMap::iterator entry = m_Dependencies.find(pName);
+  if (m_Dependencies.end() != entry)
+    return (NULL == entry->second.input) ? NULL : &entry->second;
+
+  Dependency& dep = m_Dependencies[pName];
+  dep.input = NULL;
+  dep.summary = NULL;
+
+  sys::fs::Path path;
+  if (!findDependency(pName, path))
+    return NULL;
+
+  InputBuilder& builder = m_Builder.getInputBuilder();
+  Input* input = builder.createInput(pName, path, Input::DynObj);
+  if (!builder.setContext(*input) ||
+      !builder.setMemory(*input, FileHandle::ReadOnly, FileHandle::System) ||
+      !isMyFormat(*input) ||
+      !readHeader(*input))
+    return NULL;
+
+  // the summary cache gives the summary to readHeader()
+  const DynObjSummary* summary = NULL;
+  SummaryMap::iterator cached = m_Summaries.find(input);
+  if (m_Summaries.end() != cached) {
+    summary = cached->second;
+    m_Summaries.erase(cached);
+  }
+  else
+    summary = summarize(*input);
+  if (NULL == summary)
+    return NULL;
+
+  pModule.assignOrdinal(*input);
+  dep.input = input;
+  dep.summary = summary;
+  return &dep;
+}
+
+/// summarize - build the summary of the .dynsym of pInput in the memory, and
+/// store it into the cache
+const DynObjSummary* ELFDynObjReader::summarize(Input& pInput)
+{
+  LDSection* symtab_shdr = pInput.context()->getSection(".dynsym");
+  if (NULL == symtab_shdr || NULL == symtab_shdr->getLink())
+    return NULL;
+  LDSection* strtab_shdr = symtab_shdr->getLink();
+
+  MemoryRegion* symtab_region = pInput.memArea()->request(
+              pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
+  MemoryRegion* strtab_region = pInput.memArea()->request(
+              pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
+  const char* strtab = reinterpret_cast<const char*>(strtab_region->start());
+
+  DynObjSummary::SymbolList symbols;
+  DecodeSymbols(*m_pELFReader, pInput, *symtab_region, strtab, symbols);
+
+  OwnedSummary* owned = new OwnedSummary;
+  bool result = DynObjSummary::emit(symbols, pInput.name(),
+                                    pInput.path().native(), 0, 0,
+                                    owned->image) &&
+                owned->summary.map(owned->image.data(), owned->image.size());
+  if (NULL != m_pSummaryCache)
+    m_pSummaryCache->store(pInput, symbols, pInput.name());
+
+  pInput.memArea()->release(symtab_region);
+  pInput.memArea()->release(strtab_region);
+
+  if (!result) {
+    delete owned;
+    return NULL;
+  }
+  m_OwnedSummaries.push_back(owned);
+  return &owned->summary;
+}
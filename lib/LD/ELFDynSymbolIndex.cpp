@@ -0,0 +1,225 @@
+//===- ELFDynSymbolIndex.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ELFDynSymbolIndex.h>
+#include <mcld/ADT/SizeTraits.h>
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+
+#include <cstddef>
+#include <cstring>
+
+using namespace mcld;
+
+namespace {
+
+uint16_t Read16(const uint8_t* pAddr)
+{
+  uint16_t value;
+  memcpy(&value, pAddr, sizeof(value));
+  return llvm::sys::isLittleEndianHost() ? value : mcld::bswap16(value);
+}
+
+uint32_t Read32(const uint8_t* pAddr)
+{
+  uint32_t value;
+  memcpy(&value, pAddr, sizeof(value));
+  return llvm::sys::isLittleEndianHost() ? value : mcld::bswap32(value);
+}
+
+uint64_t Read64(const uint8_t* pAddr)
+{
+  uint64_t value;
+  memcpy(&value, pAddr, sizeof(value));
+  return llvm::sys::isLittleEndianHost() ? value : mcld::bswap64(value);
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// ELFDynSymbolIndex
+//===----------------------------------------------------------------------===//
+ELFDynSymbolIndex::ELFDynSymbolIndex(Kind pKind,
+                                     unsigned int pBitClass,
+                                     const uint8_t* pHashTab, size_t pHashSize,
+                                     const uint8_t* pSymTab, size_t pSymSize,
+                                     const char* pStrTab, size_t pStrSize)
+  : m_Kind(pKind), m_BitClass(pBitClass),
+    m_pHashTab(pHashTab), m_HashSize(pHashSize),
+    m_pSymTab(pSymTab), m_NumOfSymbols(0),
+    m_pStrTab(pStrTab), m_StrSize(pStrSize),
+    m_bValid(false),
+    m_NumOfBuckets(0), m_NumOfChains(0),
+    m_SymOffset(0), m_BloomSize(0), m_BloomShift(0),
+    m_BucketOffset(0) {
+  if (32 == m_BitClass)
+    m_NumOfSymbols = pSymSize / sizeof(llvm::ELF::Elf32_Sym);
+  else if (64 == m_BitClass)
+    m_NumOfSymbols = pSymSize / sizeof(llvm::ELF::Elf64_Sym);
+  else
+    return;
+
+  size_t num_of_words = m_HashSize / sizeof(uint32_t);
+  if (SysV == m_Kind) {
+    // nbucket, nchain, bucket[nbucket], chain[nchain]
+    if (num_of_words < 2)
+      return;
+    m_NumOfBuckets = word(0);
+    m_NumOfChains  = word(1);
+    m_BucketOffset = 2;
+    m_bValid = (0 != m_NumOfBuckets &&
+                m_NumOfBuckets <= num_of_words &&
+                m_NumOfChains <= num_of_words &&
+                m_BucketOffset + m_NumOfBuckets + m_NumOfChains <=
+                                                                num_of_words);
+  }
+  else {
+    // nbuckets, symoffset, bloom_size, bloom_shift, bloom[bloom_size],
+    // buckets[nbuckets], chain[]. A bloom word is an ELF class word.
+    if (num_of_words < 4)
+      return;
+    m_NumOfBuckets = word(0);
+    m_SymOffset    = word(1);
+    m_BloomSize    = word(2);
+    m_BloomShift   = word(3);
+    size_t bloom_words = m_BloomSize * (m_BitClass / 32);
+    m_BucketOffset = 4 + bloom_words;
+    m_bValid = (0 != m_NumOfBuckets && 0 != m_BloomSize &&
+                m_BloomSize <= num_of_words && m_NumOfBuckets <= num_of_words &&
+                m_BucketOffset + m_NumOfBuckets <= num_of_words);
+  }
+}
+
+size_t ELFDynSymbolIndex::findDefined(const llvm::StringRef& pName) const
+{
+  if (!m_bValid)
+    return 0;
+  if (SysV == m_Kind)
+    return findSysV(pName);
+  return findGNU(pName);
+}
+
+size_t ELFDynSymbolIndex::findSysV(const llvm::StringRef& pName) const
+{
+  uint32_t hash = SysVHash(pName);
+  uint32_t idx = word(m_BucketOffset + (hash % m_NumOfBuckets));
+
+  // every symbol is on at most one chain, so a chain longer than nchain is
+  // a loop in a broken table.
+  for (uint32_t steps = 0; 0 != idx && steps < m_NumOfChains; ++steps) {
+    if (idx >= m_NumOfChains)
+      return 0;
+    if (isMatched(idx, pName))
+      return idx;
+    idx = word(m_BucketOffset + m_NumOfBuckets + idx);
+  }
+  return 0;
+}
+
+size_t ELFDynSymbolIndex::findGNU(const llvm::StringRef& pName) const
+{
+  uint32_t hash = GNUHash(pName);
+
+  // the bloom filter rejects most of the names not in the table
+  unsigned int bits = m_BitClass;
+  uint64_t bloom = bloomWord((hash / bits) % m_BloomSize);
+  uint64_t mask = (uint64_t(1) << (hash % bits)) |
+                  (uint64_t(1) << ((hash >> m_BloomShift) % bits));
+  if (mask != (bloom & mask))
+    return 0;
+
+  uint32_t idx = word(m_BucketOffset + (hash % m_NumOfBuckets));
+  if (idx < m_SymOffset)
+    return 0;
+
+  // the chain of a bucket ends at the hash with the lowest bit set
+  size_t chain = m_BucketOffset + m_NumOfBuckets;
+  size_t num_of_words = m_HashSize / sizeof(uint32_t);
+  while (idx < m_NumOfSymbols && chain + (idx - m_SymOffset) < num_of_words) {
+    uint32_t chain_hash = word(chain + (idx - m_SymOffset));
+    if ((hash | 1) == (chain_hash | 1) && isMatched(idx, pName))
+      return idx;
+    if (0 != (chain_hash & 1))
+      break;
+    ++idx;
+  }
+  return 0;
+}
+
+bool ELFDynSymbolIndex::isUndefined(size_t pIdx) const
+{
+  if (pIdx >= m_NumOfSymbols)
+    return false;
+
+  const uint8_t* sym = symbol(pIdx);
+  uint16_t st_shndx = 0x0;
+  if (32 == m_BitClass)
+    st_shndx = Read16(sym + offsetof(llvm::ELF::Elf32_Sym, st_shndx));
+  else
+    st_shndx = Read16(sym + offsetof(llvm::ELF::Elf64_Sym, st_shndx));
+  return (llvm::ELF::SHN_UNDEF == st_shndx);
+}
+
+bool ELFDynSymbolIndex::isMatched(size_t pIdx,
+                                  const llvm::StringRef& pName) const
+{
+  if (pIdx >= m_NumOfSymbols || isUndefined(pIdx))
+    return false;
+
+  // st_name is the first field of both Elf32_Sym and Elf64_Sym
+  uint32_t st_name = Read32(symbol(pIdx));
+  if (st_name >= m_StrSize || m_StrSize - st_name <= pName.size())
+    return false;
+  return ('\0' == m_pStrTab[st_name + pName.size()] &&
+          0 == memcmp(m_pStrTab + st_name, pName.data(), pName.size()));
+}
+
+const uint8_t* ELFDynSymbolIndex::symbol(size_t pIdx) const
+{
+  if (32 == m_BitClass)
+    return m_pSymTab + pIdx * sizeof(llvm::ELF::Elf32_Sym);
+  return m_pSymTab + pIdx * sizeof(llvm::ELF::Elf64_Sym);
+}
+
+uint32_t ELFDynSymbolIndex::word(size_t pIdx) const
+{
+  return Read32(m_pHashTab + pIdx * sizeof(uint32_t));
+}
+
+uint64_t ELFDynSymbolIndex::bloomWord(size_t pIdx) const
+{
+  const uint8_t* bloom = m_pHashTab + 4 * sizeof(uint32_t);
+  if (32 == m_BitClass)
+    return Read32(bloom + pIdx * sizeof(uint32_t));
+  return Read64(bloom + pIdx * sizeof(uint64_t));
+}
+
+/// SysVHash - the names are hashed as unsigned bytes, as the dynamic linker
+/// does.
+uint32_t ELFDynSymbolIndex::SysVHash(const llvm::StringRef& pName)
+{
+  uint32_t hash = 0;
+  for (size_t i = 0; i < pName.size(); ++i) {
+    hash = (hash << 4) + static_cast<unsigned char>(pName[i]);
+    uint32_t high = hash & 0xF0000000;
+    if (0 != high)
+      hash ^= (high >> 24);
+    hash &= ~high;
+  }
+  return hash;
+}
+
+uint32_t ELFDynSymbolIndex::GNUHash(const llvm::StringRef& pName)
+{
+  uint32_t hash = 5381;
+  for (size_t i = 0; i < pName.size(); ++i)
+    hash = (hash << 5) + hash + static_cast<unsigned char>(pName[i]);
+  return hash;
+}
+
@@ -60,7 +60,12 @@ ELFFileFormat::ELFFileFormat()
     f_pStack(NULL),
     f_pStackNote(NULL),
     f_pDataRelRoLocal(NULL),
-    f_pGNUHashTab(NULL) {
+    f_pGNUHashTab(NULL),
+    f_pRelrDyn(NULL),
+    f_pNoteGNUBuildID(NULL),
+    f_pSymInfo(NULL),
+    f_pGdbIndex(NULL),
+    f_pGNUDebugLink(NULL) {
 
 }
 
@@ -10,17 +10,32 @@
 
 #include <string>
 #include <cassert>
+#include <vector>
 
 #include <llvm/Support/ELF.h>
 #include <llvm/ADT/Twine.h>
+#include <llvm/Support/Casting.h>
 
 #include <mcld/IRBuilder.h>
+#include <mcld/Module.h>
+#include <mcld/MC/InputCost.h>
 #include <mcld/MC/MCLDInput.h>
+#include <mcld/Fragment/NullFragment.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/LD/CompressedSections.h>
 #include <mcld/LD/ELFReader.h>
 #include <mcld/LD/EhFrameReader.h>
 #include <mcld/LD/EhFrame.h>
+#include <mcld/LD/ObjectSummary.h>
+#include <mcld/LD/PackedRelocData.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/RelocationStreamer.h>
 #include <mcld/Target/GNULDBackend.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
 #include <mcld/Object/ObjectBuilder.h>
 
 using namespace mcld;
@@ -38,15 +53,30 @@ ELFObjectReader::ELFObjectReader(GNULDBackend& pBackend,
     m_Builder(pBuilder),
     m_ReadFlag(ParseEhFrame),
     m_Backend(pBackend),
-    m_Config(pConfig) {
+    m_Config(pConfig),
+    m_pSummaryCache(NULL) {
   if (pConfig.targets().is32Bits() && pConfig.targets().isLittleEndian()) {
     m_pELFReader = new ELFReader<32, true>(pBackend);
   }
   else if (pConfig.targets().is64Bits() && pConfig.targets().isLittleEndian()) {
     m_pELFReader = new ELFReader<64, true>(pBackend);
   }
+  else if (pConfig.targets().is32Bits()) {
+    m_pELFReader = new ELFReader<32, false>(pBackend);
+  }
+  else if (pConfig.targets().is64Bits()) {
+    m_pELFReader = new ELFReader<64, false>(pBackend);
+  }
 
   m_pEhFrameReader = new EhFrameReader();
+
+  if (pConfig.options().hasObjectSummaryCache()) {
+    sys::fs::Path dir(pConfig.options().objectSummaryCache());
+    if (sys::fs::is_directory(dir))
+      m_pSummaryCache = new ObjectSummaryCache(dir);
+    else
+      warning(diag::warn_bad_object_summary_cache) << dir;
+  }
 }
 
 /// destructor
@@ -54,6 +84,8 @@ ELFObjectReader::~ELFObjectReader()
 {
   delete m_pELFReader;
   delete m_pEhFrameReader;
+  // the summaries are unmapped with the cache
+  delete m_pSummaryCache;
 }
 
 /// isMyFormat
@@ -61,13 +93,12 @@ bool ELFObjectReader::isMyFormat(Input &pInput) const
 {
   assert(pInput.hasMemArea());
 
-  // Don't warning about the frequently requests.
-  // MemoryArea has a list of cache to handle this.
+  // the readers share the probe of the input
   size_t hdr_size = m_pELFReader->getELFHeaderSize();
-  MemoryRegion* region = pInput.memArea()->request(pInput.fileOffset(),
-                                                     hdr_size);
+  if (pInput.probeSize() < hdr_size)
+    return false;
 
-  uint8_t* ELF_hdr = region->start();
+  const uint8_t* ELF_hdr = pInput.probe();
   bool result = true;
   if (!m_pELFReader->isELF(ELF_hdr))
     result = false;
@@ -77,29 +108,133 @@ bool ELFObjectReader::isMyFormat(Input &pInput) const
     result = false;
   else if (Input::Object != m_pELFReader->fileType(ELF_hdr))
     result = false;
-  pInput.memArea()->release(region);
   return result;
 }
 
+/// preload - read ELF header, section header table and symbol table into the
+/// memory of the input.
+bool ELFObjectReader::preload(Input& pInput)
+{
+  assert(pInput.hasMemArea());
+  if (NULL == m_pELFReader)
+    return false;
+  return (Input::Object == m_pELFReader->preloadTables(*pInput.memArea(),
+                                                   pInput.fileOffset()));
+}
+
+/// preload - read ELF header, section header table and symbol table of the
+/// object at pFileOffset of pArea, such as an archive member, into pArea.
+bool ELFObjectReader::preload(MemoryArea& pArea, size_t pFileOffset)
+{
+  if (NULL == m_pELFReader)
+    return false;
+  return (Input::Object == m_pELFReader->preloadTables(pArea, pFileOffset));
+}
+
+/// numOfGlobalSymbols - the number of non-local symbols in .symtab
+size_t ELFObjectReader::numOfGlobalSymbols(Input& pInput)
+{
+  assert(pInput.hasMemArea());
+  size_t count = 0;
+  if (NULL == m_pELFReader ||
+      Input::Object != m_pELFReader->countGlobalSymbols(*pInput.memArea(),
+                                                        pInput.fileOffset(),
+                                                        count))
+    return 0;
+  return count;
+}
+
+/// readSymbolNames - read the names of the defined non-local symbols of the
+/// object at pFileOffset of pArea, such as an archive member.
+bool ELFObjectReader::readSymbolNames(MemoryArea& pArea,
+                                      size_t pFileOffset,
+                                      std::vector<std::string>& pNames)
+{
+  if (NULL == m_pELFReader)
+    return false;
+  return (Input::Object == m_pELFReader->readSymbolNames(pArea, pFileOffset,
+                                                         pNames));
+}
+
 /// readHeader - read section header and create LDSections.
 bool ELFObjectReader::readHeader(Input& pInput)
 {
   assert(pInput.hasMemArea());
 
-  size_t hdr_size = m_pELFReader->getELFHeaderSize();
-  MemoryRegion* region = pInput.memArea()->request(pInput.fileOffset(),
-                                                     hdr_size);
-  uint8_t* ELF_hdr = region->start();
-  bool result = m_pELFReader->readSectionHeaders(pInput, ELF_hdr);
-  pInput.memArea()->release(region);
+  if (m_Config.options().hasCostReport() && NULL == pInput.cost())
+    pInput.setCost(new InputCost());
+  InputCostScope cost(pInput, InputCost::Parse);
+
+  // With the object summary cache, the objects hashed to a summary are read
+  // from it instead of the ELF structures. The summary of the others is
+  // written for the next links.
+  const ObjectSummary* summary = NULL;
+  uint64_t size = 0, hash = 0;
+  if (NULL != m_pSummaryCache) {
+    size = m_pELFReader->objectSize(pInput);
+    if (ObjectSummaryCache::Hash(pInput, size, hash))
+      summary = m_pSummaryCache->load(hash, size);
+    else
+      size = 0;
+  }
+
+  bool result = true;
+  if (NULL != summary) {
+    result = m_pELFReader->readSummarySections(pInput, *summary);
+    m_Summaries[&pInput] = summary;
+  }
+  else {
+    // the ELF header is in the probe of the input
+    const uint8_t* ELF_hdr = pInput.probe();
+    result = m_pELFReader->readSectionHeaders(pInput, ELF_hdr);
+    if (result && 0 != size)
+      storeSummary(pInput, hash, size);
+  }
+
+  // the bytes mapped are the contents of the sections in the file
+  if (result && NULL != pInput.cost()) {
+    LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+    for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (NULL != *sect && LDFileFormat::BSS != (*sect)->kind() &&
+          LDFileFormat::Null != (*sect)->kind())
+        pInput.cost()->mappedBytes += (*sect)->size();
+    }
+  }
+
+  // Ignore the stripped debug sections before any section is read, so that
+  // neither they nor their relocation sections are read at all, whatever
+  // the order of the section headers is.
+  if (result && m_Config.options().stripDebug()) {
+    LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+    for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (NULL != *sect && LDFileFormat::Debug == (*sect)->kind())
+        (*sect)->setKind(LDFileFormat::Ignore);
+    }
+  }
   return result;
 }
 
 /// readSections - read all regular sections.
 bool ELFObjectReader::readSections(Input& pInput)
 {
-  // handle sections
+  // the symbol table and the string table of the group signatures
+  LDSection* symtab_shdr = NULL;
+  MemoryRegion* symtab = NULL;
+  const char* strtab = NULL;
+  const ObjectSummary* summary = getSummary(pInput);
+  InputCostScope cost(pInput, InputCost::Parse);
+
+  // size the signature set for the groups of the input at once
   LDContext::sect_iterator section, sectEnd = pInput.context()->sectEnd();
+  size_t num_of_groups = 0;
+  for (section = pInput.context()->sectBegin(); section != sectEnd; ++section) {
+    if (NULL != *section && LDFileFormat::Group == (*section)->kind())
+      ++num_of_groups;
+  }
+  if (0 != num_of_groups)
+    signatures().reserve(signatures().size() + num_of_groups);
+
+  // handle sections
   for (section = pInput.context()->sectBegin(); section != sectEnd; ++section) {
     // ignore the section if the LDSection* in input context is NULL
     if (NULL == *section)
@@ -109,38 +244,55 @@ bool ELFObjectReader::readSections(Input& pInput)
       /** group sections **/
       case LDFileFormat::Group: {
         assert(NULL != (*section)->getLink());
-        ResolveInfo* signature =
-              m_pELFReader->readSignature(pInput,
-                                          *(*section)->getLink(),
-                                          (*section)->getInfo());
-
-        bool exist = false;
-        if (0 == signature->nameSize() &&
-            ResolveInfo::Section == signature->type()) {
+        if (NULL == summary && symtab_shdr != (*section)->getLink()) {
+          if (NULL != symtab)
+            pInput.memArea()->release(symtab);
+          symtab_shdr = (*section)->getLink();
+          LDSection* strtab_shdr = symtab_shdr->getLink();
+          assert(NULL != strtab_shdr);
+          symtab = pInput.memArea()->request(
+             pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
+          // the signatures point into the string table, which is viewed
+          // until the input is destroyed
+          MemoryView view = pInput.memArea()->view(
+             pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
+          strtab = reinterpret_cast<const char*>(view.start());
+        }
+
+        // The groups are decided in the order of the inputs, since the
+        // sections are read one input after another. The first group of a
+        // signature wins.
+        ELFReaderIF::DecodedSymbol symbol;
+        symbol.type = ResolveInfo::NoType;
+        llvm::StringRef signature;
+        bool decoded = (NULL != summary) ?
+          m_pELFReader->decodeSummarySymbol(pInput, *summary,
+                                            (*section)->getInfo(), symbol) :
+          m_pELFReader->decodeSymbol(pInput, *symtab, strtab,
+                                     (*section)->getInfo(), symbol);
+        if (decoded)
+          signature = symbol.name;
+        if (signature.empty() && ResolveInfo::Section == symbol.type) {
           // if the signature is a section symbol in input object, we use the
           // section name as group signature.
-          signatures().insert((*section)->name(), exist);
-        } else {
-          signatures().insert(signature->name(), exist);
+          signature = (*section)->name();
         }
 
-        if (exist) {
+        if (!signatures().insert(signature)) {
           // if this is not the first time we see this group signature, then
           // ignore all the members in this group (set Ignore)
-          MemoryRegion* region = pInput.memArea()->request(
+          MemoryView group = pInput.memArea()->view(
                pInput.fileOffset() + (*section)->offset(), (*section)->size());
-          llvm::ELF::Elf32_Word* value =
-                     reinterpret_cast<llvm::ELF::Elf32_Word*>(region->start());
+          const llvm::ELF::Elf32_Word* value =
+                  reinterpret_cast<const llvm::ELF::Elf32_Word*>(group.start());
 
-          size_t size = region->size() / sizeof(llvm::ELF::Elf32_Word);
+          size_t size = group.size() / sizeof(llvm::ELF::Elf32_Word);
           if (llvm::ELF::GRP_COMDAT == *value) {
             for (size_t index = 1; index < size; ++index) {
               pInput.context()->getSection(value[index])->setKind(LDFileFormat::Ignore);
             }
           }
-          pInput.memArea()->release(region);
         }
-        ResolveInfo::Destroy(signature);
         break;
       }
       /** relocation sections **/
@@ -157,31 +309,32 @@ bool ELFObjectReader::readSections(Input& pInput)
         break;
       }
       /** normal sections **/
+      case LDFileFormat::Note:
+        // the linker writes its own build ID into a linked output
+        if (LinkerConfig::Object != m_Config.codeGenType() &&
+            m_Config.options().hasBuildID() &&
+            (*section)->atom().is(SectionAtom::NoteGNUBuildID)) {
+          (*section)->setKind(LDFileFormat::Ignore);
+          continue;
+        }
+      /** Fall through **/
       // FIXME: support Version Kind
       case LDFileFormat::Version:
       // FIXME: support GCCExceptTable Kind
       case LDFileFormat::GCCExceptTable:
       /** Fall through **/
       case LDFileFormat::Regular:
-      case LDFileFormat::Note:
-      case LDFileFormat::MetaData: {
+      case LDFileFormat::MetaData:
+      /** readHeader() has ignored the debug sections for -S **/
+      case LDFileFormat::Debug: {
         SectionData* sd = IRBuilder::CreateSectionData(**section);
-        if (!m_pELFReader->readRegularSection(pInput, *sd))
+        bool read = (*section)->isCompressed() ?
+                      readCompressedSection(pInput, *sd) :
+                      m_pELFReader->readRegularSection(pInput, *sd);
+        if (!read)
           fatal(diag::err_cannot_read_section) << (*section)->name();
         break;
       }
-      case LDFileFormat::Debug: {
-        if (m_Config.options().stripDebug()) {
-          (*section)->setKind(LDFileFormat::Ignore);
-        }
-        else {
-          SectionData* sd = IRBuilder::CreateSectionData(**section);
-          if (!m_pELFReader->readRegularSection(pInput, *sd)) {
-            fatal(diag::err_cannot_read_section) << (*section)->name();
-          }
-        }
-        break;
-      }
       case LDFileFormat::EhFrame: {
         EhFrame* eh_frame = IRBuilder::CreateEhFrame(**section);
 
@@ -189,7 +342,15 @@ bool ELFObjectReader::readSections(Input& pInput)
             (m_ReadFlag & ParseEhFrame)) {
 
           // if --eh-frame-hdr option is given, parse .eh_frame.
-          if (!m_pEhFrameReader->read<32, true>(pInput, *eh_frame)) {
+          bool parsed = false;
+          if (NULL != summary)
+            parsed = readSummaryEhFrame(pInput, *summary, *eh_frame);
+          else if (m_Config.targets().is32Bits())
+            parsed = m_pEhFrameReader->read<32, true>(pInput, *eh_frame);
+          else
+            parsed = m_pEhFrameReader->read<64, true>(pInput, *eh_frame);
+
+          if (!parsed) {
             // if we failed to parse a .eh_frame, we should not parse the rest
             // .eh_frame.
             m_ReadFlag ^= ParseEhFrame;
@@ -233,6 +394,75 @@ bool ELFObjectReader::readSections(Input& pInput)
     }
   } // end of for all sections
 
+  if (NULL != symtab)
+    pInput.memArea()->release(symtab);
+
+  if (NULL != pInput.cost()) {
+    for (section = pInput.context()->sectBegin(); section != sectEnd;
+         ++section) {
+      if (NULL != *section && LDFileFormat::Ignore != (*section)->kind())
+        ++pInput.cost()->sections;
+    }
+  }
+  return true;
+}
+
+namespace {
+
+/// ReadWord - read the pSize bytes of pData in the target byte order
+uint64_t ReadWord(const uint8_t* pData, unsigned int pSize,
+                  bool pIsLittleEndian)
+{
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < pSize; ++i) {
+    unsigned int shift = pIsLittleEndian ? i : (pSize - 1 - i);
+    value |= (uint64_t)pData[i] << (shift * 8);
+  }
+  return value;
+}
+
+} // anonymous namespace
+
+/// readCompressedSection - read the SHF_COMPRESSED section of pSD. The
+/// section becomes an uncompressed one, whose contents are inflated later
+/// with the other compressed sections.
+bool ELFObjectReader::readCompressedSection(Input& pInput, SectionData& pSD)
+{
+  LDSection& section = pSD.getSection();
+  bool is_32bits = m_Config.targets().is32Bits();
+  bool is_little = m_Config.targets().isLittleEndian();
+  size_t chdr_size = is_32bits ? 12 : 24;
+  if (section.size() < chdr_size)
+    return false;
+
+  MemoryView view = pInput.memArea()->view(
+                       pInput.fileOffset() + section.offset(), section.size());
+  if (view.size() != section.size())
+    return false;
+
+  // Elf32_Chdr or Elf64_Chdr
+  const uint8_t* chdr = view.start();
+  uint32_t type = ReadWord(chdr, 4, is_little);
+  uint64_t size = ReadWord(chdr + (is_32bits ? 4 : 8), is_32bits ? 4 : 8,
+                           is_little);
+  uint64_t align = ReadWord(chdr + (is_32bits ? 8 : 16), is_32bits ? 4 : 8,
+                            is_little);
+  if (!CompressedSections::IsSupported(type)) {
+    fatal(diag::fatal_unsupported_section_compression) << section.name()
+                                                       << pInput.path()
+                                                       << type;
+    return false;
+  }
+
+  section.setFlag(section.flag() & ~0x800); // SHF_COMPRESSED
+  section.setSize(size);
+  section.setAlign(align);
+
+  Fragment* frag = m_Builder.getModule().getCompressedSections().append(
+                     pInput, section,
+                     static_cast<CompressedSections::Type>(type),
+                     chdr + chdr_size, view.size() - chdr_size, size);
+  ObjectBuilder::AppendFragment(*frag, pSD);
   return true;
 }
 
@@ -240,6 +470,7 @@ bool ELFObjectReader::readSections(Input& pInput)
 bool ELFObjectReader::readSymbols(Input& pInput)
 {
   assert(pInput.hasMemArea());
+  InputCostScope cost(pInput, InputCost::Parse);
 
   LDSection* symtab_shdr = pInput.context()->getSection(".symtab");
   if (NULL == symtab_shdr) {
@@ -257,58 +488,255 @@ bool ELFObjectReader::readSymbols(Input& pInput)
     return false;
   }
 
-  MemoryRegion* symtab_region = pInput.memArea()->request(
+  bool result = true;
+  const ObjectSummary* summary = getSummary(pInput);
+  if (NULL != summary) {
+    result = m_pELFReader->readSummarySymbols(pInput, m_Builder, *summary);
+  }
+  else {
+    MemoryRegion* symtab_region = pInput.memArea()->request(
              pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
-  MemoryRegion* strtab_region = pInput.memArea()->request(
+    MemoryRegion* strtab_region = pInput.memArea()->request(
              pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
-  char* strtab = reinterpret_cast<char*>(strtab_region->start());
-  bool result = m_pELFReader->readSymbols(pInput,
-                                          m_Builder,
-                                          *symtab_region,
-                                          strtab);
-  pInput.memArea()->release(symtab_region);
-  pInput.memArea()->release(strtab_region);
+    char* strtab = reinterpret_cast<char*>(strtab_region->start());
+    result = m_pELFReader->readSymbols(pInput,
+                                       m_Builder,
+                                       *symtab_region,
+                                       strtab);
+    pInput.memArea()->release(symtab_region);
+    pInput.memArea()->release(strtab_region);
+  }
+
+  if (NULL != pInput.cost()) {
+    LDContext::sym_iterator sym, symEnd = pInput.context()->symTabEnd();
+    for (sym = pInput.context()->symTabBegin(); sym != symEnd; ++sym) {
+      if (NULL != *sym)
+        ++pInput.cost()->symbols;
+    }
+  }
   return result;
 }
 
 bool ELFObjectReader::readRelocations(Input& pInput)
 {
   assert(pInput.hasMemArea());
+  InputCostScope cost(pInput, InputCost::Parse);
+
+  // the relocations of a streamed partial link are copied by the writer
+  if (RelocationStreamer::IsEnabled(m_Config))
+    return m_Backend.getRelocStreamer().addInput(pInput);
 
-  MemoryArea* mem = pInput.memArea();
+  RelocSectionList list;
   LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
-  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
-    if (LDFileFormat::Ignore == (*rs)->kind())
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs)
+    list.push_back(std::make_pair(&pInput, *rs));
+  return readRelocations(list);
+}
+
+namespace { // anonymous
+
+/// RelocDecoder - the body of parallel_for to decode the i-th relocation
+/// section. The sections of the inputs read from summaries have no region.
+struct RelocDecoder
+{
+  const ObjectReader::RelocSectionList* sections;
+  std::vector<MemoryRegion*>* regions;
+  std::vector<const ObjectSummary*>* summaries;
+  std::vector<IRBuilder::RelocEntryList>* entries;
+  std::vector<unsigned char>* results;
+  ELFReaderIF* reader;
+
+  void operator()(size_t pIdx) {
+    getDiagnosticEngine().setOrdinal(pIdx);
+    Input& input = *(*sections)[pIdx].first;
+    const LDSection& section = *(*sections)[pIdx].second;
+    const ObjectSummary* summary = (*summaries)[pIdx];
+    bool result = false;
+    if (NULL != summary)
+      result = reader->decodeSummaryRelocs(input, *summary, section,
+                                           (*entries)[pIdx]);
+    else if (llvm::ELF::SHT_RELA == section.type())
+      result = reader->decodeRela(input, *(*regions)[pIdx], (*entries)[pIdx]);
+    else
+      result = reader->decodeRel(input, *(*regions)[pIdx], (*entries)[pIdx]);
+    (*results)[pIdx] = result ? 0x1 : 0x0;
+  }
+};
+
+} // anonymous namespace
+
+bool ELFObjectReader::readRelocations(const RelocSectionList& pList)
+{
+  // 1. request the regions of the sections to read. MemoryArea is not
+  // requested concurrently.
+  RelocSectionList sections;
+  std::vector<MemoryRegion*> regions;
+  std::vector<const ObjectSummary*> summaries;
+  bool result = true;
+  RelocSectionList::const_iterator rs, rsEnd = pList.end();
+  for (rs = pList.begin(); rs != rsEnd; ++rs) {
+    Input& input = *rs->first;
+    LDSection& section = *rs->second;
+    if (LDFileFormat::Ignore == section.kind() || section.hasRelocData())
       continue;
 
-    uint32_t offset = pInput.fileOffset() + (*rs)->offset();
-    uint32_t size = (*rs)->size();
-    MemoryRegion* region = mem->request(offset, size);
-    IRBuilder::CreateRelocData(**rs); ///< create relocation data for the header
-    switch ((*rs)->type()) {
-      case llvm::ELF::SHT_RELA: {
-        if (!m_pELFReader->readRela(pInput, **rs, *region)) {
-          mem->release(region);
-          return false;
-        }
-        break;
-      }
-      case llvm::ELF::SHT_REL: {
-        if (!m_pELFReader->readRel(pInput, **rs, *region)) {
-          mem->release(region);
-          return false;
-        }
-        break;
-      }
-      default: { ///< should not enter
-        mem->release(region);
-        return false;
+    if (llvm::ELF::SHT_RELA != section.type() &&
+        llvm::ELF::SHT_REL != section.type()) { ///< should not enter
+      result = false;
+      break;
+    }
+
+    assert(input.hasMemArea());
+    const ObjectSummary* summary = getSummary(input);
+    if (NULL != summary)
+      regions.push_back(NULL);
+    else
+      regions.push_back(input.memArea()->request(
+                        input.fileOffset() + section.offset(), section.size()));
+    summaries.push_back(summary);
+    sections.push_back(*rs);
+  }
+
+  // 2. decode the entries. Decoding only reads the regions and the symbols
+  // of the inputs.
+  std::vector<IRBuilder::RelocEntryList> entries(sections.size());
+  std::vector<unsigned char> decoded(sections.size(), 0x0);
+  if (result && !sections.empty()) {
+    RelocDecoder decoder = { &sections, &regions, &summaries, &entries,
+                             &decoded, m_pELFReader };
+    if (m_Config.options().isMultiThreads() && 1 < sections.size()) {
+      getDiagnosticEngine().beginBuffer();
+      parallel_for(m_Config.threads(), 0, sections.size(), decoder);
+      getDiagnosticEngine().endBuffer();
+    }
+    else {
+      for (size_t i = 0; i < sections.size(); ++i)
+        decoder(i);
+    }
+  }
+
+  // 3. create the relocations in the order of pList, so that the factory
+  // hands them out as a serial read does. The entries only applied by the
+  // writer are kept packed instead.
+  for (size_t i = 0; i < sections.size(); ++i) {
+    if (result && 0x0 != decoded[i]) {
+      LDSection& section = *sections[i].second;
+      RelocData* data = IRBuilder::CreateRelocData(section); ///< create relocation data for the header
+      Fragment* target = findPackedTarget(section);
+      if (NULL != target) {
+        PackedRelocData* packed = new PackedRelocData(*target);
+        if (packed->pack(entries[i]))
+          data->setPacked(packed);
+        else
+          delete packed;
       }
-    } // end of switch
+      if (!data->hasPacked())
+        IRBuilder::AddRelocations(section, entries[i]);
+    }
+    else
+      result = false;
+    sections[i].first->memArea()->release(regions[i]);
+  }
+  return result;
+}
 
-    mem->release(region);
-  } // end of for all relocation data
+/// getSummary - the summary that pInput is read from, or NULL
+const ObjectSummary* ELFObjectReader::getSummary(const Input& pInput) const
+{
+  SummaryMap::const_iterator it = m_Summaries.find(&pInput);
+  if (m_Summaries.end() == it)
+    return NULL;
+  return it->second;
+}
 
-  return true;
+/// storeSummary - write the summary of pInput into the cache. The .eh_frame
+/// sections are split as readSections() parses them.
+void ELFObjectReader::storeSummary(Input& pInput,
+                                   uint64_t pHash,
+                                   uint64_t pSize)
+{
+  ObjectSummary::Tables tables;
+  if (!m_pELFReader->summarize(pInput, tables))
+    return;
+
+  LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+  for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+    if (NULL == *sect || LDFileFormat::EhFrame != (*sect)->kind())
+      continue;
+
+    EhFrameReader::SplitList splits;
+    if (m_Config.targets().is32Bits())
+      m_pEhFrameReader->split<32, true>(pInput, **sect, splits);
+    else
+      m_pEhFrameReader->split<64, true>(pInput, **sect, splits);
+
+    ObjectSummary::Section& shdr = tables.sections[(*sect)->index()];
+    shdr.first = tables.eh_entries.size();
+    shdr.num = splits.size();
+    EhFrameReader::SplitList::const_iterator split, sEnd = splits.end();
+    for (split = splits.begin(); split != sEnd; ++split) {
+      ObjectSummary::EhFrameEntry entry = { split->offset, split->size,
+                                            split->data_off, split->kind,
+                                            split->fde_encoding, 0 };
+      tables.eh_entries.push_back(entry);
+    }
+  }
+  m_pSummaryCache->store(pHash, pSize, tables);
+}
+
+/// readSummaryEhFrame - create the entries of pEhFrame from pSummary
+bool ELFObjectReader::readSummaryEhFrame(Input& pInput,
+                                         const ObjectSummary& pSummary,
+                                         EhFrame& pEhFrame)
+{
+  size_t idx = pEhFrame.getSection().index();
+  const ObjectSummary::EhFrameEntry* entries =
+                                           pSummary.getEhFrameEntries(idx);
+  EhFrameReader::SplitList splits(pSummary.getSection(idx).num);
+  for (size_t i = 0; i < splits.size(); ++i) {
+    EhFrameReader::Split& split = splits[i];
+    split.kind = EhFrameReader::Unknown;
+    if (entries[i].kind < EhFrameReader::Unknown)
+      split.kind = static_cast<EhFrameReader::TokenKind>(entries[i].kind);
+    split.offset       = entries[i].offset;
+    split.size         = entries[i].size;
+    split.data_off     = entries[i].data_off;
+    split.fde_encoding = entries[i].fde_encoding;
+  }
+  return m_pEhFrameReader->build(pInput, pEhFrame, splits);
+}
+
+/// findPackedTarget - With --low-memory, the relocations against a debug
+/// section are kept packed and applied when the writer emits the section, if
+/// no pass before reads them as Relocations. The REL relocations keep their
+/// addends in the places, so they are never packed.
+Fragment* ELFObjectReader::findPackedTarget(LDSection& pSection) const
+{
+  if (!m_Config.options().isLowMemory() ||
+      LinkerConfig::Object == m_Config.codeGenType() ||
+      llvm::ELF::SHT_RELA != pSection.type() ||
+      m_Config.options().hasGdbIndex() ||
+      GeneralOptions::CompressDebugSections_None !=
+        m_Config.options().getCompressDebugSections())
+    return NULL;
+
+  LDSection* target = pSection.getLink();
+  if (NULL == target || LDFileFormat::Debug != target->kind() ||
+      0x0 != (target->flag() & llvm::ELF::SHF_ALLOC) ||
+      target->isCompressed() || !target->hasSectionData() ||
+      target->getSectionData()->empty())
+    return NULL;
+
+  // the contents are one region fragment. Input sections end with a
+  // NullFragment.
+  SectionData& data = *target->getSectionData();
+  if (!llvm::isa<RegionFragment>(data.front()))
+    return NULL;
+  SectionData::iterator frag, fragEnd = data.end();
+  for (frag = ++data.begin(); frag != fragEnd; ++frag) {
+    if (!llvm::isa<NullFragment>(*frag))
+      return NULL;
+  }
+  return &data.front();
 }
 
@@ -21,22 +21,154 @@
 #include <mcld/Fragment/RegionFragment.h>
 #include <mcld/Fragment/Stub.h>
 #include <mcld/Fragment/NullFragment.h>
+#include <mcld/LD/CompressedSections.h>
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/SectionData.h>
+#include <mcld/LD/StringTable.h>
 #include <mcld/LD/ELFSegment.h>
 #include <mcld/LD/ELFSegmentFactory.h>
 #include <mcld/LD/RelocData.h>
+#include <mcld/LD/Relocator.h>
+#include <mcld/LD/RelocationStreamer.h>
+#include <mcld/LD/LDContext.h>
 #include <mcld/LD/EhFrame.h>
+#include <mcld/LD/PackedRelocData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/Support/Compression.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/Space.h>
+#include <mcld/Support/TaskQueue.h>
+#include <mcld/Support/ThreadPool.h>
 
 #include <llvm/Support/ErrorHandling.h>
 #include <llvm/Support/system_error.h>
 #include <llvm/Support/ELF.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/Host.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
 
 using namespace llvm;
 using namespace llvm::ELF;
 using namespace mcld;
 
+namespace {
+
+/// AppendWord - append the pSize bytes of pValue in the target byte order
+void AppendWord(std::vector<uint8_t>& pData, uint64_t pValue,
+                unsigned int pSize, bool pIsLittleEndian)
+{
+  for (unsigned int i = 0; i < pSize; ++i) {
+    unsigned int shift = pIsLittleEndian ? i : (pSize - 1 - i);
+    pData.push_back((pValue >> (shift * 8)) & 0xff);
+  }
+}
+
+/// EmitChunkSize - the sections larger than this are emitted in chunks of
+/// fragments of about this size with --threads
+const size_t EmitChunkSize = 4 * 1024 * 1024;
+
+/// KernelCopyMinSize - with --kernel-copy, the region fragments smaller than
+/// this are still copied through the memory, since a system call costs more
+/// than copying them
+const size_t KernelCopyMinSize = 64 * 1024;
+
+/// GetSectionData - the fragments of pSection, or NULL if it has none
+const SectionData* GetSectionData(const LDSection& pSection)
+{
+  if (LDFileFormat::EhFrame == pSection.kind())
+    return pSection.hasEhFrame() ? &pSection.getEhFrame()->getSectionData()
+                                 : NULL;
+  return pSection.hasSectionData() ? pSection.getSectionData() : NULL;
+}
+
+/// GetPassThrough - the zlib input section which is the whole contents of
+/// pSection, or NULL
+const CompressedSections::Entry* GetPassThrough(const Module& pModule,
+                                                const LDSection& pSection)
+{
+  const SectionData* sd = GetSectionData(pSection);
+  if (NULL == sd)
+    return NULL;
+
+  const CompressedSections::Entry* result = NULL;
+  SectionData::const_iterator frag, fragEnd = sd->end();
+  for (frag = sd->begin(); frag != fragEnd; ++frag) {
+    if (0 == frag->size())
+      continue;
+    if (NULL != result)
+      return NULL;
+    result = pModule.getCompressedSections().find(*frag);
+    if (NULL == result)
+      return NULL;
+  }
+
+  if (NULL == result || CompressedSections::Zlib != result->type ||
+      result->size != pSection.size())
+    return NULL;
+  return result;
+}
+
+/// WriteRelocation - write the result of pReloc of pBits bits into pImage,
+/// the image of its output section
+void WriteRelocation(const Relocation& pReloc, unsigned int pBits, bool pSwap,
+                     uint8_t* pImage)
+{
+  uint8_t* place = pImage + pReloc.targetRef().getOutputOffset();
+  switch (pBits) {
+    case 8u: {
+      uint8_t value = pReloc.target();
+      std::memcpy(place, &value, 1);
+      break;
+    }
+    case 16u: {
+      uint16_t value = pReloc.target();
+      if (pSwap)
+        value = mcld::bswap16(value);
+      std::memcpy(place, &value, 2);
+      break;
+    }
+    case 32u: {
+      uint32_t value = pReloc.target();
+      if (pSwap)
+        value = mcld::bswap32(value);
+      std::memcpy(place, &value, 4);
+      break;
+    }
+    case 64u: {
+      uint64_t value = pReloc.target();
+      if (pSwap)
+        value = mcld::bswap64(value);
+      std::memcpy(place, &value, 8);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/// WriteCIEPointers - write the CIE Pointers of the FDEs of pEhFrame into
+/// pImage, the image of the output .eh_frame. An FDE may refer to another
+/// CIE than the one before it in its input, and the removed entries move the
+/// others.
+void WriteCIEPointers(const EhFrame& pEhFrame, bool pSwap,
+                      MemoryRegion& pImage)
+{
+  EhFrame::const_fde_iterator fde, fdeEnd = pEhFrame.fde_end();
+  for (fde = pEhFrame.fde_begin(); fde != fdeEnd; ++fde) {
+    uint64_t place = (*fde)->getOffset() + (*fde)->getCIEPointerOffset();
+    uint32_t value = place - (*fde)->getCIE().getOffset();
+    if (pSwap)
+      value = mcld::bswap32(value);
+    std::memcpy(pImage.getBuffer(place), &value, 4);
+  }
+}
+
+} // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // ELFObjectWriter
 //===----------------------------------------------------------------------===//
@@ -50,14 +182,14 @@ ELFObjectWriter::~ELFObjectWriter()
 {
 }
 
-void ELFObjectWriter::writeSection(MemoryArea& pOutput, LDSection *section)
+MemoryRegion*
+ELFObjectWriter::requestSection(MemoryArea& pOutput, LDSection& pSection)
 {
-  MemoryRegion* region;
-  // Request output region
-  switch (section->kind()) {
+  MemoryRegion* region = NULL;
+  switch (pSection.kind()) {
   case LDFileFormat::Note:
-    if (section->getSectionData() == NULL)
-      return;
+    if (pSection.getSectionData() == NULL)
+      return NULL;
     // Fall through
   case LDFileFormat::Regular:
   case LDFileFormat::Relocation:
@@ -65,10 +197,10 @@ void ELFObjectWriter::writeSection(MemoryArea& pOutput, LDSection *section)
   case LDFileFormat::Debug:
   case LDFileFormat::GCCExceptTable:
   case LDFileFormat::EhFrame: {
-    region = pOutput.request(section->offset(), section->size());
+    region = pOutput.request(pSection.offset(), pSection.size());
     if (NULL == region) {
       llvm::report_fatal_error(llvm::Twine("cannot get enough memory region for output section `") +
-                               llvm::Twine(section->name()) +
+                               llvm::Twine(pSection.name()) +
                                llvm::Twine("'.\n"));
     }
     break;
@@ -81,52 +213,126 @@ void ELFObjectWriter::writeSection(MemoryArea& pOutput, LDSection *section)
   case LDFileFormat::EhFrameHdr:
   case LDFileFormat::StackNote:
     // Ignore these sections
-    return;
+    return NULL;
   default:
     llvm::errs() << "WARNING: unsupported section kind: "
-                 << section->kind()
+                 << pSection.kind()
                  << " of section "
-                 << section->name()
+                 << pSection.name()
                  << ".\n";
-    return;
+    return NULL;
   }
+  return region;
+}
 
+void ELFObjectWriter::emitSection(LDSection& pSection, MemoryRegion& pRegion)
+{
   // Write out sections with data
-  switch(section->kind()) {
+  switch(pSection.kind()) {
+  case LDFileFormat::Debug:
+    if (pSection.isCompressed()) {
+      // the sections may be emitted concurrently, so the map is only read
+      CompressedMap::const_iterator data = m_CompressedData.find(&pSection);
+      assert(m_CompressedData.end() != data);
+      std::memcpy(pRegion.start(), &data->second[0], data->second.size());
+      break;
+    }
+    // Fall through
   case LDFileFormat::GCCExceptTable:
   case LDFileFormat::EhFrame:
   case LDFileFormat::Regular:
-  case LDFileFormat::Debug:
   case LDFileFormat::Note:
     // FIXME: if optimization of exception handling sections is enabled,
     // then we should emit these sections by the other way.
-    emitSectionData(*section, *region);
+    emitSectionData(pSection, pRegion);
     break;
   case LDFileFormat::Relocation:
-    emitRelocation(m_Config, *section, *region);
+    emitRelocation(m_Config, pSection, pRegion);
     break;
   case LDFileFormat::Target:
-    target().emitSectionData(*section, *region);
+    if (target().hasRelrDyn() &&
+        &pSection == &target().getOutputFormat()->getRelrDyn())
+      target().emitRelrDyn(pRegion);
+    else
+      target().emitSectionData(pSection, pRegion);
     break;
   default:
     llvm_unreachable("invalid section kind");
   }
 }
 
-llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
-                                              MemoryArea& pOutput)
+/// EmitTask - emit a section, or the fragments [begin, end) of a section at
+/// offset, on another thread
+struct ELFObjectWriter::EmitTask : public ThreadPool::Task
+{
+  EmitTask(ELFObjectWriter& pWriter, LDSection& pSection,
+           MemoryRegion& pRegion)
+    : writer(&pWriter), section(&pSection), region(&pRegion), split(false),
+      offset(0) { }
+
+  EmitTask(ELFObjectWriter& pWriter, LDSection& pSection,
+           MemoryRegion& pRegion, SectionData::const_iterator pBegin,
+           SectionData::const_iterator pEnd, size_t pOffset)
+    : writer(&pWriter), section(&pSection), region(&pRegion), split(true),
+      begin(pBegin), end(pEnd), offset(pOffset) { }
+
+  ELFObjectWriter* writer;
+  LDSection* section;
+  MemoryRegion* region;
+  bool split;
+  SectionData::const_iterator begin;
+  SectionData::const_iterator end;
+  size_t offset;
+
+  void run() {
+    if (split)
+      writer->emitFragments(begin, end, offset, *region);
+    else
+      writer->emitSection(*section, *region);
+  }
+};
+
+/// NamePoolTask - emit the name pools on another thread
+struct ELFObjectWriter::NamePoolTask : public ThreadPool::Task
+{
+  NamePoolTask(ELFObjectWriter& pWriter, Module& pModule, MemoryArea& pOutput)
+    : writer(&pWriter), module(&pModule), output(&pOutput) { }
+
+  ELFObjectWriter* writer;
+  Module* module;
+  MemoryArea* output;
+
+  void run() { writer->emitNamePools(*module, *output); }
+};
+
+/// RelocTask - apply the fused relocations of a section, and write the
+/// results of all relocations of the section on another thread
+struct ELFObjectWriter::RelocTask : public ThreadPool::Task
+{
+  RelocTask(ELFObjectWriter& pWriter, const RelocList& pRelocs,
+            MemoryRegion& pRegion)
+    : writer(&pWriter), relocs(&pRelocs), region(&pRegion) { }
+
+  ELFObjectWriter* writer;
+  const RelocList* relocs;
+  MemoryRegion* region;
+  RelocList fused;
+  ResultList results;
+
+  void run() {
+    writer->applyRelocations(*relocs, fused, results);
+    writer->writeRelocations(*relocs, *region);
+  }
+};
+
+/// emitNamePools - emit .dynsym, .dynstr, .hash, .symtab and .strtab
+void ELFObjectWriter::emitNamePools(Module& pModule, MemoryArea& pOutput)
 {
   bool is_dynobj = m_Config.codeGenType() == LinkerConfig::DynObj;
   bool is_exec = m_Config.codeGenType() == LinkerConfig::Exec;
-  bool is_binary = m_Config.codeGenType() == LinkerConfig::Binary;
   bool is_object = m_Config.codeGenType() == LinkerConfig::Object;
 
-  assert(is_dynobj || is_exec || is_binary || is_object);
-
   if (is_dynobj || is_exec) {
-    // Write out the interpreter section: .interp
-    target().emitInterp(pOutput);
-
     // Write out name pool sections: .dynsym, .dynstr, .hash
     target().emitDynNamePools(pModule, pOutput);
   }
@@ -135,7 +341,197 @@ llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
     // Write out name pool sections: .symtab, .strtab
     target().emitRegNamePools(pModule, pOutput);
   }
+}
+
+/// writeSections - write the name pools and pSections into the output
+void ELFObjectWriter::writeSections(Module& pModule,
+                                    const SectionList& pSections,
+                                    MemoryArea& pOutput)
+{
+  if (m_Config.options().isMultiThreads() &&
+      !m_Config.options().isLowMemory()) {
+    writeSectionsConcurrently(pModule, pSections, pOutput);
+    return;
+  }
+
+  emitNamePools(pModule, pOutput);
+
+  SectionList::const_iterator sect, sectEnd = pSections.end();
+  if (!FragmentLinker::IsStreamed(m_Config)) {
+    for (sect = pSections.begin(); sect != sectEnd; ++sect) {
+      MemoryRegion* region = requestSection(pOutput, **sect);
+      if (NULL != region)
+        emitSection(**sect, *region);
+    }
+    return;
+  }
+
+  // With --low-memory or --output-strategy=write, the sections are written
+  // in the file order, and each section is written back as soon as its
+  // relocation results are written. --low-memory also drops it. With --threads as well, the contents of a section are
+  // copied by the thread of the TaskQueue while the fused relocations of the
+  // previous section are applied and written.
+  RelocMap relocs;
+  PackedMap packed;
+  for (sect = pSections.begin(); sect != sectEnd; ++sect) {
+    if (!(*sect)->isCompressed()) {
+      relocs[*sect];
+      packed[*sect];
+    }
+  }
+  collectRelocations(pModule, relocs);
+  collectPackedRelocations(pModule, packed);
+
+  std::vector<EmitTask> tasks;
+  tasks.reserve(pSections.size());
+  TaskQueue queue(m_Config.options().isMultiThreads());
+  RelocList fused;
+  ResultList results;
+  for (sect = pSections.begin(); sect != sectEnd; ++sect) {
+    MemoryRegion* region = requestSection(pOutput, **sect);
+    if (NULL == region)
+      continue;
+
+    // the tasks are never moved, since the list is reserved
+    tasks.push_back(EmitTask(*this, **sect, *region));
+    queue.post(tasks.back());
+
+    // the previous section is copied while this one is being copied
+    if (tasks.size() > 1) {
+      queue.wait(tasks.size() - 1);
+      EmitTask& prev = tasks[tasks.size() - 2];
+      flushSection(*prev.section, relocs[prev.section], packed[prev.section],
+                   prev.region, pOutput);
+    }
+
+    fused.clear();
+    results.clear();
+    applyRelocations(relocs[*sect], fused, results);
+    reportRelocations(fused, results);
+  }
+
+  if (!tasks.empty()) {
+    queue.wait();
+    EmitTask& last = tasks.back();
+    flushSection(*last.section, relocs[last.section], packed[last.section],
+                 last.region, pOutput);
+  }
+}
 
+/// writeSectionsConcurrently - write the name pools and pSections on the
+/// thread pool
+void ELFObjectWriter::writeSectionsConcurrently(Module& pModule,
+                                                const SectionList& pSections,
+                                                MemoryArea& pOutput)
+{
+  // Request all regions at first, so that only the task of the name pools
+  // touches the MemoryArea while the tasks run.
+  std::vector<MemoryRegion*> regions(pSections.size(), NULL);
+  for (size_t i = 0; i < pSections.size(); ++i)
+    regions[i] = requestSection(pOutput, *pSections[i]);
+
+  // The name pools and the data sections are emitted at once. A large
+  // section is cut into chunks of fragments. The target sections and the
+  // relocation sections may refer to the symbol indices given by the name
+  // pools, so they are emitted after the pools.
+  std::deque<EmitTask> emits;
+  NamePoolTask pools(*this, pModule, pOutput);
+  ThreadPool::TaskList tasks;
+  tasks.push_back(&pools);
+  std::vector<size_t> later;
+  for (size_t i = 0; i < pSections.size(); ++i) {
+    if (NULL == regions[i])
+      continue;
+
+    LDSection& section = *pSections[i];
+    if (LDFileFormat::Relocation == section.kind() ||
+        LDFileFormat::Target == section.kind()) {
+      later.push_back(i);
+      continue;
+    }
+    // the CIE Pointers of .eh_frame are written after all of its fragments
+    if (section.isCompressed() || LDFileFormat::EhFrame == section.kind()) {
+      emits.push_back(EmitTask(*this, section, *regions[i]));
+      tasks.push_back(&emits.back());
+      continue;
+    }
+
+    const SectionData& sd = *GetSectionData(section);
+    SectionData::const_iterator frag, fragEnd = sd.end();
+    SectionData::const_iterator begin = sd.begin();
+    size_t offset = 0, size = 0;
+    for (frag = sd.begin(); frag != fragEnd; ++frag) {
+      size += frag->size();
+      if (size < EmitChunkSize)
+        continue;
+      SectionData::const_iterator next = frag;
+      ++next;
+      emits.push_back(EmitTask(*this, section, *regions[i], begin, next,
+                               offset));
+      tasks.push_back(&emits.back());
+      begin = next;
+      offset += size;
+      size = 0;
+    }
+    if (begin != fragEnd) {
+      emits.push_back(EmitTask(*this, section, *regions[i], begin, fragEnd,
+                               offset));
+      tasks.push_back(&emits.back());
+    }
+  }
+  m_Config.threads().run(tasks);
+
+  std::vector<size_t>::iterator idx, idxEnd = later.end();
+  for (idx = later.begin(); idx != idxEnd; ++idx)
+    emitSection(*pSections[*idx], *regions[*idx]);
+
+  if (!FragmentLinker::IsStreamed(m_Config))
+    return;
+
+  // apply the fused relocations and write the relocation results section by
+  // section. The diagnostics are reported in the order of the sections.
+  RelocMap relocs;
+  for (size_t i = 0; i < pSections.size(); ++i) {
+    if (NULL != regions[i] && !pSections[i]->isCompressed())
+      relocs[pSections[i]];
+  }
+  collectRelocations(pModule, relocs);
+
+  std::deque<RelocTask> reloc_tasks;
+  tasks.clear();
+  for (size_t i = 0; i < pSections.size(); ++i) {
+    RelocMap::iterator entry = relocs.find(pSections[i]);
+    if (relocs.end() == entry || entry->second.empty())
+      continue;
+    reloc_tasks.push_back(RelocTask(*this, entry->second, *regions[i]));
+    tasks.push_back(&reloc_tasks.back());
+  }
+
+  getDiagnosticEngine().beginBuffer();
+  m_Config.threads().run(tasks);
+  getDiagnosticEngine().endBuffer();
+
+  std::deque<RelocTask>::iterator task, taskEnd = reloc_tasks.end();
+  for (task = reloc_tasks.begin(); task != taskEnd; ++task)
+    reportRelocations(task->fused, task->results);
+}
+
+llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
+                                              MemoryArea& pOutput)
+{
+  bool is_dynobj = m_Config.codeGenType() == LinkerConfig::DynObj;
+  bool is_exec = m_Config.codeGenType() == LinkerConfig::Exec;
+  bool is_binary = m_Config.codeGenType() == LinkerConfig::Binary;
+  bool is_object = m_Config.codeGenType() == LinkerConfig::Object;
+
+  assert(is_dynobj || is_exec || is_binary || is_object);
+
+  // Compress the debug sections first, which changes the file offsets of
+  // the non-allocated sections after them
+  if (is_dynobj || is_exec)
+    compressSections(pModule);
+
+  SectionList sections;
   if (is_binary) {
     // Iterate over the loadable segments and write the corresponding sections
     ELFSegmentFactory::iterator seg, segEnd = target().elfSegmentTable().end();
@@ -144,15 +540,26 @@ llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
       if (llvm::ELF::PT_LOAD == (*seg).type()) {
         ELFSegment::sect_iterator sect, sectEnd = (*seg).end();
         for (sect = (*seg).begin(); sect != sectEnd; ++sect)
-          writeSection(pOutput, *sect);
+          sections.push_back(*sect);
       }
     }
   } else {
     // Write out regular ELF sections
     Module::iterator sect, sectEnd = pModule.end();
     for (sect = pModule.begin(); sect != sectEnd; ++sect)
-      writeSection(pOutput, *sect);
+      sections.push_back(*sect);
+  }
 
+  prepareOutput(pModule, sections, pOutput);
+  collectKernelCopies(pModule, sections, pOutput);
+
+  // Write out the interpreter section: .interp
+  if (is_dynobj || is_exec)
+    target().emitInterp(pOutput);
+
+  writeSections(pModule, sections, pOutput);
+
+  if (!is_binary) {
     emitShStrTab(target().getOutputFormat()->getShStrTab(), pModule, pOutput);
 
     if (m_Config.targets().is32Bits()) {
@@ -177,10 +584,409 @@ llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
       return make_error_code(errc::not_supported);
   }
 
+  m_CompressedData.clear();
   pOutput.clear();
+  copyByKernel(pOutput);
   return llvm::make_error_code(llvm::errc::success);
 }
 
+/// collectRelocations - bucket the input relocations by their target sections
+void ELFObjectWriter::collectRelocations(Module& pModule,
+                                         RelocMap& pRelocs) const
+{
+  Module::obj_iterator input, inEnd = pModule.obj_end();
+  for (input = pModule.obj_begin(); input != inEnd; ++input) {
+    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        // bypass the relocation with NONE type, as normalSyncRelocationResult
+        // does
+        if (0x0 == relocation->type())
+          continue;
+        const LDSection* target_sect =
+          &relocation->targetRef().frag()->getParent()->getSection();
+        RelocMap::iterator entry = pRelocs.find(target_sect);
+        if (pRelocs.end() != entry)
+          entry->second.push_back(relocation);
+      }
+    }
+  }
+
+  // the results are written through each section in the order of the places
+  RelocMap::iterator entry, eEnd = pRelocs.end();
+  for (entry = pRelocs.begin(); entry != eEnd; ++entry)
+    FragmentLinker::SortByPlace(entry->second);
+}
+
+/// applyRelocations - apply the fused relocations in pRelocs
+void ELFObjectWriter::applyRelocations(const RelocList& pRelocs,
+                                       RelocList& pFused,
+                                       ResultList& pResults)
+{
+  Relocator& relocator = *target().getRelocator();
+  RelocList::const_iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc) {
+    if (FragmentLinker::IsFused(m_Config, relocator, **reloc))
+      pFused.push_back(*reloc);
+  }
+  if (pFused.empty())
+    return;
+
+  pResults.resize(pFused.size(), Relocator::OK);
+  relocator.applyBatch(&pFused[0], &pResults[0], pFused.size());
+}
+
+/// reportRelocations - report the failed relocations in pFused
+void ELFObjectWriter::reportRelocations(const RelocList& pFused,
+                                        const ResultList& pResults)
+{
+  Relocator& relocator = *target().getRelocator();
+  for (size_t i = 0; i < pResults.size(); ++i) {
+    if (Relocator::OK != pResults[i])
+      relocator.report(*pFused[i], pResults[i]);
+  }
+}
+
+/// writeRelocations - write the results of pRelocs into pRegion
+void ELFObjectWriter::writeRelocations(const RelocList& pRelocs,
+                                       MemoryRegion& pRegion)
+{
+  // the relocations are not synced to the output by the FragmentLinker if
+  // the output is streamed
+  bool swap =
+    (llvm::sys::isLittleEndianHost() != m_Config.targets().isLittleEndian());
+  Relocator& relocator = *target().getRelocator();
+  RelocList::const_iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc)
+    WriteRelocation(**reloc, (*reloc)->size(relocator), swap, pRegion.start());
+}
+
+/// collectPackedRelocations - bucket the packed relocations by their target
+/// sections
+void ELFObjectWriter::collectPackedRelocations(Module& pModule,
+                                               PackedMap& pPacked) const
+{
+  Module::obj_iterator input, inEnd = pModule.obj_end();
+  for (input = pModule.obj_begin(); input != inEnd; ++input) {
+    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData() ||
+          !(*rs)->getRelocData()->hasPacked())
+        continue;
+      PackedRelocData* relocs = (*rs)->getRelocData()->getPacked();
+      const SectionData* data = relocs->target().getParent();
+      if (NULL == data || relocs->empty())
+        continue;
+      PackedMap::iterator entry = pPacked.find(&data->getSection());
+      if (pPacked.end() != entry)
+        entry->second.push_back(relocs);
+    }
+  }
+}
+
+/// applyPackedRelocations - apply the packed relocations of a section
+void ELFObjectWriter::applyPackedRelocations(const PackedList& pPacked,
+                                             MemoryRegion& pRegion)
+{
+  if (pPacked.empty())
+    return;
+
+  // an entry is loaded into one relocation at a time, whose target data is
+  // read from the written section as the factory reads it from the input
+  bool swap =
+    (llvm::sys::isLittleEndianHost() != m_Config.targets().isLittleEndian());
+  size_t bytes = m_Config.targets().bitclass() / 8;
+  Relocator& relocator = *target().getRelocator();
+  Relocation* relocation = Relocation::Create();
+  PackedRelocData::EntryList entries;
+  PackedList::const_iterator relocs, rEnd = pPacked.end();
+  for (relocs = pPacked.begin(); relocs != rEnd; ++relocs) {
+    Fragment& frag = (*relocs)->target();
+    for (size_t b = 0; b < (*relocs)->numOfBlocks(); ++b) {
+      (*relocs)->decode(b, entries);
+      PackedRelocData::EntryList::const_iterator entry, eEnd = entries.end();
+      for (entry = entries.begin(); entry != eEnd; ++entry) {
+        // bypass the relocation with NONE type, as collectRelocations does
+        if (0x0 == entry->type)
+          continue;
+        relocation->setType(entry->type);
+        relocation->setAddend(entry->addend);
+        relocation->setSymInfo(entry->symbol->resolveInfo());
+        relocation->targetRef().assign(frag, entry->offset);
+
+        uint64_t place = relocation->targetRef().getOutputOffset();
+        uint64_t data = 0x0;
+        if (place + bytes <= pRegion.size()) {
+          if (8 == bytes) {
+            std::memcpy(&data, pRegion.getBuffer(place), 8);
+            if (swap)
+              data = mcld::bswap64(data);
+          }
+          else {
+            uint32_t word = 0x0;
+            std::memcpy(&word, pRegion.getBuffer(place), 4);
+            data = swap ? mcld::bswap32(word) : word;
+          }
+        }
+        relocation->target() = data;
+        relocation->updateAddend();
+
+        Relocator::Result result = relocator.applyRelocation(*relocation);
+        if (Relocator::OK != result)
+          relocator.report(*relocation, result);
+        WriteRelocation(*relocation, relocation->size(relocator), swap,
+                        pRegion.start());
+      }
+    }
+  }
+  Relocation::Destroy(relocation);
+}
+
+/// flushSection - write back pSection and drop its inputs
+void ELFObjectWriter::flushSection(const LDSection& pSection,
+                                   const RelocList& pRelocs,
+                                   const PackedList& pPacked,
+                                   MemoryRegion* pRegion,
+                                   MemoryArea& pOutput)
+{
+  writeRelocations(pRelocs, *pRegion);
+  applyPackedRelocations(pPacked, *pRegion);
+
+  // write back the section and drop the input pages copied into it. They
+  // are read again only if a later pass touches them.
+  pOutput.release(pRegion);
+  if (!m_Config.options().isLowMemory())
+    return;
+
+  const SectionData* sd = GetSectionData(pSection);
+  if (NULL == sd)
+    return;
+
+  SectionData::const_iterator frag, fragEnd = sd->end();
+  for (frag = sd->begin(); frag != fragEnd; ++frag) {
+    if (Fragment::Region != frag->getKind())
+      continue;
+    const MemoryRegion& region =
+      llvm::cast<RegionFragment>(*frag).getRegion();
+    Space::Drop(region.parent(), region.start(), region.size());
+  }
+}
+
+/// prepareOutput - allocate the final size of the output at once
+void ELFObjectWriter::prepareOutput(const Module& pModule,
+                                    const SectionList& pSections,
+                                    MemoryArea& pOutput)
+{
+  GeneralOptions::OutputStrategy strategy =
+    m_Config.options().getOutputStrategy();
+  if (GeneralOptions::OutputStrategy_Map == strategy || !pOutput.hasHandler())
+    return;
+
+  // the layout is done. A binary ends at its last loadable section, and an
+  // ELF file ends at its section header table.
+  uint64_t size = 0;
+  if (LinkerConfig::Binary == m_Config.codeGenType()) {
+    SectionList::const_iterator sect, sectEnd = pSections.end();
+    for (sect = pSections.begin(); sect != sectEnd; ++sect) {
+      if (LDFileFormat::BSS != (*sect)->kind())
+        size = std::max(size, (*sect)->offset() + (*sect)->size());
+    }
+  }
+  else if (m_Config.targets().is32Bits()) {
+    size = getLastStartOffset<32>(pModule) +
+           numOfSectionHeaders(pModule) * sizeof(ELFSizeTraits<32>::Shdr);
+  }
+  else if (m_Config.targets().is64Bits()) {
+    size = getLastStartOffset<64>(pModule) +
+           numOfSectionHeaders(pModule) * sizeof(ELFSizeTraits<64>::Shdr);
+  }
+
+  // the sections of the separate debug file follow the section header table
+  if (0 != size && 0 != target().numOfMainSections()) {
+    const LDSection* last = pModule.back();
+    size = std::max(size, last->offset() + last->size());
+  }
+
+  // if the file can not be allocated, the output is grown and mapped on
+  // demand as usual
+  if (0 == size || !pOutput.handler()->allocate(size))
+    return;
+
+  if (GeneralOptions::OutputStrategy_Preallocate == strategy)
+    pOutput.mapWholeFile();
+  else
+    pOutput.setMapping(false);
+}
+
+/// collectKernelCopies - pick the fragments copied by the kernel
+void ELFObjectWriter::collectKernelCopies(Module& pModule,
+                                          const SectionList& pSections,
+                                          const MemoryArea& pOutput)
+{
+  m_KernelCopies.clear();
+  m_KernelCopied.clear();
+  if (!m_Config.options().kernelCopy() || !pOutput.hasHandler())
+    return;
+
+  // the results of the relocations are written into their fragments later,
+  // so the fragments with relocations are emitted as usual
+  FragmentSet relocated;
+  Module::obj_iterator input, inEnd = pModule.obj_end();
+  for (input = pModule.obj_begin(); input != inEnd; ++input) {
+    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc)
+        relocated.insert(llvm::cast<Relocation>(reloc)->targetRef().frag());
+    }
+  }
+
+  SectionList::const_iterator sect, sectEnd = pSections.end();
+  for (sect = pSections.begin(); sect != sectEnd; ++sect) {
+    // .eh_frame gets its CIE pointers, and the compressed sections are
+    // emitted from their compressed data
+    const LDSection& section = **sect;
+    if ((LDFileFormat::Regular != section.kind() &&
+         LDFileFormat::Debug != section.kind()) ||
+        section.isCompressed() || NULL == section.getSectionData())
+      continue;
+
+    const SectionData& sd = *section.getSectionData();
+    SectionData::const_iterator frag, fragEnd = sd.end();
+    for (frag = sd.begin(); frag != fragEnd; ++frag) {
+      if (Fragment::Region != frag->getKind() ||
+          frag->size() < KernelCopyMinSize ||
+          relocated.count(&*frag))
+        continue;
+
+      const MemoryRegion& region =
+        llvm::cast<RegionFragment>(*frag).getRegion();
+      const Space* space = region.parent();
+      if (NULL == space || NULL == space->file())
+        continue;
+
+      KernelCopy copy;
+      copy.source = space->file();
+      copy.sourceOffset = space->start() + (region.start() - space->memory());
+      copy.offset = section.offset() + frag->getOffset();
+      copy.size = frag->size();
+      copy.data = region.start();
+      m_KernelCopies.push_back(copy);
+      m_KernelCopied.insert(&*frag);
+    }
+  }
+}
+
+/// copyByKernel - copy the picked fragments into the output file
+void ELFObjectWriter::copyByKernel(MemoryArea& pOutput)
+{
+  if (m_KernelCopies.empty())
+    return;
+
+  FileHandle& output = *pOutput.handler();
+  KernelCopyList::const_iterator copy, cEnd = m_KernelCopies.end();
+  for (copy = m_KernelCopies.begin(); copy != cEnd; ++copy) {
+    if (output.copy(*copy->source, copy->sourceOffset, copy->offset,
+                    copy->size))
+      continue;
+    if (!output.write(copy->data, copy->offset, copy->size))
+      fatal(diag::fatal_unwritable_output) << output.path();
+  }
+  m_KernelCopies.clear();
+  m_KernelCopied.clear();
+}
+
+/// compressSections - compress the output sections marked SHF_COMPRESSED
+void ELFObjectWriter::compressSections(Module& pModule)
+{
+  RelocMap relocs;
+  Module::iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    if (LDFileFormat::Debug == (*sect)->kind() && (*sect)->isCompressed())
+      relocs[*sect];
+  }
+  if (relocs.empty())
+    return;
+
+  // The relocations against the compressed sections are applied by the
+  // FragmentLinker but not synced to the output, so their results are
+  // written into the uncompressed images here.
+  collectRelocations(pModule, relocs);
+
+  bool is_32bits = m_Config.targets().is32Bits();
+  bool is_little = m_Config.targets().isLittleEndian();
+  bool swap = (llvm::sys::isLittleEndianHost() != is_little);
+  Relocator& relocator = *target().getRelocator();
+
+  LDSection* first = NULL;
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    LDSection* section = *sect;
+    if (LDFileFormat::Debug != section->kind() || !section->isCompressed())
+      continue;
+    if (NULL == first)
+      first = section;
+
+    // The zlib stream of an input section is copied, if the input section
+    // is the whole output section and no relocation changes it.
+    std::vector<Relocation*>& list = relocs[section];
+    const CompressedSections::Entry* input = NULL;
+    if (list.empty())
+      input = GetPassThrough(pModule, *section);
+
+    std::vector<uint8_t> stream;
+    const uint8_t* zdata = NULL;
+    size_t zsize = 0;
+    if (NULL != input) {
+      zdata = input->stream;
+      zsize = input->streamSize;
+    }
+    else {
+      // build the image as if the section is written into the output
+      std::vector<uint8_t> image(section->size());
+      MemoryRegion* region = MemoryRegion::Create(&image[0], image.size());
+      emitSectionData(*section, *region);
+      MemoryRegion::Destroy(region);
+
+      std::vector<Relocation*>::iterator reloc, rEnd = list.end();
+      for (reloc = list.begin(); reloc != rEnd; ++reloc)
+        WriteRelocation(**reloc, (*reloc)->size(relocator), swap, &image[0]);
+
+      if (!zlib::compress(m_Config.threads(), &image[0], image.size(), stream))
+        fatal(diag::fatal_cannot_compress_section) << section->name();
+      zdata = &stream[0];
+      zsize = stream.size();
+    }
+
+    // Elf32_Chdr or Elf64_Chdr, followed by the zlib stream
+    std::vector<uint8_t>& data = m_CompressedData[section];
+    data.reserve((is_32bits ? 12 : 24) + zsize);
+    AppendWord(data, 1, 4, is_little); // ELFCOMPRESS_ZLIB
+    if (is_32bits) {
+      AppendWord(data, section->size(), 4, is_little);
+      AppendWord(data, section->align(), 4, is_little);
+    }
+    else {
+      AppendWord(data, 0, 4, is_little); // ch_reserved
+      AppendWord(data, section->size(), 8, is_little);
+      AppendWord(data, section->align(), 8, is_little);
+    }
+    data.insert(data.end(), zdata, zdata + zsize);
+
+    section->setSize(data.size());
+    section->setAlign(is_32bits ? 4 : 8);
+  }
+
+  // the compressed sections are not allocated, so only the file offsets of
+  // the sections from the first compressed one are changed
+  target().resetSectionOffset(pModule, pModule.begin() + first->index());
+}
+
 // writeELFHeader - emit ElfXX_Ehdr
 template<size_t SIZE>
 void ELFObjectWriter::writeELFHeader(const LinkerConfig& pConfig,
@@ -234,7 +1040,7 @@ void ELFObjectWriter::writeELFHeader(const LinkerConfig& pConfig,
   header->e_phentsize = sizeof(ElfXX_Phdr);
   header->e_phnum     = target().numOfSegments();
   header->e_shentsize = sizeof(ElfXX_Shdr);
-  header->e_shnum     = pModule.size();
+  header->e_shnum     = numOfSectionHeaders(pModule);
   header->e_shstrndx  = pModule.getSection(".shstrtab")->index();
 }
 
@@ -292,18 +1098,19 @@ void ELFObjectWriter::emitSectionHeader(const Module& pModule,
   typedef typename ELFSizeTraits<SIZE>::Shdr ElfXX_Shdr;
 
   // emit section header
-  unsigned int sectNum = pModule.size();
+  unsigned int sectNum = numOfSectionHeaders(pModule);
   unsigned int header_size = sizeof(ElfXX_Shdr) * sectNum;
   MemoryRegion* region = pOutput.request(getLastStartOffset<SIZE>(pModule),
                                          header_size);
   ElfXX_Shdr* shdr = (ElfXX_Shdr*)region->start();
 
   // Iterate the SectionTable in LDContext
+  // the section names are merged by their tails in .shstrtab
+  const StringTable& shstrtab = target().getShStrTabNames();
   unsigned int sectIdx = 0;
-  unsigned int shstridx = 0; // NULL section has empty name
   for (; sectIdx < sectNum; ++sectIdx) {
     const LDSection *ld_sect   = pModule.getSectionTable().at(sectIdx);
-    shdr[sectIdx].sh_name      = shstridx;
+    shdr[sectIdx].sh_name      = shstrtab.getOffset(ld_sect->name());
     shdr[sectIdx].sh_type      = ld_sect->type();
     shdr[sectIdx].sh_flags     = ld_sect->flag();
     shdr[sectIdx].sh_addr      = ld_sect->addr();
@@ -313,9 +1120,6 @@ void ELFObjectWriter::emitSectionHeader(const Module& pModule,
     shdr[sectIdx].sh_entsize   = getSectEntrySize<SIZE>(*ld_sect);
     shdr[sectIdx].sh_link      = getSectLink(*ld_sect, pConfig);
     shdr[sectIdx].sh_info      = getSectInfo(*ld_sect);
-
-    // adjust strshidx
-    shstridx += ld_sect->name().size() + 1;
   }
 }
 
@@ -360,13 +1164,7 @@ ELFObjectWriter::emitShStrTab(const LDSection& pShStrTab,
 {
   // write out data
   MemoryRegion* region = pOutput.request(pShStrTab.offset(), pShStrTab.size());
-  unsigned char* data = region->start();
-  size_t shstrsize = 0;
-  Module::const_iterator section, sectEnd = pModule.end();
-  for (section = pModule.begin(); section != sectEnd; ++section) {
-    strcpy((char*)(data + shstrsize), (*section)->name().data());
-    shstrsize += (*section)->name().size() + 1;
-  }
+  target().getShStrTabNames().emit((char*)region->start());
 }
 
 /// emitSectionData
@@ -374,28 +1172,31 @@ void
 ELFObjectWriter::emitSectionData(const LDSection& pSection,
                                  MemoryRegion& pRegion) const
 {
-  const SectionData* sd = NULL;
-  switch (pSection.kind()) {
-    case LDFileFormat::Relocation:
-      assert(pSection.hasRelocData());
-      return;
-    case LDFileFormat::EhFrame:
-      assert(pSection.hasEhFrame());
-      sd = &pSection.getEhFrame()->getSectionData();
-      break;
-    default:
-      assert(pSection.hasSectionData());
-      sd = pSection.getSectionData();
-      break;
+  if (LDFileFormat::Relocation == pSection.kind()) {
+    assert(pSection.hasRelocData());
+    return;
   }
+  const SectionData* sd = GetSectionData(pSection);
+  assert(NULL != sd);
   emitSectionData(*sd, pRegion);
+
+  if (LDFileFormat::EhFrame == pSection.kind())
+    WriteCIEPointers(*pSection.getEhFrame(),
+                     llvm::sys::isLittleEndianHost() !=
+                       m_Config.targets().isLittleEndian(),
+                     pRegion);
 }
 
 /// emitRelocation
 void ELFObjectWriter::emitRelocation(const LinkerConfig& pConfig,
                                      const LDSection& pSection,
-                                     MemoryRegion& pRegion) const
+                                     MemoryRegion& pRegion)
 {
+  if (RelocationStreamer::IsEnabled(pConfig)) {
+    target().getRelocStreamer().emit(pSection, pRegion);
+    return;
+  }
+
   const RelocData* sect_data = pSection.getRelocData();
   assert(NULL != sect_data && "SectionData is NULL in emitRelocation!");
 
@@ -516,6 +1317,8 @@ uint64_t ELFObjectWriter::getSectEntrySize(const LDSection& pSection) const
   typedef typename ELFSizeTraits<SIZE>::Rel  ElfXX_Rel;
   typedef typename ELFSizeTraits<SIZE>::Rela ElfXX_Rela;
   typedef typename ELFSizeTraits<SIZE>::Dyn  ElfXX_Dyn;
+  typedef typename ELFSizeTraits<SIZE>::Addr ElfXX_Addr;
+  typedef typename ELFSizeTraits<SIZE>::Half ElfXX_Half;
 
   if (llvm::ELF::SHT_DYNSYM == pSection.type() ||
       llvm::ELF::SHT_SYMTAB == pSection.type())
@@ -529,6 +1332,12 @@ uint64_t ELFObjectWriter::getSectEntrySize(const LDSection& pSection) const
     return sizeof(ElfXX_Word);
   if (llvm::ELF::SHT_DYNAMIC == pSection.type())
     return sizeof(ElfXX_Dyn);
+  // FIXME: use llvm enum constant
+  if (0x13 == pSection.type() ||       // SHT_RELR
+      0x6fffff00 == pSection.type())   // SHT_ANDROID_RELR
+    return sizeof(ElfXX_Addr);
+  if (0x6ffffffc == pSection.type())   // SHT_SUNW_syminfo
+    return 2 * sizeof(ElfXX_Half);
   return 0x0;
 }
 
@@ -543,7 +1352,8 @@ uint64_t ELFObjectWriter::getSectLink(const LDSection& pSection,
   if (llvm::ELF::SHT_DYNAMIC == pSection.type())
     return target().getOutputFormat()->getDynStrTab().index();
   if (llvm::ELF::SHT_HASH     == pSection.type() ||
-      llvm::ELF::SHT_GNU_HASH == pSection.type())
+      llvm::ELF::SHT_GNU_HASH == pSection.type() ||
+      0x6ffffffc              == pSection.type()) // SHT_SUNW_syminfo
     return target().getOutputFormat()->getDynSymTab().index();
   if (llvm::ELF::SHT_REL == pSection.type() ||
       llvm::ELF::SHT_RELA == pSection.type()) {
@@ -572,14 +1382,27 @@ uint64_t ELFObjectWriter::getSectInfo(const LDSection& pSection) const
       return info_link->index();
   }
 
+  // FIXME: use llvm enum constant
+  if (0x6ffffffc == pSection.type()) // SHT_SUNW_syminfo
+    return target().getOutputFormat()->getDynamic().index();
+
   return 0x0;
 }
 
+/// numOfSectionHeaders
+size_t ELFObjectWriter::numOfSectionHeaders(const Module& pModule) const
+{
+  if (0 != target().numOfMainSections())
+    return target().numOfMainSections();
+  return pModule.size();
+}
+
 /// getLastStartOffset
 template<>
 uint64_t ELFObjectWriter::getLastStartOffset<32>(const Module& pModule) const
 {
-  const LDSection* lastSect = pModule.back();
+  const LDSection* lastSect =
+    pModule.getSectionTable().at(numOfSectionHeaders(pModule) - 1);
   assert(lastSect != NULL);
   return Align<32>(lastSect->offset() + lastSect->size());
 }
@@ -588,7 +1411,8 @@ uint64_t ELFObjectWriter::getLastStartOffset<32>(const Module& pModule) const
 template<>
 uint64_t ELFObjectWriter::getLastStartOffset<64>(const Module& pModule) const
 {
-  const LDSection* lastSect = pModule.back();
+  const LDSection* lastSect =
+    pModule.getSectionTable().at(numOfSectionHeaders(pModule) - 1);
   assert(lastSect != NULL);
   return Align<64>(lastSect->offset() + lastSect->size());
 }
@@ -597,20 +1421,37 @@ uint64_t ELFObjectWriter::getLastStartOffset<64>(const Module& pModule) const
 void ELFObjectWriter::emitSectionData(const SectionData& pSD,
                                       MemoryRegion& pRegion) const
 {
-  SectionData::const_iterator fragIter, fragEnd = pSD.end();
-  size_t cur_offset = 0;
-  for (fragIter = pSD.begin(); fragIter != fragEnd; ++fragIter) {
+  emitFragments(pSD.begin(), pSD.end(), 0, pRegion);
+}
+
+/// emitFragments
+void ELFObjectWriter::emitFragments(SectionData::const_iterator pBegin,
+                                    SectionData::const_iterator pEnd,
+                                    size_t pOffset,
+                                    MemoryRegion& pRegion) const
+{
+  SectionData::const_iterator fragIter;
+  size_t cur_offset = pOffset;
+  for (fragIter = pBegin; fragIter != pEnd; ++fragIter) {
     size_t size = fragIter->size();
     switch(fragIter->getKind()) {
       case Fragment::Region: {
+        // the fragments copied by the kernel are never touched here
+        if (!m_KernelCopied.empty() && m_KernelCopied.count(&*fragIter))
+          break;
         const RegionFragment& region_frag = llvm::cast<RegionFragment>(*fragIter);
         const uint8_t* from = region_frag.getRegion().start();
         memcpy(pRegion.getBuffer(cur_offset), from, size);
         break;
       }
       case Fragment::Alignment: {
-        // TODO: emit values with different sizes (> 1 byte), and emit nops
+        // TODO: emit values with different sizes (> 1 byte)
         const AlignFragment& align_frag = llvm::cast<AlignFragment>(*fragIter);
+        if (align_frag.hasEmitNops()) {
+          target().emitNops(pRegion.getBuffer(cur_offset), cur_offset, size);
+          break;
+        }
+
         uint64_t count = size / align_frag.getValueSize();
         switch (align_frag.getValueSize()) {
           case 1u:
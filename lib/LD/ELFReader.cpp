@@ -9,12 +9,17 @@
 #include <mcld/LD/ELFReader.h>
 
 #include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
 #include <mcld/Fragment/FillFragment.h>
 #include <mcld/LD/EhFrame.h>
+#include <mcld/LD/NamePool.h>
 #include <mcld/LD/SectionData.h>
 #include <mcld/Target/GNULDBackend.h>
+#include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/Space.h>
 #include <mcld/Object/ObjectBuilder.h>
 
 #include <cstring>
@@ -29,34 +34,36 @@
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
-// ELFReader<32, true>
+// ELFReader
 //===----------------------------------------------------------------------===//
 /// constructor
-ELFReader<32, true>::ELFReader(GNULDBackend& pBackend)
+template<size_t BIT, bool LITTLEENDIAN>
+ELFReader<BIT, LITTLEENDIAN>::ELFReader(GNULDBackend& pBackend)
   : ELFReaderIF(pBackend) {
 }
 
 /// destructor
-ELFReader<32, true>::~ELFReader()
+template<size_t BIT, bool LITTLEENDIAN>
+ELFReader<BIT, LITTLEENDIAN>::~ELFReader()
 {
 }
 
 /// isELF - is this a ELF file
-bool ELFReader<32, true>::isELF(void* pELFHeader) const
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::isELF(const void* pELFHeader) const
 {
-  llvm::ELF::Elf32_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf32_Ehdr*>(pELFHeader);
-  if (0 == memcmp(llvm::ELF::ElfMagic, hdr, 4))
+  if (0 == memcmp(llvm::ELF::ElfMagic, pELFHeader, 4))
     return true;
   return false;
 }
 
 /// readRegularSection - read a regular section and create fragments.
-bool
-ELFReader<32, true>::readRegularSection(Input& pInput, SectionData& pSD) const
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::readRegularSection(Input& pInput,
+                                                      SectionData& pSD) const
 {
-  uint32_t offset = pInput.fileOffset() + pSD.getSection().offset();
-  uint32_t size = pSD.getSection().size();
+  size_t offset = pInput.fileOffset() + pSD.getSection().offset();
+  size_t size = pSD.getSection().size();
 
   Fragment* frag = IRBuilder::CreateRegion(pInput, offset, size);
   ObjectBuilder::AppendFragment(*frag, pSD);
@@ -64,202 +71,278 @@ ELFReader<32, true>::readRegularSection(Input& pInput, SectionData& pSD) const
 }
 
 /// readSymbols - read ELF symbols and create LDSymbol
-bool ELFReader<32, true>::readSymbols(Input& pInput,
-                                      IRBuilder& pBuilder,
-                                      const MemoryRegion& pRegion,
-                                      const char* pStrTab) const
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::readSymbols(Input& pInput,
+                                               IRBuilder& pBuilder,
+                                               const MemoryRegion& pRegion,
+                                               const char* pStrTab) const
 {
   // get number of symbols
-  size_t entsize = pRegion.size()/sizeof(llvm::ELF::Elf32_Sym);
-  const llvm::ELF::Elf32_Sym* symtab =
-                 reinterpret_cast<const llvm::ELF::Elf32_Sym*>(pRegion.start());
-
-  uint32_t st_name  = 0x0;
-  uint32_t st_value = 0x0;
-  uint32_t st_size  = 0x0;
-  uint8_t  st_info  = 0x0;
-  uint8_t  st_other = 0x0;
-  uint16_t st_shndx = 0x0;
+  size_t entsize = pRegion.size() / sizeof(Symbol);
+  const Symbol* symtab = reinterpret_cast<const Symbol*>(pRegion.start());
 
   // skip the first NULL symbol
   pInput.context()->addSymbol(LDSymbol::Null());
 
-  for (size_t idx = 1; idx < entsize; ++idx) {
-    st_info  = symtab[idx].st_info;
-    st_other = symtab[idx].st_other;
-
-    if (llvm::sys::isLittleEndianHost()) {
-      st_name  = symtab[idx].st_name;
-      st_value = symtab[idx].st_value;
-      st_size  = symtab[idx].st_size;
-      st_shndx = symtab[idx].st_shndx;
-    }
-    else {
-      st_name  = mcld::bswap32(symtab[idx].st_name);
-      st_value = mcld::bswap32(symtab[idx].st_value);
-      st_size  = mcld::bswap32(symtab[idx].st_size);
-      st_shndx = mcld::bswap16(symtab[idx].st_shndx);
-    }
+  // With -x, -X and -s, the local symbols which no relocation refers to are
+  // not in the output. Drop them here instead of creating their ResolveInfo
+  // and LDSymbols. A dropped symbol leaves NULL in the symbol table of the
+  // input, so the indices of the others are kept.
+  GeneralOptions::StripSymbolMode strip =
+                            pBuilder.getConfig().options().getStripSymbolMode();
+  bool discard = (Input::Object == pInput.type() &&
+                  GeneralOptions::KeepAllSymbols != strip);
+  std::vector<bool> referred;
+  if (discard) {
+    referred.resize(entsize, false);
+    markReferredSymbols(pInput, referred);
+  }
 
-    // If the section should not be included, set the st_shndx SHN_UNDEF
-    // - A section in interrelated groups are not included.
-    if (pInput.type() == Input::Object &&
-        st_shndx < llvm::ELF::SHN_LORESERVE &&
-        st_shndx != llvm::ELF::SHN_UNDEF) {
-      if (NULL == pInput.context()->getSection(st_shndx))
-        st_shndx = llvm::ELF::SHN_UNDEF;
+  // The symbols are read in batches. The names of the non-local symbols of
+  // a batch are hashed and their buckets in the NamePool are prefetched
+  // first, and then the symbols are resolved one by one in order.
+  NamePool& pool = pBuilder.getModule().getNamePool();
+  llvm::StringRef names[NamePool::BatchSize];
+  for (size_t begin = 1; begin < entsize; begin += NamePool::BatchSize) {
+    size_t end = std::min(entsize, begin + NamePool::BatchSize);
+    size_t num_of_names = 0;
+    for (size_t idx = begin; idx < end; ++idx) {
+      if (llvm::ELF::STB_LOCAL != (symtab[idx].st_info >> 4))
+        names[num_of_names++] = llvm::StringRef(pStrTab + symtab[idx].st_name);
+    }
+    pool.prefetch(names, num_of_names);
+
+    for (size_t idx = begin; idx < end; ++idx) {
+      if (discard && !referred[idx] &&
+          isDiscardable(symtab[idx], pStrTab, strip)) {
+        pInput.context()->addSymbol(NULL);
+        continue;
+      }
+      addSymbol(pInput, pBuilder, symtab[idx], pStrTab);
     }
+  }
+  pool.prefetch(NULL, 0);
+  return true;
+}
 
-    // get ld_type
-    ResolveInfo::Type ld_type = getSymType(st_info, st_shndx);
+/// readSymbol - read the pIdx-th ELF symbol and create its LDSymbol
+template<size_t BIT, bool LITTLEENDIAN>
+LDSymbol* ELFReader<BIT, LITTLEENDIAN>::readSymbol(Input& pInput,
+                                                   IRBuilder& pBuilder,
+                                                   const MemoryRegion& pRegion,
+                                                   const char* pStrTab,
+                                                   size_t pIdx) const
+{
+  if (0 == pIdx || pIdx >= pRegion.size() / sizeof(Symbol))
+    return NULL;
 
-    // get ld_desc
-    ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, pInput);
+  const Symbol* symtab = reinterpret_cast<const Symbol*>(pRegion.start());
+  return addSymbol(pInput, pBuilder, symtab[pIdx], pStrTab);
+}
 
-    // get ld_binding
-    ResolveInfo::Binding ld_binding = getSymBinding((st_info >> 4), st_shndx, st_other);
+/// decodeSymbol - decode the pIdx-th ELF symbol of pRegion
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::decodeSymbol(Input& pInput,
+                                                const MemoryRegion& pRegion,
+                                                const char* pStrTab,
+                                                size_t pIdx,
+                                                DecodedSymbol& pResult) const
+{
+  if (0 == pIdx || pIdx >= pRegion.size() / sizeof(Symbol))
+    return false;
 
-    // get ld_value - ld_value must be section relative.
-    uint64_t ld_value = getSymValue(st_value, st_shndx, pInput);
+  const Symbol* symtab = reinterpret_cast<const Symbol*>(pRegion.start());
+  decode(pInput, symtab[pIdx], pStrTab, pResult);
+  return true;
+}
 
-    // get ld_vis
-    ResolveInfo::Visibility ld_vis = getSymVisibility(st_other);
+/// addSymbol - decode pSymbol and add it by pBuilder
+template<size_t BIT, bool LITTLEENDIAN>
+LDSymbol* ELFReader<BIT, LITTLEENDIAN>::addSymbol(Input& pInput,
+                                                  IRBuilder& pBuilder,
+                                                  const Symbol& pSymbol,
+                                                  const char* pStrTab) const
+{
+  DecodedSymbol symbol;
+  decode(pInput, pSymbol, pStrTab, symbol);
+  return pBuilder.AddSymbol(pInput,
+                            symbol.name,
+                            symbol.type,
+                            symbol.desc,
+                            symbol.binding,
+                            symbol.size,
+                            symbol.value,
+                            symbol.section, symbol.visibility);
+}
 
-    // get section
-    LDSection* section = NULL;
-    if (st_shndx < llvm::ELF::SHN_LORESERVE) // including ABS and COMMON
-      section = pInput.context()->getSection(st_shndx);
+/// decode - decode pSymbol in the terms of ResolveInfo
+template<size_t BIT, bool LITTLEENDIAN>
+void ELFReader<BIT, LITTLEENDIAN>::decode(Input& pInput,
+                                          const Symbol& pSymbol,
+                                          const char* pStrTab,
+                                          DecodedSymbol& pResult) const
+{
+  SymbolFields fields = { pStrTab + pSymbol.st_name, pSymbol.st_info,
+                          pSymbol.st_other, pSymbol.st_shndx,
+                          pSymbol.st_value, pSymbol.st_size };
+  decodeFields(pInput, fields, pResult);
+}
 
-    // get ld_name
-    std::string ld_name;
-    if (ResolveInfo::Section == ld_type) {
-      // Section symbol's st_name is the section index.
-      assert(NULL != section && "get a invalid section");
-      ld_name = section->name();
-    }
-    else {
-      ld_name = std::string(pStrTab + st_name);
+/// markReferredSymbols - set the bits of pReferred of the symbols which the
+/// relocations of pInput refer to
+template<size_t BIT, bool LITTLEENDIAN>
+void ELFReader<BIT, LITTLEENDIAN>::markReferredSymbols(
+                                        Input& pInput,
+                                        std::vector<bool>& pReferred) const
+{
+  File file(*pInput.memArea(), pInput.fileOffset());
+  LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (llvm::ELF::SHT_RELA == (*rs)->type()) {
+      size_t num = (*rs)->size() / sizeof(Rela);
+      const Rela* relaTab = file.template get<Rela>((*rs)->offset(), num);
+      for (size_t idx = 0; idx < num; ++idx) {
+        uint32_t r_sym = relaTab[idx].getSymbol();
+        if (r_sym < pReferred.size())
+          pReferred[r_sym] = true;
+      }
+    }
+    else if (llvm::ELF::SHT_REL == (*rs)->type()) {
+      size_t num = (*rs)->size() / sizeof(Rel);
+      const Rel* relTab = file.template get<Rel>((*rs)->offset(), num);
+      for (size_t idx = 0; idx < num; ++idx) {
+        uint32_t r_sym = relTab[idx].getSymbol();
+        if (r_sym < pReferred.size())
+          pReferred[r_sym] = true;
+      }
     }
+  }
+}
 
-    pBuilder.AddSymbol(pInput,
-                       ld_name,
-                       ld_type,
-                       ld_desc,
-                       ld_binding,
-                       st_size,
-                       ld_value,
-                       section, ld_vis);
-  } // end of for loop
-  return true;
+/// isDiscardable - can the local symbol pSymbol be dropped in pMode if no
+/// relocation refers to it?
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::isDiscardable(
+                                  const Symbol& pSymbol,
+                                  const char* pStrTab,
+                                  GeneralOptions::StripSymbolMode pMode) const
+{
+  SymbolFields fields = { pStrTab + pSymbol.st_name, pSymbol.st_info,
+                          pSymbol.st_other, pSymbol.st_shndx,
+                          pSymbol.st_value, pSymbol.st_size };
+  return canDiscard(fields, pMode);
 }
 
 //===----------------------------------------------------------------------===//
 // ELFReader::read relocations - read ELF rela and rel, and create Relocation
 //===----------------------------------------------------------------------===//
 /// ELFReader::readRela - read ELF rela and create Relocation
-bool ELFReader<32, true>::readRela(Input& pInput,
-                                   LDSection& pSection,
-                                   const MemoryRegion& pRegion) const
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::readRela(Input& pInput,
+                                            LDSection& pSection,
+                                            const MemoryRegion& pRegion) const
+{
+  // decode all entries, and then add them at once
+  IRBuilder::RelocEntryList entries;
+  if (!decodeRela(pInput, pRegion, entries))
+    return false;
+
+  IRBuilder::AddRelocations(pSection, entries);
+  return true;
+}
+
+/// readRel - read ELF rel and create Relocation
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::readRel(Input& pInput,
+                                           LDSection& pSection,
+                                           const MemoryRegion& pRegion) const
+{
+  // decode all entries, and then add them at once
+  IRBuilder::RelocEntryList entries;
+  if (!decodeRel(pInput, pRegion, entries))
+    return false;
+
+  IRBuilder::AddRelocations(pSection, entries);
+  return true;
+}
+
+/// decodeRela - decode the ELF rela of pRegion into pEntries
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::decodeRela(Input& pInput,
+                                  const MemoryRegion& pRegion,
+                                  IRBuilder::RelocEntryList& pEntries) const
 {
   // get the number of rela
-  size_t entsize = pRegion.size() / sizeof(llvm::ELF::Elf32_Rela);
-  const llvm::ELF::Elf32_Rela* relaTab =
-                reinterpret_cast<const llvm::ELF::Elf32_Rela*>(pRegion.start());
+  size_t entsize = pRegion.size() / sizeof(Rela);
+  const Rela* relaTab = reinterpret_cast<const Rela*>(pRegion.start());
 
+  pEntries.resize(entsize);
   for (size_t idx=0; idx < entsize; ++idx) {
-    uint32_t r_offset = 0x0;
-    uint32_t r_info   = 0x0;
-    int32_t  r_addend = 0;
-    if (llvm::sys::isLittleEndianHost()) {
-      r_offset = relaTab[idx].r_offset;
-      r_info   = relaTab[idx].r_info;
-      r_addend = relaTab[idx].r_addend;
-    }
-    else {
-      r_offset = mcld::bswap32(relaTab[idx].r_offset);
-      r_info   = mcld::bswap32(relaTab[idx].r_info);
-      r_addend = mcld::bswap32(relaTab[idx].r_addend);
-    }
-
-    uint8_t  r_type = static_cast<unsigned char>(r_info);
-    uint32_t r_sym  = (r_info >> 8);
+    uint32_t r_sym = relaTab[idx].getSymbol();
     LDSymbol* symbol = pInput.context()->getSymbol(r_sym);
     if (NULL == symbol) {
       fatal(diag::err_cannot_read_symbol) << r_sym << pInput.path();
     }
 
-    IRBuilder::AddRelocation(pSection, r_type, *symbol, r_offset, r_addend);
+    IRBuilder::RelocEntry& entry = pEntries[idx];
+    entry.type   = relaTab[idx].getType();
+    entry.symbol = symbol;
+    entry.offset = relaTab[idx].r_offset;
+    entry.addend = relaTab[idx].r_addend;
   } // end of for
   return true;
 }
 
-/// readRel - read ELF rel and create Relocation
-bool ELFReader<32, true>::readRel(Input& pInput,
-                                  LDSection& pSection,
-                                  const MemoryRegion& pRegion) const
+/// decodeRel - decode the ELF rel of pRegion into pEntries
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::decodeRel(Input& pInput,
+                                  const MemoryRegion& pRegion,
+                                  IRBuilder::RelocEntryList& pEntries) const
 {
   // get the number of rel
-  size_t entsize = pRegion.size() / sizeof(llvm::ELF::Elf32_Rel);
-  const llvm::ELF::Elf32_Rel* relTab =
-                 reinterpret_cast<const llvm::ELF::Elf32_Rel*>(pRegion.start());
+  size_t entsize = pRegion.size() / sizeof(Rel);
+  const Rel* relTab = reinterpret_cast<const Rel*>(pRegion.start());
 
+  pEntries.resize(entsize);
   for (size_t idx=0; idx < entsize; ++idx) {
-    uint32_t r_offset = 0x0;
-    uint32_t r_info   = 0x0;
-    if (llvm::sys::isLittleEndianHost()) {
-      r_offset = relTab[idx].r_offset;
-      r_info   = relTab[idx].r_info;
-    }
-    else {
-      r_offset = mcld::bswap32(relTab[idx].r_offset);
-      r_info   = mcld::bswap32(relTab[idx].r_info);
-    }
-
-    uint8_t  r_type = static_cast<unsigned char>(r_info);
-    uint32_t r_sym  = (r_info >> 8);
-
+    uint32_t r_sym = relTab[idx].getSymbol();
     LDSymbol* symbol = pInput.context()->getSymbol(r_sym);
     if (NULL == symbol) {
       fatal(diag::err_cannot_read_symbol) << r_sym << pInput.path();
     }
 
-    IRBuilder::AddRelocation(pSection, r_type, *symbol, r_offset);
+    IRBuilder::RelocEntry& entry = pEntries[idx];
+    entry.type   = relTab[idx].getType();
+    entry.symbol = symbol;
+    entry.offset = relTab[idx].r_offset;
+    entry.addend = 0;
   } // end of for
   return true;
 }
 
 /// isMyEndian - is this ELF file in the same endian to me?
-bool ELFReader<32, true>::isMyEndian(void* pELFHeader) const
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::isMyEndian(const void* pELFHeader) const
 {
-  llvm::ELF::Elf32_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf32_Ehdr*>(pELFHeader);
-
-  return (hdr->e_ident[llvm::ELF::EI_DATA] == llvm::ELF::ELFDATA2LSB);
+  const ELFHeader* hdr = reinterpret_cast<const ELFHeader*>(pELFHeader);
+  uint8_t data = LITTLEENDIAN? llvm::ELF::ELFDATA2LSB: llvm::ELF::ELFDATA2MSB;
+  return (hdr->e_ident[llvm::ELF::EI_DATA] == data);
 }
 
 /// isMyMachine - is this ELF file generated for the same machine.
-bool ELFReader<32, true>::isMyMachine(void* pELFHeader) const
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::isMyMachine(const void* pELFHeader) const
 {
-  llvm::ELF::Elf32_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf32_Ehdr*>(pELFHeader);
-
-  if (llvm::sys::isLittleEndianHost())
-    return (hdr->e_machine == target().getInfo().machine());
-  return (mcld::bswap16(hdr->e_machine) == target().getInfo().machine());
+  const ELFHeader* hdr = reinterpret_cast<const ELFHeader*>(pELFHeader);
+  return (hdr->e_machine == target().getInfo().machine());
 }
 
 /// fileType - return the file type
-Input::Type ELFReader<32, true>::fileType(void* pELFHeader) const
+template<size_t BIT, bool LITTLEENDIAN>
+Input::Type ELFReader<BIT, LITTLEENDIAN>::fileType(const void* pELFHeader) const
 {
-  llvm::ELF::Elf32_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf32_Ehdr*>(pELFHeader);
-  uint32_t type = 0x0;
-  if (llvm::sys::isLittleEndianHost())
-    type = hdr->e_type;
-  else
-    type = mcld::bswap16(hdr->e_type);
-
-  switch(type) {
+  const ELFHeader* hdr = reinterpret_cast<const ELFHeader*>(pELFHeader);
+  switch(hdr->e_type.value()) {
   case llvm::ELF::ET_REL:
     return Input::Object;
   case llvm::ELF::ET_EXEC:
@@ -274,633 +357,209 @@ Input::Type ELFReader<32, true>::fileType(void* pELFHeader) const
   }
 }
 
-/// readSectionHeaders - read ELF section header table and create LDSections
-bool
-ELFReader<32, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
+/// preloadTables - read the ELF header, the section header table, .shstrtab
+/// and the symbol table of the file at pBase of pArea into pArea.
+template<size_t BIT, bool LITTLEENDIAN>
+Input::Type
+ELFReader<BIT, LITTLEENDIAN>::preloadTables(MemoryArea& pArea,
+                                            size_t pBase) const
 {
-  llvm::ELF::Elf32_Ehdr* ehdr =
-                          reinterpret_cast<llvm::ELF::Elf32_Ehdr*>(pELFHeader);
-
-  uint32_t shoff     = 0x0;
-  uint16_t shentsize = 0x0;
-  uint32_t shnum     = 0x0;
-  uint32_t shstrtab  = 0x0;
-
-  if (llvm::sys::isLittleEndianHost()) {
-    shoff     = ehdr->e_shoff;
-    shentsize = ehdr->e_shentsize;
-    shnum     = ehdr->e_shnum;
-    shstrtab  = ehdr->e_shstrndx;
-  }
-  else {
-    shoff     = mcld::bswap32(ehdr->e_shoff);
-    shentsize = mcld::bswap16(ehdr->e_shentsize);
-    shnum     = mcld::bswap16(ehdr->e_shnum);
-    shstrtab  = mcld::bswap16(ehdr->e_shstrndx);
-  }
+  MemoryArea* area = &pArea;
+  size_t base = pBase;
 
-  // If the file has no section header table, e_shoff holds zero.
-  if (0x0 == shoff)
-    return true;
-
-  llvm::ELF::Elf32_Shdr *shdr = NULL;
-  MemoryRegion* shdr_region = NULL;
-  uint32_t sh_name      = 0x0;
-  uint32_t sh_type      = 0x0;
-  uint32_t sh_flags     = 0x0;
-  uint32_t sh_offset    = 0x0;
-  uint32_t sh_size      = 0x0;
-  uint32_t sh_link      = 0x0;
-  uint32_t sh_info      = 0x0;
-  uint32_t sh_addralign = 0x0;
-
-  // if shnum and shstrtab overflow, the actual values are in the 1st shdr
-  if (shnum == llvm::ELF::SHN_UNDEF || shstrtab == llvm::ELF::SHN_XINDEX) {
-    shdr_region = pInput.memArea()->request(pInput.fileOffset() + shoff,
-                                            shentsize);
-    shdr = reinterpret_cast<llvm::ELF::Elf32_Shdr*>(shdr_region->start());
-
-    if (llvm::sys::isLittleEndianHost()) {
-      sh_size = shdr->sh_size;
-      sh_link = shdr->sh_link;
-    }
-    else {
-      sh_size = mcld::bswap32(shdr->sh_size);
-      sh_link = mcld::bswap32(shdr->sh_link);
-    }
-    pInput.memArea()->release(shdr_region);
+  Space* space = area->preload(base, sizeof(ELFHeader));
+  if (NULL == space)
+    return Input::Unknown;
 
-    if (shnum == llvm::ELF::SHN_UNDEF)
-      shnum = sh_size;
-    if (shstrtab == llvm::ELF::SHN_XINDEX)
-      shstrtab = sh_link;
+  void* ELF_hdr = space->memory() + (base - space->start());
+  if (!isELF(ELF_hdr) || !isMyEndian(ELF_hdr) || !isMyMachine(ELF_hdr))
+    return Input::Unknown;
 
-    shoff += shentsize;
-  }
+  Input::Type type = fileType(ELF_hdr);
+  if (Input::Object != type && Input::DynObj != type)
+    return type;
 
-  shdr_region = pInput.memArea()->request(pInput.fileOffset() + shoff,
-                                          shnum * shentsize);
-  llvm::ELF::Elf32_Shdr * shdrTab =
-    reinterpret_cast<llvm::ELF::Elf32_Shdr*>(shdr_region->start());
+  const ELFHeader* ehdr = reinterpret_cast<const ELFHeader*>(ELF_hdr);
+  uint64_t shoff     = ehdr->e_shoff;
+  uint16_t shentsize = ehdr->e_shentsize;
+  uint32_t shnum     = ehdr->e_shnum;
+  uint32_t shstrtab  = ehdr->e_shstrndx;
 
-  // get .shstrtab first
-  shdr = &shdrTab[shstrtab];
-  if (llvm::sys::isLittleEndianHost()) {
-    sh_offset = shdr->sh_offset;
-    sh_size   = shdr->sh_size;
-  }
-  else {
-    sh_offset = mcld::bswap32(shdr->sh_offset);
-    sh_size   = mcld::bswap32(shdr->sh_size);
-  }
+  // leave the files without section header table and the files with
+  // overflowed shnum to readSectionHeaders.
+  if (0x0 == shoff || llvm::ELF::SHN_UNDEF == shnum ||
+      llvm::ELF::SHN_XINDEX == shstrtab || sizeof(SectionHeader) != shentsize)
+    return type;
 
-  MemoryRegion* sect_name_region = pInput.memArea()->request(
-                                      pInput.fileOffset() + sh_offset, sh_size);
-  const char* sect_name =
-                       reinterpret_cast<const char*>(sect_name_region->start());
+  space = area->preload(base + shoff, shnum * shentsize);
+  if (NULL == space)
+    return type;
 
-  LinkInfoList link_info_list;
+  const SectionHeader* shdrTab = reinterpret_cast<const SectionHeader*>(
+                          space->memory() + (base + shoff - space->start()));
 
-  // create all LDSections, including first NULL section.
+  uint32_t symtab_type = (Input::Object == type)? llvm::ELF::SHT_SYMTAB:
+                                                  llvm::ELF::SHT_DYNSYM;
   for (size_t idx = 0; idx < shnum; ++idx) {
-    if (llvm::sys::isLittleEndianHost()) {
-      sh_name      = shdrTab[idx].sh_name;
-      sh_type      = shdrTab[idx].sh_type;
-      sh_flags     = shdrTab[idx].sh_flags;
-      sh_offset    = shdrTab[idx].sh_offset;
-      sh_size      = shdrTab[idx].sh_size;
-      sh_link      = shdrTab[idx].sh_link;
-      sh_info      = shdrTab[idx].sh_info;
-      sh_addralign = shdrTab[idx].sh_addralign;
-    }
-    else {
-      sh_name      = mcld::bswap32(shdrTab[idx].sh_name);
-      sh_type      = mcld::bswap32(shdrTab[idx].sh_type);
-      sh_flags     = mcld::bswap32(shdrTab[idx].sh_flags);
-      sh_offset    = mcld::bswap32(shdrTab[idx].sh_offset);
-      sh_size      = mcld::bswap32(shdrTab[idx].sh_size);
-      sh_link      = mcld::bswap32(shdrTab[idx].sh_link);
-      sh_info      = mcld::bswap32(shdrTab[idx].sh_info);
-      sh_addralign = mcld::bswap32(shdrTab[idx].sh_addralign);
-    }
-
-    LDSection* section = IRBuilder::CreateELFHeader(pInput,
-                                                    sect_name+sh_name,
-                                                    sh_type,
-                                                    sh_flags,
-                                                    sh_addralign);
-    section->setSize(sh_size);
-    section->setOffset(sh_offset);
-    section->setInfo(sh_info);
-
-    if (sh_link != 0x0 || sh_info != 0x0) {
-      LinkInfo link_info = { section, sh_link, sh_info };
-      link_info_list.push_back(link_info);
-    }
-  } // end of for
-
-  // set up InfoLink
-  LinkInfoList::iterator info, infoEnd = link_info_list.end();
-  for (info = link_info_list.begin(); info != infoEnd; ++info) {
-    if (LDFileFormat::NamePool == info->section->kind() ||
-        LDFileFormat::Group == info->section->kind() ||
-        LDFileFormat::Note == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_link));
+    uint32_t sh_type = shdrTab[idx].sh_type;
+    if (idx != shstrtab && symtab_type != sh_type)
       continue;
-    }
-    if (LDFileFormat::Relocation == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_info));
-      continue;
-    }
-  }
 
-  pInput.memArea()->release(shdr_region);
-  pInput.memArea()->release(sect_name_region);
+    area->preload(base + shdrTab[idx].sh_offset, shdrTab[idx].sh_size);
 
-  return true;
-}
-
-/// readSignature - read a symbol from the given Input and index in symtab
-/// This is used to get the signature of a group section.
-ResolveInfo* ELFReader<32, true>::readSignature(Input& pInput,
-                                                LDSection& pSymTab,
-                                                uint32_t pSymIdx) const
-{
-  LDSection* symtab = &pSymTab;
-  LDSection* strtab = symtab->getLink();
-  assert(NULL != symtab && NULL != strtab);
-
-  uint32_t offset = pInput.fileOffset() + symtab->offset() +
-                      sizeof(llvm::ELF::Elf32_Sym) * pSymIdx;
-  MemoryRegion* symbol_region =
-                pInput.memArea()->request(offset, sizeof(llvm::ELF::Elf32_Sym));
-  llvm::ELF::Elf32_Sym* entry =
-                reinterpret_cast<llvm::ELF::Elf32_Sym*>(symbol_region->start());
-
-  uint32_t st_name  = 0x0;
-  uint8_t  st_info  = 0x0;
-  uint8_t  st_other = 0x0;
-  uint16_t st_shndx = 0x0;
-  st_info  = entry->st_info;
-  st_other = entry->st_other;
-  if (llvm::sys::isLittleEndianHost()) {
-    st_name  = entry->st_name;
-    st_shndx = entry->st_shndx;
-  }
-  else {
-    st_name  = mcld::bswap32(entry->st_name);
-    st_shndx = mcld::bswap16(entry->st_shndx);
+    // preload the string table of the symbol table, too.
+    uint32_t sh_link = shdrTab[idx].sh_link;
+    if (symtab_type == sh_type && sh_link < shnum)
+      area->preload(base + shdrTab[sh_link].sh_offset,
+                    shdrTab[sh_link].sh_size);
   }
-
-  MemoryRegion* strtab_region = pInput.memArea()->request(
-                       pInput.fileOffset() + strtab->offset(), strtab->size());
-
-  // get ld_name
-  llvm::StringRef ld_name(
-                    reinterpret_cast<char*>(strtab_region->start() + st_name));
-
-  ResolveInfo* result = ResolveInfo::Create(ld_name);
-  result->setSource(pInput.type() == Input::DynObj);
-  result->setType(static_cast<ResolveInfo::Type>(st_info & 0xF));
-  result->setDesc(getSymDesc(st_shndx, pInput));
-  result->setBinding(getSymBinding((st_info >> 4), st_shndx, st_other));
-  result->setVisibility(getSymVisibility(st_other));
-
-  // release regions
-  pInput.memArea()->release(symbol_region);
-  pInput.memArea()->release(strtab_region);
-
-  return result;
+  return type;
 }
 
-/// readDynamic - read ELF .dynamic in input dynobj
-bool ELFReader<32, true>::readDynamic(Input& pInput) const
+/// countGlobalSymbols - count the non-local symbols of the symbol table.
+template<size_t BIT, bool LITTLEENDIAN>
+Input::Type
+ELFReader<BIT, LITTLEENDIAN>::countGlobalSymbols(MemoryArea& pArea,
+                                                 size_t pBase,
+                                                 size_t& pCount) const
 {
-  assert(pInput.type() == Input::DynObj);
-  const LDSection* dynamic_sect = pInput.context()->getSection(".dynamic");
-  if (NULL == dynamic_sect) {
-    fatal(diag::err_cannot_read_section) << ".dynamic";
-  }
-  const LDSection* dynstr_sect = dynamic_sect->getLink();
-  if (NULL == dynstr_sect) {
-    fatal(diag::err_cannot_read_section) << ".dynstr";
-  }
-
-  MemoryRegion* dynamic_region = pInput.memArea()->request(
-           pInput.fileOffset() + dynamic_sect->offset(), dynamic_sect->size());
-
-  MemoryRegion* dynstr_region = pInput.memArea()->request(
-             pInput.fileOffset() + dynstr_sect->offset(), dynstr_sect->size());
-
-  assert(NULL != dynamic_region && NULL != dynstr_region);
+  pCount = 0;
+  File file(pArea, pBase);
+  const void* ELF_hdr = &file.header();
+  if (!isELF(ELF_hdr) || !isMyEndian(ELF_hdr) || !isMyMachine(ELF_hdr))
+    return Input::Unknown;
 
-  const llvm::ELF::Elf32_Dyn* dynamic =
-    (llvm::ELF::Elf32_Dyn*) dynamic_region->start();
-  const char* dynstr = (const char*) dynstr_region->start();
-  bool hasSOName = false;
-  size_t numOfEntries = dynamic_sect->size() / sizeof(llvm::ELF::Elf32_Dyn);
+  Input::Type type = fileType(ELF_hdr);
+  if (Input::Object != type && Input::DynObj != type)
+    return type;
 
-  for (size_t idx = 0; idx < numOfEntries; ++idx) {
+  const SectionHeader* shdrTab = file.sectionHeaders();
+  if (NULL == shdrTab)
+    return type;
 
-    llvm::ELF::Elf32_Sword d_tag = 0x0;
-    llvm::ELF::Elf32_Word d_val = 0x0;
-
-    if (llvm::sys::isLittleEndianHost()) {
-      d_tag = dynamic[idx].d_tag;
-      d_val = dynamic[idx].d_un.d_val;
-    } else {
-      d_tag = mcld::bswap32(dynamic[idx].d_tag);
-      d_val = mcld::bswap32(dynamic[idx].d_un.d_val);
-    }
+  // sh_info of a symbol table is the index of its first non-local symbol
+  uint32_t symtab_type = (Input::Object == type)? llvm::ELF::SHT_SYMTAB:
+                                                  llvm::ELF::SHT_DYNSYM;
+  for (size_t idx = 0; idx < file.numOfSections(); ++idx) {
+    if (symtab_type != shdrTab[idx].sh_type)
+      continue;
 
-    switch (d_tag) {
-      case llvm::ELF::DT_SONAME:
-        assert(d_val < dynstr_sect->size());
-        pInput.setName(sys::fs::Path(dynstr + d_val).filename().native());
-        hasSOName = true;
-        break;
-      case llvm::ELF::DT_NEEDED:
-        // TODO:
-        break;
-      case llvm::ELF::DT_NULL:
-      default:
-        break;
-    }
+    size_t num_of_symbols = shdrTab[idx].sh_size / sizeof(Symbol);
+    uint32_t sh_info = shdrTab[idx].sh_info;
+    if (sh_info < num_of_symbols)
+      pCount = num_of_symbols - sh_info;
+    break;
   }
-
-  // if there is no SONAME in .dynamic, then set it from input path
-  if (!hasSOName)
-    pInput.setName(pInput.path().filename().native());
-
-  pInput.memArea()->release(dynamic_region);
-  pInput.memArea()->release(dynstr_region);
-  return true;
-}
-
-//===----------------------------------------------------------------------===//
-// ELFReader<64, true>
-//===----------------------------------------------------------------------===//
-/// constructor
-ELFReader<64, true>::ELFReader(GNULDBackend& pBackend)
-  : ELFReaderIF(pBackend) {
-}
-
-/// destructor
-ELFReader<64, true>::~ELFReader()
-{
-}
-
-/// isELF - is this a ELF file
-bool ELFReader<64, true>::isELF(void* pELFHeader) const
-{
-  llvm::ELF::Elf64_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf64_Ehdr*>(pELFHeader);
-  if (0 == memcmp(llvm::ELF::ElfMagic, hdr, 4))
-    return true;
-  return false;
-}
-
-/// readRegularSection - read a regular section and create fragments.
-bool
-ELFReader<64, true>::readRegularSection(Input& pInput, SectionData& pSD) const
-{
-  uint64_t offset = pInput.fileOffset() + pSD.getSection().offset();
-  uint64_t size = pSD.getSection().size();
-
-  Fragment* frag = IRBuilder::CreateRegion(pInput, offset, size);
-  ObjectBuilder::AppendFragment(*frag, pSD);
-  return true;
+  return type;
 }
 
-/// readSymbols - read ELF symbols and create LDSymbol
-bool ELFReader<64, true>::readSymbols(Input& pInput,
-                                      IRBuilder& pBuilder,
-                                      const MemoryRegion& pRegion,
-                                      const char* pStrTab) const
+/// readSymbolNames - read the names of the defined non-local symbols in
+/// .symtab of the object at pBase of pArea. MemoryArea::view() is not safe to
+/// call concurrently, so the tables are read through preloaded spaces.
+template<size_t BIT, bool LITTLEENDIAN>
+Input::Type ELFReader<BIT, LITTLEENDIAN>::readSymbolNames(
+    MemoryArea& pArea, size_t pBase, std::vector<std::string>& pNames) const
 {
-  // get number of symbols
-  size_t entsize = pRegion.size()/sizeof(llvm::ELF::Elf64_Sym);
-  const llvm::ELF::Elf64_Sym* symtab =
-                 reinterpret_cast<const llvm::ELF::Elf64_Sym*>(pRegion.start());
-
-  uint32_t st_name  = 0x0;
-  uint64_t st_value = 0x0;
-  uint64_t st_size  = 0x0;
-  uint8_t  st_info  = 0x0;
-  uint8_t  st_other = 0x0;
-  uint16_t st_shndx = 0x0;
-
-  // skip the first NULL symbol
-  pInput.context()->addSymbol(LDSymbol::Null());
-
-  for (size_t idx = 1; idx < entsize; ++idx) {
-    st_info  = symtab[idx].st_info;
-    st_other = symtab[idx].st_other;
-
-    if (llvm::sys::isLittleEndianHost()) {
-      st_name  = symtab[idx].st_name;
-      st_value = symtab[idx].st_value;
-      st_size  = symtab[idx].st_size;
-      st_shndx = symtab[idx].st_shndx;
-    }
-    else {
-      st_name  = mcld::bswap32(symtab[idx].st_name);
-      st_value = mcld::bswap64(symtab[idx].st_value);
-      st_size  = mcld::bswap64(symtab[idx].st_size);
-      st_shndx = mcld::bswap16(symtab[idx].st_shndx);
-    }
-
-    // If the section should not be included, set the st_shndx SHN_UNDEF
-    // - A section in interrelated groups are not included.
-    if (pInput.type() == Input::Object &&
-        st_shndx < llvm::ELF::SHN_LORESERVE &&
-        st_shndx != llvm::ELF::SHN_UNDEF) {
-      if (NULL == pInput.context()->getSection(st_shndx))
-        st_shndx = llvm::ELF::SHN_UNDEF;
-    }
-
-    // get ld_type
-    ResolveInfo::Type ld_type = getSymType(st_info, st_shndx);
-
-    // get ld_desc
-    ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, pInput);
-
-    // get ld_binding
-    ResolveInfo::Binding ld_binding = getSymBinding((st_info >> 4), st_shndx, st_other);
-
-    // get ld_value - ld_value must be section relative.
-    uint64_t ld_value = getSymValue(st_value, st_shndx, pInput);
-
-    // get ld_vis
-    ResolveInfo::Visibility ld_vis = getSymVisibility(st_other);
-
-    // get section
-    LDSection* section = NULL;
-    if (st_shndx < llvm::ELF::SHN_LORESERVE) // including ABS and COMMON
-      section = pInput.context()->getSection(st_shndx);
-
-    // get ld_name
-    std::string ld_name;
-    if (ResolveInfo::Section == ld_type) {
-      // Section symbol's st_name is the section index.
-      assert(NULL != section && "get a invalid section");
-      ld_name = section->name();
-    }
-    else {
-      ld_name = std::string(pStrTab + st_name);
-    }
-
-    pBuilder.AddSymbol(pInput,
-                       ld_name,
-                       ld_type,
-                       ld_desc,
-                       ld_binding,
-                       st_size,
-                       ld_value,
-                       section, ld_vis);
-  } // end of for loop
-  return true;
-}
-
-//===----------------------------------------------------------------------===//
-// ELFReader::read relocations - read ELF rela and rel, and create Relocation
-//===----------------------------------------------------------------------===//
-/// ELFReader::readRela - read ELF rela and create Relocation
-bool ELFReader<64, true>::readRela(Input& pInput,
-                                   LDSection& pSection,
-                                   const MemoryRegion& pRegion) const
-{
-  // get the number of rela
-  size_t entsize = pRegion.size() / sizeof(llvm::ELF::Elf64_Rela);
-  const llvm::ELF::Elf64_Rela* relaTab =
-                reinterpret_cast<const llvm::ELF::Elf64_Rela*>(pRegion.start());
-
-  for (size_t idx=0; idx < entsize; ++idx) {
-    uint64_t r_offset = 0x0;
-    uint64_t r_info   = 0x0;
-    int64_t  r_addend = 0;
-    if (llvm::sys::isLittleEndianHost()) {
-      r_offset = relaTab[idx].r_offset;
-      r_info   = relaTab[idx].r_info;
-      r_addend = relaTab[idx].r_addend;
-    }
-    else {
-      r_offset = mcld::bswap64(relaTab[idx].r_offset);
-      r_info   = mcld::bswap64(relaTab[idx].r_info);
-      r_addend = mcld::bswap64(relaTab[idx].r_addend);
-    }
-
-    uint32_t  r_type = static_cast<uint32_t>(r_info);
-    uint32_t r_sym  = (r_info >> 32);
-    LDSymbol* symbol = pInput.context()->getSymbol(r_sym);
-    if (NULL == symbol) {
-      fatal(diag::err_cannot_read_symbol) << r_sym << pInput.path();
-    }
-
-    IRBuilder::AddRelocation(pSection, r_type, *symbol, r_offset, r_addend);
-  } // end of for
-  return true;
-}
-
-/// readRel - read ELF rel and create Relocation
-bool ELFReader<64, true>::readRel(Input& pInput,
-                                  LDSection& pSection,
-                                  const MemoryRegion& pRegion) const
-{
-  // get the number of rel
-  size_t entsize = pRegion.size() / sizeof(llvm::ELF::Elf64_Rel);
-  const llvm::ELF::Elf64_Rel* relTab =
-                 reinterpret_cast<const llvm::ELF::Elf64_Rel*>(pRegion.start());
-
-  for (size_t idx=0; idx < entsize; ++idx) {
-    uint64_t r_offset = 0x0;
-    uint64_t r_info   = 0x0;
-    if (llvm::sys::isLittleEndianHost()) {
-      r_offset = relTab[idx].r_offset;
-      r_info   = relTab[idx].r_info;
-    }
-    else {
-      r_offset = mcld::bswap64(relTab[idx].r_offset);
-      r_info   = mcld::bswap64(relTab[idx].r_info);
-    }
-
-    uint32_t  r_type = static_cast<uint32_t>(r_info);
-    uint32_t r_sym  = (r_info >> 32);
-
-    LDSymbol* symbol = pInput.context()->getSymbol(r_sym);
-    if (NULL == symbol) {
-      fatal(diag::err_cannot_read_symbol) << r_sym << pInput.path();
-    }
-
-    IRBuilder::AddRelocation(pSection, r_type, *symbol, r_offset);
-  } // end of for
-  return true;
-}
+  pNames.clear();
+  Space* space = pArea.preload(pBase, sizeof(ELFHeader));
+  if (NULL == space)
+    return Input::Unknown;
 
-/// isMyEndian - is this ELF file in the same endian to me?
-bool ELFReader<64, true>::isMyEndian(void* pELFHeader) const
-{
-  llvm::ELF::Elf64_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf64_Ehdr*>(pELFHeader);
+  const void* ELF_hdr = space->memory() + (pBase - space->start());
+  if (!isELF(ELF_hdr) || !isMyEndian(ELF_hdr) || !isMyMachine(ELF_hdr))
+    return Input::Unknown;
 
-  return (hdr->e_ident[llvm::ELF::EI_DATA] == llvm::ELF::ELFDATA2LSB);
-}
+  Input::Type type = fileType(ELF_hdr);
+  if (Input::Object != type)
+    return type;
 
-/// isMyMachine - is this ELF file generated for the same machine.
-bool ELFReader<64, true>::isMyMachine(void* pELFHeader) const
-{
-  llvm::ELF::Elf64_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf64_Ehdr*>(pELFHeader);
+  const ELFHeader* ehdr = reinterpret_cast<const ELFHeader*>(ELF_hdr);
+  uint64_t shoff = ehdr->e_shoff;
+  uint32_t shnum = ehdr->e_shnum;
+  if (0x0 == shoff || llvm::ELF::SHN_UNDEF == shnum ||
+      sizeof(SectionHeader) != ehdr->e_shentsize)
+    return type;
 
-  if (llvm::sys::isLittleEndianHost())
-    return (hdr->e_machine == target().getInfo().machine());
-  return (mcld::bswap16(hdr->e_machine) == target().getInfo().machine());
-}
+  space = pArea.preload(pBase + shoff, shnum * sizeof(SectionHeader));
+  if (NULL == space)
+    return type;
+  const SectionHeader* shdrTab = reinterpret_cast<const SectionHeader*>(
+                          space->memory() + (pBase + shoff - space->start()));
 
-/// fileType - return the file type
-Input::Type ELFReader<64, true>::fileType(void* pELFHeader) const
-{
-  llvm::ELF::Elf64_Ehdr* hdr =
-                          reinterpret_cast<llvm::ELF::Elf64_Ehdr*>(pELFHeader);
-  uint32_t type = 0x0;
-  if (llvm::sys::isLittleEndianHost())
-    type = hdr->e_type;
-  else
-    type = mcld::bswap16(hdr->e_type);
-
-  switch(type) {
-  case llvm::ELF::ET_REL:
-    return Input::Object;
-  case llvm::ELF::ET_EXEC:
-    return Input::Exec;
-  case llvm::ELF::ET_DYN:
-    return Input::DynObj;
-  case llvm::ELF::ET_CORE:
-    return Input::CoreFile;
-  case llvm::ELF::ET_NONE:
-  default:
-    return Input::Unknown;
+  for (size_t idx = 0; idx < shnum; ++idx) {
+    const SectionHeader& symtab = shdrTab[idx];
+    if (llvm::ELF::SHT_SYMTAB != symtab.sh_type)
+      continue;
+    if (symtab.sh_link >= shnum)
+      break;
+
+    const SectionHeader& strtab = shdrTab[symtab.sh_link];
+    Space* sym_space = pArea.preload(pBase + symtab.sh_offset,
+                                     symtab.sh_size);
+    Space* str_space = pArea.preload(pBase + strtab.sh_offset,
+                                     strtab.sh_size);
+    if (NULL == sym_space || NULL == str_space)
+      break;
+
+    const Symbol* symbols = reinterpret_cast<const Symbol*>(
+       sym_space->memory() + (pBase + symtab.sh_offset - sym_space->start()));
+    const char* names = reinterpret_cast<const char*>(
+       str_space->memory() + (pBase + strtab.sh_offset - str_space->start()));
+    size_t str_size = strtab.sh_size;
+
+    // sh_info of a symbol table is the index of its first non-local symbol
+    size_t num_of_symbols = symtab.sh_size / sizeof(Symbol);
+    for (size_t i = symtab.sh_info; i < num_of_symbols; ++i) {
+      const Symbol& sym = symbols[i];
+      uint8_t binding = sym.st_info >> 4;
+      if (llvm::ELF::STB_LOCAL == binding ||
+          llvm::ELF::SHN_UNDEF == sym.st_shndx ||
+          sym.st_name >= str_size)
+        continue;
+      pNames.push_back(std::string(names + sym.st_name,
+                                   strnlen(names + sym.st_name,
+                                           str_size - sym.st_name)));
+    }
+    break;
   }
+  return type;
 }
 
 /// readSectionHeaders - read ELF section header table and create LDSections
+template<size_t BIT, bool LITTLEENDIAN>
 bool
-ELFReader<64, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
+ELFReader<BIT, LITTLEENDIAN>::readSectionHeaders(Input& pInput,
+                                                 const void* pELFHeader) const
 {
-  llvm::ELF::Elf64_Ehdr* ehdr =
-                          reinterpret_cast<llvm::ELF::Elf64_Ehdr*>(pELFHeader);
-
-  uint64_t shoff     = 0x0;
-  uint16_t shentsize = 0x0;
-  uint32_t shnum     = 0x0;
-  uint32_t shstrtab  = 0x0;
-
-  if (llvm::sys::isLittleEndianHost()) {
-    shoff     = ehdr->e_shoff;
-    shentsize = ehdr->e_shentsize;
-    shnum     = ehdr->e_shnum;
-    shstrtab  = ehdr->e_shstrndx;
-  }
-  else {
-    shoff     = mcld::bswap64(ehdr->e_shoff);
-    shentsize = mcld::bswap16(ehdr->e_shentsize);
-    shnum     = mcld::bswap16(ehdr->e_shnum);
-    shstrtab  = mcld::bswap16(ehdr->e_shstrndx);
-  }
+  File file(*pInput.memArea(), pInput.fileOffset());
 
   // If the file has no section header table, e_shoff holds zero.
-  if (0x0 == shoff)
+  const SectionHeader* shdrTab = file.sectionHeaders();
+  if (NULL == shdrTab)
     return true;
 
-  llvm::ELF::Elf64_Shdr *shdr = NULL;
-  MemoryRegion* shdr_region = NULL;
-  uint32_t sh_name      = 0x0;
-  uint32_t sh_type      = 0x0;
-  uint64_t sh_flags     = 0x0;
-  uint64_t sh_offset    = 0x0;
-  uint64_t sh_size      = 0x0;
-  uint32_t sh_link      = 0x0;
-  uint32_t sh_info      = 0x0;
-  uint64_t sh_addralign = 0x0;
-
-  // if shnum and shstrtab overflow, the actual values are in the 1st shdr
-  if (shnum == llvm::ELF::SHN_UNDEF || shstrtab == llvm::ELF::SHN_XINDEX) {
-    shdr_region = pInput.memArea()->request(pInput.fileOffset() + shoff,
-                                            shentsize);
-    shdr = reinterpret_cast<llvm::ELF::Elf64_Shdr*>(shdr_region->start());
-
-    if (llvm::sys::isLittleEndianHost()) {
-      sh_size = shdr->sh_size;
-      sh_link = shdr->sh_link;
-    }
-    else {
-      sh_size = mcld::bswap64(shdr->sh_size);
-      sh_link = mcld::bswap32(shdr->sh_link);
-    }
-    pInput.memArea()->release(shdr_region);
-
-    if (shnum == llvm::ELF::SHN_UNDEF)
-      shnum = sh_size;
-    if (shstrtab == llvm::ELF::SHN_XINDEX)
-      shstrtab = sh_link;
-
-    shoff += shentsize;
-  }
-
-  shdr_region = pInput.memArea()->request(pInput.fileOffset() + shoff,
-                                          shnum * shentsize);
-  llvm::ELF::Elf64_Shdr * shdrTab =
-    reinterpret_cast<llvm::ELF::Elf64_Shdr*>(shdr_region->start());
-
   // get .shstrtab first
-  shdr = &shdrTab[shstrtab];
-  if (llvm::sys::isLittleEndianHost()) {
-    sh_offset = shdr->sh_offset;
-    sh_size   = shdr->sh_size;
-  }
-  else {
-    sh_offset = mcld::bswap64(shdr->sh_offset);
-    sh_size   = mcld::bswap64(shdr->sh_size);
-  }
-
-  MemoryRegion* sect_name_region = pInput.memArea()->request(
-                                      pInput.fileOffset() + sh_offset, sh_size);
-  const char* sect_name =
-                       reinterpret_cast<const char*>(sect_name_region->start());
+  const char* sect_name = file.template contents<char>(shdrTab[file.shstrndx()]);
 
   LinkInfoList link_info_list;
 
   // create all LDSections, including first NULL section.
+  size_t shnum = file.numOfSections();
+  pInput.context()->reserveSections(shnum);
   for (size_t idx = 0; idx < shnum; ++idx) {
-    if (llvm::sys::isLittleEndianHost()) {
-      sh_name      = shdrTab[idx].sh_name;
-      sh_type      = shdrTab[idx].sh_type;
-      sh_flags     = shdrTab[idx].sh_flags;
-      sh_offset    = shdrTab[idx].sh_offset;
-      sh_size      = shdrTab[idx].sh_size;
-      sh_link      = shdrTab[idx].sh_link;
-      sh_info      = shdrTab[idx].sh_info;
-      sh_addralign = shdrTab[idx].sh_addralign;
-    }
-    else {
-      sh_name      = mcld::bswap32(shdrTab[idx].sh_name);
-      sh_type      = mcld::bswap32(shdrTab[idx].sh_type);
-      sh_flags     = mcld::bswap64(shdrTab[idx].sh_flags);
-      sh_offset    = mcld::bswap64(shdrTab[idx].sh_offset);
-      sh_size      = mcld::bswap64(shdrTab[idx].sh_size);
-      sh_link      = mcld::bswap32(shdrTab[idx].sh_link);
-      sh_info      = mcld::bswap32(shdrTab[idx].sh_info);
-      sh_addralign = mcld::bswap64(shdrTab[idx].sh_addralign);
-    }
+    const SectionHeader& shdr = shdrTab[idx];
+    uint32_t sh_link = shdr.sh_link;
+    uint32_t sh_info = shdr.sh_info;
 
     LDSection* section = IRBuilder::CreateELFHeader(pInput,
-                                                    sect_name+sh_name,
-                                                    sh_type,
-                                                    sh_flags,
-                                                    sh_addralign);
-    section->setSize(sh_size);
-    section->setOffset(sh_offset);
+                                                    sect_name + shdr.sh_name,
+                                                    shdr.sh_type,
+                                                    shdr.sh_flags,
+                                                    shdr.sh_addralign);
+    section->setSize(shdr.sh_size);
+    section->setOffset(shdr.sh_offset);
     section->setInfo(sh_info);
+    section->setEntSize(shdr.sh_entsize);
 
     if (sh_link != 0x0 || sh_info != 0x0) {
       LinkInfo link_info = { section, sh_link, sh_info };
@@ -909,81 +568,118 @@ ELFReader<64, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
   } // end of for
 
   // set up InfoLink
-  LinkInfoList::iterator info, infoEnd = link_info_list.end();
-  for (info = link_info_list.begin(); info != infoEnd; ++info) {
-    if (LDFileFormat::NamePool == info->section->kind() ||
-        LDFileFormat::Group == info->section->kind() ||
-        LDFileFormat::Note == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_link));
-      continue;
-    }
-    if (LDFileFormat::Relocation == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_info));
-      continue;
-    }
-  }
-
-  pInput.memArea()->release(shdr_region);
-  pInput.memArea()->release(sect_name_region);
-
+  setUpLinks(pInput, link_info_list);
   return true;
 }
 
-/// readSignature - read a symbol from the given Input and index in symtab
-/// This is used to get the signature of a group section.
-ResolveInfo* ELFReader<64, true>::readSignature(Input& pInput,
-                                                LDSection& pSymTab,
-                                                uint32_t pSymIdx) const
+/// objectSize - the bytes of the object that its section header table and
+/// its sections take
+template<size_t BIT, bool LITTLEENDIAN>
+uint64_t ELFReader<BIT, LITTLEENDIAN>::objectSize(Input& pInput) const
 {
-  LDSection* symtab = &pSymTab;
-  LDSection* strtab = symtab->getLink();
-  assert(NULL != symtab && NULL != strtab);
-
-  uint64_t offset = pInput.fileOffset() + symtab->offset() +
-                      sizeof(llvm::ELF::Elf64_Sym) * pSymIdx;
-  MemoryRegion* symbol_region =
-                pInput.memArea()->request(offset, sizeof(llvm::ELF::Elf64_Sym));
-  llvm::ELF::Elf64_Sym* entry =
-                reinterpret_cast<llvm::ELF::Elf64_Sym*>(symbol_region->start());
-
-  uint32_t st_name  = 0x0;
-  uint8_t  st_info  = 0x0;
-  uint8_t  st_other = 0x0;
-  uint16_t st_shndx = 0x0;
-  st_info  = entry->st_info;
-  st_other = entry->st_other;
-  if (llvm::sys::isLittleEndianHost()) {
-    st_name  = entry->st_name;
-    st_shndx = entry->st_shndx;
-  }
-  else {
-    st_name  = mcld::bswap32(entry->st_name);
-    st_shndx = mcld::bswap16(entry->st_shndx);
+  File file(*pInput.memArea(), pInput.fileOffset());
+  const SectionHeader* shdrTab = file.sectionHeaders();
+  if (NULL == shdrTab)
+    return 0;
+
+  uint64_t shoff = file.header().e_shoff;
+  uint64_t result = shoff + file.numOfSections() * sizeof(SectionHeader);
+  for (size_t idx = 0; idx < file.numOfSections(); ++idx) {
+    if (llvm::ELF::SHT_NOBITS == shdrTab[idx].sh_type)
+      continue;
+    uint64_t end = shdrTab[idx].sh_offset + shdrTab[idx].sh_size;
+    result = std::max(result, end);
   }
+  return result;
+}
 
-  MemoryRegion* strtab_region = pInput.memArea()->request(
-                       pInput.fileOffset() + strtab->offset(), strtab->size());
+/// summarize - fill pTables with the section headers, the symbol table and
+/// the relocations of the object
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::summarize(
+                                     Input& pInput,
+                                     ObjectSummary::Tables& pTables) const
+{
+  File file(*pInput.memArea(), pInput.fileOffset());
+  const SectionHeader* shdrTab = file.sectionHeaders();
+  if (NULL == shdrTab)
+    return false;
 
-  // get ld_name
-  llvm::StringRef ld_name(
-                    reinterpret_cast<char*>(strtab_region->start() + st_name));
+  const char* sect_name =
+                  file.template contents<char>(shdrTab[file.shstrndx()]);
 
-  ResolveInfo* result = ResolveInfo::Create(ld_name);
-  result->setSource(pInput.type() == Input::DynObj);
-  result->setType(static_cast<ResolveInfo::Type>(st_info & 0xF));
-  result->setDesc(getSymDesc(st_shndx, pInput));
-  result->setBinding(getSymBinding((st_info >> 4), st_shndx, st_other));
-  result->setVisibility(getSymVisibility(st_other));
+  size_t shnum = file.numOfSections();
+  const SectionHeader* symtab = NULL;
+  pTables.sections.resize(shnum);
+  for (size_t idx = 0; idx < shnum; ++idx) {
+    const SectionHeader& shdr = shdrTab[idx];
+    ObjectSummary::Section& sect = pTables.sections[idx];
+    sect.name      = pTables.addName(sect_name + shdr.sh_name);
+    sect.type      = shdr.sh_type;
+    sect.flags     = shdr.sh_flags;
+    sect.addralign = shdr.sh_addralign;
+    sect.offset    = shdr.sh_offset;
+    sect.size      = shdr.sh_size;
+    sect.entsize   = shdr.sh_entsize;
+    sect.link      = shdr.sh_link;
+    sect.info      = shdr.sh_info;
+    sect.first     = 0;
+    sect.num       = 0;
+
+    if (llvm::ELF::SHT_SYMTAB == sect.type && NULL == symtab) {
+      symtab = &shdr;
+    }
+    else if (llvm::ELF::SHT_RELA == sect.type) {
+      sect.first = pTables.relocs.size();
+      sect.num = sect.size / sizeof(Rela);
+      const Rela* relaTab = file.template get<Rela>(sect.offset, sect.num);
+      for (size_t i = 0; i < sect.num; ++i) {
+        ObjectSummary::Reloc reloc = { relaTab[i].r_offset,
+                                       relaTab[i].r_addend,
+                                       relaTab[i].getType(),
+                                       relaTab[i].getSymbol() };
+        pTables.relocs.push_back(reloc);
+      }
+    }
+    else if (llvm::ELF::SHT_REL == sect.type) {
+      sect.first = pTables.relocs.size();
+      sect.num = sect.size / sizeof(Rel);
+      const Rel* relTab = file.template get<Rel>(sect.offset, sect.num);
+      for (size_t i = 0; i < sect.num; ++i) {
+        ObjectSummary::Reloc reloc = { relTab[i].r_offset,
+                                       0,
+                                       relTab[i].getType(),
+                                       relTab[i].getSymbol() };
+        pTables.relocs.push_back(reloc);
+      }
+    }
+  }
 
-  // release regions
-  pInput.memArea()->release(symbol_region);
-  pInput.memArea()->release(strtab_region);
+  if (NULL == symtab || symtab->sh_link >= shnum)
+    return true;
 
-  return result;
+  const char* strtab = file.template contents<char>(shdrTab[symtab->sh_link]);
+  const Symbol* symbols = file.template contents<Symbol>(*symtab);
+  size_t num_of_symbols = symtab->sh_size / sizeof(Symbol);
+  pTables.symbols.resize(num_of_symbols);
+  for (size_t idx = 0; idx < num_of_symbols; ++idx) {
+    const Symbol& sym = symbols[idx];
+    ObjectSummary::Symbol& result = pTables.symbols[idx];
+    result.name  = pTables.addName(strtab + sym.st_name);
+    result.info  = sym.st_info;
+    result.other = sym.st_other;
+    result.shndx = sym.st_shndx;
+    result.value = sym.st_value;
+    result.size  = sym.st_size;
+  }
+  return true;
 }
 
 /// readDynamic - read ELF .dynamic in input dynobj
-bool ELFReader<64, true>::readDynamic(Input& pInput) const
+template<size_t BIT, bool LITTLEENDIAN>
+bool ELFReader<BIT, LITTLEENDIAN>::readDynamic(
+                                      Input& pInput,
+                                      std::vector<std::string>* pNeeded) const
 {
   assert(pInput.type() == Input::DynObj);
   const LDSection* dynamic_sect = pInput.context()->getSection(".dynamic");
@@ -995,32 +691,17 @@ bool ELFReader<64, true>::readDynamic(Input& pInput) const
     fatal(diag::err_cannot_read_section) << ".dynstr";
   }
 
-  MemoryRegion* dynamic_region = pInput.memArea()->request(
-           pInput.fileOffset() + dynamic_sect->offset(), dynamic_sect->size());
-
-  MemoryRegion* dynstr_region = pInput.memArea()->request(
-             pInput.fileOffset() + dynstr_sect->offset(), dynstr_sect->size());
-
-  assert(NULL != dynamic_region && NULL != dynstr_region);
-
-  const llvm::ELF::Elf64_Dyn* dynamic =
-    (llvm::ELF::Elf64_Dyn*) dynamic_region->start();
-  const char* dynstr = (const char*) dynstr_region->start();
+  File file(*pInput.memArea(), pInput.fileOffset());
+  size_t numOfEntries = dynamic_sect->size() / sizeof(Dyn);
+  const Dyn* dynamic = file.template get<Dyn>(dynamic_sect->offset(),
+                                              numOfEntries);
+  const char* dynstr = file.template get<char>(dynstr_sect->offset(),
+                                               dynstr_sect->size());
   bool hasSOName = false;
-  size_t numOfEntries = dynamic_sect->size() / sizeof(llvm::ELF::Elf64_Dyn);
 
   for (size_t idx = 0; idx < numOfEntries; ++idx) {
-
-    llvm::ELF::Elf64_Sxword d_tag = 0x0;
-    llvm::ELF::Elf64_Xword d_val = 0x0;
-
-    if (llvm::sys::isLittleEndianHost()) {
-      d_tag = dynamic[idx].d_tag;
-      d_val = dynamic[idx].d_un.d_val;
-    } else {
-      d_tag = mcld::bswap64(dynamic[idx].d_tag);
-      d_val = mcld::bswap64(dynamic[idx].d_un.d_val);
-    }
+    int64_t d_tag = dynamic[idx].d_tag;
+    uint64_t d_val = dynamic[idx].d_val;
 
     switch (d_tag) {
       case llvm::ELF::DT_SONAME:
@@ -1029,7 +710,9 @@ bool ELFReader<64, true>::readDynamic(Input& pInput) const
         hasSOName = true;
         break;
       case llvm::ELF::DT_NEEDED:
-        // TODO:
+        assert(d_val < dynstr_sect->size());
+        if (NULL != pNeeded)
+          pNeeded->push_back(dynstr + d_val);
         break;
       case llvm::ELF::DT_NULL:
       default:
@@ -1041,8 +724,17 @@ bool ELFReader<64, true>::readDynamic(Input& pInput) const
   if (!hasSOName)
     pInput.setName(pInput.path().filename().native());
 
-  pInput.memArea()->release(dynamic_region);
-  pInput.memArea()->release(dynstr_region);
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Explicit instantiations
+//===----------------------------------------------------------------------===//
+namespace mcld {
+
+template class ELFReader<32, true>;
+template class ELFReader<64, true>;
+template class ELFReader<32, false>;
+template class ELFReader<64, false>;
+
+} // namespace of mcld
@@ -11,6 +11,8 @@
 #include <mcld/IRBuilder.h>
 #include <mcld/Fragment/FillFragment.h>
 #include <mcld/LD/EhFrame.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/NamePool.h>
 #include <mcld/LD/SectionData.h>
 #include <mcld/Target/GNULDBackend.h>
 //#include <mcld/Support/MemoryArea.h>
@@ -27,6 +29,16 @@
 
 using namespace mcld;
 
+namespace { // anonymous
+
+/// SummaryName - the name of the pIdx-th symbol of pSummary
+inline const char* SummaryName(const ObjectSummary& pSummary, size_t pIdx)
+{
+  return pSummary.getName(pSummary.getSymbol(pIdx).name);
+}
+
+} // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // ELFReaderIF
 //===----------------------------------------------------------------------===//
@@ -162,3 +174,249 @@ uint64_t ELFReaderIF::getSymValue(uint64_t pValue,
   return 0x0;
 }
 
+/// decodeFields - decode pFields in the terms of ResolveInfo
+void ELFReaderIF::decodeFields(Input& pInput,
+                               const SymbolFields& pFields,
+                               DecodedSymbol& pResult) const
+{
+  uint16_t st_shndx = pFields.shndx;
+
+  // If the section should not be included, set the st_shndx SHN_UNDEF
+  // - A section in interrelated groups are not included.
+  if (pInput.type() == Input::Object &&
+      st_shndx < llvm::ELF::SHN_LORESERVE &&
+      st_shndx != llvm::ELF::SHN_UNDEF) {
+    if (NULL == pInput.context()->getSection(st_shndx))
+      st_shndx = llvm::ELF::SHN_UNDEF;
+  }
+
+  // get ld_type
+  ResolveInfo::Type ld_type = getSymType(pFields.info, st_shndx);
+
+  // get ld_desc
+  ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, pInput);
+
+  // get ld_binding
+  ResolveInfo::Binding ld_binding = getSymBinding((pFields.info >> 4),
+                                                  st_shndx,
+                                                  pFields.other);
+
+  // get ld_value - ld_value must be section relative.
+  uint64_t ld_value = getSymValue(pFields.value, st_shndx, pInput);
+
+  // get ld_vis
+  ResolveInfo::Visibility ld_vis = getSymVisibility(pFields.other);
+
+  // get section
+  LDSection* section = NULL;
+  if (st_shndx < llvm::ELF::SHN_LORESERVE) // including ABS and COMMON
+    section = pInput.context()->getSection(st_shndx);
+
+  // get ld_name. It refers to the string table or the section name
+  // directly. NamePool copies it only if a new ResolveInfo is created.
+  llvm::StringRef ld_name;
+  if (ResolveInfo::Section == ld_type) {
+    // Section symbol's st_name is the section index.
+    assert(NULL != section && "get a invalid section");
+    ld_name = section->name();
+  }
+  else {
+    ld_name = llvm::StringRef(pFields.name);
+  }
+
+  pResult.name       = ld_name;
+  pResult.type       = ld_type;
+  pResult.desc       = ld_desc;
+  pResult.binding    = ld_binding;
+  pResult.visibility = ld_vis;
+  pResult.size       = pFields.size;
+  pResult.value      = ld_value;
+  pResult.section    = section;
+}
+
+/// canDiscard - can the local symbol pFields be dropped in pMode if no
+/// relocation refers to it?
+bool ELFReaderIF::canDiscard(const SymbolFields& pFields,
+                             GeneralOptions::StripSymbolMode pMode) const
+{
+  // the section symbols stand for the input sections
+  if (llvm::ELF::STB_LOCAL != (pFields.info >> 4) ||
+      llvm::ELF::STT_SECTION == (pFields.info & 0xF))
+    return false;
+
+  switch (pMode) {
+    case GeneralOptions::StripTemporaries:
+      // -X drops the temporary labels of the assembler only
+      return (0 == strncmp(pFields.name, ".L", 2));
+    case GeneralOptions::StripLocals:
+    case GeneralOptions::StripAllSymbols:
+      return true;
+    case GeneralOptions::KeepAllSymbols:
+    default:
+      return false;
+  }
+}
+
+/// setUpLinks - set the links of the sections of pInput by pList
+void ELFReaderIF::setUpLinks(Input& pInput, const LinkInfoList& pList) const
+{
+  LinkInfoList::const_iterator info, infoEnd = pList.end();
+  for (info = pList.begin(); info != infoEnd; ++info) {
+    if (LDFileFormat::NamePool == info->section->kind() ||
+        LDFileFormat::Group == info->section->kind() ||
+        LDFileFormat::Note == info->section->kind()) {
+      info->section->setLink(pInput.context()->getSection(info->sh_link));
+      continue;
+    }
+    if (LDFileFormat::Relocation == info->section->kind()) {
+      info->section->setLink(pInput.context()->getSection(info->sh_info));
+      continue;
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// ELFReaderIF - read the summary of an object
+//===----------------------------------------------------------------------===//
+/// readSummarySections - create the LDSections of pInput from pSummary
+bool ELFReaderIF::readSummarySections(Input& pInput,
+                                      const ObjectSummary& pSummary) const
+{
+  LinkInfoList link_info_list;
+
+  // create all LDSections, including first NULL section.
+  size_t shnum = pSummary.numOfSections();
+  pInput.context()->reserveSections(shnum);
+  for (size_t idx = 0; idx < shnum; ++idx) {
+    const ObjectSummary::Section& shdr = pSummary.getSection(idx);
+    LDSection* section = IRBuilder::CreateELFHeader(pInput,
+                                                    pSummary.getName(shdr.name),
+                                                    shdr.type,
+                                                    shdr.flags,
+                                                    shdr.addralign);
+    section->setSize(shdr.size);
+    section->setOffset(shdr.offset);
+    section->setInfo(shdr.info);
+    section->setEntSize(shdr.entsize);
+
+    if (shdr.link != 0x0 || shdr.info != 0x0) {
+      LinkInfo link_info = { section, shdr.link, shdr.info };
+      link_info_list.push_back(link_info);
+    }
+  }
+
+  setUpLinks(pInput, link_info_list);
+  return true;
+}
+
+/// readSummarySymbols - create the LDSymbols of pInput from pSummary
+bool ELFReaderIF::readSummarySymbols(Input& pInput,
+                                     IRBuilder& pBuilder,
+                                     const ObjectSummary& pSummary) const
+{
+  size_t entsize = pSummary.numOfSymbols();
+
+  // skip the first NULL symbol
+  pInput.context()->addSymbol(LDSymbol::Null());
+
+  // the same as readSymbols(), the unreferred local symbols are dropped for
+  // -x, -X and -s
+  GeneralOptions::StripSymbolMode strip =
+                            pBuilder.getConfig().options().getStripSymbolMode();
+  bool discard = (Input::Object == pInput.type() &&
+                  GeneralOptions::KeepAllSymbols != strip);
+  std::vector<bool> referred;
+  if (discard) {
+    referred.resize(entsize, false);
+    LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+    for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      size_t idx = (*rs)->index();
+      const ObjectSummary::Reloc* relocs = pSummary.getRelocs(idx);
+      for (size_t i = 0; i < pSummary.getSection(idx).num; ++i) {
+        if (relocs[i].symbol < entsize)
+          referred[relocs[i].symbol] = true;
+      }
+    }
+  }
+
+  NamePool& pool = pBuilder.getModule().getNamePool();
+  llvm::StringRef names[NamePool::BatchSize];
+  for (size_t begin = 1; begin < entsize; begin += NamePool::BatchSize) {
+    size_t end = std::min(entsize, begin + NamePool::BatchSize);
+    size_t num_of_names = 0;
+    for (size_t idx = begin; idx < end; ++idx) {
+      if (llvm::ELF::STB_LOCAL != (pSummary.getSymbol(idx).info >> 4))
+        names[num_of_names++] = llvm::StringRef(SummaryName(pSummary, idx));
+    }
+    pool.prefetch(names, num_of_names);
+
+    for (size_t idx = begin; idx < end; ++idx) {
+      const ObjectSummary::Symbol& sym = pSummary.getSymbol(idx);
+      SymbolFields fields = { SummaryName(pSummary, idx), sym.info,
+                              sym.other, sym.shndx, sym.value, sym.size };
+      if (discard && !referred[idx] && canDiscard(fields, strip)) {
+        pInput.context()->addSymbol(NULL);
+        continue;
+      }
+
+      DecodedSymbol symbol;
+      decodeFields(pInput, fields, symbol);
+      pBuilder.AddSymbol(pInput,
+                         symbol.name,
+                         symbol.type,
+                         symbol.desc,
+                         symbol.binding,
+                         symbol.size,
+                         symbol.value,
+                         symbol.section, symbol.visibility);
+    }
+  }
+  pool.prefetch(NULL, 0);
+  return true;
+}
+
+/// decodeSummarySymbol - decode the pIdx-th symbol of pSummary
+bool ELFReaderIF::decodeSummarySymbol(Input& pInput,
+                                      const ObjectSummary& pSummary,
+                                      size_t pIdx,
+                                      DecodedSymbol& pResult) const
+{
+  if (0 == pIdx || pIdx >= pSummary.numOfSymbols())
+    return false;
+
+  const ObjectSummary::Symbol& sym = pSummary.getSymbol(pIdx);
+  SymbolFields fields = { SummaryName(pSummary, pIdx), sym.info,
+                          sym.other, sym.shndx, sym.value, sym.size };
+  decodeFields(pInput, fields, pResult);
+  return true;
+}
+
+/// decodeSummaryRelocs - decode the entries of the relocation section
+/// pSection of pSummary into pEntries
+bool ELFReaderIF::decodeSummaryRelocs(Input& pInput,
+                                      const ObjectSummary& pSummary,
+                                      const LDSection& pSection,
+                                      IRBuilder::RelocEntryList& pEntries) const
+{
+  size_t sect_idx = pSection.index();
+  if (sect_idx >= pSummary.numOfSections())
+    return false;
+
+  const ObjectSummary::Reloc* relocs = pSummary.getRelocs(sect_idx);
+  size_t entsize = pSummary.getSection(sect_idx).num;
+  pEntries.resize(entsize);
+  for (size_t idx = 0; idx < entsize; ++idx) {
+    uint32_t r_sym = relocs[idx].symbol;
+    LDSymbol* symbol = pInput.context()->getSymbol(r_sym);
+    if (NULL == symbol) {
+      fatal(diag::err_cannot_read_symbol) << r_sym << pInput.path();
+    }
+
+    IRBuilder::RelocEntry& entry = pEntries[idx];
+    entry.type   = relocs[idx].type;
+    entry.symbol = symbol;
+    entry.offset = relocs[idx].offset;
+    entry.addend = relocs[idx].addend;
+  }
+  return true;
+}
@@ -35,7 +35,7 @@ EhFrame::FDE::FDE(MemoryRegion& pRegion,
                   const EhFrame::CIE& pCIE,
                   uint32_t pDataStart)
   : RegionFragment(pRegion),
-    m_CIE(pCIE),
+    m_pCIE(&pCIE),
     m_DataStart(pDataStart) {
 }
 
@@ -111,6 +111,44 @@ void EhFrame::addFDE(EhFrame::FDE& pFDE)
   addFragment(pFDE);
 }
 
+uint64_t EhFrame::remove(const std::set<const Fragment*>& pDropped)
+{
+  size_t cie_kept = 0;
+  for (size_t i = 0; i < m_CIEs.size(); ++i) {
+    if (0 == pDropped.count(m_CIEs[i]))
+      m_CIEs[cie_kept++] = m_CIEs[i];
+  }
+  m_CIEs.resize(cie_kept);
+
+  size_t fde_kept = 0;
+  for (size_t i = 0; i < m_FDEs.size(); ++i) {
+    if (0 == pDropped.count(m_FDEs[i]))
+      m_FDEs[fde_kept++] = m_FDEs[i];
+  }
+  m_FDEs.resize(fde_kept);
+
+  uint64_t removed = 0;
+  uint64_t offset = 0;
+  SectionData::FragmentListType& list = m_pSectionData->getFragmentList();
+  SectionData::iterator frag = list.begin(), fragEnd = list.end();
+  while (frag != fragEnd) {
+    Fragment* cur = &*frag;
+    ++frag;
+    if (0 != pDropped.count(cur)) {
+      removed += cur->size();
+      list.remove(cur);
+      delete cur;
+      continue;
+    }
+    cur->setOffset(offset);
+    offset += cur->size();
+  }
+
+  if (NULL != m_pSection)
+    m_pSection->setSize(offset);
+  return removed;
+}
+
 EhFrame& EhFrame::merge(EhFrame& pOther)
 {
   ObjectBuilder::MoveSectionData(pOther.getSectionData(), *m_pSectionData);
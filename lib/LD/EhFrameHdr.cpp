@@ -10,14 +10,15 @@
 
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/ThreadPool.h>
 #include <mcld/LD/EhFrame.h>
 #include <mcld/LD/LDSection.h>
 
 #include <llvm/Support/Dwarf.h>
 #include <llvm/Support/DataTypes.h>
 
-#include <algorithm>
 #include <cstring>
+#include <vector>
 
 using namespace mcld;
 using namespace llvm::dwarf;
@@ -27,19 +28,95 @@ using namespace llvm::dwarf;
 //===----------------------------------------------------------------------===//
 namespace bit32 {
 
-typedef std::pair<SizeTraits<32>::Address, SizeTraits<32>::Address> Entry;
+/// Entry - the initial location and the address of an FDE, relative to
+/// .eh_frame_hdr
+typedef std::pair<uint32_t, uint32_t> Entry;
 
-bool EntryCompare(const Entry& pX, const Entry& pY)
-{ return (pX.first < pY.first); }
+/// EntryKey - the key the table is sorted by. The relative locations plus
+/// bias are in the order of the absolute ones.
+struct EntryKey
+{
+  uint32_t bias;
+
+  uint32_t operator()(const Entry& pEntry) const
+  { return pEntry.first + bias; }
+};
 
 } // bit32 namespace
 
+/// PCBeginDecoder - compute the initial locations of the FDEs on the thread
+/// pool
+struct EhFrameHdr::PCBeginDecoder
+{
+  const EhFrameHdr* hdr;
+  const EhFrame* eh_frame;
+  const PCEncoding* encodings;
+  const MemoryRegion* region;
+  std::vector<bit32::Entry>* table;
+
+  void operator()(size_t pIdx) {
+    const EhFrame::FDE& fde = **(eh_frame->fde_begin() + pIdx);
+    const PCEncoding& encoding = encodings[fde.getCIE().getFDEEncode()];
+    uint64_t pc = hdr->computePCBegin(fde, encoding, *region);
+    uint64_t addr = hdr->m_EhFrame.addr() + fde.getOffset();
+    (*table)[pIdx] = std::make_pair(pc - hdr->m_EhFrameHdr.addr(),
+                                    addr - hdr->m_EhFrameHdr.addr());
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // Template Specification Functions
 //===----------------------------------------------------------------------===//
 /// emitOutput<32> - write out eh_frame_hdr
 template<>
-void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput)
+void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput, ThreadPool& pThreads)
+{
+  emit(pOutput, pThreads, 4);
+}
+
+/// emitOutput<64> - write out eh_frame_hdr
+template<>
+void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput, ThreadPool& pThreads)
+{
+  emit(pOutput, pThreads, 8);
+}
+
+//===----------------------------------------------------------------------===//
+// EhFrameHdr
+//===----------------------------------------------------------------------===//
+
+EhFrameHdr::EhFrameHdr(LDSection& pEhFrameHdr, const LDSection& pEhFrame)
+  : m_EhFrameHdr(pEhFrameHdr), m_EhFrame(pEhFrame) {
+}
+
+EhFrameHdr::~EhFrameHdr()
+{
+}
+
+/// @ref lsb core generic 4.1
+/// .eh_frame_hdr section format
+/// uint8_t : version
+/// uint8_t : eh_frame_ptr_enc
+/// uint8_t : fde_count_enc
+/// uint8_t : table_enc
+/// uint32_t : eh_frame_ptr
+/// uint32_t : fde_count
+/// __________________________ when fde_count > 0
+/// <uint32_t, uint32_t>+ : binary search table
+/// sizeOutput - base on the fde count to size output
+void EhFrameHdr::sizeOutput()
+{
+  size_t size = 12;
+  if (m_EhFrame.hasEhFrame())
+    size += 8 * m_EhFrame.getEhFrame()->numOfFDEs();
+  m_EhFrameHdr.setSize(size);
+}
+
+/// emit - write out eh_frame_hdr of an output of pAddrSize-byte addresses.
+/// The table is DW_EH_PE_datarel | DW_EH_PE_sdata4 for both 32-bit and 64-bit
+/// outputs.
+void EhFrameHdr::emit(MemoryArea& pOutput, ThreadPool& pThreads,
+                      size_t pAddrSize)
 {
   MemoryRegion* ehframehdr_region =
     pOutput.request(m_EhFrameHdr.offset(), m_EhFrameHdr.size());
@@ -61,9 +138,9 @@ void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput)
   // fde_count
   uint32_t* fde_count = (uint32_t*)(data + 8);
   if (m_EhFrame.hasEhFrame())
-    *fde_count = 0;
-  else
     *fde_count = m_EhFrame.getEhFrame()->numOfFDEs();
+  else
+    *fde_count = 0;
 
   if (0 != *fde_count) {
     // fde_count_enc
@@ -80,119 +157,92 @@ void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput)
   }
 
   if (0 != *fde_count) {
+    // decode every FDE encoding once. The CIEs share a few encodings.
+    PCEncoding encodings[256];
+    for (unsigned int i = 0; i < 256; ++i)
+      encodings[i] = DecodePCEncoding(i, pAddrSize);
 
     // prepare the binary search table
-    typedef std::vector<bit32::Entry> SearchTableType;
-    SearchTableType search_table;
-    MemoryRegion* ehframe_region =
-      pOutput.request(m_EhFrame.offset(), m_EhFrame.size());
-    EhFrame::const_fde_iterator fde, fde_end = m_EhFrame.getEhFrame()->fde_end();
-    for(fde = m_EhFrame.getEhFrame()->fde_begin(); fde != fde_end; ++fde) {
-      assert(*fde != NULL);
-      SizeTraits<32>::Offset offset;
-      SizeTraits<32>::Address fde_pc;
-      SizeTraits<32>::Address fde_addr;
-      offset = (*fde)->getOffset();
-      fde_pc = computePCBegin(**fde, *ehframe_region);
-      fde_addr = m_EhFrame.addr() + offset;
-      search_table.push_back(std::make_pair(fde_pc, fde_addr));
-    }
-    pOutput.release(ehframe_region);
+    std::vector<bit32::Entry> search_table(*fde_count);
+    PCBeginDecoder decoder = { this, m_EhFrame.getEhFrame(), encodings,
+                               ehframe_region, &search_table };
+    parallel_for(pThreads, 0, search_table.size(), decoder, 1024);
 
-    std::sort(search_table.begin(), search_table.end(), bit32::EntryCompare);
+    // A 32-bit output is sorted by the absolute locations. The locations of
+    // a 64-bit output are within the signed 32-bit range of .eh_frame_hdr.
+    bit32::EntryKey key;
+    if (4 == pAddrSize)
+      key.bias = m_EhFrameHdr.addr();
+    else
+      key.bias = 0x80000000u;
+    parallel_radix_sort(pThreads, search_table, key);
 
     // write out the binary search table
     uint32_t* bst = (uint32_t*)(data + 12);
-    SearchTableType::const_iterator entry, entry_end = search_table.end();
+    std::vector<bit32::Entry>::const_iterator entry, entry_end =
+                                                           search_table.end();
     size_t id = 0;
     for (entry = search_table.begin(); entry != entry_end; ++entry) {
-      bst[id++] = (*entry).first - m_EhFrameHdr.addr();
-      bst[id++] = (*entry).second - m_EhFrameHdr.addr();
+      bst[id++] = (*entry).first;
+      bst[id++] = (*entry).second;
     }
   }
   pOutput.release(ehframehdr_region);
   pOutput.release(ehframe_region);
 }
 
-/// emitOutput<64> - write out eh_frame_hdr
-template<>
-void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput)
-{
-}
-
-//===----------------------------------------------------------------------===//
-// EhFrameHdr
-//===----------------------------------------------------------------------===//
-
-EhFrameHdr::EhFrameHdr(LDSection& pEhFrameHdr, const LDSection& pEhFrame)
-  : m_EhFrameHdr(pEhFrameHdr), m_EhFrame(pEhFrame) {
-}
-
-EhFrameHdr::~EhFrameHdr()
-{
-}
-
-/// @ref lsb core generic 4.1
-/// .eh_frame_hdr section format
-/// uint8_t : version
-/// uint8_t : eh_frame_ptr_enc
-/// uint8_t : fde_count_enc
-/// uint8_t : table_enc
-/// uint32_t : eh_frame_ptr
-/// uint32_t : fde_count
-/// __________________________ when fde_count > 0
-/// <uint32_t, uint32_t>+ : binary search table
-/// sizeOutput - base on the fde count to size output
-void EhFrameHdr::sizeOutput()
-{
-  size_t size = 12;
-  if (m_EhFrame.hasEhFrame())
-    size += 8 * m_EhFrame.getEhFrame()->numOfFDEs();
-  m_EhFrameHdr.setSize(size);
-}
-
-/// computePCBegin - return the address of FDE's pc
-/// @ref binutils gold: ehframe.cc:222
-uint32_t EhFrameHdr::computePCBegin(const EhFrame::FDE& pFDE,
-                                    const MemoryRegion& pEhFrameRegion)
+/// DecodePCEncoding - decode the FDE encoding pEncoding of a CIE
+EhFrameHdr::PCEncoding EhFrameHdr::DecodePCEncoding(uint8_t pEncoding,
+                                                    size_t pAddrSize)
 {
-  uint8_t fde_encoding = pFDE.getCIE().getFDEEncode();
-  unsigned int eh_value = fde_encoding & 0x7;
+  PCEncoding result;
+  unsigned int eh_value = pEncoding & 0x7;
 
-  // check the size to read in
-  if (eh_value == llvm::dwarf::DW_EH_PE_absptr) {
-    eh_value = DW_EH_PE_udata4;
-  }
-
-  size_t pc_size = 0x0;
+  result.size = 0x0;
   switch (eh_value) {
+    case DW_EH_PE_absptr:
+      result.size = pAddrSize;
+      break;
     case DW_EH_PE_udata2:
-      pc_size = 2;
+      result.size = 2;
       break;
     case DW_EH_PE_udata4:
-      pc_size = 4;
+      result.size = 4;
       break;
     case DW_EH_PE_udata8:
-      pc_size = 8;
+      result.size = 8;
       break;
     default:
       // TODO
       break;
   }
 
-  SizeTraits<32>::Address pc = 0x0;
+  // adjust the signed value
+  result.isSigned = (pEncoding & llvm::dwarf::DW_EH_PE_signed) != 0x0;
+  result.application = pEncoding & 0x70;
+  return result;
+}
+
+/// computePCBegin - return the address of FDE's pc
+/// @ref binutils gold: ehframe.cc:222
+uint64_t EhFrameHdr::computePCBegin(const EhFrame::FDE& pFDE,
+                                    const PCEncoding& pEncoding,
+                                    const MemoryRegion& pEhFrameRegion) const
+{
+  SizeTraits<64>::Address pc = 0x0;
   const uint8_t* offset = (const uint8_t*) pEhFrameRegion.start() +
                           pFDE.getOffset() +
                           pFDE.getDataStart();
-  std::memcpy(&pc, offset, pc_size);
+  std::memcpy(&pc, offset, pEncoding.size);
 
-  // adjust the signed value
-  bool is_signed = (fde_encoding & llvm::dwarf::DW_EH_PE_signed) != 0x0;
-  if (DW_EH_PE_udata2 == eh_value && is_signed)
-    pc = (pc ^ 0x8000) - 0x8000;
+  // sign-extend the signed values
+  if (pEncoding.isSigned && 0 != pEncoding.size && pEncoding.size < 8) {
+    uint64_t sign = uint64_t(1) << (pEncoding.size * 8 - 1);
+    pc = (pc ^ sign) - sign;
+  }
 
   // handle eh application
-  switch (fde_encoding & 0x70)
+  switch (pEncoding.application)
   {
     case DW_EH_PE_absptr:
       break;
@@ -0,0 +1,325 @@
+//===- EhFrameOptimizer.cpp -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/EhFrameOptimizer.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/MemoryRegion.h>
+
+#include <llvm/Support/Casting.h>
+
+#include <algorithm>
+
+using namespace mcld;
+
+namespace {
+
+/// GetRelocSection - the input section that defines the symbol of pReloc.
+/// Return NULL if the symbol is not defined in any section.
+const LDSection* GetRelocSection(const Relocation& pReloc)
+{
+  if (NULL == pReloc.symInfo() || NULL == pReloc.symInfo()->outSymbol())
+    return NULL;
+
+  const LDSymbol* symbol = pReloc.symInfo()->outSymbol();
+  if (!symbol->hasFragRef())
+    return NULL;
+
+  const Fragment* frag = symbol->fragRef()->frag();
+  if (NULL == frag || NULL == frag->getParent())
+    return NULL;
+  return &frag->getParent()->getSection();
+}
+
+/// RelocOffsetCompare - order the relocations of an entry by their places
+struct RelocOffsetCompare
+{
+  bool operator()(const Relocation* pA, const Relocation* pB) const
+  { return pA->targetRef().offset() < pB->targetRef().offset(); }
+};
+
+/// Append - append the bytes of pValue to pKey
+template<typename T>
+void Append(std::string& pKey, const T& pValue)
+{
+  pKey.append(reinterpret_cast<const char*>(&pValue), sizeof(T));
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// EhFrameOptimizer
+//===----------------------------------------------------------------------===//
+EhFrameOptimizer::EhFrameOptimizer(const LinkerConfig& pConfig,
+                                   Module& pModule)
+  : m_Config(pConfig), m_Module(pModule) {
+}
+
+EhFrameOptimizer::~EhFrameOptimizer()
+{
+}
+
+uint64_t EhFrameOptimizer::run()
+{
+  // The CIEs and FDEs of a relocatable output are kept for the later links.
+  if (LinkerConfig::Object == m_Config.codeGenType())
+    return 0;
+
+  findCandidates();
+
+  CandidateList::iterator candidate, cEnd = m_Candidates.end();
+  for (candidate = m_Candidates.begin(); candidate != cEnd; ++candidate) {
+    RelocMap relocs;
+    std::vector<LDSection*>::iterator rs, rsEnd = candidate->relocs.end();
+    for (rs = candidate->relocs.begin(); rs != rsEnd; ++rs) {
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        relocs[relocation->targetRef().frag()].push_back(relocation);
+      }
+    }
+
+    pruneFDEs(*candidate, relocs);
+    mergeCIEs(*candidate, relocs);
+  }
+
+  if (m_Dropped.empty())
+    return 0;
+
+  // the symbols move before the fragments are deleted
+  redirectSymbols();
+
+  uint64_t removed = 0;
+  for (candidate = m_Candidates.begin(); candidate != cEnd; ++candidate) {
+    removeRelocations(*candidate);
+    removed += candidate->sect->getEhFrame()->remove(m_Dropped);
+  }
+  return removed;
+}
+
+void EhFrameOptimizer::findCandidates()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    size_t first = m_Candidates.size();
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      // An unparsed .eh_frame is a single fragment without CIEs.
+      if (LDFileFormat::EhFrame != (*sect)->kind() ||
+          !(*sect)->hasEhFrame() ||
+          0 == (*sect)->getEhFrame()->numOfCIEs())
+        continue;
+
+      Candidate candidate;
+      candidate.sect = *sect;
+      m_Candidates.push_back(candidate);
+    }
+
+    if (first == m_Candidates.size())
+      continue;
+
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      for (size_t i = first; i < m_Candidates.size(); ++i) {
+        if ((*rs)->getLink() == m_Candidates[i].sect)
+          m_Candidates[i].relocs.push_back(*rs);
+      }
+    }
+  }
+}
+
+void EhFrameOptimizer::pruneFDEs(Candidate& pCandidate,
+                                 const RelocMap& pRelocs)
+{
+  // Without relocations, nothing tells which functions the FDEs describe.
+  if (pCandidate.relocs.empty())
+    return;
+
+  EhFrame& eh_frame = *pCandidate.sect->getEhFrame();
+  std::set<const EhFrame::CIE*> used, live;
+  EhFrame::fde_iterator fde, fdeEnd = eh_frame.fde_end();
+  for (fde = eh_frame.fde_begin(); fde != fdeEnd; ++fde) {
+    used.insert(&(*fde)->getCIE());
+    if (isDead(**fde, pRelocs))
+      m_Dropped.insert(*fde);
+    else
+      live.insert(&(*fde)->getCIE());
+  }
+
+  // a CIE without any FDE at the beginning is kept
+  EhFrame::cie_iterator cie, cieEnd = eh_frame.cie_end();
+  for (cie = eh_frame.cie_begin(); cie != cieEnd; ++cie) {
+    if (0 != used.count(*cie) && 0 == live.count(*cie))
+      m_Dropped.insert(*cie);
+  }
+}
+
+bool EhFrameOptimizer::isDead(const EhFrame::FDE& pFDE,
+                              const RelocMap& pRelocs) const
+{
+  // The relocation of PC Begin is dropped when it refers to a discarded
+  // group section.
+  RelocMap::const_iterator entry = pRelocs.find(&pFDE);
+  if (pRelocs.end() == entry)
+    return true;
+
+  const Relocation* pc_begin = NULL;
+  std::vector<Relocation*>::const_iterator reloc, rEnd = entry->second.end();
+  for (reloc = entry->second.begin(); reloc != rEnd; ++reloc) {
+    if (pFDE.getDataStart() == (*reloc)->targetRef().offset()) {
+      pc_begin = *reloc;
+      break;
+    }
+  }
+  if (NULL == pc_begin)
+    return true;
+
+  const LDSection* target = GetRelocSection(*pc_begin);
+  return (NULL != target && LDFileFormat::Ignore == target->kind());
+}
+
+void EhFrameOptimizer::mergeCIEs(Candidate& pCandidate,
+                                 const RelocMap& pRelocs)
+{
+  EhFrame& eh_frame = *pCandidate.sect->getEhFrame();
+  std::map<const EhFrame::CIE*, const EhFrame::CIE*> leaders;
+  std::string key;
+  EhFrame::cie_iterator cie, cieEnd = eh_frame.cie_end();
+  for (cie = eh_frame.cie_begin(); cie != cieEnd; ++cie) {
+    if (0 != m_Dropped.count(*cie))
+      continue;
+
+    getKey(**cie, pRelocs, key);
+    std::pair<std::map<std::string, const EhFrame::CIE*>::iterator, bool>
+                           leader = m_Leaders.insert(std::make_pair(key, *cie));
+    if (leader.second)
+      continue;
+
+    m_Dropped.insert(*cie);
+    leaders[*cie] = leader.first->second;
+  }
+
+  if (leaders.empty())
+    return;
+
+  EhFrame::fde_iterator fde, fdeEnd = eh_frame.fde_end();
+  for (fde = eh_frame.fde_begin(); fde != fdeEnd; ++fde) {
+    std::map<const EhFrame::CIE*, const EhFrame::CIE*>::iterator entry =
+                                              leaders.find(&(*fde)->getCIE());
+    if (leaders.end() != entry)
+      (*fde)->setCIE(*entry->second);
+  }
+}
+
+void EhFrameOptimizer::getKey(const EhFrame::CIE& pCIE,
+                              const RelocMap& pRelocs,
+                              std::string& pKey) const
+{
+  pKey.assign(reinterpret_cast<const char*>(pCIE.getRegion().start()),
+              pCIE.size());
+
+  // the personality routine
+  RelocMap::const_iterator entry = pRelocs.find(&pCIE);
+  if (pRelocs.end() == entry)
+    return;
+
+  std::vector<Relocation*> relocs(entry->second);
+  std::sort(relocs.begin(), relocs.end(), RelocOffsetCompare());
+  std::vector<Relocation*>::const_iterator reloc, rEnd = relocs.end();
+  for (reloc = relocs.begin(); reloc != rEnd; ++reloc) {
+    Append(pKey, (*reloc)->targetRef().offset());
+    Append(pKey, (*reloc)->type());
+    Append(pKey, (*reloc)->symInfo());
+    Append(pKey, (*reloc)->addend());
+  }
+}
+
+void EhFrameOptimizer::removeRelocations(Candidate& pCandidate)
+{
+  std::vector<LDSection*>::iterator rs, rsEnd = pCandidate.relocs.end();
+  for (rs = pCandidate.relocs.begin(); rs != rsEnd; ++rs) {
+    RelocData::RelocationListType& list =
+                                 (*rs)->getRelocData()->getRelocationList();
+    RelocData::iterator reloc = list.begin(), rEnd = list.end();
+    while (reloc != rEnd) {
+      Relocation* relocation = llvm::cast<Relocation>(reloc);
+      ++reloc;
+      if (0 != m_Dropped.count(relocation->targetRef().frag()))
+        list.remove(relocation);
+    }
+  }
+}
+
+void EhFrameOptimizer::redirectSymbols()
+{
+  // A symbol in a removed entry moves to the start of the next kept entry,
+  // or to the end of the last one.
+  typedef std::map<const Fragment*, std::pair<Fragment*, uint64_t> > MoveMap;
+  MoveMap moved;
+  CandidateList::iterator candidate, cEnd = m_Candidates.end();
+  for (candidate = m_Candidates.begin(); candidate != cEnd; ++candidate) {
+    SectionData& data = candidate->sect->getEhFrame()->getSectionData();
+    std::vector<const Fragment*> pending;
+    Fragment* prev = NULL;
+    SectionData::iterator frag, fragEnd = data.end();
+    for (frag = data.begin(); frag != fragEnd; ++frag) {
+      if (0 != m_Dropped.count(&*frag)) {
+        pending.push_back(&*frag);
+        continue;
+      }
+      for (size_t i = 0; i < pending.size(); ++i)
+        moved[pending[i]] = std::make_pair(&*frag, uint64_t(0));
+      pending.clear();
+      prev = &*frag;
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+      moved[pending[i]] = std::make_pair(prev,
+                                         (NULL == prev) ? 0 : prev->size());
+    }
+  }
+
+  std::vector<LDSymbol*> symbols(m_Module.sym_begin(), m_Module.sym_end());
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    symbols.insert(symbols.end(),
+                   (*obj)->context()->symTabBegin(),
+                   (*obj)->context()->symTabEnd());
+  }
+
+  std::vector<LDSymbol*>::iterator sym, symEnd = symbols.end();
+  for (sym = symbols.begin(); sym != symEnd; ++sym) {
+    if (NULL == *sym || !(*sym)->hasFragRef())
+      continue;
+
+    MoveMap::iterator entry = moved.find((*sym)->fragRef()->frag());
+    if (moved.end() == entry)
+      continue;
+
+    if (NULL == entry->second.first) {
+      // nothing is kept in the section
+      (*sym)->setFragmentRef(NULL);
+      continue;
+    }
+    FragmentRef ref;
+    ref.assign(*entry->second.first, entry->second.second);
+    (*sym)->setFragmentRef(&ref);
+  }
+}
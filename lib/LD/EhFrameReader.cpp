@@ -14,6 +14,7 @@
 #include <mcld/MC/MCLDInput.h>
 #include <mcld/LD/EhFrame.h>
 #include <mcld/LD/LDSection.h>
+#include <mcld/Support/LEB128.h>
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MsgHandling.h>
 
@@ -23,20 +24,19 @@ using namespace llvm::dwarf;
 //===----------------------------------------------------------------------===//
 // Helper Functions
 //===----------------------------------------------------------------------===//
-/// skip_LEB128 - skip the first LEB128 encoded value from *pp, update *pp
-/// to the next character.
+/// skip_LEB128 - skip the first pNum LEB128 encoded values from *pp, update
+/// *pp to the next character.
 /// @return - false if we ran off the end of the string.
 /// @ref - GNU gold 1.11, ehframe.h, Eh_frame::skip_leb128.
 static bool
-skip_LEB128(EhFrameReader::ConstAddress* pp, EhFrameReader::ConstAddress pend)
+skip_LEB128(EhFrameReader::ConstAddress* pp, EhFrameReader::ConstAddress pend,
+            size_t pNum = 1)
 {
-  for (EhFrameReader::ConstAddress p = *pp; p < pend; ++p) {
-    if (0x0 == (*p & 0x80)) {
-      *pp = p + 1;
-      return true;
-    }
-  }
-  return false;
+  EhFrameReader::ConstAddress p = leb128::skip(*pp, pend, pNum);
+  if (NULL == p)
+    return false;
+  *pp = p;
+  return true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -89,6 +89,77 @@ EhFrameReader::scan<true>(ConstAddress pHandler,
 
 template<>
 bool EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame)
+{
+  SplitList splits;
+  split<32, true>(pInput, pEhFrame.getSection(), splits);
+  return build(pInput, pEhFrame, splits);
+}
+
+template<>
+bool EhFrameReader::read<64, true>(Input& pInput, EhFrame& pEhFrame)
+{
+  SplitList splits;
+  split<64, true>(pInput, pEhFrame.getSection(), splits);
+  return build(pInput, pEhFrame, splits);
+}
+
+template<>
+bool EhFrameReader::split<32, true>(Input& pInput,
+                                    const LDSection& pSection,
+                                    SplitList& pSplits)
+{
+  return parse(pInput, pSection, addCIE<32>, pSplits);
+}
+
+template<>
+bool EhFrameReader::split<64, true>(Input& pInput,
+                                    const LDSection& pSection,
+                                    SplitList& pSplits)
+{
+  return parse(pInput, pSection, addCIE<64>, pSplits);
+}
+
+bool EhFrameReader::build(Input& pInput,
+                          EhFrame& pEhFrame,
+                          const SplitList& pSplits)
+{
+  uint64_t sect_off = pInput.fileOffset() + pEhFrame.getSection().offset();
+  SplitList::const_iterator split, sEnd = pSplits.end();
+  for (split = pSplits.begin(); split != sEnd; ++split) {
+    if (Unknown == split->kind)
+      return false;
+
+    MemoryRegion* entry =
+      pInput.memArea()->request(sect_off + split->offset, split->size);
+    switch (split->kind) {
+      case CIE: {
+        EhFrame::CIE* cie = new EhFrame::CIE(*entry);
+        cie->setFDEEncode(split->fde_encoding);
+        pEhFrame.addCIE(*cie);
+        break;
+      }
+      case FDE: {
+        EhFrame::FDE* fde = new EhFrame::FDE(*entry,
+                                             pEhFrame.cie_back(),
+                                             split->data_off);
+        pEhFrame.addFDE(*fde);
+        break;
+      }
+      case Terminator:
+      default: {
+        RegionFragment* frag = new RegionFragment(*entry);
+        pEhFrame.addFragment(*frag);
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+bool EhFrameReader::parse(Input& pInput,
+                          const LDSection& pSection,
+                          Action pAddCIE,
+                          SplitList& pSplits)
 {
   // Alphabet:
   //   {CIE, FDE, CIEt}
@@ -116,37 +187,44 @@ bool EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame)
 
   const Action transition[NumOfStates][NumOfTokenKinds] = {
    /*    CIE     FDE     Term Unknown */
-    { addCIE, reject, addTerm, reject}, // Q0
-    { addCIE, addFDE, addTerm, reject}, // Q1
+    { pAddCIE, reject, addTerm, reject}, // Q0
+    { pAddCIE, addFDE, addTerm, reject}, // Q1
   };
 
   // get file offset and address
-  LDSection& section = pEhFrame.getSection();
-  uint64_t file_off = pInput.fileOffset() + section.offset();
+  uint64_t sect_off = pInput.fileOffset() + pSection.offset();
+  uint64_t file_off = sect_off;
   MemoryRegion* sect_reg =
-                       pInput.memArea()->request(file_off, section.size());
+                       pInput.memArea()->request(file_off, pSection.size());
   ConstAddress handler = (ConstAddress)sect_reg->start();
 
+  bool result = true;
   State cur_state = Q0;
   while (Reject != cur_state && Accept != cur_state) {
 
     Token token = scan<true>(handler, file_off, *sect_reg);
-    MemoryRegion* entry = pInput.memArea()->request(token.file_off, token.size);
 
-    if (!transition[cur_state][token.kind](pEhFrame, *entry, token)) {
+    // an entry across the end of the section is not parsed
+    if (token.size > static_cast<uint64_t>(sect_reg->end() - handler)) {
+      cur_state = Reject;
+      break;
+    }
+
+    Split split = { token.kind, file_off - sect_off, token.size,
+                    token.data_off, llvm::dwarf::DW_EH_PE_absptr };
+    if (!transition[cur_state][token.kind](handler, token, split)) {
       // fail to scan
       debug(diag::debug_cannot_scan_eh) << pInput.name();
-      return false;
+      result = false;
+      break;
     }
+    pSplits.push_back(split);
 
     file_off += token.size;
     handler += token.size;
 
     if (handler == sect_reg->end())
       cur_state = Accept;
-    else if (handler > sect_reg->end()) {
-      cur_state = Reject;
-    }
     else
       cur_state = autometa[cur_state][token.kind];
   } // end of while
@@ -154,18 +232,25 @@ bool EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame)
   if (Reject == cur_state) {
     // fail to parse
     debug(diag::debug_cannot_parse_eh) << pInput.name();
-    return false;
+    result = false;
   }
-  return true;
+
+  if (!result) {
+    Split unknown = { Unknown, file_off - sect_off, 0, 0,
+                      llvm::dwarf::DW_EH_PE_absptr };
+    pSplits.push_back(unknown);
+  }
+  return result;
 }
 
-bool EhFrameReader::addCIE(EhFrame& pEhFrame,
-                           MemoryRegion& pRegion,
-                           const EhFrameReader::Token& pToken)
+template<size_t BITCLASS>
+bool EhFrameReader::addCIE(ConstAddress pEntry,
+                           const EhFrameReader::Token& pToken,
+                           EhFrameReader::Split& pSplit)
 {
   // skip Length, Extended Length and CIE ID.
-  ConstAddress handler = pRegion.start() + pToken.data_off;
-  ConstAddress cie_end = pRegion.end();
+  ConstAddress handler = pEntry + pToken.data_off;
+  ConstAddress cie_end = pEntry + pToken.size;
 
   // the version should be 1 or 3
   uint8_t version = *handler++;
@@ -186,19 +271,23 @@ bool EhFrameReader::addCIE(EhFrame& pEhFrame,
   // skip the Augumentation String field
   handler = aug_str_back + 1;
 
-  // skip the Code Alignment Factor
-  if (!skip_LEB128(&handler, cie_end)) {
+  // skip the Code Alignment Factor and the Data Alignment Factor
+  if (!skip_LEB128(&handler, cie_end, 2)) {
     return false;
   }
-  // skip the Data Alignment Factor
-  if (!skip_LEB128(&handler, cie_end)) {
-    return false;
+  // skip the Return Address Register, a byte in version 1 and a ULEB128 in
+  // version 3
+  if (3 == version) {
+    if (!skip_LEB128(&handler, cie_end)) {
+      return false;
+    }
   }
-  // skip the Return Address Register
-  if (cie_end - handler < 1) {
-    return false;
+  else {
+    if (cie_end - handler < 1) {
+      return false;
+    }
+    ++handler;
   }
-  ++handler;
 
   // the Augmentation String start with 'eh' is a CIE from gcc before 3.0,
   // in LSB Core Spec 3.0RC1. We do not support it.
@@ -254,7 +343,7 @@ bool EhFrameReader::addCIE(EhFrame& pEhFrame,
               per_length = 8;
               break;
             case llvm::dwarf::DW_EH_PE_absptr:
-              per_length = 4; // pPkg.bitclass / 8;
+              per_length = BITCLASS / 8;
               break;
           }
           // skip the alignment
@@ -299,40 +388,32 @@ bool EhFrameReader::addCIE(EhFrame& pEhFrame,
     } // the rest chars.
   } // first char is 'z'
 
-  // create and push back the CIE entry
-  EhFrame::CIE* cie = new EhFrame::CIE(pRegion);
-  cie->setFDEEncode(fde_encoding);
-  pEhFrame.addCIE(*cie);
+  // the CIE entry is created by build()
+  pSplit.fde_encoding = fde_encoding;
   return true;
 }
 
-bool EhFrameReader::addFDE(EhFrame& pEhFrame,
-                           MemoryRegion& pRegion,
-                           const EhFrameReader::Token& pToken)
+bool EhFrameReader::addFDE(ConstAddress pEntry,
+                           const EhFrameReader::Token& pToken,
+                           EhFrameReader::Split& pSplit)
 {
-  if (pToken.data_off == pRegion.size())
+  if (pToken.data_off == pToken.size)
     return false;
 
-  // create and push back the FDE entry
-  EhFrame::FDE* fde = new EhFrame::FDE(pRegion,
-                                       pEhFrame.cie_back(),
-                                       pToken.data_off);
-  pEhFrame.addFDE(*fde);
+  // the FDE entry of the last CIE is created by build()
   return true;
 }
 
-bool EhFrameReader::addTerm(EhFrame& pEhFrame,
-                            MemoryRegion& pRegion,
-                            const EhFrameReader::Token& pToken)
+bool EhFrameReader::addTerm(ConstAddress pEntry,
+                            const EhFrameReader::Token& pToken,
+                            EhFrameReader::Split& pSplit)
 {
-  RegionFragment* frag = new RegionFragment(pRegion);
-  pEhFrame.addFragment(*frag);
   return true;
 }
 
-bool EhFrameReader::reject(EhFrame& pEhFrame,
-                           MemoryRegion& pRegion,
-                           const EhFrameReader::Token& pToken)
+bool EhFrameReader::reject(ConstAddress pEntry,
+                           const EhFrameReader::Token& pToken,
+                           EhFrameReader::Split& pSplit)
 {
   return true;
 }
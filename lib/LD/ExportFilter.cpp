@@ -0,0 +1,272 @@
+//===- ExportFilter.cpp ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ExportFilter.h>
+
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/Path.h>
+
+#include <algorithm>
+#include <cctype>
+
+using namespace mcld;
+
+namespace { // anonymous
+
+bool IsDelimiter(char pChar)
+{
+  return ('{' == pChar || '}' == pChar || ';' == pChar || ':' == pChar ||
+          '"' == pChar || 0 != isspace(static_cast<unsigned char>(pChar)));
+}
+
+/// NextToken - cut the next token out of pContent. A token is `{', `}',
+/// `;', `:', a quoted string or a run of the other characters. The spaces
+/// and the comments of `#' and `/* */' are skipped.
+/// @return an empty token at the end of pContent
+llvm::StringRef NextToken(llvm::StringRef& pContent)
+{
+  while (!pContent.empty()) {
+    if (0 != isspace(static_cast<unsigned char>(pContent[0])))
+      pContent = pContent.substr(1);
+    else if ('#' == pContent[0])
+      pContent = pContent.substr(pContent.find('\n'));
+    else if (pContent.startswith("/*"))
+      pContent = pContent.substr(pContent.find("*/", 2)).substr(2);
+    else
+      break;
+  }
+  if (pContent.empty())
+    return llvm::StringRef();
+
+  size_t length = 1;
+  if ('"' == pContent[0])
+    length = std::min(pContent.find('"', 1), pContent.size() - 1) + 1;
+  else if (!IsDelimiter(pContent[0])) {
+    while (length < pContent.size() && !IsDelimiter(pContent[length]))
+      ++length;
+  }
+  llvm::StringRef token = pContent.substr(0, length);
+  pContent = pContent.substr(length);
+  return token;
+}
+
+/// MatchChar - match pChar against the element of pPattern at pPos, which
+/// is `?', a bracket expression or a character, and move pPos past it
+bool MatchChar(llvm::StringRef pPattern, size_t& pPos, char pChar)
+{
+  if ('?' == pPattern[pPos]) {
+    ++pPos;
+    return true;
+  }
+
+  if ('[' == pPattern[pPos]) {
+    size_t i = pPos + 1;
+    bool negative = false;
+    if (i < pPattern.size() && ('!' == pPattern[i] || '^' == pPattern[i])) {
+      negative = true;
+      ++i;
+    }
+
+    // `]' right after the opening bracket is a member
+    size_t first = i;
+    bool matched = false;
+    while (i < pPattern.size() && (']' != pPattern[i] || first == i)) {
+      if (i + 2 < pPattern.size() && '-' == pPattern[i + 1] &&
+          ']' != pPattern[i + 2]) {
+        if (pPattern[i] <= pChar && pChar <= pPattern[i + 2])
+          matched = true;
+        i += 3;
+      }
+      else {
+        if (pPattern[i] == pChar)
+          matched = true;
+        ++i;
+      }
+    }
+
+    // an unclosed bracket is an ordinary character
+    if (i < pPattern.size()) {
+      pPos = i + 1;
+      return (matched != negative);
+    }
+  }
+
+  return (pPattern[pPos++] == pChar);
+}
+
+/// MatchGlob - does pName match the shell pattern pPattern?
+bool MatchGlob(llvm::StringRef pPattern, llvm::StringRef pName)
+{
+  // backtrack to the last `*' on a mismatch
+  size_t p = 0, n = 0;
+  size_t star = llvm::StringRef::npos, star_n = 0;
+  while (n < pName.size()) {
+    if (p < pPattern.size() && '*' == pPattern[p]) {
+      star = p++;
+      star_n = n;
+      continue;
+    }
+
+    size_t next = p;
+    if (p < pPattern.size() && MatchChar(pPattern, next, pName[n])) {
+      p = next;
+      ++n;
+      continue;
+    }
+
+    if (llvm::StringRef::npos == star)
+      return false;
+    p = star + 1;
+    n = ++star_n;
+  }
+
+  while (p < pPattern.size() && '*' == pPattern[p])
+    ++p;
+  return (p == pPattern.size());
+}
+
+bool MatchAny(const std::vector<std::string>& pPatterns, llvm::StringRef pName)
+{
+  std::vector<std::string>::const_iterator pattern, pEnd = pPatterns.end();
+  for (pattern = pPatterns.begin(); pattern != pEnd; ++pattern) {
+    if (MatchGlob(*pattern, pName))
+      return true;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// ExportFilter
+//===----------------------------------------------------------------------===//
+ExportFilter::ExportFilter()
+  : m_bDisabled(false) {
+}
+
+ExportFilter::~ExportFilter()
+{
+}
+
+bool ExportFilter::read(const sys::fs::Path& pPath, std::string& pContent)
+{
+  FileHandle file;
+  if (!file.open(pPath, FileHandle::ReadOnly))
+    return false;
+
+  pContent.assign(file.size(), '\0');
+  bool result = pContent.empty() ||
+                file.read(&pContent[0], 0, pContent.size());
+  file.close();
+  return result;
+}
+
+bool ExportFilter::readDynamicList(const sys::fs::Path& pPath)
+{
+  std::string content;
+  if (!read(pPath, content))
+    return false;
+  parseDynamicList(content);
+  return true;
+}
+
+bool ExportFilter::readVersionScript(const sys::fs::Path& pPath)
+{
+  std::string content;
+  if (!read(pPath, content))
+    return false;
+  parseVersionScript(content);
+  return true;
+}
+
+void ExportFilter::parseDynamicList(llvm::StringRef pContent)
+{
+  parse(pContent);
+
+  // the symbols not listed are hidden
+  addRule("*", Local);
+}
+
+void ExportFilter::parseVersionScript(llvm::StringRef pContent)
+{
+  parse(pContent);
+}
+
+void ExportFilter::parse(llvm::StringRef pContent)
+{
+  unsigned int depth = 0;
+  Scope scope = Global;
+  llvm::StringRef token = NextToken(pContent);
+  while (!token.empty()) {
+    llvm::StringRef next = NextToken(pContent);
+    if ("{" == token) {
+      // a version node exports its symbols unless local: is given
+      if (0 == depth++)
+        scope = Global;
+    }
+    else if ("}" == token) {
+      if (0 != depth)
+        --depth;
+    }
+    else if (0 == depth || ";" == token || ":" == token) {
+      // version names, dependencies and separators
+    }
+    else if ("extern" == token) {
+      m_bDisabled = true;
+      return;
+    }
+    else if (":" == next && ("global" == token || "local" == token)) {
+      scope = ("global" == token) ? Global : Local;
+      next = NextToken(pContent);
+    }
+    else
+      addRule(token, scope);
+    token = next;
+  }
+}
+
+void ExportFilter::addRule(llvm::StringRef pName, Scope pScope)
+{
+  llvm::StringRef name = pName;
+  if (2 <= pName.size() && '"' == pName[0] && '"' == pName[pName.size() - 1])
+    name = pName.substr(1, pName.size() - 2);
+  else if (llvm::StringRef::npos != pName.find_first_of("*?[")) {
+    if (Global == pScope)
+      m_GlobalPatterns.push_back(pName.str());
+    else
+      m_LocalPatterns.push_back(pName.str());
+    return;
+  }
+
+  NameMap::iterator entry = m_Names.find(name);
+  if (m_Names.end() == entry)
+    m_Names[name] = pScope;
+  else if (Global == pScope)
+    entry->setValue(Global);
+}
+
+bool ExportFilter::isExported(llvm::StringRef pName) const
+{
+  if (m_bDisabled)
+    return true;
+
+  NameMap::const_iterator entry = m_Names.find(pName);
+  if (m_Names.end() != entry)
+    return (Global == entry->getValue());
+
+  if (MatchAny(m_GlobalPatterns, pName))
+    return true;
+  return !MatchAny(m_LocalPatterns, pName);
+}
+
+bool ExportFilter::empty() const
+{
+  return (m_Names.empty() &&
+          m_GlobalPatterns.empty() &&
+          m_LocalPatterns.empty());
+}
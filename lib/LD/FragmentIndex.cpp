@@ -0,0 +1,63 @@
+//===- FragmentIndex.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/FragmentIndex.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Fragment/Fragment.h>
+
+#include <algorithm>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// FragmentIndex
+//===----------------------------------------------------------------------===//
+FragmentIndex::FragmentIndex()
+{
+}
+
+FragmentIndex::FragmentIndex(SectionData& pSD)
+{
+  build(pSD);
+}
+
+void FragmentIndex::build(SectionData& pSD)
+{
+  clear();
+  uint64_t offset = 0;
+  m_Offsets.push_back(offset);
+  SectionData::iterator frag, fragEnd = pSD.end();
+  for (frag = pSD.begin(); frag != fragEnd; ++frag) {
+    m_Fragments.push_back(&*frag);
+    offset += frag->size();
+    m_Offsets.push_back(offset);
+  }
+}
+
+void FragmentIndex::clear()
+{
+  m_Fragments.clear();
+  m_Offsets.clear();
+}
+
+Fragment* FragmentIndex::find(uint64_t& pOffset) const
+{
+  if (m_Fragments.empty())
+    return NULL;
+
+  // the first fragment which ends at or after pOffset
+  OffsetList::const_iterator end =
+    std::lower_bound(m_Offsets.begin() + 1, m_Offsets.end(), pOffset);
+  if (m_Offsets.end() == end)
+    return NULL;
+
+  size_t idx = (end - m_Offsets.begin()) - 1;
+  pOffset -= m_Offsets[idx];
+  return m_Fragments[idx];
+}
+
@@ -10,51 +10,147 @@
 
 #include <mcld/Module.h>
 #include <mcld/InputTree.h>
+#include <mcld/LinkerConfig.h>
 #include <mcld/MC/Attribute.h>
 #include <mcld/MC/MCLDInput.h>
+#include <mcld/LD/ArchiveIndexCache.h>
+#include <mcld/LD/DynObjReader.h>
 #include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/NamePool.h>
 #include <mcld/LD/ELFObjectReader.h>
+#include <mcld/LD/LDReader.h>
 #include <mcld/Support/FileSystem.h>
 #include <mcld/Support/FileHandle.h>
+#include <mcld/Support/LinkStats.h>
 #include <mcld/Support/MemoryArea.h>
-#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MemoryView.h>
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/Path.h>
+#include <mcld/Support/ThreadPool.h>
 #include <mcld/ADT/SizeTraits.h>
 
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Host.h>
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 
 using namespace mcld;
 
+namespace { // anonymous
+
+/// MemberPreloader - the body of parallel_for to preload the i-th member
+struct MemberPreloader
+{
+  ELFObjectReader* reader;
+  MemoryArea* area;
+  const std::vector<size_t>* offsets;
+
+  void operator()(size_t pIdx) {
+    reader->preload(*area, (*offsets)[pIdx]);
+  }
+};
+
+/// MemberSymbolReader - the body of parallel_for to read the names of the
+/// symbols defined by the i-th member
+struct MemberSymbolReader
+{
+  ELFObjectReader* reader;
+  MemoryArea* area;
+  const std::vector<size_t>* offsets;
+  std::vector<std::vector<std::string> >* names;
+
+  void operator()(size_t pIdx) {
+    reader->readSymbolNames(*area, (*offsets)[pIdx], (*names)[pIdx]);
+  }
+};
+
+/// FirstMemberOffset - the offset of the member header following the armap.
+/// The size of the armap is zero if the archive has none.
+uint64_t FirstMemberOffset(const Archive& pArchive)
+{
+  if (0 == pArchive.getSymTabSize())
+    return Archive::MAGIC_LEN;
+  return Archive::MAGIC_LEN + sizeof(Archive::MemberHeader) +
+         pArchive.getSymTabSize();
+}
+
+/// FromBigEndian - the armap words are in big-endian
+inline uint32_t FromBigEndian(uint32_t pWord)
+{
+  return llvm::sys::isLittleEndianHost() ? mcld::bswap32(pWord) : pWord;
+}
+
+inline uint64_t FromBigEndian(uint64_t pWord)
+{
+  return llvm::sys::isLittleEndianHost() ? mcld::bswap64(pWord) : pWord;
+}
+
+/// ReadArmap - add the symbols of an armap of WordType words to pArchive. The
+/// armap is the number of symbols, the file offsets of the members which
+/// define the symbols, and then the NUL-terminated symbol names.
+template<typename WordType>
+void ReadArmap(Archive& pArchive, const uint8_t* pBuffer)
+{
+  const WordType* data = reinterpret_cast<const WordType*>(pBuffer);
+
+  // read the number of symbols
+  WordType number = FromBigEndian(*data);
+
+  // set up the pointers for file offset and name offset
+  ++data;
+  const char* name = reinterpret_cast<const char*>(data + number);
+
+  // add the archive symbols
+  for (WordType i = 0; i < number; ++i) {
+    pArchive.addSymbol(name, FromBigEndian(*data));
+    name += strlen(name) + 1;
+    ++data;
+  }
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// GNUArchiveReader
+//===----------------------------------------------------------------------===//
 GNUArchiveReader::GNUArchiveReader(Module& pModule,
-                                   ELFObjectReader& pELFObjectReader)
+                                   ELFObjectReader& pELFObjectReader,
+                                   const LinkerConfig& pConfig,
+                                   DynObjReader* pDynObjReader)
  : m_Module(pModule),
-   m_ELFObjectReader(pELFObjectReader)
+   m_ELFObjectReader(pELFObjectReader),
+   m_Config(pConfig),
+   m_pDynObjReader(pDynObjReader),
+   m_pIndexCache(NULL)
 {
+  if (pConfig.options().hasArchiveIndexCache()) {
+    sys::fs::Path dir(pConfig.options().archiveIndexCache());
+    if (sys::fs::is_directory(dir))
+      m_pIndexCache = new ArchiveIndexCache(dir);
+    else
+      warning(diag::warn_bad_archive_index_cache) << dir;
+  }
 }
 
 GNUArchiveReader::~GNUArchiveReader()
 {
+  delete m_pIndexCache;
 }
 
 /// isMyFormat
 bool GNUArchiveReader::isMyFormat(Input& pInput) const
 {
   assert(pInput.hasMemArea());
-  MemoryRegion* region = pInput.memArea()->request(pInput.fileOffset(),
-                                                   Archive::MAGIC_LEN);
-  const char* str = reinterpret_cast<const char*>(region->getBuffer());
+  // the readers share the probe of the input
+  if (pInput.probeSize() < Archive::MAGIC_LEN)
+    return false;
+  const char* str = reinterpret_cast<const char*>(pInput.probe());
 
   bool result = false;
-  assert(NULL != str);
   if (isArchive(str) || isThinArchive(str))
     result = true;
-
-  pInput.memArea()->release(region);
   return result;
 }
 
@@ -74,51 +170,91 @@ bool GNUArchiveReader::isThinArchive(const char* pStr) const
 bool GNUArchiveReader::isThinArchive(Input& pInput) const
 {
   assert(pInput.hasMemArea());
-  MemoryRegion* region = pInput.memArea()->request(pInput.fileOffset(),
-                                                   Archive::MAGIC_LEN);
-  const char* str = reinterpret_cast<const char*>(region->getBuffer());
+  if (pInput.probeSize() < Archive::MAGIC_LEN)
+    return false;
+  const char* str = reinterpret_cast<const char*>(pInput.probe());
 
   bool result = false;
-  assert(NULL != str);
   if (isThinArchive(str))
     result = true;
-
-  pInput.memArea()->release(region);
   return result;
 }
 
 bool GNUArchiveReader::readArchive(Archive& pArchive)
 {
   // bypass the empty archive
-  if (Archive::MAGIC_LEN == pArchive.getARFile().memArea()->handler()->size())
+  if (Archive::MAGIC_LEN == pArchive.getARFile().memArea()->size())
     return true;
 
   if (pArchive.getARFile().attribute()->isWholeArchive())
     return includeAllMembers(pArchive);
 
   // if this is the first time read this archive, setup symtab and strtab
-  if (pArchive.getSymbolTable().empty()) {
-  // read the symtab of the archive
-  readSymbolTable(pArchive);
-
-  // read the strtab of the archive
-  readStringTable(pArchive);
+  if (!pArchive.hasArchiveMember(pArchive.getARFile().name())) {
+    // use the cached index of the archive if any. Otherwise, read the symtab
+    // and the strtab of the archive, and then cache them
+    if (NULL == m_pIndexCache || !m_pIndexCache->load(pArchive)) {
+      bool has_armap = readSymbolTable(pArchive);
+      readStringTable(pArchive);
+      if (!has_armap)
+        buildSymbolTable(pArchive);
+      if (NULL != m_pIndexCache)
+        m_pIndexCache->store(pArchive);
+    }
 
-  // add root archive to ArchiveMemberMap
-  pArchive.addArchiveMember(pArchive.getARFile().name(),
-                            pArchive.inputs().root(),
-                            &InputTree::Downward);
+    // add root archive to ArchiveMemberMap
+    pArchive.addArchiveMember(pArchive.getARFile().name(),
+                              pArchive.inputs().root(),
+                              &InputTree::Downward);
   }
 
-  // include the needed members in the archive and build up the input tree
-  bool willSymResolved;
-  do {
-    willSymResolved = false;
-    for (size_t idx = 0; idx < pArchive.numOfSymbols(); ++idx) {
+  // include the needed members in the archive and build up the input tree.
+  // Every undefined symbol is looked up in the armap once. Including a member
+  // appends its undefined symbols to the list, and they are looked up in the
+  // next round. When the archive is read again, only the symbols added since
+  // the last read are looked up.
+  const NamePool::UndefListType& undefs = m_Module.getNamePool().getUndefList();
+  size_t i = pArchive.getUndefCursor();
+  CandidateList candidates;
+  while (i < undefs.size()) {
+    // 1. select the members that define the undefined symbols
+    candidates.clear();
+    for (size_t end = undefs.size(); i < end; ++i) {
+      const ResolveInfo* info = undefs[i];
+      size_t idx = pArchive.findSymbol(llvm::StringRef(info->name(),
+                                                       info->nameSize()));
+      if (LinkStats::isEnabled())
+        LinkStats::Add(LinkStats::ArchiveLookups);
+      if (Archive::kNoSymbol == idx)
+        continue;
+
       // bypass if we already decided to include this symbol or not
       if (Archive::Symbol::Unknown != pArchive.getSymbolStatus(idx))
         continue;
 
+      // a shared library read before the archive defines the symbol, even
+      // if its symbols are read lazily
+      if (NULL != m_pDynObjReader && info->isUndef())
+        m_pDynObjReader->importSymbol(*info);
+
+      Archive::Symbol::Status status = shouldIncludeSymbol(*info);
+      if (Archive::Symbol::Exclude == status)
+        pArchive.setSymbolStatus(idx, status);
+      else if (Archive::Symbol::Include == status)
+        candidates.push_back(std::make_pair(idx, info));
+    }
+
+    // 2. read the tables of the selected members in parallel
+    preloadMembers(pArchive, candidates);
+
+    // 3. include the members in order. A member may define the symbols of the
+    // following candidates, so check the symbols again.
+    CandidateList::iterator cand, cEnd = candidates.end();
+    for (cand = candidates.begin(); cand != cEnd; ++cand) {
+      size_t idx = cand->first;
+      if (Archive::Symbol::Unknown != pArchive.getSymbolStatus(idx))
+        continue;
+
       // bypass if another symbol with the same object file offset is included
       if (pArchive.hasObjectMember(pArchive.getObjFileOffset(idx))) {
         pArchive.setSymbolStatus(idx, Archive::Symbol::Include);
@@ -126,22 +262,149 @@ bool GNUArchiveReader::readArchive(Archive& pArchive)
       }
 
       // check if we should include this defined symbol
-      Archive::Symbol::Status status =
-        shouldIncludeSymbol(pArchive.getSymbolName(idx));
+      if (LinkStats::isEnabled())
+        LinkStats::Add(LinkStats::ArchiveMembersScanned);
+      Archive::Symbol::Status status = shouldIncludeSymbol(*cand->second);
       if (Archive::Symbol::Unknown != status)
         pArchive.setSymbolStatus(idx, status);
 
       if (Archive::Symbol::Include == status) {
         // include the object member from the given offset
         includeMember(pArchive, pArchive.getObjFileOffset(idx));
-        willSymResolved = true;
-      } // end of if
+      }
     } // end of for
-  } while (willSymResolved);
+  } // end of while
+  pArchive.setUndefCursor(i);
 
   return true;
 }
 
+/// preloadMembers - read the ELF headers, the section header tables and the
+/// symbol tables of the candidate members in parallel. The IR of members is
+/// still created by includeMember() in order.
+void GNUArchiveReader::preloadMembers(Archive& pArchive,
+                                      const CandidateList& pCandidates)
+{
+  if (!m_Config.options().isMultiThreads() || pCandidates.size() < 2)
+    return;
+
+  // members of a thin archive are files by themselves
+  if (isThinArchive(pArchive.getARFile())) {
+    openThinMembers(pArchive, pCandidates);
+    return;
+  }
+
+  std::vector<size_t> offsets;
+  offsets.reserve(pCandidates.size());
+  CandidateList::const_iterator cand, cEnd = pCandidates.end();
+  for (cand = pCandidates.begin(); cand != cEnd; ++cand) {
+    offsets.push_back(pArchive.getARFile().fileOffset() +
+                      pArchive.getObjFileOffset(cand->first) +
+                      sizeof(Archive::MemberHeader));
+  }
+  std::sort(offsets.begin(), offsets.end());
+  offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+
+  MemberPreloader preloader = { &m_ELFObjectReader,
+                                pArchive.getARFile().memArea(),
+                                &offsets };
+  parallel_for(m_Config.threads(), 0, offsets.size(), preloader);
+}
+
+/// openThinMembers - open the files of the candidate members of a thin
+/// archive concurrently. Opening a file on a network storage takes a round
+/// trip, so opening the members one by one in includeMember() serializes the
+/// link. The opened files are found again when the members are included.
+void GNUArchiveReader::openThinMembers(Archive& pArchive,
+                                       const CandidateList& pCandidates)
+{
+  Input& ar_file = pArchive.getARFile();
+  std::vector<uint64_t> offsets;
+  offsets.reserve(pCandidates.size());
+  CandidateList::const_iterator cand, cEnd = pCandidates.end();
+  for (cand = pCandidates.begin(); cand != cEnd; ++cand) {
+    uint64_t offset = pArchive.getObjFileOffset(cand->first);
+    if (!pArchive.hasObjectMember(offset))
+      offsets.push_back(offset);
+  }
+  std::sort(offsets.begin(), offsets.end());
+  offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+
+  std::vector<sys::fs::Path> paths;
+  paths.reserve(offsets.size());
+  std::vector<uint64_t>::iterator offset, oEnd = offsets.end();
+  for (offset = offsets.begin(); offset != oEnd; ++offset) {
+    MemoryView header_view =
+      ar_file.memArea()->view(ar_file.fileOffset() + *offset,
+                              sizeof(Archive::MemberHeader));
+    const Archive::MemberHeader* header =
+      reinterpret_cast<const Archive::MemberHeader*>(header_view.getBuffer());
+
+    // a nested archive is opened once by its first member
+    std::string member_name;
+    uint64_t nested_offset = 0;
+    readMemberName(pArchive, *header, member_name, nested_offset);
+    if (NULL != pArchive.getArchiveMember(member_name))
+      continue;
+
+    paths.push_back(sys::fs::Path());
+    getThinMemberPath(ar_file, member_name, paths.back());
+  }
+
+  if (paths.size() > 1)
+    pArchive.openMemberFiles(m_Config.threads(), paths);
+}
+
+/// readMemberName - read the name of a member from its header. The name of a
+/// member in a thin archive is in the extended name table of the root, and
+/// may be followed by the offset of the member in a nested archive.
+void GNUArchiveReader::readMemberName(const Archive& pArchiveRoot,
+                                      const Archive::MemberHeader& pHeader,
+                                      std::string& pName,
+                                      uint64_t& pNestedOffset) const
+{
+  llvm::StringRef name_field(pHeader.name, sizeof(pHeader.name));
+  if ('/' != pHeader.name[0]) {
+    // this is an object file in an archive
+    size_t pos = name_field.find_first_of('/');
+    pName.assign(name_field.substr(0, pos).str());
+    return;
+  }
+
+  // this is an object/archive file in a thin archive
+  size_t begin = 1;
+  size_t end = name_field.find_first_of(" :");
+  uint32_t name_offset = 0;
+  // parse the name offset
+  name_field.substr(begin, end - begin).getAsInteger(10, name_offset);
+
+  if (':' == name_field[end]) {
+    // there is a nested offset
+    begin = end + 1;
+    end = name_field.find_first_of(' ', begin);
+    name_field.substr(begin, end - begin).getAsInteger(10, pNestedOffset);
+  }
+
+  // get the member name from the extended name table
+  assert(pArchiveRoot.hasStrTable());
+  begin = name_offset;
+  end = pArchiveRoot.getStrTable().find_first_of('\n', begin);
+  pName.assign(pArchiveRoot.getStrTable().substr(begin, end - begin -1));
+}
+
+/// getThinMemberPath - the path of a member of a thin archive is relative to
+/// the archive
+void GNUArchiveReader::getThinMemberPath(const Input& pArchiveFile,
+                                         const std::string& pName,
+                                         sys::fs::Path& pPath) const
+{
+  pPath = pArchiveFile.path().parent_path();
+  if (!pPath.empty())
+    pPath.append(pName);
+  else
+    pPath.assign(pName);
+}
+
 /// readMemberHeader - read the header of a member in a archive file and then
 /// return the corresponding archive member (it may be an input object or
 /// another archive)
@@ -153,51 +416,25 @@ bool GNUArchiveReader::readArchive(Archive& pArchive)
 /// @param pMemberSize   - the file size of this member
 Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
                                           Input& pArchiveFile,
-                                          uint32_t pFileOffset,
-                                          uint32_t& pNestedOffset,
+                                          uint64_t pFileOffset,
+                                          uint64_t& pNestedOffset,
                                           size_t& pMemberSize)
 {
   assert(pArchiveFile.hasMemArea());
 
-  MemoryRegion* header_region =
-    pArchiveFile.memArea()->request((pArchiveFile.fileOffset() + pFileOffset),
-                                    sizeof(Archive::MemberHeader));
+  MemoryView header_view =
+    pArchiveFile.memArea()->view((pArchiveFile.fileOffset() + pFileOffset),
+                                 sizeof(Archive::MemberHeader));
   const Archive::MemberHeader* header =
-    reinterpret_cast<const Archive::MemberHeader*>(header_region->getBuffer());
+    reinterpret_cast<const Archive::MemberHeader*>(header_view.getBuffer());
 
   assert(0 == memcmp(header->fmag, Archive::MEMBER_MAGIC, sizeof(header->fmag)));
 
-  pMemberSize = atoi(header->size);
+  pMemberSize = strtoull(header->size, NULL, 10);
 
   // parse the member name and nested offset if any
   std::string member_name;
-  llvm::StringRef name_field(header->name, sizeof(header->name));
-  if ('/' != header->name[0]) {
-    // this is an object file in an archive
-    size_t pos = name_field.find_first_of('/');
-    member_name.assign(name_field.substr(0, pos).str());
-  }
-  else {
-    // this is an object/archive file in a thin archive
-    size_t begin = 1;
-    size_t end = name_field.find_first_of(" :");
-    uint32_t name_offset = 0;
-    // parse the name offset
-    name_field.substr(begin, end - begin).getAsInteger(10, name_offset);
-
-    if (':' == name_field[end]) {
-      // there is a nested offset
-      begin = end + 1;
-      end = name_field.find_first_of(' ', begin);
-      name_field.substr(begin, end - begin).getAsInteger(10, pNestedOffset);
-    }
-
-    // get the member name from the extended name table
-    assert(pArchiveRoot.hasStrTable());
-    begin = name_offset;
-    end = pArchiveRoot.getStrTable().find_first_of('\n', begin);
-    member_name.assign(pArchiveRoot.getStrTable().substr(begin, end - begin -1));
-  }
+  readMemberName(pArchiveRoot, *header, member_name, pNestedOffset);
 
   Input* member = NULL;
   bool isThinAR = isThinArchive(pArchiveFile);
@@ -221,11 +458,8 @@ Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
 
     // get nested file path, the nested file's member name is the relative
     // path to the archive containing it.
-    sys::fs::Path input_path(pArchiveFile.path().parent_path());
-    if (!input_path.empty())
-      input_path.append(member_name);
-    else
-      input_path.assign(member_name);
+    sys::fs::Path input_path;
+    getThinMemberPath(pArchiveFile, member_name, input_path);
 
     member = pArchiveRoot.getMemberFile(pArchiveFile,
                                         isThinAR,
@@ -233,129 +467,170 @@ Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
                                         input_path);
   }
 
-  pArchiveFile.memArea()->release(header_region);
   return member;
 }
 
-/// readSymbolTable - read the archive symbol map (armap)
+/// readSymbolTable - read the archive symbol map (armap). An archive created
+/// without the `s' modifier of ar(1) has no armap, then the size of the armap
+/// is set to zero and false is returned.
 bool GNUArchiveReader::readSymbolTable(Archive& pArchive)
 {
   assert(pArchive.getARFile().hasMemArea());
 
-  MemoryRegion* header_region =
-    pArchive.getARFile().memArea()->request((pArchive.getARFile().fileOffset() +
-                                             Archive::MAGIC_LEN),
-                                            sizeof(Archive::MemberHeader));
+  MemoryView header_view =
+    pArchive.getARFile().memArea()->view((pArchive.getARFile().fileOffset() +
+                                          Archive::MAGIC_LEN),
+                                         sizeof(Archive::MemberHeader));
   const Archive::MemberHeader* header =
-    reinterpret_cast<const Archive::MemberHeader*>(header_region->getBuffer());
+    reinterpret_cast<const Archive::MemberHeader*>(header_view.getBuffer());
   assert(0 == memcmp(header->fmag, Archive::MEMBER_MAGIC, sizeof(header->fmag)));
 
-  int symtab_size = atoi(header->size);
+  if (0 != memcmp(header->name, Archive::SVR4_SYMTAB_NAME,
+                  sizeof(header->name)) &&
+      0 != memcmp(header->name, Archive::SYM64_SYMTAB_NAME,
+                  sizeof(header->name))) {
+    pArchive.setSymTabSize(0);
+    return false;
+  }
+
+  size_t symtab_size = strtoull(header->size, NULL, 10);
   pArchive.setSymTabSize(symtab_size);
 
   if (!pArchive.getARFile().attribute()->isWholeArchive()) {
-    MemoryRegion* symtab_region =
-      pArchive.getARFile().memArea()->request(
-                                            (pArchive.getARFile().fileOffset() +
-                                             Archive::MAGIC_LEN +
-                                             sizeof(Archive::MemberHeader)),
-                                            symtab_size);
-    const uint32_t* data =
-      reinterpret_cast<const uint32_t*>(symtab_region->getBuffer());
-
-    // read the number of symbols
-    uint32_t number = 0;
-    if (llvm::sys::isLittleEndianHost())
-      number = mcld::bswap32(*data);
+    MemoryView symtab_view =
+      pArchive.getARFile().memArea()->view(
+                                         (pArchive.getARFile().fileOffset() +
+                                          Archive::MAGIC_LEN +
+                                          sizeof(Archive::MemberHeader)),
+                                         symtab_size);
+    // the armap of an archive over 4 GiB is named /SYM64/, and its words are
+    // 64-bit
+    if (0 == memcmp(header->name, Archive::SYM64_SYMTAB_NAME,
+                    sizeof(header->name)))
+      ReadArmap<uint64_t>(pArchive, symtab_view.getBuffer());
     else
-      number = *data;
-
-    // set up the pointers for file offset and name offset
-    ++data;
-    const char* name = reinterpret_cast<const char*>(data + number);
-
-    // add the archive symbols
-    for (uint32_t i = 0; i < number; ++i) {
-      if (llvm::sys::isLittleEndianHost())
-        pArchive.addSymbol(name, mcld::bswap32(*data));
-      else
-        pArchive.addSymbol(name, *data);
-      name += strlen(name) + 1;
-      ++data;
-    }
-    pArchive.getARFile().memArea()->release(symtab_region);
+      ReadArmap<uint32_t>(pArchive, symtab_view.getBuffer());
   }
-  pArchive.getARFile().memArea()->release(header_region);
   return true;
 }
 
 /// readStringTable - read the strtab for long file name of the archive
 bool GNUArchiveReader::readStringTable(Archive& pArchive)
 {
-  size_t offset = Archive::MAGIC_LEN +
-                  sizeof(Archive::MemberHeader) +
-                  pArchive.getSymTabSize();
+  size_t offset = FirstMemberOffset(pArchive);
 
   if (0x0 != (offset & 1))
     ++offset;
 
   assert(pArchive.getARFile().hasMemArea());
 
-  MemoryRegion* header_region =
-    pArchive.getARFile().memArea()->request((pArchive.getARFile().fileOffset() +
-                                             offset),
-                                            sizeof(Archive::MemberHeader));
+  MemoryView header_view =
+    pArchive.getARFile().memArea()->view((pArchive.getARFile().fileOffset() +
+                                          offset),
+                                         sizeof(Archive::MemberHeader));
   const Archive::MemberHeader* header =
-    reinterpret_cast<const Archive::MemberHeader*>(header_region->getBuffer());
+    reinterpret_cast<const Archive::MemberHeader*>(header_view.getBuffer());
 
   assert(0 == memcmp(header->fmag, Archive::MEMBER_MAGIC, sizeof(header->fmag)));
 
   if (0 == memcmp(header->name, Archive::STRTAB_NAME, sizeof(header->name))) {
     // read the extended name table
-    int strtab_size = atoi(header->size);
-    MemoryRegion* strtab_region =
-      pArchive.getARFile().memArea()->request(
-                                   (pArchive.getARFile().fileOffset() +
-                                    offset + sizeof(Archive::MemberHeader)),
-                                   strtab_size);
+    size_t strtab_size = strtoull(header->size, NULL, 10);
+    MemoryView strtab_view =
+      pArchive.getARFile().memArea()->view(
+                                (pArchive.getARFile().fileOffset() +
+                                 offset + sizeof(Archive::MemberHeader)),
+                                strtab_size);
     const char* strtab =
-      reinterpret_cast<const char*>(strtab_region->getBuffer());
+      reinterpret_cast<const char*>(strtab_view.getBuffer());
     pArchive.getStrTable().assign(strtab, strtab_size);
-    pArchive.getARFile().memArea()->release(strtab_region);
   }
-  pArchive.getARFile().memArea()->release(header_region);
   return true;
 }
 
-/// shouldIncludeStatus - given a sym name from armap and check if including
-/// the corresponding archive member, and then return the decision
+/// buildSymbolTable - build the armap of an archive without one from the
+/// symbol tables of its members. The members are read in parallel through
+/// the ELF reader, and then their symbols are added in the order of the
+/// members, as ar(1) writes an armap, so the members are selected as if the
+/// archive had an armap.
+void GNUArchiveReader::buildSymbolTable(Archive& pArchive)
+{
+  Input& ar_file = pArchive.getARFile();
+
+  // the members of a thin archive are files by themselves, and opening all of
+  // them costs more than the armap saves
+  if (isThinArchive(ar_file)) {
+    warning(diag::warn_archive_without_armap) << ar_file.path();
+    return;
+  }
+
+  // 1. find the object members. The extended name table is not a member.
+  std::vector<uint64_t> headers;
+  std::vector<size_t> offsets;
+  uint64_t end_offset = ar_file.memArea()->size();
+  uint64_t offset = FirstMemberOffset(pArchive);
+  while (offset + sizeof(Archive::MemberHeader) <= end_offset) {
+    MemoryView header_view =
+      ar_file.memArea()->view(ar_file.fileOffset() + offset,
+                              sizeof(Archive::MemberHeader));
+    const Archive::MemberHeader* header =
+      reinterpret_cast<const Archive::MemberHeader*>(header_view.getBuffer());
+    if (0 != memcmp(header->fmag, Archive::MEMBER_MAGIC, sizeof(header->fmag)))
+      break;
+
+    if (0 != memcmp(header->name, Archive::STRTAB_NAME, sizeof(header->name))) {
+      headers.push_back(offset);
+      offsets.push_back(ar_file.fileOffset() + offset +
+                        sizeof(Archive::MemberHeader));
+    }
+
+    offset += sizeof(Archive::MemberHeader) +
+              strtoull(header->size, NULL, 10);
+    if (0x0 != (offset & 1))
+      ++offset;
+  }
+
+  // 2. read the names of the symbols defined by the members in parallel
+  std::vector<std::vector<std::string> > names(offsets.size());
+  MemberSymbolReader reader = { &m_ELFObjectReader,
+                                ar_file.memArea(),
+                                &offsets,
+                                &names };
+  parallel_for(m_Config.threads(), 0, offsets.size(), reader);
+
+  // 3. add the symbols in order
+  for (size_t i = 0; i < headers.size(); ++i) {
+    std::vector<std::string>::const_iterator name, nEnd = names[i].end();
+    for (name = names[i].begin(); name != nEnd; ++name)
+      pArchive.addSymbol(name->c_str(), headers[i]);
+  }
+}
+
+/// shouldIncludeStatus - given the resolved symbol of an armap entry, check if
+/// including the corresponding archive member, and then return the decision
 enum Archive::Symbol::Status
-GNUArchiveReader::shouldIncludeSymbol(const llvm::StringRef& pSymName) const
+GNUArchiveReader::shouldIncludeSymbol(const ResolveInfo& pInfo) const
 {
   // TODO: handle symbol version issue and user defined symbols
-  const ResolveInfo* info = m_Module.getNamePool().findInfo(pSymName);
-  if (NULL != info) {
-    if (!info->isUndef())
-      return Archive::Symbol::Exclude;
-    if (info->isWeak())
-      return Archive::Symbol::Unknown;
-    return Archive::Symbol::Include;
-  }
-  return Archive::Symbol::Unknown;
+  if (!pInfo.isUndef())
+    return Archive::Symbol::Exclude;
+  if (pInfo.isWeak())
+    return Archive::Symbol::Unknown;
+  return Archive::Symbol::Include;
 }
 
 /// includeMember - include the object member in the given file offset, and
 /// return the size of the object
 /// @param pArchiveRoot - the archive root
 /// @param pFileOffset  - file offset of the member header in the archive
-size_t GNUArchiveReader::includeMember(Archive& pArchive, uint32_t pFileOffset)
+size_t GNUArchiveReader::includeMember(Archive& pArchive, uint64_t pFileOffset)
 {
   Input* cur_archive = &(pArchive.getARFile());
   Input* member = NULL;
-  uint32_t file_offset = pFileOffset;
+  uint64_t file_offset = pFileOffset;
   size_t size = 0;
   do {
-    uint32_t nested_offset = 0;
+    uint64_t nested_offset = 0;
     // use the file offset in current archive to find out the member we
     // want to include
     member = readMemberHeader(pArchive,
@@ -371,6 +646,15 @@ size_t GNUArchiveReader::includeMember(Archive& pArchive, uint32_t pFileOffset)
         continue;
     }
 
+    // a bitcode member is compiled by the link time optimization if it is
+    // needed, so nothing of it is linked here.
+    if (Input::Bitcode == LDReader::Sniff(*member)) {
+      member->setType(Input::Bitcode);
+      if (!m_Config.bitcode().isLTO())
+        error(diag::err_bitcode_input_without_lto) << member->name();
+      return size;
+    }
+
     // insert a node into the subtree of current archive.
     Archive::ArchiveMember* parent =
       pArchive.getArchiveMember(cur_archive->name());
@@ -385,11 +669,18 @@ size_t GNUArchiveReader::includeMember(Archive& pArchive, uint32_t pFileOffset)
 
     if (m_ELFObjectReader.isMyFormat(*member)) {
       member->setType(Input::Object);
+      // the symbols of the members of an --exclude-libs archive are hidden
+      // when they are read
+      if (m_Config.options().isInExcludeLIBS(pArchive.getARFile()))
+        member->setNoExport();
       pArchive.addObjectMember(pFileOffset, parent->lastPos);
       m_ELFObjectReader.readHeader(*member);
       m_ELFObjectReader.readSections(*member);
+      m_Module.assignOrdinal(*member);
       m_ELFObjectReader.readSymbols(*member);
       m_Module.getObjectList().push_back(member);
+      if (LinkStats::isEnabled())
+        LinkStats::Add(LinkStats::ArchiveMembersIncluded);
     }
     else if (isMyFormat(*member)) {
       member->setType(Input::Archive);
@@ -421,21 +712,21 @@ bool GNUArchiveReader::includeAllMembers(Archive& pArchive)
                             &InputTree::Downward);
 
   bool isThinAR = isThinArchive(pArchive.getARFile());
-  uint32_t begin_offset = pArchive.getARFile().fileOffset() +
-                          Archive::MAGIC_LEN +
-                          sizeof(Archive::MemberHeader) +
-                          pArchive.getSymTabSize();
+  uint64_t begin_offset = pArchive.getARFile().fileOffset() +
+                          FirstMemberOffset(pArchive);
   if (pArchive.hasStrTable()) {
     if (0x0 != (begin_offset & 1))
       ++begin_offset;
     begin_offset += sizeof(Archive::MemberHeader) +
                     pArchive.getStrTable().size();
   }
-  uint32_t end_offset = pArchive.getARFile().memArea()->handler()->size();
-  for (uint32_t offset = begin_offset;
+  uint64_t end_offset = pArchive.getARFile().memArea()->size();
+  for (uint64_t offset = begin_offset;
        offset < end_offset;
        offset += sizeof(Archive::MemberHeader)) {
 
+    if (LinkStats::isEnabled())
+      LinkStats::Add(LinkStats::ArchiveMembersScanned);
     size_t size = includeMember(pArchive, offset);
 
     if (!isThinAR) {
@@ -0,0 +1,385 @@
+//===- GarbageCollection.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/GarbageCollection.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/EhFrame.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/NamePool.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Target/TargetLDBackend.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <cassert>
+#include <cctype>
+
+using namespace mcld;
+
+/// getSymbolSection - the input section that defines pSymbol. Return NULL if
+/// pSymbol is not defined in any section, e.g., undefined, absolute, common
+/// and dynamic symbols.
+static const LDSection* getSymbolSection(const LDSymbol* pSymbol)
+{
+  if (NULL == pSymbol || !pSymbol->hasFragRef())
+    return NULL;
+
+  const Fragment* frag = pSymbol->fragRef()->frag();
+  if (NULL == frag || NULL == frag->getParent())
+    return NULL;
+  return &frag->getParent()->getSection();
+}
+
+static const LDSection* getRelocSection(const Relocation& pReloc)
+{
+  if (NULL == pReloc.symInfo())
+    return NULL;
+  return getSymbolSection(pReloc.symInfo()->outSymbol());
+}
+
+/// IsInDiscardedSection - the symbol is defined in a removed section
+static bool IsInDiscardedSection(const LDSymbol& pSymbol)
+{
+  const LDSection* sect = getSymbolSection(&pSymbol);
+  return (NULL != sect && LDFileFormat::Ignore == sect->kind());
+}
+
+/// IsRemovable - only the sections of code, data and LSDA can be removed. The
+/// others, such as .eh_frame, notes and target-dependent sections, are kept.
+static bool IsRemovable(const LDSection& pSection)
+{
+  switch (pSection.kind()) {
+    case LDFileFormat::Regular:
+    case LDFileFormat::BSS:
+    case LDFileFormat::GCCExceptTable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// IsCIdentifier - sections named as C identifiers may be referred by the
+/// linker-defined __start_SECNAME and __stop_SECNAME symbols.
+static bool IsCIdentifier(llvm::StringRef pName)
+{
+  if (pName.empty() || 0 != isdigit(static_cast<unsigned char>(pName[0])))
+    return false;
+
+  for (size_t i = 0; i < pName.size(); ++i) {
+    if ('_' != pName[i] &&
+        0 == isalnum(static_cast<unsigned char>(pName[i])))
+      return false;
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// GarbageCollection
+//===----------------------------------------------------------------------===//
+GarbageCollection::GarbageCollection(const LinkerConfig& pConfig,
+                                     const TargetLDBackend& pBackend,
+                                     Module& pModule,
+                                     ObjectReader* pReader)
+  : m_Config(pConfig), m_Backend(pBackend), m_Module(pModule),
+    m_pReader(pReader) {
+}
+
+GarbageCollection::~GarbageCollection()
+{
+}
+
+bool GarbageCollection::run()
+{
+  // 1. traverse all the relocations read to set up the reached sections of
+  // each input section
+  setUpReachedSections();
+
+  // 2. get the sections that must be kept
+  SectionListTy entry;
+  getEntrySections(entry);
+
+  // 3. find all the sections that can be reached by the kept sections
+  if (!findReferencedSections(entry))
+    return false;
+
+  // 4. remove the unreached sections
+  stripSections();
+  return true;
+}
+
+void GarbageCollection::addReachedSection(const LDSection& pFrom,
+                                          const LDSection& pTo)
+{
+  if (&pFrom == &pTo)
+    return;
+  m_SectionReachedListMap[&pFrom].push_back(&pTo);
+  if (0 != m_ReferencedSections.count(&pFrom))
+    m_LateReached.push_back(&pTo);
+}
+
+void GarbageCollection::setUpReachedSections()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind())
+        continue;
+
+      const LDSection* apply_sect = (*rs)->getLink();
+      if (NULL == apply_sect || LDFileFormat::Ignore == apply_sect->kind())
+        continue;
+
+      // read the relocations once the section they apply to is reached
+      if (!(*rs)->hasRelocData()) {
+        if (NULL != m_pReader)
+          m_PendingRelocs[apply_sect].push_back(std::make_pair(*obj, *rs));
+        continue;
+      }
+      setUpReachedSections(**rs);
+    } // for all relocation sections
+  } // for all inputs
+}
+
+void GarbageCollection::setUpReachedSections(const LDSection& pRelocSect)
+{
+  if (!pRelocSect.hasRelocData())
+    return;
+
+  const LDSection* apply_sect = pRelocSect.getLink();
+
+  // The references from non-allocatable sections, such as debugging
+  // information, do not keep the referred sections alive.
+  if (0x0 == (apply_sect->flag() & llvm::ELF::SHF_ALLOC))
+    return;
+
+  if (LDFileFormat::EhFrame == apply_sect->kind() &&
+      apply_sect->hasEhFrame()) {
+    setUpEhFrameReachedSections(pRelocSect);
+    return;
+  }
+
+  RelocData::const_iterator reloc, rEnd = pRelocSect.getRelocData()->end();
+  for (reloc = pRelocSect.getRelocData()->begin(); reloc != rEnd; ++reloc) {
+    const Relocation* relocation = llvm::cast<Relocation>(reloc);
+    const LDSection* target = getRelocSection(*relocation);
+    if (NULL != target)
+      addReachedSection(*apply_sect, *target);
+  }
+}
+
+void GarbageCollection::setUpEhFrameReachedSections(const LDSection& pRelocSect)
+{
+  const EhFrame& eh_frame = *pRelocSect.getLink()->getEhFrame();
+
+  // The relocation at the lowest offset of an FDE is its pc_begin, which
+  // refers to the function described by the FDE.
+  typedef std::map<const Fragment*, const Relocation*> PCBeginMap;
+  PCBeginMap pc_begin;
+  EhFrame::const_fde_iterator fde, fdeEnd = eh_frame.fde_end();
+  for (fde = eh_frame.fde_begin(); fde != fdeEnd; ++fde)
+    pc_begin[*fde] = NULL;
+
+  RelocData::const_iterator reloc, rEnd = pRelocSect.getRelocData()->end();
+  for (reloc = pRelocSect.getRelocData()->begin(); reloc != rEnd; ++reloc) {
+    const Relocation* relocation = llvm::cast<Relocation>(reloc);
+    PCBeginMap::iterator entry = pc_begin.find(relocation->targetRef().frag());
+    if (pc_begin.end() == entry)
+      continue;
+    if (NULL == entry->second ||
+        relocation->targetRef().offset() < entry->second->targetRef().offset())
+      entry->second = relocation;
+  }
+
+  for (reloc = pRelocSect.getRelocData()->begin(); reloc != rEnd; ++reloc) {
+    const Relocation* relocation = llvm::cast<Relocation>(reloc);
+    const LDSection* target = getRelocSection(*relocation);
+    if (NULL == target)
+      continue;
+
+    PCBeginMap::iterator entry = pc_begin.find(relocation->targetRef().frag());
+    if (pc_begin.end() == entry) {
+      // CIEs and the unparsed contents refer to personality routines. They
+      // are kept with .eh_frame.
+      addReachedSection(eh_frame.getSection(), *target);
+    }
+    else if (relocation != entry->second) {
+      // the function keeps its LSDA
+      const LDSection* func = getRelocSection(*entry->second);
+      if (NULL != func)
+        addReachedSection(*func, *target);
+    }
+  }
+}
+
+bool GarbageCollection::isKept(const LDSection& pSection)
+{
+  if (!IsRemovable(pSection))
+    return true;
+
+  if (0x0 == (pSection.flag() & llvm::ELF::SHF_ALLOC))
+    return true;
+
+  // sections run by the system without being referred
+  static const char* kept_prefixes[] = {
+    ".init",
+    ".fini",
+    ".preinit_array",
+    ".ctors",
+    ".dtors",
+    ".jcr"
+  };
+  static const size_t num_of_prefixes =
+                          sizeof(kept_prefixes) / sizeof(kept_prefixes[0]);
+
+  llvm::StringRef name(pSection.name());
+  for (size_t i = 0; i < num_of_prefixes; ++i) {
+    if (name.startswith(kept_prefixes[i]))
+      return true;
+  }
+
+  return IsCIdentifier(name);
+}
+
+void GarbageCollection::addSymbolSection(const LDSymbol* pSymbol,
+                                         SectionListTy& pEntry)
+{
+  const LDSection* sect = getSymbolSection(pSymbol);
+  if (NULL != sect)
+    pEntry.push_back(sect);
+}
+
+void GarbageCollection::getEntrySections(SectionListTy& pEntry)
+{
+  // 1. the sections that must be kept
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (isKept(**sect))
+        pEntry.push_back(*sect);
+    }
+  }
+
+  // 2. the section of the entry symbol
+  llvm::StringRef entry_name;
+  if (m_Config.options().hasEntry())
+    entry_name = m_Config.options().entry();
+  else
+    entry_name = m_Backend.getEntry();
+  addSymbolSection(m_Module.getNamePool().findSymbol(entry_name), pEntry);
+
+  // 3. the sections of the exported symbols
+  if (LinkerConfig::DynObj == m_Config.codeGenType() ||
+      m_Config.options().exportDynamic()) {
+    Module::SymbolTable& symbols = m_Module.getSymbolTable();
+    Module::sym_iterator symbol, symEnd = symbols.dynamicEnd();
+    for (symbol = symbols.dynamicBegin(); symbol != symEnd; ++symbol)
+      addSymbolSection(*symbol, pEntry);
+  }
+}
+
+bool GarbageCollection::findReferencedSections(SectionListTy& pEntry)
+{
+  // use pEntry as the work list. The relocation sections of the sections
+  // reached are read when the work list runs out.
+  ObjectReader::RelocSectionList pending;
+  while (!pEntry.empty() || !pending.empty()) {
+    if (pEntry.empty()) {
+      if (!readRelocations(pending, pEntry))
+        return false;
+      pending.clear();
+      continue;
+    }
+
+    const LDSection* sect = pEntry.back();
+    pEntry.pop_back();
+    if (!m_ReferencedSections.insert(sect).second)
+      continue;
+
+    PendingRelocMap::iterator relocs = m_PendingRelocs.find(sect);
+    if (m_PendingRelocs.end() != relocs) {
+      pending.insert(pending.end(), relocs->second.begin(),
+                                    relocs->second.end());
+      m_PendingRelocs.erase(relocs);
+    }
+
+    SectionReachedListMap::iterator reached =
+                                        m_SectionReachedListMap.find(sect);
+    if (m_SectionReachedListMap.end() == reached)
+      continue;
+
+    SectionListTy::iterator it, itEnd = reached->second.end();
+    for (it = reached->second.begin(); it != itEnd; ++it) {
+      if (0 == m_ReferencedSections.count(*it))
+        pEntry.push_back(*it);
+    }
+  }
+  return true;
+}
+
+bool GarbageCollection::readRelocations(
+                                 const ObjectReader::RelocSectionList& pList,
+                                 SectionListTy& pEntry)
+{
+  assert(NULL != m_pReader);
+  if (!m_pReader->readRelocations(pList))
+    return false;
+
+  // the relocations of the reached sections refer to more sections
+  ObjectReader::RelocSectionList::const_iterator rs, rsEnd = pList.end();
+  for (rs = pList.begin(); rs != rsEnd; ++rs)
+    setUpReachedSections(*rs->second);
+
+  pEntry.insert(pEntry.end(), m_LateReached.begin(), m_LateReached.end());
+  m_LateReached.clear();
+  return true;
+}
+
+void GarbageCollection::stripSections()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (IsRemovable(**sect) && 0 == m_ReferencedSections.count(*sect))
+        (*sect)->setKind(LDFileFormat::Ignore);
+    }
+
+    // the relocations of the removed sections are neither scanned nor applied
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (NULL != (*rs)->getLink() &&
+          LDFileFormat::Ignore == (*rs)->getLink()->kind())
+        (*rs)->setKind(LDFileFormat::Ignore);
+    }
+  }
+
+  // The symbols defined in the removed sections are not emitted. The
+  // relocations of the non-allocatable sections may still refer to them, and
+  // they see zero.
+  Module::sym_iterator symbol, symEnd = m_Module.sym_end();
+  for (symbol = m_Module.sym_begin(); symbol != symEnd; ++symbol) {
+    if (IsInDiscardedSection(**symbol))
+      (*symbol)->setValue(0x0);
+  }
+  m_Module.getSymbolTable().removeIf(IsInDiscardedSection);
+}
+
@@ -0,0 +1,428 @@
+//===- GdbIndex.cpp -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/GdbIndex.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Module.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// Helper Functions
+//===----------------------------------------------------------------------===//
+namespace {
+
+const uint32_t Version = 7;
+const uint32_t HeaderSize = 6 * 4;
+const uint32_t CUEntrySize = 8 + 8;
+const uint32_t AddressEntrySize = 8 + 8 + 4;
+const uint32_t MinNumOfSlots = 1024;
+
+/// the kinds of the names of .debug_pubnames and .debug_pubtypes, which do
+/// not have the attributes of the GNU ones
+const uint32_t KindType = 1;
+
+/// Contents - the contents of the input section pSection, or NULL
+const uint8_t* Contents(const LDSection& pSection)
+{
+  if (!pSection.hasSectionData() || pSection.getSectionData()->empty())
+    return NULL;
+  const Fragment& frag = pSection.getSectionData()->front();
+  if (Fragment::Region != frag.getKind() || frag.size() != pSection.size())
+    return NULL;
+  return llvm::cast<RegionFragment>(frag).getRegion().start();
+}
+
+/// Read - read the pBytes-byte little endian value at pData
+uint64_t Read(const uint8_t* pData, unsigned int pBytes)
+{
+  uint64_t result = 0x0;
+  for (unsigned int i = 0; i < pBytes; ++i)
+    result |= static_cast<uint64_t>(pData[i]) << (8 * i);
+  return result;
+}
+
+/// Write - write the pBytes-byte little endian value pValue at pData. The
+/// index is little endian on every target.
+void Write(uint8_t* pData, uint64_t pValue, unsigned int pBytes)
+{
+  for (unsigned int i = 0; i < pBytes; ++i)
+    pData[i] = static_cast<uint8_t>(pValue >> (8 * i));
+}
+
+/// FragmentOffset - the offset of the fragment in its section
+uint64_t FragmentOffset(const Fragment* pFrag)
+{
+  return pFrag->hasOffset() ? pFrag->getOffset() : 0x0;
+}
+
+/// ReadAddends - map the places of the relocations of pSection to their
+/// addends. The .debug_info offsets of a RELA object are in the addends, and
+/// the ones of a REL object are in place.
+void ReadAddends(const Input& pInput,
+                 const LDSection& pSection,
+                 std::map<uint64_t, int64_t>& pAddends)
+{
+  LDContext::const_sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (&pSection != (*rs)->getLink() || !(*rs)->hasRelocData())
+      continue;
+
+    RelocData::const_iterator reloc, rEnd = (*rs)->getRelocData()->end();
+    for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+      const Relocation* relocation = llvm::cast<Relocation>(reloc);
+      const FragmentRef& place = relocation->targetRef();
+      pAddends[FragmentOffset(place.frag()) + place.offset()] =
+        relocation->addend();
+    }
+  }
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// GdbIndex::ObjectReader
+//===----------------------------------------------------------------------===//
+/// ObjectReader - read the objects on the thread pool
+struct GdbIndex::ObjectReader
+{
+  std::vector<Input*>* inputs;
+  std::vector<ObjectIndex>* indices;
+
+  void operator()(size_t pIdx) {
+    GdbIndex::ReadObject(*(*inputs)[pIdx], (*indices)[pIdx]);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// GdbIndex
+//===----------------------------------------------------------------------===//
+GdbIndex::GdbIndex(LDSection& pGdbIndex)
+  : m_GdbIndex(pGdbIndex),
+    m_NumOfSlots(0),
+    m_AddressOffset(0),
+    m_SymbolOffset(0),
+    m_PoolOffset(0) {
+}
+
+GdbIndex::~GdbIndex()
+{
+}
+
+/// Hash - mapped_index_string_hash() of gdb for the index version 5 and later
+uint32_t GdbIndex::Hash(const std::string& pName)
+{
+  uint32_t result = 0;
+  for (size_t i = 0; i < pName.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(pName[i]);
+    result = result * 67 + std::tolower(c) - 113;
+  }
+  return result;
+}
+
+/// ReadObject - read the compile units of .debug_info, the executable
+/// sections and the public names of pInput
+void GdbIndex::ReadObject(Input& pInput, ObjectIndex& pIndex)
+{
+  std::vector<const LDSection*> pubs;
+  LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+  for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+    LDSection& section = **sect;
+    // the index of an input is stale in the output
+    if (".gdb_index" == section.name()) {
+      section.setKind(LDFileFormat::Ignore);
+      continue;
+    }
+
+    if (LDFileFormat::Regular == section.kind() && 0 != section.size() &&
+        (llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR) ==
+          (section.flag() & (llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR)) &&
+        section.hasSectionData() && !section.getSectionData()->empty()) {
+      AddressRange range = { &section.getSectionData()->front(),
+                             section.size(), 0 };
+      pIndex.ranges.push_back(range);
+      continue;
+    }
+
+    if (LDFileFormat::Debug != section.kind())
+      continue;
+
+    if (".debug_info" == section.name()) {
+      const uint8_t* data = Contents(section);
+      if (NULL == data)
+        continue;
+
+      // the compile unit headers. A DWARF64 unit has a 12-byte length.
+      const Fragment* info = &section.getSectionData()->front();
+      uint64_t offset = 0;
+      while (offset + 4 <= section.size()) {
+        uint64_t length = Read(data + offset, 4);
+        uint64_t header = 4;
+        if (0xffffffff == length) {
+          if (offset + 12 > section.size())
+            break;
+          length = Read(data + offset + 4, 8);
+          header = 12;
+        }
+        if (0 == length || offset + header + length > section.size())
+          break;
+        CompileUnit unit = { info, offset, header + length };
+        pIndex.units.push_back(unit);
+        offset += header + length;
+      }
+    }
+    else if (".debug_gnu_pubnames" == section.name() ||
+             ".debug_gnu_pubtypes" == section.name() ||
+             ".debug_pubnames" == section.name() ||
+             ".debug_pubtypes" == section.name()) {
+      pubs.push_back(&section);
+    }
+  }
+
+  if (pIndex.units.empty()) {
+    pIndex.ranges.clear();
+    return;
+  }
+
+  for (size_t i = 0; i < pubs.size(); ++i) {
+    const std::string& name = pubs[i]->name();
+    bool is_gnu = (0 == name.compare(0, 11, ".debug_gnu_"));
+    bool is_type = ('t' == name[name.size() - 5]);
+    ReadPubNames(pInput, *pubs[i], is_gnu, is_type, pIndex);
+  }
+}
+
+/// ReadPubNames - read the name sets of pSection. The set of a compile unit
+/// refers to it by its offset in .debug_info, and a set of an unknown
+/// offset goes to the first compile unit.
+void GdbIndex::ReadPubNames(Input& pInput,
+                            const LDSection& pSection,
+                            bool pIsGNU,
+                            bool pIsType,
+                            ObjectIndex& pIndex)
+{
+  const uint8_t* data = Contents(pSection);
+  if (NULL == data)
+    return;
+
+  std::map<uint64_t, int64_t> addends;
+  ReadAddends(pInput, pSection, addends);
+
+  uint64_t base = FragmentOffset(&pSection.getSectionData()->front());
+  uint64_t size = pSection.size();
+  uint64_t offset = 0;
+  while (offset + 14 <= size) {
+    // the set header: unit_length, version, debug_info_offset and
+    // debug_info_length. The DWARF64 sets are not indexed.
+    uint64_t length = Read(data + offset, 4);
+    if (0 == length || 0xffffffff == length || offset + 4 + length > size)
+      break;
+    uint64_t set_end = offset + 4 + length;
+
+    uint64_t info_offset = Read(data + offset + 6, 4);
+    std::map<uint64_t, int64_t>::const_iterator addend =
+      addends.find(base + offset + 6);
+    if (addends.end() != addend)
+      info_offset += addend->second;
+
+    uint32_t unit = 0;
+    for (size_t i = 0; i < pIndex.units.size(); ++i) {
+      if (info_offset == pIndex.units[i].offset) {
+        unit = i;
+        break;
+      }
+    }
+
+    // the tuples of DIE offset, the attributes of the GNU ones, and name
+    uint64_t cursor = offset + 14;
+    while (cursor + 4 <= set_end) {
+      if (0 == Read(data + cursor, 4))
+        break;
+      cursor += 4;
+
+      uint32_t attrs = pIsType ? (KindType << 28) : 0;
+      if (pIsGNU) {
+        if (cursor >= set_end)
+          break;
+        // the kind in bits 4-6 and the static bit 7 are the bits 28-31
+        attrs = static_cast<uint32_t>(data[cursor] & 0xf0) << 24;
+        ++cursor;
+      }
+
+      const char* name = reinterpret_cast<const char*>(data + cursor);
+      size_t name_size = strnlen(name, set_end - cursor);
+      if (cursor + name_size >= set_end)
+        break;
+      cursor += name_size + 1;
+
+      PubName pub_name = { std::string(name, name_size), unit, attrs };
+      pIndex.names.push_back(pub_name);
+    }
+    offset = set_end;
+  }
+}
+
+/// read - read the objects in parallel, and then gather them in the input
+/// order, so the index is the same whatever the number of the threads
+void GdbIndex::read(Module& pModule, ThreadPool& pThreads)
+{
+  std::vector<Input*> inputs(pModule.obj_begin(), pModule.obj_end());
+  std::vector<ObjectIndex> indices(inputs.size());
+  ObjectReader reader = { &inputs, &indices };
+  parallel_for(pThreads, 0, inputs.size(), reader);
+
+  for (size_t i = 0; i < indices.size(); ++i) {
+    ObjectIndex& index = indices[i];
+    uint32_t base = m_Units.size();
+    m_Units.insert(m_Units.end(), index.units.begin(), index.units.end());
+
+    for (size_t r = 0; r < index.ranges.size(); ++r) {
+      m_Ranges.push_back(index.ranges[r]);
+      m_Ranges.back().unit = base;
+    }
+
+    for (size_t n = 0; n < index.names.size(); ++n) {
+      const PubName& pub_name = index.names[n];
+      llvm::StringMapEntry<uint32_t>& entry =
+        m_SymbolMap.GetOrCreateValue(pub_name.name, m_Symbols.size());
+      if (entry.getValue() == m_Symbols.size()) {
+        m_Symbols.push_back(Symbol());
+        m_Symbols.back().name = pub_name.name;
+      }
+      m_Symbols[entry.getValue()].units.push_back(
+        (base + pub_name.unit) | pub_name.attrs);
+    }
+  }
+
+  // a name of a compile unit may be in both pubnames and pubtypes
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    std::vector<uint32_t>& units = m_Symbols[i].units;
+    std::sort(units.begin(), units.end());
+    units.erase(std::unique(units.begin(), units.end()), units.end());
+  }
+}
+
+/// sizeOutput - the symbol table is at most 3/4 full, as the one of gdb
+void GdbIndex::sizeOutput()
+{
+  if (m_Units.empty()) {
+    m_GdbIndex.setSize(0);
+    return;
+  }
+
+  m_NumOfSlots = MinNumOfSlots;
+  while (m_NumOfSlots * 3 < m_Symbols.size() * 4)
+    m_NumOfSlots *= 2;
+
+  uint64_t pool_size = 0;
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    pool_size += 4 * (1 + m_Symbols[i].units.size());
+    pool_size += m_Symbols[i].name.size() + 1;
+  }
+
+  m_AddressOffset = HeaderSize + CUEntrySize * m_Units.size();
+  m_SymbolOffset = m_AddressOffset + AddressEntrySize * m_Ranges.size();
+  m_PoolOffset = m_SymbolOffset + 8 * m_NumOfSlots;
+  m_GdbIndex.setSize(m_PoolOffset + pool_size);
+}
+
+/// emitOutput - the offsets of the compile units and the addresses of the
+/// code are known after the layout
+void GdbIndex::emitOutput(MemoryArea& pOutput)
+{
+  if (0 == m_GdbIndex.size())
+    return;
+
+  MemoryRegion* region = pOutput.request(m_GdbIndex.offset(),
+                                         m_GdbIndex.size());
+  if (NULL == region)
+    return;
+  uint8_t* data = region->start();
+  std::memset(data, 0x0, m_GdbIndex.size());
+
+  // header, the types CU list is empty
+  Write(data, Version, 4);
+  Write(data + 4, HeaderSize, 4);
+  Write(data + 8, m_AddressOffset, 4);
+  Write(data + 12, m_AddressOffset, 4);
+  Write(data + 16, m_SymbolOffset, 4);
+  Write(data + 20, m_PoolOffset, 4);
+
+  // CU list
+  uint8_t* entry = data + HeaderSize;
+  for (size_t i = 0; i < m_Units.size(); ++i, entry += CUEntrySize) {
+    Write(entry, FragmentOffset(m_Units[i].info) + m_Units[i].offset, 8);
+    Write(entry + 8, m_Units[i].length, 8);
+  }
+
+  // address area
+  entry = data + m_AddressOffset;
+  for (size_t i = 0; i < m_Ranges.size(); ++i, entry += AddressEntrySize) {
+    const Fragment* frag = m_Ranges[i].frag;
+    uint64_t low = frag->getParent()->getSection().addr() +
+                   FragmentOffset(frag);
+    Write(entry, low, 8);
+    Write(entry + 8, low + m_Ranges[i].size, 8);
+    Write(entry + 16, m_Ranges[i].unit, 4);
+  }
+
+  // constant pool, the CU vectors and then the names
+  std::vector<uint32_t> vector_offsets(m_Symbols.size());
+  uint32_t pool = 0;
+  uint8_t* pool_data = data + m_PoolOffset;
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    const std::vector<uint32_t>& units = m_Symbols[i].units;
+    vector_offsets[i] = pool;
+    Write(pool_data + pool, units.size(), 4);
+    for (size_t u = 0; u < units.size(); ++u)
+      Write(pool_data + pool + 4 * (1 + u), units[u], 4);
+    pool += 4 * (1 + units.size());
+  }
+
+  // symbol table, an empty slot is a pair of zeros
+  uint32_t mask = m_NumOfSlots - 1;
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    const std::string& name = m_Symbols[i].name;
+    std::memcpy(pool_data + pool, name.data(), name.size());
+
+    uint32_t hash = Hash(name);
+    uint32_t slot = hash & mask;
+    uint32_t step = ((hash * 17) & mask) | 1;
+    uint8_t* slot_data = data + m_SymbolOffset + 8 * slot;
+    while (0 != Read(slot_data, 4) || 0 != Read(slot_data + 4, 4)) {
+      slot = (slot + step) & mask;
+      slot_data = data + m_SymbolOffset + 8 * slot;
+    }
+    Write(slot_data, pool, 4);
+    Write(slot_data + 4, vector_offsets[i], 4);
+    pool += name.size() + 1;
+  }
+
+  pOutput.release(region);
+}
+
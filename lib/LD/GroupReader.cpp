@@ -10,6 +10,7 @@
 #include <mcld/LD/ArchiveReader.h>
 #include <mcld/LD/DynObjReader.h>
 #include <mcld/LD/GroupReader.h>
+#include <mcld/LD/NamePool.h>
 #include <mcld/LD/ObjectReader.h>
 #include <mcld/LinkerConfig.h>
 #include <mcld/MC/Attribute.h>
@@ -36,11 +37,6 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
                             InputBuilder& pBuilder,
                             const LinkerConfig& pConfig)
 {
-  // record the number of total objects included in this sub-tree
-  size_t cur_obj_cnt = 0;
-  size_t last_obj_cnt = 0;
-  size_t non_ar_obj_cnt = 0;
-
   // record the archive files in this sub-tree
   typedef std::vector<ArchiveListEntry*> ArchiveListType;
   ArchiveListType ar_list;
@@ -59,13 +55,17 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
         (*input)->type() == Input::Object ||
         (*input)->type() == Input::DynObj  ||
         (*input)->type() == Input::Archive ||
-        (*input)->type() == Input::External) {
+        (*input)->type() == Input::External ||
+        (*input)->type() == Input::Bitcode) {
       ++input;
       continue;
     }
 
+    // only the reader of the type claimed by the probe checks the input
+    unsigned int type = LDReader::Sniff(**input);
+
     // is an archive
-    if (m_ArchiveReader.isMyFormat(**input)) {
+    if (Input::Archive == type && m_ArchiveReader.isMyFormat(**input)) {
       (*input)->setType(Input::Archive);
       // record the Archive used by each archive node
       Archive* ar = new Archive(**input, pBuilder);
@@ -73,25 +73,30 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
       ar_list.push_back(entry);
       // read archive
       m_ArchiveReader.readArchive(*ar);
-      cur_obj_cnt += ar->numOfObjectMember();
     }
     // is a relocatable object file
-    else if (m_ObjectReader.isMyFormat(**input)) {
+    else if (Input::Object == type && m_ObjectReader.isMyFormat(**input)) {
       (*input)->setType(Input::Object);
       m_ObjectReader.readHeader(**input);
       m_ObjectReader.readSections(**input);
+      m_Module.assignOrdinal(**input);
       m_ObjectReader.readSymbols(**input);
       m_Module.getObjectList().push_back(*input);
-      ++cur_obj_cnt;
-      ++non_ar_obj_cnt;
     }
     // is a shared object file
-    else if (m_DynObjReader.isMyFormat(**input)) {
+    else if (Input::DynObj == type && m_DynObjReader.isMyFormat(**input)) {
       (*input)->setType(Input::DynObj);
       m_DynObjReader.readHeader(**input);
+      m_Module.assignOrdinal(**input);
       m_DynObjReader.readSymbols(**input);
       m_Module.getLibraryList().push_back(*input);
     }
+    // is a bitcode file, compiled by the link time optimization
+    else if (Input::Bitcode == type) {
+      (*input)->setType(Input::Bitcode);
+      if (!pConfig.bitcode().isLTO())
+        error(diag::err_bitcode_input_without_lto) << (*input)->path();
+    }
     else {
       fatal(diag::err_unrecognized_input_file) << (*input)->path()
                                                << pConfig.targets().triple().str();
@@ -100,19 +105,24 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
   }
 
   // after read in all the archives, traverse the archive list in a loop until
-  // there is no unresolved symbols added
+  // there is no unresolved symbols added. An archive only looks up the
+  // undefined symbols added since its last visit, and the archives that have
+  // seen all of them are skipped.
+  const NamePool::UndefListType& undefs = m_Module.getNamePool().getUndefList();
   ArchiveListType::iterator it = ar_list.begin();
   ArchiveListType::iterator end = ar_list.end();
-  while (cur_obj_cnt != last_obj_cnt) {
-    last_obj_cnt = cur_obj_cnt;
-    cur_obj_cnt = non_ar_obj_cnt;
+  bool has_new_undefs = true;
+  while (has_new_undefs) {
+    has_new_undefs = false;
     for (it = ar_list.begin(); it != end; ++it) {
       Archive& ar = (*it)->archive;
       // if --whole-archive is given to this archive, no need to read it again
       if ( ar.getARFile().attribute()->isWholeArchive())
         continue;
+      if (ar.getUndefCursor() == undefs.size())
+        continue;
       m_ArchiveReader.readArchive(ar);
-      cur_obj_cnt += ar.numOfObjectMember();
+      has_new_undefs = true;
     }
   }
 
@@ -0,0 +1,116 @@
+//===- GroupSignatureSet.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/GroupSignatureSet.h>
+#include <mcld/ADT/StringHash.h>
+
+#include <cstring>
+
+using namespace mcld;
+
+namespace {
+
+/// the empty bucket
+const char* const g_Empty = NULL;
+
+/// helper_hash - the hash of pSignature
+uint32_t helper_hash(llvm::StringRef pSignature)
+{
+  static const StringHash<DJB> hasher = StringHash<DJB>();
+  return hasher(pSignature);
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// GroupSignatureSet
+//===----------------------------------------------------------------------===//
+GroupSignatureSet::GroupSignatureSet()
+  : m_NumOfEntries(0) {
+}
+
+void GroupSignatureSet::reserve(size_t pNum)
+{
+  // keep the load factor under 75%
+  size_t num_of_buckets = 16;
+  while (num_of_buckets * 3 < pNum * 4)
+    num_of_buckets <<= 1;
+  if (num_of_buckets > m_Buckets.size())
+    grow(num_of_buckets);
+}
+
+bool GroupSignatureSet::insert(llvm::StringRef pSignature)
+{
+  // a NULL data marks an empty bucket
+  if (g_Empty == pSignature.data())
+    pSignature = llvm::StringRef("", 0);
+
+  if ((m_NumOfEntries + 1) * 4 > m_Buckets.size() * 3)
+    reserve(m_NumOfEntries + 1);
+
+  uint32_t hash = helper_hash(pSignature);
+  size_t idx = lookup(pSignature, hash);
+  Bucket& bucket = m_Buckets[idx];
+  if (g_Empty != bucket.data)
+    return false;
+
+  bucket.data = pSignature.data();
+  bucket.size = pSignature.size();
+  bucket.hash = hash;
+  ++m_NumOfEntries;
+  return true;
+}
+
+bool GroupSignatureSet::count(llvm::StringRef pSignature) const
+{
+  if (m_Buckets.empty())
+    return false;
+  size_t idx = lookup(pSignature, helper_hash(pSignature));
+  return (g_Empty != m_Buckets[idx].data);
+}
+
+void GroupSignatureSet::clear()
+{
+  BucketList().swap(m_Buckets);
+  m_NumOfEntries = 0;
+}
+
+size_t GroupSignatureSet::lookup(llvm::StringRef pSignature,
+                                 uint32_t pHash) const
+{
+  size_t mask = m_Buckets.size() - 1;
+  size_t idx = pHash & mask;
+  while (true) {
+    const Bucket& bucket = m_Buckets[idx];
+    if (g_Empty == bucket.data)
+      return idx;
+    if (pHash == bucket.hash && pSignature.size() == bucket.size &&
+        0 == memcmp(pSignature.data(), bucket.data, bucket.size))
+      return idx;
+    idx = (idx + 1) & mask;
+  }
+}
+
+void GroupSignatureSet::grow(size_t pNumOfBuckets)
+{
+  Bucket empty = { g_Empty, 0, 0 };
+  BucketList buckets(pNumOfBuckets, empty);
+  buckets.swap(m_Buckets);
+
+  // re-insert the signatures by their hashes
+  size_t mask = m_Buckets.size() - 1;
+  BucketList::const_iterator it, end = buckets.end();
+  for (it = buckets.begin(); it != end; ++it) {
+    if (g_Empty == it->data)
+      continue;
+    size_t idx = it->hash & mask;
+    while (g_Empty != m_Buckets[idx].data)
+      idx = (idx + 1) & mask;
+    m_Buckets[idx] = *it;
+  }
+}
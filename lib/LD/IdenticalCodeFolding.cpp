@@ -0,0 +1,612 @@
+//===- IdenticalCodeFolding.cpp -------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/IdenticalCodeFolding.h>
+
+#include <mcld/GeneralOptions.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/NullFragment.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace mcld;
+
+static const size_t NoCandidate = static_cast<size_t>(-1);
+
+/// getTarget - the fragment and the offset the relocation refers to. Return
+/// NULL if the target symbol is not defined in a fragment.
+static const Fragment* getTarget(const Relocation& pReloc, uint64_t& pOffset)
+{
+  pOffset = 0;
+  const LDSymbol* symbol = pReloc.symInfo()->outSymbol();
+  if (NULL == symbol || !symbol->hasFragRef())
+    return NULL;
+  pOffset = symbol->fragRef()->offset();
+  return symbol->fragRef()->frag();
+}
+
+static bool CompareRelocOffset(const Relocation* pX, const Relocation* pY)
+{
+  return (pX->targetRef().offset() < pY->targetRef().offset());
+}
+
+/// SkipSourceName - skip the <source-name> of a mangled name at pPos, a
+/// length followed by that many characters.
+static bool SkipSourceName(llvm::StringRef pName, size_t& pPos)
+{
+  size_t start = pPos;
+  size_t length = 0;
+  while (pPos < pName.size() && isdigit(pName[pPos]))
+    length = length * 10 + (pName[pPos++] - '0');
+  if (start == pPos || 0 == length || pName.size() - pPos < length)
+    return false;
+  pPos += length;
+  return true;
+}
+
+/// SkipSubstitution - skip the S_, S<seq-id>_ or S<abbreviation> at pPos
+static bool SkipSubstitution(llvm::StringRef pName, size_t& pPos)
+{
+  ++pPos;
+  if (pPos < pName.size() && islower(pName[pPos])) {
+    ++pPos;
+    return true;
+  }
+  while (pPos < pName.size() && (isdigit(pName[pPos]) || isupper(pName[pPos])))
+    ++pPos;
+  if (pPos == pName.size() || '_' != pName[pPos])
+    return false;
+  ++pPos;
+  return true;
+}
+
+/// SkipTemplateArgs - skip the <template-args> I ... E at pPos. Return false
+/// on a construct it does not know, and the name is then taken as neither a
+/// constructor nor a destructor.
+static bool SkipTemplateArgs(llvm::StringRef pName, size_t& pPos)
+{
+  unsigned int depth = 0;
+  while (pPos < pName.size()) {
+    char c = pName[pPos];
+    if (isdigit(c)) {
+      if (!SkipSourceName(pName, pPos))
+        return false;
+      continue;
+    }
+
+    switch (c) {
+      case 'I': case 'N': case 'J': case 'X': case 'F':
+        // the template-args, nested-names, argument packs, expressions and
+        // function types end with E
+        ++depth;
+        ++pPos;
+        break;
+      case 'E':
+        ++pPos;
+        if (0 == --depth)
+          return true;
+        break;
+      case 'L': {
+        // an integer literal L <builtin-type> [n] <number> E
+        ++pPos;
+        if (pPos == pName.size() || !islower(pName[pPos]))
+          return false;
+        ++pPos;
+        if (pPos < pName.size() && 'n' == pName[pPos])
+          ++pPos;
+        while (pPos < pName.size() && isdigit(pName[pPos]))
+          ++pPos;
+        if (pPos == pName.size() || 'E' != pName[pPos])
+          return false;
+        ++pPos;
+        break;
+      }
+      case 'S': case 'T':
+        if (!SkipSubstitution(pName, pPos))
+          return false;
+        break;
+      case 'D':
+        // Dt and DT are decltypes ending with E, Dv is a vector type
+        if (pPos + 1 == pName.size() || 'v' == pName[pPos + 1])
+          return false;
+        if ('t' == pName[pPos + 1] || 'T' == pName[pPos + 1])
+          ++depth;
+        pPos += 2;
+        break;
+      case 'u':
+        ++pPos;
+        if (!SkipSourceName(pName, pPos))
+          return false;
+        break;
+      default:
+        // builtin types and qualifiers
+        ++pPos;
+        break;
+    }
+  }
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// IdenticalCodeFolding::Hasher
+//===----------------------------------------------------------------------===//
+struct IdenticalCodeFolding::Hasher
+{
+  const IdenticalCodeFolding* icf;
+  HashFunc func;
+  std::vector<uint64_t>* hashes;
+
+  void operator()(size_t pIdx) { (*hashes)[pIdx] = (icf->*func)(pIdx); }
+};
+
+namespace {
+
+/// ClassOrder - order the candidates by their classes and hashes. Ties are
+/// broken by the input order, so the result never depends on the threads.
+struct ClassOrder
+{
+  const std::vector<size_t>* classes;
+  const std::vector<uint64_t>* hashes;
+
+  bool operator()(size_t pX, size_t pY) const {
+    if ((*classes)[pX] != (*classes)[pY])
+      return ((*classes)[pX] < (*classes)[pY]);
+    if ((*hashes)[pX] != (*hashes)[pY])
+      return ((*hashes)[pX] < (*hashes)[pY]);
+    return (pX < pY);
+  }
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// IdenticalCodeFolding
+//===----------------------------------------------------------------------===//
+IdenticalCodeFolding::IdenticalCodeFolding(const LinkerConfig& pConfig,
+                                           Module& pModule)
+  : m_Config(pConfig), m_Module(pModule) {
+}
+
+IdenticalCodeFolding::~IdenticalCodeFolding()
+{
+}
+
+size_t IdenticalCodeFolding::foldIdenticalCode()
+{
+  // 1. find the candidates
+  findCandidates();
+  if (GeneralOptions::ICF_Safe == m_Config.options().getICFMode())
+    removeUnsafeCandidates();
+
+  size_t size = m_Candidates.size();
+  if (size < 2)
+    return 0;
+
+  // 2. group the candidates by the parts that do not change
+  m_Classes.assign(size, 0);
+  std::vector<uint64_t> hashes(size);
+  Hasher constant = { this, &IdenticalCodeFolding::hashConstant, &hashes };
+  parallel_for(m_Config.threads(), 0, size, constant, 64);
+  size_t num_of_classes = partition(hashes,
+                                    &IdenticalCodeFolding::equalsConstant);
+
+  // 3. split the groups by the groups of the referred candidates until the
+  // groups are stable.
+  while (num_of_classes < size) {
+    Hasher variable = { this, &IdenticalCodeFolding::hashVariable, &hashes };
+    parallel_for(m_Config.threads(), 0, size, variable, 64);
+    size_t refined = partition(hashes, &IdenticalCodeFolding::equalsVariable);
+    if (refined == num_of_classes)
+      break;
+    num_of_classes = refined;
+  }
+
+  // 4. fold every group into its first member
+  return fold();
+}
+
+void IdenticalCodeFolding::findCandidates()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    size_t first = m_Candidates.size();
+    std::map<const LDSection*, size_t> sect_index;
+
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (LDFileFormat::Regular != (*sect)->kind() ||
+          !llvm::StringRef((*sect)->name()).startswith(".text."))
+        continue;
+
+      uint32_t flag = (*sect)->flag();
+      if (0x0 == (flag & llvm::ELF::SHF_ALLOC) ||
+          0x0 == (flag & llvm::ELF::SHF_EXECINSTR) ||
+          0x0 != (flag & llvm::ELF::SHF_WRITE))
+        continue;
+
+      // input sections end with a NullFragment
+      if (!(*sect)->hasSectionData() || (*sect)->getSectionData()->empty())
+        continue;
+
+      SectionData* data = (*sect)->getSectionData();
+      Fragment& frag = data->front();
+      if (!llvm::isa<RegionFragment>(frag))
+        continue;
+
+      bool only_null = true;
+      SectionData::iterator it, itEnd = data->end();
+      for (it = ++data->begin(); it != itEnd && only_null; ++it)
+        only_null = llvm::isa<NullFragment>(*it);
+      if (!only_null)
+        continue;
+
+      FoldingCandidate candidate;
+      candidate.sect = *sect;
+      candidate.frag = llvm::cast<RegionFragment>(&frag);
+      sect_index[*sect] = m_Candidates.size();
+      m_CandidateIndex[&frag] = m_Candidates.size();
+      m_Candidates.push_back(candidate);
+    }
+
+    if (first == m_Candidates.size())
+      continue;
+
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      std::map<const LDSection*, size_t>::iterator entry =
+                                          sect_index.find((*rs)->getLink());
+      if (sect_index.end() == entry)
+        continue;
+
+      FoldingCandidate& candidate = m_Candidates[entry->second];
+      RelocData::const_iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc)
+        candidate.relocs.push_back(llvm::cast<Relocation>(reloc));
+    }
+
+    for (size_t i = first; i < m_Candidates.size(); ++i) {
+      std::stable_sort(m_Candidates[i].relocs.begin(),
+                       m_Candidates[i].relocs.end(),
+                       CompareRelocOffset);
+    }
+  }
+}
+
+void IdenticalCodeFolding::removeUnsafeCandidates()
+{
+  // A candidate is safe if all symbols defined in it are ctors or dtors.
+  std::vector<bool> has_ctor(m_Candidates.size(), false);
+  std::vector<bool> unsafe(m_Candidates.size(), false);
+
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sym_iterator sym, symEnd = (*obj)->context()->symTabEnd();
+    for (sym = (*obj)->context()->symTabBegin(); sym != symEnd; ++sym) {
+      if (NULL == *sym || !(*sym)->hasFragRef() ||
+          ResolveInfo::Section == (*sym)->type())
+        continue;
+
+      size_t idx = getCandidate((*sym)->fragRef()->frag());
+      if (NoCandidate == idx)
+        continue;
+
+      if (isCtorOrDtor((*sym)->name()))
+        has_ctor[idx] = true;
+      else
+        unsafe[idx] = true;
+    }
+  }
+
+  FoldingCandidates candidates;
+  m_CandidateIndex.clear();
+  for (size_t i = 0; i < m_Candidates.size(); ++i) {
+    if (!has_ctor[i] || unsafe[i])
+      continue;
+    m_CandidateIndex[m_Candidates[i].frag] = candidates.size();
+    candidates.push_back(m_Candidates[i]);
+  }
+  m_Candidates.swap(candidates);
+}
+
+bool IdenticalCodeFolding::isCtorOrDtor(llvm::StringRef pName)
+{
+  // A constructor or a destructor is a member, so its name is a nested-name
+  //   _Z N [<CV-qualifiers>] [<ref-qualifier>] <prefix> <ctor-dtor-name> E
+  // and its C1, C2, C3, D0, D1 or D2 directly follows the name of the class.
+  if (!pName.startswith("_ZN"))
+    return false;
+
+  size_t pos = 3;
+  while (pos < pName.size() &&
+         llvm::StringRef::npos != llvm::StringRef("rVKRO").find(pName[pos]))
+    ++pos;
+
+  bool after_class = false;
+  while (pos < pName.size()) {
+    char c = pName[pos];
+    if (isdigit(c)) {
+      if (!SkipSourceName(pName, pos))
+        return false;
+      after_class = true;
+    }
+    else if ('I' == c) {
+      // the template-args of a class template
+      if (!after_class || !SkipTemplateArgs(pName, pos))
+        return false;
+    }
+    else if ('S' == c) {
+      // St is the namespace std, the other substitutions may be classes
+      after_class = !pName.substr(pos).startswith("St");
+      if (!SkipSubstitution(pName, pos))
+        return false;
+    }
+    else if (after_class && pos + 2 < pName.size() && 'E' == pName[pos + 2]) {
+      char kind = pName[pos + 1];
+      return (('C' == c && '1' <= kind && kind <= '3') ||
+              ('D' == c && '0' <= kind && kind <= '2'));
+    }
+    else
+      return false;
+  }
+  return false;
+}
+
+size_t IdenticalCodeFolding::getCandidate(const Fragment* pFrag) const
+{
+  CandidateIndexMap::const_iterator entry = m_CandidateIndex.find(pFrag);
+  if (m_CandidateIndex.end() == entry)
+    return NoCandidate;
+  return entry->second;
+}
+
+uint64_t IdenticalCodeFolding::hashConstant(size_t pIdx) const
+{
+  const FoldingCandidate& candidate = m_Candidates[pIdx];
+  const MemoryRegion& region = candidate.frag->getRegion();
+
+  const uint8_t* start = region.start();
+  llvm::hash_code hash = llvm::hash_combine_range(start,
+                                                  start + region.size());
+  hash = llvm::hash_combine(hash,
+                            candidate.sect->flag(),
+                            candidate.sect->align(),
+                            candidate.relocs.size());
+
+  std::vector<const Relocation*>::const_iterator reloc,
+                                                 rEnd = candidate.relocs.end();
+  for (reloc = candidate.relocs.begin(); reloc != rEnd; ++reloc) {
+    hash = llvm::hash_combine(hash,
+                              (*reloc)->type(),
+                              (*reloc)->targetRef().offset(),
+                              (*reloc)->addend());
+
+    // the referred candidates are compared by their classes later
+    uint64_t offset = 0;
+    const Fragment* target = getTarget(**reloc, offset);
+    if (NULL == target)
+      hash = llvm::hash_combine(hash, (*reloc)->symInfo());
+    else if (NoCandidate == getCandidate(target))
+      hash = llvm::hash_combine(hash, target, offset);
+    else
+      hash = llvm::hash_combine(hash, offset);
+  }
+  return hash;
+}
+
+uint64_t IdenticalCodeFolding::hashVariable(size_t pIdx) const
+{
+  const FoldingCandidate& candidate = m_Candidates[pIdx];
+  llvm::hash_code hash = llvm::hash_combine(candidate.relocs.size());
+
+  std::vector<const Relocation*>::const_iterator reloc,
+                                                 rEnd = candidate.relocs.end();
+  for (reloc = candidate.relocs.begin(); reloc != rEnd; ++reloc) {
+    uint64_t offset = 0;
+    size_t target = getCandidate(getTarget(**reloc, offset));
+    if (NoCandidate != target)
+      hash = llvm::hash_combine(hash, m_Classes[target]);
+  }
+  return hash;
+}
+
+bool IdenticalCodeFolding::equalsConstant(size_t pA, size_t pB) const
+{
+  const FoldingCandidate& a = m_Candidates[pA];
+  const FoldingCandidate& b = m_Candidates[pB];
+
+  if (a.sect->flag() != b.sect->flag() || a.sect->align() != b.sect->align())
+    return false;
+
+  const MemoryRegion& region_a = a.frag->getRegion();
+  const MemoryRegion& region_b = b.frag->getRegion();
+  if (region_a.size() != region_b.size() ||
+      0 != memcmp(region_a.start(), region_b.start(), region_a.size()))
+    return false;
+
+  if (a.relocs.size() != b.relocs.size())
+    return false;
+
+  for (size_t i = 0; i < a.relocs.size(); ++i) {
+    const Relocation& x = *a.relocs[i];
+    const Relocation& y = *b.relocs[i];
+    if (x.type() != y.type() ||
+        x.targetRef().offset() != y.targetRef().offset() ||
+        x.addend() != y.addend())
+      return false;
+
+    uint64_t offset_x = 0, offset_y = 0;
+    const Fragment* target_x = getTarget(x, offset_x);
+    const Fragment* target_y = getTarget(y, offset_y);
+    if (offset_x != offset_y)
+      return false;
+
+    if (NULL == target_x || NULL == target_y) {
+      if (target_x != target_y || x.symInfo() != y.symInfo())
+        return false;
+      continue;
+    }
+
+    if (target_x == target_y)
+      continue;
+
+    // different targets can be identical only if both are candidates
+    if (NoCandidate == getCandidate(target_x) ||
+        NoCandidate == getCandidate(target_y))
+      return false;
+  }
+  return true;
+}
+
+bool IdenticalCodeFolding::equalsVariable(size_t pA, size_t pB) const
+{
+  const FoldingCandidate& a = m_Candidates[pA];
+  const FoldingCandidate& b = m_Candidates[pB];
+
+  // equalsConstant() has checked the number of relocations
+  for (size_t i = 0; i < a.relocs.size(); ++i) {
+    uint64_t offset = 0;
+    size_t target_x = getCandidate(getTarget(*a.relocs[i], offset));
+    size_t target_y = getCandidate(getTarget(*b.relocs[i], offset));
+    if (NoCandidate != target_x &&
+        m_Classes[target_x] != m_Classes[target_y])
+      return false;
+  }
+  return true;
+}
+
+size_t IdenticalCodeFolding::partition(const std::vector<uint64_t>& pHashes,
+                                       EqualsFunc pEquals)
+{
+  size_t size = m_Candidates.size();
+  std::vector<size_t> order(size);
+  for (size_t i = 0; i < size; ++i)
+    order[i] = i;
+
+  ClassOrder compare = { &m_Classes, &pHashes };
+  parallel_sort(m_Config.threads(), order.begin(), order.end(), compare);
+
+  // Candidates with the same class and hash are compared with the leaders
+  // of the new classes in the run. pEquals reads the current classes, so
+  // they are replaced only after all runs are split.
+  std::vector<size_t> classes(size);
+  std::vector<size_t> leaders;
+  size_t num_of_classes = 0;
+  size_t begin = 0;
+  while (begin < size) {
+    size_t end = begin + 1;
+    while (end < size &&
+           m_Classes[order[end]] == m_Classes[order[begin]] &&
+           pHashes[order[end]] == pHashes[order[begin]])
+      ++end;
+
+    leaders.clear();
+    for (size_t i = begin; i < end; ++i) {
+      size_t member = order[i];
+      size_t leader = 0;
+      while (leader < leaders.size() &&
+             !(this->*pEquals)(leaders[leader], member))
+        ++leader;
+
+      if (leaders.size() == leader) {
+        leaders.push_back(member);
+        classes[member] = num_of_classes++;
+      }
+      else
+        classes[member] = classes[leaders[leader]];
+    }
+    begin = end;
+  }
+
+  m_Classes.swap(classes);
+  return num_of_classes;
+}
+
+size_t IdenticalCodeFolding::fold()
+{
+  size_t size = m_Candidates.size();
+  std::vector<size_t> kept(size, NoCandidate);
+  std::map<const Fragment*, RegionFragment*> folded;
+  for (size_t i = 0; i < size; ++i) {
+    size_t& leader = kept[m_Classes[i]];
+    if (NoCandidate == leader) {
+      leader = i;
+      continue;
+    }
+    m_Candidates[i].sect->setKind(LDFileFormat::Ignore);
+    folded[m_Candidates[i].frag] = m_Candidates[leader].frag;
+  }
+
+  if (folded.empty())
+    return 0;
+
+  // Move the symbols of the folded sections to the kept ones. An input
+  // symbol and its output symbol share a FragmentRef, and so do the new ones.
+  std::map<const FragmentRef*, FragmentRef*> moved;
+  std::vector<LDSymbol*> symbols(m_Module.sym_begin(), m_Module.sym_end());
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    symbols.insert(symbols.end(),
+                   (*obj)->context()->symTabBegin(),
+                   (*obj)->context()->symTabEnd());
+  }
+
+  std::vector<LDSymbol*>::iterator sym, symEnd = symbols.end();
+  for (sym = symbols.begin(); sym != symEnd; ++sym) {
+    if (NULL == *sym || !(*sym)->hasFragRef())
+      continue;
+
+    const FragmentRef* ref = (*sym)->fragRef();
+    std::map<const FragmentRef*, FragmentRef*>::iterator entry =
+                                                           moved.find(ref);
+    if (moved.end() == entry) {
+      std::map<const Fragment*, RegionFragment*>::iterator target =
+                                                   folded.find(ref->frag());
+      if (folded.end() == target)
+        continue;
+      entry = moved.insert(std::make_pair(ref,
+                  FragmentRef::Create(*target->second, ref->offset()))).first;
+    }
+    (*sym)->setFragmentRef(entry->second);
+  }
+
+  // the relocations of the folded sections are neither scanned nor applied
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (NULL != (*rs)->getLink() &&
+          LDFileFormat::Ignore == (*rs)->getLink()->kind())
+        (*rs)->setKind(LDFileFormat::Ignore);
+    }
+  }
+  return folded.size();
+}
+
@@ -0,0 +1,688 @@
+//===- IncrementalLink.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/IncrementalLink.h>
+
+#include <mcld/Module.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/ADT/SizeTraits.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+using namespace mcld;
+
+namespace {
+
+const char StateMagic[8] = { 'M', 'C', 'L', 'D', 'I', 'N', 'C', '2' };
+
+/// ReadFile - read the whole file of pPath into pData
+bool ReadFile(const std::string& pPath, std::vector<uint8_t>& pData)
+{
+  FileHandle file;
+  if (!file.open(sys::fs::Path(pPath), FileHandle::ReadOnly))
+    return false;
+
+  pData.resize(file.size());
+  bool result = pData.empty() || file.read(&pData[0], 0, pData.size());
+  file.close();
+  return result;
+}
+
+/// HashFile - hash the whole file of pPath
+bool HashFile(const std::string& pPath, uint64_t& pSize, uint64_t& pHash)
+{
+  std::vector<uint8_t> data;
+  if (!ReadFile(pPath, data))
+    return false;
+  pSize = data.size();
+  pHash = digest::fast(data.empty() ? NULL : &data[0], data.size());
+  return true;
+}
+
+/// HashWord - mix pValue into pSeed
+uint64_t HashWord(uint64_t pSeed, uint64_t pValue)
+{
+  return digest::fast(reinterpret_cast<const uint8_t*>(&pValue),
+                      sizeof(pValue), pSeed);
+}
+
+/// RangeLess - order the ranges by their beginnings
+struct RangeLess
+{
+  bool operator()(const IncrementalLink::Range& pX,
+                  const IncrementalLink::Range& pY) const {
+    return pX.begin < pY.begin;
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// StateWriter and StateReader - the words of the state file are in little
+// endian, and a string is its size followed by its bytes.
+//===----------------------------------------------------------------------===//
+class StateWriter
+{
+public:
+  void word(uint64_t pValue) {
+    for (unsigned int i = 0; i < 8; ++i)
+      m_Data.push_back((pValue >> (i * 8)) & 0xff);
+  }
+
+  void string(const std::string& pValue) {
+    word(pValue.size());
+    m_Data.insert(m_Data.end(), pValue.begin(), pValue.end());
+  }
+
+  void bytes(const char* pData, size_t pSize) {
+    m_Data.insert(m_Data.end(), pData, pData + pSize);
+  }
+
+  const std::vector<uint8_t>& data() const { return m_Data; }
+
+private:
+  std::vector<uint8_t> m_Data;
+};
+
+class StateReader
+{
+public:
+  explicit StateReader(const std::vector<uint8_t>& pData)
+    : m_Data(pData), m_Pos(0), m_bGood(true) { }
+
+  uint64_t word() {
+    if (!m_bGood || m_Data.size() - m_Pos < 8) {
+      m_bGood = false;
+      return 0;
+    }
+    uint64_t value = 0;
+    for (unsigned int i = 0; i < 8; ++i)
+      value |= static_cast<uint64_t>(m_Data[m_Pos + i]) << (i * 8);
+    m_Pos += 8;
+    return value;
+  }
+
+  std::string string() {
+    uint64_t size = word();
+    if (!m_bGood || m_Data.size() - m_Pos < size) {
+      m_bGood = false;
+      return std::string();
+    }
+    std::string value(m_Data.begin() + m_Pos, m_Data.begin() + m_Pos + size);
+    m_Pos += size;
+    return value;
+  }
+
+  bool bytes(const char* pExpected, size_t pSize) {
+    if (!m_bGood || m_Data.size() - m_Pos < pSize ||
+        0 != memcmp(&m_Data[m_Pos], pExpected, pSize)) {
+      m_bGood = false;
+      return false;
+    }
+    m_Pos += pSize;
+    return true;
+  }
+
+  bool good() const { return m_bGood; }
+
+  bool atEnd() const { return m_Pos == m_Data.size(); }
+
+private:
+  const std::vector<uint8_t>& m_Data;
+  size_t m_Pos;
+  bool m_bGood;
+};
+
+//===----------------------------------------------------------------------===//
+// ScanObject
+//===----------------------------------------------------------------------===//
+template<size_t SIZE>
+bool ScanObject(const uint8_t* pData, size_t pSize,
+                IncrementalLink::Shape& pShape)
+{
+  typedef typename ELFSizeTraits<SIZE>::Ehdr ElfXX_Ehdr;
+  typedef typename ELFSizeTraits<SIZE>::Shdr ElfXX_Shdr;
+  typedef typename ELFSizeTraits<SIZE>::Rel  ElfXX_Rel;
+  typedef typename ELFSizeTraits<SIZE>::Rela ElfXX_Rela;
+
+  if (pSize < sizeof(ElfXX_Ehdr))
+    return false;
+
+  ElfXX_Ehdr ehdr;
+  memcpy(&ehdr, pData, sizeof(ehdr));
+  if (llvm::ELF::ET_REL != ehdr.e_type ||
+      sizeof(ElfXX_Shdr) != ehdr.e_shentsize ||
+      0 == ehdr.e_shoff || 0 == ehdr.e_shnum ||
+      ehdr.e_shoff > pSize ||
+      (pSize - ehdr.e_shoff) / sizeof(ElfXX_Shdr) < ehdr.e_shnum)
+    return false;
+
+  std::vector<ElfXX_Shdr> shdrs(ehdr.e_shnum);
+  memcpy(&shdrs[0], pData + ehdr.e_shoff, ehdr.e_shnum * sizeof(ElfXX_Shdr));
+
+  uint64_t digest = digest::fast(NULL, 0);
+  digest = HashWord(digest, ehdr.e_machine);
+  digest = HashWord(digest, ehdr.e_flags);
+  digest = HashWord(digest, ehdr.e_shnum);
+
+  pShape.sections.clear();
+  pShape.sections.resize(ehdr.e_shnum);
+  for (size_t i = 0; i < shdrs.size(); ++i) {
+    const ElfXX_Shdr& shdr = shdrs[i];
+    if (llvm::ELF::SHT_NOBITS != shdr.sh_type &&
+        (shdr.sh_offset > pSize || pSize - shdr.sh_offset < shdr.sh_size))
+      return false;
+
+    IncrementalLink::SectionShape& sect = pShape.sections[i];
+    sect.type = shdr.sh_type;
+    sect.flag = shdr.sh_flags;
+    sect.offset = shdr.sh_offset;
+    sect.size = shdr.sh_size;
+
+    // the offsets of the contents are not a part of the shape
+    digest = HashWord(digest, shdr.sh_name);
+    digest = HashWord(digest, shdr.sh_type);
+    digest = HashWord(digest, shdr.sh_flags);
+    digest = HashWord(digest, shdr.sh_size);
+    digest = HashWord(digest, shdr.sh_link);
+    digest = HashWord(digest, shdr.sh_info);
+    digest = HashWord(digest, shdr.sh_addralign);
+    digest = HashWord(digest, shdr.sh_entsize);
+  }
+
+  // collect the windows around the relocation places
+  for (size_t i = 0; i < shdrs.size(); ++i) {
+    const ElfXX_Shdr& shdr = shdrs[i];
+    size_t entsize = 0;
+    if (llvm::ELF::SHT_REL == shdr.sh_type)
+      entsize = sizeof(ElfXX_Rel);
+    else if (llvm::ELF::SHT_RELA == shdr.sh_type)
+      entsize = sizeof(ElfXX_Rela);
+    else
+      continue;
+
+    if (shdr.sh_info >= shdrs.size())
+      continue;
+    IncrementalLink::SectionShape& target = pShape.sections[shdr.sh_info];
+    if (llvm::ELF::SHT_NOBITS == target.type)
+      continue;
+
+    // r_offset is the first field of both Rel and Rela
+    size_t num = shdr.sh_size / entsize;
+    for (size_t j = 0; j < num; ++j) {
+      ElfXX_Rel rel;
+      memcpy(&rel, pData + shdr.sh_offset + j * entsize, sizeof(rel));
+      uint64_t offset = rel.r_offset;
+      IncrementalLink::Range window;
+      window.begin = (offset > IncrementalLink::WindowBefore) ?
+                     offset - IncrementalLink::WindowBefore : 0;
+      window.end = std::min<uint64_t>(target.size,
+                                      offset + IncrementalLink::WindowAfter);
+      if (window.begin < window.end)
+        target.windows.push_back(window);
+    }
+  }
+
+  // merge the windows, and digest the bytes in them
+  for (size_t i = 0; i < pShape.sections.size(); ++i) {
+    IncrementalLink::RangeList& windows = pShape.sections[i].windows;
+    if (windows.empty())
+      continue;
+    std::sort(windows.begin(), windows.end(), RangeLess());
+    size_t last = 0;
+    for (size_t j = 1; j < windows.size(); ++j) {
+      if (windows[j].begin <= windows[last].end)
+        windows[last].end = std::max(windows[last].end, windows[j].end);
+      else
+        windows[++last] = windows[j];
+    }
+    windows.resize(last + 1);
+
+    const uint8_t* contents = pData + pShape.sections[i].offset;
+    for (size_t j = 0; j < windows.size(); ++j) {
+      digest = HashWord(digest, windows[j].begin);
+      digest = digest::fast(contents + windows[j].begin,
+                            windows[j].end - windows[j].begin, digest);
+    }
+  }
+
+  pShape.digest = digest;
+  return true;
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// IncrementalLink::FileHasher
+//===----------------------------------------------------------------------===//
+struct IncrementalLink::FileHasher
+{
+  const FileList* files;
+  ImageList* images;
+  bool scanAll;
+
+  void operator()(size_t pIdx) {
+    const FileRecord& file = (*files)[pIdx];
+    FileImage& image = (*images)[pIdx];
+    std::vector<uint8_t> data;
+    image.exists = ReadFile(file.path, data);
+    image.scanned = false;
+    if (!image.exists)
+      return;
+
+    const uint8_t* start = data.empty() ? NULL : &data[0];
+    image.hash = digest::fast(start, data.size());
+
+    bool changed = (image.hash != file.hash);
+    if (!file.isObject || (!scanAll && !changed))
+      return;
+
+    image.scanned = Scan(start, data.size(), image.shape);
+    if (!image.scanned)
+      return;
+
+    image.sectionHashes.resize(image.shape.sections.size());
+    for (size_t i = 0; i < image.shape.sections.size(); ++i) {
+      const SectionShape& sect = image.shape.sections[i];
+      if (llvm::ELF::SHT_NOBITS == sect.type)
+        image.sectionHashes[i] = digest::fast(NULL, 0);
+      else
+        image.sectionHashes[i] = digest::fast(start + sect.offset, sect.size);
+    }
+
+    if (!scanAll)
+      image.contents.swap(data);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// IncrementalLink
+//===----------------------------------------------------------------------===//
+IncrementalLink::IncrementalLink(const LinkerConfig& pConfig,
+                                 const std::string& pOutput,
+                                 uint64_t pKey)
+  : m_Config(pConfig), m_Output(pOutput), m_StateFile(pOutput + ".inc"),
+    m_Key(pKey), m_OutputSize(0), m_OutputHash(0) {
+  // the files named by the options are a part of the command line
+  uint64_t size = 0, hash = 0;
+  if (m_Config.options().hasSymbolOrderingFile() &&
+      HashFile(m_Config.options().symbolOrderingFile(), size, hash))
+    m_Key = HashWord(m_Key, hash);
+  if (!m_Config.options().callGraphProfileFile().empty() &&
+      HashFile(m_Config.options().callGraphProfileFile(), size, hash))
+    m_Key = HashWord(m_Key, hash);
+  if (m_Config.options().hasDynamicList() &&
+      HashFile(m_Config.options().dynamicList(), size, hash))
+    m_Key = HashWord(m_Key, hash);
+  if (m_Config.options().hasVersionScript() &&
+      HashFile(m_Config.options().versionScript(), size, hash))
+    m_Key = HashWord(m_Key, hash);
+}
+
+IncrementalLink::~IncrementalLink()
+{
+}
+
+bool IncrementalLink::Scan(const uint8_t* pData, size_t pSize, Shape& pShape)
+{
+  if (pSize < llvm::ELF::EI_NIDENT ||
+      0 != memcmp(llvm::ELF::ElfMagic, pData, 4))
+    return false;
+
+  // the objects are read in the host byte order
+  unsigned char data = llvm::sys::isLittleEndianHost() ?
+                       llvm::ELF::ELFDATA2LSB : llvm::ELF::ELFDATA2MSB;
+  if (data != pData[llvm::ELF::EI_DATA])
+    return false;
+
+  switch (pData[llvm::ELF::EI_CLASS]) {
+    case llvm::ELF::ELFCLASS32:
+      return ScanObject<32>(pData, pSize, pShape);
+    case llvm::ELF::ELFCLASS64:
+      return ScanObject<64>(pData, pSize, pShape);
+    default:
+      return false;
+  }
+}
+
+bool IncrementalLink::update()
+{
+  if (!load() || !checkOutput())
+    return false;
+
+  ImageList images;
+  hashFiles(false, images);
+
+  // collect the sections to patch, or give up
+  typedef std::pair<size_t, size_t> Patch;
+  std::vector<Patch> patches;
+  bool changed = false;
+  for (size_t i = 0; i < m_Files.size(); ++i) {
+    const FileRecord& file = m_Files[i];
+    const FileImage& image = images[i];
+    if (!image.exists)
+      return false;
+    if (image.hash == file.hash)
+      continue;
+    changed = true;
+
+    if (!file.isObject || !image.scanned ||
+        image.shape.digest != file.shape ||
+        image.shape.sections.size() != file.sections.size())
+      return false;
+
+    for (size_t j = 0; j < file.sections.size(); ++j) {
+      if (image.sectionHashes[j] == file.sections[j].hash)
+        continue;
+      switch (file.sections[j].kind) {
+        case Discarded:
+          break;
+        case Verbatim:
+          patches.push_back(std::make_pair(i, j));
+          break;
+        default:
+          return false;
+      }
+    }
+  }
+
+  if (!changed)
+    return true;
+
+  // a patched output would keep the build ID hashed from the old contents
+  GeneralOptions::BuildID build_id = m_Config.options().getBuildID();
+  if (!patches.empty() &&
+      (GeneralOptions::BuildID_Fast == build_id ||
+       GeneralOptions::BuildID_MD5 == build_id ||
+       GeneralOptions::BuildID_SHA1 == build_id))
+    return false;
+
+  // write the new contents between the windows
+  if (!patches.empty()) {
+    FileHandle output;
+    if (!output.open(sys::fs::Path(m_Output), FileHandle::ReadWrite))
+      return false;
+
+    for (size_t i = 0; i < patches.size(); ++i) {
+      const FileImage& image = images[patches[i].first];
+      const SectionShape& sect = image.shape.sections[patches[i].second];
+      uint64_t out_offset =
+        m_Files[patches[i].first].sections[patches[i].second].outOffset;
+      const uint8_t* contents = &image.contents[0] + sect.offset;
+
+      uint64_t begin = 0;
+      for (size_t j = 0; j <= sect.windows.size(); ++j) {
+        uint64_t end = (j < sect.windows.size()) ? sect.windows[j].begin
+                                                 : sect.size;
+        if (begin < end &&
+            !output.write(contents + begin, out_offset + begin, end - begin)) {
+          output.close();
+          return false;
+        }
+        if (j < sect.windows.size())
+          begin = sect.windows[j].end;
+      }
+    }
+    output.close();
+  }
+
+  // the output is up to date, record the new contents
+  for (size_t i = 0; i < m_Files.size(); ++i) {
+    if (images[i].hash == m_Files[i].hash)
+      continue;
+    m_Files[i].hash = images[i].hash;
+    for (size_t j = 0; j < m_Files[i].sections.size(); ++j)
+      m_Files[i].sections[j].hash = images[i].sectionHashes[j];
+  }
+
+  if (!patches.empty() && !recordOutput())
+    return false;
+
+  if (!save())
+    warning(diag::warn_cannot_write_incremental_state) << m_StateFile;
+  return true;
+}
+
+bool IncrementalLink::record(Module& pModule)
+{
+  // the files of the input tree. The members of an archive are recorded by
+  // the archive.
+  m_Files.clear();
+  std::vector<Input*> inputs;
+  std::set<std::string> paths;
+  InputTree::dfs_iterator input, inEnd = pModule.getInputTree().dfs_end();
+  for (input = pModule.getInputTree().dfs_begin(); input != inEnd; ++input) {
+    if ((*input)->path().empty() || 0 != (*input)->fileOffset())
+      continue;
+    if (!paths.insert((*input)->path().native()).second)
+      continue;
+
+    FileRecord file;
+    file.path = (*input)->path().native();
+    file.hash = 0;
+    file.isObject = (Input::Object == (*input)->type() &&
+                     (*input)->hasContext() && (*input)->hasMemArea());
+    file.shape = 0;
+    m_Files.push_back(file);
+    inputs.push_back(*input);
+  }
+
+  ImageList images;
+  hashFiles(true, images);
+
+  // the region fragments of the output, to find the places of the sections
+  FragmentMap fragments;
+  Module::iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    if (!(*sect)->hasSectionData())
+      continue;
+    SectionData::iterator frag, fragEnd = (*sect)->getSectionData()->end();
+    for (frag = (*sect)->getSectionData()->begin(); frag != fragEnd; ++frag) {
+      if (Fragment::Region != frag->getKind())
+        continue;
+      const RegionFragment& region = llvm::cast<RegionFragment>(*frag);
+      fragments[region.getRegion().start()] = &region;
+    }
+  }
+
+  for (size_t i = 0; i < m_Files.size(); ++i) {
+    if (!images[i].exists) {
+      warning(diag::warn_cannot_write_incremental_state) << m_StateFile;
+      return false;
+    }
+    m_Files[i].hash = images[i].hash;
+    if (!m_Files[i].isObject)
+      continue;
+    if (!images[i].scanned) {
+      m_Files[i].isObject = false;
+      continue;
+    }
+    recordObject(*inputs[i], images[i], fragments, m_Files[i]);
+  }
+
+  if (!recordOutput() || !save()) {
+    warning(diag::warn_cannot_write_incremental_state) << m_StateFile;
+    return false;
+  }
+  return true;
+}
+
+void IncrementalLink::recordObject(Input& pInput, const FileImage& pImage,
+                                   const FragmentMap& pFragments,
+                                   FileRecord& pFile) const
+{
+  // the folded sections are not discarded but merged with the others of the
+  // same contents
+  bool icf = (GeneralOptions::ICF_None != m_Config.options().getICFMode());
+
+  pFile.shape = pImage.shape.digest;
+  pFile.sections.resize(pImage.shape.sections.size());
+  for (size_t i = 0; i < pImage.shape.sections.size(); ++i) {
+    const SectionShape& shape = pImage.shape.sections[i];
+    SectionRecord& record = pFile.sections[i];
+    record.kind = Fixed;
+    record.hash = pImage.sectionHashes[i];
+    record.outOffset = 0;
+
+    if (i >= pInput.context()->numOfSections())
+      continue;
+    LDSection* sect = pInput.context()->getSection(i);
+    if (NULL == sect || sect->offset() != shape.offset ||
+        sect->size() != shape.size)
+      continue;
+
+    if (LDFileFormat::Ignore == sect->kind()) {
+      if (!icf)
+        record.kind = Discarded;
+      continue;
+    }
+
+    // only the contents copied verbatim into the output can be patched
+    if ((LDFileFormat::Regular != sect->kind() &&
+         LDFileFormat::Debug != sect->kind() &&
+         LDFileFormat::Note != sect->kind()) ||
+        (llvm::ELF::SHT_PROGBITS != shape.type &&
+         llvm::ELF::SHT_NOTE != shape.type) ||
+        0 != (shape.flag & llvm::ELF::SHF_MERGE) ||
+        (icf && 0 != (shape.flag & llvm::ELF::SHF_EXECINSTR)) ||
+        0 == shape.size)
+      continue;
+
+    MemoryRegion* region =
+      pInput.memArea()->request(pInput.fileOffset() + shape.offset,
+                                shape.size);
+    if (NULL == region)
+      continue;
+    FragmentMap::const_iterator frag = pFragments.find(region->start());
+    pInput.memArea()->release(region);
+    if (pFragments.end() == frag || frag->second->size() != shape.size)
+      continue;
+
+    const LDSection& output = frag->second->getParent()->getSection();
+    if (LDFileFormat::Ignore == output.kind() || output.isCompressed() ||
+        llvm::ELF::SHT_NOBITS == output.type())
+      continue;
+
+    record.kind = Verbatim;
+    record.outOffset = output.offset() + frag->second->getOffset();
+  }
+}
+
+void IncrementalLink::hashFiles(bool pScanAll, ImageList& pImages) const
+{
+  pImages.clear();
+  pImages.resize(m_Files.size());
+
+  FileHasher hasher;
+  hasher.files = &m_Files;
+  hasher.images = &pImages;
+  hasher.scanAll = pScanAll;
+  parallel_for(m_Config.threads(), 0, m_Files.size(), hasher);
+}
+
+bool IncrementalLink::checkOutput() const
+{
+  uint64_t size = 0, hash = 0;
+  if (!HashFile(m_Output, size, hash))
+    return false;
+  return (size == m_OutputSize && hash == m_OutputHash);
+}
+
+bool IncrementalLink::recordOutput()
+{
+  return HashFile(m_Output, m_OutputSize, m_OutputHash);
+}
+
+bool IncrementalLink::load()
+{
+  std::vector<uint8_t> data;
+  if (!ReadFile(m_StateFile, data))
+    return false;
+
+  StateReader reader(data);
+  if (!reader.bytes(StateMagic, sizeof(StateMagic)) || m_Key != reader.word())
+    return false;
+
+  m_OutputSize = reader.word();
+  m_OutputHash = reader.word();
+
+  m_Files.clear();
+  uint64_t num_files = reader.word();
+  for (uint64_t i = 0; reader.good() && i < num_files; ++i) {
+    FileRecord file;
+    file.path = reader.string();
+    file.hash = reader.word();
+    file.isObject = (0 != reader.word());
+    file.shape = reader.word();
+    uint64_t num_sections = reader.word();
+    for (uint64_t j = 0; reader.good() && j < num_sections; ++j) {
+      SectionRecord sect;
+      sect.kind = reader.word();
+      sect.hash = reader.word();
+      sect.outOffset = reader.word();
+      file.sections.push_back(sect);
+    }
+    m_Files.push_back(file);
+  }
+  return (reader.good() && reader.atEnd());
+}
+
+bool IncrementalLink::save() const
+{
+  StateWriter writer;
+  writer.bytes(StateMagic, sizeof(StateMagic));
+  writer.word(m_Key);
+  writer.word(m_OutputSize);
+  writer.word(m_OutputHash);
+  writer.word(m_Files.size());
+  FileList::const_iterator file, fEnd = m_Files.end();
+  for (file = m_Files.begin(); file != fEnd; ++file) {
+    writer.string(file->path);
+    writer.word(file->hash);
+    writer.word(file->isObject ? 1 : 0);
+    writer.word(file->shape);
+    writer.word(file->sections.size());
+    std::vector<SectionRecord>::const_iterator sect,
+                                               sEnd = file->sections.end();
+    for (sect = file->sections.begin(); sect != sEnd; ++sect) {
+      writer.word(sect->kind);
+      writer.word(sect->hash);
+      writer.word(sect->outOffset);
+    }
+  }
+
+  FileHandle state;
+  FileHandle::Permission perm = 0644;
+  if (!state.open(sys::fs::Path(m_StateFile),
+                  FileHandle::WriteOnly | FileHandle::Create |
+                  FileHandle::Truncate,
+                  perm))
+    return false;
+
+  const std::vector<uint8_t>& data = writer.data();
+  bool result = state.write(&data[0], 0, data.size());
+  state.close();
+  return result;
+}
+
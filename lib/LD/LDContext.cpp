@@ -21,6 +21,7 @@ LDContext& LDContext::appendSection(LDSection& pSection)
   if (LDFileFormat::Relocation == pSection.kind())
     m_RelocSections.push_back(&pSection);
   pSection.setIndex(m_SectionTable.size());
+  m_SectionIndex.insert(std::make_pair(pSection.name(), m_SectionTable.size()));
   m_SectionTable.push_back(&pSection);
   return *this;
 }
@@ -41,30 +42,34 @@ const LDSection* LDContext::getSection(unsigned int pIdx) const
 
 LDSection* LDContext::getSection(const std::string& pName)
 {
-  sect_iterator sect_iter, sect_end = sectEnd();
-  for (sect_iter = sectBegin(); sect_iter != sect_end; ++sect_iter) {
-    if(NULL != *sect_iter && (*sect_iter)->name() == pName)
-      return *sect_iter;
-  }
-  return NULL;
+  llvm::StringMap<size_t>::const_iterator entry = m_SectionIndex.find(pName);
+  if (m_SectionIndex.end() == entry)
+    return NULL;
+  return m_SectionTable[entry->getValue()];
 }
 
 const LDSection* LDContext::getSection(const std::string& pName) const
 {
-  const_sect_iterator sect_iter, sect_end = sectEnd();
-  for (sect_iter = sectBegin(); sect_iter != sect_end; ++sect_iter) {
-    if(NULL != *sect_iter && (*sect_iter)->name() == pName)
-      return *sect_iter;
-  }
-  return NULL;
+  llvm::StringMap<size_t>::const_iterator entry = m_SectionIndex.find(pName);
+  if (m_SectionIndex.end() == entry)
+    return NULL;
+  return m_SectionTable[entry->getValue()];
 }
 
 size_t LDContext::getSectionIdx(const std::string& pName) const
 {
+  llvm::StringMap<size_t>::const_iterator entry = m_SectionIndex.find(pName);
+  if (m_SectionIndex.end() == entry)
+    return 0;
+  if (0 != entry->getValue())
+    return entry->getValue();
+
+  // the null section shares its name with the sections after it
+  const SectionAtom* atom = SectionAtom::Find(pName);
   size_t result = 1;
   size_t size = m_SectionTable.size();
   for (; result != size; ++result)
-    if (m_SectionTable[result]->name() == pName)
+    if (&m_SectionTable[result]->atom() == atom)
       return result;
   return 0;
 }
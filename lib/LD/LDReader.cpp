@@ -7,8 +7,74 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/LDReader.h>
+#include <mcld/MC/MCLDInput.h>
+
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
 
 using namespace mcld;
 
-//==========================
+namespace {
+
+/// MagicEntry - an input whose probe begins with magic is of type, or of the
+/// type given by the ELF header if type is Unknown
+struct MagicEntry
+{
+  const char* magic;
+  size_t size;
+  unsigned int type;
+};
+
+const MagicEntry g_Magics[] = {
+  { "\x7f" "ELF",   4, Input::Unknown },
+  { "!<arch>\n",    8, Input::Archive },
+  { "!<thin>\n",    8, Input::Archive },
+  { "BC\xc0\xde",    4, Input::Bitcode },
+  { "\xde\xc0\x17\x0b", 4, Input::Bitcode }  // the bitcode wrapper
+};
+
+/// helper_elf_type - the input type of the ELF header pHeader
+unsigned int helper_elf_type(const uint8_t* pHeader, size_t pSize)
+{
+  // e_type follows e_ident in both ELF32 and ELF64
+  if (pSize < llvm::ELF::EI_NIDENT + 2)
+    return Input::Unknown;
+
+  uint16_t type = 0;
+  if (llvm::ELF::ELFDATA2LSB == pHeader[llvm::ELF::EI_DATA])
+    type = pHeader[16] | (pHeader[17] << 8);
+  else if (llvm::ELF::ELFDATA2MSB == pHeader[llvm::ELF::EI_DATA])
+    type = (pHeader[16] << 8) | pHeader[17];
+
+  switch (type) {
+    case llvm::ELF::ET_REL:
+      return Input::Object;
+    case llvm::ELF::ET_DYN:
+      return Input::DynObj;
+    default:
+      return Input::Unknown;
+  }
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
 // LDReader
+//===----------------------------------------------------------------------===//
+unsigned int LDReader::Sniff(Input& pInput)
+{
+  const uint8_t* probe = pInput.probe();
+  size_t size = pInput.probeSize();
+
+  size_t num = sizeof(g_Magics) / sizeof(g_Magics[0]);
+  for (size_t i = 0; i < num; ++i) {
+    if (size < g_Magics[i].size ||
+        0 != memcmp(probe, g_Magics[i].magic, g_Magics[i].size))
+      continue;
+    if (Input::Unknown == g_Magics[i].type)
+      return helper_elf_type(probe, size);
+    return g_Magics[i].type;
+  }
+  return Input::Unknown;
+}
@@ -22,7 +22,7 @@ static llvm::ManagedStatic<SectionFactory> g_SectFactory;
 // LDSection
 //===----------------------------------------------------------------------===//
 LDSection::LDSection()
-  : m_Name(),
+  : m_pAtom(&SectionAtom::Get(SectionAtom::Null)),
     m_Kind(LDFileFormat::Ignore),
     m_Type(0x0),
     m_Flag(0x0),
@@ -30,9 +30,11 @@ LDSection::LDSection()
     m_Offset(~uint64_t(0)),
     m_Addr(0x0),
     m_Align(0),
+    m_EntSize(0),
     m_Info(0),
     m_pLink(NULL),
-    m_Index(0) {
+    m_Index(0),
+    m_Order(NoOrder) {
   m_Data.sect_data = NULL;
 }
 
@@ -42,7 +44,7 @@ LDSection::LDSection(const std::string& pName,
                      uint32_t pFlag,
                      uint64_t pSize,
                      uint64_t pAddr)
-  : m_Name(pName),
+  : m_pAtom(&SectionAtom::Intern(pName)),
     m_Kind(pKind),
     m_Type(pType),
     m_Flag(pFlag),
@@ -50,9 +52,11 @@ LDSection::LDSection(const std::string& pName,
     m_Offset(~uint64_t(0)),
     m_Addr(pAddr),
     m_Align(0),
+    m_EntSize(0),
     m_Info(0),
     m_pLink(NULL),
-    m_Index(0) {
+    m_Index(0),
+    m_Order(NoOrder) {
   m_Data.sect_data = NULL;
 }
 
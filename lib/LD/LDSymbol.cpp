@@ -22,30 +22,28 @@ using namespace mcld;
 typedef GCFactory<LDSymbol, MCLD_SYMBOLS_PER_INPUT> LDSymbolFactory;
 
 static llvm::ManagedStatic<LDSymbol> g_NullSymbol;
-static llvm::ManagedStatic<NullFragment> g_NullSymbolFragment;
+// not a ManagedStatic, since a Fragment created by new lives in the arena of
+// Fragments, which is released at the end of every link.
+static NullFragment g_NullSymbolFragment;
 static llvm::ManagedStatic<LDSymbolFactory> g_LDSymbolFactory;
 
 //===----------------------------------------------------------------------===//
 // LDSymbol
 //===----------------------------------------------------------------------===//
 LDSymbol::LDSymbol()
-  : m_pResolveInfo(NULL), m_pFragRef(NULL), m_Value(0) {
-}
-
-LDSymbol::~LDSymbol()
-{
+  : m_pResolveInfo(NULL), m_Value(0) {
 }
 
 LDSymbol::LDSymbol(const LDSymbol& pCopy)
   : m_pResolveInfo(pCopy.m_pResolveInfo),
-    m_pFragRef(pCopy.m_pFragRef),
+    m_FragRef(pCopy.m_FragRef),
     m_Value(pCopy.m_Value) {
 }
 
 LDSymbol& LDSymbol::operator=(const LDSymbol& pCopy)
 {
   m_pResolveInfo = pCopy.m_pResolveInfo;
-  m_pFragRef = pCopy.m_pFragRef;
+  m_FragRef.assign(pCopy.m_FragRef);
   m_Value = pCopy.m_Value;
   return (*this);
 }
@@ -75,15 +73,18 @@ LDSymbol* LDSymbol::Null()
   // lazy initialization
   if (NULL == g_NullSymbol->resolveInfo()) {
     g_NullSymbol->setResolveInfo(*ResolveInfo::Null());
-    g_NullSymbol->setFragmentRef(FragmentRef::Create(*g_NullSymbolFragment, 0));
+    g_NullSymbol->m_FragRef.assign(g_NullSymbolFragment, 0);
     ResolveInfo::Null()->setSymPtr(&*g_NullSymbol);
   }
   return &*g_NullSymbol;
 }
 
-void LDSymbol::setFragmentRef(FragmentRef* pFragmentRef)
+void LDSymbol::setFragmentRef(const FragmentRef* pFragmentRef)
 {
-  m_pFragRef = pFragmentRef;
+  if (NULL == pFragmentRef)
+    m_FragRef.reset();
+  else
+    m_FragRef.assign(*pFragmentRef);
 }
 
 void LDSymbol::setResolveInfo(const ResolveInfo& pInfo)
@@ -96,8 +97,3 @@ bool LDSymbol::isNull() const
   return (this == Null());
 }
 
-bool LDSymbol::hasFragRef() const
-{
-  return !m_pFragRef->isNull();
-}
-
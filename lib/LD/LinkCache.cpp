@@ -0,0 +1,404 @@
+//===- LinkCache.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/LinkCache.h>
+
+#include <mcld/Module.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/SystemUtils.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <set>
+
+using namespace mcld;
+
+namespace {
+
+const char StampMagic[] = "MCLDSTP2";
+
+/// the size of the chunks to copy the output into the cache
+const size_t CopyChunkSize = 1 << 20;
+
+/// HashWord - mix pValue into pSeed
+uint64_t HashWord(uint64_t pSeed, uint64_t pValue)
+{
+  return digest::fast(reinterpret_cast<const uint8_t*>(&pValue),
+                      sizeof(pValue), pSeed);
+}
+
+/// HashString - mix pValue and its terminator into pSeed
+uint64_t HashString(uint64_t pSeed, const std::string& pValue)
+{
+  return digest::fast(reinterpret_cast<const uint8_t*>(pValue.c_str()),
+                      pValue.size() + 1, pSeed);
+}
+
+/// OpenTemporary - open a temporary file of this process beside pPath
+bool OpenTemporary(const sys::fs::Path& pPath,
+                   sys::fs::Path& pTmpPath,
+                   FileHandle& pFile)
+{
+  std::string tmp_name;
+  llvm::raw_string_ostream os(tmp_name);
+  os << pPath.native() << '.' << sys::getpid() << ".tmp";
+  os.flush();
+  pTmpPath.assign(tmp_name);
+
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  return pFile.open(pTmpPath, mode, perm);
+}
+
+/// Publish - close the temporary file and rename it to pPath if it is
+/// written, or remove it otherwise.
+bool Publish(FileHandle& pFile,
+             const sys::fs::Path& pTmpPath,
+             const sys::fs::Path& pPath,
+             bool pWritten)
+{
+  bool result = pFile.close() && pWritten;
+  if (result)
+    result = (0 == sys::fs::detail::rename(pTmpPath, pPath));
+  if (!result)
+    sys::fs::detail::unlink(pTmpPath);
+  return result;
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LinkCache::InputHasher
+//===----------------------------------------------------------------------===//
+struct LinkCache::InputHasher
+{
+  InputList* inputs;
+  uint64_t now;
+
+  void operator()(size_t pIdx) {
+    InputFile& input = (*inputs)[pIdx];
+    if (input.stamped)
+      return;
+
+    input.hashed = false;
+    FileHandle file;
+    if (!file.open(sys::fs::Path(input.path), FileHandle::ReadOnly))
+      return;
+
+    std::vector<uint8_t> data(file.size());
+    if (data.empty() || file.read(&data[0], 0, data.size())) {
+      input.stamp.size = data.size();
+      input.stamp.hashTime = now;
+      input.stamp.hash = digest::fast(data.empty() ? NULL : &data[0],
+                                      data.size());
+      input.hashed = true;
+    }
+    file.close();
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// LinkCache
+//===----------------------------------------------------------------------===//
+LinkCache::LinkCache(const LinkerConfig& pConfig, const sys::fs::Path& pDir)
+  : m_Config(pConfig), m_Dir(pDir), m_Key(0), m_bKeyed(false),
+    m_pCachedFile(NULL) {
+}
+
+LinkCache::~LinkCache()
+{
+  if (NULL != m_pCachedFile) {
+    m_pCachedFile->close();
+    delete m_pCachedFile;
+  }
+}
+
+bool LinkCache::lookup(const Module& pModule)
+{
+  m_bKeyed = false;
+  loadStamps();
+
+  // the files of the input tree, in the order of the tree, and the files
+  // named by the options
+  InputList inputs;
+  std::set<std::string> paths;
+  InputTree::const_dfs_iterator input, inEnd = pModule.getInputTree().dfs_end();
+  for (input = pModule.getInputTree().dfs_begin(); input != inEnd; ++input) {
+    if ((*input)->path().empty() || 0 != (*input)->fileOffset())
+      continue;
+    if (!paths.insert((*input)->path().native()).second)
+      continue;
+    InputFile file;
+    file.path = (*input)->path().native();
+    inputs.push_back(file);
+  }
+
+  if (m_Config.options().hasSymbolOrderingFile()) {
+    InputFile file;
+    file.path = m_Config.options().symbolOrderingFile();
+    inputs.push_back(file);
+  }
+  if (m_Config.options().hasCallGraphProfileFile()) {
+    InputFile file;
+    file.path = m_Config.options().callGraphProfileFile();
+    inputs.push_back(file);
+  }
+  if (m_Config.options().hasDynamicList()) {
+    InputFile file;
+    file.path = m_Config.options().dynamicList();
+    inputs.push_back(file);
+  }
+  if (m_Config.options().hasVersionScript()) {
+    InputFile file;
+    file.path = m_Config.options().versionScript();
+    inputs.push_back(file);
+  }
+
+  // only the files whose stamps are changed are read
+  bool changed = false;
+  InputList::iterator file, fEnd = inputs.end();
+  for (file = inputs.begin(); file != fEnd; ++file) {
+    sys::fs::FileID id;
+    sys::fs::detail::file_id(sys::fs::Path(file->path), id);
+    if (!id.isValid())
+      return false;
+
+    FileHandle handle;
+    if (!handle.open(sys::fs::Path(file->path), FileHandle::ReadOnly))
+      return false;
+    file->stamp.size = handle.size();
+    handle.close();
+
+    file->stamp.device = id.device();
+    file->stamp.inode = id.inode();
+    file->stamp.modTime = id.modTime();
+    file->hashed = true;
+
+    StampMap::const_iterator stamp = m_Stamps.find(file->path);
+    file->stamped = (m_Stamps.end() != stamp &&
+                     stamp->second.device == file->stamp.device &&
+                     stamp->second.inode == file->stamp.inode &&
+                     stamp->second.size == file->stamp.size &&
+                     stamp->second.modTime == file->stamp.modTime);
+    if (file->stamped) {
+      file->stamp.hashTime = stamp->second.hashTime;
+      file->stamp.hash = stamp->second.hash;
+    }
+    else
+      changed = true;
+  }
+
+  if (changed)
+    hashInputs(inputs);
+
+  uint64_t key = digest::fast(reinterpret_cast<const uint8_t*>(StampMagic),
+                              sizeof(StampMagic));
+  key = HashWord(key, m_Config.options().commandLineKey());
+  key = HashString(key, m_Config.targets().triple().str());
+  key = HashWord(key, m_Config.codeGenType());
+  for (file = inputs.begin(); file != fEnd; ++file) {
+    if (!file->hashed)
+      return false;
+    key = HashString(key, file->path);
+    key = HashWord(key, file->stamp.hash);
+    if (!file->stamped)
+      m_Stamps[file->path] = file->stamp;
+  }
+  m_Key = key;
+  m_bKeyed = true;
+
+  if (changed && !saveStamps())
+    debug(diag::debug_cannot_write_link_cache) << m_Dir;
+
+  // keep the cached output opened, so it is still there for restore() even
+  // if another link replaces it.
+  FileHandle* cached = new FileHandle();
+  if (!cached->open(getCachePath(), FileHandle::ReadOnly) ||
+      0 == cached->size()) {
+    delete cached;
+    return false;
+  }
+  m_pCachedFile = cached;
+  return true;
+}
+
+bool LinkCache::restore(MemoryArea& pOutput) const
+{
+  if (NULL == m_pCachedFile)
+    return false;
+
+  size_t size = m_pCachedFile->size();
+  MemoryRegion* region = pOutput.request(0, size);
+  if (NULL == region)
+    return false;
+  bool result = m_pCachedFile->read(region->start(), 0, size);
+  pOutput.release(region);
+  return result;
+}
+
+bool LinkCache::store(MemoryArea& pOutput) const
+{
+  if (!m_bKeyed || NULL != m_pCachedFile || !pOutput.hasHandler())
+    return false;
+
+  // write back the output before reading it
+  pOutput.clear();
+  FileHandle& output = *pOutput.handler();
+  if (!output.isReadable() || 0 == output.size())
+    return false;
+
+  sys::fs::Path tmp_path;
+  FileHandle tmp;
+  if (!OpenTemporary(getCachePath(), tmp_path, tmp)) {
+    debug(diag::debug_cannot_write_link_cache) << getCachePath();
+    return false;
+  }
+
+  std::vector<uint8_t> chunk(std::min(CopyChunkSize, output.size()));
+  bool written = true;
+  for (size_t offset = 0; written && offset < output.size();
+       offset += chunk.size()) {
+    size_t length = std::min(chunk.size(), output.size() - offset);
+    written = output.read(&chunk[0], offset, length) &&
+              tmp.write(&chunk[0], offset, length);
+  }
+
+  if (!Publish(tmp, tmp_path, getCachePath(), written)) {
+    debug(diag::debug_cannot_write_link_cache) << getCachePath();
+    return false;
+  }
+  return true;
+}
+
+sys::fs::Path LinkCache::getCachePath() const
+{
+  std::string name;
+  llvm::raw_string_ostream os(name);
+  os.write_hex(m_Key);
+  os << ".out";
+  os.flush();
+
+  sys::fs::Path result(m_Dir);
+  result.append(name);
+  return result;
+}
+
+void LinkCache::hashInputs(InputList& pInputs) const
+{
+  InputHasher hasher;
+  hasher.inputs = &pInputs;
+  hasher.now = std::time(NULL);
+  parallel_for(m_Config.threads(), 0, pInputs.size(), hasher);
+}
+
+void LinkCache::ParseStamps(const std::string& pText, StampMap& pStamps)
+{
+  pStamps.clear();
+  size_t magic = sizeof(StampMagic) - 1;
+  if (0 != pText.compare(0, magic, StampMagic) ||
+      pText.size() <= magic || '\n' != pText[magic])
+    return;
+
+  // a line is the six fields of a stamp in hex followed by the path
+  size_t pos = magic + 1;
+  while (pos < pText.size()) {
+    size_t eol = pText.find('\n', pos);
+    if (std::string::npos == eol)
+      return;
+    std::string line(pText, pos, eol - pos);
+    pos = eol + 1;
+
+    const char* cur = line.c_str();
+    uint64_t field[6];
+    bool good = true;
+    for (unsigned int i = 0; good && i < 6; ++i) {
+      char* end = NULL;
+      field[i] = strtoull(cur, &end, 16);
+      good = (end != cur && ' ' == *end);
+      cur = end + 1;
+    }
+    if (!good || '\0' == *cur)
+      continue;
+
+    Stamp stamp;
+    stamp.device = field[0];
+    stamp.inode = field[1];
+    stamp.size = field[2];
+    stamp.modTime = field[3];
+    stamp.hashTime = field[4];
+    stamp.hash = field[5];
+
+    // a file modified in the second of its hashing may be changed after
+    if (stamp.modTime >= stamp.hashTime)
+      continue;
+    pStamps[std::string(cur)] = stamp;
+  }
+}
+
+void LinkCache::PrintStamps(const StampMap& pStamps, std::string& pText)
+{
+  pText.clear();
+  llvm::raw_string_ostream os(pText);
+  os << StampMagic << '\n';
+  StampMap::const_iterator stamp, sEnd = pStamps.end();
+  for (stamp = pStamps.begin(); stamp != sEnd; ++stamp) {
+    if (std::string::npos != stamp->first.find('\n'))
+      continue;
+    os.write_hex(stamp->second.device) << ' ';
+    os.write_hex(stamp->second.inode) << ' ';
+    os.write_hex(stamp->second.size) << ' ';
+    os.write_hex(stamp->second.modTime) << ' ';
+    os.write_hex(stamp->second.hashTime) << ' ';
+    os.write_hex(stamp->second.hash) << ' ';
+    os << stamp->first << '\n';
+  }
+  os.flush();
+}
+
+void LinkCache::loadStamps()
+{
+  m_Stamps.clear();
+  sys::fs::Path path(m_Dir);
+  path.append("inputs.stamps");
+
+  FileHandle file;
+  if (!file.open(path, FileHandle::ReadOnly))
+    return;
+
+  std::string text(file.size(), '\0');
+  if (!text.empty() && file.read(&text[0], 0, text.size()))
+    ParseStamps(text, m_Stamps);
+  file.close();
+}
+
+bool LinkCache::saveStamps() const
+{
+  std::string text;
+  PrintStamps(m_Stamps, text);
+
+  sys::fs::Path path(m_Dir);
+  path.append("inputs.stamps");
+  sys::fs::Path tmp_path;
+  FileHandle tmp;
+  if (!OpenTemporary(path, tmp_path, tmp))
+    return false;
+  return Publish(tmp, tmp_path, path, tmp.write(text.data(), 0, text.size()));
+}
+
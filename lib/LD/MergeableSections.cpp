@@ -0,0 +1,743 @@
+//===- MergeableSections.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/MergeableSections.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/AlignFragment.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/NullFragment.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/PackedRelocData.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/Relocator.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Object/SectionMap.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/Target/TargetLDBackend.h>
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/MathExtras.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace mcld;
+
+static const size_t NoCandidate = static_cast<size_t>(-1);
+static const size_t NoPiece = static_cast<size_t>(-1);
+
+/// IsZero - are the pSize bytes at pData all zeros?
+static bool IsZero(const uint8_t* pData, uint64_t pSize)
+{
+  for (uint64_t i = 0; i < pSize; ++i) {
+    if (0x0 != pData[i])
+      return false;
+  }
+  return true;
+}
+
+/// GetAlignment - the alignment a piece at pOffset of a section aligned to
+/// pAlign keeps
+static uint64_t GetAlignment(uint64_t pAlign, uint64_t pOffset)
+{
+  if (0x0 == pAlign)
+    return 1;
+  return llvm::MinAlign(pAlign, pOffset);
+}
+
+/// IsCandidate - a SHF_MERGE section held in one RegionFragment
+static bool IsCandidate(const LDSection& pSection)
+{
+  switch (pSection.kind()) {
+    case LDFileFormat::Regular:
+    case LDFileFormat::Debug:
+    case LDFileFormat::MetaData:
+      break;
+    default:
+      return false;
+  }
+
+  if (0x0 == (pSection.flag() & llvm::ELF::SHF_MERGE) ||
+      0x0 == pSection.entSize() || 0x0 == pSection.size() ||
+      0x0 != (pSection.size() % pSection.entSize()))
+    return false;
+
+  // input sections end with a NullFragment
+  if (!pSection.hasSectionData() || pSection.getSectionData()->empty())
+    return false;
+
+  const SectionData& data = *pSection.getSectionData();
+  if (!llvm::isa<RegionFragment>(data.front()))
+    return false;
+
+  SectionData::const_iterator frag, fragEnd = data.end();
+  for (frag = ++data.begin(); frag != fragEnd; ++frag) {
+    if (!llvm::isa<NullFragment>(*frag))
+      return false;
+  }
+  return (pSection.size() ==
+          llvm::cast<RegionFragment>(data.front()).getRegion().size());
+}
+
+namespace {
+
+/// GroupKey - the candidates of the same key share their pieces
+struct GroupKey
+{
+  std::string output;
+  uint32_t flag;
+  uint64_t entsize;
+  uint32_t align;
+
+  bool operator<(const GroupKey& pOther) const
+  {
+    if (flag != pOther.flag)
+      return flag < pOther.flag;
+    if (entsize != pOther.entsize)
+      return entsize < pOther.entsize;
+    if (align != pOther.align)
+      return align < pOther.align;
+    return output < pOther.output;
+  }
+};
+
+/// PieceOffsetLess - find the piece holding an offset
+struct PieceOffsetLess
+{
+  bool operator()(uint64_t pOffset,
+                  const MergeableSections::Piece& pPiece) const
+  { return pOffset < pPiece.offset; }
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// MergeableSections::Splitter
+//===----------------------------------------------------------------------===//
+struct MergeableSections::Splitter
+{
+  const CandidateList* candidates;
+  std::vector<PieceList>* pieces;
+  std::vector<char>* valid;
+
+  void operator()(size_t pIdx) {
+    const Candidate& candidate = (*candidates)[pIdx];
+    const LDSection& sect = *candidate.sect;
+    const MemoryRegion& region = candidate.frag->getRegion();
+    PieceList& list = (*pieces)[pIdx];
+
+    bool is_string = (0x0 != (sect.flag() & llvm::ELF::SHF_STRINGS));
+    (*valid)[pIdx] = Split(region.start(), region.size(), sect.entSize(),
+                           is_string, list);
+
+    // identical bytes in different groups or of different alignments are
+    // different pieces
+    PieceList::iterator piece, pEnd = list.end();
+    for (piece = list.begin(); piece != pEnd; ++piece) {
+      piece->hash = llvm::hash_combine(piece->hash,
+                                       candidate.group,
+                                       GetAlignment(sect.align(),
+                                                    piece->offset));
+    }
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// MergeableSections::Deduplicator
+//===----------------------------------------------------------------------===//
+struct MergeableSections::Deduplicator
+{
+  MergeableSections* merger;
+
+  void operator()(size_t pShard) { merger->deduplicate(pShard); }
+};
+
+//===----------------------------------------------------------------------===//
+// MergeableSections
+//===----------------------------------------------------------------------===//
+MergeableSections::MergeableSections(const LinkerConfig& pConfig,
+                                     TargetLDBackend& pBackend,
+                                     Module& pModule)
+  : m_Config(pConfig), m_Backend(pBackend), m_Module(pModule) {
+}
+
+MergeableSections::~MergeableSections()
+{
+  std::vector<RegionFragment*>::iterator frag, fEnd = m_Removed.end();
+  for (frag = m_Removed.begin(); frag != fEnd; ++frag)
+    delete *frag;
+}
+
+bool MergeableSections::Split(const uint8_t* pData,
+                              uint64_t pSize,
+                              uint64_t pEntSize,
+                              bool pIsString,
+                              PieceList& pPieces)
+{
+  pPieces.clear();
+  if (0x0 == pEntSize || 0x0 != (pSize % pEntSize))
+    return false;
+
+  uint64_t offset = 0;
+  while (offset < pSize) {
+    uint64_t end = offset + pEntSize;
+    if (pIsString) {
+      // a string ends with a character of zeros
+      end = offset;
+      while (end < pSize && !IsZero(pData + end, pEntSize))
+        end += pEntSize;
+      if (end == pSize)
+        return false;
+      end += pEntSize;
+    }
+
+    Piece piece;
+    piece.offset = offset;
+    piece.size = end - offset;
+    piece.hash = llvm::hash_combine_range(pData + offset, pData + end);
+    piece.leader = NoPiece;
+    piece.frag = NULL;
+    piece.fragOffset = offset;
+    pPieces.push_back(piece);
+    offset = end;
+  }
+  return true;
+}
+
+uint64_t MergeableSections::merge()
+{
+  // 1. split the candidates into pieces
+  findCandidates();
+  if (m_Pieces.empty())
+    return 0;
+
+  // 2. the sections referred by unknown addends keep all pieces
+  pinCandidates();
+
+  // 3. find the first piece of the identical ones
+  Deduplicator dedup = { this };
+  parallel_for(m_Config.threads(), 0, NumOfShards, dedup, 1);
+
+  // 4. rebuild the candidates from their kept pieces
+  uint64_t removed = 0;
+  for (size_t i = 0; i < m_Candidates.size(); ++i)
+    removed += rewrite(i);
+
+  if (m_Removed.empty())
+    return 0;
+
+  // 5. move the references. The relocations read the offsets of the
+  // section symbols, so they are moved first.
+  redirectRelocations();
+  redirectSymbols();
+  return removed;
+}
+
+void MergeableSections::findCandidates()
+{
+  CandidateList candidates;
+  std::map<GroupKey, size_t> groups;
+
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    size_t first = candidates.size();
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (!IsCandidate(**sect))
+        continue;
+
+      const SectionMap::NamePair& pair =
+                        m_Config.scripts().sectionMap().find((*sect)->name());
+      GroupKey key;
+      key.output = (pair.isNull())? (*sect)->name() : pair.to;
+      key.flag = (*sect)->flag();
+      key.entsize = (*sect)->entSize();
+      key.align = (*sect)->align();
+      std::map<GroupKey, size_t>::iterator group =
+                  groups.insert(std::make_pair(key, groups.size())).first;
+
+      Candidate candidate;
+      candidate.sect = *sect;
+      candidate.frag = llvm::cast<RegionFragment>(
+                                         &(*sect)->getSectionData()->front());
+      candidate.group = group->second;
+      candidate.first = 0;
+      candidate.last = 0;
+      candidate.pinned = false;
+      candidate.rewritten = false;
+      candidate.sectSymbol = NULL;
+      candidates.push_back(candidate);
+    }
+
+    if (first == candidates.size())
+      continue;
+
+    // the places in a section with relocations can not be moved
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData() ||
+          (*rs)->getRelocData()->empty())
+        continue;
+      for (size_t i = first; i < candidates.size(); ++i) {
+        if ((*rs)->getLink() == candidates[i].sect)
+          candidates[i].sect = NULL;
+      }
+    }
+
+    size_t kept = first;
+    for (size_t i = first; i < candidates.size(); ++i) {
+      if (NULL != candidates[i].sect)
+        candidates[kept++] = candidates[i];
+    }
+    candidates.resize(kept);
+  }
+
+  if (candidates.empty())
+    return;
+
+  std::vector<PieceList> pieces(candidates.size());
+  std::vector<char> valid(candidates.size(), 0);
+  Splitter splitter = { &candidates, &pieces, &valid };
+  parallel_for(m_Config.threads(), 0, candidates.size(), splitter, 16);
+
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (!valid[i])
+      continue;
+
+    Candidate& candidate = candidates[i];
+    size_t idx = m_Candidates.size();
+    candidate.first = m_Pieces.size();
+    PieceList::iterator piece, pEnd = pieces[i].end();
+    for (piece = pieces[i].begin(); piece != pEnd; ++piece) {
+      piece->leader = m_Pieces.size();
+      piece->frag = candidate.frag;
+      m_Pieces.push_back(*piece);
+      m_Owners.push_back(idx);
+    }
+    candidate.last = m_Pieces.size();
+    m_CandidateIndex[candidate.frag] = idx;
+    m_Candidates.push_back(candidate);
+  }
+}
+
+void MergeableSections::pinCandidates()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      bool is_rel = (llvm::ELF::SHT_REL == (*rs)->type());
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation& relocation = llvm::cast<Relocation>(*reloc);
+        const ResolveInfo* info = relocation.symInfo();
+        if (NULL == info || ResolveInfo::Section != info->type() ||
+            NULL == info->outSymbol() || !info->outSymbol()->hasFragRef())
+          continue;
+
+        size_t idx = getCandidate(info->outSymbol()->fragRef()->frag());
+        if (NoCandidate == idx || m_Candidates[idx].pinned)
+          continue;
+
+        int64_t target = 0;
+        if (!getRelocTarget(relocation, is_rel, target) || target < 0 ||
+            static_cast<uint64_t>(target) > m_Candidates[idx].sect->size())
+          m_Candidates[idx].pinned = true;
+      }
+
+      if ((*rs)->getRelocData()->hasPacked())
+        pinPackedRelocations(*(*rs)->getRelocData()->getPacked());
+    }
+  }
+}
+
+void MergeableSections::pinPackedRelocations(const PackedRelocData& pRelocs)
+{
+  PackedRelocData::EntryList entries;
+  for (size_t b = 0; b < pRelocs.numOfBlocks(); ++b) {
+    pRelocs.decode(b, entries);
+    PackedRelocData::EntryList::const_iterator entry, eEnd = entries.end();
+    for (entry = entries.begin(); entry != eEnd; ++entry) {
+      const ResolveInfo* info = entry->symbol->resolveInfo();
+      if (NULL == info || ResolveInfo::Section != info->type() ||
+          NULL == info->outSymbol() || !info->outSymbol()->hasFragRef())
+        continue;
+
+      size_t idx = getCandidate(info->outSymbol()->fragRef()->frag());
+      if (NoCandidate == idx || m_Candidates[idx].pinned)
+        continue;
+
+      // the packed relocations are RELA
+      int64_t target = info->outSymbol()->fragRef()->offset() +
+                       static_cast<int64_t>(entry->addend);
+      if (target < 0 ||
+          static_cast<uint64_t>(target) > m_Candidates[idx].sect->size())
+        m_Candidates[idx].pinned = true;
+    }
+  }
+}
+
+void MergeableSections::deduplicate(size_t pShard)
+{
+  // the leaders of a hash are chained from the latest one
+  struct Link
+  {
+    size_t piece;
+    size_t next;
+  };
+
+  llvm::DenseMap<uint64_t, size_t> heads;
+  std::vector<Link> links;
+  for (size_t i = 0; i < m_Pieces.size(); ++i) {
+    uint64_t key = m_Pieces[i].hash;
+    if (pShard != (key % NumOfShards))
+      continue;
+
+    // keep away from the empty and tombstone keys of DenseMap
+    if (llvm::DenseMapInfo<uint64_t>::getEmptyKey() == key ||
+        llvm::DenseMapInfo<uint64_t>::getTombstoneKey() == key)
+      key = 0x0;
+
+    llvm::DenseMap<uint64_t, size_t>::iterator entry = heads.find(key);
+    size_t head = (heads.end() == entry)? NoPiece : entry->second;
+    size_t leader = NoPiece;
+    for (size_t l = head; NoPiece != l; l = links[l].next) {
+      if (equals(links[l].piece, i)) {
+        leader = links[l].piece;
+        break;
+      }
+    }
+
+    if (NoPiece != leader) {
+      if (!m_Candidates[m_Owners[i]].pinned)
+        m_Pieces[i].leader = leader;
+      continue;
+    }
+
+    Link link = { i, head };
+    links.push_back(link);
+    heads[key] = links.size() - 1;
+  }
+}
+
+bool MergeableSections::equals(size_t pA, size_t pB) const
+{
+  const Piece& a = m_Pieces[pA];
+  const Piece& b = m_Pieces[pB];
+  const Candidate& owner_a = m_Candidates[m_Owners[pA]];
+  const Candidate& owner_b = m_Candidates[m_Owners[pB]];
+  if (a.size != b.size || owner_a.group != owner_b.group)
+    return false;
+
+  uint32_t align = owner_a.sect->align();
+  if (GetAlignment(align, a.offset) != GetAlignment(align, b.offset))
+    return false;
+  return (getBytes(pA) == getBytes(pB));
+}
+
+uint64_t MergeableSections::rewrite(size_t pIdx)
+{
+  Candidate& candidate = m_Candidates[pIdx];
+  bool dropped = false;
+  for (size_t i = candidate.first; i < candidate.last && !dropped; ++i)
+    dropped = (i != m_Pieces[i].leader);
+  if (!dropped)
+    return 0;
+
+  SectionData& data = *candidate.sect->getSectionData();
+  SectionData::FragmentListType& list = data.getFragmentList();
+  MemoryRegion& region = candidate.frag->getRegion();
+  list.remove(candidate.frag);
+  m_Removed.push_back(candidate.frag);
+  candidate.rewritten = true;
+
+  // the new fragments are inserted before the NullFragments
+  SectionData::iterator pos = data.begin();
+  uint64_t offset = 0;
+  size_t i = candidate.first;
+  while (i < candidate.last) {
+    if (i != m_Pieces[i].leader) {
+      ++i;
+      continue;
+    }
+
+    size_t run = i;
+    while (i < candidate.last && i == m_Pieces[i].leader)
+      ++i;
+    uint64_t start = m_Pieces[run].offset;
+    uint64_t size = m_Pieces[i - 1].offset + m_Pieces[i - 1].size - start;
+
+    // the first run is aligned by the section
+    uint64_t align = GetAlignment(candidate.sect->align(), start);
+    if (0x0 != offset && align > 1) {
+      AlignFragment* align_frag = new AlignFragment(align, // alignment
+                                                    0x0, // the filled value
+                                                    1u,  // the size of value
+                                                    align - 1 // max bytes
+                                                    );
+      align_frag->setParent(&data);
+      align_frag->setOffset(offset);
+      list.insert(pos, align_frag);
+      offset += align_frag->size();
+    }
+
+    MemoryRegion* sub = MemoryRegion::Create(region.getBuffer(start), size);
+    RegionFragment* frag = new RegionFragment(*sub);
+    frag->setParent(&data);
+    frag->setOffset(offset);
+    list.insert(pos, frag);
+    for (size_t k = run; k < i; ++k) {
+      m_Pieces[k].frag = frag;
+      m_Pieces[k].fragOffset = m_Pieces[k].offset - start;
+    }
+    offset += size;
+  }
+
+  for (; pos != data.end(); ++pos)
+    pos->setOffset(offset);
+
+  uint64_t removed = candidate.sect->size() - offset;
+  candidate.sect->setSize(offset);
+  return removed;
+}
+
+void MergeableSections::redirectRelocations()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      bool is_rel = (llvm::ELF::SHT_REL == (*rs)->type());
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation& relocation = llvm::cast<Relocation>(*reloc);
+        const ResolveInfo* info = relocation.symInfo();
+        if (NULL == info || ResolveInfo::Section != info->type() ||
+            NULL == info->outSymbol() || !info->outSymbol()->hasFragRef())
+          continue;
+
+        size_t idx = getCandidate(info->outSymbol()->fragRef()->frag());
+        if (NoCandidate == idx || !m_Candidates[idx].rewritten)
+          continue;
+
+        // pinCandidates() has checked the target
+        int64_t target = 0;
+        getRelocTarget(relocation, is_rel, target);
+
+        uint64_t offset = 0;
+        LDSymbol* symbol = getRedirection(idx, target, offset);
+        relocation.setSymInfo(symbol->resolveInfo());
+        if (is_rel) {
+          relocation.target() = offset;
+          relocation.setAddend(0x0);
+        }
+        else
+          relocation.setAddend(offset);
+      }
+
+      if ((*rs)->getRelocData()->hasPacked())
+        redirectPackedRelocations(*(*rs)->getRelocData()->getPacked());
+    }
+  }
+}
+
+void MergeableSections::redirectPackedRelocations(PackedRelocData& pRelocs)
+{
+  // the entries are decoded, redirected and packed again
+  PackedRelocData::EntryList entries, block;
+  for (size_t b = 0; b < pRelocs.numOfBlocks(); ++b) {
+    pRelocs.decode(b, block);
+    entries.insert(entries.end(), block.begin(), block.end());
+  }
+
+  bool redirected = false;
+  PackedRelocData::EntryList::iterator entry, eEnd = entries.end();
+  for (entry = entries.begin(); entry != eEnd; ++entry) {
+    const ResolveInfo* info = entry->symbol->resolveInfo();
+    if (NULL == info || ResolveInfo::Section != info->type() ||
+        NULL == info->outSymbol() || !info->outSymbol()->hasFragRef())
+      continue;
+
+    size_t idx = getCandidate(info->outSymbol()->fragRef()->frag());
+    if (NoCandidate == idx || !m_Candidates[idx].rewritten)
+      continue;
+
+    // pinPackedRelocations() has checked the target
+    int64_t target = info->outSymbol()->fragRef()->offset() +
+                     static_cast<int64_t>(entry->addend);
+    uint64_t offset = 0;
+    entry->symbol = getRedirection(idx, target, offset);
+    entry->addend = offset;
+    redirected = true;
+  }
+
+  if (redirected)
+    pRelocs.pack(entries);
+}
+
+void MergeableSections::redirectSymbols()
+{
+  // An input symbol and its output symbol share a FragmentRef, and so do
+  // the new ones.
+  std::map<const FragmentRef*, FragmentRef*> moved;
+  std::vector<LDSymbol*> symbols(m_Module.sym_begin(), m_Module.sym_end());
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    symbols.insert(symbols.end(),
+                   (*obj)->context()->symTabBegin(),
+                   (*obj)->context()->symTabEnd());
+  }
+
+  std::vector<LDSymbol*>::iterator sym, symEnd = symbols.end();
+  for (sym = symbols.begin(); sym != symEnd; ++sym) {
+    if (NULL == *sym || !(*sym)->hasFragRef())
+      continue;
+
+    const FragmentRef* ref = (*sym)->fragRef();
+    std::map<const FragmentRef*, FragmentRef*>::iterator entry =
+                                                           moved.find(ref);
+    if (moved.end() == entry) {
+      size_t idx = getCandidate(ref->frag());
+      if (NoCandidate == idx || !m_Candidates[idx].rewritten)
+        continue;
+
+      FragmentRef* result = NULL;
+      size_t piece = getPiece(idx, ref->offset());
+      if (NoPiece == piece) {
+        // the end of the section
+        SectionData& data = *m_Candidates[idx].sect->getSectionData();
+        result = FragmentRef::Create(data.back(), 0x0);
+      }
+      else {
+        const Piece& leader = m_Pieces[m_Pieces[piece].leader];
+        result = FragmentRef::Create(*leader.frag, leader.fragOffset +
+                                     ref->offset() - m_Pieces[piece].offset);
+      }
+      entry = moved.insert(std::make_pair(ref, result)).first;
+    }
+    (*sym)->setFragmentRef(entry->second);
+  }
+}
+
+size_t MergeableSections::getCandidate(const Fragment* pFrag) const
+{
+  CandidateIndexMap::const_iterator entry = m_CandidateIndex.find(pFrag);
+  if (m_CandidateIndex.end() == entry)
+    return NoCandidate;
+  return entry->second;
+}
+
+size_t MergeableSections::getPiece(size_t pIdx, uint64_t pOffset) const
+{
+  const Candidate& candidate = m_Candidates[pIdx];
+  const Piece& last = m_Pieces[candidate.last - 1];
+  if (pOffset >= last.offset + last.size)
+    return NoPiece;
+
+  PieceList::const_iterator piece =
+      std::upper_bound(m_Pieces.begin() + candidate.first,
+                       m_Pieces.begin() + candidate.last,
+                       pOffset,
+                       PieceOffsetLess());
+  return (piece - m_Pieces.begin()) - 1;
+}
+
+uint64_t MergeableSections::getSectionOffset(size_t pPiece,
+                                             uint64_t pOffset) const
+{
+  const Piece& piece = m_Pieces[pPiece];
+  return piece.frag->getOffset() + piece.fragOffset + pOffset;
+}
+
+LDSymbol* MergeableSections::getSectionSymbol(size_t pIdx)
+{
+  Candidate& candidate = m_Candidates[pIdx];
+  if (NULL != candidate.sectSymbol)
+    return candidate.sectSymbol;
+
+  ResolveInfo* info =
+    m_Module.getNamePool().createSymbol(candidate.sect->name(),
+                                        false,
+                                        ResolveInfo::Section,
+                                        ResolveInfo::Define,
+                                        ResolveInfo::Local,
+                                        0x0,
+                                        ResolveInfo::Default);
+  LDSymbol* symbol = LDSymbol::Create(*info);
+  info->setSymPtr(symbol);
+  symbol->setFragmentRef(
+        FragmentRef::Create(candidate.sect->getSectionData()->front(), 0x0));
+  symbol->setValue(0x0);
+  candidate.sectSymbol = symbol;
+  return symbol;
+}
+
+LDSymbol* MergeableSections::getRedirection(size_t pIdx,
+                                            int64_t pTarget,
+                                            uint64_t& pOffset)
+{
+  size_t owner = pIdx;
+  pOffset = m_Candidates[pIdx].sect->size();
+  size_t piece = getPiece(pIdx, pTarget);
+  if (NoPiece != piece) {
+    size_t leader = m_Pieces[piece].leader;
+    owner = m_Owners[leader];
+    pOffset = getSectionOffset(leader, pTarget - m_Pieces[piece].offset);
+  }
+  return getSectionSymbol(owner);
+}
+
+bool MergeableSections::getRelocTarget(const Relocation& pReloc,
+                                       bool pIsRel,
+                                       int64_t& pOffset) const
+{
+  int64_t offset = pReloc.symInfo()->outSymbol()->fragRef()->offset();
+  int64_t addend = static_cast<int64_t>(pReloc.addend());
+  if (pIsRel) {
+    // the addend is in the place
+    const Relocator* relocator = m_Backend.getRelocator();
+    if (NULL == relocator || !relocator->isDataAddend(pReloc.type()))
+      return false;
+    if (32 == m_Config.targets().bitclass())
+      addend += static_cast<int32_t>(pReloc.target());
+    else
+      addend += static_cast<int64_t>(pReloc.target());
+  }
+  pOffset = offset + addend;
+  return true;
+}
+
+llvm::StringRef MergeableSections::getBytes(size_t pIdx) const
+{
+  const Piece& piece = m_Pieces[pIdx];
+  const MemoryRegion& region =
+                          m_Candidates[m_Owners[pIdx]].frag->getRegion();
+  return llvm::StringRef(
+           reinterpret_cast<const char*>(region.getBuffer(piece.offset)),
+           piece.size);
+}
@@ -11,42 +11,59 @@
 
 using namespace mcld;
 
-MsgHandler::MsgHandler(DiagnosticEngine& pEngine)
- : m_Engine(pEngine), m_NumArgs(0) {
+MsgHandler::MsgHandler(DiagnosticEngine& pEngine,
+                       DiagnosticEngine::State* pState)
+ : m_Engine(pEngine), m_pState(pState), m_NumArgs(0) {
 }
 
 MsgHandler::~MsgHandler()
 {
+  if (NULL == m_pState)
+    return;
+
   emit();
+  if (&m_Engine.state() == m_pState)
+    m_Engine.m_Mutex.unlock();
 }
 
 bool MsgHandler::emit()
 {
+  if (NULL == m_pState)
+    return false;
+
   flushCounts();
-  return m_Engine.emit();
+  return m_Engine.emit(*m_pState);
 }
 
 void MsgHandler::addString(llvm::StringRef pStr) const
 {
+  if (NULL == m_pState)
+    return;
+
   assert(m_NumArgs < DiagnosticEngine::MaxArguments &&
          "Too many arguments to diagnostic!");
-  m_Engine.state().ArgumentKinds[m_NumArgs] = DiagnosticEngine::ak_std_string;
-  m_Engine.state().ArgumentStrs[m_NumArgs++] = pStr.data();
+  m_pState->ArgumentKinds[m_NumArgs] = DiagnosticEngine::ak_std_string;
+  m_pState->ArgumentStrs[m_NumArgs++] = pStr.data();
 }
 
 void MsgHandler::addString(const std::string& pStr) const
 {
+  if (NULL == m_pState)
+    return;
+
   assert(m_NumArgs < DiagnosticEngine::MaxArguments &&
          "Too many arguments to diagnostic!");
-  m_Engine.state().ArgumentKinds[m_NumArgs] = DiagnosticEngine::ak_std_string;
-  m_Engine.state().ArgumentStrs[m_NumArgs++] = pStr;
+  m_pState->ArgumentKinds[m_NumArgs] = DiagnosticEngine::ak_std_string;
+  m_pState->ArgumentStrs[m_NumArgs++] = pStr;
 }
 
 void MsgHandler::addTaggedVal(intptr_t pValue, DiagnosticEngine::ArgumentKind pKind) const
 {
+  if (NULL == m_pState)
+    return;
+
   assert(m_NumArgs < DiagnosticEngine::MaxArguments &&
          "Too many arguments to diagnostic!");
-  m_Engine.state().ArgumentKinds[m_NumArgs] = pKind;
-  m_Engine.state().ArgumentVals[m_NumArgs++] = pValue;
+  m_pState->ArgumentKinds[m_NumArgs] = pKind;
+  m_pState->ArgumentVals[m_NumArgs++] = pValue;
 }
-
@@ -9,6 +9,9 @@
 #include <llvm/Support/raw_ostream.h>
 #include <mcld/LD/NamePool.h>
 #include <mcld/LD/StaticResolver.h>
+#include <mcld/Support/LinkStats.h>
+
+#include <algorithm>
 
 using namespace mcld;
 
@@ -16,17 +19,13 @@ using namespace mcld;
 // NamePool
 //===----------------------------------------------------------------------===//
 NamePool::NamePool(NamePool::size_type pSize)
-  : m_pResolver(new StaticResolver()), m_Table(pSize) {
+  : m_pResolver(new StaticResolver()), m_Table(pSize),
+    m_NumOfHints(0), m_NextHint(0) {
 }
 
 NamePool::~NamePool()
 {
   delete m_pResolver;
-
-  FreeInfoSet::iterator info, iEnd = m_FreeInfoSet.end();
-  for (info = m_FreeInfoSet.begin(); info != iEnd; ++info) {
-    ResolveInfo::Destroy(*info);
-  }
 }
 
 /// createSymbol - create a symbol
@@ -38,16 +37,15 @@ ResolveInfo* NamePool::createSymbol(const llvm::StringRef& pName,
                                     ResolveInfo::SizeType pSize,
                                     ResolveInfo::Visibility pVisibility)
 {
-  ResolveInfo** result = m_FreeInfoSet.allocate();
-  (*result) = ResolveInfo::Create(pName);
-  (*result)->setIsSymbol(true);
-  (*result)->setSource(pIsDyn);
-  (*result)->setType(pType);
-  (*result)->setDesc(pDesc);
-  (*result)->setBinding(pBinding);
-  (*result)->setVisibility(pVisibility);
-  (*result)->setSize(pSize);
-  return *result;
+  ResolveInfo* result = m_LocalFactory.produce(pName);
+  result->setIsSymbol(true);
+  result->setSource(pIsDyn);
+  result->setType(pType);
+  result->setDesc(pDesc);
+  result->setBinding(pBinding);
+  result->setVisibility(pVisibility);
+  result->setSize(pSize);
+  return result;
 }
 
 /// insertSymbol - insert a symbol and resolve it immediately
@@ -61,14 +59,35 @@ void NamePool::insertSymbol(const llvm::StringRef& pName,
                               ResolveInfo::SizeType pSize,
                               ResolveInfo::Visibility pVisibility,
                               ResolveInfo* pOldInfo,
-                              Resolver::Result& pResult)
+                              Resolver::Result& pResult,
+                              unsigned int pOrdinal)
+{
+  size_t hash = hashOf(pName);
+  ResolveInfo* undef = doInsertSymbol(hash, pName, pIsDyn, pType, pDesc,
+                                      pBinding, pSize, pVisibility, pOldInfo,
+                                      pResult, pOrdinal);
+  if (NULL != undef)
+    m_UndefList.push_back(undef);
+}
+
+ResolveInfo* NamePool::doInsertSymbol(size_t pHash,
+                                      const llvm::StringRef& pName,
+                                      bool pIsDyn,
+                                      ResolveInfo::Type pType,
+                                      ResolveInfo::Desc pDesc,
+                                      ResolveInfo::Binding pBinding,
+                                      ResolveInfo::SizeType pSize,
+                                      ResolveInfo::Visibility pVisibility,
+                                      ResolveInfo* pOldInfo,
+                                      Resolver::Result& pResult,
+                                      unsigned int pOrdinal)
 {
   // We should check if there is any symbol with the same name existed.
   // If it already exists, we should use resolver to decide which symbol
   // should be reserved. Otherwise, we insert the symbol and set up its
   // attributes.
   bool exist = false;
-  ResolveInfo* old_symbol = m_Table.insert(pName, exist);
+  ResolveInfo* old_symbol = m_Table.insert(pName, pHash, exist);
   ResolveInfo* new_symbol = NULL;
   if (exist && old_symbol->isSymbol()) {
     new_symbol = m_Table.getEntryFactory().produce(pName);
@@ -85,19 +104,37 @@ void NamePool::insertSymbol(const llvm::StringRef& pName,
   new_symbol->setBinding(pBinding);
   new_symbol->setVisibility(pVisibility);
   new_symbol->setSize(pSize);
+  new_symbol->setOrdinal(pOrdinal);
+
+  if (LinkStats::isEnabled())
+    LinkStats::Add(LinkStats::SymbolsInserted);
+
+  // a non-weak undefined reference of a regular object makes the --as-needed
+  // libraries defining the symbol later needed
+  bool regular_ref = (!pIsDyn &&
+                      ResolveInfo::Undefined == pDesc &&
+                      ResolveInfo::Weak != pBinding);
 
   if (!exist) {
     // old_symbol is neither existed nor a symbol.
     pResult.info      = new_symbol;
     pResult.existent  = false;
     pResult.overriden = true;
-    return;
+    if (regular_ref)
+      new_symbol->setRegularRef();
+    if (new_symbol->isUndef())
+      return new_symbol;
+    return NULL;
   }
   else if (NULL != pOldInfo) {
     // existent, remember its attribute
     pOldInfo->override(*old_symbol);
   }
 
+  // a weak undefined symbol becomes non-weak undefined if other references
+  // are not weak
+  bool was_weak_undef = (old_symbol->isUndef() && old_symbol->isWeak());
+
   // exist and is a symbol
   // symbol resolution
   bool override = false;
@@ -111,8 +148,50 @@ void NamePool::insertSymbol(const llvm::StringRef& pName,
       m_pResolver->resolveAgain(*this, action, *old_symbol, *new_symbol, pResult);
   }
 
+  if (LinkStats::isEnabled()) {
+    LinkStats::Add(LinkStats::SymbolsResolved);
+    if (pResult.overriden)
+      LinkStats::Add(LinkStats::SymbolsOverridden);
+  }
+
+  if (regular_ref && NULL != pResult.info)
+    pResult.info->setRegularRef();
+
+  ResolveInfo* undef = NULL;
+  if (was_weak_undef && NULL != pResult.info &&
+      pResult.info->isUndef() && !pResult.info->isWeak())
+    undef = pResult.info;
+
   m_Table.getEntryFactory().destroy(new_symbol);
-  return;
+  return undef;
+}
+
+void NamePool::prefetch(const llvm::StringRef* pNames, size_t pNum)
+{
+  // all the names are hashed before any bucket is touched, so the loads of
+  // the buckets are in flight together
+  m_NumOfHints = std::min(pNum, static_cast<size_t>(BatchSize));
+  m_NextHint = 0;
+  for (unsigned int i = 0; i < m_NumOfHints; ++i) {
+    m_Hints[i].name = pNames[i].data();
+    m_Hints[i].size = pNames[i].size();
+    m_Hints[i].hash = m_Table.hash()(pNames[i]);
+  }
+
+  for (unsigned int i = 0; i < m_NumOfHints; ++i)
+    m_Table.prefetch(m_Hints[i].hash);
+}
+
+size_t NamePool::hashOf(const llvm::StringRef& pName)
+{
+  // the names are inserted in the order they are prefetched
+  for (unsigned int i = m_NextHint; i < m_NumOfHints; ++i) {
+    if (m_Hints[i].name == pName.data() && m_Hints[i].size == pName.size()) {
+      m_NextHint = i + 1;
+      return m_Hints[i].hash;
+    }
+  }
+  return m_Table.hash()(pName);
 }
 
 llvm::StringRef NamePool::insertString(const llvm::StringRef& pString)
@@ -124,7 +203,11 @@ llvm::StringRef NamePool::insertString(const llvm::StringRef& pString)
 
 void NamePool::reserve(NamePool::size_type pSize)
 {
-  m_Table.rehash(pSize);
+  // a table grows when it is more than 3/4 full. Give the table enough
+  // buckets to hold pSize symbols under that load.
+  size_type num_of_buckets = pSize + pSize / 3 + 1;
+  if (m_Table.numOfBuckets() < num_of_buckets)
+    m_Table.rehash(num_of_buckets);
 }
 
 NamePool::size_type NamePool::capacity() const
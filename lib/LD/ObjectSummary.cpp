@@ -0,0 +1,268 @@
+//===- ObjectSummary.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ObjectSummary.h>
+
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryView.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/SystemUtils.h>
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstring>
+
+using namespace mcld;
+
+static const uint32_t kByteOrder = 0x01020304;
+
+/// align8 - the offset of the next 8-byte aligned field
+static inline size_t align8(size_t pOffset)
+{
+  return (pOffset + 7) & ~static_cast<size_t>(7);
+}
+
+/// isRelocation - the entries of a relocation section are Relocs, and the
+/// entries of the others are EhFrameEntries
+static inline bool isRelocation(uint32_t pType)
+{
+  return (llvm::ELF::SHT_RELA == pType || llvm::ELF::SHT_REL == pType);
+}
+
+//===----------------------------------------------------------------------===//
+// ObjectSummary::Tables
+//===----------------------------------------------------------------------===//
+uint32_t ObjectSummary::Tables::addName(const llvm::StringRef& pName)
+{
+  uint32_t offset = names.size();
+  names.append(pName.data(), pName.size());
+  names.push_back('\0');
+  return offset;
+}
+
+//===----------------------------------------------------------------------===//
+// ObjectSummary
+//===----------------------------------------------------------------------===//
+const char ObjectSummary::MAGIC[] = "MCLDOSM1";
+
+ObjectSummary::ObjectSummary()
+  : m_pHeader(NULL), m_pSections(NULL), m_pSymbols(NULL), m_pRelocs(NULL),
+    m_pEhEntries(NULL), m_pNames(NULL) {
+}
+
+bool ObjectSummary::map(const void* pImage, size_t pSize)
+{
+  if (pSize < sizeof(Header))
+    return false;
+
+  const char* image = reinterpret_cast<const char*>(pImage);
+  const Header* header = reinterpret_cast<const Header*>(image);
+  if (0 != memcmp(header->magic, MAGIC, sizeof(header->magic)) ||
+      kByteOrder != header->byte_order)
+    return false;
+
+  // check the bound of every part before looking into it
+  uint64_t sections = align8(sizeof(Header));
+  uint64_t symbols = align8(sections +
+                            static_cast<uint64_t>(header->num_of_sections) *
+                            sizeof(Section));
+  uint64_t relocs = align8(symbols +
+                           static_cast<uint64_t>(header->num_of_symbols) *
+                           sizeof(Symbol));
+  uint64_t eh_entries = align8(relocs +
+                               static_cast<uint64_t>(header->num_of_relocs) *
+                               sizeof(Reloc));
+  uint64_t names = align8(eh_entries +
+                          static_cast<uint64_t>(header->num_of_eh_entries) *
+                          sizeof(EhFrameEntry));
+  if (0 == header->names_size || names + header->names_size != pSize ||
+      '\0' != image[pSize - 1])
+    return false;
+
+  const Section* sect = reinterpret_cast<const Section*>(image + sections);
+  for (uint32_t i = 0; i < header->num_of_sections; ++i) {
+    uint64_t end = static_cast<uint64_t>(sect[i].first) + sect[i].num;
+    uint32_t limit = isRelocation(sect[i].type) ? header->num_of_relocs :
+                                                  header->num_of_eh_entries;
+    if (sect[i].name >= header->names_size || end > limit)
+      return false;
+  }
+
+  const Symbol* sym = reinterpret_cast<const Symbol*>(image + symbols);
+  for (uint32_t i = 0; i < header->num_of_symbols; ++i) {
+    if (sym[i].name >= header->names_size)
+      return false;
+  }
+
+  m_pHeader    = header;
+  m_pSections  = sect;
+  m_pSymbols   = sym;
+  m_pRelocs    = reinterpret_cast<const Reloc*>(image + relocs);
+  m_pEhEntries = reinterpret_cast<const EhFrameEntry*>(image + eh_entries);
+  m_pNames     = image + names;
+  return true;
+}
+
+void ObjectSummary::emit(const Tables& pTables,
+                         uint64_t pFileSize,
+                         uint64_t pHash,
+                         std::string& pImage)
+{
+  Header header;
+  memset(&header, 0, sizeof(Header));
+  memcpy(header.magic, MAGIC, sizeof(header.magic));
+  header.byte_order        = kByteOrder;
+  header.num_of_sections   = pTables.sections.size();
+  header.num_of_symbols    = pTables.symbols.size();
+  header.num_of_relocs     = pTables.relocs.size();
+  header.num_of_eh_entries = pTables.eh_entries.size();
+  header.names_size        = pTables.names.size() + 1;
+  header.file_size         = pFileSize;
+  header.hash              = pHash;
+
+  pImage.assign(reinterpret_cast<const char*>(&header), sizeof(Header));
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!pTables.sections.empty())
+    pImage.append(reinterpret_cast<const char*>(&pTables.sections[0]),
+                  pTables.sections.size() * sizeof(Section));
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!pTables.symbols.empty())
+    pImage.append(reinterpret_cast<const char*>(&pTables.symbols[0]),
+                  pTables.symbols.size() * sizeof(Symbol));
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!pTables.relocs.empty())
+    pImage.append(reinterpret_cast<const char*>(&pTables.relocs[0]),
+                  pTables.relocs.size() * sizeof(Reloc));
+  pImage.resize(align8(pImage.size()), '\0');
+  if (!pTables.eh_entries.empty())
+    pImage.append(reinterpret_cast<const char*>(&pTables.eh_entries[0]),
+                  pTables.eh_entries.size() * sizeof(EhFrameEntry));
+  pImage.resize(align8(pImage.size()), '\0');
+  pImage.append(pTables.names);
+  // the image always ends with a NUL
+  pImage.push_back('\0');
+}
+
+//===----------------------------------------------------------------------===//
+// ObjectSummaryCache
+//===----------------------------------------------------------------------===//
+ObjectSummaryCache::ObjectSummaryCache(const sys::fs::Path& pDir)
+  : m_Dir(pDir) {
+}
+
+ObjectSummaryCache::~ObjectSummaryCache()
+{
+  SummaryListType::iterator it, itEnd = m_SummaryList.end();
+  for (it = m_SummaryList.begin(); it != itEnd; ++it) {
+    (*it)->handle->munmap((*it)->image, (*it)->handle->size());
+    (*it)->handle->close();
+    delete (*it)->handle;
+    delete *it;
+  }
+}
+
+bool ObjectSummaryCache::Hash(Input& pInput, uint64_t pSize, uint64_t& pHash)
+{
+  if (!pInput.hasMemArea() || 0 == pSize)
+    return false;
+
+  MemoryView view = pInput.memArea()->view(pInput.fileOffset(), pSize);
+  if (view.size() != pSize)
+    return false;
+
+  uint8_t digest[8];
+  digest::hash(digest::Fast, view.start(), view.size(), digest);
+  pHash = 0;
+  for (unsigned i = 0; i < 8; ++i)
+    pHash |= static_cast<uint64_t>(digest[i]) << (8 * i);
+  return true;
+}
+
+sys::fs::Path ObjectSummaryCache::getCachePath(uint64_t pHash) const
+{
+  std::string name;
+  llvm::raw_string_ostream os(name);
+  os.write_hex(pHash);
+  os << ".osum";
+  os.flush();
+
+  sys::fs::Path result(m_Dir);
+  result.append(name);
+  return result;
+}
+
+const ObjectSummary* ObjectSummaryCache::load(uint64_t pHash,
+                                              uint64_t pFileSize)
+{
+  FileHandle* handle = new FileHandle();
+  void* image = NULL;
+  if (!handle->open(getCachePath(pHash), FileHandle::ReadOnly) ||
+      0 == handle->size() ||
+      !handle->mmap(image, 0, handle->size())) {
+    delete handle;
+    return NULL;
+  }
+
+  MappedSummary* mapped = new MappedSummary();
+  mapped->handle = handle;
+  mapped->image = image;
+  if (!mapped->summary.map(image, handle->size()) ||
+      mapped->summary.getHash() != pHash ||
+      mapped->summary.getFileSize() != pFileSize) {
+    // a broken summary, or another object of the same hash. It is replaced
+    // by store().
+    handle->munmap(image, handle->size());
+    delete handle;
+    delete mapped;
+    return NULL;
+  }
+
+  m_SummaryList.push_back(mapped);
+  return &mapped->summary;
+}
+
+bool ObjectSummaryCache::store(uint64_t pHash,
+                               uint64_t pFileSize,
+                               const ObjectSummary::Tables& pTables)
+{
+  sys::fs::Path cache_path = getCachePath(pHash);
+  std::string image;
+  ObjectSummary::emit(pTables, pFileSize, pHash, image);
+
+  // write a temporary file of this process, and rename it to the cache file
+  std::string tmp_name;
+  llvm::raw_string_ostream os(tmp_name);
+  os << cache_path.native() << '.' << sys::getpid() << ".tmp";
+  os.flush();
+  sys::fs::Path tmp_path(tmp_name);
+
+  FileHandle tmp;
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  if (!tmp.open(tmp_path, mode, perm)) {
+    debug(diag::debug_cannot_write_object_summary) << cache_path;
+    return false;
+  }
+
+  bool result = tmp.write(image.data(), 0, image.size());
+  result = tmp.close() && result;
+  if (result)
+    result = (0 == sys::fs::detail::rename(tmp_path, cache_path));
+
+  if (!result) {
+    sys::fs::detail::unlink(tmp_path);
+    debug(diag::debug_cannot_write_object_summary) << cache_path;
+  }
+  return result;
+}
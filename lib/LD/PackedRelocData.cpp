@@ -0,0 +1,138 @@
+//===- PackedRelocData.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/PackedRelocData.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/Support/LEB128.h>
+
+#include <llvm/ADT/DenseMap.h>
+
+#include <cassert>
+
+using namespace mcld;
+
+namespace { // anonymous
+
+/// AppendULEB128 - append pValue in ULEB128 to pData
+void AppendULEB128(std::vector<uint8_t>& pData, uint64_t pValue)
+{
+  leb128::ByteType buffer[16];
+  leb128::ByteType* end = buffer;
+  leb128::encode<uint64_t>(end, pValue);
+  pData.insert(pData.end(), buffer, end);
+}
+
+/// AppendSLEB128 - append pValue in SLEB128 to pData
+void AppendSLEB128(std::vector<uint8_t>& pData, int64_t pValue)
+{
+  leb128::ByteType buffer[16];
+  leb128::ByteType* end = buffer;
+  leb128::encode<int64_t>(end, pValue);
+  pData.insert(pData.end(), buffer, end);
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// PackedRelocData
+//===----------------------------------------------------------------------===//
+PackedRelocData::PackedRelocData(Fragment& pTarget)
+  : m_pTarget(&pTarget), m_Size(0) {
+}
+
+bool PackedRelocData::pack(const EntryList& pEntries)
+{
+  clear();
+
+  // the dictionaries are looked up by a table of all types and a map of the
+  // symbols
+  int types[256];
+  for (size_t i = 0; i < 256; ++i)
+    types[i] = -1;
+  llvm::DenseMap<const LDSymbol*, uint32_t> symbols;
+
+  uint64_t size = m_pTarget->size();
+  int64_t prev = 0;
+  EntryList::const_iterator entry, eEnd = pEntries.end();
+  for (entry = pEntries.begin(); entry != eEnd; ++entry) {
+    // the same as IRBuilder::AddRelocations()
+    const ResolveInfo* info = entry->symbol->resolveInfo();
+    if (!entry->symbol->hasFragRef() &&
+        ResolveInfo::Section == info->type() &&
+        ResolveInfo::Undefined == info->desc())
+      continue;
+
+    if (entry->offset > size) {
+      clear();
+      return false;
+    }
+
+    if (0 == m_Size % BlockSize) {
+      m_Blocks.push_back(m_Data.size());
+      prev = 0;
+    }
+
+    int& type = types[entry->type];
+    if (-1 == type) {
+      type = m_Types.size();
+      m_Types.push_back(entry->type);
+    }
+
+    std::pair<llvm::DenseMap<const LDSymbol*, uint32_t>::iterator, bool> sym =
+      symbols.insert(std::make_pair(entry->symbol, m_Symbols.size()));
+    if (sym.second)
+      m_Symbols.push_back(entry->symbol);
+
+    AppendSLEB128(m_Data, static_cast<int64_t>(entry->offset) - prev);
+    AppendULEB128(m_Data, type);
+    AppendULEB128(m_Data, sym.first->second);
+    AppendSLEB128(m_Data, static_cast<int64_t>(entry->addend));
+    prev = entry->offset;
+    ++m_Size;
+  }
+  return true;
+}
+
+void PackedRelocData::decode(size_t pIdx, EntryList& pEntries) const
+{
+  assert(pIdx < m_Blocks.size());
+  size_t num = BlockSize;
+  if (pIdx + 1 == m_Blocks.size())
+    num = m_Size - pIdx * BlockSize;
+  pEntries.resize(num);
+
+  const leb128::ByteType* data = &m_Data[m_Blocks[pIdx]];
+  int64_t offset = 0;
+  for (size_t i = 0; i < num; ++i) {
+    Entry& entry = pEntries[i];
+    offset += leb128::decode<int64_t>(data);
+    entry.offset = offset;
+    entry.type   = m_Types[leb128::decode<uint64_t>(data)];
+    entry.symbol = m_Symbols[leb128::decode<uint64_t>(data)];
+    entry.addend = leb128::decode<int64_t>(data);
+  }
+}
+
+size_t PackedRelocData::memory() const
+{
+  return m_Data.capacity() + m_Blocks.capacity() * sizeof(uint32_t) +
+         m_Types.capacity() * sizeof(Relocation::Type) +
+         m_Symbols.capacity() * sizeof(LDSymbol*);
+}
+
+void PackedRelocData::clear()
+{
+  m_Size = 0;
+  m_Data.clear();
+  m_Blocks.clear();
+  m_Types.clear();
+  m_Symbols.clear();
+}
+
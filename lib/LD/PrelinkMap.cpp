@@ -0,0 +1,81 @@
+//===- PrelinkMap.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/PrelinkMap.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/Path.h>
+
+#include <string>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// PrelinkMap
+//===----------------------------------------------------------------------===//
+PrelinkMap::PrelinkMap()
+{
+}
+
+PrelinkMap::~PrelinkMap()
+{
+}
+
+bool PrelinkMap::read(const sys::fs::Path& pPath)
+{
+  FileHandle file;
+  if (!file.open(pPath, FileHandle::ReadOnly))
+    return false;
+
+  std::string content(file.size(), '\0');
+  bool result = content.empty() ||
+                file.read(&content[0], 0, content.size());
+  file.close();
+
+  size_t bad_line = 0;
+  return result && parse(content, bad_line);
+}
+
+bool PrelinkMap::parse(llvm::StringRef pContent, size_t& pBadLine)
+{
+  size_t line_no = 0;
+  while (!pContent.empty()) {
+    std::pair<llvm::StringRef, llvm::StringRef> line = pContent.split('\n');
+    pContent = line.second;
+    ++line_no;
+
+    llvm::StringRef text = line.first.split('#').first.trim();
+    if (text.empty())
+      continue;
+
+    // <name> <address>
+    std::pair<llvm::StringRef, llvm::StringRef> fields =
+      text.split(' ');
+    if (fields.second.empty())
+      fields = text.split('\t');
+    llvm::StringRef name = fields.first.trim();
+    llvm::StringRef addr = fields.second.trim();
+    uint64_t base = 0;
+    if (name.empty() || addr.empty() || addr.getAsInteger(0, base)) {
+      pBadLine = line_no;
+      return false;
+    }
+
+    // the last line of a library gives its address
+    m_BaseMap[name] = base;
+  }
+  return true;
+}
+
+uint64_t PrelinkMap::getBase(llvm::StringRef pName) const
+{
+  BaseMapType::const_iterator it = m_BaseMap.find(pName);
+  if (m_BaseMap.end() == it)
+    return NotFound;
+  return it->getValue();
+}
+
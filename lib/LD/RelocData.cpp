@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/RelocData.h>
+#include <mcld/LD/PackedRelocData.h>
 #include <mcld/Support/GCFactory.h>
 
 #include <llvm/Support/ManagedStatic.h>
@@ -21,11 +22,17 @@ static llvm::ManagedStatic<RelocDataFactory> g_RelocDataFactory;
 // RelocData
 //===----------------------------------------------------------------------===//
 RelocData::RelocData()
-  : m_pSection(NULL) {
+  : m_pSection(NULL), m_pPacked(NULL) {
 }
 
 RelocData::RelocData(LDSection &pSection)
-  : m_pSection(&pSection) {
+  : m_pSection(&pSection), m_pPacked(NULL) {
+}
+
+RelocData::~RelocData()
+{
+  m_Relocations.clearAndLeakNodesUnsafely();
+  delete m_pPacked;
 }
 
 RelocData* RelocData::Create(LDSection& pSection)
@@ -53,3 +60,10 @@ RelocData& RelocData::append(Relocation& pRelocation)
   return *this;
 }
 
+void RelocData::setPacked(PackedRelocData* pPacked)
+{
+  if (pPacked != m_pPacked)
+    delete m_pPacked;
+  m_pPacked = pPacked;
+}
+
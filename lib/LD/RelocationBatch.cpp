@@ -0,0 +1,38 @@
+//===- RelocationBatch.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/RelocationBatch.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// RelocationBatch
+//===----------------------------------------------------------------------===//
+RelocationBatch::RelocationBatch(Relocation* const* pRelocs, size_t pNum)
+  : m_pRelocs(pRelocs), m_Order(pNum) {
+  // counting sort by the types. Relocation::Type is 8-bit.
+  static const size_t NumOfTypes = 256;
+  size_t count[NumOfTypes] = { 0 };
+  for (size_t i = 0; i < pNum; ++i)
+    ++count[pRelocs[i]->type()];
+
+  size_t begin = 0;
+  for (size_t type = 0; type < NumOfTypes; ++type) {
+    if (0 == count[type])
+      continue;
+    Run run = { static_cast<Relocation::Type>(type), begin, count[type] };
+    m_Runs.push_back(run);
+    // count[type] becomes the next slot of the type
+    count[type] = begin;
+    begin += run.size;
+  }
+
+  for (size_t i = 0; i < pNum; ++i)
+    m_Order[count[pRelocs[i]->type()]++] = i;
+}
+
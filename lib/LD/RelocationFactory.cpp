@@ -23,6 +23,7 @@ using namespace mcld;
 //===----------------------------------------------------------------------===//
 RelocationFactory::RelocationFactory()
   : GCFactory<Relocation, MCLD_RELOCATIONS_PER_INPUT>(), m_pConfig(NULL) {
+  setUsageKind(MemoryUsage::Relocations);
 }
 
 void RelocationFactory::setConfig(const LinkerConfig& pConfig)
@@ -0,0 +1,308 @@
+//===- RelocationStreamer.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/RelocationStreamer.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/ADT/SizeTraits.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/LD/EhFrame.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/Relocator.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/LD/SectionSymbolSet.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Target/GNULDBackend.h>
+
+#include <llvm/Support/ELF.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// RelocationStreamer
+//===----------------------------------------------------------------------===//
+RelocationStreamer::RelocationStreamer(const LinkerConfig& pConfig,
+                                       GNULDBackend& pBackend)
+  : m_Config(pConfig), m_Backend(pBackend), m_pModule(NULL) {
+}
+
+RelocationStreamer::~RelocationStreamer()
+{
+}
+
+bool RelocationStreamer::IsEnabled(const LinkerConfig& pConfig)
+{
+  return (LinkerConfig::Object == pConfig.codeGenType() &&
+          pConfig.options().streamPartialLink());
+}
+
+/// addInput - record the relocation sections of pInput
+bool RelocationStreamer::addInput(Input& pInput)
+{
+  assert(pInput.hasMemArea());
+
+  MemoryArea* mem = pInput.memArea();
+  LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    // the target section is a discarded group section
+    if (LDFileFormat::Ignore == (*rs)->kind())
+      continue;
+
+    Source source;
+    source.input = &pInput;
+    source.section = *rs;
+    source.region = mem->request(pInput.fileOffset() + (*rs)->offset(),
+                                 (*rs)->size());
+    if (NULL == source.region)
+      return false;
+
+    // the fragments of the target section stay together after merging, so
+    // the first one tells where the section is in its output section
+    LDSection& target = *(*rs)->getLink();
+    const SectionData* data = NULL;
+    switch (target.kind()) {
+      case LDFileFormat::Relocation:
+        break;
+      case LDFileFormat::EhFrame:
+        if (target.hasEhFrame())
+          data = &target.getEhFrame()->getSectionData();
+        break;
+      default:
+        data = target.getSectionData();
+        break;
+    }
+    source.target = (NULL == data || data->empty()) ? NULL : &data->front();
+    m_Sources.push_back(source);
+  }
+  return true;
+}
+
+/// sizeOutputs - create the output relocation sections and size them
+void RelocationStreamer::sizeOutputs(Module& pModule)
+{
+  m_pModule = &pModule;
+
+  for (size_t i = 0; i < m_Sources.size(); ++i) {
+    LDSection& input = *m_Sources[i].section;
+
+    // get the output relocation LDSection with identical name.
+    LDSection* output_sect = pModule.getSection(input.name());
+    if (NULL == output_sect) {
+      output_sect = LDSection::Create(input.name(),
+                                      input.kind(),
+                                      input.type(),
+                                      input.flag());
+      output_sect->setAlign(input.align());
+      pModule.appendSection(*output_sect);
+    }
+
+    // get the linked output section
+    LDSection* output_link = pModule.getSection(input.getLink()->name());
+    assert(NULL != output_link);
+    output_sect->setLink(output_link);
+
+    std::pair<llvm::DenseMap<const LDSection*, size_t>::iterator, bool> res =
+      m_OutputIndex.insert(std::make_pair(output_sect, m_Outputs.size()));
+    if (res.second) {
+      m_Outputs.push_back(Output());
+      m_Outputs.back().section = output_sect;
+    }
+    m_Outputs[res.first->second].sources.push_back(i);
+
+    size_t entsize = 0;
+    bool is_32 = m_Config.targets().is32Bits();
+    if (llvm::ELF::SHT_REL == output_sect->type())
+      entsize = is_32 ? sizeof(ELFSizeTraits<32>::Rel)
+                      : sizeof(ELFSizeTraits<64>::Rel);
+    else if (llvm::ELF::SHT_RELA == output_sect->type())
+      entsize = is_32 ? sizeof(ELFSizeTraits<32>::Rela)
+                      : sizeof(ELFSizeTraits<64>::Rela);
+    else {
+      fatal(diag::unknown_reloc_section_type) << output_sect->type()
+                                              << output_sect->name();
+    }
+    output_sect->setSize(output_sect->size() +
+                         (input.size() / entsize) * entsize);
+  }
+}
+
+/// emit - write the entries of the output relocation section pSection
+void RelocationStreamer::emit(const LDSection& pSection,
+                              MemoryRegion& pRegion)
+{
+  llvm::DenseMap<const LDSection*, size_t>::const_iterator entry =
+                                                m_OutputIndex.find(&pSection);
+  assert(m_OutputIndex.end() != entry && "Not a streamed section!");
+
+  // the sections are emitted concurrently, but an output relocation section
+  // is written by one thread only
+  Output& output = m_Outputs[entry->second];
+  bool is_rel = (llvm::ELF::SHT_REL == pSection.type());
+  uint8_t* buffer = pRegion.start();
+  std::vector<size_t>::const_iterator src, srcEnd = output.sources.end();
+  for (src = output.sources.begin(); src != srcEnd; ++src) {
+    const Source& source = m_Sources[*src];
+    if (m_Config.targets().is32Bits())
+      buffer += is_rel ? emitRel<32>(source, output, buffer)
+                       : emitRela<32>(source, output, buffer);
+    else
+      buffer += is_rel ? emitRel<64>(source, output, buffer)
+                       : emitRela<64>(source, output, buffer);
+  }
+}
+
+template<size_t SIZE>
+uint64_t RelocationStreamer::emitRel(const Source& pSource,
+                                     Output& pOutput,
+                                     uint8_t* pBuffer)
+{
+  typedef typename ELFSizeTraits<SIZE>::Rel ElfXX_Rel;
+
+  const ElfXX_Rel* from =
+                   reinterpret_cast<const ElfXX_Rel*>(pSource.region->start());
+  ElfXX_Rel* to = reinterpret_cast<ElfXX_Rel*>(pBuffer);
+  size_t num = pSource.region->size() / sizeof(ElfXX_Rel);
+
+  uint64_t base = 0;
+  uint64_t file_base = 0;
+  if (NULL != pSource.target) {
+    base = pSource.target->getOffset();
+    file_base = pSource.target->getParent()->getSection().offset() + base;
+  }
+
+  for (size_t i = 0; i < num; ++i) {
+    to[i] = from[i];
+    to[i].r_offset = from[i].r_offset + base;
+
+    uint32_t index = 0;
+    uint64_t delta = 0;
+    if (NULL == pSource.target ||
+        !getSymbolIndex(pSource, from[i].getSymbol(), index, delta)) {
+      to[i].setSymbolAndType(0, 0x0);
+      continue;
+    }
+    to[i].setSymbolAndType(index, from[i].getType());
+
+    // the addend is in the place
+    if (0 != delta && 0x0 != from[i].getType()) {
+      ImplicitAddend addend = { file_base + from[i].r_offset, delta,
+                                from[i].getType() };
+      pOutput.addends.push_back(addend);
+    }
+  }
+  return num * sizeof(ElfXX_Rel);
+}
+
+template<size_t SIZE>
+uint64_t RelocationStreamer::emitRela(const Source& pSource,
+                                      Output& pOutput,
+                                      uint8_t* pBuffer)
+{
+  typedef typename ELFSizeTraits<SIZE>::Rela ElfXX_Rela;
+
+  const ElfXX_Rela* from =
+                  reinterpret_cast<const ElfXX_Rela*>(pSource.region->start());
+  ElfXX_Rela* to = reinterpret_cast<ElfXX_Rela*>(pBuffer);
+  size_t num = pSource.region->size() / sizeof(ElfXX_Rela);
+
+  uint64_t base = (NULL == pSource.target) ? 0 : pSource.target->getOffset();
+  for (size_t i = 0; i < num; ++i) {
+    to[i] = from[i];
+    to[i].r_offset = from[i].r_offset + base;
+
+    uint32_t index = 0;
+    uint64_t delta = 0;
+    if (NULL == pSource.target ||
+        !getSymbolIndex(pSource, from[i].getSymbol(), index, delta)) {
+      to[i].setSymbolAndType(0, 0x0);
+      continue;
+    }
+    to[i].setSymbolAndType(index, from[i].getType());
+    to[i].r_addend = from[i].r_addend + delta;
+  }
+  return num * sizeof(ElfXX_Rela);
+}
+
+/// getSymbolIndex - the output symbol of the pIdx-th symbol of pSource
+bool RelocationStreamer::getSymbolIndex(const Source& pSource,
+                                        uint32_t pIdx,
+                                        uint32_t& pIndex,
+                                        uint64_t& pDelta) const
+{
+  pIndex = 0;
+  pDelta = 0;
+  if (0 == pIdx)
+    return true;
+
+  LDSymbol* symbol = pSource.input->context()->getSymbol(pIdx);
+  if (NULL == symbol)
+    fatal(diag::err_cannot_read_symbol) << pIdx << pSource.input->path();
+
+  ResolveInfo* info = symbol->resolveInfo();
+  if (ResolveInfo::Section != info->type()) {
+    pIndex = m_Backend.getSymbolIdx(info->outSymbol());
+    return true;
+  }
+
+  // a section symbol of a discarded section
+  if (!symbol->hasFragRef())
+    return false;
+
+  // refer to the symbol of the output section instead
+  const FragmentRef* frag_ref = info->outSymbol()->fragRef();
+  pDelta = frag_ref->getOutputOffset();
+  const LDSection& out_sect = frag_ref->frag()->getParent()->getSection();
+  pIndex = m_Backend.getSymbolIdx(
+                             m_pModule->getSectionSymbolSet().get(out_sect));
+  return true;
+}
+
+/// syncImplicitAddends - adjust the implicit addends of SHT_REL
+void RelocationStreamer::syncImplicitAddends(MemoryArea& pOutput)
+{
+  bool has_addends = false;
+  for (size_t i = 0; i < m_Outputs.size(); ++i)
+    has_addends |= !m_Outputs[i].addends.empty();
+  if (!has_addends)
+    return;
+
+  MemoryRegion* region = pOutput.request(0, pOutput.handler()->size());
+  uint8_t* data = region->getBuffer();
+  Relocator& relocator = *m_Backend.getRelocator();
+  bool is_little = m_Config.targets().isLittleEndian();
+
+  for (size_t i = 0; i < m_Outputs.size(); ++i) {
+    std::vector<ImplicitAddend>::const_iterator addend,
+                                      aEnd = m_Outputs[i].addends.end();
+    for (addend = m_Outputs[i].addends.begin(); addend != aEnd; ++addend) {
+      unsigned int bytes = relocator.getSize(addend->type) / 8;
+      if (0 == bytes || bytes > 8)
+        continue;
+
+      // the same as partialSyncRelocationResult(), the delta is added to
+      // the whole place
+      uint8_t* place = data + addend->offset;
+      uint64_t value = 0;
+      for (unsigned int b = 0; b < bytes; ++b)
+        value |= uint64_t(place[is_little ? b : (bytes - 1 - b)]) << (b * 8);
+      value += addend->delta;
+      for (unsigned int b = 0; b < bytes; ++b)
+        place[is_little ? b : (bytes - 1 - b)] = (value >> (b * 8)) & 0xff;
+    }
+  }
+  pOutput.clear();
+}
+
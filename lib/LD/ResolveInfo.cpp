@@ -19,7 +19,8 @@ static ResolveInfo* g_NullResolveInfo = NULL;
 // ResolveInfo
 //===----------------------------------------------------------------------===//
 ResolveInfo::ResolveInfo()
-  : m_Size(0), m_BitField(0) {
+  : m_BitField(0), m_ScanProps(0), m_bRegularRef(false),
+    m_Ordinal(NoOrdinal) {
   m_Ptr.sym_ptr = 0;
 }
 
@@ -29,13 +30,15 @@ ResolveInfo::~ResolveInfo()
 
 void ResolveInfo::override(const ResolveInfo& pFrom)
 {
-  m_Size = pFrom.m_Size;
+  coldSize() = pFrom.size();
+  m_Ordinal = pFrom.m_Ordinal;
   overrideAttributes(pFrom);
   overrideVisibility(pFrom);
 }
 
 void ResolveInfo::overrideAttributes(const ResolveInfo& pFrom)
 {
+  m_ScanProps = 0;
   m_BitField &= ~RESOLVE_MASK;
   m_BitField |= (pFrom.m_BitField & RESOLVE_MASK);
 }
@@ -71,16 +74,19 @@ void ResolveInfo::overrideVisibility(const ResolveInfo& pFrom)
 
 void ResolveInfo::setRegular()
 {
+  m_ScanProps = 0;
   m_BitField &= (~dynamic_flag);
 }
 
 void ResolveInfo::setDynamic()
 {
+  m_ScanProps = 0;
   m_BitField |= dynamic_flag;
 }
 
 void ResolveInfo::setSource(bool pIsDyn)
 {
+  m_ScanProps = 0;
   if (pIsDyn)
     m_BitField |= dynamic_flag;
   else
@@ -89,18 +95,21 @@ void ResolveInfo::setSource(bool pIsDyn)
 
 void ResolveInfo::setType(uint32_t pType)
 {
+  m_ScanProps = 0;
   m_BitField &= ~TYPE_MASK;
   m_BitField |= ((pType << TYPE_OFFSET) & TYPE_MASK);
 }
 
 void ResolveInfo::setDesc(uint32_t pDesc)
 {
+  m_ScanProps = 0;
   m_BitField &= ~DESC_MASK;
   m_BitField |= ((pDesc << DESC_OFFSET) & DESC_MASK);
 }
 
 void ResolveInfo::setBinding(uint32_t pBinding)
 {
+  m_ScanProps = 0;
   m_BitField &= ~BINDING_MASK;
   if (pBinding == Local || pBinding == Absolute)
     m_BitField |= local_flag;
@@ -121,12 +130,14 @@ void ResolveInfo::setOther(uint32_t pOther)
 
 void ResolveInfo::setVisibility(ResolveInfo::Visibility pVisibility)
 {
+  m_ScanProps = 0;
   m_BitField &= ~VISIBILITY_MASK;
   m_BitField |= pVisibility << VISIBILITY_OFFSET;
 }
 
 void ResolveInfo::setIsSymbol(bool pIsSymbol)
 {
+  m_ScanProps = 0;
   if (pIsSymbol)
     m_BitField |= symbol_flag;
   else
@@ -241,16 +252,21 @@ bool ResolveInfo::compare(const ResolveInfo::key_type& pKey)
 //===----------------------------------------------------------------------===//
 ResolveInfo* ResolveInfo::Create(const ResolveInfo::key_type& pKey)
 {
-  ResolveInfo* result = static_cast<ResolveInfo*>(
-                          malloc(sizeof(ResolveInfo)+pKey.size()+1));
-  if (NULL == result)
+  void* place = malloc(AllocSize(pKey));
+  if (NULL == place)
     return NULL;
+  return Create(pKey, place);
+}
 
-  new (result) ResolveInfo();
+ResolveInfo* ResolveInfo::Create(const ResolveInfo::key_type& pKey,
+                                 void* pPlace)
+{
+  ResolveInfo* result = new (pPlace) ResolveInfo();
   std::memcpy(result->m_Name, pKey.data(), pKey.size());
   result->m_Name[pKey.size()] = '\0';
   result->m_BitField &= ~ResolveInfo::RESOLVE_MASK;
   result->m_BitField |= (pKey.size() << ResolveInfo::NAME_LENGTH_OFFSET);
+  result->coldSize() = 0;
   return result;
 }
 
@@ -271,10 +287,11 @@ ResolveInfo* ResolveInfo::Null()
 {
   if (NULL == g_NullResolveInfo) {
     g_NullResolveInfo = static_cast<ResolveInfo*>(
-                          malloc(sizeof(ResolveInfo) + 1));
+                          malloc(AllocSize(key_type())));
     new (g_NullResolveInfo) ResolveInfo();
     g_NullResolveInfo->m_Name[0] = '\0';
     g_NullResolveInfo->m_BitField = 0x0;
+    g_NullResolveInfo->coldSize() = 0;
     g_NullResolveInfo->setBinding(Local);
   }
   return g_NullResolveInfo;
@@ -0,0 +1,91 @@
+//===- ResolveInfoFactory.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ResolveInfoFactory.h>
+#include <mcld/Support/MemoryUsage.h>
+#include <mcld/Support/PageHeap.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// ResolveInfoFactory
+//===----------------------------------------------------------------------===//
+ResolveInfoFactory::ResolveInfoFactory()
+  : m_pCurrent(NULL), m_pEnd(NULL), m_Bytes(0) {
+}
+
+ResolveInfoFactory::~ResolveInfoFactory()
+{
+  SlabListType::iterator slab, sEnd = m_Slabs.end();
+  for (slab = m_Slabs.begin(); slab != sEnd; ++slab)
+    PageHeap::deallocate(slab->first, slab->second);
+  if (MemoryUsage::isEnabled())
+    MemoryUsage::Release(MemoryUsage::NamePools, m_Bytes);
+}
+
+ResolveInfo* ResolveInfoFactory::produce(const key_type& pKey)
+{
+  void* place = allocate(ResolveInfo::AllocSize(pKey));
+  if (NULL == place)
+    return NULL;
+  if (MemoryUsage::isEnabled())
+    MemoryUsage::AddObjects(MemoryUsage::NamePools);
+  return ResolveInfo::Create(pKey, place);
+}
+
+void ResolveInfoFactory::destroy(entry_type*& pEntry)
+{
+  if (NULL == pEntry)
+    return;
+
+  size_t size = align(ResolveInfo::AllocSize(
+                        llvm::StringRef(pEntry->name(), pEntry->nameSize())));
+  if (reinterpret_cast<char*>(pEntry) + size == m_pCurrent)
+    m_pCurrent -= size;
+  pEntry = NULL;
+  if (MemoryUsage::isEnabled())
+    MemoryUsage::RemoveObjects(MemoryUsage::NamePools);
+}
+
+void* ResolveInfoFactory::allocate(size_t pSize)
+{
+  pSize = align(pSize);
+
+  // a large record has a slab of its own, and leaves the current slab to the
+  // following records.
+  if (pSize > SlabSize / 4) {
+    char* slab = static_cast<char*>(PageHeap::allocate(pSize));
+    if (NULL != slab) {
+      m_Slabs.push_back(std::make_pair(slab, pSize));
+      addBytes(pSize);
+    }
+    return slab;
+  }
+
+  if (static_cast<size_t>(m_pEnd - m_pCurrent) < pSize) {
+    size_t size = SlabSize;
+    char* slab = static_cast<char*>(PageHeap::allocate(size));
+    if (NULL == slab)
+      return NULL;
+    m_Slabs.push_back(std::make_pair(slab, size));
+    m_pCurrent = slab;
+    m_pEnd = slab + SlabSize;
+    addBytes(SlabSize);
+  }
+
+  void* result = m_pCurrent;
+  m_pCurrent += pSize;
+  return result;
+}
+
+void ResolveInfoFactory::addBytes(size_t pSize)
+{
+  m_Bytes += pSize;
+  if (MemoryUsage::isEnabled())
+    MemoryUsage::Allocate(MemoryUsage::NamePools, pSize);
+}
@@ -0,0 +1,146 @@
+//===- SectionAtom.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/SectionAtom.h>
+#include <mcld/Support/Thread.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/ManagedStatic.h>
+
+#include <cassert>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// the names of the predefined atoms, in the order of SectionAtom::Predefined
+const char* g_PredefinedNames[SectionAtom::NumOfPredefined] = {
+  "",
+  ".text",
+  ".data",
+  ".bss",
+  ".rodata",
+  ".init",
+  ".fini",
+  ".init_array",
+  ".fini_array",
+  ".preinit_array",
+  ".ctors",
+  ".dtors",
+  ".jcr",
+  ".data.rel.ro",
+  ".data.rel.ro.local",
+  ".tdata",
+  ".tbss",
+  ".got",
+  ".got.plt",
+  ".plt",
+  ".dynamic",
+  ".dynsym",
+  ".dynstr",
+  ".hash",
+  ".gnu.hash",
+  ".interp",
+  ".rel.dyn",
+  ".rela.dyn",
+  ".rel.plt",
+  ".rela.plt",
+  ".eh_frame",
+  ".eh_frame_hdr",
+  ".gcc_except_table",
+  ".comment",
+  ".note.GNU-stack",
+  ".note.gnu.build-id",
+  ".symtab",
+  ".strtab",
+  ".shstrtab"
+};
+
+} // anonymous namespace
+
+namespace mcld {
+
+/// SectionAtomTable - the atoms, indexed by their names and by their IDs
+struct SectionAtomTable
+{
+  SectionAtomTable();
+
+  ~SectionAtomTable();
+
+  /// intern - the caller holds the lock
+  const SectionAtom& intern(llvm::StringRef pName);
+
+  sys::Mutex lock;
+  llvm::StringMap<SectionAtom*> index;
+  std::vector<SectionAtom*> atoms;
+};
+
+} // namespace of mcld
+
+SectionAtomTable::SectionAtomTable()
+{
+  for (unsigned int i = 0; i < SectionAtom::NumOfPredefined; ++i)
+    intern(g_PredefinedNames[i]);
+}
+
+SectionAtomTable::~SectionAtomTable()
+{
+  std::vector<SectionAtom*>::iterator atom, aEnd = atoms.end();
+  for (atom = atoms.begin(); atom != aEnd; ++atom)
+    delete *atom;
+}
+
+const SectionAtom& SectionAtomTable::intern(llvm::StringRef pName)
+{
+  SectionAtom*& entry = index[pName];
+  if (NULL == entry) {
+    entry = new SectionAtom(pName, atoms.size());
+    atoms.push_back(entry);
+  }
+  return *entry;
+}
+
+static llvm::ManagedStatic<SectionAtomTable> g_AtomTable;
+
+//===----------------------------------------------------------------------===//
+// SectionAtom
+//===----------------------------------------------------------------------===//
+SectionAtom::SectionAtom(llvm::StringRef pName, ID pID)
+  : m_Name(pName.data(), pName.size()), m_ID(pID) {
+}
+
+const SectionAtom& SectionAtom::Intern(llvm::StringRef pName)
+{
+  sys::ScopedLock lock(g_AtomTable->lock);
+  return g_AtomTable->intern(pName);
+}
+
+const SectionAtom* SectionAtom::Find(llvm::StringRef pName)
+{
+  sys::ScopedLock lock(g_AtomTable->lock);
+  llvm::StringMap<SectionAtom*>::const_iterator entry =
+                                                 g_AtomTable->index.find(pName);
+  if (g_AtomTable->index.end() == entry)
+    return NULL;
+  return entry->getValue();
+}
+
+const SectionAtom& SectionAtom::Get(Predefined pID)
+{
+  assert(pID < NumOfPredefined && "not a predefined atom");
+  sys::ScopedLock lock(g_AtomTable->lock);
+  return *g_AtomTable->atoms[pID];
+}
+
+size_t SectionAtom::size()
+{
+  sys::ScopedLock lock(g_AtomTable->lock);
+  return g_AtomTable->atoms.size();
+}
+
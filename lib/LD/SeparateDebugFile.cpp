@@ -0,0 +1,193 @@
+//===- SeparateDebugFile.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/SeparateDebugFile.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/ADT/SizeTraits.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/StringTable.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/Path.h>
+
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// SeparateDebugFile
+//===----------------------------------------------------------------------===//
+SeparateDebugFile::SeparateDebugFile(const LinkerConfig& pConfig,
+                                     const Module& pModule,
+                                     const StringTable& pShStrTab,
+                                     const LDSection& pGNUDebugLink)
+  : m_Config(pConfig),
+    m_Module(pModule),
+    m_ShStrTab(pShStrTab),
+    m_GNUDebugLink(pGNUDebugLink),
+    m_CRC(0x0) {
+}
+
+bool SeparateDebugFile::emit(MemoryArea& pOutput)
+{
+  if (!pOutput.hasHandler())
+    return false;
+
+  FileHandle debug;
+  FileHandle::OpenMode mode =
+    FileHandle::ReadWrite | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  if (!debug.open(sys::fs::Path(m_Config.options().separateDebugFile()),
+                  mode, perm))
+    return false;
+
+  bool result = false;
+  if (m_Config.targets().is32Bits())
+    result = doEmit<32>(pOutput, debug);
+  else if (m_Config.targets().is64Bits())
+    result = doEmit<64>(pOutput, debug);
+  return debug.close() && result;
+}
+
+template<size_t SIZE>
+bool SeparateDebugFile::doEmit(MemoryArea& pOutput, FileHandle& pDebug)
+{
+  typedef typename ELFSizeTraits<SIZE>::Ehdr ElfXX_Ehdr;
+  typedef typename ELFSizeTraits<SIZE>::Shdr ElfXX_Shdr;
+
+  // every section has reached the file, and the section header table of the
+  // output is emitted by the writer
+  pOutput.clear();
+  FileHandle& output = *pOutput.handler();
+
+  ElfXX_Ehdr ehdr;
+  std::memcpy(&ehdr, pOutput.request(0, sizeof(ElfXX_Ehdr))->start(),
+              sizeof(ElfXX_Ehdr));
+  size_t num_of_main = ehdr.e_shnum;
+  size_t num_of_sects = m_Module.size();
+  uint64_t main_end = ehdr.e_shoff + num_of_main * sizeof(ElfXX_Shdr);
+
+  std::vector<ElfXX_Shdr> shdrs(num_of_sects);
+  std::memcpy(&shdrs[0],
+              pOutput.request(ehdr.e_shoff,
+                              num_of_main * sizeof(ElfXX_Shdr))->start(),
+              num_of_main * sizeof(ElfXX_Shdr));
+
+  // 1. the non-alloc sections and the notes of the output keep their
+  // contents, and the other alloc sections become SHT_NOBITS
+  uint64_t offset = sizeof(ElfXX_Ehdr);
+  for (size_t i = 1; i < num_of_main; ++i) {
+    ElfXX_Shdr& shdr = shdrs[i];
+    if (llvm::ELF::SHT_NOBITS == shdr.sh_type)
+      continue;
+
+    if (0 != (shdr.sh_flags & llvm::ELF::SHF_ALLOC) &&
+        llvm::ELF::SHT_NOTE != shdr.sh_type) {
+      shdr.sh_type = llvm::ELF::SHT_NOBITS;
+      shdr.sh_offset = offset;
+      continue;
+    }
+
+    alignAddress(offset, shdr.sh_addralign);
+    if (0 != shdr.sh_size) {
+      MemoryRegion* region = pOutput.request(shdr.sh_offset, shdr.sh_size);
+      if (!pDebug.write(region->start(), offset, shdr.sh_size))
+        return false;
+    }
+    shdr.sh_offset = offset;
+    offset += shdr.sh_size;
+  }
+
+  // 2. the debug sections follow the section header table of the output.
+  // They are moved as a block at the same offset modulo the page size, so
+  // the file systems which share extents make a reflink of it.
+  if (num_of_main < num_of_sects) {
+    const LDSection* first = m_Module.getSectionTable().at(num_of_main);
+    const LDSection* last = m_Module.back();
+    uint64_t begin = first->offset();
+    uint64_t size = last->offset() + last->size() - begin;
+
+    alignAddress(offset, 0x1000);
+    offset += begin % 0x1000;
+    if (!pDebug.copy(output, begin, offset, size)) {
+      MemoryRegion* region = pOutput.request(begin, size);
+      if (!pDebug.write(region->start(), offset, size))
+        return false;
+    }
+
+    for (size_t i = num_of_main; i < num_of_sects; ++i) {
+      const LDSection* sect = m_Module.getSectionTable().at(i);
+      ElfXX_Shdr& shdr = shdrs[i];
+      std::memset(&shdr, 0, sizeof(ElfXX_Shdr));
+      shdr.sh_name      = m_ShStrTab.getOffset(sect->name());
+      shdr.sh_type      = sect->type();
+      shdr.sh_flags     = sect->flag();
+      shdr.sh_addr      = sect->addr();
+      shdr.sh_offset    = sect->offset() - begin + offset;
+      shdr.sh_size      = sect->size();
+      shdr.sh_addralign = sect->align();
+      if (0 != (sect->flag() & llvm::ELF::SHF_STRINGS))
+        shdr.sh_entsize = 1;
+    }
+    offset += size;
+  }
+
+  // 3. the section header table of all the output sections
+  offset = Align<SIZE>(offset);
+  if (!pDebug.write(&shdrs[0], offset, num_of_sects * sizeof(ElfXX_Shdr)))
+    return false;
+
+  ehdr.e_phoff = 0x0;
+  ehdr.e_phnum = 0x0;
+  ehdr.e_shoff = offset;
+  ehdr.e_shnum = num_of_sects;
+  if (!pDebug.write(&ehdr, 0, sizeof(ElfXX_Ehdr)))
+    return false;
+
+  if (!computeCRC(pDebug, offset + num_of_sects * sizeof(ElfXX_Shdr)))
+    return false;
+
+  // 4. write the CRC at the end of .gnu_debuglink in the target byte order,
+  // and cut the debug sections off the output
+  if (m_GNUDebugLink.size() >= 4) {
+    MemoryRegion* region =
+      pOutput.request(m_GNUDebugLink.offset() + m_GNUDebugLink.size() - 4, 4);
+    uint8_t* data = region->start();
+    for (unsigned i = 0; i < 4; ++i) {
+      unsigned shift = m_Config.targets().isLittleEndian() ? 8 * i
+                                                           : 8 * (3 - i);
+      data[i] = (m_CRC >> shift) & 0xff;
+    }
+  }
+  pOutput.clear();
+  return output.truncate(main_end);
+}
+
+bool SeparateDebugFile::computeCRC(FileHandle& pDebug, size_t pSize)
+{
+  // the chunks of the debug file are summed up in parallel
+  void* data = NULL;
+  if (pDebug.mmap(data, 0, pSize)) {
+    m_CRC = digest::crc32(m_Config.threads(),
+                          static_cast<const uint8_t*>(data), pSize);
+    return pDebug.munmap(data, pSize);
+  }
+
+  std::vector<uint8_t> buffer(pSize);
+  if (!pDebug.read(&buffer[0], 0, pSize))
+    return false;
+  m_CRC = digest::crc32(m_Config.threads(), &buffer[0], pSize);
+  return true;
+}
+
@@ -0,0 +1,267 @@
+//===- SmallDataOrdering.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/SmallDataOrdering.h>
+
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/FGNode.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentGraph.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/NamePool.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/Path.h>
+
+#include <llvm/Support/Casting.h>
+
+#include <algorithm>
+
+using namespace mcld;
+
+namespace {
+
+/// the output sections of the small data
+const char* g_SmallDataSections[] = { ".sdata", ".sbss" };
+
+/// ObjectCompare - the object of more accesses per byte is placed first. The
+/// objects of the same density are placed from the smallest up.
+struct ObjectCompare
+{
+  ObjectCompare(const std::vector<uint64_t>& pSizes,
+                const std::vector<uint64_t>& pCounts)
+    : sizes(pSizes), counts(pCounts) {
+  }
+
+  bool operator()(size_t pX, size_t pY) const
+  {
+    // an empty object counts a byte, so every density is defined
+    double x = (double)counts[pX] / (double)std::max(sizes[pX], (uint64_t)1);
+    double y = (double)counts[pY] / (double)std::max(sizes[pY], (uint64_t)1);
+    if (x != y)
+      return x > y;
+    return sizes[pX] < sizes[pY];
+  }
+
+  const std::vector<uint64_t>& sizes;
+  const std::vector<uint64_t>& counts;
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// SmallDataOrdering
+//===----------------------------------------------------------------------===//
+SmallDataOrdering::SmallDataOrdering(const LinkerConfig& pConfig,
+                                     Module& pModule)
+  : m_Config(pConfig), m_Module(pModule) {
+}
+
+SmallDataOrdering::~SmallDataOrdering()
+{
+}
+
+bool SmallDataOrdering::readProfile(const sys::fs::Path& pPath)
+{
+  FileHandle file;
+  if (!file.open(pPath, FileHandle::ReadOnly))
+    return false;
+
+  std::string content(file.size(), '\0');
+  bool result = content.empty() ||
+                file.read(&content[0], 0, content.size());
+  file.close();
+
+  if (result)
+    parseProfile(content);
+  return result;
+}
+
+void SmallDataOrdering::parseProfile(llvm::StringRef pContent)
+{
+  while (!pContent.empty()) {
+    std::pair<llvm::StringRef, llvm::StringRef> line = pContent.split('\n');
+    llvm::StringRef rest = line.first.trim();
+    pContent = line.second;
+    if (rest.empty())
+      continue;
+
+    // symbol count
+    std::pair<llvm::StringRef, llvm::StringRef> field = rest.split(' ');
+    llvm::StringRef count = field.second.trim();
+
+    ProfileEntry entry;
+    if (field.first.empty() || count.empty() ||
+        llvm::StringRef::npos != count.find(' ') ||
+        count.getAsInteger(10, entry.count)) {
+      warning(diag::warn_small_data_profile_malformed_line)
+        << line.first.trim();
+      continue;
+    }
+    entry.symbol = field.first.str();
+    m_Profile.push_back(entry);
+  }
+}
+
+void SmallDataOrdering::run()
+{
+  FragmentGraph graph;
+  if (!graph.construct(m_Config, m_Module))
+    return;
+
+  size_t num = sizeof(g_SmallDataSections) / sizeof(g_SmallDataSections[0]);
+  for (size_t i = 0; i < num; ++i) {
+    LDSection* sect = m_Module.getSection(g_SmallDataSections[i]);
+    if (NULL != sect && sect->hasSectionData())
+      collectObjects(graph, *sect);
+  }
+
+  if (m_Objects.size() < 2)
+    return;
+
+  if (m_Profile.empty())
+    countRelocations(graph);
+  else
+    countProfile(graph);
+
+  std::vector<uint64_t> sizes, counts;
+  sizes.reserve(m_Objects.size());
+  counts.reserve(m_Objects.size());
+  ObjectListTy::const_iterator obj, oEnd = m_Objects.end();
+  for (obj = m_Objects.begin(); obj != oEnd; ++obj) {
+    sizes.push_back(obj->size);
+    counts.push_back(obj->count);
+  }
+
+  std::vector<size_t> order;
+  Sort(sizes, counts, order);
+  reorder(order);
+}
+
+void SmallDataOrdering::Sort(const std::vector<uint64_t>& pSizes,
+                             const std::vector<uint64_t>& pCounts,
+                             std::vector<size_t>& pOrder)
+{
+  pOrder.clear();
+  pOrder.reserve(pSizes.size());
+  for (size_t i = 0; i < pSizes.size(); ++i)
+    pOrder.push_back(i);
+  std::stable_sort(pOrder.begin(), pOrder.end(),
+                   ObjectCompare(pSizes, pCounts));
+}
+
+void SmallDataOrdering::collectObjects(FragmentGraph& pGraph,
+                                       LDSection& pSection)
+{
+  // the fragments of a regular node are consecutive in the section
+  FGNode* last = NULL;
+  SectionData::iterator frag, fragEnd = pSection.getSectionData()->end();
+  for (frag = pSection.getSectionData()->begin(); frag != fragEnd; ++frag) {
+    FGNode* node = pGraph.getNode(*frag);
+    assert(NULL != node);
+    if (node != last) {
+      Object obj = { node, &pSection, 0x0, 0x0 };
+      m_ObjectMap[node] = m_Objects.size();
+      m_Objects.push_back(obj);
+      last = node;
+    }
+    // the size of an alignment depends on the offset, which is changed
+    if (Fragment::Alignment != frag->getKind())
+      m_Objects.back().size += frag->size();
+  }
+}
+
+size_t SmallDataOrdering::getObject(const FragmentGraph& pGraph,
+                                    const ResolveInfo* pSym) const
+{
+  if (NULL == pSym || !pSym->isDefine() || NULL == pSym->outSymbol() ||
+      !pSym->outSymbol()->hasFragRef() ||
+      NULL == pSym->outSymbol()->fragRef()->frag())
+    return NoObject;
+
+  const FGNode* node = pGraph.getNode(*pSym->outSymbol()->fragRef()->frag());
+  ObjectMapTy::const_iterator obj = m_ObjectMap.find(node);
+  if (m_ObjectMap.end() == obj)
+    return NoObject;
+  return obj->second;
+}
+
+void SmallDataOrdering::countRelocations(const FragmentGraph& pGraph)
+{
+  Module::obj_iterator input, inEnd = m_Module.obj_end();
+  for (input = m_Module.obj_begin(); input != inEnd; ++input) {
+    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        size_t obj = getObject(pGraph, relocation->symInfo());
+        if (NoObject != obj)
+          ++m_Objects[obj].count;
+      }
+    }
+  }
+}
+
+void SmallDataOrdering::countProfile(const FragmentGraph& pGraph)
+{
+  ProfileListTy::const_iterator entry, eEnd = m_Profile.end();
+  for (entry = m_Profile.begin(); entry != eEnd; ++entry) {
+    const ResolveInfo* info = m_Module.getNamePool().findInfo(entry->symbol);
+    size_t obj = getObject(pGraph, info);
+    if (NoObject == obj) {
+      warning(diag::warn_small_data_profile_no_such_symbol) << entry->symbol;
+      continue;
+    }
+    m_Objects[obj].count += entry->count;
+  }
+}
+
+void SmallDataOrdering::reorder(const std::vector<size_t>& pOrder)
+{
+  // move the fragments of every object to the end of its section. After all
+  // objects are moved, the sections are in the new order.
+  std::vector<size_t>::const_iterator it, itEnd = pOrder.end();
+  for (it = pOrder.begin(); it != itEnd; ++it) {
+    Object& obj = m_Objects[*it];
+    SectionData::FragmentListType& frag_list =
+      obj.section->getSectionData()->getFragmentList();
+    FGNode::frag_iterator frag, fragEnd = obj.node->frag_end();
+    for (frag = obj.node->frag_begin(); frag != fragEnd; ++frag)
+      frag_list.splice(frag_list.end(), frag_list,
+                       SectionData::iterator(*frag));
+  }
+
+  // reset the offsets of the fragments and the sizes of the sections
+  size_t num = sizeof(g_SmallDataSections) / sizeof(g_SmallDataSections[0]);
+  for (size_t i = 0; i < num; ++i) {
+    LDSection* sect = m_Module.getSection(g_SmallDataSections[i]);
+    if (NULL == sect || !sect->hasSectionData())
+      continue;
+
+    uint64_t offset = 0x0;
+    SectionData::iterator frag, fragEnd = sect->getSectionData()->end();
+    for (frag = sect->getSectionData()->begin(); frag != fragEnd; ++frag) {
+      frag->setOffset(offset);
+      offset += frag->size();
+    }
+    sect->setSize(offset);
+  }
+}
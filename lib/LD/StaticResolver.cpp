@@ -14,6 +14,23 @@ using namespace mcld;
 
 //==========================
 // StaticResolver
+
+// The ordinates are indexed by ResolveInfo::resolveClass(), whose bits are
+// Local|Desc(2)|Dyn|Weak. A symbol with both Local and Weak bits is absolute,
+// which is resolved as a definition. Local symbols are resolved as global
+// ones otherwise.
+const unsigned char StaticResolver::OrdinateTable[] =
+{
+  /* U    */ U_ORD,  w_U_ORD, d_U_ORD, wd_U_ORD,
+  /* D    */ D_ORD,  w_D_ORD, d_D_ORD, wd_D_ORD,
+  /* C    */ C_ORD,  w_C_ORD, Cs_ORD,  Cs_ORD,
+  /* I    */ Is_ORD, Is_ORD,  Is_ORD,  Is_ORD,
+  /* l_U  */ U_ORD,  D_ORD,   d_U_ORD, d_D_ORD,
+  /* l_D  */ D_ORD,  D_ORD,   d_D_ORD, d_D_ORD,
+  /* l_C  */ C_ORD,  D_ORD,   Cs_ORD,  d_D_ORD,
+  /* l_I  */ Is_ORD, D_ORD,   Is_ORD,  d_D_ORD
+};
+
 StaticResolver::~StaticResolver()
 {
 }
@@ -77,6 +94,13 @@ bool StaticResolver::resolve(ResolveInfo& __restrict__ pOld,
         return false;
       }
       case NOACT: {      /* no action.  */
+        // of two definitions of the same kind, the first one in the order
+        // of the inputs wins, whichever of them is resolved first
+        if (row == col && !pNew.isUndef() && pNew.ordinal() < old->ordinal()) {
+          pOverride = true;
+          old->override(pNew);
+          break;
+        }
         pOverride = false;
         old->overrideVisibility(pNew);
         break;
@@ -0,0 +1,162 @@
+//===- StringTable.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/StringTable.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+typedef llvm::StringMapEntry<uint64_t> StringEntry;
+
+/// ReverseLess - compare two strings by their reversed bytes. A string sorts
+/// before the strings it is a suffix of.
+struct ReverseLess
+{
+  bool operator()(const StringEntry* pX, const StringEntry* pY) const {
+    llvm::StringRef x = pX->getKey();
+    llvm::StringRef y = pY->getKey();
+    size_t x_idx = x.size(), y_idx = y.size();
+    while (0 != x_idx && 0 != y_idx) {
+      unsigned char x_char = x[--x_idx];
+      unsigned char y_char = y[--y_idx];
+      if (x_char != y_char)
+        return x_char < y_char;
+    }
+    return x_idx < y_idx;
+  }
+};
+
+/// HeadEmitter - the body of parallel_for to write the i-th head string
+struct HeadEmitter
+{
+  const std::vector<const StringEntry*>* heads;
+  char* buffer;
+
+  void operator()(size_t pIdx) {
+    const StringEntry& entry = *(*heads)[pIdx];
+    llvm::StringRef str = entry.getKey();
+    memcpy(buffer + entry.getValue(), str.data(), str.size());
+    buffer[entry.getValue() + str.size()] = '\0';
+  }
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// StringTable
+//===----------------------------------------------------------------------===//
+StringTable::StringTable()
+  : m_Size(1), m_bFinalized(false) {
+}
+
+StringTable::~StringTable()
+{
+}
+
+void StringTable::add(llvm::StringRef pString)
+{
+  // the empty string is the null character at offset 0
+  if (pString.empty())
+    return;
+
+  StringMapType::iterator entry = m_Strings.find(pString);
+  if (m_Strings.end() != entry)
+    return;
+
+  if (!m_bFinalized) {
+    m_Strings[pString] = 0;
+    return;
+  }
+
+  // a late string is appended without sharing, so the offsets assigned
+  // before are not changed
+  m_Strings[pString] = m_Size;
+  m_Heads.push_back(&*m_Strings.find(pString));
+  m_Size += pString.size() + 1;
+}
+
+void StringTable::finalize(ThreadPool& pPool)
+{
+  std::vector<StringEntry*> entries;
+  entries.reserve(m_Strings.size());
+  StringMapType::iterator entry, eEnd = m_Strings.end();
+  for (entry = m_Strings.begin(); entry != eEnd; ++entry)
+    entries.push_back(&*entry);
+
+  // the keys are unique, so the order does not depend on the hash order
+  parallel_sort(pPool, entries.begin(), entries.end(), ReverseLess());
+
+  // from the last one down, a string is either a suffix of the previous
+  // (longer) string or starts a new string in the table
+  m_Size = 1;
+  m_Heads.clear();
+  llvm::StringRef prev;
+  uint64_t prev_offset = 0;
+  std::vector<StringEntry*>::reverse_iterator it, itEnd = entries.rend();
+  for (it = entries.rbegin(); it != itEnd; ++it) {
+    llvm::StringRef str = (*it)->getKey();
+    if (prev.endswith(str)) {
+      (*it)->setValue(prev_offset + prev.size() - str.size());
+      continue;
+    }
+    (*it)->setValue(m_Size);
+    m_Heads.push_back(*it);
+    prev = str;
+    prev_offset = m_Size;
+    m_Size += str.size() + 1;
+  }
+  m_bFinalized = true;
+}
+
+uint64_t StringTable::getOffset(llvm::StringRef pString) const
+{
+  if (pString.empty())
+    return 0;
+
+  StringMapType::const_iterator entry = m_Strings.find(pString);
+  assert(m_Strings.end() != entry && "the string is not in the table");
+  assert(m_bFinalized && "the offsets are not assigned");
+  if (m_Strings.end() == entry)
+    return 0;
+  return entry->getValue();
+}
+
+void StringTable::emit(char* pBuffer) const
+{
+  assert(m_bFinalized && "the offsets are not assigned");
+
+  // a shared tail is written by the string that owns it
+  pBuffer[0] = '\0';
+  HeadEmitter emitter = { &m_Heads, pBuffer };
+  for (size_t i = 0; i < m_Heads.size(); ++i)
+    emitter(i);
+}
+
+void StringTable::emit(char* pBuffer, ThreadPool& pPool) const
+{
+  assert(m_bFinalized && "the offsets are not assigned");
+
+  pBuffer[0] = '\0';
+  HeadEmitter emitter = { &m_Heads, pBuffer };
+  parallel_for(pPool, 0, m_Heads.size(), emitter, 1024);
+}
+
+void StringTable::clear()
+{
+  m_Strings.clear();
+  m_Heads.clear();
+  m_Size = 1;
+  m_bFinalized = false;
+}
+
@@ -15,6 +15,7 @@
 #include <mcld/Fragment/Stub.h>
 #include <mcld/Fragment/Relocation.h>
 #include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Support/LinkStats.h>
 
 #include <string>
 
@@ -40,29 +41,33 @@ void StubFactory::addPrototype(Stub* pPrototype)
 Stub* StubFactory::create(Relocation& pReloc,
                           uint64_t pTargetSymValue,
                           IRBuilder& pBuilder,
-                          BranchIslandFactory& pBRIslandFactory)
+                          BranchIslandFactory& pBRIslandFactory,
+                          uint64_t pBranchRange)
 {
   // find if there is a prototype stub for the input relocation
   Stub* prototype = findPrototype(pReloc,
                                   pReloc.place(),
                                   pTargetSymValue);
   if (NULL != prototype) {
-    // find the island for the input relocation
-    BranchIsland* island = pBRIslandFactory.find(*(pReloc.targetRef().frag()));
-    if (NULL == island) {
-      island = pBRIslandFactory.produce(*(pReloc.targetRef().frag()));
-    }
-
-    // find if there is such a stub in the island already
-    assert(NULL != island);
-    Stub* stub = island->findStub(prototype, pReloc);
+    // find if there is such a stub in any island within the range already
+    Stub* stub = pBRIslandFactory.findStub(prototype, pReloc, pBranchRange);
     if (NULL != stub) {
       // reset the branch target to the stub instead!
       pReloc.setSymInfo(stub->symInfo());
     }
     else {
+      // find the island for the input relocation
+      BranchIsland* island =
+        pBRIslandFactory.find(*(pReloc.targetRef().frag()));
+      if (NULL == island) {
+        island = pBRIslandFactory.produce(*(pReloc.targetRef().frag()));
+      }
+      assert(NULL != island);
+
       // create a stub from the prototype
       stub = prototype->clone();
+      if (LinkStats::isEnabled())
+        LinkStats::Add(LinkStats::Stubs);
 
       // build a name for stub symbol
       std::string name("__");
@@ -0,0 +1,125 @@
+//===- SymbolOrdering.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/SymbolOrdering.h>
+
+#include <mcld/Module.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/Path.h>
+
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// SymbolOrdering
+//===----------------------------------------------------------------------===//
+SymbolOrdering::SymbolOrdering()
+{
+}
+
+SymbolOrdering::~SymbolOrdering()
+{
+}
+
+bool SymbolOrdering::read(const sys::fs::Path& pPath)
+{
+  FileHandle file;
+  if (!file.open(pPath, FileHandle::ReadOnly))
+    return false;
+
+  std::string content(file.size(), '\0');
+  bool result = content.empty() ||
+                file.read(&content[0], 0, content.size());
+  file.close();
+
+  if (result)
+    parse(content);
+  return result;
+}
+
+void SymbolOrdering::parse(llvm::StringRef pContent)
+{
+  while (!pContent.empty()) {
+    std::pair<llvm::StringRef, llvm::StringRef> line = pContent.split('\n');
+    llvm::StringRef name = line.first.trim();
+    pContent = line.second;
+
+    // the first line of a name gives its priority
+    if (!name.empty() && m_SymbolMap.end() == m_SymbolMap.find(name)) {
+      size_t priority = m_SymbolMap.size();
+      m_SymbolMap[name] = priority;
+    }
+  }
+}
+
+void SymbolOrdering::computeSectionPriorities(const Module& pModule)
+{
+  std::vector<bool> found(m_SymbolMap.size(), false);
+
+  Module::const_obj_iterator obj, objEnd = pModule.obj_end();
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    const LDContext* context = (*obj)->context();
+    LDContext::const_sym_iterator sym, symEnd = context->symTabEnd();
+    for (sym = context->symTabBegin(); sym != symEnd; ++sym) {
+      if (NULL == *sym || !(*sym)->hasFragRef())
+        continue;
+
+      size_t priority = getPriority(llvm::StringRef((*sym)->name(),
+                                                    (*sym)->nameSize()));
+      if (NotOrdered == priority)
+        continue;
+      found[priority] = true;
+
+      // an overridden symbol refers to the fragment of its definition, so
+      // the section is always the defining one
+      const SectionData* data = (*sym)->fragRef()->frag()->getParent();
+      if (NULL == data)
+        continue;
+
+      const LDSection* sect = &data->getSection();
+      SectionMapType::iterator entry = m_SectionMap.find(sect);
+      if (m_SectionMap.end() == entry)
+        m_SectionMap[sect] = priority;
+      else if (priority < entry->second)
+        entry->second = priority;
+    }
+  }
+
+  SymbolMapType::const_iterator entry, eEnd = m_SymbolMap.end();
+  for (entry = m_SymbolMap.begin(); entry != eEnd; ++entry) {
+    if (!found[entry->getValue()])
+      warning(diag::warn_symbol_ordering_no_such_symbol) << entry->getKey();
+  }
+}
+
+size_t SymbolOrdering::getPriority(llvm::StringRef pName) const
+{
+  SymbolMapType::const_iterator entry = m_SymbolMap.find(pName);
+  if (m_SymbolMap.end() == entry)
+    return NotOrdered;
+  return entry->getValue();
+}
+
+size_t SymbolOrdering::getPriority(const LDSection& pSection) const
+{
+  SectionMapType::const_iterator entry = m_SectionMap.find(&pSection);
+  if (m_SectionMap.end() == entry)
+    return NotOrdered;
+  return entry->second;
+}
+
@@ -156,6 +156,23 @@ TextDiagnosticPrinter::handleDiagnostic(DiagnosticEngine::Severity pSeverity,
   }
 }
 
+bool
+TextDiagnosticPrinter::isIgnored(DiagnosticEngine::Severity pSeverity) const
+{
+  switch (pSeverity) {
+    case DiagnosticEngine::Debug:
+      return (m_Config.options().verbose() < 0);
+    case DiagnosticEngine::Note:
+      return (m_Config.options().verbose() < 1);
+    case DiagnosticEngine::Ignore:
+      return (m_Config.options().verbose() < 2);
+    case DiagnosticEngine::None:
+      return true;
+    default:
+      return false;
+  }
+}
+
 void TextDiagnosticPrinter::beginInput(const Input& pInput, const LinkerConfig& pConfig)
 {
   m_pInput = &pInput;
@@ -8,6 +8,7 @@ mcld_mc_SRC_FILES := \
   FileAction.cpp  \
   InputAction.cpp  \
   InputBuilder.cpp  \
+  InputCost.cpp  \
   InputFactory.cpp  \
   MCLDDirectory.cpp \
   MCLDInput.cpp \
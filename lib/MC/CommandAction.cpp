@@ -74,13 +74,29 @@ bool NamespecAction::activate(InputBuilder& pBuilder) const
 //===----------------------------------------------------------------------===//
 // BitcodeAction
 //===----------------------------------------------------------------------===//
-BitcodeAction::BitcodeAction(unsigned int pPosition, const sys::fs::Path &pPath)
-  : InputAction(pPosition), m_Path(pPath) {
+BitcodeAction::BitcodeAction(unsigned int pPosition,
+                             const BitcodeOption& pBitcode)
+  : InputAction(pPosition), m_Bitcode(pBitcode) {
 }
 
 bool BitcodeAction::activate(InputBuilder& pBuilder) const
 {
-  pBuilder.createNode<InputTree::Positional>("bitcode", path(), Input::External);
+  if (!m_Bitcode.hasObjects()) {
+    pBuilder.createNode<InputTree::Positional>("bitcode", path(),
+                                               Input::External);
+    return true;
+  }
+
+  // the bitcode was compiled into objects in the memory. Link them in its
+  // place.
+  BitcodeOption::ObjectList::const_iterator obj,
+                                            objEnd = m_Bitcode.objects().end();
+  for (obj = m_Bitcode.objects().begin(); obj != objEnd; ++obj) {
+    pBuilder.createNode<InputTree::Positional>("bitcode", path());
+    Input* input = *pBuilder.getCurrentNode();
+    pBuilder.setContext(*input, false);
+    pBuilder.setMemory(*input, obj->first, obj->second);
+  }
   return true;
 }
 
@@ -20,13 +20,24 @@ using namespace mcld;
 InputBuilder::InputBuilder(const LinkerConfig& pConfig)
   : m_Config(pConfig),
     m_pCurrentTree(NULL), m_pMove(NULL), m_Root(),
-    m_bOwnFactory(true) {
+    m_bOwnFactory(true), m_bOwnMemFactory(true) {
 
     m_pInputFactory = new InputFactory(MCLD_NUM_OF_INPUTS, pConfig);
     m_pContextFactory = new ContextFactory(MCLD_NUM_OF_INPUTS);
     m_pMemFactory = new MemoryAreaFactory(MCLD_NUM_OF_INPUTS);
 }
 
+InputBuilder::InputBuilder(const LinkerConfig& pConfig,
+                           MemoryAreaFactory& pMemoryFactory)
+  : m_Config(pConfig),
+    m_pMemFactory(&pMemoryFactory),
+    m_pCurrentTree(NULL), m_pMove(NULL), m_Root(),
+    m_bOwnFactory(true), m_bOwnMemFactory(false) {
+
+    m_pInputFactory = new InputFactory(MCLD_NUM_OF_INPUTS, pConfig);
+    m_pContextFactory = new ContextFactory(MCLD_NUM_OF_INPUTS);
+}
+
 InputBuilder::InputBuilder(const LinkerConfig& pConfig,
                            InputFactory& pInputFactory,
                            ContextFactory& pContextFactory,
@@ -37,7 +48,7 @@ InputBuilder::InputBuilder(const LinkerConfig& pConfig,
     m_pMemFactory(&pMemoryFactory),
     m_pContextFactory(&pContextFactory),
     m_pCurrentTree(NULL), m_pMove(NULL), m_Root(),
-    m_bOwnFactory(pDelegate) {
+    m_bOwnFactory(pDelegate), m_bOwnMemFactory(pDelegate) {
 
 }
 
@@ -46,8 +57,9 @@ InputBuilder::~InputBuilder()
   if (m_bOwnFactory) {
     delete m_pInputFactory;
     delete m_pContextFactory;
-    delete m_pMemFactory;
   }
+  if (m_bOwnMemFactory)
+    delete m_pMemFactory;
 }
 
 Input* InputBuilder::createInput(const std::string& pName,
@@ -135,6 +147,11 @@ bool InputBuilder::setMemory(Input& pInput,
   if (!memory->handler()->isGood())
     return false;
 
+  // serve all regions of a read-only input from one mapping. If the file can
+  // not be mapped at once, e.g., a pipe, MemoryArea reads it piece by piece.
+  if (FileHandle::ReadOnly == pMode && m_Config.options().mapWholeFile())
+    memory->mapWholeFile();
+
   pInput.setMemArea(memory);
   return true;
 }
@@ -146,6 +163,13 @@ bool InputBuilder::setMemory(Input& pInput, void* pMemBuffer, size_t pSize)
   return true;
 }
 
+void InputBuilder::openMemory(ThreadPool& pPool,
+                              const std::vector<sys::fs::Path>& pPaths,
+                              FileHandle::OpenMode pMode)
+{
+  m_pMemFactory->open(pPool, pPaths, pMode);
+}
+
 const AttrConstraint& InputBuilder::getConstraint() const
 {
   return m_Config.attribute().constraint();
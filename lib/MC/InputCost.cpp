@@ -0,0 +1,49 @@
+//===- InputCost.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/MC/InputCost.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/SystemUtils.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// InputCost
+//===----------------------------------------------------------------------===//
+InputCost::InputCost()
+  : mappedBytes(0), sections(0), symbols(0), relocations(0), outputBytes(0) {
+  for (unsigned int i = 0; i < NumOfPhases; ++i)
+    time[i] = 0;
+}
+
+const char* InputCost::name(Phase pPhase)
+{
+  switch (pPhase) {
+    case Parse: return "parse";
+    case Scan:  return "scan";
+    case Apply: return "apply";
+    case Emit:  return "emit";
+    default:    return "unknown";
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// InputCostScope
+//===----------------------------------------------------------------------===//
+InputCostScope::InputCostScope(Input& pInput, InputCost::Phase pPhase)
+  : m_pCost(pInput.cost()), m_Phase(pPhase), m_Begin(0) {
+  if (NULL != m_pCost)
+    m_Begin = sys::GetTimeInMicroseconds();
+}
+
+InputCostScope::~InputCostScope()
+{
+  if (NULL != m_pCost)
+    m_pCost->time[m_Phase] += sys::GetTimeInMicroseconds() - m_Begin;
+}
+
@@ -101,3 +101,20 @@ void MCLDDirectory::setSysroot(const sys::fs::Path& pSysroot)
   }
 }
 
+sys::fs::Path* MCLDDirectory::find(const std::string& pFileName)
+{
+  if (isGood() && !Directory::m_CacheFull) {
+    // read all the left entries into the cache
+    iterator entry = begin(), enEnd = end();
+    while (entry != enEnd)
+      ++entry;
+  }
+
+  std::string path(Directory::m_Path.native());
+  path += pFileName;
+  PathCache::iterator entry = Directory::m_Cache.find(path);
+  if (Directory::m_Cache.end() == entry)
+    return NULL;
+  return &entry.getEntry()->value();
+}
+
@@ -8,8 +8,14 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/MC/MCLDInput.h>
 #include <mcld/MC/Attribute.h>
+#include <mcld/MC/InputCost.h>
 #include <mcld/LD/LDContext.h>
+#include <mcld/Support/FileHandle.h>
 #include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/Space.h>
+
+#include <algorithm>
+#include <cstring>
 
 using namespace mcld;
 
@@ -22,9 +28,15 @@ Input::Input(llvm::StringRef pName)
     m_Path(),
     m_pAttr(NULL),
     m_bNeeded(false),
+    m_bNoExport(false),
     m_fileOffset(0),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pCost(NULL),
+    m_Ordinal(NoOrdinal),
+    m_Home(NoHome),
+    m_ProbeSize(0),
+    m_bProbed(false) {
 }
 
 Input::Input(llvm::StringRef pName, const AttributeProxy& pProxy)
@@ -33,9 +45,15 @@ Input::Input(llvm::StringRef pName, const AttributeProxy& pProxy)
     m_Path(),
     m_pAttr(const_cast<Attribute*>(pProxy.attr())),
     m_bNeeded(false),
+    m_bNoExport(false),
     m_fileOffset(0),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pCost(NULL),
+    m_Ordinal(NoOrdinal),
+    m_Home(NoHome),
+    m_ProbeSize(0),
+    m_bProbed(false) {
 }
 
 Input::Input(llvm::StringRef pName,
@@ -47,9 +65,15 @@ Input::Input(llvm::StringRef pName,
     m_Path(pPath),
     m_pAttr(NULL),
     m_bNeeded(false),
+    m_bNoExport(false),
     m_fileOffset(pFileOffset),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pCost(NULL),
+    m_Ordinal(NoOrdinal),
+    m_Home(NoHome),
+    m_ProbeSize(0),
+    m_bProbed(false) {
 }
 
 Input::Input(llvm::StringRef pName,
@@ -62,9 +86,15 @@ Input::Input(llvm::StringRef pName,
     m_Path(pPath),
     m_pAttr(const_cast<Attribute*>(pProxy.attr())),
     m_bNeeded(false),
+    m_bNoExport(false),
     m_fileOffset(pFileOffset),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pCost(NULL),
+    m_Ordinal(NoOrdinal),
+    m_Home(NoHome),
+    m_ProbeSize(0),
+    m_bProbed(false) {
 }
 
 Input::~Input()
@@ -73,5 +103,53 @@ Input::~Input()
   // MemoryArea is deleted by MemoryAreaFactory
   if (NULL != m_pMemArea)
     m_pMemArea->clear();
+  delete m_pCost;
+}
+
+void Input::setCost(InputCost* pCost)
+{
+  delete m_pCost;
+  m_pCost = pCost;
+}
+
+
+const uint8_t* Input::probe()
+{
+  if (m_bProbed)
+    return m_Probe;
+
+  m_bProbed = true;
+  m_ProbeSize = 0;
+  memset(m_Probe, 0, ProbeSize);
+  if (NULL == m_pMemArea)
+    return m_Probe;
+
+  // an input from the memory ends at the end of its universal space
+  size_t offset = m_fileOffset;
+  size_t file_size = m_pMemArea->size();
+  size_t size = ProbeSize;
+  size = (offset < file_size) ? std::min(size, file_size - offset) : 0;
+  if (0 == size)
+    return m_Probe;
+
+  // The header is usually in a space already, preloaded or mapped as the
+  // whole file. Otherwise, read it by one system call without creating any
+  // space or region.
+  Space* space = m_pMemArea->find(offset, size);
+
+  if (NULL != space) {
+    memcpy(m_Probe, space->memory() + (offset - space->start()), size);
+    m_ProbeSize = size;
+  }
+  else if (m_pMemArea->hasHandler() &&
+           m_pMemArea->handler()->read(m_Probe, offset, size)) {
+    m_ProbeSize = size;
+  }
+  return m_Probe;
 }
 
+size_t Input::probeSize()
+{
+  probe();
+  return m_ProbeSize;
+}
@@ -52,7 +52,9 @@ bool SearchDirs::insert(const std::string& pPath)
   if (dir->isInSysroot())
     dir->setSysroot(m_SysRoot);
 
-  if (exists(dir->path()) && is_directory(dir->path())) {
+  sys::fs::FileStatus status;
+  sys::fs::cached::status(dir->path(), status);
+  if (is_directory(status)) {
     m_DirList.push_back(dir);
     return true;
   }
@@ -79,83 +81,34 @@ mcld::sys::fs::Path* SearchDirs::find(const std::string& pNamespec, mcld::Input:
 
   std::string file;
   SpecToFilename(pNamespec, file);
-  // for all MCLDDirectorys
+
+  std::string shared_file, static_file;
+  if (Input::DynObj == pType) {
+    shared_file = file;
+    shared_file += mcld::sys::fs::detail::shared_library_extension;
+  }
+  static_file = file;
+  static_file += mcld::sys::fs::detail::static_library_extension;
+
+  // for all MCLDDirectorys, prefer the shared object in the same directory
   DirList::iterator mcld_dir, mcld_dir_end = m_DirList.end();
   for (mcld_dir=m_DirList.begin(); mcld_dir!=mcld_dir_end; ++mcld_dir) {
-    // for all entries in MCLDDirectory
-    MCLDDirectory::iterator entry = (*mcld_dir)->begin();
-    MCLDDirectory::iterator enEnd = (*mcld_dir)->end();
-
-    switch(pType) {
-      case Input::DynObj: {
-        while (entry!=enEnd) {
-          if (file == entry.path()->stem().native() ) {
-            if(mcld::sys::fs::detail::shared_library_extension == entry.path()->extension().native()) {
-              return entry.path();
-            }
-          }
-          ++entry;
-        }
-      }
-      /** Fall through **/
-      case Input::Archive : {
-        entry = (*mcld_dir)->begin();
-        enEnd = (*mcld_dir)->end();
-        while ( entry!=enEnd ) {
-          if (file == entry.path()->stem().native() &&
-            mcld::sys::fs::detail::static_library_extension == entry.path()->extension().native()) {
-            return entry.path();
-          }
-          ++entry;
-        }
-      }
-      default:
-        break;
-    } // end of switch
-  } // end of while
+    mcld::sys::fs::Path* path = NULL;
+    if (Input::DynObj == pType) {
+      path = (*mcld_dir)->find(shared_file);
+      if (NULL != path)
+        return path;
+    }
+    path = (*mcld_dir)->find(static_file);
+    if (NULL != path)
+      return path;
+  } // end of for
   return NULL;
 }
 
 const mcld::sys::fs::Path*
 SearchDirs::find(const std::string& pNamespec, mcld::Input::Type pType) const
 {
-  assert(Input::DynObj == pType || Input::Archive == pType);
-
-  std::string file;
-  SpecToFilename(pNamespec, file);
-  // for all MCLDDirectorys
-  DirList::const_iterator mcld_dir, mcld_dir_end = m_DirList.end();
-  for (mcld_dir=m_DirList.begin(); mcld_dir!=mcld_dir_end; ++mcld_dir) {
-    // for all entries in MCLDDirectory
-    MCLDDirectory::iterator entry = (*mcld_dir)->begin();
-    MCLDDirectory::iterator enEnd = (*mcld_dir)->end();
-
-    switch(pType) {
-      case Input::DynObj: {
-        while (entry!=enEnd) {
-          if (file == entry.path()->stem().native() ) {
-            if(mcld::sys::fs::detail::shared_library_extension == entry.path()->extension().native()) {
-              return entry.path();
-            }
-          }
-          ++entry;
-        }
-      }
-      /** Fall through **/
-      case Input::Archive : {
-        entry = (*mcld_dir)->begin();
-        enEnd = (*mcld_dir)->end();
-        while ( entry!=enEnd ) {
-          if (file == entry.path()->stem().native() &&
-            mcld::sys::fs::detail::static_library_extension == entry.path()->extension().native()) {
-            return entry.path();
-          }
-          ++entry;
-        }
-      }
-      default:
-        break;
-    } // end of switch
-  } // end of while
-  return NULL;
+  // looking up a directory only fills its cache
+  return const_cast<SearchDirs*>(this)->find(pNamespec, pType);
 }
@@ -9,6 +9,7 @@
 #include <mcld/MC/SymbolCategory.h>
 #include <mcld/LD/LDSymbol.h>
 #include <mcld/LD/ResolveInfo.h>
+#include <mcld/Support/ThreadPool.h>
 #include <algorithm>
 #include <cassert>
 
@@ -31,9 +32,28 @@ SymbolCategory::Category::categorize(const ResolveInfo& pInfo)
   return Category::Regular;
 }
 
+//===----------------------------------------------------------------------===//
+// Categorizer
+//===----------------------------------------------------------------------===//
+/// Categorizer - compute the category of every symbol for categorize()
+struct SymbolCategory::Categorizer
+{
+  const OutputSymbols* symbols;
+  const TypeList* pinned;
+  TypeList* types;
+
+  void operator()(size_t pIdx) {
+    if (NotPinned != (*pinned)[pIdx])
+      (*types)[pIdx] = (*pinned)[pIdx];
+    else
+      (*types)[pIdx] = Category::categorize(*(*symbols)[pIdx]->resolveInfo());
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // SymbolCategory
 SymbolCategory::SymbolCategory()
+  : m_bDeferred(false)
 {
   m_pFile     = new Category(Category::File);
   m_pLocal    = new Category(Category::Local);
@@ -92,11 +112,21 @@ SymbolCategory& SymbolCategory::add(LDSymbol& pSymbol, Category::Type pTarget)
 SymbolCategory& SymbolCategory::add(LDSymbol& pSymbol)
 {
   assert(NULL != pSymbol.resolveInfo());
+  if (m_bDeferred) {
+    m_OutputSymbols.push_back(&pSymbol);
+    m_Pinned.push_back(NotPinned);
+    return *this;
+  }
   return add(pSymbol, Category::categorize(*pSymbol.resolveInfo()));
 }
 
 SymbolCategory& SymbolCategory::forceLocal(LDSymbol& pSymbol)
 {
+  if (m_bDeferred) {
+    m_OutputSymbols.push_back(&pSymbol);
+    m_Pinned.push_back(Category::Local);
+    return *this;
+  }
   return add(pSymbol, Category::Local);
 }
 
@@ -104,6 +134,11 @@ SymbolCategory& SymbolCategory::arrange(LDSymbol& pSymbol,
                                         const ResolveInfo& pSourceInfo)
 {
   assert(NULL != pSymbol.resolveInfo());
+
+  // categorize() follows the current ResolveInfo
+  if (m_bDeferred)
+    return *this;
+
   Category::Type source = Category::categorize(pSourceInfo);
   Category::Type target = Category::categorize(*pSymbol.resolveInfo());
 
@@ -182,6 +217,7 @@ SymbolCategory& SymbolCategory::arrange(LDSymbol& pSymbol,
 
 SymbolCategory& SymbolCategory::changeCommonsToGlobal()
 {
+  assert(!m_bDeferred && "symbols are not categorized yet");
   // Change Common to Dynamic/Regular
   while (!emptyCommons()) {
     size_t pos = m_pCommon->end - 1;
@@ -207,6 +243,7 @@ SymbolCategory& SymbolCategory::changeCommonsToGlobal()
 
 SymbolCategory& SymbolCategory::changeLocalToDynamic(const LDSymbol& pSymbol)
 {
+  assert(!m_bDeferred && "symbols are not categorized yet");
   // find the position of pSymbol from local category
   size_t pos = m_pLocal->begin;
   while (pos != m_pLocal->end) {
@@ -226,6 +263,91 @@ SymbolCategory& SymbolCategory::changeLocalToDynamic(const LDSymbol& pSymbol)
   return *this;
 }
 
+SymbolCategory&
+SymbolCategory::removeIf(bool (*pIsRemoved)(const LDSymbol&))
+{
+  assert(!m_bDeferred && "symbols are not categorized yet");
+
+  // compact every category in place. Categories are adjacent, so a kept
+  // symbol only moves to a slot that has been visited.
+  size_t kept = 0;
+  Category* current = m_pFile;
+  while (NULL != current) {
+    size_t begin = kept;
+    for (size_t pos = current->begin; pos != current->end; ++pos) {
+      if (!pIsRemoved(*m_OutputSymbols[pos]))
+        m_OutputSymbols[kept++] = m_OutputSymbols[pos];
+    }
+    current->begin = begin;
+    current->end = kept;
+    current = current->next;
+  }
+  m_OutputSymbols.resize(kept);
+  return *this;
+}
+
+SymbolCategory& SymbolCategory::defer()
+{
+  if (m_bDeferred)
+    return *this;
+
+  // the symbols which are not in the category of their ResolveInfos, such as
+  // the forcefully local ones, keep their categories.
+  m_Pinned.assign(m_OutputSymbols.size(), NotPinned);
+  Category* current = m_pFile;
+  while (NULL != current) {
+    for (size_t pos = current->begin; pos != current->end; ++pos) {
+      const ResolveInfo& info = *m_OutputSymbols[pos]->resolveInfo();
+      if (current->type != Category::categorize(info))
+        m_Pinned[pos] = current->type;
+    }
+    current = current->next;
+  }
+  m_bDeferred = true;
+  return *this;
+}
+
+SymbolCategory& SymbolCategory::categorize(ThreadPool* pThreads)
+{
+  if (!m_bDeferred)
+    return *this;
+
+  size_t size = m_OutputSymbols.size();
+  TypeList types(size);
+  Categorizer categorizer = { &m_OutputSymbols, &m_Pinned, &types };
+  if (NULL != pThreads)
+    parallel_for(*pThreads, 0, size, categorizer, 4096);
+  else {
+    for (size_t i = 0; i < size; ++i)
+      categorizer(i);
+  }
+
+  // lay the categories out in order, and put the symbols into them stably
+  size_t counts[Category::Regular + 1] = { 0 };
+  for (size_t i = 0; i < size; ++i)
+    ++counts[types[i]];
+
+  size_t positions[Category::Regular + 1];
+  size_t offset = 0;
+  Category* current = m_pFile;
+  while (NULL != current) {
+    positions[current->type] = offset;
+    current->begin = offset;
+    offset += counts[current->type];
+    current->end = offset;
+    current = current->next;
+  }
+
+  OutputSymbols result(size);
+  for (size_t i = 0; i < size; ++i)
+    result[positions[types[i]]++] = m_OutputSymbols[i];
+  m_OutputSymbols.swap(result);
+
+  TypeList().swap(m_Pinned);
+  m_bDeferred = false;
+  return *this;
+}
+
 size_t SymbolCategory::numOfSymbols() const
 {
   return m_OutputSymbols.size();
@@ -3,7 +3,8 @@ LOCAL_PATH:= $(call my-dir)
 mcld_object_SRC_FILES := \
   ObjectBuilder.cpp \
   ObjectLinker.cpp \
-  SectionMap.cpp
+  SectionMap.cpp \
+  SectionScript.cpp
 
 # For the host
 # =====================================================
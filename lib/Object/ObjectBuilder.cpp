@@ -20,16 +20,82 @@
 #include <mcld/Fragment/AlignFragment.h>
 #include <mcld/Fragment/NullFragment.h>
 #include <mcld/Fragment/FillFragment.h>
+#include <mcld/Support/ThreadPool.h>
 
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
 
 using namespace mcld;
 
+namespace { // anonymous
+
+/// CreateAlignment - create the AlignFragment which precedes the fragments of
+/// pFrom in an output section. Return NULL if pFrom needs no alignment.
+AlignFragment* CreateAlignment(const LDSection& pFrom)
+{
+  if (pFrom.align() <= 1)
+    return NULL;
+
+  AlignFragment* align = new AlignFragment(pFrom.align(), // alignment
+                                           0x0, // the filled value
+                                           1u,  // the size of filled value
+                                           pFrom.align() - 1 // max bytes to emit
+                                           );
+  // pad the code by nops, so the CPU decodes through the gap cheaply
+  if (0x0 != (pFrom.flag() & llvm::ELF::SHF_EXECINSTR))
+    align->setEmitNops(true);
+  return align;
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// ObjectBuilder::OffsetUpdater
+//===----------------------------------------------------------------------===//
+/// OffsetUpdater - lay out the fragments of a pending output section
+struct ObjectBuilder::OffsetUpdater
+{
+  PendingList* pending;
+
+  void operator()(size_t pIdx) {
+    PendingLayout& layout = (*pending)[pIdx];
+    SectionData::iterator frag, fragEnd = layout.data->end();
+    if (NULL == layout.last)
+      frag = layout.data->begin();
+    else
+      frag = ++SectionData::iterator(layout.last);
+
+    uint64_t offset = layout.base;
+    for (; frag != fragEnd; ++frag) {
+      frag->setOffset(offset);
+      offset += frag->size();
+    }
+    layout.data->getSection().setSize(offset);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// ObjectBuilder::FragmentMover
+//===----------------------------------------------------------------------===//
+/// FragmentMover - move the fragments of the input sections of an output
+/// section
+struct ObjectBuilder::FragmentMover
+{
+  MoveList* moves;
+
+  void operator()(size_t pIdx) {
+    FragmentMove& move = (*moves)[pIdx];
+    std::vector<SectionData*>::iterator from, fromEnd = move.from.end();
+    for (from = move.from.begin(); from != fromEnd; ++from)
+      SpliceFragments(**from, *move.to);
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // ObjectBuilder
 //===----------------------------------------------------------------------===//
 ObjectBuilder::ObjectBuilder(const LinkerConfig& pConfig, Module& pTheModule)
-  : m_Config(pConfig), m_Module(pTheModule) {
+  : m_Config(pConfig), m_Module(pTheModule), m_bDeferOffsets(false) {
 }
 
 /// CreateSection - create an output section.
@@ -44,7 +110,7 @@ LDSection* ObjectBuilder::CreateSection(const std::string& pName,
   std::string output_name = (pair.isNull())?pName:pair.to;
   LDSection* output_sect = LDSection::Create(output_name, pKind, pType, pFlag);
   output_sect->setAlign(pAlign);
-  m_Module.getSectionTable().push_back(output_sect);
+  m_Module.appendSection(*output_sect);
   return output_sect;
 }
 
@@ -54,16 +120,7 @@ LDSection* ObjectBuilder::MergeSection(LDSection& pInputSection)
   const SectionMap::NamePair& pair =
               m_Config.scripts().sectionMap().find(pInputSection.name());
   std::string output_name = (pair.isNull())?pInputSection.name():pair.to;
-  LDSection* target = m_Module.getSection(output_name);
-
-  if (NULL == target) {
-    target = LDSection::Create(output_name,
-                               pInputSection.kind(),
-                               pInputSection.type(),
-                               pInputSection.flag());
-    target->setAlign(pInputSection.align());
-    m_Module.getSectionTable().push_back(target);
-  }
+  LDSection* target = getOutputSection(output_name, pInputSection);
 
   switch (target->kind()) {
     // Some *OUTPUT sections should not be merged.
@@ -89,6 +146,12 @@ LDSection* ObjectBuilder::MergeSection(LDSection& pInputSection)
       else
         data = IRBuilder::CreateSectionData(*target);
 
+      if (m_bDeferOffsets) {
+        moveFragments(*pInputSection.getSectionData(), *data);
+        UpdateSectionAlign(*target, pInputSection);
+        return target;
+      }
+
       if (MoveSectionData(*pInputSection.getSectionData(), *data)) {
         UpdateSectionAlign(*target, pInputSection);
         return target;
@@ -99,20 +162,100 @@ LDSection* ObjectBuilder::MergeSection(LDSection& pInputSection)
   return target;
 }
 
+/// MergeSections - merge the input sections in order
+bool ObjectBuilder::MergeSections(const SectionList& pInputs,
+                                  const MappingList& pMappings,
+                                  SectionList& pOutputs)
+{
+  assert(pInputs.size() == pMappings.size() && "Missing section mappings!");
+  pOutputs.resize(pInputs.size());
+
+  if (!m_bDeferOffsets) {
+    for (size_t i = 0; i < pInputs.size(); ++i) {
+      pOutputs[i] = MergeSection(*pInputs[i]);
+      if (NULL == pOutputs[i])
+        return false;
+    }
+    return true;
+  }
+
+  // find the output sections in the input order, and group the input
+  // sections by their output sections
+  MoveList moves;
+  llvm::DenseMap<const SectionData*, size_t> move_index;
+  for (size_t i = 0; i < pInputs.size(); ++i) {
+    LDSection& input = *pInputs[i];
+    const SectionMap::NamePair& pair = *pMappings[i];
+    LDSection* target =
+               getOutputSection(pair.isNull() ? input.name() : pair.to, input);
+    pOutputs[i] = target;
+
+    switch (target->kind()) {
+      case LDFileFormat::Relocation:
+      case LDFileFormat::NamePool:
+      case LDFileFormat::EhFrame:
+        // not the section data
+        if (NULL == MergeSection(input))
+          return false;
+        continue;
+      default:
+        break;
+    }
+
+    SectionData* data = NULL;
+    if (target->hasSectionData())
+      data = target->getSectionData();
+    else
+      data = IRBuilder::CreateSectionData(*target);
+
+    addPending(*data);
+    UpdateSectionAlign(*target, input);
+
+    std::pair<llvm::DenseMap<const SectionData*, size_t>::iterator, bool> res =
+      move_index.insert(std::make_pair(data, moves.size()));
+    if (res.second) {
+      moves.push_back(FragmentMove());
+      moves.back().to = data;
+    }
+    moves[res.first->second].from.push_back(input.getSectionData());
+  }
+
+  // the output sections are independent of each other
+  FragmentMover mover = { &moves };
+  if (m_Config.options().isMultiThreads())
+    parallel_for(m_Config.threads(), 0, moves.size(), mover);
+  else {
+    for (size_t i = 0; i < moves.size(); ++i)
+      mover(i);
+  }
+  return true;
+}
+
+/// getOutputSection - get or create the output section pName
+LDSection* ObjectBuilder::getOutputSection(const std::string& pName,
+                                           const LDSection& pInputSection)
+{
+  LDSection* target = m_Module.getSection(pName);
+  if (NULL == target) {
+    target = LDSection::Create(pName,
+                               pInputSection.kind(),
+                               pInputSection.type(),
+                               pInputSection.flag());
+    target->setAlign(pInputSection.align());
+    m_Module.appendSection(*target);
+  }
+  return target;
+}
+
 /// MoveSectionData - move the fragments of pTO section data to pTo
 bool ObjectBuilder::MoveSectionData(SectionData& pFrom, SectionData& pTo)
 {
   assert(&pFrom != &pTo && "Cannot move section data to itself!");
 
   uint32_t offset = pTo.getSection().size();
-  AlignFragment* align = NULL;
-  if (pFrom.getSection().align() > 1) {
-    // if the align constraint is larger than 1, append an alignment
-    align = new AlignFragment(pFrom.getSection().align(), // alignment
-                              0x0, // the filled value
-                              1u,  // the size of filled value
-                              pFrom.getSection().align() - 1 // max bytes to emit
-                              );
+  // if the align constraint is larger than 1, append an alignment
+  AlignFragment* align = CreateAlignment(pFrom.getSection());
+  if (NULL != align) {
     align->setOffset(offset);
     align->setParent(&pTo);
     pTo.getFragmentList().push_back(align);
@@ -136,6 +279,66 @@ bool ObjectBuilder::MoveSectionData(SectionData& pFrom, SectionData& pTo)
   return true;
 }
 
+/// deferOffsets - leave the offsets of the merged fragments to updateOffsets()
+void ObjectBuilder::deferOffsets()
+{
+  m_bDeferOffsets = true;
+}
+
+/// moveFragments - move the fragments of pFrom to pTo without offsets
+void ObjectBuilder::moveFragments(SectionData& pFrom, SectionData& pTo)
+{
+  addPending(pTo);
+  SpliceFragments(pFrom, pTo);
+}
+
+/// addPending - remember where the fragments of pTo are not laid out yet
+void ObjectBuilder::addPending(SectionData& pTo)
+{
+  if (m_PendingSet.insert(&pTo).second) {
+    PendingLayout layout;
+    layout.data = &pTo;
+    layout.last = pTo.empty() ? NULL : &pTo.back();
+    layout.base = pTo.getSection().size();
+    m_Pending.push_back(layout);
+  }
+}
+
+/// SpliceFragments - move the fragments of pFrom to pTo without offsets
+void ObjectBuilder::SpliceFragments(SectionData& pFrom, SectionData& pTo)
+{
+  assert(&pFrom != &pTo && "Cannot move section data to itself!");
+
+  AlignFragment* align = CreateAlignment(pFrom.getSection());
+  if (NULL != align) {
+    align->setParent(&pTo);
+    pTo.getFragmentList().push_back(align);
+  }
+
+  SectionData::FragmentListType& from_list = pFrom.getFragmentList();
+  SectionData::FragmentListType& to_list = pTo.getFragmentList();
+  SectionData::FragmentListType::iterator frag, fragEnd = from_list.end();
+  for (frag = from_list.begin(); frag != fragEnd; ++frag)
+    frag->setParent(&pTo);
+  to_list.splice(to_list.end(), from_list);
+}
+
+/// updateOffsets - lay out the output sections of the deferred merges
+void ObjectBuilder::updateOffsets()
+{
+  OffsetUpdater updater = { &m_Pending };
+  if (m_Config.options().isMultiThreads())
+    parallel_for(m_Config.threads(), 0, m_Pending.size(), updater);
+  else {
+    for (size_t i = 0; i < m_Pending.size(); ++i)
+      updater(i);
+  }
+
+  m_Pending.clear();
+  m_PendingSet.clear();
+  m_bDeferOffsets = false;
+}
+
 /// UpdateSectionFlags - update alignment for input section
 void ObjectBuilder::UpdateSectionAlign(LDSection& pTo, const LDSection& pFrom)
 {
@@ -16,22 +16,46 @@
 #include <mcld/LD/LDContext.h>
 #include <mcld/LD/Archive.h>
 #include <mcld/LD/ArchiveReader.h>
+#include <mcld/LD/CallGraphOrdering.h>
 #include <mcld/LD/ObjectReader.h>
 #include <mcld/LD/DynObjReader.h>
+#include <mcld/LD/EhFrameOptimizer.h>
+#include <mcld/LD/ExportFilter.h>
+#include <mcld/LD/GarbageCollection.h>
+#include <mcld/LD/IdenticalCodeFolding.h>
+#include <mcld/LD/MergeableSections.h>
 #include <mcld/LD/GroupReader.h>
 #include <mcld/LD/BinaryReader.h>
 #include <mcld/LD/ObjectWriter.h>
 #include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SmallDataOrdering.h>
 #include <mcld/LD/RelocData.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/LD/SymbolOrdering.h>
+#include <mcld/MC/InputCost.h>
+#include <mcld/Support/Path.h>
 #include <mcld/Support/RealPath.h>
+#include <mcld/Support/LinkStats.h>
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/Support/TimeReport.h>
 #include <mcld/Target/TargetLDBackend.h>
 #include <mcld/Fragment/FragmentLinker.h>
 #include <mcld/Object/ObjectBuilder.h>
+#include <mcld/Object/SectionMap.h>
+#include <mcld/Object/SectionScript.h>
 
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace llvm;
 using namespace mcld;
@@ -85,9 +109,11 @@ bool ObjectLinker::initFragmentLinker()
   // initialize the readers and writers
   // Because constructor can not be failed, we initalize all readers and
   // writers outside the FragmentLinker constructors.
+  // The archive reader imports the lazily read symbols of shared libraries,
+  // so the shared library reader is created first.
   m_pObjectReader  = m_LDBackend.createObjectReader(*m_pBuilder);
-  m_pArchiveReader = m_LDBackend.createArchiveReader(*m_pModule);
   m_pDynObjReader  = m_LDBackend.createDynObjReader(*m_pBuilder);
+  m_pArchiveReader = m_LDBackend.createArchiveReader(*m_pModule);
   m_pGroupReader   = new GroupReader(*m_pModule, *m_pObjectReader,
                                      *m_pDynObjReader, *m_pArchiveReader);
   m_pBinaryReader  = m_LDBackend.createBinaryReader(*m_pBuilder);
@@ -113,11 +139,172 @@ bool ObjectLinker::initStdSections()
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Input Preloading
+//===----------------------------------------------------------------------===//
+namespace { // anonymous
+
+/// Preloader - the body of parallel_for to preload the i-th input
+struct Preloader
+{
+  std::vector<Input*>* inputs;
+  ObjectReader* obj_reader;
+  DynObjReader* dynobj_reader;
+  TimeReport* report;
+  const ThreadPool* pool;
+
+  void operator()(size_t pIdx) {
+    Input& input = *(*inputs)[pIdx];
+    TimeScope timer(report, "preload input", input.path().native());
+    getDiagnosticEngine().setOrdinal(pIdx);
+    input.setHome(pool->currentThread());
+    if (!obj_reader->preload(input))
+      dynobj_reader->preload(input);
+  }
+};
+
+/// Prefetcher - keep the system reading the next few inputs of normalize()
+/// while the current one is being parsed. Prefetching only gives the system
+/// hints, so it does no harm if normalize() changes the tree under it.
+///
+/// The whole file is prefetched. With --strip-debug most bytes of a -g
+/// object are never read, so nothing is prefetched then.
+class Prefetcher
+{
+public:
+  Prefetcher(Module::input_iterator pBegin, Module::input_iterator pEnd,
+             bool pEnable)
+    : m_Ahead(pBegin), m_End(pEnd), m_Distance(0), m_bEnable(pEnable) {
+  }
+
+  /// advance - called once for every input before normalize() reads it.
+  void advance() {
+    if (!m_bEnable)
+      return;
+
+    for (; m_Ahead != m_End && m_Distance < Window; ++m_Ahead, ++m_Distance) {
+      if (!isGroup(m_Ahead) && (*m_Ahead)->hasMemArea())
+        (*m_Ahead)->memArea()->prefetch();
+    }
+    // the current input is done after this round
+    if (0 != m_Distance)
+      --m_Distance;
+  }
+
+private:
+  static const size_t Window = 4;
+
+  Module::input_iterator m_Ahead;
+  Module::input_iterator m_End;
+  size_t m_Distance;
+  bool m_bEnable;
+};
+
+} // anonymous namespace
+
+/// preloadInputs - read the ELF headers, section header tables and symbol
+/// tables of all untyped inputs in parallel. Symbols are still read and
+/// resolved by normalize() in the order of the input tree, so the result is
+/// the same as a serial link.
+void ObjectLinker::preloadInputs()
+{
+  if (!m_Config.options().isMultiThreads() ||
+      m_Config.options().isBinaryInput())
+    return;
+
+  // collect the inputs. Every MemoryArea is preloaded only once.
+  std::vector<Input*> inputs;
+  std::set<MemoryArea*> areas;
+  InputTree::dfs_iterator input, inEnd = m_pModule->getInputTree().dfs_end();
+  for (input = m_pModule->getInputTree().dfs_begin(); input != inEnd; ++input) {
+    if (isGroup(input) || Input::Unknown != (*input)->type())
+      continue;
+    if (!(*input)->hasMemArea() || !(*input)->memArea()->hasHandler())
+      continue;
+    if (areas.insert((*input)->memArea()).second)
+      inputs.push_back(*input);
+  }
+
+  TimeScope timer(m_Config.timeReport(), "preloadInputs");
+  Preloader preloader = { &inputs, m_pObjectReader, m_pDynObjReader,
+                          m_Config.timeReport(), &m_Config.threads() };
+  getDiagnosticEngine().beginBuffer();
+  parallel_for(m_Config.threads(), 0, inputs.size(), preloader);
+  getDiagnosticEngine().endBuffer();
+}
+
+/// readExportFilter - read --dynamic-list and --version-script into the
+/// ExportFilter of IRBuilder
+void ObjectLinker::readExportFilter()
+{
+  if (LinkerConfig::Object == m_Config.codeGenType())
+    return;
+
+  ExportFilter& filter = m_pBuilder->getExportFilter();
+  if (m_Config.options().hasDynamicList()) {
+    const std::string& file = m_Config.options().dynamicList();
+    if (!filter.readDynamicList(sys::fs::Path(file)))
+      error(diag::err_cannot_read_dynamic_list) << file;
+  }
+
+  if (m_Config.options().hasVersionScript()) {
+    const std::string& file = m_Config.options().versionScript();
+    if (!filter.readVersionScript(sys::fs::Path(file)))
+      error(diag::err_cannot_read_version_script) << file;
+  }
+
+  if (filter.isDisabled())
+    warning(diag::warn_export_filter_extern);
+}
+
+/// reserveSymbols - sum the non-local symbols of all untyped inputs and
+/// reserve them in the NamePool, so that the NamePool does not rehash while
+/// normalize() resolves the symbols. The sum over-counts the symbols defined
+/// or referred by many inputs, and does not count the archive members.
+void ObjectLinker::reserveSymbols()
+{
+  if (m_Config.options().isBinaryInput())
+    return;
+
+  size_t num_of_symbols = 0;
+  InputTree::dfs_iterator input, inEnd = m_pModule->getInputTree().dfs_end();
+  for (input = m_pModule->getInputTree().dfs_begin(); input != inEnd; ++input) {
+    if (isGroup(input) || Input::Unknown != (*input)->type())
+      continue;
+    if (!(*input)->hasMemArea() || !(*input)->memArea()->hasHandler())
+      continue;
+
+    size_t num = getObjectReader()->numOfGlobalSymbols(**input);
+    if (0 == num)
+      num = getDynObjReader()->numOfGlobalSymbols(**input);
+    num_of_symbols += num;
+  }
+
+  NamePool& pool = m_pModule->getNamePool();
+  pool.reserve(pool.size() + num_of_symbols);
+}
+
 void ObjectLinker::normalize()
 {
+  // -----  categorize the symbols after they are resolved  ----- //
+  m_pModule->getSymbolTable().defer();
+
+  // -----  read the exported symbols before any symbol is read  ----- //
+  readExportFilter();
+
+  // -----  preload inputs in parallel  ----- //
+  preloadInputs();
+
+  // -----  size the symbol table once  ----- //
+  reserveSymbols();
+
   // -----  set up inputs  ----- //
   Module::input_iterator input, inEnd = m_pModule->input_end();
+  Prefetcher prefetcher(m_pModule->input_begin(), inEnd,
+                        !m_Config.options().stripDebug());
   for (input = m_pModule->input_begin(); input!=inEnd; ++input) {
+    prefetcher.advance();
+
     // is a group node
     if (isGroup(input)) {
       getGroupReader()->readGroup(input, m_pBuilder->getInputBuilder(), m_Config);
@@ -128,7 +315,8 @@ void ObjectLinker::normalize()
     // intermediate representation)
     if ((*input)->type() == Input::Script ||
         (*input)->type() == Input::Archive ||
-        (*input)->type() == Input::External)
+        (*input)->type() == Input::External ||
+        (*input)->type() == Input::Bitcode)
       continue;
 
     if (Input::Object == (*input)->type()) {
@@ -141,29 +329,43 @@ void ObjectLinker::normalize()
       continue;
     }
 
+    TimeScope timer(m_Config.timeReport(), "read input",
+                    (*input)->path().native());
+
+    // only the reader of the type claimed by the probe checks the input
+    unsigned int type = Input::Unknown;
+    if (!m_Config.options().isBinaryInput())
+      type = LDReader::Sniff(**input);
+
     // read input as a binary file
     if (m_Config.options().isBinaryInput()) {
       (*input)->setType(Input::Object);
+      m_pModule->assignOrdinal(**input);
       getBinaryReader()->readBinary(**input);
       m_pModule->getObjectList().push_back(*input);
     }
     // is a relocatable object file
-    else if (getObjectReader()->isMyFormat(**input)) {
+    else if (Input::Object == type &&
+             getObjectReader()->isMyFormat(**input)) {
       (*input)->setType(Input::Object);
       getObjectReader()->readHeader(**input);
       getObjectReader()->readSections(**input);
+      m_pModule->assignOrdinal(**input);
       getObjectReader()->readSymbols(**input);
       m_pModule->getObjectList().push_back(*input);
     }
     // is a shared object file
-    else if (getDynObjReader()->isMyFormat(**input)) {
+    else if (Input::DynObj == type &&
+             getDynObjReader()->isMyFormat(**input)) {
       (*input)->setType(Input::DynObj);
       getDynObjReader()->readHeader(**input);
+      m_pModule->assignOrdinal(**input);
       getDynObjReader()->readSymbols(**input);
       m_pModule->getLibraryList().push_back(*input);
     }
     // is an archive
-    else if (getArchiveReader()->isMyFormat(**input)) {
+    else if (Input::Archive == type &&
+             getArchiveReader()->isMyFormat(**input)) {
       (*input)->setType(Input::Archive);
       Archive archive(**input, m_pBuilder->getInputBuilder());
       getArchiveReader()->readArchive(archive);
@@ -172,11 +374,32 @@ void ObjectLinker::normalize()
                                                             archive.inputs());
       }
     }
+    // is a bitcode file. It was compiled by the link time optimization, and
+    // its objects are linked in place of the bitcode.
+    else if (Input::Bitcode == type) {
+      (*input)->setType(Input::Bitcode);
+      if (!m_Config.bitcode().isLTO())
+        error(diag::err_bitcode_input_without_lto) << (*input)->path();
+    }
     else {
       fatal(diag::err_unrecognized_input_file) << (*input)->path()
                                           << m_Config.targets().triple().str();
     }
   } // end of for
+
+  // -----  resolve the rest undefined symbols by lazy libraries  ----- //
+  getDynObjReader()->importSymbols(m_pModule->getNamePool());
+
+  // -----  categorize the symbols in one pass  ----- //
+  {
+    TimeScope timer(m_Config.timeReport(), "categorizeSymbols");
+    m_pModule->getSymbolTable().categorize(
+                                   m_Config.options().isMultiThreads() ?
+                                   &m_Config.threads() : NULL);
+  }
+
+  // -----  the archive members are merged. Freeze the input tree.  ----- //
+  m_pModule->getInputTree().freeze();
 }
 
 bool ObjectLinker::linkable() const
@@ -217,14 +440,40 @@ bool ObjectLinker::linkable() const
 
 /// readRelocations - read all relocation entries
 ///
-/// All symbols should be read and resolved before this function.
+/// All symbols should be read and resolved before this function. With
+/// --gc-sections, the relocations are read by the garbage collection once
+/// the sections they apply to are reached, so the relocations of the removed
+/// sections are never decoded.
 bool ObjectLinker::readRelocations()
 {
   // Bitcode is read by the other path. This function reads relocation sections
   // in object files.
-  mcld::InputTree::bfs_iterator input, inEnd = m_pModule->getInputTree().bfs_end();
-  for (input=m_pModule->getInputTree().bfs_begin(); input!=inEnd; ++input) {
+  InputTree& tree = m_pModule->getInputTree();
+  if (!tree.isFrozen())
+    tree.freeze();
+
+  // a relocation reads its place when it is created, so the compressed
+  // sections which are still needed are inflated before, all at once
+  if (!m_pModule->getCompressedSections().decompress(m_Config.threads()))
+    return false;
+
+  if (LinkerConfig::Object != m_Config.codeGenType() &&
+      m_Config.options().GCSections())
+    return true;
+
+  return readInputRelocations();
+}
+
+/// readInputRelocations - read the relocation sections of the objects that
+/// are not read or ignored yet
+bool ObjectLinker::readInputRelocations()
+{
+  InputTree& tree = m_pModule->getInputTree();
+  InputTree::FlatList::const_iterator input, inEnd = tree.flat().end();
+  for (input = tree.flat().begin(); input != inEnd; ++input) {
     if ((*input)->type() == Input::Object && (*input)->hasMemArea()) {
+      TimeScope timer(m_Config.timeReport(), "read relocations",
+                      (*input)->path().native());
       if (!getObjectReader()->readRelocations(**input))
         return false;
     }
@@ -233,10 +482,289 @@ bool ObjectLinker::readRelocations()
   return true;
 }
 
+/// dataStrippingOpt - remove the input sections that are not needed
+bool ObjectLinker::dataStrippingOpt()
+{
+  // Garbage collection and ICF work on the final outputs only. Sections of a
+  // relocatable output may be referred by the later links.
+  if (LinkerConfig::Object == m_Config.codeGenType())
+    return true;
+
+  // run garbage collection first, so ICF does not compare the dead sections
+  if (m_Config.options().GCSections()) {
+    GarbageCollection GC(m_Config, m_LDBackend, *m_pModule,
+                         getObjectReader());
+    if (!GC.run())
+      return false;
+
+    // the relocation sections of the kept sections are read by the garbage
+    // collection, and the others are ignored. Read the rest, if any, before
+    // the other passes use the relocations.
+    if (!readInputRelocations())
+      return false;
+  }
+
+  if (GeneralOptions::ICF_None != m_Config.options().getICFMode()) {
+    IdenticalCodeFolding icf(m_Config, *m_pModule);
+    icf.foldIdenticalCode();
+  }
+
+  // drop the duplicated strings and constants of the live sections
+  MergeableSections merger(m_Config, m_LDBackend, *m_pModule);
+  merger.merge();
+
+  // drop the FDEs of the removed functions and the duplicated CIEs
+  EhFrameOptimizer eh_frame(m_Config, *m_pModule);
+  eh_frame.run();
+  return true;
+}
+
+namespace {
+
+/// OrderedSection - an input section that is not merged in the input order
+struct OrderedSection
+{
+  OrderedSection(size_t pRank, size_t pPriority,
+                 Input* pInput, LDSection* pSection)
+    : rank(pRank), priority(pPriority), input(pInput), section(pSection) {
+  }
+
+  bool operator<(const OrderedSection& pOther) const
+  {
+    if (rank != pOther.rank)
+      return rank < pOther.rank;
+    return priority < pOther.priority;
+  }
+
+  size_t rank;
+  size_t priority;
+  Input* input;
+  LDSection* section;
+};
+
+/// getSectionGroup - the group of pSection of pInput in its output section.
+/// The sections placed by the linker script are in the Regular group.
+SectionMap::Group getSectionGroup(const LinkerConfig& pConfig,
+                                  const Input& pInput,
+                                  const LDSection& pSection)
+{
+  const SectionScript& script = pConfig.scripts().sections();
+  if (SectionScript::NoRule != script.find(pInput.path().native(),
+                                           pSection.name()))
+    return SectionMap::Regular;
+  return pConfig.scripts().sectionMap().find(pSection.name()).group;
+}
+
+/// MappingFinder - the body of parallel_for to look up the mapping of the
+/// i-th input section. The rules of the linker script precede SectionMap.
+struct MappingFinder
+{
+  const SectionMap* map;
+  const SectionScript* script;
+  const std::vector<Input*>* inputs;
+  const std::vector<LDSection*>* sections;
+  std::vector<const SectionMap::NamePair*>* mappings;
+  std::vector<unsigned int>* rules;
+
+  void operator()(size_t pIdx) {
+    const LDSection* sect = (*sections)[pIdx];
+    unsigned int rule = script->find((*inputs)[pIdx]->path().native(),
+                                     sect->name());
+    (*rules)[pIdx] = rule;
+    if (SectionScript::NoRule != rule)
+      (*mappings)[pIdx] = &script->getRule(rule).mapping;
+    else
+      (*mappings)[pIdx] = &map->find(sect->name());
+  }
+};
+
+/// PlacementCompare - order the input sections by the rules of the linker
+/// script placing them, and by the sorting of the rules. The sections that
+/// no rule places follow.
+struct PlacementCompare
+{
+  const SectionScript* script;
+  const std::vector<LDSection*>* sections;
+  const std::vector<unsigned int>* rules;
+
+  bool operator()(size_t pX, size_t pY) const {
+    unsigned int rule = (*rules)[pX];
+    if (rule != (*rules)[pY])
+      return rule < (*rules)[pY];
+    if (SectionScript::NoRule == rule)
+      return false;
+
+    const LDSection* x = (*sections)[pX];
+    const LDSection* y = (*sections)[pY];
+    switch (script->getRule(rule).sort) {
+      case SectionScript::SortByName:
+        return x->name() < y->name();
+      case SectionScript::SortByAlignment:
+        return x->align() > y->align();
+      default:
+        return false;
+    }
+  }
+};
+
+/// MayBeSorted - can --sort-section move pSection in its output section
+/// pOutput? The code, whose pieces such as .init may be concatenated, and the
+/// arrays of the constructors and destructors keep the input order.
+bool MayBeSorted(const LDSection& pSection, const std::string& pOutput)
+{
+  if (LDFileFormat::Regular != pSection.kind() &&
+      LDFileFormat::BSS != pSection.kind())
+    return false;
+
+  if (0x0 == (pSection.flag() & llvm::ELF::SHF_ALLOC) ||
+      0x0 != (pSection.flag() & llvm::ELF::SHF_EXECINSTR))
+    return false;
+
+  switch (pSection.type()) {
+    case llvm::ELF::SHT_INIT_ARRAY:
+    case llvm::ELF::SHT_FINI_ARRAY:
+    case llvm::ELF::SHT_PREINIT_ARRAY:
+      return false;
+    default:
+      break;
+  }
+
+  static const char* const ordered[] = {
+    ".init_array", ".fini_array", ".preinit_array", ".ctors", ".dtors", ".jcr"
+  };
+  for (size_t i = 0; i < sizeof(ordered) / sizeof(ordered[0]); ++i) {
+    if (0 == pOutput.compare(0, std::strlen(ordered[i]), ordered[i]))
+      return false;
+  }
+  return true;
+}
+
+/// SortCompare - order the input sections of an output section by
+/// --sort-section
+struct SortCompare
+{
+  GeneralOptions::SortSection sort;
+  const std::vector<LDSection*>* sections;
+
+  bool operator()(size_t pX, size_t pY) const {
+    const LDSection* x = (*sections)[pX];
+    const LDSection* y = (*sections)[pY];
+    if (GeneralOptions::SortSection_Name == sort)
+      return x->name() < y->name();
+    return x->align() > y->align();
+  }
+};
+
+/// SortSections - sort the input sections of each output section in place.
+/// The sections only move among the places of their output section in the
+/// lists, so the output sections are still created in the input order.
+void SortSections(GeneralOptions::SortSection pSort,
+                  std::vector<Input*>& pInputs,
+                  ObjectBuilder::SectionList& pSections,
+                  ObjectBuilder::MappingList& pMappings,
+                  const std::vector<unsigned int>& pRules)
+{
+  typedef std::map<std::string, std::vector<size_t> > PlaceMap;
+  PlaceMap places;
+  for (size_t i = 0; i < pSections.size(); ++i) {
+    // the sections placed by the linker script are sorted by its rules
+    if (SectionScript::NoRule != pRules[i])
+      continue;
+    const std::string& output = pMappings[i]->isNull() ? pSections[i]->name()
+                                                       : pMappings[i]->to;
+    if (MayBeSorted(*pSections[i], output))
+      places[output].push_back(i);
+  }
+
+  SortCompare compare = { pSort, &pSections };
+  PlaceMap::iterator place, pEnd = places.end();
+  for (place = places.begin(); place != pEnd; ++place) {
+    const std::vector<size_t>& from = place->second;
+    std::vector<size_t> order(from);
+    std::stable_sort(order.begin(), order.end(), compare);
+
+    std::vector<Input*> inputs(order.size());
+    ObjectBuilder::SectionList sects(order.size());
+    ObjectBuilder::MappingList maps(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      inputs[i] = pInputs[order[i]];
+      sects[i] = pSections[order[i]];
+      maps[i] = pMappings[order[i]];
+    }
+    for (size_t i = 0; i < from.size(); ++i) {
+      pInputs[from[i]] = inputs[i];
+      pSections[from[i]] = sects[i];
+      pMappings[from[i]] = maps[i];
+    }
+  }
+}
+
+/// CountOutputBytes - add the bytes that the sections of every input object
+/// bring into the output file to the cost of the object
+void CountOutputBytes(Module& pModule)
+{
+  Module::obj_iterator obj, objEnd = pModule.obj_end();
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    InputCost* cost = (*obj)->cost();
+    if (NULL == cost)
+      continue;
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      switch ((*sect)->kind()) {
+        case LDFileFormat::Ignore:
+        case LDFileFormat::Null:
+        case LDFileFormat::BSS:
+        case LDFileFormat::Relocation:
+        case LDFileFormat::NamePool:
+        case LDFileFormat::Group:
+        case LDFileFormat::StackNote:
+          continue;
+        default:
+          cost->outputBytes += (*sect)->size();
+          break;
+      }
+    }
+  }
+}
+
+} // anonymous namespace
+
 /// mergeSections - put allinput sections into output sections
 bool ObjectLinker::mergeSections()
 {
   ObjectBuilder builder(m_Config, *m_pModule);
+
+  if (m_Config.options().hasCostReport())
+    CountOutputBytes(*m_pModule);
+
+  m_LDBackend.preMergeSections(*m_pModule);
+
+  // The input sections defining the symbols of --symbol-ordering-file are
+  // merged first, in the order of their priorities. The hot sections follow
+  // them, and then the regular sections in the input order. The startup,
+  // exit and unlikely executed sections are merged at last.
+  SymbolOrdering ordering;
+  if (m_Config.options().hasSymbolOrderingFile()) {
+    const std::string& file = m_Config.options().symbolOrderingFile();
+    if (!ordering.read(sys::fs::Path(file))) {
+      error(diag::err_cannot_read_symbol_ordering_file) << file;
+      return false;
+    }
+    ordering.computeSectionPriorities(*m_pModule);
+  }
+  // the fragments are laid out after all of them are merged
+  builder.deferOffsets();
+
+  if (!mergeOrderedSections(builder, ordering, true))
+    return false;
+
+  // The regular sections are merged in two phases. Their mappings in
+  // SectionMap are looked up in parallel first, and then ObjectBuilder moves
+  // them into the output sections. The target-dependent sections and
+  // .eh_frame are merged as they are met, since they never go to the output
+  // sections of the regular ones.
+  std::vector<Input*> regular_inputs;
+  ObjectBuilder::SectionList regular_sects;
   Module::obj_iterator obj, objEnd = m_pModule->obj_end();
   for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
     LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
@@ -273,24 +801,211 @@ bool ObjectLinker::mergeSections()
           if (!(*sect)->hasSectionData())
             continue; // skip
 
-          LDSection* out_sect = builder.MergeSection(**sect);
-          if (NULL != out_sect) {
-            if (!m_LDBackend.updateSectionFlags(*out_sect, **sect)) {
-              error(diag::err_cannot_merge_section) << (*sect)->name()
-                                                    << (*obj)->name();
-              return false;
-            }
-          }
-          else {
-            error(diag::err_cannot_merge_section) << (*sect)->name()
-                                                  << (*obj)->name();
-            return false;
-          }
+          // the ordered sections are merged by mergeOrderedSections
+          if (SymbolOrdering::NotOrdered != ordering.getPriority(**sect))
+            continue;
+
+          regular_inputs.push_back(*obj);
+          regular_sects.push_back(*sect);
           break;
         }
       } // end of switch
     } // for each section
   } // for each obj
+
+  // -----  phase 1: look up the mappings of the regular sections  ----- //
+  ObjectBuilder::MappingList mappings(regular_sects.size());
+  std::vector<unsigned int> rules(regular_sects.size(),
+                                  SectionScript::NoRule);
+  const SectionScript& script = m_Config.scripts().sections();
+  MappingFinder finder = { &m_Config.scripts().sectionMap(), &script,
+                           &regular_inputs, &regular_sects, &mappings,
+                           &rules };
+  if (m_Config.options().isMultiThreads())
+    parallel_for(m_Config.threads(), 0, regular_sects.size(), finder, 256);
+  else {
+    for (size_t i = 0; i < regular_sects.size(); ++i)
+      finder(i);
+  }
+
+  // the sections of the other groups are merged by mergeOrderedSections
+  size_t num_regular = 0;
+  for (size_t i = 0; i < regular_sects.size(); ++i) {
+    if (SectionMap::Regular != mappings[i]->group)
+      continue;
+    regular_inputs[num_regular] = regular_inputs[i];
+    regular_sects[num_regular] = regular_sects[i];
+    mappings[num_regular] = mappings[i];
+    rules[num_regular] = rules[i];
+    ++num_regular;
+  }
+  regular_inputs.resize(num_regular);
+  regular_sects.resize(num_regular);
+  mappings.resize(num_regular);
+  rules.resize(num_regular);
+
+  // --sort-section sorts the sections that no rule of the linker script
+  // places, such as the -fdata-sections pieces of .rodata and .data. By
+  // decreasing alignment, the padding between them nearly disappears.
+  if (GeneralOptions::SortSection_None != m_Config.options().getSortSection())
+    SortSections(m_Config.options().getSortSection(), regular_inputs,
+                 regular_sects, mappings, rules);
+
+  // The sections placed by the linker script are merged in the order of its
+  // rules, so the output sections are also created in the order of the
+  // script. The others keep the input order after them.
+  if (!script.empty()) {
+    std::vector<size_t> order(num_regular);
+    for (size_t i = 0; i < num_regular; ++i)
+      order[i] = i;
+    PlacementCompare compare = { &script, &regular_sects, &rules };
+    std::stable_sort(order.begin(), order.end(), compare);
+
+    std::vector<Input*> inputs(num_regular);
+    ObjectBuilder::SectionList sects(num_regular);
+    ObjectBuilder::MappingList maps(num_regular);
+    for (size_t i = 0; i < num_regular; ++i) {
+      inputs[i] = regular_inputs[order[i]];
+      sects[i] = regular_sects[order[i]];
+      maps[i] = mappings[order[i]];
+    }
+    regular_inputs.swap(inputs);
+    regular_sects.swap(sects);
+    mappings.swap(maps);
+  }
+
+  // -----  phase 2: move the fragments into the output sections  ----- //
+  ObjectBuilder::SectionList outputs;
+  bool merged = builder.MergeSections(regular_sects, mappings, outputs);
+  for (size_t i = 0; i < num_regular; ++i) {
+    if (!merged || NULL == outputs[i] ||
+        !m_LDBackend.updateSectionFlags(*outputs[i], *regular_sects[i])) {
+      error(diag::err_cannot_merge_section) << regular_sects[i]->name()
+                                            << regular_inputs[i]->name();
+      return false;
+    }
+  }
+
+  if (!mergeOrderedSections(builder, ordering, false))
+    return false;
+
+  // -----  lay out the fragments of the output sections  ----- //
+  TimeScope timer(m_Config.timeReport(), "updateFragmentOffsets");
+  builder.updateOffsets();
+  return true;
+}
+
+/// mergeOrderedSections - merge the input sections that are not merged in
+/// the input order
+bool ObjectLinker::mergeOrderedSections(ObjectBuilder& pBuilder,
+                                        const SymbolOrdering& pOrdering,
+                                        bool pBeforeRegular)
+{
+  std::vector<OrderedSection> ordered;
+  Module::obj_iterator obj, objEnd = m_pModule->obj_end();
+  for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      // only the sections merged by ObjectBuilder are ordered
+      switch ((*sect)->kind()) {
+        case LDFileFormat::Ignore:
+        case LDFileFormat::Null:
+        case LDFileFormat::Relocation:
+        case LDFileFormat::NamePool:
+        case LDFileFormat::Group:
+        case LDFileFormat::StackNote:
+        case LDFileFormat::Target:
+        case LDFileFormat::EhFrame:
+          continue;
+        default:
+          break;
+      }
+      if (!(*sect)->hasSectionData())
+        continue;
+
+      // the listed symbols of --symbol-ordering-file precede the groups
+      size_t priority = pOrdering.getPriority(**sect);
+      SectionMap::Group group = getSectionGroup(m_Config, **obj, **sect);
+      if (SymbolOrdering::NotOrdered != priority) {
+        if (pBeforeRegular)
+          ordered.push_back(OrderedSection(0, priority, *obj, *sect));
+      }
+      else if (pBeforeRegular ? (group < SectionMap::Regular)
+                              : (group > SectionMap::Regular)) {
+        ordered.push_back(OrderedSection(1 + group, 0, *obj, *sect));
+      }
+    }
+  }
+
+  // the sections of the same rank and priority keep the input order
+  std::stable_sort(ordered.begin(), ordered.end());
+
+  std::vector<OrderedSection>::iterator it, itEnd = ordered.end();
+  for (it = ordered.begin(); it != itEnd; ++it) {
+    if (!mergeSectionData(pBuilder, *it->input, *it->section))
+      return false;
+  }
+  return true;
+}
+
+/// mergeSectionData - merge the section data of pSection of pInput
+bool ObjectLinker::mergeSectionData(ObjectBuilder& pBuilder,
+                                    const Input& pInput,
+                                    LDSection& pSection)
+{
+  LDSection* out_sect = pBuilder.MergeSection(pSection);
+  if (NULL == out_sect || !m_LDBackend.updateSectionFlags(*out_sect, pSection)) {
+    error(diag::err_cannot_merge_section) << pSection.name() << pInput.name();
+    return false;
+  }
+  return true;
+}
+
+/// orderFunctions - reorder the functions of the output sections
+bool ObjectLinker::orderFunctions()
+{
+  if (!m_Config.options().callGraphOrdering() ||
+      LinkerConfig::Object == m_Config.codeGenType())
+    return true;
+
+  // the listed symbols are already placed by --symbol-ordering-file
+  if (m_Config.options().hasSymbolOrderingFile()) {
+    warning(diag::warn_call_graph_ordering_ignored);
+    return true;
+  }
+
+  CallGraphOrdering ordering(m_Config, *m_pModule);
+  if (m_Config.options().hasCallGraphProfileFile()) {
+    const std::string& file = m_Config.options().callGraphProfileFile();
+    if (!ordering.readProfile(sys::fs::Path(file))) {
+      error(diag::err_cannot_read_call_graph_profile_file) << file;
+      return false;
+    }
+  }
+  ordering.run();
+  return true;
+}
+
+/// orderSmallData - reorder the small data objects of the GP-relative targets
+bool ObjectLinker::orderSmallData()
+{
+  if (!m_LDBackend.hasGPRelativeData() ||
+      LinkerConfig::Object == m_Config.codeGenType())
+    return true;
+
+  // the listed symbols are already placed by --symbol-ordering-file
+  if (m_Config.options().hasSymbolOrderingFile())
+    return true;
+
+  SmallDataOrdering ordering(m_Config, *m_pModule);
+  if (m_Config.options().hasSmallDataProfileFile()) {
+    const std::string& file = m_Config.options().smallDataProfileFile();
+    if (!ordering.readProfile(sys::fs::Path(file))) {
+      error(diag::err_cannot_read_small_data_profile_file) << file;
+      return false;
+    }
+  }
+  ordering.run();
   return true;
 }
 
@@ -328,11 +1043,70 @@ bool ObjectLinker::addScriptSymbols()
   return true;
 }
 
+/// readDependencies - resolve the references of an executable which are
+/// still undefined by the DT_NEEDED libraries of its shared objects
+void ObjectLinker::readDependencies()
+{
+  // the references of a shared object or a relocatable output may stay
+  // undefined
+  if (LinkerConfig::Exec != m_Config.codeGenType() ||
+      m_pModule->lib_begin() == m_pModule->lib_end())
+    return;
+
+  TimeScope timer(m_Config.timeReport(), "readDependencies");
+  getDynObjReader()->readDependencies(*m_pModule);
+}
+
+//===----------------------------------------------------------------------===//
+// Relocation Scanning
+//===----------------------------------------------------------------------===//
+namespace { // anonymous
+
+/// RelocPreScanner - the body of parallel_for to pre-scan the i-th relocation
+struct RelocPreScanner
+{
+  std::vector<Relocation*>* relocs;
+  std::vector<LDSection*>* sections;
+  std::vector<unsigned char>* needs_scan;
+  TargetLDBackend* backend;
+
+  void operator()(size_t pIdx) {
+    getDiagnosticEngine().setOrdinal(pIdx);
+    (*needs_scan)[pIdx] =
+      backend->preScanRelocation(*(*relocs)[pIdx], *(*sections)[pIdx]);
+  }
+};
+
+/// CountEntries - the number of entries reserved in the output section
+/// pName, including its reserved header entries
+size_t CountEntries(const Module& pModule, const char* pName)
+{
+  const LDSection* sect = pModule.getSection(pName);
+  if (NULL == sect || !sect->hasSectionData())
+    return 0;
+  return sect->getSectionData()->size();
+}
+
+} // anonymous namespace
+
 bool ObjectLinker::scanRelocations()
 {
-  // apply all relocations of all inputs
+  // scan all relocations of all inputs
+  bool partial = (LinkerConfig::Object == m_Config.codeGenType());
+  bool concurrent = !partial && m_Config.options().isMultiThreads();
+
+  // With --threads, the relocations are pre-scanned in parallel, and then
+  // the backend reserves the GOT, PLT and dynamic relocation entries in the
+  // order of the inputs, so the entries are laid out as a serial link does.
+  std::vector<Relocation*> relocs;
+  std::vector<LDSection*> sections;
+  // the first relocation of every input in relocs
+  std::vector<std::pair<size_t, Input*> > firsts;
   Module::obj_iterator input, inEnd = m_pModule->obj_end();
   for (input = m_pModule->obj_begin(); input != inEnd; ++input) {
+    InputCostScope cost(**input, InputCost::Scan);
+    if (concurrent)
+      firsts.push_back(std::make_pair(relocs.size(), *input));
     LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
     for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
       // bypass the reloc section if
@@ -345,14 +1119,66 @@ bool ObjectLinker::scanRelocations()
       RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
       for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
         Relocation* relocation = llvm::cast<Relocation>(reloc);
+        if (LinkStats::isEnabled())
+          LinkStats::AddRelocation(relocation->type());
+        if (NULL != (*input)->cost())
+          ++(*input)->cost()->relocations;
+        if (concurrent) {
+          relocs.push_back(relocation);
+          sections.push_back(*rs);
+          continue;
+        }
         // scan relocation
-        if (LinkerConfig::Object != m_Config.codeGenType())
-          m_LDBackend.scanRelocation(*relocation, *m_pBuilder, *m_pModule, **rs);
+        if (!partial) {
+          if (m_LDBackend.preScanRelocation(*relocation, **rs))
+            m_LDBackend.scanRelocation(*relocation, *m_pBuilder,
+                                       *m_pModule, **rs);
+        }
         else
           m_LDBackend.partialScanRelocation(*relocation, *m_pModule, **rs);
       } // for all relocations
     } // for all relocation section
   } // for all inputs
+
+  if (!relocs.empty()) {
+    std::vector<unsigned char> needs_scan(relocs.size(), 0x0);
+    RelocPreScanner prescanner = { &relocs, &sections, &needs_scan,
+                                   &m_LDBackend };
+
+    // with --thread-affinity, the relocations of an input are pre-scanned
+    // by the thread which preloaded the input
+    ThreadPool::HomeList homes;
+    if (m_Config.threads().hasAffinity()) {
+      homes.resize(relocs.size(), ThreadPool::NoHome);
+      for (size_t f = 0; f < firsts.size(); ++f) {
+        size_t end = (f + 1 < firsts.size()) ? firsts[f + 1].first :
+                                               relocs.size();
+        std::fill(homes.begin() + firsts[f].first, homes.begin() + end,
+                  firsts[f].second->home());
+      }
+    }
+    getDiagnosticEngine().beginBuffer();
+    parallel_for(m_Config.threads(), 0, relocs.size(), prescanner, homes, 256);
+    getDiagnosticEngine().endBuffer();
+    // the parallel pre-scan is not attributed to the inputs, the reservation
+    // is
+    for (size_t f = 0; f < firsts.size(); ++f) {
+      InputCostScope cost(*firsts[f].second, InputCost::Scan);
+      size_t end = (f + 1 < firsts.size()) ? firsts[f + 1].first :
+                                             relocs.size();
+      for (size_t i = firsts[f].first; i < end; ++i) {
+        if (0x0 != needs_scan[i])
+          m_LDBackend.scanRelocation(*relocs[i], *m_pBuilder, *m_pModule,
+                                     *sections[i]);
+      }
+    }
+  }
+
+  if (LinkStats::isEnabled()) {
+    LinkStats::Set(LinkStats::GOTEntries, CountEntries(*m_pModule, ".got") +
+                                          CountEntries(*m_pModule, ".got.plt"));
+    LinkStats::Set(LinkStats::PLTEntries, CountEntries(*m_pModule, ".plt"));
+  }
   return true;
 }
 
@@ -449,7 +1275,33 @@ bool ObjectLinker::relocation()
 /// emitOutput - emit the output file.
 bool ObjectLinker::emitOutput(MemoryArea& pOutput)
 {
-  return llvm::errc::success == getWriter()->writeObject(*m_pModule, pOutput);
+  if (llvm::errc::success != getWriter()->writeObject(*m_pModule, pOutput))
+    return false;
+
+  dropInputs();
+  return true;
+}
+
+/// dropInputs - all section contents of inputs are copied into the output.
+/// Let the system reclaim the pages of inputs before the output is written
+/// back.
+void ObjectLinker::dropInputs()
+{
+  std::set<MemoryArea*> areas;
+  Module::obj_iterator obj, objEnd = m_pModule->obj_end();
+  for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
+    if ((*obj)->hasMemArea())
+      areas.insert((*obj)->memArea());
+  }
+  Module::lib_iterator lib, libEnd = m_pModule->lib_end();
+  for (lib = m_pModule->lib_begin(); lib != libEnd; ++lib) {
+    if ((*lib)->hasMemArea())
+      areas.insert((*lib)->memArea());
+  }
+
+  std::set<MemoryArea*>::iterator area, aEnd = areas.end();
+  for (area = areas.begin(); area != aEnd; ++area)
+    (*area)->advise(FileHandle::DontNeed);
 }
 
 /// postProcessing - do modification after all processes
@@ -8,8 +8,9 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/Object/SectionMap.h>
 #include <mcld/ADT/StringHash.h>
+
+#include <algorithm>
 #include <cassert>
-#include <cstring>
 
 using namespace mcld;
 
@@ -20,11 +21,13 @@ SectionMap::NamePair SectionMap::NullName;
 // SectionMap::NamePair
 //===----------------------------------------------------------------------===//
 SectionMap::NamePair::NamePair()
-  : hash(-1) {
+  : hash(-1), group(SectionMap::Regular) {
 }
 
-SectionMap::NamePair::NamePair(const std::string& pFrom, const std::string& pTo)
-  : from(pFrom), to(pTo) {
+SectionMap::NamePair::NamePair(const std::string& pFrom,
+                               const std::string& pTo,
+                               SectionMap::Group pGroup)
+  : from(pFrom), to(pTo), group(pGroup) {
   hash = SectionMap::hash(pFrom);
 }
 
@@ -33,47 +36,58 @@ bool SectionMap::NamePair::isNull() const
   return (&NullName == this);
 }
 
+//===----------------------------------------------------------------------===//
+// SectionMap::TrieNode
+//===----------------------------------------------------------------------===//
+SectionMap::TrieNode::TrieNode()
+  : mapping(SectionMap::NoMapping) {
+}
+
 //===----------------------------------------------------------------------===//
 // SectionMap
 //===----------------------------------------------------------------------===//
+SectionMap::SectionMap()
+  : m_Trie(1), m_Wildcard(NoMapping) {
+}
+
 const SectionMap::NamePair& SectionMap::find(const std::string& pFrom) const
 {
-  unsigned int hash = SectionMap::hash(pFrom);
-  return find(pFrom, hash);
+  unsigned int index = lookup(pFrom);
+  if (NoMapping == index)
+    return NullName;
+  return m_NamePairList[index];
 }
 
 SectionMap::NamePair& SectionMap::find(const std::string& pFrom)
 {
-  unsigned int hash = SectionMap::hash(pFrom);
-  return find(pFrom, hash);
+  unsigned int index = lookup(pFrom);
+  if (NoMapping == index)
+    return NullName;
+  return m_NamePairList[index];
 }
 
 const SectionMap::NamePair&
 SectionMap::find(const std::string& pFrom, unsigned int pHash) const
 {
-  NamePairList::const_iterator name_hash, nEnd = m_NamePairList.end();
-  for (name_hash = m_NamePairList.begin(); name_hash != nEnd; ++name_hash) {
-    if (matched(*name_hash, pFrom, pHash)) {
-      return *name_hash;
-    }
-  }
-  return NullName;
+  return find(pFrom);
 }
 
 SectionMap::NamePair&
 SectionMap::find(const std::string& pFrom, unsigned int pHash)
 {
-  NamePairList::iterator name_hash, nEnd = m_NamePairList.end();
-  for (name_hash = m_NamePairList.begin(); name_hash != nEnd; ++name_hash) {
-    if (matched(*name_hash, pFrom, pHash)) {
-      return *name_hash;
-    }
-  }
-  return NullName;
+  return find(pFrom);
+}
+
+SectionMap::NamePair& SectionMap::append(const std::string &pFrom,
+                                         const std::string &pTo,
+                                         bool &pExist)
+{
+  return append(pFrom, pTo, Regular, pExist);
 }
 
 SectionMap::NamePair& SectionMap::append(const std::string &pFrom,
                                          const std::string &pTo,
+                                         Group pGroup,
                                          bool &pExist)
 {
   NamePair& result = find(pFrom);
@@ -83,31 +97,79 @@ SectionMap::NamePair& SectionMap::append(const std::string &pFrom,
   }
 
   pExist = false;
-  NamePair entry(pFrom, pTo);
+  NamePair entry(pFrom, pTo, pGroup);
   m_NamePairList.push_back(entry);
+  insert(m_NamePairList.size() - 1);
   return m_NamePairList.back();
 }
 
-bool SectionMap::matched(const NamePair& pNamePair,
-                         const std::string& pInput,
-                         unsigned int pHashValue) const
+unsigned int SectionMap::lookup(const std::string& pInput) const
 {
-  if ('*' == pNamePair.from[0])
-    return true;
+  // the mappings are found in the order of their lengths, but the first
+  // appended one wins
+  unsigned int result = m_Wildcard;
+  unsigned int node = 0;
+  size_t depth = 0;
+  while (true) {
+    unsigned int mapping = m_Trie[node].mapping;
+    if (NoMapping != mapping && mapping < result) {
+      // .text.hot matches .text.hot and .text.hot.*, but not .text.hotter
+      if (Regular == m_NamePairList[mapping].group ||
+          depth == pInput.size() ||
+          '.' == pInput[depth])
+        result = mapping;
+    }
 
-  if (pNamePair.from.size() > pInput.size())
-    return false;
+    if (depth == pInput.size())
+      break;
+    node = getChild(node, pInput[depth]);
+    if (NoMapping == node)
+      break;
+    ++depth;
+  }
+  return result;
+}
 
-  if (!StringHash<ES>::may_include(pNamePair.hash, pHashValue))
-    return false;
+void SectionMap::insert(unsigned int pIndex)
+{
+  const std::string& from = m_NamePairList[pIndex].from;
+  if (!from.empty() && '*' == from[0]) {
+    if (NoMapping == m_Wildcard)
+      m_Wildcard = pIndex;
+    return;
+  }
 
-  if (0 == strncmp(pInput.c_str(),
-                   pNamePair.from.c_str(),
-                   pNamePair.from.size())) {
-    return true;
+  unsigned int node = 0;
+  for (size_t i = 0; i < from.size(); ++i) {
+    unsigned int child = getChild(node, from[i]);
+    if (NoMapping == child) {
+      child = m_Trie.size();
+      m_Trie.push_back(TrieNode());
+
+      std::vector<std::pair<char, unsigned int> >& children =
+                                                      m_Trie[node].children;
+      std::vector<std::pair<char, unsigned int> >::iterator pos =
+        std::lower_bound(children.begin(), children.end(),
+                         std::make_pair(from[i], 0u));
+      children.insert(pos, std::make_pair(from[i], child));
+    }
+    node = child;
   }
 
-  return false;
+  if (NoMapping == m_Trie[node].mapping)
+    m_Trie[node].mapping = pIndex;
+}
+
+unsigned int SectionMap::getChild(unsigned int pNode, char pChar) const
+{
+  const std::vector<std::pair<char, unsigned int> >& children =
+                                                      m_Trie[pNode].children;
+  std::vector<std::pair<char, unsigned int> >::const_iterator pos =
+    std::lower_bound(children.begin(), children.end(),
+                     std::make_pair(pChar, 0u));
+  if (pos == children.end() || pos->first != pChar)
+    return NoMapping;
+  return pos->second;
 }
 
 unsigned int SectionMap::hash(const std::string& pString)
@@ -0,0 +1,464 @@
+//===- SectionScript.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Object/SectionScript.h>
+
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/Path.h>
+
+#include <algorithm>
+#include <cctype>
+
+using namespace mcld;
+
+namespace { // anonymous
+
+bool IsDelimiter(char pChar)
+{
+  return ('{' == pChar || '}' == pChar || '(' == pChar || ')' == pChar ||
+          ';' == pChar || ':' == pChar || ',' == pChar || '=' == pChar ||
+          0 != isspace(static_cast<unsigned char>(pChar)));
+}
+
+/** \class Lexer
+ *  \brief Lexer cuts the tokens out of a linker script. A token is one of
+ *  `{}();:,=' or a run of the other characters. The spaces and the C
+ *  comments are skipped.
+ */
+class Lexer
+{
+public:
+  explicit Lexer(llvm::StringRef pContent)
+    : m_Content(pContent) {
+    m_Next = cut();
+  }
+
+  /// next - the next token, or an empty token at the end
+  llvm::StringRef next() {
+    llvm::StringRef token = m_Next;
+    m_Next = cut();
+    return token;
+  }
+
+  llvm::StringRef peek() const { return m_Next; }
+
+  /// skipGroup - skip the group of pOpen and its closing token, which are
+  /// the next tokens
+  void skipGroup(llvm::StringRef pOpen, llvm::StringRef pClose) {
+    unsigned int depth = 0;
+    while (!peek().empty()) {
+      llvm::StringRef token = next();
+      if (pOpen == token)
+        ++depth;
+      else if (pClose == token && 0 == --depth)
+        return;
+    }
+  }
+
+  /// skipStatement - skip the tokens to the next `;' at the same depth of
+  /// parentheses. A `}' also ends the statement, and it is not skipped.
+  void skipStatement() {
+    while (!peek().empty() && "}" != peek()) {
+      if ("(" == peek()) {
+        skipGroup("(", ")");
+        continue;
+      }
+      if (";" == next())
+        return;
+    }
+  }
+
+private:
+  llvm::StringRef cut() {
+    while (!m_Content.empty()) {
+      if (0 != isspace(static_cast<unsigned char>(m_Content[0])))
+        m_Content = m_Content.substr(1);
+      else if (m_Content.startswith("/*"))
+        m_Content = m_Content.substr(m_Content.find("*/", 2)).substr(2);
+      else
+        break;
+    }
+    if (m_Content.empty())
+      return llvm::StringRef();
+
+    size_t length = 1;
+    if (!IsDelimiter(m_Content[0])) {
+      while (length < m_Content.size() && !IsDelimiter(m_Content[length]))
+        ++length;
+    }
+    llvm::StringRef token = m_Content.substr(0, length);
+    m_Content = m_Content.substr(length);
+    return token;
+  }
+
+private:
+  llvm::StringRef m_Content;
+  llvm::StringRef m_Next;
+};
+
+/// GetSortPolicy - the policy of the sorting keyword pToken
+/// @return false if pToken is not a sorting keyword
+bool GetSortPolicy(llvm::StringRef pToken, SectionScript::SortPolicy& pSort)
+{
+  if ("SORT" == pToken || "SORT_BY_NAME" == pToken)
+    pSort = SectionScript::SortByName;
+  else if ("SORT_BY_ALIGNMENT" == pToken)
+    pSort = SectionScript::SortByAlignment;
+  else if ("SORT_NONE" == pToken || "SORT_BY_INIT_PRIORITY" == pToken)
+    pSort = SectionScript::Unsorted;
+  else
+    return false;
+  return true;
+}
+
+/// IsCommand - is pToken a command with parentheses other than an input
+/// section description, e.g., PROVIDE(), ASSERT() or LONG()?
+bool IsCommand(llvm::StringRef pToken)
+{
+  static const char* commands[] = {
+    "ENTRY", "ASSERT", "PROVIDE", "PROVIDE_HIDDEN", "HIDDEN", "INCLUDE",
+    "BYTE", "SHORT", "LONG", "QUAD", "SQUAD", "FILL"
+  };
+  for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); ++i) {
+    if (pToken == commands[i])
+      return true;
+  }
+  return false;
+}
+
+/// ReadList - read the patterns in the parentheses of EXCLUDE_FILE or a
+/// sorting keyword, which are the next tokens. The nested sorting keywords
+/// are skipped, e.g., SORT_BY_NAME(SORT_BY_ALIGNMENT(.data.*)).
+void ReadList(Lexer& pLexer, SectionScript::PatternList& pList)
+{
+  if ("(" != pLexer.peek())
+    return;
+  pLexer.next();
+
+  unsigned int depth = 1;
+  while (!pLexer.peek().empty()) {
+    llvm::StringRef token = pLexer.next();
+    SectionScript::SortPolicy sort;
+    if (")" == token) {
+      if (0 == --depth)
+        return;
+    }
+    else if (GetSortPolicy(token, sort) && "(" == pLexer.peek()) {
+      pLexer.next();
+      ++depth;
+    }
+    else if ("," != token)
+      pList.push_back(token.str());
+  }
+}
+
+/** \class Parser
+ *  \brief Parser reads the SECTIONS commands into a SectionScript.
+ */
+class Parser
+{
+public:
+  Parser(llvm::StringRef pContent, SectionScript& pScript)
+    : m_Lexer(pContent), m_Script(pScript), m_bDiscard(false) {
+  }
+
+  /// run - read the commands
+  /// @return true if a /DISCARD/ output section is skipped
+  bool run();
+
+private:
+  /// parseSections - read the body of SECTIONS
+  void parseSections();
+
+  /// parseOutputSection - read the output section pOutput, whose name is
+  /// read
+  void parseOutputSection(const std::string& pOutput);
+
+  /// parseInput - read an input section description of pOutput
+  void parseInput(llvm::StringRef pToken, const std::string& pOutput);
+
+  /// append - add a rule of pOutput unless pOutput is /DISCARD/
+  void append(const std::string& pOutput,
+              llvm::StringRef pFile,
+              const SectionScript::PatternList& pExcludes,
+              SectionScript::PatternList& pSections,
+              SectionScript::SortPolicy pSort);
+
+private:
+  Lexer m_Lexer;
+  SectionScript& m_Script;
+  bool m_bDiscard;
+};
+
+bool Parser::run()
+{
+  while (!m_Lexer.peek().empty()) {
+    llvm::StringRef token = m_Lexer.next();
+    if ("SECTIONS" == token && "{" == m_Lexer.peek()) {
+      m_Lexer.next();
+      parseSections();
+    }
+    else if ("(" == m_Lexer.peek())
+      m_Lexer.skipGroup("(", ")");
+    else if ("{" == m_Lexer.peek())
+      m_Lexer.skipGroup("{", "}");
+    else if ("=" == m_Lexer.peek())
+      m_Lexer.skipStatement();
+  }
+  return m_bDiscard;
+}
+
+void Parser::parseSections()
+{
+  while (!m_Lexer.peek().empty()) {
+    llvm::StringRef token = m_Lexer.next();
+    if ("}" == token)
+      return;
+    if (";" == token)
+      continue;
+
+    // ENTRY(), ASSERT(), PROVIDE() and the like
+    if ("(" == m_Lexer.peek() && IsCommand(token)) {
+      m_Lexer.skipGroup("(", ")");
+      continue;
+    }
+
+    // `. = 0x1000;', `foo += 4;' and the like
+    if ("=" == m_Lexer.peek() || "=" == token) {
+      m_Lexer.skipStatement();
+      continue;
+    }
+
+    parseOutputSection(token.str());
+  }
+}
+
+void Parser::parseOutputSection(const std::string& pOutput)
+{
+  // the address and the type before `:', and the load address, the
+  // alignments and the constraints before `{'
+  while (!m_Lexer.peek().empty() && ":" != m_Lexer.peek()) {
+    if ("(" == m_Lexer.peek())
+      m_Lexer.skipGroup("(", ")");
+    else
+      m_Lexer.next();
+  }
+  m_Lexer.next();
+  while (!m_Lexer.peek().empty() && "{" != m_Lexer.peek()) {
+    if ("(" == m_Lexer.peek())
+      m_Lexer.skipGroup("(", ")");
+    else
+      m_Lexer.next();
+  }
+  m_Lexer.next();
+
+  while (!m_Lexer.peek().empty()) {
+    llvm::StringRef token = m_Lexer.next();
+    if ("}" == token)
+      break;
+    if (";" == token || "," == token)
+      continue;
+
+    if ("=" == m_Lexer.peek() || "=" == token) {
+      m_Lexer.skipStatement();
+      continue;
+    }
+
+    if ("KEEP" == token && "(" == m_Lexer.peek()) {
+      m_Lexer.next();
+      parseInput(m_Lexer.next(), pOutput);
+      if (")" == m_Lexer.peek())
+        m_Lexer.next();
+      continue;
+    }
+
+    // PROVIDE(), ASSERT(), BYTE(), LONG(), FILL() and the like
+    if ("(" == m_Lexer.peek() && IsCommand(token)) {
+      m_Lexer.skipGroup("(", ")");
+      continue;
+    }
+
+    parseInput(token, pOutput);
+  }
+
+  // `>region', `AT>region', `:phdr' and `=fill' after the body
+  while (!m_Lexer.peek().empty()) {
+    llvm::StringRef token = m_Lexer.peek();
+    if (token.startswith(">") || token.startswith("AT>") || "," == token)
+      m_Lexer.next();
+    else if (":" == token || "=" == token) {
+      m_Lexer.next();
+      m_Lexer.next();
+    }
+    else
+      break;
+  }
+}
+
+void Parser::parseInput(llvm::StringRef pToken, const std::string& pOutput)
+{
+  SectionScript::PatternList excludes;
+  llvm::StringRef file = pToken;
+  if ("EXCLUDE_FILE" == file) {
+    ReadList(m_Lexer, excludes);
+    file = m_Lexer.next();
+  }
+
+  // the files are not sorted, e.g., SORT(*)(.text)
+  SectionScript::SortPolicy sort;
+  if (GetSortPolicy(file, sort) && "(" == m_Lexer.peek()) {
+    m_Lexer.next();
+    file = m_Lexer.next();
+    if (")" == m_Lexer.peek())
+      m_Lexer.next();
+  }
+
+  if ("CONSTRUCTORS" == file || "CREATE_OBJECT_SYMBOLS" == file)
+    return;
+
+  // a file name alone places all its sections
+  SectionScript::PatternList sections;
+  if ("(" != m_Lexer.peek()) {
+    sections.push_back("*");
+    append(pOutput, file, excludes, sections, SectionScript::Unsorted);
+    return;
+  }
+  m_Lexer.next();
+
+  while (!m_Lexer.peek().empty()) {
+    llvm::StringRef token = m_Lexer.next();
+    if (")" == token)
+      break;
+    if ("," == token)
+      continue;
+
+    // EXCLUDE_FILE in the list applies to the next pattern only
+    if ("EXCLUDE_FILE" == token && "(" == m_Lexer.peek()) {
+      append(pOutput, file, excludes, sections, SectionScript::Unsorted);
+      SectionScript::PatternList more(excludes);
+      ReadList(m_Lexer, more);
+      SectionScript::PatternList one(1, m_Lexer.next().str());
+      append(pOutput, file, more, one, SectionScript::Unsorted);
+      continue;
+    }
+
+    if (GetSortPolicy(token, sort) && "(" == m_Lexer.peek()) {
+      append(pOutput, file, excludes, sections, SectionScript::Unsorted);
+      SectionScript::PatternList sorted;
+      ReadList(m_Lexer, sorted);
+      append(pOutput, file, excludes, sorted, sort);
+      continue;
+    }
+
+    sections.push_back(token.str());
+  }
+  append(pOutput, file, excludes, sections, SectionScript::Unsorted);
+}
+
+void Parser::append(const std::string& pOutput,
+                    llvm::StringRef pFile,
+                    const SectionScript::PatternList& pExcludes,
+                    SectionScript::PatternList& pSections,
+                    SectionScript::SortPolicy pSort)
+{
+  if (pSections.empty() || pFile.empty())
+    return;
+
+  if ("/DISCARD/" == pOutput)
+    m_bDiscard = true;
+  else
+    m_Script.append(pOutput, pFile, pExcludes, pSections, pSort);
+  pSections.clear();
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// SectionScript
+//===----------------------------------------------------------------------===//
+SectionScript::SectionScript()
+  : m_bDiscard(false) {
+}
+
+SectionScript::~SectionScript()
+{
+}
+
+bool SectionScript::read(const sys::fs::Path& pPath)
+{
+  FileHandle file;
+  if (!file.open(pPath, FileHandle::ReadOnly))
+    return false;
+
+  std::string content(file.size(), '\0');
+  bool result = content.empty() ||
+                file.read(&content[0], 0, content.size());
+  file.close();
+  if (!result)
+    return false;
+
+  parse(content);
+  return true;
+}
+
+void SectionScript::parse(llvm::StringRef pContent)
+{
+  Parser parser(pContent, *this);
+  if (parser.run())
+    m_bDiscard = true;
+  compile();
+}
+
+void SectionScript::append(const std::string& pOutput,
+                           llvm::StringRef pFile,
+                           const PatternList& pExcludes,
+                           const PatternList& pSections,
+                           SortPolicy pSort)
+{
+  unsigned int idx = m_Rules.size();
+  m_Rules.push_back(Rule());
+  m_Rules.back().mapping = SectionMap::NamePair(std::string(), pOutput);
+  m_Rules.back().sort = pSort;
+
+  m_FileMatcher.add(pFile, idx);
+  PatternList::const_iterator pattern, pEnd = pExcludes.end();
+  for (pattern = pExcludes.begin(); pattern != pEnd; ++pattern)
+    m_ExcludeMatcher.add(*pattern, idx);
+  pEnd = pSections.end();
+  for (pattern = pSections.begin(); pattern != pEnd; ++pattern)
+    m_SectionMatcher.add(*pattern, idx);
+}
+
+void SectionScript::compile()
+{
+  m_FileMatcher.compile();
+  m_ExcludeMatcher.compile();
+  m_SectionMatcher.compile();
+}
+
+unsigned int SectionScript::find(llvm::StringRef pFile,
+                                 llvm::StringRef pSection) const
+{
+  if (empty())
+    return NoRule;
+
+  const GlobMatcher::IDList& rules = m_SectionMatcher.match(pSection);
+  if (rules.empty())
+    return NoRule;
+
+  const GlobMatcher::IDList& files = m_FileMatcher.match(pFile);
+  const GlobMatcher::IDList& excludes = m_ExcludeMatcher.match(pFile);
+  GlobMatcher::IDList::const_iterator rule, rEnd = rules.end();
+  for (rule = rules.begin(); rule != rEnd; ++rule) {
+    if (std::binary_search(files.begin(), files.end(), *rule) &&
+        !std::binary_search(excludes.begin(), excludes.end(), *rule))
+      return *rule;
+  }
+  return NoRule;
+}
+
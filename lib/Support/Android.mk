@@ -1,22 +1,36 @@
 LOCAL_PATH:= $(call my-dir)
 
 mcld_support_SRC_FILES := \
+  Arena.cpp \
   CommandLine.cpp \
+  Compression.cpp \
+  Digest.cpp \
   Directory.cpp \
   FileHandle.cpp  \
   FileSystem.cpp  \
+  GlobMatcher.cpp  \
   HandleToArea.cpp  \
   LEB128.cpp  \
+  LinkContext.cpp \
+  LinkStats.cpp \
   MemoryArea.cpp  \
   MemoryAreaFactory.cpp \
   MemoryRegion.cpp  \
+  MemoryUsage.cpp \
   MsgHandling.cpp \
+  PageHeap.cpp \
   Path.cpp  \
+  PerfCounters.cpp \
+  PathCache.cpp \
   RealPath.cpp  \
   RegionFactory.cpp \
   Space.cpp \
   SystemUtils.cpp \
   TargetRegistry.cpp  \
+  TaskQueue.cpp \
+  Thread.cpp \
+  ThreadPool.cpp \
+  TimeReport.cpp \
   ToolOutputFile.cpp  \
   raw_mem_ostream.cpp \
   raw_ostream.cpp
@@ -0,0 +1,80 @@
+//===- Arena.cpp ----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/Arena.h>
+#include <mcld/Support/PageHeap.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// Arena
+//===----------------------------------------------------------------------===//
+Arena::Arena(MemoryUsage::Kind pKind)
+  : m_Kind(pKind), m_pCurrent(NULL), m_pEnd(NULL), m_Bytes(0),
+    m_NumOfObjects(0) {
+}
+
+Arena::~Arena()
+{
+  release();
+}
+
+void* Arena::allocate(size_t pSize)
+{
+  pSize = align(pSize);
+  ++m_NumOfObjects;
+  if (MemoryUsage::isEnabled())
+    MemoryUsage::AddObjects(m_Kind);
+
+  // a large object has a slab of its own, and leaves the current slab to the
+  // following objects.
+  if (pSize > SlabSize / 4)
+    return addSlab(pSize);
+
+  if (static_cast<size_t>(m_pEnd - m_pCurrent) < pSize) {
+    char* slab = addSlab(SlabSize);
+    if (NULL == slab)
+      return NULL;
+    m_pCurrent = slab;
+    m_pEnd = slab + SlabSize;
+  }
+
+  void* result = m_pCurrent;
+  m_pCurrent += pSize;
+  return result;
+}
+
+void Arena::release()
+{
+  SlabListType::iterator slab, sEnd = m_Slabs.end();
+  for (slab = m_Slabs.begin(); slab != sEnd; ++slab)
+    PageHeap::deallocate(slab->first, slab->second);
+  if (MemoryUsage::isEnabled()) {
+    MemoryUsage::Release(m_Kind, m_Bytes);
+    MemoryUsage::RemoveObjects(m_Kind, m_NumOfObjects);
+  }
+
+  m_Slabs.clear();
+  m_pCurrent = NULL;
+  m_pEnd = NULL;
+  m_Bytes = 0;
+  m_NumOfObjects = 0;
+}
+
+char* Arena::addSlab(size_t pSize)
+{
+  char* slab = static_cast<char*>(PageHeap::allocate(pSize));
+  if (NULL == slab)
+    return NULL;
+  m_Slabs.push_back(std::make_pair(slab, pSize));
+  m_Bytes += pSize;
+  if (MemoryUsage::isEnabled())
+    MemoryUsage::Allocate(m_Kind, pSize);
+  return slab;
+}
+
@@ -117,6 +117,10 @@ bool parser<mcld::ZOption>::parse(llvm::cl::Option &O,
     Val.setKind(ZOption::MulDefs);
   else if (0 == Arg.compare("nocopyreloc"))
     Val.setKind(ZOption::NoCopyReloc);
+  else if (0 == Arg.compare("direct"))
+    Val.setKind(ZOption::Direct);
+  else if (0 == Arg.compare("nodirect"))
+    Val.setKind(ZOption::NoDirect);
   else if (0 == Arg.compare("nodefaultlib"))
     Val.setKind(ZOption::NoDefaultLib);
   else if (0 == Arg.compare("nodelete"))
@@ -135,6 +139,10 @@ bool parser<mcld::ZOption>::parse(llvm::cl::Option &O,
     Val.setKind(ZOption::Now);
   else if (0 == Arg.compare("origin"))
     Val.setKind(ZOption::Origin);
+  else if (0 == Arg.compare("separate-code"))
+    Val.setKind(ZOption::SeparateCode);
+  else if (0 == Arg.compare("noseparate-code"))
+    Val.setKind(ZOption::NoSeparateCode);
   else if (Arg.startswith("common-page-size=")) {
     Val.setKind(ZOption::CommPageSize);
     long long unsigned size = 0;
@@ -0,0 +1,227 @@
+//===- Compression.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Config/Config.h"
+#include <mcld/Support/Compression.h>
+#include <mcld/Support/ThreadPool.h>
+
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#if defined(HAVE_LIBZSTD) && HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+using namespace mcld;
+
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+
+namespace {
+
+/// ChunkCompressor - deflate the chunks of the input into the raw deflate
+/// blocks, and compute their adler-32 checksums.
+struct ChunkCompressor
+{
+  const uint8_t* data;
+  size_t size;
+  size_t chunkSize;
+  std::vector<std::vector<uint8_t> >* outputs;
+  std::vector<uLong>* checksums;
+  std::vector<char>* succeeded;
+
+  void operator()(size_t pIdx) {
+    size_t begin = pIdx * chunkSize;
+    size_t length = std::min(chunkSize, size - begin);
+    bool last = (begin + length == size);
+
+    (*checksums)[pIdx] = adler32(adler32(0L, Z_NULL, 0),
+                                 data + begin, length);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // a negative window size writes a raw deflate stream: no zlib header
+    // nor trailer
+    if (Z_OK != deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                             -15, 8, Z_DEFAULT_STRATEGY)) {
+      (*succeeded)[pIdx] = 0;
+      return;
+    }
+
+    // deflateBound() does not count the bytes of the sync flush
+    std::vector<uint8_t>& output = (*outputs)[pIdx];
+    output.resize(deflateBound(&stream, length) + 16);
+
+    stream.next_in = const_cast<Bytef*>(data + begin);
+    stream.avail_in = length;
+    stream.next_out = &output[0];
+    stream.avail_out = output.size();
+
+    int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (last)
+      (*succeeded)[pIdx] = (Z_STREAM_END == result);
+    else
+      (*succeeded)[pIdx] = (Z_OK == result && 0 == stream.avail_in &&
+                            0 != stream.avail_out);
+
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+  }
+};
+
+} // anonymous namespace
+
+#endif
+
+//===----------------------------------------------------------------------===//
+// zlib
+//===----------------------------------------------------------------------===//
+bool mcld::zlib::isAvailable()
+{
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool mcld::zlib::compress(ThreadPool& pPool,
+                          const uint8_t* pData,
+                          size_t pSize,
+                          std::vector<uint8_t>& pResult,
+                          size_t pChunkSize)
+{
+  pResult.clear();
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+  if (0 == pChunkSize)
+    pChunkSize = DefaultChunkSize;
+
+  // an empty input still has one chunk to finish the stream
+  size_t num_chunks = (0 == pSize) ? 1 : (pSize + pChunkSize - 1) / pChunkSize;
+
+  std::vector<std::vector<uint8_t> > outputs(num_chunks);
+  std::vector<uLong> checksums(num_chunks);
+  std::vector<char> succeeded(num_chunks, 0);
+
+  ChunkCompressor compressor;
+  compressor.data = pData;
+  compressor.size = pSize;
+  compressor.chunkSize = pChunkSize;
+  compressor.outputs = &outputs;
+  compressor.checksums = &checksums;
+  compressor.succeeded = &succeeded;
+  parallel_for(pPool, 0, num_chunks, compressor);
+
+  size_t total = 0;
+  for (size_t i = 0; i < num_chunks; ++i) {
+    if (!succeeded[i])
+      return false;
+    total += outputs[i].size();
+  }
+
+  // zlib header: deflate with a 32K window, the default level
+  pResult.reserve(2 + total + 4);
+  pResult.push_back(0x78);
+  pResult.push_back(0x9c);
+
+  uLong checksum = checksums[0];
+  for (size_t i = 0; i < num_chunks; ++i) {
+    pResult.insert(pResult.end(), outputs[i].begin(), outputs[i].end());
+    if (0 != i) {
+      size_t length = std::min(pChunkSize, pSize - i * pChunkSize);
+      checksum = adler32_combine(checksum, checksums[i], length);
+    }
+  }
+
+  // zlib trailer: the adler-32 checksum in big endian
+  pResult.push_back((checksum >> 24) & 0xff);
+  pResult.push_back((checksum >> 16) & 0xff);
+  pResult.push_back((checksum >> 8) & 0xff);
+  pResult.push_back(checksum & 0xff);
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+bool mcld::zlib::uncompress(const uint8_t* pData,
+                            size_t pSize,
+                            uint8_t* pResult,
+                            size_t pResultSize)
+{
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (Z_OK != inflateInit(&stream))
+    return false;
+
+  // avail_in and avail_out are 32-bit, so a large section is fed in pieces
+  const size_t max_piece = 0x40000000;
+  size_t in_left = pSize, out_left = pResultSize;
+  stream.next_in = const_cast<Bytef*>(pData);
+  stream.next_out = pResult;
+
+  // inflate() makes no progress without any output space, so an empty
+  // output is given a byte that must stay unused
+  Bytef spare;
+  if (0 == pResultSize) {
+    stream.next_out = &spare;
+    stream.avail_out = 1;
+  }
+
+  int result = Z_OK;
+  do {
+    if (0 == stream.avail_in && 0 != in_left) {
+      stream.avail_in = std::min(in_left, max_piece);
+      in_left -= stream.avail_in;
+    }
+    if (0 == stream.avail_out && 0 != out_left) {
+      stream.avail_out = std::min(out_left, max_piece);
+      out_left -= stream.avail_out;
+    }
+    // Z_BUF_ERROR means the input is truncated or the output is too small
+    result = inflate(&stream, Z_NO_FLUSH);
+  } while (Z_OK == result);
+
+  bool succeeded = (Z_STREAM_END == result && 0 == out_left &&
+                    (0 == pResultSize ? 1u : 0u) == stream.avail_out);
+  inflateEnd(&stream);
+  return succeeded;
+#else
+  return false;
+#endif
+}
+
+//===----------------------------------------------------------------------===//
+// zstd
+//===----------------------------------------------------------------------===//
+bool mcld::zstd::isAvailable()
+{
+#if defined(HAVE_LIBZSTD) && HAVE_LIBZSTD
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool mcld::zstd::uncompress(const uint8_t* pData,
+                            size_t pSize,
+                            uint8_t* pResult,
+                            size_t pResultSize)
+{
+#if defined(HAVE_LIBZSTD) && HAVE_LIBZSTD
+  size_t result = ZSTD_decompress(pResult, pResultSize, pData, pSize);
+  return (!ZSTD_isError(result) && result == pResultSize);
+#else
+  return false;
+#endif
+}
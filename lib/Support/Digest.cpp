@@ -0,0 +1,523 @@
+//===- Digest.cpp ---------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+inline uint32_t RotateLeft32(uint32_t pValue, unsigned pBits)
+{ return (pValue << pBits) | (pValue >> (32 - pBits)); }
+
+inline uint64_t RotateLeft64(uint64_t pValue, unsigned pBits)
+{ return (pValue << pBits) | (pValue >> (64 - pBits)); }
+
+inline uint32_t ReadLE32(const uint8_t* pData)
+{
+  return static_cast<uint32_t>(pData[0])        |
+         (static_cast<uint32_t>(pData[1]) << 8)  |
+         (static_cast<uint32_t>(pData[2]) << 16) |
+         (static_cast<uint32_t>(pData[3]) << 24);
+}
+
+inline uint64_t ReadLE64(const uint8_t* pData)
+{
+  return static_cast<uint64_t>(ReadLE32(pData)) |
+         (static_cast<uint64_t>(ReadLE32(pData + 4)) << 32);
+}
+
+inline uint32_t ReadBE32(const uint8_t* pData)
+{
+  return (static_cast<uint32_t>(pData[0]) << 24) |
+         (static_cast<uint32_t>(pData[1]) << 16) |
+         (static_cast<uint32_t>(pData[2]) << 8)  |
+         static_cast<uint32_t>(pData[3]);
+}
+
+inline void WriteLE32(uint8_t* pData, uint32_t pValue)
+{
+  for (unsigned i = 0; i < 4; ++i)
+    pData[i] = (pValue >> (i * 8)) & 0xff;
+}
+
+inline void WriteLE64(uint8_t* pData, uint64_t pValue)
+{
+  for (unsigned i = 0; i < 8; ++i)
+    pData[i] = (pValue >> (i * 8)) & 0xff;
+}
+
+inline void WriteBE32(uint8_t* pData, uint32_t pValue)
+{
+  for (unsigned i = 0; i < 4; ++i)
+    pData[i] = (pValue >> (24 - i * 8)) & 0xff;
+}
+
+/// PadBlocks - hash the last partial block of pData with the MD-style
+/// padding: a 0x80 byte, zeros, and the bit length in 8 bytes.
+template<typename Compressor>
+void PadBlocks(Compressor& pCompressor, const uint8_t* pData, size_t pSize,
+               bool pBigEndianLength)
+{
+  size_t full = pSize & ~static_cast<size_t>(63);
+  for (size_t offset = 0; offset < full; offset += 64)
+    pCompressor.block(pData + offset);
+
+  uint8_t tail[128];
+  size_t rest = pSize - full;
+  std::memset(tail, 0, sizeof(tail));
+  if (0 != rest)
+    std::memcpy(tail, pData + full, rest);
+  tail[rest] = 0x80;
+
+  size_t tail_size = (rest < 56) ? 64 : 128;
+  uint64_t bits = static_cast<uint64_t>(pSize) * 8;
+  for (unsigned i = 0; i < 8; ++i) {
+    unsigned shift = pBigEndianLength ? (56 - i * 8) : (i * 8);
+    tail[tail_size - 8 + i] = (bits >> shift) & 0xff;
+  }
+
+  pCompressor.block(tail);
+  if (128 == tail_size)
+    pCompressor.block(tail + 64);
+}
+
+//===----------------------------------------------------------------------===//
+// MD5, RFC 1321
+//===----------------------------------------------------------------------===//
+struct MD5Compressor
+{
+  uint32_t state[4];
+
+  MD5Compressor() {
+    state[0] = 0x67452301;
+    state[1] = 0xefcdab89;
+    state[2] = 0x98badcfe;
+    state[3] = 0x10325476;
+  }
+
+  void block(const uint8_t* pBlock) {
+    static const uint32_t k[64] = {
+      0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+      0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+      0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+      0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+      0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+      0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+      0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+      0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+      0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+      0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+      0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+    };
+    static const unsigned r[64] = {
+      7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+      5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+      4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+      6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+    };
+
+    uint32_t w[16];
+    for (unsigned i = 0; i < 16; ++i)
+      w[i] = ReadLE32(pBlock + i * 4);
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    for (unsigned i = 0; i < 64; ++i) {
+      uint32_t f;
+      unsigned g;
+      if (i < 16) {
+        f = (b & c) | (~b & d);
+        g = i;
+      }
+      else if (i < 32) {
+        f = (d & b) | (~d & c);
+        g = (5 * i + 1) % 16;
+      }
+      else if (i < 48) {
+        f = b ^ c ^ d;
+        g = (3 * i + 5) % 16;
+      }
+      else {
+        f = c ^ (b | ~d);
+        g = (7 * i) % 16;
+      }
+      uint32_t temp = d;
+      d = c;
+      c = b;
+      b = b + RotateLeft32(a + f + k[i] + w[g], r[i]);
+      a = temp;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+  }
+};
+
+void HashMD5(const uint8_t* pData, size_t pSize, uint8_t* pResult)
+{
+  MD5Compressor md5;
+  PadBlocks(md5, pData, pSize, false);
+  for (unsigned i = 0; i < 4; ++i)
+    WriteLE32(pResult + i * 4, md5.state[i]);
+}
+
+//===----------------------------------------------------------------------===//
+// SHA-1, FIPS 180-4
+//===----------------------------------------------------------------------===//
+struct SHA1Compressor
+{
+  uint32_t state[5];
+
+  SHA1Compressor() {
+    state[0] = 0x67452301;
+    state[1] = 0xefcdab89;
+    state[2] = 0x98badcfe;
+    state[3] = 0x10325476;
+    state[4] = 0xc3d2e1f0;
+  }
+
+  void block(const uint8_t* pBlock) {
+    uint32_t w[80];
+    for (unsigned i = 0; i < 16; ++i)
+      w[i] = ReadBE32(pBlock + i * 4);
+    for (unsigned i = 16; i < 80; ++i)
+      w[i] = RotateLeft32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+             e = state[4];
+    for (unsigned i = 0; i < 80; ++i) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5a827999;
+      }
+      else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ed9eba1;
+      }
+      else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8f1bbcdc;
+      }
+      else {
+        f = b ^ c ^ d;
+        k = 0xca62c1d6;
+      }
+      uint32_t temp = RotateLeft32(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = RotateLeft32(b, 30);
+      b = a;
+      a = temp;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+  }
+};
+
+void HashSHA1(const uint8_t* pData, size_t pSize, uint8_t* pResult)
+{
+  SHA1Compressor sha1;
+  PadBlocks(sha1, pData, pSize, true);
+  for (unsigned i = 0; i < 5; ++i)
+    WriteBE32(pResult + i * 4, sha1.state[i]);
+}
+
+//===----------------------------------------------------------------------===//
+// xxHash64
+//===----------------------------------------------------------------------===//
+const uint64_t Prime64_1 = 0x9e3779b185ebca87ULL;
+const uint64_t Prime64_2 = 0xc2b2ae3d27d4eb4fULL;
+const uint64_t Prime64_3 = 0x165667b19e3779f9ULL;
+const uint64_t Prime64_4 = 0x85ebca77c2b2ae63ULL;
+const uint64_t Prime64_5 = 0x27d4eb2f165667c5ULL;
+
+inline uint64_t XXRound(uint64_t pAcc, uint64_t pInput)
+{
+  pAcc += pInput * Prime64_2;
+  pAcc = RotateLeft64(pAcc, 31);
+  return pAcc * Prime64_1;
+}
+
+inline uint64_t XXMerge(uint64_t pAcc, uint64_t pValue)
+{
+  pAcc ^= XXRound(0, pValue);
+  return pAcc * Prime64_1 + Prime64_4;
+}
+
+uint64_t XXHash64(const uint8_t* pData, size_t pSize, uint64_t pSeed)
+{
+  const uint8_t* p = pData;
+  const uint8_t* end = pData + pSize;
+  uint64_t h64;
+
+  if (pSize >= 32) {
+    uint64_t v1 = pSeed + Prime64_1 + Prime64_2;
+    uint64_t v2 = pSeed + Prime64_2;
+    uint64_t v3 = pSeed;
+    uint64_t v4 = pSeed - Prime64_1;
+    const uint8_t* limit = end - 32;
+    do {
+      v1 = XXRound(v1, ReadLE64(p));
+      v2 = XXRound(v2, ReadLE64(p + 8));
+      v3 = XXRound(v3, ReadLE64(p + 16));
+      v4 = XXRound(v4, ReadLE64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h64 = RotateLeft64(v1, 1) + RotateLeft64(v2, 7) +
+          RotateLeft64(v3, 12) + RotateLeft64(v4, 18);
+    h64 = XXMerge(h64, v1);
+    h64 = XXMerge(h64, v2);
+    h64 = XXMerge(h64, v3);
+    h64 = XXMerge(h64, v4);
+  }
+  else
+    h64 = pSeed + Prime64_5;
+
+  h64 += static_cast<uint64_t>(pSize);
+
+  for (; p + 8 <= end; p += 8) {
+    h64 ^= XXRound(0, ReadLE64(p));
+    h64 = RotateLeft64(h64, 27) * Prime64_1 + Prime64_4;
+  }
+  if (p + 4 <= end) {
+    h64 ^= static_cast<uint64_t>(ReadLE32(p)) * Prime64_1;
+    h64 = RotateLeft64(h64, 23) * Prime64_2 + Prime64_3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h64 ^= (*p) * Prime64_5;
+    h64 = RotateLeft64(h64, 11) * Prime64_1;
+  }
+
+  h64 ^= h64 >> 33;
+  h64 *= Prime64_2;
+  h64 ^= h64 >> 29;
+  h64 *= Prime64_3;
+  h64 ^= h64 >> 32;
+  return h64;
+}
+
+/// ChunkHasher - hash the chunks of the input into their digests
+struct ChunkHasher
+{
+  digest::Kind kind;
+  const uint8_t* data;
+  size_t size;
+  size_t chunkSize;
+  uint8_t* digests;
+
+  void operator()(size_t pIdx) {
+    size_t begin = pIdx * chunkSize;
+    size_t length = std::min(chunkSize, size - begin);
+    digest::hash(kind, data + begin, length,
+                 digests + pIdx * digest::size(kind));
+  }
+};
+
+/// CRC32Table - the table of the reflected polynomial 0xedb88320
+struct CRC32Table
+{
+  uint32_t value[256];
+
+  CRC32Table() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (unsigned k = 0; k < 8; ++k)
+        c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+      value[i] = c;
+    }
+  }
+};
+
+const CRC32Table g_CRC32Table;
+
+/// GF2MatrixTimes - multiply the 32x32 matrix over GF(2) pMatrix by pVector
+uint32_t GF2MatrixTimes(const uint32_t* pMatrix, uint32_t pVector)
+{
+  uint32_t sum = 0;
+  for (; 0 != pVector; pVector >>= 1, ++pMatrix) {
+    if (pVector & 1)
+      sum ^= *pMatrix;
+  }
+  return sum;
+}
+
+/// GF2MatrixSquare - pSquare = pMatrix * pMatrix
+void GF2MatrixSquare(uint32_t* pSquare, const uint32_t* pMatrix)
+{
+  for (unsigned n = 0; n < 32; ++n)
+    pSquare[n] = GF2MatrixTimes(pMatrix, pMatrix[n]);
+}
+
+/// ChunkCRC - compute the CRCs of the chunks of the input
+struct ChunkCRC
+{
+  const uint8_t* data;
+  size_t size;
+  size_t chunkSize;
+  uint32_t* crcs;
+
+  void operator()(size_t pIdx) {
+    size_t begin = pIdx * chunkSize;
+    size_t length = std::min(chunkSize, size - begin);
+    crcs[pIdx] = digest::crc32(data + begin, length);
+  }
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// digest
+//===----------------------------------------------------------------------===//
+size_t digest::size(Kind pKind)
+{
+  switch (pKind) {
+    case Fast: return 8;
+    case MD5:  return 16;
+    case SHA1: return 20;
+  }
+  return 0;
+}
+
+void digest::hash(Kind pKind, const uint8_t* pData, size_t pSize,
+                  uint8_t* pResult)
+{
+  switch (pKind) {
+    case Fast:
+      WriteLE64(pResult, XXHash64(pData, pSize, 0));
+      return;
+    case MD5:
+      HashMD5(pData, pSize, pResult);
+      return;
+    case SHA1:
+      HashSHA1(pData, pSize, pResult);
+      return;
+  }
+}
+
+uint64_t digest::fast(const uint8_t* pData, size_t pSize, uint64_t pSeed)
+{
+  return XXHash64(pData, pSize, pSeed);
+}
+
+void digest::treeHash(ThreadPool& pPool,
+                      Kind pKind,
+                      const uint8_t* pData,
+                      size_t pSize,
+                      uint8_t* pResult,
+                      size_t pChunkSize)
+{
+  if (0 == pChunkSize)
+    pChunkSize = DefaultChunkSize;
+
+  size_t num_of_chunks = (pSize + pChunkSize - 1) / pChunkSize;
+  if (num_of_chunks <= 1) {
+    hash(pKind, pData, pSize, pResult);
+    return;
+  }
+
+  std::vector<uint8_t> digests(num_of_chunks * size(pKind));
+  ChunkHasher hasher;
+  hasher.kind = pKind;
+  hasher.data = pData;
+  hasher.size = pSize;
+  hasher.chunkSize = pChunkSize;
+  hasher.digests = &digests[0];
+  parallel_for(pPool, 0, num_of_chunks, hasher);
+
+  hash(pKind, &digests[0], digests.size(), pResult);
+}
+
+
+uint32_t digest::crc32(const uint8_t* pData, size_t pSize, uint32_t pCRC)
+{
+  uint32_t c = ~pCRC;
+  for (size_t i = 0; i < pSize; ++i)
+    c = g_CRC32Table.value[(c ^ pData[i]) & 0xff] ^ (c >> 8);
+  return ~c;
+}
+
+/// crc32Combine - shift the CRC of A over the pSizeB zeros by the operator
+/// of one zero bit squared into the operators of 2^n zero bytes, as
+/// crc32_combine() of zlib does
+uint32_t digest::crc32Combine(uint32_t pCRCA, uint32_t pCRCB, uint64_t pSizeB)
+{
+  if (0 == pSizeB)
+    return pCRCA;
+
+  uint32_t even[32]; // the operator of 2^n zero bits, n even
+  uint32_t odd[32];  // the operator of 2^n zero bits, n odd
+
+  // the operator of one zero bit
+  odd[0] = 0xedb88320;
+  uint32_t row = 1;
+  for (unsigned n = 1; n < 32; ++n) {
+    odd[n] = row;
+    row <<= 1;
+  }
+
+  // two, and then four zero bits
+  GF2MatrixSquare(even, odd);
+  GF2MatrixSquare(odd, even);
+
+  // apply the zero bytes of B to the CRC of A
+  do {
+    GF2MatrixSquare(even, odd);
+    if (pSizeB & 1)
+      pCRCA = GF2MatrixTimes(even, pCRCA);
+    pSizeB >>= 1;
+    if (0 == pSizeB)
+      break;
+
+    GF2MatrixSquare(odd, even);
+    if (pSizeB & 1)
+      pCRCA = GF2MatrixTimes(odd, pCRCA);
+    pSizeB >>= 1;
+  } while (0 != pSizeB);
+
+  return pCRCA ^ pCRCB;
+}
+
+uint32_t digest::crc32(ThreadPool& pPool,
+                       const uint8_t* pData,
+                       size_t pSize,
+                       size_t pChunkSize)
+{
+  if (0 == pChunkSize)
+    pChunkSize = DefaultChunkSize;
+
+  size_t num_of_chunks = (pSize + pChunkSize - 1) / pChunkSize;
+  if (num_of_chunks <= 1)
+    return crc32(pData, pSize);
+
+  std::vector<uint32_t> crcs(num_of_chunks);
+  ChunkCRC crc;
+  crc.data = pData;
+  crc.size = pSize;
+  crc.chunkSize = pChunkSize;
+  crc.crcs = &crcs[0];
+  parallel_for(pPool, 0, num_of_chunks, crc);
+
+  uint32_t result = crcs[0];
+  for (size_t i = 1; i < num_of_chunks; ++i) {
+    size_t length = std::min(pChunkSize, pSize - i * pChunkSize);
+    result = crc32Combine(result, crcs[i], length);
+  }
+  return result;
+}
@@ -19,7 +19,12 @@
 #endif
 
 #include <sys/stat.h>
-#include <sys/mman.h>
+#if defined(MCLD_ON_UNIX)
+# include <sys/mman.h>
+#endif
+#if defined(__linux__)
+# include <sys/syscall.h>
+#endif
 
 #if defined(_MSC_VER)
 #include <io.h>
@@ -138,6 +143,29 @@ bool FileHandle::delegate(int pFD, FileHandle::OpenMode pMode)
   return true;
 }
 
+bool FileHandle::openAnonymous()
+{
+  if (isOpened()) {
+    setState(BadBit);
+    return false;
+  }
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+  // MFD_CLOEXEC
+  m_Handler = ::syscall(SYS_memfd_create, "mcld-output", 0x1U);
+#else
+  m_Handler = -1;
+#endif
+  if (-1 == m_Handler) {
+    setState(FailBit);
+    return false;
+  }
+
+  m_OpenMode = ReadWrite;
+  m_Size = 0;
+  return true;
+}
+
 bool FileHandle::close()
 {
   if (!isOpened()) {
@@ -175,6 +203,27 @@ bool FileHandle::truncate(size_t pSize)
   return true;
 }
 
+bool FileHandle::allocate(size_t pSize)
+{
+  if (!isOpened() || !isWritable()) {
+    setState(BadBit);
+    return false;
+  }
+
+  if (pSize <= m_Size)
+    return truncate(pSize);
+
+#if defined(_POSIX_ADVISORY_INFO) && (_POSIX_ADVISORY_INFO > 0)
+  // posix_fallocate returns the error number instead of setting errno. The
+  // file systems without the support of preallocation get a plain truncate.
+  if (0 == ::posix_fallocate(m_Handler, 0, pSize)) {
+    m_Size = pSize;
+    return true;
+  }
+#endif
+  return truncate(pSize);
+}
+
 bool FileHandle::read(void* pMemBuffer, size_t pStartOffset, size_t pLength)
 {
   if (!isOpened() || !isReadable()) {
@@ -222,9 +271,11 @@ bool FileHandle::write(const void* pMemBuffer, size_t pStartOffset, size_t pLeng
   return true;
 }
 
-bool FileHandle::mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength)
+bool FileHandle::copy(const FileHandle& pSource, size_t pSourceOffset,
+                      size_t pStartOffset, size_t pLength)
 {
-  if (!isOpened()) {
+  if (!isOpened() || !isWritable() ||
+      !pSource.isOpened() || !pSource.isReadable()) {
     setState(BadBit);
     return false;
   }
@@ -232,31 +283,47 @@ bool FileHandle::mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength)
   if (0 == pLength)
     return true;
 
-  int prot, flag;
-  if (isReadable() && !isWritable()) {
-    // read-only
-    prot = PROT_READ;
-    flag = MAP_FILE | MAP_PRIVATE;
-  }
-  else if (!isReadable() && isWritable()) {
-    // write-only
-    prot = PROT_WRITE;
-    flag = MAP_FILE | MAP_SHARED;
+#if defined(__linux__) && defined(SYS_copy_file_range)
+  // the kernel may copy less than asked, e.g., at the boundaries of extents
+  int64_t in = pSourceOffset;
+  int64_t out = pStartOffset;
+  size_t left = pLength;
+  while (0 != left) {
+    ssize_t copied = ::syscall(SYS_copy_file_range, pSource.handler(), &in,
+                               m_Handler, &out, left, 0x0U);
+    if (copied <= 0)
+      return false;
+    left -= copied;
   }
-  else if (isReadWrite()) {
-    // read and write
-    prot = PROT_READ | PROT_WRITE;
-    flag = MAP_FILE | MAP_SHARED;
+
+  if (pStartOffset + pLength > m_Size)
+    m_Size = pStartOffset + pLength;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool FileHandle::mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength)
+{
+  if (!isOpened()) {
+    setState(BadBit);
+    return false;
   }
-  else {
+
+  if (0 == pLength)
+    return true;
+
+  if (!isReadable() && !isWritable()) {
     // can not read/write
     setState(BadBit);
     return false;
   }
 
-  pMemBuffer = ::mmap(NULL, pLength, prot, flag, m_Handler, pStartOffset);
+  pMemBuffer = sys::fs::detail::mmap(m_Handler, pStartOffset, pLength,
+                                     isReadable(), isWritable());
 
-  if (MAP_FAILED == pMemBuffer) {
+  if (NULL == pMemBuffer) {
     setState(FailBit);
     return false;
   }
@@ -271,7 +338,7 @@ bool FileHandle::munmap(void* pMemBuffer, size_t pLength)
     return false;
   }
 
-  if (-1 == ::munmap(pMemBuffer, pLength)) {
+  if (-1 == sys::fs::detail::munmap(pMemBuffer, pLength)) {
     setState(FailBit);
     return false;
   }
@@ -279,6 +346,48 @@ bool FileHandle::munmap(void* pMemBuffer, size_t pLength)
   return true;
 }
 
+bool FileHandle::advise(Advice pAdvice, size_t pStartOffset, size_t pLength)
+{
+  if (!isOpened())
+    return false;
+
+#if defined(POSIX_FADV_NORMAL)
+  int advice = POSIX_FADV_NORMAL;
+  switch (pAdvice) {
+    case SequentialAccess: advice = POSIX_FADV_SEQUENTIAL; break;
+    case RandomAccess:     advice = POSIX_FADV_RANDOM;     break;
+    case WillNeed:         advice = POSIX_FADV_WILLNEED;   break;
+    case DontNeed:         advice = POSIX_FADV_DONTNEED;   break;
+    case NormalAccess:
+    default:                                               break;
+  }
+  return (0 == ::posix_fadvise(m_Handler, pStartOffset, pLength, advice));
+#else
+  return false;
+#endif
+}
+
+bool FileHandle::madvise(void* pMemBuffer, size_t pLength, Advice pAdvice)
+{
+  if (NULL == pMemBuffer || 0 == pLength)
+    return false;
+
+#if defined(MADV_NORMAL)
+  int advice = MADV_NORMAL;
+  switch (pAdvice) {
+    case SequentialAccess: advice = MADV_SEQUENTIAL; break;
+    case RandomAccess:     advice = MADV_RANDOM;     break;
+    case WillNeed:         advice = MADV_WILLNEED;   break;
+    case DontNeed:         advice = MADV_DONTNEED;   break;
+    case NormalAccess:
+    default:                                         break;
+  }
+  return (0 == ::madvise(pMemBuffer, pLength, advice));
+#else
+  return false;
+#endif
+}
+
 void FileHandle::setState(FileHandle::IOState pState)
 {
   m_State |= pState;
@@ -315,6 +424,14 @@ bool FileHandle::isReadWrite() const
   return (FileHandle::ReadWrite == (m_OpenMode & FileHandle::ReadWrite));
 }
 
+bool FileHandle::isSeekable() const
+{
+  struct ::stat file_stat;
+  if (!isOpened() || -1 == ::fstat(m_Handler, &file_stat))
+    return false;
+  return (S_ISREG(file_stat.st_mode) || S_ISBLK(file_stat.st_mode));
+}
+
 bool FileHandle::isGood() const
 {
   return !(m_State & (BadBit | FailBit));
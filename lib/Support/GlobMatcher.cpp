@@ -0,0 +1,248 @@
+//===- GlobMatcher.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/GlobMatcher.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// GlobMatcher
+//===----------------------------------------------------------------------===//
+GlobMatcher::GlobMatcher()
+  : m_NumOfClasses(1), m_Start(0) {
+  for (unsigned int i = 0; i < 256; ++i)
+    m_Classes[i] = 0;
+}
+
+void GlobMatcher::add(llvm::StringRef pPattern, unsigned int pID)
+{
+  Pattern pattern;
+  parse(pPattern, pattern.elements);
+  pattern.id = pID;
+  pattern.base = m_Owners.size();
+  m_Owners.insert(m_Owners.end(), pattern.elements.size() + 1,
+                  m_Patterns.size());
+  m_Patterns.push_back(pattern);
+
+  m_States.clear();
+  m_Accepts.clear();
+}
+
+/// parse - the elements of pPattern. The bracket expressions are read as
+/// ExportFilter does, and an unclosed bracket is an ordinary character.
+void GlobMatcher::parse(llvm::StringRef pPattern,
+                        std::vector<Element>& pElements)
+{
+  size_t i = 0;
+  while (i < pPattern.size()) {
+    Element element;
+    element.isStar = false;
+
+    if ('*' == pPattern[i]) {
+      ++i;
+      // `**' is `*'
+      if (!pElements.empty() && pElements.back().isStar)
+        continue;
+      element.isStar = true;
+      pElements.push_back(element);
+      continue;
+    }
+
+    if ('?' == pPattern[i]) {
+      ++i;
+      element.chars.set();
+      pElements.push_back(element);
+      continue;
+    }
+
+    if ('[' == pPattern[i]) {
+      size_t j = i + 1;
+      bool negative = false;
+      if (j < pPattern.size() && ('!' == pPattern[j] || '^' == pPattern[j])) {
+        negative = true;
+        ++j;
+      }
+
+      // `]' right after the opening bracket is a member
+      size_t first = j;
+      std::bitset<256> chars;
+      while (j < pPattern.size() && (']' != pPattern[j] || first == j)) {
+        if (j + 2 < pPattern.size() && '-' == pPattern[j + 1] &&
+            ']' != pPattern[j + 2]) {
+          unsigned int low = static_cast<unsigned char>(pPattern[j]);
+          unsigned int high = static_cast<unsigned char>(pPattern[j + 2]);
+          for (unsigned int c = low; c <= high; ++c)
+            chars.set(c);
+          j += 3;
+        }
+        else {
+          chars.set(static_cast<unsigned char>(pPattern[j]));
+          ++j;
+        }
+      }
+
+      if (j < pPattern.size()) {
+        element.chars = negative ? ~chars : chars;
+        pElements.push_back(element);
+        i = j + 1;
+        continue;
+      }
+    }
+
+    element.chars.set(static_cast<unsigned char>(pPattern[i]));
+    pElements.push_back(element);
+    ++i;
+  }
+}
+
+/// computeClasses - refine the partition of the characters by the character
+/// set of every element
+void GlobMatcher::computeClasses()
+{
+  for (unsigned int c = 0; c < 256; ++c)
+    m_Classes[c] = 0;
+  m_NumOfClasses = 1;
+
+  std::vector<Pattern>::const_iterator pattern, pEnd = m_Patterns.end();
+  for (pattern = m_Patterns.begin(); pattern != pEnd; ++pattern) {
+    std::vector<Element>::const_iterator elem, eEnd = pattern->elements.end();
+    for (elem = pattern->elements.begin(); elem != eEnd; ++elem) {
+      if (elem->isStar || 256 == elem->chars.count())
+        continue;
+
+      // a class is split into the characters in the set and the others
+      std::vector<unsigned int> remap(2 * m_NumOfClasses, ~0u);
+      unsigned int num = 0;
+      for (unsigned int c = 0; c < 256; ++c) {
+        unsigned int key = 2 * m_Classes[c] + (elem->chars[c] ? 1 : 0);
+        if (~0u == remap[key])
+          remap[key] = num++;
+        m_Classes[c] = remap[key];
+      }
+      m_NumOfClasses = num;
+    }
+  }
+}
+
+void GlobMatcher::closure(PositionSet& pSet) const
+{
+  // `*' matches nothing, too. The element after `*' is never `*'.
+  size_t size = pSet.size();
+  for (size_t i = 0; i < size; ++i) {
+    const Element* element = getElement(pSet[i]);
+    if (NULL != element && element->isStar)
+      pSet.push_back(pSet[i] + 1);
+  }
+  std::sort(pSet.begin(), pSet.end());
+  pSet.erase(std::unique(pSet.begin(), pSet.end()), pSet.end());
+}
+
+const GlobMatcher::Element* GlobMatcher::getElement(unsigned int pPos) const
+{
+  const Pattern& pattern = m_Patterns[m_Owners[pPos]];
+  size_t idx = pPos - pattern.base;
+  if (idx == pattern.elements.size())
+    return NULL;
+  return &pattern.elements[idx];
+}
+
+unsigned int GlobMatcher::getState(const PositionSet& pSet,
+                                   StateMap& pStateMap,
+                                   std::vector<PositionSet>& pSets)
+{
+  StateMap::iterator it = pStateMap.find(pSet);
+  if (pStateMap.end() != it)
+    return it->second;
+
+  unsigned int index = m_States.size();
+  pStateMap[pSet] = index;
+  pSets.push_back(pSet);
+
+  State state;
+  state.next.assign(m_NumOfClasses, 0);
+  state.accept = 0;
+
+  IDList ids;
+  PositionSet::const_iterator pos, pEnd = pSet.end();
+  for (pos = pSet.begin(); pos != pEnd; ++pos) {
+    if (NULL == getElement(*pos))
+      ids.push_back(m_Patterns[m_Owners[*pos]].id);
+  }
+  if (!ids.empty()) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    state.accept = m_Accepts.size();
+    m_Accepts.push_back(ids);
+  }
+
+  m_States.push_back(state);
+  return index;
+}
+
+void GlobMatcher::compile()
+{
+  m_States.clear();
+  m_Accepts.clear();
+  computeClasses();
+
+  // a representative character of every class
+  std::vector<unsigned int> rep(m_NumOfClasses, 0);
+  for (int c = 255; c >= 0; --c)
+    rep[m_Classes[c]] = c;
+
+  StateMap state_map;
+  std::vector<PositionSet> sets;
+
+  // the dead state accepts nothing
+  m_Accepts.push_back(IDList());
+  getState(PositionSet(), state_map, sets);
+
+  PositionSet start;
+  std::vector<Pattern>::const_iterator pattern, pEnd = m_Patterns.end();
+  for (pattern = m_Patterns.begin(); pattern != pEnd; ++pattern)
+    start.push_back(pattern->base);
+  closure(start);
+  m_Start = getState(start, state_map, sets);
+
+  // the new states are appended to sets while the old ones are visited
+  for (size_t s = 1; s < sets.size(); ++s) {
+    PositionSet current = sets[s];
+    for (unsigned int k = 0; k < m_NumOfClasses; ++k) {
+      PositionSet next;
+      PositionSet::const_iterator pos, posEnd = current.end();
+      for (pos = current.begin(); pos != posEnd; ++pos) {
+        const Element* element = getElement(*pos);
+        if (NULL == element)
+          continue;
+        if (element->isStar)
+          next.push_back(*pos);
+        else if (element->chars[rep[k]])
+          next.push_back(*pos + 1);
+      }
+      closure(next);
+      unsigned int target = getState(next, state_map, sets);
+      m_States[s].next[k] = target;
+    }
+  }
+}
+
+const GlobMatcher::IDList& GlobMatcher::match(llvm::StringRef pName) const
+{
+  assert(isCompiled() && "GlobMatcher is not compiled!");
+
+  unsigned int state = m_Start;
+  for (size_t i = 0; i < pName.size() && 0 != state; ++i) {
+    unsigned char c = static_cast<unsigned char>(pName[i]);
+    state = m_States[state].next[m_Classes[c]];
+  }
+  return m_Accepts[m_States[state].accept];
+}
+
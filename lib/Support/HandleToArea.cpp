@@ -24,6 +24,7 @@ bool HandleToArea::push_back(FileHandle* pHandle, MemoryArea* pArea)
                               llvm::StringRef(pHandle->path().native().c_str(),
                                               pHandle->path().native().size()));
 
+  sys::fs::cached::file_id(pHandle->path(), bucket.id);
   bucket.handle = pHandle;
   bucket.area = pArea;
   m_AreaMap.push_back(bucket);
@@ -71,6 +72,10 @@ HandleToArea::Result HandleToArea::findFirst(const sys::fs::Path& pPath)
     }
   }
 
+  const Bucket* same_file = findByID(pPath);
+  if (NULL != same_file)
+    return Result(same_file->handle, same_file->area);
+
   return Result(NULL, NULL);
 }
 
@@ -89,6 +94,27 @@ HandleToArea::ConstResult HandleToArea::findFirst(const sys::fs::Path& pPath) co
     }
   }
 
+  const Bucket* same_file = findByID(pPath);
+  if (NULL != same_file)
+    return ConstResult(same_file->handle, same_file->area);
+
   return ConstResult(NULL, NULL);
 }
 
+/// findByID - find the record of the physical file of pPath
+const HandleToArea::Bucket*
+HandleToArea::findByID(const sys::fs::Path& pPath) const
+{
+  sys::fs::FileID id;
+  sys::fs::cached::file_id(pPath, id);
+  if (!id.isValid())
+    return NULL;
+
+  HandleToAreaMap::const_iterator bucket, bEnd = m_AreaMap.end();
+  for (bucket = m_AreaMap.begin(); bucket != bEnd; ++bucket) {
+    if (bucket->id == id)
+      return &(*bucket);
+  }
+  return NULL;
+}
+
@@ -7,6 +7,15 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/Support/LEB128.h>
+#include <mcld/ADT/SizeTraits.h>
+
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MathExtras.h>
+
+#include <cstring>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 namespace mcld {
 
@@ -224,5 +233,117 @@ int64_t decode<int64_t>(const ByteType *&pBuf) {
   return result;
 }
 
+//===------------------- LEB128 Word-at-a-time APIs ----------------------===//
+namespace {
+
+/*
+ * The continuation bits of eight bytes. A byte whose bit is clear ends a
+ * value.
+ */
+const uint64_t ContinuationBits = 0x8080808080808080ULL;
+
+/*
+ * Load the eight bytes at pBuf. The first byte is the least significant one
+ * on every host.
+ */
+inline uint64_t load(const ByteType *pBuf) {
+  uint64_t word;
+  memcpy(&word, pBuf, sizeof(word));
+  if (!llvm::sys::isLittleEndianHost())
+    word = mcld::bswap64(word);
+  return word;
+}
+
+/*
+ * Gather the 7-bit groups of the first pSize bytes of pWord into an integer.
+ * Without BMI2, each step merges neighbouring groups of 7, 14 and 28 bits.
+ */
+inline uint64_t compact(uint64_t pWord, unsigned pSize) {
+  if (pSize < sizeof(pWord))
+    pWord &= (static_cast<uint64_t>(1) << (8 * pSize)) - 1;
+#if defined(__BMI2__)
+  return _pext_u64(pWord, 0x7f7f7f7f7f7f7f7fULL);
+#else
+  pWord &= 0x7f7f7f7f7f7f7f7fULL;
+  pWord = ((pWord & 0x7f007f007f007f00ULL) >> 1) |
+           (pWord & 0x007f007f007f007fULL);
+  pWord = ((pWord & 0x3fff00003fff0000ULL) >> 2) |
+           (pWord & 0x00003fff00003fffULL);
+  pWord = ((pWord & 0x0fffffff00000000ULL) >> 4) |
+           (pWord & 0x000000000fffffffULL);
+  return pWord;
+#endif
+}
+
+} // anonymous namespace
+
+const ByteType *skip(const ByteType *pBuf, const ByteType *pEnd,
+                     size_t pNum) {
+  while (pNum > 0 && (pEnd - pBuf) >= 8) {
+    uint64_t stops = ~load(pBuf) & ContinuationBits;
+    size_t num = llvm::CountPopulation_64(stops);
+    if (num < pNum) {
+      // all values ending in these bytes are skipped
+      pBuf += 8;
+      pNum -= num;
+      continue;
+    }
+    // drop the stops of the first pNum - 1 values
+    while (--pNum > 0)
+      stops &= (stops - 1);
+    return pBuf + (llvm::CountTrailingZeros_64(stops) >> 3) + 1;
+  }
+
+  // the last bytes of the buffer
+  while (pNum > 0) {
+    if (pBuf >= pEnd)
+      return NULL;
+    if ((*pBuf++ & 0x80) == 0)
+      --pNum;
+  }
+  return pBuf;
+}
+
+const ByteType *decode(const ByteType *pBuf, const ByteType *pEnd,
+                       uint64_t *pValues, size_t pNum) {
+  size_t i = 0;
+  while (i < pNum) {
+    if ((pEnd - pBuf) >= 8) {
+      uint64_t word = load(pBuf);
+      uint64_t stops = ~word & ContinuationBits;
+      if (stops != 0) {
+        // decode every value ending in these bytes
+        unsigned used = 0;
+        do {
+          unsigned size = (llvm::CountTrailingZeros_64(stops) >> 3) + 1;
+          pValues[i++] = compact(word, size);
+          used += size;
+          if (used == 8)
+            break;
+          word >>= (8 * size);
+          stops >>= (8 * size);
+        } while (i < pNum && stops != 0);
+        pBuf += used;
+        continue;
+      }
+    }
+
+    // Large number or the last bytes of the buffer.
+    uint64_t result = 0;
+    unsigned shift = 0;
+    ByteType byte;
+    do {
+      if (pBuf >= pEnd)
+        return NULL;
+      byte = *pBuf++;
+      if (shift < (8 * sizeof(result)))
+        result |= (static_cast<uint64_t>(byte & 0x7f) << shift);
+      shift += 7;
+    } while (byte & 0x80);
+    pValues[i++] = result;
+  }
+  return pBuf;
+}
+
 } // namespace of leb128
 } // namespace of mcld
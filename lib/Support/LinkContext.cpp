@@ -0,0 +1,81 @@
+//===- LinkContext.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/LinkContext.h>
+#include <mcld/LD/RelocationFactory.h>
+#include <mcld/Support/Thread.h>
+#include <mcld/Support/raw_ostream.h>
+
+#include <llvm/Support/ManagedStatic.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// static variables
+//===----------------------------------------------------------------------===//
+static llvm::ManagedStatic<LinkContext> g_DefaultContext;
+static llvm::ManagedStatic<sys::ThreadLocal> g_CurrentContext;
+
+//===----------------------------------------------------------------------===//
+// LinkContext
+//===----------------------------------------------------------------------===//
+LinkContext::LinkContext()
+  : m_pOuts(NULL), m_pErrs(NULL), m_TraceCounter(0), m_pRelocFactory(NULL) {
+}
+
+LinkContext::~LinkContext()
+{
+  // the calling thread must not keep a destroyed context
+  if (this == GetCurrent())
+    SetCurrent(NULL);
+  delete m_pRelocFactory;
+}
+
+LinkContext& LinkContext::Current()
+{
+  LinkContext* context = GetCurrent();
+  if (NULL == context)
+    return *g_DefaultContext;
+  return *context;
+}
+
+void LinkContext::activate()
+{
+  SetCurrent(this);
+}
+
+void LinkContext::SetCurrent(LinkContext* pContext)
+{
+  g_CurrentContext->set(pContext);
+}
+
+LinkContext* LinkContext::GetCurrent()
+{
+  return static_cast<LinkContext*>(g_CurrentContext->get());
+}
+
+raw_fd_ostream& LinkContext::outs()
+{
+  if (NULL == m_pOuts)
+    return mcld::process_outs();
+  return *m_pOuts;
+}
+
+raw_fd_ostream& LinkContext::errs()
+{
+  if (NULL == m_pErrs)
+    return mcld::process_errs();
+  return *m_pErrs;
+}
+
+RelocationFactory& LinkContext::getRelocationFactory()
+{
+  if (NULL == m_pRelocFactory)
+    m_pRelocFactory = new RelocationFactory();
+  return *m_pRelocFactory;
+}
@@ -0,0 +1,174 @@
+//===- LinkStats.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/LinkStats.h>
+#include <mcld/Support/Thread.h>
+#include <mcld/LD/Relocator.h>
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+
+namespace { // anonymous
+
+const unsigned int NumOfRelocTypes = 256;
+
+sys::Mutex g_Lock;
+uint64_t g_Counters[LinkStats::NumOfCounters];
+uint64_t g_Relocations[NumOfRelocTypes];
+
+const char* const g_Names[LinkStats::NumOfCounters] = {
+  "object files",
+  "archives",
+  "shared objects",
+  "scripts",
+  "archive symbol lookups",
+  "archive members scanned",
+  "archive members included",
+  "symbols inserted",
+  "symbols resolved",
+  "symbols overridden",
+  "hash table lookups",
+  "hash table probes",
+  "hash table longest probe",
+  "hash table rehashes",
+  "relocations",
+  "GOT entries",
+  "PLT entries",
+  "relaxation iterations",
+  "branch islands",
+  "stubs",
+  "bytes mapped",
+  "bytes copied"
+};
+
+/// Phase - a phase and its first counter. The last one ends the counters.
+struct Phase
+{
+  const char* name;
+  LinkStats::Counter begin;
+};
+
+const Phase g_Phases[] = {
+  { "Inputs",            LinkStats::ObjectInputs },
+  { "Symbol Resolution", LinkStats::SymbolsInserted },
+  { "Relocations",       LinkStats::Relocations },
+  { "Layout",            LinkStats::RelaxationIterations },
+  { "Input and Output",  LinkStats::BytesMapped },
+  { NULL,                LinkStats::NumOfCounters }
+};
+
+/// PrintCounter - print a row of the table
+void PrintCounter(llvm::raw_ostream& pOS, uint64_t pValue, const char* pName)
+{
+  pOS << llvm::format("  %14llu  ", static_cast<unsigned long long>(pValue))
+      << pName << '\n';
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LinkStats
+//===----------------------------------------------------------------------===//
+bool LinkStats::g_bEnabled = false;
+
+void LinkStats::Enable(bool pEnable)
+{
+  g_bEnabled = pEnable;
+}
+
+void LinkStats::Add(Counter pCounter, uint64_t pNum)
+{
+  sys::ScopedLock lock(g_Lock);
+  g_Counters[pCounter] += pNum;
+}
+
+void LinkStats::Set(Counter pCounter, uint64_t pValue)
+{
+  sys::ScopedLock lock(g_Lock);
+  g_Counters[pCounter] = pValue;
+}
+
+void LinkStats::AddProbes(uint64_t pProbes)
+{
+  sys::ScopedLock lock(g_Lock);
+  ++g_Counters[HashLookups];
+  g_Counters[HashProbes] += pProbes;
+  if (pProbes > g_Counters[HashMaxProbes])
+    g_Counters[HashMaxProbes] = pProbes;
+}
+
+void LinkStats::AddRelocation(uint8_t pType)
+{
+  sys::ScopedLock lock(g_Lock);
+  ++g_Counters[Relocations];
+  ++g_Relocations[pType];
+}
+
+uint64_t LinkStats::Get(Counter pCounter)
+{
+  sys::ScopedLock lock(g_Lock);
+  return g_Counters[pCounter];
+}
+
+uint64_t LinkStats::GetRelocations(uint8_t pType)
+{
+  sys::ScopedLock lock(g_Lock);
+  return g_Relocations[pType];
+}
+
+const char* LinkStats::GetName(Counter pCounter)
+{
+  return g_Names[pCounter];
+}
+
+void LinkStats::Reset()
+{
+  sys::ScopedLock lock(g_Lock);
+  for (int counter = 0; counter < NumOfCounters; ++counter)
+    g_Counters[counter] = 0;
+  for (unsigned int type = 0; type < NumOfRelocTypes; ++type)
+    g_Relocations[type] = 0;
+}
+
+void LinkStats::Print(llvm::raw_ostream& pOS, const Relocator* pRelocator)
+{
+  pOS << "===" << std::string(70, '-') << "===\n"
+      << std::string(25, ' ') << "MCLinker Statistics\n"
+      << "===" << std::string(70, '-') << "===\n";
+
+  for (const Phase* phase = g_Phases; NULL != phase->name; ++phase) {
+    pOS << phase->name << ":\n";
+    for (int counter = phase->begin; counter < (phase + 1)->begin; ++counter) {
+      Counter kind = static_cast<Counter>(counter);
+      PrintCounter(pOS, Get(kind), GetName(kind));
+
+      // the relocations by type follow their sum
+      if (Relocations != kind)
+        continue;
+      for (unsigned int type = 0; type < NumOfRelocTypes; ++type) {
+        uint64_t num = GetRelocations(type);
+        if (0 == num)
+          continue;
+        pOS << "  ";
+        if (NULL != pRelocator)
+          PrintCounter(pOS, num, pRelocator->getName(type));
+        else {
+          std::string name("type ");
+          name += llvm::utostr(type);
+          PrintCounter(pOS, num, name.c_str());
+        }
+      }
+    }
+  }
+}
+
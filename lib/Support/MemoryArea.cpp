@@ -12,8 +12,30 @@
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/MsgHandling.h>
 
+#include <algorithm>
+
 using namespace mcld;
 
+//===--------------------------------------------------------------------===//
+// Helper Functions
+//===--------------------------------------------------------------------===//
+static inline bool StartBefore(const Space* pSpace, size_t pOffset)
+{
+  return pSpace->start() < pOffset;
+}
+
+static inline bool OffsetBefore(size_t pOffset, const Space* pSpace)
+{
+  return pOffset < pSpace->start();
+}
+
+static inline bool Contains(const Space& pSpace, size_t pOffset,
+                            size_t pLength)
+{
+  return (pSpace.start() <= pOffset &&
+          pOffset + pLength <= pSpace.start() + pSpace.size());
+}
+
 //===--------------------------------------------------------------------===//
 // MemoryArea
 //===--------------------------------------------------------------------===//
@@ -21,13 +43,14 @@ using namespace mcld;
 // This constructor is used for *SPECIAL* situation. I'm sorry I can not
 // reveal what is the special situation.
 MemoryArea::MemoryArea(Space& pUniverse)
-  : m_pFileHandle(NULL) {
-  m_SpaceMap.insert(std::make_pair(Key(pUniverse.start(), pUniverse.size()),
-                                   &pUniverse));
+  : m_MaxSpaceSize(0), m_pWholeFile(NULL), m_pFileHandle(NULL),
+    m_bMapping(true) {
+  insert(pUniverse);
 }
 
 MemoryArea::MemoryArea(FileHandle& pFileHandle)
-  : m_pFileHandle(&pFileHandle) {
+  : m_MaxSpaceSize(0), m_pWholeFile(NULL), m_pFileHandle(&pFileHandle),
+    m_bMapping(true) {
 }
 
 MemoryArea::~MemoryArea()
@@ -62,8 +85,12 @@ MemoryRegion* MemoryArea::request(size_t pOffset, size_t pLength)
       unreachable(diag::err_out_of_range_region) << pOffset << pLength;
     }
 
-    space = Space::Create(*m_pFileHandle, pOffset, pLength);
-    m_SpaceMap.insert(std::make_pair(Key(space->start(), space->size()), space));
+    if (m_bMapping)
+      space = Space::Create(*m_pFileHandle, pOffset, pLength);
+    else
+      space = Space::Create(*m_pFileHandle, pOffset, pLength,
+                            Space::ALLOCATED_ARRAY);
+    insert(*space);
   }
 
   // adjust r_start
@@ -74,6 +101,83 @@ MemoryRegion* MemoryArea::request(size_t pOffset, size_t pLength)
   return MemoryRegion::Create(r_start, pLength, *space);
 }
 
+// view - get a read-only view of a range of the file
+MemoryView MemoryArea::view(size_t pOffset, size_t pLength)
+{
+  // the whole mapped file and the universal space are kept until clear()
+  if (NULL != m_pWholeFile && Contains(*m_pWholeFile, pOffset, pLength)) {
+    return MemoryView(m_pWholeFile->memory() +
+                      (pOffset - m_pWholeFile->start()), pLength);
+  }
+
+  if (NULL == m_pFileHandle) {
+    Space* space = find(pOffset, pLength);
+    if (NULL != space)
+      return MemoryView(space->memory() + (pOffset - space->start()), pLength);
+  }
+
+  // keep the region until clear(), so that release() never drops the space
+  // under the view
+  MemoryRegion* region = request(pOffset, pLength);
+  m_ViewRegions.push_back(region);
+  return MemoryView(region->start(), pLength);
+}
+
+// mapWholeFile - map the whole file into one space
+bool MemoryArea::mapWholeFile()
+{
+  if (NULL != m_pWholeFile)
+    return true;
+
+  if (NULL == m_pFileHandle || !m_pFileHandle->isOpened())
+    return false;
+
+  m_pWholeFile = Space::Create(*m_pFileHandle);
+  if (NULL == m_pWholeFile)
+    return false;
+
+  insert(*m_pWholeFile);
+  return true;
+}
+
+// prefetch - ask the system to read the file ahead
+void MemoryArea::prefetch()
+{
+  if (NULL == m_pFileHandle || !m_pFileHandle->isOpened())
+    return;
+
+  // readers jump between tables of the file. Let the system read the whole
+  // file in the background instead of faulting in pages one by one.
+  if (NULL != m_pWholeFile)
+    Space::Advise(m_pWholeFile, *m_pFileHandle, FileHandle::WillNeed);
+  else
+    m_pFileHandle->advise(FileHandle::WillNeed);
+}
+
+// preload - read a range of the file without creating a MemoryRegion
+Space* MemoryArea::preload(size_t pOffset, size_t pLength)
+{
+  {
+    sys::ScopedLock locker(m_PreloadMutex);
+    Space* space = find(pOffset, pLength);
+    if (NULL != space)
+      return space;
+  }
+
+  // we never touch the diagnostic engine here, leave the out-of-range
+  // requests to request().
+  if (NULL == m_pFileHandle || 0 == pLength ||
+      pOffset + pLength > m_pFileHandle->size())
+    return NULL;
+
+  // read the file out of the lock, so that the preloads of different ranges
+  // do not wait for each other
+  Space* space = Space::Create(*m_pFileHandle, pOffset, pLength);
+  sys::ScopedLock locker(m_PreloadMutex);
+  insert(*space);
+  return space;
+}
+
 // release - release a MemoryRegion
 void MemoryArea::release(MemoryRegion* pRegion)
 {
@@ -83,7 +187,7 @@ void MemoryArea::release(MemoryRegion* pRegion)
   Space *space = pRegion->parent();
   MemoryRegion::Destroy(pRegion);
 
-  if (0 == space->numOfRegions()) {
+  if (0 == space->numOfRegions() && space != m_pWholeFile) {
 
     if (NULL != m_pFileHandle) {
       // if m_pFileHandle is NULL, clients delegate us an universal Space and
@@ -94,14 +198,7 @@ void MemoryArea::release(MemoryRegion* pRegion)
         Space::Sync(space, *m_pFileHandle);
       }
 
-      std::pair<SpaceMapType::iterator, SpaceMapType::iterator> range =
-        m_SpaceMap.equal_range(Key(space->start(), space->size()));
-      SpaceMapType::iterator it;
-      for (it = range.first; it != range.second; ++it) {
-        if (space == it->second)
-          break;
-      }
-      m_SpaceMap.erase(it);
+      erase(*space);
 
       Space::Release(space, *m_pFileHandle);
       assert(NULL != space);
@@ -116,24 +213,55 @@ void MemoryArea::clear()
   if (NULL == m_pFileHandle)
     return;
 
-  SpaceMapType::iterator space, sEnd = m_SpaceMap.end();
+  RegionList::iterator region, rEnd = m_ViewRegions.end();
+  for (region = m_ViewRegions.begin(); region != rEnd; ++region)
+    MemoryRegion::Destroy(*region);
+  m_ViewRegions.clear();
+
+  SpaceList::iterator space, sEnd = m_SpaceList.end();
   if (m_pFileHandle->isWritable()) {
-    for (space = m_SpaceMap.begin(); space != sEnd; ++space) {
-      Space::Sync(space->second, *m_pFileHandle);
-      Space::Release(space->second, *m_pFileHandle);
-      assert(NULL != space->second);
-      Space::Destroy(space->second);
+    for (space = m_SpaceList.begin(); space != sEnd; ++space) {
+      Space::Sync(*space, *m_pFileHandle);
+      Space::Release(*space, *m_pFileHandle);
+      assert(NULL != *space);
+      Space::Destroy(*space);
     }
   }
   else {
-    for (space = m_SpaceMap.begin(); space != sEnd; ++space) {
-      Space::Release(space->second, *m_pFileHandle);
-      assert(NULL != space->second);
-      Space::Destroy(space->second);
+    for (space = m_SpaceList.begin(); space != sEnd; ++space) {
+      Space::Release(*space, *m_pFileHandle);
+      assert(NULL != *space);
+      Space::Destroy(*space);
     }
   }
 
-  m_SpaceMap.clear();
+  m_SpaceList.clear();
+  m_MaxSpaceSize = 0;
+  m_pWholeFile = NULL;
+}
+
+// advise - tell the system how all spaces of the file will be accessed.
+void MemoryArea::advise(FileHandle::Advice pAdvice)
+{
+  if (NULL == m_pFileHandle)
+    return;
+
+  SpaceList::iterator space, sEnd = m_SpaceList.end();
+  for (space = m_SpaceList.begin(); space != sEnd; ++space)
+    Space::Advise(*space, *m_pFileHandle, pAdvice);
+}
+
+// size - the size of the file or the universal space
+size_t MemoryArea::size() const
+{
+  if (NULL != m_pFileHandle)
+    return m_pFileHandle->size();
+
+  // the universal space is the only space of an area without file handler
+  if (m_SpaceList.empty())
+    return 0;
+  const Space* universe = m_SpaceList.front();
+  return universe->start() + universe->size();
 }
 
 //===--------------------------------------------------------------------===//
@@ -141,19 +269,52 @@ void MemoryArea::clear()
 //===--------------------------------------------------------------------===//
 Space* MemoryArea::find(size_t pOffset, size_t pLength)
 {
-  SpaceMapType::iterator it = m_SpaceMap.find(Key(pOffset, pLength));
-  if (it != m_SpaceMap.end())
-    return it->second;
+  return const_cast<Space*>(
+           static_cast<const MemoryArea*>(this)->find(pOffset, pLength));
+}
 
+const Space* MemoryArea::find(size_t pOffset, size_t pLength) const
+{
+  // walk backward from the last space starting at or before pOffset, until
+  // no space can reach pOffset.
+  SpaceList::const_iterator it = std::upper_bound(m_SpaceList.begin(),
+                                                  m_SpaceList.end(),
+                                                  pOffset,
+                                                  OffsetBefore);
+  while (it != m_SpaceList.begin()) {
+    --it;
+    if (Contains(**it, pOffset, pLength))
+      return *it;
+    if ((*it)->start() + m_MaxSpaceSize < pOffset)
+      break;
+  }
   return NULL;
 }
 
-const Space* MemoryArea::find(size_t pOffset, size_t pLength) const
+void MemoryArea::insert(Space& pSpace)
 {
-  SpaceMapType::const_iterator it = m_SpaceMap.find(Key(pOffset, pLength));
-  if (it != m_SpaceMap.end())
-    return it->second;
+  // insert after the spaces with the same start, so that the older ones are
+  // found first.
+  SpaceList::iterator it = std::upper_bound(m_SpaceList.begin(),
+                                            m_SpaceList.end(),
+                                            pSpace.start(),
+                                            OffsetBefore);
+  m_SpaceList.insert(it, &pSpace);
+  if (pSpace.size() > m_MaxSpaceSize)
+    m_MaxSpaceSize = pSpace.size();
+}
 
-  return NULL;
+void MemoryArea::erase(Space& pSpace)
+{
+  SpaceList::iterator it = std::lower_bound(m_SpaceList.begin(),
+                                            m_SpaceList.end(),
+                                            pSpace.start(),
+                                            StartBefore);
+  for (; it != m_SpaceList.end() && (*it)->start() == pSpace.start(); ++it) {
+    if (&pSpace == *it) {
+      m_SpaceList.erase(it);
+      return;
+    }
+  }
 }
 
@@ -10,9 +10,43 @@
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/SystemUtils.h>
 #include <mcld/Support/Space.h>
+#include <mcld/Support/ThreadPool.h>
 
 using namespace mcld;
 
+namespace {
+
+/// FileOpener - the body of parallel_for to open the i-th file
+struct FileOpener
+{
+  const std::vector<sys::fs::Path>* paths;
+  std::vector<FileHandle*>* handles;
+  FileHandle::OpenMode mode;
+
+  void operator()(size_t pIdx) {
+    // stat() through the cache, so that looking up the file by its FileID
+    // later does not ask the file system again.
+    const sys::fs::Path& path = (*paths)[pIdx];
+    sys::fs::FileID id;
+    sys::fs::cached::file_id(path, id);
+    if (!id.isValid())
+      return;
+
+    FileHandle* handle = new FileHandle();
+    if (!handle->open(path, mode)) {
+      delete handle;
+      return;
+    }
+    // readers jump between the tables of an input. Read it ahead in the
+    // background while the other files are opened.
+    if (handle->isReadable() && !handle->isWritable())
+      handle->advise(FileHandle::WillNeed);
+    (*handles)[pIdx] = handle;
+  }
+};
+
+} // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // MemoryAreaFactory
 //===----------------------------------------------------------------------===//
@@ -43,6 +77,14 @@ MemoryAreaFactory::produce(const sys::fs::Path& pPath,
       error(diag::err_cannot_open_file) << pPath
                                         << sys::strerror(handler->error());
     }
+    else if (handler->isReadable() && !handler->isWritable()) {
+      // readers mostly walk through inputs from the beginning to the end.
+      handler->advise(FileHandle::SequentialAccess);
+    }
+    else if (handler->isWritable()) {
+      // the file may be created or truncated by the opening.
+      sys::fs::cached::forget(pPath);
+    }
 
     MemoryArea* result = allocate();
     new (result) MemoryArea(*handler);
@@ -67,6 +109,14 @@ MemoryAreaFactory::produce(const sys::fs::Path& pPath,
       error(diag::err_cannot_open_file) << pPath
                                         << sys::strerror(handler->error());
     }
+    else if (handler->isReadable() && !handler->isWritable()) {
+      // readers mostly walk through inputs from the beginning to the end.
+      handler->advise(FileHandle::SequentialAccess);
+    }
+    else if (handler->isWritable()) {
+      // the file may be created or truncated by the opening.
+      sys::fs::cached::forget(pPath);
+    }
 
     MemoryArea* result = allocate();
     new (result) MemoryArea(*handler);
@@ -78,6 +128,32 @@ MemoryAreaFactory::produce(const sys::fs::Path& pPath,
   return map_result.area;
 }
 
+void MemoryAreaFactory::open(ThreadPool& pPool,
+                             const std::vector<sys::fs::Path>& pPaths,
+                             FileHandle::OpenMode pMode)
+{
+  std::vector<FileHandle*> handles(pPaths.size(), NULL);
+  FileOpener opener = { &pPaths, &handles, pMode };
+  parallel_for(pPool, 0, pPaths.size(), opener);
+
+  // register the opened files in order. A file may be opened already, by
+  // the same path or by another one.
+  for (size_t i = 0; i < pPaths.size(); ++i) {
+    if (NULL == handles[i])
+      continue;
+
+    if (NULL != m_HandleToArea.findFirst(pPaths[i]).area) {
+      handles[i]->close();
+      delete handles[i];
+      continue;
+    }
+
+    MemoryArea* result = allocate();
+    new (result) MemoryArea(*handles[i]);
+    m_HandleToArea.push_back(handles[i], result);
+  }
+}
+
 MemoryArea* MemoryAreaFactory::produce(void* pMemBuffer, size_t pSize)
 {
   Space* space = Space::Create(pMemBuffer, pSize);
@@ -102,7 +178,8 @@ void MemoryAreaFactory::destruct(MemoryArea* pArea)
 {
   m_HandleToArea.erase(pArea);
   pArea->clear();
-  pArea->handler()->close();
+  if (pArea->hasHandler())
+    pArea->handler()->close();
   destroy(pArea);
   deallocate(pArea);
 }
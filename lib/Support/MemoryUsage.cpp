@@ -0,0 +1,135 @@
+//===- MemoryUsage.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/MemoryUsage.h>
+#include <mcld/Support/Thread.h>
+
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+
+namespace { // anonymous
+
+sys::Mutex g_Lock;
+MemoryUsage::Counter g_Counters[MemoryUsage::NumOfKinds];
+
+const char* const g_Names[MemoryUsage::NumOfKinds] = {
+  "GCFactory",
+  "NamePool",
+  "RelocationFactory",
+  "RegionFactory",
+  "Fragment",
+  "Space (heap)",
+  "Space (mapped)"
+};
+
+/// PrintMegabytes - print pBytes in MiB
+void PrintMegabytes(llvm::raw_ostream& pOS, size_t pBytes)
+{
+  pOS << llvm::format("%11.2f", pBytes / (1024.0 * 1024.0));
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// MemoryUsage
+//===----------------------------------------------------------------------===//
+bool MemoryUsage::g_bEnabled = false;
+
+void MemoryUsage::Enable(bool pEnable)
+{
+  g_bEnabled = pEnable;
+}
+
+void MemoryUsage::Allocate(Kind pKind, size_t pBytes)
+{
+  sys::ScopedLock lock(g_Lock);
+  Counter& counter = g_Counters[pKind];
+  counter.bytes += pBytes;
+  if (counter.bytes > counter.peakBytes)
+    counter.peakBytes = counter.bytes;
+}
+
+void MemoryUsage::Release(Kind pKind, size_t pBytes)
+{
+  sys::ScopedLock lock(g_Lock);
+  Counter& counter = g_Counters[pKind];
+  counter.bytes = (pBytes < counter.bytes) ? (counter.bytes - pBytes) : 0;
+}
+
+void MemoryUsage::AddObjects(Kind pKind, size_t pNum)
+{
+  sys::ScopedLock lock(g_Lock);
+  Counter& counter = g_Counters[pKind];
+  counter.objects += pNum;
+  if (counter.objects > counter.peakObjects)
+    counter.peakObjects = counter.objects;
+}
+
+void MemoryUsage::RemoveObjects(Kind pKind, size_t pNum)
+{
+  sys::ScopedLock lock(g_Lock);
+  Counter& counter = g_Counters[pKind];
+  counter.objects = (pNum < counter.objects) ? (counter.objects - pNum) : 0;
+}
+
+MemoryUsage::Counter MemoryUsage::Get(Kind pKind)
+{
+  sys::ScopedLock lock(g_Lock);
+  return g_Counters[pKind];
+}
+
+const char* MemoryUsage::GetName(Kind pKind)
+{
+  return g_Names[pKind];
+}
+
+void MemoryUsage::PrintSummary(llvm::raw_ostream& pOS, const char* pPhase)
+{
+  // the peak of the sum is not known, so the sum of the peaks is printed
+  size_t live = 0, peak = 0;
+  for (int kind = 0; kind < NumOfKinds; ++kind) {
+    Counter counter = Get(static_cast<Kind>(kind));
+    live += counter.bytes;
+    peak += counter.peakBytes;
+  }
+  pOS << "memory usage after " << pPhase << ": live";
+  PrintMegabytes(pOS, live);
+  pOS << " MiB, sum of peaks";
+  PrintMegabytes(pOS, peak);
+  pOS << " MiB\n";
+}
+
+void MemoryUsage::Print(llvm::raw_ostream& pOS)
+{
+  pOS << "===" << std::string(70, '-') << "===\n"
+      << std::string(24, ' ') << "MCLinker Memory Usage\n"
+      << "===" << std::string(70, '-') << "===\n"
+      << "  Live (MiB)  Peak (MiB)  Live Objects  Peak Objects  Factory\n";
+  Counter total = { 0, 0, 0, 0 };
+  for (int kind = 0; kind < NumOfKinds; ++kind) {
+    Counter counter = Get(static_cast<Kind>(kind));
+    PrintMegabytes(pOS, counter.bytes);
+    pOS << ' ';
+    PrintMegabytes(pOS, counter.peakBytes);
+    pOS << llvm::format("  %12llu  %12llu  ",
+                        static_cast<unsigned long long>(counter.objects),
+                        static_cast<unsigned long long>(counter.peakObjects))
+        << GetName(static_cast<Kind>(kind)) << '\n';
+    total.bytes += counter.bytes;
+    total.peakBytes += counter.peakBytes;
+  }
+  PrintMegabytes(pOS, total.bytes);
+  pOS << ' ';
+  PrintMegabytes(pOS, total.peakBytes);
+  pOS << std::string(30, ' ') << "Total (sum of peaks)\n";
+}
+
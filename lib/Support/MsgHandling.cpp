@@ -11,10 +11,10 @@
 #include <mcld/LD/DiagnosticPrinter.h>
 #include <mcld/LD/TextDiagnosticPrinter.h>
 #include <mcld/LD/MsgHandler.h>
+#include <mcld/Support/LinkContext.h>
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/raw_ostream.h>
 
-#include <llvm/Support/ManagedStatic.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/Signals.h>
 
@@ -23,36 +23,36 @@
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
-// static variables
+// MsgHandling
 //===----------------------------------------------------------------------===//
-static llvm::ManagedStatic<DiagnosticEngine> g_pEngine;
-
 void
 mcld::InitializeDiagnosticEngine(const mcld::LinkerConfig& pConfig,
                                  DiagnosticPrinter* pPrinter)
 {
-  g_pEngine->reset(pConfig);
+  DiagnosticEngine& engine = getDiagnosticEngine();
+  engine.reset(pConfig);
   if (NULL != pPrinter)
-    g_pEngine->setPrinter(*pPrinter, false);
+    engine.setPrinter(*pPrinter, false);
   else {
     DiagnosticPrinter* printer = new TextDiagnosticPrinter(mcld::errs(), pConfig);
-    g_pEngine->setPrinter(*printer, true);
+    engine.setPrinter(*printer, true);
   }
 }
 
 DiagnosticEngine& mcld::getDiagnosticEngine()
 {
-  return *g_pEngine;
+  return LinkContext::Current().getDiagEngine();
 }
 
 bool mcld::Diagnose()
 {
-  if (g_pEngine->getPrinter()->getNumErrors() > 0) {
+  DiagnosticEngine& engine = getDiagnosticEngine();
+  if (engine.getPrinter()->getNumErrors() > 0) {
     // If we reached here, we are failing ungracefully. Run the interrupt handlers
     // to make sure any special cleanups get done, in particular that we remove
     // files registered with RemoveFileOnSignal.
     llvm::sys::RunInterruptHandlers();
-    g_pEngine->getPrinter()->finish();
+    engine.getPrinter()->finish();
     return false;
   }
   return true;
@@ -60,6 +60,5 @@ bool mcld::Diagnose()
 
 void mcld::FinalizeDiagnosticEngine()
 {
-  g_pEngine->getPrinter()->finish();
+  getDiagnosticEngine().getPrinter()->finish();
 }
-
@@ -0,0 +1,180 @@
+//===- PageHeap.cpp -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Config/Config.h"
+#include <mcld/Support/PageHeap.h>
+#include <mcld/Support/Thread.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#if defined(MCLD_HUGE_PAGES) && defined(MCLD_ON_UNIX)
+#include <sys/mman.h>
+#define MCLD_PAGE_HEAP_MMAP 1
+#endif
+
+using namespace mcld;
+
+#ifdef MCLD_PAGE_HEAP_MMAP
+namespace { // anonymous
+
+/// the blocks are aligned to the cache lines
+const size_t BlockAlignment = 64;
+
+/// the current regions, one for each NUMA node of the bound workers, so the
+/// huge pages are touched first on their nodes as the slabs of the Arenas
+const unsigned int NumOfNodes = 8;
+
+struct HeapState
+{
+  typedef std::map<size_t, std::vector<char*> > FreeListMap;
+
+  HeapState() : numOfRegions(0) {
+    for (unsigned int i = 0; i < NumOfNodes; ++i) {
+      current[i] = NULL;
+      end[i] = NULL;
+    }
+  }
+
+  sys::Mutex lock;
+  char* current[NumOfNodes];
+  char* end[NumOfNodes];
+  FreeListMap freeBlocks;
+  size_t numOfRegions;
+};
+
+HeapState& GetState()
+{
+  static HeapState state;
+  return state;
+}
+
+size_t AlignTo(size_t pSize, size_t pAlignment)
+{
+  return (pSize + pAlignment - 1) & ~(pAlignment - 1);
+}
+
+/// MapRegion - map pSize bytes of anonymous memory aligned to HugePageSize,
+/// and advise the kernel to back it by transparent huge pages
+char* MapRegion(size_t pSize)
+{
+  size_t span = pSize + PageHeap::HugePageSize;
+  void* addr = ::mmap(NULL, span, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == addr)
+    return NULL;
+
+  // trim the head and the tail which are out of the aligned region
+  uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+  uintptr_t aligned = AlignTo(begin, PageHeap::HugePageSize);
+  if (aligned != begin)
+    ::munmap(addr, aligned - begin);
+  size_t tail = (begin + span) - (aligned + pSize);
+  if (0 != tail)
+    ::munmap(reinterpret_cast<void*>(aligned + pSize), tail);
+
+#if defined(MADV_HUGEPAGE)
+  ::madvise(reinterpret_cast<void*>(aligned), pSize, MADV_HUGEPAGE);
+#endif
+  return reinterpret_cast<char*>(aligned);
+}
+
+} // anonymous namespace
+#endif
+
+//===----------------------------------------------------------------------===//
+// PageHeap
+//===----------------------------------------------------------------------===//
+void* PageHeap::allocate(size_t pSize)
+{
+#ifdef MCLD_PAGE_HEAP_MMAP
+  HeapState& state = GetState();
+  size_t size = AlignTo((0 == pSize) ? 1 : pSize, BlockAlignment);
+
+  // a large block has a region of its own
+  if (size > RegionSize / 4) {
+    char* block = MapRegion(AlignTo(size, HugePageSize));
+    if (NULL != block) {
+      sys::ScopedLock lock(state.lock);
+      ++state.numOfRegions;
+    }
+    return block;
+  }
+
+  sys::ScopedLock lock(state.lock);
+  HeapState::FreeListMap::iterator entry = state.freeBlocks.find(size);
+  if (state.freeBlocks.end() != entry && !entry->second.empty()) {
+    char* block = entry->second.back();
+    entry->second.pop_back();
+    return block;
+  }
+
+  // the rest of the current region is left if the block does not fit
+  unsigned int node = ThreadPool::GetCurrentNode() % NumOfNodes;
+  if (static_cast<size_t>(state.end[node] - state.current[node]) < size) {
+    char* region = MapRegion(RegionSize);
+    if (NULL == region)
+      return NULL;
+    ++state.numOfRegions;
+    state.current[node] = region;
+    state.end[node] = region + RegionSize;
+  }
+
+  char* block = state.current[node];
+  state.current[node] += size;
+  return block;
+#else
+  return malloc(pSize);
+#endif
+}
+
+void PageHeap::deallocate(void* pPtr, size_t pSize)
+{
+  if (NULL == pPtr)
+    return;
+
+#ifdef MCLD_PAGE_HEAP_MMAP
+  HeapState& state = GetState();
+  size_t size = AlignTo((0 == pSize) ? 1 : pSize, BlockAlignment);
+  if (size > RegionSize / 4) {
+    ::munmap(pPtr, AlignTo(size, HugePageSize));
+    sys::ScopedLock lock(state.lock);
+    --state.numOfRegions;
+    return;
+  }
+
+  sys::ScopedLock lock(state.lock);
+  state.freeBlocks[size].push_back(static_cast<char*>(pPtr));
+#else
+  free(pPtr);
+#endif
+}
+
+bool PageHeap::isHugePage()
+{
+#ifdef MCLD_PAGE_HEAP_MMAP
+  return true;
+#else
+  return false;
+#endif
+}
+
+size_t PageHeap::numOfRegions()
+{
+#ifdef MCLD_PAGE_HEAP_MMAP
+  HeapState& state = GetState();
+  sys::ScopedLock lock(state.lock);
+  return state.numOfRegions;
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,122 @@
+//===- PathCache.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/PathCache.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/Thread.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/ManagedStatic.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcld::sys::fs;
+
+namespace {
+
+/// Entry - what is known about a path. The parts are filled on demand.
+struct Entry
+{
+  Entry() : hasStatus(false), hasCanonical(false) {}
+
+  bool hasStatus;
+  FileStatus status;
+  FileID id;
+
+  bool hasCanonical;
+  std::string canonical;
+};
+
+struct StatusTable
+{
+  sys::Mutex lock;
+  llvm::StringMap<Entry> entries;
+};
+
+llvm::ManagedStatic<StatusTable> g_Table;
+
+/// Stat - get the status and the FileID of pPath
+void Stat(const Path& pPath, FileStatus& pStatus, FileID& pID)
+{
+  {
+    sys::ScopedLock locker(g_Table->lock);
+    llvm::StringMap<Entry>::iterator entry =
+                                       g_Table->entries.find(pPath.native());
+    if (g_Table->entries.end() != entry && entry->getValue().hasStatus) {
+      pStatus = entry->getValue().status;
+      pID = entry->getValue().id;
+      return;
+    }
+  }
+
+  // stat() without the lock, since the file system may be slow. Two threads
+  // asking for the same path both ask the system and get the same answer.
+  detail::status(pPath, pStatus, pID);
+
+  sys::ScopedLock locker(g_Table->lock);
+  Entry& entry = g_Table->entries[pPath.native()];
+  entry.hasStatus = true;
+  entry.status = pStatus;
+  entry.id = pID;
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// cached
+//===----------------------------------------------------------------------===//
+void mcld::sys::fs::cached::status(const Path& pPath, FileStatus& pFileStatus)
+{
+  FileID id;
+  Stat(pPath, pFileStatus, id);
+}
+
+void mcld::sys::fs::cached::file_id(const Path& pPath, FileID& pFileID)
+{
+  FileStatus status;
+  Stat(pPath, status, pFileID);
+}
+
+void mcld::sys::fs::cached::canonical(const Path& pPath, Path& pResult)
+{
+  std::string result;
+  {
+    sys::ScopedLock locker(g_Table->lock);
+    Entry& entry = g_Table->entries[pPath.native()];
+    if (!entry.hasCanonical) {
+      entry.canonical = pPath.native();
+      if (pPath.isFromRoot()) {
+        detail::canonicalize(entry.canonical);
+      }
+      else if (pPath.isFromPWD()) {
+        detail::get_pwd(entry.canonical);
+        entry.canonical += '/';
+        entry.canonical += pPath.native();
+        detail::canonicalize(entry.canonical);
+      }
+      entry.hasCanonical = true;
+    }
+    result = entry.canonical;
+  }
+  // pResult may be pPath itself
+  pResult.assign(result);
+}
+
+void mcld::sys::fs::cached::forget(const Path& pPath)
+{
+  sys::ScopedLock locker(g_Table->lock);
+  g_Table->entries.erase(pPath.native());
+}
+
+void mcld::sys::fs::cached::clear()
+{
+  sys::ScopedLock locker(g_Table->lock);
+  g_Table->entries.clear();
+}
+
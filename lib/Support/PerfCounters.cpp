@@ -0,0 +1,235 @@
+//===- PerfCounters.cpp ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/PerfCounters.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// PerfCounters::Group
+//===----------------------------------------------------------------------===//
+/// Group - the counters of a thread. The first opened counter is the leader
+/// of the group, so the counters are scheduled and read together.
+struct PerfCounters::Group
+{
+  Group();
+
+  ~Group();
+
+  bool read(Sample& pSample) const;
+
+  int fd[NumOfKinds];
+  int leader;
+  unsigned int numOfOpened;
+};
+
+#if defined(__linux__)
+
+namespace {
+
+/// GetEventConfig - the perf_event_attr type and config of pKind
+void GetEventConfig(PerfCounters::Kind pKind, uint32_t& pType,
+                    uint64_t& pConfig)
+{
+  switch (pKind) {
+    case PerfCounters::Cycles:
+      pType = PERF_TYPE_HARDWARE;
+      pConfig = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PerfCounters::Instructions:
+      pType = PERF_TYPE_HARDWARE;
+      pConfig = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PerfCounters::LLCMisses:
+      pType = PERF_TYPE_HW_CACHE;
+      pConfig = PERF_COUNT_HW_CACHE_LL |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    case PerfCounters::DTLBMisses:
+      pType = PERF_TYPE_HW_CACHE;
+      pConfig = PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    case PerfCounters::BranchMisses:
+    default:
+      pType = PERF_TYPE_HARDWARE;
+      pConfig = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+  }
+}
+
+/// OpenEvent - open the counter pKind of the calling thread in the group of
+/// pLeader, or as a leader if pLeader is -1
+int OpenEvent(PerfCounters::Kind pKind, int pLeader)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  uint32_t type;
+  uint64_t config;
+  GetEventConfig(pKind, type, config);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP |
+                     PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // pid 0 and cpu -1: the calling thread on any processor
+  return syscall(__NR_perf_event_open, &attr, 0, -1, pLeader, 0);
+}
+
+} // anonymous namespace
+
+#endif
+
+PerfCounters::Group::Group()
+  : leader(-1), numOfOpened(0) {
+  for (unsigned int i = 0; i < NumOfKinds; ++i)
+    fd[i] = -1;
+
+#if defined(__linux__)
+  for (unsigned int i = 0; i < NumOfKinds; ++i) {
+    fd[i] = OpenEvent(static_cast<Kind>(i), leader);
+    if (-1 == fd[i])
+      continue;
+    if (-1 == leader)
+      leader = fd[i];
+    ++numOfOpened;
+  }
+#endif
+}
+
+PerfCounters::Group::~Group()
+{
+#if defined(__linux__)
+  for (unsigned int i = 0; i < NumOfKinds; ++i) {
+    if (-1 != fd[i])
+      close(fd[i]);
+  }
+#endif
+}
+
+bool PerfCounters::Group::read(Sample& pSample) const
+{
+  if (0 == numOfOpened)
+    return false;
+
+#if defined(__linux__)
+  // nr, time_enabled, time_running, and the values in the opening order
+  uint64_t data[3 + NumOfKinds];
+  ssize_t size = ::read(leader, data, sizeof(data));
+  if (size < (ssize_t)(3 * sizeof(uint64_t)) || data[0] != numOfOpened)
+    return false;
+
+  // the group is multiplexed with the other users of the counters if it
+  // ran for less time than it was enabled
+  double scale = 1.0;
+  if (0 != data[2] && data[2] < data[1])
+    scale = (double)data[1] / (double)data[2];
+
+  unsigned int idx = 3;
+  for (unsigned int i = 0; i < NumOfKinds; ++i) {
+    if (-1 == fd[i])
+      continue;
+    pSample.value[i] = (uint64_t)(data[idx++] * scale);
+    pSample.valid[i] = true;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+//===----------------------------------------------------------------------===//
+// PerfCounters::Sample
+//===----------------------------------------------------------------------===//
+PerfCounters::Sample::Sample()
+{
+  for (unsigned int i = 0; i < NumOfKinds; ++i) {
+    value[i] = 0;
+    valid[i] = false;
+  }
+}
+
+PerfCounters::Sample
+PerfCounters::Sample::sub(const Sample& pBefore) const
+{
+  Sample result;
+  for (unsigned int i = 0; i < NumOfKinds; ++i) {
+    result.valid[i] = valid[i] && pBefore.valid[i];
+    if (result.valid[i] && value[i] >= pBefore.value[i])
+      result.value[i] = value[i] - pBefore.value[i];
+  }
+  return result;
+}
+
+void PerfCounters::Sample::add(const Sample& pOther)
+{
+  for (unsigned int i = 0; i < NumOfKinds; ++i) {
+    if (!pOther.valid[i])
+      continue;
+    value[i] += pOther.value[i];
+    valid[i] = true;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// PerfCounters
+//===----------------------------------------------------------------------===//
+PerfCounters::PerfCounters()
+  : m_bAvailable(false) {
+  m_bAvailable = (0 != getGroup()->numOfOpened);
+}
+
+PerfCounters::~PerfCounters()
+{
+  std::vector<Group*>::iterator group, gEnd = m_Groups.end();
+  for (group = m_Groups.begin(); group != gEnd; ++group)
+    delete *group;
+}
+
+bool PerfCounters::read(Sample& pSample)
+{
+  return getGroup()->read(pSample);
+}
+
+const char* PerfCounters::name(Kind pKind)
+{
+  switch (pKind) {
+    case Cycles:       return "cycles";
+    case Instructions: return "instructions";
+    case LLCMisses:    return "llc-misses";
+    case DTLBMisses:   return "dtlb-misses";
+    case BranchMisses: return "branch-misses";
+    default:           return "unknown";
+  }
+}
+
+PerfCounters::Group* PerfCounters::getGroup()
+{
+  Group* group = static_cast<Group*>(m_Group.get());
+  if (NULL != group)
+    return group;
+
+  group = new Group();
+  m_Group.set(group);
+  sys::ScopedLock lock(m_Lock);
+  m_Groups.push_back(group);
+  return group;
+}
@@ -44,16 +44,6 @@ RealPath& RealPath::assign(const Path& pPath)
 
 void RealPath::initialize()
 {
-  if (isFromRoot()) {
-    detail::canonicalize(m_PathName);
-  }
-  else if (isFromPWD()) {
-    std::string path_name;
-    detail::get_pwd(path_name);
-    path_name += '/';
-    path_name += m_PathName;
-    detail::canonicalize(path_name);
-    m_PathName = path_name;
-  }
+  cached::canonical(*this, *this);
 }
 
@@ -13,6 +13,11 @@
 
 using namespace mcld;
 
+RegionFactory::RegionFactory()
+  : Alloc() {
+  setUsageKind(MemoryUsage::Regions);
+}
+
 //===----------------------------------------------------------------------===//
 // RegionFactory
 //===----------------------------------------------------------------------===//
@@ -6,17 +6,26 @@
 // License. See LICENSE.TXT for details.
 //
 //===----------------------------------------------------------------------===//
+#include <mcld/Config/Config.h>
 #include <mcld/Support/Space.h>
 #include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/LinkStats.h>
+#include <mcld/Support/MemoryUsage.h>
 #include <mcld/Support/MsgHandling.h>
 #include <cstdlib>
+#if defined(MCLD_ON_UNIX)
+#include <sys/mman.h>
 #include <unistd.h>
+#endif
 
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
 // constant data
-static const off_t PageSize = getpagesize();
+// the alignment of the mapped file offsets. It is the page size on Unix, and
+// the allocation granularity on Windows.
+static const off_t PageSize = sys::fs::detail::map_granularity();
 
 //===----------------------------------------------------------------------===//
 // Non-member functions
@@ -49,13 +58,13 @@ inline static Space::Type policy(off_t pOffset, size_t pLength)
 // Space
 //===----------------------------------------------------------------------===//
 Space::Space()
-  : m_Data(NULL), m_StartOffset(0), m_Size(0),
+  : m_Data(NULL), m_StartOffset(0), m_Size(0), m_pFile(NULL),
     m_RegionCount(0), m_Type(UNALLOCATED) {
 }
 
 Space::Space(Space::Type pType, void* pMemBuffer, size_t pSize)
   : m_Data(static_cast<Address>(pMemBuffer)), m_StartOffset(0), m_Size(pSize),
-    m_RegionCount(0), m_Type(pType)
+    m_pFile(NULL), m_RegionCount(0), m_Type(pType)
 {
 }
 
@@ -64,6 +73,44 @@ Space::~Space()
   // do nothing. m_Data is deleted by @ref releaseSpace
 }
 
+/// CountUsage - count the memory of pSpace in MemoryUsage. External
+/// buffers are counted by their owners.
+static void CountUsage(const Space& pSpace, bool pAllocate)
+{
+  if (!MemoryUsage::isEnabled())
+    return;
+
+  MemoryUsage::Kind kind;
+  if (Space::ALLOCATED_ARRAY == pSpace.type())
+    kind = MemoryUsage::HeapSpaces;
+  else if (Space::MMAPED == pSpace.type())
+    kind = MemoryUsage::MappedSpaces;
+  else
+    return;
+
+  if (pAllocate) {
+    MemoryUsage::Allocate(kind, pSpace.size());
+    MemoryUsage::AddObjects(kind);
+  }
+  else {
+    MemoryUsage::Release(kind, pSpace.size());
+    MemoryUsage::RemoveObjects(kind);
+  }
+}
+
+/// CountStats - count the bytes of pSpace mapped from or copied out of a
+/// file in LinkStats
+static void CountStats(const Space& pSpace)
+{
+  if (!LinkStats::isEnabled())
+    return;
+
+  if (Space::ALLOCATED_ARRAY == pSpace.type())
+    LinkStats::Add(LinkStats::BytesCopied, pSpace.size());
+  else if (Space::MMAPED == pSpace.type())
+    LinkStats::Add(LinkStats::BytesMapped, pSpace.size());
+}
+
 Space* Space::Create(void* pMemBuffer, size_t pSize)
 {
   Space* result = new Space(EXTERNAL, pMemBuffer, pSize);
@@ -72,11 +119,17 @@ Space* Space::Create(void* pMemBuffer, size_t pSize)
 
 Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize)
 {
-  Type type;
+  return Create(pHandler, pStart, pSize, policy(pStart, pSize));
+}
+
+Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize,
+                     Type pType)
+{
+  Type type = pType;
   void* memory = NULL;
   Space* result = NULL;
   size_t start = 0, size = 0, total_offset;
-  switch(type = policy(pStart, pSize)) {
+  switch(type) {
     case ALLOCATED_ARRAY: {
       // adjust total_offset, start and size
       total_offset = pStart + pSize;
@@ -138,6 +191,35 @@ Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize)
 
   result = new Space(type, memory, size);
   result->setStart(start);
+  result->m_pFile = &pHandler;
+  CountUsage(*result, true);
+  CountStats(*result);
+  return result;
+}
+
+Space* Space::Create(FileHandle& pHandler)
+{
+  // files larger than this are not mapped at once on a 32-bit host
+  const size_t max_size = (sizeof(void*) > 4)? (~(size_t)0x0): (0x1U << 30);
+
+  if (!pHandler.isReadable() || 0 == pHandler.size() ||
+      pHandler.size() > max_size)
+    return NULL;
+
+  void* memory = NULL;
+  if (!pHandler.mmap(memory, 0, pHandler.size())) {
+    // the mapping was rejected by the system. Let the caller fall back to
+    // the piecewise policy.
+    pHandler.cleanState(static_cast<FileHandle::IOState>(
+                                pHandler.rdstate() & ~FileHandle::FailBit));
+    return NULL;
+  }
+
+  Space* result = new Space(MMAPED, memory, pHandler.size());
+  result->setStart(0);
+  result->m_pFile = &pHandler;
+  CountUsage(*result, true);
+  CountStats(*result);
   return result;
 }
 
@@ -152,6 +234,7 @@ void Space::Release(Space* pSpace, FileHandle& pHandler)
   if (NULL == pSpace)
     return;
 
+  CountUsage(*pSpace, false);
   switch(pSpace->type()) {
     case ALLOCATED_ARRAY:
       free(pSpace->memory());
@@ -190,3 +273,41 @@ void Space::Sync(Space* pSpace, FileHandle& pHandler)
   } // end of switch
 }
 
+void Space::Advise(Space* pSpace, FileHandle& pHandler,
+                   FileHandle::Advice pAdvice)
+{
+  if (NULL == pSpace || !pHandler.isOpened())
+    return;
+
+  switch(pSpace->type()) {
+    case Space::MMAPED: {
+      pHandler.madvise(pSpace->memory(), pSpace->size(), pAdvice);
+      return;
+    }
+    case Space::ALLOCATED_ARRAY: {
+      // the contents are already copied. Dropping the copy is not the
+      // business of the system.
+      if (FileHandle::DontNeed != pAdvice)
+        pHandler.advise(pAdvice, pSpace->start(), pSpace->size());
+      return;
+    }
+    default:
+      return;
+  } // end of switch
+}
+
+void Space::Drop(const Space* pSpace, ConstAddress pStart, size_t pSize)
+{
+  // the pages of an allocated array or an external buffer are the only copy
+  // of the contents
+  if (NULL == pSpace || MMAPED != pSpace->type())
+    return;
+
+#if defined(MADV_DONTNEED)
+  uintptr_t mask = PageSize - 1;
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(pStart) + mask) & ~mask;
+  uintptr_t end = (reinterpret_cast<uintptr_t>(pStart) + pSize) & ~mask;
+  if (begin < end)
+    ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+#endif
+}
@@ -27,6 +27,13 @@ mcld::TargetRegistry::lookupTarget(const llvm::Target &pTarget)
       break;
     }
   }
+
+  // register the rest of the target on its first lookup
+  if (NULL != result && NULL != result->InitializeFn) {
+    mcld::Target::InitializeFnTy initialize = result->InitializeFn;
+    result->InitializeFn = NULL;
+    initialize();
+  }
   return result;
 }
 
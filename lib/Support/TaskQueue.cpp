@@ -0,0 +1,93 @@
+//===- TaskQueue.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/TaskQueue.h>
+#include <mcld/Support/LinkContext.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// TaskQueue
+//===----------------------------------------------------------------------===//
+TaskQueue::TaskQueue(bool pAsync)
+  : m_NumOfPosted(0), m_NumOfFinished(0), m_bStop(false),
+    m_pContext(LinkContext::GetCurrent()) {
+  // without a thread, post() runs the tasks by itself
+  if (pAsync)
+    m_Thread.start(Entry, this);
+}
+
+TaskQueue::~TaskQueue()
+{
+  if (!isAsync())
+    return;
+
+  m_Lock.lock();
+  m_bStop = true;
+  m_Posted.signal();
+  m_Lock.unlock();
+  m_Thread.join();
+}
+
+void TaskQueue::post(Task& pTask)
+{
+  ++m_NumOfPosted;
+  if (!isAsync()) {
+    pTask.run();
+    sys::ScopedLock lock(m_Lock);
+    ++m_NumOfFinished;
+    return;
+  }
+
+  sys::ScopedLock lock(m_Lock);
+  m_Tasks.push_back(&pTask);
+  m_Posted.signal();
+}
+
+void TaskQueue::wait(size_t pNum)
+{
+  sys::ScopedLock lock(m_Lock);
+  while (m_NumOfFinished < pNum)
+    m_Finished.wait(m_Lock);
+}
+
+void TaskQueue::wait()
+{
+  wait(m_NumOfPosted);
+}
+
+void* TaskQueue::Entry(void* pQueue)
+{
+  TaskQueue* queue = static_cast<TaskQueue*>(pQueue);
+  LinkContext::SetCurrent(queue->m_pContext);
+  queue->loop();
+  return NULL;
+}
+
+void TaskQueue::loop()
+{
+  m_Lock.lock();
+  while (true) {
+    // the tasks posted before the stop are still run
+    while (!m_bStop && m_Tasks.empty())
+      m_Posted.wait(m_Lock);
+    if (m_Tasks.empty())
+      break;
+
+    Task* task = m_Tasks.front();
+    m_Tasks.pop_front();
+    m_Lock.unlock();
+
+    task->run();
+
+    m_Lock.lock();
+    ++m_NumOfFinished;
+    m_Finished.broadcast();
+  }
+  m_Lock.unlock();
+}
@@ -0,0 +1,23 @@
+//===- Thread.cpp ---------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Config/Config.h"
+#include <mcld/Support/Thread.h>
+
+#include <cstddef>
+
+using namespace mcld::sys;
+
+//===----------------------------------------------------------------------===//
+// Include the truly platform-specific parts.
+#if defined(MCLD_ON_UNIX)
+#include "Unix/Thread.inc"
+#endif
+#if defined(MCLD_ON_WIN32)
+#include "Windows/Thread.inc"
+#endif
@@ -0,0 +1,280 @@
+//===- ThreadPool.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/Support/LinkContext.h>
+
+#include <llvm/Support/ManagedStatic.h>
+
+#include <cassert>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// ThreadPool::Worker
+//===----------------------------------------------------------------------===//
+struct ThreadPool::Worker
+{
+  ThreadPool* pool;
+  unsigned int id;
+  unsigned int node;
+  int cpu;  ///< the bound processor, or -1
+  sys::Thread thread;
+};
+
+namespace { // anonymous
+
+/// the Worker of the calling thread, or NULL
+llvm::ManagedStatic<sys::ThreadLocal> g_CurrentWorker;
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// ThreadPool
+//===----------------------------------------------------------------------===//
+ThreadPool::ThreadPool(unsigned int pNumThreads, bool pAffinity)
+  : m_Size(pNumThreads),
+    m_bAffinity(pAffinity),
+    m_Generation(0),
+    m_pContext(NULL),
+    m_NumOfPending(0),
+    m_bRunning(false),
+    m_bStop(false) {
+  if (0 == m_Size)
+    m_Size = sys::GetNumOfProcessors();
+
+  // the processors ordered by their nodes, so the adjacent IDs share a node
+  std::vector<unsigned int> cpus;
+  if (m_bAffinity && m_Size > 1) {
+    unsigned int num_cpus = sys::GetNumOfProcessors();
+    for (unsigned int node = 0; node < sys::GetNumOfNodes(); ++node) {
+      for (unsigned int cpu = 0; cpu < num_cpus; ++cpu) {
+        if (node == sys::GetNodeOfProcessor(cpu))
+          cpus.push_back(cpu);
+      }
+    }
+  }
+  if (cpus.empty())
+    m_bAffinity = false;
+
+  // queue 0 belongs to the caller of run(), which counts as a thread of the
+  // first node
+  m_Queues.reserve(m_Size);
+  m_Queues.push_back(new Queue());
+  m_Nodes.push_back(m_bAffinity ? sys::GetNodeOfProcessor(cpus[0]) : 0);
+  for (unsigned int id = 1; id < m_Size; ++id) {
+    Worker* worker = new Worker();
+    worker->pool = this;
+    worker->id = id;
+    worker->cpu = -1;
+    worker->node = 0;
+    if (m_bAffinity) {
+      worker->cpu = cpus[id % cpus.size()];
+      worker->node = sys::GetNodeOfProcessor(worker->cpu);
+    }
+    m_Queues.push_back(new Queue());
+    if (!worker->thread.start(WorkerEntry, worker)) {
+      // can not create more threads. Work with what we have.
+      delete worker;
+      delete m_Queues.back();
+      m_Queues.pop_back();
+      break;
+    }
+    m_Workers.push_back(worker);
+    m_Nodes.push_back(worker->node);
+  }
+  m_Size = m_Queues.size();
+  setupVictims();
+}
+
+ThreadPool::~ThreadPool()
+{
+  m_Lock.lock();
+  m_bStop = true;
+  m_WakeUp.broadcast();
+  m_Lock.unlock();
+
+  std::vector<Worker*>::iterator worker, wEnd = m_Workers.end();
+  for (worker = m_Workers.begin(); worker != wEnd; ++worker) {
+    (*worker)->thread.join();
+    delete *worker;
+  }
+
+  std::vector<Queue*>::iterator queue, qEnd = m_Queues.end();
+  for (queue = m_Queues.begin(); queue != qEnd; ++queue)
+    delete *queue;
+}
+
+void ThreadPool::setupVictims()
+{
+  m_Victims.resize(m_Size);
+  for (unsigned int id = 0; id < m_Size; ++id) {
+    for (unsigned int i = 1; i < m_Size; ++i) {
+      unsigned int victim = (id + i) % m_Size;
+      if (m_Nodes[victim] == m_Nodes[id])
+        m_Victims[id].push_back(victim);
+    }
+    for (unsigned int i = 1; i < m_Size; ++i) {
+      unsigned int victim = (id + i) % m_Size;
+      if (m_Nodes[victim] != m_Nodes[id])
+        m_Victims[id].push_back(victim);
+    }
+  }
+}
+
+void ThreadPool::run(const TaskList& pTasks)
+{
+  execute(pTasks, NULL);
+}
+
+void ThreadPool::run(const TaskList& pTasks, const HomeList& pHomes)
+{
+  assert(pTasks.size() == pHomes.size() && "Missing homes of tasks!");
+  execute(pTasks, &pHomes);
+}
+
+unsigned int ThreadPool::currentThread() const
+{
+  Worker* worker = static_cast<Worker*>(g_CurrentWorker->get());
+  if (NULL == worker || this != worker->pool)
+    return 0;
+  return worker->id;
+}
+
+unsigned int ThreadPool::GetCurrentNode()
+{
+  Worker* worker = static_cast<Worker*>(g_CurrentWorker->get());
+  if (NULL == worker || -1 == worker->cpu)
+    return 0;
+  return worker->node;
+}
+
+void ThreadPool::execute(const TaskList& pTasks, const HomeList* pHomes)
+{
+  if (pTasks.empty())
+    return;
+
+  m_Lock.lock();
+  bool nested = m_bRunning;
+  m_bRunning = true;
+  m_Lock.unlock();
+
+  // a serial pool or a nested run executes the tasks in order.
+  if (isSerial() || nested) {
+    TaskList::const_iterator task, tEnd = pTasks.end();
+    for (task = pTasks.begin(); task != tEnd; ++task)
+      (*task)->run();
+    if (!nested) {
+      sys::ScopedLock lock(m_Lock);
+      m_bRunning = false;
+    }
+    return;
+  }
+
+  // A worker finishing the previous run may steal the new tasks at once, so
+  // count the tasks before they are visible in the queues.
+  m_Lock.lock();
+  m_NumOfPending = pTasks.size();
+  m_Lock.unlock();
+
+  // distribute the tasks before waking up the workers. The consecutive
+  // tasks go to the same thread, so a phase over the same list of items
+  // gives a thread the same items as the previous phase did.
+  for (size_t i = 0; i < pTasks.size(); ++i) {
+    size_t home = (i * m_Size) / pTasks.size();
+    if (NULL != pHomes && NoHome != (*pHomes)[i])
+      home = (*pHomes)[i] % m_Size;
+    Queue* queue = m_Queues[home];
+    sys::ScopedLock lock(queue->mutex);
+    queue->tasks.push_back(pTasks[i]);
+  }
+
+  m_Lock.lock();
+  ++m_Generation;
+  m_pContext = LinkContext::GetCurrent();
+  m_WakeUp.broadcast();
+  m_Lock.unlock();
+
+  drain(0);
+
+  m_Lock.lock();
+  while (0 != m_NumOfPending)
+    m_Done.wait(m_Lock);
+  m_bRunning = false;
+  m_Lock.unlock();
+}
+
+void* ThreadPool::WorkerEntry(void* pWorker)
+{
+  Worker* worker = static_cast<Worker*>(pWorker);
+  g_CurrentWorker->set(worker);
+  if (-1 != worker->cpu && !sys::BindCurrentThread(worker->cpu))
+    worker->cpu = -1;
+  worker->pool->loop(worker->id);
+  return NULL;
+}
+
+void ThreadPool::loop(unsigned int pID)
+{
+  size_t generation = 0;
+  while (true) {
+    m_Lock.lock();
+    while (!m_bStop && generation == m_Generation)
+      m_WakeUp.wait(m_Lock);
+    if (m_bStop) {
+      m_Lock.unlock();
+      return;
+    }
+    generation = m_Generation;
+    LinkContext::SetCurrent(m_pContext);
+    m_Lock.unlock();
+
+    drain(pID);
+  }
+}
+
+ThreadPool::Task* ThreadPool::getTask(unsigned int pID)
+{
+  // take from the front of my queue
+  {
+    Queue* queue = m_Queues[pID];
+    sys::ScopedLock lock(queue->mutex);
+    if (!queue->tasks.empty()) {
+      Task* task = queue->tasks.front();
+      queue->tasks.pop_front();
+      return task;
+    }
+  }
+
+  // steal from the back of the others, of my node first
+  const std::vector<unsigned int>& victims = m_Victims[pID];
+  for (size_t i = 0; i < victims.size(); ++i) {
+    Queue* queue = m_Queues[victims[i]];
+    sys::ScopedLock lock(queue->mutex);
+    if (!queue->tasks.empty()) {
+      Task* task = queue->tasks.back();
+      queue->tasks.pop_back();
+      return task;
+    }
+  }
+  return NULL;
+}
+
+void ThreadPool::drain(unsigned int pID)
+{
+  Task* task = NULL;
+  while (NULL != (task = getTask(pID))) {
+    task->run();
+
+    sys::ScopedLock lock(m_Lock);
+    assert(0 != m_NumOfPending);
+    if (0 == --m_NumOfPending)
+      m_Done.broadcast();
+  }
+}
+
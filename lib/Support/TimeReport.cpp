@@ -0,0 +1,313 @@
+//===- TimeReport.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/TimeReport.h>
+#include <mcld/Support/SystemUtils.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+
+using namespace mcld;
+
+namespace { // anonymous
+
+/// PhaseLess - order the phases by their beginnings. Of two phases beginning
+/// at the same time, the longer one encloses the other.
+struct PhaseLess
+{
+  bool operator()(const TimeReport::Span* pX,
+                  const TimeReport::Span* pY) const {
+    if (pX->begin != pY->begin)
+      return pX->begin < pY->begin;
+    return pX->end > pY->end;
+  }
+};
+
+/// Summary - the sum of the spans of the same name
+struct Summary
+{
+  Summary() : count(0), time(0) { }
+
+  size_t count;
+  uint64_t time;
+  PerfCounters::Sample counters;
+};
+
+/// PrintMilliseconds - print pMicroseconds in milliseconds
+void PrintMilliseconds(llvm::raw_ostream& pOS, uint64_t pMicroseconds)
+{
+  pOS << llvm::format("%14.3f", pMicroseconds / 1000.0);
+}
+
+/// PrintPercent - print pPart of pTotal in percent
+void PrintPercent(llvm::raw_ostream& pOS, uint64_t pPart, uint64_t pTotal)
+{
+  pOS << llvm::format("%7.1f%%", (0 == pTotal) ? 0.0 : pPart * 100.0 / pTotal);
+}
+
+/// PrintCounters - print the IPC and the misses per thousand instructions
+/// of pSample
+void PrintCounters(llvm::raw_ostream& pOS, const PerfCounters::Sample& pSample)
+{
+  uint64_t insts = pSample.value[PerfCounters::Instructions];
+  if (!pSample.valid[PerfCounters::Instructions] || 0 == insts) {
+    pOS << "       -       -       -       -";
+    return;
+  }
+
+  if (pSample.valid[PerfCounters::Cycles] &&
+      0 != pSample.value[PerfCounters::Cycles])
+    pOS << llvm::format("%8.2f", (double)insts /
+                                 pSample.value[PerfCounters::Cycles]);
+  else
+    pOS << "       -";
+
+  static const PerfCounters::Kind misses[] = {
+    PerfCounters::LLCMisses, PerfCounters::DTLBMisses,
+    PerfCounters::BranchMisses
+  };
+  for (size_t i = 0; i < sizeof(misses) / sizeof(misses[0]); ++i) {
+    if (pSample.valid[misses[i]])
+      pOS << llvm::format("%8.2f", pSample.value[misses[i]] * 1000.0 / insts);
+    else
+      pOS << "       -";
+  }
+}
+
+/// The headers of the columns printed by PrintCounters()
+const char* g_CountersHeader = "     IPC  LLC/kI dTLB/kI  BrM/kI";
+
+/// PrintJSONString - print pString as a quoted JSON string
+void PrintJSONString(llvm::raw_ostream& pOS, const std::string& pString)
+{
+  pOS << '"';
+  for (size_t i = 0; i < pString.size(); ++i) {
+    unsigned char c = pString[i];
+    if ('"' == c || '\\' == c)
+      pOS << '\\' << c;
+    else if (c < 0x20)
+      pOS << llvm::format("\\u%04x", c);
+    else
+      pOS << c;
+  }
+  pOS << '"';
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// TimeReport
+//===----------------------------------------------------------------------===//
+TimeReport::TimeReport(bool pPerfCounters)
+  : m_Start(sys::GetTimeInMicroseconds()), m_pCounters(NULL) {
+  m_Threads.push_back(sys::GetCurrentThreadID());
+  if (pPerfCounters)
+    m_pCounters = new PerfCounters();
+}
+
+TimeReport::~TimeReport()
+{
+  delete m_pCounters;
+}
+
+unsigned int TimeReport::getThread()
+{
+  unsigned long id = sys::GetCurrentThreadID();
+  for (unsigned int i = 0; i < m_Threads.size(); ++i) {
+    if (id == m_Threads[i])
+      return i;
+  }
+  m_Threads.push_back(id);
+  return m_Threads.size() - 1;
+}
+
+void TimeReport::add(const char* pName,
+                     const std::string& pDetail,
+                     uint64_t pBegin,
+                     uint64_t pEnd,
+                     const PerfCounters::Sample* pCounters)
+{
+  sys::ScopedLock lock(m_Lock);
+  Span span;
+  span.name = pName;
+  span.detail = pDetail;
+  span.thread = getThread();
+  span.begin = pBegin;
+  span.end = pEnd;
+  if (NULL != pCounters)
+    span.counters = *pCounters;
+  m_Spans.push_back(span);
+}
+
+void TimeReport::print(llvm::raw_ostream& pOS) const
+{
+  // the phases of thread 0, and the depth of each phase
+  std::vector<const Span*> phases;
+  SpanList::const_iterator span, spanEnd = m_Spans.end();
+  for (span = m_Spans.begin(); span != spanEnd; ++span) {
+    if (0 == span->thread && span->detail.empty())
+      phases.push_back(&*span);
+  }
+  std::sort(phases.begin(), phases.end(), PhaseLess());
+
+  std::vector<size_t> depths;
+  std::vector<uint64_t> ends;
+  uint64_t total = 0;
+  for (size_t i = 0; i < phases.size(); ++i) {
+    while (!ends.empty() && ends.back() <= phases[i]->begin)
+      ends.pop_back();
+    depths.push_back(ends.size());
+    ends.push_back(phases[i]->end);
+    if (0 == depths.back())
+      total += phases[i]->end - phases[i]->begin;
+  }
+
+  pOS << "===" << std::string(70, '-') << "===\n"
+      << std::string(25, ' ') << "MCLinker Time Report\n"
+      << "===" << std::string(70, '-') << "===\n"
+      << "  Total Execution Time: ";
+  PrintMilliseconds(pOS, total);
+  pOS << " ms\n";
+  if (NULL != m_pCounters && !m_pCounters->isAvailable())
+    pOS << "  The performance counters are not available.\n";
+  bool counters = (NULL != m_pCounters && m_pCounters->isAvailable());
+
+  pOS << "\n     Wall Time (ms)       %";
+  if (counters)
+    pOS << g_CountersHeader;
+  pOS << "  Phase\n";
+  for (size_t i = 0; i < phases.size(); ++i) {
+    uint64_t time = phases[i]->end - phases[i]->begin;
+    pOS << "    ";
+    PrintMilliseconds(pOS, time);
+    PrintPercent(pOS, time, total);
+    if (counters)
+      PrintCounters(pOS, phases[i]->counters);
+    pOS << "  ";
+    pOS.indent(depths[i] * 2) << phases[i]->name << '\n';
+  }
+
+  // the per-input and per-batch work, summed up over all threads
+  llvm::StringMap<Summary> summaries;
+  std::vector<const char*> names;
+  for (span = m_Spans.begin(); span != spanEnd; ++span) {
+    if (span->detail.empty())
+      continue;
+    llvm::StringMapEntry<Summary>& entry =
+                                   summaries.GetOrCreateValue(span->name);
+    if (0 == entry.getValue().count)
+      names.push_back(span->name);
+    ++entry.getValue().count;
+    entry.getValue().time += span->end - span->begin;
+    entry.getValue().counters.add(span->counters);
+  }
+  if (names.empty())
+    return;
+
+  pOS << "\n     CPU Time (ms)    Count";
+  if (counters)
+    pOS << g_CountersHeader;
+  pOS << "  Work in " << m_Threads.size() << " threads\n";
+  for (size_t i = 0; i < names.size(); ++i) {
+    const Summary& summary = summaries[names[i]];
+    pOS << "    ";
+    PrintMilliseconds(pOS, summary.time);
+    pOS << llvm::format("%9u", static_cast<unsigned int>(summary.count));
+    if (counters)
+      PrintCounters(pOS, summary.counters);
+    pOS << "  " << names[i] << '\n';
+  }
+}
+
+void TimeReport::writeTrace(llvm::raw_ostream& pOS) const
+{
+  int pid = sys::getpid();
+  pOS << "{\"traceEvents\":[\n";
+  for (unsigned int i = 0; i < m_Threads.size(); ++i) {
+    pOS << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+        << ",\"tid\":" << i << ",\"args\":{\"name\":\""
+        << ((0 == i) ? "main" : "worker") << "\"}},\n";
+  }
+
+  SpanList::const_iterator span, spanEnd = m_Spans.end();
+  for (span = m_Spans.begin(); span != spanEnd; ++span) {
+    pOS << "{\"ph\":\"X\",\"cat\":\"mcld\",\"name\":";
+    PrintJSONString(pOS, span->name);
+    pOS << ",\"pid\":" << pid
+        << ",\"tid\":" << span->thread
+        << ",\"ts\":" << (span->begin - m_Start)
+        << ",\"dur\":" << (span->end - span->begin);
+    bool has_args = false;
+    if (!span->detail.empty()) {
+      pOS << ",\"args\":{\"detail\":";
+      PrintJSONString(pOS, span->detail);
+      has_args = true;
+    }
+    for (unsigned int k = 0; k < PerfCounters::NumOfKinds; ++k) {
+      if (!span->counters.valid[k])
+        continue;
+      pOS << (has_args ? "," : ",\"args\":{") << '"'
+          << PerfCounters::name(static_cast<PerfCounters::Kind>(k)) << "\":"
+          << span->counters.value[k];
+      has_args = true;
+    }
+    if (has_args)
+      pOS << '}';
+    pOS << "},\n";
+  }
+
+  // a trailing comma is not allowed in JSON
+  pOS << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid
+      << ",\"args\":{\"name\":\"mcld\"}}\n"
+      << "]}\n";
+}
+
+//===----------------------------------------------------------------------===//
+// TimeScope
+//===----------------------------------------------------------------------===//
+TimeScope::TimeScope(TimeReport* pReport, const char* pName)
+  : m_pReport(pReport), m_pName(pName), m_Begin(0) {
+  if (NULL != m_pReport) {
+    if (NULL != m_pReport->counters())
+      m_pReport->counters()->read(m_Counters);
+    m_Begin = sys::GetTimeInMicroseconds();
+  }
+}
+
+TimeScope::TimeScope(TimeReport* pReport,
+                     const char* pName,
+                     const std::string& pDetail)
+  : m_pReport(pReport), m_pName(pName), m_Begin(0) {
+  if (NULL != m_pReport) {
+    m_Detail = pDetail;
+    if (NULL != m_pReport->counters())
+      m_pReport->counters()->read(m_Counters);
+    m_Begin = sys::GetTimeInMicroseconds();
+  }
+}
+
+TimeScope::~TimeScope()
+{
+  if (NULL == m_pReport)
+    return;
+
+  uint64_t end = sys::GetTimeInMicroseconds();
+  if (NULL == m_pReport->counters()) {
+    m_pReport->add(m_pName, m_Detail, m_Begin, end);
+    return;
+  }
+
+  PerfCounters::Sample counters;
+  m_pReport->counters()->read(counters);
+  counters = counters.sub(m_Counters);
+  m_pReport->add(m_pName, m_Detail, m_Begin, end, &counters);
+}
+
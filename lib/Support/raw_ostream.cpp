@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 #include "mcld/Config/Config.h"
 #include <mcld/Support/raw_ostream.h>
+#include <mcld/Support/LinkContext.h>
 
 #if defined(HAVE_UNISTD_H)
 # include <unistd.h>
@@ -92,7 +93,7 @@ bool mcld::raw_fd_ostream::is_displayed() const
 //===----------------------------------------------------------------------===//
 //  outs(), errs(), nulls()
 //===----------------------------------------------------------------------===//
-mcld::raw_fd_ostream& mcld::outs() {
+mcld::raw_fd_ostream& mcld::process_outs() {
   // Set buffer settings to model stdout behavior.
   // Delete the file descriptor when the program exists, forcing error
   // detection. If you don't want this behavior, don't use outs().
@@ -100,9 +101,16 @@ mcld::raw_fd_ostream& mcld::outs() {
   return S;
 }
 
-mcld::raw_fd_ostream& mcld::errs() {
+mcld::raw_fd_ostream& mcld::process_errs() {
   // Set standard error to be unbuffered by default.
   static mcld::raw_fd_ostream S(STDERR_FILENO, false, true);
   return S;
 }
 
+mcld::raw_fd_ostream& mcld::outs() {
+  return LinkContext::Current().outs();
+}
+
+mcld::raw_fd_ostream& mcld::errs() {
+  return LinkContext::Current().errs();
+}
@@ -21,6 +21,8 @@ public:
 
   uint32_t machine() const { return llvm::ELF::EM_ARM; }
 
+  uint32_t relativeRelocType() const { return llvm::ELF::R_ARM_RELATIVE; }
+
   uint64_t defaultTextSegmentAddr() const { return 0x8000; }
 
   uint64_t flags() const
@@ -16,6 +16,7 @@
 #include "THMToTHMStub.h"
 #include "THMToARMStub.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include <llvm/ADT/Triple.h>
@@ -48,6 +49,9 @@ using namespace mcld;
 ARMGNULDBackend::ARMGNULDBackend(const LinkerConfig& pConfig, GNUInfo* pInfo)
   : GNULDBackend(pConfig, pInfo),
     m_pRelocator(NULL),
+    m_ShiftedOffset(0x0),
+    m_CPUArch(-1),
+    m_CodeEnd(0x0),
     m_pGOT(NULL),
     m_pPLT(NULL),
     m_pRelDyn(NULL),
@@ -71,6 +75,35 @@ ARMGNULDBackend::~ARMGNULDBackend()
   delete m_pDynamic;
 }
 
+void ARMGNULDBackend::reset()
+{
+  // the relocator keeps the GOT and PLT entries of the symbols
+  delete m_pRelocator;
+  m_pRelocator = NULL;
+  m_BranchRelocs.clear();
+  m_InvalidDynRelocs.clear();
+  m_ShiftedOffset = 0x0;
+  m_CPUArch = -1;
+  m_CodeEnd = 0x0;
+  delete m_pGOT;
+  m_pGOT = NULL;
+  delete m_pPLT;
+  m_pPLT = NULL;
+  delete m_pRelDyn;
+  m_pRelDyn = NULL;
+  delete m_pRelPLT;
+  m_pRelPLT = NULL;
+  delete m_pDynamic;
+  m_pDynamic = NULL;
+  m_pGOTSymbol = NULL;
+  m_pEXIDXStart = NULL;
+  m_pEXIDXEnd = NULL;
+  m_pEXIDX = NULL;
+  m_pEXTAB = NULL;
+  m_pAttributes = NULL;
+  GNULDBackend::reset();
+}
+
 void ARMGNULDBackend::initTargetSections(Module& pModule, ObjectBuilder& pBuilder)
 {
  // FIXME: Currently we set exidx and extab to "Exception" and directly emit
@@ -100,7 +133,7 @@ void ARMGNULDBackend::initTargetSections(Module& pModule, ObjectBuilder& pBuilde
 
     // initialize .plt
     LDSection& plt = file_format->getPLT();
-    m_pPLT = new ARMPLT(plt, *m_pGOT);
+    m_pPLT = new ARMPLT(plt, *m_pGOT, !config().options().hasNow());
 
     // initialize .rel.plt
     LDSection& relplt = file_format->getRelPlt();
@@ -128,6 +161,15 @@ void ARMGNULDBackend::initTargetSymbols(IRBuilder& pBuilder, Module& pModule)
                                                   FragmentRef::Null(),
                                                   ResolveInfo::Hidden);
   if (NULL != m_pEXIDX && 0x0 != m_pEXIDX->size()) {
+    // reserve the terminating sentinel of the sorted index table, which is
+    // filled by sortEXIDX()
+    if (LinkerConfig::Object != config().codeGenType()) {
+      FillFragment* sentinel = new FillFragment(0x0, 1, EXIDXEntrySize);
+      m_pEXIDX->setSize(m_pEXIDX->size() +
+        ObjectBuilder::AppendFragment(*sentinel,
+                                      *m_pEXIDX->getSectionData()));
+    }
+
     FragmentRef* exidx_start =
       FragmentRef::Create(m_pEXIDX->getSectionData()->front(), 0x0);
     FragmentRef* exidx_end =
@@ -200,6 +242,9 @@ Relocator* ARMGNULDBackend::getRelocator()
 
 void ARMGNULDBackend::doPreLayout(IRBuilder& pBuilder)
 {
+  // the scan only collects the invalid dynamic relocations
+  reportInvalidDynRelocs();
+
   // initialize .dynamic data
   if (!config().isCodeStatic() && NULL == m_pDynamic)
     m_pDynamic = new ARMELFDynamic(*this, config());
@@ -246,8 +291,12 @@ void ARMGNULDBackend::doPostLayout(Module& pModule, IRBuilder& pBuilder)
     // Since we already have the size of LDSection PLT, m_pPLT should not be
     // NULL.
     assert(NULL != m_pPLT);
-    m_pPLT->applyPLT0();
-    m_pPLT->applyPLT1();
+    // the entries of a non-lazy PLT are applied at emission, after the
+    // relocations bind them to their GOT entries
+    if (m_pPLT->isLazy()) {
+      m_pPLT->applyPLT0();
+      m_pPLT->applyPLT1();
+    }
   }
 
   // apply GOT
@@ -261,6 +310,15 @@ void ARMGNULDBackend::doPostLayout(Module& pModule, IRBuilder& pBuilder)
       m_pGOT->applyGOT0(0);
     }
   }
+
+  // the end of the code, covered by the sentinel of .ARM.exidx
+  m_CodeEnd = 0x0;
+  Module::const_iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    if (0x0 != ((*sect)->flag() & llvm::ELF::SHF_ALLOC) &&
+        0x0 != ((*sect)->flag() & llvm::ELF::SHF_EXECINSTR))
+      m_CodeEnd = std::max(m_CodeEnd, (*sect)->addr() + (*sect)->size());
+  }
 }
 
 /// dynamic - the dynamic section of the target machine.
@@ -370,15 +428,15 @@ ARMGNULDBackend::defineSymbolforCopyReloc(IRBuilder& pBuilder,
   return *cpy_sym;
 }
 
-/// checkValidReloc - When we attempt to generate a dynamic relocation for
+/// isValidDynReloc - When we attempt to generate a dynamic relocation for
 /// ouput file, check if the relocation is supported by dynamic linker.
-void ARMGNULDBackend::checkValidReloc(Relocation& pReloc) const
+bool ARMGNULDBackend::isValidDynReloc(Relocation::Type pType) const
 {
   // If not PIC object, no relocation type is invalid
   if (!config().isCodeIndep())
-    return;
+    return true;
 
-  switch(pReloc.type()) {
+  switch(pType) {
     case llvm::ELF::R_ARM_RELATIVE:
     case llvm::ELF::R_ARM_COPY:
     case llvm::ELF::R_ARM_GLOB_DAT:
@@ -389,13 +447,22 @@ void ARMGNULDBackend::checkValidReloc(Relocation& pReloc) const
     case llvm::ELF::R_ARM_TLS_DTPMOD32:
     case llvm::ELF::R_ARM_TLS_DTPOFF32:
     case llvm::ELF::R_ARM_TLS_TPOFF32:
-      break;
-
+      return true;
     default:
-      error(diag::non_pic_relocation) << (int)pReloc.type()
-                                      << pReloc.symInfo()->name();
-      break;
+      return false;
+  }
+}
+
+/// reportInvalidDynRelocs - report the invalid dynamic relocations in the
+/// scanning order
+void ARMGNULDBackend::reportInvalidDynRelocs()
+{
+  RelocList::const_iterator reloc, rEnd = m_InvalidDynRelocs.end();
+  for (reloc = m_InvalidDynRelocs.begin(); reloc != rEnd; ++reloc) {
+    error(diag::non_pic_relocation) << (int)(*reloc)->type()
+                                    << (*reloc)->symInfo()->name();
   }
+  m_InvalidDynRelocs.clear();
 }
 
 void
@@ -416,9 +483,11 @@ ARMGNULDBackend::scanLocalReloc(Relocation& pReloc, const LDSection& pSection)
     case llvm::ELF::R_ARM_ABS32_NOI: {
       // If buiding PIC object (shared library or PIC executable),
       // a dynamic relocations with RELATIVE type to this location is needed.
-      // Reserve an entry in .rel.dyn
+      // Reserve an entry in .rel.dyn, or pack it into .relr.dyn
       if (config().isCodeIndep()) {
-        m_pRelDyn->reserveEntry();
+        if (llvm::ELF::R_ARM_ABS32 != pReloc.type() ||
+            !reserveRelrEntry(pReloc))
+          m_pRelDyn->reserveEntry();
         // set Rel bit
         rsym->setReserved(rsym->reserved() | ReserveRel);
         checkAndSetHasTextRel(*pSection.getLink());
@@ -528,16 +597,8 @@ void ARMGNULDBackend::scanGlobalReloc(Relocation& pReloc,
       // dynamic relocation entry
       if (symbolNeedsPLT(*rsym)) {
         // create plt for this symbol if it does not have one
-        if (!(rsym->reserved() & ReservePLT)){
-          // Symbol needs PLT entry, we need to reserve a PLT entry
-          // and the corresponding GOT and dynamic relocation entry
-          // in .got and .rel.plt. (GOT entry will be reserved simultaneously
-          // when calling ARMPLT->reserveEntry())
-          m_pPLT->reserveEntry();
-          m_pRelPLT->reserveEntry();
-          // set PLT bit
-          rsym->setReserved(rsym->reserved() | ReservePLT);
-        }
+        if (!(rsym->reserved() & ReservePLT))
+          reservePLT(*rsym);
       }
 
       if (symbolNeedsDynRel(*rsym, (rsym->reserved() & ReservePLT), true)) {
@@ -548,7 +609,8 @@ void ARMGNULDBackend::scanGlobalReloc(Relocation& pReloc,
           addCopyReloc(*cpy_sym.resolveInfo());
         }
         else {
-          checkValidReloc(pReloc);
+          if (!isValidDynReloc(pReloc.type()))
+            m_InvalidDynRelocs.push_back(&pReloc);
           // set Rel bit
           rsym->setReserved(rsym->reserved() | ReserveRel);
           checkAndSetHasTextRel(*pSection.getLink());
@@ -623,7 +685,8 @@ void ARMGNULDBackend::scanGlobalReloc(Relocation& pReloc,
           addCopyReloc(*cpy_sym.resolveInfo());
         }
         else {
-          checkValidReloc(pReloc);
+          if (!isValidDynReloc(pReloc.type()))
+            m_InvalidDynRelocs.push_back(&pReloc);
           // set Rel bit
           rsym->setReserved(rsym->reserved() | ReserveRel);
           checkAndSetHasTextRel(*pSection.getLink());
@@ -661,14 +724,7 @@ void ARMGNULDBackend::scanGlobalReloc(Relocation& pReloc,
         return;
       }
 
-      // Symbol needs PLT entry, we need to reserve a PLT entry
-      // and the corresponding GOT and dynamic relocation entry
-      // in .got and .rel.plt. (GOT entry will be reserved simultaneously
-      // when calling ARMPLT->reserveEntry())
-      m_pPLT->reserveEntry();
-      m_pRelPLT->reserveEntry();
-      // set PLT bit
-      rsym->setReserved(rsym->reserved() | ReservePLT);
+      reservePLT(*rsym);
       return;
     }
 
@@ -681,20 +737,7 @@ void ARMGNULDBackend::scanGlobalReloc(Relocation& pReloc,
     case llvm::ELF::R_ARM_GOT_ABS:
     case llvm::ELF::R_ARM_GOT_PREL: {
       // Symbol needs GOT entry, reserve entry in .got
-      // return if we already create GOT for this symbol
-      if (rsym->reserved() & (ReserveGOT | GOTRel))
-        return;
-      m_pGOT->reserveGOT();
-      // if the symbol cannot be fully resolved at link time, then we need a
-      // dynamic relocation
-      if (!symbolFinalValueIsKnown(*rsym)) {
-        m_pRelDyn->reserveEntry();
-        // set GOTRel bit
-        rsym->setReserved(rsym->reserved() | GOTRel);
-        return;
-      }
-      // set GOT bit
-      rsym->setReserved(rsym->reserved() | ReserveGOT);
+      reserveGOT(*rsym);
       return;
     }
 
@@ -713,6 +756,54 @@ void ARMGNULDBackend::scanGlobalReloc(Relocation& pReloc,
   } // end switch
 }
 
+void ARMGNULDBackend::reserveGOT(ResolveInfo& pSym)
+{
+  // return if we already create GOT for this symbol
+  if (pSym.reserved() & (ReserveGOT | GOTRel))
+    return;
+  m_pGOT->reserveGOT();
+  // if the symbol cannot be fully resolved at link time, then we need a
+  // dynamic relocation
+  if (!symbolFinalValueIsKnown(pSym)) {
+    m_pRelDyn->reserveEntry();
+    // set GOTRel bit
+    pSym.setReserved(pSym.reserved() | GOTRel);
+    return;
+  }
+  // set GOT bit
+  pSym.setReserved(pSym.reserved() | ReserveGOT);
+}
+
+void ARMGNULDBackend::reservePLT(ResolveInfo& pSym)
+{
+  // Symbol needs PLT entry, we need to reserve a PLT entry
+  // and the corresponding GOT and dynamic relocation entry.
+  m_pPLT->reserveEntry();
+  if (m_pPLT->isLazy()) {
+    // the GOTPLT entry is reserved by ARMPLT::reserveEntry(), and the
+    // relocation in .rel.plt is for the lazy binding
+    m_pRelPLT->reserveEntry();
+  }
+  else {
+    // all symbols are bound at load time, the PLT entry loads the GOT entry
+    // of the symbol, which is relocated by R_ARM_GLOB_DAT
+    reserveGOT(pSym);
+  }
+  // set PLT bit
+  pSym.setReserved(pSym.reserved() | ReservePLT);
+}
+
+bool ARMGNULDBackend::preScanRelocation(Relocation& pReloc,
+                                        const LDSection& pSection)
+{
+  assert(NULL != pReloc.symInfo() &&
+         "ResolveInfo of relocation not set while preScanRelocation");
+
+  pReloc.updateAddend();
+  assert(NULL != pSection.getLink());
+  return (0 != (pSection.getLink()->flag() & llvm::ELF::SHF_ALLOC));
+}
+
 void ARMGNULDBackend::scanRelocation(Relocation& pReloc,
                                      IRBuilder& pBuilder,
                                      Module& pModule,
@@ -720,12 +811,6 @@ void ARMGNULDBackend::scanRelocation(Relocation& pReloc,
 {
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
-  assert(NULL != rsym && "ResolveInfo of relocation not set while scanRelocation");
-
-  pReloc.updateAddend();
-  assert(NULL != pSection.getLink());
-  if (0 == (pSection.getLink()->flag() & llvm::ELF::SHF_ALLOC))
-    return;
 
   // Scan relocation type to determine if an GOT/PLT/Dynamic Relocation
   // entries should be created.
@@ -742,7 +827,7 @@ void ARMGNULDBackend::scanRelocation(Relocation& pReloc,
   // check if we shoule issue undefined reference for the relocation target
   // symbol
   if (rsym->isUndef() && !rsym->isDyn() && !rsym->isWeak() && !rsym->isNull())
-    fatal(diag::undefined_reference) << rsym->name();
+    issueUndefRef(pReloc, pSection, pModule);
 }
 
 uint64_t ARMGNULDBackend::emitSectionData(const LDSection& pSection,
@@ -810,6 +895,8 @@ uint64_t ARMGNULDBackend::emitSectionData(const LDSection& pSection,
 
   if (&pSection == &(file_format->getPLT())) {
     assert(NULL != m_pPLT && "emitSectionData failed, m_pPLT is NULL!");
+    if (!m_pPLT->isLazy())
+      m_pPLT->applyPLT1();
     uint64_t result = m_pPLT->emit(pRegion);
     return result;
   }
@@ -825,6 +912,38 @@ uint64_t ARMGNULDBackend::emitSectionData(const LDSection& pSection,
   return 0x0;
 }
 
+void ARMGNULDBackend::emitNops(uint8_t* pBuffer,
+                               uint64_t pOffset,
+                               uint64_t pSize) const
+{
+  // A padding can follow either ARM or Thumb code. ARM code always ends at a
+  // word boundary, so a padding starting at a halfword boundary follows Thumb
+  // code and is filled by Thumb nops. Otherwise, the words are filled by ARM
+  // nops, and a trailing halfword by a Thumb nop.
+  static const uint8_t arm_nop[4] = {0x00, 0x00, 0xa0, 0xe1}; // mov r0, r0
+  static const uint8_t thumb_nop[2] = {0xc0, 0x46};           // mov r8, r8
+
+  // an odd padding is not executed, fill it with zero
+  if (0x0 != (pOffset & 0x1) || 0x0 != (pSize & 0x1)) {
+    std::memset(pBuffer, 0x0, pSize);
+    return;
+  }
+
+  bool is_thumb = (0x0 != (pOffset & 0x2));
+  while (pSize > 0) {
+    if (!is_thumb && pSize >= 4) {
+      memcpy(pBuffer, arm_nop, 4);
+      pBuffer += 4;
+      pSize -= 4;
+    }
+    else {
+      memcpy(pBuffer, thumb_nop, 2);
+      pBuffer += 2;
+      pSize -= 2;
+    }
+  }
+}
+
 /// finalizeSymbol - finalize the symbol value
 bool ARMGNULDBackend::finalizeTargetSymbols()
 {
@@ -835,6 +954,8 @@ bool ARMGNULDBackend::mergeSection(Module& pModule, LDSection& pSection)
 {
   switch (pSection.type()) {
     case llvm::ELF::SHT_ARM_ATTRIBUTES: {
+      readCPUArch(pSection);
+
       // FIXME: (Luba)
       // Handle ARM attributes in the right way.
       // In current milestone, we goes through the shortcut.
@@ -857,6 +978,144 @@ bool ARMGNULDBackend::mergeSection(Module& pModule, LDSection& pSection)
   return true;
 }
 
+namespace {
+
+// the attribute tags of .ARM.attributes
+// @ref ARM IHI 0045, Addenda to, and Errata in, the ABI for the ARM Architecture
+enum {
+  Tag_File             = 1,
+  Tag_CPU_raw_name     = 4,
+  Tag_CPU_name         = 5,
+  Tag_CPU_arch         = 6,
+  Tag_compatibility    = 32
+};
+
+// the value of Tag_CPU_arch for ARMv5T
+const int CPU_Arch_V5T = 3;
+
+/// helper_read32 - read a little-endian word at pData
+uint32_t helper_read32(const uint8_t* pData)
+{
+  return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) |
+         ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+}
+
+/// helper_read_uleb128 - read an ULEB128 from pData[pOffset], return false at
+/// the end of the data
+bool helper_read_uleb128(const uint8_t* pData, size_t pSize, size_t& pOffset,
+                         uint64_t& pValue)
+{
+  pValue = 0x0;
+  unsigned int shift = 0;
+  while (pOffset < pSize) {
+    uint8_t byte = pData[pOffset++];
+    pValue |= (uint64_t)(byte & 0x7f) << shift;
+    if (0x0 == (byte & 0x80))
+      return true;
+    shift += 7;
+  }
+  return false;
+}
+
+/// helper_skip_ntbs - skip a NUL-terminated string at pData[pOffset]
+bool helper_skip_ntbs(const uint8_t* pData, size_t pSize, size_t& pOffset)
+{
+  while (pOffset < pSize) {
+    if (0x0 == pData[pOffset++])
+      return true;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+/// ReadCPUArch - read Tag_CPU_arch of the "aeabi" subsection, return -1 if
+/// not found
+int ARMGNULDBackend::ReadCPUArch(const uint8_t* pData, size_t pSize)
+{
+  // format-version 'A', and then the vendor subsections
+  if (0 == pSize || 'A' != pData[0])
+    return -1;
+
+  size_t offset = 1;
+  while (offset + 4 <= pSize) {
+    uint32_t sub_size = helper_read32(pData + offset);
+    if (sub_size < 4 || sub_size > pSize - offset)
+      return -1;
+    size_t sub_end = offset + sub_size;
+    const char* vendor = reinterpret_cast<const char*>(pData + offset + 4);
+    size_t pos = offset + 4;
+    if (!helper_skip_ntbs(pData, sub_end, pos))
+      return -1;
+
+    if (0 == strcmp(vendor, "aeabi")) {
+      // the attributes of the whole file are in the Tag_File sub-subsection
+      while (pos + 5 <= sub_end) {
+        uint8_t tag = pData[pos];
+        uint32_t size = helper_read32(pData + pos + 1);
+        if (size < 5 || size > sub_end - pos)
+          return -1;
+        size_t end = pos + size;
+        if (Tag_File != tag) {
+          pos = end;
+          continue;
+        }
+
+        pos += 5;
+        while (pos < end) {
+          uint64_t attr, value;
+          if (!helper_read_uleb128(pData, end, pos, attr))
+            return -1;
+          if (Tag_CPU_arch == attr) {
+            if (!helper_read_uleb128(pData, end, pos, value))
+              return -1;
+            return static_cast<int>(value);
+          }
+
+          // the values of Tag_CPU_raw_name, Tag_CPU_name and the odd tags
+          // above 32 are strings. Tag_compatibility has both.
+          bool ok = true;
+          if (Tag_compatibility == attr) {
+            ok = helper_read_uleb128(pData, end, pos, value) &&
+                 helper_skip_ntbs(pData, end, pos);
+          }
+          else if (Tag_CPU_raw_name == attr || Tag_CPU_name == attr ||
+                   (attr > Tag_compatibility && 0x1 == (attr & 0x1)))
+            ok = helper_skip_ntbs(pData, end, pos);
+          else
+            ok = helper_read_uleb128(pData, end, pos, value);
+          if (!ok)
+            return -1;
+        }
+        return -1;
+      }
+    }
+    offset = sub_end;
+  }
+  return -1;
+}
+
+void ARMGNULDBackend::readCPUArch(const LDSection& pSection)
+{
+  if (!pSection.hasSectionData() || pSection.getSectionData()->empty())
+    return;
+
+  const RegionFragment* frag =
+    llvm::dyn_cast<RegionFragment>(&pSection.getSectionData()->front());
+  if (NULL == frag)
+    return;
+
+  int arch = ReadCPUArch(frag->getRegion().start(),
+                         frag->getRegion().size());
+  if (arch > m_CPUArch)
+    m_CPUArch = arch;
+}
+
+bool ARMGNULDBackend::mayUseBLX() const
+{
+  return (-1 == m_CPUArch || m_CPUArch >= CPU_Arch_V5T);
+}
+
 bool ARMGNULDBackend::readSection(Input& pInput, SectionData& pSD)
 {
   Fragment* frag = NULL;
@@ -947,15 +1206,9 @@ ARMGNULDBackend::getTargetSectionOrder(const LDSection& pSectHdr) const
   return SHO_UNDEFINED;
 }
 
-/// doRelax
-bool
-ARMGNULDBackend::doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished)
+/// collectBranchRelocs
+void ARMGNULDBackend::collectBranchRelocs(Module& pModule)
 {
-  assert(NULL != getStubFactory() && NULL != getBRIslandFactory());
-
-  bool isRelaxed = false;
-  ELFFileFormat* file_format = getOutputFormat();
-  // check branch relocs and create the related stubs if needed
   Module::obj_iterator input, inEnd = pModule.obj_end();
   for (input = pModule.obj_begin(); input != inEnd; ++input) {
     LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
@@ -974,45 +1227,9 @@ ARMGNULDBackend::doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished)
           case llvm::ELF::R_ARM_THM_XPC22:
           case llvm::ELF::R_ARM_THM_JUMP24:
           case llvm::ELF::R_ARM_THM_JUMP19:
-          case llvm::ELF::R_ARM_V4BX: {
-            // calculate the possible symbol value
-            uint64_t sym_value = 0x0;
-            LDSymbol* symbol = relocation->symInfo()->outSymbol();
-            if (symbol->hasFragRef()) {
-              uint64_t value = symbol->fragRef()->getOutputOffset();
-              uint64_t addr =
-                symbol->fragRef()->frag()->getParent()->getSection().addr();
-              sym_value = addr + value;
-            }
-            if (relocation->symInfo()->isGlobal() &&
-                (relocation->symInfo()->reserved() & ReservePLT) != 0x0) {
-              // FIXME: we need to find out the address of the specific plt entry
-              assert(file_format->hasPLT());
-              sym_value = file_format->getPLT().addr();
-            }
-
-            Stub* stub = getStubFactory()->create(*relocation, // relocation
-                                                  sym_value, // symbol value
-                                                  pBuilder,
-                                                  *getBRIslandFactory());
-            if (NULL != stub) {
-              // a stub symbol should be local
-              assert(NULL != stub->symInfo() && stub->symInfo()->isLocal());
-              LDSection& symtab = file_format->getSymTab();
-              LDSection& strtab = file_format->getStrTab();
-
-              // increase the size of .symtab and .strtab if needed
-              if (config().targets().is32Bits())
-                symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
-              else
-                symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf64_Sym));
-              symtab.setInfo(symtab.getInfo() + 1);
-              strtab.setSize(strtab.size() + stub->symInfo()->nameSize() + 1);
-
-              isRelaxed = true;
-            }
+          case llvm::ELF::R_ARM_V4BX:
+            m_BranchRelocs.push_back(relocation);
             break;
-          }
           default:
             break;
         } // end of switch
@@ -1020,6 +1237,118 @@ ARMGNULDBackend::doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished)
       } // for all relocations
     } // for all relocation section
   } // for all inputs
+}
+
+/// maxBranchRange
+uint64_t ARMGNULDBackend::maxBranchRange(uint32_t pType) const
+{
+  switch (pType) {
+    case llvm::ELF::R_ARM_CALL:
+    case llvm::ELF::R_ARM_JUMP24:
+    case llvm::ELF::R_ARM_PLT32:
+      return -ARM_MAX_BWD_BRANCH_OFFSET;
+    case llvm::ELF::R_ARM_THM_CALL:
+    case llvm::ELF::R_ARM_THM_XPC22:
+    case llvm::ELF::R_ARM_THM_JUMP24:
+      return -THM_MAX_BWD_BRANCH_OFFSET;
+    case llvm::ELF::R_ARM_THM_JUMP19:
+      return -THM_JUMP19_MAX_BWD_BRANCH_OFFSET;
+    default:
+      // no stub is shared by the other relocations
+      return 0x0;
+  }
+}
+
+/// mayBeShifted
+bool ARMGNULDBackend::mayBeShifted(const Relocation& pReloc,
+                                   uint64_t pOffset) const
+{
+  // the sections after .text are moved as a whole if .text grows
+  const LDSection* text = &getOutputFormat()->getText();
+  const Fragment* place = pReloc.targetRef().frag();
+  if (text != &place->getParent()->getSection() ||
+      place->getOffset() >= pOffset)
+    return true;
+
+  // the branches to PLT are checked in every round
+  if (pReloc.symInfo()->isGlobal() &&
+      (pReloc.symInfo()->reserved() & ReservePLT) != 0x0)
+    return true;
+
+  const LDSymbol* symbol = pReloc.symInfo()->outSymbol();
+  if (!symbol->hasFragRef() || NULL == symbol->fragRef()->frag())
+    return false;
+  const Fragment* target = symbol->fragRef()->frag();
+  return (text != &target->getParent()->getSection() ||
+          target->getOffset() >= pOffset);
+}
+
+/// doRelax
+bool
+ARMGNULDBackend::doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished)
+{
+  assert(NULL != getStubFactory() && NULL != getBRIslandFactory());
+
+  ELFFileFormat* file_format = getOutputFormat();
+
+  // The branches are collected once. In the later rounds, only the branches
+  // whose distances may be changed by the shifted fragments are checked.
+  // The islands of .text are planned before the first round, so that the
+  // stubs are assigned to them in one round.
+  if (m_BranchRelocs.empty()) {
+    collectBranchRelocs(pModule);
+    if (file_format->getText().hasSectionData())
+      getBRIslandFactory()->plan(*file_format->getText().getSectionData());
+  }
+
+  bool isRelaxed = false;
+  // check branch relocs and create the related stubs if needed
+  BranchRelocList::iterator reloc, rEnd = m_BranchRelocs.end();
+  for (reloc = m_BranchRelocs.begin(); reloc != rEnd; ++reloc) {
+    Relocation* relocation = *reloc;
+    if (!mayBeShifted(*relocation, m_ShiftedOffset))
+      continue;
+
+    // calculate the possible symbol value
+    uint64_t sym_value = 0x0;
+    LDSymbol* symbol = relocation->symInfo()->outSymbol();
+    if (symbol->hasFragRef()) {
+      uint64_t value = symbol->fragRef()->getOutputOffset();
+      uint64_t addr =
+        symbol->fragRef()->frag()->getParent()->getSection().addr();
+      sym_value = addr + value;
+    }
+    if (relocation->symInfo()->isGlobal() &&
+        (relocation->symInfo()->reserved() & ReservePLT) != 0x0) {
+      // FIXME: we need to find out the address of the specific plt entry
+      assert(file_format->hasPLT());
+      sym_value = file_format->getPLT().addr();
+    }
+
+    Stub* stub = getStubFactory()->create(*relocation, // relocation
+                                          sym_value, // symbol value
+                                          pBuilder,
+                                          *getBRIslandFactory(),
+                                          maxBranchRange(relocation->type()));
+    if (NULL != stub) {
+      // a stub symbol should be local
+      assert(NULL != stub->symInfo() && stub->symInfo()->isLocal());
+      LDSection& symtab = file_format->getSymTab();
+      LDSection& strtab = file_format->getStrTab();
+
+      // increase the size of .symtab and .strtab if needed
+      if (config().targets().is32Bits())
+        symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
+      else
+        symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf64_Sym));
+      symtab.setInfo(symtab.getInfo() + 1);
+      getStrTabNames().add(llvm::StringRef(stub->symInfo()->name(),
+                                           stub->symInfo()->nameSize()));
+      strtab.setSize(getStrTabNames().size());
+
+      isRelaxed = true;
+    }
+  } // for all branch relocations
 
   // find the first fragment w/ invalid offset due to stub insertion
   Fragment* invalid = NULL;
@@ -1037,7 +1366,12 @@ ARMGNULDBackend::doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished)
     }
   }
 
-  // reset the offset of invalid fragments
+  // reset the offset of invalid fragments, and check the branches across
+  // them in the next round
+  if (NULL != invalid) {
+    m_ShiftedOffset = invalid->getPrevNode()->getOffset() +
+                      invalid->getPrevNode()->size();
+  }
   while (NULL != invalid) {
     invalid->setOffset(invalid->getPrevNode()->getOffset() +
                        invalid->getPrevNode()->size());
@@ -1053,19 +1387,159 @@ ARMGNULDBackend::doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished)
   return isRelaxed;
 }
 
+/// relaxedSectionBegin
+Module::iterator ARMGNULDBackend::relaxedSectionBegin(Module& pModule)
+{
+  const LDSection* text = &getOutputFormat()->getText();
+  Module::iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    if (text == *sect)
+      return sect;
+  }
+  return pModule.begin();
+}
+
 /// initTargetStubs
 bool ARMGNULDBackend::initTargetStubs()
 {
   if (NULL != getStubFactory()) {
     getStubFactory()->addPrototype(new ARMToARMStub(config().isCodeIndep()));
-    getStubFactory()->addPrototype(new ARMToTHMStub(config().isCodeIndep()));
+    getStubFactory()->addPrototype(new ARMToTHMStub(config().isCodeIndep(),
+                                                    mayUseBLX()));
     getStubFactory()->addPrototype(new THMToTHMStub(config().isCodeIndep()));
-    getStubFactory()->addPrototype(new THMToARMStub(config().isCodeIndep()));
+    getStubFactory()->addPrototype(new THMToARMStub(config().isCodeIndep(),
+                                                    mayUseBLX()));
     return true;
   }
   return false;
 }
 
+namespace {
+
+/// EXIDXEntry - an entry of .ARM.exidx with its PREL31 fields resolved
+struct EXIDXEntry
+{
+  /// the address of the function
+  uint64_t func;
+  /// EXIDX_CANTUNWIND, an inline entry, or the address of the .ARM.extab
+  /// entry if isTab
+  uint64_t data;
+  bool isTab;
+
+  bool operator==(const EXIDXEntry& pOther) const
+  { return data == pOther.data && isTab == pOther.isTab; }
+};
+
+/// EXIDXFuncLess - order the entries by the address of their functions
+struct EXIDXFuncLess
+{
+  bool operator()(const EXIDXEntry& pX, const EXIDXEntry& pY) const
+  { return pX.func < pY.func; }
+};
+
+/// the second word of an entry of a function which cannot be unwound
+const uint32_t EXIDX_CANTUNWIND = 0x1;
+
+/// helper_write32 - write a little-endian word at pData
+void helper_write32(uint8_t* pData, uint32_t pValue)
+{
+  pData[0] = pValue & 0xff;
+  pData[1] = (pValue >> 8) & 0xff;
+  pData[2] = (pValue >> 16) & 0xff;
+  pData[3] = (pValue >> 24) & 0xff;
+}
+
+/// helper_decode_prel31 - the address referred by the PREL31 pWord at pPlace
+uint64_t helper_decode_prel31(uint64_t pPlace, uint32_t pWord)
+{
+  int32_t offset = (int32_t)(pWord << 1) >> 1;
+  return (uint32_t)(pPlace + offset);
+}
+
+/// helper_encode_prel31 - the PREL31 word at pPlace referring to pAddr
+uint32_t helper_encode_prel31(uint64_t pPlace, uint64_t pAddr)
+{
+  return (uint32_t)(pAddr - pPlace) & 0x7fffffff;
+}
+
+/// helper_write_exidx - write pEntry at pData, placed at pPlace
+void helper_write_exidx(uint8_t* pData, uint64_t pPlace,
+                        const EXIDXEntry& pEntry)
+{
+  helper_write32(pData, helper_encode_prel31(pPlace, pEntry.func));
+  if (pEntry.isTab)
+    helper_write32(pData + 4, helper_encode_prel31(pPlace + 4, pEntry.data));
+  else
+    helper_write32(pData + 4, pEntry.data);
+}
+
+} // anonymous namespace
+
+/// SortEXIDX - sort the entries of .ARM.exidx by the addresses of their
+/// functions, merge the adjacent entries with the same unwinding
+/// instructions, and terminate the table by a EXIDX_CANTUNWIND sentinel at
+/// the end of the code.
+/// The size of the section is fixed by the layout, so the slots freed by the
+/// merged entries are filled with the sentinel as well.
+void ARMGNULDBackend::SortEXIDX(uint8_t* pData, size_t pSize, uint64_t pAddr,
+                                uint64_t pCodeEnd)
+{
+  size_t num = pSize / EXIDXEntrySize;
+  if (num < 2)
+    return;
+
+  // the last slot is the reserved sentinel
+  std::vector<EXIDXEntry> entries(num - 1);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    uint64_t place = pAddr + i * EXIDXEntrySize;
+    uint32_t word = helper_read32(pData + i * EXIDXEntrySize + 4);
+    entries[i].func =
+      helper_decode_prel31(place, helper_read32(pData + i * EXIDXEntrySize));
+    entries[i].isTab = (EXIDX_CANTUNWIND != word && 0x0 == (word >> 31));
+    entries[i].data = entries[i].isTab ?
+                      helper_decode_prel31(place + 4, word) : word;
+  }
+  std::stable_sort(entries.begin(), entries.end(), EXIDXFuncLess());
+
+  // merge the adjacent entries with the same unwinding instructions
+  size_t idx = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (0 != idx && entries[idx - 1] == entries[i])
+      continue;
+    helper_write_exidx(pData + idx * EXIDXEntrySize,
+                       pAddr + idx * EXIDXEntrySize, entries[i]);
+    entries[idx++] = entries[i];
+  }
+
+  EXIDXEntry sentinel = { pCodeEnd, EXIDX_CANTUNWIND, false };
+  for (; idx < num; ++idx) {
+    helper_write_exidx(pData + idx * EXIDXEntrySize,
+                       pAddr + idx * EXIDXEntrySize, sentinel);
+  }
+}
+
+/// sortEXIDX - sort the entries of .ARM.exidx in the output
+void ARMGNULDBackend::sortEXIDX(MemoryArea& pOutput)
+{
+  if (m_pEXIDX->size() < 2 * EXIDXEntrySize)
+    return;
+
+  MemoryRegion* region = pOutput.request(m_pEXIDX->offset(),
+                                         m_pEXIDX->size());
+  SortEXIDX(region->start(), m_pEXIDX->size(), m_pEXIDX->addr(), m_CodeEnd);
+  pOutput.release(region);
+}
+
+/// postProcessing - sort .ARM.exidx before the generic post-processing,
+/// which computes the build ID over the final output
+void ARMGNULDBackend::postProcessing(MemoryArea& pOutput)
+{
+  if (LinkerConfig::Object != config().codeGenType() &&
+      NULL != m_pEXIDX && 0x0 != m_pEXIDX->size())
+    sortEXIDX(pOutput);
+  GNULDBackend::postProcessing(pOutput);
+}
+
 /// doCreateProgramHdrs - backend can implement this function to create the
 /// target-dependent segments
 void ARMGNULDBackend::doCreateProgramHdrs(Module& pModule)
@@ -16,6 +16,8 @@
 #include <mcld/Target/GNULDBackend.h>
 #include <mcld/Target/OutputRelocSection.h>
 
+#include <vector>
+
 namespace mcld {
 
 class LinkerConfig;
@@ -36,11 +38,15 @@ public:
   static const int32_t THM_MAX_BWD_BRANCH_OFFSET = (-(1 << 22) + 4);
   static const int32_t THM2_MAX_FWD_BRANCH_OFFSET = (((1 << 24) - 2) + 4);
   static const int32_t THM2_MAX_BWD_BRANCH_OFFSET = (-(1 << 24) + 4);
+  static const int32_t THM_JUMP19_MAX_FWD_BRANCH_OFFSET = ((1 << 20) - 2 + 4);
+  static const int32_t THM_JUMP19_MAX_BWD_BRANCH_OFFSET = (-(1 << 20) + 4);
 
 public:
   ARMGNULDBackend(const LinkerConfig& pConfig, GNUInfo* pInfo);
   ~ARMGNULDBackend();
 
+  void reset();
+
 public:
   typedef std::vector<llvm::ELF::Elf32_Dyn*> ELF32DynList;
 
@@ -111,6 +117,10 @@ public:
                       Module& pModule,
                       LDSection& pSection);
 
+  /// preScanRelocation - update the addend, and skip the relocations of the
+  /// non-allocated sections
+  bool preScanRelocation(Relocation& pReloc, const LDSection& pSection);
+
   /// doPreLayout - Backend can do any needed modification before layout
   void doPreLayout(IRBuilder& pBuilder);
 
@@ -144,6 +154,13 @@ public:
   uint64_t emitSectionData(const LDSection& pSection,
                            MemoryRegion& pRegion) const;
 
+  /// emitNops - fill the padding of an executable section with nops
+  void emitNops(uint8_t* pBuffer, uint64_t pOffset, uint64_t pSize) const;
+
+  /// postProcessing - sort .ARM.exidx, and then do the generic
+  /// post-processing
+  void postProcessing(MemoryArea& pOutput);
+
   ARMGOT& getGOT();
 
   const ARMGOT& getGOT() const;
@@ -172,14 +189,56 @@ public:
   /// readSection - read target dependent sections
   bool readSection(Input& pInput, SectionData& pSD);
 
+  /// mayUseBLX - can a call across ARM and Thumb state be rewritten to BLX?
+  /// BLX is available if Tag_CPU_arch of the inputs is ARMv5T or above. The
+  /// inputs without .ARM.attributes are assumed to run on such cores.
+  bool mayUseBLX() const;
+
+  /// the size of an entry of .ARM.exidx
+  static const size_t EXIDXEntrySize = 8;
+
+  /// SortEXIDX - sort the pSize bytes of .ARM.exidx entries at pData, which
+  /// are placed at pAddr, by the addresses of their functions. The adjacent
+  /// identical entries are merged, and the freed slots and the reserved last
+  /// slot are filled with a EXIDX_CANTUNWIND sentinel at pCodeEnd.
+  static void SortEXIDX(uint8_t* pData, size_t pSize, uint64_t pAddr,
+                        uint64_t pCodeEnd);
+
+  /// ReadCPUArch - read Tag_CPU_arch from the pSize bytes of an input
+  /// .ARM.attributes at pData. Return -1 if the "aeabi" attributes of the file
+  /// have no Tag_CPU_arch or the data is malformed.
+  static int ReadCPUArch(const uint8_t* pData, size_t pSize);
+
 private:
+  /// sortEXIDX - sort the entries of .ARM.exidx in pOutput by SortEXIDX()
+  void sortEXIDX(MemoryArea& pOutput);
+
+  /// readCPUArch - read Tag_CPU_arch from an input .ARM.attributes by
+  /// ReadCPUArch()
+  void readCPUArch(const LDSection& pSection);
+
   void scanLocalReloc(Relocation& pReloc, const LDSection& pSection);
 
   void scanGlobalReloc(Relocation& pReloc,
                        IRBuilder& pBuilder,
                        const LDSection& pSection);
 
-  void checkValidReloc(Relocation& pReloc) const;
+  /// reserveGOT - reserve the GOT entry of the global symbol pSym and its
+  /// dynamic relocation
+  void reserveGOT(ResolveInfo& pSym);
+
+  /// reservePLT - reserve the PLT entry of pSym. A lazy PLT entry has its own
+  /// GOTPLT entry and .rel.plt relocation, and a non-lazy one shares the GOT
+  /// entry of pSym.
+  void reservePLT(ResolveInfo& pSym);
+
+  /// isValidDynReloc - can the dynamic linker handle a dynamic relocation
+  /// generated for a relocation of type pType?
+  bool isValidDynReloc(Relocation::Type pType) const;
+
+  /// reportInvalidDynRelocs - report the relocations collected by the scan
+  /// for which the dynamic linker can not handle a dynamic relocation
+  void reportInvalidDynRelocs();
 
   /// addCopyReloc - add a copy relocation into .rel.dyn for pSym
   /// @param pSym - A resolved copy symbol that defined in BSS section
@@ -197,6 +256,9 @@ private:
   /// FIXME: if we can handle arm attributes, we may refine this!
   uint64_t maxBranchOffset() { return THM_MAX_FWD_BRANCH_OFFSET; }
 
+  /// maxBranchRange - the backward offset, which is the shorter one
+  uint64_t maxBranchRange(uint32_t pType) const;
+
   /// mayRelax - Backends should override this function if they need relaxation
   bool mayRelax() { return true; }
 
@@ -206,6 +268,16 @@ private:
   /// otherwise set it to false.
   bool doRelax(Module& pModule, IRBuilder& pBuilder, bool& pFinished);
 
+  /// relaxedSectionBegin - the stubs are only inserted into .text
+  Module::iterator relaxedSectionBegin(Module& pModule);
+
+  /// collectBranchRelocs - collect the relocations which may need stubs
+  void collectBranchRelocs(Module& pModule);
+
+  /// mayBeShifted - can the distance of the branch pReloc be changed by the
+  /// fragments of .text from pOffset on?
+  bool mayBeShifted(const Relocation& pReloc, uint64_t pOffset) const;
+
   /// initTargetStubs
   bool initTargetStubs();
 
@@ -221,9 +293,27 @@ private:
   /// target-dependent segments
   virtual void doCreateProgramHdrs(Module& pModule);
 
+private:
+  typedef std::vector<Relocation*> BranchRelocList;
+  typedef std::vector<Relocation*> RelocList;
+
 private:
   Relocator* m_pRelocator;
 
+  /// m_BranchRelocs - the branch relocations, collected by the first doRelax
+  BranchRelocList m_BranchRelocs;
+  /// m_InvalidDynRelocs - the relocations which need an unsupported dynamic
+  /// relocation, in the scanning order. They are reported before layout.
+  RelocList m_InvalidDynRelocs;
+  /// m_ShiftedOffset - the fragments of .text from this offset on are shifted
+  /// by the last doRelax
+  uint64_t m_ShiftedOffset;
+  /// m_CPUArch - the highest Tag_CPU_arch of the inputs, or -1 if no input
+  /// has .ARM.attributes
+  int m_CPUArch;
+  /// m_CodeEnd - the end address of the executable sections
+  uint64_t m_CodeEnd;
+
   ARMGOT* m_pGOT;
   ARMPLT* m_pPLT;
   /// m_RelDyn - dynamic relocation table of .rel.dyn
@@ -23,15 +23,19 @@ ARMPLT0::ARMPLT0(SectionData& pParent)
   : PLT::Entry<sizeof(arm_plt0)>(pParent) {}
 
 ARMPLT1::ARMPLT1(SectionData& pParent)
-  : PLT::Entry<sizeof(arm_plt1)>(pParent) {}
+  : PLT::Entry<sizeof(arm_plt1)>(pParent), m_GOTOffset(0x0) {}
 
 //===----------------------------------------------------------------------===//
 // ARMPLT
 
 ARMPLT::ARMPLT(LDSection& pSection,
-               ARMGOT &pGOTPLT)
-  : PLT(pSection), m_GOT(pGOTPLT), m_PLTEntryIterator() {
-  new ARMPLT0(*m_SectionData);
+               ARMGOT &pGOTPLT,
+               bool pIsLazy)
+  : PLT(pSection), m_GOT(pGOTPLT), m_bLazy(pIsLazy), m_PLTEntryIterator() {
+  // m_PLTEntryIterator is the last consumed entry. It is PLT0 of a lazy PLT,
+  // or end() of a non-lazy PLT before the first consume().
+  if (m_bLazy)
+    new ARMPLT0(*m_SectionData);
   m_PLTEntryIterator = m_SectionData->begin();
 }
 
@@ -41,13 +45,16 @@ ARMPLT::~ARMPLT()
 
 bool ARMPLT::hasPLT1() const
 {
-  return (m_SectionData->size() > 1);
+  return (m_SectionData->size() > (m_bLazy ? 1 : 0));
 }
 
 void ARMPLT::finalizeSectionSize()
 {
-  uint64_t size = (m_SectionData->size() - 1) * sizeof(arm_plt1) +
-                     sizeof(arm_plt0);
+  uint64_t size = 0;
+  if (m_bLazy)
+    size = (m_SectionData->size() - 1) * sizeof(arm_plt1) + sizeof(arm_plt0);
+  else
+    size = m_SectionData->size() * sizeof(arm_plt1);
   m_Section.setSize(size);
 
   uint32_t offset = 0;
@@ -68,13 +75,18 @@ void ARMPLT::reserveEntry(size_t pNum)
     if (!plt1_entry)
       fatal(diag::fail_allocate_memory_plt);
 
-    m_GOT.reserveGOTPLT();
+    // the GOT entry of a non-lazy PLT entry is reserved with the symbol
+    if (m_bLazy)
+      m_GOT.reserveGOTPLT();
   }
 }
 
 ARMPLT1* ARMPLT::consume()
 {
-  ++m_PLTEntryIterator;
+  if (m_PLTEntryIterator == m_SectionData->end())
+    m_PLTEntryIterator = m_SectionData->begin();
+  else
+    ++m_PLTEntryIterator;
   assert(m_PLTEntryIterator != m_SectionData->end() &&
          "The number of PLT Entries and ResolveInfo doesn't match");
 
@@ -82,6 +94,7 @@ ARMPLT1* ARMPLT::consume()
 }
 
 ARMPLT0* ARMPLT::getPLT0() const {
+  assert(m_bLazy && "non-lazy PLT has no PLT0!");
 
   iterator first = m_SectionData->getFragmentList().begin();
 
@@ -94,6 +107,8 @@ ARMPLT0* ARMPLT::getPLT0() const {
 }
 
 void ARMPLT::applyPLT0() {
+  if (!m_bLazy)
+    return;
 
   uint64_t plt_base = m_Section.addr();
   assert(plt_base && ".plt base address is NULL!");
@@ -143,10 +158,11 @@ void ARMPLT::applyPLT1() {
   uint32_t GOTEntryAddress =
     got_base +  GOTEntrySize * 3;
 
-  uint64_t PLTEntryAddress =
-    plt_base + ARMPLT0::EntrySize; //Offset of PLT0
-
-  ++it; //skip PLT0
+  uint64_t PLTEntryAddress = plt_base;
+  if (m_bLazy) {
+    PLTEntryAddress += ARMPLT0::EntrySize; //Offset of PLT0
+    ++it; //skip PLT0
+  }
   uint64_t PLT1EntrySize = ARMPLT1::EntrySize;
   ARMPLT1* plt1 = NULL;
 
@@ -158,6 +174,10 @@ void ARMPLT::applyPLT1() {
     if (!Out)
       fatal(diag::fail_allocate_memory_plt);
 
+    // a non-lazy PLT1 entry loads the GOT entry of its symbol
+    if (!m_bLazy)
+      GOTEntryAddress = got_base + plt1->getGOTOffset();
+
     // Offset is the distance between the last PLT entry and the associated
     // GOT entry.
     int32_t Offset = (GOTEntryAddress - (PLTEntryAddress + 8));
@@ -182,9 +202,11 @@ uint64_t ARMPLT::emit(MemoryRegion& pRegion)
   iterator it = begin();
 
   unsigned char* buffer = pRegion.getBuffer();
-  memcpy(buffer, llvm::cast<ARMPLT0>((*it)).getValue(), ARMPLT0::EntrySize);
-  result += ARMPLT0::EntrySize;
-  ++it;
+  if (m_bLazy) {
+    memcpy(buffer, llvm::cast<ARMPLT0>((*it)).getValue(), ARMPLT0::EntrySize);
+    result += ARMPLT0::EntrySize;
+    ++it;
+  }
 
   ARMPLT1* plt1 = 0;
   ARMPLT::iterator ie = end();
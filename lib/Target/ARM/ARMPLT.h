@@ -45,17 +45,38 @@ class ARMPLT1 : public PLT::Entry<sizeof(arm_plt1)>
 {
 public:
   ARMPLT1(SectionData& pParent);
+
+  /// getGOTOffset - the offset in .got of the GOT entry a non-lazy PLT1
+  /// entry loads
+  uint64_t getGOTOffset() const
+  { return m_GOTOffset; }
+
+  void setGOTOffset(uint64_t pOffset)
+  { m_GOTOffset = pOffset; }
+
+private:
+  uint64_t m_GOTOffset;
 };
 
 /** \class ARMPLT
  *  \brief ARM Procedure Linkage Table
+ *
+ *  A non-lazy PLT (-z now) has no PLT0, and each PLT1 entry loads the GOT
+ *  entry of its symbol instead of a GOTPLT entry. The GOT entries are bound
+ *  while applying relocations, so applyPLT1() of a non-lazy PLT is called
+ *  at emission.
  */
 class ARMPLT : public PLT
 {
 public:
-  ARMPLT(LDSection& pSection, ARMGOT& pGOTPLT);
+  ARMPLT(LDSection& pSection, ARMGOT& pGOTPLT, bool pIsLazy);
   ~ARMPLT();
 
+  /// isLazy - does this PLT have PLT0 and the GOTPLT entries for the lazy
+  /// binding?
+  bool isLazy() const
+  { return m_bLazy; }
+
   // finalizeSectionSize - set LDSection size
   void finalizeSectionSize();
 
@@ -76,6 +97,7 @@ public:
 
 private:
   ARMGOT& m_GOT;
+  bool m_bLazy;
 
   // Used by getEntry() for mapping a ResolveInfo instance to a PLT1 Entry.
   iterator m_PLTEntryIterator;
@@ -12,6 +12,7 @@
 #include <llvm/Support/ELF.h>
 #include <llvm/Support/Host.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/LD/RelocationBatch.h>
 #include "ARMRelocator.h"
 #include "ARMRelocationFunctions.h"
 
@@ -39,6 +40,21 @@ static const ApplyFunctionTriple ApplyFunctions[] = {
   DECL_ARM_APPLY_RELOC_FUNC_PTRS
 };
 
+// the kernels of the common relocations. They call the applying functions
+// directly, so that the functions can be inlined into the loops of
+// RelocationBatch.
+struct ARMAbs32Kernel
+{
+  Relocator::Result operator()(Relocation& pReloc, ARMRelocator& pParent)
+  { return abs32(pReloc, pParent); }
+};
+
+struct ARMCallKernel
+{
+  Relocator::Result operator()(Relocation& pReloc, ARMRelocator& pParent)
+  { return call(pReloc, pParent); }
+};
+
 //===--------------------------------------------------------------------===//
 // ARMRelocator
 //===--------------------------------------------------------------------===//
@@ -72,6 +88,56 @@ Relocator::Size ARMRelocator::getSize(Relocation::Type pType) const
   return 32;
 }
 
+bool ARMRelocator::mayApplyConcurrently(const Relocation& pRelocation) const
+{
+  Relocation::Type type = pRelocation.type();
+  if (type >= sizeof (ApplyFunctions) / sizeof (ApplyFunctions[0]))
+    return false;
+
+  // these functions consume PLT and dynamic relocation entries only if the
+  // symbol reserves them
+  ApplyFunctionType func = ApplyFunctions[type].func;
+  ApplyFunctionType none_func = &none;
+  ApplyFunctionType abs32_func = &abs32;
+  ApplyFunctionType call_func = &call;
+  if (none_func == func)
+    return true;
+  if (abs32_func != func && call_func != func)
+    return false;
+
+  const ResolveInfo* rsym = pRelocation.symInfo();
+  return (NULL != rsym && 0x0 == rsym->reserved());
+}
+
+bool ARMRelocator::isDataAddend(Type pType) const
+{
+  return (llvm::ELF::R_ARM_ABS32 == pType ||
+          llvm::ELF::R_ARM_GOTOFF32 == pType);
+}
+
+void ARMRelocator::applyBatch(Relocation* const* pRelocs,
+                              Result* pResults,
+                              size_t pNum)
+{
+  RelocationBatch batch(pRelocs, pNum);
+  RelocationBatch::run_iterator run, rEnd = batch.run_end();
+  for (run = batch.run_begin(); run != rEnd; ++run) {
+    assert(run->type < sizeof (ApplyFunctions) / sizeof (ApplyFunctions[0]));
+    switch (run->type) {
+      case llvm::ELF::R_ARM_ABS32:
+        batch.apply(*run, ARMAbs32Kernel(), *this, pResults);
+        break;
+      case llvm::ELF::R_ARM_CALL:
+      case llvm::ELF::R_ARM_JUMP24:
+        batch.apply(*run, ARMCallKernel(), *this, pResults);
+        break;
+      default:
+        batch.apply(*run, ApplyFunctions[run->type].func, *this, pResults);
+        break;
+    }
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // non-member functions
 //===--------------------------------------------------------------------===//
@@ -197,7 +263,13 @@ ARMPLT1& helper_get_PLT_and_init(Relocation& pReloc, ARMRelocator& pParent)
   pParent.getSymPLTMap().record(*rsym, *plt_entry);
 
   // If we first get this PLT entry, we should initialize it.
-  if (rsym->reserved() & ARMGNULDBackend::ReservePLT) {
+  if ((rsym->reserved() & ARMGNULDBackend::ReservePLT) &&
+      !ld_backend.getPLT().isLazy()) {
+    // the non-lazy PLT entry loads the GOT entry of the symbol
+    ARMGOTEntry& got_entry = helper_get_GOT_and_init(pReloc, pParent);
+    plt_entry->setGOTOffset(got_entry.getOffset());
+  }
+  else if (rsym->reserved() & ARMGNULDBackend::ReservePLT) {
     ARMGOTEntry* gotplt_entry = pParent.getSymGOTPLTMap().lookUp(*rsym);
     assert(NULL == gotplt_entry && "PLT entry not exist, but DynRel entry exist!");
     gotplt_entry = ld_backend.getGOT().consumeGOTPLT();
@@ -378,7 +450,9 @@ ARMRelocator::Result abs32(Relocation& pReloc, ARMRelocator& pParent)
 
   // A local symbol may need REL Type dynamic relocation
   if (rsym->isLocal() && (rsym->reserved() & ARMGNULDBackend::ReserveRel)) {
-    helper_DynRel(pReloc, llvm::ELF::R_ARM_RELATIVE, pParent);
+    // the relocation packed into .relr.dyn needs no entry in .rel.dyn
+    if (!pParent.getTarget().isRelrEntry(pReloc))
+      helper_DynRel(pReloc, llvm::ELF::R_ARM_RELATIVE, pParent);
     pReloc.target() = (S + A) | T ;
     return ARMRelocator::OK;
   }
@@ -514,12 +588,12 @@ ARMRelocator::Result call(Relocation& pReloc, ARMRelocator& pParent)
   }
 
   // At this moment (after relaxation), if the jump target is thumb instruction,
-  // switch mode is needed, rewrite the instruction to BLX
-  // FIXME: check if we can use BLX instruction (check from .ARM.attribute
-  // CPU ARCH TAG, which should be ARMv5 or above)
+  // switch mode is needed, rewrite the instruction to BLX. Without BLX, the
+  // branch should have been redirected to a stub.
   if (T != 0) {
     // cannot rewrite to blx for R_ARM_JUMP24
-    if (pReloc.type() == llvm::ELF::R_ARM_JUMP24)
+    if (pReloc.type() == llvm::ELF::R_ARM_JUMP24 ||
+        !pParent.getTarget().mayUseBLX())
       return ARMRelocator::BadReloc;
 
     pReloc.target() = (pReloc.target() & 0xffffff) |
@@ -573,12 +647,12 @@ ARMRelocator::Result thm_call(Relocation& pReloc, ARMRelocator& pParent)
   S = S + A;
 
   // At this moment (after relaxation), if the jump target is arm
-  // instruction, switch mode is needed, rewrite the instruction to BLX
-  // FIXME: check if we can use BLX instruction (check from .ARM.attribute
-  // CPU ARCH TAG, which should be ARMv5 or above)
+  // instruction, switch mode is needed, rewrite the instruction to BLX.
+  // Without BLX, the branch should have been redirected to a stub.
   if (T == 0) {
     // cannot rewrite to blx for R_ARM_THM_JUMP24
-    if (pReloc.type() == llvm::ELF::R_ARM_THM_JUMP24)
+    if (pReloc.type() == llvm::ELF::R_ARM_THM_JUMP24 ||
+        !pParent.getTarget().mayUseBLX())
       return ARMRelocator::BadReloc;
 
     // for BLX, select bit 1 from relocation base address to jump target
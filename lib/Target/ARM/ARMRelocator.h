@@ -35,6 +35,16 @@ public:
 
   Result applyRelocation(Relocation& pRelocation);
 
+  /// mayApplyConcurrently - the absolute relocations and the branches of
+  /// symbols which reserve no PLT or dynamic relocation entries.
+  bool mayApplyConcurrently(const Relocation& pRelocation) const;
+
+  /// isDataAddend - R_ARM_ABS32 and R_ARM_GOTOFF32
+  bool isDataAddend(Type pType) const;
+
+  /// applyBatch - apply the common relocations by type in tight loops
+  void applyBatch(Relocation* const* pRelocs, Result* pResults, size_t pNum);
+
   ARMGNULDBackend& getTarget()
   { return m_Target; }
 
@@ -31,7 +31,8 @@ class ResolveInfo;
 class ARMToTHMStub : public Stub
 {
 public:
-  ARMToTHMStub(bool pIsOutputPIC);
+  /// @param pUseBLX - can the calls switch the mode by BLX without a stub?
+  ARMToTHMStub(bool pIsOutputPIC, bool pUseBLX);
 
   ~ARMToTHMStub();
 
@@ -57,6 +58,7 @@ private:
   /// for doClone
   ARMToTHMStub(const uint32_t* pData,
                size_t pSize,
+               bool pUseBLX,
                const_fixup_iterator pBegin,
                const_fixup_iterator pEnd);
 
@@ -69,6 +71,7 @@ private:
   static const uint32_t TEMPLATE[];
   const uint32_t* m_pData;
   size_t m_Size;
+  bool m_UseBLX;
 };
 
 } // namespace of mcld
@@ -33,8 +33,9 @@ const uint32_t THMToARMStub::TEMPLATE[] = {
   0x0         // dcd   R_ARM_ABS32(X)
 };
 
-THMToARMStub::THMToARMStub(bool pIsOutputPIC)
- : Stub(), m_Name("T2A_prototype"), m_pData(NULL), m_Size(0x0)
+THMToARMStub::THMToARMStub(bool pIsOutputPIC, bool pUseBLX)
+ : Stub(), m_Name("T2A_prototype"), m_pData(NULL), m_Size(0x0),
+   m_UseBLX(pUseBLX)
 {
   if (pIsOutputPIC) {
     m_pData = PIC_TEMPLATE;
@@ -51,9 +52,11 @@ THMToARMStub::THMToARMStub(bool pIsOutputPIC)
 /// for doClone
 THMToARMStub::THMToARMStub(const uint32_t* pData,
                            size_t pSize,
+                           bool pUseBLX,
                            const_fixup_iterator pBegin,
                            const_fixup_iterator pEnd)
- : Stub(), m_Name("T2A_veneer"), m_pData(pData), m_Size(pSize)
+ : Stub(), m_Name("T2A_veneer"), m_pData(pData), m_Size(pSize),
+   m_UseBLX(pUseBLX)
 {
   for (const_fixup_iterator it = pBegin, ie = pEnd; it != ie; ++it)
     addFixup(**it);
@@ -72,8 +75,12 @@ bool THMToARMStub::isMyDuty(const class Relocation& pReloc,
   if ((pTargetSymValue & 0x1) == 0x0) {
     switch (pReloc.type()) {
       case llvm::ELF::R_ARM_THM_CALL: {
-        // FIXME: Assuming blx is available (i.e., target is armv5 or above!)
-        // then, we do not need a stub unless the branch target is too far.
+        // without BLX, a stub is needed to switch mode
+        if (!m_UseBLX) {
+          result = true;
+          break;
+        }
+        // with BLX, we do not need a stub unless the branch target is too far.
         uint64_t dest = pTargetSymValue + pReloc.addend() + 4u;
         int64_t branch_offset = static_cast<int64_t>(dest) - pSource;
         if ((branch_offset > ARMGNULDBackend::THM_MAX_FWD_BRANCH_OFFSET) ||
@@ -121,6 +128,7 @@ uint64_t THMToARMStub::initSymValue() const
 
 Stub* THMToARMStub::doClone()
 {
-  return new THMToARMStub(m_pData, m_Size, fixup_begin(), fixup_end());
+  return new THMToARMStub(m_pData, m_Size, m_UseBLX,
+                          fixup_begin(), fixup_end());
 }
 
@@ -31,7 +31,8 @@ class ResolveInfo;
 class THMToARMStub : public Stub
 {
 public:
-  THMToARMStub(bool pIsOutputPIC);
+  /// @param pUseBLX - can the calls switch the mode by BLX without a stub?
+  THMToARMStub(bool pIsOutputPIC, bool pUseBLX);
 
   ~THMToARMStub();
 
@@ -60,6 +61,7 @@ private:
   /// for doClone
   THMToARMStub(const uint32_t* pData,
                size_t pSize,
+               bool pUseBLX,
                const_fixup_iterator pBegin,
                const_fixup_iterator pEnd);
 
@@ -72,6 +74,7 @@ private:
   static const uint32_t TEMPLATE[];
   const uint32_t* m_pData;
   size_t m_Size;
+  bool m_UseBLX;
 };
 
 } // namespace of mcld
@@ -8,6 +8,7 @@ mcld_target_SRC_FILES := \
   GNULDBackend.cpp  \
   GOT.cpp \
   OutputRelocSection.cpp  \
+  OutputRelrSection.cpp  \
   PLT.cpp \
   Target.cpp  \
   TargetLDBackend.cpp
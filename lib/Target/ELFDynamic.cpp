@@ -128,6 +128,13 @@ void ELFDynamic::reserveEntries(const ELFFileFormat& pFormat)
   if (pFormat.hasGNUHashTab())
     reserveOne(0x6ffffef5); // DT_GNU_HASH
 
+  // FIXME: use llvm enum constant
+  if (pFormat.hasSymInfo()) {
+    reserveOne(0x6ffffeff); // DT_SYMINFO
+    reserveOne(0x6ffffdf3); // DT_SYMINSZ
+    reserveOne(0x6ffffdf4); // DT_SYMINENT
+  }
+
   if (pFormat.hasDynSymTab()) {
     reserveOne(llvm::ELF::DT_SYMTAB); // DT_SYMTAB
     reserveOne(llvm::ELF::DT_SYMENT); // DT_SYMENT
@@ -152,14 +159,41 @@ void ELFDynamic::reserveEntries(const ELFFileFormat& pFormat)
     reserveOne(llvm::ELF::DT_REL); // DT_REL
     reserveOne(llvm::ELF::DT_RELSZ); // DT_RELSZ
     reserveOne(llvm::ELF::DT_RELENT); // DT_RELENT
+
+    // FIXME: use llvm enum constant
+    if (m_Backend.isCombReloc())
+      reserveOne(0x6ffffffa); // DT_RELCOUNT
   }
 
   if (pFormat.hasRelaDyn()) {
     reserveOne(llvm::ELF::DT_RELA); // DT_RELA
     reserveOne(llvm::ELF::DT_RELASZ); // DT_RELASZ
     reserveOne(llvm::ELF::DT_RELAENT); // DT_RELAENT
+
+    // FIXME: use llvm enum constant
+    if (m_Backend.isCombReloc())
+      reserveOne(0x6ffffff9); // DT_RELACOUNT
   }
 
+  if (m_Backend.hasRelrDyn()) {
+    // FIXME: use llvm enum constant
+    if (GeneralOptions::PackDynRelocs_Android ==
+        m_Config.options().getPackDynRelocs()) {
+      reserveOne(0x6fffe000); // DT_ANDROID_RELR
+      reserveOne(0x6fffe001); // DT_ANDROID_RELRSZ
+      reserveOne(0x6fffe003); // DT_ANDROID_RELRENT
+    }
+    else {
+      reserveOne(36); // DT_RELR
+      reserveOne(35); // DT_RELRSZ
+      reserveOne(37); // DT_RELRENT
+    }
+  }
+
+  // FIXME: use llvm enum constant
+  if (m_Backend.isPrelinked())
+    reserveOne(0x6ffffdf5); // DT_GNU_PRELINKED
+
   uint64_t dt_flags = 0x0;
   if (m_Config.options().hasOrigin())
     dt_flags |= llvm::ELF::DF_ORIGIN;
@@ -234,6 +268,13 @@ void ELFDynamic::applyEntries(const ELFFileFormat& pFormat)
   if (pFormat.hasGNUHashTab())
     applyOne(0x6ffffef5, pFormat.getGNUHashTab().addr()); // DT_GNU_HASH
 
+  // FIXME: use llvm enum constant
+  if (pFormat.hasSymInfo()) {
+    applyOne(0x6ffffeff, pFormat.getSymInfo().addr()); // DT_SYMINFO
+    applyOne(0x6ffffdf3, pFormat.getSymInfo().size()); // DT_SYMINSZ
+    applyOne(0x6ffffdf4, 4); // DT_SYMINENT
+  }
+
   if (pFormat.hasDynSymTab()) {
     applyOne(llvm::ELF::DT_SYMTAB, pFormat.getDynSymTab().addr()); // DT_SYMTAB
     applyOne(llvm::ELF::DT_SYMENT, symbolSize()); // DT_SYMENT
@@ -261,14 +302,45 @@ void ELFDynamic::applyEntries(const ELFFileFormat& pFormat)
     applyOne(llvm::ELF::DT_REL, pFormat.getRelDyn().addr()); // DT_REL
     applyOne(llvm::ELF::DT_RELSZ, pFormat.getRelDyn().size()); // DT_RELSZ
     applyOne(llvm::ELF::DT_RELENT, m_pEntryFactory->relSize()); // DT_RELENT
+
+    // FIXME: use llvm enum constant
+    if (m_Backend.isCombReloc())
+      applyOne(0x6ffffffa, m_Backend.numOfRelativeRelocs()); // DT_RELCOUNT
   }
 
   if (pFormat.hasRelaDyn()) {
     applyOne(llvm::ELF::DT_RELA, pFormat.getRelaDyn().addr()); // DT_RELA
     applyOne(llvm::ELF::DT_RELASZ, pFormat.getRelaDyn().size()); // DT_RELASZ
     applyOne(llvm::ELF::DT_RELAENT, m_pEntryFactory->relaSize()); // DT_RELAENT
+
+    // FIXME: use llvm enum constant
+    if (m_Backend.isCombReloc())
+      applyOne(0x6ffffff9, m_Backend.numOfRelativeRelocs()); // DT_RELACOUNT
+  }
+
+  if (m_Backend.hasRelrDyn()) {
+    const OutputRelrSection& relr = m_Backend.getRelrDyn();
+    uint64_t relr_size = relr.numOfEntries() * relr.getEntrySize();
+
+    // FIXME: use llvm enum constant
+    if (GeneralOptions::PackDynRelocs_Android ==
+        m_Config.options().getPackDynRelocs()) {
+      applyOne(0x6fffe000, pFormat.getRelrDyn().addr()); // DT_ANDROID_RELR
+      applyOne(0x6fffe001, relr_size); // DT_ANDROID_RELRSZ
+      applyOne(0x6fffe003, relr.getEntrySize()); // DT_ANDROID_RELRENT
+    }
+    else {
+      applyOne(36, pFormat.getRelrDyn().addr()); // DT_RELR
+      applyOne(35, relr_size); // DT_RELRSZ
+      applyOne(37, relr.getEntrySize()); // DT_RELRENT
+    }
   }
 
+  // the time stamp of the prelinking is zero, so the output stays the same
+  // for the same inputs
+  if (m_Backend.isPrelinked())
+    applyOne(0x6ffffdf5, 0x0); // DT_GNU_PRELINKED
+
   if (m_Backend.hasTextRel()) {
     applyOne(llvm::ELF::DT_TEXTREL, 0x0); // DT_TEXTREL
 
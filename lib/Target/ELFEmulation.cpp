@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/Target/ELFEmulation.h>
 #include <mcld/LinkerConfig.h>
+#include <mcld/Object/SectionMap.h>
 
 #include <llvm/Support/Host.h>
 
@@ -61,10 +62,39 @@ static const NameMap map[] =
   {".gnu.linkonce.l", ".ldata"},
 };
 
+struct GroupMap {
+  const char* from;         ///< the input string. (match FROM and FROM.*)
+  const char* to;           ///< the output string.
+  SectionMap::Group group;  ///< the group in the output section
+};
+
+/// The sub-sections of .text emitted by the compilers for the hot/cold code
+/// splitting. They must be appended before {".text", ".text"}, which matches
+/// them too.
+static const GroupMap group_map[] =
+{
+  {".text.hot", ".text", SectionMap::Hot},
+  {".text.startup", ".text", SectionMap::Startup},
+  {".text.exit", ".text", SectionMap::Exit},
+  {".text.unlikely", ".text", SectionMap::Unlikely},
+};
+
 bool mcld::MCLDEmulateELF(LinkerConfig& pConfig)
 {
   // set up section map
   if (pConfig.codeGenType() != LinkerConfig::Object) {
+    const unsigned int group_map_size =
+      (sizeof(group_map) / sizeof(group_map[0]));
+    for (unsigned int i = 0; i < group_map_size; ++i) {
+      bool exist = false;
+      pConfig.scripts().sectionMap().append(group_map[i].from,
+                                            group_map[i].to,
+                                            group_map[i].group,
+                                            exist);
+      if (exist)
+        return false;
+    }
+
     const unsigned int map_size =  (sizeof(map) / sizeof(map[0]) );
     for (unsigned int i = 0; i < map_size; ++i) {
       bool exist = false;
@@ -22,17 +22,30 @@
 #include <mcld/Config/Config.h>
 #include <mcld/ADT/SizeTraits.h>
 #include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/CommonBuckets.h>
+#include <mcld/LD/DiagnosticLineInfo.h>
 #include <mcld/LD/LDContext.h>
 #include <mcld/Fragment/FillFragment.h>
+#include <mcld/Fragment/Relocation.h>
 #include <mcld/LD/EhFrame.h>
 #include <mcld/LD/EhFrameHdr.h>
+#include <mcld/LD/GdbIndex.h>
+#include <mcld/LD/PrelinkMap.h>
 #include <mcld/LD/RelocData.h>
 #include <mcld/LD/RelocationFactory.h>
+#include <mcld/LD/RelocationStreamer.h>
+#include <mcld/LD/SeparateDebugFile.h>
 #include <mcld/MC/Attribute.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/LinkStats.h>
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/MemoryAreaFactory.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/SystemUtils.h>
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/Support/TimeReport.h>
 #include <mcld/LD/BranchIslandFactory.h>
 #include <mcld/LD/StubFactory.h>
 #include <mcld/Object/ObjectBuilder.h>
@@ -53,12 +66,40 @@ static bool isCIdentifier(const std::string& pName)
   return (pName.find_first_not_of(ident) > pName.length());
 }
 
+/// getBuildIDSize - return the size of the build ID in .note.gnu.build-id
+static size_t getBuildIDSize(const GeneralOptions& pOptions)
+{
+  switch (pOptions.getBuildID()) {
+    case GeneralOptions::BuildID_Fast:
+      return digest::size(digest::Fast);
+    case GeneralOptions::BuildID_MD5:
+    case GeneralOptions::BuildID_UUID:
+      return digest::size(digest::MD5);
+    case GeneralOptions::BuildID_SHA1:
+      return digest::size(digest::SHA1);
+    case GeneralOptions::BuildID_Hex:
+      return pOptions.getBuildIDValue().size();
+    default:
+      return 0;
+  }
+}
+
+/// writeNoteWord - write a 32-bit field of a note in the target byte order
+static void writeNoteWord(uint8_t* pPlace, uint32_t pValue, bool pIsLittle)
+{
+  for (unsigned int i = 0; i < 4; ++i) {
+    unsigned int shift = pIsLittle ? (i * 8) : (24 - i * 8);
+    pPlace[i] = (pValue >> shift) & 0xff;
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // GNULDBackend
 //===----------------------------------------------------------------------===//
 GNULDBackend::GNULDBackend(const LinkerConfig& pConfig, GNUInfo* pInfo)
   : TargetLDBackend(pConfig),
     m_pObjectReader(NULL),
+    m_pDynObjReader(NULL),
     m_pDynObjFileFormat(NULL),
     m_pExecFileFormat(NULL),
     m_pObjectFileFormat(NULL),
@@ -67,8 +108,19 @@ GNULDBackend::GNULDBackend(const LinkerConfig& pConfig, GNUInfo* pInfo)
     m_pBRIslandFactory(NULL),
     m_pStubFactory(NULL),
     m_pEhFrameHdr(NULL),
+    m_pGdbIndex(NULL),
+    m_pSeparateDebugFile(NULL),
+    m_pRelrDyn(NULL),
+    m_pRelocStreamer(NULL),
+    m_GNUHashMaskbitslog2(0),
+    m_GNUHashShift2(0),
     m_bHasTextRel(false),
     m_bHasStaticTLS(false),
+    m_NumOfRelativeRelocs(0),
+    m_PrelinkBase(0x0),
+    m_bPrelinked(false),
+    m_NumOfMainSections(0),
+    m_MainFileSize(0),
     f_pPreInitArrayStart(NULL),
     f_pPreInitArrayEnd(NULL),
     f_pInitArrayStart(NULL),
@@ -99,8 +151,72 @@ GNULDBackend::~GNULDBackend()
   delete m_pObjectFileFormat;
   delete m_pSymIndexMap;
   delete m_pEhFrameHdr;
+  delete m_pGdbIndex;
+  delete m_pSeparateDebugFile;
+  delete m_pRelrDyn;
+  delete m_pRelocStreamer;
+  delete m_pBRIslandFactory;
+  delete m_pStubFactory;
+}
+
+void GNULDBackend::reset()
+{
+  // the readers are owned by the ObjectLinker
+  m_pObjectReader = NULL;
+  m_pDynObjReader = NULL;
+
+  m_ELFSegmentTable.clear();
+
   delete m_pBRIslandFactory;
+  m_pBRIslandFactory = NULL;
   delete m_pStubFactory;
+  m_pStubFactory = NULL;
+  delete m_pEhFrameHdr;
+  m_pEhFrameHdr = NULL;
+  delete m_pGdbIndex;
+  m_pGdbIndex = NULL;
+  delete m_pSeparateDebugFile;
+  m_pSeparateDebugFile = NULL;
+  delete m_pRelrDyn;
+  m_pRelrDyn = NULL;
+  delete m_pRelocStreamer;
+  m_pRelocStreamer = NULL;
+
+  m_pSymIndexMap->clear();
+  m_StrTabNames.clear();
+  m_DynStrTabNames.clear();
+  m_ShStrTabNames.clear();
+  m_GNUHashes.clear();
+  m_GNUHashMaskbitslog2 = 0;
+  m_GNUHashShift2 = 0;
+
+  m_bHasTextRel = false;
+  m_bHasStaticTLS = false;
+  m_NumOfRelativeRelocs = 0;
+  m_PrelinkBase = 0x0;
+  m_bPrelinked = false;
+  m_NumOfMainSections = 0;
+  m_MainFileSize = 0;
+
+  f_pPreInitArrayStart = NULL;
+  f_pPreInitArrayEnd = NULL;
+  f_pInitArrayStart = NULL;
+  f_pInitArrayEnd = NULL;
+  f_pFiniArrayStart = NULL;
+  f_pFiniArrayEnd = NULL;
+  f_pStack = NULL;
+  f_pDynamic = NULL;
+  f_pTDATA = NULL;
+  f_pTBSS = NULL;
+  f_pExecutableStart = NULL;
+  f_pEText = NULL;
+  f_p_EText = NULL;
+  f_p__EText = NULL;
+  f_pEData = NULL;
+  f_p_EData = NULL;
+  f_pBSSStart = NULL;
+  f_pEnd = NULL;
+  f_p_End = NULL;
 }
 
 size_t GNULDBackend::sectionStartOffset() const
@@ -128,6 +244,8 @@ uint64_t GNULDBackend::segmentStartAddr() const
     config().scripts().addressMap().find(".text");
   if (mapping != config().scripts().addressMap().end())
     return mapping.getEntry()->value();
+  else if (m_bPrelinked)
+    return m_PrelinkBase;
   else if (config().isCodeIndep())
     return 0x0;
   else
@@ -138,7 +256,8 @@ GNUArchiveReader*
 GNULDBackend::createArchiveReader(Module& pModule)
 {
   assert(NULL != m_pObjectReader);
-  return new GNUArchiveReader(pModule, *m_pObjectReader);
+  return new GNUArchiveReader(pModule, *m_pObjectReader, config(),
+                              m_pDynObjReader);
 }
 
 ELFObjectReader* GNULDBackend::createObjectReader(IRBuilder& pBuilder)
@@ -149,7 +268,8 @@ ELFObjectReader* GNULDBackend::createObjectReader(IRBuilder& pBuilder)
 
 ELFDynObjReader* GNULDBackend::createDynObjReader(IRBuilder& pBuilder)
 {
-  return new ELFDynObjReader(*this, pBuilder, config());
+  m_pDynObjReader = new ELFDynObjReader(*this, pBuilder, config());
+  return m_pDynObjReader;
 }
 
 ELFBinaryReader* GNULDBackend::createBinaryReader(IRBuilder& pBuilder)
@@ -170,6 +290,7 @@ bool GNULDBackend::initStdSections(ObjectBuilder& pBuilder)
         m_pDynObjFileFormat = new ELFDynObjFileFormat();
       m_pDynObjFileFormat->initStdSections(pBuilder,
                                            config().targets().bitclass());
+      initRelrDyn(m_pDynObjFileFormat->getRelrDyn());
       return true;
     }
     case LinkerConfig::Exec:
@@ -178,6 +299,7 @@ bool GNULDBackend::initStdSections(ObjectBuilder& pBuilder)
         m_pExecFileFormat = new ELFExecFileFormat();
       m_pExecFileFormat->initStdSections(pBuilder,
                                          config().targets().bitclass());
+      initRelrDyn(m_pExecFileFormat->getRelrDyn());
       return true;
     }
     case LinkerConfig::Object: {
@@ -193,6 +315,47 @@ bool GNULDBackend::initStdSections(ObjectBuilder& pBuilder)
   }
 }
 
+/// initRelrDyn - initialize .relr.dyn if --pack-dyn-relocs is given
+void GNULDBackend::initRelrDyn(LDSection& pSection)
+{
+  if (NULL != m_pRelrDyn || config().isCodeStatic())
+    return;
+
+  switch (config().options().getPackDynRelocs()) {
+    case GeneralOptions::PackDynRelocs_Relr:
+      break;
+    case GeneralOptions::PackDynRelocs_Android:
+      // FIXME: use llvm enum constant
+      pSection.setType(0x6fffff00); // SHT_ANDROID_RELR
+      break;
+    case GeneralOptions::PackDynRelocs_None:
+    default:
+      return;
+  }
+  m_pRelrDyn = new OutputRelrSection(pSection,
+                                     config().targets().bitclass() / 8);
+}
+
+bool GNULDBackend::reserveRelrEntry(const Relocation& pReloc)
+{
+  if (NULL == m_pRelrDyn)
+    return false;
+  return m_pRelrDyn->reserveEntry(pReloc);
+}
+
+void GNULDBackend::emitRelrDyn(MemoryRegion& pRegion) const
+{
+  assert(NULL != m_pRelrDyn && ".relr.dyn section not exist");
+  m_pRelrDyn->emit(pRegion);
+}
+
+RelocationStreamer& GNULDBackend::getRelocStreamer()
+{
+  if (NULL == m_pRelocStreamer)
+    m_pRelocStreamer = new RelocationStreamer(config(), *this);
+  return *m_pRelocStreamer;
+}
+
 /// initStandardSymbols - define and initialize standard symbols.
 /// This function is called after section merging but before read relocations.
 bool GNULDBackend::initStandardSymbols(IRBuilder& pBuilder,
@@ -745,11 +908,15 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
   size_t symtab = 1;
   size_t dynsym = pIsStaticLink ? 0 : 1;
 
-  // size of string tables starts from 1 to hold the null character in their
-  // first byte
-  size_t strtab   = 1;
-  size_t dynstr   = pIsStaticLink ? 0 : 1;
-  size_t shstrtab = 1;
+  // the string tables are merged by their tails, so their sizes are known
+  // after all strings are added
+  StringTable& strtab   = getStrTabNames();
+  StringTable& dynstr   = getDynStrTabNames();
+  StringTable& shstrtab = getShStrTabNames();
+  strtab.clear();
+  dynstr.clear();
+  shstrtab.clear();
+
   size_t hash     = 0;
   size_t gnuhash  = 0;
 
@@ -764,8 +931,8 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
   symEnd = symbols.end();
   for (symbol = symbols.begin(); symbol != symEnd; ++symbol) {
     ++symtab;
-    if (ResolveInfo::Section != (*symbol)->type())
-      strtab += (*symbol)->nameSize() + 1;
+    if (hasSymbolName(**symbol))
+      strtab.add(llvm::StringRef((*symbol)->name(), (*symbol)->nameSize()));
   }
   symtab_local_cnt = 1 + symbols.numOfFiles() + symbols.numOfLocals() +
                      symbols.numOfLocalDyns();
@@ -775,38 +942,46 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
   switch(config().codeGenType()) {
     case LinkerConfig::DynObj: {
       // soname
-      dynstr += pModule.name().size() + 1;
+      dynstr.add(pModule.name());
     }
     /** fall through **/
     case LinkerConfig::Exec:
     case LinkerConfig::Binary: {
       if (!pIsStaticLink) {
         /// Compute the size of .dynsym, .dynstr, and dynsym_local_cnt
+        size_t ordered_cnt = 0;
         symEnd = symbols.dynamicEnd();
         for (symbol = symbols.localDynBegin(); symbol != symEnd; ++symbol) {
           ++dynsym;
-          if (ResolveInfo::Section != (*symbol)->type())
-            dynstr += (*symbol)->nameSize() + 1;
+          if (hasSymbolName(**symbol))
+            dynstr.add(llvm::StringRef((*symbol)->name(),
+                                       (*symbol)->nameSize()));
+          if (0 != getDynsymOrder(**symbol))
+            ++ordered_cnt;
         }
         dynsym_local_cnt = 1 + symbols.numOfLocalDyns();
 
+        // .gnu.hash sorts the hashed symbols by their buckets, which breaks
+        // the order required by the target
+        bool gnu_style =
+          GeneralOptions::GNU  == config().options().getHashStyle() ||
+          GeneralOptions::Both == config().options().getHashStyle();
+        if (gnu_style && 0 != ordered_cnt) {
+          warning(diag::warn_gnu_hash_with_ordered_dynsym) << ordered_cnt;
+          gnu_style = false;
+        }
+
         // compute .gnu.hash
-        if (GeneralOptions::GNU  == config().options().getHashStyle() ||
-            GeneralOptions::Both == config().options().getHashStyle()) {
-          // count the number of dynsym to hash
-          size_t hashed_sym_cnt = 0;
-          symEnd = symbols.dynamicEnd();
-          for (symbol = symbols.dynamicBegin(); symbol != symEnd; ++symbol) {
-            if (DynsymCompare().needGNUHash(**symbol))
-              ++hashed_sym_cnt;
-          }
+        if (gnu_style) {
+          // hash the dynsyms once, and choose the bloom filter by the hashes
+          size_t hashed_sym_cnt = hashDynsyms(symbols);
           // Special case for empty .dynsym
           if (hashed_sym_cnt == 0)
             gnuhash = 5 * 4 + config().targets().bitclass() / 8;
           else {
             size_t nbucket = getHashBucketCount(hashed_sym_cnt, true);
             gnuhash = (4 + nbucket + hashed_sym_cnt) * 4;
-            gnuhash += (1U << getGNUHashMaskbitslog2(hashed_sym_cnt)) / 8;
+            gnuhash += (1U << m_GNUHashMaskbitslog2) / 8;
           }
         }
 
@@ -822,7 +997,7 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
         Module::const_lib_iterator lib, libEnd = pModule.lib_end();
         for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
           if (!(*lib)->attribute()->isAsNeeded() || (*lib)->isNeeded()) {
-            dynstr += (*lib)->name().size() + 1;
+            dynstr.add((*lib)->name());
             dynamic().reserveNeedEntry();
           }
         }
@@ -830,13 +1005,11 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
         // add DT_RPATH
         if (!config().options().getRpathList().empty()) {
           dynamic().reserveNeedEntry();
-          GeneralOptions::const_rpath_iterator rpath,
-            rpathEnd = config().options().rpath_end();
-          for (rpath = config().options().rpath_begin();
-               rpath != rpathEnd; ++rpath)
-            dynstr += (*rpath).size() + 1;
+          dynstr.add(getRpathString());
         }
 
+        dynstr.finalize(config().threads());
+
         // set size
         if (config().targets().is32Bits()) {
           file_format->getDynSymTab().setSize(dynsym *
@@ -845,10 +1018,15 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
           file_format->getDynSymTab().setSize(dynsym *
                                               sizeof(llvm::ELF::Elf64_Sym));
         }
-        file_format->getDynStrTab().setSize(dynstr);
+        file_format->getDynStrTab().setSize(dynstr.size());
         file_format->getHashTab().setSize(hash);
         file_format->getGNUHashTab().setSize(gnuhash);
 
+        // -z direct gives every .dynsym entry an Elf32_Syminfo or
+        // Elf64_Syminfo, both of which are two half words
+        if (config().options().hasDirect())
+          file_format->getSymInfo().setSize(dynsym * 4);
+
         // set .dynsym sh_info to one greater than the symbol table
         // index of the last local symbol
         file_format->getDynSymTab().setInfo(dynsym_local_cnt);
@@ -866,7 +1044,8 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
         file_format->getSymTab().setSize(symtab*sizeof(llvm::ELF::Elf32_Sym));
       else
         file_format->getSymTab().setSize(symtab*sizeof(llvm::ELF::Elf64_Sym));
-      file_format->getStrTab().setSize(strtab);
+      strtab.finalize(config().threads());
+      file_format->getStrTab().setSize(strtab.size());
 
       // set .symtab sh_info to one greater than the symbol table
       // index of the last local symbol
@@ -880,30 +1059,31 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
           break;
         // take StackNote directly
         case LDFileFormat::StackNote:
-          shstrtab += ((*sect)->name().size() + 1);
+          shstrtab.add((*sect)->name());
           break;
         case LDFileFormat::EhFrame:
           if (((*sect)->size() != 0) ||
               ((*sect)->hasEhFrame() &&
                config().codeGenType() == LinkerConfig::Object))
-            shstrtab += ((*sect)->name().size() + 1);
+            shstrtab.add((*sect)->name());
           break;
         case LDFileFormat::Relocation:
           if (((*sect)->size() != 0) ||
               ((*sect)->hasRelocData() &&
                config().codeGenType() == LinkerConfig::Object))
-            shstrtab += ((*sect)->name().size() + 1);
+            shstrtab.add((*sect)->name());
           break;
         default:
           if (((*sect)->size() != 0) ||
               ((*sect)->hasSectionData() &&
                config().codeGenType() == LinkerConfig::Object))
-            shstrtab += ((*sect)->name().size() + 1);
+            shstrtab.add((*sect)->name());
           break;
         } // end of switch
       } // end of for
-      shstrtab += (strlen(".shstrtab") + 1);
-      file_format->getShStrTab().setSize(shstrtab);
+      shstrtab.add(".shstrtab");
+      shstrtab.finalize(config().threads());
+      file_format->getShStrTab().setSize(shstrtab.size());
       break;
     }
     default:
@@ -915,15 +1095,14 @@ void GNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
 /// emitSymbol32 - emit an ELF32 symbol
 void GNULDBackend::emitSymbol32(llvm::ELF::Elf32_Sym& pSym,
                                 LDSymbol& pSymbol,
-                                char* pStrtab,
-                                size_t pStrtabsize,
+                                const StringTable& pStrtab,
                                 size_t pSymtabIdx)
 {
    // FIXME: check the endian between host and target
    // write out symbol
-   if (ResolveInfo::Section != pSymbol.type()) {
-     pSym.st_name  = pStrtabsize;
-     strcpy((pStrtab + pStrtabsize), pSymbol.name());
+   if (hasSymbolName(pSymbol)) {
+     pSym.st_name  = pStrtab.getOffset(llvm::StringRef(pSymbol.name(),
+                                                       pSymbol.nameSize()));
    }
    else {
      pSym.st_name  = 0;
@@ -938,20 +1117,18 @@ void GNULDBackend::emitSymbol32(llvm::ELF::Elf32_Sym& pSym,
 /// emitSymbol64 - emit an ELF64 symbol
 void GNULDBackend::emitSymbol64(llvm::ELF::Elf64_Sym& pSym,
                                 LDSymbol& pSymbol,
-                                char* pStrtab,
-                                size_t pStrtabsize,
+                                const StringTable& pStrtab,
                                 size_t pSymtabIdx)
 {
    // FIXME: check the endian between host and target
    // write out symbol
-   if (ResolveInfo::Section != pSymbol.type()) {
-     pSym.st_name  = pStrtabsize;
-     strcpy((pStrtab + pStrtabsize), pSymbol.name());
+   if (hasSymbolName(pSymbol)) {
+     pSym.st_name  = pStrtab.getOffset(llvm::StringRef(pSymbol.name(),
+                                                       pSymbol.nameSize()));
    }
    else {
      pSym.st_name  = 0;
    }
-   pSym.st_name  = pStrtabsize;
    pSym.st_value = pSymbol.value();
    pSym.st_size  = getSymbolSize(pSymbol);
    pSym.st_info  = getSymbolInfo(pSymbol);
@@ -959,6 +1136,40 @@ void GNULDBackend::emitSymbol64(llvm::ELF::Elf64_Sym& pSym,
    pSym.st_shndx = getSymbolShndx(pSymbol);
 }
 
+/// getRpathString - the -rpath list joined by colons
+std::string GNULDBackend::getRpathString() const
+{
+  std::string result;
+  GeneralOptions::const_rpath_iterator rpath,
+    rpathEnd = config().options().rpath_end();
+  for (rpath = config().options().rpath_begin(); rpath != rpathEnd; ++rpath) {
+    if (config().options().rpath_begin() != rpath)
+      result.append(":");
+    result.append(*rpath);
+  }
+  return result;
+}
+
+/// SymtabEmitter - the body of parallel_for to emit the i-th .symtab entry.
+/// The entries and the name offsets are independent of each other.
+struct GNULDBackend::SymtabEmitter
+{
+  GNULDBackend* backend;
+  const Module::SymbolTable* symbols;
+  const StringTable* strtab;
+  llvm::ELF::Elf32_Sym* symtab32;
+  llvm::ELF::Elf64_Sym* symtab64;
+
+  void operator()(size_t pIdx) {
+    // the entry 0 is the null symbol
+    LDSymbol& symbol = *symbols->begin()[pIdx];
+    if (NULL != symtab32)
+      backend->emitSymbol32(symtab32[pIdx + 1], symbol, *strtab, pIdx + 1);
+    else
+      backend->emitSymbol64(symtab64[pIdx + 1], symbol, *strtab, pIdx + 1);
+  }
+};
+
 /// emitRegNamePools - emit regular name pools - .symtab, .strtab
 ///
 /// the size of these tables should be computed before layout
@@ -988,42 +1199,37 @@ void GNULDBackend::emitRegNamePools(const Module& pModule,
                                       << config().targets().bitclass();
   }
 
-  // set up strtab_region
-  char* strtab = (char*)strtab_region->start();
+  // set up strtab_region. The offsets of the names are assigned when the
+  // table is finalized, so the names and the symbols are emitted apart.
+  const StringTable& strtab = getStrTabNames();
+  strtab.emit((char*)strtab_region->start(), config().threads());
 
   // emit the first ELF symbol
   if (config().targets().is32Bits())
-    emitSymbol32(symtab32[0], *LDSymbol::Null(), strtab, 0, 0);
+    emitSymbol32(symtab32[0], *LDSymbol::Null(), strtab, 0);
   else
-    emitSymbol64(symtab64[0], *LDSymbol::Null(), strtab, 0, 0);
+    emitSymbol64(symtab64[0], *LDSymbol::Null(), strtab, 0);
 
-  bool sym_exist = false;
-  HashTableType::entry_type* entry = NULL;
+  const Module::SymbolTable& symbols = pModule.getSymbolTable();
+
+  // the indexes of the symbols for the relocations of a partial link
   if (LinkerConfig::Object == config().codeGenType()) {
-    entry = m_pSymIndexMap->insert(LDSymbol::Null(), sym_exist);
+    bool sym_exist = false;
+    HashTableType::entry_type* entry =
+                              m_pSymIndexMap->insert(LDSymbol::Null(), sym_exist);
     entry->setValue(0);
-  }
 
-  size_t symIdx = 1;
-  size_t strtabsize = 1;
-
-  const Module::SymbolTable& symbols = pModule.getSymbolTable();
-  Module::const_sym_iterator symbol, symEnd;
-
-  symEnd = symbols.end();
-  for (symbol = symbols.begin(); symbol != symEnd; ++symbol) {
-    if (LinkerConfig::Object == config().codeGenType()) {
+    size_t symIdx = 1;
+    Module::const_sym_iterator symbol, symEnd = symbols.end();
+    for (symbol = symbols.begin(); symbol != symEnd; ++symbol) {
       entry = m_pSymIndexMap->insert(*symbol, sym_exist);
       entry->setValue(symIdx);
+      ++symIdx;
     }
-    if (config().targets().is32Bits())
-      emitSymbol32(symtab32[symIdx], **symbol, strtab, strtabsize, symIdx);
-    else
-      emitSymbol64(symtab64[symIdx], **symbol, strtab, strtabsize, symIdx);
-    ++symIdx;
-    if (ResolveInfo::Section != (*symbol)->type())
-      strtabsize += (*symbol)->nameSize() + 1;
   }
+
+  SymtabEmitter emitter = { this, &symbols, &strtab, symtab32, symtab64 };
+  parallel_for(config().threads(), 0, symbols.numOfSymbols(), emitter, 1024);
 }
 
 /// emitDynNamePools - emit dynamic name pools - .dyntab, .dynstr, .hash
@@ -1064,26 +1270,28 @@ void GNULDBackend::emitDynNamePools(Module& pModule, MemoryArea& pOutput)
   }
 
   // set up strtab_region
-  char* strtab = (char*)strtab_region->start();
+  const StringTable& strtab = getDynStrTabNames();
+  strtab.emit((char*)strtab_region->start());
 
   // emit the first ELF symbol
   if (config().targets().is32Bits())
-    emitSymbol32(symtab32[0], *LDSymbol::Null(), strtab, 0, 0);
+    emitSymbol32(symtab32[0], *LDSymbol::Null(), strtab, 0);
   else
-    emitSymbol64(symtab64[0], *LDSymbol::Null(), strtab, 0, 0);
+    emitSymbol64(symtab64[0], *LDSymbol::Null(), strtab, 0);
 
   size_t symIdx = 1;
-  size_t strtabsize = 1;
 
   Module::SymbolTable& symbols = pModule.getSymbolTable();
-  // emit .gnu.hash
-  if (GeneralOptions::GNU  == config().options().getHashStyle() ||
-      GeneralOptions::Both == config().options().getHashStyle()) {
+  // put the symbols ordered by the target at the end of .dynsym
+  orderDynsyms(symbols);
+
+  // emit .gnu.hash. It is not created if the target orders the dynsyms.
+  if (file_format->hasGNUHashTab()) {
     // Currently we may add output symbols after sizeNamePools(), and a
     // non-stable sort is used in SymbolCategory::arrange(), so we just
-    // sort .dynsym right before emitting .gnu.hash
-    std::stable_sort(symbols.dynamicBegin(), symbols.dynamicEnd(),
-                     DynsymCompare());
+    // partition .dynsym right before emitting .gnu.hash
+    std::stable_partition(symbols.dynamicBegin(), symbols.dynamicEnd(),
+                          DynsymIsUnhashed());
     emitGNUHashTab(symbols, pOutput);
   }
   // emit .hash
@@ -1095,60 +1303,72 @@ void GNULDBackend::emitDynNamePools(Module& pModule, MemoryArea& pOutput)
   Module::const_sym_iterator symbol, symEnd = symbols.dynamicEnd();
   for (symbol = symbols.localDynBegin(); symbol != symEnd; ++symbol) {
     if (config().targets().is32Bits())
-      emitSymbol32(symtab32[symIdx], **symbol, strtab, strtabsize, symIdx);
+      emitSymbol32(symtab32[symIdx], **symbol, strtab, symIdx);
     else
-      emitSymbol64(symtab64[symIdx], **symbol, strtab, strtabsize, symIdx);
+      emitSymbol64(symtab64[symIdx], **symbol, strtab, symIdx);
     // maintain output's symbol and index map
     entry = m_pSymIndexMap->insert(*symbol, sym_exist);
     entry->setValue(symIdx);
     // sum up counters
     ++symIdx;
-    if (ResolveInfo::Section != (*symbol)->type())
-      strtabsize += (*symbol)->nameSize() + 1;
   }
 
   // emit DT_NEED
-  // add DT_NEED strings into .dynstr
   ELFDynamic::iterator dt_need = dynamic().needBegin();
   Module::const_lib_iterator lib, libEnd = pModule.lib_end();
   for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
     if (!(*lib)->attribute()->isAsNeeded() || (*lib)->isNeeded()) {
-      strcpy((strtab + strtabsize), (*lib)->name().c_str());
-      (*dt_need)->setValue(llvm::ELF::DT_NEEDED, strtabsize);
-      strtabsize += (*lib)->name().size() + 1;
+      (*dt_need)->setValue(llvm::ELF::DT_NEEDED,
+                           strtab.getOffset((*lib)->name()));
       ++dt_need;
     }
   }
 
+  // .SUNW_syminfo refers to the DT_NEEDED entries
+  if (file_format->hasSymInfo())
+    emitSymInfo(pModule, pOutput);
+
   if (!config().options().getRpathList().empty()) {
+    uint64_t rpath = strtab.getOffset(getRpathString());
     if (!config().options().hasNewDTags())
-      (*dt_need)->setValue(llvm::ELF::DT_RPATH, strtabsize);
+      (*dt_need)->setValue(llvm::ELF::DT_RPATH, rpath);
     else
-      (*dt_need)->setValue(llvm::ELF::DT_RUNPATH, strtabsize);
+      (*dt_need)->setValue(llvm::ELF::DT_RUNPATH, rpath);
     ++dt_need;
+  }
 
-    GeneralOptions::const_rpath_iterator rpath,
-      rpathEnd = config().options().rpath_end();
-    for (rpath = config().options().rpath_begin(); rpath != rpathEnd; ++rpath) {
-      memcpy((strtab + strtabsize), (*rpath).data(), (*rpath).size());
-      strtabsize += (*rpath).size();
-      strtab[strtabsize++] = (rpath + 1 == rpathEnd ? '\0' : ':');
-    }
+  // -z combreloc needs the .dynsym indexes, so the dynamic relocations are
+  // sorted here, before .dynamic and the relocation sections are emitted
+  if (isCombReloc()) {
+    if (file_format->hasRelDyn())
+      m_NumOfRelativeRelocs = combineDynRelocs(file_format->getRelDyn());
+    else if (file_format->hasRelaDyn())
+      m_NumOfRelativeRelocs = combineDynRelocs(file_format->getRelaDyn());
   }
 
+  // DT_RELRSZ is the size of the encoded places, which are final here
+  if (hasRelrDyn())
+    m_pRelrDyn->finalizeEntries();
+
   // initialize value of ELF .dynamic section
   if (LinkerConfig::DynObj == config().codeGenType()) {
     // set pointer to SONAME entry in dynamic string table.
-    dynamic().applySoname(strtabsize);
+    dynamic().applySoname(strtab.getOffset(pModule.name()));
   }
   dynamic().applyEntries(*file_format);
   dynamic().emit(dyn_sect, *dyn_region);
+}
 
-  // emit soname
-  if (LinkerConfig::DynObj == config().codeGenType()) {
-    strcpy((strtab + strtabsize), pModule.name().c_str());
-    strtabsize += pModule.name().size() + 1;
-  }
+/// orderDynsyms - put the dynamic symbols with non-zero ordering keys at the
+/// end of .dynsym in the increasing order of their keys
+void GNULDBackend::orderDynsyms(Module::SymbolTable& pSymtab)
+{
+  DynsymIsUnordered unordered = { this };
+  Module::sym_iterator tail = std::stable_partition(pSymtab.dynamicBegin(),
+                                                    pSymtab.dynamicEnd(),
+                                                    unordered);
+  DynsymOrderCompare compare = { this };
+  std::stable_sort(tail, pSymtab.dynamicEnd(), compare);
 }
 
 /// emitELFHashTab - emit .hash
@@ -1190,6 +1410,56 @@ void GNULDBackend::emitELFHashTab(const Module::SymbolTable& pSymtab,
   }
 }
 
+/// emitSymInfo - emit .SUNW_syminfo
+///
+/// The entry of a symbol defined by a shared object gets the index of the
+/// DT_NEEDED entry of the shared object in .dynamic and SYMINFO_FLG_DIRECT,
+/// so the dynamic linker looks the symbol up in that library only. The
+/// entry of a symbol defined in the output is bound to the output itself,
+/// without the flag, so it is still interposable.
+void GNULDBackend::emitSymInfo(const Module& pModule, MemoryArea& pOutput)
+{
+  ELFFileFormat* file_format = getOutputFormat();
+  MemoryRegion* region = pOutput.request(file_format->getSymInfo().offset(),
+                                         file_format->getSymInfo().size());
+  uint16_t* syminfo = reinterpret_cast<uint16_t*>(region->start());
+  memset(syminfo, 0x0, region->size());
+
+  // the DT_NEEDED entries come first in .dynamic, in the order of the
+  // libraries
+  std::map<unsigned int, uint16_t> needed;
+  uint16_t dt_idx = 0;
+  Module::const_lib_iterator lib, libEnd = pModule.lib_end();
+  for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
+    if (!(*lib)->attribute()->isAsNeeded() || (*lib)->isNeeded())
+      needed[(*lib)->ordinal()] = dt_idx++;
+  }
+
+  const Module::SymbolTable& symbols = pModule.getSymbolTable();
+  size_t symIdx = 1;
+  Module::const_sym_iterator symbol, symEnd = symbols.dynamicEnd();
+  for (symbol = symbols.localDynBegin(); symbol != symEnd;
+       ++symbol, ++symIdx) {
+    const ResolveInfo* info = (*symbol)->resolveInfo();
+    if (info->isUndef())
+      continue;
+
+    // si_boundto, si_flags
+    if (!info->isDyn()) {
+      syminfo[symIdx * 2] = 0xffff; // SYMINFO_BT_SELF
+      continue;
+    }
+    std::map<unsigned int, uint16_t>::const_iterator entry =
+      needed.find(info->ordinal());
+    if (needed.end() == entry)
+      continue;
+    syminfo[symIdx * 2]     = entry->second;
+    syminfo[symIdx * 2 + 1] = 0x1; // SYMINFO_FLG_DIRECT
+  }
+
+  pOutput.release(region);
+}
+
 /// emitGNUHashTab - emit .gnu.hash
 void GNULDBackend::emitGNUHashTab(Module::SymbolTable& pSymtab,
                                   MemoryArea& pOutput)
@@ -1244,7 +1514,12 @@ void GNULDBackend::emitGNUHashTab(Module::SymbolTable& pSymtab,
     return;
   }
 
-  uint32_t maskbitslog2 = getGNUHashMaskbitslog2(hashed_sym_cnt);
+  // the bloom filter is chosen by sizeNamePools()
+  uint32_t maskbitslog2 = m_GNUHashMaskbitslog2;
+  if (0 == maskbitslog2) {
+    maskbitslog2 = getGNUHashMaskbitslog2(hashed_sym_cnt);
+    m_GNUHashShift2 = maskbitslog2;
+  }
   uint32_t maskbits = 1u << maskbitslog2;
   uint32_t shift1 = config().targets().is32Bits() ? 5 : 6;
   uint32_t mask = (1u << shift1) - 1;
@@ -1252,55 +1527,52 @@ void GNULDBackend::emitGNUHashTab(Module::SymbolTable& pSymtab,
   nbucket   = getHashBucketCount(hashed_sym_cnt, true);
   symidx    = 1 + unhashed_sym_cnt;
   maskwords = 1 << (maskbitslog2 - shift1);
-  shift2    = maskbitslog2;
+  shift2    = m_GNUHashShift2;
 
   // setup bucket and chain
   bucket = (uint32_t*)(bitmask + maskbits / 8);
   chain  = (bucket + nbucket);
 
-  // build the gnu style hash table
-  typedef std::multimap<uint32_t,
-                        std::pair<LDSymbol*, uint32_t> > SymMapType;
-  SymMapType symmap;
-  symEnd = pSymtab.dynamicEnd();
-  for (symbol = pSymtab.localDynBegin() + symidx - 1; symbol != symEnd;
-    ++symbol) {
-    StringHash<DJB> hasher;
-    uint32_t djbhash = hasher((*symbol)->name());
-    uint32_t hash = djbhash % nbucket;
-    symmap.insert(std::make_pair(hash, std::make_pair(*symbol, djbhash)));
+  // sort the hashed symbols by bucket in one counting pass. The symbols in a
+  // bucket keep their order.
+  Module::sym_iterator hashed = pSymtab.localDynBegin() + symidx - 1;
+  std::vector<uint32_t> hashes(hashed_sym_cnt);
+  std::vector<uint32_t> starts(nbucket + 1, 0x0);
+  for (size_t i = 0; i < hashed_sym_cnt; ++i) {
+    hashes[i] = getGNUHash(*hashed[i]);
+    ++starts[hashes[i] % nbucket + 1];
+  }
+  for (size_t idx = 0; idx < nbucket; ++idx)
+    starts[idx + 1] += starts[idx];
+
+  std::vector<LDSymbol*> sorted_syms(hashed_sym_cnt);
+  std::vector<uint32_t> sorted_hashes(hashed_sym_cnt);
+  std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+  for (size_t i = 0; i < hashed_sym_cnt; ++i) {
+    uint32_t pos = next[hashes[i] % nbucket]++;
+    sorted_syms[pos] = hashed[i];
+    sorted_hashes[pos] = hashes[i];
   }
+  std::copy(sorted_syms.begin(), sorted_syms.end(), hashed);
 
   // compute bucket, chain, and bitmask
   std::vector<uint64_t> bitmasks(maskwords);
-  size_t hashedidx = symidx;
   for (size_t idx = 0; idx < nbucket; ++idx) {
-    size_t count = 0;
-    std::pair<SymMapType::iterator, SymMapType::iterator> ret;
-    ret = symmap.equal_range(idx);
-    for (SymMapType::iterator it = ret.first; it != ret.second; ) {
-      // rearrange the hashed symbol ordering
-      *(pSymtab.localDynBegin() + hashedidx - 1) = it->second.first;
-      uint32_t djbhash = it->second.second;
-      uint32_t val = ((djbhash >> shift1) & ((maskbits >> shift1) - 1));
-      bitmasks[val] |= 1u << (djbhash & mask);
-      bitmasks[val] |= 1u << ((djbhash >> shift2) & mask);
-      val = djbhash & ~1u;
-      // advance the iterator and check if we're dealing w/ the last elment
-      if (++it == ret.second) {
-        // last element terminates the chain
-        val |= 1;
-      }
-      chain[hashedidx - symidx] = val;
-
-      ++hashedidx;
-      ++count;
-    }
-
-    if (count == 0)
+    if (starts[idx] == starts[idx + 1])
       bucket[idx] = 0;
     else
-      bucket[idx] = hashedidx - count;
+      bucket[idx] = symidx + starts[idx];
+  }
+  for (size_t i = 0; i < hashed_sym_cnt; ++i) {
+    uint32_t djbhash = sorted_hashes[i];
+    uint32_t val = ((djbhash >> shift1) & (maskwords - 1));
+    bitmasks[val] |= (uint64_t)1 << (djbhash & mask);
+    bitmasks[val] |= (uint64_t)1 << ((djbhash >> shift2) & mask);
+    val = djbhash & ~1u;
+    // the last element of a bucket terminates the chain
+    if (i + 1 == starts[djbhash % nbucket + 1])
+      val |= 1;
+    chain[i] = val;
   }
 
   // write the bitmasks
@@ -1345,8 +1617,136 @@ void GNULDBackend::emitInterp(MemoryArea& pOutput)
   }
 }
 
+/// sizeBuildID - compute the size of the .note.gnu.build-id section
+void GNULDBackend::sizeBuildID()
+{
+  // the header, the name "GNU" and the build ID padded to 4 bytes
+  size_t id_size = getBuildIDSize(config().options());
+  LDSection& note = getOutputFormat()->getNoteGNUBuildID();
+  note.setSize(16 + ((id_size + 3) & ~0x3));
+}
+
+/// sizeGNUDebugLink - compute the size of the .gnu_debuglink section
+void GNULDBackend::sizeGNUDebugLink()
+{
+  // the file name of the separate debug file padded to 4 bytes, and its CRC
+  std::string name =
+    sys::fs::Path(config().options().separateDebugFile()).filename().native();
+  LDSection& link = getOutputFormat()->getGNUDebugLink();
+  link.setSize(((name.size() + 1 + 3) & ~0x3) + 4);
+}
+
+/// emitGNUDebugLink - emit the file name of the separate debug file in
+/// .gnu_debuglink. Its CRC is filled in by SeparateDebugFile.
+void GNULDBackend::emitGNUDebugLink(MemoryArea& pOutput)
+{
+  std::string name =
+    sys::fs::Path(config().options().separateDebugFile()).filename().native();
+  const LDSection& link = getOutputFormat()->getGNUDebugLink();
+  MemoryRegion* region = pOutput.request(link.offset(), link.size());
+  std::memset(region->start(), 0, link.size());
+  std::memcpy(region->start(), name.data(), name.size());
+}
+
+/// emitBuildID - compute the build ID of the whole output and emit the
+/// .note.gnu.build-id
+void GNULDBackend::emitBuildID(MemoryArea& pOutput)
+{
+  if (!getOutputFormat()->hasNoteGNUBuildID() || !pOutput.hasHandler())
+    return;
+
+  // NT_GNU_BUILD_ID
+  const uint32_t note_type = 3;
+  const GeneralOptions& options = config().options();
+  const LDSection& note = getOutputFormat()->getNoteGNUBuildID();
+  size_t id_size = getBuildIDSize(options);
+
+  // every section has to reach the file before the whole file is hashed.
+  // The sections of the separate debug file are not hashed.
+  pOutput.clear();
+  uint64_t size = pOutput.handler()->size();
+  if (0 != m_MainFileSize)
+    size = m_MainFileSize;
+  MemoryRegion* region = pOutput.request(0, size);
+  uint8_t* data = region->start();
+  uint8_t* header = data + note.offset();
+  uint8_t* desc = header + 16;
+
+  // the build ID is hashed as zeros
+  bool is_little = config().targets().isLittleEndian();
+  writeNoteWord(header, 4, is_little);
+  writeNoteWord(header + 4, id_size, is_little);
+  writeNoteWord(header + 8, note_type, is_little);
+  std::memcpy(header + 12, "GNU", 4);
+  std::memset(desc, 0, note.size() - 16);
+
+  // the chunks of the file are hashed in parallel, and then their digests
+  // are hashed into the build ID
+  uint8_t id[20];
+  switch (options.getBuildID()) {
+    case GeneralOptions::BuildID_Fast:
+      digest::treeHash(config().threads(), digest::Fast, data,
+                       region->size(), id);
+      std::memcpy(desc, id, id_size);
+      break;
+    case GeneralOptions::BuildID_MD5:
+      digest::treeHash(config().threads(), digest::MD5, data,
+                       region->size(), id);
+      std::memcpy(desc, id, id_size);
+      break;
+    case GeneralOptions::BuildID_SHA1:
+      digest::treeHash(config().threads(), digest::SHA1, data,
+                       region->size(), id);
+      std::memcpy(desc, id, id_size);
+      break;
+    case GeneralOptions::BuildID_UUID: {
+      if (!sys::GetRandomBytes(desc, id_size)) {
+        error(diag::err_cannot_get_random_bytes) << "--build-id=uuid";
+        break;
+      }
+      // a random UUID of version 4, RFC 4122
+      desc[6] = (desc[6] & 0x0f) | 0x40;
+      desc[8] = (desc[8] & 0x3f) | 0x80;
+      break;
+    }
+    case GeneralOptions::BuildID_Hex:
+      std::memcpy(desc, options.getBuildIDValue().data(), id_size);
+      break;
+    default:
+      break;
+  }
+
+  pOutput.clear();
+}
+
 /// getSectionOrder
 unsigned int GNULDBackend::getSectionOrder(const LDSection& pSectHdr) const
+{
+  // layout() caches the orders of the output sections
+  if (pSectHdr.hasOrder())
+    return pSectHdr.order();
+  return computeSectionOrder(pSectHdr);
+}
+
+/// isSeparateDebugSection
+bool GNULDBackend::isSeparateDebugSection(const LDSection& pSection) const
+{
+  if ((LinkerConfig::DynObj != config().codeGenType() &&
+       LinkerConfig::Exec != config().codeGenType()) ||
+      !config().options().hasSeparateDebugFile() ||
+      0 != (pSection.flag() & llvm::ELF::SHF_ALLOC))
+    return false;
+
+  if (LDFileFormat::Debug == pSection.kind())
+    return true;
+
+  const ELFFileFormat* file_format = getOutputFormat();
+  return file_format->hasGdbIndex() &&
+         &pSection == &file_format->getGdbIndex();
+}
+
+/// computeSectionOrder
+unsigned int GNULDBackend::computeSectionOrder(const LDSection& pSectHdr) const
 {
   const ELFFileFormat* file_format = getOutputFormat();
 
@@ -1357,6 +1757,9 @@ unsigned int GNULDBackend::getSectionOrder(const LDSection& pSectHdr) const
   if (&pSectHdr == &file_format->getStrTab())
     return SHO_STRTAB;
 
+  if (isSeparateDebugSection(pSectHdr))
+    return SHO_SEPARATE_DEBUG;
+
   // if the section is not ALLOC, lay it out until the last possible moment
   if (0 == (pSectHdr.flag() & llvm::ELF::SHF_ALLOC))
     return SHO_UNDEFINED;
@@ -1411,6 +1814,8 @@ unsigned int GNULDBackend::getSectionOrder(const LDSection& pSectHdr) const
 
     // get the order from target for target specific sections
     case LDFileFormat::Target:
+      if (hasRelrDyn() && &pSectHdr == &file_format->getRelrDyn())
+        return SHO_RELOCATION;
       return getTargetSectionOrder(pSectHdr);
 
     // handle .interp and .note.* sections
@@ -1561,9 +1966,6 @@ GNULDBackend::allocateCommonSymbols(Module& pModule)
 
   SymbolCategory::iterator com_sym, com_end;
 
-  // FIXME: If the order of common symbols is defined, then sort common symbols
-  // std::sort(com_sym, com_end, some kind of order);
-
   // get corresponding BSS LDSection
   ELFFileFormat* file_format = getOutputFormat();
   LDSection& bss_sect = file_format->getBSS();
@@ -1586,7 +1988,11 @@ GNULDBackend::allocateCommonSymbols(Module& pModule)
   uint64_t bss_offset  = bss_sect.size();
   uint64_t tbss_offset = tbss_sect.size();
 
-  // allocate all local common symbols
+  // The common symbols are placed by alignment buckets, from the largest
+  // alignment to the smallest, and every bucket is one fragment.
+  CommonBuckets bss_commons, tbss_commons;
+
+  // collect all local common symbols
   com_end = symbol_list.localEnd();
 
   for (com_sym = symbol_list.localBegin(); com_sym != com_end; ++com_sym) {
@@ -1597,24 +2003,16 @@ GNULDBackend::allocateCommonSymbols(Module& pModule)
       // when emitting the regular name pools. We must change the symbols'
       // description here.
       (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-      Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-
-      if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-        // allocate TLS common symbol in tbss section
-        tbss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                     *tbss_sect_data,
-                                                     (*com_sym)->value());
-      }
-      else {
-        bss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                    *bss_sect_data,
-                                                    (*com_sym)->value());
-      }
+
+      // allocate TLS common symbol in tbss section
+      if (ResolveInfo::ThreadLocal == (*com_sym)->type())
+        tbss_commons.add(**com_sym);
+      else
+        bss_commons.add(**com_sym);
     }
   }
 
-  // allocate all global common symbols
+  // collect all global common symbols
   com_end = symbol_list.commonEnd();
   for (com_sym = symbol_list.commonBegin(); com_sym != com_end; ++com_sym) {
     // We have to reset the description of the symbol here. When doing
@@ -1623,22 +2021,17 @@ GNULDBackend::allocateCommonSymbols(Module& pModule)
     // when emitting the regular name pools. We must change the symbols'
     // description here.
     (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-    Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-    (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
 
-    if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-      // allocate TLS common symbol in tbss section
-      tbss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                   *tbss_sect_data,
-                                                   (*com_sym)->value());
-    }
-    else {
-      bss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                  *bss_sect_data,
-                                                  (*com_sym)->value());
-    }
+    // allocate TLS common symbol in tbss section
+    if (ResolveInfo::ThreadLocal == (*com_sym)->type())
+      tbss_commons.add(**com_sym);
+    else
+      bss_commons.add(**com_sym);
   }
 
+  bss_offset += bss_commons.allocate(*bss_sect_data);
+  tbss_offset += tbss_commons.allocate(*tbss_sect_data);
+
   bss_sect.setSize(bss_offset);
   tbss_sect.setSize(tbss_offset);
   symbol_list.changeCommonsToGlobal();
@@ -1651,6 +2044,9 @@ GNULDBackend::allocateCommonSymbols(Module& pModule)
 ///      output.cc: 2809: Output_section::update_flags_for_input_section
 bool GNULDBackend::updateSectionFlags(LDSection& pTo, const LDSection& pFrom)
 {
+  // the order of pTo depends on its flags
+  pTo.resetOrder();
+
   // union the flags from input
   uint32_t flags = pTo.flag();
   flags |= (pFrom.flag() &
@@ -1705,6 +2101,12 @@ void GNULDBackend::createProgramHdrs(Module& pModule)
       // 2. create data segment if w/o omagic set
       createPT_LOAD = true;
     }
+    else if (isCodeSeparated() &&
+             (prev_flag & llvm::ELF::PF_X) ^ (cur_flag & llvm::ELF::PF_X)) {
+      // 2.a create a segment for the executable sections if -z separate-code
+      // is set, and another one for the read-only sections after them
+      createPT_LOAD = true;
+    }
     else if ((*sect)->kind() == LDFileFormat::BSS &&
              load_seg->isDataSegment() &&
              config().scripts().addressMap().find(".bss") !=
@@ -1726,8 +2128,15 @@ void GNULDBackend::createProgramHdrs(Module& pModule)
     if (createPT_LOAD) {
       // create new PT_LOAD segment
       load_seg = m_ELFSegmentTable.produce(llvm::ELF::PT_LOAD, cur_flag);
-      if (!config().options().nmagic() && !config().options().omagic())
-        load_seg->setAlign(abiPageSize());
+      if (!config().options().nmagic() && !config().options().omagic()) {
+        // both p_vaddr and p_offset of the executable segment are aligned to
+        // the huge page, so the text can be remapped onto huge pages
+        if (config().options().hugePageText() &&
+            0x0 != (cur_flag & llvm::ELF::PF_X))
+          load_seg->setAlign(std::max(hugePageSize(), abiPageSize()));
+        else
+          load_seg->setAlign(abiPageSize());
+      }
     }
 
     assert(NULL != load_seg);
@@ -1863,6 +2272,58 @@ void GNULDBackend::setupProgramHdrs()
   }
 }
 
+/// isCombReloc - whether the dynamic relocations are combined by -z combreloc
+bool GNULDBackend::isCombReloc() const
+{
+  return (config().options().hasCombReloc() &&
+          0x0 != m_pInfo->relativeRelocType() &&
+          (LinkerConfig::DynObj == config().codeGenType() ||
+           LinkerConfig::Exec == config().codeGenType()));
+}
+
+/// combineDynRelocs - put the relative relocations of pSection first, and
+/// sort the others by symbol index and offset. The loader handles the leading
+/// relative relocations counted by DT_RELCOUNT in a fast path, and the sorted
+/// symbol relocations let it reuse the last symbol lookup.
+size_t GNULDBackend::combineDynRelocs(LDSection& pSection)
+{
+  RelocData::RelocationListType& relocs =
+    pSection.getRelocData()->getRelocationList();
+
+  std::vector<DynRelocKey> keys;
+  keys.reserve(relocs.size());
+  size_t num_of_relative = 0;
+  RelocData::iterator it, itEnd = relocs.end();
+  for (it = relocs.begin(); it != itEnd; ++it) {
+    DynRelocKey key;
+    key.reloc = &*it;
+    key.is_relative = (m_pInfo->relativeRelocType() == it->type());
+    key.sym_idx = 0;
+    if (!key.is_relative && NULL != it->symInfo())
+      key.sym_idx = getSymbolIdx(it->symInfo()->outSymbol());
+    key.offset = 0;
+    const FragmentRef& frag_ref = it->targetRef();
+    if (NULL != frag_ref.frag()) {
+      key.offset = frag_ref.frag()->getParent()->getSection().addr() +
+                   frag_ref.getOutputOffset();
+    }
+    if (key.is_relative)
+      ++num_of_relative;
+    keys.push_back(key);
+  }
+
+  std::stable_sort(keys.begin(), keys.end(), DynRelocCompare());
+
+  // relink the relocations in the sorted order. The list does not own them.
+  while (!relocs.empty())
+    relocs.remove(relocs.begin());
+  std::vector<DynRelocKey>::iterator key, keyEnd = keys.end();
+  for (key = keys.begin(); key != keyEnd; ++key)
+    relocs.push_back(key->reloc);
+
+  return num_of_relative;
+}
+
 /// setupGNUStackInfo - setup the section flag of .note.GNU-stack in output
 /// @ref gold linker: layout.cc:2608
 void GNULDBackend::setupGNUStackInfo(Module& pModule)
@@ -1984,6 +2445,20 @@ void GNULDBackend::setOutputSectionOffset(Module& pModule,
         break;
     }
 
+    // the section header table of the output goes between its sections and
+    // the ones of the separate debug file, which are cut off after emission
+    if (isSeparateDebugSection(**cur) && !isSeparateDebugSection(**prev)) {
+      offset = (*prev)->offset() + (*prev)->size();
+      m_NumOfMainSections = (*cur)->index();
+      if (config().targets().is32Bits())
+        m_MainFileSize = Align<32>(offset) +
+          m_NumOfMainSections * sizeof(ELFSizeTraits<32>::Shdr);
+      else
+        m_MainFileSize = Align<64>(offset) +
+          m_NumOfMainSections * sizeof(ELFSizeTraits<64>::Shdr);
+      offset = m_MainFileSize;
+    }
+
     alignAddress(offset, (*cur)->align());
     (*cur)->setOffset(offset);
   }
@@ -2078,14 +2553,96 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule,
   }
 }
 
+namespace {
+
+/// AlignCompare - the section of the larger alignment goes first
+struct AlignCompare
+{
+  bool operator()(const std::pair<LDSection*, unsigned int>& X,
+                  const std::pair<LDSection*, unsigned int>& Y) const
+  { return X.first->align() > Y.first->align(); }
+};
+
+/// IsLargeData - is the section at least pPageSize bytes, or not a regular
+/// section?
+struct IsLargeData
+{
+  explicit IsLargeData(uint64_t pPageSize) : pageSize(pPageSize) { }
+
+  bool operator()(const std::pair<LDSection*, unsigned int>& X) const
+  {
+    return (LDFileFormat::Regular != X.first->kind() ||
+            X.first->size() >= pageSize);
+  }
+
+  uint64_t pageSize;
+};
+
+} // anonymous namespace
+
+/// PackDataPages - every page of the writable segments that a process
+/// touches is dirty in every process, so the sections are ordered to dirty
+/// the fewest pages:
+/// 1. the sections of a rank of PT_GNU_RELRO are ordered by their alignments,
+/// so there is the least padding between them, and the relocated data spans
+/// the fewest pages. .got keeps its place at the end of PT_GNU_RELRO.
+/// 2. the .data sections smaller than a page are moved to the end of .data,
+/// which is next to .bss, so they share the pages that the small data and the
+/// zero-filled head of .bss dirty anyway, and do not leave a partially dirty
+/// page among the large ones.
+void GNULDBackend::PackDataPages(std::vector<SHOEntry>& pList,
+                                 uint64_t pPageSize)
+{
+  std::vector<SHOEntry>::iterator begin = pList.begin(), end;
+  for (; begin != pList.end(); begin = end) {
+    end = begin;
+    while (end != pList.end() && end->second == begin->second)
+      ++end;
+
+    switch (begin->second) {
+      case SHO_RELRO_LOCAL:
+      case SHO_RELRO:
+        std::stable_sort(begin, end, AlignCompare());
+        break;
+      case SHO_DATA: {
+        std::vector<SHOEntry>::iterator small =
+          std::stable_partition(begin, end, IsLargeData(pPageSize));
+        std::stable_sort(small, end, AlignCompare());
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
 /// layout - layout method
 void GNULDBackend::layout(Module& pModule)
 {
+  // the non-allocated .debug_* sections are compressed by the writer. They
+  // are marked before relocation(), so their relocations are written into
+  // the uncompressed image instead of the output file.
+  bool compress_debug = (GeneralOptions::CompressDebugSections_Zlib ==
+                             config().options().getCompressDebugSections() &&
+                         LinkerConfig::Object != config().codeGenType() &&
+                         LinkerConfig::Binary != config().codeGenType());
+
   std::vector<SHOEntry> output_list;
   // 1. determine what sections will go into final output, and push the needed
   // sections into output_list for later processing
   for (Module::iterator it = pModule.begin(), ie = pModule.end(); it != ie;
        ++it) {
+    // the kind, flags and name of an output section are settled here, so its
+    // order is computed once
+    if (!(*it)->hasOrder())
+      (*it)->setOrder(computeSectionOrder(**it));
+
+    if (compress_debug && LDFileFormat::Debug == (*it)->kind() &&
+        0 != (*it)->size() &&
+        0 == ((*it)->flag() & llvm::ELF::SHF_ALLOC) &&
+        0 == (*it)->name().compare(0, 6, ".debug"))
+      (*it)->setFlag((*it)->flag() | 0x800); // SHF_COMPRESSED
+
     switch ((*it)->kind()) {
     // take NULL and StackNote directly
     case LDFileFormat::Null:
@@ -2141,6 +2698,9 @@ void GNULDBackend::layout(Module& pModule)
 
   // 2. sort output section orders
   std::stable_sort(output_list.begin(), output_list.end(), SHOCompare());
+  if (config().options().packDataPages() &&
+      LinkerConfig::Object != config().codeGenType())
+    PackDataPages(output_list, commonPageSize());
 
   // 3. update output sections in Module
   pModule.getSectionTable().clear();
@@ -2158,12 +2718,39 @@ void GNULDBackend::layout(Module& pModule)
   setOutputSectionOffset(pModule, pModule.begin(), pModule.end(), 0x0);
 }
 
+/// preMergeSections - the fragments of the input sections are moved into the
+/// output sections later, so the compile units and the code of the objects
+/// are found now
+void GNULDBackend::preMergeSections(Module& pModule)
+{
+  if ((LinkerConfig::DynObj != config().codeGenType() &&
+       LinkerConfig::Exec != config().codeGenType()) ||
+      !config().options().hasGdbIndex())
+    return;
+
+  m_pGdbIndex = new GdbIndex(getOutputFormat()->getGdbIndex());
+  m_pGdbIndex->read(pModule, config().threads());
+}
+
 /// preLayout - Backend can do any needed modification before layout
 void GNULDBackend::preLayout(Module& pModule, IRBuilder& pBuilder)
 {
+  // the base address of a prelinked library decides DT_GNU_PRELINKED, which
+  // is reserved with the other .dynamic entries
+  if (LinkerConfig::DynObj == config().codeGenType() &&
+      config().options().hasPrelinkMap())
+    setupPrelink(pModule);
+
   // prelayout target first
   doPreLayout(pBuilder);
 
+  // size .relr.dyn as if every place needs an address entry. It is shrunk
+  // after layout, when the places have their addresses.
+  if (hasRelrDyn()) {
+    getOutputFormat()->getRelrDyn().setSize(m_pRelrDyn->numOfRelocs() *
+                                            m_pRelrDyn->getEntrySize());
+  }
+
   if (LinkerConfig::Object != config().codeGenType() &&
       config().options().hasEhFrameHdr() && getOutputFormat()->hasEhFrame()) {
     // init EhFrameHdr and size the output section
@@ -2173,6 +2760,19 @@ void GNULDBackend::preLayout(Module& pModule, IRBuilder& pBuilder)
     m_pEhFrameHdr->sizeOutput();
   }
 
+  if ((LinkerConfig::DynObj == config().codeGenType() ||
+       LinkerConfig::Exec == config().codeGenType()) &&
+      config().options().hasBuildID())
+    sizeBuildID();
+
+  if (NULL != m_pGdbIndex)
+    m_pGdbIndex->sizeOutput();
+
+  if ((LinkerConfig::DynObj == config().codeGenType() ||
+       LinkerConfig::Exec == config().codeGenType()) &&
+      config().options().hasSeparateDebugFile())
+    sizeGNUDebugLink();
+
   // change .tbss and .tdata section symbol from Local to LocalDyn category
   if (NULL != f_pTDATA)
     pModule.getSymbolTable().changeLocalToDynamic(*f_pTDATA);
@@ -2183,8 +2783,11 @@ void GNULDBackend::preLayout(Module& pModule, IRBuilder& pBuilder)
   // To merge input's relocation sections into output's relocation sections.
   //
   // If we are generating relocatables (-r), move input relocation sections
-  // to corresponding output relocation sections.
-  if (LinkerConfig::Object == config().codeGenType()) {
+  // to corresponding output relocation sections. The streamed ones are
+  // copied by the writer.
+  if (RelocationStreamer::IsEnabled(config()))
+    getRelocStreamer().sizeOutputs(pModule);
+  else if (LinkerConfig::Object == config().codeGenType()) {
     Module::obj_iterator input, inEnd = pModule.obj_end();
     for (input = pModule.obj_begin(); input != inEnd; ++input) {
       LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
@@ -2199,7 +2802,7 @@ void GNULDBackend::preLayout(Module& pModule, IRBuilder& pBuilder)
                                           (*rs)->flag());
 
           output_sect->setAlign((*rs)->align());
-          pModule.getSectionTable().push_back(output_sect);
+          pModule.appendSection(*output_sect);
         }
 
         // set output relocation section link
@@ -2256,25 +2859,170 @@ void GNULDBackend::postLayout(Module& pModule, IRBuilder& pBuilder)
     setOutputSectionAddress(pModule, pModule.begin(), pModule.end());
 
     // 1.3 do relaxation
-    relax(pModule, pBuilder);
+    {
+      TimeScope phase(config().timeReport(), "relax");
+      relax(pModule, pBuilder);
+    }
+
+    // 1.4 size the packed relative relocations
+    sizeRelrDyn(pModule);
 
-    // 1.4 set up the attributes of program headers
+    // 1.5 set up the attributes of program headers
     setupProgramHdrs();
   }
 
+  // the debug sections are split off the output at the end of the link
+  if ((LinkerConfig::DynObj == config().codeGenType() ||
+       LinkerConfig::Exec == config().codeGenType()) &&
+      config().options().hasSeparateDebugFile()) {
+    m_pSeparateDebugFile =
+      new SeparateDebugFile(config(), pModule, m_ShStrTabNames,
+                            getOutputFormat()->getGNUDebugLink());
+  }
+
   // 2. target specific post layout
   doPostLayout(pModule, pBuilder);
 }
 
 void GNULDBackend::postProcessing(MemoryArea& pOutput)
 {
+  // the implicit addends of a streamed partial link
+  if (NULL != m_pRelocStreamer)
+    m_pRelocStreamer->syncImplicitAddends(pOutput);
+
   if (LinkerConfig::Object != config().codeGenType() &&
       config().options().hasEhFrameHdr() && getOutputFormat()->hasEhFrame()) {
     // emit eh_frame_hdr
     if (config().targets().is32Bits())
-      m_pEhFrameHdr->emitOutput<32>(pOutput);
+      m_pEhFrameHdr->emitOutput<32>(pOutput, config().threads());
     else
-      m_pEhFrameHdr->emitOutput<64>(pOutput);
+      m_pEhFrameHdr->emitOutput<64>(pOutput, config().threads());
+  }
+
+  // the prelinked values are hashed into the build ID
+  if (m_bPrelinked)
+    applyPrelink(pOutput);
+
+  if (NULL != m_pGdbIndex)
+    m_pGdbIndex->emitOutput(pOutput);
+
+  if (getOutputFormat()->hasGNUDebugLink() &&
+      0 != getOutputFormat()->getGNUDebugLink().size())
+    emitGNUDebugLink(pOutput);
+
+  // the build ID covers the whole output, so it is computed last
+  emitBuildID(pOutput);
+
+  // the debug sections are moved after the build ID is computed, and the
+  // CRC of the debug file is not hashed into it
+  if (NULL != m_pSeparateDebugFile && !m_pSeparateDebugFile->emit(pOutput)) {
+    error(diag::err_cannot_write_separate_debug_file)
+                                    << config().options().separateDebugFile();
+  }
+}
+
+/// setupPrelink - a library is named in the map by its DT_SONAME, which is
+/// the output file name if -soname is not given, or by the file name of it
+void GNULDBackend::setupPrelink(const Module& pModule)
+{
+  const std::string& path = config().options().prelinkMap();
+  PrelinkMap map;
+  if (!map.read(sys::fs::Path(path))) {
+    error(diag::err_cannot_read_prelink_map) << path;
+    return;
+  }
+
+  uint64_t base = map.getBase(pModule.name());
+  if (PrelinkMap::NotFound == base) {
+    sys::fs::Path name(pModule.name());
+    base = map.getBase(name.filename().native());
+  }
+  if (PrelinkMap::NotFound == base) {
+    warning(diag::warn_not_in_prelink_map) << pModule.name() << path;
+    return;
+  }
+
+  if (0 != (base & (abiPageSize() - 1))) {
+    error(diag::err_unaligned_prelink_base) << pModule.name() << base;
+    return;
+  }
+  m_PrelinkBase = base;
+  m_bPrelinked = true;
+}
+
+namespace {
+
+/// WritePrelinkWord - write the pSize bytes of pValue in the target byte
+/// order
+void WritePrelinkWord(uint8_t* pPlace, uint64_t pValue, unsigned int pSize,
+                      bool pIsLittle)
+{
+  for (unsigned int i = 0; i < pSize; ++i) {
+    unsigned int shift = pIsLittle ? (i * 8) : ((pSize - 1 - i) * 8);
+    pPlace[i] = (pValue >> shift) & 0xff;
+  }
+}
+
+} // anonymous namespace
+
+/// applyPrelink - a loader which maps the library at its base address finds
+/// the relocated values in place, so it may skip the relative relocations,
+/// and the GOT entries of the symbols which the library defines. The
+/// relocations are kept for the loaders which map it elsewhere.
+/// 1. A relative relocation of RELA is written as its addend. One of REL has
+/// the address in place already.
+/// 2. A GOT entry of a symbol defined in the library is written as the
+/// address of the symbol. The thread-local and the indirect symbols, whose
+/// GOT entries are not addresses, are left to the loader, as are the symbols
+/// of the other libraries.
+void GNULDBackend::applyPrelink(MemoryArea& pOutput)
+{
+  ELFFileFormat* file_format = getOutputFormat();
+  LDSection* rel_dyn = NULL;
+  bool is_rela = false;
+  if (file_format->hasRelDyn())
+    rel_dyn = &file_format->getRelDyn();
+  else if (file_format->hasRelaDyn()) {
+    rel_dyn = &file_format->getRelaDyn();
+    is_rela = true;
+  }
+  if (NULL == rel_dyn || !rel_dyn->hasRelocData())
+    return;
+
+  const LDSection* got = file_format->hasGOT() ? &file_format->getGOT() : NULL;
+  unsigned int word_size = config().targets().bitclass() / 8;
+  bool is_little = config().targets().isLittleEndian();
+
+  RelocData::iterator it, itEnd = rel_dyn->getRelocData()->end();
+  for (it = rel_dyn->getRelocData()->begin(); it != itEnd; ++it) {
+    const FragmentRef& frag_ref = it->targetRef();
+    if (NULL == frag_ref.frag())
+      continue;
+    const LDSection& sect = frag_ref.frag()->getParent()->getSection();
+    if (LDFileFormat::BSS == sect.kind())
+      continue;
+
+    uint64_t value = 0x0;
+    if (m_pInfo->relativeRelocType() == it->type()) {
+      if (!is_rela)
+        continue;
+      value = it->addend();
+    }
+    else {
+      const ResolveInfo* sym = it->symInfo();
+      if (&sect != got || NULL == sym || sym->isDyn() || sym->isUndef() ||
+          ResolveInfo::ThreadLocal == sym->type() ||
+          ResolveInfo::IndirectFunc == sym->type())
+        continue;
+      value = sym->outSymbol()->value();
+      if (is_rela)
+        value += it->addend();
+    }
+
+    MemoryRegion* region =
+      pOutput.request(sect.offset() + frag_ref.getOutputOffset(), word_size);
+    WritePrelinkWord(region->start(), value, word_size, is_little);
+    pOutput.release(region);
   }
 }
 
@@ -2325,6 +3073,131 @@ unsigned GNULDBackend::getGNUHashMaskbitslog2(unsigned pNumOfSymbols) const
   return maskbitslog2;
 }
 
+namespace {
+
+/// GNUHasher - the body of parallel_for to hash the i-th dynsym
+struct GNUHasher
+{
+  const std::vector<const LDSymbol*>* symbols;
+  std::vector<uint32_t>* hashes;
+
+  void operator()(size_t pIdx) {
+    StringHash<DJB> hasher;
+    (*hashes)[pIdx] = hasher((*symbols)[pIdx]->name());
+  }
+};
+
+/// helper_count_bits - the number of bits set in pWord
+unsigned int helper_count_bits(uint64_t pWord)
+{
+  unsigned int count = 0;
+  for (; 0x0 != pWord; pWord &= pWord - 1)
+    ++count;
+  return count;
+}
+
+} // anonymous namespace
+
+/// hashDynsyms - compute the GNU hashes of the dynamic symbols to hash
+size_t GNULDBackend::hashDynsyms(Module::SymbolTable& pSymtab)
+{
+  std::vector<const LDSymbol*> symbols;
+  Module::const_sym_iterator symbol, symEnd = pSymtab.dynamicEnd();
+  for (symbol = pSymtab.dynamicBegin(); symbol != symEnd; ++symbol) {
+    if (DynsymCompare().needGNUHash(**symbol))
+      symbols.push_back(*symbol);
+  }
+
+  std::vector<uint32_t> hashes(symbols.size());
+  GNUHasher hasher = { &symbols, &hashes };
+  parallel_for(config().threads(), 0, symbols.size(), hasher, 256);
+
+  m_GNUHashes.clear();
+  for (size_t i = 0; i < symbols.size(); ++i)
+    m_GNUHashes[symbols[i]] = hashes[i];
+
+  chooseGNUHashBloom(hashes,
+                     getGNUHashMaskbitslog2(hashes.size()),
+                     config().targets().is32Bits() ? 5 : 6,
+                     m_GNUHashMaskbitslog2,
+                     m_GNUHashShift2);
+  return symbols.size();
+}
+
+/// getGNUHash - the GNU hash of pSymbol
+uint32_t GNULDBackend::getGNUHash(const LDSymbol& pSymbol) const
+{
+  // the symbols added after sizeNamePools() are hashed here
+  GNUHashMapType::const_iterator entry = m_GNUHashes.find(&pSymbol);
+  if (m_GNUHashes.end() != entry)
+    return entry->second;
+  StringHash<DJB> hasher;
+  return hasher(pSymbol.name());
+}
+
+/// chooseGNUHashBloom - choose the bloom filter of .gnu.hash
+///
+/// A lookup of an absent name passes the filter if both of its bits are set.
+/// For a random name, the rate is the sum of (bits set / word bits)^2 over
+/// the words, divided by the number of words. The filters from half to twice
+/// the size gold chooses are tried with every shift, and the smallest filter
+/// whose rate is at most 1/16 is used. If none is, the one with the lowest
+/// rate is used.
+void GNULDBackend::chooseGNUHashBloom(const std::vector<uint32_t>& pHashes,
+                                      uint32_t pBase,
+                                      uint32_t pShift1,
+                                      uint32_t& pMaskbitslog2,
+                                      uint32_t& pShift2)
+{
+  pMaskbitslog2 = pBase;
+  pShift2 = pBase;
+  if (pHashes.empty())
+    return;
+
+  const uint32_t mask = (1u << pShift1) - 1;
+  const double word_bits = (double)(1u << pShift1);
+  const double max_false_positive = 1.0 / 16;
+
+  uint32_t first = (pBase - 1 < pShift1) ? pShift1 : pBase - 1;
+  double best_rate = 2.0;
+  for (uint32_t log2 = first; log2 <= pBase + 1; ++log2) {
+    size_t maskwords = 1u << (log2 - pShift1);
+    std::vector<uint64_t> bitmasks(maskwords);
+    double size_rate = 2.0;
+    uint32_t size_shift = log2;
+    for (uint32_t shift = pShift1; shift < 32; ++shift) {
+      std::fill(bitmasks.begin(), bitmasks.end(), 0x0);
+      for (size_t i = 0; i < pHashes.size(); ++i) {
+        uint32_t val = (pHashes[i] >> pShift1) & (maskwords - 1);
+        bitmasks[val] |= (uint64_t)1 << (pHashes[i] & mask);
+        bitmasks[val] |= (uint64_t)1 << ((pHashes[i] >> shift) & mask);
+      }
+
+      double rate = 0.0;
+      for (size_t w = 0; w < maskwords; ++w) {
+        double set = helper_count_bits(bitmasks[w]) / word_bits;
+        rate += set * set;
+      }
+      rate /= maskwords;
+      if (rate < size_rate) {
+        size_rate = rate;
+        size_shift = shift;
+      }
+    }
+
+    if (size_rate <= max_false_positive) {
+      pMaskbitslog2 = log2;
+      pShift2 = size_shift;
+      return;
+    }
+    if (size_rate < best_rate) {
+      best_rate = size_rate;
+      pMaskbitslog2 = log2;
+      pShift2 = size_shift;
+    }
+  }
+}
+
 /// isDynamicSymbol
 /// @ref Google gold linker: symtab.cc:311
 bool GNULDBackend::isDynamicSymbol(const LDSymbol& pSymbol)
@@ -2387,10 +3260,84 @@ uint64_t GNULDBackend::abiPageSize() const
     return m_pInfo->abiPageSize();
 }
 
+/// emitNops - fill the padding of an executable section
+void GNULDBackend::emitNops(uint8_t* pBuffer,
+                            uint64_t pOffset,
+                            uint64_t pSize) const
+{
+  std::memset(pBuffer, 0x0, pSize);
+}
+
+/// hugePageSize - the size of the huge pages backing the text for
+/// --huge-page-text
+uint64_t GNULDBackend::hugePageSize() const
+{
+  // the transparent huge page of x86-64, and the 2MiB block of AArch64 and
+  // ARM LPAE
+  return 0x200000;
+}
+
+/// isCodeSeparated - the executable sections are not mixed with the other
+/// sections in a segment
+bool GNULDBackend::isCodeSeparated() const
+{
+  if (config().options().omagic() || config().options().nmagic())
+    return false;
+  return (config().options().hasSeparateCode() ||
+          config().options().hugePageText());
+}
+
+/// scanProperties - the ScanProperty bits of pSym. They are computed on the
+/// first query after the attributes of pSym change, since a symbol is usually
+/// referred by many relocations.
+uint16_t GNULDBackend::scanProperties(const ResolveInfo& pSym) const
+{
+  uint16_t props = pSym.scanProperties();
+  if (0 == props) {
+    props = computeScanProperties(pSym);
+    pSym.setScanProperties(props);
+  }
+  return props;
+}
+
+/// computeScanProperties - evaluate the ScanProperty bits of pSym
+uint16_t GNULDBackend::computeScanProperties(const ResolveInfo& pSym) const
+{
+  uint16_t props = ResolveInfo::ScanComputed;
+
+  bool preemptible = computePreemptible(pSym);
+  if (preemptible)
+    props |= ResolveInfo::ScanPreemptible;
+  if (computeNeedsPLT(pSym, preemptible))
+    props |= ResolveInfo::ScanNeedsPLT;
+  if (computeFinalValueIsKnown(pSym))
+    props |= ResolveInfo::ScanFinalValueKnown;
+
+  // only the reference from dynamic executable to non-function symbol in
+  // the dynamic objects may need copy relocation, unless -z nocopyreloc
+  if (!config().isCodeIndep() &&
+      pSym.isDyn() &&
+      pSym.type() != ResolveInfo::Function &&
+      pSym.size() != 0 &&
+      !config().options().hasNoCopyReloc())
+    props |= ResolveInfo::ScanCopyRelocCand;
+
+  for (unsigned int idx = 0; idx < 4; ++idx) {
+    if (computeNeedsDynRel(pSym, preemptible, (idx & 0x2), (idx & 0x1)))
+      props |= (1 << (ResolveInfo::ScanDynRelOffset + idx));
+  }
+  return props;
+}
+
 /// isSymbolPreemtible - whether the symbol can be preemted by other
 /// link unit
-/// @ref Google gold linker, symtab.h:551
 bool GNULDBackend::isSymbolPreemptible(const ResolveInfo& pSym) const
+{
+  return (0 != (scanProperties(pSym) & ResolveInfo::ScanPreemptible));
+}
+
+/// @ref Google gold linker, symtab.h:551
+bool GNULDBackend::computePreemptible(const ResolveInfo& pSym) const
 {
   if (pSym.other() != ResolveInfo::Default)
     return false;
@@ -2403,8 +3350,16 @@ bool GNULDBackend::isSymbolPreemptible(const ResolveInfo& pSym) const
   if (LinkerConfig::DynObj != config().codeGenType())
     return false;
 
-  if (config().options().Bsymbolic())
-    return false;
+  // -Bsymbolic binds the references to the definitions in the output, and
+  // -Bsymbolic-functions binds those to the function definitions only. The
+  // undefined symbols and the symbols of the shared objects stay preemptible.
+  if (pSym.isDefine() && !pSym.isDyn()) {
+    if (config().options().Bsymbolic())
+      return false;
+    if (config().options().BsymbolicFunctions() &&
+        ResolveInfo::Function == pSym.type())
+      return false;
+  }
 
   // A local defined symbol should be non-preemptible.
   // This issue is found when linking libstdc++ on freebsd. A R_386_GOT32
@@ -2417,10 +3372,20 @@ bool GNULDBackend::isSymbolPreemptible(const ResolveInfo& pSym) const
 }
 
 /// symbolNeedsDynRel - return whether the symbol needs a dynamic relocation
-/// @ref Google gold linker, symtab.h:645
 bool GNULDBackend::symbolNeedsDynRel(const ResolveInfo& pSym,
                                      bool pSymHasPLT,
                                      bool isAbsReloc) const
+{
+  unsigned int idx = (pSymHasPLT ? 0x2 : 0x0) | (isAbsReloc ? 0x1 : 0x0);
+  return (0 != (scanProperties(pSym) &
+                (1 << (ResolveInfo::ScanDynRelOffset + idx))));
+}
+
+/// @ref Google gold linker, symtab.h:645
+bool GNULDBackend::computeNeedsDynRel(const ResolveInfo& pSym,
+                                      bool pPreemptible,
+                                      bool pSymHasPLT,
+                                      bool isAbsReloc) const
 {
   // an undefined reference in the executables should be statically
   // resolved to 0 and no need a dynamic relocation
@@ -2442,16 +3407,21 @@ bool GNULDBackend::symbolNeedsDynRel(const ResolveInfo& pSym,
     return false;
   if (!config().isCodeIndep() && pSymHasPLT)
     return false;
-  if (pSym.isDyn() || pSym.isUndef() ||
-      isSymbolPreemptible(pSym))
+  if (pSym.isDyn() || pSym.isUndef() || pPreemptible)
     return true;
 
   return false;
 }
 
 /// symbolNeedsPLT - return whether the symbol needs a PLT entry
-/// @ref Google gold linker, symtab.h:596
 bool GNULDBackend::symbolNeedsPLT(const ResolveInfo& pSym) const
+{
+  return (0 != (scanProperties(pSym) & ResolveInfo::ScanNeedsPLT));
+}
+
+/// @ref Google gold linker, symtab.h:596
+bool GNULDBackend::computeNeedsPLT(const ResolveInfo& pSym,
+                                   bool pPreemptible) const
 {
   if (pSym.isUndef() &&
       !pSym.isDyn() &&
@@ -2473,13 +3443,18 @@ bool GNULDBackend::symbolNeedsPLT(const ResolveInfo& pSym) const
 
   return (pSym.isDyn() ||
           pSym.isUndef() ||
-          isSymbolPreemptible(pSym));
+          pPreemptible);
 }
 
 /// symbolHasFinalValue - return true if the symbol's value can be decided at
 /// link time
-/// @ref Google gold linker, Symbol::final_value_is_known
 bool GNULDBackend::symbolFinalValueIsKnown(const ResolveInfo& pSym) const
+{
+  return (0 != (scanProperties(pSym) & ResolveInfo::ScanFinalValueKnown));
+}
+
+/// @ref Google gold linker, Symbol::final_value_is_known
+bool GNULDBackend::computeFinalValueIsKnown(const ResolveInfo& pSym) const
 {
   // if the output is pic code or if not executables, symbols' value may change
   // at runtime
@@ -2508,16 +3483,7 @@ bool GNULDBackend::symbolFinalValueIsKnown(const ResolveInfo& pSym) const
 bool GNULDBackend::symbolNeedsCopyReloc(const Relocation& pReloc,
                                         const ResolveInfo& pSym) const
 {
-  // only the reference from dynamic executable to non-function symbol in
-  // the dynamic objects may need copy relocation
-  if (config().isCodeIndep() ||
-      !pSym.isDyn() ||
-      pSym.type() == ResolveInfo::Function ||
-      pSym.size() == 0)
-    return false;
-
-  // check if the option -z nocopyreloc is given
-  if (config().options().hasNoCopyReloc())
+  if (0 == (scanProperties(pSym) & ResolveInfo::ScanCopyRelocCand))
     return false;
 
   // TODO: Is this check necessary?
@@ -2567,6 +3533,36 @@ void GNULDBackend::checkAndSetHasTextRel(const LDSection& pSection)
   return;
 }
 
+void GNULDBackend::issueUndefRef(const Relocation& pReloc,
+                                 const LDSection& pSection,
+                                 const Module& pModule)
+{
+  const ResolveInfo* rsym = pReloc.symInfo();
+  DiagnosticEngine& engine = getDiagnosticEngine();
+  DiagnosticLineInfo* line_info = engine.getLineInfo();
+  if (NULL != line_info && !engine.isIgnored(diag::undefined_reference)) {
+    // the input of pSection is only looked for when the message is issued
+    Module::const_obj_iterator input, inEnd = pModule.obj_end();
+    for (input = pModule.obj_begin(); input != inEnd; ++input) {
+      const LDContext& context = *(*input)->context();
+      if (context.relocSectEnd() != std::find(context.relocSectBegin(),
+                                              context.relocSectEnd(),
+                                              &pSection))
+        break;
+    }
+
+    std::string file;
+    unsigned int line = 0;
+    if (inEnd != input &&
+        line_info->findLine(**input, pReloc.targetRef(), file, line)) {
+      engine.report(diag::undefined_reference, DiagnosticEngine::Fatal, true)
+        << rsym->name() << file << line;
+      return;
+    }
+  }
+  fatal(diag::undefined_reference) << rsym->name();
+}
+
 /// initBRIslandFactory - initialize the branch island factory for relaxation
 bool GNULDBackend::initBRIslandFactory()
 {
@@ -2591,26 +3587,90 @@ bool GNULDBackend::relax(Module& pModule, IRBuilder& pBuilder)
     return true;
 
   bool finished = true;
+  std::vector<uint64_t> sizes;
   do {
-    if (doRelax(pModule, pBuilder, finished)) {
-      // If the sections (e.g., .text) are relaxed, the layout is also changed
-      // We need to do the following:
-
-      // 1. set up the offset
-      setOutputSectionOffset(pModule, pModule.begin(), pModule.end());
+    if (LinkStats::isEnabled())
+      LinkStats::Add(LinkStats::RelaxationIterations);
 
-      // 2. set up the offset constraint of PT_RELRO
-      if (config().options().hasRelro())
-        setupRelro(pModule);
+    // the sizes before this round, to find the first section it changes
+    Module::iterator sect, sectEnd = pModule.end();
+    sizes.clear();
+    for (sect = relaxedSectionBegin(pModule); sect != sectEnd; ++sect)
+      sizes.push_back((*sect)->size());
 
-      // 3. set up the output sections' address
-      setOutputSectionAddress(pModule, pModule.begin(), pModule.end());
+    if (doRelax(pModule, pBuilder, finished)) {
+      // If the sections (e.g., .text) are relaxed, the layout is also changed.
+      // The sections before the first resized one keep their offsets and
+      // addresses.
+      size_t idx = 0;
+      for (sect = relaxedSectionBegin(pModule); sect != sectEnd; ++sect, ++idx) {
+        if ((*sect)->size() != sizes[idx])
+          break;
+      }
+      if (sect != sectEnd)
+        relayout(pModule, sect);
     }
   } while (!finished);
 
   return true;
 }
 
+/// relayout - lay out the output sections after pSect again
+void GNULDBackend::relayout(Module& pModule, Module::iterator pSect)
+{
+  // 1. set up the offset from pSect
+  setOutputSectionOffset(pModule, pSect, pModule.end());
+
+  // 2. set up the offset constraint of PT_RELRO. It is kept if the page
+  // aligned section, the first non-relro one, is before pSect.
+  if (config().options().hasRelro()) {
+    Module::iterator sect, sectEnd = pModule.end();
+    for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+      if (getSectionOrder(**sect) > SHO_RELRO_LAST)
+        break;
+    }
+    if (sect == sectEnd || (*pSect)->index() <= (*sect)->index())
+      setupRelro(pModule);
+  }
+
+  // 3. set up the output sections' address
+  setOutputSectionAddress(pModule, pSect, pModule.end());
+}
+
+void GNULDBackend::sizeRelrDyn(Module& pModule)
+{
+  if (!hasRelrDyn())
+    return;
+
+  // Shrinking .relr.dyn moves the following sections, and the bitmaps of
+  // the moved places may change. Iterate until the size is stable. After
+  // MaxShrinkRounds, the section only grows, so the iteration always stops.
+  // The unused words at the end of the section are empty bitmaps.
+  static const unsigned int MaxShrinkRounds = 4;
+  LDSection& relr = getOutputFormat()->getRelrDyn();
+  for (unsigned int round = 0; ; ++round) {
+    uint64_t size = m_pRelrDyn->sizeOfEntries();
+    if (size == relr.size() ||
+        (size < relr.size() && round >= MaxShrinkRounds))
+      break;
+
+    relr.setSize(size);
+    relayout(pModule, pModule.begin() + relr.index());
+  }
+}
+
+/// hasSymbolName - whether the name of pSymbol is put into the string table
+bool GNULDBackend::hasSymbolName(const LDSymbol& pSymbol) const
+{
+  return ResolveInfo::Section != pSymbol.type();
+}
+
+/// getDynsymOrder - the ordering key of dynamic symbol pSymbol
+uint64_t GNULDBackend::getDynsymOrder(const LDSymbol& pSymbol) const
+{
+  return 0;
+}
+
 bool GNULDBackend::DynsymCompare::needGNUHash(const LDSymbol& X) const
 {
   // FIXME: in bfd and gold linker, an undefined symbol might be hashed
@@ -2619,6 +3679,16 @@ bool GNULDBackend::DynsymCompare::needGNUHash(const LDSymbol& X) const
   return !X.resolveInfo()->isUndef() && !X.isDyn();
 }
 
+bool GNULDBackend::DynRelocCompare::operator()(const DynRelocKey& X,
+                                               const DynRelocKey& Y) const
+{
+  if (X.is_relative != Y.is_relative)
+    return X.is_relative;
+  if (X.sym_idx != Y.sym_idx)
+    return X.sym_idx < Y.sym_idx;
+  return X.offset < Y.offset;
+}
+
 bool GNULDBackend::DynsymCompare::operator()(const LDSymbol* X,
                                              const LDSymbol* Y) const
 {
@@ -53,6 +53,26 @@ HexagonLDBackend::~HexagonLDBackend()
   delete m_pDynamic;
 }
 
+void HexagonLDBackend::reset()
+{
+  // the relocator keeps the GOT and PLT entries of the symbols
+  delete m_pRelocator;
+  m_pRelocator = NULL;
+  delete m_pGOT;
+  m_pGOT = NULL;
+  delete m_pPLT;
+  m_pPLT = NULL;
+  delete m_pRelDyn;
+  m_pRelDyn = NULL;
+  delete m_pRelPLT;
+  m_pRelPLT = NULL;
+  delete m_pDynamic;
+  m_pDynamic = NULL;
+  m_pGOTSymbol = NULL;
+  m_pBSSEnd = NULL;
+  GNULDBackend::reset();
+}
+
 bool HexagonLDBackend::initRelocator()
 {
   if (NULL == m_pRelocator) {
@@ -98,8 +118,14 @@ void HexagonLDBackend::scanRelocation(Relocation& pReloc,
                                       IRBuilder& pBuilder,
                                       Module& pModule,
                                       LDSection& pSection)
+{
+}
+
+bool HexagonLDBackend::preScanRelocation(Relocation& pReloc,
+                                         const LDSection& pSection)
 {
   pReloc.updateAddend();
+  return false;
 }
 
 uint64_t HexagonLDBackend::emitSectionData(const LDSection& pSection,
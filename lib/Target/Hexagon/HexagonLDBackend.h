@@ -31,6 +31,8 @@ public:
 
   ~HexagonLDBackend();
 
+  void reset();
+
   uint32_t machine() const;
 
   HexagonGOT& getGOT();
@@ -102,6 +104,9 @@ public:
                       Module& pModule,
                       LDSection& pSection);
 
+  /// preScanRelocation - update the addend. Hexagon reserves no entries yet.
+  bool preScanRelocation(Relocation& pReloc, const LDSection& pSection);
+
   OutputRelocSection& getRelDyn();
 
   const OutputRelocSection& getRelDyn() const;
@@ -113,6 +118,9 @@ public:
   /// getTargetSectionOrder - compute the layout order of Hexagon target section
   unsigned int getTargetSectionOrder(const LDSection& pSectHdr) const;
 
+  /// hasGPRelativeData - the small data is addressed relative to GP
+  bool hasGPRelativeData() const { return true; }
+
   /// finalizeTargetSymbols - finalize the symbol value
   bool finalizeTargetSymbols();
 
@@ -10,11 +10,16 @@
 #include <llvm/ADT/Twine.h>
 #include <llvm/Support/DataTypes.h>
 #include <llvm/Support/ELF.h>
+#include <mcld/LD/RelocationBatch.h>
 #include <mcld/Support/MsgHandling.h>
 
 #include "HexagonRelocator.h"
 #include "HexagonRelocationFunctions.h"
 
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 using namespace mcld;
 
 //===--------------------------------------------------------------------===//
@@ -39,6 +44,32 @@ static const ApplyFunctionTriple ApplyFunctions[] = {
   DECL_HEXAGON_APPLY_RELOC_FUNC_PTRS
 };
 
+// the kernels of the frequent relocations, which are inlined into the loops
+// of RelocationBatch
+struct HexagonB22PCRELKernel
+{
+  Relocator::Result operator()(Relocation& pReloc, HexagonRelocator& pParent)
+  { return relocB22PCREL(pReloc, pParent); }
+};
+
+struct HexagonLO16Kernel
+{
+  Relocator::Result operator()(Relocation& pReloc, HexagonRelocator& pParent)
+  { return relocLO16(pReloc, pParent); }
+};
+
+struct HexagonHI16Kernel
+{
+  Relocator::Result operator()(Relocation& pReloc, HexagonRelocator& pParent)
+  { return relocHI16(pReloc, pParent); }
+};
+
+struct Hexagon32Kernel
+{
+  Relocator::Result operator()(Relocation& pReloc, HexagonRelocator& pParent)
+  { return reloc32(pReloc, pParent); }
+};
+
 //===--------------------------------------------------------------------===//
 // HexagonRelocator
 //===--------------------------------------------------------------------===//
@@ -64,6 +95,41 @@ HexagonRelocator::applyRelocation(Relocation& pRelocation)
   return ApplyFunctions[type].func(pRelocation, *this);
 }
 
+bool HexagonRelocator::mayApplyConcurrently(const Relocation& pRelocation) const
+{
+  // no relocation consumes GOT, PLT or dynamic relocation entries
+  return (pRelocation.type() <
+          sizeof (ApplyFunctions) / sizeof (ApplyFunctions[0]));
+}
+
+void HexagonRelocator::applyBatch(Relocation* const* pRelocs,
+                                  Result* pResults,
+                                  size_t pNum)
+{
+  RelocationBatch batch(pRelocs, pNum);
+  RelocationBatch::run_iterator run, rEnd = batch.run_end();
+  for (run = batch.run_begin(); run != rEnd; ++run) {
+    assert(run->type < sizeof (ApplyFunctions) / sizeof (ApplyFunctions[0]));
+    switch (run->type) {
+      case llvm::ELF::R_HEX_B22_PCREL:
+        batch.apply(*run, HexagonB22PCRELKernel(), *this, pResults);
+        break;
+      case llvm::ELF::R_HEX_LO16:
+        batch.apply(*run, HexagonLO16Kernel(), *this, pResults);
+        break;
+      case llvm::ELF::R_HEX_HI16:
+        batch.apply(*run, HexagonHI16Kernel(), *this, pResults);
+        break;
+      case llvm::ELF::R_HEX_32:
+        batch.apply(*run, Hexagon32Kernel(), *this, pResults);
+        break;
+      default:
+        batch.apply(*run, ApplyFunctions[run->type].func, *this, pResults);
+        break;
+    }
+  }
+}
+
 const char* HexagonRelocator::getName(Relocation::Type pType) const
 {
   return ApplyFunctions[pType].name;
@@ -76,22 +142,77 @@ Relocator::Size HexagonRelocator::getSize(Relocation::Type pType) const
 //===--------------------------------------------------------------------===//
 // Relocation helper function
 //===--------------------------------------------------------------------===//
-template<typename T1, typename T2>
-T1 ApplyMask(T2 pMask, T1 pData) {
-  T1 result = 0;
-  size_t off = 0;
-
-  for (size_t bit = 0; bit != sizeof (T1) * 8; ++bit) {
-    const bool valBit = (pData >> off) & 1;
-    const bool maskBit = (pMask >> bit) & 1;
-    if (maskBit) {
-      result |= static_cast<T1>(valBit) << bit;
-      ++off;
-    }
+namespace {
+
+/// InstClass - the classes of the relocated fields, named as in the Hexagon
+/// ABI
+enum InstClass {
+  Word32,
+  Word32_B22,
+  Word32_B15,
+  Word32_B13,
+  Word32_B7,
+  Word32_LO,
+  Word16,
+  Word8,
+  NumOfInstClasses
+};
+
+/// FieldRun - a run of contiguous bits of a field. The bits of the value
+/// from bit src are put at bit dst of the instruction word.
+struct FieldRun
+{
+  uint8_t src;
+  uint8_t dst;
+  uint32_t bits;
+};
+
+/// FieldEncoding - the mask of a field and its runs from low to high. The
+/// runs take the bits of the value from low to high as well.
+struct FieldEncoding
+{
+  uint32_t mask;
+  unsigned int numOfRuns;
+  FieldRun runs[4];
+};
+
+const FieldEncoding Encodings[NumOfInstClasses] = {
+  /* Word32     */ { 0xffffffff, 1, { {  0,  0, 0xffffffff } } },
+  /* Word32_B22 */ { 0x01ff3ffe, 2, { {  0,  1, 0x00003ffe },
+                                      { 13, 16, 0x01ff0000 } } },
+  /* Word32_B15 */ { 0x00df20fe, 4, { {  0,  1, 0x000000fe },
+                                      {  7, 13, 0x00002000 },
+                                      {  8, 16, 0x001f0000 },
+                                      { 13, 22, 0x00c00000 } } },
+  /* Word32_B13 */ { 0x00202ffe, 3, { {  0,  1, 0x00000ffe },
+                                      { 11, 13, 0x00002000 },
+                                      { 12, 21, 0x00200000 } } },
+  /* Word32_B7  */ { 0x00001f18, 2, { {  0,  3, 0x00000018 },
+                                      {  2,  8, 0x00001f00 } } },
+  /* Word32_LO  */ { 0x00c03fff, 2, { {  0,  0, 0x00003fff },
+                                      { 14, 22, 0x00c00000 } } },
+  /* Word16     */ { 0x0000ffff, 1, { {  0,  0, 0x0000ffff } } },
+  /* Word8      */ { 0x000000ff, 1, { {  0,  0, 0x000000ff } } }
+};
+
+/// ApplyMask - scatter the low bits of pValue into the field of pClass
+inline uint32_t ApplyMask(InstClass pClass, uint32_t pValue)
+{
+  const FieldEncoding& encoding = Encodings[pClass];
+#if defined(__BMI2__)
+  return _pdep_u32(pValue, encoding.mask);
+#else
+  uint32_t result = 0x0;
+  for (unsigned int i = 0; i < encoding.numOfRuns; ++i) {
+    const FieldRun& run = encoding.runs[i];
+    result |= ((pValue >> run.src) << run.dst) & run.bits;
   }
   return result;
+#endif
 }
 
+} // anonymous namespace
+
 //=========================================//
 // Each relocation function implementation //
 //=========================================//
@@ -114,7 +235,7 @@ HexagonRelocator::Result relocB22PCREL(Relocation& pReloc,
   int32_t range = 1 << 21;
 
   if ( (result < range) && (result > -range)) {
-    pReloc.target() = pReloc.target() | ApplyMask(0x01ff3ffe, result);
+    pReloc.target() = pReloc.target() | ApplyMask(Word32_B22, result);
     return HexagonRelocator::OK;
   }
   return HexagonRelocator::Overflow;
@@ -131,7 +252,7 @@ HexagonRelocator::Result relocB15PCREL(Relocation& pReloc,
   int32_t result = (int32_t) ((S + A - P) >> 2);
   int32_t range = 1 << 14;
   if ( (result < range) && (result > -range)) {
-    pReloc.target() = pReloc.target() | ApplyMask(0x00df20fe,result);
+    pReloc.target() = pReloc.target() | ApplyMask(Word32_B15, result);
     return HexagonRelocator::OK;
   }
   return HexagonRelocator::Overflow;
@@ -148,7 +269,7 @@ HexagonRelocator::Result relocB7PCREL(Relocation& pReloc,
   int32_t result = (int32_t) ((S + A - P) >> 2);
   int32_t range = 1 << 6;
   if ( (result < range) && (result > -range)) {
-    pReloc.target() = pReloc.target() | ApplyMask(0x00001f18, result);
+    pReloc.target() = pReloc.target() | ApplyMask(Word32_B7, result);
     return HexagonRelocator::OK;
   }
   return HexagonRelocator::Overflow;
@@ -162,7 +283,7 @@ HexagonRelocator::Result relocLO16(Relocation& pReloc,
   HexagonRelocator::DWord   A = pReloc.addend();
 
   uint32_t result = (uint32_t) (S + A);
-  pReloc.target() = pReloc.target() | ApplyMask(0x00c03fff, result);
+  pReloc.target() = pReloc.target() | ApplyMask(Word32_LO, result);
   return HexagonRelocator::OK;
 }
 
@@ -174,7 +295,7 @@ HexagonRelocator::Result relocHI16(Relocation& pReloc,
   HexagonRelocator::DWord   A = pReloc.addend();
 
   uint32_t result = (uint32_t) ((S + A) >> 16);
-  pReloc.target() = pReloc.target() | ApplyMask(0x00c03fff, result);
+  pReloc.target() = pReloc.target() | ApplyMask(Word32_LO, result);
   return HexagonRelocator::OK;
 }
 
@@ -197,7 +318,7 @@ HexagonRelocator::Result reloc16(Relocation& pReloc, HexagonRelocator& pParent)
   HexagonRelocator::DWord S = pReloc.symValue();
 
   uint32_t result = (uint32_t) (S + A);
-  pReloc.target() = pReloc.target() | ApplyMask(0x0000ffff, result);
+  pReloc.target() = pReloc.target() | ApplyMask(Word16, result);
 
   return HexagonRelocator::OK;
 }
@@ -209,7 +330,7 @@ HexagonRelocator::Result reloc8(Relocation& pReloc, HexagonRelocator& pParent)
   HexagonRelocator::DWord S = pReloc.symValue();
 
   uint32_t result = (uint32_t) (S + A);
-  pReloc.target() = pReloc.target() | ApplyMask(0x000000ff, result);
+  pReloc.target() = pReloc.target() | ApplyMask(Word8, result);
 
   return HexagonRelocator::OK;
 }
@@ -225,7 +346,7 @@ HexagonRelocator::Result relocB13PCREL(Relocation& pReloc,
   int32_t result = ((S + A - P) >> 2);
   int32_t range = 1L << 12;
   if (result < range && result > -range) {
-    pReloc.target() = pReloc.target() | ApplyMask(0x00202ffe, result);
+    pReloc.target() = pReloc.target() | ApplyMask(Word32_B13, result);
     return HexagonRelocator::OK;
   }
   return HexagonRelocator::Overflow;
@@ -251,7 +372,7 @@ HexagonRelocator::Result reloc32PCREL(Relocation& pReloc,
   int32_t range = 1 << 31;
 
   if (result < range && result > -range)  {
-    pReloc.target() = pReloc.target() | ApplyMask(0xffffffff, result);
+    pReloc.target() = pReloc.target() | ApplyMask(Word32, result);
     return HexagonRelocator::OK;
   }
 
@@ -38,6 +38,13 @@ public:
 
   Result applyRelocation(Relocation& pRelocation);
 
+  /// mayApplyConcurrently - no Hexagon relocation consumes GOT, PLT or
+  /// dynamic relocation entries
+  bool mayApplyConcurrently(const Relocation& pRelocation) const;
+
+  /// applyBatch - apply the relocations of a batch by their types
+  void applyBatch(Relocation* const* pRelocs, Result* pResults, size_t pNum);
+
   HexagonLDBackend& getTarget()
   { return m_Target; }
 
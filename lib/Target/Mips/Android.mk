@@ -6,8 +6,10 @@ mcld_mips_target_SRC_FILES := \
   MipsELFMCLinker.cpp  \
   MipsEmulation.cpp \
   MipsGOT.cpp \
+  MipsGOTPLT.cpp \
   MipsLDBackend.cpp \
   MipsMCLinker.cpp \
+  MipsPLT.cpp \
   MipsRelocator.cpp \
   MipsTargetMachine.cpp
 
@@ -21,7 +21,8 @@ enum {
   MIPS_BASE_ADDRESS = 0x70000006,
   MIPS_LOCAL_GOTNO  = 0x7000000a,
   MIPS_SYMTABNO     = 0x70000011,
-  MIPS_GOTSYM       = 0x70000013
+  MIPS_GOTSYM       = 0x70000013,
+  MIPS_PLTGOT       = 0x70000032
 };
 
 MipsELFDynamic::MipsELFDynamic(const MipsGNULDBackend& pParent,
@@ -47,6 +48,10 @@ void MipsELFDynamic::reserveTargetEntries(const ELFFileFormat& pFormat)
   reserveOne(MIPS_LOCAL_GOTNO);
   reserveOne(MIPS_SYMTABNO);
   reserveOne(MIPS_GOTSYM);
+
+  // the .got.plt of the non-PIC ABI extensions
+  if (pFormat.hasGOTPLT())
+    reserveOne(MIPS_PLTGOT);
 }
 
 void MipsELFDynamic::applyTargetEntries(const ELFFileFormat& pFormat)
@@ -61,6 +66,9 @@ void MipsELFDynamic::applyTargetEntries(const ELFFileFormat& pFormat)
   applyOne(MIPS_LOCAL_GOTNO, getLocalGotNum(pFormat));
   applyOne(MIPS_SYMTABNO, getSymTabNum(pFormat));
   applyOne(MIPS_GOTSYM, getGotSym(pFormat));
+
+  if (pFormat.hasGOTPLT())
+    applyOne(MIPS_PLTGOT, pFormat.getGOTPLT().addr());
 }
 
 size_t MipsELFDynamic::getSymTabNum(const ELFFileFormat& pFormat) const
@@ -11,9 +11,12 @@
 
 #include <llvm/Support/Casting.h>
 
+#include <mcld/LD/LDSymbol.h>
 #include <mcld/LD/ResolveInfo.h>
+#include <mcld/MC/MCLDInput.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
 
 namespace {
   const size_t MipsGOT0Num = 1;
@@ -25,45 +28,27 @@ using namespace mcld;
 // MipsGOT
 //===----------------------------------------------------------------------===//
 MipsGOT::MipsGOT(LDSection& pSection)
-  : GOT(pSection),
-    m_pLocalNum(0),
-    m_pLast(NULL)
+  : GOT(pSection)
 {
   // Create GOT0 entries.
   reserve(MipsGOT0Num);
-
-  // Skip GOT0 entries.
-  iterator it = m_SectionData->begin();
-
-  for (size_t i = 1; i < MipsGOT0Num; ++i) {
-    assert((it != m_SectionData->end()) &&
-           "Generation of GOT0 entries is incomplete!");
-
-    ++it;
-  }
-
-  m_LocalGOTIterator = it;
-  m_GlobalGOTIterator = it;
-  m_pLocalNum = MipsGOT0Num;
 }
 
-void MipsGOT::reserve(size_t pNum)
+MipsGOT::~MipsGOT()
 {
-  for (size_t i = 0; i < pNum; i++) {
-    new MipsGOTEntry(0, m_SectionData);
-  }
+  for (GroupList::iterator group = m_Groups.begin(), gEnd = m_Groups.end();
+       group != gEnd; ++group)
+    delete *group;
+  for (PartList::iterator part = m_Parts.begin(), pEnd = m_Parts.end();
+       part != pEnd; ++part)
+    delete *part;
 }
 
-MipsGOTEntry* MipsGOT::consume()
+void MipsGOT::reserve(size_t pNum)
 {
-  if (NULL == m_pLast) {
-    assert(!empty() && "Consume empty GOT entry!");
-    m_pLast = llvm::cast<MipsGOTEntry>(&m_SectionData->front());
-    return m_pLast;
+  for (size_t i = 0; i < pNum; i++) {
+    m_Entries.push_back(new MipsGOTEntry(0, m_SectionData));
   }
-
-  m_pLast = llvm::cast<MipsGOTEntry>(m_pLast->getNextNode());
-  return m_pLast;
 }
 
 bool MipsGOT::hasGOT1() const
@@ -85,46 +70,267 @@ uint64_t MipsGOT::emit(MemoryRegion& pRegion)
   return result;
 }
 
-void MipsGOT::reserveLocalEntry()
+void MipsGOT::addFragment(const Fragment& pFrag, const Input& pInput)
+{
+  std::pair<llvm::DenseMap<const Input*, size_t>::iterator, bool> res =
+    m_InputGroups.insert(std::make_pair(&pInput, m_Groups.size()));
+  if (res.second) {
+    Group* group = new Group();
+    group->input = &pInput;
+    m_Groups.push_back(group);
+  }
+  m_FragGroups[&pFrag] = res.first->second;
+}
+
+MipsGOT::Group& MipsGOT::getGroup(const Fragment& pFrag)
+{
+  llvm::DenseMap<const Fragment*, size_t>::const_iterator group =
+                                                    m_FragGroups.find(&pFrag);
+  assert(m_FragGroups.end() != group && "The fragment is not scanned!");
+  return *m_Groups[group->second];
+}
+
+void MipsGOT::reservePageEntries(const Fragment& pFrag,
+                                 const void* pRange,
+                                 size_t pNum)
+{
+  getGroup(pFrag).pages.insert(std::make_pair(pRange, pNum));
+}
+
+void MipsGOT::reserveLocalEntry(const Fragment& pFrag,
+                                const ResolveInfo& pInfo)
+{
+  Group& group = getGroup(pFrag);
+  if (group.localSet.insert(&pInfo).second)
+    group.locals.push_back(const_cast<ResolveInfo*>(&pInfo));
+}
+
+void MipsGOT::reserveGlobalEntry(const Fragment& pFrag, ResolveInfo& pInfo)
+{
+  Group& group = getGroup(pFrag);
+  if (group.globalSet.insert(&pInfo).second)
+    group.globals.push_back(&pInfo);
+
+  if (m_GlobalSet.insert(&pInfo).second)
+    m_Globals.push_back(&pInfo);
+}
+
+size_t MipsGOT::costOf(const Group& pGroup,
+                       const Part& pPart,
+                       bool pIsPrimary) const
+{
+  size_t cost = 0;
+  for (RangeMap::const_iterator range = pGroup.pages.begin(),
+       rEnd = pGroup.pages.end(); range != rEnd; ++range) {
+    if (pPart.pages.end() == pPart.pages.find(range->first))
+      cost += range->second;
+  }
+
+  for (SymbolList::const_iterator sym = pGroup.locals.begin(),
+       sEnd = pGroup.locals.end(); sym != sEnd; ++sym) {
+    if (0 == pPart.localSet.count(*sym))
+      ++cost;
+  }
+
+  // the primary GOT has the entries of all global GOT symbols
+  if (!pIsPrimary) {
+    for (SymbolList::const_iterator sym = pGroup.globals.begin(),
+         sEnd = pGroup.globals.end(); sym != sEnd; ++sym) {
+      if (0 == pPart.globalSet.count(*sym))
+        ++cost;
+    }
+  }
+  return cost;
+}
+
+void MipsGOT::merge(const Group& pGroup, Part& pPart, bool pIsPrimary)
+{
+  pPart.size += costOf(pGroup, pPart, pIsPrimary);
+
+  for (RangeMap::const_iterator range = pGroup.pages.begin(),
+       rEnd = pGroup.pages.end(); range != rEnd; ++range) {
+    if (pPart.pages.insert(*range).second)
+      pPart.numOfPages += range->second;
+  }
+
+  for (SymbolList::const_iterator sym = pGroup.locals.begin(),
+       sEnd = pGroup.locals.end(); sym != sEnd; ++sym) {
+    if (pPart.localSet.insert(*sym).second)
+      pPart.locals.push_back(*sym);
+  }
+
+  if (!pIsPrimary) {
+    for (SymbolList::const_iterator sym = pGroup.globals.begin(),
+         sEnd = pGroup.globals.end(); sym != sEnd; ++sym) {
+      if (pPart.globalSet.insert(*sym).second)
+        pPart.globals.push_back(*sym);
+    }
+  }
+}
+
+void MipsGOT::finalizeScanning()
+{
+  assert(m_Parts.empty() && "The GOT is finalized twice!");
+
+  // the primary GOT
+  Part* part = new Part();
+  part->size = MipsGOT0Num + m_Globals.size();
+  part->globals = m_Globals;
+  if (part->size > MaxNumOfEntries)
+    fatal(diag::mips_global_got_overflow) << m_Globals.size();
+  m_Parts.push_back(part);
+
+  // put the groups into the GOTs in the order of the inputs
+  m_GroupParts.resize(m_Groups.size());
+  for (size_t i = 0; i < m_Groups.size(); ++i) {
+    bool is_primary = (1 == m_Parts.size());
+    if (part->size + costOf(*m_Groups[i], *part, is_primary) >
+        MaxNumOfEntries) {
+      part = new Part();
+      m_Parts.push_back(part);
+      is_primary = false;
+      if (costOf(*m_Groups[i], *part, is_primary) > MaxNumOfEntries)
+        fatal(diag::mips_got_overflow) << m_Groups[i]->input->name();
+    }
+    merge(*m_Groups[i], *part, is_primary);
+    m_GroupParts[i] = m_Parts.size() - 1;
+  }
+
+  for (size_t i = 0; i < m_Parts.size(); ++i)
+    createEntries(*m_Parts[i], (0 == i));
+}
+
+void MipsGOT::createEntries(Part& pPart, bool pIsPrimary)
+{
+  // the primary GOT begins with GOT0
+  pPart.first = pIsPrimary ? 0 : m_Entries.size();
+  pPart.nextPage = m_Entries.size();
+  reserve(pPart.numOfPages);
+  pPart.endOfPages = m_Entries.size();
+
+  SymbolList::const_iterator sym, sEnd = pPart.locals.end();
+  for (sym = pPart.locals.begin(); sym != sEnd; ++sym) {
+    reserve(1);
+    pPart.symEntries[*sym] = m_Entries.back();
+  }
+
+  sEnd = pPart.globals.end();
+  for (sym = pPart.globals.begin(); sym != sEnd; ++sym) {
+    reserve(1);
+    pPart.symEntries[*sym] = m_Entries.back();
+  }
+  assert(m_Entries.size() - pPart.first == pPart.size &&
+         "The number of GOT entries is miscounted!");
+}
+
+MipsGOT::Part& MipsGOT::getPart(const Fragment& pFrag)
+{
+  assert(!m_Parts.empty() && "The GOT is not finalized!");
+  llvm::DenseMap<const Fragment*, size_t>::const_iterator group =
+                                                    m_FragGroups.find(&pFrag);
+  // the relocations not scanned use the primary GOT
+  if (m_FragGroups.end() == group)
+    return *m_Parts.front();
+  return *m_Parts[m_GroupParts[group->second]];
+}
+
+const MipsGOT::Part& MipsGOT::getPart(const Fragment& pFrag) const
+{
+  return const_cast<MipsGOT*>(this)->getPart(pFrag);
+}
+
+uint64_t MipsGOT::getGPAddr(const Fragment& pFrag) const
 {
-  reserve(1);
-  ++m_pLocalNum;
+  if (m_Parts.empty())
+    return addr() + 0x7FF0;
+  return addr() + getPart(pFrag).first * MipsGOTEntry::EntrySize + 0x7FF0;
+}
+
+MipsGOTEntry* MipsGOT::getPageEntry(const Fragment& pFrag, uint64_t pPage)
+{
+  Part& part = getPart(pFrag);
+  MipsGOTEntry*& entry = part.pageEntries[pPage];
+  if (NULL == entry) {
+    if (part.endOfPages == part.nextPage) {
+      part.pageEntries.erase(pPage);
+      return NULL;
+    }
+    entry = m_Entries[part.nextPage++];
+    entry->setValue(pPage);
+  }
+  return entry;
+}
 
-  // Move global entries iterator forward.
-  // We need to put global GOT entries after all local ones.
-  ++m_GlobalGOTIterator;
+MipsGOTEntry* MipsGOT::getLocalEntry(const Fragment& pFrag,
+                                     const ResolveInfo& pInfo)
+{
+  Part& part = getPart(pFrag);
+  llvm::DenseMap<const ResolveInfo*, MipsGOTEntry*>::iterator entry =
+                                                 part.symEntries.find(&pInfo);
+  if (part.symEntries.end() == entry)
+    return NULL;
+  return entry->second;
 }
 
-void MipsGOT::reserveGlobalEntry()
+MipsGOTEntry* MipsGOT::getGlobalEntry(const Fragment& pFrag,
+                                      const ResolveInfo& pInfo)
 {
-  reserve(1);
+  return getLocalEntry(pFrag, pInfo);
 }
 
-MipsGOTEntry* MipsGOT::consumeLocal()
+namespace {
+
+/// GlobalValueSetter - the body of parallel_for to set the i-th global entry
+/// of a GOT part
+template<typename PartType>
+struct GlobalValueSetter
+{
+  PartType* part;
+
+  void operator()(size_t pIdx) {
+    // lookup() never inserts, so the map may be read concurrently
+    const ResolveInfo* sym = part->globals[pIdx];
+    MipsGOTEntry* entry = part->symEntries.lookup(sym);
+    if (NULL != entry && NULL != sym->outSymbol())
+      entry->setValue(sym->outSymbol()->value());
+  }
+};
+
+} // anonymous namespace
+
+void MipsGOT::setGlobalValues(ThreadPool& pPool)
 {
-  iterator& it = m_LocalGOTIterator;
-  ++it;
-  assert(it != m_SectionData->getFragmentList().end() &&
-         "The number of GOT Entries and ResolveInfo doesn't match");
-  return llvm::cast<MipsGOTEntry>(&(*it));
+  if (m_Parts.empty())
+    return;
+
+  GlobalValueSetter<Part> setter = { m_Parts.front() };
+  parallel_for(pPool, 0, setter.part->globals.size(), setter, 1024);
 }
 
-MipsGOTEntry* MipsGOT::consumeGlobal()
+void MipsGOT::getSecondaryGlobals(GlobalEntryList& pEntries) const
 {
-  iterator& it = m_GlobalGOTIterator;
-  ++it;
-  assert(it != m_SectionData->getFragmentList().end() &&
-         "The number of GOT Entries and ResolveInfo doesn't match");
-  return llvm::cast<MipsGOTEntry>(&(*it));
+  pEntries.clear();
+  for (size_t i = 1; i < m_Parts.size(); ++i) {
+    const Part& part = *m_Parts[i];
+    SymbolList::const_iterator sym, sEnd = part.globals.end();
+    for (sym = part.globals.begin(); sym != sEnd; ++sym) {
+      MipsGOTEntry* entry = part.symEntries.lookup(*sym);
+      pEntries.push_back(std::make_pair(entry, *sym));
+    }
+  }
 }
 
 size_t MipsGOT::getTotalNum() const
 {
-  return m_SectionData->getFragmentList().size();
+  if (m_Parts.empty())
+    return m_Entries.size();
+  return m_Parts.front()->size;
 }
 
 size_t MipsGOT::getLocalNum() const
 {
-  return m_pLocalNum;
+  if (m_Parts.empty())
+    return MipsGOT0Num;
+  return getTotalNum() - m_Globals.size();
 }
 
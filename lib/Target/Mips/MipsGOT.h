@@ -13,13 +13,19 @@
 #endif
 
 #include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
 
 #include <mcld/Target/GOT.h>
 
+#include <vector>
+
 namespace mcld
 {
+class Fragment;
+class Input;
 class LDSection;
 class MemoryRegion;
+class ThreadPool;
 
 /** \class MipsGOTEntry
  *  \brief GOT Entry with size of 4 bytes
@@ -34,24 +40,91 @@ public:
 
 /** \class MipsGOT
  *  \brief Mips Global Offset Table.
+ *
+ *  A GOT entry is reached by a signed 16-bit offset from $gp, so one GOT
+ *  holds at most MaxNumOfEntries entries. The .got section of a large link
+ *  is cut into several GOTs, each of which has its own $gp. The relocations
+ *  of one input object use the same GOT, which is chosen when scanning is
+ *  done. The first GOT is the primary one, which holds GOT0 and the global
+ *  entries of all the global GOT symbols, as the dynamic linker expects.
+ *  The global entries of the other GOTs are set by R_MIPS_REL32.
+ *
+ *  The local entries of GOT16 and GOT_PAGE relocations hold the 64 KiB
+ *  pages of the local addresses, and a page entry is shared by all the
+ *  addresses near it. Since the addresses are not known while scanning, a
+ *  GOT reserves enough page entries to cover the sections referred to, and
+ *  the pages are looked up in a hash table when applying.
  */
 class MipsGOT : public GOT
 {
+public:
+  typedef std::vector<std::pair<MipsGOTEntry*, ResolveInfo*> >
+                                                              GlobalEntryList;
+
+  enum {
+    /// MaxNumOfEntries - $gp is 0x7FF0 past the beginning of a GOT
+    MaxNumOfEntries = (0x7FF0 + 0x8000) / 4
+  };
+
 public:
   MipsGOT(LDSection& pSection);
 
+  ~MipsGOT();
+
   uint64_t emit(MemoryRegion& pRegion);
 
   void reserve(size_t pNum = 1);
-  void reserveLocalEntry();
-  void reserveGlobalEntry();
 
+  // -----  scanning  ----- //
+  /// addFragment - the relocations of pFrag belong to pInput
+  void addFragment(const Fragment& pFrag, const Input& pInput);
+
+  /// reservePageEntries - reserve pNum page entries for the relocations of
+  /// pFrag to the local addresses in pRange. The relocations of an input to
+  /// the same range share the entries.
+  void reservePageEntries(const Fragment& pFrag,
+                          const void* pRange,
+                          size_t pNum);
+
+  /// reserveLocalEntry - reserve the entry of local symbol pInfo
+  void reserveLocalEntry(const Fragment& pFrag, const ResolveInfo& pInfo);
+
+  /// reserveGlobalEntry - reserve the entry of global symbol pInfo
+  void reserveGlobalEntry(const Fragment& pFrag, ResolveInfo& pInfo);
+
+  /// finalizeScanning - cut the .got section into GOTs and create the
+  /// entries. It is called once the relocations are scanned.
+  void finalizeScanning();
+
+  // -----  applying  ----- //
+  /// getGPAddr - the $gp value of the relocations of pFrag
+  uint64_t getGPAddr(const Fragment& pFrag) const;
+
+  /// getPageEntry - the entry of the page pPage in the GOT of pFrag
+  /// @return NULL if all the page entries are used
+  MipsGOTEntry* getPageEntry(const Fragment& pFrag, uint64_t pPage);
+
+  /// getLocalEntry - the entry of local symbol pInfo in the GOT of pFrag
+  MipsGOTEntry* getLocalEntry(const Fragment& pFrag, const ResolveInfo& pInfo);
+
+  /// getGlobalEntry - the entry of global symbol pInfo in the GOT of pFrag
+  MipsGOTEntry* getGlobalEntry(const Fragment& pFrag,
+                               const ResolveInfo& pInfo);
+
+  /// setGlobalValues - set the global entries of the primary GOT to the
+  /// values of their symbols. The entries are set in parallel by pPool.
+  void setGlobalValues(ThreadPool& pPool);
+
+  /// getSecondaryGlobals - the global entries out of the primary GOT, which
+  /// need R_MIPS_REL32, and their symbols
+  void getSecondaryGlobals(GlobalEntryList& pEntries) const;
+
+  /// getTotalNum - the number of the entries of the primary GOT
   size_t getTotalNum() const;
-  size_t getLocalNum() const;
 
-  MipsGOTEntry* consume();
-  MipsGOTEntry* consumeLocal();
-  MipsGOTEntry* consumeGlobal();
+  /// getLocalNum - the number of the local entries of the primary GOT,
+  /// including GOT0
+  size_t getLocalNum() const;
 
   void setLocal(const ResolveInfo* pInfo) {
     m_GOTTypeMap[pInfo] = false;
@@ -75,14 +148,84 @@ public:
 private:
   typedef llvm::DenseMap<const ResolveInfo*, bool> SymbolTypeMapType;
 
+  typedef llvm::DenseMap<const void*, size_t> RangeMap;
+  typedef llvm::DenseSet<const ResolveInfo*> SymbolSet;
+  typedef std::vector<ResolveInfo*> SymbolList;
+
+  /// Group - what the relocations of an input need
+  struct Group
+  {
+    const Input* input;
+    RangeMap pages;
+    SymbolSet localSet;
+    SymbolList locals;
+    SymbolSet globalSet;
+    SymbolList globals;
+  };
+
+  /// Part - one GOT of the .got section
+  struct Part
+  {
+    Part() : first(0), size(0), numOfPages(0), nextPage(0), endOfPages(0) { }
+
+    /// first - the index of the first entry in the .got section
+    size_t first;
+
+    /// size - the number of the entries
+    size_t size;
+
+    RangeMap pages;
+    size_t numOfPages;
+    SymbolSet localSet;
+    SymbolList locals;
+    SymbolSet globalSet;
+    SymbolList globals;
+
+    /// nextPage - the index of the next free page entry
+    size_t nextPage;
+    size_t endOfPages;
+    llvm::DenseMap<uint64_t, MipsGOTEntry*> pageEntries;
+    llvm::DenseMap<const ResolveInfo*, MipsGOTEntry*> symEntries;
+  };
+
+  typedef std::vector<Group*> GroupList;
+  typedef std::vector<Part*> PartList;
+
+private:
+  /// getGroup - the group of the relocations of pFrag
+  Group& getGroup(const Fragment& pFrag);
+
+  /// getPart - the GOT of the relocations of pFrag
+  Part& getPart(const Fragment& pFrag);
+  const Part& getPart(const Fragment& pFrag) const;
+
+  /// costOf - the number of the entries which pGroup adds to pPart
+  size_t costOf(const Group& pGroup, const Part& pPart, bool pIsPrimary) const;
+
+  /// merge - put pGroup into pPart
+  void merge(const Group& pGroup, Part& pPart, bool pIsPrimary);
+
+  /// createEntries - create the entries of pPart
+  void createEntries(Part& pPart, bool pIsPrimary);
+
 private:
   SymbolTypeMapType m_GOTTypeMap;
 
-  iterator m_LocalGOTIterator;  // last local GOT entries
-  iterator m_GlobalGOTIterator; // last global GOT entries
-  size_t m_pLocalNum;
+  /// m_Entries - all the entries in the order of the .got section
+  std::vector<MipsGOTEntry*> m_Entries;
+
+  /// m_Globals - the global GOT symbols in the order of .dynsym
+  SymbolSet m_GlobalSet;
+  SymbolList m_Globals;
+
+  GroupList m_Groups;
+  llvm::DenseMap<const Input*, size_t> m_InputGroups;
+  llvm::DenseMap<const Fragment*, size_t> m_FragGroups;
+
+  PartList m_Parts;
 
-  MipsGOTEntry* m_pLast; ///< the last consumed entry
+  /// m_GroupParts - the index of the part of every group
+  std::vector<size_t> m_GroupParts;
 };
 
 } // namespace of mcld
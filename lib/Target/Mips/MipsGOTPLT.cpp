@@ -0,0 +1,75 @@
+//===- MipsGOTPLT.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "MipsGOTPLT.h"
+
+#include <llvm/Support/Casting.h>
+
+#include <mcld/LD/LDSection.h>
+#include <mcld/Support/MemoryRegion.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// MipsGOTPLT
+//===----------------------------------------------------------------------===//
+MipsGOTPLT::MipsGOTPLT(LDSection& pSection)
+  : GOT(pSection)
+{
+  // Create GOT0 entries, and skip them
+  reserve(MipsGOTPLT0Num);
+  m_Last = m_SectionData->begin();
+  for (size_t i = 1; i < MipsGOTPLT0Num; ++i)
+    ++m_Last;
+}
+
+MipsGOTPLT::~MipsGOTPLT()
+{
+}
+
+uint64_t MipsGOTPLT::emit(MemoryRegion& pRegion)
+{
+  uint32_t* buffer = reinterpret_cast<uint32_t*>(pRegion.getBuffer());
+
+  uint64_t result = 0;
+  for (iterator it = begin(), ie = end(); it != ie; ++it, ++buffer) {
+    MipsGOTEntry* entry = &(llvm::cast<MipsGOTEntry>((*it)));
+    *buffer = static_cast<uint32_t>(entry->getValue());
+    result += entry->size();
+  }
+  return result;
+}
+
+void MipsGOTPLT::reserve(size_t pNum)
+{
+  for (size_t i = 0; i < pNum; ++i)
+    new MipsGOTEntry(0, m_SectionData);
+}
+
+MipsGOTEntry* MipsGOTPLT::consume()
+{
+  ++m_Last;
+  assert(m_Last != m_SectionData->end() &&
+         "The number of GOTPLT entries and PLT entries doesn't match");
+  return &(llvm::cast<MipsGOTEntry>(*m_Last));
+}
+
+bool MipsGOTPLT::hasGOT1() const
+{
+  return (m_SectionData->size() > MipsGOTPLT0Num);
+}
+
+void MipsGOTPLT::applyAllGOTPLT(uint64_t pPLT0Addr)
+{
+  iterator it = begin(), ie = end();
+  for (size_t i = 0; i < MipsGOTPLT0Num && it != ie; ++i)
+    ++it;
+  for (; it != ie; ++it)
+    llvm::cast<MipsGOTEntry>(*it).setValue(pPLT0Addr);
+}
+
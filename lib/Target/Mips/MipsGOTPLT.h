@@ -0,0 +1,61 @@
+//===- MipsGOTPLT.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_MIPS_GOTPLT_H
+#define MCLD_MIPS_GOTPLT_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Target/GOT.h>
+
+#include "MipsGOT.h"
+
+namespace mcld {
+
+class LDSection;
+class MemoryRegion;
+
+const unsigned int MipsGOTPLT0Num = 2;
+
+/** \class MipsGOTPLT
+ *  \brief Mips .got.plt section of the non-PIC ABI extensions.
+ *
+ *  The first two entries are set by the dynamic linker to the address of
+ *  the lazy resolver and the link map. The other entries are the ones of
+ *  the PLT1 entries, in the same order, and point to PLT0 until they are
+ *  bound.
+ */
+class MipsGOTPLT : public GOT
+{
+public:
+  MipsGOTPLT(LDSection& pSection);
+
+  ~MipsGOTPLT();
+
+  uint64_t emit(MemoryRegion& pRegion);
+
+  void reserve(size_t pNum = 1);
+
+  MipsGOTEntry* consume();
+
+  // hasGOT1 - return if this section has any GOT1 entry
+  bool hasGOT1() const;
+
+  /// applyAllGOTPLT - point the entries to PLT0 at pPLT0Addr
+  void applyAllGOTPLT(uint64_t pPLT0Addr);
+
+private:
+  // m_Last - the last consumed entry
+  iterator m_Last;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -20,6 +20,9 @@
 #include <mcld/IRBuilder.h>
 #include <mcld/MC/Attribute.h>
 #include <mcld/Fragment/FillFragment.h>
+#include <mcld/LD/CommonBuckets.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/MC/MCLDInput.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MsgHandling.h>
@@ -37,7 +40,10 @@ MipsGNULDBackend::MipsGNULDBackend(const LinkerConfig& pConfig,
   : GNULDBackend(pConfig, pInfo),
     m_pRelocator(NULL),
     m_pGOT(NULL),
+    m_pPLT(NULL),
+    m_pGOTPLT(NULL),
     m_pRelDyn(NULL),
+    m_pRelPLT(NULL),
     m_pDynamic(NULL),
     m_pGOTSymbol(NULL),
     m_pGpDispSymbol(NULL)
@@ -48,10 +54,37 @@ MipsGNULDBackend::~MipsGNULDBackend()
 {
   delete m_pRelocator;
   delete m_pGOT;
+  delete m_pPLT;
+  delete m_pGOTPLT;
   delete m_pRelDyn;
+  delete m_pRelPLT;
   delete m_pDynamic;
 }
 
+void MipsGNULDBackend::reset()
+{
+  delete m_pRelocator;
+  m_pRelocator = NULL;
+  delete m_pGOT;
+  m_pGOT = NULL;
+  delete m_pPLT;
+  m_pPLT = NULL;
+  delete m_pGOTPLT;
+  m_pGOTPLT = NULL;
+  delete m_pRelDyn;
+  m_pRelDyn = NULL;
+  delete m_pRelPLT;
+  m_pRelPLT = NULL;
+  delete m_pDynamic;
+  m_pDynamic = NULL;
+  m_pGOTSymbol = NULL;
+  m_pGpDispSymbol = NULL;
+  m_GlobalGOTSyms.clear();
+  m_SymPLTMap = SymbolEntryMap<MipsPLT1>();
+  m_RelocInputs.clear();
+  GNULDBackend::reset();
+}
+
 void MipsGNULDBackend::initTargetSections(Module& pModule, ObjectBuilder& pBuilder)
 {
   if (LinkerConfig::Object != config().codeGenType()) {
@@ -61,9 +94,19 @@ void MipsGNULDBackend::initTargetSections(Module& pModule, ObjectBuilder& pBuild
     LDSection& got = file_format->getGOT();
     m_pGOT = new MipsGOT(got);
 
+    // initialize .got.plt and .plt
+    LDSection& gotplt = file_format->getGOTPLT();
+    m_pGOTPLT = new MipsGOTPLT(gotplt);
+    LDSection& plt = file_format->getPLT();
+    m_pPLT = new MipsPLT(plt, *m_pGOTPLT);
+
     // initialize .rel.dyn
     LDSection& reldyn = file_format->getRelDyn();
     m_pRelDyn = new OutputRelocSection(pModule, reldyn);
+
+    // initialize .rel.plt
+    LDSection& relplt = file_format->getRelPlt();
+    m_pRelPLT = new OutputRelocSection(pModule, relplt);
   }
 }
 
@@ -110,29 +153,39 @@ Relocator* MipsGNULDBackend::getRelocator()
   return m_pRelocator;
 }
 
-void MipsGNULDBackend::scanRelocation(Relocation& pReloc,
-                                      IRBuilder& pBuilder,
-                                      Module& pModule,
-                                      LDSection& pSection)
+bool MipsGNULDBackend::preScanRelocation(Relocation& pReloc,
+                                         const LDSection& pSection)
 {
-  // rsym - The relocation target symbol
-  ResolveInfo* rsym = pReloc.symInfo();
-  assert(NULL != rsym && "ResolveInfo of relocation not set while scanRelocation");
+  assert(NULL != pReloc.symInfo() &&
+         "ResolveInfo of relocation not set while preScanRelocation");
 
   // Skip relocation against _gp_disp
   if (NULL != m_pGpDispSymbol) {
     if (pReloc.symInfo() == m_pGpDispSymbol->resolveInfo())
-      return;
+      return false;
   }
 
   pReloc.updateAddend();
 
   assert(NULL != pSection.getLink());
-  if (0 == (pSection.getLink()->flag() & llvm::ELF::SHF_ALLOC))
-    return;
+  return (0 != (pSection.getLink()->flag() & llvm::ELF::SHF_ALLOC));
+}
+
+void MipsGNULDBackend::scanRelocation(Relocation& pReloc,
+                                      IRBuilder& pBuilder,
+                                      Module& pModule,
+                                      LDSection& pSection)
+{
+  // rsym - The relocation target symbol
+  ResolveInfo* rsym = pReloc.symInfo();
+
+  // the relocations of an input share a GOT
+  m_pGOT->addFragment(*pReloc.targetRef().frag(), getInput(pModule, pSection));
 
   // We test isLocal or if pInputSym is not a dynamic symbol
-  // We assume -Bsymbolic to bind all symbols internaly via !rsym->isDyn()
+  // The symbols defined in the output are always bound internally via
+  // !rsym->isDyn(), as if -Bsymbolic was given, so -Bsymbolic and
+  // -Bsymbolic-functions need nothing more here.
   // Don't put undef symbols into local entries.
   if ((rsym->isLocal() || !isDynamicSymbol(*rsym) ||
       !rsym->isDyn()) && !rsym->isUndef())
@@ -143,7 +196,41 @@ void MipsGNULDBackend::scanRelocation(Relocation& pReloc,
   // check if we shoule issue undefined reference for the relocation target
   // symbol
   if (rsym->isUndef() && !rsym->isDyn() && !rsym->isWeak() && !rsym->isNull())
-    fatal(diag::undefined_reference) << rsym->name();
+    issueUndefRef(pReloc, pSection, pModule);
+}
+
+/// getInput - the input of relocation section pSection
+const Input& MipsGNULDBackend::getInput(Module& pModule,
+                                        const LDSection& pSection)
+{
+  if (m_RelocInputs.empty()) {
+    Module::obj_iterator input, inEnd = pModule.obj_end();
+    for (input = pModule.obj_begin(); input != inEnd; ++input) {
+      LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+      for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs)
+        m_RelocInputs[*rs] = *input;
+    }
+  }
+  assert(0 != m_RelocInputs.count(&pSection) && "Unknown relocation section!");
+  return *m_RelocInputs[&pSection];
+}
+
+/// reservePageEntries - reserve the GOT page entries of pReloc, enough for
+/// the addresses in the section of its symbol
+void MipsGNULDBackend::reservePageEntries(const Relocation& pReloc)
+{
+  const ResolveInfo* rsym = pReloc.symInfo();
+  const Fragment& frag = *pReloc.targetRef().frag();
+  const LDSymbol* sym = rsym->outSymbol();
+  if (NULL == sym || !sym->hasFragRef()) {
+    // an absolute address is in one page
+    m_pGOT->reservePageEntries(frag, rsym, 1);
+    return;
+  }
+
+  // A range of N bytes covers at most (N / 64K) + 1 pages, rounded up.
+  const LDSection& sect = sym->fragRef()->frag()->getParent()->getSection();
+  m_pGOT->reservePageEntries(frag, &sect, ((sect.size() + 0xFFFF) >> 16) + 1);
 }
 
 void MipsGNULDBackend::doPreLayout(IRBuilder& pBuilder)
@@ -155,6 +242,29 @@ void MipsGNULDBackend::doPreLayout(IRBuilder& pBuilder)
   // set .got size
   // when building shared object, the .got section is must.
   if (LinkerConfig::Object != config().codeGenType()) {
+    // Make sure the global GOT symbols are dynamic symbols. If not,
+    // something is wrong earlier when putting them into the global GOT.
+    GlobalGOTSymMap::const_iterator sym, sEnd = m_GlobalGOTSyms.end();
+    for (sym = m_GlobalGOTSyms.begin(); sym != sEnd; ++sym) {
+      if (!isDynamicSymbol(*sym->first))
+        fatal(diag::mips_got_symbol) << sym->first->name();
+    }
+
+    m_pGOT->finalizeScanning();
+
+    // the global entries out of the primary GOT are set by the dynamic
+    // linker
+    MipsGOT::GlobalEntryList globals;
+    m_pGOT->getSecondaryGlobals(globals);
+    m_pRelDyn->reserveEntry(globals.size());
+    MipsGOT::GlobalEntryList::iterator entry, eEnd = globals.end();
+    for (entry = globals.begin(); entry != eEnd; ++entry) {
+      Relocation& rel_entry = *m_pRelDyn->consumeEntry();
+      rel_entry.setType(llvm::ELF::R_MIPS_REL32);
+      rel_entry.targetRef().assign(*entry->first);
+      rel_entry.setSymInfo(entry->second);
+    }
+
     if (LinkerConfig::DynObj == config().codeGenType() ||
         m_pGOT->hasGOT1() ||
         NULL != m_pGOTSymbol) {
@@ -162,6 +272,12 @@ void MipsGNULDBackend::doPreLayout(IRBuilder& pBuilder)
       defineGOTSymbol(pBuilder);
     }
 
+    // set .plt and .got.plt size
+    if (m_pPLT->hasPLT1()) {
+      m_pPLT->finalizeSectionSize();
+      m_pGOTPLT->finalizeSectionSize();
+    }
+
     ELFFileFormat* file_format = getOutputFormat();
     // set .rel.dyn size
     if (!m_pRelDyn->empty()) {
@@ -170,11 +286,25 @@ void MipsGNULDBackend::doPreLayout(IRBuilder& pBuilder)
       file_format->getRelDyn().setSize(
                                   m_pRelDyn->numOfRelocs() * getRelEntrySize());
     }
+
+    // set .rel.plt size
+    if (!m_pRelPLT->empty()) {
+      assert(!config().isCodeStatic() &&
+            "static linkage should not result in a dynamic relocation section");
+      file_format->getRelPlt().setSize(
+                                  m_pRelPLT->numOfRelocs() * getRelEntrySize());
+    }
   }
 }
 
 void MipsGNULDBackend::doPostLayout(Module& pModule, IRBuilder& pBuilder)
 {
+  // apply PLT
+  if (getOutputFormat()->hasPLT()) {
+    assert(NULL != m_pPLT);
+    m_pPLT->applyPLT0();
+    m_pPLT->applyPLT1();
+  }
 }
 
 /// dynamic - the dynamic section of the target machine.
@@ -206,368 +336,43 @@ uint64_t MipsGNULDBackend::emitSectionData(const LDSection& pSection,
     return result;
   }
 
+  if (&pSection == &(file_format->getPLT())) {
+    assert(NULL != m_pPLT && "emitSectionData failed, m_pPLT is NULL!");
+    return m_pPLT->emit(pRegion);
+  }
+
+  if (&pSection == &(file_format->getGOTPLT())) {
+    assert(NULL != m_pGOTPLT && "emitSectionData failed, m_pGOTPLT is NULL!");
+    return m_pGOTPLT->emit(pRegion);
+  }
+
   fatal(diag::unrecognized_output_sectoin)
           << pSection.name()
           << "mclinker@googlegroups.com";
   return 0;
 }
-/// isGlobalGOTSymbol - return true if the symbol is the global GOT entry.
-bool MipsGNULDBackend::isGlobalGOTSymbol(const LDSymbol& pSymbol) const
-{
-  return std::find(m_GlobalGOTSyms.begin(),
-                   m_GlobalGOTSyms.end(), &pSymbol) != m_GlobalGOTSyms.end();
-}
-
-/// sizeNamePools - compute the size of regular name pools
-/// In ELF executable files, regular name pools are .symtab, .strtab,
-/// .dynsym, .dynstr, .hash and .shstrtab.
-void
-MipsGNULDBackend::sizeNamePools(Module& pModule, bool pIsStaticLink)
-{
-  // number of entries in symbol tables starts from 1 to hold the special entry
-  // at index 0 (STN_UNDEF). See ELF Spec Book I, p1-21.
-  size_t symtab = 1;
-  size_t dynsym = pIsStaticLink ? 0 : 1;
-
-  // size of string tables starts from 1 to hold the null character in their
-  // first byte
-  size_t strtab = 1;
-  size_t dynstr = pIsStaticLink ? 0 : 1;
-  size_t shstrtab = 1;
-  size_t hash   = 0;
-
-  // number of local symbol in the .dynsym
-  size_t symtab_local_cnt = 0;
-  size_t dynsym_local_cnt = 0;
-
-  const Module::SymbolTable& symbols = pModule.getSymbolTable();
-  Module::const_sym_iterator symbol, symEnd;
-  /// Compute the size of .symtab, .strtab, and symtab_local_cnt
-  /// @{
-  symEnd = symbols.end();
-  for (symbol = symbols.begin(); symbol != symEnd; ++symbol) {
-    ++symtab;
-    if (ResolveInfo::Section != (*symbol)->type() ||
-        *symbol == m_pGpDispSymbol)
-      strtab += (*symbol)->nameSize() + 1;
-  }
-  symtab_local_cnt = 1 + symbols.numOfFiles() + symbols.numOfLocals() +
-                     symbols.numOfLocalDyns();
-  /// @}
-
-  /// Compute the size of .dynsym, .dynstr, and dynsym_local_cnt
-  /// @{
-  if (!pIsStaticLink) {
-    symEnd = symbols.dynamicEnd();
-    for (symbol = symbols.localDynBegin(); symbol != symEnd; ++symbol) {
-      ++dynsym;
-      if (ResolveInfo::Section != (*symbol)->type() ||
-          *symbol == m_pGpDispSymbol)
-        dynstr += (*symbol)->nameSize() + 1;
-    }
-    dynsym_local_cnt = 1 + symbols.numOfLocalDyns();
-  }
-  /// @}
-
-  ELFFileFormat* file_format = getOutputFormat();
-
-  switch(config().codeGenType()) {
-    // compute size of .dynstr and .hash
-    case LinkerConfig::DynObj: {
-      // soname
-      if (!pIsStaticLink)
-        dynstr += pModule.name().size() + 1;
-    }
-    /** fall through **/
-    case LinkerConfig::Exec: {
-      // add DT_NEED strings into .dynstr and .dynamic
-      // Rules:
-      //   1. ignore --no-add-needed
-      //   2. force count in --no-as-needed
-      //   3. judge --as-needed
-      if (!pIsStaticLink) {
-        Module::const_lib_iterator lib, libEnd = pModule.lib_end();
-        for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
-          // --add-needed
-          if ((*lib)->attribute()->isAddNeeded()) {
-            // --no-as-needed
-            if (!(*lib)->attribute()->isAsNeeded()) {
-              dynstr += (*lib)->name().size() + 1;
-              dynamic().reserveNeedEntry();
-            }
-            // --as-needed
-            else if ((*lib)->isNeeded()) {
-              dynstr += (*lib)->name().size() + 1;
-              dynamic().reserveNeedEntry();
-            }
-          }
-        }
-
-        if (!config().options().getRpathList().empty()) {
-          dynamic().reserveNeedEntry();
-          GeneralOptions::const_rpath_iterator rpath,
-            rpathEnd = config().options().rpath_end();
-          for (rpath = config().options().rpath_begin();
-               rpath != rpathEnd; ++rpath)
-            dynstr += (*rpath).size() + 1;
-        }
-
-        // compute .hash
-        // Both Elf32_Word and Elf64_Word are 4 bytes
-        hash = (2 + getHashBucketCount(dynsym, false) + dynsym) *
-               sizeof(llvm::ELF::Elf32_Word);
-      }
-
-      // set size
-      if (config().targets().is32Bits())
-        file_format->getDynSymTab().setSize(dynsym*sizeof(llvm::ELF::Elf32_Sym));
-      else
-        file_format->getDynSymTab().setSize(dynsym*sizeof(llvm::ELF::Elf64_Sym));
-      file_format->getDynStrTab().setSize(dynstr);
-      file_format->getHashTab().setSize(hash);
-
-      // set .dynsym sh_info to one greater than the symbol table
-      // index of the last local symbol
-      file_format->getDynSymTab().setInfo(dynsym_local_cnt);
-    }
-    /* fall through */
-    case LinkerConfig::Object: {
-      if (config().targets().is32Bits())
-        file_format->getSymTab().setSize(symtab*sizeof(llvm::ELF::Elf32_Sym));
-      else
-        file_format->getSymTab().setSize(symtab*sizeof(llvm::ELF::Elf64_Sym));
-      file_format->getStrTab().setSize(strtab);
-
-      // set .symtab sh_info to one greater than the symbol table
-      // index of the last local symbol
-      file_format->getSymTab().setInfo(symtab_local_cnt);
-      break;
-    }
-    default: {
-      fatal(diag::fatal_illegal_codegen_type) << pModule.name();
-      break;
-    }
-  } // end of switch
-  /// @}
-
-  /// reserve fixed entries in the .dynamic section.
-  /// @{
-  if (LinkerConfig::DynObj == config().codeGenType() ||
-      LinkerConfig::Exec == config().codeGenType()) {
-    // Because some entries in .dynamic section need information of .dynsym,
-    // .dynstr, .symtab, .strtab and .hash, we can not reserve non-DT_NEEDED
-    // entries until we get the size of the sections mentioned above
-    dynamic().reserveEntries(*file_format);
-    file_format->getDynamic().setSize(dynamic().numOfBytes());
-  }
-  /// @}
-
-  /// compute the size of .shstrtab section.
-  /// @{
-  Module::const_iterator sect, sectEnd = pModule.end();
-  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
-    // StackNote sections will always be in output!
-    if (0 != (*sect)->size() || LDFileFormat::StackNote == (*sect)->kind()) {
-      shstrtab += ((*sect)->name().size() + 1);
-    }
-  }
-  shstrtab += (strlen(".shstrtab") + 1);
-  file_format->getShStrTab().setSize(shstrtab);
-  /// @}
-}
-
-/// emitSymbol32 - emit an ELF32 symbol
-void MipsGNULDBackend::emitSymbol32(llvm::ELF::Elf32_Sym& pSym,
-                                    LDSymbol& pSymbol,
-                                    char* pStrtab,
-                                    size_t pStrtabsize,
-                                    size_t pSymtabIdx)
-{
-   // FIXME: check the endian between host and target
-   // write out symbol
-    if (ResolveInfo::Section != pSymbol.type() ||
-          &pSymbol == m_pGpDispSymbol) {
-     pSym.st_name  = pStrtabsize;
-     strcpy((pStrtab + pStrtabsize), pSymbol.name());
-   }
-   else {
-     pSym.st_name  = 0;
-   }
-   pSym.st_value = pSymbol.value();
-   pSym.st_size  = getSymbolSize(pSymbol);
-   pSym.st_info  = getSymbolInfo(pSymbol);
-   pSym.st_other = pSymbol.visibility();
-   pSym.st_shndx = getSymbolShndx(pSymbol);
-}
-
-/// emitNamePools - emit dynamic name pools - .dyntab, .dynstr, .hash
-///
-/// the size of these tables should be computed before layout
-/// layout should computes the start offset of these tables
-void MipsGNULDBackend::emitDynNamePools(Module& pModule, MemoryArea& pOutput)
+/// hasSymbolName - _gp_disp is a section symbol with a name
+bool MipsGNULDBackend::hasSymbolName(const LDSymbol& pSymbol) const
 {
-  ELFFileFormat* file_format = getOutputFormat();
-  if (!file_format->hasDynSymTab() ||
-      !file_format->hasDynStrTab() ||
-      !file_format->hasHashTab()   ||
-      !file_format->hasDynamic())
-    return;
-
-  LDSection& symtab_sect = file_format->getDynSymTab();
-  LDSection& strtab_sect = file_format->getDynStrTab();
-  LDSection& hash_sect   = file_format->getHashTab();
-  LDSection& dyn_sect    = file_format->getDynamic();
-
-  MemoryRegion* symtab_region = pOutput.request(symtab_sect.offset(),
-                                                symtab_sect.size());
-  MemoryRegion* strtab_region = pOutput.request(strtab_sect.offset(),
-                                                strtab_sect.size());
-  MemoryRegion* hash_region   = pOutput.request(hash_sect.offset(),
-                                                hash_sect.size());
-  MemoryRegion* dyn_region    = pOutput.request(dyn_sect.offset(),
-                                                dyn_sect.size());
-
-  // set up symtab_region
-  llvm::ELF::Elf32_Sym* symtab32 = NULL;
-  symtab32 = (llvm::ELF::Elf32_Sym*)symtab_region->start();
-
-  symtab32[0].st_name  = 0;
-  symtab32[0].st_value = 0;
-  symtab32[0].st_size  = 0;
-  symtab32[0].st_info  = 0;
-  symtab32[0].st_other = 0;
-  symtab32[0].st_shndx = 0;
-
-  // set up strtab_region
-  char* strtab = (char*)strtab_region->start();
-  strtab[0] = '\0';
-
-  bool sym_exist = false;
-  HashTableType::entry_type* entry = 0;
-
-  // add index 0 symbol into SymIndexMap
-  entry = m_pSymIndexMap->insert(NULL, sym_exist);
-  entry->setValue(0);
-
-  size_t symtabIdx = 1;
-  size_t strtabsize = 1;
-
-  // emit .dynsym, and .dynstr (emit LocalDyn and Dynamic category) except GOT
-  // entries
-  const Module::SymbolTable& symbols = pModule.getSymbolTable();
-  Module::const_sym_iterator symbol, symEnd = symbols.dynamicEnd();
-  for (symbol = symbols.localDynBegin(); symbol != symEnd; ++symbol) {
-    if (isGlobalGOTSymbol(**symbol))
-      continue;
-    emitSymbol32(symtab32[symtabIdx], **symbol, strtab, strtabsize, symtabIdx);
-    // maintain output's symbol and index map
-    entry = m_pSymIndexMap->insert(*symbol, sym_exist);
-    entry->setValue(symtabIdx);
-    // sum up counters
-    ++symtabIdx;
-    if (ResolveInfo::Section != (*symbol)->type() || *symbol == m_pGpDispSymbol)
-      strtabsize += (*symbol)->nameSize() + 1;
-  }
-
-  // emit global GOT
-  for (std::vector<LDSymbol*>::const_iterator symbol = m_GlobalGOTSyms.begin(),
-       symbol_end = m_GlobalGOTSyms.end();
-       symbol != symbol_end; ++symbol) {
-    // Make sure this golbal GOT entry is a dynamic symbol.
-    // If not, something is wrong earlier when putting this symbol into
-    //  global GOT.
-    if (!isDynamicSymbol(**symbol))
-      fatal(diag::mips_got_symbol) << (*symbol)->name();
-
-    emitSymbol32(symtab32[symtabIdx], **symbol, strtab, strtabsize, symtabIdx);
-    // maintain output's symbol and index map
-    entry = m_pSymIndexMap->insert(*symbol, sym_exist);
-    entry->setValue(symtabIdx);
-    // sum up counters
-    ++symtabIdx;
-    if (ResolveInfo::Section != (*symbol)->type() || *symbol == m_pGpDispSymbol)
-      strtabsize += (*symbol)->nameSize() + 1;
-  }
-
-  // emit DT_NEED
-  // add DT_NEED strings into .dynstr
-  // Rules:
-  //   1. ignore --no-add-needed
-  //   2. force count in --no-as-needed
-  //   3. judge --as-needed
-  ELFDynamic::iterator dt_need = dynamic().needBegin();
-  Module::const_lib_iterator lib, libEnd = pModule.lib_end();
-  for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
-    // --add-needed
-    if ((*lib)->attribute()->isAddNeeded()) {
-      // --no-as-needed
-      if (!(*lib)->attribute()->isAsNeeded()) {
-        strcpy((strtab + strtabsize), (*lib)->name().c_str());
-        (*dt_need)->setValue(llvm::ELF::DT_NEEDED, strtabsize);
-        strtabsize += (*lib)->name().size() + 1;
-        ++dt_need;
-      }
-      // --as-needed
-      else if ((*lib)->isNeeded()) {
-        strcpy((strtab + strtabsize), (*lib)->name().c_str());
-        (*dt_need)->setValue(llvm::ELF::DT_NEEDED, strtabsize);
-        strtabsize += (*lib)->name().size() + 1;
-        ++dt_need;
-      }
-    }
-  } // for
-
-  // emit soname
-
-  if (!config().options().getRpathList().empty()) {
-    (*dt_need)->setValue(llvm::ELF::DT_RPATH, strtabsize);
-    ++dt_need;
-    GeneralOptions::const_rpath_iterator rpath,
-      rpathEnd = config().options().rpath_end();
-    for (rpath = config().options().rpath_begin(); rpath != rpathEnd; ++rpath) {
-      memcpy((strtab + strtabsize), (*rpath).data(), (*rpath).size());
-      strtabsize += (*rpath).size();
-      strtab[strtabsize++] = (rpath + 1 == rpathEnd ? '\0' : ':');
-    }
-  }
-
-  // initialize value of ELF .dynamic section
-  if (LinkerConfig::DynObj == config().codeGenType())
-    dynamic().applySoname(strtabsize);
-  dynamic().applyEntries(*file_format);
-  dynamic().emit(dyn_sect, *dyn_region);
-
-  strcpy((strtab + strtabsize), pModule.name().c_str());
-  strtabsize += pModule.name().size() + 1;
-
-  // emit hash table
-  // FIXME: this verion only emit SVR4 hash section.
-  //        Please add GNU new hash section
-
-  // both 32 and 64 bits hash table use 32-bit entry
-  // set up hash_region
-  uint32_t* word_array = (uint32_t*)hash_region->start();
-  uint32_t& nbucket = word_array[0];
-  uint32_t& nchain  = word_array[1];
-
-  nbucket = getHashBucketCount(symtabIdx, false);
-  nchain  = symtabIdx;
-
-  uint32_t* bucket = (word_array + 2);
-  uint32_t* chain  = (bucket + nbucket);
-
-  // initialize bucket
-  bzero((void*)bucket, nbucket);
+  return GNULDBackend::hasSymbolName(pSymbol) || &pSymbol == m_pGpDispSymbol;
+}
 
-  StringHash<ELF> hash_func;
+/// getDynsymOrder - the global GOT symbols are at the end of .dynsym in the
+/// order of their entries
+uint64_t MipsGNULDBackend::getDynsymOrder(const LDSymbol& pSymbol) const
+{
+  return m_GlobalGOTSyms.lookup(&pSymbol);
+}
 
-  for (size_t sym_idx=0; sym_idx < symtabIdx; ++sym_idx) {
-    llvm::StringRef name(strtab + symtab32[sym_idx].st_name);
-    size_t bucket_pos = hash_func(name) % nbucket;
-    chain[sym_idx] = bucket[bucket_pos];
-    bucket[bucket_pos] = sym_idx;
-  }
+bool MipsGNULDBackend::isAbsoluteJumpAllowed() const
+{
+  return !config().isCodeIndep();
+}
 
+bool MipsGNULDBackend::isNonPICExec() const
+{
+  return LinkerConfig::Exec == config().codeGenType() &&
+         !config().isCodeIndep();
 }
 
 MipsGOT& MipsGNULDBackend::getGOT()
@@ -594,6 +399,25 @@ const OutputRelocSection& MipsGNULDBackend::getRelDyn() const
   return *m_pRelDyn;
 }
 
+MipsPLT& MipsGNULDBackend::getPLT()
+{
+  assert(NULL != m_pPLT && "PLT section not exist");
+  return *m_pPLT;
+}
+
+const MipsPLT& MipsGNULDBackend::getPLT() const
+{
+  assert(NULL != m_pPLT && "PLT section not exist");
+  return *m_pPLT;
+}
+
+const MipsPLT1& MipsGNULDBackend::getPLTEntry(const ResolveInfo& pSym) const
+{
+  const MipsPLT1* entry = m_SymPLTMap.lookUp(pSym);
+  assert(NULL != entry && "The symbol reserves no PLT entry!");
+  return *entry;
+}
+
 unsigned int
 MipsGNULDBackend::getTargetSectionOrder(const LDSection& pSectHdr) const
 {
@@ -602,6 +426,12 @@ MipsGNULDBackend::getTargetSectionOrder(const LDSection& pSectHdr) const
   if (&pSectHdr == &file_format->getGOT())
     return SHO_DATA;
 
+  if (&pSectHdr == &file_format->getGOTPLT())
+    return SHO_DATA;
+
+  if (&pSectHdr == &file_format->getPLT())
+    return SHO_PLT;
+
   return SHO_UNDEFINED;
 }
 
@@ -610,6 +440,9 @@ bool MipsGNULDBackend::finalizeTargetSymbols()
 {
   if (NULL != m_pGpDispSymbol)
     m_pGpDispSymbol->setValue(m_pGOT->addr() + 0x7FF0);
+
+  if (NULL != m_pGOT)
+    m_pGOT->setGlobalValues(config().threads());
   return true;
 }
 
@@ -627,9 +460,6 @@ bool MipsGNULDBackend::allocateCommonSymbols(Module& pModule)
 
   SymbolCategory::iterator com_sym, com_end;
 
-  // FIXME: If the order of common symbols is defined, then sort common symbols
-  // std::sort(com_sym, com_end, some kind of order);
-
   // get corresponding BSS LDSection
   ELFFileFormat* file_format = getOutputFormat();
   LDSection& bss_sect = file_format->getBSS();
@@ -652,7 +482,11 @@ bool MipsGNULDBackend::allocateCommonSymbols(Module& pModule)
   uint64_t bss_offset  = bss_sect.size();
   uint64_t tbss_offset = tbss_sect.size();
 
-  // allocate all local common symbols
+  // The common symbols are placed by alignment buckets, from the largest
+  // alignment to the smallest, and every bucket is one fragment.
+  CommonBuckets bss_commons, tbss_commons;
+
+  // collect all local common symbols
   com_end = symbol_list.localEnd();
 
   for (com_sym = symbol_list.localBegin(); com_sym != com_end; ++com_sym) {
@@ -663,25 +497,17 @@ bool MipsGNULDBackend::allocateCommonSymbols(Module& pModule)
       // when emitting the regular name pools. We must change the symbols'
       // description here.
       (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-      Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-
-      if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-        // allocate TLS common symbol in tbss section
-        tbss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                     *tbss_sect_data,
-                                                     (*com_sym)->value());
-      }
+
+      // allocate TLS common symbol in tbss section
+      if (ResolveInfo::ThreadLocal == (*com_sym)->type())
+        tbss_commons.add(**com_sym);
       // FIXME: how to identify small and large common symbols?
-      else {
-        bss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                    *bss_sect_data,
-                                                    (*com_sym)->value());
-      }
+      else
+        bss_commons.add(**com_sym);
     }
   }
 
-  // allocate all global common symbols
+  // collect all global common symbols
   com_end = symbol_list.commonEnd();
   for (com_sym = symbol_list.commonBegin(); com_sym != com_end; ++com_sym) {
     // We have to reset the description of the symbol here. When doing
@@ -690,23 +516,18 @@ bool MipsGNULDBackend::allocateCommonSymbols(Module& pModule)
     // when emitting the regular name pools. We must change the symbols'
     // description here.
     (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-    Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-    (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
 
-    if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-      // allocate TLS common symbol in tbss section
-      tbss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                   *tbss_sect_data,
-                                                   (*com_sym)->value());
-    }
+    // allocate TLS common symbol in tbss section
+    if (ResolveInfo::ThreadLocal == (*com_sym)->type())
+      tbss_commons.add(**com_sym);
     // FIXME: how to identify small and large common symbols?
-    else {
-      bss_offset += ObjectBuilder::AppendFragment(*frag,
-                                                  *bss_sect_data,
-                                                  (*com_sym)->value());
-    }
+    else
+      bss_commons.add(**com_sym);
   }
 
+  bss_offset += bss_commons.allocate(*bss_sect_data);
+  tbss_offset += tbss_commons.allocate(*tbss_sect_data);
+
   bss_sect.setSize(bss_offset);
   tbss_sect.setSize(tbss_offset);
   symbol_list.changeCommonsToGlobal();
@@ -746,7 +567,6 @@ void MipsGNULDBackend::scanLocalReloc(Relocation& pReloc,
     case llvm::ELF::R_MIPS_SHIFT5:
     case llvm::ELF::R_MIPS_SHIFT6:
     case llvm::ELF::R_MIPS_64:
-    case llvm::ELF::R_MIPS_GOT_PAGE:
     case llvm::ELF::R_MIPS_GOT_OFST:
     case llvm::ELF::R_MIPS_SUB:
     case llvm::ELF::R_MIPS_INSERT_A:
@@ -765,30 +585,30 @@ void MipsGNULDBackend::scanLocalReloc(Relocation& pReloc,
     case llvm::ELF::R_MIPS_JUMP_SLOT:
       break;
     case llvm::ELF::R_MIPS_GOT16:
+    case llvm::ELF::R_MIPS_GOT_PAGE:
+      // The page entries are shared by the nearby local addresses. GOT16
+      // of a global symbol refers to the entry of its address.
+      if (rsym->isLocal() || llvm::ELF::R_MIPS_GOT_PAGE == pReloc.type()) {
+        reservePageEntries(pReloc);
+        // Remeber this rsym is a local GOT entry
+        m_pGOT->setLocal(rsym);
+        break;
+      }
+      // fall through
     case llvm::ELF::R_MIPS_CALL16:
+    case llvm::ELF::R_MIPS_GOT_DISP:
     case llvm::ELF::R_MIPS_GOT_HI16:
     case llvm::ELF::R_MIPS_CALL_HI16:
     case llvm::ELF::R_MIPS_GOT_LO16:
     case llvm::ELF::R_MIPS_CALL_LO16:
-      // For got16 section based relocations, we need to reserve got entries.
-      if (rsym->type() == ResolveInfo::Section) {
-        m_pGOT->reserveLocalEntry();
-        // Remeber this rsym is a local GOT entry
-        m_pGOT->setLocal(rsym);
-        return;
-      }
-
-      if (!(rsym->reserved() & MipsGNULDBackend::ReserveGot)) {
-        m_pGOT->reserveLocalEntry();
-        rsym->setReserved(rsym->reserved() | ReserveGot);
-        // Remeber this rsym is a local GOT entry
-        m_pGOT->setLocal(rsym);
-      }
+      m_pGOT->reserveLocalEntry(*pReloc.targetRef().frag(), *rsym);
+      rsym->setReserved(rsym->reserved() | ReserveGot);
+      // Remeber this rsym is a local GOT entry
+      m_pGOT->setLocal(rsym);
       break;
     case llvm::ELF::R_MIPS_GPREL32:
     case llvm::ELF::R_MIPS_GPREL16:
     case llvm::ELF::R_MIPS_LITERAL:
-    case llvm::ELF::R_MIPS_GOT_DISP:
       break;
     case llvm::ELF::R_MIPS_TLS_DTPMOD32:
     case llvm::ELF::R_MIPS_TLS_DTPREL32:
@@ -833,8 +653,19 @@ void MipsGNULDBackend::scanGlobalReloc(Relocation& pReloc,
     case llvm::ELF::R_MIPS_64:
     case llvm::ELF::R_MIPS_HI16:
     case llvm::ELF::R_MIPS_LO16:
-      if (symbolNeedsDynRel(*rsym, false, true)) {
+      // The address of a function of the shared objects is its PLT entry,
+      // and their data is copied into the executable.
+      if (isNonPICExec() && symbolNeedsPLT(*rsym) &&
+          !(rsym->reserved() & ReservePLT))
+        reservePLT(*rsym);
+
+      if (symbolNeedsDynRel(*rsym, (rsym->reserved() & ReservePLT), true)) {
         m_pRelDyn->reserveEntry();
+        if (isNonPICExec() && symbolNeedsCopyReloc(pReloc, *rsym)) {
+          LDSymbol& cpy_sym = defineSymbolforCopyReloc(pBuilder, *rsym);
+          addCopyReloc(*cpy_sym.resolveInfo());
+          break;
+        }
         rsym->setReserved(rsym->reserved() | ReserveRel);
         checkAndSetHasTextRel(*pSection.getLink());
 
@@ -852,10 +683,11 @@ void MipsGNULDBackend::scanGlobalReloc(Relocation& pReloc,
     case llvm::ELF::R_MIPS_CALL_LO16:
     case llvm::ELF::R_MIPS_GOT_PAGE:
     case llvm::ELF::R_MIPS_GOT_OFST:
+      m_pGOT->reserveGlobalEntry(*pReloc.targetRef().frag(), *rsym);
       if (!(rsym->reserved() & MipsGNULDBackend::ReserveGot)) {
-        m_pGOT->reserveGlobalEntry();
         rsym->setReserved(rsym->reserved() | ReserveGot);
-        m_GlobalGOTSyms.push_back(rsym->outSymbol());
+        uint64_t order = m_GlobalGOTSyms.size() + 1;
+        m_GlobalGOTSyms[rsym->outSymbol()] = order;
         // Remeber this rsym is a global GOT entry
         m_pGOT->setGlobal(rsym);
       }
@@ -869,6 +701,10 @@ void MipsGNULDBackend::scanGlobalReloc(Relocation& pReloc,
       break;
     case llvm::ELF::R_MIPS_26:
     case llvm::ELF::R_MIPS_PC16:
+      // the calls of the non-PIC code go through the PLT
+      if (isNonPICExec() && symbolNeedsPLT(*rsym) &&
+          !(rsym->reserved() & ReservePLT))
+        reservePLT(*rsym);
       break;
     case llvm::ELF::R_MIPS_16:
     case llvm::ELF::R_MIPS_SHIFT5:
@@ -903,6 +739,89 @@ void MipsGNULDBackend::scanGlobalReloc(Relocation& pReloc,
   }
 }
 
+void MipsGNULDBackend::reservePLT(ResolveInfo& pSym)
+{
+  // The .got.plt entry is reserved with the PLT entry. Both of them are
+  // assigned now, so the PLT entries are in the order of scanning.
+  m_pPLT->reserveEntry();
+  MipsPLT1* plt_entry = m_pPLT->consume();
+  MipsGOTEntry* gotplt_entry = m_pGOTPLT->consume();
+  m_SymPLTMap.record(pSym, *plt_entry);
+
+  // the lazy binding of the .got.plt entry
+  m_pRelPLT->reserveEntry();
+  Relocation& rel_entry = *m_pRelPLT->consumeEntry();
+  rel_entry.setType(llvm::ELF::R_MIPS_JUMP_SLOT);
+  rel_entry.targetRef().assign(*gotplt_entry);
+  rel_entry.setSymInfo(&pSym);
+
+  // set PLT bit
+  pSym.setReserved(pSym.reserved() | ReservePLT);
+}
+
+void MipsGNULDBackend::addCopyReloc(ResolveInfo& pSym)
+{
+  Relocation& rel_entry = *m_pRelDyn->consumeEntry();
+  rel_entry.setType(llvm::ELF::R_MIPS_COPY);
+  assert(pSym.outSymbol()->hasFragRef());
+  rel_entry.targetRef().assign(*pSym.outSymbol()->fragRef());
+  rel_entry.setSymInfo(&pSym);
+}
+
+/// defineSymbolForCopyReloc
+/// For a symbol needing copy relocation, define a copy symbol in the BSS
+/// section and all other reference to this symbol should refer to this
+/// copy.
+/// This is executed at scan relocation stage.
+LDSymbol&
+MipsGNULDBackend::defineSymbolforCopyReloc(IRBuilder& pBuilder,
+                                           const ResolveInfo& pSym)
+{
+  // get or create corresponding BSS LDSection
+  LDSection* bss_sect_hdr = NULL;
+  ELFFileFormat* file_format = getOutputFormat();
+  if (ResolveInfo::ThreadLocal == pSym.type())
+    bss_sect_hdr = &file_format->getTBSS();
+  else
+    bss_sect_hdr = &file_format->getBSS();
+
+  // get or create corresponding BSS SectionData
+  SectionData* bss_data = NULL;
+  if (bss_sect_hdr->hasSectionData())
+    bss_data = bss_sect_hdr->getSectionData();
+  else
+    bss_data = IRBuilder::CreateSectionData(*bss_sect_hdr);
+
+  // Determine the alignment by the symbol value
+  // FIXME: here we use the largest alignment
+  uint32_t addralign = config().targets().bitclass() / 8;
+
+  // allocate space in BSS for the copy symbol
+  Fragment* frag = new FillFragment(0x0, 1, pSym.size());
+  uint64_t size = ObjectBuilder::AppendFragment(*frag,
+                                                *bss_data,
+                                                addralign);
+  bss_sect_hdr->setSize(bss_sect_hdr->size() + size);
+
+  // change symbol binding to Global if it's a weak symbol
+  ResolveInfo::Binding binding = (ResolveInfo::Binding)pSym.binding();
+  if (binding == ResolveInfo::Weak)
+    binding = ResolveInfo::Global;
+
+  // Define the copy symbol in the bss section and resolve it
+  LDSymbol* cpy_sym = pBuilder.AddSymbol<IRBuilder::Force, IRBuilder::Resolve>(
+                      pSym.name(),
+                      (ResolveInfo::Type)pSym.type(),
+                      ResolveInfo::Define,
+                      binding,
+                      pSym.size(),  // size
+                      0x0,          // value
+                      FragmentRef::Create(*frag, 0x0),
+                      (ResolveInfo::Visibility)pSym.other());
+
+  return *cpy_sym;
+}
+
 void MipsGNULDBackend::defineGOTSymbol(IRBuilder& pBuilder)
 {
   // define symbol _GLOBAL_OFFSET_TABLE_
@@ -9,11 +9,15 @@
 #ifndef MIPS_LDBACKEND_H
 #define MIPS_LDBACKEND_H
 #include <mcld/Target/GNULDBackend.h>
+#include <mcld/Target/SymbolEntryMap.h>
 #include "MipsELFDynamic.h"
 #include "MipsGOT.h"
+#include "MipsGOTPLT.h"
+#include "MipsPLT.h"
 
 namespace mcld {
 
+class Input;
 class LinkerConfig;
 class OutputRelocSection;
 class SectionMap;
@@ -30,6 +34,7 @@ public:
     None          = 0,  // no reserved entry
     ReserveRel    = 1,  // reserve a dynamic relocation entry
     ReserveGot    = 2,  // reserve a GOT entry
+    ReservePLT    = 4,  // reserve a PLT entry
     ReserveGpDisp = 8   // reserve _gp_disp symbol
   };
 
@@ -37,6 +42,8 @@ public:
   MipsGNULDBackend(const LinkerConfig& pConfig, MipsGNUInfo* pInfo);
   ~MipsGNULDBackend();
 
+  void reset();
+
 public:
   /// initTargetSections - initialize target dependent sections in output
   void initTargetSections(Module& pModule, ObjectBuilder& pBuilder);
@@ -58,6 +65,10 @@ public:
                       Module& pModule,
                       LDSection& pSection);
 
+  /// preScanRelocation - update the addend, and skip the relocations against
+  /// _gp_disp and the relocations of the non-allocated sections
+  bool preScanRelocation(Relocation& pReloc, const LDSection& pSection);
+
   /// preLayout - Backend can do any needed modification before layout
   void doPreLayout(IRBuilder& pBuilder);
 
@@ -89,21 +100,28 @@ public:
   uint64_t emitSectionData(const LDSection& pSection,
                            MemoryRegion& pRegion) const;
 
-  void sizeNamePools(Module& pModule, bool pIsStaticLink);
-
-  /// emitNamePools - emit dynamic name pools - .dyntab, .dynstr, .hash
-  void emitDynNamePools(Module& pModule, MemoryArea& pOut);
-
-
   MipsGOT& getGOT();
   const MipsGOT& getGOT() const;
 
   OutputRelocSection& getRelDyn();
   const OutputRelocSection& getRelDyn() const;
 
+  MipsPLT& getPLT();
+  const MipsPLT& getPLT() const;
+
+  /// getPLTEntry - the PLT entry of pSym, which reserves one
+  const MipsPLT1& getPLTEntry(const ResolveInfo& pSym) const;
+
   /// getTargetSectionOrder - compute the layout order of ARM target sections
   unsigned int getTargetSectionOrder(const LDSection& pSectHdr) const;
 
+  /// hasGPRelativeData - the small data is addressed relative to _gp
+  bool hasGPRelativeData() const { return true; }
+
+  /// isAbsoluteJumpAllowed - may a call be relaxed to an absolute jal? Only
+  /// if the output is not position-independent.
+  bool isAbsoluteJumpAllowed() const;
+
   /// finalizeSymbol - finalize the symbol value
   bool finalizeTargetSymbols();
 
@@ -120,14 +138,38 @@ private:
                        IRBuilder& pBuilder,
                        const LDSection& pSection);
 
+  /// getInput - the input of relocation section pSection
+  const Input& getInput(Module& pModule, const LDSection& pSection);
+
+  /// reservePageEntries - reserve the GOT page entries of pReloc
+  void reservePageEntries(const Relocation& pReloc);
+
+  /// isNonPICExec - is the output an executable of the non-PIC ABI
+  /// extensions, which calls the functions of the shared objects through
+  /// the PLT and copies their data by R_MIPS_COPY?
+  bool isNonPICExec() const;
+
+  /// reservePLT - reserve the PLT, .got.plt and R_MIPS_JUMP_SLOT entries of
+  /// pSym
+  void reservePLT(ResolveInfo& pSym);
+
+  /// addCopyReloc - add a copy relocation into .rel.dyn for pSym
+  /// @param pSym - A resolved copy symbol that defined in BSS section
+  void addCopyReloc(ResolveInfo& pSym);
+
+  /// defineSymbolforCopyReloc - allocate a space in BSS section and
+  /// and force define the copy of pSym to BSS section
+  /// @return the output LDSymbol of the copy symbol
+  LDSymbol& defineSymbolforCopyReloc(IRBuilder& pLinker,
+                                     const ResolveInfo& pSym);
+
   void defineGOTSymbol(IRBuilder& pBuilder);
 
-  /// emitSymbol32 - emit an ELF32 symbol, override parent's function
-  void emitSymbol32(llvm::ELF::Elf32_Sym& pSym32,
-                    LDSymbol& pSymbol,
-                    char* pStrtab,
-                    size_t pStrtabsize,
-                    size_t pSymtabIdx);
+  /// hasSymbolName - whether the name of pSymbol is put into the string table
+  bool hasSymbolName(const LDSymbol& pSymbol) const;
+
+  /// getDynsymOrder - the ordering key of dynamic symbol pSymbol
+  uint64_t getDynsymOrder(const LDSymbol& pSymbol) const;
 
   /// getRelEntrySize - the size in BYTE of rel type relocation
   size_t getRelEntrySize()
@@ -145,17 +187,25 @@ private:
   Relocator* m_pRelocator;
 
   MipsGOT* m_pGOT;                      // .got
+  MipsPLT* m_pPLT;                      // .plt
+  MipsGOTPLT* m_pGOTPLT;                // .got.plt
   OutputRelocSection* m_pRelDyn;        // .rel.dyn
+  OutputRelocSection* m_pRelPLT;        // .rel.plt
 
   MipsELFDynamic* m_pDynamic;
   LDSymbol* m_pGOTSymbol;
   LDSymbol* m_pGpDispSymbol;
 
-  std::vector<LDSymbol*> m_GlobalGOTSyms;
+  /// m_GlobalGOTSyms - the global GOT symbols and their ordering keys in
+  /// .dynsym, which follow the order of their GOT entries
+  typedef llvm::DenseMap<const LDSymbol*, uint64_t> GlobalGOTSymMap;
+  GlobalGOTSymMap m_GlobalGOTSyms;
 
-private:
-  /// isGlobalGOTSymbol - return true if the symbol is the global GOT entry.
-  bool isGlobalGOTSymbol(const LDSymbol& pSymbol) const;
+  /// m_SymPLTMap - the PLT entries of the symbols, assigned when scanning
+  SymbolEntryMap<MipsPLT1> m_SymPLTMap;
+
+  /// m_RelocInputs - the inputs of the relocation sections
+  llvm::DenseMap<const LDSection*, const Input*> m_RelocInputs;
 
 };
 
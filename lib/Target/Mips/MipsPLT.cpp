@@ -0,0 +1,153 @@
+//===- MipsPLT.cpp --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "MipsGOTPLT.h"
+#include "MipsPLT.h"
+
+#include <llvm/Support/Casting.h>
+
+#include <mcld/LD/LDSection.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
+
+using namespace mcld;
+
+namespace {
+
+/// helper_hi - the high half of pAddress, adjusted for the signed low half
+uint32_t helper_hi(uint64_t pAddress)
+{
+  return ((pAddress + 0x8000) >> 16) & 0xFFFF;
+}
+
+/// helper_lo - the low half of pAddress
+uint32_t helper_lo(uint64_t pAddress)
+{
+  return pAddress & 0xFFFF;
+}
+
+} // anonymous namespace
+
+MipsPLT0::MipsPLT0(SectionData& pParent)
+  : PLT::Entry<sizeof(mips_plt0)>(pParent) {}
+
+MipsPLT1::MipsPLT1(SectionData& pParent)
+  : PLT::Entry<sizeof(mips_plt1)>(pParent) {}
+
+//===----------------------------------------------------------------------===//
+// MipsPLT
+//===----------------------------------------------------------------------===//
+MipsPLT::MipsPLT(LDSection& pSection, MipsGOTPLT& pGOTPLT)
+  : PLT(pSection), m_GOTPLT(pGOTPLT), m_Last() {
+  new MipsPLT0(*m_SectionData);
+  m_Last = m_SectionData->begin();
+}
+
+MipsPLT::~MipsPLT()
+{
+}
+
+bool MipsPLT::hasPLT1() const
+{
+  return (m_SectionData->size() > 1);
+}
+
+void MipsPLT::finalizeSectionSize()
+{
+  uint64_t size = (m_SectionData->size() - 1) * sizeof(mips_plt1) +
+                  sizeof(mips_plt0);
+  m_Section.setSize(size);
+
+  uint32_t offset = 0;
+  SectionData::iterator frag, fragEnd = m_SectionData->end();
+  for (frag = m_SectionData->begin(); frag != fragEnd; ++frag) {
+    frag->setOffset(offset);
+    offset += frag->size();
+  }
+}
+
+void MipsPLT::reserveEntry(size_t pNum)
+{
+  for (size_t i = 0; i < pNum; ++i) {
+    new MipsPLT1(*m_SectionData);
+    m_GOTPLT.reserve();
+  }
+}
+
+MipsPLT1* MipsPLT::consume()
+{
+  ++m_Last;
+  assert(m_Last != m_SectionData->end() &&
+         "The number of PLT Entries and ResolveInfo doesn't match");
+  return llvm::cast<MipsPLT1>(&(*m_Last));
+}
+
+void MipsPLT::applyPLT0()
+{
+  iterator first = m_SectionData->getFragmentList().begin();
+  assert(first != m_SectionData->getFragmentList().end() &&
+         "FragmentList is empty, applyPLT0 failed!");
+  MipsPLT0* plt0 = &(llvm::cast<MipsPLT0>(*first));
+
+  uint32_t* data = static_cast<uint32_t*>(malloc(MipsPLT0::EntrySize));
+  if (NULL == data)
+    fatal(diag::fail_allocate_memory_plt);
+
+  memcpy(data, mips_plt0, MipsPLT0::EntrySize);
+  uint64_t gotplt_base = m_GOTPLT.addr();
+  data[0] |= helper_hi(gotplt_base);
+  data[1] |= helper_lo(gotplt_base);
+  data[2] |= helper_lo(gotplt_base);
+
+  plt0->setValue(reinterpret_cast<unsigned char*>(data));
+}
+
+void MipsPLT::applyPLT1()
+{
+  iterator it = m_SectionData->begin(), ie = m_SectionData->end();
+  assert(it != ie && "FragmentList is empty, applyPLT1 failed!");
+  ++it; // skip PLT0
+
+  // the entry of the i-th PLT1 entry is the (MipsGOTPLT0Num + i)-th one
+  uint64_t gotplt_addr = m_GOTPLT.addr() +
+                         MipsGOTPLT0Num * MipsGOTEntry::EntrySize;
+  for (; it != ie; ++it, gotplt_addr += MipsGOTEntry::EntrySize) {
+    MipsPLT1* plt1 = &(llvm::cast<MipsPLT1>(*it));
+    uint32_t* data = static_cast<uint32_t*>(malloc(MipsPLT1::EntrySize));
+    if (NULL == data)
+      fatal(diag::fail_allocate_memory_plt);
+
+    memcpy(data, mips_plt1, MipsPLT1::EntrySize);
+    data[0] |= helper_hi(gotplt_addr);
+    data[1] |= helper_lo(gotplt_addr);
+    data[3] |= helper_lo(gotplt_addr);
+
+    plt1->setValue(reinterpret_cast<unsigned char*>(data));
+  }
+
+  m_GOTPLT.applyAllGOTPLT(addr());
+}
+
+uint64_t MipsPLT::emit(MemoryRegion& pRegion)
+{
+  uint64_t result = 0x0;
+  iterator it = begin(), ie = end();
+  unsigned char* buffer = pRegion.getBuffer();
+
+  memcpy(buffer, llvm::cast<MipsPLT0>(*it).getValue(), MipsPLT0::EntrySize);
+  result += MipsPLT0::EntrySize;
+  ++it;
+
+  for (; it != ie; ++it) {
+    const MipsPLT1& plt1 = llvm::cast<MipsPLT1>(*it);
+    memcpy(buffer + result, plt1.getValue(), MipsPLT1::EntrySize);
+    result += MipsPLT1::EntrySize;
+  }
+  return result;
+}
+
@@ -0,0 +1,96 @@
+//===- MipsPLT.h ----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_MIPS_PLT_H
+#define MCLD_MIPS_PLT_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+
+#include <mcld/Target/PLT.h>
+
+namespace {
+
+const uint32_t mips_plt0[] = {
+  0x3c1c0000, // lui   $28, %hi(&GOTPLT[0])
+  0x8f990000, // lw    $25, %lo(&GOTPLT[0])($28)
+  0x279c0000, // addiu $28, $28, %lo(&GOTPLT[0])
+  0x031cc023, // subu  $24, $24, $28
+  0x03e07821, // move  $15, $31
+  0x0018c082, // srl   $24, $24, 2
+  0x0320f809, // jalr  $25
+  0x2718fffe  // subu  $24, $24, 2
+};
+
+const uint32_t mips_plt1[] = {
+  0x3c0f0000, // lui   $15, %hi(.got.plt entry)
+  0x8df90000, // lw    $25, %lo(.got.plt entry)($15)
+  0x03200008, // jr    $25
+  0x25f80000  // addiu $24, $15, %lo(.got.plt entry)
+};
+
+} // anonymous namespace
+
+namespace mcld {
+
+class MipsGOTPLT;
+class MemoryRegion;
+
+class MipsPLT0 : public PLT::Entry<sizeof(mips_plt0)>
+{
+public:
+  MipsPLT0(SectionData& pParent);
+};
+
+class MipsPLT1 : public PLT::Entry<sizeof(mips_plt1)>
+{
+public:
+  MipsPLT1(SectionData& pParent);
+};
+
+/** \class MipsPLT
+ *  \brief Mips Procedure Linkage Table of the non-PIC ABI extensions.
+ *
+ *  The executables of non-PIC code call the functions of the shared objects
+ *  through the PLT instead of the global GOT. A PLT1 entry jumps through its
+ *  .got.plt entry, which points to PLT0 until the dynamic linker binds it.
+ *  PLT0 calls the lazy resolver with the index of the .got.plt entry in $24.
+ */
+class MipsPLT : public PLT
+{
+public:
+  MipsPLT(LDSection& pSection, MipsGOTPLT& pGOTPLT);
+  ~MipsPLT();
+
+  // finalizeSectionSize - set LDSection size
+  void finalizeSectionSize();
+
+  // hasPLT1 - return if this plt section has any plt1 entry
+  bool hasPLT1() const;
+
+  void reserveEntry(size_t pNum = 1) ;
+
+  MipsPLT1* consume();
+
+  void applyPLT0();
+
+  void applyPLT1();
+
+  uint64_t emit(MemoryRegion& pRegion);
+
+private:
+  MipsGOTPLT& m_GOTPLT;
+
+  // m_Last - the last consumed entry
+  iterator m_Last;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -14,20 +14,25 @@ static MipsRelocator::Result Name(Relocation& pEntry, \
 #define DECL_MIPS_APPLY_RELOC_FUNCS \
 DECL_MIPS_APPLY_RELOC_FUNC(none) \
 DECL_MIPS_APPLY_RELOC_FUNC(abs32) \
+DECL_MIPS_APPLY_RELOC_FUNC(rel26) \
 DECL_MIPS_APPLY_RELOC_FUNC(hi16) \
 DECL_MIPS_APPLY_RELOC_FUNC(lo16) \
 DECL_MIPS_APPLY_RELOC_FUNC(got16) \
 DECL_MIPS_APPLY_RELOC_FUNC(call16) \
 DECL_MIPS_APPLY_RELOC_FUNC(gprel32) \
 DECL_MIPS_APPLY_RELOC_FUNC(gothi16) \
-DECL_MIPS_APPLY_RELOC_FUNC(gotlo16)
+DECL_MIPS_APPLY_RELOC_FUNC(gotlo16) \
+DECL_MIPS_APPLY_RELOC_FUNC(gotdisp) \
+DECL_MIPS_APPLY_RELOC_FUNC(gotpage) \
+DECL_MIPS_APPLY_RELOC_FUNC(gotofst) \
+DECL_MIPS_APPLY_RELOC_FUNC(jalr)
 
 #define DECL_MIPS_APPLY_RELOC_FUNC_PTRS \
   { &none,     0, "R_MIPS_NONE",             0}, \
   { &none,     1, "R_MIPS_16",              16}, \
   { &abs32,    2, "R_MIPS_32",              32}, \
   { &none,     3, "R_MIPS_REL32",           32}, \
-  { &none,     4, "R_MIPS_26",              64}, \
+  { &rel26,    4, "R_MIPS_26",              32}, \
   { &hi16,     5, "R_MIPS_HI16",            16}, \
   { &lo16,     6, "R_MIPS_LO16",            16}, \
   { &none,     7, "R_MIPS_GPREL16",         16}, \
@@ -42,9 +47,9 @@ DECL_MIPS_APPLY_RELOC_FUNC(gotlo16)
   { &none,    16, "R_MIPS_SHIFT5",          32}, \
   { &none,    17, "R_MIPS_SHIFT6",          32}, \
   { &none,    18, "R_MIPS_64",              64}, \
-  { &none,    19, "R_MIPS_GOT_DISP",        16}, \
-  { &none,    20, "R_MIPS_GOT_PAGE",        16}, \
-  { &none,    21, "R_MIPS_GOT_OFST",        16}, \
+  { &gotdisp, 19, "R_MIPS_GOT_DISP",        16}, \
+  { &gotpage, 20, "R_MIPS_GOT_PAGE",        16}, \
+  { &gotofst, 21, "R_MIPS_GOT_OFST",        16}, \
   { &gothi16, 22, "R_MIPS_GOT_HI16",        16}, \
   { &gotlo16, 23, "R_MIPS_GOT_LO16",        16}, \
   { &none,    24, "R_MIPS_SUB",             64}, \
@@ -60,7 +65,7 @@ DECL_MIPS_APPLY_RELOC_FUNC(gotlo16)
   { &none,    34, "R_MIPS_ADD_IMMEDIATE",    0}, \
   { &none,    35, "R_MIPS_PJUMP",            0}, \
   { &none,    36, "R_MIPS_RELGOT",           0}, \
-  { &none,    37, "R_MIPS_JALR",            32}, \
+  { &jalr,    37, "R_MIPS_JALR",            32}, \
   { &none,    38, "R_MIPS_TLS_DTPMOD32",    32}, \
   { &none,    39, "R_MIPS_TLS_DTPREL32",    32}, \
   { &none,    40, "R_MIPS_TLS_DTPMOD64",     0}, \
@@ -102,59 +102,72 @@ bool helper_isGpDisp(const Relocation& pReloc)
   return 0 == strcmp(GP_DISP_NAME, rsym->name());
 }
 
+// Get the $gp value of the GOT used by pReloc.
 static
-Relocator::Address helper_GetGP(MipsRelocator& pParent)
+Relocator::Address helper_GetGP(const Relocation& pReloc,
+                                MipsRelocator& pParent)
 {
-  return pParent.getTarget().getGOT().addr() + 0x7FF0;
+  return pParent.getTarget().getGOT().getGPAddr(*pReloc.targetRef().frag());
 }
 
 static
 MipsGOTEntry& helper_GetGOTEntry(Relocation& pReloc,
-                                 MipsRelocator& pParent,
-                                 bool& pExist, int32_t value)
+                                 MipsRelocator& pParent)
 {
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
   MipsGNULDBackend& ld_backend = pParent.getTarget();
   MipsGOT& got = ld_backend.getGOT();
+  const Fragment& frag = *pReloc.targetRef().frag();
 
-  if (got.isLocal(rsym) && ResolveInfo::Section == rsym->type()) {
-    // Local section symbols consume local got entries.
-    return *got.consumeLocal();
+  MipsGOTEntry* got_entry = NULL;
+  if (got.isLocal(rsym)) {
+    got_entry = got.getLocalEntry(frag, *rsym);
+    if (NULL != got_entry)
+      got_entry->setValue(pReloc.symValue());
   }
-
-  MipsGOTEntry* got_entry = pParent.getSymGOTMap().lookUp(*rsym);
-  if (NULL != got_entry) {
-    // found a mapping, then return the mapped entry immediately
-    return *got_entry;
+  else {
+    // the values of the global entries are set by finalizeTargetSymbols()
+    // and the dynamic linker
+    got_entry = got.getGlobalEntry(frag, *rsym);
   }
 
-  // not found
-  if (got.isLocal(rsym))
-    got_entry = got.consumeLocal();
-  else
-    got_entry = got.consumeGlobal();
-
-  pParent.getSymGOTMap().record(*rsym, *got_entry);
-
-  // If we first get this GOT entry, we should initialize it.
-  if (rsym->reserved() & MipsGNULDBackend::ReserveGot) {
-    got_entry->setValue(pReloc.symValue());
-  }
-  else {
+  if (NULL == got_entry)
     fatal(diag::reserve_entry_number_mismatch_got);
-  }
+  return *got_entry;
+}
 
+// Get the entry of the 64 KiB page of pAddress, shared by the nearby
+// addresses.
+static
+MipsGOTEntry& helper_GetPageEntry(Relocation& pReloc,
+                                  MipsRelocator& pParent,
+                                  int32_t pAddress)
+{
+  MipsGOT& got = pParent.getTarget().getGOT();
+  uint32_t page = (pAddress + 0x8000) & 0xFFFF0000;
+  MipsGOTEntry* got_entry = got.getPageEntry(*pReloc.targetRef().frag(), page);
+  if (NULL == got_entry)
+    fatal(diag::reserve_entry_number_mismatch_got);
   return *got_entry;
 }
 
+// Get the offset of pEntry from the $gp of pReloc.
+static
+Relocator::Address helper_GetGPOffset(Relocation& pReloc,
+                                      MipsRelocator& pParent,
+                                      const MipsGOTEntry& pEntry)
+{
+  MipsGOT& got = pParent.getTarget().getGOT();
+  return got.addr() + pEntry.getOffset() - helper_GetGP(pReloc, pParent);
+}
+
 static
 Relocator::Address helper_GetGOTOffset(Relocation& pReloc,
                                        MipsRelocator& pParent)
 {
-  bool exist;
-  MipsGOTEntry& got_entry = helper_GetGOTEntry(pReloc, pParent, exist, 0);
-  return got_entry.getOffset() - 0x7FF0;
+  MipsGOTEntry& got_entry = helper_GetGOTEntry(pReloc, pParent);
+  return helper_GetGPOffset(pReloc, pParent, got_entry);
 }
 
 static
@@ -175,6 +188,20 @@ int32_t helper_CalcAHL(const Relocation& pHiReloc, const Relocation& pLoReloc)
   return AHL;
 }
 
+// Get the value of the symbol of pReloc. A function of the shared objects
+// that is called or addressed by non-PIC code is its PLT entry.
+static
+Relocator::Address helper_GetSymbolValue(const Relocation& pReloc,
+                                         MipsRelocator& pParent)
+{
+  const ResolveInfo* rsym = pReloc.symInfo();
+  if (0x0 == (rsym->reserved() & MipsGNULDBackend::ReservePLT))
+    return pReloc.symValue();
+
+  const MipsGNULDBackend& ld_backend = pParent.getTarget();
+  return ld_backend.getPLT().addr() + ld_backend.getPLTEntry(*rsym).getOffset();
+}
+
 static
 void helper_DynRel(Relocation& pReloc, MipsRelocator& pParent)
 {
@@ -219,7 +246,7 @@ MipsRelocator::Result abs32(Relocation& pReloc, MipsRelocator& pParent)
   ResolveInfo* rsym = pReloc.symInfo();
 
   Relocator::DWord A = pReloc.target() + pReloc.addend();
-  Relocator::DWord S = pReloc.symValue();
+  Relocator::DWord S = helper_GetSymbolValue(pReloc, pParent);
 
   LDSection& target_sect = pReloc.targetRef().frag()->getParent()->getSection();
   // If the flag of target section is not ALLOC, we will not scan this relocation
@@ -240,6 +267,38 @@ MipsRelocator::Result abs32(Relocation& pReloc, MipsRelocator& pParent)
   return MipsRelocator::OK;
 }
 
+// R_MIPS_26:
+//   local   : ((A | ((P + 4) & 0xF0000000)) + S) >> 2
+//   external: (sign-extend(A) + S) >> 2
+static
+MipsRelocator::Result rel26(Relocation& pReloc, MipsRelocator& pParent)
+{
+  ResolveInfo* rsym = pReloc.symInfo();
+  Relocator::Address P = pReloc.place();
+
+  int32_t field = (pReloc.target() & 0x03FFFFFF) << 2;
+  int32_t A = field;
+  if (!rsym->isLocal())
+    A = (A << 4) >> 4;
+  A += pReloc.addend();
+  Relocator::Address S = helper_GetSymbolValue(pReloc, pParent);
+
+  // the target must be in the 256 MiB region of the delay slot. As BFD does,
+  // the region bits of the delay slot are not ORed into A for the check, or
+  // the region of a local target would be counted twice.
+  if (((S + A) & 0xF0000000) != ((P + 4) & 0xF0000000))
+    return MipsRelocator::Overflow;
+
+  Relocator::Address X = S + A;
+  if (rsym->isLocal())
+    X = S + ((field | ((P + 4) & 0xF0000000)) + pReloc.addend());
+
+  pReloc.target() &= 0xFC000000;
+  pReloc.target() |= (X >> 2) & 0x03FFFFFF;
+
+  return MipsRelocator::OK;
+}
+
 // R_MIPS_HI16:
 //   local/external: ((AHL + S) - (short)(AHL + S)) >> 16
 //   _gp_disp      : ((AHL + GP - P) - (short)(AHL + GP - P)) >> 16
@@ -256,11 +315,11 @@ MipsRelocator::Result hi16(Relocation& pReloc, MipsRelocator& pParent)
 
   if (helper_isGpDisp(pReloc)) {
     int32_t P = pReloc.place();
-    int32_t GP = helper_GetGP(pParent);
+    int32_t GP = helper_GetGP(pReloc, pParent);
     res = ((AHL + GP - P) - (int16_t)(AHL + GP - P)) >> 16;
   }
   else {
-    int32_t S = pReloc.symValue();
+    int32_t S = helper_GetSymbolValue(pReloc, pParent);
     res = ((AHL + S) - (int16_t)(AHL + S)) >> 16;
   }
 
@@ -280,12 +339,12 @@ MipsRelocator::Result lo16(Relocation& pReloc, MipsRelocator& pParent)
 
   if (helper_isGpDisp(pReloc)) {
     int32_t P = pReloc.place();
-    int32_t GP = helper_GetGP(pParent);
+    int32_t GP = helper_GetGP(pReloc, pParent);
     int32_t AHL = pParent.getAHL();
     res = AHL + GP - P + 4;
   }
   else {
-    int32_t S = pReloc.symValue();
+    int32_t S = helper_GetSymbolValue(pReloc, pParent);
     // The previous AHL may be for other hi/lo pairs.
     // We need to calcuate the lo part now.  It is easy.
     // Remember to add the section offset to ALO.
@@ -317,12 +376,8 @@ MipsRelocator::Result got16(Relocation& pReloc, MipsRelocator& pParent)
 
     pParent.setAHL(AHL);
 
-    int32_t res = (AHL + S + 0x8000) & 0xFFFF0000;
-    bool exist;
-    MipsGOTEntry& got_entry = helper_GetGOTEntry(pReloc, pParent, exist, res);
-
-    got_entry.setValue(res);
-    G = got_entry.getOffset() - 0x7FF0;
+    MipsGOTEntry& got_entry = helper_GetPageEntry(pReloc, pParent, AHL + S);
+    G = helper_GetGPOffset(pReloc, pParent, got_entry);
   }
   else {
     G = helper_GetGOTOffset(pReloc, pParent);
@@ -384,7 +439,7 @@ MipsRelocator::Result gprel32(Relocation& pReloc, MipsRelocator& pParent)
   // Remember to add the section offset to A.
   int32_t A = pReloc.target() + pReloc.addend();
   int32_t S = pReloc.symValue();
-  int32_t GP = helper_GetGP(pParent);
+  int32_t GP = helper_GetGP(pReloc, pParent);
 
   // llvm does not emits SHT_MIPS_REGINFO section.
   // Assume that GP0 is zero.
@@ -393,3 +448,103 @@ MipsRelocator::Result gprel32(Relocation& pReloc, MipsRelocator& pParent)
   return MipsRelocator::OK;
 }
 
+
+// R_MIPS_GOT_DISP:
+//   local/external: G
+static
+MipsRelocator::Result gotdisp(Relocation& pReloc, MipsRelocator& pParent)
+{
+  Relocator::Address G = helper_GetGOTOffset(pReloc, pParent);
+
+  pReloc.target() &= 0xFFFF0000;
+  pReloc.target() |= (G & 0xFFFF);
+
+  return MipsRelocator::OK;
+}
+
+// R_MIPS_GOT_PAGE:
+//   local   : G (the entry of the page of S + A)
+//   external: G
+static
+MipsRelocator::Result gotpage(Relocation& pReloc, MipsRelocator& pParent)
+{
+  Relocator::Address G = 0;
+  if (pParent.getTarget().getGOT().isLocal(pReloc.symInfo())) {
+    int32_t A = (int16_t)(pReloc.target() & 0xFFFF) + pReloc.addend();
+    int32_t S = pReloc.symValue();
+    MipsGOTEntry& got_entry = helper_GetPageEntry(pReloc, pParent, S + A);
+    G = helper_GetGPOffset(pReloc, pParent, got_entry);
+  }
+  else {
+    G = helper_GetGOTOffset(pReloc, pParent);
+  }
+
+  pReloc.target() &= 0xFFFF0000;
+  pReloc.target() |= (G & 0xFFFF);
+
+  return MipsRelocator::OK;
+}
+
+// R_MIPS_GOT_OFST:
+//   local   : S + A - page of (S + A)
+//   external: A
+static
+MipsRelocator::Result gotofst(Relocation& pReloc, MipsRelocator& pParent)
+{
+  int32_t A = (int16_t)(pReloc.target() & 0xFFFF) + pReloc.addend();
+  int32_t res = A;
+  if (pParent.getTarget().getGOT().isLocal(pReloc.symInfo())) {
+    int32_t S = pReloc.symValue();
+    res = (S + A) - ((S + A + 0x8000) & 0xFFFF0000);
+  }
+
+  pReloc.target() &= 0xFFFF0000;
+  pReloc.target() |= (res & 0xFFFF);
+
+  return MipsRelocator::OK;
+}
+
+// R_MIPS_JALR: a hint on the jalr/jr of a call through $t9. The indirect
+// jump becomes a direct one if the target is known at link time.
+//   in range of a branch: jalr $t9 => bal S, jr $t9 => b S
+//   in the 256 MiB region, non-PIC: jalr $t9 => jal S, jr $t9 => j S
+static
+MipsRelocator::Result jalr(Relocation& pReloc, MipsRelocator& pParent)
+{
+  static const uint32_t JALR_T9 = 0x0320f809;
+  static const uint32_t JR_T9   = 0x03200008;
+
+  uint32_t insn = pReloc.target();
+  if (JALR_T9 != insn && JR_T9 != insn)
+    return MipsRelocator::OK;
+
+  // the call must reach the definition in the output
+  const ResolveInfo* rsym = pReloc.symInfo();
+  MipsGNULDBackend& ld_backend = pParent.getTarget();
+  if (!rsym->isLocal() &&
+      (!rsym->isDefine() || rsym->isDyn() ||
+       ld_backend.isSymbolPreemptible(*rsym)))
+    return MipsRelocator::OK;
+  if (ResolveInfo::Function != rsym->type() && !rsym->isLocal())
+    return MipsRelocator::OK;
+
+  // the odd addresses are MIPS16 or microMIPS code, which needs jalx
+  Relocator::Address S = pReloc.symValue() + pReloc.addend();
+  if (0x0 != (S & 0x3))
+    return MipsRelocator::OK;
+
+  // the branches are relative to the delay slot
+  int64_t offset = (int64_t)S - (int64_t)(pReloc.place() + 4);
+  if (offset >= -0x20000 && offset <= 0x1fffc) {
+    uint32_t imm = (offset >> 2) & 0xFFFF;
+    pReloc.target() = (JALR_T9 == insn ? 0x04110000 : 0x10000000) | imm;
+    return MipsRelocator::OK;
+  }
+
+  if (ld_backend.isAbsoluteJumpAllowed() &&
+      ((pReloc.place() + 4) & 0xF0000000) == (S & 0xF0000000)) {
+    uint32_t index = (S >> 2) & 0x3FFFFFF;
+    pReloc.target() = (JALR_T9 == insn ? 0x0C000000 : 0x08000000) | index;
+  }
+  return MipsRelocator::OK;
+}
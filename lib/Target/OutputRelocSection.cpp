@@ -24,49 +24,52 @@ using namespace mcld;
 OutputRelocSection::OutputRelocSection(Module& pModule, LDSection& pSection)
   : m_Module(pModule),
     m_pRelocData(NULL),
-    m_isVisit(false),
-    m_ValidEntryIterator(){
+    m_NumOfReserved(0),
+    m_NumOfConsumed(0),
+    m_pFreeEntry(NULL),
+    m_NumOfFree(0) {
   assert(!pSection.hasRelocData() && "Given section is not a relocation section");
   m_pRelocData = IRBuilder::CreateRelocData(pSection);
 }
 
 OutputRelocSection::~OutputRelocSection()
 {
+  // The RelocData does not own the records, so the blocks are freed here.
+  BlockList::iterator block, bEnd = m_Blocks.end();
+  for (block = m_Blocks.begin(); block != bEnd; ++block)
+    delete [] *block;
 }
 
 void OutputRelocSection::reserveEntry(size_t pNum)
 {
-  for(size_t i=0; i<pNum; i++)
-    m_pRelocData->append(*Relocation::Create());
+  m_NumOfReserved += pNum;
 }
 
 Relocation* OutputRelocSection::consumeEntry()
 {
-  // first time visit this function, set m_ValidEntryIterator to
-  // Fragments.begin()
-  if(!m_isVisit) {
-    assert(!m_pRelocData->getRelocationList().empty() &&
-             "DynRelSection contains no entries.");
-    m_ValidEntryIterator = m_pRelocData->begin();
-    m_isVisit = true;
-  }
-  else {
-    // Add m_ValidEntryIterator here instead of at the end of this function.
-    // We may reserve an entry and then consume it immediately, e.g. for COPY
-    // relocation, so we need to avoid setting this iterator to
-    // RelocData->end() in any case, or when reserve and consume again,
-    // ++m_ValidEntryIterator will still be RelocData->end().
-    ++m_ValidEntryIterator;
-  }
-  assert(m_ValidEntryIterator != m_pRelocData->end() &&
+  assert(m_NumOfConsumed < m_NumOfReserved &&
          "No empty relocation entry for the incoming symbol.");
 
-  return &(*m_ValidEntryIterator);
+  if (0 == m_NumOfFree) {
+    // Allocate the entries reserved so far at once. An entry may be reserved
+    // and consumed immediately while scanning, e.g. for COPY relocation, and
+    // then the rest entries are reserved later.
+    m_NumOfFree = m_NumOfReserved - m_NumOfConsumed;
+    m_pFreeEntry = new Relocation[m_NumOfFree];
+    m_Blocks.push_back(m_pFreeEntry);
+  }
+
+  Relocation* entry = m_pFreeEntry;
+  ++m_pFreeEntry;
+  --m_NumOfFree;
+  ++m_NumOfConsumed;
+  m_pRelocData->append(*entry);
+  return entry;
 }
 
 size_t OutputRelocSection::numOfRelocs()
 {
-  return m_pRelocData->size();
+  return m_NumOfReserved;
 }
 
 bool OutputRelocSection::addSymbolToDynSym(LDSymbol& pSymbol)
@@ -0,0 +1,134 @@
+//===- OutputRelrSection.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Target/OutputRelrSection.h>
+
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
+
+#include <algorithm>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// OutputRelrSection
+//===----------------------------------------------------------------------===//
+OutputRelrSection::OutputRelrSection(LDSection& pSection, size_t pEntrySize)
+  : m_Section(pSection), m_EntrySize(pEntrySize) {
+  assert((4 == pEntrySize || 8 == pEntrySize) && "invalid RELR entry size");
+}
+
+OutputRelrSection::~OutputRelrSection()
+{
+}
+
+bool OutputRelrSection::reserveEntry(const Relocation& pReloc)
+{
+  // The offsets of the fragments are set when the input sections are merged.
+  // The place keeps its alignment at the final address if the output section
+  // is aligned to the entry size.
+  const LDSection& target_sect =
+    pReloc.targetRef().frag()->getParent()->getSection();
+  if (target_sect.align() < m_EntrySize ||
+      0 != (pReloc.targetRef().getOutputOffset() % m_EntrySize))
+    return false;
+
+  if (m_RelocSet.insert(&pReloc).second)
+    m_Relocs.push_back(&pReloc);
+  return true;
+}
+
+bool OutputRelrSection::hasEntry(const Relocation& pReloc) const
+{
+  return (m_RelocSet.end() != m_RelocSet.find(&pReloc));
+}
+
+void OutputRelrSection::getPlaces(std::vector<uint64_t>& pPlaces) const
+{
+  pPlaces.clear();
+  pPlaces.reserve(m_Relocs.size());
+  RelocList::const_iterator reloc, rEnd = m_Relocs.end();
+  for (reloc = m_Relocs.begin(); reloc != rEnd; ++reloc)
+    pPlaces.push_back((*reloc)->place());
+
+  std::sort(pPlaces.begin(), pPlaces.end());
+  pPlaces.erase(std::unique(pPlaces.begin(), pPlaces.end()), pPlaces.end());
+}
+
+uint64_t OutputRelrSection::sizeOfEntries() const
+{
+  std::vector<uint64_t> places;
+  getPlaces(places);
+
+  EntryList entries;
+  Encode(places, m_EntrySize, entries);
+  return entries.size() * m_EntrySize;
+}
+
+void OutputRelrSection::finalizeEntries()
+{
+  std::vector<uint64_t> places;
+  getPlaces(places);
+  Encode(places, m_EntrySize, m_Entries);
+
+  if (m_Entries.size() * m_EntrySize > m_Section.size()) {
+    fatal(diag::err_relr_dyn_overflow) << m_Entries.size() * m_EntrySize
+                                       << m_Section.name()
+                                       << m_Section.size();
+  }
+}
+
+void OutputRelrSection::emit(MemoryRegion& pRegion) const
+{
+  size_t num = pRegion.size() / m_EntrySize;
+  if (4 == m_EntrySize) {
+    uint32_t* buffer = reinterpret_cast<uint32_t*>(pRegion.start());
+    for (size_t i = 0; i < num; ++i)
+      buffer[i] = (i < m_Entries.size()) ? m_Entries[i] : 0x1;
+  }
+  else {
+    uint64_t* buffer = reinterpret_cast<uint64_t*>(pRegion.start());
+    for (size_t i = 0; i < num; ++i)
+      buffer[i] = (i < m_Entries.size()) ? m_Entries[i] : 0x1;
+  }
+}
+
+void OutputRelrSection::Encode(const std::vector<uint64_t>& pPlaces,
+                               size_t pEntrySize,
+                               EntryList& pEntries)
+{
+  // a bitmap covers (pEntrySize * 8 - 1) words, the lowest bit is the tag
+  const uint64_t num_of_bits = pEntrySize * 8 - 1;
+
+  pEntries.clear();
+  size_t i = 0, num = pPlaces.size();
+  while (i < num) {
+    // an address entry, and the bitmaps follow it
+    pEntries.push_back(pPlaces[i]);
+    uint64_t base = pPlaces[i] + pEntrySize;
+    ++i;
+
+    while (true) {
+      uint64_t bitmap = 0x0;
+      for (; i < num; ++i) {
+        uint64_t delta = pPlaces[i] - base;
+        if (delta >= num_of_bits * pEntrySize || 0 != (delta % pEntrySize))
+          break;
+        bitmap |= (uint64_t)1 << (delta / pEntrySize);
+      }
+      if (0x0 == bitmap)
+        break;
+      pEntries.push_back((bitmap << 1) | 0x1);
+      base += num_of_bits * pEntrySize;
+    }
+  }
+}
+
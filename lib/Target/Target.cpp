@@ -18,6 +18,7 @@ mcld::Target::Target()
     MCLinkerCtorFn(NULL),
     TargetLDBackendCtorFn(NULL),
     DiagnosticLineInfoCtorFn(NULL),
+    InitializeFn(NULL),
     m_pT(NULL)
 {
 }
@@ -21,6 +21,8 @@ public:
 
   uint32_t machine() const { return llvm::ELF::EM_386; }
 
+  uint32_t relativeRelocType() const { return llvm::ELF::R_386_RELATIVE; }
+
   uint64_t defaultTextSegmentAddr() const { return 0x08048000; }
 
   /// flags - the value of ElfXX_Ehdr::e_flags
@@ -36,6 +38,8 @@ public:
 
   uint32_t machine() const { return llvm::ELF::EM_X86_64; }
 
+  uint32_t relativeRelocType() const { return llvm::ELF::R_X86_64_RELATIVE; }
+
   uint64_t defaultTextSegmentAddr() const { return 0x400000; }
 
   /// flags - the value of ElfXX_Ehdr::e_flags
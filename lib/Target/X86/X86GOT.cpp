@@ -11,15 +11,13 @@
 #include <mcld/LD/LDFileFormat.h>
 #include <mcld/LD/SectionData.h>
 
-#include <llvm/Support/Casting.h>
-
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
 // X86_32GOT
 //===----------------------------------------------------------------------===//
 X86_32GOT::X86_32GOT(LDSection& pSection)
-  : GOT(pSection), m_pLast(NULL)
+  : GOT(pSection), m_pTable(NULL), m_NumOfConsumed(0)
 {
 }
 
@@ -29,28 +27,29 @@ X86_32GOT::~X86_32GOT()
 
 void X86_32GOT::reserve(size_t pNum)
 {
-  for (size_t i = 0; i < pNum; i++) {
-    new X86_32GOTEntry(0, m_SectionData);
-  }
+  if (NULL == m_pTable)
+    m_pTable = new EntryTable(m_SectionData);
+  m_pTable->reserve(pNum);
 }
 
 X86_32GOTEntry* X86_32GOT::consume()
 {
-  if (NULL == m_pLast) {
-    assert(!empty() && "Consume empty GOT entry!");
-    m_pLast = llvm::cast<X86_32GOTEntry>(&m_SectionData->front());
-    return m_pLast;
-  }
+  assert(m_NumOfConsumed < numOfEntries() && "Consume empty GOT entry!");
+  return &m_pTable->at(m_NumOfConsumed++);
+}
 
-  m_pLast = llvm::cast<X86_32GOTEntry>(m_pLast->getNextNode());
-  return m_pLast;
+size_t X86_32GOT::numOfEntries() const
+{
+  if (NULL == m_pTable)
+    return 0;
+  return m_pTable->numOfSlots();
 }
 
 //===----------------------------------------------------------------------===//
 // X86_64GOT
 //===----------------------------------------------------------------------===//
 X86_64GOT::X86_64GOT(LDSection& pSection)
-  : GOT(pSection), m_pLast(NULL)
+  : GOT(pSection), m_pTable(NULL), m_NumOfConsumed(0)
 {
 }
 
@@ -60,20 +59,21 @@ X86_64GOT::~X86_64GOT()
 
 void X86_64GOT::reserve(size_t pNum)
 {
-  for (size_t i = 0; i < pNum; i++) {
-    new X86_64GOTEntry(0, m_SectionData);
-  }
+  if (NULL == m_pTable)
+    m_pTable = new EntryTable(m_SectionData);
+  m_pTable->reserve(pNum);
 }
 
 X86_64GOTEntry* X86_64GOT::consume()
 {
-  if (NULL == m_pLast) {
-    assert(!empty() && "Consume empty GOT entry!");
-    m_pLast = llvm::cast<X86_64GOTEntry>(&m_SectionData->front());
-    return m_pLast;
-  }
+  assert(m_NumOfConsumed < numOfEntries() && "Consume empty GOT entry!");
+  return &m_pTable->at(m_NumOfConsumed++);
+}
 
-  m_pLast = llvm::cast<X86_64GOTEntry>(m_pLast->getNextNode());
-  return m_pLast;
+size_t X86_64GOT::numOfEntries() const
+{
+  if (NULL == m_pTable)
+    return 0;
+  return m_pTable->numOfSlots();
 }
 
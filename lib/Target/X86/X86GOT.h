@@ -13,6 +13,7 @@
 #endif
 
 #include <mcld/Target/GOT.h>
+#include <mcld/Target/SlotTable.h>
 
 namespace mcld {
 
@@ -22,11 +23,11 @@ class SectionData;
 /** \class X86_32GOTEntry
  *  \brief GOT Entry with size of 4 bytes
  */
-class X86_32GOTEntry : public GOT::Entry<4>
+class X86_32GOTEntry : public GOT::Slot<4>
 {
 public:
-  X86_32GOTEntry(uint64_t pContent, SectionData* pParent)
-   : GOT::Entry<4>(pContent, pParent)
+  X86_32GOTEntry(Fragment& pTable, size_t pIndex)
+   : GOT::Slot<4>(pTable, pIndex)
   {}
 };
 
@@ -45,18 +46,32 @@ public:
 
   X86_32GOTEntry* consume();
 
-private:
-  X86_32GOTEntry* m_pLast; ///< the last consumed entry
+  size_t numOfEntries() const;
+
+  X86_32GOTEntry& getEntry(size_t pIdx)
+  { return m_pTable->at(pIdx); }
+
+  const X86_32GOTEntry& getEntry(size_t pIdx) const
+  { return m_pTable->at(pIdx); }
+
+protected:
+  typedef SlotTable<X86_32GOTEntry> EntryTable;
+
+protected:
+  /// m_pTable - the fragment of all entries. It is created by the first
+  /// reserve(), so a GOT without entries has no fragment.
+  EntryTable* m_pTable;
+  size_t m_NumOfConsumed;
 };
 
 /** \class X86_64GOTEntry
  *  \brief GOT Entry with size of 8 bytes
  */
-class X86_64GOTEntry : public GOT::Entry<8>
+class X86_64GOTEntry : public GOT::Slot<8>
 {
 public:
-  X86_64GOTEntry(uint64_t pContent, SectionData* pParent)
-   : GOT::Entry<8>(pContent, pParent)
+  X86_64GOTEntry(Fragment& pTable, size_t pIndex)
+   : GOT::Slot<8>(pTable, pIndex)
   {}
 };
 
@@ -75,8 +90,22 @@ public:
 
   X86_64GOTEntry* consume();
 
-private:
-  X86_64GOTEntry* m_pLast; ///< the last consumed entry
+  size_t numOfEntries() const;
+
+  X86_64GOTEntry& getEntry(size_t pIdx)
+  { return m_pTable->at(pIdx); }
+
+  const X86_64GOTEntry& getEntry(size_t pIdx) const
+  { return m_pTable->at(pIdx); }
+
+protected:
+  typedef SlotTable<X86_64GOTEntry> EntryTable;
+
+protected:
+  /// m_pTable - the fragment of all entries. It is created by the first
+  /// reserve(), so a GOT without entries has no fragment.
+  EntryTable* m_pTable;
+  size_t m_NumOfConsumed;
 };
 
 } // namespace of mcld
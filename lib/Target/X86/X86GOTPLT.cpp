@@ -9,8 +9,6 @@
 #include "X86GOTPLT.h"
 #include "X86PLT.h"
 
-#include <llvm/Support/Casting.h>
-
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/LDFileFormat.h>
 #include <mcld/Support/MsgHandling.h>
@@ -38,25 +36,21 @@ X86_32GOTPLT::~X86_32GOTPLT()
 
 bool X86_32GOTPLT::hasGOT1() const
 {
-  return (m_SectionData->size() > X86GOTPLT0Num);
+  return (numOfEntries() > X86GOTPLT0Num);
 }
 
 void X86_32GOTPLT::applyGOT0(uint64_t pAddress)
 {
-  llvm::cast<X86_32GOTEntry>
-    (*(m_SectionData->getFragmentList().begin())).setValue(pAddress);
+  getEntry(0).setValue(pAddress);
 }
 
 void X86_32GOTPLT::applyAllGOTPLT(const X86PLT& pPLT)
 {
-  iterator it = begin();
-  // skip GOT0
-  for (size_t i = 0; i < X86GOTPLT0Num; ++i)
-    ++it;
   // address of corresponding plt entry
   uint64_t plt_addr = pPLT.addr() + pPLT.getPLT0Size();
-  for (; it != end() ; ++it) {
-    llvm::cast<X86_32GOTEntry>(*it).setValue(plt_addr + 6);
+  // skip GOT0
+  for (size_t i = X86GOTPLT0Num, n = numOfEntries(); i < n; ++i) {
+    getEntry(i).setValue(plt_addr + 6);
     plt_addr += pPLT.getPLT1Size();
   }
 }
@@ -82,25 +76,21 @@ X86_64GOTPLT::~X86_64GOTPLT()
 
 bool X86_64GOTPLT::hasGOT1() const
 {
-  return (m_SectionData->size() > X86GOTPLT0Num);
+  return (numOfEntries() > X86GOTPLT0Num);
 }
 
 void X86_64GOTPLT::applyGOT0(uint64_t pAddress)
 {
-  llvm::cast<X86_64GOTEntry>
-    (*(m_SectionData->getFragmentList().begin())).setValue(pAddress);
+  getEntry(0).setValue(pAddress);
 }
 
 void X86_64GOTPLT::applyAllGOTPLT(const X86PLT& pPLT)
 {
-  iterator it = begin();
-  // skip GOT0
-  for (size_t i = 0; i < X86GOTPLT0Num; ++i)
-    ++it;
   // address of corresponding plt entry
   uint64_t plt_addr = pPLT.addr() + pPLT.getPLT0Size();
-  for (; it != end() ; ++it) {
-    llvm::cast<X86_64GOTEntry>(*it).setValue(plt_addr + 6);
+  // skip GOT0
+  for (size_t i = X86GOTPLT0Num, n = numOfEntries(); i < n; ++i) {
+    getEntry(i).setValue(plt_addr + 6);
     plt_addr += pPLT.getPLT1Size();
   }
 }
@@ -25,10 +25,22 @@
 #include <mcld/Support/TargetRegistry.h>
 #include <mcld/Object/ObjectBuilder.h>
 
+#include <algorithm>
 #include <cstring>
 
 using namespace mcld;
 
+/// helper_read_insn - read pNBytes at pOffset of the fragment of pReloc
+static void helper_read_insn(Relocation& pReloc,
+                             uint64_t pOffset,
+                             uint8_t* pInsn,
+                             size_t pNBytes)
+{
+  FragmentRef place(pReloc.targetRef());
+  place.assign(*place.frag(), pOffset);
+  place.memcpy(pInsn, pNBytes);
+}
+
 //===----------------------------------------------------------------------===//
 // X86GNULDBackend
 //===----------------------------------------------------------------------===//
@@ -71,6 +83,23 @@ X86GNULDBackend::~X86GNULDBackend()
   delete m_pDynamic;
 }
 
+void X86GNULDBackend::reset()
+{
+  // the relocator keeps the GOT and PLT entries of the symbols
+  delete m_pRelocator;
+  m_pRelocator = NULL;
+  delete m_pPLT;
+  m_pPLT = NULL;
+  delete m_pRelDyn;
+  m_pRelDyn = NULL;
+  delete m_pRelPLT;
+  m_pRelPLT = NULL;
+  delete m_pDynamic;
+  m_pDynamic = NULL;
+  m_pGOTSymbol = NULL;
+  GNULDBackend::reset();
+}
+
 Relocator* X86GNULDBackend::getRelocator()
 {
   assert(NULL != m_pRelocator);
@@ -219,22 +248,30 @@ LDSymbol& X86GNULDBackend::defineSymbolforCopyReloc(IRBuilder& pBuilder,
   return *cpy_sym;
 }
 
+bool X86GNULDBackend::preScanRelocation(Relocation& pReloc,
+                                        const LDSection& pSection)
+{
+  if (LinkerConfig::Object == config().codeGenType())
+    return false;
+  assert(NULL != pReloc.symInfo() &&
+         "ResolveInfo of relocation not set while preScanRelocation");
+
+  pReloc.updateAddend();
+  assert(NULL != pSection.getLink());
+  return (0 != (pSection.getLink()->flag() & llvm::ELF::SHF_ALLOC));
+}
+
 void X86GNULDBackend::scanRelocation(Relocation& pReloc,
                                      IRBuilder& pLinker,
                                      Module& pModule,
                                      LDSection& pSection)
 {
-  if (LinkerConfig::Object == config().codeGenType())
+  // the relocations removed by relaxation reserve nothing
+  if (0x0 == pReloc.type())
     return;
+
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
-  assert(NULL != rsym &&
-         "ResolveInfo of relocation not set while scanRelocation");
-
-  pReloc.updateAddend();
-  assert(NULL != pSection.getLink());
-  if (0 == (pSection.getLink()->flag() & llvm::ELF::SHF_ALLOC))
-    return;
 
   // Scan relocation type to determine if the GOT/PLT/Dynamic Relocation
   // entries should be created.
@@ -246,7 +283,7 @@ void X86GNULDBackend::scanRelocation(Relocation& pReloc,
   // check if we should issue undefined reference for the relocation target
   // symbol
   if (rsym->isUndef() && !rsym->isDyn() && !rsym->isWeak() && !rsym->isNull())
-    fatal(diag::undefined_reference) << rsym->name();
+    issueUndefRef(pReloc, pSection, pModule);
 }
 
 uint64_t X86GNULDBackend::emitSectionData(const LDSection& pSection,
@@ -268,22 +305,19 @@ uint64_t X86GNULDBackend::emitSectionData(const LDSection& pSection,
 
     m_pPLT->applyPLT0();
     m_pPLT->applyPLT1();
-    X86PLT::iterator it = m_pPLT->begin();
-    unsigned int plt0_size = llvm::cast<PLTEntryBase>((*it)).size();
-
-    memcpy(buffer, llvm::cast<PLTEntryBase>((*it)).getValue(), plt0_size);
-    RegionSize += plt0_size;
-    ++it;
-
-    PLTEntryBase* plt1 = 0;
-    X86PLT::iterator ie = m_pPLT->end();
-    while (it != ie) {
-      plt1 = &(llvm::cast<PLTEntryBase>(*it));
-      EntrySize = plt1->size();
-      memcpy(buffer + RegionSize, plt1->getValue(), EntrySize);
-      RegionSize += EntrySize;
-      ++it;
+    if (m_pPLT->isLazy()) {
+      X86PLT::iterator it = m_pPLT->begin();
+      unsigned int plt0_size = llvm::cast<PLTEntryBase>((*it)).size();
+
+      memcpy(buffer, llvm::cast<PLTEntryBase>((*it)).getValue(), plt0_size);
+      RegionSize += plt0_size;
     }
+
+    // all PLT1 entries are in one image
+    EntrySize = m_pPLT->numOfPLT1() * m_pPLT->getPLT1Size();
+    if (0 != EntrySize)
+      memcpy(buffer + RegionSize, m_pPLT->getPLT1Value(), EntrySize);
+    RegionSize += EntrySize;
   }
 
   else if (&pSection == &(FileFormat->getGOT())) {
@@ -302,6 +336,44 @@ uint64_t X86GNULDBackend::emitSectionData(const LDSection& pSection,
   return RegionSize;
 }
 
+void X86GNULDBackend::emitNops(uint8_t* pBuffer,
+                               uint64_t pOffset,
+                               uint64_t pSize) const
+{
+  // the multi-byte nops recommended by the Intel and AMD optimization
+  // manuals. A gap is filled by the longest ones, so the decoder skips it in
+  // a few instructions.
+  static const uint8_t nops[10][10] = {
+    // nop
+    {0x90},
+    // xchg %ax,%ax
+    {0x66, 0x90},
+    // nopl (%[re]ax)
+    {0x0f, 0x1f, 0x00},
+    // nopl 0(%[re]ax)
+    {0x0f, 0x1f, 0x40, 0x00},
+    // nopl 0(%[re]ax,%[re]ax,1)
+    {0x0f, 0x1f, 0x44, 0x00, 0x00},
+    // nopw 0(%[re]ax,%[re]ax,1)
+    {0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00},
+    // nopl 0L(%[re]ax)
+    {0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00},
+    // nopl 0L(%[re]ax,%[re]ax,1)
+    {0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // nopw 0L(%[re]ax,%[re]ax,1)
+    {0x66, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // nopw %cs:0L(%[re]ax,%[re]ax,1)
+    {0x66, 0x2e, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+  };
+
+  while (pSize > 0) {
+    uint64_t length = std::min(pSize, (uint64_t)10);
+    memcpy(pBuffer, nops[length - 1], length);
+    pBuffer += length;
+    pSize -= length;
+  }
+}
+
 X86PLT& X86GNULDBackend::getPLT()
 {
   assert(NULL != m_pPLT && "PLT section not exist");
@@ -405,6 +477,15 @@ X86_32GNULDBackend::~X86_32GNULDBackend()
   delete m_pGOTPLT;
 }
 
+void X86_32GNULDBackend::reset()
+{
+  delete m_pGOT;
+  m_pGOT = NULL;
+  delete m_pGOTPLT;
+  m_pGOTPLT = NULL;
+  X86GNULDBackend::reset();
+}
+
 bool X86_32GNULDBackend::initRelocator()
 {
   if (NULL == m_pRelocator) {
@@ -428,9 +509,10 @@ void X86_32GNULDBackend::scanLocalReloc(Relocation& pReloc,
     case llvm::ELF::R_386_8:
       // If buiding PIC object (shared library or PIC executable),
       // a dynamic relocations with RELATIVE type to this location is needed.
-      // Reserve an entry in .rel.dyn
+      // Reserve an entry in .rel.dyn, or pack it into .relr.dyn
       if (config().isCodeIndep()) {
-        m_pRelDyn->reserveEntry();
+        if (llvm::ELF::R_386_32 != pReloc.type() || !reserveRelrEntry(pReloc))
+          m_pRelDyn->reserveEntry();
         // set Rel bit
         rsym->setReserved(rsym->reserved() | ReserveRel);
         checkAndSetHasTextRel(*pSection.getLink());
@@ -442,6 +524,11 @@ void X86_32GNULDBackend::scanLocalReloc(Relocation& pReloc,
       // FIXME: A GOT section is needed
       return;
 
+    case X86_32Relocator::R_386_GOT32X:
+      // the load of a local symbol needs no GOT entry
+      if (relaxGOT32X(pReloc, pSection))
+        return;
+      // fall through
     case llvm::ELF::R_386_GOT32:
       // Symbol needs GOT entry, reserve entry in .got
       // return if we already create GOT for this symbol
@@ -583,17 +670,8 @@ void X86_32GNULDBackend::scanGlobalReloc(Relocation& pReloc,
       // dynamic relocation entry
       if (symbolNeedsPLT(*rsym)) {
         // create plt for this symbol if it does not have one
-        if (!(rsym->reserved() & ReservePLT)){
-          // Symbol needs PLT entry, we need to reserve a PLT entry
-          // and the corresponding GOT and dynamic relocation entry
-          // in .got and .rel.plt. (GOT entry will be reserved simultaneously
-          // when calling X86PLT->reserveEntry())
-          m_pPLT->reserveEntry();
-          m_pGOTPLT->reserve();
-          m_pRelPLT->reserveEntry();
-          // set PLT bit
-          rsym->setReserved(rsym->reserved() | ReservePLT);
-        }
+        if (!(rsym->reserved() & ReservePLT))
+          reservePLT(*rsym);
       }
 
       if (symbolNeedsDynRel(*rsym, (rsym->reserved() & ReservePLT), true)) {
@@ -635,42 +713,17 @@ void X86_32GNULDBackend::scanGlobalReloc(Relocation& pReloc,
         return;
       }
 
-      // Symbol needs PLT entry, we need to reserve a PLT entry
-      // and the corresponding GOT and dynamic relocation entry
-      // in .got and .rel.plt. (GOT entry will be reserved simultaneously
-      // when calling X86PLT->reserveEntry())
-      m_pPLT->reserveEntry();
-      m_pGOTPLT->reserve();
-      m_pRelPLT->reserveEntry();
-      // set PLT bit
-      rsym->setReserved(rsym->reserved() | ReservePLT);
+      reservePLT(*rsym);
       return;
 
+    case X86_32Relocator::R_386_GOT32X:
+      // the load of a non-preemptible symbol needs no GOT entry
+      if (relaxGOT32X(pReloc, pSection))
+        return;
+      // fall through
     case llvm::ELF::R_386_GOT32:
       // Symbol needs GOT entry, reserve entry in .got
-      // return if we already create GOT for this symbol
-      if (rsym->reserved() & (ReserveGOT | GOTRel))
-        return;
-      m_pGOT->reserve();
-
-      // If the GOT is used in statically linked binaries,
-      // the GOT entry is enough and no relocation is needed.
-      if (config().isCodeStatic()) {
-        rsym->setReserved(rsym->reserved() | ReserveGOT);
-        return;
-      }
-      // If building shared object or the symbol is undefined, a dynamic
-      // relocation is needed to relocate this GOT entry. Reserve an
-      // entry in .rel.dyn
-      if (LinkerConfig::DynObj ==
-                   config().codeGenType() || rsym->isUndef() || rsym->isDyn()) {
-        m_pRelDyn->reserveEntry();
-        // set GOTRel bit
-        rsym->setReserved(rsym->reserved() | GOTRel);
-        return;
-      }
-      // set GOT bit
-      rsym->setReserved(rsym->reserved() | ReserveGOT);
+      reserveGOT(*rsym);
       return;
 
     case llvm::ELF::R_386_PC32:
@@ -680,17 +733,8 @@ void X86_32GNULDBackend::scanGlobalReloc(Relocation& pReloc,
       if (symbolNeedsPLT(*rsym) &&
           LinkerConfig::DynObj != config().codeGenType()) {
         // create plt for this symbol if it does not have one
-        if (!(rsym->reserved() & ReservePLT)){
-          // Symbol needs PLT entry, we need to reserve a PLT entry
-          // and the corresponding GOT and dynamic relocation entry
-          // in .got and .rel.plt. (GOT entry will be reserved simultaneously
-          // when calling X86PLT->reserveEntry())
-          m_pPLT->reserveEntry();
-          m_pGOTPLT->reserve();
-          m_pRelPLT->reserveEntry();
-          // set PLT bit
-          rsym->setReserved(rsym->reserved() | ReservePLT);
-        }
+        if (!(rsym->reserved() & ReservePLT))
+          reservePLT(*rsym);
       }
 
       if (symbolNeedsDynRel(*rsym, (rsym->reserved() & ReservePLT), false)) {
@@ -780,6 +824,52 @@ void X86_32GNULDBackend::scanGlobalReloc(Relocation& pReloc,
   } // end switch
 }
 
+void X86_32GNULDBackend::reserveGOT(ResolveInfo& pSym)
+{
+  // return if we already create GOT for this symbol
+  if (pSym.reserved() & (ReserveGOT | GOTRel))
+    return;
+  m_pGOT->reserve();
+
+  // If the GOT is used in statically linked binaries,
+  // the GOT entry is enough and no relocation is needed.
+  if (config().isCodeStatic()) {
+    pSym.setReserved(pSym.reserved() | ReserveGOT);
+    return;
+  }
+  // If building shared object or the symbol is undefined, a dynamic
+  // relocation is needed to relocate this GOT entry. Reserve an
+  // entry in .rel.dyn
+  if (LinkerConfig::DynObj ==
+               config().codeGenType() || pSym.isUndef() || pSym.isDyn()) {
+    m_pRelDyn->reserveEntry();
+    // set GOTRel bit
+    pSym.setReserved(pSym.reserved() | GOTRel);
+    return;
+  }
+  // set GOT bit
+  pSym.setReserved(pSym.reserved() | ReserveGOT);
+}
+
+void X86_32GNULDBackend::reservePLT(ResolveInfo& pSym)
+{
+  // Symbol needs PLT entry, we need to reserve a PLT entry
+  // and the corresponding GOT and dynamic relocation entry.
+  m_pPLT->reserveEntry();
+  if (m_pPLT->isLazy()) {
+    // the entry in .got.plt and .rel.plt for the lazy binding
+    m_pGOTPLT->reserve();
+    m_pRelPLT->reserveEntry();
+  }
+  else {
+    // all symbols are bound at load time, the PLT entry jumps through the
+    // .got entry of the symbol, which is relocated by R_386_GLOB_DAT
+    reserveGOT(pSym);
+  }
+  // set PLT bit
+  pSym.setReserved(pSym.reserved() | ReservePLT);
+}
+
 void X86_32GNULDBackend::initTargetSections(Module& pModule,
 					    ObjectBuilder& pBuilder)
 {
@@ -796,6 +886,7 @@ void X86_32GNULDBackend::initTargetSections(Module& pModule,
     // initialize .plt
     LDSection& plt = file_format->getPLT();
     m_pPLT = new X86_32PLT(plt,
+			   *m_pGOT,
 			   *m_pGOTPLT,
 			   config());
 
@@ -870,18 +961,11 @@ uint64_t X86_32GNULDBackend::emitGOTSectionData(MemoryRegion& pRegion) const
 
   uint32_t* buffer = reinterpret_cast<uint32_t*>(pRegion.getBuffer());
 
-  X86_32GOTEntry* got = 0;
-  unsigned int EntrySize = X86_32GOTEntry::EntrySize;
-  uint64_t RegionSize = 0;
-
-  for (X86_32GOT::iterator it = m_pGOT->begin(),
-       ie = m_pGOT->end(); it != ie; ++it, ++buffer) {
-    got = &(llvm::cast<X86_32GOTEntry>((*it)));
-    *buffer = static_cast<uint32_t>(got->getValue());
-    RegionSize += EntrySize;
-  }
+  size_t num = m_pGOT->numOfEntries();
+  for (size_t i = 0; i < num; ++i)
+    buffer[i] = static_cast<uint32_t>(m_pGOT->getEntry(i).getValue());
 
-  return RegionSize;
+  return num * X86_32GOTEntry::EntrySize;
 }
 
 uint64_t X86_32GNULDBackend::emitGOTPLTSectionData(MemoryRegion& pRegion,
@@ -893,18 +977,11 @@ uint64_t X86_32GNULDBackend::emitGOTPLTSectionData(MemoryRegion& pRegion,
 
   uint32_t* buffer = reinterpret_cast<uint32_t*>(pRegion.getBuffer());
 
-  X86_32GOTEntry* got = 0;
-  unsigned int EntrySize = X86_32GOTEntry::EntrySize;
-  uint64_t RegionSize = 0;
-
-  for (X86_32GOTPLT::iterator it = m_pGOTPLT->begin(),
-       ie = m_pGOTPLT->end(); it != ie; ++it, ++buffer) {
-    got = &(llvm::cast<X86_32GOTEntry>((*it)));
-    *buffer = static_cast<uint32_t>(got->getValue());
-    RegionSize += EntrySize;
-  }
+  size_t num = m_pGOTPLT->numOfEntries();
+  for (size_t i = 0; i < num; ++i)
+    buffer[i] = static_cast<uint32_t>(m_pGOTPLT->getEntry(i).getValue());
 
-  return RegionSize;
+  return num * X86_32GOTEntry::EntrySize;
 }
 
 /// convert R_386_TLS_IE to R_386_TLS_LE
@@ -958,6 +1035,66 @@ void X86_32GNULDBackend::convertTLSIEtoLE(Relocation& pReloc,
   pReloc.setType(llvm::ELF::R_386_TLS_LE);
 }
 
+bool X86_32GNULDBackend::relaxGOT32X(Relocation& pReloc, LDSection& pSection)
+{
+  // the symbol must be resolved to the output at link time
+  ResolveInfo* rsym = pReloc.symInfo();
+  if (!rsym->isLocal() &&
+      (!rsym->isDefine() || rsym->isDyn() || isSymbolPreemptible(*rsym)))
+    return false;
+  if (ResolveInfo::IndirectFunc == rsym->type() || rsym->isAbsolute())
+    return false;
+
+  uint64_t off = pReloc.targetRef().offset();
+  if (off < 2)
+    return false;
+
+  // the ModRM byte is right before the displacement. The forms with a SIB
+  // byte are left as they are.
+  uint8_t insn[2];
+  helper_read_insn(pReloc, off - 2, insn, 2);
+  uint8_t mod = insn[1] & 0xc0;
+  uint8_t rm = insn[1] & 0x07;
+  bool has_base = (0x80 == mod && 0x04 != rm);
+  bool no_base = (0x00 == mod && 0x05 == rm);
+  bool is_call = (0xff == insn[0] && 0x10 == (insn[1] & 0x38));
+  bool is_mov = (0x8b == insn[0]);
+  if ((!is_call && !is_mov) || (!has_base && !no_base))
+    return false;
+  // without a base register, the load gets the absolute address, which
+  // needs a dynamic relocation in PIC
+  if (is_mov && no_base && config().isCodeIndep())
+    return false;
+
+  // mov foo@GOT(%reg1), %reg2  =>  lea foo@GOTOFF(%reg1), %reg2
+  // mov foo@GOT, %reg          =>  mov $foo, %reg
+  // call *foo@GOT(%reg)        =>  addr32 call foo
+  Relocation* reloc = Relocation::Create(X86_32Relocator::R_386_TLS_OPT,
+                                         *pReloc.targetRef().frag(),
+                                         off - 2,
+                                         0x0);
+  pSection.getRelocData()->getRelocationList().insert(
+    RelocData::iterator(pReloc), reloc);
+  uint8_t* op = reinterpret_cast<uint8_t*>(&reloc->target());
+  if (is_call) {
+    op[0] = 0x67;
+    op[1] = 0xe8;
+    // the displacement is relative to the end of the call
+    pReloc.setType(llvm::ELF::R_386_PC32);
+    pReloc.setAddend(pReloc.addend() - 4);
+  }
+  else if (has_base) {
+    op[0] = 0x8d;
+    pReloc.setType(llvm::ELF::R_386_GOTOFF);
+  }
+  else {
+    op[0] = 0xc7;
+    op[1] = 0xc0 | ((insn[1] >> 3) & 0x07);
+    pReloc.setType(llvm::ELF::R_386_32);
+  }
+  return true;
+}
+
 // Create a GOT entry for the TLS module index
 X86_32GOTEntry& X86_32GNULDBackend::getTLSModuleID()
 {
@@ -973,7 +1110,8 @@ X86_32GOTEntry& X86_32GNULDBackend::getTLSModuleID()
   m_pRelDyn->reserveEntry();
   Relocation* rel_entry = m_pRelDyn->consumeEntry();
   rel_entry->setType(llvm::ELF::R_386_TLS_DTPMOD32);
-  rel_entry->targetRef().assign(*got_entry, 0x0);
+  rel_entry->targetRef().assign(got_entry->getTable(),
+                                got_entry->getTableOffset());
   rel_entry->setSymInfo(NULL);
 
   return *got_entry;
@@ -992,6 +1130,17 @@ X86_64GNULDBackend::~X86_64GNULDBackend()
   delete m_pGOTPLT;
 }
 
+void X86_64GNULDBackend::reset()
+{
+  delete m_pGOT;
+  m_pGOT = NULL;
+  delete m_pGOTPLT;
+  m_pGOTPLT = NULL;
+  m_GOTTPOFFSyms.clear();
+  m_TLSDescSyms.clear();
+  X86GNULDBackend::reset();
+}
+
 bool X86_64GNULDBackend::initRelocator()
 {
   if (NULL == m_pRelocator) {
@@ -1068,31 +1217,25 @@ void X86_64GNULDBackend::scanLocalReloc(Relocation& pReloc,
     case llvm::ELF::R_X86_64_PC8:
       return;
 
+    case 41: // FIXME: use llvm enum constant R_X86_64_GOTPCRELX
+    case 42: // FIXME: use llvm enum constant R_X86_64_REX_GOTPCRELX
+      // the load of a non-preemptible symbol needs no GOT entry
+      if (relaxGOTPCRELX(pReloc, pSection))
+        return;
+      // fall through
     case llvm::ELF::R_X86_64_GOTPCREL:
       // Symbol needs GOT entry, reserve entry in .got
-      // return if we already create GOT for this symbol
-      if (rsym->reserved() & (ReserveGOT | GOTRel))
-        return;
-      m_pGOT->reserve();
+      reserveGOT(*rsym);
+      return;
 
-      // If the GOT is used in statically linked binaries,
-      // the GOT entry is enough and no relocation is needed.
-      if (config().isCodeStatic()) {
-        rsym->setReserved(rsym->reserved() | ReserveGOT);
-        return;
-      }
-      // If building shared object or the symbol is undefined, a dynamic
-      // relocation is needed to relocate this GOT entry. Reserve an
-      // entry in .rela.dyn
-      if (LinkerConfig::DynObj ==
-                   config().codeGenType() || rsym->isUndef() || rsym->isDyn()) {
-        m_pRelDyn->reserveEntry();
-        // set GOTRel bit
-        rsym->setReserved(rsym->reserved() | GOTRel);
-        return;
-      }
-      // set GOT bit
-      rsym->setReserved(rsym->reserved() | ReserveGOT);
+    case llvm::ELF::R_X86_64_TLSGD:
+    case llvm::ELF::R_X86_64_TLSLD:
+    case llvm::ELF::R_X86_64_DTPOFF32:
+    case llvm::ELF::R_X86_64_GOTTPOFF:
+    case llvm::ELF::R_X86_64_TPOFF32:
+    case llvm::ELF::R_X86_64_GOTPC32_TLSDESC:
+    case llvm::ELF::R_X86_64_TLSDESC_CALL:
+      scanTLSReloc(pReloc, pSection);
       return;
 
     default:
@@ -1120,17 +1263,8 @@ void X86_64GNULDBackend::scanGlobalReloc(Relocation& pReloc,
       // dynamic relocation entry
       if (symbolNeedsPLT(*rsym)) {
         // create plt for this symbol if it does not have one
-        if (!(rsym->reserved() & ReservePLT)){
-          // Symbol needs PLT entry, we need to reserve a PLT entry
-          // and the corresponding GOT and dynamic relocation entry
-          // in .got and .rela.plt. (GOT entry will be reserved simultaneously
-          // when calling X86PLT->reserveEntry())
-          m_pPLT->reserveEntry();
-          m_pGOTPLT->reserve();
-          m_pRelPLT->reserveEntry();
-          // set PLT bit
-          rsym->setReserved(rsym->reserved() | ReservePLT);
-        }
+        if (!(rsym->reserved() & ReservePLT))
+          reservePLT(*rsym);
       }
 
       if (symbolNeedsDynRel(*rsym, (rsym->reserved() & ReservePLT), true)) {
@@ -1148,31 +1282,15 @@ void X86_64GNULDBackend::scanGlobalReloc(Relocation& pReloc,
       }
       return;
 
+    case 41: // FIXME: use llvm enum constant R_X86_64_GOTPCRELX
+    case 42: // FIXME: use llvm enum constant R_X86_64_REX_GOTPCRELX
+      // the load of a non-preemptible symbol needs no GOT entry
+      if (relaxGOTPCRELX(pReloc, pSection))
+        return;
+      // fall through
     case llvm::ELF::R_X86_64_GOTPCREL:
       // Symbol needs GOT entry, reserve entry in .got
-      // return if we already create GOT for this symbol
-      if (rsym->reserved() & (ReserveGOT | GOTRel))
-        return;
-      m_pGOT->reserve();
-
-      // If the GOT is used in statically linked binaries,
-      // the GOT entry is enough and no relocation is needed.
-      if (config().isCodeStatic()) {
-        rsym->setReserved(rsym->reserved() | ReserveGOT);
-        return;
-      }
-      // If building shared object or the symbol is undefined, a dynamic
-      // relocation is needed to relocate this GOT entry. Reserve an
-      // entry in .rela.dyn
-      if (LinkerConfig::DynObj ==
-                   config().codeGenType() || rsym->isUndef() || rsym->isDyn()) {
-        m_pRelDyn->reserveEntry();
-        // set GOTRel bit
-        rsym->setReserved(rsym->reserved() | GOTRel);
-        return;
-      }
-      // set GOT bit
-      rsym->setReserved(rsym->reserved() | ReserveGOT);
+      reserveGOT(*rsym);
       return;
 
     case llvm::ELF::R_X86_64_PLT32:
@@ -1193,15 +1311,7 @@ void X86_64GNULDBackend::scanGlobalReloc(Relocation& pReloc,
         return;
       }
 
-      // Symbol needs PLT entry, we need to reserve a PLT entry
-      // and the corresponding GOT and dynamic relocation entry
-      // in .got and .rel.plt. (GOT entry will be reserved simultaneously
-      // when calling X86PLT->reserveEntry())
-      m_pPLT->reserveEntry();
-      m_pGOTPLT->reserve();
-      m_pRelPLT->reserveEntry();
-      // set PLT bit
-      rsym->setReserved(rsym->reserved() | ReservePLT);
+      reservePLT(*rsym);
       return;
 
     case llvm::ELF::R_X86_64_PC32:
@@ -1210,17 +1320,8 @@ void X86_64GNULDBackend::scanGlobalReloc(Relocation& pReloc,
       if (symbolNeedsPLT(*rsym) &&
           LinkerConfig::DynObj != config().codeGenType()) {
         // create plt for this symbol if it does not have one
-        if (!(rsym->reserved() & ReservePLT)){
-          // Symbol needs PLT entry, we need to reserve a PLT entry
-          // and the corresponding GOT and dynamic relocation entry
-          // in .got and .rel.plt. (GOT entry will be reserved simultaneously
-          // when calling X86PLT->reserveEntry())
-          m_pPLT->reserveEntry();
-          m_pGOTPLT->reserve();
-          m_pRelPLT->reserveEntry();
-          // set PLT bit
-          rsym->setReserved(rsym->reserved() | ReservePLT);
-        }
+        if (!(rsym->reserved() & ReservePLT))
+          reservePLT(*rsym);
       }
 
       // Only PC relative relocation against dynamic symbol needs a
@@ -1237,6 +1338,16 @@ void X86_64GNULDBackend::scanGlobalReloc(Relocation& pReloc,
       }
       return;
 
+    case llvm::ELF::R_X86_64_TLSGD:
+    case llvm::ELF::R_X86_64_TLSLD:
+    case llvm::ELF::R_X86_64_DTPOFF32:
+    case llvm::ELF::R_X86_64_GOTTPOFF:
+    case llvm::ELF::R_X86_64_TPOFF32:
+    case llvm::ELF::R_X86_64_GOTPC32_TLSDESC:
+    case llvm::ELF::R_X86_64_TLSDESC_CALL:
+      scanTLSReloc(pReloc, pSection);
+      return;
+
     default:
       fatal(diag::unsupported_relocation) << (int)pReloc.type()
                                           << "mclinker@googlegroups.com";
@@ -1244,6 +1355,466 @@ void X86_64GNULDBackend::scanGlobalReloc(Relocation& pReloc,
   } // end switch
 }
 
+void X86_64GNULDBackend::reserveGOT(ResolveInfo& pSym)
+{
+  // return if we already create GOT for this symbol
+  if (pSym.reserved() & (ReserveGOT | GOTRel))
+    return;
+  m_pGOT->reserve();
+
+  // If the GOT is used in statically linked binaries,
+  // the GOT entry is enough and no relocation is needed.
+  if (config().isCodeStatic()) {
+    pSym.setReserved(pSym.reserved() | ReserveGOT);
+    return;
+  }
+  // If building shared object or the symbol is undefined, a dynamic
+  // relocation is needed to relocate this GOT entry. Reserve an
+  // entry in .rela.dyn
+  if (LinkerConfig::DynObj ==
+               config().codeGenType() || pSym.isUndef() || pSym.isDyn()) {
+    m_pRelDyn->reserveEntry();
+    // set GOTRel bit
+    pSym.setReserved(pSym.reserved() | GOTRel);
+    return;
+  }
+  // set GOT bit
+  pSym.setReserved(pSym.reserved() | ReserveGOT);
+}
+
+void X86_64GNULDBackend::reservePLT(ResolveInfo& pSym)
+{
+  // Symbol needs PLT entry, we need to reserve a PLT entry
+  // and the corresponding GOT and dynamic relocation entry.
+  m_pPLT->reserveEntry();
+  if (m_pPLT->isLazy()) {
+    // the entry in .got.plt and .rela.plt for the lazy binding
+    m_pGOTPLT->reserve();
+    m_pRelPLT->reserveEntry();
+  }
+  else {
+    // all symbols are bound at load time, the PLT entry jumps through the
+    // .got entry of the symbol, which is relocated by R_X86_64_GLOB_DAT
+    reserveGOT(pSym);
+  }
+  // set PLT bit
+  pSym.setReserved(pSym.reserved() | ReservePLT);
+}
+
+bool X86_64GNULDBackend::isTLSOffsetKnown(const ResolveInfo& pSym) const
+{
+  return !config().isCodeIndep() &&
+         (LinkerConfig::Exec == config().codeGenType() ||
+          LinkerConfig::Binary == config().codeGenType()) &&
+         !pSym.isUndef() && symbolFinalValueIsKnown(pSym);
+}
+
+void X86_64GNULDBackend::scanTLSReloc(Relocation& pReloc,
+                                      LDSection& pSection)
+{
+  // Only the executables know the offsets of the TLS symbols to the thread
+  // pointer. The initial-exec and TLS descriptor models go through .got, and
+  // the other TLS models are unsupported.
+  ResolveInfo* rsym = pReloc.symInfo();
+  bool is_exec = !config().isCodeIndep() &&
+                 (LinkerConfig::Exec == config().codeGenType() ||
+                  LinkerConfig::Binary == config().codeGenType());
+  bool is_local_exec = isTLSOffsetKnown(*rsym);
+
+  bool relaxed = false;
+  switch (pReloc.type()) {
+    case llvm::ELF::R_X86_64_TLSGD:
+      relaxed = is_local_exec && convertTLSGDtoLE(pReloc, pSection);
+      break;
+    case llvm::ELF::R_X86_64_TLSLD:
+      relaxed = is_exec && convertTLSLDtoLE(pReloc, pSection);
+      break;
+    case llvm::ELF::R_X86_64_GOTTPOFF:
+      relaxed = is_local_exec && convertTLSIEtoLE(pReloc, pSection);
+      if (!relaxed) {
+        // the offset is loaded from .got
+        if (!is_exec)
+          setHasStaticTLS();
+        reserveGOTTPOFF(*rsym);
+        relaxed = true;
+      }
+      break;
+    case llvm::ELF::R_X86_64_GOTPC32_TLSDESC:
+      // the descriptors are only kept in the shared objects. Both
+      // relocations of a descriptor in an executable have to be relaxed.
+      if (is_local_exec)
+        relaxed = convertTLSDESCtoLE(pReloc, pSection);
+      else if (is_exec) {
+        relaxed = convertTLSDESCtoIE(pReloc, pSection);
+        if (relaxed)
+          reserveGOTTPOFF(*rsym);
+      }
+      else {
+        reserveTLSDesc(*rsym);
+        relaxed = true;
+      }
+      break;
+    case llvm::ELF::R_X86_64_TLSDESC_CALL:
+      relaxed = !is_exec || relaxTLSDESCCall(pReloc, pSection);
+      break;
+    case llvm::ELF::R_X86_64_DTPOFF32:
+      // the module of an executable starts at the thread pointer once the
+      // R_X86_64_TLSLD is relaxed
+      if (is_exec)
+        pReloc.setType(llvm::ELF::R_X86_64_TPOFF32);
+      relaxed = true;
+      break;
+    case llvm::ELF::R_X86_64_TPOFF32:
+      relaxed = is_local_exec;
+      break;
+    default:
+      break;
+  }
+
+  if (!relaxed) {
+    fatal(diag::unsupported_relocation) << (int)pReloc.type()
+                                        << "mclinker@googlegroups.com";
+  }
+}
+
+void X86_64GNULDBackend::reserveGOTTPOFF(const ResolveInfo& pSym)
+{
+  if (!m_GOTTPOFFSyms.insert(&pSym).second)
+    return;
+  m_pGOT->reserve();
+  if (!isTLSOffsetKnown(pSym))
+    m_pRelDyn->reserveEntry();
+}
+
+void X86_64GNULDBackend::reserveTLSDesc(const ResolveInfo& pSym)
+{
+  if (!m_TLSDescSyms.insert(&pSym).second)
+    return;
+  // the resolver function and its argument, both filled by the dynamic
+  // linker at load time
+  m_pGOT->reserve(2);
+  m_pRelDyn->reserveEntry();
+}
+
+Relocation& X86_64GNULDBackend::createOptReloc(Relocation::Type pType,
+                                               Relocation& pReloc,
+                                               uint64_t pOffset,
+                                               LDSection& pSection)
+{
+  assert(NULL != pReloc.targetRef().frag());
+  Relocation* reloc = Relocation::Create(pType,
+                                         *pReloc.targetRef().frag(),
+                                         pOffset,
+                                         0x0);
+  pSection.getRelocData()->getRelocationList().insert(
+    RelocData::iterator(pReloc), reloc);
+  return *reloc;
+}
+
+/// helper_next_reloc - the relocation following pReloc at pOffset of the same
+/// fragment
+static Relocation* helper_next_reloc(Relocation& pReloc,
+                                     uint64_t pOffset,
+                                     LDSection& pSection)
+{
+  RelocData::iterator next(pReloc);
+  ++next;
+  if (pSection.getRelocData()->end() == next)
+    return NULL;
+  Relocation* reloc = llvm::cast<Relocation>(next);
+  if (reloc->targetRef().frag() != pReloc.targetRef().frag() ||
+      reloc->targetRef().offset() != pOffset)
+    return NULL;
+  return reloc;
+}
+
+bool X86_64GNULDBackend::RewriteGOTPCRELX(uint8_t* pInsn, bool pAllowCall)
+{
+  // mov foo@GOTPCREL(%rip), %reg  =>  lea foo(%rip), %reg
+  if (0x8b == pInsn[0]) {
+    pInsn[0] = 0x8d;
+    return true;
+  }
+
+  // call *foo@GOTPCREL(%rip)      =>  addr32 call foo
+  if (pAllowCall && 0xff == pInsn[0] && 0x15 == pInsn[1]) {
+    pInsn[0] = 0x67;
+    pInsn[1] = 0xe8;
+    return true;
+  }
+  return false;
+}
+
+bool X86_64GNULDBackend::RewriteTLSGDtoLE(uint8_t* pInsn)
+{
+  // data16 lea x@tlsgd(%rip), %rdi
+  // data16 data16 rex64 call __tls_get_addr@plt
+  static const uint8_t gd[] = { 0x66, 0x48, 0x8d, 0x3d };
+  static const uint8_t call[] = { 0x66, 0x66, 0x48, 0xe8 };
+  if (0 != memcmp(pInsn, gd, 4) || 0 != memcmp(pInsn + 8, call, 4))
+    return false;
+
+  // mov %fs:0, %rax
+  // lea x@tpoff(%rax), %rax
+  static const uint8_t le[] = { 0x64, 0x48, 0x8b, 0x04, 0x25, 0x00, 0x00, 0x00,
+                                0x00, 0x48, 0x8d, 0x80 };
+  memcpy(pInsn, le, sizeof(le));
+  return true;
+}
+
+bool X86_64GNULDBackend::RewriteTLSLDtoLE(uint8_t* pInsn)
+{
+  // lea x@tlsld(%rip), %rdi
+  // call __tls_get_addr@plt
+  static const uint8_t ld[] = { 0x48, 0x8d, 0x3d };
+  if (0 != memcmp(pInsn, ld, 3) || 0xe8 != pInsn[7])
+    return false;
+
+  // data16 data16 data16 mov %fs:0, %rax
+  static const uint8_t le[] = { 0x66, 0x66, 0x66, 0x64, 0x48, 0x8b, 0x04, 0x25,
+                                0x00, 0x00, 0x00, 0x00 };
+  memcpy(pInsn, le, sizeof(le));
+  return true;
+}
+
+bool X86_64GNULDBackend::RewriteTLSIEtoLE(uint8_t* pInsn)
+{
+  // mov x@gottpoff(%rip), %reg  or  add x@gottpoff(%rip), %reg
+  if ((0x48 != pInsn[0] && 0x4c != pInsn[0]) ||
+      (0x8b != pInsn[1] && 0x03 != pInsn[1]) ||
+      0x05 != (pInsn[2] & 0xc7))
+    return false;
+
+  // mov $x@tpoff, %reg  or  add $x@tpoff, %reg
+  if (0x4c == pInsn[0])
+    pInsn[0] = 0x49;
+  pInsn[1] = (0x8b == pInsn[1]) ? 0xc7 : 0x81;
+  pInsn[2] = 0xc0 | ((pInsn[2] >> 3) & 7);
+  return true;
+}
+
+/// helper_is_tlsdesc_lea - is pInsn the REX prefix, the opcode and the ModRM
+/// byte of the lea of a TLS descriptor?
+static bool helper_is_tlsdesc_lea(const uint8_t* pInsn)
+{
+  // lea x@tlsdesc(%rip), %reg
+  return ((0x48 == pInsn[0] || 0x4c == pInsn[0]) &&
+          0x8d == pInsn[1] &&
+          0x05 == (pInsn[2] & 0xc7));
+}
+
+bool X86_64GNULDBackend::RewriteTLSDESCtoLE(uint8_t* pInsn)
+{
+  if (!helper_is_tlsdesc_lea(pInsn))
+    return false;
+
+  // mov $x@tpoff, %reg
+  if (0x4c == pInsn[0])
+    pInsn[0] = 0x49;
+  pInsn[1] = 0xc7;
+  pInsn[2] = 0xc0 | ((pInsn[2] >> 3) & 7);
+  return true;
+}
+
+bool X86_64GNULDBackend::RewriteTLSDESCtoIE(uint8_t* pInsn)
+{
+  if (!helper_is_tlsdesc_lea(pInsn))
+    return false;
+
+  // mov x@gottpoff(%rip), %reg
+  pInsn[1] = 0x8b;
+  return true;
+}
+
+bool X86_64GNULDBackend::RewriteTLSDESCCall(uint8_t* pInsn)
+{
+  // call *x@tlsdesc(%rax)  =>  xchg %ax, %ax
+  if (0xff != pInsn[0] || 0x10 != pInsn[1])
+    return false;
+  pInsn[0] = 0x66;
+  pInsn[1] = 0x90;
+  return true;
+}
+
+bool X86_64GNULDBackend::relaxGOTPCRELX(Relocation& pReloc,
+                                        LDSection& pSection)
+{
+  // the symbol must be resolved to the output at link time
+  ResolveInfo* rsym = pReloc.symInfo();
+  if (!rsym->isLocal() &&
+      (!rsym->isDefine() || rsym->isDyn() || isSymbolPreemptible(*rsym)))
+    return false;
+  if (ResolveInfo::IndirectFunc == rsym->type() || rsym->isAbsolute())
+    return false;
+
+  uint64_t off = pReloc.targetRef().offset();
+  if (off < 2)
+    return false;
+
+  uint8_t insn[2];
+  helper_read_insn(pReloc, off - 2, insn, 2);
+  // FIXME: use llvm enum constant R_X86_64_GOTPCRELX
+  if (!RewriteGOTPCRELX(insn, 41 == pReloc.type()))
+    return false;
+
+  Relocation& reloc = createOptReloc(X86_64Relocator::R_X86_64_OPT32,
+                                     pReloc, off - 2, pSection);
+  memcpy(&reloc.target(), insn, 2);
+
+  pReloc.setType(llvm::ELF::R_X86_64_PC32);
+  return true;
+}
+
+bool X86_64GNULDBackend::convertTLSGDtoLE(Relocation& pReloc,
+                                          LDSection& pSection)
+{
+  uint64_t off = pReloc.targetRef().offset();
+  if (off < 4)
+    return false;
+
+  // the call of __tls_get_addr follows the lea
+  Relocation* call = helper_next_reloc(pReloc, off + 8, pSection);
+  if (NULL == call || (llvm::ELF::R_X86_64_PLT32 != call->type() &&
+                       llvm::ELF::R_X86_64_PC32 != call->type()))
+    return false;
+
+  uint8_t insn[12];
+  helper_read_insn(pReloc, off - 4, insn, 12);
+  if (!RewriteTLSGDtoLE(insn))
+    return false;
+
+  Relocation& first = createOptReloc(X86_64Relocator::R_X86_64_OPT64,
+                                     pReloc, off - 4, pSection);
+  memcpy(&first.target(), insn, 8);
+  Relocation& second = createOptReloc(X86_64Relocator::R_X86_64_OPT32,
+                                      pReloc, off + 4, pSection);
+  memcpy(&second.target(), insn + 8, 4);
+
+  // the call is gone, and the offset is applied to the lea
+  pReloc.targetRef().assign(*pReloc.targetRef().frag(), off + 8);
+  pReloc.setType(llvm::ELF::R_X86_64_TPOFF32);
+  pReloc.setAddend(pReloc.addend() + 4);
+  call->setType(llvm::ELF::R_X86_64_NONE);
+  return true;
+}
+
+bool X86_64GNULDBackend::convertTLSLDtoLE(Relocation& pReloc,
+                                          LDSection& pSection)
+{
+  uint64_t off = pReloc.targetRef().offset();
+  if (off < 3)
+    return false;
+
+  // the call of __tls_get_addr follows the lea
+  Relocation* call = helper_next_reloc(pReloc, off + 5, pSection);
+  if (NULL == call || (llvm::ELF::R_X86_64_PLT32 != call->type() &&
+                       llvm::ELF::R_X86_64_PC32 != call->type()))
+    return false;
+
+  uint8_t insn[12];
+  helper_read_insn(pReloc, off - 3, insn, 12);
+  if (!RewriteTLSLDtoLE(insn))
+    return false;
+
+  Relocation& first = createOptReloc(X86_64Relocator::R_X86_64_OPT64,
+                                     pReloc, off - 3, pSection);
+  memcpy(&first.target(), insn, 8);
+  Relocation& second = createOptReloc(X86_64Relocator::R_X86_64_OPT32,
+                                      pReloc, off + 5, pSection);
+  memcpy(&second.target(), insn + 8, 4);
+
+  pReloc.setType(llvm::ELF::R_X86_64_NONE);
+  call->setType(llvm::ELF::R_X86_64_NONE);
+  return true;
+}
+
+bool X86_64GNULDBackend::convertTLSIEtoLE(Relocation& pReloc,
+                                          LDSection& pSection)
+{
+  uint64_t off = pReloc.targetRef().offset();
+  if (off < 3)
+    return false;
+
+  uint8_t insn[3];
+  helper_read_insn(pReloc, off - 3, insn, 3);
+  if (!RewriteTLSIEtoLE(insn))
+    return false;
+
+  Relocation& reloc = createOptReloc(X86_64Relocator::R_X86_64_OPT32,
+                                     pReloc, off - 3, pSection);
+  memcpy(&reloc.target(), insn, 3);
+
+  pReloc.setType(llvm::ELF::R_X86_64_TPOFF32);
+  pReloc.setAddend(pReloc.addend() + 4);
+  return true;
+}
+
+bool X86_64GNULDBackend::convertTLSDESCtoLE(Relocation& pReloc,
+                                            LDSection& pSection)
+{
+  uint64_t off = pReloc.targetRef().offset();
+  if (off < 3)
+    return false;
+
+  uint8_t insn[3];
+  helper_read_insn(pReloc, off - 3, insn, 3);
+  if (!RewriteTLSDESCtoLE(insn))
+    return false;
+
+  Relocation& reloc = createOptReloc(X86_64Relocator::R_X86_64_OPT32,
+                                     pReloc, off - 3, pSection);
+  memcpy(&reloc.target(), insn, 3);
+
+  pReloc.setType(llvm::ELF::R_X86_64_TPOFF32);
+  pReloc.setAddend(pReloc.addend() + 4);
+  return true;
+}
+
+bool X86_64GNULDBackend::convertTLSDESCtoIE(Relocation& pReloc,
+                                            LDSection& pSection)
+{
+  uint64_t off = pReloc.targetRef().offset();
+  if (off < 3)
+    return false;
+
+  uint8_t insn[3];
+  helper_read_insn(pReloc, off - 3, insn, 3);
+  if (!RewriteTLSDESCtoIE(insn))
+    return false;
+
+  Relocation& reloc = createOptReloc(X86_64Relocator::R_X86_64_OPT32,
+                                     pReloc, off - 3, pSection);
+  memcpy(&reloc.target(), insn, 3);
+
+  pReloc.setType(llvm::ELF::R_X86_64_GOTTPOFF);
+  return true;
+}
+
+bool X86_64GNULDBackend::relaxTLSDESCCall(Relocation& pReloc,
+                                          LDSection& pSection)
+{
+  uint64_t off = pReloc.targetRef().offset();
+  uint8_t insn[2];
+  helper_read_insn(pReloc, off, insn, 2);
+  if (!RewriteTLSDESCCall(insn))
+    return false;
+
+  // The rewriting relocation covers 4 bytes, so it starts before the call if
+  // the call ends the fragment.
+  uint64_t start = off;
+  if (off + 4 > pReloc.targetRef().frag()->size()) {
+    if (off < 2)
+      return false;
+    start = off - 2;
+  }
+  Relocation& reloc = createOptReloc(X86_64Relocator::R_X86_64_OPT32,
+                                     pReloc, start, pSection);
+  memcpy(reinterpret_cast<uint8_t*>(&reloc.target()) + (off - start), insn, 2);
+
+  pReloc.setType(llvm::ELF::R_X86_64_NONE);
+  return true;
+}
+
 void X86_64GNULDBackend::initTargetSections(Module& pModule,
 					    ObjectBuilder& pBuilder)
 {
@@ -1260,6 +1831,7 @@ void X86_64GNULDBackend::initTargetSections(Module& pModule,
     // initialize .plt
     LDSection& plt = file_format->getPLT();
     m_pPLT = new X86_64PLT(plt,
+			   *m_pGOT,
 			   *m_pGOTPLT,
 			   config());
 
@@ -1296,18 +1868,11 @@ uint64_t X86_64GNULDBackend::emitGOTSectionData(MemoryRegion& pRegion) const
 
   uint64_t* buffer = reinterpret_cast<uint64_t*>(pRegion.getBuffer());
 
-  X86_64GOTEntry* got = 0;
-  unsigned int EntrySize = X86_64GOTEntry::EntrySize;
-  uint64_t RegionSize = 0;
+  size_t num = m_pGOT->numOfEntries();
+  for (size_t i = 0; i < num; ++i)
+    buffer[i] = static_cast<uint64_t>(m_pGOT->getEntry(i).getValue());
 
-  for (X86_64GOT::iterator it = m_pGOT->begin(),
-       ie = m_pGOT->end(); it != ie; ++it, ++buffer) {
-    got = &(llvm::cast<X86_64GOTEntry>((*it)));
-    *buffer = static_cast<uint64_t>(got->getValue());
-    RegionSize += EntrySize;
-  }
-
-  return RegionSize;
+  return num * X86_64GOTEntry::EntrySize;
 }
 
 uint64_t X86_64GNULDBackend::emitGOTPLTSectionData(MemoryRegion& pRegion,
@@ -1319,18 +1884,11 @@ uint64_t X86_64GNULDBackend::emitGOTPLTSectionData(MemoryRegion& pRegion,
 
   uint64_t* buffer = reinterpret_cast<uint64_t*>(pRegion.getBuffer());
 
-  X86_64GOTEntry* got = 0;
-  unsigned int EntrySize = X86_64GOTEntry::EntrySize;
-  uint64_t RegionSize = 0;
+  size_t num = m_pGOTPLT->numOfEntries();
+  for (size_t i = 0; i < num; ++i)
+    buffer[i] = static_cast<uint64_t>(m_pGOTPLT->getEntry(i).getValue());
 
-  for (X86_64GOTPLT::iterator it = m_pGOTPLT->begin(),
-       ie = m_pGOTPLT->end(); it != ie; ++it, ++buffer) {
-    got = &(llvm::cast<X86_64GOTEntry>((*it)));
-    *buffer = static_cast<uint64_t>(got->getValue());
-    RegionSize += EntrySize;
-  }
-
-  return RegionSize;
+  return num * X86_64GOTEntry::EntrySize;
 }
 
 namespace mcld {
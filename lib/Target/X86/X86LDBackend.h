@@ -17,6 +17,8 @@
 #include <mcld/Target/GNULDBackend.h>
 #include <mcld/Target/OutputRelocSection.h>
 
+#include <llvm/ADT/DenseSet.h>
+
 namespace mcld {
 
 class LinkerConfig;
@@ -78,6 +80,8 @@ public:
 
   ~X86GNULDBackend();
 
+  void reset();
+
   uint32_t machine() const;
 
   X86PLT& getPLT();
@@ -116,6 +120,9 @@ public:
   uint64_t emitSectionData(const LDSection& pSection,
                            MemoryRegion& pRegion) const;
 
+  /// emitNops - fill the padding of an executable section with nops
+  void emitNops(uint8_t* pBuffer, uint64_t pOffset, uint64_t pSize) const;
+
   /// initRelocator - create and initialize Relocator.
   virtual bool initRelocator() = 0;
 
@@ -137,6 +144,10 @@ public:
                       Module& pModule,
                       LDSection& pSection);
 
+  /// preScanRelocation - update the addend, and skip the relocations of the
+  /// non-allocated sections
+  bool preScanRelocation(Relocation& pReloc, const LDSection& pSection);
+
   OutputRelocSection& getRelDyn();
 
   const OutputRelocSection& getRelDyn() const;
@@ -232,6 +243,8 @@ public:
 
   ~X86_32GNULDBackend();
 
+  void reset();
+
   void initTargetSections(Module& pModule, ObjectBuilder& pBuilder);
 
   X86_32GOT& getGOT();
@@ -255,6 +268,14 @@ private:
                        Module& pModule,
                        LDSection& pSection);
 
+  /// reserveGOT - reserve the .got entry of pSym and its dynamic relocation
+  void reserveGOT(ResolveInfo& pSym);
+
+  /// reservePLT - reserve the PLT entry of pSym. A lazy PLT entry has its own
+  /// .got.plt entry and .rel.plt relocation, and a non-lazy one shares the
+  /// .got entry of pSym.
+  void reservePLT(ResolveInfo& pSym);
+
   /// initRelocator - create and initialize Relocator.
   bool initRelocator();
 
@@ -262,6 +283,12 @@ private:
   /// convert R_386_TLS_IE to R_386_TLS_LE
   void convertTLSIEtoLE(Relocation& pReloc, LDSection& pSection);
 
+  /// -----  relaxation  ----- ///
+  /// relax R_386_GOT32X of a non-preemptible symbol. The load through the
+  /// GOT becomes a lea of R_386_GOTOFF, or a mov of R_386_32 in non-PIC
+  /// code, and the indirect call becomes a direct call of R_386_PC32.
+  bool relaxGOT32X(Relocation& pReloc, LDSection& pSection);
+
   void setGOTSectionSize(IRBuilder& pBuilder);
 
   uint64_t emitGOTSectionData(MemoryRegion& pRegion) const;
@@ -288,6 +315,8 @@ public:
 
   ~X86_64GNULDBackend();
 
+  void reset();
+
   void initTargetSections(Module& pModule, ObjectBuilder& pBuilder);
 
   X86_64GOT& getGOT();
@@ -298,6 +327,41 @@ public:
 
   const X86_64GOTPLT& getGOTPLT() const;
 
+  /// isTLSOffsetKnown - is the offset of the TLS symbol pSym to the thread
+  /// pointer known at link time? It is if an executable defines pSym.
+  bool isTLSOffsetKnown(const ResolveInfo& pSym) const;
+
+  /// -----  instruction rewriting of relaxation  ----- ///
+  /// Each function checks the instruction bytes at pInsn around the place of
+  /// a relocation, rewrites them in place, and returns true. If the bytes are
+  /// not the code sequence the ABI expects, it returns false and leaves them
+  /// untouched.
+
+  /// RewriteGOTPCRELX - the 2 bytes before R_X86_64_[REX_]GOTPCRELX. The
+  /// indirect call is only relaxed for R_X86_64_GOTPCRELX (pAllowCall).
+  static bool RewriteGOTPCRELX(uint8_t* pInsn, bool pAllowCall);
+
+  /// RewriteTLSGDtoLE - the 12 bytes from 4 bytes before R_X86_64_TLSGD
+  static bool RewriteTLSGDtoLE(uint8_t* pInsn);
+
+  /// RewriteTLSLDtoLE - the 12 bytes from 3 bytes before R_X86_64_TLSLD
+  static bool RewriteTLSLDtoLE(uint8_t* pInsn);
+
+  /// RewriteTLSIEtoLE - the 3 bytes before R_X86_64_GOTTPOFF
+  static bool RewriteTLSIEtoLE(uint8_t* pInsn);
+
+  /// RewriteTLSDESCtoLE - the 3 bytes before R_X86_64_GOTPC32_TLSDESC
+  static bool RewriteTLSDESCtoLE(uint8_t* pInsn);
+
+  /// RewriteTLSDESCtoIE - the 3 bytes before R_X86_64_GOTPC32_TLSDESC
+  static bool RewriteTLSDESCtoIE(uint8_t* pInsn);
+
+  /// RewriteTLSDESCCall - the 2 bytes at R_X86_64_TLSDESC_CALL
+  static bool RewriteTLSDESCCall(uint8_t* pInsn);
+
+private:
+  typedef llvm::DenseSet<const ResolveInfo*> TLSSymbolSet;
+
 private:
   void scanLocalReloc(Relocation& pReloc,
                       IRBuilder& pBuilder,
@@ -309,9 +373,64 @@ private:
                        Module& pModule,
                        LDSection& pSection);
 
+  /// scanTLSReloc - relax the TLS relocations to the local-exec model, and
+  /// the TLS descriptors of an executable to the initial-exec model
+  void scanTLSReloc(Relocation& pReloc, LDSection& pSection);
+
+  /// reserveGOTTPOFF - reserve the .got entry holding the offset of pSym to
+  /// the thread pointer, and its R_X86_64_TPOFF64 if the offset is unknown
+  void reserveGOTTPOFF(const ResolveInfo& pSym);
+
+  /// reserveTLSDesc - reserve the TLS descriptor of pSym, a pair of .got
+  /// entries relocated by R_X86_64_TLSDESC
+  void reserveTLSDesc(const ResolveInfo& pSym);
+
+  /// reserveGOT - reserve the .got entry of pSym and its dynamic relocation
+  void reserveGOT(ResolveInfo& pSym);
+
+  /// reservePLT - reserve the PLT entry of pSym. A lazy PLT entry has its own
+  /// .got.plt entry and .rela.plt relocation, and a non-lazy one shares the
+  /// .got entry of pSym.
+  void reservePLT(ResolveInfo& pSym);
+
   /// initRelocator - create and initialize Relocator.
   bool initRelocator();
 
+  /// -----  relaxation  ----- ///
+  /// relax R_X86_64_[REX_]GOTPCRELX of a non-preemptible symbol to
+  /// R_X86_64_PC32, the load through the GOT becomes a lea
+  bool relaxGOTPCRELX(Relocation& pReloc, LDSection& pSection);
+
+  /// convert R_X86_64_TLSGD and the call of __tls_get_addr to
+  /// R_X86_64_TPOFF32
+  bool convertTLSGDtoLE(Relocation& pReloc, LDSection& pSection);
+
+  /// convert R_X86_64_TLSLD and the call of __tls_get_addr to the load of
+  /// the thread pointer
+  bool convertTLSLDtoLE(Relocation& pReloc, LDSection& pSection);
+
+  /// convert R_X86_64_GOTTPOFF to R_X86_64_TPOFF32
+  bool convertTLSIEtoLE(Relocation& pReloc, LDSection& pSection);
+
+  /// convert R_X86_64_GOTPC32_TLSDESC to R_X86_64_TPOFF32, the load of the
+  /// descriptor becomes the load of the offset
+  bool convertTLSDESCtoLE(Relocation& pReloc, LDSection& pSection);
+
+  /// convert R_X86_64_GOTPC32_TLSDESC to R_X86_64_GOTTPOFF, the load of the
+  /// descriptor becomes the load of the offset from .got
+  bool convertTLSDESCtoIE(Relocation& pReloc, LDSection& pSection);
+
+  /// relax the call of the TLS descriptor at R_X86_64_TLSDESC_CALL to a nop,
+  /// once its R_X86_64_GOTPC32_TLSDESC is converted
+  bool relaxTLSDESCCall(Relocation& pReloc, LDSection& pSection);
+
+  /// createOptReloc - create a relocation rewriting the instruction at
+  /// pOffset of the place of pReloc, and insert it before pReloc
+  Relocation& createOptReloc(Relocation::Type pType,
+                             Relocation& pReloc,
+                             uint64_t pOffset,
+                             LDSection& pSection);
+
   void setGOTSectionSize(IRBuilder& pBuilder);
 
   uint64_t emitGOTSectionData(MemoryRegion& pRegion) const;
@@ -325,6 +444,10 @@ private:
 private:
   X86_64GOT* m_pGOT;
   X86_64GOTPLT* m_pGOTPLT;
+
+  /// the symbols with a R_X86_64_GOTTPOFF entry and with a TLS descriptor
+  TLSSymbolSet m_GOTTPOFFSyms;
+  TLSSymbolSet m_TLSDescSyms;
 };
 } // namespace of mcld
 
@@ -26,31 +26,16 @@ X86_32DynPLT0::X86_32DynPLT0(SectionData& pParent)
 {
 }
 
-X86_32DynPLT1::X86_32DynPLT1(SectionData& pParent)
-  : PLT::Entry<sizeof(x86_32_dyn_plt1)>(pParent)
-{
-}
-
 X86_32ExecPLT0::X86_32ExecPLT0(SectionData& pParent)
   : PLT::Entry<sizeof(x86_32_exec_plt0)>(pParent)
 {
 }
 
-X86_32ExecPLT1::X86_32ExecPLT1(SectionData& pParent)
-  : PLT::Entry<sizeof(x86_32_exec_plt1)>(pParent)
-{
-}
-
 X86_64PLT0::X86_64PLT0(SectionData& pParent)
   : PLT::Entry<sizeof(x86_64_plt0)>(pParent)
 {
 }
 
-X86_64PLT1::X86_64PLT1(SectionData& pParent)
-  : PLT::Entry<sizeof(x86_64_plt1)>(pParent)
-{
-}
-
 //===----------------------------------------------------------------------===//
 // X86PLT
 //===----------------------------------------------------------------------===//
@@ -58,6 +43,11 @@ X86PLT::X86PLT(LDSection& pSection,
 	       const LinkerConfig& pConfig,
 	       int got_size)
   : PLT(pSection),
+    m_pPLT1Table(NULL),
+    m_NumOfConsumed(0),
+    m_bLazy(!pConfig.options().hasNow()),
+    m_PLT0(NULL),
+    m_PLT0Size(0),
     m_Config(pConfig)
 {
   assert(LinkerConfig::DynObj == m_Config.codeGenType() ||
@@ -66,33 +56,37 @@ X86PLT::X86PLT(LDSection& pSection,
 
   if (got_size == 32) {
     if (LinkerConfig::DynObj == m_Config.codeGenType()) {
-      m_PLT0 = x86_32_dyn_plt0;
-      m_PLT1 = x86_32_dyn_plt1;
-      m_PLT0Size = sizeof (x86_32_dyn_plt0);
+      m_PLT1 = m_bLazy ? x86_32_dyn_plt1 : x86_32_dyn_nonlazy_plt1;
       m_PLT1Size = sizeof (x86_32_dyn_plt1);
-      // create PLT0
-      new X86_32DynPLT0(*m_SectionData);
+      if (m_bLazy) {
+        m_PLT0 = x86_32_dyn_plt0;
+        m_PLT0Size = sizeof (x86_32_dyn_plt0);
+        // create PLT0
+        new X86_32DynPLT0(*m_SectionData);
+      }
     }
     else {
-      m_PLT0 = x86_32_exec_plt0;
-      m_PLT1 = x86_32_exec_plt1;
-      m_PLT0Size = sizeof (x86_32_exec_plt0);
+      m_PLT1 = m_bLazy ? x86_32_exec_plt1 : x86_32_exec_nonlazy_plt1;
       m_PLT1Size = sizeof (x86_32_exec_plt1);
-      // create PLT0
-      new X86_32ExecPLT0(*m_SectionData);
+      if (m_bLazy) {
+        m_PLT0 = x86_32_exec_plt0;
+        m_PLT0Size = sizeof (x86_32_exec_plt0);
+        // create PLT0
+        new X86_32ExecPLT0(*m_SectionData);
+      }
     }
   }
   else {
     assert(got_size == 64);
-    m_PLT0 = x86_64_plt0;
-    m_PLT1 = x86_64_plt1;
-    m_PLT0Size = sizeof (x86_64_plt0);
+    m_PLT1 = m_bLazy ? x86_64_plt1 : x86_64_nonlazy_plt1;
     m_PLT1Size = sizeof (x86_64_plt1);
-    // create PLT0
-    new X86_64PLT0(*m_SectionData);
-    m_Last = m_SectionData->begin();
+    if (m_bLazy) {
+      m_PLT0 = x86_64_plt0;
+      m_PLT0Size = sizeof (x86_64_plt0);
+      // create PLT0
+      new X86_64PLT0(*m_SectionData);
+    }
   }
-  m_Last = m_SectionData->begin();
 }
 
 X86PLT::~X86PLT()
@@ -101,18 +95,11 @@ X86PLT::~X86PLT()
 
 void X86PLT::finalizeSectionSize()
 {
-  uint64_t size = 0;
   // plt0 size
-  size = getPLT0()->size();
-
-  // get first plt1 entry
-  X86PLT::iterator it = begin();
-  ++it;
-  if (end() != it) {
-    // plt1 size
-    PLTEntryBase* plt1 = &(llvm::cast<PLTEntryBase>(*it));
-    size += (m_SectionData->size() - 1) * plt1->size();
-  }
+  uint64_t size = m_PLT0Size;
+
+  // plt1 size
+  size += numOfPLT1() * m_PLT1Size;
   m_Section.setSize(size);
 
   uint32_t offset = 0;
@@ -125,36 +112,36 @@ void X86PLT::finalizeSectionSize()
 
 bool X86PLT::hasPLT1() const
 {
-  return (m_SectionData->size() > 1);
+  return (numOfPLT1() > 0);
 }
 
 void X86PLT::reserveEntry(size_t pNum)
 {
-  PLTEntryBase* plt1_entry = NULL;
-
-  for (size_t i = 0; i < pNum; ++i) {
-
-    if (LinkerConfig::DynObj == m_Config.codeGenType())
-      plt1_entry = new X86_32DynPLT1(*m_SectionData);
-    else
-      plt1_entry = new X86_32ExecPLT1(*m_SectionData);
-
-    if (NULL == plt1_entry)
+  if (NULL == m_pPLT1Table) {
+    m_pPLT1Table = new PLT1Table(m_SectionData);
+    if (NULL == m_pPLT1Table)
       fatal(diag::fail_allocate_memory_plt);
   }
+  m_pPLT1Table->reserve(pNum);
 }
 
-PLTEntryBase* X86PLT::consume()
+X86PLT1* X86PLT::consume()
 {
-  // This will skip PLT0.
-  ++m_Last;
-  assert(m_Last != m_SectionData->end() &&
+  assert(m_NumOfConsumed < numOfPLT1() &&
          "The number of PLT Entries and ResolveInfo doesn't match");
-  return llvm::cast<PLTEntryBase>(&(*m_Last));
+  return &m_pPLT1Table->at(m_NumOfConsumed++);
+}
+
+size_t X86PLT::numOfPLT1() const
+{
+  if (NULL == m_pPLT1Table)
+    return 0;
+  return m_pPLT1Table->numOfSlots();
 }
 
 PLTEntryBase* X86PLT::getPLT0() const
 {
+  assert(m_bLazy && "non-lazy PLT has no PLT0!");
   iterator first = m_SectionData->getFragmentList().begin();
 
   assert(first != m_SectionData->getFragmentList().end() &&
@@ -169,15 +156,20 @@ PLTEntryBase* X86PLT::getPLT0() const
 // X86_32PLT
 //===----------------------------------------------------------------------===//
 X86_32PLT::X86_32PLT(LDSection& pSection,
+		     X86_32GOT& pGOT,
 		     X86_32GOTPLT& pGOTPLT,
 		     const LinkerConfig& pConfig)
   : X86PLT(pSection, pConfig, 32),
+    m_GOT(pGOT),
     m_GOTPLT(pGOTPLT) {
 }
 
 // FIXME: It only works on little endian machine.
 void X86_32PLT::applyPLT0()
 {
+  if (!isLazy())
+    return;
+
   PLTEntryBase* plt0 = getPLT0();
 
   unsigned char* data = 0;
@@ -203,9 +195,26 @@ void X86_32PLT::applyPLT1()
 {
   assert(m_Section.addr() && ".plt base address is NULL!");
 
-  X86PLT::iterator it = m_SectionData->begin();
-  X86PLT::iterator ie = m_SectionData->end();
-  assert(it != ie && "FragmentList is empty, applyPLT1 failed!");
+  size_t num = numOfPLT1();
+  m_PLT1Value.resize(num * m_PLT1Size);
+  if (0 == num)
+    return;
+
+  if (!isLazy()) {
+    // jmp *sym@GOT(%ebx) is relative to .got.plt, and jmp *(sym in .got) is
+    // the address of the .got entry.
+    uint64_t GOTBase = m_GOT.addr();
+    if (LinkerConfig::DynObj == m_Config.codeGenType())
+      GOTBase -= m_GOTPLT.addr();
+
+    unsigned char* data = &m_PLT1Value[0];
+    for (size_t i = 0; i < num; ++i, data += m_PLT1Size) {
+      memcpy(data, m_PLT1, m_PLT1Size);
+      uint32_t* offset = reinterpret_cast<uint32_t*>(data + 2);
+      *offset = GOTBase + m_pPLT1Table->at(i).getGOTOffset();
+    }
+    return;
+  }
 
   uint64_t GOTEntrySize = X86_32GOTEntry::EntrySize;
 
@@ -216,21 +225,12 @@ void X86_32PLT::applyPLT1()
 
   //skip PLT0
   uint64_t PLTEntryOffset = m_PLT0Size;
-  ++it;
-
-  PLTEntryBase* plt1 = 0;
 
   uint64_t PLTRelOffset = 0;
 
-  while (it != ie) {
-    plt1 = &(llvm::cast<PLTEntryBase>(*it));
-    unsigned char *data;
-    data = static_cast<unsigned char*>(malloc(plt1->size()));
-
-    if (!data)
-      fatal(diag::fail_allocate_memory_plt);
-
-    memcpy(data, m_PLT1, plt1->size());
+  unsigned char* data = &m_PLT1Value[0];
+  for (size_t i = 0; i < num; ++i, data += m_PLT1Size) {
+    memcpy(data, m_PLT1, m_PLT1Size);
 
     uint32_t* offset;
 
@@ -245,9 +245,6 @@ void X86_32PLT::applyPLT1()
     offset = reinterpret_cast<uint32_t*>(data + 12);
     *offset = -(PLTEntryOffset + 12 + 4);
     PLTEntryOffset += m_PLT1Size;
-
-    plt1->setValue(data);
-    ++it;
   }
 }
 
@@ -255,15 +252,20 @@ void X86_32PLT::applyPLT1()
 // X86_64PLT
 //===----------------------------------------------------------------------===//
 X86_64PLT::X86_64PLT(LDSection& pSection,
+		     X86_64GOT& pGOT,
 		     X86_64GOTPLT& pGOTPLT,
 		     const LinkerConfig& pConfig)
   : X86PLT(pSection, pConfig, 64),
+    m_GOT(pGOT),
     m_GOTPLT(pGOTPLT) {
 }
 
 // FIXME: It only works on little endian machine.
 void X86_64PLT::applyPLT0()
 {
+  if (!isLazy())
+    return;
+
   PLTEntryBase* plt0 = getPLT0();
 
   unsigned char* data = 0;
@@ -289,9 +291,24 @@ void X86_64PLT::applyPLT1()
 {
   assert(m_Section.addr() && ".plt base address is NULL!");
 
-  X86PLT::iterator it = m_SectionData->begin();
-  X86PLT::iterator ie = m_SectionData->end();
-  assert(it != ie && "FragmentList is empty, applyPLT1 failed!");
+  size_t num = numOfPLT1();
+  m_PLT1Value.resize(num * m_PLT1Size);
+  if (0 == num)
+    return;
+
+  if (!isLazy()) {
+    // jmpq *sym@GOTPCREL(%rip) of the .got entry
+    uint64_t PLTEntryAddress = addr();
+    unsigned char* data = &m_PLT1Value[0];
+    for (size_t i = 0; i < num; ++i, data += m_PLT1Size) {
+      memcpy(data, m_PLT1, m_PLT1Size);
+      uint32_t* offset = reinterpret_cast<uint32_t*>(data + 2);
+      *offset = m_GOT.addr() + m_pPLT1Table->at(i).getGOTOffset() -
+                (PLTEntryAddress + 6);
+      PLTEntryAddress += m_PLT1Size;
+    }
+    return;
+  }
 
   uint64_t GOTEntrySize = X86_64GOTEntry::EntrySize;
 
@@ -303,24 +320,15 @@ void X86_64PLT::applyPLT1()
 
   // skip PLT0
   uint64_t PLTEntryOffset = m_PLT0Size;
-  ++it;
 
   // PC-relative to entry in PLT section.
   SymGOTPCREL -= addr() + PLTEntryOffset + 6;
 
-  PLTEntryBase* plt1 = 0;
-
   uint64_t PLTRelIndex = 0;
 
-  while (it != ie) {
-    plt1 = &(llvm::cast<PLTEntryBase>(*it));
-    unsigned char *data;
-    data = static_cast<unsigned char*>(malloc(plt1->size()));
-
-    if (!data)
-      fatal(diag::fail_allocate_memory_plt);
-
-    memcpy(data, m_PLT1, plt1->size());
+  unsigned char* data = &m_PLT1Value[0];
+  for (size_t i = 0; i < num; ++i, data += m_PLT1Size) {
+    memcpy(data, m_PLT1, m_PLT1Size);
 
     uint32_t* offset;
 
@@ -338,9 +346,5 @@ void X86_64PLT::applyPLT1()
     offset = reinterpret_cast<uint32_t*>(data + 12);
     *offset = -(PLTEntryOffset + 12 + 4);
     PLTEntryOffset += m_PLT1Size;
-
-    plt1->setValue(data);
-    ++it;
   }
 }
-
@@ -10,6 +10,9 @@
 #define MCLD_TARGET_X86_PLT_H
 
 #include <mcld/Target/PLT.h>
+#include <mcld/Target/SlotTable.h>
+
+#include <vector>
 
 namespace {
 
@@ -49,11 +52,34 @@ const uint8_t x86_64_plt1[] = {
   0xe9, 0, 0, 0, 0           // jmpq   plt0
 };
 
+// The non-lazy PLT1 entries of -z now jump through the .got entries. They
+// have no PLT0 to jump back to, and are padded to the size of PLT1.
+const uint8_t x86_32_dyn_nonlazy_plt1[] = {
+  0xff, 0xa3, 0, 0, 0, 0,             // jmp    *sym@GOT(%ebx)
+  0x66, 0x0f, 0x1f, 0x44, 0, 0,       // nopw   0(%eax,%eax,1)
+  0x0f, 0x1f, 0x40, 0                 // nopl   0(%eax)
+};
+
+const uint8_t x86_32_exec_nonlazy_plt1[] = {
+  0xff, 0x25, 0, 0, 0, 0,             // jmp    *(sym in .got)
+  0x66, 0x0f, 0x1f, 0x44, 0, 0,       // nopw   0(%eax,%eax,1)
+  0x0f, 0x1f, 0x40, 0                 // nopl   0(%eax)
+};
+
+const uint8_t x86_64_nonlazy_plt1[] = {
+  0xff, 0x25, 0, 0, 0, 0,             // jmpq   *sym@GOTPCREL(%rip)
+  0x66, 0x0f, 0x1f, 0x44, 0, 0,       // nopw   0(%rax,%rax,1)
+  0x0f, 0x1f, 0x40, 0                 // nopl   0(%rax)
+};
+
 } // anonymous namespace
 
 namespace mcld {
 
+class X86_32GOT;
 class X86_32GOTPLT;
+class X86_64GOT;
+class X86_64GOTPLT;
 class GOTEntry;
 class LinkerConfig;
 
@@ -66,24 +92,12 @@ public:
   X86_32DynPLT0(SectionData& pParent);
 };
 
-class X86_32DynPLT1 : public PLT::Entry<sizeof(x86_32_dyn_plt1)>
-{
-public:
-  X86_32DynPLT1(SectionData& pParent);
-};
-
 class X86_32ExecPLT0 : public PLT::Entry<sizeof(x86_32_exec_plt0)>
 {
 public:
   X86_32ExecPLT0(SectionData& pParent);
 };
 
-class X86_32ExecPLT1 : public PLT::Entry<sizeof(x86_32_exec_plt1)>
-{
-public:
-  X86_32ExecPLT1(SectionData& pParent);
-};
-
 //===----------------------------------------------------------------------===//
 // X86_64PLT Entry
 //===----------------------------------------------------------------------===//
@@ -93,10 +107,30 @@ public:
   X86_64PLT0(SectionData& pParent);
 };
 
-class X86_64PLT1 : public PLT::Entry<sizeof(x86_64_plt1)>
+//===----------------------------------------------------------------------===//
+// X86PLT1 Entry
+//===----------------------------------------------------------------------===//
+/** \class X86PLT1
+ *  \brief A PLT1 entry. The PLT1 entries of X86_32 and X86_64 are all 16
+ *  bytes, and are kept in one SlotTable.
+ */
+class X86PLT1 : public PLT::Slot<sizeof(x86_64_plt1)>
 {
 public:
-  X86_64PLT1(SectionData& pParent);
+  X86PLT1(Fragment& pTable, size_t pIndex)
+    : PLT::Slot<sizeof(x86_64_plt1)>(pTable, pIndex), m_GOTOffset(0x0)
+  {}
+
+  /// getGOTOffset - the offset in .got of the entry a non-lazy PLT1 entry
+  /// jumps through
+  uint64_t getGOTOffset() const
+  { return m_GOTOffset; }
+
+  void setGOTOffset(uint64_t pOffset)
+  { m_GOTOffset = pOffset; }
+
+private:
+  uint64_t m_GOTOffset;
 };
 
 //===----------------------------------------------------------------------===//
@@ -104,6 +138,10 @@ public:
 //===----------------------------------------------------------------------===//
 /** \class X86PLT
  *  \brief X86 Procedure Linkage Table
+ *
+ *  With -z now, the dynamic linker binds all the symbols at load time and the
+ *  PLT is not lazy. Then there is no PLT0, and each PLT1 entry jumps through
+ *  the .got entry of its symbol instead of its own .got.plt entry.
  */
 class X86PLT : public PLT
 {
@@ -119,9 +157,20 @@ public:
   // hasPLT1 - return if this PLT has any PLT1 entry
   bool hasPLT1() const;
 
+  /// isLazy - does this PLT have PLT0 and the .got.plt entries for the lazy
+  /// binding?
+  bool isLazy() const
+  { return m_bLazy; }
+
   void reserveEntry(size_t pNum = 1) ;
 
-  PLTEntryBase* consume();
+  X86PLT1* consume();
+
+  size_t numOfPLT1() const;
+
+  /// getPLT1Value - the code of all PLT1 entries, set by applyPLT1()
+  const uint8_t* getPLT1Value() const
+  { return m_PLT1Value.empty() ? NULL : &m_PLT1Value[0]; }
 
   virtual void applyPLT0() = 0;
 
@@ -134,8 +183,16 @@ protected:
   PLTEntryBase* getPLT0() const;
 
 protected:
-  // the last consumed entry.
-  SectionData::iterator m_Last;
+  typedef SlotTable<X86PLT1> PLT1Table;
+
+protected:
+  // m_pPLT1Table - the fragment of all PLT1 entries. It is created by the
+  // first reserveEntry() and follows PLT0.
+  PLT1Table* m_pPLT1Table;
+  size_t m_NumOfConsumed;
+  std::vector<uint8_t> m_PLT1Value;
+
+  bool m_bLazy;
 
   const uint8_t *m_PLT0;
   const uint8_t *m_PLT1;
@@ -155,6 +212,7 @@ class X86_32PLT : public X86PLT
 {
 public:
   X86_32PLT(LDSection& pSection,
+	    X86_32GOT& pGOT,
 	    X86_32GOTPLT& pGOTPLT,
 	    const LinkerConfig& pConfig);
 
@@ -163,6 +221,7 @@ public:
   void applyPLT1();
 
 private:
+  X86_32GOT& m_GOT;
   X86_32GOTPLT& m_GOTPLT;
 };
 
@@ -176,6 +235,7 @@ class X86_64PLT : public X86PLT
 {
 public:
   X86_64PLT(LDSection& pSection,
+	    X86_64GOT& pGOT,
 	    X86_64GOTPLT& pGOTPLT,
 	    const LinkerConfig& pConfig);
 
@@ -184,6 +244,7 @@ public:
   void applyPLT1();
 
 private:
+  X86_64GOT& m_GOT;
   X86_64GOTPLT& m_GOTPLT;
 };
 
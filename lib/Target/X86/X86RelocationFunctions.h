@@ -71,8 +71,8 @@ DECL_X86_32_APPLY_RELOC_FUNC(unsupport)
   { &unsupport,         40, "R_386_TLS_DESC_CALL",    0  },  \
   { &unsupport,         41, "R_386_TLS_DESC",         0  },  \
   { &unsupport,         42, "R_386_IRELATIVE",        0  },  \
-  { &unsupport,         43, "R_386_NUM",              0  },  \
-  { &none,              44, "R_386_TLS_OPT",          0  }
+  { &got32,             43, "R_386_GOT32X",           32 },  \
+  { &none,              44, "R_386_TLS_OPT",          32 }
 
 #define DECL_X86_64_APPLY_RELOC_FUNC(Name) \
 static X86Relocator::Result Name(Relocation& pEntry, X86_64Relocator& pParent);
@@ -84,6 +84,10 @@ DECL_X86_64_APPLY_RELOC_FUNC(signed32)         \
 DECL_X86_64_APPLY_RELOC_FUNC(gotpcrel)         \
 DECL_X86_64_APPLY_RELOC_FUNC(plt32)            \
 DECL_X86_64_APPLY_RELOC_FUNC(rel)              \
+DECL_X86_64_APPLY_RELOC_FUNC(tpoff32)          \
+DECL_X86_64_APPLY_RELOC_FUNC(dtpoff32)         \
+DECL_X86_64_APPLY_RELOC_FUNC(gottpoff)         \
+DECL_X86_64_APPLY_RELOC_FUNC(tlsdesc)          \
 DECL_X86_64_APPLY_RELOC_FUNC(unsupport)
 
 #define DECL_X86_64_APPLY_RELOC_FUNC_PTRS \
@@ -108,9 +112,9 @@ DECL_X86_64_APPLY_RELOC_FUNC(unsupport)
   { &none,              18, "R_X86_64_TPOFF64",         0  },  \
   { &unsupport,         19, "R_X86_64_TLSGD",           0  },  \
   { &unsupport,         20, "R_X86_64_TLSLD",           0  },  \
-  { &unsupport,         21, "R_X86_64_DTPOFF32",        0  },  \
-  { &unsupport,         22, "R_X86_64_GOTTPOFF",        0  },  \
-  { &unsupport,         23, "R_X86_64_TPOFF32",         0  },  \
+  { &dtpoff32,          21, "R_X86_64_DTPOFF32",        32 },  \
+  { &gottpoff,          22, "R_X86_64_GOTTPOFF",        32 },  \
+  { &tpoff32,           23, "R_X86_64_TPOFF32",         32 },  \
   { &unsupport,         24, "R_X86_64_PC64",            64 },  \
   { &unsupport,         25, "R_X86_64_GOTOFF64",        64 },  \
   { &unsupport,         26, "R_X86_64_GOTPC32",         32 },  \
@@ -121,8 +125,14 @@ DECL_X86_64_APPLY_RELOC_FUNC(unsupport)
   { &unsupport,         31, "R_X86_64_PLTOFF64",        64 },  \
   { &unsupport,         32, "R_X86_64_SIZE32",          32 },  \
   { &unsupport,         33, "R_X86_64_SIZE64",          64 },  \
-  { &unsupport,         34, "R_X86_64_GOTPC32_TLSDESC", 0  },  \
-  { &unsupport,         35, "R_X86_64_TLSDESC_CALL",    0  },  \
+  { &tlsdesc,           34, "R_X86_64_GOTPC32_TLSDESC", 32 },  \
+  { &none,              35, "R_X86_64_TLSDESC_CALL",    0  },  \
   { &none,              36, "R_X86_64_TLSDESC",         0  },  \
   { &none,              37, "R_X86_64_IRELATIVE",       0  },  \
-  { &none,              38, "R_X86_64_RELATIVE64",      0  }
+  { &none,              38, "R_X86_64_RELATIVE64",      0  },  \
+  { &unsupport,         39, "R_X86_64_PC32_BND",        32 },  \
+  { &unsupport,         40, "R_X86_64_PLT32_BND",       32 },  \
+  { &gotpcrel,          41, "R_X86_64_GOTPCRELX",       32 },  \
+  { &gotpcrel,          42, "R_X86_64_REX_GOTPCRELX",   32 },  \
+  { &none,              43, "R_X86_64_OPT32",           32 },  \
+  { &none,              44, "R_X86_64_OPT64",           64 }
@@ -11,6 +11,7 @@
 
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocationBatch.h>
 
 #include <llvm/ADT/Twine.h>
 #include <llvm/Support/DataTypes.h>
@@ -41,6 +42,21 @@ static const X86_32ApplyFunctionTriple X86_32ApplyFunctions[] = {
   DECL_X86_32_APPLY_RELOC_FUNC_PTRS
 };
 
+// the kernels of the common relocations. They call the applying functions
+// directly, so that the functions can be inlined into the loops of
+// RelocationBatch.
+struct X86_32AbsKernel
+{
+  Relocator::Result operator()(Relocation& pReloc, X86_32Relocator& pParent)
+  { return abs(pReloc, pParent); }
+};
+
+struct X86_32RelKernel
+{
+  Relocator::Result operator()(Relocation& pReloc, X86_32Relocator& pParent)
+  { return rel(pReloc, pParent); }
+};
+
 //===--------------------------------------------------------------------===//
 // X86Relocator
 //===--------------------------------------------------------------------===//
@@ -82,6 +98,60 @@ Relocator::Size X86_32Relocator::getSize(Relocation::Type pType) const
   return X86_32ApplyFunctions[pType].size;;
 }
 
+bool X86_32Relocator::mayApplyConcurrently(const Relocation& pRelocation) const
+{
+  Relocation::Type type = pRelocation.type();
+  if (type >= sizeof (X86_32ApplyFunctions) / sizeof (X86_32ApplyFunctions[0]))
+    return false;
+
+  // these functions consume GOT, PLT and dynamic relocation entries only if
+  // the symbol reserves them or needs a dynamic relocation
+  X86_32ApplyFunctionType func = X86_32ApplyFunctions[type].func;
+  X86_32ApplyFunctionType none_func = &none;
+  X86_32ApplyFunctionType abs_func = &abs;
+  X86_32ApplyFunctionType rel_func = &rel;
+  X86_32ApplyFunctionType gotoff32_func = &gotoff32;
+  X86_32ApplyFunctionType gotpc32_func = &gotpc32;
+  if (none_func == func)
+    return true;
+  if (abs_func != func && rel_func != func &&
+      gotoff32_func != func && gotpc32_func != func)
+    return false;
+
+  const ResolveInfo* rsym = pRelocation.symInfo();
+  return (NULL != rsym && 0x0 == rsym->reserved() &&
+          !m_Target.symbolNeedsDynRel(*rsym, false, true));
+}
+
+bool X86_32Relocator::isDataAddend(Type pType) const
+{
+  return (llvm::ELF::R_386_32 == pType || llvm::ELF::R_386_GOTOFF == pType);
+}
+
+void X86_32Relocator::applyBatch(Relocation* const* pRelocs,
+                                 Result* pResults,
+                                 size_t pNum)
+{
+  RelocationBatch batch(pRelocs, pNum);
+  RelocationBatch::run_iterator run, rEnd = batch.run_end();
+  for (run = batch.run_begin(); run != rEnd; ++run) {
+    assert(run->type < sizeof (X86_32ApplyFunctions) /
+                       sizeof (X86_32ApplyFunctions[0]));
+    switch (run->type) {
+      case llvm::ELF::R_386_32:
+        batch.apply(*run, X86_32AbsKernel(), *this, pResults);
+        break;
+      case llvm::ELF::R_386_PC32:
+        batch.apply(*run, X86_32RelKernel(), *this, pResults);
+        break;
+      default:
+        batch.apply(*run, X86_32ApplyFunctions[run->type].func, *this,
+                    pResults);
+        break;
+    }
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // Relocation helper function
 //===--------------------------------------------------------------------===//
@@ -146,11 +216,13 @@ X86_32GOTEntry& helper_get_GOT_and_init(Relocation& pReloc,
   else if (rsym->reserved() & X86GNULDBackend::GOTRel) {
     // Initialize got_entry content and the corresponding dynamic relocation.
     if (helper_use_relative_reloc(*rsym, pParent)) {
-      helper_DynRel(rsym, *got_entry, 0x0, llvm::ELF::R_386_RELATIVE, pParent);
+      helper_DynRel(rsym, got_entry->getTable(), got_entry->getTableOffset(),
+                    llvm::ELF::R_386_RELATIVE, pParent);
       got_entry->setValue(pReloc.symValue());
     }
     else {
-      helper_DynRel(rsym, *got_entry, 0x0, llvm::ELF::R_386_GLOB_DAT, pParent);
+      helper_DynRel(rsym, got_entry->getTable(), got_entry->getTableOffset(),
+                    llvm::ELF::R_386_GLOB_DAT, pParent);
       got_entry->setValue(0);
     }
   }
@@ -178,14 +250,14 @@ X86Relocator::Address helper_GOT(Relocation& pReloc, X86_32Relocator& pParent)
 
 
 static
-PLTEntryBase& helper_get_PLT_and_init(Relocation& pReloc,
+X86PLT1& helper_get_PLT_and_init(Relocation& pReloc,
 				      X86_32Relocator& pParent)
 {
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
   X86_32GNULDBackend& ld_backend = pParent.getTarget();
 
-  PLTEntryBase* plt_entry = pParent.getSymPLTMap().lookUp(*rsym);
+  X86PLT1* plt_entry = pParent.getSymPLTMap().lookUp(*rsym);
   if (NULL != plt_entry)
     return *plt_entry;
 
@@ -193,7 +265,13 @@ PLTEntryBase& helper_get_PLT_and_init(Relocation& pReloc,
   plt_entry = ld_backend.getPLT().consume();
   pParent.getSymPLTMap().record(*rsym, *plt_entry);
   // If we first get this PLT entry, we should initialize it.
-  if (rsym->reserved() & X86GNULDBackend::ReservePLT) {
+  if ((rsym->reserved() & X86GNULDBackend::ReservePLT) &&
+      !ld_backend.getPLT().isLazy()) {
+    // the non-lazy PLT entry jumps through the .got entry of the symbol
+    X86_32GOTEntry& got_entry = helper_get_GOT_and_init(pReloc, pParent);
+    plt_entry->setGOTOffset(got_entry.getOffset());
+  }
+  else if (rsym->reserved() & X86GNULDBackend::ReservePLT) {
     X86_32GOTEntry* gotplt_entry = pParent.getSymGOTPLTMap().lookUp(*rsym);
     assert(NULL == gotplt_entry && "PLT entry not exist, but DynRel entry exist!");
     gotplt_entry = ld_backend.getGOTPLT().consume();
@@ -201,7 +279,8 @@ PLTEntryBase& helper_get_PLT_and_init(Relocation& pReloc,
     // init the corresponding rel entry in .rel.plt
     Relocation& rel_entry = *ld_backend.getRelPLT().consumeEntry();
     rel_entry.setType(llvm::ELF::R_386_JUMP_SLOT);
-    rel_entry.targetRef().assign(*gotplt_entry);
+    rel_entry.targetRef().assign(gotplt_entry->getTable(),
+                                 gotplt_entry->getTableOffset());
     rel_entry.setSymInfo(rsym);
   }
   else {
@@ -222,7 +301,7 @@ X86Relocator::Address helper_PLT_ORG(X86_32Relocator& pParent)
 static
 X86Relocator::Address helper_PLT(Relocation& pReloc, X86_32Relocator& pParent)
 {
-  PLTEntryBase& plt_entry = helper_get_PLT_and_init(pReloc, pParent);
+  X86PLT1& plt_entry = helper_get_PLT_and_init(pReloc, pParent);
   return helper_PLT_ORG(pParent) + plt_entry.getOffset();
 }
 
@@ -261,9 +340,12 @@ X86Relocator::Result abs(Relocation& pReloc, X86_32Relocator& pParent)
   // A local symbol may need REL Type dynamic relocation
   if (rsym->isLocal() && has_dyn_rel) {
     if (llvm::ELF::R_386_32 == pReloc.type()) {
-      helper_DynRel(rsym, *pReloc.targetRef().frag(),
-                    pReloc.targetRef().offset(), llvm::ELF::R_386_RELATIVE,
-                    pParent);
+      // the relocation packed into .relr.dyn needs no entry in .rel.dyn
+      if (!pParent.getTarget().isRelrEntry(pReloc)) {
+        helper_DynRel(rsym, *pReloc.targetRef().frag(),
+                      pReloc.targetRef().offset(), llvm::ELF::R_386_RELATIVE,
+                      pParent);
+      }
     }
     else {
       // FIXME: check Section symbol
@@ -423,8 +505,10 @@ X86Relocator::Result tls_gd(Relocation& pReloc, X86_32Relocator& pParent)
     got_entry1->setValue(0x0);
     got_entry2->setValue(0x0);
     // setup dyn rel for get_entry1
-    Relocation& rel_entry1 = helper_DynRel(rsym, *got_entry1, 0x0,
-                                        llvm::ELF::R_386_TLS_DTPMOD32, pParent);
+    Relocation& rel_entry1 = helper_DynRel(rsym, got_entry1->getTable(),
+                                           got_entry1->getTableOffset(),
+                                           llvm::ELF::R_386_TLS_DTPMOD32,
+                                           pParent);
     if (rsym->isLocal()) {
       // for local symbol, set got_entry2 to symbol value
       got_entry2->setValue(pReloc.symValue());
@@ -443,8 +527,8 @@ X86Relocator::Result tls_gd(Relocation& pReloc, X86_32Relocator& pParent)
     else {
       // for non-local symbol, add a pair of rel entries against this symbol
       // for those two got entries
-      helper_DynRel(rsym, *got_entry2, 0x0,
-                                        llvm::ELF::R_386_TLS_DTPOFF32, pParent);
+      helper_DynRel(rsym, got_entry2->getTable(), got_entry2->getTableOffset(),
+                    llvm::ELF::R_386_TLS_DTPOFF32, pParent);
     }
   }
 
@@ -512,7 +596,8 @@ X86Relocator::Result tls_ie(Relocation& pReloc, X86_32Relocator& pParent)
     Relocation& rel_entry = *ld_backend.getRelDyn().consumeEntry();
     rel_entry.setType(llvm::ELF::R_386_TLS_TPOFF);
     rel_entry.setSymInfo(rsym);
-    rel_entry.targetRef().assign(*got_entry);
+    rel_entry.targetRef().assign(got_entry->getTable(),
+                                 got_entry->getTableOffset());
   }
 
   // perform relocation to the absolute address of got_entry
@@ -545,7 +630,8 @@ X86Relocator::Result tls_gotie(Relocation& pReloc, X86_32Relocator& pParent)
     Relocation& rel_entry = *ld_backend.getRelDyn().consumeEntry();
     rel_entry.setType(llvm::ELF::R_386_TLS_TPOFF);
     rel_entry.setSymInfo(rsym);
-    rel_entry.targetRef().assign(*got_entry);
+    rel_entry.targetRef().assign(got_entry->getTable(),
+                                 got_entry->getTableOffset());
   }
 
   // All GOT offsets are relative to the end of the GOT.
@@ -608,6 +694,25 @@ static const X86_64ApplyFunctionTriple X86_64ApplyFunctions[] = {
   DECL_X86_64_APPLY_RELOC_FUNC_PTRS
 };
 
+// the kernels of the common relocations
+struct X86_64AbsKernel
+{
+  Relocator::Result operator()(Relocation& pReloc, X86_64Relocator& pParent)
+  { return abs(pReloc, pParent); }
+};
+
+struct X86_64Signed32Kernel
+{
+  Relocator::Result operator()(Relocation& pReloc, X86_64Relocator& pParent)
+  { return signed32(pReloc, pParent); }
+};
+
+struct X86_64RelKernel
+{
+  Relocator::Result operator()(Relocation& pReloc, X86_64Relocator& pParent)
+  { return rel(pReloc, pParent); }
+};
+
 //===--------------------------------------------------------------------===//
 // X86_64Relocator
 //===--------------------------------------------------------------------===//
@@ -638,6 +743,57 @@ Relocator::Size X86_64Relocator::getSize(Relocation::Type pType) const
   return X86_64ApplyFunctions[pType].size;
 }
 
+bool X86_64Relocator::mayApplyConcurrently(const Relocation& pRelocation) const
+{
+  Relocation::Type type = pRelocation.type();
+  if (type >= sizeof (X86_64ApplyFunctions) / sizeof (X86_64ApplyFunctions[0]))
+    return false;
+
+  // these functions consume PLT and dynamic relocation entries only if the
+  // symbol reserves them or needs a dynamic relocation
+  X86_64ApplyFunctionType func = X86_64ApplyFunctions[type].func;
+  X86_64ApplyFunctionType none_func = &none;
+  X86_64ApplyFunctionType abs_func = &abs;
+  X86_64ApplyFunctionType signed32_func = &signed32;
+  X86_64ApplyFunctionType rel_func = &rel;
+  if (none_func == func)
+    return true;
+  if (abs_func != func && signed32_func != func && rel_func != func)
+    return false;
+
+  const ResolveInfo* rsym = pRelocation.symInfo();
+  return (NULL != rsym && 0x0 == rsym->reserved() &&
+          !m_Target.symbolNeedsDynRel(*rsym, false, true));
+}
+
+void X86_64Relocator::applyBatch(Relocation* const* pRelocs,
+                                 Result* pResults,
+                                 size_t pNum)
+{
+  RelocationBatch batch(pRelocs, pNum);
+  RelocationBatch::run_iterator run, rEnd = batch.run_end();
+  for (run = batch.run_begin(); run != rEnd; ++run) {
+    assert(run->type < sizeof (X86_64ApplyFunctions) /
+                       sizeof (X86_64ApplyFunctions[0]));
+    switch (run->type) {
+      case llvm::ELF::R_X86_64_64:
+      case llvm::ELF::R_X86_64_32:
+        batch.apply(*run, X86_64AbsKernel(), *this, pResults);
+        break;
+      case llvm::ELF::R_X86_64_32S:
+        batch.apply(*run, X86_64Signed32Kernel(), *this, pResults);
+        break;
+      case llvm::ELF::R_X86_64_PC32:
+        batch.apply(*run, X86_64RelKernel(), *this, pResults);
+        break;
+      default:
+        batch.apply(*run, X86_64ApplyFunctions[run->type].func, *this,
+                    pResults);
+        break;
+    }
+  }
+}
+
 /// helper_DynRel - Get an relocation entry in .rela.dyn
 static
 Relocation& helper_DynRel(ResolveInfo* pSym,
@@ -698,14 +854,15 @@ X86_64GOTEntry& helper_get_GOT_and_init(Relocation& pReloc,
   else if (rsym->reserved() & X86GNULDBackend::GOTRel) {
     // Initialize got_entry content and the corresponding dynamic relocation.
     if (helper_use_relative_reloc(*rsym, pParent)) {
-      Relocation& rel_entry = helper_DynRel(rsym, *got_entry, 0x0,
+      Relocation& rel_entry = helper_DynRel(rsym, got_entry->getTable(),
+					    got_entry->getTableOffset(),
 					    llvm::ELF::R_X86_64_RELATIVE,
 					    pParent);
       rel_entry.setAddend(pReloc.symValue());
     }
     else {
-      helper_DynRel(rsym, *got_entry, 0x0, llvm::ELF::R_X86_64_GLOB_DAT,
-		    pParent);
+      helper_DynRel(rsym, got_entry->getTable(), got_entry->getTableOffset(),
+		    llvm::ELF::R_X86_64_GLOB_DAT, pParent);
     }
     got_entry->setValue(0);
   }
@@ -729,14 +886,14 @@ X86Relocator::Address helper_GOT(Relocation& pReloc, X86_64Relocator& pParent)
 }
 
 static
-PLTEntryBase& helper_get_PLT_and_init(Relocation& pReloc,
+X86PLT1& helper_get_PLT_and_init(Relocation& pReloc,
 				      X86_64Relocator& pParent)
 {
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
   X86_64GNULDBackend& ld_backend = pParent.getTarget();
 
-  PLTEntryBase* plt_entry = pParent.getSymPLTMap().lookUp(*rsym);
+  X86PLT1* plt_entry = pParent.getSymPLTMap().lookUp(*rsym);
   if (NULL != plt_entry)
     return *plt_entry;
 
@@ -744,7 +901,13 @@ PLTEntryBase& helper_get_PLT_and_init(Relocation& pReloc,
   plt_entry = ld_backend.getPLT().consume();
   pParent.getSymPLTMap().record(*rsym, *plt_entry);
   // If we first get this PLT entry, we should initialize it.
-  if (rsym->reserved() & X86GNULDBackend::ReservePLT) {
+  if ((rsym->reserved() & X86GNULDBackend::ReservePLT) &&
+      !ld_backend.getPLT().isLazy()) {
+    // the non-lazy PLT entry jumps through the .got entry of the symbol
+    X86_64GOTEntry& got_entry = helper_get_GOT_and_init(pReloc, pParent);
+    plt_entry->setGOTOffset(got_entry.getOffset());
+  }
+  else if (rsym->reserved() & X86GNULDBackend::ReservePLT) {
     X86_64GOTEntry* gotplt_entry = pParent.getSymGOTPLTMap().lookUp(*rsym);
     assert(NULL == gotplt_entry && "PLT entry not exist, but DynRel entry exist!");
     gotplt_entry = ld_backend.getGOTPLT().consume();
@@ -752,7 +915,8 @@ PLTEntryBase& helper_get_PLT_and_init(Relocation& pReloc,
     // init the corresponding rel entry in .rel.plt
     Relocation& rel_entry = *ld_backend.getRelPLT().consumeEntry();
     rel_entry.setType(llvm::ELF::R_X86_64_JUMP_SLOT);
-    rel_entry.targetRef().assign(*gotplt_entry);
+    rel_entry.targetRef().assign(gotplt_entry->getTable(),
+                                 gotplt_entry->getTableOffset());
     rel_entry.setSymInfo(rsym);
   }
   else {
@@ -771,10 +935,119 @@ X86Relocator::Address helper_PLT_ORG(X86_64Relocator& pParent)
 static
 X86Relocator::Address helper_PLT(Relocation& pReloc, X86_64Relocator& pParent)
 {
-  PLTEntryBase& plt_entry = helper_get_PLT_and_init(pReloc, pParent);
+  X86PLT1& plt_entry = helper_get_PLT_and_init(pReloc, pParent);
   return helper_PLT_ORG(pParent) + plt_entry.getOffset();
 }
 
+/// helper_TLS_symbol - the offset of S to the TLS segment. The value of a
+/// TLS symbol is already the offset, but the one of a section symbol is not.
+static
+X86Relocator::Address helper_TLS_symbol(Relocation& pReloc,
+                                        X86_64Relocator& pParent)
+{
+  ELFSegment* tls_seg = pParent.getTarget().elfSegmentTable().find(
+                                       llvm::ELF::PT_TLS, llvm::ELF::PF_R, 0x0);
+  assert(NULL != tls_seg && "no TLS segment for the TLS relocation");
+  X86Relocator::Address S = pReloc.symValue();
+  if (ResolveInfo::ThreadLocal != pReloc.symInfo()->type())
+    S -= tls_seg->vaddr();
+  return S;
+}
+
+/// helper_TLS_offset - the offset of S + A to the TLS segment
+static
+X86Relocator::Address helper_TLS_offset(Relocation& pReloc,
+                                        X86_64Relocator& pParent)
+{
+  return helper_TLS_symbol(pReloc, pParent) + pReloc.addend();
+}
+
+/// helper_TP - the offset of the thread pointer to the TLS segment. The
+/// thread pointer points to the end of the TLS segment, which is aligned to
+/// the segment alignment.
+static
+X86Relocator::Address helper_TP(X86_64Relocator& pParent)
+{
+  ELFSegment* tls_seg = pParent.getTarget().elfSegmentTable().find(
+                                       llvm::ELF::PT_TLS, llvm::ELF::PF_R, 0x0);
+  assert(NULL != tls_seg && "no TLS segment for the TLS relocation");
+  uint64_t align = (0 == tls_seg->align()) ? 1 : tls_seg->align();
+  return (tls_seg->memsz() + align - 1) & ~(align - 1);
+}
+
+/// helper_get_GOTTPOFF_and_init - the .got entry holding the offset of the
+/// TLS symbol of pReloc to the thread pointer
+static
+X86_64GOTEntry& helper_get_GOTTPOFF_and_init(Relocation& pReloc,
+                                             X86_64Relocator& pParent)
+{
+  ResolveInfo* rsym = pReloc.symInfo();
+  X86_64GNULDBackend& ld_backend = pParent.getTarget();
+
+  X86_64GOTEntry* got_entry = pParent.getSymGOTTPOFFMap().lookUp(*rsym);
+  if (NULL != got_entry)
+    return *got_entry;
+
+  got_entry = ld_backend.getGOT().consume();
+  pParent.getSymGOTTPOFFMap().record(*rsym, *got_entry);
+
+  if (ld_backend.isTLSOffsetKnown(*rsym)) {
+    got_entry->setValue(helper_TLS_symbol(pReloc, pParent) -
+                        helper_TP(pParent));
+    return *got_entry;
+  }
+
+  // a symbol of this module is relocated by its offset in the TLS segment
+  if (helper_use_relative_reloc(*rsym, pParent)) {
+    Relocation& rel_entry = helper_DynRel(NULL, got_entry->getTable(),
+                                          got_entry->getTableOffset(),
+                                          llvm::ELF::R_X86_64_TPOFF64,
+                                          pParent);
+    rel_entry.setAddend(helper_TLS_symbol(pReloc, pParent));
+  }
+  else {
+    helper_DynRel(rsym, got_entry->getTable(), got_entry->getTableOffset(),
+                  llvm::ELF::R_X86_64_TPOFF64, pParent);
+  }
+  got_entry->setValue(0);
+  return *got_entry;
+}
+
+/// helper_get_TLSDesc_and_init - the first .got entry of the TLS descriptor
+/// of the symbol of pReloc
+static
+X86_64GOTEntry& helper_get_TLSDesc_and_init(Relocation& pReloc,
+                                            X86_64Relocator& pParent)
+{
+  ResolveInfo* rsym = pReloc.symInfo();
+  X86_64GNULDBackend& ld_backend = pParent.getTarget();
+
+  X86_64GOTEntry* got_entry = pParent.getSymTLSDescMap().lookUp(*rsym);
+  if (NULL != got_entry)
+    return *got_entry;
+
+  // the resolver function and its argument
+  got_entry = ld_backend.getGOT().consume();
+  X86_64GOTEntry* arg_entry = ld_backend.getGOT().consume();
+  pParent.getSymTLSDescMap().record(*rsym, *got_entry);
+
+  // the descriptor is bound at load time
+  if (helper_use_relative_reloc(*rsym, pParent)) {
+    Relocation& rel_entry = helper_DynRel(NULL, got_entry->getTable(),
+                                          got_entry->getTableOffset(),
+                                          llvm::ELF::R_X86_64_TLSDESC,
+                                          pParent);
+    rel_entry.setAddend(helper_TLS_symbol(pReloc, pParent));
+  }
+  else {
+    helper_DynRel(rsym, got_entry->getTable(), got_entry->getTableOffset(),
+                  llvm::ELF::R_X86_64_TLSDESC, pParent);
+  }
+  got_entry->setValue(0);
+  arg_entry->setValue(0);
+  return *got_entry;
+}
+
 //
 // R_X86_64_NONE
 X86Relocator::Result none(Relocation& pReloc, X86_64Relocator& pParent)
@@ -948,6 +1221,39 @@ X86Relocator::Result rel(Relocation& pReloc, X86_64Relocator& pParent)
   return X86Relocator::OK;
 }
 
+// R_X86_64_TPOFF32: S + A - TP
+X86Relocator::Result tpoff32(Relocation& pReloc, X86_64Relocator& pParent)
+{
+  pReloc.target() = helper_TLS_offset(pReloc, pParent) - helper_TP(pParent);
+  return X86Relocator::OK;
+}
+
+// R_X86_64_DTPOFF32: S + A - DTP
+X86Relocator::Result dtpoff32(Relocation& pReloc, X86_64Relocator& pParent)
+{
+  pReloc.target() = helper_TLS_offset(pReloc, pParent);
+  return X86Relocator::OK;
+}
+
+// R_X86_64_GOTTPOFF: GOT(S) + GOT_ORG + A - P
+X86Relocator::Result gottpoff(Relocation& pReloc, X86_64Relocator& pParent)
+{
+  X86_64GOTEntry& got_entry = helper_get_GOTTPOFF_and_init(pReloc, pParent);
+  pReloc.target() = got_entry.getOffset() + helper_GOT_ORG(pParent) +
+                    pReloc.addend() - pReloc.place();
+  return X86Relocator::OK;
+}
+
+// R_X86_64_GOTPC32_TLSDESC: GOT(S) + GOT_ORG + A - P, GOT(S) is the TLS
+// descriptor
+X86Relocator::Result tlsdesc(Relocation& pReloc, X86_64Relocator& pParent)
+{
+  X86_64GOTEntry& got_entry = helper_get_TLSDesc_and_init(pReloc, pParent);
+  pReloc.target() = got_entry.getOffset() + helper_GOT_ORG(pParent) +
+                    pReloc.addend() - pReloc.place();
+  return X86Relocator::OK;
+}
+
 X86Relocator::Result unsupport(Relocation& pReloc, X86_64Relocator& pParent)
 {
   return X86Relocator::Unsupport;
@@ -29,7 +29,7 @@ class ResolveInfo;
 class X86Relocator : public Relocator
 {
 public:
-  typedef SymbolEntryMap<PLTEntryBase> SymPLTMap;
+  typedef SymbolEntryMap<X86PLT1> SymPLTMap;
 
 public:
   X86Relocator();
@@ -57,7 +57,8 @@ public:
   typedef SymbolEntryMap<X86_32GOTEntry> SymGOTPLTMap;
 
   enum {
-    R_386_TLS_OPT = 44 // mcld internal relocation type
+    R_386_GOT32X  = 43, // FIXME: use llvm enum constant R_386_GOT32X
+    R_386_TLS_OPT = 44  // mcld internal relocation type
   };
 
 public:
@@ -65,6 +66,16 @@ public:
 
   Result applyRelocation(Relocation& pRelocation);
 
+  /// mayApplyConcurrently - the absolute, PC-relative and GOT-relative
+  /// relocations of symbols which need no GOT, PLT or dynamic relocation.
+  bool mayApplyConcurrently(const Relocation& pRelocation) const;
+
+  /// isDataAddend - R_386_32 and R_386_GOTOFF
+  bool isDataAddend(Type pType) const;
+
+  /// applyBatch - apply the common relocations by type in tight loops
+  void applyBatch(Relocation* const* pRelocs, Result* pResults, size_t pNum);
+
   X86_32GNULDBackend& getTarget()
   { return m_Target; }
 
@@ -97,11 +108,23 @@ public:
   typedef SymbolEntryMap<X86_64GOTEntry> SymGOTMap;
   typedef SymbolEntryMap<X86_64GOTEntry> SymGOTPLTMap;
 
+  enum {
+    R_X86_64_OPT32 = 43, // mcld internal relocation type
+    R_X86_64_OPT64 = 44  // mcld internal relocation type
+  };
+
 public:
   X86_64Relocator(X86_64GNULDBackend& pParent);
 
   Result applyRelocation(Relocation& pRelocation);
 
+  /// mayApplyConcurrently - the absolute, PC-relative and GOT-relative
+  /// relocations of symbols which need no GOT, PLT or dynamic relocation.
+  bool mayApplyConcurrently(const Relocation& pRelocation) const;
+
+  /// applyBatch - apply the common relocations by type in tight loops
+  void applyBatch(Relocation* const* pRelocs, Result* pResults, size_t pNum);
+
   X86_64GNULDBackend& getTarget()
   { return m_Target; }
 
@@ -118,10 +141,21 @@ public:
   const SymGOTPLTMap& getSymGOTPLTMap() const { return m_SymGOTPLTMap; }
   SymGOTPLTMap&       getSymGOTPLTMap()       { return m_SymGOTPLTMap; }
 
+  /// the .got entries holding the offsets of the TLS symbols to the thread
+  /// pointer
+  const SymGOTMap& getSymGOTTPOFFMap() const { return m_SymGOTTPOFFMap; }
+  SymGOTMap&       getSymGOTTPOFFMap()       { return m_SymGOTTPOFFMap; }
+
+  /// the first .got entries of the TLS descriptors
+  const SymGOTMap& getSymTLSDescMap() const { return m_SymTLSDescMap; }
+  SymGOTMap&       getSymTLSDescMap()       { return m_SymTLSDescMap; }
+
 private:
   X86_64GNULDBackend& m_Target;
   SymGOTMap m_SymGOTMap;
   SymGOTPLTMap m_SymGOTPLTMap;
+  SymGOTMap m_SymGOTTPOFFMap;
+  SymGOTMap m_SymTLSDescMap;
 };
 
 } // namespace of mcld
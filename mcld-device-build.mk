@@ -23,6 +23,11 @@ ifeq ($(MCLD_ENABLE_ASSERTION),true)
     -UNDEBUG
 endif
 
+ifeq ($(MCLD_ENABLE_HUGE_PAGES),true)
+  LOCAL_CPPFLAGS += \
+    -DMCLD_HUGE_PAGES=1
+endif
+
 # Make sure bionic is first so we can include system headers.
 LOCAL_C_INCLUDES := \
   bionic \
@@ -16,6 +16,11 @@ ifeq ($(MCLD_ENABLE_ASSERTION),true)
     -UNDEBUG
 endif
 
+ifeq ($(MCLD_ENABLE_HUGE_PAGES),true)
+  LOCAL_CPPFLAGS += \
+    -DMCLD_HUGE_PAGES=1
+endif
+
 LOCAL_C_INCLUDES := \
   $(MCLD_ROOT_PATH)/include \
   $(LLVM_ROOT_PATH) \
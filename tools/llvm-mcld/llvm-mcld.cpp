@@ -6,20 +6,28 @@
 // License. See LICENSE.TXT for details.
 //
 //===----------------------------------------------------------------------===//
+#include <mcld/Environment.h>
 #include <mcld/Module.h>
 #include <mcld/LinkerConfig.h>
 #include <mcld/Target/TargetMachine.h>
+#include <mcld/CodeGen/LTOCodeGen.h>
+#include <mcld/CodeGen/MCLinker.h>
+#include <mcld/CodeGen/SplitCodeGen.h>
 #include <mcld/Support/TargetSelect.h>
 #include <mcld/Support/TargetRegistry.h>
 #include <mcld/Support/CommandLine.h>
+#include <mcld/Support/Compression.h>
+#include <mcld/Support/Digest.h>
 #include <mcld/Support/Path.h>
 #include <mcld/Support/RealPath.h>
+#include <mcld/Support/SystemUtils.h>
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/FileSystem.h>
 #include <mcld/Support/raw_ostream.h>
 #include <mcld/Support/ToolOutputFile.h>
 #include <mcld/LD/DiagnosticLineInfo.h>
+#include <mcld/LD/IncrementalLink.h>
 #include <mcld/LD/TextDiagnosticPrinter.h>
 
 #include <llvm/PassManager.h>
@@ -41,6 +49,8 @@
 #include <llvm/Support/Process.h>
 #include <llvm/Target/TargetMachine.h>
 
+#include <cstring>
+
 #if defined(HAVE_UNISTD_H)
 # include <unistd.h>
 #endif
@@ -304,6 +314,54 @@ ArgTraceAlias("trace",
               cl::desc("alias for -t"),
               cl::aliasopt(ArgTrace));
 
+static cl::opt<bool>
+ArgTimeReport("time-report",
+              cl::desc("Print the time spent in each phase of the link"),
+              cl::init(false));
+
+static cl::opt<bool>
+ArgPerfCounters("perf-counters",
+                cl::desc("Report the IPC and the cache, TLB and branch misses "
+                         "of each phase with the time report (Linux)"),
+                cl::init(false));
+
+static cl::opt<std::string>
+ArgTimeTrace("time-trace",
+             cl::desc("Write the Chrome trace events of the link into the "
+                      "file"),
+             cl::value_desc("file"));
+
+static cl::opt<std::string>
+ArgCostReport("cost-report",
+              cl::desc("Write the bytes, sections, symbols, relocations and "
+                       "time of each input object into the file, as JSON if "
+                       "it ends in .json, or as CSV"),
+              cl::value_desc("file"));
+
+static cl::opt<bool>
+ArgPrintMemoryUsage("print-memory-usage",
+                    cl::desc("Print the memory used by the factories after "
+                             "each phase of the link"),
+                    cl::init(false));
+
+static cl::opt<bool>
+ArgStats("stats",
+         cl::desc("Print the counters of the work done in each phase of the "
+                  "link"),
+         cl::init(false));
+
+static cl::opt<bool>
+ArgExitFast("exit-fast",
+            cl::desc("Exit right after the output is written, without "
+                     "releasing the memory of the link"),
+            cl::init(false));
+
+static cl::opt<bool>
+ArgVerifyDeterminism("verify-determinism",
+                     cl::desc("Link again with one thread and report the "
+                              "first difference from the output"),
+                     cl::init(false));
+
 static cl::opt<int>
 ArgVerbose("verbose",
            cl::init(-1),
@@ -340,6 +398,11 @@ ArgBsymbolic("Bsymbolic",
              cl::desc("Bind references within the shared library."),
              cl::init(false));
 
+static cl::opt<bool>
+ArgBsymbolicFunctions("Bsymbolic-functions",
+             cl::desc("Bind references to functions within the shared library."),
+             cl::init(false));
+
 static cl::opt<bool>
 ArgBgroup("Bgroup",
           cl::desc("Info the dynamic linker to perform lookups only inside the group."),
@@ -365,6 +428,17 @@ ArgEhFrameHdr("eh-frame-hdr",
               cl::desc("Request creation of \".eh_frame_hdr\" section and ELF \"PT_GNU_EH_FRAME\" segment header."),
               cl::init(false));
 
+static cl::opt<bool>
+ArgGdbIndex("gdb-index",
+            cl::desc("Generate the \".gdb_index\" section of the DWARF names and address ranges."),
+            cl::init(false));
+
+static cl::opt<std::string>
+ArgSeparateDebugFile("separate-debug-file",
+                     cl::desc("Write the debug sections into the file, and "
+                              "link the output to it by .gnu_debuglink"),
+                     cl::value_desc("path"));
+
 static cl::list<mcld::ZOption, bool, llvm::cl::parser<mcld::ZOption> >
 ArgZOptionList("z",
                cl::ZeroOrMore,
@@ -521,9 +595,6 @@ ArgOMagicAlias("N",
                cl::desc("alias for --omagic"),
                cl::aliasopt(ArgOMagic));
 
-/// @{
-/// @name FIXME: begin of unsupported options
-/// @}
 static cl::opt<bool>
 ArgGCSections("gc-sections",
               cl::desc("Enable garbage collection of unused input sections."),
@@ -553,9 +624,12 @@ ArgICF("icf",
          clEnumValN(icf::All, "all",
            "always preform cold folding"),
          clEnumValN(icf::Safe, "safe",
-           "Folds ctors, dtors and functions whose pointers are definitely not taken."),
+           "only fold ctors and dtors, whose addresses are never compared."),
          clEnumValEnd));
 
+/// @{
+/// @name FIXME: begin of unsupported options
+/// @}
 // FIXME: add this to target options?
 static cl::opt<bool>
 ArgFIXCA8("fix-cortex-a8",
@@ -591,8 +665,11 @@ ArgExcludeLIBS("exclude-libs",
 
 static cl::opt<std::string>
 ArgBuildID("build-id",
-           cl::desc("Request creation of \".note.gnu.build-id\" ELF note section."),
-           cl::value_desc("style"));
+           cl::desc("Request creation of \".note.gnu.build-id\" ELF note section. "
+                    "The style is fast, md5, sha1 (default), uuid, 0x<hex> "
+                    "or none."),
+           cl::value_desc("style"),
+           cl::ValueOptional);
 
 static cl::opt<std::string>
 ArgForceUndefined("u",
@@ -609,6 +686,21 @@ ArgVersionScript("version-script",
                  cl::desc("Version script."),
                  cl::value_desc("Version script"));
 
+static cl::opt<std::string>
+ArgDynamicList("dynamic-list",
+               cl::desc("Export the symbols listed in the file only"),
+               cl::value_desc("file"));
+
+static cl::opt<std::string>
+ArgScript("script",
+          cl::desc("Place the input sections by the SECTIONS of the linker script"),
+          cl::value_desc("file"));
+
+static cl::alias
+ArgScriptAlias("T",
+               cl::desc("alias for --script"),
+               cl::aliasopt(ArgScript));
+
 static cl::opt<bool>
 ArgWarnCommon("warn-common",
               cl::desc("warn common symbol"),
@@ -626,6 +718,83 @@ ArgHashStyle("hash-style", cl::init(mcld::GeneralOptions::SystemV),
                  "both the classic ELF and new style GNU hash tables"),
        clEnumValEnd));
 
+static cl::opt<mcld::GeneralOptions::PackDynRelocs>
+ArgPackDynRelocs("pack-dyn-relocs",
+  cl::init(mcld::GeneralOptions::PackDynRelocs_None),
+  cl::desc("Pack the relative dynamic relocations."),
+  cl::values(
+       clEnumValN(mcld::GeneralOptions::PackDynRelocs_None, "none",
+                 "do not pack the dynamic relocations"),
+       clEnumValN(mcld::GeneralOptions::PackDynRelocs_Relr, "relr",
+                 "pack the relative relocations into .relr.dyn"),
+       clEnumValN(mcld::GeneralOptions::PackDynRelocs_Android, "android",
+                 "pack the relative relocations with the Android tags"),
+       clEnumValEnd));
+
+static cl::opt<mcld::GeneralOptions::CompressDebugSections>
+ArgCompressDebugSections("compress-debug-sections",
+  cl::init(mcld::GeneralOptions::CompressDebugSections_None),
+  cl::desc("Compress the debug sections."),
+  cl::values(
+       clEnumValN(mcld::GeneralOptions::CompressDebugSections_None, "none",
+                 "do not compress the debug sections"),
+       clEnumValN(mcld::GeneralOptions::CompressDebugSections_Zlib, "zlib",
+                 "compress the debug sections with zlib (SHF_COMPRESSED)"),
+       clEnumValEnd));
+
+static cl::opt<std::string>
+ArgSymbolOrderingFile("symbol-ordering-file",
+  cl::desc("Place the sections of the symbols listed in the file first, in "
+           "the listed order"),
+  cl::value_desc("file"));
+
+static cl::opt<bool>
+ArgCallGraphOrdering("call-graph-ordering",
+  cl::desc("Reorder the functions of .text by the call graph"),
+  cl::init(false));
+
+static cl::opt<std::string>
+ArgCallGraphProfileFile("call-graph-profile-file",
+  cl::desc("Weight the call graph by the `caller callee count' lines of the "
+           "file. It implies --call-graph-ordering"),
+  cl::value_desc("file"));
+
+static cl::opt<std::string>
+ArgSmallDataProfileFile("small-data-profile-file",
+  cl::desc("Order the small data of GP-relative targets by the "
+           "`symbol count' lines of the file"),
+  cl::value_desc("file"));
+
+static cl::opt<std::string>
+ArgPrelinkMap("prelink-map",
+  cl::desc("Lay out a shared library at its base address in the file, "
+           "whose lines are `library address'"),
+  cl::value_desc("file"));
+
+static cl::opt<bool>
+ArgPackDataPages("pack-data-pages",
+  cl::desc("Order the writable sections to pack the RELRO data into the "
+           "fewest pages, and put the small .data sections next to .bss"),
+  cl::init(false));
+
+static cl::opt<bool>
+ArgHugePageText("huge-page-text",
+  cl::desc("Align the executable segment to 2MiB huge pages. It implies "
+           "-z separate-code"),
+  cl::init(false));
+
+static cl::opt<bool>
+ArgIncremental("incremental",
+  cl::desc("Update the output in place if only the contents of some "
+           "objects are changed since the last link"),
+  cl::init(false));
+
+static cl::opt<bool>
+ArgLazySharedSymbols("lazy-shared-symbols",
+  cl::desc("Read only the symbols of shared libraries which resolve "
+           "undefined references, by the hash tables of the libraries"),
+  cl::init(false));
+
 static cl::opt<std::string>
 ArgFilter("F",
           cl::desc("Filter for shared object symbol table"),
@@ -682,6 +851,120 @@ ArgEnableNewDTags("enable-new-dtags",
                   cl::desc("Enable use of DT_RUNPATH and DT_FLAGS"),
                   cl::init(false));
 
+static cl::opt<unsigned int>
+ArgThreads("threads",
+           cl::desc("Use N threads to link, 0 means one per processor"),
+           cl::value_desc("N"),
+           cl::init(1));
+
+static cl::opt<bool>
+ArgThreadAffinity("thread-affinity",
+                  cl::desc("Bind the threads to the processors node by node, "
+                           "and keep the work on an input on its thread"),
+                  cl::init(false));
+
+static cl::opt<unsigned int>
+ArgCodeGenPartitions("codegen-partitions",
+                     cl::desc("Split the bitcode into N partitions and "
+                              "compile them in parallel"),
+                     cl::value_desc("N"),
+                     cl::init(1));
+
+static cl::opt<unsigned int>
+ArgLTOJobs("lto-jobs",
+           cl::desc("Compile the module of the link time optimization as N "
+                    "partitions in parallel, 0 means --codegen-partitions"),
+           cl::value_desc("N"),
+           cl::init(0));
+
+static cl::opt<std::string>
+ArgLTOCacheDir("lto-cache-dir",
+               cl::desc("Cache the objects of the link time optimization in "
+                        "the directory"),
+               cl::value_desc("dir"));
+
+static cl::opt<std::string>
+ArgArchiveIndexCache("archive-index-cache",
+                     cl::desc("Cache the symbol indexes of archives in the "
+                              "directory"),
+                     cl::value_desc("dir"));
+
+static cl::opt<std::string>
+ArgDynObjSummaryCache("dynobj-summary-cache",
+                      cl::desc("Cache the symbol summaries of shared objects "
+                               "in the directory"),
+                      cl::value_desc("dir"));
+
+static cl::opt<std::string>
+ArgObjectSummaryCache("object-summary-cache",
+                      cl::desc("Cache the decoded tables of relocatable "
+                               "objects in the directory"),
+                      cl::value_desc("dir"));
+
+static cl::opt<std::string>
+ArgLinkCache("link-cache",
+             cl::desc("Copy the output from the cache in the directory if the "
+                      "same inputs were linked by the same command line"),
+             cl::value_desc("dir"));
+
+static cl::opt<bool>
+ArgMapWholeFile("map-whole-files",
+                cl::desc("Map every read-only input file into memory at once"),
+                cl::init(true));
+
+static cl::opt<bool>
+ArgFuseRelocations("fuse-relocations",
+                   cl::desc("Apply the relocations which reserve no GOT, PLT "
+                            "or dynamic relocation entries while writing the "
+                            "output"),
+                   cl::init(false));
+
+static cl::opt<bool>
+ArgKernelCopy("kernel-copy",
+              cl::desc("Copy the large input contents which no relocation "
+                       "changes into the output file in the kernel"),
+              cl::init(false));
+
+static cl::opt<bool>
+ArgStreamPartialLink("stream-partial-link",
+                     cl::desc("Copy the relocation sections of a partial "
+                              "link into the output without reading them "
+                              "into the linker"),
+                     cl::init(false));
+
+static cl::opt<bool>
+ArgLowMemory("low-memory",
+             cl::desc("Write the output section by section to bound the "
+                      "peak memory, at the cost of some link time"),
+             cl::init(false));
+
+static cl::opt<mcld::GeneralOptions::OutputStrategy>
+ArgOutputStrategy("output-strategy",
+  cl::init(mcld::GeneralOptions::OutputStrategy_Map),
+  cl::desc("How the output file is written."),
+  cl::values(
+       clEnumValN(mcld::GeneralOptions::OutputStrategy_Map, "map",
+                 "grow the output and map it piece by piece on demand"),
+       clEnumValN(mcld::GeneralOptions::OutputStrategy_Preallocate,
+                 "preallocate",
+                 "allocate the final size at once and map the whole output"),
+       clEnumValN(mcld::GeneralOptions::OutputStrategy_Write, "write",
+                 "allocate the final size at once and write each section "
+                 "by a single write, without mapping the output"),
+       clEnumValEnd));
+
+static cl::opt<mcld::GeneralOptions::SortSection>
+ArgSortSection("sort-section",
+  cl::init(mcld::GeneralOptions::SortSection_None),
+  cl::desc("Sort the input sections of an output section which are not "
+           "placed by the linker script or --symbol-ordering-file."),
+  cl::values(
+       clEnumValN(mcld::GeneralOptions::SortSection_Name, "name",
+                 "sort by name"),
+       clEnumValN(mcld::GeneralOptions::SortSection_Alignment, "alignment",
+                 "sort by decreasing alignment, which drops most padding"),
+       clEnumValEnd));
+
 class FalseParser : public cl::parser<bool> {
   const char *ArgStr;
 public:
@@ -956,6 +1239,41 @@ static void ParseProgName(const char *progname)
   }
 }
 
+/// ParseBuildID - Parse the style of --build-id
+/// @return false if the style is unknown
+static bool ParseBuildID(const std::string& pStyle,
+                         mcld::GeneralOptions& pOptions)
+{
+  if (pStyle.empty() || "sha1" == pStyle)
+    pOptions.setBuildID(mcld::GeneralOptions::BuildID_SHA1);
+  else if ("fast" == pStyle)
+    pOptions.setBuildID(mcld::GeneralOptions::BuildID_Fast);
+  else if ("md5" == pStyle)
+    pOptions.setBuildID(mcld::GeneralOptions::BuildID_MD5);
+  else if ("uuid" == pStyle)
+    pOptions.setBuildID(mcld::GeneralOptions::BuildID_UUID);
+  else if ("none" == pStyle)
+    pOptions.setBuildID(mcld::GeneralOptions::BuildID_None);
+  else if (StringRef(pStyle).startswith("0x")) {
+    // the bytes are given in the order of the hex string
+    std::string hex = pStyle.substr(2);
+    if (hex.empty() || 0 != (hex.size() % 2))
+      return false;
+    std::string bytes;
+    for (size_t i = 0; i < hex.size(); i += 2) {
+      unsigned int byte;
+      if (StringRef(hex.substr(i, 2)).getAsInteger(16, byte))
+        return false;
+      bytes.push_back(static_cast<char>(byte));
+    }
+    pOptions.setBuildID(mcld::GeneralOptions::BuildID_Hex);
+    pOptions.setBuildIDValue(bytes);
+  }
+  else
+    return false;
+  return true;
+}
+
 static bool ShouldColorize()
 {
    const char* term = getenv("TERM");
@@ -992,6 +1310,12 @@ static bool ProcessLinkerOptionsFromCommand(mcld::LinkerConfig& pConfig) {
     pConfig.options().getRpathList().push_back(*rp);
   }
 
+  // add all rpath-link entries
+  rpEnd = ArgRuntimePathLink.end();
+  for (rp = ArgRuntimePathLink.begin(); rp != rpEnd; ++rp) {
+    pConfig.options().getRpathLinkList().push_back(*rp);
+  }
+
   // --fatal-warnings
   // pConfig.options().setFatalWarnings(ArgFatalWarnings);
 
@@ -1037,16 +1361,27 @@ static bool ProcessLinkerOptionsFromCommand(mcld::LinkerConfig& pConfig) {
 
   pConfig.options().setPIE(ArgPIE);
   pConfig.options().setTrace(ArgTrace);
+  pConfig.options().setTimeReport(ArgTimeReport);
+  pConfig.options().setTimeTrace(ArgTimeTrace);
+  pConfig.options().setCostReport(ArgCostReport);
+  pConfig.options().setPerfCounters(ArgPerfCounters);
+  pConfig.options().setPrintMemoryUsage(ArgPrintMemoryUsage);
+  pConfig.options().setStats(ArgStats);
+  pConfig.options().setExitFast(ArgExitFast);
+  pConfig.options().setVerifyDeterminism(ArgVerifyDeterminism);
   pConfig.options().setVerbose(ArgVerbose);
   pConfig.options().setMaxErrorNum(ArgMaxErrorNum);
   pConfig.options().setMaxWarnNum(ArgMaxWarnNum);
   pConfig.options().setEntry(ArgEntry);
   pConfig.options().setBsymbolic(ArgBsymbolic);
+  pConfig.options().setBsymbolicFunctions(ArgBsymbolicFunctions);
   pConfig.options().setBgroup(ArgBgroup);
   pConfig.options().setDyld(ArgDyld);
   pConfig.options().setNoUndefined(ArgNoUndefined);
   pConfig.options().setMulDefs(ArgAllowMulDefs);
   pConfig.options().setEhFrameHdr(ArgEhFrameHdr);
+  pConfig.options().setGdbIndex(ArgGdbIndex);
+  pConfig.options().setSeparateDebugFile(ArgSeparateDebugFile);
   pConfig.options().setNMagic(ArgNMagic);
   pConfig.options().setOMagic(ArgOMagic);
   pConfig.options().setStripDebug(ArgStripDebug || ArgStripAll);
@@ -1055,7 +1390,64 @@ static bool ProcessLinkerOptionsFromCommand(mcld::LinkerConfig& pConfig) {
   pConfig.options().setDefineCommon(ArgDefineCommon);
   pConfig.options().setNewDTags(ArgEnableNewDTags);
   pConfig.options().setHashStyle(ArgHashStyle);
+  pConfig.options().setPackDynRelocs(ArgPackDynRelocs);
+  if (mcld::GeneralOptions::CompressDebugSections_Zlib ==
+      ArgCompressDebugSections && !mcld::zlib::isAvailable()) {
+    mcld::warning(mcld::diag::warn_zlib_not_available)
+      << ArgCompressDebugSections.ArgStr;
+  }
+  else
+    pConfig.options().setCompressDebugSections(ArgCompressDebugSections);
+  pConfig.options().setSymbolOrderingFile(ArgSymbolOrderingFile);
+  pConfig.options().setCallGraphOrdering(ArgCallGraphOrdering ||
+                                         !ArgCallGraphProfileFile.empty());
+  pConfig.options().setCallGraphProfileFile(ArgCallGraphProfileFile);
+  pConfig.options().setSmallDataProfileFile(ArgSmallDataProfileFile);
+  pConfig.options().setDynamicList(ArgDynamicList);
+  pConfig.options().setVersionScript(ArgVersionScript);
+  pConfig.options().excludeLIBS().insert(ArgExcludeLIBS.begin(),
+                                         ArgExcludeLIBS.end());
+  pConfig.options().setHugePageText(ArgHugePageText);
+  pConfig.options().setPackDataPages(ArgPackDataPages);
+  pConfig.options().setPrelinkMap(ArgPrelinkMap);
+  pConfig.options().setIncremental(ArgIncremental);
+  pConfig.options().setLazySharedSymbols(ArgLazySharedSymbols);
   pConfig.options().setNoStdlib(ArgNoStdlib);
+  pConfig.options().setNumThreads(ArgThreads);
+  pConfig.options().setThreadAffinity(ArgThreadAffinity);
+  pConfig.options().setCodeGenPartitions(ArgCodeGenPartitions);
+  pConfig.options().setLTOJobs(ArgLTOJobs);
+  pConfig.options().setLTOCacheDir(ArgLTOCacheDir);
+  pConfig.options().setMapWholeFile(ArgMapWholeFile);
+  pConfig.options().setFuseRelocations(ArgFuseRelocations);
+  pConfig.options().setKernelCopy(ArgKernelCopy);
+  pConfig.options().setStreamPartialLink(ArgStreamPartialLink);
+  pConfig.options().setLowMemory(ArgLowMemory);
+  pConfig.options().setOutputStrategy(ArgOutputStrategy);
+  pConfig.options().setSortSection(ArgSortSection);
+
+  // --build-id[=style]
+  if (ArgBuildID.getNumOccurrences() > 0 &&
+      !ParseBuildID(ArgBuildID, pConfig.options())) {
+    mcld::error(mcld::diag::err_invalid_build_id) << ArgBuildID;
+    return false;
+  }
+
+  // --script, the SECTIONS are compiled once before any input is read
+  if (!ArgScript.empty()) {
+    mcld::SectionScript& sections = pConfig.scripts().sections();
+    if (!sections.read(mcld::sys::fs::Path(ArgScript))) {
+      mcld::error(mcld::diag::err_cannot_read_linker_script) << ArgScript;
+      return false;
+    }
+    if (sections.hasDiscard())
+      mcld::warning(mcld::diag::warn_linker_script_discard) << ArgScript;
+  }
+  pConfig.options().setArchiveIndexCache(ArgArchiveIndexCache);
+  pConfig.options().setDynObjSummaryCache(ArgDynObjSummaryCache);
+  pConfig.options().setObjectSummaryCache(ArgObjectSummaryCache);
+  pConfig.options().setLinkCache(ArgLinkCache);
+  pConfig.options().setGCSections(ArgGCSections && !ArgNoGCSections);
 
   if (ArgStripAll)
     pConfig.options().setStripSymbols(mcld::GeneralOptions::StripAllSymbols);
@@ -1124,18 +1516,17 @@ static bool ProcessLinkerOptionsFromCommand(mcld::LinkerConfig& pConfig) {
     pConfig.options().addZOption(*zOpt);
   }
 
-  if (ArgGCSections) {
-    mcld::warning(mcld::diag::warn_unsupported_option) << ArgGCSections.ArgStr;
-  }
-
   // set up icf mode
   switch (ArgICF) {
-    case icf::None:
-      break;
     case icf::All:
+      pConfig.options().setICFMode(mcld::GeneralOptions::ICF_All);
+      break;
     case icf::Safe:
+      pConfig.options().setICFMode(mcld::GeneralOptions::ICF_Safe);
+      break;
+    case icf::None:
     default:
-      mcld::warning(mcld::diag::warn_unsupported_option) << ArgICF.ArgStr;
+      pConfig.options().setICFMode(mcld::GeneralOptions::ICF_None);
       break;
   }
 
@@ -1201,10 +1592,8 @@ int main(int argc, char* argv[])
   InitializeAllAsmPrinters();
   InitializeAllAsmParsers();
   InitializeAllTargetMCs();
-  mcld::InitializeAllTargets();
-  mcld::InitializeAllLinkers();
-  mcld::InitializeAllEmulations();
-  mcld::InitializeAllDiagnostics();
+  // the mcld targets are initialized when they are looked up
+  mcld::Initialize();
 
   ParseProgName(argv[0]);
   cl::ParseCommandLineOptions(argc, argv, "MCLinker\n");
@@ -1288,7 +1677,7 @@ int main(int argc, char* argv[])
     for (mcld::TargetRegistry::iterator it = mcld::TargetRegistry::begin(),
            ie = mcld::TargetRegistry::end(); it != ie; ++it) {
       if (MArch == (*it)->get()->getName()) {
-        TheTarget = *it;
+        TheTarget = mcld::TargetRegistry::lookupTarget(*(*it)->get());
         break;
       }
     }
@@ -1385,6 +1774,85 @@ int main(int argc, char* argv[])
 
   mcld::getDiagnosticEngine().setLineInfo(*diag_line_info.take());
 
+  // The hash of the command line keys the cached outputs and the state of
+  // --incremental.
+  uint64_t key = mcld::digest::fast(NULL, 0);
+  for (int i = 0; i < argc; ++i) {
+    key = mcld::digest::fast(reinterpret_cast<const uint8_t*>(argv[i]),
+                             strlen(argv[i]) + 1, key);
+  }
+  LDConfig.options().setCommandLineKey(key);
+
+  // With --incremental, update the output of the last link in place if only
+  // the contents of some objects are changed. --verify-determinism links
+  // twice, and the module of the first link is not kept for the next one.
+  OwningPtr<mcld::IncrementalLink> incremental;
+  if (LDConfig.options().isIncremental() &&
+      !LDConfig.options().verifyDeterminism() &&
+      !ArgOutputFilename.empty() &&
+      (mcld::CGFT_EXEFile == ArgFileType ||
+       mcld::CGFT_DSOFile == ArgFileType)) {
+    incremental.reset(new mcld::IncrementalLink(LDConfig,
+                                                ArgOutputFilename.native(),
+                                                key));
+    if (incremental->update())
+      return 0;
+  }
+
+  bool is_link = (mcld::CGFT_DSOFile == ArgFileType ||
+                  mcld::CGFT_EXEFile == ArgFileType ||
+                  mcld::CGFT_PARTIAL == ArgFileType ||
+                  mcld::CGFT_BINARY  == ArgFileType);
+
+  // The bitcode inputs of the link, files or archive members, are resolved
+  // against the other inputs and linked into the module, which is optimized
+  // as a whole program.
+  OwningPtr<mcld::LTOCodeGen> lto;
+  if (is_link) {
+    lto.reset(new mcld::LTOCodeGen(LDConfig, mod));
+    if (!mcld::MCLinker::AddLTOInputs(LDConfig, *lto))
+      return 1;
+    if (lto->empty())
+      lto.reset();
+    else if (!lto->run())
+      return 1;
+  }
+
+  // Compile the bitcode before the link and hand the objects to the linker
+  // in the memory, in place of the bitcode. With --codegen-partitions, the
+  // bitcode is compiled as partitions on the thread pool. The module of the
+  // LTO is compiled as --lto-jobs partitions, and the objects are cached in
+  // --lto-cache-dir. The module is left with the declarations only.
+  OwningPtr<mcld::SplitCodeGen> split;
+  if (is_link && (!ArgBitcodeFilename.empty() || NULL != lto.get())) {
+    split.reset(new mcld::SplitCodeGen(*TheTarget, TheTriple.getTriple(),
+                                       MCPU, FeaturesStr, Options,
+                                       ArgRelocModel, CMModel, OLvl));
+    unsigned int num_of_parts = LDConfig.options().codeGenPartitions();
+    if (NULL != lto.get()) {
+      num_of_parts = LDConfig.options().ltoJobs();
+      if (LDConfig.options().hasLTOCacheDir()) {
+        mcld::sys::fs::Path dir(LDConfig.options().ltoCacheDir());
+        if (mcld::sys::fs::is_directory(dir))
+          split->setCacheDir(dir);
+        else
+          mcld::warning(mcld::diag::warn_bad_lto_cache) << dir;
+      }
+    }
+    if (!split->run(LDConfig.threads(), mod, num_of_parts))
+      return 1;
+    if (!ArgBitcodeFilename.empty()) {
+      LDConfig.bitcode().setPosition(ArgBitcodeFilename.getPosition());
+      LDConfig.bitcode().setPath(ArgBitcodeFilename);
+    }
+    else {
+      LDConfig.bitcode().setPosition(lto->position());
+      LDConfig.bitcode().setPath(lto->path());
+    }
+    LDConfig.bitcode().setLTO(NULL != lto.get());
+    split->addObjects(LDConfig.bitcode());
+  }
+
   // Figure out where we are going to send the output...
   OwningPtr<mcld::ToolOutputFile>
   Out(GetOutputStream(TheTarget->get()->getName(),
@@ -1434,6 +1902,23 @@ int main(int argc, char* argv[])
 
   // Declare success.
   Out->keep();
+
+  // Save the state of the full link for the next --incremental link.
+  if (NULL != incremental.get()) {
+    Out->memory().clear();
+    incremental->record(LDIRModule);
+  }
+
+  // With --exit-fast, only the output is closed. The Module, the factories
+  // and the inputs are left to the system.
+  if (LDConfig.options().exitFast()) {
+    Out.reset();
+    mcld::outs().flush();
+    mcld::errs().flush();
+    outs().flush();
+    errs().flush();
+    mcld::sys::Exit(0);
+  }
   return 0;
 }
 
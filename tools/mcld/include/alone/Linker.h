@@ -20,6 +20,7 @@ class LinkerConfig;
 class Linker;
 class Input;
 class MemoryArea;
+class MemoryAreaFactory;
 
 namespace sys { namespace fs {
 
@@ -69,7 +70,10 @@ public:
 
   ~Linker();
 
-  enum ErrorCode config(const LinkerConfig& pConfig);
+  /// config - set up the linker. If pAreas is given, the input files are
+  /// read through its MemoryAreas, which outlive the linker.
+  enum ErrorCode config(const LinkerConfig& pConfig,
+                        mcld::MemoryAreaFactory* pAreas = NULL);
 
   enum ErrorCode addNameSpec(const std::string &pNameSpec);
 
@@ -0,0 +1,88 @@
+//===- LinkBatch.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ALONE_SUPPORT_LINK_BATCH_H
+#define ALONE_SUPPORT_LINK_BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "alone/Support/LinkServer.h"
+
+namespace mcld {
+
+class MemoryAreaFactory;
+
+} // end namespace mcld
+
+namespace alone {
+
+/** \class LinkBatch
+ *  \brief LinkBatch runs the links listed in a manifest, sharing the input
+ *  files used by more than one of them.
+ *
+ *  Every line of a manifest is the command line of a link without the
+ *  program name, such as "-o t1 t1.o -L. -lfoo". The arguments are separated
+ *  by white spaces and may be quoted by '"'. Empty lines and the lines
+ *  starting with '#' are ignored.
+ *
+ *  Before the links start, the files named by more than one link are loaded
+ *  into a MemoryAreaFactory once, as LinkServer preloads them. Every link
+ *  runs in a forked process which parses its own command line, so it has
+ *  the same configuration as an independent link, and reads the shared
+ *  files through the inherited MemoryAreas. The links run in any order, so
+ *  a link must not read the output of another one.
+ */
+class LinkBatch {
+public:
+  typedef LinkServer::LinkFunction LinkFunction;
+
+private:
+  typedef std::vector<std::string> ArgumentList;
+
+  struct Job {
+    unsigned line;
+    ArgumentList args;
+  };
+
+  typedef std::vector<Job> JobList;
+
+private:
+  unsigned mNumOfJobs;
+  mcld::MemoryAreaFactory* mAreas;
+  JobList mJobs;
+
+public:
+  /// LinkBatch - run at most pNumOfJobs links at a time. If pNumOfJobs is
+  /// zero, use the number of processors.
+  explicit LinkBatch(unsigned pNumOfJobs);
+
+  ~LinkBatch();
+
+  /// read - read the links of the manifest at pPath.
+  bool read(const std::string& pPath);
+
+  size_t size() const { return mJobs.size(); }
+
+  /// run - load the shared files and run all links.
+  /// @return EXIT_SUCCESS if every link succeeds
+  int run(const char* pProgram, LinkFunction pLink);
+
+private:
+  /// preload - load the files named by more than one link.
+  void preload();
+
+  /// start - fork the process of pJob.
+  /// @return the process id, or -1 if the process can not be created
+  int start(const Job& pJob, const char* pProgram, LinkFunction pLink);
+};
+
+} // end namespace alone
+
+#endif // ALONE_SUPPORT_LINK_BATCH_H
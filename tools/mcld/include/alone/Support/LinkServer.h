@@ -0,0 +1,107 @@
+//===- LinkServer.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ALONE_SUPPORT_LINK_SERVER_H
+#define ALONE_SUPPORT_LINK_SERVER_H
+
+#include <string>
+#include <vector>
+
+#include <mcld/Support/FileSystem.h>
+
+namespace mcld {
+
+class MemoryArea;
+class MemoryAreaFactory;
+
+} // end namespace mcld
+
+namespace alone {
+
+/** \class LinkServer
+ *  \brief LinkServer serves the links submitted over a local socket, and
+ *  keeps the files used by most links opened and mapped between them.
+ *
+ *  The server preloads the given files, such as libc.so and the prebuilt
+ *  archives, into a MemoryAreaFactory. For every request, the server forks a
+ *  process that links by the command line of the request in the working
+ *  directory of the client, with the standard output and error of the
+ *  client. A link gets a fresh Module and reads the preloaded files through
+ *  the inherited MemoryAreas, so it does not open nor map them again. The
+ *  preloaded files changed since the last request are loaded again before
+ *  the fork.
+ *
+ *  Only the file mappings are shared. The parsed symbol tables of the shared
+ *  objects and the symbol indexes of the archives are NOT kept warm: their
+ *  LDSymbols, ResolveInfos and fragments come from the global factories of
+ *  a link, which Linker::reset() tears down, so nothing parsed by the server
+ *  before the fork could be reused by a link.
+ *
+ *  A link runs as the user of the server, in any directory and with any
+ *  output. The socket file is accessible to that user only, and the
+ *  connections of the other users are refused by their credentials.
+ */
+class LinkServer {
+public:
+  /// LinkFunction - link by the command line. The input files are read
+  /// through pAreas if it is not NULL.
+  /// @return the exit status of the link
+  typedef int (*LinkFunction)(int pArgc, char** pArgv,
+                              mcld::MemoryAreaFactory* pAreas);
+
+private:
+  struct Preload {
+    std::string path;
+    mcld::sys::fs::FileID id;
+    mcld::MemoryArea* area;
+  };
+
+  typedef std::vector<Preload> PreloadList;
+
+private:
+  std::string mSocketPath;
+  mcld::MemoryAreaFactory* mAreas;
+  PreloadList mPreloads;
+  int mSocket;
+
+public:
+  explicit LinkServer(const std::string& pSocketPath);
+
+  ~LinkServer();
+
+  /// preload - open and map the file of pPath for the following links. A
+  /// relative pPath is of the directory of the server, and is kept as an
+  /// absolute path, so a link matches a relative path of its own directory
+  /// to the preloaded files by the FileID only.
+  bool preload(const std::string& pPath);
+
+  /// run - serve the requests until the server fails.
+  /// @return the exit status of the server
+  int run(LinkFunction pLink);
+
+  /// Submit - submit the link of the command line to the server at
+  /// pSocketPath, and wait for it.
+  /// @return the exit status of the link, or -1 if the server is not
+  /// reachable.
+  static int Submit(const std::string& pSocketPath, int pArgc, char** pArgv);
+
+private:
+  /// load - open and map the file of pPreload
+  bool load(Preload& pPreload);
+
+  /// refresh - load the preloaded files changed since they were loaded.
+  void refresh();
+
+  /// serve - serve the request of the connection pConnection
+  void serve(int pConnection, LinkFunction pLink);
+};
+
+} // end namespace alone
+
+#endif // ALONE_SUPPORT_LINK_SERVER_H
@@ -95,7 +95,8 @@ enum Linker::ErrorCode Linker::extractFiles(const LinkerConfig& pConfig) {
   return kSuccess;
 }
 
-enum Linker::ErrorCode Linker::config(const LinkerConfig& pConfig) {
+enum Linker::ErrorCode Linker::config(const LinkerConfig& pConfig,
+                                      mcld::MemoryAreaFactory* pAreas) {
   if (mLDConfig != NULL) {
     return kDoubleConfig;
   }
@@ -104,7 +105,11 @@ enum Linker::ErrorCode Linker::config(const LinkerConfig& pConfig) {
 
   mModule = new mcld::Module(mLDConfig->options().soname());
 
-  mBuilder = new mcld::IRBuilder(*mModule, *mLDConfig);
+  if (NULL != pAreas) {
+    mBuilder = new mcld::IRBuilder(*mModule, *mLDConfig, *pAreas);
+  } else {
+    mBuilder = new mcld::IRBuilder(*mModule, *mLDConfig);
+  }
 
   mLinker = new mcld::Linker();
 
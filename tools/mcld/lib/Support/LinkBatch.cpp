@@ -0,0 +1,210 @@
+//===- LinkBatch.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "alone/Support/LinkBatch.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryAreaFactory.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/Thread.h>
+
+using namespace alone;
+
+namespace {
+
+/// SplitLine - split pLine into the arguments. A quoted argument may
+/// contain white spaces.
+/// @return false if a quote is not closed
+bool SplitLine(const std::string& pLine, std::vector<std::string>& pArgs) {
+  size_t pos = 0;
+  while (pos < pLine.size()) {
+    if (isspace(static_cast<unsigned char>(pLine[pos]))) {
+      ++pos;
+      continue;
+    }
+
+    std::string arg;
+    bool quoted = false;
+    while (pos < pLine.size() &&
+           (quoted || !isspace(static_cast<unsigned char>(pLine[pos])))) {
+      if ('"' == pLine[pos]) {
+        quoted = !quoted;
+      } else {
+        arg.push_back(pLine[pos]);
+      }
+      ++pos;
+    }
+    if (quoted) {
+      return false;
+    }
+    pArgs.push_back(arg);
+  }
+  return true;
+}
+
+/// IsRegularFile - is pPath a regular file, which may be an input of a link
+bool IsRegularFile(const std::string& pPath) {
+  struct stat st;
+  return (0 == ::stat(pPath.c_str(), &st) && S_ISREG(st.st_mode));
+}
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LinkBatch
+//===----------------------------------------------------------------------===//
+LinkBatch::LinkBatch(unsigned pNumOfJobs)
+  : mNumOfJobs(pNumOfJobs), mAreas(new mcld::MemoryAreaFactory(32)) {
+  if (0 == mNumOfJobs) {
+    mNumOfJobs = mcld::sys::GetNumOfProcessors();
+  }
+}
+
+LinkBatch::~LinkBatch() {
+  delete mAreas;
+}
+
+bool LinkBatch::read(const std::string& pPath) {
+  std::ifstream manifest(pPath.c_str());
+  if (!manifest) {
+    llvm::errs() << "Cannot open the manifest `" << pPath << "'!\n";
+    return false;
+  }
+
+  std::string line;
+  unsigned line_no = 0;
+  while (std::getline(manifest, line)) {
+    ++line_no;
+    Job job;
+    job.line = line_no;
+    if (!SplitLine(line, job.args)) {
+      llvm::errs() << pPath << ":" << line_no << ": unterminated quote!\n";
+      return false;
+    }
+    if (job.args.empty() || '#' == job.args[0][0]) {
+      continue;
+    }
+    mJobs.push_back(job);
+  }
+  return true;
+}
+
+void LinkBatch::preload() {
+  // count the links naming each file once. The outputs are not inputs.
+  std::map<std::string, unsigned> counts;
+  JobList::const_iterator job, jobEnd = mJobs.end();
+  for (job = mJobs.begin(); job != jobEnd; ++job) {
+    std::set<std::string> names;
+    for (size_t i = 0; i < job->args.size(); ++i) {
+      if ("-o" == job->args[i]) {
+        ++i;
+        continue;
+      }
+      names.insert(job->args[i]);
+    }
+    std::set<std::string>::const_iterator name, nameEnd = names.end();
+    for (name = names.begin(); name != nameEnd; ++name) {
+      ++counts[*name];
+    }
+  }
+
+  std::map<std::string, unsigned>::const_iterator it, itEnd = counts.end();
+  for (it = counts.begin(); it != itEnd; ++it) {
+    if (it->second < 2 || '-' == it->first[0] || !IsRegularFile(it->first)) {
+      continue;
+    }
+
+    mcld::MemoryArea* area =
+      mAreas->produce(mcld::sys::fs::Path(it->first),
+                      mcld::FileHandle::ReadOnly);
+    if (!area->handler()->isGood()) {
+      mAreas->destruct(area);
+      continue;
+    }
+    // touch the whole file once, so the links find it in the page cache.
+    area->mapWholeFile();
+    area->prefetch();
+  }
+}
+
+int LinkBatch::start(const Job& pJob, const char* pProgram,
+                     LinkFunction pLink) {
+  pid_t pid = ::fork();
+  if (0 != pid) {
+    return pid;
+  }
+
+  std::vector<char*> argv;
+  argv.push_back(const_cast<char*>(pProgram));
+  for (size_t i = 0; i < pJob.args.size(); ++i) {
+    argv.push_back(const_cast<char*>(pJob.args[i].c_str()));
+  }
+  argv.push_back(NULL);
+  // exit() flushes the streams of the link.
+  ::exit(pLink(argv.size() - 1, &argv[0], mAreas));
+}
+
+int LinkBatch::run(const char* pProgram, LinkFunction pLink) {
+  preload();
+
+  // the line of the running link of every process
+  std::map<pid_t, unsigned> running;
+  unsigned num_of_failures = 0;
+  size_t next = 0;
+  while (next < mJobs.size() || !running.empty()) {
+    if (next < mJobs.size() && running.size() < mNumOfJobs) {
+      pid_t pid = start(mJobs[next], pProgram, pLink);
+      if (-1 == pid) {
+        llvm::errs() << "Cannot start the link of line " << mJobs[next].line
+                     << "!\n";
+        ++num_of_failures;
+      } else {
+        running[pid] = mJobs[next].line;
+      }
+      ++next;
+      continue;
+    }
+
+    int result = 0;
+    pid_t pid = ::waitpid(-1, &result, 0);
+    if (-1 == pid) {
+      if (EINTR == errno) {
+        continue;
+      }
+      break;
+    }
+
+    std::map<pid_t, unsigned>::iterator entry = running.find(pid);
+    if (running.end() == entry) {
+      continue;
+    }
+    if (!WIFEXITED(result) || EXIT_SUCCESS != WEXITSTATUS(result)) {
+      llvm::errs() << "The link of line " << entry->second << " failed!\n";
+      ++num_of_failures;
+    }
+    running.erase(entry);
+  }
+
+  return (0 == num_of_failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,433 @@
+//===- LinkServer.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "alone/Support/LinkServer.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryAreaFactory.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/PathCache.h>
+
+using namespace alone;
+
+namespace {
+
+// A request is a byte carrying the standard output and error of the client,
+// the size of the body in uint32_t, and the body: the working directory and
+// the arguments, each terminated by '\0'. The response is the exit status of
+// the link in int32_t. Both ends are on the same host, so the integers are
+// in the byte order of the host.
+const uint32_t kMaxRequestSize = 64 * 1024 * 1024;
+
+bool ReadAll(int pFD, void* pBuffer, size_t pSize) {
+  char* buffer = static_cast<char*>(pBuffer);
+  while (pSize > 0) {
+    ssize_t result = ::read(pFD, buffer, pSize);
+    if (result < 0 && EINTR == errno) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    buffer += result;
+    pSize -= result;
+  }
+  return true;
+}
+
+bool WriteAll(int pFD, const void* pBuffer, size_t pSize) {
+  const char* buffer = static_cast<const char*>(pBuffer);
+  while (pSize > 0) {
+    ssize_t result = ::write(pFD, buffer, pSize);
+    if (result < 0 && EINTR == errno) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    buffer += result;
+    pSize -= result;
+  }
+  return true;
+}
+
+bool SendFDs(int pSocket, const int pFDs[2]) {
+  char byte = 0;
+  struct iovec iov;
+  iov.iov_base = &byte;
+  iov.iov_len = 1;
+
+  char control[CMSG_SPACE(2 * sizeof(int))];
+  memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+  memcpy(CMSG_DATA(cmsg), pFDs, 2 * sizeof(int));
+
+  return (1 == ::sendmsg(pSocket, &msg, 0));
+}
+
+bool ReceiveFDs(int pSocket, int pFDs[2]) {
+  char byte = 0;
+  struct iovec iov;
+  iov.iov_base = &byte;
+  iov.iov_len = 1;
+
+  char control[CMSG_SPACE(2 * sizeof(int))];
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  if (1 != ::recvmsg(pSocket, &msg, 0)) {
+    return false;
+  }
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (NULL == cmsg ||
+      SOL_SOCKET != cmsg->cmsg_level ||
+      SCM_RIGHTS != cmsg->cmsg_type ||
+      CMSG_LEN(2 * sizeof(int)) != cmsg->cmsg_len) {
+    return false;
+  }
+  memcpy(pFDs, CMSG_DATA(cmsg), 2 * sizeof(int));
+  return true;
+}
+
+// The links run in the directories of the clients, so a relative path of
+// the server may name another file there.
+std::string MakeAbsolute(const std::string& pPath) {
+  if (!pPath.empty() && '/' == pPath[0]) {
+    return pPath;
+  }
+  char cwd[PATH_MAX];
+  if (NULL == ::getcwd(cwd, sizeof(cwd))) {
+    return std::string();
+  }
+  std::string result(cwd);
+  result.push_back('/');
+  result.append(pPath);
+  return result;
+}
+
+// A link runs as the user of the server, so only that user may submit one.
+bool IsSameUser(int pConnection) {
+#if defined(SO_PEERCRED)
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+  if (0 != ::getsockopt(pConnection, SOL_SOCKET, SO_PEERCRED, &cred, &len) ||
+      sizeof(cred) != len) {
+    return false;
+  }
+  return (::geteuid() == cred.uid);
+#else
+  uid_t uid;
+  gid_t gid;
+  if (0 != ::getpeereid(pConnection, &uid, &gid)) {
+    return false;
+  }
+  return (::geteuid() == uid);
+#endif
+}
+
+bool SetAddress(const std::string& pPath, struct sockaddr_un& pAddr) {
+  memset(&pAddr, 0, sizeof(pAddr));
+  pAddr.sun_family = AF_UNIX;
+  if (pPath.empty() || pPath.size() >= sizeof(pAddr.sun_path)) {
+    return false;
+  }
+  memcpy(pAddr.sun_path, pPath.c_str(), pPath.size() + 1);
+  return true;
+}
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LinkServer
+//===----------------------------------------------------------------------===//
+LinkServer::LinkServer(const std::string& pSocketPath)
+  : mSocketPath(pSocketPath), mAreas(new mcld::MemoryAreaFactory(32)),
+    mSocket(-1) {
+}
+
+LinkServer::~LinkServer() {
+  if (-1 != mSocket) {
+    ::close(mSocket);
+    ::unlink(mSocketPath.c_str());
+  }
+  delete mAreas;
+}
+
+bool LinkServer::preload(const std::string& pPath) {
+  std::string path = MakeAbsolute(pPath);
+  if (path.empty()) {
+    return false;
+  }
+
+  PreloadList::iterator it, itEnd = mPreloads.end();
+  for (it = mPreloads.begin(); it != itEnd; ++it) {
+    if (it->path == path) {
+      return true;
+    }
+  }
+
+  Preload preload;
+  preload.path = path;
+  preload.area = NULL;
+  if (!load(preload)) {
+    return false;
+  }
+  mPreloads.push_back(preload);
+  return true;
+}
+
+bool LinkServer::load(Preload& pPreload) {
+  mcld::sys::fs::Path path(pPreload.path);
+  mcld::sys::fs::detail::file_id(path, pPreload.id);
+  if (!pPreload.id.isValid()) {
+    return false;
+  }
+
+  pPreload.area = mAreas->produce(path, mcld::FileHandle::ReadOnly);
+  if (!pPreload.area->handler()->isGood()) {
+    mAreas->destruct(pPreload.area);
+    pPreload.area = NULL;
+    return false;
+  }
+
+  // touch the whole file once, so the links find it in the page cache.
+  pPreload.area->mapWholeFile();
+  pPreload.area->prefetch();
+  return true;
+}
+
+void LinkServer::refresh() {
+  // the files may have changed since the last link.
+  mcld::sys::fs::cached::clear();
+
+  PreloadList::iterator it = mPreloads.begin();
+  while (it != mPreloads.end()) {
+    mcld::sys::fs::FileID id;
+    mcld::sys::fs::detail::file_id(mcld::sys::fs::Path(it->path), id);
+    if (id == it->id) {
+      ++it;
+      continue;
+    }
+
+    // the file is replaced or removed since it was loaded.
+    mAreas->destruct(it->area);
+    it->area = NULL;
+    if (load(*it)) {
+      ++it;
+    } else {
+      it = mPreloads.erase(it);
+    }
+  }
+}
+
+int LinkServer::run(LinkFunction pLink) {
+  struct sockaddr_un addr;
+  if (!SetAddress(mSocketPath, addr)) {
+    llvm::errs() << "Invalid socket path `" << mSocketPath << "'!\n";
+    return EXIT_FAILURE;
+  }
+
+  mSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (-1 == mSocket) {
+    llvm::errs() << "Cannot create the socket! (detail: "
+                 << strerror(errno) << ")\n";
+    return EXIT_FAILURE;
+  }
+
+  // a socket file left by a dead server refuses to bind. The socket file is
+  // created for the user of the server only.
+  ::unlink(mSocketPath.c_str());
+  mode_t mask = ::umask(0177);
+  int bound = ::bind(mSocket, reinterpret_cast<struct sockaddr*>(&addr),
+                     sizeof(addr));
+  ::umask(mask);
+  if (0 != bound ||
+      0 != ::chmod(mSocketPath.c_str(), 0600) ||
+      0 != ::listen(mSocket, SOMAXCONN)) {
+    llvm::errs() << "Cannot listen on `" << mSocketPath << "'! (detail: "
+                 << strerror(errno) << ")\n";
+    return EXIT_FAILURE;
+  }
+
+  // the serving processes are reaped by the system.
+  ::signal(SIGCHLD, SIG_IGN);
+
+  while (true) {
+    int connection = ::accept(mSocket, NULL, NULL);
+    if (-1 == connection) {
+      if (EINTR == errno || ECONNABORTED == errno) {
+        continue;
+      }
+      llvm::errs() << "Cannot accept the connection! (detail: "
+                   << strerror(errno) << ")\n";
+      return EXIT_FAILURE;
+    }
+
+    if (!IsSameUser(connection)) {
+      ::close(connection);
+      continue;
+    }
+
+    refresh();
+
+    pid_t pid = ::fork();
+    if (0 == pid) {
+      ::close(mSocket);
+      ::signal(SIGCHLD, SIG_DFL);
+      serve(connection, pLink);
+      ::_exit(EXIT_SUCCESS);
+    }
+    ::close(connection);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+void LinkServer::serve(int pConnection, LinkFunction pLink) {
+  int fds[2];
+  if (!ReceiveFDs(pConnection, fds)) {
+    return;
+  }
+
+  uint32_t size = 0;
+  std::vector<char> body;
+  if (!ReadAll(pConnection, &size, sizeof(size)) ||
+      0 == size || size > kMaxRequestSize) {
+    return;
+  }
+  body.resize(size);
+  if (!ReadAll(pConnection, &body[0], size) || '\0' != body[size - 1]) {
+    return;
+  }
+
+  // the working directory, and then the arguments
+  std::vector<char*> args;
+  const char* cwd = &body[0];
+  size_t pos = strlen(cwd) + 1;
+  while (pos < size) {
+    args.push_back(&body[pos]);
+    pos += strlen(&body[pos]) + 1;
+  }
+  if (args.empty()) {
+    return;
+  }
+  args.push_back(NULL);
+
+  int32_t status = EXIT_FAILURE;
+  pid_t pid = ::fork();
+  if (0 == pid) {
+    ::close(pConnection);
+    if (-1 == ::dup2(fds[0], STDOUT_FILENO) ||
+        -1 == ::dup2(fds[1], STDERR_FILENO) ||
+        0 != ::chdir(cwd)) {
+      ::_exit(EXIT_FAILURE);
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+    // the relative paths known by the server are of its own directory.
+    mcld::sys::fs::cached::clear();
+    // exit() flushes the streams of the link.
+    ::exit(pLink(args.size() - 1, &args[0], mAreas));
+  }
+
+  if (-1 != pid) {
+    int result = 0;
+    while (-1 == ::waitpid(pid, &result, 0) && EINTR == errno) {
+    }
+    if (WIFEXITED(result)) {
+      status = WEXITSTATUS(result);
+    } else if (WIFSIGNALED(result)) {
+      status = 128 + WTERMSIG(result);
+    }
+  }
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+  WriteAll(pConnection, &status, sizeof(status));
+  ::close(pConnection);
+}
+
+int LinkServer::Submit(const std::string& pSocketPath,
+                       int pArgc, char** pArgv) {
+  struct sockaddr_un addr;
+  if (!SetAddress(pSocketPath, addr)) {
+    return -1;
+  }
+
+  char cwd[PATH_MAX];
+  if (NULL == ::getcwd(cwd, sizeof(cwd))) {
+    return -1;
+  }
+
+  std::string body(cwd);
+  body.push_back('\0');
+  for (int i = 0; i < pArgc; ++i) {
+    body.append(pArgv[i]);
+    body.push_back('\0');
+  }
+  if (body.size() > kMaxRequestSize) {
+    return -1;
+  }
+
+  int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (-1 == connection) {
+    return -1;
+  }
+
+  if (0 != ::connect(connection, reinterpret_cast<struct sockaddr*>(&addr),
+                     sizeof(addr))) {
+    ::close(connection);
+    return -1;
+  }
+
+  const int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+  uint32_t size = body.size();
+  int32_t status = -1;
+  if (!SendFDs(connection, fds) ||
+      !WriteAll(connection, &size, sizeof(size)) ||
+      !WriteAll(connection, body.data(), body.size()) ||
+      !ReadAll(connection, &status, sizeof(status))) {
+    status = -1;
+  }
+  ::close(connection);
+  return status;
+}
@@ -157,6 +157,11 @@ void LinkerConfig::setBsymbolic(bool pEnable) {
   return;
 }
 
+void LinkerConfig::setBsymbolicFunctions(bool pEnable) {
+  mLDConfig->options().setBsymbolicFunctions(pEnable);
+  return;
+}
+
 void LinkerConfig::setDefineCommon(bool pEnable) {
   mLDConfig->options().setDefineCommon(pEnable);
   return;
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <stdlib.h>
+#include <string.h>
 #include <string>
 
 #include <llvm/ADT/SmallString.h>
@@ -22,6 +23,8 @@
 #include <alone/Config/Config.h>
 #include <alone/Support/LinkerConfig.h>
 #include <alone/Support/Initialization.h>
+#include <alone/Support/LinkBatch.h>
+#include <alone/Support/LinkServer.h>
 #include <alone/Support/TargetLinkerConfigs.h>
 #include <alone/Linker.h>
 
@@ -92,6 +95,11 @@ OptBsymbolic("Bsymbolic",
              llvm::cl::desc("Bind references within the shared library."),
              llvm::cl::init(true));
 
+static llvm::cl::opt<bool>
+OptBsymbolicFunctions("Bsymbolic-functions",
+  llvm::cl::desc("Bind references to functions within the shared library."),
+  llvm::cl::init(false));
+
 static llvm::cl::opt<std::string>
 OptDyld("dynamic-linker",
         llvm::cl::desc("Set the name of the dynamic linker."),
@@ -203,7 +211,8 @@ std::string DetermineOutputFilename(const std::string &pOutputPath) {
 }
 
 static inline
-bool ConfigLinker(Linker &pLinker, const std::string &pOutputFilename) {
+bool ConfigLinker(Linker &pLinker, const std::string &pOutputFilename,
+                  mcld::MemoryAreaFactory *pAreas) {
   LinkerConfig* config = NULL;
 
 #ifdef TARGET_BUILD
@@ -256,13 +265,14 @@ bool ConfigLinker(Linker &pLinker, const std::string &pOutputFilename) {
   // 7. Set up output's type.
   config->setShared(OptShared);
 
-  // 8. Set up -Bsymbolic.
+  // 8. Set up -Bsymbolic and -Bsymbolic-functions.
   config->setBsymbolic(OptBsymbolic);
+  config->setBsymbolicFunctions(OptBsymbolicFunctions);
 
   // 9. Set up -d (define common symbols)
   config->setDefineCommon(OptDefineCommon);
 
-  Linker::ErrorCode result = pLinker.config(*config);
+  Linker::ErrorCode result = pLinker.config(*config, pAreas);
   if (Linker::kSuccess != result) {
     llvm::errs() << "Failed to configure the linker! (detail: "
                  << Linker::GetErrorString(result) << ")\n";
@@ -344,7 +354,9 @@ static inline bool LinkFiles(Linker &pLinker) {
   return true;
 }
 
-int main(int argc, char** argv) {
+/// Link - link by the command line. The input files are read through pAreas
+/// if it is given.
+static int Link(int argc, char** argv, mcld::MemoryAreaFactory* pAreas) {
   llvm::cl::SetVersionPrinter(MCLDVersionPrinter);
   llvm::cl::ParseCommandLineOptions(argc, argv);
   init::Initialize();
@@ -355,7 +367,7 @@ int main(int argc, char** argv) {
   }
 
   Linker linker;
-  if (!ConfigLinker(linker, OutputFilename)) {
+  if (!ConfigLinker(linker, OutputFilename, pAreas)) {
     return EXIT_FAILURE;
   }
 
@@ -370,3 +382,68 @@ int main(int argc, char** argv) {
   return EXIT_SUCCESS;
 }
 
+/// Serve - run the link server on pSocketPath, preloading the files of
+/// pArgv. The command line options are never parsed by the server, so every
+/// forked link parses its own command line from scratch.
+static int Serve(const char* pSocketPath, int pArgc, char** pArgv) {
+  init::Initialize();
+
+  LinkServer server(pSocketPath);
+  for (int i = 0; i < pArgc; ++i) {
+    if (!server.preload(pArgv[i])) {
+      llvm::errs() << "Cannot preload `" << pArgv[i] << "'!\n";
+    }
+  }
+  return server.run(Link);
+}
+
+/// Batch - run the links of the manifest at pManifest, pNumOfJobs at a
+/// time. The files shared by the links are loaded once.
+static int Batch(const char* pProgram, const char* pManifest,
+                 unsigned pNumOfJobs) {
+  init::Initialize();
+
+  LinkBatch batch(pNumOfJobs);
+  if (!batch.read(pManifest)) {
+    return EXIT_FAILURE;
+  }
+  return batch.run(pProgram, Link);
+}
+
+#define SERVER_OPTION "--server="
+#define CONNECT_OPTION "--connect="
+#define BATCH_OPTION "--batch="
+#define JOBS_OPTION "-j"
+
+int main(int argc, char** argv) {
+  // mcld --server=<socket> [files to preload...]
+  if (argc > 1 &&
+      0 == strncmp(argv[1], SERVER_OPTION, strlen(SERVER_OPTION))) {
+    return Serve(argv[1] + strlen(SERVER_OPTION), argc - 2, argv + 2);
+  }
+
+  // mcld --batch=<manifest> [-j<jobs>]
+  if (argc > 1 &&
+      0 == strncmp(argv[1], BATCH_OPTION, strlen(BATCH_OPTION))) {
+    unsigned jobs = 0;
+    if (argc > 2 && 0 == strncmp(argv[2], JOBS_OPTION, strlen(JOBS_OPTION))) {
+      jobs = atoi(argv[2] + strlen(JOBS_OPTION));
+    }
+    return Batch(argv[0], argv[1] + strlen(BATCH_OPTION), jobs);
+  }
+
+  // mcld --connect=<socket> [options] [inputs]
+  // If the server is not reachable, link in this process.
+  if (argc > 1 &&
+      0 == strncmp(argv[1], CONNECT_OPTION, strlen(CONNECT_OPTION))) {
+    const char* socket_path = argv[1] + strlen(CONNECT_OPTION);
+    argv[1] = argv[0];
+    int status = LinkServer::Submit(socket_path, argc - 1, argv + 1);
+    if (-1 != status) {
+      return status;
+    }
+    return Link(argc - 1, argv + 1, NULL);
+  }
+
+  return Link(argc, argv, NULL);
+}
@@ -0,0 +1,261 @@
+//===- ARMLDBackendTest.cpp -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <../lib/Target/ARM/ARMLDBackend.h>
+#include "ARMLDBackendTest.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// the address of the .ARM.exidx of the testcases
+const uint64_t EXIDXAddr = 0x8000;
+
+/// the end of the code, where the sentinel refers to
+const uint64_t CodeEnd = 0x4000;
+
+void Write32(uint8_t* pData, uint32_t pValue)
+{
+  pData[0] = pValue & 0xff;
+  pData[1] = (pValue >> 8) & 0xff;
+  pData[2] = (pValue >> 16) & 0xff;
+  pData[3] = (pValue >> 24) & 0xff;
+}
+
+uint32_t Read32(const uint8_t* pData)
+{
+  return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) |
+         ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+}
+
+uint32_t EncodePrel31(uint64_t pPlace, uint64_t pAddr)
+{
+  return (uint32_t)(pAddr - pPlace) & 0x7fffffff;
+}
+
+uint64_t DecodePrel31(uint64_t pPlace, uint32_t pWord)
+{
+  int32_t offset = (int32_t)(pWord << 1) >> 1;
+  return (uint32_t)(pPlace + offset);
+}
+
+/// SetEntry - write the entry pIdx of the table pData for the function at
+/// pFunc. The second word is the PREL31 of pTab if pTab is not zero, or
+/// pData otherwise.
+void SetEntry(std::vector<uint8_t>& pData, size_t pIdx, uint64_t pFunc,
+              uint32_t pWord, uint64_t pTab = 0x0)
+{
+  uint64_t place = EXIDXAddr + pIdx * ARMGNULDBackend::EXIDXEntrySize;
+  uint8_t* entry = &pData[pIdx * ARMGNULDBackend::EXIDXEntrySize];
+  Write32(entry, EncodePrel31(place, pFunc));
+  Write32(entry + 4, (0x0 != pTab) ? EncodePrel31(place + 4, pTab) : pWord);
+}
+
+/// Func - the address of the function of the entry pIdx
+uint64_t Func(const std::vector<uint8_t>& pData, size_t pIdx)
+{
+  uint64_t place = EXIDXAddr + pIdx * ARMGNULDBackend::EXIDXEntrySize;
+  return DecodePrel31(place,
+                      Read32(&pData[pIdx * ARMGNULDBackend::EXIDXEntrySize]));
+}
+
+/// Word - the second word of the entry pIdx
+uint32_t Word(const std::vector<uint8_t>& pData, size_t pIdx)
+{
+  return Read32(&pData[pIdx * ARMGNULDBackend::EXIDXEntrySize + 4]);
+}
+
+/// Tab - the address of the .ARM.extab entry of the entry pIdx
+uint64_t Tab(const std::vector<uint8_t>& pData, size_t pIdx)
+{
+  uint64_t place = EXIDXAddr + pIdx * ARMGNULDBackend::EXIDXEntrySize + 4;
+  return DecodePrel31(place, Word(pData, pIdx));
+}
+
+/// Append32 - append a little-endian word to pData
+void Append32(std::vector<uint8_t>& pData, uint32_t pValue)
+{
+  uint8_t word[4];
+  Write32(word, pValue);
+  pData.insert(pData.end(), word, word + 4);
+}
+
+/// Attributes - the .ARM.attributes with a Tag_File sub-subsection of pAttrs
+/// in the subsection of pVendor
+std::vector<uint8_t> Attributes(const char* pVendor,
+                                const std::vector<uint8_t>& pAttrs)
+{
+  // Tag_File, and the size which counts the tag and itself
+  std::vector<uint8_t> file(1, 0x1);
+  Append32(file, 5 + pAttrs.size());
+  file.insert(file.end(), pAttrs.begin(), pAttrs.end());
+
+  // format-version 'A', the size of the subsection which counts itself, and
+  // the vendor name
+  size_t vendor_size = strlen(pVendor) + 1;
+  std::vector<uint8_t> data(1, 'A');
+  Append32(data, 4 + vendor_size + file.size());
+  data.insert(data.end(), pVendor, pVendor + vendor_size);
+  data.insert(data.end(), file.begin(), file.end());
+  return data;
+}
+
+/// Bytes - the vector of pSize bytes at pData
+std::vector<uint8_t> Bytes(const char* pData, size_t pSize)
+{
+  return std::vector<uint8_t>(pData, pData + pSize);
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+ARMLDBackendTest::ARMLDBackendTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ARMLDBackendTest::~ARMLDBackendTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void ARMLDBackendTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ARMLDBackendTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ARMLDBackendTest, sort_exidx) {
+  // three entries out of order, and the reserved sentinel slot
+  std::vector<uint8_t> data(4 * ARMGNULDBackend::EXIDXEntrySize, 0x0);
+  SetEntry(data, 0, 0x3000, 0x80b0b0b0);
+  SetEntry(data, 1, 0x1000, 0x0, 0x9000);
+  SetEntry(data, 2, 0x2000, 0x1);
+
+  ARMGNULDBackend::SortEXIDX(&data[0], data.size(), EXIDXAddr, CodeEnd);
+
+  // the PREL31 words are encoded again for the new places
+  ASSERT_EQ(0x1000u, Func(data, 0));
+  ASSERT_EQ(0x9000u, Tab(data, 0));
+  ASSERT_EQ(0x2000u, Func(data, 1));
+  ASSERT_EQ(0x1u, Word(data, 1));
+  ASSERT_EQ(0x3000u, Func(data, 2));
+  ASSERT_EQ(0x80b0b0b0u, Word(data, 2));
+  ASSERT_EQ(CodeEnd, Func(data, 3));
+  ASSERT_EQ(0x1u, Word(data, 3));
+}
+
+TEST_F( ARMLDBackendTest, sort_exidx_backward) {
+  // the functions before the table are referred by negative offsets
+  std::vector<uint8_t> data(3 * ARMGNULDBackend::EXIDXEntrySize, 0x0);
+  SetEntry(data, 0, 0xa000, 0x1);
+  SetEntry(data, 1, 0x100, 0x0, 0xb000);
+
+  ARMGNULDBackend::SortEXIDX(&data[0], data.size(), EXIDXAddr, CodeEnd);
+
+  ASSERT_EQ(0x100u, Func(data, 0));
+  ASSERT_EQ(0xb000u, Tab(data, 0));
+  ASSERT_EQ(0xa000u, Func(data, 1));
+  ASSERT_EQ(0x1u, Word(data, 1));
+}
+
+TEST_F( ARMLDBackendTest, sort_exidx_merge) {
+  // the adjacent entries with the same unwinding instructions are merged,
+  // and the freed slots are filled with the sentinel
+  std::vector<uint8_t> data(6 * ARMGNULDBackend::EXIDXEntrySize, 0x0);
+  SetEntry(data, 0, 0x2000, 0x1);
+  SetEntry(data, 1, 0x1000, 0x1);
+  SetEntry(data, 2, 0x3000, 0x0, 0x9000);
+  SetEntry(data, 3, 0x3800, 0x0, 0x9000);
+  SetEntry(data, 4, 0x3c00, 0x80b0b0b0);
+
+  ARMGNULDBackend::SortEXIDX(&data[0], data.size(), EXIDXAddr, CodeEnd);
+
+  ASSERT_EQ(0x1000u, Func(data, 0));
+  ASSERT_EQ(0x1u, Word(data, 0));
+  ASSERT_EQ(0x3000u, Func(data, 1));
+  ASSERT_EQ(0x9000u, Tab(data, 1));
+  ASSERT_EQ(0x3c00u, Func(data, 2));
+  ASSERT_EQ(0x80b0b0b0u, Word(data, 2));
+  for (size_t i = 3; i < 6; ++i) {
+    ASSERT_EQ(CodeEnd, Func(data, i));
+    ASSERT_EQ(0x1u, Word(data, i));
+  }
+}
+
+TEST_F( ARMLDBackendTest, sort_exidx_sentinel_only) {
+  // a table with only the reserved slot is left as it is
+  std::vector<uint8_t> data(ARMGNULDBackend::EXIDXEntrySize, 0xff);
+  ARMGNULDBackend::SortEXIDX(&data[0], data.size(), EXIDXAddr, CodeEnd);
+  for (size_t i = 0; i < data.size(); ++i)
+    ASSERT_EQ(0xffu, data[i]);
+}
+
+
+TEST_F( ARMLDBackendTest, read_cpu_arch) {
+  // Tag_CPU_name "ARM7TDMI", Tag_compatibility 1 "gnu", Tag_ARM_ISA_use 1,
+  // and then Tag_CPU_arch ARMv4T
+  const char attrs[] = "\x05" "ARM7TDMI\0" "\x20\x01" "gnu\0" "\x08\x01"
+                       "\x06\x02";
+  std::vector<uint8_t> data =
+    Attributes("aeabi", Bytes(attrs, sizeof(attrs) - 1));
+  ASSERT_EQ(2, ARMGNULDBackend::ReadCPUArch(&data[0], data.size()));
+}
+
+TEST_F( ARMLDBackendTest, read_cpu_arch_other_vendor) {
+  // the subsections of the other vendors are skipped
+  const char attrs[] = "\x06\x0a";
+  std::vector<uint8_t> data =
+    Attributes("gnu", Bytes(attrs, sizeof(attrs) - 1));
+  ASSERT_EQ(-1, ARMGNULDBackend::ReadCPUArch(&data[0], data.size()));
+
+  std::vector<uint8_t> aeabi =
+    Attributes("aeabi", Bytes(attrs, sizeof(attrs) - 1));
+  data.insert(data.end(), aeabi.begin() + 1, aeabi.end());
+  ASSERT_EQ(10, ARMGNULDBackend::ReadCPUArch(&data[0], data.size()));
+}
+
+TEST_F( ARMLDBackendTest, read_cpu_arch_missing) {
+  // no Tag_CPU_arch in the attributes of the file
+  const char attrs[] = "\x08\x01\x09\x02";
+  std::vector<uint8_t> data =
+    Attributes("aeabi", Bytes(attrs, sizeof(attrs) - 1));
+  ASSERT_EQ(-1, ARMGNULDBackend::ReadCPUArch(&data[0], data.size()));
+}
+
+TEST_F( ARMLDBackendTest, read_cpu_arch_malformed) {
+  const char attrs[] = "\x06\x0a";
+  std::vector<uint8_t> data =
+    Attributes("aeabi", Bytes(attrs, sizeof(attrs) - 1));
+
+  // an unknown format-version
+  std::vector<uint8_t> version = data;
+  version[0] = 'B';
+  ASSERT_EQ(-1, ARMGNULDBackend::ReadCPUArch(&version[0], version.size()));
+
+  // the subsection is larger than the section
+  ASSERT_EQ(-1, ARMGNULDBackend::ReadCPUArch(&data[0], data.size() - 1));
+
+  // the value of Tag_CPU_arch runs off the end
+  std::vector<uint8_t> uleb = data;
+  uleb.back() = 0x8a;
+  ASSERT_EQ(-1, ARMGNULDBackend::ReadCPUArch(&uleb[0], uleb.size()));
+
+  // an empty section
+  ASSERT_EQ(-1, ARMGNULDBackend::ReadCPUArch(&data[0], 0));
+}
@@ -0,0 +1,190 @@
+//===- ArchiveIndexCacheTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LinkerConfig.h>
+#include <mcld/LD/Archive.h>
+#include <mcld/LD/ArchiveIndexCache.h>
+#include <mcld/MC/InputBuilder.h>
+#include <mcld/MC/InputFactory.h>
+#include <mcld/Support/Path.h>
+#include "ArchiveIndexCacheTest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// Image - an index image copied into 8-byte aligned memory, as a mapped
+/// cache file is
+class Image
+{
+public:
+  explicit Image(const std::string& pData)
+    : m_Size(pData.size()), m_Words((pData.size() + 7) / 8, 0x0) {
+    memcpy(&m_Words[0], pData.data(), pData.size());
+  }
+
+  void* data() { return &m_Words[0]; }
+
+  size_t size() const { return m_Size; }
+
+private:
+  size_t m_Size;
+  std::vector<uint64_t> m_Words;
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+ArchiveIndexCacheTest::ArchiveIndexCacheTest()
+  : m_MemFactory(10), m_ContextFactory(4) {
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pAlloc  = new InputFactory(10, *m_pConfig);
+  m_pBuilder = new InputBuilder(*m_pConfig,
+                                *m_pAlloc,
+                                m_ContextFactory,
+                                m_MemFactory,
+                                false);
+  m_pArchive = NULL;
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ArchiveIndexCacheTest::~ArchiveIndexCacheTest()
+{
+  delete m_pAlloc;
+  delete m_pBuilder;
+  delete m_pConfig;
+}
+
+// SetUp() will be called immediately before each test.
+void ArchiveIndexCacheTest::SetUp()
+{
+  Input* input = m_pAlloc->produce("libtest.a", sys::fs::Path("libtest.a"),
+                                   Input::Archive);
+  m_pArchive = new Archive(*input, *m_pBuilder);
+}
+
+// TearDown() will be called immediately after each test.
+void ArchiveIndexCacheTest::TearDown()
+{
+  delete m_pArchive;
+  m_pArchive = NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ArchiveIndexCacheTest, round_trip) {
+  m_pArchive->addSymbol("foo", 0x100);
+  m_pArchive->addSymbol("bar", 0x200);
+  m_pArchive->addSymbol("foo", 0x300);
+  m_pArchive->setSymTabSize(0x40);
+  m_pArchive->getStrTable() = "a_long_member_name.o/\n";
+
+  std::string data;
+  ArchiveIndex::emit(*m_pArchive, "/lib/libtest.a", 0x1234, 42, data);
+  Image image(data);
+
+  ArchiveIndex index;
+  ASSERT_TRUE(index.map(image.data(), image.size()));
+  ASSERT_EQ(3u, index.numOfSymbols());
+  ASSERT_EQ(0x40u, index.getSymTabSize());
+  ASSERT_TRUE("a_long_member_name.o/\n" == index.getStrTable());
+  ASSERT_TRUE("/lib/libtest.a" == index.getPath());
+  ASSERT_EQ(0x1234u, index.getFileSize());
+  ASSERT_EQ(42u, index.getModTime());
+
+  ASSERT_TRUE("foo" == index.getSymbolName(0));
+  ASSERT_TRUE("bar" == index.getSymbolName(1));
+  ASSERT_TRUE("foo" == index.getSymbolName(2));
+  ASSERT_EQ(0x100u, index.getObjFileOffset(0));
+  ASSERT_EQ(0x200u, index.getObjFileOffset(1));
+  ASSERT_EQ(0x300u, index.getObjFileOffset(2));
+
+  // only the first symbol of a name is found
+  size_t idx = 0;
+  ASSERT_TRUE(index.findSymbol("foo", idx));
+  ASSERT_EQ(0u, idx);
+  ASSERT_TRUE(index.findSymbol("bar", idx));
+  ASSERT_EQ(1u, idx);
+  ASSERT_FALSE(index.findSymbol("baz", idx));
+}
+
+TEST_F( ArchiveIndexCacheTest, empty_archive) {
+  std::string data;
+  ArchiveIndex::emit(*m_pArchive, "libtest.a", 8, 0, data);
+  Image image(data);
+
+  ArchiveIndex index;
+  ASSERT_TRUE(index.map(image.data(), image.size()));
+  ASSERT_EQ(0u, index.numOfSymbols());
+  size_t idx = 0;
+  ASSERT_FALSE(index.findSymbol("foo", idx));
+}
+
+TEST_F( ArchiveIndexCacheTest, reject_malformed) {
+  m_pArchive->addSymbol("foo", 0x100);
+  m_pArchive->addSymbol("bar", 0x200);
+
+  std::string data;
+  ArchiveIndex::emit(*m_pArchive, "libtest.a", 8, 0, data);
+
+  ArchiveIndex index;
+  // too short for the header
+  Image header(data.substr(0, sizeof(ArchiveIndex::Header) - 1));
+  ASSERT_FALSE(index.map(header.data(), header.size()));
+
+  // the names are cut, so the image does not end with a NUL
+  Image truncated(data.substr(0, data.size() - 2));
+  ASSERT_FALSE(index.map(truncated.data(), truncated.size()));
+
+  // another magic, such as the one of an older format
+  std::string magic(data);
+  magic[7] = '0';
+  Image old(magic);
+  ASSERT_FALSE(index.map(old.data(), old.size()));
+
+  // a bucket refers to a symbol out of range
+  std::string bucket(data);
+  size_t buckets = (sizeof(ArchiveIndex::Header) + strlen("libtest.a") + 7) /
+                   8 * 8 + 2 * sizeof(ArchiveIndex::Entry);
+  uint32_t bad = 3;
+  memcpy(&bucket[buckets], &bad, sizeof(bad));
+  Image corrupt(bucket);
+  ASSERT_FALSE(index.map(corrupt.data(), corrupt.size()));
+
+  Image good(data);
+  ASSERT_TRUE(index.map(good.data(), good.size()));
+}
+
+TEST_F( ArchiveIndexCacheTest, archive_uses_index) {
+  m_pArchive->addSymbol("foo", 0x100);
+  m_pArchive->addSymbol("bar", 0x200);
+  m_pArchive->getStrTable() = "a_long_member_name.o/\n";
+
+  std::string data;
+  ArchiveIndex::emit(*m_pArchive, "libtest.a", 8, 0, data);
+  Image image(data);
+  ArchiveIndex index;
+  ASSERT_TRUE(index.map(image.data(), image.size()));
+
+  // an archive whose armap is not read looks its symbols up in the index
+  Archive cached(m_pArchive->getARFile(), *m_pBuilder);
+  cached.setIndex(index);
+  ASSERT_TRUE(cached.hasIndex());
+  ASSERT_EQ(2u, cached.numOfSymbols());
+  ASSERT_EQ(1u, cached.findSymbol("bar"));
+  ASSERT_EQ(0x200u, cached.getObjFileOffset(1));
+  ASSERT_TRUE(Archive::kNoSymbol == cached.findSymbol("baz"));
+  ASSERT_TRUE(m_pArchive->getStrTable() == cached.getStrTable());
+}
+
@@ -0,0 +1,53 @@
+//===- ArchiveIndexCacheTest.h --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_ARCHIVE_INDEX_CACHE_TEST_H
+#define MCLD_UNITTEST_ARCHIVE_INDEX_CACHE_TEST_H
+
+#include <gtest.h>
+#include <mcld/MC/ContextFactory.h>
+#include <mcld/Support/MemoryAreaFactory.h>
+
+namespace mcld {
+
+class Archive;
+class InputFactory;
+class InputBuilder;
+class LinkerConfig;
+
+namespace test {
+
+class ArchiveIndexCacheTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  ArchiveIndexCacheTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~ArchiveIndexCacheTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::InputFactory* m_pAlloc;
+  mcld::InputBuilder* m_pBuilder;
+  mcld::MemoryAreaFactory m_MemFactory;
+  mcld::ContextFactory m_ContextFactory;
+  mcld::Archive* m_pArchive;
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,24 @@
+//===- BenchMain.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The *Bench.cpp files are micro-benchmarks of the data structures on the hot
+// paths of a link. They are built with google-benchmark into mcld-bench,
+// apart from the gtest unittests. LinkBench.cpp links the synthetic programs
+// of SyntheticInputs.cpp end to end, and RelocBench.cpp measures the
+// relocation phases of each backend against golden outputs. Run
+//
+//   mcld-bench --benchmark_filter=NamePool
+//
+// to measure a change before and after it.
+//
+//===----------------------------------------------------------------------===//
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
+
@@ -0,0 +1,113 @@
+//===- CallGraphOrderingTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/CallGraphOrdering.h>
+#include "CallGraphOrderingTest.h"
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+CallGraphOrderingTest::CallGraphOrderingTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+CallGraphOrderingTest::~CallGraphOrderingTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void CallGraphOrderingTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void CallGraphOrderingTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( CallGraphOrderingTest, sort_no_edges) {
+  // nothing is called, the input order is kept
+  std::vector<uint64_t> sizes(3, 16);
+  CallGraphOrdering::EdgeListTy edges;
+  std::vector<size_t> order;
+  CallGraphOrdering::Sort(sizes, edges, order);
+  ASSERT_EQ(3u, order.size());
+  ASSERT_EQ(0u, order[0]);
+  ASSERT_EQ(1u, order[1]);
+  ASSERT_EQ(2u, order[2]);
+}
+
+TEST_F( CallGraphOrderingTest, sort_chain) {
+  // 0 calls 2, and 2 calls 3. The callees follow their callers.
+  std::vector<uint64_t> sizes(4, 16);
+  CallGraphOrdering::EdgeListTy edges;
+  edges.push_back(CallGraphOrdering::Edge(0, 2, 10));
+  edges.push_back(CallGraphOrdering::Edge(2, 3, 5));
+  std::vector<size_t> order;
+  CallGraphOrdering::Sort(sizes, edges, order);
+  ASSERT_EQ(4u, order.size());
+  ASSERT_EQ(0u, order[0]);
+  ASSERT_EQ(2u, order[1]);
+  ASSERT_EQ(3u, order[2]);
+  ASSERT_EQ(1u, order[3]);
+}
+
+TEST_F( CallGraphOrderingTest, sort_heaviest_caller) {
+  // 2 is placed after 1, its heaviest caller
+  std::vector<uint64_t> sizes(3, 16);
+  CallGraphOrdering::EdgeListTy edges;
+  edges.push_back(CallGraphOrdering::Edge(0, 2, 1));
+  edges.push_back(CallGraphOrdering::Edge(1, 2, 7));
+  std::vector<size_t> order;
+  CallGraphOrdering::Sort(sizes, edges, order);
+  ASSERT_EQ(3u, order.size());
+  ASSERT_EQ(1u, order[0]);
+  ASSERT_EQ(2u, order[1]);
+  ASSERT_EQ(0u, order[2]);
+}
+
+TEST_F( CallGraphOrderingTest, sort_density) {
+  // the smaller cluster of the same weight is denser
+  std::vector<uint64_t> sizes;
+  sizes.push_back(100);
+  sizes.push_back(100);
+  sizes.push_back(10);
+  sizes.push_back(10);
+  CallGraphOrdering::EdgeListTy edges;
+  edges.push_back(CallGraphOrdering::Edge(0, 1, 1));
+  edges.push_back(CallGraphOrdering::Edge(2, 3, 1));
+  std::vector<size_t> order;
+  CallGraphOrdering::Sort(sizes, edges, order);
+  ASSERT_EQ(4u, order.size());
+  ASSERT_EQ(2u, order[0]);
+  ASSERT_EQ(3u, order[1]);
+  ASSERT_EQ(0u, order[2]);
+  ASSERT_EQ(1u, order[3]);
+}
+
+TEST_F( CallGraphOrderingTest, sort_cluster_size) {
+  // the clusters larger than MaxClusterSize are not merged
+  std::vector<uint64_t> sizes;
+  sizes.push_back(CallGraphOrdering::MaxClusterSize);
+  sizes.push_back(16);
+  CallGraphOrdering::EdgeListTy edges;
+  edges.push_back(CallGraphOrdering::Edge(0, 1, 1));
+  std::vector<size_t> order;
+  CallGraphOrdering::Sort(sizes, edges, order);
+  ASSERT_EQ(2u, order.size());
+  ASSERT_EQ(1u, order[0]);
+  ASSERT_EQ(0u, order[1]);
+}
+
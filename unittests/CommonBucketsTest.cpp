@@ -0,0 +1,120 @@
+//===- CommonBucketsTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/CommonBuckets.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include "CommonBucketsTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// helper_common - a common symbol of pSize bytes aligned to pAlign
+LDSymbol* helper_common(const char* pName, uint64_t pSize, uint64_t pAlign)
+{
+  ResolveInfo* info = ResolveInfo::Create(pName);
+  info->setDesc(ResolveInfo::Common);
+  info->setSize(pSize);
+  LDSymbol* sym = LDSymbol::Create(*info);
+  info->setSymPtr(sym);
+  sym->setValue(pAlign);
+  return sym;
+}
+
+/// helper_offset - the offset of pSymbol in its section data
+uint64_t helper_offset(const LDSymbol& pSymbol)
+{
+  return pSymbol.fragRef()->frag()->getOffset() + pSymbol.fragRef()->offset();
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+CommonBucketsTest::CommonBucketsTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+CommonBucketsTest::~CommonBucketsTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void CommonBucketsTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void CommonBucketsTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( CommonBucketsTest, by_alignment) {
+  LDSection* bss = LDSection::Create(".bss", LDFileFormat::BSS, 0, 0);
+  SectionData* data = SectionData::Create(*bss);
+
+  LDSymbol* a = helper_common("a", 1, 1);
+  LDSymbol* b = helper_common("b", 12, 8);
+  LDSymbol* c = helper_common("c", 3, 1);
+  LDSymbol* d = helper_common("d", 4, 8);
+  LDSymbol* e = helper_common("e", 4, 4);
+
+  CommonBuckets commons;
+  ASSERT_TRUE(commons.empty());
+  commons.add(*a);
+  commons.add(*b);
+  commons.add(*c);
+  commons.add(*d);
+  commons.add(*e);
+  ASSERT_FALSE(commons.empty());
+
+  // 8: b [0, 12), d [16, 20); 4: e [20, 24); 1: a [24, 25), c [25, 28)
+  ASSERT_TRUE(28 == commons.allocate(*data));
+  ASSERT_TRUE(commons.empty());
+
+  ASSERT_TRUE(0 == helper_offset(*b));
+  ASSERT_TRUE(16 == helper_offset(*d));
+  ASSERT_TRUE(20 == helper_offset(*e));
+  ASSERT_TRUE(24 == helper_offset(*a));
+  ASSERT_TRUE(25 == helper_offset(*c));
+
+  // one fragment per bucket
+  ASSERT_TRUE(b->fragRef()->frag() == d->fragRef()->frag());
+  ASSERT_TRUE(a->fragRef()->frag() == c->fragRef()->frag());
+  ASSERT_FALSE(a->fragRef()->frag() == e->fragRef()->frag());
+
+  LDSection::Destroy(bss);
+}
+
+TEST_F( CommonBucketsTest, odd_alignment) {
+  LDSection* bss = LDSection::Create(".bss", LDFileFormat::BSS, 0, 0);
+  SectionData* data = SectionData::Create(*bss);
+
+  LDSymbol* a = helper_common("a", 5, 2);
+  LDSymbol* b = helper_common("b", 6, 6);
+
+  CommonBuckets commons;
+  commons.add(*a);
+  commons.add(*b);
+
+  // 2: a [0, 5); others: b [6, 12)
+  ASSERT_TRUE(12 == commons.allocate(*data));
+  ASSERT_TRUE(0 == helper_offset(*a));
+  ASSERT_TRUE(6 == helper_offset(*b));
+
+  LDSection::Destroy(bss);
+}
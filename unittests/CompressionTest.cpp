@@ -0,0 +1,150 @@
+//===- CompressionTest.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Config/Config.h"
+#include <mcld/Support/Compression.h>
+#include <mcld/Support/ThreadPool.h>
+#include "CompressionTest.h"
+
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+/// Decompress - inflate pInput, which has pSize bytes after inflated.
+bool Decompress(const std::vector<uint8_t>& pInput, size_t pSize,
+                std::vector<uint8_t>& pOutput)
+{
+  pOutput.resize(pSize + 1);
+  uLongf length = pOutput.size();
+  if (Z_OK != uncompress(&pOutput[0], &length, &pInput[0], pInput.size()))
+    return false;
+  pOutput.resize(length);
+  return true;
+}
+#endif
+
+void Fill(std::vector<uint8_t>& pData, size_t pSize)
+{
+  pData.resize(pSize);
+  for (size_t i = 0; i < pSize; ++i)
+    pData[i] = (i * 7 + (i >> 5)) & 0xff;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+CompressionTest::CompressionTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+CompressionTest::~CompressionTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void CompressionTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void CompressionTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+#if defined(HAVE_LIBZ) && HAVE_LIBZ
+TEST_F( CompressionTest, empty) {
+  ThreadPool pool(2);
+  std::vector<uint8_t> result, output;
+  ASSERT_TRUE(zlib::compress(pool, NULL, 0, result));
+  ASSERT_TRUE(Decompress(result, 0, output));
+  ASSERT_TRUE(output.empty());
+}
+
+TEST_F( CompressionTest, one_chunk) {
+  ThreadPool pool(2);
+  std::vector<uint8_t> data, result, output;
+  Fill(data, 3000);
+  ASSERT_TRUE(zlib::compress(pool, &data[0], data.size(), result));
+  ASSERT_TRUE(Decompress(result, data.size(), output));
+  ASSERT_TRUE(data == output);
+}
+
+TEST_F( CompressionTest, many_chunks) {
+  ThreadPool pool(4);
+  std::vector<uint8_t> data, result, output;
+  Fill(data, 10000);
+  ASSERT_TRUE(zlib::compress(pool, &data[0], data.size(), result, 1000));
+  ASSERT_TRUE(Decompress(result, data.size(), output));
+  ASSERT_TRUE(data == output);
+
+  // the last chunk is shorter than the others
+  ASSERT_TRUE(zlib::compress(pool, &data[0], data.size(), result, 3000));
+  ASSERT_TRUE(Decompress(result, data.size(), output));
+  ASSERT_TRUE(data == output);
+}
+
+TEST_F( CompressionTest, same_for_any_threads) {
+  ThreadPool serial(1);
+  ThreadPool parallel(4);
+  std::vector<uint8_t> data, serial_result, parallel_result;
+  Fill(data, 20000);
+  ASSERT_TRUE(zlib::compress(serial, &data[0], data.size(),
+                             serial_result, 1024));
+  ASSERT_TRUE(zlib::compress(parallel, &data[0], data.size(),
+                             parallel_result, 1024));
+  ASSERT_TRUE(serial_result == parallel_result);
+}
+
+TEST_F( CompressionTest, uncompress) {
+  ThreadPool pool(4);
+  std::vector<uint8_t> data, result;
+  Fill(data, 10000);
+  ASSERT_TRUE(zlib::compress(pool, &data[0], data.size(), result, 1000));
+
+  std::vector<uint8_t> output(data.size());
+  ASSERT_TRUE(zlib::uncompress(&result[0], result.size(),
+                               &output[0], output.size()));
+  ASSERT_TRUE(data == output);
+
+  // the size of the output must be exact
+  std::vector<uint8_t> larger(data.size() + 1);
+  ASSERT_FALSE(zlib::uncompress(&result[0], result.size(),
+                                &larger[0], larger.size()));
+  ASSERT_FALSE(zlib::uncompress(&result[0], result.size(),
+                                &output[0], output.size() - 1));
+
+  // a truncated stream
+  ASSERT_FALSE(zlib::uncompress(&result[0], result.size() / 2,
+                                &output[0], output.size()));
+}
+#else
+TEST_F( CompressionTest, not_available) {
+  ThreadPool pool(1);
+  std::vector<uint8_t> data, result;
+  Fill(data, 16);
+  ASSERT_FALSE(zlib::isAvailable());
+  ASSERT_FALSE(zlib::compress(pool, &data[0], data.size(), result));
+
+  std::vector<uint8_t> output(16);
+  ASSERT_FALSE(zlib::uncompress(&data[0], data.size(),
+                                &output[0], output.size()));
+}
+#endif
+
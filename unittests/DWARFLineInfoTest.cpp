@@ -0,0 +1,167 @@
+//===- DWARFLineInfoTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/TargetOptions.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/DWARFLineInfo.h>
+#include <mcld/LD/ELFObjectReader.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Path.h>
+#include <../lib/Target/X86/X86LDBackend.h>
+#include <../lib/Target/X86/X86GNUInfo.h>
+
+#include <llvm/Support/Casting.h>
+
+#include "DWARFLineInfoTest.h"
+
+using namespace mcld;
+using namespace mcld::sys::fs;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+DWARFLineInfoTest::DWARFLineInfoTest()
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnueabi");
+  m_pConfig->targets().setEndian( TargetOptions::Little );
+  m_pConfig->targets().setBitClass( 64 );
+  Relocation::SetUp( *m_pConfig );
+
+  m_pInfo = new X86_64GNUInfo( m_pConfig->targets().triple() );
+  m_pLDBackend = new X86_64GNULDBackend( *m_pConfig, m_pInfo );
+  m_pModule = new Module();
+  m_pIRBuilder = new IRBuilder( *m_pModule, *m_pConfig);
+  m_pELFObjReader = new ELFObjectReader(*m_pLDBackend,
+                                        *m_pIRBuilder,
+                                        *m_pConfig);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+DWARFLineInfoTest::~DWARFLineInfoTest()
+{
+  delete m_pConfig;
+  delete m_pLDBackend;
+  delete m_pModule;
+  delete m_pIRBuilder;
+  delete m_pELFObjReader;
+}
+
+// SetUp() will be called immediately before each test.
+void DWARFLineInfoTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void DWARFLineInfoTest::TearDown()
+{
+}
+
+Input* DWARFLineInfoTest::readObject(const char* pName)
+{
+  Path path(TOPDIR);
+  path.append("unittests");
+  path.append(pName);
+
+  Input* input = m_pIRBuilder->ReadInput(pName, path);
+  if (NULL == input || !input->hasMemArea())
+    return NULL;
+  input->setType(Input::Object);
+
+  if (!m_pELFObjReader->readHeader(*input) ||
+      !m_pELFObjReader->readSections(*input) ||
+      !m_pELFObjReader->readSymbols(*input) ||
+      !m_pELFObjReader->readRelocations(*input))
+    return NULL;
+  return input;
+}
+
+Relocation* DWARFLineInfoTest::findReloc(Input& pInput, const char* pSymbol)
+{
+  LDSection* rela_text = pInput.context()->getSection(".rela.text");
+  if (NULL == rela_text || !rela_text->hasRelocData())
+    return NULL;
+
+  RelocData::iterator reloc, rEnd = rela_text->getRelocData()->end();
+  for (reloc = rela_text->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+    Relocation* relocation = llvm::cast<Relocation>(reloc);
+    if (std::string(pSymbol) == relocation->symInfo()->name())
+      return relocation;
+  }
+  return NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+// test_debug_x86_64.o is compiled by gcc -g -gdwarf-4 -O0 -c from undef.c:
+//    5 int main()
+//    6 {
+//    7   puts("hello");
+//    8   undefined_function();
+//    9   return 0;
+//   10 }
+TEST_F( DWARFLineInfoTest, find_line_of_undefined_reference )
+{
+  Input* input = readObject("test_debug_x86_64.o");
+  ASSERT_TRUE(NULL != input);
+  Relocation* reloc = findReloc(*input, "undefined_function");
+  ASSERT_TRUE(NULL != reloc);
+
+  DWARFLineInfo line_info;
+  std::string file;
+  unsigned int line = 0;
+  ASSERT_TRUE(line_info.findLine(*input, reloc->targetRef(), file, line));
+  ASSERT_EQ("undef.c", file);
+  ASSERT_EQ(8u, line);
+
+  reloc = findReloc(*input, "puts");
+  ASSERT_TRUE(NULL != reloc);
+  ASSERT_TRUE(line_info.findLine(*input, reloc->targetRef(), file, line));
+  ASSERT_EQ(7u, line);
+}
+
+TEST_F( DWARFLineInfoTest, rows_follow_the_fragments )
+{
+  Input* input = readObject("test_debug_x86_64.o");
+  ASSERT_TRUE(NULL != input);
+  Relocation* reloc = findReloc(*input, "undefined_function");
+  ASSERT_TRUE(NULL != reloc);
+
+  DWARFLineInfo line_info;
+  std::string file;
+  unsigned int line = 0;
+  ASSERT_TRUE(line_info.findLine(*input, reloc->targetRef(), file, line));
+
+  // the layout moves the fragment after the table is decoded
+  reloc->targetRef().frag()->setOffset(0x1000);
+  line = 0;
+  ASSERT_TRUE(line_info.findLine(*input, reloc->targetRef(), file, line));
+  ASSERT_EQ(8u, line);
+}
+
+TEST_F( DWARFLineInfoTest, no_debug_line )
+{
+  Input* input = readObject("test_x86_64.o");
+  ASSERT_TRUE(NULL != input);
+  Relocation* reloc = findReloc(*input, "puts");
+  ASSERT_TRUE(NULL != reloc);
+
+  DWARFLineInfo line_info;
+  std::string file;
+  unsigned int line = 0;
+  ASSERT_FALSE(line_info.findLine(*input, reloc->targetRef(), file, line));
+}
+
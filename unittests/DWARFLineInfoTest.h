@@ -0,0 +1,69 @@
+//===- DWARFLineInfoTest.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_DWARFLINEINFO_TEST_H
+#define MCLD_DWARFLINEINFO_TEST_H
+
+#include <gtest.h>
+
+namespace mcld
+{
+class Input;
+class LinkerConfig;
+class GNUInfo;
+class GNULDBackend;
+class Module;
+class IRBuilder;
+class ELFObjectReader;
+class Relocation;
+} // namespace of mcld
+
+namespace mcldtest
+{
+
+/** \class DWARFLineInfoTest
+ *  \brief The testcases of DWARFLineInfo
+ *
+ *  \see DWARFLineInfo
+ */
+class DWARFLineInfoTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  DWARFLineInfoTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~DWARFLineInfoTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// readObject - read the sections, the symbols and the relocations of the
+  /// object pName in unittests
+  mcld::Input* readObject(const char* pName);
+
+  /// findReloc - the relocation of .rela.text of pInput against pSymbol
+  mcld::Relocation* findReloc(mcld::Input& pInput, const char* pSymbol);
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::GNUInfo* m_pInfo;
+  mcld::GNULDBackend* m_pLDBackend;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+  mcld::ELFObjectReader* m_pELFObjReader;
+};
+
+} // namespace of mcldtest
+
+#endif
+
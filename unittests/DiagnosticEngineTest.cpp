@@ -0,0 +1,183 @@
+//===- DiagnosticEngineTest.cpp -------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LinkerConfig.h>
+#include <mcld/LD/DiagnosticEngine.h>
+#include <mcld/LD/DiagnosticInfos.h>
+#include <mcld/LD/DiagnosticPrinter.h>
+#include <mcld/LD/TextDiagnosticPrinter.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/Support/raw_ostream.h>
+#include "DiagnosticEngineTest.h"
+
+#include <llvm/ADT/StringExtras.h>
+
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace mcld {
+namespace test {
+
+/** \class RecordPrinter
+ *  \brief RecordPrinter records the messages it is given, and ignores the
+ *  same messages as the TextDiagnosticPrinter.
+ */
+class RecordPrinter : public TextDiagnosticPrinter
+{
+public:
+  RecordPrinter(const LinkerConfig& pConfig)
+    : TextDiagnosticPrinter(mcld::errs(), pConfig) { }
+
+  void handleDiagnostic(DiagnosticEngine::Severity pSeverity,
+                        const Diagnostic& pInfo) {
+    DiagnosticPrinter::handleDiagnostic(pSeverity, pInfo);
+    if (isIgnored(pSeverity))
+      return;
+    std::string message;
+    pInfo.format(message);
+    messages.push_back(message);
+  }
+
+public:
+  std::vector<std::string> messages;
+};
+
+} // namespace of test
+} // namespace of mcld
+
+namespace {
+
+struct Reporter
+{
+  void operator()(size_t pIdx) {
+    getDiagnosticEngine().setOrdinal(pIdx);
+    warning(diag::warn_cannot_open_search_dir) << llvm::utostr(pIdx);
+    if (0 == (pIdx % 3))
+      warning(diag::warn_cannot_open_search_dir) << llvm::utostr(pIdx) + "b";
+  }
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+DiagnosticEngineTest::DiagnosticEngineTest()
+  : m_pConfig(NULL), m_pPrinter(NULL)
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+DiagnosticEngineTest::~DiagnosticEngineTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void DiagnosticEngineTest::SetUp()
+{
+  m_pConfig = new LinkerConfig("x86_64-unknown-linux-gnu");
+  m_pPrinter = new RecordPrinter(*m_pConfig);
+  InitializeDiagnosticEngine(*m_pConfig, m_pPrinter);
+}
+
+// TearDown() will be called immediately after each test.
+void DiagnosticEngineTest::TearDown()
+{
+  InitializeDiagnosticEngine(*m_pConfig);
+  delete m_pPrinter;
+  delete m_pConfig;
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( DiagnosticEngineTest, drop_ignored_messages) {
+  // debug messages are shown at verbose level 0
+  m_pConfig->options().setVerbose(-1);
+  debug(diag::debug_eh_unsupport) << "a.o";
+  ASSERT_TRUE(m_pPrinter->messages.empty());
+
+  m_pConfig->options().setVerbose(0);
+  debug(diag::debug_eh_unsupport) << "b.o";
+  ASSERT_EQ(1U, m_pPrinter->messages.size());
+  ASSERT_EQ("unsupported .eh_frame section in input: b.o",
+            m_pPrinter->messages[0]);
+}
+
+TEST_F( DiagnosticEngineTest, buffer_until_the_barrier) {
+  DiagnosticEngine& engine = getDiagnosticEngine();
+  engine.beginBuffer();
+  ASSERT_TRUE(engine.isBuffered());
+  warning(diag::warn_cannot_open_search_dir) << "dir";
+  ASSERT_TRUE(m_pPrinter->messages.empty());
+
+  engine.endBuffer();
+  ASSERT_FALSE(engine.isBuffered());
+  ASSERT_EQ(1U, m_pPrinter->messages.size());
+  ASSERT_EQ("can not open search directory `-Ldir'", m_pPrinter->messages[0]);
+
+  // not buffered any more
+  warning(diag::warn_cannot_open_search_dir) << "dir2";
+  ASSERT_EQ(2U, m_pPrinter->messages.size());
+}
+
+TEST_F( DiagnosticEngineTest, order_of_phases_and_ordinals) {
+  DiagnosticEngine& engine = getDiagnosticEngine();
+  engine.beginBuffer();
+  engine.setOrdinal(7);
+  warning(diag::warn_cannot_open_search_dir) << "7";
+  engine.setOrdinal(2);
+  warning(diag::warn_cannot_open_search_dir) << "2";
+
+  // the next phase is printed after the first one
+  engine.beginBuffer();
+  engine.setOrdinal(0);
+  warning(diag::warn_cannot_open_search_dir) << "0";
+  engine.endBuffer();
+
+  ASSERT_EQ(3U, m_pPrinter->messages.size());
+  ASSERT_EQ("can not open search directory `-L2'", m_pPrinter->messages[0]);
+  ASSERT_EQ("can not open search directory `-L7'", m_pPrinter->messages[1]);
+  ASSERT_EQ("can not open search directory `-L0'", m_pPrinter->messages[2]);
+}
+
+TEST_F( DiagnosticEngineTest, parallel_messages_in_serial_order) {
+  const size_t num = 1000;
+  ThreadPool pool(4);
+  Reporter reporter;
+
+  getDiagnosticEngine().beginBuffer();
+  parallel_for(pool, 0, num, reporter);
+  getDiagnosticEngine().endBuffer();
+
+  std::vector<std::string> expected;
+  for (size_t i = 0; i < num; ++i) {
+    expected.push_back("can not open search directory `-L" +
+                       llvm::utostr(i) + "'");
+    if (0 == (i % 3))
+      expected.push_back("can not open search directory `-L" +
+                         llvm::utostr(i) + "b'");
+  }
+  ASSERT_TRUE(expected == m_pPrinter->messages);
+  ASSERT_EQ(expected.size(), m_pPrinter->getNumWarnings());
+}
+
+TEST_F( DiagnosticEngineTest, descriptions_by_id) {
+  DiagnosticInfos infos(*m_pConfig);
+  ASSERT_TRUE(infos.getDescription(diag::err_cannot_open_input, false)
+                                         .startswith("can not open input"));
+  ASSERT_TRUE(infos.getDescription(diag::note_has_no_symtab, false) ==
+              infos.getDescription(diag::note_has_no_symtab, true));
+
+  unsigned int last = diag::NUM_OF_BUILDIN_DIAGNOSTIC_INFO - 1;
+  ASSERT_FALSE(infos.getDescription(last, false).empty());
+  ASSERT_TRUE(infos.getDescription(last, false) ==
+              infos.getDescription(last, true));
+}
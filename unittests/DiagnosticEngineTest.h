@@ -0,0 +1,46 @@
+//===- DiagnosticEngineTest.h ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_DIAGNOSTIC_ENGINE_TEST_H
+#define MCLD_UNITTEST_DIAGNOSTIC_ENGINE_TEST_H
+
+#include <gtest.h>
+
+namespace mcld {
+
+class LinkerConfig;
+
+namespace test {
+
+class RecordPrinter;
+
+class DiagnosticEngineTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  DiagnosticEngineTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~DiagnosticEngineTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  LinkerConfig* m_pConfig;
+  RecordPrinter* m_pPrinter;
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,148 @@
+//===- DigestTest.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/ThreadPool.h>
+#include "DigestTest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// Hex - hash pText and return the digest in hex
+std::string Hex(digest::Kind pKind, const char* pText)
+{
+  uint8_t result[20];
+  digest::hash(pKind, reinterpret_cast<const uint8_t*>(pText),
+               strlen(pText), result);
+
+  std::string hex;
+  char byte[3];
+  for (size_t i = 0; i < digest::size(pKind); ++i) {
+    snprintf(byte, sizeof(byte), "%02x", result[i]);
+    hex += byte;
+  }
+  return hex;
+}
+
+void Fill(std::vector<uint8_t>& pData, size_t pSize)
+{
+  pData.resize(pSize);
+  for (size_t i = 0; i < pSize; ++i)
+    pData[i] = (i * 7 + (i >> 5)) & 0xff;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+DigestTest::DigestTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+DigestTest::~DigestTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void DigestTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void DigestTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( DigestTest, md5) {
+  ASSERT_EQ("d41d8cd98f00b204e9800998ecf8427e", Hex(digest::MD5, ""));
+  ASSERT_EQ("900150983cd24fb0d6963f7d28e17f72", Hex(digest::MD5, "abc"));
+}
+
+TEST_F( DigestTest, sha1) {
+  ASSERT_EQ("a9993e364706816aba3e25717850c26c9cd0d89d",
+            Hex(digest::SHA1, "abc"));
+  // two blocks after the padding
+  ASSERT_EQ("84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+            Hex(digest::SHA1, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmn"
+                              "lmnomnopnopq"));
+}
+
+TEST_F( DigestTest, fast) {
+  // xxHash64 in the little endian
+  ASSERT_EQ("99e9d85137db46ef", Hex(digest::Fast, ""));
+  ASSERT_EQ("990977adf52cbc44", Hex(digest::Fast, "abc"));
+  ASSERT_EQ("f18b378a3ca8cefb",
+            Hex(digest::Fast, "Nobody inspects the spammish repetition"));
+}
+
+TEST_F( DigestTest, fast_seed) {
+  const uint8_t data[] = { 'a', 'b', 'c' };
+  ASSERT_EQ(0xef46db3751d8e999ULL, digest::fast(NULL, 0));
+  ASSERT_EQ(0x44bc2cf5ad770999ULL, digest::fast(data, sizeof(data)));
+  // xxHash64 with the seed 1
+  ASSERT_EQ(0xd5afba1336a3be4bULL, digest::fast(NULL, 0, 1));
+  ASSERT_EQ(0xbea9ca8199328908ULL, digest::fast(data, sizeof(data), 1));
+}
+
+TEST_F( DigestTest, one_chunk_tree) {
+  // a tree of one chunk is the plain digest
+  ThreadPool pool(2);
+  std::vector<uint8_t> data;
+  Fill(data, 1000);
+  uint8_t plain[20], tree[20];
+  digest::hash(digest::SHA1, &data[0], data.size(), plain);
+  digest::treeHash(pool, digest::SHA1, &data[0], data.size(), tree);
+  ASSERT_TRUE(0 == memcmp(plain, tree, 20));
+}
+
+TEST_F( DigestTest, tree_independent_of_threads) {
+  std::vector<uint8_t> data;
+  Fill(data, 5000);
+  uint8_t serial[20], parallel[20];
+  ThreadPool one(1), four(4);
+  digest::treeHash(one, digest::SHA1, &data[0], data.size(), serial, 1024);
+  digest::treeHash(four, digest::SHA1, &data[0], data.size(), parallel, 1024);
+  ASSERT_TRUE(0 == memcmp(serial, parallel, 20));
+
+  // the chunk size is a part of the result
+  digest::treeHash(four, digest::SHA1, &data[0], data.size(), parallel, 2048);
+  ASSERT_FALSE(0 == memcmp(serial, parallel, 20));
+}
+
+TEST_F( DigestTest, crc32) {
+  const uint8_t* check = reinterpret_cast<const uint8_t*>("123456789");
+  ASSERT_TRUE(0x0 == digest::crc32(check, 0));
+  ASSERT_TRUE(0xcbf43926 == digest::crc32(check, 9));
+
+  // continued from the CRC of the first bytes
+  ASSERT_TRUE(0xcbf43926 == digest::crc32(check + 4, 5,
+                                          digest::crc32(check, 4)));
+  ASSERT_TRUE(0xcbf43926 == digest::crc32Combine(digest::crc32(check, 4),
+                                                 digest::crc32(check + 4, 5),
+                                                 5));
+}
+
+TEST_F( DigestTest, parallel_crc32_is_plain) {
+  std::vector<uint8_t> data;
+  Fill(data, 5000);
+  uint32_t plain = digest::crc32(&data[0], data.size());
+  ThreadPool one(1), four(4);
+  ASSERT_TRUE(plain == digest::crc32(one, &data[0], data.size(), 1024));
+  ASSERT_TRUE(plain == digest::crc32(four, &data[0], data.size(), 1024));
+  ASSERT_TRUE(plain == digest::crc32(four, &data[0], data.size(), 333));
+}
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "mcld/Support/Directory.h"
+#include "mcld/MC/MCLDDirectory.h"
 #include "DirIteratorTest.h"
 #include "errno.h"
 
@@ -62,3 +63,21 @@ TEST_F( DirIteratorTest, open_dir ) {
 }
 
 
+
+TEST_F( DirIteratorTest, find_entry ) {
+  MCLDDirectory dir(".");
+  ASSERT_TRUE( dir.isGood() );
+
+  // every entry found by the iterator can be looked up by its file name
+  size_t num = 0;
+  Directory::iterator entry = m_pDir->begin();
+  Directory::iterator enEnd = m_pDir->end();
+  for (; entry != enEnd; ++entry) {
+    Path* path = dir.find(entry.path()->filename().native());
+    ASSERT_TRUE( NULL != path );
+    ASSERT_TRUE( entry.path()->filename() == path->filename() );
+    ++num;
+  }
+  ASSERT_TRUE( 0 != num );
+  ASSERT_TRUE( NULL == dir.find("no-such-file-in-this-directory") );
+}
@@ -0,0 +1,159 @@
+//===- DynObjSummaryTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/DynObjSummary.h>
+#include "DynObjSummaryTest.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+DynObjSummary::Symbol MakeSymbol(const char* pName,
+                                 ResolveInfo::Desc pDesc,
+                                 uint64_t pValue)
+{
+  DynObjSummary::Symbol symbol;
+  symbol.name = pName;
+  symbol.type = ResolveInfo::Function;
+  symbol.desc = pDesc;
+  symbol.binding = ResolveInfo::Global;
+  symbol.visibility = ResolveInfo::Default;
+  symbol.size = 16;
+  symbol.value = pValue;
+  return symbol;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+DynObjSummaryTest::DynObjSummaryTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+DynObjSummaryTest::~DynObjSummaryTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void DynObjSummaryTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void DynObjSummaryTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( DynObjSummaryTest, round_trip) {
+  DynObjSummary::SymbolList symbols;
+  symbols.push_back(MakeSymbol("undef_fn", ResolveInfo::Undefined, 0x0));
+  symbols.push_back(MakeSymbol("foo", ResolveInfo::Define, 0x100));
+  symbols.push_back(MakeSymbol("bar", ResolveInfo::Define, 0x200));
+
+  std::string image;
+  ASSERT_TRUE(DynObjSummary::emit(symbols, "libfoo.so", "/lib/libfoo.so",
+                                  4096, 1234, image));
+
+  DynObjSummary summary;
+  ASSERT_TRUE(summary.map(image.data(), image.size()));
+  ASSERT_EQ(3u, summary.numOfSymbols());
+  ASSERT_TRUE("libfoo.so" == summary.getSOName());
+  ASSERT_TRUE("/lib/libfoo.so" == summary.getPath());
+  ASSERT_EQ(4096u, summary.getFileSize());
+  ASSERT_EQ(1234u, summary.getModTime());
+
+  ASSERT_TRUE(summary.isUndefined(0));
+  ASSERT_TRUE("undef_fn" == summary.getName(0));
+
+  size_t idx = summary.findDefined("bar");
+  ASSERT_EQ(2u, idx);
+  ASSERT_EQ(0x200u, summary.getEntry(idx).value);
+  ASSERT_EQ(16u, summary.getEntry(idx).size);
+  ASSERT_EQ(ResolveInfo::Function, summary.getEntry(idx).type);
+}
+
+TEST_F( DynObjSummaryTest, undefined_and_missing_names) {
+  DynObjSummary::SymbolList symbols;
+  symbols.push_back(MakeSymbol("undef_fn", ResolveInfo::Undefined, 0x0));
+  symbols.push_back(MakeSymbol("foo", ResolveInfo::Define, 0x100));
+
+  std::string image;
+  ASSERT_TRUE(DynObjSummary::emit(symbols, "libfoo.so", "/lib/libfoo.so",
+                                  4096, 1234, image));
+
+  DynObjSummary summary;
+  ASSERT_TRUE(summary.map(image.data(), image.size()));
+  ASSERT_EQ(summary.numOfSymbols(), summary.findDefined("undef_fn"));
+  ASSERT_EQ(summary.numOfSymbols(), summary.findDefined("no_such_symbol"));
+  ASSERT_EQ(1u, summary.findDefined("foo"));
+}
+
+TEST_F( DynObjSummaryTest, first_definition_wins) {
+  DynObjSummary::SymbolList symbols;
+  symbols.push_back(MakeSymbol("foo", ResolveInfo::Define, 0x100));
+  symbols.push_back(MakeSymbol("foo", ResolveInfo::Define, 0x200));
+
+  std::string image;
+  ASSERT_TRUE(DynObjSummary::emit(symbols, "libfoo.so", "/lib/libfoo.so",
+                                  4096, 1234, image));
+
+  DynObjSummary summary;
+  ASSERT_TRUE(summary.map(image.data(), image.size()));
+  ASSERT_EQ(0u, summary.findDefined("foo"));
+}
+
+TEST_F( DynObjSummaryTest, many_symbols) {
+  std::vector<std::string> names;
+  for (unsigned i = 0; i < 5000; ++i) {
+    std::string name;
+    llvm::raw_string_ostream os(name);
+    os << "symbol_" << i;
+    os.flush();
+    names.push_back(name);
+  }
+
+  DynObjSummary::SymbolList symbols;
+  for (unsigned i = 0; i < names.size(); ++i)
+    symbols.push_back(MakeSymbol(names[i].c_str(), ResolveInfo::Define, i));
+
+  std::string image;
+  ASSERT_TRUE(DynObjSummary::emit(symbols, "libc.so", "/lib/libc.so",
+                                  1 << 20, 5678, image));
+
+  DynObjSummary summary;
+  ASSERT_TRUE(summary.map(image.data(), image.size()));
+  for (unsigned i = 0; i < names.size(); ++i)
+    ASSERT_EQ(i, summary.findDefined(names[i]));
+}
+
+TEST_F( DynObjSummaryTest, broken_images) {
+  DynObjSummary::SymbolList symbols;
+  symbols.push_back(MakeSymbol("foo", ResolveInfo::Define, 0x100));
+
+  std::string image;
+  ASSERT_TRUE(DynObjSummary::emit(symbols, "libfoo.so", "/lib/libfoo.so",
+                                  4096, 1234, image));
+
+  DynObjSummary summary;
+  // truncated
+  ASSERT_FALSE(summary.map(image.data(), image.size() / 2));
+  // bad magic
+  std::string bad(image);
+  bad[0] = 'X';
+  ASSERT_FALSE(summary.map(bad.data(), bad.size()));
+}
+
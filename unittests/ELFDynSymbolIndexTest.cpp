@@ -0,0 +1,185 @@
+//===- ELFDynSymbolIndexTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ELFDynSymbolIndex.h>
+#include "ELFDynSymbolIndexTest.h"
+
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+// .dynsym of 64-bit ELF: the null symbol, an undefined symbol, and three
+// defined symbols.
+const char* const kNames[] = { "", "undef_fn", "foo", "bar", "baz" };
+const size_t kNumOfSymbols = 5;
+
+struct DynObj
+{
+  std::vector<llvm::ELF::Elf64_Sym> symtab;
+  std::string strtab;
+
+  DynObj() : symtab(kNumOfSymbols) {
+    memset(&symtab[0], 0, kNumOfSymbols * sizeof(llvm::ELF::Elf64_Sym));
+    strtab.push_back('\0');
+    for (size_t i = 1; i < kNumOfSymbols; ++i) {
+      symtab[i].st_name = strtab.size();
+      symtab[i].st_shndx = (1 == i) ? llvm::ELF::SHN_UNDEF : 7;
+      strtab.append(kNames[i]);
+      strtab.push_back('\0');
+    }
+  }
+
+  ELFDynSymbolIndex index(ELFDynSymbolIndex::Kind pKind,
+                          const std::vector<uint32_t>& pHash) const {
+    return ELFDynSymbolIndex(pKind, 64,
+                   reinterpret_cast<const uint8_t*>(&pHash[0]),
+                   pHash.size() * sizeof(uint32_t),
+                   reinterpret_cast<const uint8_t*>(&symtab[0]),
+                   symtab.size() * sizeof(llvm::ELF::Elf64_Sym),
+                   strtab.data(), strtab.size());
+  }
+};
+
+/// SysVTable - nbucket, nchain, bucket[3], chain[5]
+std::vector<uint32_t> SysVTable()
+{
+  const uint32_t nbucket = 3;
+  std::vector<uint32_t> table(2 + nbucket + kNumOfSymbols, 0);
+  table[0] = nbucket;
+  table[1] = kNumOfSymbols;
+  for (uint32_t i = 1; i < kNumOfSymbols; ++i) {
+    uint32_t bucket = 2 + ELFDynSymbolIndex::SysVHash(kNames[i]) % nbucket;
+    table[2 + nbucket + i] = table[bucket];
+    table[bucket] = i;
+  }
+  return table;
+}
+
+/// GNUTable - one bucket and one 64-bit bloom word over the defined symbols
+std::vector<uint32_t> GNUTable()
+{
+  const uint32_t symoffset = 2;
+  const uint32_t shift = 6;
+  uint64_t bloom = 0;
+  std::vector<uint32_t> table;
+  table.push_back(1);
+  table.push_back(symoffset);
+  table.push_back(1);
+  table.push_back(shift);
+  table.push_back(0); // bloom, the low and the high words
+  table.push_back(0);
+  table.push_back(symoffset); // bucket[0]
+  for (uint32_t i = symoffset; i < kNumOfSymbols; ++i) {
+    uint32_t hash = ELFDynSymbolIndex::GNUHash(kNames[i]);
+    bloom |= (uint64_t(1) << (hash % 64)) |
+             (uint64_t(1) << ((hash >> shift) % 64));
+    if (kNumOfSymbols - 1 == i)
+      hash |= 1;
+    else
+      hash &= ~1u;
+    table.push_back(hash);
+  }
+  memcpy(&table[4], &bloom, sizeof(bloom));
+  return table;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+ELFDynSymbolIndexTest::ELFDynSymbolIndexTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ELFDynSymbolIndexTest::~ELFDynSymbolIndexTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void ELFDynSymbolIndexTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ELFDynSymbolIndexTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ELFDynSymbolIndexTest, hash_functions) {
+  ASSERT_EQ(0x0u, ELFDynSymbolIndex::SysVHash(""));
+  ASSERT_EQ(0x077905a6u, ELFDynSymbolIndex::SysVHash("printf"));
+  ASSERT_EQ(5381u, ELFDynSymbolIndex::GNUHash(""));
+  ASSERT_EQ(0x156b2bb8u, ELFDynSymbolIndex::GNUHash("printf"));
+}
+
+TEST_F( ELFDynSymbolIndexTest, sysv_lookup) {
+  DynObj dynobj;
+  std::vector<uint32_t> table = SysVTable();
+  ELFDynSymbolIndex index = dynobj.index(ELFDynSymbolIndex::SysV, table);
+
+  ASSERT_TRUE(index.isValid());
+  ASSERT_EQ(kNumOfSymbols, index.numOfSymbols());
+  ASSERT_TRUE(index.isUndefined(1));
+  ASSERT_FALSE(index.isUndefined(2));
+  ASSERT_EQ(2u, index.findDefined("foo"));
+  ASSERT_EQ(3u, index.findDefined("bar"));
+  ASSERT_EQ(4u, index.findDefined("baz"));
+  ASSERT_EQ(0u, index.findDefined("undef_fn"));
+  ASSERT_EQ(0u, index.findDefined("fo"));
+  ASSERT_EQ(0u, index.findDefined("printf"));
+}
+
+TEST_F( ELFDynSymbolIndexTest, gnu_lookup) {
+  DynObj dynobj;
+  std::vector<uint32_t> table = GNUTable();
+  ELFDynSymbolIndex index = dynobj.index(ELFDynSymbolIndex::GNU, table);
+
+  ASSERT_TRUE(index.isValid());
+  ASSERT_EQ(2u, index.findDefined("foo"));
+  ASSERT_EQ(3u, index.findDefined("bar"));
+  ASSERT_EQ(4u, index.findDefined("baz"));
+  ASSERT_EQ(0u, index.findDefined("undef_fn"));
+  ASSERT_EQ(0u, index.findDefined("foo2"));
+  ASSERT_EQ(0u, index.findDefined("printf"));
+}
+
+TEST_F( ELFDynSymbolIndexTest, broken_tables) {
+  DynObj dynobj;
+
+  // the buckets are out of the table
+  std::vector<uint32_t> sysv = SysVTable();
+  sysv.resize(4);
+  ELFDynSymbolIndex short_sysv = dynobj.index(ELFDynSymbolIndex::SysV, sysv);
+  ASSERT_FALSE(short_sysv.isValid());
+  ASSERT_EQ(0u, short_sysv.findDefined("foo"));
+
+  // every chain loops back to itself
+  sysv = SysVTable();
+  for (uint32_t i = 1; i < kNumOfSymbols; ++i)
+    sysv[2 + 3 + i] = i;
+  ELFDynSymbolIndex loop = dynobj.index(ELFDynSymbolIndex::SysV, sysv);
+  ASSERT_TRUE(loop.isValid());
+  ASSERT_EQ(0u, loop.findDefined("undef_fn"));
+
+  // no bloom word
+  std::vector<uint32_t> gnu = GNUTable();
+  gnu[2] = 0;
+  ELFDynSymbolIndex no_bloom = dynobj.index(ELFDynSymbolIndex::GNU, gnu);
+  ASSERT_FALSE(no_bloom.isValid());
+  ASSERT_EQ(0u, no_bloom.findDefined("foo"));
+}
@@ -151,6 +151,32 @@ TEST_F( ELFReaderTest, read_symbol_and_rela )
   ASSERT_EQ(-0x4, rReloc->addend());
 }
 
+TEST_F( ELFReaderTest, discard_locals )
+{
+  m_pInput->setType(Input::Object);
+  m_pConfig->options().setStripSymbols(GeneralOptions::StripLocals);
+
+  LDSection* symtab_shdr = m_pInput->context()->getSection(".symtab");
+  LDSection* strtab_shdr = symtab_shdr->getLink();
+  MemoryRegion* symtab_region = m_pInput->memArea()->request(
+                         m_pInput->fileOffset() + symtab_shdr->offset(),
+                         symtab_shdr->size());
+  MemoryRegion* strtab_region = m_pInput->memArea()->request(
+                         m_pInput->fileOffset() + strtab_shdr->offset(),
+                         strtab_shdr->size());
+  char* strtab = reinterpret_cast<char*>(strtab_region->start());
+  ASSERT_TRUE(m_pELFReader->readSymbols(*m_pInput, *m_pIRBuilder,
+                                        *symtab_region, strtab));
+  m_pInput->memArea()->release(symtab_region);
+  m_pInput->memArea()->release(strtab_region);
+
+  // the file symbol is dropped, but its index is kept
+  ASSERT_TRUE(NULL==m_pInput->context()->getSymbol(1));
+  ASSERT_EQ("puts", std::string(m_pInput->context()->getSymbol(10)->name()));
+
+  m_pConfig->options().setStripSymbols(GeneralOptions::KeepAllSymbols);
+}
+
 TEST_F( ELFReaderTest, read_regular_sections ) {
   ASSERT_TRUE( m_pELFObjReader->readSections(*m_pInput) );
 }
@@ -160,3 +186,14 @@ TEST_F( ELFReaderTest, is_my_format ) {
 }
 
 
+
+TEST_F( ELFReaderTest, read_symbol_names ) {
+  // only main is defined and non-local. puts is undefined.
+  std::vector<std::string> names;
+  ASSERT_EQ(Input::Object,
+            m_pELFReader->readSymbolNames(*m_pInput->memArea(),
+                                          m_pInput->fileOffset(),
+                                          names));
+  ASSERT_EQ(1u, names.size());
+  ASSERT_EQ("main", names[0]);
+}
@@ -17,10 +17,6 @@
 #include <mcld/Target/GNULDBackend.h>
 #include <mcld/MC/InputBuilder.h>
 
-namespace mcld {
-  class ELFReader<64, true>;
-} // namespace for mcld
-
 namespace mcldtest
 {
 
@@ -0,0 +1,87 @@
+//===- EhFrameTest.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/EhFrame.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/MemoryRegion.h>
+#include "EhFrameTest.h"
+
+#include <llvm/Support/ELF.h>
+
+#include <set>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+EhFrameTest::EhFrameTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+EhFrameTest::~EhFrameTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void EhFrameTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void EhFrameTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( EhFrameTest, remove_entries) {
+  uint8_t data[80] = { 0 };
+  LDSection* section = LDSection::Create(".eh_frame", LDFileFormat::EhFrame,
+                                         llvm::ELF::SHT_PROGBITS,
+                                         llvm::ELF::SHF_ALLOC);
+  EhFrame* eh_frame = EhFrame::Create(*section);
+
+  EhFrame::CIE* cie1 = new EhFrame::CIE(*MemoryRegion::Create(data, 16));
+  eh_frame->addCIE(*cie1);
+  EhFrame::FDE* fde1 = new EhFrame::FDE(*MemoryRegion::Create(data + 16, 16),
+                                        *cie1, 8);
+  eh_frame->addFDE(*fde1);
+  EhFrame::FDE* fde2 = new EhFrame::FDE(*MemoryRegion::Create(data + 32, 16),
+                                        *cie1, 8);
+  eh_frame->addFDE(*fde2);
+  EhFrame::CIE* cie2 = new EhFrame::CIE(*MemoryRegion::Create(data + 48, 16));
+  eh_frame->addCIE(*cie2);
+  EhFrame::FDE* fde3 = new EhFrame::FDE(*MemoryRegion::Create(data + 64, 16),
+                                        *cie2, 8);
+  eh_frame->addFDE(*fde3);
+  ASSERT_EQ(4u, fde3->getCIEPointerOffset());
+
+  // the second CIE is the same as the first one, and the first FDE is dead
+  fde3->setCIE(*cie1);
+  std::set<const Fragment*> dropped;
+  dropped.insert(fde1);
+  dropped.insert(cie2);
+  ASSERT_EQ(32u, eh_frame->remove(dropped));
+
+  ASSERT_EQ(1u, eh_frame->numOfCIEs());
+  ASSERT_EQ(2u, eh_frame->numOfFDEs());
+  ASSERT_TRUE(cie1 == &eh_frame->cie_front());
+  ASSERT_TRUE(fde2 == &eh_frame->fde_front());
+  ASSERT_TRUE(fde3 == &eh_frame->fde_back());
+  ASSERT_TRUE(cie1 == &fde3->getCIE());
+
+  ASSERT_EQ(0u, cie1->getOffset());
+  ASSERT_EQ(16u, fde2->getOffset());
+  ASSERT_EQ(32u, fde3->getOffset());
+  ASSERT_EQ(3u, eh_frame->getSectionData().size());
+  ASSERT_EQ(48u, section->size());
+}
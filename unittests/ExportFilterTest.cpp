@@ -0,0 +1,111 @@
+//===- ExportFilterTest.cpp -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ExportFilter.h>
+#include "ExportFilterTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+ExportFilterTest::ExportFilterTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ExportFilterTest::~ExportFilterTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void ExportFilterTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ExportFilterTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ExportFilterTest, empty) {
+  ExportFilter filter;
+  filter.parseVersionScript("");
+  ASSERT_TRUE(filter.empty());
+  ASSERT_TRUE(filter.isExported("main"));
+}
+
+TEST_F( ExportFilterTest, version_script_local_all) {
+  ExportFilter filter;
+  filter.parseVersionScript("{\n"
+                            "  global:\n"
+                            "    foo; bar_*;  # the public API\n"
+                            "  local: *;\n"
+                            "};\n");
+  ASSERT_FALSE(filter.empty());
+  ASSERT_TRUE(filter.isExported("foo"));
+  ASSERT_TRUE(filter.isExported("bar_init"));
+  ASSERT_TRUE(filter.isExported("bar_"));
+  ASSERT_FALSE(filter.isExported("foobar"));
+  ASSERT_FALSE(filter.isExported("_ZN3fooC1Ev"));
+}
+
+TEST_F( ExportFilterTest, version_script_nodes) {
+  ExportFilter filter;
+  filter.parseVersionScript("/* two versions */\n"
+                            "LIBFOO_1.0 { foo; local: *; };\n"
+                            "LIBFOO_2.0 { global: foo2; } LIBFOO_1.0;\n");
+  ASSERT_TRUE(filter.isExported("foo"));
+  ASSERT_TRUE(filter.isExported("foo2"));
+  ASSERT_FALSE(filter.isExported("LIBFOO_1.0"));
+  ASSERT_FALSE(filter.isExported("helper"));
+}
+
+TEST_F( ExportFilterTest, version_script_precedence) {
+  // a name matches before a pattern, and global before local
+  ExportFilter filter;
+  filter.parseVersionScript("{ global: foo_*; bar; local: foo_internal; "
+                            "bar; baz*; };");
+  ASSERT_TRUE(filter.isExported("foo_api"));
+  ASSERT_FALSE(filter.isExported("foo_internal"));
+  ASSERT_TRUE(filter.isExported("bar"));
+  ASSERT_FALSE(filter.isExported("baz1"));
+  ASSERT_TRUE(filter.isExported("qux"));
+}
+
+TEST_F( ExportFilterTest, version_script_patterns) {
+  ExportFilter filter;
+  filter.parseVersionScript("{ global: f?o; b[aeiou]r; n[!0-9]x; local: *; };");
+  ASSERT_TRUE(filter.isExported("foo"));
+  ASSERT_TRUE(filter.isExported("fxo"));
+  ASSERT_FALSE(filter.isExported("fo"));
+  ASSERT_TRUE(filter.isExported("bar"));
+  ASSERT_FALSE(filter.isExported("bxr"));
+  ASSERT_TRUE(filter.isExported("nax"));
+  ASSERT_FALSE(filter.isExported("n1x"));
+}
+
+TEST_F( ExportFilterTest, version_script_extern) {
+  // the C++ patterns need the demangled names
+  ExportFilter filter;
+  filter.parseVersionScript("{ global: extern \"C++\" { foo::*; }; "
+                            "local: *; };");
+  ASSERT_TRUE(filter.isDisabled());
+  ASSERT_TRUE(filter.isExported("_ZN3foo3barEv"));
+  ASSERT_TRUE(filter.isExported("helper"));
+}
+
+TEST_F( ExportFilterTest, dynamic_list) {
+  ExportFilter filter;
+  filter.parseDynamicList("{\n  foo;\n  bar*;\n};\n");
+  ASSERT_TRUE(filter.isExported("foo"));
+  ASSERT_TRUE(filter.isExported("barrier"));
+  ASSERT_FALSE(filter.isExported("baz"));
+}
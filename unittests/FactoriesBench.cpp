@@ -0,0 +1,45 @@
+//===- FactoriesBench.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/RelocationFactory.h>
+#include <mcld/LD/ResolveInfoFactory.h>
+#include <mcld/Fragment/Relocation.h>
+
+#include <benchmark/benchmark.h>
+
+using namespace mcld;
+
+/// produce the relocations of an input, and release them at once
+static void BM_RelocationFactoryProduce(benchmark::State& pState)
+{
+  size_t num = pState.range(0);
+  while (pState.KeepRunning()) {
+    RelocationFactory factory;
+    for (size_t i = 0; i < num; ++i)
+      benchmark::DoNotOptimize(factory.produceEmptyEntry());
+  }
+  pState.SetItemsProcessed(pState.iterations() * num);
+}
+BENCHMARK(BM_RelocationFactoryProduce)->RangeMultiplier(10)->Range(1000, 1000000);
+
+/// produce and destroy the ResolveInfos of the symbols being resolved
+static void BM_ResolveInfoFactoryProduce(benchmark::State& pState)
+{
+  size_t num = pState.range(0);
+  while (pState.KeepRunning()) {
+    ResolveInfoFactory factory;
+    for (size_t i = 0; i < num; ++i) {
+      ResolveInfo* info = factory.produce("_ZN4mcld10ResolveInfoE");
+      if (0 == (i & 0x3))
+        factory.destroy(info);
+    }
+  }
+  pState.SetItemsProcessed(pState.iterations() * num);
+}
+BENCHMARK(BM_ResolveInfoFactoryProduce)->RangeMultiplier(10)->Range(1000, 1000000);
+
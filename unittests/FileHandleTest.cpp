@@ -10,6 +10,7 @@
 #include <mcld/Support/Path.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <cstring>
 #include "FileHandleTest.h"
 
 using namespace mcld;
@@ -99,3 +100,27 @@ TEST_F(FileHandleTest, fail_close) {
   ASSERT_FALSE(m_pTestee->isOpened());
   ASSERT_FALSE(m_pTestee->isGood());
 }
+
+TEST_F(FileHandleTest, copy_range) {
+  mcld::sys::fs::Path path(TOPDIR);
+  path.append("unittests/test.txt");
+  ASSERT_TRUE(m_pTestee->open(path, FileHandle::ReadOnly));
+
+  FileHandle output;
+  if (!output.openAnonymous())
+    return;
+  ASSERT_TRUE(output.allocate(32));
+
+  // the system may not copy between the file systems. The handler stays
+  // good then.
+  if (!output.copy(*m_pTestee, 3, 5, 20)) {
+    ASSERT_TRUE(output.isGood());
+    return;
+  }
+
+  char expected[20], copied[20];
+  ASSERT_TRUE(m_pTestee->read(expected, 3, 20));
+  ASSERT_TRUE(output.read(copied, 5, 20));
+  ASSERT_EQ(0, memcmp(expected, copied, 20));
+  ASSERT_TRUE(32 == output.size());
+}
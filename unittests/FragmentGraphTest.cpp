@@ -0,0 +1,111 @@
+//===- FragmentGraphTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Fragment/FragmentGraph.h>
+#include "FragmentGraphTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+typedef FragmentGraph::AdjacencyList AdjacencyList;
+
+// Constructor can do set-up work for all test here.
+FragmentGraphTest::FragmentGraphTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+FragmentGraphTest::~FragmentGraphTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void FragmentGraphTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void FragmentGraphTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( FragmentGraphTest, adjacency_empty) {
+  AdjacencyList matrix;
+  matrix.finalize(3);
+  ASSERT_EQ(3u, matrix.getN());
+  ASSERT_EQ(0u, matrix.numOfEdges());
+  for (uint32_t x = 0; x < 3; ++x) {
+    ASSERT_TRUE(matrix.begin(x) == matrix.end(x));
+    for (uint32_t y = 0; y < 3; ++y)
+      ASSERT_EQ(0u, matrix.at(x, y));
+  }
+}
+
+TEST_F( FragmentGraphTest, adjacency_rows) {
+  // the references are added out of order. A row lists the targets of its
+  // node in ascending order.
+  AdjacencyList matrix;
+  matrix.add(2, 0);
+  matrix.add(0, 3);
+  matrix.add(0, 1);
+  matrix.add(3, 3);
+  matrix.add(2, 1);
+  matrix.finalize(4);
+
+  ASSERT_EQ(5u, matrix.numOfEdges());
+
+  AdjacencyList::const_iterator it = matrix.begin(0);
+  ASSERT_EQ(2, matrix.end(0) - it);
+  ASSERT_EQ(1u, it[0].node);
+  ASSERT_EQ(3u, it[1].node);
+
+  ASSERT_TRUE(matrix.begin(1) == matrix.end(1));
+
+  it = matrix.begin(2);
+  ASSERT_EQ(2, matrix.end(2) - it);
+  ASSERT_EQ(0u, it[0].node);
+  ASSERT_EQ(1u, it[1].node);
+
+  it = matrix.begin(3);
+  ASSERT_EQ(1, matrix.end(3) - it);
+  ASSERT_EQ(3u, it[0].node);
+
+  ASSERT_EQ(1u, matrix.at(0, 1));
+  ASSERT_EQ(0u, matrix.at(1, 0));
+  ASSERT_EQ(1u, matrix.at(3, 3));
+  ASSERT_EQ(0u, matrix.at(3, 0));
+}
+
+TEST_F( FragmentGraphTest, adjacency_weights) {
+  // the duplicated references are merged into the weight of one edge
+  AdjacencyList matrix;
+  matrix.add(1, 0);
+  matrix.add(0, 1);
+  matrix.add(1, 0);
+  matrix.add(0, 1);
+  matrix.add(1, 0);
+  matrix.add(1, 2);
+  matrix.finalize(3);
+
+  ASSERT_EQ(3u, matrix.numOfEdges());
+  ASSERT_EQ(2u, matrix.at(0, 1));
+  ASSERT_EQ(3u, matrix.at(1, 0));
+  ASSERT_EQ(1u, matrix.at(1, 2));
+  ASSERT_EQ(0u, matrix.at(2, 1));
+
+  AdjacencyList::const_iterator it = matrix.begin(1);
+  ASSERT_EQ(2, matrix.end(1) - it);
+  ASSERT_EQ(0u, it[0].node);
+  ASSERT_EQ(3u, it[0].weight);
+  ASSERT_EQ(2u, it[1].node);
+  ASSERT_EQ(1u, it[1].weight);
+}
+
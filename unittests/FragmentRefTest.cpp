@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 #include "FragmentRefTest.h"
 
+#include <mcld/Fragment/FillFragment.h>
 #include <mcld/Fragment/FragmentRef.h>
 #include <mcld/Fragment/RegionFragment.h>
 #include <mcld/Support/MemoryAreaFactory.h>
@@ -67,3 +68,19 @@ TEST_F( FragmentRefTest, ) {
   delete areaFactory;
 }
 
+TEST_F( FragmentRefTest, assign) {
+  FillFragment* a = new FillFragment(0x0, 1, 16);
+  FillFragment* b = new FillFragment(0x0, 1, 16);
+
+  FragmentRef* ref = FragmentRef::Create(*a, 8);
+  ASSERT_EQ(a, ref->frag());
+  ASSERT_TRUE(8 == ref->offset());
+
+  ref->assign(*b, 4);
+  ASSERT_EQ(b, ref->frag());
+  ASSERT_TRUE(4 == ref->offset());
+
+  ASSERT_TRUE(NULL == FragmentRef::Null()->frag());
+  delete a;
+  delete b;
+}
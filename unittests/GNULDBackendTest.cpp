@@ -0,0 +1,227 @@
+//===- GNULDBackendTest.cpp -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/Target/GNULDBackend.h>
+#include "GNULDBackendTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// DataPagePacker - open the section orders and PackDataPages() of
+/// GNULDBackend to the testcases. It is never instantiated.
+class DataPagePacker : public GNULDBackend
+{
+public:
+  using GNULDBackend::SHOEntry;
+  using GNULDBackend::SHO_TEXT;
+  using GNULDBackend::SHO_RELRO;
+  using GNULDBackend::SHO_RELRO_LAST;
+  using GNULDBackend::SHO_DATA;
+  using GNULDBackend::SHO_BSS;
+
+  static void Pack(std::vector<SHOEntry>& pList, uint64_t pPageSize)
+  { PackDataPages(pList, pPageSize); }
+};
+
+/// BloomChooser - open chooseGNUHashBloom() of GNULDBackend to the
+/// testcases. It is never instantiated.
+class BloomChooser : public GNULDBackend
+{
+public:
+  static void Choose(const std::vector<uint32_t>& pHashes,
+                     uint32_t pBase,
+                     uint32_t pShift1,
+                     uint32_t& pMaskbitslog2,
+                     uint32_t& pShift2)
+  { chooseGNUHashBloom(pHashes, pBase, pShift1, pMaskbitslog2, pShift2); }
+};
+
+typedef std::vector<DataPagePacker::SHOEntry> SHOList;
+
+const uint64_t PageSize = 0x1000;
+
+/// Hashes - pNum distinct hashes spread over all 32 bits
+std::vector<uint32_t> Hashes(uint32_t pNum)
+{
+  std::vector<uint32_t> hashes;
+  for (uint32_t i = 0; i < pNum; ++i)
+    hashes.push_back(i * 2654435761u);
+  return hashes;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+GNULDBackendTest::GNULDBackendTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+GNULDBackendTest::~GNULDBackendTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void GNULDBackendTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void GNULDBackendTest::TearDown()
+{
+  for (size_t i = 0; i < m_Sections.size(); ++i)
+    LDSection::Destroy(m_Sections[i]);
+  m_Sections.clear();
+}
+
+LDSection* GNULDBackendTest::createSection(const char* pName,
+                                           unsigned int pKind,
+                                           uint64_t pSize,
+                                           uint32_t pAlign)
+{
+  LDSection* section = LDSection::Create(pName, LDFileFormat::Kind(pKind),
+                                         0, 0, pSize);
+  section->setAlign(pAlign);
+  m_Sections.push_back(section);
+  return section;
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( GNULDBackendTest, pack_relro_by_alignment) {
+  // the sections of a rank of PT_GNU_RELRO are sorted by their alignments,
+  // stably, and .got keeps its place after them
+  LDSection* a = createSection(".data.rel.ro.a", LDFileFormat::Regular, 4, 4);
+  LDSection* b = createSection(".data.rel.ro.b", LDFileFormat::Regular, 8, 16);
+  LDSection* c = createSection(".data.rel.ro.c", LDFileFormat::Regular, 4, 4);
+  LDSection* d = createSection(".data.rel.ro.d", LDFileFormat::Regular, 8, 8);
+  LDSection* got = createSection(".got", LDFileFormat::Target, 8, 32);
+
+  SHOList list;
+  list.push_back(std::make_pair(a, DataPagePacker::SHO_RELRO));
+  list.push_back(std::make_pair(b, DataPagePacker::SHO_RELRO));
+  list.push_back(std::make_pair(c, DataPagePacker::SHO_RELRO));
+  list.push_back(std::make_pair(d, DataPagePacker::SHO_RELRO));
+  list.push_back(std::make_pair(got, DataPagePacker::SHO_RELRO_LAST));
+  DataPagePacker::Pack(list, PageSize);
+
+  ASSERT_EQ(5u, list.size());
+  ASSERT_TRUE(b == list[0].first);
+  ASSERT_TRUE(d == list[1].first);
+  ASSERT_TRUE(a == list[2].first);
+  ASSERT_TRUE(c == list[3].first);
+  ASSERT_TRUE(got == list[4].first);
+}
+
+TEST_F( GNULDBackendTest, pack_small_data_last) {
+  // the regular .data sections smaller than a page go to the end of their
+  // rank, sorted by their alignments. The large ones keep their order.
+  LDSection* small1 = createSection(".data.s1", LDFileFormat::Regular, 16, 4);
+  LDSection* large1 = createSection(".data.l1", LDFileFormat::Regular,
+                                    PageSize, 4);
+  LDSection* small2 = createSection(".data.s2", LDFileFormat::Regular, 16, 8);
+  LDSection* target = createSection(".data.t", LDFileFormat::Target, 16, 4);
+  LDSection* large2 = createSection(".data.l2", LDFileFormat::Regular,
+                                    2 * PageSize, 16);
+  LDSection* bss = createSection(".bss", LDFileFormat::BSS, 16, 32);
+
+  SHOList list;
+  list.push_back(std::make_pair(small1, DataPagePacker::SHO_DATA));
+  list.push_back(std::make_pair(large1, DataPagePacker::SHO_DATA));
+  list.push_back(std::make_pair(small2, DataPagePacker::SHO_DATA));
+  list.push_back(std::make_pair(target, DataPagePacker::SHO_DATA));
+  list.push_back(std::make_pair(large2, DataPagePacker::SHO_DATA));
+  list.push_back(std::make_pair(bss, DataPagePacker::SHO_BSS));
+  DataPagePacker::Pack(list, PageSize);
+
+  ASSERT_EQ(6u, list.size());
+  ASSERT_TRUE(large1 == list[0].first);
+  ASSERT_TRUE(target == list[1].first);
+  ASSERT_TRUE(large2 == list[2].first);
+  ASSERT_TRUE(small2 == list[3].first);
+  ASSERT_TRUE(small1 == list[4].first);
+  ASSERT_TRUE(bss == list[5].first);
+}
+
+TEST_F( GNULDBackendTest, pack_keeps_ranks) {
+  // the sections never move across ranks, and the ranks other than
+  // PT_GNU_RELRO and .data keep their order
+  LDSection* text1 = createSection(".text.1", LDFileFormat::Regular, 4, 4);
+  LDSection* text2 = createSection(".text.2", LDFileFormat::Regular, 4, 64);
+  LDSection* relro = createSection(".data.rel.ro", LDFileFormat::Regular,
+                                   4, 4);
+  LDSection* data = createSection(".data", LDFileFormat::Regular, 4, 64);
+
+  SHOList list;
+  list.push_back(std::make_pair(text1, DataPagePacker::SHO_TEXT));
+  list.push_back(std::make_pair(text2, DataPagePacker::SHO_TEXT));
+  list.push_back(std::make_pair(relro, DataPagePacker::SHO_RELRO));
+  list.push_back(std::make_pair(data, DataPagePacker::SHO_DATA));
+  DataPagePacker::Pack(list, PageSize);
+
+  ASSERT_EQ(4u, list.size());
+  ASSERT_TRUE(text1 == list[0].first);
+  ASSERT_TRUE(text2 == list[1].first);
+  ASSERT_TRUE(relro == list[2].first);
+  ASSERT_TRUE(data == list[3].first);
+  for (size_t i = 1; i < list.size(); ++i)
+    ASSERT_TRUE(list[i - 1].second <= list[i].second);
+}
+
+
+TEST_F( GNULDBackendTest, bloom_empty) {
+  // without hashes, the size gold chooses is kept
+  std::vector<uint32_t> hashes;
+  uint32_t maskbitslog2 = 0, shift2 = 0;
+  BloomChooser::Choose(hashes, 6, 6, maskbitslog2, shift2);
+  ASSERT_EQ(6u, maskbitslog2);
+  ASSERT_EQ(6u, shift2);
+}
+
+TEST_F( GNULDBackendTest, bloom_single_bit) {
+  // a zero hash sets the same bit twice with every shift, so the first
+  // filter and the first shift are taken
+  std::vector<uint32_t> hashes(1, 0x0);
+  uint32_t maskbitslog2 = 0, shift2 = 0;
+  BloomChooser::Choose(hashes, 6, 6, maskbitslog2, shift2);
+  ASSERT_EQ(6u, maskbitslog2);
+  ASSERT_EQ(6u, shift2);
+}
+
+TEST_F( GNULDBackendTest, bloom_shrinks) {
+  // a few hashes fit in half of the size gold chooses
+  std::vector<uint32_t> hashes = Hashes(4);
+  uint32_t maskbitslog2 = 0, shift2 = 0;
+  BloomChooser::Choose(hashes, 8, 5, maskbitslog2, shift2);
+  ASSERT_EQ(7u, maskbitslog2);
+  ASSERT_TRUE(shift2 >= 5 && shift2 < 32);
+}
+
+TEST_F( GNULDBackendTest, bloom_grows) {
+  // 64 hashes fill the 32 and 64 bits filters too much, so the filter of
+  // twice the size gold chooses is taken
+  std::vector<uint32_t> hashes = Hashes(64);
+  uint32_t maskbitslog2 = 0, shift2 = 0;
+  BloomChooser::Choose(hashes, 6, 5, maskbitslog2, shift2);
+  ASSERT_EQ(7u, maskbitslog2);
+  ASSERT_TRUE(shift2 >= 5 && shift2 < 32);
+}
+
+TEST_F( GNULDBackendTest, bloom_all_full) {
+  // every filter tried is full, so none is better than the smallest one
+  std::vector<uint32_t> hashes = Hashes(256);
+  uint32_t maskbitslog2 = 0, shift2 = 0;
+  BloomChooser::Choose(hashes, 6, 5, maskbitslog2, shift2);
+  ASSERT_EQ(5u, maskbitslog2);
+  ASSERT_EQ(5u, shift2);
+}
@@ -0,0 +1,50 @@
+//===- GNULDBackendTest.h -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_GNU_LDBACKEND_TEST_H
+#define MCLD_UNITTEST_GNU_LDBACKEND_TEST_H
+
+#include <gtest.h>
+#include <vector>
+
+namespace mcld {
+
+class LDSection;
+
+namespace test {
+
+class GNULDBackendTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  GNULDBackendTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~GNULDBackendTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// createSection - create a section of pKind with pSize bytes aligned to
+  /// pAlign, which is destroyed by TearDown()
+  LDSection* createSection(const char* pName, unsigned int pKind,
+                           uint64_t pSize, uint32_t pAlign);
+
+protected:
+  std::vector<LDSection*> m_Sections;
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+
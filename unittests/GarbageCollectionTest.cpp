@@ -0,0 +1,113 @@
+//===- GarbageCollectionTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/GarbageCollection.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <llvm/Support/ELF.h>
+#include "GarbageCollectionTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+const uint32_t Text = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR;
+const uint32_t Data = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_WRITE;
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+GarbageCollectionTest::GarbageCollectionTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+GarbageCollectionTest::~GarbageCollectionTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void GarbageCollectionTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void GarbageCollectionTest::TearDown()
+{
+  for (size_t i = 0; i < m_Sections.size(); ++i)
+    LDSection::Destroy(m_Sections[i]);
+  m_Sections.clear();
+}
+
+LDSection* GarbageCollectionTest::createSection(const char* pName,
+                                                unsigned int pKind,
+                                                uint32_t pFlag)
+{
+  LDSection* section = LDSection::Create(pName, LDFileFormat::Kind(pKind),
+                                         llvm::ELF::SHT_PROGBITS, pFlag);
+  m_Sections.push_back(section);
+  return section;
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( GarbageCollectionTest, removable) {
+  // code, data and LSDA can be removed if they are not reached
+  ASSERT_FALSE(GarbageCollection::isKept(
+    *createSection(".text.foo", LDFileFormat::Regular, Text)));
+  ASSERT_FALSE(GarbageCollection::isKept(
+    *createSection(".data", LDFileFormat::Regular, Data)));
+  ASSERT_FALSE(GarbageCollection::isKept(
+    *createSection(".bss.bar", LDFileFormat::BSS, Data)));
+  ASSERT_FALSE(GarbageCollection::isKept(
+    *createSection(".gcc_except_table.foo", LDFileFormat::GCCExceptTable,
+                   llvm::ELF::SHF_ALLOC)));
+}
+
+TEST_F( GarbageCollectionTest, kept_by_kind_and_flags) {
+  // the other kinds and the sections not loaded are always kept
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".eh_frame", LDFileFormat::EhFrame,
+                   llvm::ELF::SHF_ALLOC)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".note.foo", LDFileFormat::Note, llvm::ELF::SHF_ALLOC)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".debug_info", LDFileFormat::Debug, 0x0)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".comment.foo", LDFileFormat::Regular, 0x0)));
+}
+
+TEST_F( GarbageCollectionTest, kept_by_name) {
+  // the sections run by the system
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".init", LDFileFormat::Regular, Text)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".init_array.00100", LDFileFormat::Regular, Data)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".fini", LDFileFormat::Regular, Text)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".preinit_array", LDFileFormat::Regular, Data)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".ctors.65535", LDFileFormat::Regular, Data)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".dtors", LDFileFormat::Regular, Data)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection(".jcr", LDFileFormat::Regular, Data)));
+
+  // the sections which __start_ and __stop_ symbols may refer to
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection("my_section", LDFileFormat::Regular, Data)));
+  ASSERT_TRUE(GarbageCollection::isKept(
+    *createSection("_set2", LDFileFormat::Regular, Data)));
+  ASSERT_FALSE(GarbageCollection::isKept(
+    *createSection("2set", LDFileFormat::Regular, Data)));
+  ASSERT_FALSE(GarbageCollection::isKept(
+    *createSection("my-section", LDFileFormat::Regular, Data)));
+}
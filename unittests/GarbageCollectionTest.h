@@ -0,0 +1,50 @@
+//===- GarbageCollectionTest.h --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_GARBAGE_COLLECTION_TEST_H
+#define MCLD_UNITTEST_GARBAGE_COLLECTION_TEST_H
+
+#include <gtest.h>
+#include <vector>
+
+namespace mcld {
+
+class LDSection;
+
+namespace test {
+
+class GarbageCollectionTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  GarbageCollectionTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~GarbageCollectionTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// createSection - create a section of pKind with the flags pFlag, which
+  /// is destroyed by TearDown()
+  LDSection* createSection(const char* pName, unsigned int pKind,
+                           uint32_t pFlag);
+
+protected:
+  std::vector<LDSection*> m_Sections;
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+
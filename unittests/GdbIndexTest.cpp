@@ -0,0 +1,152 @@
+//===- GdbIndexTest.cpp ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/Module.h>
+#include <mcld/LD/GdbIndex.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/ThreadPool.h>
+#include "GdbIndexTest.h"
+
+#include <llvm/Support/ELF.h>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// two compile units of 11 bytes
+uint8_t DebugInfo[] = {
+  0x07, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+  0x07, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08
+};
+
+/// the global function main and the static variable counter of the first
+/// unit, and main of the second one
+uint8_t GNUPubNames[] = {
+  0x25, 0x00, 0x00, 0x00, 0x02, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00,
+  0x0b, 0x00, 0x00, 0x00, 0x30, 'm', 'a', 'i', 'n', 0x00,
+  0x10, 0x00, 0x00, 0x00, 0xa0, 'c', 'o', 'u', 'n', 't', 'e', 'r', 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x18, 0x00, 0x00, 0x00, 0x02, 0x00,
+  0x0b, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00,
+  0x0b, 0x00, 0x00, 0x00, 0x30, 'm', 'a', 'i', 'n', 0x00,
+  0x00, 0x00, 0x00, 0x00
+};
+
+uint8_t Text[16] = { 0x0 };
+
+/// AddSection - add the section pName of pData to pContext
+LDSection* AddSection(LDContext& pContext,
+                      const char* pName,
+                      LDFileFormat::Kind pKind,
+                      uint32_t pFlag,
+                      uint8_t* pData,
+                      size_t pSize)
+{
+  LDSection* section = LDSection::Create(pName, pKind,
+                                         llvm::ELF::SHT_PROGBITS, pFlag);
+  SectionData* data = IRBuilder::CreateSectionData(*section);
+  IRBuilder::AppendFragment(*IRBuilder::CreateRegion(pData, pSize), *data);
+  pContext.appendSection(*section);
+  return section;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+GdbIndexTest::GdbIndexTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+GdbIndexTest::~GdbIndexTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void GdbIndexTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void GdbIndexTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( GdbIndexTest, hash_is_case_insensitive) {
+  EXPECT_TRUE(0x0 == GdbIndex::Hash(""));
+  EXPECT_TRUE(0xfffffff0 == GdbIndex::Hash("a"));
+  EXPECT_TRUE(GdbIndex::Hash("Main") == GdbIndex::Hash("main"));
+}
+
+TEST_F( GdbIndexTest, read_and_size) {
+  LDContext context;
+  AddSection(context, ".text", LDFileFormat::Regular,
+             llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR,
+             Text, sizeof(Text));
+  AddSection(context, ".debug_info", LDFileFormat::Debug, 0x0,
+             DebugInfo, sizeof(DebugInfo));
+  AddSection(context, ".debug_gnu_pubnames", LDFileFormat::Debug, 0x0,
+             GNUPubNames, sizeof(GNUPubNames));
+  LDSection* stale = AddSection(context, ".gdb_index", LDFileFormat::Regular,
+                                0x0, Text, sizeof(Text));
+
+  Input input("a.o");
+  input.setContext(&context);
+  Module module;
+  module.getObjectList().push_back(&input);
+
+  LDSection* output = LDSection::Create(".gdb_index", LDFileFormat::MetaData,
+                                        llvm::ELF::SHT_PROGBITS, 0x0);
+  ThreadPool pool(2);
+  GdbIndex index(*output);
+  index.read(module, pool);
+  index.sizeOutput();
+
+  EXPECT_TRUE(2 == index.numOfCompileUnits());
+  EXPECT_TRUE(1 == index.numOfAddressRanges());
+  EXPECT_TRUE(2 == index.numOfSymbols());
+  EXPECT_TRUE(LDFileFormat::Ignore == stale->kind());
+
+  // header, CU list, address area, 1024 slots, and the constant pool of
+  // main (2 units) and counter (1 unit)
+  EXPECT_TRUE(24 + 2 * 16 + 20 + 1024 * 8 + (12 + 5) + (8 + 8) ==
+              output->size());
+}
+
+TEST_F( GdbIndexTest, no_debug_info) {
+  LDContext context;
+  AddSection(context, ".text", LDFileFormat::Regular,
+             llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR,
+             Text, sizeof(Text));
+
+  Input input("b.o");
+  input.setContext(&context);
+  Module module;
+  module.getObjectList().push_back(&input);
+
+  LDSection* output = LDSection::Create(".gdb_index", LDFileFormat::MetaData,
+                                        llvm::ELF::SHT_PROGBITS, 0x0);
+  ThreadPool pool(1);
+  GdbIndex index(*output);
+  index.read(module, pool);
+  index.sizeOutput();
+
+  EXPECT_TRUE(0 == index.numOfCompileUnits());
+  EXPECT_TRUE(0 == index.numOfAddressRanges());
+  EXPECT_TRUE(0 == output->size());
+}
+
@@ -0,0 +1,105 @@
+//===- GlobMatcherTest.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/GlobMatcher.h>
+#include "GlobMatcherTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+GlobMatcherTest::GlobMatcherTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+GlobMatcherTest::~GlobMatcherTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void GlobMatcherTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void GlobMatcherTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( GlobMatcherTest, empty) {
+  GlobMatcher matcher;
+  ASSERT_TRUE(matcher.empty());
+  matcher.compile();
+  ASSERT_TRUE(matcher.isCompiled());
+  ASSERT_TRUE(matcher.match("").empty());
+  ASSERT_TRUE(matcher.match(".text").empty());
+}
+
+TEST_F( GlobMatcherTest, all_ids) {
+  GlobMatcher matcher;
+  matcher.add(".text*", 0);
+  matcher.add("*.o", 1);
+  matcher.add("*", 2);
+  matcher.add(".text.hot", 3);
+  matcher.compile();
+
+  const GlobMatcher::IDList& ids = matcher.match(".text.hot");
+  ASSERT_EQ(3, ids.size());
+  ASSERT_EQ(0, ids[0]);
+  ASSERT_EQ(2, ids[1]);
+  ASSERT_EQ(3, ids[2]);
+
+  ASSERT_EQ(2, matcher.match("foo.o").size());
+  ASSERT_EQ(1, matcher.match("").size());
+  ASSERT_EQ(2, matcher.match("").front());
+}
+
+TEST_F( GlobMatcherTest, brackets) {
+  GlobMatcher matcher;
+  matcher.add("[a-c]?x", 0);
+  matcher.add("[!.]*", 1);
+  matcher.add("a[b", 2);
+  matcher.add("[]]", 3);
+  matcher.compile();
+
+  ASSERT_EQ(2, matcher.match("bzx").size());
+  ASSERT_EQ(1, matcher.match("dzx").size());
+  ASSERT_TRUE(matcher.match(".data").empty());
+  ASSERT_EQ(2, matcher.match("a[b").size());
+  ASSERT_EQ(2, matcher.match("a[b").back());
+  ASSERT_EQ(3, matcher.match("]").back());
+}
+
+TEST_F( GlobMatcherTest, stars) {
+  GlobMatcher matcher;
+  matcher.add("**foo*bar", 0);
+  matcher.compile();
+
+  ASSERT_EQ(1, matcher.match("foobar").size());
+  ASSERT_EQ(1, matcher.match("xfoozbar").size());
+  ASSERT_EQ(1, matcher.match("foobarbar").size());
+  ASSERT_TRUE(matcher.match("foobarx").empty());
+  ASSERT_TRUE(matcher.match("fobar").empty());
+}
+
+TEST_F( GlobMatcherTest, recompile) {
+  GlobMatcher matcher;
+  matcher.add(".data", 0);
+  matcher.compile();
+  ASSERT_TRUE(matcher.match(".bss").empty());
+
+  matcher.add(".bss", 1);
+  ASSERT_FALSE(matcher.isCompiled());
+  matcher.compile();
+  ASSERT_EQ(1, matcher.match(".bss").front());
+  ASSERT_EQ(0, matcher.match(".data").front());
+}
@@ -0,0 +1,97 @@
+//===- HashTableBench.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/StringHash.h>
+
+#include <benchmark/benchmark.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+typedef HashEntry<llvm::StringRef, int, StringCompare<llvm::StringRef> >
+  StringEntryType;
+
+typedef HashTable<StringEntryType,
+                  StringHash<MURMUR>,
+                  EntryFactory<StringEntryType> > StringTableType;
+
+void MakeNames(std::vector<std::string>& pNames, size_t pNum)
+{
+  pNames.clear();
+  pNames.reserve(pNum);
+  char buf[64];
+  for (size_t i = 0; i < pNum; ++i) {
+    snprintf(buf, sizeof(buf), "_ZN4mcld%zuE.text.%zu", i % 89, i);
+    pNames.push_back(buf);
+  }
+}
+
+} // anonymous namespace
+
+/// rehash a full table into twice the buckets
+static void BM_HashTableRehash(benchmark::State& pState)
+{
+  std::vector<std::string> names;
+  MakeNames(names, pState.range(0));
+  StringTableType table(names.size());
+  bool exist;
+  for (size_t i = 0; i < names.size(); ++i)
+    table.insert(names[i], exist);
+
+  size_t buckets = table.numOfBuckets();
+  while (pState.KeepRunning()) {
+    table.rehash(buckets * 2);
+    table.rehash(buckets);
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size() * 2);
+}
+BENCHMARK(BM_HashTableRehash)->RangeMultiplier(10)->Range(10000, 1000000);
+
+/// insert into a table which grows from the default size
+static void BM_HashTableGrow(benchmark::State& pState)
+{
+  std::vector<std::string> names;
+  MakeNames(names, pState.range(0));
+  while (pState.KeepRunning()) {
+    StringTableType table;
+    bool exist;
+    for (size_t i = 0; i < names.size(); ++i)
+      table.insert(names[i], exist);
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size());
+}
+BENCHMARK(BM_HashTableGrow)->RangeMultiplier(10)->Range(10000, 1000000);
+
+/// hash the names of symbols and sections by the hash function TYPE
+template<uint32_t TYPE>
+static void BM_StringHash(benchmark::State& pState)
+{
+  std::vector<std::string> names;
+  MakeNames(names, 4096);
+  StringHash<TYPE> hasher;
+  while (pState.KeepRunning()) {
+    for (size_t i = 0; i < names.size(); ++i)
+      benchmark::DoNotOptimize(hasher(names[i]));
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size());
+}
+BENCHMARK_TEMPLATE(BM_StringHash, ELF);
+BENCHMARK_TEMPLATE(BM_StringHash, DJB);
+BENCHMARK_TEMPLATE(BM_StringHash, BKDR);
+BENCHMARK_TEMPLATE(BM_StringHash, FNV);
+BENCHMARK_TEMPLATE(BM_StringHash, ES);
+BENCHMARK_TEMPLATE(BM_StringHash, MURMUR);
+
@@ -10,7 +10,11 @@
 #include "HashTableTest.h"
 #include "mcld/ADT/HashEntry.h"
 #include "mcld/ADT/HashTable.h"
+#include "mcld/ADT/StringHash.h"
 #include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 using namespace std;
 using namespace mcld;
@@ -97,7 +101,7 @@ TEST_F( HashTableTest, ptr_entry ) {
 TEST_F( HashTableTest, constructor ) {
   typedef HashEntry<int, int, IntCompare> HashEntryType;
   HashTable<HashEntryType, IntHash, EntryFactory<HashEntryType> > hashTable(16);
-  EXPECT_TRUE(17 == hashTable.numOfBuckets());
+  EXPECT_TRUE(32 == hashTable.numOfBuckets());
   EXPECT_TRUE(hashTable.empty());
   EXPECT_TRUE(0 == hashTable.numOfEntries());
 }
@@ -137,7 +141,7 @@ TEST_F( HashTableTest, alloc100 ) {
 
   EXPECT_FALSE(hashTable->empty());
   EXPECT_TRUE(100 == hashTable->numOfEntries());
-  EXPECT_TRUE(197 == hashTable->numOfBuckets());
+  EXPECT_TRUE(256 == hashTable->numOfBuckets());
   delete hashTable;
 }
 
@@ -220,7 +224,7 @@ TEST_F( HashTableTest, tombstone ) {
     entry = hashTable->insert(key, exist);
   }
   EXPECT_TRUE(100 == hashTable->numOfEntries());
-  EXPECT_TRUE(197 == hashTable->numOfBuckets());
+  EXPECT_TRUE(256 == hashTable->numOfBuckets());
 
   delete hashTable;
 }
@@ -313,7 +317,7 @@ TEST_F( HashTableTest, chain_iterator_list ) {
     entry->setValue(key);
   }
   ASSERT_TRUE(16 == hashTable->numOfEntries());
-  ASSERT_TRUE(37 == hashTable->numOfBuckets());
+  ASSERT_TRUE(32 == hashTable->numOfBuckets());
 
   unsigned int key = 0;
   int count = 0;
@@ -324,3 +328,43 @@ TEST_F( HashTableTest, chain_iterator_list ) {
   ASSERT_EQ(16, count);
   delete hashTable;
 }
+
+TEST_F( HashTableTest, murmur_string_entry ) {
+  typedef HashEntry<llvm::StringRef, int, StringCompare<llvm::StringRef> >
+                                                                 HashEntryType;
+  typedef HashTable<HashEntryType,
+                    StringHash<MURMUR>,
+                    EntryFactory<HashEntryType> > HashTableTy;
+  HashTableTy *hashTable = new HashTableTy();
+
+  // names of every tail length share the same prefix
+  std::vector<std::string> names;
+  for (int i = 0; i < 100; ++i) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "_ZN4mcld9NamePool12insertSymbolE%d", i);
+    names.push_back(buf);
+    names.push_back(names.back().substr(0, i % 17));
+  }
+
+  bool exist;
+  int count = 0;
+  for (size_t i = 0; i < names.size(); ++i) {
+    HashTableTy::entry_type* entry = hashTable->insert(names[i], exist);
+    if (!exist) {
+      entry->setValue(i);
+      ++count;
+    }
+  }
+  ASSERT_TRUE(count == (int)hashTable->numOfEntries());
+
+  StringHash<MURMUR> hash_func;
+  for (size_t i = 0; i < names.size(); ++i) {
+    HashTableTy::iterator iter = hashTable->find(names[i]);
+    ASSERT_TRUE(hashTable->end() != iter);
+    ASSERT_TRUE(names[i] == names[iter.getEntry()->value()]);
+  }
+  ASSERT_TRUE(hashTable->end() == hashTable->find("_ZN4mcld9NamePool"));
+  ASSERT_TRUE(hash_func("a") != hash_func("b"));
+  ASSERT_TRUE(hash_func("abcdefgh") != hash_func("abcdefgi"));
+  delete hashTable;
+}
@@ -0,0 +1,79 @@
+//===- IdenticalCodeFoldingTest.cpp ---------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/IdenticalCodeFolding.h>
+#include "IdenticalCodeFoldingTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+IdenticalCodeFoldingTest::IdenticalCodeFoldingTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+IdenticalCodeFoldingTest::~IdenticalCodeFoldingTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void IdenticalCodeFoldingTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void IdenticalCodeFoldingTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( IdenticalCodeFoldingTest, ctor_and_dtor) {
+  // the complete, base and allocating constructors
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooC1Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooC2Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooC3Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooC1ERKS_"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN2ns3FooC2Ei"));
+
+  // the deleting, complete and base destructors
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooD0Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooD1Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooD2Ev"));
+
+  // the members of class templates and of substitutions
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooIiEC1Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZN2ns3BarILi3EEC2Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZNSt6vectorIiSaIiEEC2Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor("_ZNSsC1EPKc"));
+}
+
+TEST_F( IdenticalCodeFoldingTest, other_names) {
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(""));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("main"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZN3Foo3barEv"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_Z3fooi"));
+
+  // not a mangled name
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("FooC1Ev"));
+
+  // the inheriting constructors and the unknown kinds are not folded
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooCI1E3Bari"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooC4Ev"));
+
+  // C1 and D1 which are parts of the names of ordinary functions
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZN2ns5FUNC1Ev"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZN3Foo5getC1Ev"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZN3Foo6pushD1Ei"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZN3FooIiE3getEv"));
+
+  // the namespace std has no constructor
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor("_ZNStC1Ev"));
+}
@@ -0,0 +1,155 @@
+//===- IncrementalLinkTest.cpp --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/IncrementalLink.h>
+#include "IncrementalLinkTest.h"
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+enum {
+  TextOffset = sizeof(llvm::ELF::Elf64_Ehdr),
+  TextSize = 64,
+  RelaOffset = TextOffset + TextSize,
+  ShdrOffset = RelaOffset + sizeof(llvm::ELF::Elf64_Rela)
+};
+
+/// BuildObject - a relocatable object of .text and .rela.text, which has a
+/// relocation at pRelocOffset of .text
+void BuildObject(std::vector<uint8_t>& pData, uint64_t pRelocOffset)
+{
+  pData.assign(ShdrOffset + 3 * sizeof(llvm::ELF::Elf64_Shdr), 0);
+
+  llvm::ELF::Elf64_Ehdr ehdr;
+  memset(&ehdr, 0, sizeof(ehdr));
+  memcpy(ehdr.e_ident, llvm::ELF::ElfMagic, 4);
+  ehdr.e_ident[llvm::ELF::EI_CLASS] = llvm::ELF::ELFCLASS64;
+  ehdr.e_ident[llvm::ELF::EI_DATA] = llvm::sys::isLittleEndianHost() ?
+                                     llvm::ELF::ELFDATA2LSB :
+                                     llvm::ELF::ELFDATA2MSB;
+  ehdr.e_type = llvm::ELF::ET_REL;
+  ehdr.e_machine = llvm::ELF::EM_X86_64;
+  ehdr.e_shoff = ShdrOffset;
+  ehdr.e_shentsize = sizeof(llvm::ELF::Elf64_Shdr);
+  ehdr.e_shnum = 3;
+  memcpy(&pData[0], &ehdr, sizeof(ehdr));
+
+  for (unsigned int i = 0; i < TextSize; ++i)
+    pData[TextOffset + i] = 0x90;
+
+  llvm::ELF::Elf64_Rela rela;
+  memset(&rela, 0, sizeof(rela));
+  rela.r_offset = pRelocOffset;
+  memcpy(&pData[RelaOffset], &rela, sizeof(rela));
+
+  llvm::ELF::Elf64_Shdr shdr[3];
+  memset(shdr, 0, sizeof(shdr));
+  shdr[1].sh_type = llvm::ELF::SHT_PROGBITS;
+  shdr[1].sh_flags = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR;
+  shdr[1].sh_offset = TextOffset;
+  shdr[1].sh_size = TextSize;
+  shdr[2].sh_type = llvm::ELF::SHT_RELA;
+  shdr[2].sh_offset = RelaOffset;
+  shdr[2].sh_size = sizeof(llvm::ELF::Elf64_Rela);
+  shdr[2].sh_info = 1;
+  shdr[2].sh_entsize = sizeof(llvm::ELF::Elf64_Rela);
+  memcpy(&pData[ShdrOffset], shdr, sizeof(shdr));
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+IncrementalLinkTest::IncrementalLinkTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+IncrementalLinkTest::~IncrementalLinkTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void IncrementalLinkTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void IncrementalLinkTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( IncrementalLinkTest, scan_windows) {
+  std::vector<uint8_t> data;
+  BuildObject(data, 20);
+
+  IncrementalLink::Shape shape;
+  ASSERT_TRUE(IncrementalLink::Scan(&data[0], data.size(), shape));
+  ASSERT_EQ(3u, shape.sections.size());
+  ASSERT_EQ(uint64_t(TextOffset), shape.sections[1].offset);
+  ASSERT_EQ(uint64_t(TextSize), shape.sections[1].size);
+  ASSERT_EQ(1u, shape.sections[1].windows.size());
+  ASSERT_EQ(20u - IncrementalLink::WindowBefore,
+            shape.sections[1].windows[0].begin);
+  ASSERT_EQ(20u + IncrementalLink::WindowAfter,
+            shape.sections[1].windows[0].end);
+  ASSERT_TRUE(shape.sections[2].windows.empty());
+}
+
+TEST_F( IncrementalLinkTest, clip_windows) {
+  std::vector<uint8_t> data;
+  BuildObject(data, 60);
+
+  IncrementalLink::Shape shape;
+  ASSERT_TRUE(IncrementalLink::Scan(&data[0], data.size(), shape));
+  ASSERT_EQ(1u, shape.sections[1].windows.size());
+  ASSERT_EQ(uint64_t(TextSize), shape.sections[1].windows[0].end);
+}
+
+TEST_F( IncrementalLinkTest, digest_of_windows) {
+  std::vector<uint8_t> data;
+  BuildObject(data, 20);
+  IncrementalLink::Shape shape;
+  ASSERT_TRUE(IncrementalLink::Scan(&data[0], data.size(), shape));
+  uint64_t digest = shape.digest;
+
+  // a byte outside the windows is not a part of the shape
+  data[TextOffset + 50] = 0xcc;
+  ASSERT_TRUE(IncrementalLink::Scan(&data[0], data.size(), shape));
+  ASSERT_EQ(digest, shape.digest);
+
+  // but a byte inside is
+  data[TextOffset + 14] = 0xcc;
+  ASSERT_TRUE(IncrementalLink::Scan(&data[0], data.size(), shape));
+  ASSERT_NE(digest, shape.digest);
+}
+
+TEST_F( IncrementalLinkTest, not_relocatable) {
+  std::vector<uint8_t> data;
+  BuildObject(data, 20);
+  IncrementalLink::Shape shape;
+
+  llvm::ELF::Elf64_Half type = llvm::ELF::ET_EXEC;
+  memcpy(&data[offsetof(llvm::ELF::Elf64_Ehdr, e_type)], &type, sizeof(type));
+  ASSERT_FALSE(IncrementalLink::Scan(&data[0], data.size(), shape));
+
+  // truncated
+  BuildObject(data, 20);
+  ASSERT_FALSE(IncrementalLink::Scan(&data[0], ShdrOffset, shape));
+}
+
@@ -179,3 +179,57 @@ TEST_F( InputTreeTest, DFSIterator_BasicTraversal)
   ASSERT_TRUE(dfs_it ==  dfs_end);
 }
 
+
+TEST_F( InputTreeTest, Freeze_PreorderAndRanges)
+{
+  // a.o ( --start-group b.o c.a{ c1.o c2.o } --end-group ) d.o
+  InputTree::iterator node = m_pTestee->root();
+  m_pTestee->insert<InputTree::Inclusive>(node,
+                                          *m_pAlloc->produce("a.o", "/"));
+  node.move<InputTree::Inclusive>();
+  m_pTestee->enterGroup<InputTree::Positional>(node);
+  node.move<InputTree::Positional>();
+  m_pTestee->insert<InputTree::Positional>(node,
+                                           *m_pAlloc->produce("d.o", "/"));
+
+  InputTree::iterator group = node;
+  m_pTestee->insert<InputTree::Inclusive>(node,
+                                          *m_pAlloc->produce("b.o", "/"));
+  node.move<InputTree::Inclusive>();
+  m_pTestee->insert<InputTree::Positional>(node,
+                                           *m_pAlloc->produce("c.a", "/"));
+  node.move<InputTree::Positional>();
+  m_pTestee->insert<InputTree::Inclusive>(node,
+                                          *m_pAlloc->produce("c1.o", "/"));
+  node.move<InputTree::Inclusive>();
+  m_pTestee->insert<InputTree::Positional>(node,
+                                           *m_pAlloc->produce("c2.o", "/"));
+
+  ASSERT_FALSE(m_pTestee->isFrozen());
+  m_pTestee->freeze();
+  ASSERT_TRUE(m_pTestee->isFrozen());
+
+  // the same order as dfs_iterator
+  const InputTree::FlatList& flat = m_pTestee->flat();
+  ASSERT_EQ(6u, flat.size());
+  InputTree::dfs_iterator dfs_it = m_pTestee->dfs_begin();
+  for (size_t i = 0; i < flat.size(); ++i, ++dfs_it)
+    ASSERT_TRUE(*dfs_it == flat[i]);
+  ASSERT_TRUE(dfs_it == m_pTestee->dfs_end());
+
+  // the group holds b.o, c.a and its members. c.a holds c1.o and c2.o.
+  const InputTree::RangeList& ranges = m_pTestee->ranges();
+  ASSERT_EQ(2u, ranges.size());
+  ASSERT_TRUE(InputTree::Range::Group == ranges[0].kind);
+  ASSERT_EQ(1u, ranges[0].begin);
+  ASSERT_EQ(5u, ranges[0].end);
+  ASSERT_TRUE(InputTree::Range::Archive == ranges[1].kind);
+  ASSERT_STREQ("c.a", flat[ranges[1].begin - 1]->name().c_str());
+  ASSERT_EQ(3u, ranges[1].begin);
+  ASSERT_EQ(5u, ranges[1].end);
+
+  // any modification thaws the tree
+  m_pTestee->insert<InputTree::Positional>(group,
+                                           *m_pAlloc->produce("e.o", "/"));
+  ASSERT_FALSE(m_pTestee->isFrozen());
+}
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "mcld/LD/LDSymbol.h"
+#include "mcld/Fragment/FillFragment.h"
 #include "LDSymbolTest.h"
 
 using namespace mcld;
@@ -40,3 +41,26 @@ void LDSymbolTest::TearDown()
 TEST_F( LDSymbolTest, produce ) {
 }
 
+TEST_F( LDSymbolTest, fragment_ref_in_place ) {
+  ResolveInfo* info = ResolveInfo::Create("a");
+  LDSymbol* sym = LDSymbol::Create(*info);
+  FillFragment* frag = new FillFragment(0x0, 1, 16);
+
+  sym->setFragmentRef(FragmentRef::Null());
+  ASSERT_FALSE(sym->hasFragRef());
+  ASSERT_TRUE(sym->fragRef()->isNull());
+
+  {
+    // the symbol keeps a copy of a temporary reference
+    FragmentRef ref;
+    ref.assign(*frag, 4);
+    sym->setFragmentRef(&ref);
+  }
+  ASSERT_TRUE(sym->hasFragRef());
+  ASSERT_EQ(frag, sym->fragRef()->frag());
+  ASSERT_TRUE(4 == sym->fragRef()->offset());
+
+  LDSymbol::Destroy(sym);
+  ResolveInfo::Destroy(info);
+  delete frag;
+}
@@ -0,0 +1,68 @@
+//===- LEB128Bench.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/LEB128.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// Encode - encode pNum values of up to pMaxBytes bytes, as .debug_info and
+/// .eh_frame hold mostly short ones
+template<typename IntType>
+void Encode(std::vector<leb128::ByteType>& pBuffer, size_t pNum,
+            unsigned int pMaxBytes)
+{
+  pBuffer.assign(pNum * 10, 0x0);
+  leb128::ByteType* ptr = &pBuffer[0];
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  for (size_t i = 0; i < pNum; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned int bits = 7 * (1 + (seed >> 60) % pMaxBytes);
+    uint64_t value = (seed >> 3) & ((1ULL << (bits - 1)) - 1);
+    if (static_cast<IntType>(-1) < 0 && (seed & 0x1))
+      leb128::encode<IntType>(ptr, -static_cast<IntType>(value));
+    else
+      leb128::encode<IntType>(ptr, static_cast<IntType>(value));
+  }
+  pBuffer.resize(ptr - &pBuffer[0]);
+}
+
+template<typename IntType>
+void DecodeAll(benchmark::State& pState, unsigned int pMaxBytes)
+{
+  const size_t num = 65536;
+  std::vector<leb128::ByteType> buffer;
+  Encode<IntType>(buffer, num, pMaxBytes);
+  while (pState.KeepRunning()) {
+    const leb128::ByteType* ptr = &buffer[0];
+    for (size_t i = 0; i < num; ++i)
+      benchmark::DoNotOptimize(leb128::decode<IntType>(ptr));
+  }
+  pState.SetItemsProcessed(pState.iterations() * num);
+  pState.SetBytesProcessed(pState.iterations() * buffer.size());
+}
+
+} // anonymous namespace
+
+static void BM_ULEB128Decode(benchmark::State& pState)
+{
+  DecodeAll<uint64_t>(pState, pState.range(0));
+}
+BENCHMARK(BM_ULEB128Decode)->Arg(1)->Arg(2)->Arg(4)->Arg(9);
+
+static void BM_SLEB128Decode(benchmark::State& pState)
+{
+  DecodeAll<int64_t>(pState, pState.range(0));
+}
+BENCHMARK(BM_SLEB128Decode)->Arg(1)->Arg(2)->Arg(4)->Arg(9);
+
@@ -530,3 +530,63 @@ TEST_F( LEB128Test, Type_Conversion_Test) {
   ASSERT_TRUE(leb128::decode<uint64_t>(p) == 154452);
   ASSERT_TRUE(p == (buffer + 3));
 }
+
+TEST_F( LEB128Test, Skip_Test) {
+  leb128::ByteType buffer[32];
+  leb128::ByteType *result = buffer;
+  // 2, 128, 2^56, 127 and ten values of 1, the 4th one ends in the 2nd word
+  leb128::encode<uint64_t>(result, 2);
+  leb128::encode<uint64_t>(result, 128);
+  leb128::encode<uint64_t>(result, static_cast<uint64_t>(1) << 56);
+  leb128::encode<uint64_t>(result, 127);
+  for (int i = 0; i < 10; ++i)
+    leb128::encode<int64_t>(result, 1);
+  ASSERT_TRUE(result == (buffer + 23));
+
+  const leb128::ByteType *end = result;
+  ASSERT_TRUE(leb128::skip(buffer, end, 0) == buffer);
+  ASSERT_TRUE(leb128::skip(buffer, end) == (buffer + 1));
+  ASSERT_TRUE(leb128::skip(buffer, end, 2) == (buffer + 3));
+  ASSERT_TRUE(leb128::skip(buffer, end, 3) == (buffer + 12));
+  ASSERT_TRUE(leb128::skip(buffer, end, 4) == (buffer + 13));
+  ASSERT_TRUE(leb128::skip(buffer, end, 10) == (buffer + 19));
+  ASSERT_TRUE(leb128::skip(buffer, end, 14) == end);
+
+  // run off the end of the buffer
+  ASSERT_TRUE(leb128::skip(buffer, end, 15) == NULL);
+  ASSERT_TRUE(leb128::skip(buffer, buffer + 11, 3) == NULL);
+}
+
+TEST_F( LEB128Test, Bulk_Decode_Test) {
+  const uint64_t values[] = { 0, 1, 127, 128, 154452, 0x7fffffff,
+                              static_cast<uint64_t>(1) << 49,
+                              (static_cast<uint64_t>(1) << 56) - 1,
+                              static_cast<uint64_t>(1) << 56,
+                              static_cast<uint64_t>(-1), 3, 624485 };
+  const size_t num = sizeof(values) / sizeof(values[0]);
+
+  leb128::ByteType buffer[128];
+  leb128::ByteType *result = buffer;
+  for (size_t i = 0; i < num; ++i)
+    leb128::encode<uint64_t>(result, values[i]);
+  const leb128::ByteType *end = result;
+
+  uint64_t decoded[num];
+  ASSERT_TRUE(leb128::decode(buffer, end, decoded, num) == end);
+  for (size_t i = 0; i < num; ++i)
+    ASSERT_EQ(values[i], decoded[i]);
+
+  // decode from every offset, so that each value is met at each position
+  // of a word and in the last bytes of the buffer
+  const leb128::ByteType *p = buffer;
+  for (size_t i = 0; i < num; ++i) {
+    ASSERT_TRUE(leb128::decode(p, end, decoded, num - i) == end);
+    for (size_t j = i; j < num; ++j)
+      ASSERT_EQ(values[j], decoded[j - i]);
+    p = leb128::skip(p, end);
+  }
+
+  // run off the end of the buffer
+  ASSERT_TRUE(leb128::decode(buffer, end, decoded, num + 1) == NULL);
+  ASSERT_TRUE(leb128::decode(buffer, end - 1, decoded, num) == NULL);
+}
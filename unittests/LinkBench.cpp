@@ -0,0 +1,156 @@
+//===- LinkBench.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// End-to-end link benchmarks of synthetic programs. The inputs are generated
+// once per benchmark by SyntheticInputs, and every iteration links them
+// through mcld::Linker. The objects are read from memory, the archives from
+// files. The wall time of each phase and the peak memory of the factories
+// are reported as counters, in milliseconds and MiB.
+//
+// BM_Link/<arch>/10000/500 is the baseline of 10k objects and 5M
+// relocations.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Environment.h>
+#include <mcld/IRBuilder.h>
+#include <mcld/Linker.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryUsage.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/TimeReport.h>
+#include "SyntheticInputs.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// WriteFile - write pImage into the file of its name
+sys::fs::Path WriteFile(const SyntheticInputs::Image& pImage)
+{
+  sys::fs::Path path("LinkBench." + pImage.name);
+  FileHandle file;
+  FileHandle::OpenMode mode =
+    FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+  FileHandle::Permission perm = 0644;
+  file.open(path, mode, perm);
+  file.write(pImage.data.data(), 0, pImage.data.size());
+  file.close();
+  return path;
+}
+
+/// LinkOnce - link the inputs, and add the wall time of the phases to
+/// pPhases
+bool LinkOnce(const SyntheticInputs& pInputs,
+              SyntheticInputs::ImageList& pObjects,
+              const std::vector<sys::fs::Path>& pArchives,
+              std::map<std::string, double>& pPhases)
+{
+  LinkerConfig config(pInputs.triple());
+  config.setCodeGenType(LinkerConfig::Exec);
+  // the spans are only recorded if a report or a trace is asked for
+  config.options().setTimeTrace("LinkBench.trace.json");
+
+  Linker linker;
+  linker.config(config);
+
+  Module module("LinkBench.out");
+  IRBuilder builder(module, config);
+  for (size_t i = 0; i < pObjects.size(); ++i) {
+    builder.ReadInput(pObjects[i].name,
+                      const_cast<char*>(pObjects[i].data.data()),
+                      pObjects[i].data.size());
+  }
+  for (size_t i = 0; i < pArchives.size(); ++i)
+    builder.ReadInput(pArchives[i].filename().native(), pArchives[i]);
+
+  bool result = linker.link(module, builder) && linker.emit("LinkBench.out");
+
+  const TimeReport* report = config.timeReport();
+  if (NULL != report) {
+    TimeReport::SpanList::const_iterator span,
+                                         spanEnd = report->spans().end();
+    for (span = report->spans().begin(); span != spanEnd; ++span) {
+      if (0 == span->thread && span->detail.empty())
+        pPhases[span->name] += (span->end - span->begin) / 1000.0;
+    }
+  }
+  return result;
+}
+
+} // anonymous namespace
+
+/// link pState.range(0) objects with pState.range(1) relocations each. One
+/// in ten objects is an archive member.
+template<SyntheticInputs::Arch ARCH>
+static void BM_Link(benchmark::State& pState)
+{
+  SyntheticInputs::Scale scale;
+  scale.numOfObjects = pState.range(0);
+  scale.numOfRelocs = pState.range(1);
+  scale.numOfSymbols = 100;
+  scale.numOfSections = 16;
+  scale.numOfArchives = (scale.numOfObjects >= 100) ? 4 : 0;
+  scale.numOfMembers = scale.numOfObjects / 40;
+
+  SyntheticInputs inputs(ARCH, scale);
+  SyntheticInputs::ImageList objects, archives;
+  inputs.generate(objects, archives);
+
+  std::vector<sys::fs::Path> archive_paths;
+  for (size_t i = 0; i < archives.size(); ++i)
+    archive_paths.push_back(WriteFile(archives[i]));
+  archives.clear();
+
+  Initialize();
+  MemoryUsage::Enable();
+
+  std::map<std::string, double> phases;
+  while (pState.KeepRunning()) {
+    if (!LinkOnce(inputs, objects, archive_paths, phases)) {
+      pState.SkipWithError("the link failed");
+      break;
+    }
+  }
+
+  double iterations = std::max<double>(pState.iterations(), 1);
+  std::map<std::string, double>::const_iterator phase, pEnd = phases.end();
+  for (phase = phases.begin(); phase != pEnd; ++phase)
+    pState.counters[phase->first + "_ms"] = phase->second / iterations;
+
+  double peak = 0.0;
+  for (int kind = 0; kind < MemoryUsage::NumOfKinds; ++kind)
+    peak += MemoryUsage::Get(static_cast<MemoryUsage::Kind>(kind)).peakBytes;
+  pState.counters["peak_MiB"] = peak / (1024.0 * 1024.0);
+  pState.SetItemsProcessed(pState.iterations() *
+                           scale.numOfObjects * scale.numOfRelocs);
+
+  MemoryUsage::Enable(false);
+  Finalize();
+}
+
+BENCHMARK_TEMPLATE(BM_Link, SyntheticInputs::X86_64)
+  ->ArgPair(100, 50)->ArgPair(1000, 500)->ArgPair(10000, 500)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Link, SyntheticInputs::ARM)
+  ->ArgPair(100, 50)->ArgPair(1000, 500)->ArgPair(10000, 500)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Link, SyntheticInputs::Mips)
+  ->ArgPair(100, 50)->ArgPair(1000, 500)->ArgPair(10000, 500)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+
@@ -0,0 +1,104 @@
+//===- LinkCacheTest.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/LinkCache.h>
+#include "LinkCacheTest.h"
+
+#include <string>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+LinkCache::Stamp MakeStamp(uint64_t pModTime, uint64_t pHashTime)
+{
+  LinkCache::Stamp stamp;
+  stamp.device = 0x801;
+  stamp.inode = 0x1234;
+  stamp.size = 4096;
+  stamp.modTime = pModTime;
+  stamp.hashTime = pHashTime;
+  stamp.hash = 0xcbf29ce484222325ULL;
+  return stamp;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+LinkCacheTest::LinkCacheTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+LinkCacheTest::~LinkCacheTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void LinkCacheTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void LinkCacheTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( LinkCacheTest, stamps_round_trip) {
+  LinkCache::StampMap stamps, result;
+  stamps["/usr/lib/libc.a"] = MakeStamp(100, 200);
+  stamps["obj dir/a.o"] = MakeStamp(300, 301);
+
+  std::string text;
+  LinkCache::PrintStamps(stamps, text);
+  LinkCache::ParseStamps(text, result);
+
+  ASSERT_EQ(2u, result.size());
+  const LinkCache::Stamp& stamp = result["obj dir/a.o"];
+  ASSERT_EQ(0x801u, stamp.device);
+  ASSERT_EQ(0x1234u, stamp.inode);
+  ASSERT_EQ(4096u, stamp.size);
+  ASSERT_EQ(300u, stamp.modTime);
+  ASSERT_EQ(301u, stamp.hashTime);
+  ASSERT_EQ(0xcbf29ce484222325ULL, stamp.hash);
+}
+
+TEST_F( LinkCacheTest, untrusted_stamps) {
+  LinkCache::StampMap stamps, result;
+  // modified in the second of hashing
+  stamps["a.o"] = MakeStamp(200, 200);
+  stamps["b.o"] = MakeStamp(199, 200);
+  // a path of a newline can not be printed
+  stamps["c\n.o"] = MakeStamp(100, 200);
+
+  std::string text;
+  LinkCache::PrintStamps(stamps, text);
+  LinkCache::ParseStamps(text, result);
+
+  ASSERT_EQ(1u, result.size());
+  ASSERT_TRUE(result.end() != result.find("b.o"));
+}
+
+TEST_F( LinkCacheTest, bad_stamps) {
+  LinkCache::StampMap result;
+  LinkCache::ParseStamps("", result);
+  ASSERT_TRUE(result.empty());
+
+  LinkCache::ParseStamps("MCLDSTP0\n1 2 3 4 5 6 a.o\n", result);
+  ASSERT_TRUE(result.empty());
+
+  // a broken line is skipped, and an unterminated line is dropped
+  LinkCache::ParseStamps("MCLDSTP2\n1 2 x 4 5 6 a.o\n1 2 3 4 5 6 b.o\n"
+                         "1 2 3 4 5 6 c.o", result);
+  ASSERT_EQ(1u, result.size());
+  ASSERT_TRUE(result.end() != result.find("b.o"));
+}
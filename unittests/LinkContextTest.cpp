@@ -0,0 +1,109 @@
+//===- LinkContextTest.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/LinkContext.h>
+#include <mcld/Support/TaskQueue.h>
+#include <mcld/Support/ThreadPool.h>
+#include "LinkContextTest.h"
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// Recorder - record the current context of the thread running index i
+struct Recorder
+{
+  std::vector<LinkContext*>* contexts;
+
+  void operator()(size_t i) { (*contexts)[i] = &LinkContext::Current(); }
+};
+
+/// ContextTask - record the current context of the thread running it
+class ContextTask : public TaskQueue::Task
+{
+public:
+  ContextTask() : context(NULL) { }
+
+  void run() { context = &LinkContext::Current(); }
+
+  LinkContext* context;
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+LinkContextTest::LinkContextTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+LinkContextTest::~LinkContextTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void LinkContextTest::SetUp()
+{
+  LinkContext::SetCurrent(NULL);
+}
+
+// TearDown() will be called immediately after each test.
+void LinkContextTest::TearDown()
+{
+  LinkContext::SetCurrent(NULL);
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( LinkContextTest, default_context) {
+  ASSERT_TRUE(NULL == LinkContext::GetCurrent());
+  LinkContext& context = LinkContext::Current();
+  ASSERT_TRUE(&context == &LinkContext::Current());
+
+  LinkContext mine;
+  mine.activate();
+  ASSERT_TRUE(&mine == LinkContext::GetCurrent());
+  ASSERT_TRUE(&mine == &LinkContext::Current());
+
+  LinkContext::SetCurrent(NULL);
+  ASSERT_TRUE(&context == &LinkContext::Current());
+}
+
+TEST_F( LinkContextTest, trace_counter) {
+  LinkContext first, second;
+  ASSERT_EQ(0u, first.nextTraceID());
+  ASSERT_EQ(1u, first.nextTraceID());
+  ASSERT_EQ(0u, second.nextTraceID());
+}
+
+TEST_F( LinkContextTest, thread_pool) {
+  LinkContext context;
+  context.activate();
+
+  ThreadPool pool(4);
+  std::vector<LinkContext*> contexts(1000, NULL);
+  Recorder body = { &contexts };
+  parallel_for(pool, 0, contexts.size(), body);
+  for (size_t i = 0; i < contexts.size(); ++i)
+    ASSERT_TRUE(&context == contexts[i]);
+}
+
+TEST_F( LinkContextTest, task_queue) {
+  LinkContext context;
+  context.activate();
+
+  ContextTask task;
+  TaskQueue queue;
+  queue.post(task);
+  queue.wait();
+  ASSERT_TRUE(&context == task.context);
+}
@@ -0,0 +1,123 @@
+//===- LinkStatsTest.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/LinkStats.h>
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include "LinkStatsTest.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+struct IntCompare
+{
+  bool operator()(int X, int Y) const
+  { return (X==Y); }
+};
+
+struct IntHash
+{
+  size_t operator()(int pKey) const
+  { return pKey; }
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+LinkStatsTest::LinkStatsTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+LinkStatsTest::~LinkStatsTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void LinkStatsTest::SetUp()
+{
+  LinkStats::Reset();
+  LinkStats::Enable();
+}
+
+// TearDown() will be called immediately after each test.
+void LinkStatsTest::TearDown()
+{
+  LinkStats::Enable(false);
+  LinkStats::Reset();
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( LinkStatsTest, add_and_set) {
+  LinkStats::Add(LinkStats::ObjectInputs);
+  LinkStats::Add(LinkStats::ObjectInputs, 2);
+  LinkStats::Set(LinkStats::GOTEntries, 7);
+  LinkStats::Set(LinkStats::GOTEntries, 5);
+
+  ASSERT_EQ(3u, LinkStats::Get(LinkStats::ObjectInputs));
+  ASSERT_EQ(5u, LinkStats::Get(LinkStats::GOTEntries));
+  ASSERT_EQ(0u, LinkStats::Get(LinkStats::PLTEntries));
+}
+
+TEST_F( LinkStatsTest, relocations_by_type) {
+  LinkStats::AddRelocation(2);
+  LinkStats::AddRelocation(2);
+  LinkStats::AddRelocation(10);
+
+  ASSERT_EQ(3u, LinkStats::Get(LinkStats::Relocations));
+  ASSERT_EQ(2u, LinkStats::GetRelocations(2));
+  ASSERT_EQ(1u, LinkStats::GetRelocations(10));
+  ASSERT_EQ(0u, LinkStats::GetRelocations(3));
+}
+
+TEST_F( LinkStatsTest, hash_table_probes) {
+  typedef HashEntry<int, int, IntCompare> HashEntryType;
+  HashTable<HashEntryType, IntHash, EntryFactory<HashEntryType> > table(0);
+
+  bool exist;
+  for (int i = 0; i < 100; ++i)
+    table.insert(i, exist);
+
+  // every insertion looks up the table once, and the table grows
+  ASSERT_EQ(100u, LinkStats::Get(LinkStats::HashLookups));
+  ASSERT_TRUE(LinkStats::Get(LinkStats::HashProbes) >= 100u);
+  ASSERT_TRUE(LinkStats::Get(LinkStats::HashMaxProbes) >= 1u);
+  ASSERT_TRUE(LinkStats::Get(LinkStats::HashRehashes) >= 1u);
+}
+
+TEST_F( LinkStatsTest, disabled) {
+  LinkStats::Enable(false);
+  typedef HashEntry<int, int, IntCompare> HashEntryType;
+  HashTable<HashEntryType, IntHash, EntryFactory<HashEntryType> > table(0);
+
+  bool exist;
+  table.insert(1, exist);
+  ASSERT_EQ(0u, LinkStats::Get(LinkStats::HashLookups));
+}
+
+TEST_F( LinkStatsTest, print) {
+  LinkStats::Add(LinkStats::SymbolsInserted, 42);
+  LinkStats::AddRelocation(4);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  LinkStats::Print(os, NULL);
+  os.flush();
+
+  ASSERT_NE(std::string::npos, text.find("Symbol Resolution:\n"));
+  ASSERT_NE(std::string::npos, text.find("42  symbols inserted\n"));
+  ASSERT_NE(std::string::npos, text.find("1  type 4\n"));
+}
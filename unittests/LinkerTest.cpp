@@ -466,3 +466,53 @@ TEST_F( LinkerTest, plasma_object) {
 
   Finalize();
 }
+
+// This testcase links two modules with the same configured Linker. The
+// target and the backend are kept by Linker::clear, and the symbols and the
+// relocations of the first module must be gone in the second link.
+TEST_F( LinkerTest, plasma_twice_clear) {
+
+  Initialize();
+  Linker linker;
+
+  ///< --mtriple="armv7-none-linux-gnueabi"
+  LinkerConfig config("armv7-none-linux-gnueabi");
+
+  /// -L=${TOPDIR}/test/libs/ARM/Android/android-14
+  Path search_dir(TOPDIR);
+  search_dir.append("test/libs/ARM/Android/android-14");
+  config.options().directories().insert(search_dir);
+
+  linker.config(config);
+
+  config.setCodeGenType(LinkerConfig::DynObj);  ///< --shared
+
+  Path crtbegin(search_dir);
+  crtbegin.append("crtbegin_so.o");
+  Path plasma(TOPDIR);
+  plasma.append("test/Android/Plasma/ARM/plasma.o");
+  Path crtend(search_dir);
+  crtend.append("crtend_so.o");
+
+  const char* names[2] = { "libplasma.clear1.so", "libplasma.clear2.so" };
+  for (int i = 0; i < 2; ++i) {
+    config.options().setSOName(names[i]);
+    config.options().setBsymbolic(0 != i);
+
+    Module module(names[i]);
+    IRBuilder builder(module, config);
+    builder.ReadInput("crtbegin", crtbegin);
+    builder.ReadInput("plasma", plasma);
+    builder.ReadInput("m");
+    builder.ReadInput("log");
+    builder.ReadInput("jnigraphics");
+    builder.ReadInput("c");
+    builder.ReadInput("crtend", crtend);
+
+    ASSERT_TRUE(linker.link(module, builder));
+    ASSERT_TRUE(linker.emit(names[i]));
+    ASSERT_TRUE(linker.clear());
+  }
+
+  Finalize();
+}
@@ -0,0 +1,107 @@
+//===- MemoryAreaBench.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/Path.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+const size_t FileSize = 16 * 1024 * 1024;
+
+/// GetFile - create the input file of the benchmarks once
+const sys::fs::Path& GetFile()
+{
+  static sys::fs::Path path("MemoryAreaBench.data");
+  static bool created = false;
+  if (!created) {
+    std::vector<char> data(FileSize, 0x5a);
+    FileHandle file;
+    FileHandle::OpenMode mode =
+      FileHandle::WriteOnly | FileHandle::Create | FileHandle::Truncate;
+    FileHandle::Permission perm = 0644;
+    file.open(path, mode, perm);
+    file.write(&data[0], 0, data.size());
+    file.close();
+    created = true;
+  }
+  return path;
+}
+
+/// RequestAll - request and release pNum regions of pLength bytes at
+/// pOffsets
+void RequestAll(benchmark::State& pState,
+                const std::vector<size_t>& pOffsets,
+                size_t pLength,
+                bool pMapWholeFile)
+{
+  FileHandle file;
+  file.open(GetFile(), FileHandle::ReadOnly);
+  while (pState.KeepRunning()) {
+    MemoryArea area(file);
+    if (pMapWholeFile)
+      area.mapWholeFile();
+    for (size_t i = 0; i < pOffsets.size(); ++i) {
+      MemoryRegion* region = area.request(pOffsets[i], pLength);
+      benchmark::DoNotOptimize(region->getBuffer()[0]);
+      area.release(region);
+    }
+    area.clear();
+  }
+  file.close();
+  pState.SetItemsProcessed(pState.iterations() * pOffsets.size());
+  pState.SetBytesProcessed(pState.iterations() * pOffsets.size() * pLength);
+}
+
+} // anonymous namespace
+
+/// request the section headers one by one, as the readers do
+static void BM_MemoryAreaSequential(benchmark::State& pState)
+{
+  size_t length = pState.range(0);
+  std::vector<size_t> offsets;
+  for (size_t offset = 0; offset + length <= FileSize; offset += length)
+    offsets.push_back(offset);
+  RequestAll(pState, offsets, length, pState.range(1));
+}
+BENCHMARK(BM_MemoryAreaSequential)->ArgPair(64, 0)->ArgPair(64, 1)
+                                  ->ArgPair(4096, 0)->ArgPair(4096, 1);
+
+/// request the sections of archive members at random, as the archive reader
+/// does
+static void BM_MemoryAreaRandom(benchmark::State& pState)
+{
+  size_t length = pState.range(0);
+  std::vector<size_t> offsets;
+  srand(1);
+  for (size_t i = 0; i < 4096; ++i)
+    offsets.push_back((static_cast<size_t>(rand()) * 4099) %
+                      (FileSize - length));
+  RequestAll(pState, offsets, length, pState.range(1));
+}
+BENCHMARK(BM_MemoryAreaRandom)->ArgPair(64, 0)->ArgPair(64, 1)
+                              ->ArgPair(65536, 0)->ArgPair(65536, 1);
+
+/// request the same region again and again, as the readers do with the
+/// string tables
+static void BM_MemoryAreaRepeated(benchmark::State& pState)
+{
+  size_t length = pState.range(0);
+  std::vector<size_t> offsets(4096, 8192);
+  RequestAll(pState, offsets, length, pState.range(1));
+}
+BENCHMARK(BM_MemoryAreaRepeated)->ArgPair(4096, 0)->ArgPair(4096, 1);
+
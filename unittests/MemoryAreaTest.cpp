@@ -12,15 +12,37 @@
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MemoryAreaFactory.h>
 #include <mcld/Support/Path.h>
+#include <mcld/Support/Space.h>
+#include <mcld/Support/ThreadPool.h>
 
 #include "MemoryAreaTest.h"
 #include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cstdio>
+#include <vector>
 
 using namespace mcld;
 using namespace mcld::sys::fs;
 using namespace mcldtest;
 
+namespace {
+
+/// Preloader - preload the i-th range of an area. The ranges overlap, and
+/// every range is given twice.
+struct Preloader
+{
+	MemoryArea* area;
+	std::vector<Space*>* spaces;
+
+	static size_t offset(size_t pIdx) { return (pIdx / 2) * 80; }
+	static size_t length() { return 100; }
+
+	void operator()(size_t pIdx)
+	{ (*spaces)[pIdx] = area->preload(offset(pIdx), length()); }
+};
+
+} // anonymous namespace
 
 // Constructor can do set-up work for all test here.
 MemoryAreaTest::MemoryAreaTest()
@@ -163,3 +185,229 @@ TEST_F( MemoryAreaTest, write_sync )
 }
 
 
+
+TEST_F( MemoryAreaTest, overlapped_spaces )
+{
+	Path path(TOPDIR) ;
+	path.append("unittests/test3.txt") ;
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1) ;
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadOnly) ;
+	ASSERT_TRUE(area->handler()->isOpened()) ;
+	ASSERT_TRUE(area->handler()->isGood()) ;
+
+	// a small space is allocated, and then a mapped space covers it.
+	MemoryRegion* region1 = area->request(6000, 100) ;
+	MemoryRegion* region2 = area->request(100, 7000) ;
+	ASSERT_TRUE(region1->parent() != region2->parent()) ;
+
+	// the small space only overlaps the range, the mapped one contains it.
+	MemoryRegion* region3 = area->request(6050, 500) ;
+	ASSERT_TRUE(region3->parent() == region2->parent()) ;
+	ASSERT_EQ(region1->getBuffer()[50], region3->getBuffer()[0]) ;
+	ASSERT_EQ(region2->getBuffer()[5950], region3->getBuffer()[0]) ;
+
+	// a range crossing the end of all spaces gets a new space.
+	MemoryRegion* region4 = area->request(8000, 2000) ;
+	ASSERT_TRUE(region4->parent() != region2->parent()) ;
+	ASSERT_TRUE(region4->parent()->start() <= 8000) ;
+	ASSERT_TRUE(8000 + 2000 <=
+	            region4->parent()->start() + region4->parent()->size()) ;
+
+	area->release(region1);
+	area->release(region2);
+	area->release(region3);
+	area->release(region4);
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, map_whole_file )
+{
+	Path path(TOPDIR) ;
+	path.append("unittests/test3.txt") ;
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1) ;
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadOnly) ;
+	ASSERT_TRUE(area->handler()->isOpened()) ;
+	ASSERT_TRUE(area->mapWholeFile()) ;
+	ASSERT_TRUE(area->isWholeFileMapped()) ;
+
+	// all regions are slices of the same space.
+	MemoryRegion* region1 = area->request(0, 100) ;
+	MemoryRegion* region2 = area->request(6000, 100) ;
+	ASSERT_TRUE(region1->parent() == region2->parent()) ;
+	ASSERT_EQ(area->handler()->size(), region1->parent()->size()) ;
+
+	// the whole file space is kept after all regions are released.
+	Space* whole = region1->parent() ;
+	area->release(region1);
+	area->release(region2);
+	MemoryRegion* region3 = area->request(10, 10) ;
+	ASSERT_TRUE(whole == region3->parent()) ;
+	area->release(region3);
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, write_without_mapping )
+{
+	Path path(TOPDIR) ;
+	path.append("unittests/test2.txt") ;
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1) ;
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadWrite) ;
+	ASSERT_TRUE(area->handler()->isOpened()) ;
+	area->setMapping(false) ;
+	ASSERT_FALSE(area->isMapping()) ;
+
+	// a page is read into the dynamic memory and written back on release.
+	MemoryRegion* region = area->request(0, 4096) ;
+	ASSERT_EQ(Space::ALLOCATED_ARRAY, region->parent()->type()) ;
+	region->getBuffer()[4000] = 'K' ;
+	region->getBuffer()[4001] = 'R' ;
+	area->release(region);
+	area->clear();
+	area->handler()->close();
+
+	area->handler()->open(path, FileHandle::ReadOnly);
+	region = area->request(4000, 4);
+	ASSERT_EQ('K', region->getBuffer()[0]);
+	ASSERT_EQ('R', region->getBuffer()[1]);
+	area->clear();
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, view )
+{
+	Path path(TOPDIR) ;
+	path.append("unittests/test3.txt") ;
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1) ;
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadOnly) ;
+	ASSERT_TRUE(area->handler()->isOpened()) ;
+
+	// a view outlives the regions of the same range.
+	MemoryView view1 = area->view(3, 2) ;
+	MemoryRegion* region = area->request(3, 2) ;
+	area->release(region);
+	ASSERT_EQ(2, view1.size()) ;
+	ASSERT_EQ('L', view1.getBuffer()[0]) ;
+	ASSERT_EQ('O', view1.getBuffer()[1]) ;
+
+	// a view into the whole mapped file is a slice of it.
+	area->clear();
+	ASSERT_TRUE(area->mapWholeFile()) ;
+	region = area->request(0, 100) ;
+	MemoryView view2 = area->view(3, 2) ;
+	ASSERT_TRUE(region->start() + 3 == view2.start()) ;
+	ASSERT_EQ('L', view2.getBuffer()[0]) ;
+	area->release(region);
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, same_file_by_another_path )
+{
+	Path path(TOPDIR) ;
+	path.append("unittests/test3.txt") ;
+	Path link(TOPDIR) ;
+	link.append("unittests/test3.lnk") ;
+	::unlink(link.c_str());
+	ASSERT_EQ(0, ::symlink(path.c_str(), link.c_str())) ;
+
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1) ;
+	MemoryArea* area1 = AreaFactory->produce(path, FileHandle::ReadOnly) ;
+	MemoryArea* area2 = AreaFactory->produce(link, FileHandle::ReadOnly) ;
+	::unlink(link.c_str());
+	ASSERT_TRUE(area1->handler()->isOpened()) ;
+	ASSERT_TRUE(area1 == area2) ;
+
+	AreaFactory->destruct(area1);
+}
+
+TEST_F( MemoryAreaTest, open_files_concurrently )
+{
+	std::vector<Path> paths;
+	const char* names[] = { "unittests/test.txt", "unittests/test2.txt",
+	                        "unittests/test3.txt", "unittests/no_such_file",
+	                        "unittests/test.txt" };
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+		paths.push_back(Path(TOPDIR));
+		paths.back().append(names[i]);
+	}
+
+	ThreadPool pool(4);
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(8) ;
+	AreaFactory->open(pool, paths, FileHandle::ReadOnly);
+
+	// produce() gets the opened files, and a path given twice is opened once
+	MemoryArea* area1 = AreaFactory->produce(paths[0], FileHandle::ReadOnly) ;
+	MemoryArea* area3 = AreaFactory->produce(paths[2], FileHandle::ReadOnly) ;
+	MemoryArea* area5 = AreaFactory->produce(paths[4], FileHandle::ReadOnly) ;
+	ASSERT_TRUE(area1->handler()->isOpened()) ;
+	ASSERT_TRUE(area3->handler()->isOpened()) ;
+	ASSERT_TRUE(area1 == area5) ;
+	ASSERT_TRUE(area1 != area3) ;
+
+	// a missing file is left to produce()
+	MemoryArea* area4 = AreaFactory->produce(paths[3], FileHandle::ReadOnly) ;
+	ASSERT_FALSE(area4->handler()->isGood()) ;
+
+	delete AreaFactory;
+}
+
+TEST_F( MemoryAreaTest, preload_concurrently )
+{
+	Path path(TOPDIR);
+	path.append("unittests/test3.txt");
+
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	ASSERT_TRUE(NULL != file);
+	std::vector<char> content(10710);
+	size_t read = std::fread(&content[0], 1, content.size(), file);
+	ASSERT_EQ(content.size(), read);
+	std::fclose(file);
+
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1);
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadOnly);
+
+	const size_t num = 200;
+	std::vector<Space*> spaces(num, NULL);
+	Preloader preloader = { area, &spaces };
+	ThreadPool pool(4);
+	parallel_for(pool, 0, num, preloader);
+
+	// every range is held by a space with the content of the file
+	for (size_t i = 0; i < num; ++i) {
+		size_t offset = Preloader::offset(i);
+		ASSERT_TRUE(NULL != spaces[i]);
+		ASSERT_TRUE(spaces[i]->start() <= offset);
+		ASSERT_TRUE(spaces[i]->start() + spaces[i]->size() >=
+		            offset + Preloader::length());
+		const char* data =
+		  reinterpret_cast<const char*>(spaces[i]->memory()) +
+		  (offset - spaces[i]->start());
+		ASSERT_TRUE(std::equal(data, data + Preloader::length(),
+		                       &content[offset]));
+	}
+
+	// the following requests are served by the preloaded spaces
+	MemoryRegion* region = area->request(Preloader::offset(num - 1),
+	                                     Preloader::length());
+	ASSERT_TRUE(std::equal(region->getBuffer(),
+	                       region->getBuffer() + Preloader::length(),
+	                       &content[Preloader::offset(num - 1)]));
+	area->release(region);
+
+	// a range out of the file is left to request()
+	ASSERT_TRUE(NULL == area->preload(content.size() - 10, 100));
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, size_of_memory_input )
+{
+	char buffer[] = "!<arch>\n";
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1) ;
+	MemoryArea* area = AreaFactory->produce(buffer, 8) ;
+	ASSERT_FALSE(area->hasHandler()) ;
+	ASSERT_EQ(8, area->size()) ;
+
+	MemoryView view = area->view(0, 8) ;
+	ASSERT_EQ('!', view.getBuffer()[0]) ;
+	ASSERT_EQ('\n', view.getBuffer()[7]) ;
+	AreaFactory->destruct(area);
+}
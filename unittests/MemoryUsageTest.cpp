@@ -0,0 +1,137 @@
+//===- MemoryUsageTest.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/MemoryUsage.h>
+#include <mcld/Support/Arena.h>
+#include <mcld/Support/GCFactory.h>
+#include "MemoryUsageTest.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+MemoryUsageTest::MemoryUsageTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+MemoryUsageTest::~MemoryUsageTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void MemoryUsageTest::SetUp()
+{
+  MemoryUsage::Enable();
+}
+
+// TearDown() will be called immediately after each test.
+void MemoryUsageTest::TearDown()
+{
+  MemoryUsage::Enable(false);
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( MemoryUsageTest, count_gc_factory) {
+  MemoryUsage::Counter before = MemoryUsage::Get(MemoryUsage::GCFactories);
+  {
+    GCFactory<int, 4> factory;
+    for (int i = 0; i < 5; ++i)
+      factory.allocate();
+
+    // 5 objects in 2 chunks
+    MemoryUsage::Counter live = MemoryUsage::Get(MemoryUsage::GCFactories);
+    ASSERT_EQ(before.objects + 5, live.objects);
+    ASSERT_TRUE(live.bytes >= before.bytes + 2 * 4 * sizeof(int));
+    ASSERT_TRUE(live.peakBytes >= live.bytes);
+    ASSERT_TRUE(live.peakObjects >= live.objects);
+  }
+
+  // the factory releases its chunks at destruction
+  MemoryUsage::Counter after = MemoryUsage::Get(MemoryUsage::GCFactories);
+  ASSERT_EQ(before.objects, after.objects);
+  ASSERT_EQ(before.bytes, after.bytes);
+  ASSERT_TRUE(after.peakBytes >= before.bytes + 2 * 4 * sizeof(int));
+}
+
+TEST_F( MemoryUsageTest, count_arena) {
+  MemoryUsage::Counter before = MemoryUsage::Get(MemoryUsage::Fragments);
+  {
+    Arena arena(MemoryUsage::Fragments);
+    char* first = static_cast<char*>(arena.allocate(3));
+    char* second = static_cast<char*>(arena.allocate(16));
+    ASSERT_TRUE(first + 8 == second);
+
+    // a large object has a slab of its own
+    char* large = static_cast<char*>(arena.allocate(1024 * 1024));
+    ASSERT_TRUE(NULL != large);
+    char* third = static_cast<char*>(arena.allocate(8));
+    ASSERT_TRUE(second + 16 == third);
+    ASSERT_EQ(2u, arena.numOfSlabs());
+
+    MemoryUsage::Counter live = MemoryUsage::Get(MemoryUsage::Fragments);
+    ASSERT_EQ(before.objects + 4, live.objects);
+    ASSERT_EQ(before.bytes + arena.bytes(), live.bytes);
+
+    // all slabs are freed at once
+    arena.release();
+    ASSERT_EQ(0u, arena.numOfSlabs());
+    live = MemoryUsage::Get(MemoryUsage::Fragments);
+    ASSERT_EQ(before.objects, live.objects);
+    ASSERT_EQ(before.bytes, live.bytes);
+
+    ASSERT_TRUE(NULL != arena.allocate(8));
+  }
+
+  MemoryUsage::Counter after = MemoryUsage::Get(MemoryUsage::Fragments);
+  ASSERT_EQ(before.objects, after.objects);
+  ASSERT_EQ(before.bytes, after.bytes);
+}
+
+TEST_F( MemoryUsageTest, disabled) {
+  MemoryUsage::Enable(false);
+  MemoryUsage::Counter before = MemoryUsage::Get(MemoryUsage::GCFactories);
+  {
+    GCFactory<int, 4> factory;
+    factory.allocate();
+    MemoryUsage::Counter live = MemoryUsage::Get(MemoryUsage::GCFactories);
+    ASSERT_EQ(before.objects, live.objects);
+    ASSERT_EQ(before.bytes, live.bytes);
+  }
+}
+
+TEST_F( MemoryUsageTest, never_below_zero) {
+  MemoryUsage::Counter before = MemoryUsage::Get(MemoryUsage::MappedSpaces);
+  MemoryUsage::Release(MemoryUsage::MappedSpaces, before.bytes + 100);
+  MemoryUsage::RemoveObjects(MemoryUsage::MappedSpaces, before.objects + 1);
+  MemoryUsage::Counter after = MemoryUsage::Get(MemoryUsage::MappedSpaces);
+  ASSERT_EQ(0u, after.bytes);
+  ASSERT_EQ(0u, after.objects);
+  ASSERT_EQ(before.peakBytes, after.peakBytes);
+}
+
+TEST_F( MemoryUsageTest, print) {
+  MemoryUsage::Allocate(MemoryUsage::Regions, 1024 * 1024);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  MemoryUsage::PrintSummary(os, "normalize");
+  MemoryUsage::Print(os);
+  os.flush();
+
+  ASSERT_NE(std::string::npos, text.find("memory usage after normalize"));
+  ASSERT_NE(std::string::npos, text.find("RegionFactory\n"));
+  ASSERT_NE(std::string::npos, text.find("Total (sum of peaks)\n"));
+  MemoryUsage::Release(MemoryUsage::Regions, 1024 * 1024);
+}
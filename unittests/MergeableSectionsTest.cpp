@@ -0,0 +1,79 @@
+//===- MergeableSectionsTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/MergeableSections.h>
+#include "MergeableSectionsTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+MergeableSectionsTest::MergeableSectionsTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+MergeableSectionsTest::~MergeableSectionsTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void MergeableSectionsTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void MergeableSectionsTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( MergeableSectionsTest, split_strings) {
+  const uint8_t data[] = "foo\0bar\0\0";
+  MergeableSections::PieceList pieces;
+  ASSERT_TRUE(MergeableSections::Split(data, 9, 1, true, pieces));
+  ASSERT_EQ(3u, pieces.size());
+  ASSERT_EQ(0u, pieces[0].offset);
+  ASSERT_EQ(4u, pieces[0].size);
+  ASSERT_EQ(4u, pieces[1].offset);
+  ASSERT_EQ(4u, pieces[1].size);
+  ASSERT_EQ(8u, pieces[2].offset);
+  ASSERT_EQ(1u, pieces[2].size);
+}
+
+TEST_F( MergeableSectionsTest, split_wide_strings) {
+  // a character of two bytes ends the string only if both are zeros
+  const uint8_t data[] = { 'a', 0, 0, 'b', 0, 0, 'c', 0, 0, 0 };
+  MergeableSections::PieceList pieces;
+  ASSERT_TRUE(MergeableSections::Split(data, 10, 2, true, pieces));
+  ASSERT_EQ(2u, pieces.size());
+  ASSERT_EQ(6u, pieces[0].size);
+  ASSERT_EQ(6u, pieces[1].offset);
+  ASSERT_EQ(4u, pieces[1].size);
+}
+
+TEST_F( MergeableSectionsTest, split_unterminated) {
+  const uint8_t data[] = "foo\0bar";
+  MergeableSections::PieceList pieces;
+  ASSERT_FALSE(MergeableSections::Split(data, 7, 1, true, pieces));
+  ASSERT_FALSE(MergeableSections::Split(data, 7, 2, false, pieces));
+}
+
+TEST_F( MergeableSectionsTest, split_entries) {
+  const uint8_t data[] = { 1, 2, 3, 4, 1, 2, 3, 4, 5, 6, 7, 8 };
+  MergeableSections::PieceList pieces;
+  ASSERT_TRUE(MergeableSections::Split(data, 12, 4, false, pieces));
+  ASSERT_EQ(3u, pieces.size());
+  ASSERT_EQ(8u, pieces[2].offset);
+  ASSERT_EQ(4u, pieces[2].size);
+  ASSERT_TRUE(pieces[0].hash == pieces[1].hash);
+  ASSERT_FALSE(pieces[0].hash == pieces[2].hash);
+}
+
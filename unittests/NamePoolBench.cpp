@@ -0,0 +1,120 @@
+//===- NamePoolBench.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/NamePool.h>
+#include <mcld/LD/Resolver.h>
+#include <mcld/LD/ResolveInfo.h>
+
+#include <benchmark/benchmark.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// MakeNames - make pNum mangled names which share long prefixes, as the
+/// symbols of C++ inputs do
+void MakeNames(std::vector<std::string>& pNames, size_t pNum,
+               const char* pPrefix = "_ZN4mcld6detail")
+{
+  pNames.clear();
+  pNames.reserve(pNum);
+  char buf[64];
+  for (size_t i = 0; i < pNum; ++i) {
+    snprintf(buf, sizeof(buf), "%s%zuE%zuv", pPrefix, i % 97, i);
+    pNames.push_back(buf);
+  }
+}
+
+void InsertAll(NamePool& pPool, const std::vector<std::string>& pNames)
+{
+  Resolver::Result result;
+  for (size_t i = 0; i < pNames.size(); ++i) {
+    pPool.insertSymbol(pNames[i], false, ResolveInfo::Function,
+                       ResolveInfo::Define, ResolveInfo::Global, 0,
+                       ResolveInfo::Default, NULL, result);
+  }
+}
+
+} // anonymous namespace
+
+/// insert the symbols into a pool which grows from its default size
+static void BM_NamePoolInsert(benchmark::State& pState)
+{
+  std::vector<std::string> names;
+  MakeNames(names, pState.range(0));
+  while (pState.KeepRunning()) {
+    NamePool pool;
+    InsertAll(pool, names);
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size());
+}
+BENCHMARK(BM_NamePoolInsert)->RangeMultiplier(10)->Range(10000, 1000000);
+
+/// insert the symbols into a pool sized for them
+static void BM_NamePoolInsertReserved(benchmark::State& pState)
+{
+  std::vector<std::string> names;
+  MakeNames(names, pState.range(0));
+  while (pState.KeepRunning()) {
+    NamePool pool(names.size());
+    InsertAll(pool, names);
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size());
+}
+BENCHMARK(BM_NamePoolInsertReserved)->RangeMultiplier(10)->Range(10000, 1000000);
+
+/// insert every symbol twice, so the second insertions are resolved
+static void BM_NamePoolResolve(benchmark::State& pState)
+{
+  std::vector<std::string> names;
+  MakeNames(names, pState.range(0));
+  while (pState.KeepRunning()) {
+    NamePool pool(names.size());
+    InsertAll(pool, names);
+    InsertAll(pool, names);
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size() * 2);
+}
+BENCHMARK(BM_NamePoolResolve)->RangeMultiplier(10)->Range(10000, 1000000);
+
+/// look up the symbols in the pool
+static void BM_NamePoolLookupHit(benchmark::State& pState)
+{
+  std::vector<std::string> names;
+  MakeNames(names, pState.range(0));
+  NamePool pool(names.size());
+  InsertAll(pool, names);
+  while (pState.KeepRunning()) {
+    for (size_t i = 0; i < names.size(); ++i)
+      benchmark::DoNotOptimize(pool.findInfo(names[i]));
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size());
+}
+BENCHMARK(BM_NamePoolLookupHit)->RangeMultiplier(10)->Range(10000, 1000000);
+
+/// look up the names which are not in the pool, as the armap lookups do
+static void BM_NamePoolLookupMiss(benchmark::State& pState)
+{
+  std::vector<std::string> names, misses;
+  MakeNames(names, pState.range(0));
+  MakeNames(misses, pState.range(0), "_ZN4mcld7missing");
+  NamePool pool(names.size());
+  InsertAll(pool, names);
+  while (pState.KeepRunning()) {
+    for (size_t i = 0; i < misses.size(); ++i)
+      benchmark::DoNotOptimize(pool.findInfo(misses[i]));
+  }
+  pState.SetItemsProcessed(pState.iterations() * misses.size());
+}
+BENCHMARK(BM_NamePoolLookupMiss)->RangeMultiplier(10)->Range(10000, 1000000);
+
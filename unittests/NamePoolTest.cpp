@@ -11,6 +11,7 @@
 #include <mcld/LD/Resolver.h>
 #include <mcld/LD/StaticResolver.h>
 #include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/ResolveInfoFactory.h>
 #include <mcld/LD/LDSymbol.h>
 #include <llvm/ADT/StringRef.h>
 #include <string>
@@ -0,0 +1,165 @@
+//===- ObjectSummaryTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ObjectSummary.h>
+#include "ObjectSummaryTest.h"
+
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
+#include <string>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// MakeTables - .text, .rela.text and .eh_frame, two symbols, two relocations
+/// and the CIE, the FDE and the terminator of .eh_frame
+void MakeTables(ObjectSummary::Tables& pTables)
+{
+  ObjectSummary::Section null_sect, text, rela, eh_frame;
+  memset(&null_sect, 0, sizeof(null_sect));
+  pTables.sections.push_back(null_sect);
+
+  memset(&text, 0, sizeof(text));
+  text.name = pTables.addName(".text");
+  text.type = llvm::ELF::SHT_PROGBITS;
+  text.flags = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR;
+  text.addralign = 16;
+  text.offset = 0x40;
+  text.size = 0x20;
+  pTables.sections.push_back(text);
+
+  memset(&rela, 0, sizeof(rela));
+  rela.name = pTables.addName(".rela.text");
+  rela.type = llvm::ELF::SHT_RELA;
+  rela.info = 1;
+  rela.num = 2;
+  pTables.sections.push_back(rela);
+
+  memset(&eh_frame, 0, sizeof(eh_frame));
+  eh_frame.name = pTables.addName(".eh_frame");
+  eh_frame.type = llvm::ELF::SHT_PROGBITS;
+  eh_frame.num = 3;
+  pTables.sections.push_back(eh_frame);
+
+  ObjectSummary::Symbol null_sym, local, global;
+  memset(&null_sym, 0, sizeof(null_sym));
+  pTables.symbols.push_back(null_sym);
+
+  memset(&local, 0, sizeof(local));
+  local.name = pTables.addName(".Ltmp0");
+  local.shndx = 1;
+  local.value = 0x8;
+  pTables.symbols.push_back(local);
+
+  memset(&global, 0, sizeof(global));
+  global.name = pTables.addName("main");
+  global.info = (llvm::ELF::STB_GLOBAL << 4) | llvm::ELF::STT_FUNC;
+  global.shndx = 1;
+  global.size = 0x20;
+  pTables.symbols.push_back(global);
+
+  ObjectSummary::Reloc first = { 0x4, -4, 2, 2 };
+  ObjectSummary::Reloc second = { 0x10, 8, 10, 1 };
+  pTables.relocs.push_back(first);
+  pTables.relocs.push_back(second);
+
+  ObjectSummary::EhFrameEntry cie = { 0x0, 0x18, 8, 0, 0x1b, 0 };
+  ObjectSummary::EhFrameEntry fde = { 0x18, 0x20, 8, 1, 0, 0 };
+  ObjectSummary::EhFrameEntry term = { 0x38, 0x4, 4, 2, 0, 0 };
+  pTables.eh_entries.push_back(cie);
+  pTables.eh_entries.push_back(fde);
+  pTables.eh_entries.push_back(term);
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+ObjectSummaryTest::ObjectSummaryTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ObjectSummaryTest::~ObjectSummaryTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void ObjectSummaryTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ObjectSummaryTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ObjectSummaryTest, round_trip) {
+  ObjectSummary::Tables tables;
+  MakeTables(tables);
+
+  std::string image;
+  ObjectSummary::emit(tables, 4096, 0x0123456789abcdefULL, image);
+
+  ObjectSummary summary;
+  ASSERT_TRUE(summary.map(image.data(), image.size()));
+  ASSERT_EQ(4096u, summary.getFileSize());
+  ASSERT_TRUE(0x0123456789abcdefULL == summary.getHash());
+
+  ASSERT_EQ(4u, summary.numOfSections());
+  ASSERT_TRUE(0 == strcmp("", summary.getName(summary.getSection(0).name)));
+  const ObjectSummary::Section& text = summary.getSection(1);
+  ASSERT_TRUE(0 == strcmp(".text", summary.getName(text.name)));
+  ASSERT_EQ(16u, text.addralign);
+  ASSERT_EQ(0x40u, text.offset);
+  ASSERT_EQ(0x20u, text.size);
+
+  ASSERT_EQ(3u, summary.numOfSymbols());
+  ASSERT_TRUE(0 == strcmp("main", summary.getName(summary.getSymbol(2).name)));
+  ASSERT_EQ(0x20u, summary.getSymbol(2).size);
+  ASSERT_EQ(0x8u, summary.getSymbol(1).value);
+
+  const ObjectSummary::Reloc* relocs = summary.getRelocs(2);
+  ASSERT_EQ(2u, summary.getSection(2).num);
+  ASSERT_EQ(0x4u, relocs[0].offset);
+  ASSERT_EQ(-4, relocs[0].addend);
+  ASSERT_EQ(2u, relocs[0].symbol);
+  ASSERT_EQ(10u, relocs[1].type);
+
+  const ObjectSummary::EhFrameEntry* entries = summary.getEhFrameEntries(3);
+  ASSERT_EQ(3u, summary.getSection(3).num);
+  ASSERT_EQ(0x1b, entries[0].fde_encoding);
+  ASSERT_EQ(0x18u, entries[1].offset);
+  ASSERT_EQ(4u, entries[2].size);
+}
+
+TEST_F( ObjectSummaryTest, broken_images) {
+  ObjectSummary::Tables tables;
+  MakeTables(tables);
+
+  std::string image;
+  ObjectSummary::emit(tables, 4096, 1234, image);
+
+  ObjectSummary summary;
+  // truncated
+  ASSERT_FALSE(summary.map(image.data(), image.size() / 2));
+  // bad magic
+  std::string bad(image);
+  bad[0] = 'X';
+  ASSERT_FALSE(summary.map(bad.data(), bad.size()));
+
+  // the entries of a section out of the relocations
+  tables.sections[2].num = 3;
+  ObjectSummary::emit(tables, 4096, 1234, image);
+  ASSERT_FALSE(summary.map(image.data(), image.size()));
+}
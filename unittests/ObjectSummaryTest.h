@@ -0,0 +1,37 @@
+//===- ObjectSummaryTest.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_OBJECT_SUMMARY_TEST_H
+#define MCLD_UNITTEST_OBJECT_SUMMARY_TEST_H
+
+#include <gtest.h>
+
+namespace mcld {
+namespace test {
+
+class ObjectSummaryTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  ObjectSummaryTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~ObjectSummaryTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,91 @@
+//===- OutputRelrSectionTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Target/OutputRelrSection.h>
+#include "OutputRelrSectionTest.h"
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+OutputRelrSectionTest::OutputRelrSectionTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+OutputRelrSectionTest::~OutputRelrSectionTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void OutputRelrSectionTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void OutputRelrSectionTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( OutputRelrSectionTest, encode_empty) {
+  std::vector<uint64_t> places;
+  OutputRelrSection::EntryList entries;
+  OutputRelrSection::Encode(places, 4, entries);
+  ASSERT_TRUE(entries.empty());
+}
+
+TEST_F( OutputRelrSectionTest, encode_bitmap) {
+  // an address entry, and one bitmap of the next 31 words
+  std::vector<uint64_t> places;
+  places.push_back(0x1000);
+  places.push_back(0x1004);
+  places.push_back(0x1010);
+  places.push_back(0x107c);
+
+  OutputRelrSection::EntryList entries;
+  OutputRelrSection::Encode(places, 4, entries);
+  ASSERT_EQ(2u, entries.size());
+  ASSERT_EQ(0x1000u, entries[0]);
+  uint64_t bitmap = (0x1 << 0) | (0x1 << 3) | (0x1u << 30);
+  ASSERT_EQ((bitmap << 1) | 0x1, entries[1]);
+}
+
+TEST_F( OutputRelrSectionTest, encode_far) {
+  // the places out of the bitmap start a new address entry
+  std::vector<uint64_t> places;
+  places.push_back(0x1000);
+  places.push_back(0x1004);
+  places.push_back(0x2000);
+
+  OutputRelrSection::EntryList entries;
+  OutputRelrSection::Encode(places, 4, entries);
+  ASSERT_EQ(3u, entries.size());
+  ASSERT_EQ(0x1000u, entries[0]);
+  ASSERT_EQ(0x3u, entries[1]);
+  ASSERT_EQ(0x2000u, entries[2]);
+}
+
+TEST_F( OutputRelrSectionTest, encode_64) {
+  // a 64-bit bitmap covers 63 words
+  std::vector<uint64_t> places;
+  for (uint64_t i = 0; i < 65; ++i)
+    places.push_back(0x10000 + i * 8);
+
+  OutputRelrSection::EntryList entries;
+  OutputRelrSection::Encode(places, 8, entries);
+  ASSERT_EQ(3u, entries.size());
+  ASSERT_EQ(0x10000u, entries[0]);
+  ASSERT_EQ(~(uint64_t)0x0, entries[1]);
+  ASSERT_EQ(0x3u, entries[2]);
+}
+
@@ -0,0 +1,142 @@
+//===- PackedRelocDataTest.cpp --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/PackedRelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include "PackedRelocDataTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+uint8_t Data[1024] = { 0x0 };
+
+/// helper_symbol - a symbol of type pType
+LDSymbol* helper_symbol(const char* pName, ResolveInfo::Type pType)
+{
+  ResolveInfo* info = ResolveInfo::Create(pName);
+  info->setType(pType);
+  LDSymbol* sym = LDSymbol::Create(*info);
+  info->setSymPtr(sym);
+  return sym;
+}
+
+/// helper_entry - a decoded relocation entry
+IRBuilder::RelocEntry helper_entry(Relocation::Type pType, LDSymbol* pSymbol,
+                                   uint32_t pOffset,
+                                   Relocation::Address pAddend)
+{
+  IRBuilder::RelocEntry entry;
+  entry.type = pType;
+  entry.symbol = pSymbol;
+  entry.offset = pOffset;
+  entry.addend = pAddend;
+  return entry;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+PackedRelocDataTest::PackedRelocDataTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+PackedRelocDataTest::~PackedRelocDataTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void PackedRelocDataTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void PackedRelocDataTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( PackedRelocDataTest, pack_and_decode_blocks) {
+  Fragment* frag = IRBuilder::CreateRegion(Data, sizeof(Data));
+  LDSymbol* syms[3] = { helper_symbol("a", ResolveInfo::Section),
+                        helper_symbol("b", ResolveInfo::Object),
+                        helper_symbol("c", ResolveInfo::Function) };
+
+  // the offsets go back once in a while, and the addends are signed
+  PackedRelocData::EntryList entries;
+  for (uint32_t i = 0; i < 150; ++i) {
+    uint32_t offset = (0 == i % 10) ? i : 4 * i;
+    Relocation::Address addend = (0 == i % 3) ? -static_cast<int64_t>(i) : i;
+    entries.push_back(helper_entry((i % 2) ? 10 : 1, syms[i % 3], offset,
+                                   addend));
+  }
+
+  PackedRelocData packed(*frag);
+  ASSERT_TRUE(packed.pack(entries));
+  EXPECT_TRUE(150 == packed.size());
+  EXPECT_TRUE(3 == packed.numOfBlocks());
+  EXPECT_TRUE(frag == &packed.target());
+  EXPECT_TRUE(packed.memory() < 150 * sizeof(IRBuilder::RelocEntry));
+
+  PackedRelocData::EntryList block;
+  size_t idx = 0;
+  for (size_t b = 0; b < packed.numOfBlocks(); ++b) {
+    packed.decode(b, block);
+    EXPECT_TRUE((2 == b ? 22 : 64) == block.size());
+    for (size_t i = 0; i < block.size(); ++i, ++idx) {
+      EXPECT_TRUE(entries[idx].type == block[i].type);
+      EXPECT_TRUE(entries[idx].symbol == block[i].symbol);
+      EXPECT_TRUE(entries[idx].offset == block[i].offset);
+      EXPECT_TRUE(entries[idx].addend == block[i].addend);
+    }
+  }
+  EXPECT_TRUE(150 == idx);
+}
+
+TEST_F( PackedRelocDataTest, out_of_target) {
+  Fragment* frag = IRBuilder::CreateRegion(Data, 16);
+  LDSymbol* sym = helper_symbol("d", ResolveInfo::Object);
+
+  PackedRelocData::EntryList entries;
+  entries.push_back(helper_entry(1, sym, 8, 0));
+  entries.push_back(helper_entry(1, sym, 32, 0));
+
+  PackedRelocData packed(*frag);
+  EXPECT_FALSE(packed.pack(entries));
+  EXPECT_TRUE(packed.empty());
+  EXPECT_TRUE(0 == packed.numOfBlocks());
+}
+
+TEST_F( PackedRelocDataTest, drop_discarded_section) {
+  Fragment* frag = IRBuilder::CreateRegion(Data, sizeof(Data));
+  LDSymbol* kept = helper_symbol("e", ResolveInfo::Object);
+  LDSymbol* discarded = helper_symbol("f", ResolveInfo::Section);
+  discarded->resolveInfo()->setDesc(ResolveInfo::Undefined);
+
+  PackedRelocData::EntryList entries;
+  entries.push_back(helper_entry(1, kept, 0, 0));
+  entries.push_back(helper_entry(1, discarded, 8, 0));
+  entries.push_back(helper_entry(1, kept, 16, 4));
+
+  PackedRelocData packed(*frag);
+  ASSERT_TRUE(packed.pack(entries));
+  EXPECT_TRUE(2 == packed.size());
+
+  PackedRelocData::EntryList block;
+  packed.decode(0, block);
+  ASSERT_TRUE(2 == block.size());
+  EXPECT_TRUE(16 == block[1].offset);
+  EXPECT_TRUE(4 == block[1].addend);
+}
+
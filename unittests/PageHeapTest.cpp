@@ -0,0 +1,95 @@
+//===- PageHeapTest.cpp ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/PageHeap.h>
+#include <mcld/Support/Arena.h>
+#include <mcld/Support/GCFactory.h>
+#include "PageHeapTest.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cstring>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+PageHeapTest::PageHeapTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+PageHeapTest::~PageHeapTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void PageHeapTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void PageHeapTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( PageHeapTest, allocate_and_write) {
+  char* small = static_cast<char*>(PageHeap::allocate(100));
+  char* large = static_cast<char*>(PageHeap::allocate(PageHeap::RegionSize));
+  ASSERT_TRUE(NULL != small);
+  ASSERT_TRUE(NULL != large);
+  memset(small, 0xa5, 100);
+  memset(large, 0x5a, PageHeap::RegionSize);
+  ASSERT_EQ(0xa5, static_cast<unsigned char>(small[99]));
+  ASSERT_EQ(0x5a, static_cast<unsigned char>(large[PageHeap::RegionSize - 1]));
+
+  if (PageHeap::isHugePage()) {
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(small) % 64);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(large) % PageHeap::HugePageSize);
+  }
+
+  PageHeap::deallocate(small, 100);
+  PageHeap::deallocate(large, PageHeap::RegionSize);
+}
+
+TEST_F( PageHeapTest, reuse_freed_block) {
+  void* block = PageHeap::allocate(4096);
+  PageHeap::deallocate(block, 4096);
+  void* again = PageHeap::allocate(4096);
+  if (PageHeap::isHugePage())
+    ASSERT_TRUE(block == again);
+  PageHeap::deallocate(again, 4096);
+}
+
+TEST_F( PageHeapTest, large_block_region) {
+  if (!PageHeap::isHugePage())
+    return;
+
+  size_t before = PageHeap::numOfRegions();
+  void* large = PageHeap::allocate(PageHeap::RegionSize / 2);
+  ASSERT_EQ(before + 1, PageHeap::numOfRegions());
+  PageHeap::deallocate(large, PageHeap::RegionSize / 2);
+  ASSERT_EQ(before, PageHeap::numOfRegions());
+}
+
+TEST_F( PageHeapTest, clients) {
+  GCFactory<int, 4> factory;
+  for (int i = 0; i < 9; ++i)
+    *factory.allocate() = i;
+  ASSERT_EQ(9u, factory.size());
+
+  Arena arena(MemoryUsage::Fragments);
+  for (int i = 0; i < 100; ++i)
+    memset(arena.allocate(1024), i, 1024);
+  ASSERT_TRUE(arena.numOfSlabs() >= 2);
+  arena.release();
+  ASSERT_EQ(0u, arena.numOfSlabs());
+}
@@ -8,7 +8,10 @@
 //===----------------------------------------------------------------------===//
 #include "PathTest.h"
 #include "mcld/Support/FileSystem.h"
+#include "mcld/Support/RealPath.h"
+#include <cstdio>
 #include <string>
+#include <unistd.h>
 
 //
 using namespace mcld;
@@ -165,3 +168,44 @@ TEST_F(PathTest, filename) {
   m_pTestee->assign("aa");
   EXPECT_STREQ("aa", m_pTestee->filename().c_str());
 }
+
+TEST_F(PathTest, cached_status) {
+  char name[64];
+  snprintf(name, sizeof(name), "/tmp/mcld-path-cache-%d", (int)getpid());
+  m_pTestee->assign(name);
+  remove(name);
+
+  FileStatus status;
+  cached::status(*m_pTestee, status);
+  EXPECT_FALSE(exists(status));
+
+  // the cache does not see the new file until it is forgotten
+  FILE* file = fopen(name, "w");
+  ASSERT_TRUE(NULL != file);
+  fclose(file);
+  cached::status(*m_pTestee, status);
+  EXPECT_FALSE(exists(status));
+
+  cached::forget(*m_pTestee);
+  cached::status(*m_pTestee, status);
+  EXPECT_TRUE(status.type() == RegularFile);
+
+  FileID cached_id, id;
+  cached::file_id(*m_pTestee, cached_id);
+  detail::file_id(*m_pTestee, id);
+  EXPECT_TRUE(cached_id.isValid());
+  EXPECT_TRUE(cached_id == id);
+
+  remove(name);
+  cached::clear();
+}
+
+TEST_F(PathTest, cached_canonical) {
+  m_pTestee->assign("/aa/./bb//cc/../dd");
+  Path result;
+  cached::canonical(*m_pTestee, result);
+  EXPECT_STREQ("/aa/bb/dd", result.c_str());
+
+  RealPath real(*m_pTestee);
+  EXPECT_STREQ("/aa/bb/dd", real.c_str());
+}
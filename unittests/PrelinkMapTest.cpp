@@ -0,0 +1,71 @@
+//===- PrelinkMapTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/PrelinkMap.h>
+#include "PrelinkMapTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+PrelinkMapTest::PrelinkMapTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+PrelinkMapTest::~PrelinkMapTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void PrelinkMapTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void PrelinkMapTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( PrelinkMapTest, parse_empty) {
+  PrelinkMap map;
+  size_t bad_line = 0;
+  ASSERT_TRUE(map.parse("", bad_line));
+  ASSERT_TRUE(map.parse("\n  \n# libc.so 0x1000\n", bad_line));
+  ASSERT_TRUE(map.empty());
+  ASSERT_TRUE(PrelinkMap::NotFound == map.getBase("libc.so"));
+}
+
+TEST_F( PrelinkMapTest, parse_libraries) {
+  PrelinkMap map;
+  size_t bad_line = 0;
+  ASSERT_TRUE(map.parse("libc.so 0xafd00000\n"
+                        "\tlibm.so\t0xafc00000 # math\r\n"
+                        "liblog.so   2952790016\n"
+                        "libc.so 0xafe00000\n", bad_line));
+  ASSERT_EQ(3u, map.numOfLibraries());
+  ASSERT_TRUE(0xafe00000ull == map.getBase("libc.so"));
+  ASSERT_TRUE(0xafc00000ull == map.getBase("libm.so"));
+  ASSERT_TRUE(0xb0000000ull == map.getBase("liblog.so"));
+  ASSERT_TRUE(PrelinkMap::NotFound == map.getBase("libz.so"));
+}
+
+TEST_F( PrelinkMapTest, parse_bad_lines) {
+  size_t bad_line = 0;
+  PrelinkMap map1;
+  ASSERT_FALSE(map1.parse("libc.so 0xafd00000\nlibm.so\n", bad_line));
+  ASSERT_EQ(2u, bad_line);
+
+  PrelinkMap map2;
+  ASSERT_FALSE(map2.parse("\nlibc.so base\n", bad_line));
+  ASSERT_EQ(2u, bad_line);
+}
+
@@ -0,0 +1,302 @@
+//===- RelocBench.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Relocation throughput benchmarks of each backend. Every iteration links a
+// relocation set through mcld::Linker, and the wall time of the
+// scanRelocations and applyRelocations phases is reported in milliseconds and
+// in millions of relocations per second. The sets are the synthetic programs
+// of SyntheticInputs for x86-32, x86-64, ARM, Thumb, Mips and Hexagon, and
+// the recorded objects checked into unittests/.
+//
+// The MD5 digest of the output of the first iteration is compared with the
+// golden digest of the benchmark in unittests/RelocBench.golden, and a
+// benchmark whose output differs fails. A benchmark without a golden digest
+// records its own. Run
+//
+//   MCLD_UPDATE_GOLDEN=1 mcld-bench --benchmark_filter=BM_Reloc
+//
+// to record the digests again after a change of the output is intended.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Environment.h>
+#include <mcld/IRBuilder.h>
+#include <mcld/Linker.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Digest.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/TimeReport.h>
+#include "SyntheticInputs.h"
+
+#include <llvm/ADT/StringExtras.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+const char* OutputFile = "RelocBench.out";
+
+/// GoldenPath - the file of the golden digests
+sys::fs::Path GoldenPath()
+{
+  sys::fs::Path path(TOPDIR);
+  path.append("unittests/RelocBench.golden");
+  return path;
+}
+
+/// ReadFile - read the file pPath into pData
+bool ReadFile(const std::string& pPath, std::string& pData)
+{
+  std::ifstream file(pPath.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    return false;
+  pData.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  return true;
+}
+
+/// OutputDigest - the MD5 digest of the output in hex
+std::string OutputDigest()
+{
+  std::string data;
+  if (!ReadFile(OutputFile, data))
+    return std::string();
+
+  std::vector<uint8_t> result(digest::size(digest::MD5));
+  digest::hash(digest::MD5, reinterpret_cast<const uint8_t*>(data.data()),
+               data.size(), &result[0]);
+
+  std::string hex;
+  char buf[3];
+  for (size_t i = 0; i < result.size(); ++i) {
+    snprintf(buf, sizeof(buf), "%02x", result[i]);
+    hex.append(buf);
+  }
+  return hex;
+}
+
+/// CheckGolden - compare pDigest with the golden digest of pName. The golden
+/// digest is recorded if there is none, or if MCLD_UPDATE_GOLDEN is set.
+/// @return false if the digests differ
+bool CheckGolden(const std::string& pName, const std::string& pDigest)
+{
+  // the lines are `<benchmark> <digest>', and `#' starts a comment
+  std::string content;
+  ReadFile(GoldenPath().native(), content);
+
+  std::vector<std::string> lines;
+  std::istringstream in(content);
+  std::string line, golden;
+  while (std::getline(in, line)) {
+    std::string::size_type space = line.find(' ');
+    if (!line.empty() && '#' != line[0] && std::string::npos != space &&
+        pName == line.substr(0, space)) {
+      golden = line.substr(space + 1);
+      continue;
+    }
+    lines.push_back(line);
+  }
+
+  if (!golden.empty() && NULL == getenv("MCLD_UPDATE_GOLDEN"))
+    return (golden == pDigest);
+
+  lines.push_back(pName + " " + pDigest);
+  std::ofstream out(GoldenPath().native().c_str(),
+                    std::ios::out | std::ios::trunc);
+  for (size_t i = 0; i < lines.size(); ++i)
+    out << lines[i] << '\n';
+  return true;
+}
+
+/// NumOfRelocations - the relocations of the objects of pModule
+size_t NumOfRelocations(const Module& pModule)
+{
+  size_t num = 0;
+  Module::const_obj_iterator input, iEnd = pModule.obj_end();
+  for (input = pModule.obj_begin(); input != iEnd; ++input) {
+    const LDContext* context = (*input)->context();
+    LDContext::const_sect_iterator rs, rsEnd = context->relocSectEnd();
+    for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (NULL != (*rs)->getRelocData())
+        num += (*rs)->getRelocData()->size();
+    }
+  }
+  return num;
+}
+
+/// LinkOnce - link pObjects into an executable, and add the wall time of
+/// the relocation phases to pPhases
+bool LinkOnce(const char* pTriple,
+              SyntheticInputs::ImageList& pObjects,
+              std::map<std::string, double>& pPhases,
+              size_t& pNumOfRelocs)
+{
+  LinkerConfig config(pTriple);
+  config.setCodeGenType(LinkerConfig::Exec);
+  // the spans are only recorded if a report or a trace is asked for
+  config.options().setTimeTrace("RelocBench.trace.json");
+
+  Linker linker;
+  linker.config(config);
+
+  Module module(OutputFile);
+  IRBuilder builder(module, config);
+  for (size_t i = 0; i < pObjects.size(); ++i) {
+    builder.ReadInput(pObjects[i].name,
+                      const_cast<char*>(pObjects[i].data.data()),
+                      pObjects[i].data.size());
+  }
+
+  if (!linker.link(module, builder) || !linker.emit(OutputFile))
+    return false;
+  pNumOfRelocs = NumOfRelocations(module);
+
+  const TimeReport* report = config.timeReport();
+  if (NULL != report) {
+    TimeReport::SpanList::const_iterator span,
+                                         spanEnd = report->spans().end();
+    for (span = report->spans().begin(); span != spanEnd; ++span) {
+      if (0 == span->thread && span->detail.empty() &&
+          ("scanRelocations" == span->name ||
+           "applyRelocations" == span->name))
+        pPhases[span->name] += (span->end - span->begin) / 1000.0;
+    }
+  }
+  return true;
+}
+
+/// RunLinks - link pObjects in every iteration of pState, verify the output
+/// against the golden digest of pName and report the throughput of the
+/// relocation phases
+void RunLinks(benchmark::State& pState,
+              const std::string& pName,
+              const char* pTriple,
+              SyntheticInputs::ImageList& pObjects)
+{
+  Initialize();
+
+  std::map<std::string, double> phases;
+  size_t num_of_relocs = 0;
+  bool checked = false;
+  while (pState.KeepRunning()) {
+    if (!LinkOnce(pTriple, pObjects, phases, num_of_relocs)) {
+      pState.SkipWithError("the link failed");
+      break;
+    }
+    if (!checked) {
+      pState.PauseTiming();
+      checked = true;
+      if (!CheckGolden(pName, OutputDigest())) {
+        pState.SkipWithError("the output differs from the golden output");
+        pState.ResumeTiming();
+        break;
+      }
+      pState.ResumeTiming();
+    }
+  }
+
+  double iterations = std::max<double>(pState.iterations(), 1);
+  double scan = phases["scanRelocations"] / iterations;
+  double apply = phases["applyRelocations"] / iterations;
+  pState.counters["scan_ms"] = scan;
+  pState.counters["apply_ms"] = apply;
+  // relocations per millisecond are thousands per second
+  if (scan > 0.0)
+    pState.counters["scan_Mrelocs/s"] = num_of_relocs / scan / 1000.0;
+  if (apply > 0.0)
+    pState.counters["apply_Mrelocs/s"] = num_of_relocs / apply / 1000.0;
+  pState.SetItemsProcessed(pState.iterations() * num_of_relocs);
+
+  Finalize();
+}
+
+} // anonymous namespace
+
+/// link pState.range(0) synthetic objects with pState.range(1) relocations
+/// each
+template<SyntheticInputs::Arch ARCH>
+static void BM_Reloc(benchmark::State& pState)
+{
+  SyntheticInputs::Scale scale;
+  scale.numOfObjects = pState.range(0);
+  scale.numOfRelocs = pState.range(1);
+  scale.numOfSymbols = 100;
+  scale.numOfSections = 16;
+  scale.numOfArchives = 0;
+  scale.numOfMembers = 0;
+
+  SyntheticInputs inputs(ARCH, scale);
+  SyntheticInputs::ImageList objects, archives;
+  inputs.generate(objects, archives);
+
+  std::string name("synthetic/");
+  name += SyntheticInputs::getName(ARCH);
+  name += "/" + llvm::utostr(scale.numOfObjects);
+  name += "/" + llvm::utostr(scale.numOfRelocs);
+  RunLinks(pState, name, inputs.triple(), objects);
+}
+
+/// link the recorded object unittests/test_x86_64.o, whose undefined
+/// reference to puts is resolved by a stub
+static void BM_RelocRecorded_x86_64(benchmark::State& pState)
+{
+  SyntheticInputs::Scale scale = { 1, 1, 0, 1, 0, 0 };
+  SyntheticInputs inputs(SyntheticInputs::X86_64, scale);
+
+  SyntheticInputs::ImageList objects(2);
+  sys::fs::Path path(TOPDIR);
+  path.append("unittests/test_x86_64.o");
+  objects[0].name = "test_x86_64.o";
+  if (!ReadFile(path.native(), objects[0].data)) {
+    pState.SkipWithError("cannot read unittests/test_x86_64.o");
+    return;
+  }
+  objects[1].name = "stubs.o";
+  inputs.createStubs(std::vector<std::string>(1, "puts"), objects[1].data);
+
+  RunLinks(pState, "recorded/test_x86_64.o", inputs.triple(), objects);
+}
+
+BENCHMARK_TEMPLATE(BM_Reloc, SyntheticInputs::X86_32)
+  ->ArgPair(100, 1000)->ArgPair(1000, 5000)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Reloc, SyntheticInputs::X86_64)
+  ->ArgPair(100, 1000)->ArgPair(1000, 5000)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Reloc, SyntheticInputs::ARM)
+  ->ArgPair(100, 1000)->ArgPair(1000, 5000)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Reloc, SyntheticInputs::Thumb)
+  ->ArgPair(100, 1000)->ArgPair(1000, 5000)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Reloc, SyntheticInputs::Mips)
+  ->ArgPair(100, 1000)->ArgPair(1000, 5000)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Reloc, SyntheticInputs::Hexagon)
+  ->ArgPair(100, 1000)->ArgPair(1000, 5000)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_RelocRecorded_x86_64)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,70 @@
+//===- SectionAtomTest.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/SectionAtom.h>
+#include "SectionAtomTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+SectionAtomTest::SectionAtomTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SectionAtomTest::~SectionAtomTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SectionAtomTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SectionAtomTest::TearDown()
+{
+}
+
+TEST_F( SectionAtomTest, predefined) {
+  const SectionAtom& text = SectionAtom::Intern(".text");
+  ASSERT_TRUE(text.is(SectionAtom::Text));
+  ASSERT_TRUE(&text == &SectionAtom::Get(SectionAtom::Text));
+  ASSERT_TRUE(".text" == text.name());
+
+  ASSERT_TRUE(SectionAtom::Intern("").is(SectionAtom::Null));
+  ASSERT_TRUE(SectionAtom::Intern(".note.gnu.build-id").is(
+                                            SectionAtom::NoteGNUBuildID));
+  ASSERT_TRUE(SectionAtom::Intern(".shstrtab").is(SectionAtom::ShStrTab));
+}
+
+TEST_F( SectionAtomTest, intern) {
+  ASSERT_TRUE(NULL == SectionAtom::Find(".text.SectionAtomTest"));
+
+  const SectionAtom& atom = SectionAtom::Intern(".text.SectionAtomTest");
+  ASSERT_TRUE(atom.id() >= (SectionAtom::ID)SectionAtom::NumOfPredefined);
+  ASSERT_TRUE(&atom == SectionAtom::Find(".text.SectionAtomTest"));
+
+  std::string name(".text.");
+  name += "SectionAtomTest";
+  ASSERT_TRUE(&atom == &SectionAtom::Intern(name));
+  ASSERT_FALSE(&atom == &SectionAtom::Intern(".text.SectionAtomTest2"));
+}
+
+TEST_F( SectionAtomTest, section) {
+  LDSection* foo = LDSection::Create(".data.SectionAtomTest",
+                                     LDFileFormat::Regular, 0x1, 0x3);
+  LDSection* bar = LDSection::Create(".data.SectionAtomTest",
+                                     LDFileFormat::Regular, 0x1, 0x3);
+  ASSERT_TRUE(&foo->atom() == &bar->atom());
+  ASSERT_TRUE(&foo->name() == &bar->name());
+  LDSection::Destroy(foo);
+  LDSection::Destroy(bar);
+}
@@ -9,6 +9,8 @@
 #include "SectionDataTest.h"
 
 #include <mcld/LD/SectionData.h>
+#include <mcld/LD/FragmentIndex.h>
+#include <mcld/Fragment/FillFragment.h>
 #include <mcld/LD/LDFileFormat.h>
 #include <mcld/LD/LDSection.h>
 
@@ -79,3 +81,36 @@ TEST_F( SectionDataTest, Fragment_list_and_iterator ) {
 
   LDSection::Destroy(test);
 }
+
+TEST_F( SectionDataTest, fragment_index ) {
+  LDSection* test = LDSection::Create("test", LDFileFormat::Regular, 0, 0);
+  SectionData* s = SectionData::Create(*test);
+
+  FillFragment* a = new FillFragment(0x0, 1, 16, s);
+  FillFragment* b = new FillFragment(0x0, 1, 0, s);
+  FillFragment* c = new FillFragment(0x0, 1, 8, s);
+
+  FragmentIndex index(*s);
+  ASSERT_TRUE(3 == index.size());
+  ASSERT_TRUE(16 == index.offset(1));
+  ASSERT_TRUE(24 == index.offset(3));
+
+  uint64_t offset = 4;
+  EXPECT_TRUE(a == index.find(offset));
+  EXPECT_TRUE(4 == offset);
+
+  // an offset at the end of a fragment belongs to it, like a FragmentRef
+  offset = 16;
+  EXPECT_TRUE(a == index.find(offset));
+  EXPECT_TRUE(16 == offset);
+
+  offset = 20;
+  EXPECT_TRUE(c == index.find(offset));
+  EXPECT_TRUE(4 == offset);
+
+  offset = 25;
+  EXPECT_TRUE(NULL == index.find(offset));
+
+  (void)b;
+  LDSection::Destroy(test);
+}
@@ -0,0 +1,82 @@
+//===- SectionMapBench.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Object/SectionMap.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// the default mappings of the standard sections
+const char* const Mappings[][2] = {
+  { ".text",             ".text" },
+  { ".rodata",           ".rodata" },
+  { ".data.rel.ro.local", ".data.rel.ro.local" },
+  { ".data.rel.ro",      ".data.rel.ro" },
+  { ".data",             ".data" },
+  { ".bss",              ".bss" },
+  { ".tdata",            ".tdata" },
+  { ".tbss",             ".tbss" },
+  { ".init_array",       ".init_array" },
+  { ".fini_array",       ".fini_array" },
+  { ".ctors",            ".ctors" },
+  { ".dtors",            ".dtors" },
+  { ".gcc_except_table", ".gcc_except_table" },
+  { ".gnu.linkonce.t",   ".text" },
+  { ".gnu.linkonce.r",   ".rodata" },
+  { ".gnu.linkonce.d",   ".data" },
+  { ".gnu.linkonce.b",   ".bss" },
+  { ".gnu.linkonce.wi",  ".debug_info" }
+};
+
+void MakeMap(SectionMap& pMap)
+{
+  bool exist = false;
+  for (size_t i = 0; i < sizeof(Mappings) / sizeof(Mappings[0]); ++i)
+    pMap.append(Mappings[i][0], Mappings[i][1], exist);
+}
+
+/// MakeNames - make the input section names of -ffunction-sections and
+/// -fdata-sections, and some names which are not mapped
+void MakeNames(std::vector<std::string>& pNames)
+{
+  const char* const prefixes[] = {
+    ".text.", ".rodata.", ".data.", ".bss.", ".data.rel.ro.",
+    ".gnu.linkonce.t.", ".debug_", ".note."
+  };
+  char buf[64];
+  for (size_t i = 0; i < 4096; ++i) {
+    snprintf(buf, sizeof(buf), "%s_ZN4mcld%zuE",
+             prefixes[i % (sizeof(prefixes) / sizeof(prefixes[0]))], i);
+    pNames.push_back(buf);
+  }
+}
+
+} // anonymous namespace
+
+/// map the input section names to the output sections
+static void BM_SectionMapFind(benchmark::State& pState)
+{
+  SectionMap map;
+  MakeMap(map);
+  std::vector<std::string> names;
+  MakeNames(names);
+  while (pState.KeepRunning()) {
+    for (size_t i = 0; i < names.size(); ++i)
+      benchmark::DoNotOptimize(&map.find(names[i]));
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size());
+}
+BENCHMARK(BM_SectionMapFind);
+
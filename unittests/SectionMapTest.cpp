@@ -0,0 +1,104 @@
+//===- SectionMapTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Object/SectionMap.h>
+#include "SectionMapTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+SectionMapTest::SectionMapTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SectionMapTest::~SectionMapTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SectionMapTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SectionMapTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( SectionMapTest, find_prefix) {
+  SectionMap map;
+  bool exist = false;
+  map.append(".text", ".text", exist);
+  ASSERT_FALSE(exist);
+
+  ASSERT_TRUE(".text" == map.find(".text.foo").to);
+  ASSERT_TRUE(SectionMap::Regular == map.find(".text.foo").group);
+  ASSERT_TRUE(map.find(".data").isNull());
+
+  map.append(".text", ".text", exist);
+  ASSERT_TRUE(exist);
+  ASSERT_EQ(1u, map.size());
+}
+
+TEST_F( SectionMapTest, find_group) {
+  SectionMap map;
+  bool exist = false;
+  map.append(".text.hot", ".text", SectionMap::Hot, exist);
+  map.append(".text.unlikely", ".text", SectionMap::Unlikely, exist);
+  map.append(".text", ".text", exist);
+  ASSERT_EQ(3u, map.size());
+
+  ASSERT_TRUE(SectionMap::Hot == map.find(".text.hot").group);
+  ASSERT_TRUE(SectionMap::Hot == map.find(".text.hot._Z3foov").group);
+  ASSERT_TRUE(SectionMap::Unlikely == map.find(".text.unlikely.bar").group);
+
+  // a function named hotter is a regular function
+  ASSERT_TRUE(SectionMap::Regular == map.find(".text.hotter").group);
+  ASSERT_TRUE(".text" == map.find(".text.hotter").to);
+  ASSERT_TRUE(SectionMap::Regular == map.find(".text").group);
+}
+
+TEST_F( SectionMapTest, find_longest) {
+  SectionMap map;
+  bool exist = false;
+  map.append(".data.rel.ro.local", ".data.rel.ro.local", exist);
+  map.append(".data.rel.ro", ".data.rel.ro", exist);
+  map.append(".data", ".data", exist);
+  map.append(".sdata2", ".sdata", exist);
+  map.append(".sdata", ".sdata", exist);
+
+  ASSERT_TRUE(".data.rel.ro.local" == map.find(".data.rel.ro.local.x").to);
+  ASSERT_TRUE(".data.rel.ro" == map.find(".data.rel.ro.x").to);
+  ASSERT_TRUE(".data.rel.ro" == map.find(".data.rel.ro").to);
+  ASSERT_TRUE(".data" == map.find(".data.rel").to);
+  ASSERT_TRUE(".sdata" == map.find(".sdata2.foo").to);
+  ASSERT_TRUE(".sdata" == map.find(".sdata.foo").to);
+  ASSERT_TRUE(map.find(".dat").isNull());
+  ASSERT_TRUE(map.find("").isNull());
+}
+
+TEST_F( SectionMapTest, find_wildcard) {
+  SectionMap map;
+  bool exist = false;
+  map.append(".text", ".text", exist);
+  map.append("*", ".other", exist);
+  ASSERT_FALSE(exist);
+
+  ASSERT_TRUE(".text" == map.find(".text.foo").to);
+  ASSERT_TRUE(".other" == map.find(".data").to);
+
+  // every name is mapped by the wildcard
+  map.append(".data", ".data", exist);
+  ASSERT_TRUE(exist);
+}
+
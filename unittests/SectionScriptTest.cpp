@@ -0,0 +1,104 @@
+//===- SectionScriptTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Object/SectionScript.h>
+#include "SectionScriptTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+SectionScriptTest::SectionScriptTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SectionScriptTest::~SectionScriptTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SectionScriptTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SectionScriptTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( SectionScriptTest, empty) {
+  SectionScript script;
+  script.parse("ENTRY(_start)\n");
+  ASSERT_TRUE(script.empty());
+  ASSERT_FALSE(script.hasDiscard());
+  ASSERT_TRUE(SectionScript::NoRule == script.find("a.o", ".text"));
+}
+
+TEST_F( SectionScriptTest, first_rule) {
+  SectionScript script;
+  script.parse("SECTIONS\n"
+               "{\n"
+               "  . = 0x400000;\n"
+               "  .text ALIGN(16) : AT(0x1000) {\n"
+               "    *(.text.hot .text.hot.*)\n"
+               "    KEEP(*(.init))\n"
+               "    *(.text .text.*)\n"
+               "    PROVIDE(etext = .);\n"
+               "  } >rom =0x90\n"
+               "  .data : { __data = .; foo.o(.data) *(.data .data.*) }\n"
+               "}\n");
+  ASSERT_EQ(5, script.size());
+
+  unsigned int rule = script.find("a.o", ".text.hot.main");
+  ASSERT_EQ(0, rule);
+  ASSERT_TRUE(".text" == script.getRule(rule).mapping.to);
+  ASSERT_EQ(1, script.find("a.o", ".init"));
+  ASSERT_EQ(2, script.find("a.o", ".text.main"));
+  ASSERT_EQ(3, script.find("foo.o", ".data"));
+  ASSERT_EQ(4, script.find("bar.o", ".data"));
+  ASSERT_TRUE(".data" == script.getRule(4).mapping.to);
+  ASSERT_TRUE(SectionScript::NoRule == script.find("a.o", ".rodata"));
+}
+
+TEST_F( SectionScriptTest, exclude_file) {
+  SectionScript script;
+  script.parse("SECTIONS {\n"
+               "  .text : { EXCLUDE_FILE(*crtend.o) *(.text) }\n"
+               "  .ctors : { *(EXCLUDE_FILE(*crtend.o) .ctors) }\n"
+               "}\n");
+  ASSERT_EQ(0, script.find("/lib/crt1.o", ".text"));
+  ASSERT_TRUE(SectionScript::NoRule == script.find("/lib/crtend.o", ".text"));
+  ASSERT_EQ(1, script.find("a.o", ".ctors"));
+  ASSERT_TRUE(SectionScript::NoRule == script.find("crtend.o", ".ctors"));
+}
+
+TEST_F( SectionScriptTest, sort) {
+  SectionScript script;
+  script.parse("SECTIONS {\n"
+               "  .ctors : { *(.ctors) *(SORT(.ctors.*)) SORT(CONSTRUCTORS) }\n"
+               "  .data : { *(SORT_BY_ALIGNMENT(SORT_BY_NAME(.data.*))) }\n"
+               "}\n");
+  ASSERT_EQ(3, script.size());
+  ASSERT_EQ(SectionScript::Unsorted, script.getRule(0).sort);
+  ASSERT_EQ(1, script.find("a.o", ".ctors.65535"));
+  ASSERT_EQ(SectionScript::SortByName, script.getRule(1).sort);
+  ASSERT_EQ(2, script.find("a.o", ".data.rel"));
+  ASSERT_EQ(SectionScript::SortByAlignment, script.getRule(2).sort);
+}
+
+TEST_F( SectionScriptTest, discard) {
+  SectionScript script;
+  script.parse("/* drop the comments */\n"
+               "SECTIONS { /DISCARD/ : { *(.comment) } }\n");
+  ASSERT_TRUE(script.empty());
+  ASSERT_TRUE(script.hasDiscard());
+}
@@ -0,0 +1,95 @@
+//===- SlotTableTest.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Target/GOT.h>
+#include <mcld/Target/PLT.h>
+#include <mcld/Target/SlotTable.h>
+#include "SlotTableTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+typedef SlotTable<GOT::Slot<8> > GOTTable;
+typedef SlotTable<PLT::Slot<16> > PLTTable;
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+SlotTableTest::SlotTableTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SlotTableTest::~SlotTableTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SlotTableTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SlotTableTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( SlotTableTest, reserve) {
+  GOTTable table(NULL);
+  ASSERT_TRUE(table.empty());
+  ASSERT_EQ(0u, table.size());
+
+  table.reserve();
+  table.reserve(3);
+  ASSERT_FALSE(table.empty());
+  ASSERT_EQ(4u, table.numOfSlots());
+  ASSERT_EQ(32u, table.size());
+
+  // the table is one target fragment covering all its entries
+  const Fragment& frag = table;
+  ASSERT_TRUE(Fragment::Target == frag.getKind());
+  ASSERT_EQ(32u, frag.size());
+
+  for (size_t i = 0; i < table.numOfSlots(); ++i) {
+    ASSERT_EQ(i, table.at(i).index());
+    ASSERT_EQ(i * 8, table.at(i).getTableOffset());
+    ASSERT_TRUE(&table == &table.at(i).getTable());
+  }
+}
+
+TEST_F( SlotTableTest, offsets) {
+  // the offset of an entry follows the offset of its table
+  PLTTable table(NULL);
+  table.reserve(2);
+  table.setOffset(0x40);
+  ASSERT_EQ(0x40u, table.at(0).getOffset());
+  ASSERT_EQ(0x50u, table.at(1).getOffset());
+
+  table.setOffset(0x100);
+  ASSERT_EQ(0x110u, table.at(1).getOffset());
+}
+
+TEST_F( SlotTableTest, stable_entries) {
+  // the entries handed out never move when more entries are reserved
+  GOTTable table(NULL);
+  table.reserve();
+  GOT::Slot<8>* first = &table.at(0);
+  first->setValue(0x1234);
+
+  table.reserve(1000);
+  ASSERT_TRUE(first == &table.at(0));
+  ASSERT_EQ(0x1234u, table.at(0).getValue());
+  ASSERT_EQ(0x0u, table.at(1000).getValue());
+  ASSERT_EQ(1001u * 8, table.size());
+}
+
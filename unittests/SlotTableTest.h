@@ -0,0 +1,37 @@
+//===- SlotTableTest.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_SLOT_TABLE_TEST_H
+#define MCLD_UNITTEST_SLOT_TABLE_TEST_H
+
+#include <gtest.h>
+
+namespace mcld {
+namespace test {
+
+class SlotTableTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  SlotTableTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~SlotTableTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,88 @@
+//===- SmallDataOrderingTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/SmallDataOrdering.h>
+#include "SmallDataOrderingTest.h"
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+SmallDataOrderingTest::SmallDataOrderingTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SmallDataOrderingTest::~SmallDataOrderingTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SmallDataOrderingTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SmallDataOrderingTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( SmallDataOrderingTest, sort_unaccessed) {
+  // the objects never accessed are placed from the smallest up
+  std::vector<uint64_t> sizes;
+  sizes.push_back(8);
+  sizes.push_back(2);
+  sizes.push_back(4);
+  sizes.push_back(2);
+  std::vector<uint64_t> counts(4, 0);
+  std::vector<size_t> order;
+  SmallDataOrdering::Sort(sizes, counts, order);
+  ASSERT_EQ(4u, order.size());
+  ASSERT_EQ(1u, order[0]);
+  ASSERT_EQ(3u, order[1]);
+  ASSERT_EQ(2u, order[2]);
+  ASSERT_EQ(0u, order[3]);
+}
+
+TEST_F( SmallDataOrderingTest, sort_density) {
+  // the object of more accesses per byte is placed first
+  std::vector<uint64_t> sizes;
+  sizes.push_back(4);
+  sizes.push_back(64);
+  sizes.push_back(8);
+  std::vector<uint64_t> counts;
+  counts.push_back(1);
+  counts.push_back(64);
+  counts.push_back(0);
+  std::vector<size_t> order;
+  SmallDataOrdering::Sort(sizes, counts, order);
+  ASSERT_EQ(3u, order.size());
+  ASSERT_EQ(1u, order[0]);
+  ASSERT_EQ(0u, order[1]);
+  ASSERT_EQ(2u, order[2]);
+}
+
+TEST_F( SmallDataOrderingTest, sort_empty_object) {
+  // an empty object counts a byte
+  std::vector<uint64_t> sizes;
+  sizes.push_back(4);
+  sizes.push_back(0);
+  std::vector<uint64_t> counts;
+  counts.push_back(2);
+  counts.push_back(1);
+  std::vector<size_t> order;
+  SmallDataOrdering::Sort(sizes, counts, order);
+  ASSERT_EQ(2u, order.size());
+  ASSERT_EQ(1u, order[0]);
+  ASSERT_EQ(0u, order[1]);
+}
@@ -196,6 +196,36 @@ TEST_F( StaticResolverTest, DynWeakAfterDynDef ) {
   ASSERT_TRUE(1 == old_sym->size());
 }
 
+TEST_F( StaticResolverTest, WeakDefByOrdinal ) {
+  ResolveInfo* old_sym = ResolveInfo::Create("abc");
+  ResolveInfo* new_sym = ResolveInfo::Create("abc");
+
+  old_sym->setBinding(ResolveInfo::Weak);
+  new_sym->setBinding(ResolveInfo::Weak);
+  old_sym->setDesc(ResolveInfo::Define);
+  new_sym->setDesc(ResolveInfo::Define);
+  old_sym->setSize(1);
+  new_sym->setSize(2);
+
+  // a later input does not override the first weak definition
+  old_sym->setOrdinal(3);
+  new_sym->setOrdinal(5);
+  bool override = false;
+  bool result = m_pResolver->resolve(*old_sym, *new_sym, override);
+  ASSERT_TRUE(result);
+  ASSERT_FALSE( override );
+  ASSERT_TRUE(1 == old_sym->size());
+  ASSERT_TRUE(3 == old_sym->ordinal());
+
+  // an earlier input resolved later does
+  new_sym->setOrdinal(2);
+  result = m_pResolver->resolve(*old_sym, *new_sym, override);
+  ASSERT_TRUE(result);
+  ASSERT_TRUE( override );
+  ASSERT_TRUE(2 == old_sym->size());
+  ASSERT_TRUE(2 == old_sym->ordinal());
+}
+
 TEST_F( StaticResolverTest, MarkByBiggerCommon )
 {
   ResolveInfo* old_sym = ResolveInfo::Create("abc");
@@ -6,27 +6,26 @@
 // License. See LICENSE.TXT for details.
 //
 //===----------------------------------------------------------------------===//
+#include <mcld/LD/StringTable.h>
+#include <mcld/Support/ThreadPool.h>
 #include "StringTableTest.h"
-#include "mcld/LD/StringTable.h"
+
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <vector>
 
 using namespace mcld;
-using namespace mcldtest;
-
+using namespace mcld::test;
 
 // Constructor can do set-up work for all test here.
 StringTableTest::StringTableTest()
 {
-  // create testee. modify it if need
-  Resolver* R = new Resolver();
-  StrSymPool* Pool = new StrSymPool(1, 1, *R);
-  m_pTestee = new StringTable(*Pool);
 }
 
 // Destructor can do clean-up work that doesn't throw exceptions here.
 StringTableTest::~StringTableTest()
 {
-  delete m_pTestee;
 }
 
 // SetUp() will be called immediately before each test.
@@ -39,39 +38,112 @@ void StringTableTest::TearDown()
 {
 }
 
-//==========================================================================//
+//===----------------------------------------------------------------------===//
 // Testcases
-//
-TEST_F(StringTableTest, different_string_size) {
-  int size = 127-32;
-  for (int i = 32; i < 127; ++i) {
-    char c[2];
-    c[0] = i;
-    c[1] = '\0';
-    ASSERT_NE(m_pTestee->insert(c), c);
+//===----------------------------------------------------------------------===//
+TEST_F( StringTableTest, empty) {
+  ThreadPool pool(1);
+  StringTable table;
+  table.add("");
+  table.finalize(pool);
+  ASSERT_TRUE(table.empty());
+  ASSERT_EQ(1u, table.size());
+  ASSERT_EQ(0u, table.getOffset(""));
+}
+
+TEST_F( StringTableTest, merge_suffix) {
+  ThreadPool pool(1);
+  StringTable table;
+  table.add("bar");
+  table.add("_Z3barv");
+  table.add("foobar");
+  table.add("ar");
+  table.add("foobar");
+  table.add("baz");
+  table.finalize(pool);
+
+  ASSERT_EQ(5u, table.numOfStrings());
+  // "_Z3barv" and "foobar" are emitted, "bar" and "ar" share "foobar"
+  ASSERT_EQ(1u + 8u + 7u + 4u, table.size());
+
+  std::vector<char> buffer(table.size(), 'x');
+  table.emit(&buffer[0]);
+  ASSERT_EQ('\0', buffer[0]);
+  const char* names[] = { "bar", "_Z3barv", "foobar", "ar", "baz" };
+  for (size_t i = 0; i < 5; ++i) {
+    uint64_t offset = table.getOffset(names[i]);
+    ASSERT_TRUE(offset < table.size());
+    ASSERT_STREQ(names[i], &buffer[offset]);
   }
-  ASSERT_EQ(m_pTestee->size(), size);
+  ASSERT_EQ(table.getOffset("foobar") + 3, table.getOffset("bar"));
+  ASSERT_EQ(table.getOffset("foobar") + 4, table.getOffset("ar"));
+}
+
+TEST_F( StringTableTest, add_after_finalize) {
+  ThreadPool pool(1);
+  StringTable table;
+  table.add("foobar");
+  table.finalize(pool);
+  uint64_t offset = table.getOffset("foobar");
+
+  // a late string is appended even if it is a suffix
+  table.add("bar");
+  ASSERT_EQ(offset, table.getOffset("foobar"));
+  ASSERT_EQ(8u, table.getOffset("bar"));
+  ASSERT_EQ(12u, table.size());
+
+  std::vector<char> buffer(table.size(), 'x');
+  table.emit(&buffer[0]);
+  ASSERT_STREQ("bar", &buffer[8]);
 }
 
-TEST_F(StringTableTest, traverse_begin_to_end) {
-  m_pTestee->insert("Hello");
-  m_pTestee->insert("World");
-  m_pTestee->insert("Media");
-  m_pTestee->insert("Tek");
-  StringTable::iterator it = m_pTestee->begin();
-  ASSERT_STREQ(*it, "Hello");
-  ++it;
-  ASSERT_STREQ(*it, "World");
-  ++it;
-  ASSERT_STREQ(*it, "Media");
-  ++it;
-  ASSERT_STREQ(*it, "Tek");
-  ++it;
-  ASSERT_EQ(it, m_pTestee->end());
+TEST_F( StringTableTest, parallel_finalize) {
+  // the tables sorted by one thread and by four threads are the same
+  ThreadPool serial(1);
+  ThreadPool parallel(4);
+  StringTable table1, table4;
+  char name[32];
+  for (int i = 0; i < 20000; ++i) {
+    snprintf(name, sizeof(name), "_ZN4test%dE", i);
+    table1.add(name);
+    table4.add(name);
+    table1.add(name + 4);
+    table4.add(name + 4);
+  }
+  table1.finalize(serial);
+  table4.finalize(parallel);
+
+  ASSERT_EQ(table1.size(), table4.size());
+  std::vector<char> buffer1(table1.size()), buffer4(table4.size());
+  table1.emit(&buffer1[0]);
+  table4.emit(&buffer4[0]);
+  ASSERT_TRUE(buffer1 == buffer4);
+
+  // every "test%dE" is a tail of its "_ZN4test%dE"
+  for (int i = 0; i < 20000; ++i) {
+    snprintf(name, sizeof(name), "_ZN4test%dE", i);
+    ASSERT_EQ(table4.getOffset(name) + 4, table4.getOffset(name + 4));
+    ASSERT_STREQ(name, &buffer4[table4.getOffset(name)]);
+  }
 }
 
-TEST_F(StringTableTest, null_string) {
-  m_pTestee->insert("");
-  ASSERT_STREQ(*(m_pTestee->begin()), "");
-  ASSERT_EQ(m_pTestee->size(), 1);
+
+TEST_F( StringTableTest, parallel_emit) {
+  // the table emitted by four threads is the same as the serial one
+  ThreadPool parallel(4);
+  StringTable table;
+  char name[32];
+  for (int i = 0; i < 20000; ++i) {
+    snprintf(name, sizeof(name), "_ZN4test%dE", i);
+    table.add(name);
+    table.add(name + 4);
+  }
+  table.finalize(parallel);
+  table.add("late");
+
+  std::vector<char> serial(table.size(), 'x'), buffer(table.size(), 'x');
+  table.emit(&serial[0]);
+  table.emit(&buffer[0], parallel);
+  ASSERT_TRUE(serial == buffer);
+  ASSERT_STREQ("late", &buffer[table.getOffset("late")]);
 }
@@ -6,25 +6,14 @@
 // License. See LICENSE.TXT for details.
 //
 //===----------------------------------------------------------------------===//
-#ifndef STRINGTABLE_TEST_H
-#define STRINGTABLE_TEST_H
+#ifndef MCLD_UNITTEST_STRING_TABLE_TEST_H
+#define MCLD_UNITTEST_STRING_TABLE_TEST_H
 
 #include <gtest.h>
 
-namespace mcld
-{
-class StringTable;
-
-} // namespace for mcld
+namespace mcld {
+namespace test {
 
-namespace mcldtest
-{
-
-/** \class StringTableTest
- *  \brief 
- *
- *  \see StringTable 
- */
 class StringTableTest : public ::testing::Test
 {
 public:
@@ -39,12 +28,10 @@ public:
 
   // TearDown() will be called immediately after each test.
   virtual void TearDown();
-
-protected:
-  mcld::StringTable* m_pTestee;
 };
 
-} // namespace of mcldtest
+} // namespace of test
+} // namespace of mcld
 
 #endif
 
@@ -142,3 +142,112 @@ TEST_F(SymbolCategoryTest, change_local_to_dynamic) {
   ++sym;
   ASSERT_STREQ("e", (*sym)->name());
 }
+
+static bool IsRemoved(const LDSymbol& pSymbol)
+{
+  return ('x' == pSymbol.name()[0]);
+}
+
+TEST_F(SymbolCategoryTest, remove_if) {
+  ResolveInfo* a = ResolveInfo::Create("a");
+  ResolveInfo* b = ResolveInfo::Create("xb");
+  ResolveInfo* c = ResolveInfo::Create("c");
+  ResolveInfo* d = ResolveInfo::Create("xd");
+  ResolveInfo* e = ResolveInfo::Create("e");
+
+  a->setBinding(ResolveInfo::Local);
+  b->setBinding(ResolveInfo::Local);
+  c->setDesc(ResolveInfo::Common);
+  c->setBinding(ResolveInfo::Global);
+  d->setBinding(ResolveInfo::Global);
+  e->setBinding(ResolveInfo::Global);
+
+  LDSymbol* aa = LDSymbol::Create(*a);
+  LDSymbol* bb = LDSymbol::Create(*b);
+  LDSymbol* cc = LDSymbol::Create(*c);
+  LDSymbol* dd = LDSymbol::Create(*d);
+  LDSymbol* ee = LDSymbol::Create(*e);
+
+  m_pTestee->add(*ee);
+  m_pTestee->add(*dd);
+  m_pTestee->add(*cc);
+  m_pTestee->add(*bb);
+  m_pTestee->add(*aa);
+
+  m_pTestee->removeIf(IsRemoved);
+
+  ASSERT_TRUE(3 == m_pTestee->numOfSymbols());
+  ASSERT_TRUE(1 == m_pTestee->numOfLocals());
+  ASSERT_TRUE(1 == m_pTestee->numOfCommons());
+  ASSERT_TRUE(1 == m_pTestee->numOfDynamics());
+
+  SymbolCategory::iterator sym = m_pTestee->begin();
+  ASSERT_STREQ("a", (*sym)->name());
+  ++sym;
+  ASSERT_STREQ("c", (*sym)->name());
+  ++sym;
+  ASSERT_STREQ("e", (*sym)->name());
+  ASSERT_TRUE(m_pTestee->localEnd() == m_pTestee->commonBegin());
+  ASSERT_TRUE(m_pTestee->dynamicEnd() == m_pTestee->end());
+}
+
+TEST_F(SymbolCategoryTest, deferred_categorize) {
+  ResolveInfo* a = ResolveInfo::Create("a");
+  ResolveInfo* b = ResolveInfo::Create("b");
+  ResolveInfo* c = ResolveInfo::Create("c");
+  ResolveInfo* d = ResolveInfo::Create("d");
+  ResolveInfo* e = ResolveInfo::Create("e");
+  ResolveInfo* f = ResolveInfo::Create("f");
+
+  a->setBinding(ResolveInfo::Global);
+  b->setBinding(ResolveInfo::Local);
+  c->setDesc(ResolveInfo::Common);
+  c->setBinding(ResolveInfo::Global);
+  d->setBinding(ResolveInfo::Local);
+  e->setBinding(ResolveInfo::Global);
+  f->setType(ResolveInfo::File);
+
+  LDSymbol* aa = LDSymbol::Create(*a);
+  LDSymbol* bb = LDSymbol::Create(*b);
+  LDSymbol* cc = LDSymbol::Create(*c);
+  LDSymbol* dd = LDSymbol::Create(*d);
+  LDSymbol* ee = LDSymbol::Create(*e);
+  LDSymbol* ff = LDSymbol::Create(*f);
+
+  m_pTestee->forceLocal(*aa);
+  m_pTestee->defer();
+  ASSERT_TRUE(m_pTestee->isDeferred());
+
+  m_pTestee->add(*bb);
+  m_pTestee->add(*cc);
+  m_pTestee->add(*dd);
+  m_pTestee->add(*ee);
+  m_pTestee->add(*ff);
+
+  // c is resolved to a defined symbol after it is added
+  c->setDesc(ResolveInfo::Define);
+  m_pTestee->arrange(*cc, *c);
+
+  m_pTestee->categorize();
+  ASSERT_FALSE(m_pTestee->isDeferred());
+
+  ASSERT_TRUE(6 == m_pTestee->numOfSymbols());
+  ASSERT_TRUE(3 == m_pTestee->numOfLocals());
+  ASSERT_TRUE(0 == m_pTestee->numOfCommons());
+  ASSERT_TRUE(2 == m_pTestee->numOfDynamics());
+
+  // the symbols keep their order within a category
+  SymbolCategory::iterator sym = m_pTestee->begin();
+  ASSERT_STREQ("f", (*sym)->name());
+  ++sym;
+  ASSERT_STREQ("a", (*sym)->name());
+  ++sym;
+  ASSERT_STREQ("b", (*sym)->name());
+  ++sym;
+  ASSERT_STREQ("d", (*sym)->name());
+  ++sym;
+  ASSERT_STREQ("c", (*sym)->name());
+  ++sym;
+  ASSERT_STREQ("e", (*sym)->name());
+  ASSERT_TRUE(m_pTestee->commonBegin() == m_pTestee->commonEnd());
+}
@@ -0,0 +1,95 @@
+//===- SymbolEntryMapTest.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Target/SymbolEntryMap.h>
+#include <mcld/LD/ResolveInfo.h>
+#include "SymbolEntryMapTest.h"
+
+#include <vector>
+#include <cstdio>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+SymbolEntryMapTest::SymbolEntryMapTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SymbolEntryMapTest::~SymbolEntryMapTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SymbolEntryMapTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SymbolEntryMapTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( SymbolEntryMapTest, record_and_look_up) {
+  SymbolEntryMap<int> map;
+  std::vector<ResolveInfo*> symbols;
+  std::vector<int> entries(1000);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    char name[16];
+    sprintf(name, "sym%u", (unsigned int)i);
+    symbols.push_back(ResolveInfo::Create(name));
+    entries[i] = i;
+  }
+
+  ResolveInfo* absent = ResolveInfo::Create("absent");
+  ASSERT_TRUE(map.empty());
+  ASSERT_TRUE(NULL == map.lookUp(*absent));
+
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    map.record(*symbols[i], entries[i]);
+    // the early records are still found after rehashing
+    ASSERT_EQ(&entries[0], map.lookUp(*symbols[0]));
+  }
+  ASSERT_EQ(symbols.size(), map.size());
+
+  const SymbolEntryMap<int>& const_map = map;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    ASSERT_EQ(&entries[i], map.lookUp(*symbols[i]));
+    ASSERT_EQ(&entries[i], const_map.lookUp(*symbols[i]));
+  }
+  ASSERT_TRUE(NULL == map.lookUp(*absent));
+
+  // the mappings are iterated in the recorded order
+  size_t idx = 0;
+  SymbolEntryMap<int>::iterator it, itEnd = map.end();
+  for (it = map.begin(); it != itEnd; ++it, ++idx)
+    ASSERT_TRUE(symbols[idx] == it->symbol);
+
+  for (size_t i = 0; i < symbols.size(); ++i)
+    ResolveInfo::Destroy(symbols[i]);
+  ResolveInfo::Destroy(absent);
+}
+
+TEST_F( SymbolEntryMapTest, first_record_wins) {
+  SymbolEntryMap<int> map;
+  ResolveInfo* symbol = ResolveInfo::Create("symbol");
+  int first = 1, second = 2;
+
+  map.reserve(100);
+  map.record(*symbol, first);
+  map.record(*symbol, second);
+  ASSERT_EQ(2u, map.size());
+  ASSERT_EQ(&first, map.lookUp(*symbol));
+
+  ResolveInfo::Destroy(symbol);
+}
+
@@ -0,0 +1,67 @@
+//===- SymbolOrderingTest.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/SymbolOrdering.h>
+#include "SymbolOrderingTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+SymbolOrderingTest::SymbolOrderingTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SymbolOrderingTest::~SymbolOrderingTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SymbolOrderingTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SymbolOrderingTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( SymbolOrderingTest, parse_empty) {
+  SymbolOrdering ordering;
+  ordering.parse("");
+  ASSERT_TRUE(ordering.empty());
+
+  ordering.parse("\n  \n\t\n");
+  ASSERT_TRUE(ordering.empty());
+  ASSERT_TRUE(SymbolOrdering::NotOrdered == ordering.getPriority("main"));
+}
+
+TEST_F( SymbolOrderingTest, parse_names) {
+  SymbolOrdering ordering;
+  ordering.parse("main\n  _Z3foov \r\n\nbar");
+  ASSERT_EQ(3u, ordering.numOfSymbols());
+  ASSERT_EQ(0u, ordering.getPriority("main"));
+  ASSERT_EQ(1u, ordering.getPriority("_Z3foov"));
+  ASSERT_EQ(2u, ordering.getPriority("bar"));
+  ASSERT_TRUE(SymbolOrdering::NotOrdered == ordering.getPriority("baz"));
+}
+
+TEST_F( SymbolOrderingTest, parse_duplicates) {
+  // the first line of a name gives its priority
+  SymbolOrdering ordering;
+  ordering.parse("foo\nbar\nfoo\nbaz\n");
+  ASSERT_EQ(3u, ordering.numOfSymbols());
+  ASSERT_EQ(0u, ordering.getPriority("foo"));
+  ASSERT_EQ(1u, ordering.getPriority("bar"));
+  ASSERT_EQ(2u, ordering.getPriority("baz"));
+}
+
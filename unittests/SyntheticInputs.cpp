@@ -0,0 +1,618 @@
+//===- SyntheticInputs.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "SyntheticInputs.h"
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/ELF.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <map>
+
+using namespace mcld;
+using namespace mcld::test;
+using namespace llvm::ELF;
+
+namespace {
+
+const unsigned int TextAlign = 16;
+
+//===----------------------------------------------------------------------===//
+// little-endian writers
+//===----------------------------------------------------------------------===//
+void Write8(std::string& pOut, uint8_t pValue)
+{
+  pOut.push_back(static_cast<char>(pValue));
+}
+
+void Write16(std::string& pOut, uint16_t pValue)
+{
+  Write8(pOut, pValue & 0xff);
+  Write8(pOut, pValue >> 8);
+}
+
+void Write32(std::string& pOut, uint32_t pValue)
+{
+  Write16(pOut, pValue & 0xffff);
+  Write16(pOut, pValue >> 16);
+}
+
+void Write64(std::string& pOut, uint64_t pValue)
+{
+  Write32(pOut, pValue & 0xffffffffULL);
+  Write32(pOut, pValue >> 32);
+}
+
+/// WriteWord - write a 32-bit or a 64-bit word of the file class
+void WriteWord(std::string& pOut, bool pIs64, uint64_t pValue)
+{
+  if (pIs64)
+    Write64(pOut, pValue);
+  else
+    Write32(pOut, static_cast<uint32_t>(pValue));
+}
+
+void Align(std::string& pOut, size_t pAlign, char pFill = 0x0)
+{
+  while (0 != (pOut.size() % pAlign))
+    pOut.push_back(pFill);
+}
+
+/// StringTable - a string table being built
+class StringTable
+{
+public:
+  StringTable() : m_Data(1, '\0') { }
+
+  uint32_t add(const std::string& pString) {
+    uint32_t offset = m_Data.size();
+    m_Data.append(pString);
+    m_Data.push_back('\0');
+    return offset;
+  }
+
+  const std::string& data() const { return m_Data; }
+
+private:
+  std::string m_Data;
+};
+
+struct Section
+{
+  uint32_t name;
+  uint32_t type;
+  uint64_t flags;
+  uint64_t offset;
+  uint64_t size;
+  uint32_t link;
+  uint32_t info;
+  uint64_t align;
+  uint64_t entsize;
+};
+
+struct Symbol
+{
+  uint32_t name;
+  uint8_t info;
+  uint16_t shndx;
+  uint64_t value;
+  uint64_t size;
+};
+
+struct Reloc
+{
+  uint64_t offset;
+  uint32_t symbol;
+  uint32_t type;
+  int64_t addend;
+};
+
+/// FinishObject - append the symbol table, the string tables and the section
+/// header table of an object to pOut, and write its ELF header
+void FinishObject(std::string& pOut,
+                  SyntheticInputs::Arch pArch,
+                  bool pIs64,
+                  std::vector<Section>& pSections,
+                  StringTable& pShStrTab,
+                  const StringTable& pStrTab,
+                  const std::vector<Symbol>& pSymbols)
+{
+  // .symtab: all symbols but the null one are global
+  Align(pOut, pIs64 ? 8 : 4);
+  {
+    uint32_t symtab_idx = pSections.size();
+    size_t sym_size = pIs64 ? 24 : 16;
+    Section sect = { pShStrTab.add(".symtab"), SHT_SYMTAB, 0, pOut.size(),
+                     pSymbols.size() * sym_size, symtab_idx + 1, 1,
+                     pIs64 ? 8u : 4u, sym_size };
+    pSections.push_back(sect);
+    for (size_t s = 0; s < pSymbols.size(); ++s) {
+      const Symbol& sym = pSymbols[s];
+      Write32(pOut, sym.name);
+      if (pIs64) {
+        Write8(pOut, sym.info);
+        Write8(pOut, STV_DEFAULT);
+        Write16(pOut, sym.shndx);
+        Write64(pOut, sym.value);
+        Write64(pOut, sym.size);
+      }
+      else {
+        Write32(pOut, static_cast<uint32_t>(sym.value));
+        Write32(pOut, static_cast<uint32_t>(sym.size));
+        Write8(pOut, sym.info);
+        Write8(pOut, STV_DEFAULT);
+        Write16(pOut, sym.shndx);
+      }
+    }
+  }
+
+  // .strtab and .shstrtab
+  {
+    Section sect = { pShStrTab.add(".strtab"), SHT_STRTAB, 0, pOut.size(),
+                     pStrTab.data().size(), 0, 0, 1, 0 };
+    pSections.push_back(sect);
+    pOut.append(pStrTab.data());
+  }
+  uint32_t shstrtab_name = pShStrTab.add(".shstrtab");
+  {
+    Section sect = { shstrtab_name, SHT_STRTAB, 0, pOut.size(),
+                     pShStrTab.data().size(), 0, 0, 1, 0 };
+    pSections.push_back(sect);
+    pOut.append(pShStrTab.data());
+  }
+
+  // the section header table
+  Align(pOut, pIs64 ? 8 : 4);
+  uint64_t shoff = pOut.size();
+  for (size_t s = 0; s < pSections.size(); ++s) {
+    const Section& sect = pSections[s];
+    Write32(pOut, sect.name);
+    Write32(pOut, sect.type);
+    WriteWord(pOut, pIs64, sect.flags);
+    WriteWord(pOut, pIs64, 0x0);        // sh_addr
+    WriteWord(pOut, pIs64, sect.offset);
+    WriteWord(pOut, pIs64, sect.size);
+    Write32(pOut, sect.link);
+    Write32(pOut, sect.info);
+    WriteWord(pOut, pIs64, sect.align);
+    WriteWord(pOut, pIs64, sect.entsize);
+  }
+
+  // the ELF header
+  std::string header;
+  Write8(header, 0x7f);
+  header.append("ELF");
+  Write8(header, pIs64 ? ELFCLASS64 : ELFCLASS32);
+  Write8(header, ELFDATA2LSB);
+  Write8(header, EV_CURRENT);
+  header.append(9, '\0');
+  Write16(header, ET_REL);
+  switch (pArch) {
+    case SyntheticInputs::X86_32:  Write16(header, EM_386);     break;
+    case SyntheticInputs::X86_64:  Write16(header, EM_X86_64);  break;
+    case SyntheticInputs::ARM:
+    case SyntheticInputs::Thumb:   Write16(header, EM_ARM);     break;
+    case SyntheticInputs::Mips:    Write16(header, EM_MIPS);    break;
+    case SyntheticInputs::Hexagon: Write16(header, EM_HEXAGON); break;
+  }
+  Write32(header, EV_CURRENT);
+  WriteWord(header, pIs64, 0x0);        // e_entry
+  WriteWord(header, pIs64, 0x0);        // e_phoff
+  WriteWord(header, pIs64, shoff);
+  // e_flags: the EABI version of ARM, the machine version V2 of Hexagon
+  switch (pArch) {
+    case SyntheticInputs::ARM:
+    case SyntheticInputs::Thumb:   Write32(header, EF_ARM_EABI_VER5); break;
+    case SyntheticInputs::Hexagon: Write32(header, 0x2);              break;
+    default:                       Write32(header, 0x0);              break;
+  }
+  Write16(header, pIs64 ? 64 : 52);     // e_ehsize
+  Write16(header, 0);                   // e_phentsize
+  Write16(header, 0);                   // e_phnum
+  Write16(header, pIs64 ? 64 : 40);     // e_shentsize
+  Write16(header, pSections.size());
+  Write16(header, pSections.size() - 1);  // e_shstrndx
+  pOut.replace(0, header.size(), header);
+}
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// SyntheticInputs
+//===----------------------------------------------------------------------===//
+SyntheticInputs::SyntheticInputs(Arch pArch, const Scale& pScale)
+  : m_Arch(pArch), m_Scale(pScale) {
+  assert(0 != m_Scale.numOfObjects && 0 != m_Scale.numOfSymbols &&
+         0 != m_Scale.numOfSections);
+  assert(m_Scale.numOfArchives * m_Scale.numOfMembers < m_Scale.numOfObjects);
+}
+
+const char* SyntheticInputs::getName(Arch pArch)
+{
+  switch (pArch) {
+    case X86_32:  return "x86-32";
+    case X86_64:  return "x86-64";
+    case ARM:     return "arm";
+    case Thumb:   return "thumb";
+    case Mips:    return "mips";
+    case Hexagon: return "hexagon";
+  }
+  return "unknown";
+}
+
+const char* SyntheticInputs::triple() const
+{
+  switch (m_Arch) {
+    case X86_32:  return "i386-none-linux-gnu";
+    case X86_64:  return "x86_64-none-linux-gnu";
+    case ARM:     return "armv7-none-linux-gnueabi";
+    case Thumb:   return "thumbv7-none-linux-gnueabi";
+    case Mips:    return "mipsel-none-linux-gnu";
+    case Hexagon: return "hexagon-none-linux";
+  }
+  return "";
+}
+
+std::string SyntheticInputs::symbolName(unsigned int pObject,
+                                        unsigned int pSymbol)
+{
+  // mangled names with long common prefixes, as the symbols of C++ inputs
+  char buf[64];
+  snprintf(buf, sizeof(buf), "_ZN9synthetic6object%uE%uv", pObject, pSymbol);
+  return buf;
+}
+
+void SyntheticInputs::generate(ImageList& pObjects, ImageList& pArchives) const
+{
+  unsigned int num_of_members = m_Scale.numOfArchives * m_Scale.numOfMembers;
+  unsigned int first_member = m_Scale.numOfObjects - num_of_members;
+
+  pObjects.clear();
+  pObjects.resize(first_member);
+  for (unsigned int i = 0; i < first_member; ++i) {
+    pObjects[i].name = "obj" + llvm::utostr(i) + ".o";
+    createObject(i, pObjects[i].data);
+  }
+
+  pArchives.clear();
+  pArchives.resize(m_Scale.numOfArchives);
+  for (unsigned int a = 0; a < m_Scale.numOfArchives; ++a) {
+    ImageList members(m_Scale.numOfMembers);
+    for (unsigned int m = 0; m < m_Scale.numOfMembers; ++m) {
+      unsigned int index = first_member + a * m_Scale.numOfMembers + m;
+      members[m].name = "m" + llvm::utostr(index) + ".o";
+      createObject(index, members[m].data);
+    }
+    pArchives[a].name = "libsynthetic" + llvm::utostr(a) + ".a";
+    createArchive(members, pArchives[a].data);
+  }
+}
+
+void SyntheticInputs::createObject(unsigned int pIndex,
+                                   std::string& pData) const
+{
+  bool is64 = is64Bits();
+  const Scale& scale = m_Scale;
+
+  // 1. the relocations. Relocation j calls a function of one of the next
+  // seven objects, and one in eight of them is a data relocation. The REL
+  // targets keep the addend of a call in its word.
+  uint32_t call_type = 0, data_type = 0, call_word = 0;
+  int64_t call_addend = 0;
+  switch (m_Arch) {
+    case X86_32:
+      call_type = R_386_PC32;
+      data_type = R_386_32;
+      call_word = 0xfffffffc;   // -4
+      break;
+    case X86_64:
+      call_type = R_X86_64_PLT32;
+      data_type = R_X86_64_64;
+      call_word = 0x90909090;   // nops
+      call_addend = -4;
+      break;
+    case ARM:
+      call_type = R_ARM_CALL;
+      data_type = R_ARM_ABS32;
+      call_word = 0xebfffffe;   // bl .
+      break;
+    case Thumb:
+      call_type = R_ARM_THM_CALL;
+      data_type = R_ARM_ABS32;
+      call_word = 0xfffef7ff;   // bl ., as the halfwords 0xf7ff 0xfffe
+      break;
+    case Mips:
+      call_type = R_MIPS_26;
+      data_type = R_MIPS_32;
+      call_word = 0x0c000000;   // jal 0
+      break;
+    case Hexagon:
+      call_type = R_HEX_B22_PCREL;
+      data_type = R_HEX_32;
+      call_word = 0x5a00c000;   // call 0
+      break;
+  }
+
+  unsigned int text_relocs = scale.numOfRelocs - scale.numOfRelocs / 8;
+  unsigned int data_relocs = scale.numOfRelocs - text_relocs;
+  unsigned int relocs_per_text =
+    (text_relocs + scale.numOfSections - 1) / scale.numOfSections;
+  unsigned int syms_per_text =
+    (scale.numOfSymbols + scale.numOfSections - 1) / scale.numOfSections;
+  unsigned int data_word = is64 ? 8 : 4;
+  // the address of a Thumb function has its bit 0 set
+  uint64_t func_bit = (Thumb == m_Arch) ? 0x1 : 0x0;
+
+  // every call is a word in its section, every function has a word, too
+  uint64_t text_size = 4 * std::max(relocs_per_text, syms_per_text);
+  text_size = (text_size + TextAlign - 1) & ~uint64_t(TextAlign - 1);
+  uint64_t data_size = data_word * std::max(data_relocs, 1u);
+
+  // 2. the symbols: null, defined functions, the data symbol, _start, and
+  // the undefined references
+  StringTable strtab;
+  std::vector<Symbol> symbols(1);
+  Symbol null_sym = { 0, 0, 0, 0, 0 };
+  symbols[0] = null_sym;
+  for (unsigned int s = 0; s < scale.numOfSymbols; ++s) {
+    Symbol sym;
+    sym.name = strtab.add(symbolName(pIndex, s));
+    sym.info = (STB_GLOBAL << 4) | STT_FUNC;
+    sym.shndx = 1 + (s % scale.numOfSections);
+    sym.value = (4 * (s / scale.numOfSections)) | func_bit;
+    sym.size = 4;
+    symbols.push_back(sym);
+  }
+  {
+    Symbol sym;
+    sym.name = strtab.add("synthetic_data" + llvm::utostr(pIndex));
+    sym.info = (STB_GLOBAL << 4) | STT_OBJECT;
+    sym.shndx = 1 + scale.numOfSections;
+    sym.value = 0;
+    sym.size = data_size;
+    symbols.push_back(sym);
+  }
+  if (0 == pIndex) {
+    Symbol sym;
+    sym.name = strtab.add("_start");
+    sym.info = (STB_GLOBAL << 4) | STT_FUNC;
+    sym.shndx = 1;
+    sym.value = func_bit;
+    sym.size = 4;
+    symbols.push_back(sym);
+  }
+
+  std::map<std::pair<unsigned int, unsigned int>, uint32_t> undefs;
+  std::vector<std::vector<Reloc> > text_rels(scale.numOfSections);
+  std::vector<Reloc> data_rels;
+  unsigned int num_of_calls = 0;
+  for (unsigned int j = 0; j < scale.numOfRelocs; ++j) {
+    unsigned int object = (pIndex + 1 + j % 7) % scale.numOfObjects;
+    unsigned int target = (j * 31) % scale.numOfSymbols;
+
+    uint32_t sym_idx;
+    if (object == pIndex)
+      sym_idx = 1 + target;
+    else {
+      std::pair<unsigned int, unsigned int> key(object, target);
+      std::map<std::pair<unsigned int, unsigned int>, uint32_t>::iterator it =
+        undefs.find(key);
+      if (undefs.end() == it) {
+        Symbol sym;
+        sym.name = strtab.add(symbolName(object, target));
+        sym.info = (STB_GLOBAL << 4) | STT_NOTYPE;
+        sym.shndx = SHN_UNDEF;
+        sym.value = 0;
+        sym.size = 0;
+        sym_idx = symbols.size();
+        symbols.push_back(sym);
+        undefs[key] = sym_idx;
+      }
+      else
+        sym_idx = it->second;
+    }
+
+    if (7 == (j % 8)) {
+      Reloc rel = { data_word * data_rels.size(), sym_idx, data_type, 0 };
+      data_rels.push_back(rel);
+    }
+    else {
+      std::vector<Reloc>& rels =
+        text_rels[num_of_calls++ % scale.numOfSections];
+      Reloc rel = { 4 * rels.size(), sym_idx, call_type, call_addend };
+      rels.push_back(rel);
+    }
+  }
+
+  // 3. the section contents
+  StringTable shstrtab;
+  std::vector<Section> sections(1);
+  Section null_sect = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  sections[0] = null_sect;
+
+  std::string out;
+  out.assign(is64 ? 64 : 52, '\0');
+
+  std::string text;
+  for (uint64_t w = 0; w < text_size; w += 4)
+    Write32(text, call_word);
+  for (unsigned int t = 0; t < scale.numOfSections; ++t) {
+    Align(out, TextAlign);
+    Section sect = { shstrtab.add(".text." + symbolName(pIndex, t)),
+                     SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+                     out.size(), text_size, 0, 0, TextAlign, 0 };
+    sections.push_back(sect);
+    out.append(text);
+  }
+
+  Align(out, data_word);
+  {
+    Section sect = { shstrtab.add(".data"), SHT_PROGBITS,
+                     SHF_ALLOC | SHF_WRITE, out.size(), data_size, 0, 0,
+                     data_word, 0 };
+    sections.push_back(sect);
+    out.append(data_size, '\0');
+  }
+
+  // the relocation sections follow the symbol table in the section header
+  // table, and refer to it by index
+  unsigned int num_of_rel_sects = 0;
+  for (unsigned int t = 0; t < scale.numOfSections; ++t) {
+    if (!text_rels[t].empty())
+      ++num_of_rel_sects;
+  }
+  if (!data_rels.empty())
+    ++num_of_rel_sects;
+  uint32_t symtab_idx = sections.size() + num_of_rel_sects;
+
+  bool rela = isRela();
+  size_t rel_size = is64 ? 24 : (rela ? 12 : 8);
+  for (unsigned int t = 0; t <= scale.numOfSections; ++t) {
+    // t == numOfSections is the .data section
+    const std::vector<Reloc>& rels =
+      (t < scale.numOfSections) ? text_rels[t] : data_rels;
+    if (rels.empty())
+      continue;
+
+    Align(out, is64 ? 8 : 4);
+    std::string prefix = rela ? ".rela" : ".rel";
+    Section sect;
+    sect.name = shstrtab.add(prefix + ((t < scale.numOfSections) ?
+                             ".text." + symbolName(pIndex, t) :
+                             std::string(".data")));
+    sect.type = rela ? SHT_RELA : SHT_REL;
+    sect.flags = 0;
+    sect.offset = out.size();
+    sect.size = rels.size() * rel_size;
+    sect.link = symtab_idx;
+    sect.info = 1 + t;
+    sect.align = is64 ? 8 : 4;
+    sect.entsize = rel_size;
+    sections.push_back(sect);
+
+    for (size_t r = 0; r < rels.size(); ++r) {
+      if (is64) {
+        Write64(out, rels[r].offset);
+        Write64(out, (uint64_t(rels[r].symbol) << 32) | rels[r].type);
+        Write64(out, static_cast<uint64_t>(rels[r].addend));
+      }
+      else {
+        Write32(out, static_cast<uint32_t>(rels[r].offset));
+        Write32(out, (rels[r].symbol << 8) | (rels[r].type & 0xff));
+        if (rela)
+          Write32(out, static_cast<uint32_t>(rels[r].addend));
+      }
+    }
+  }
+  assert(sections.size() == symtab_idx);
+
+  // 4. the symbol table, the string tables and the headers
+  FinishObject(out, m_Arch, is64, sections, shstrtab, strtab, symbols);
+
+  pData.swap(out);
+}
+
+void SyntheticInputs::createStubs(const std::vector<std::string>& pNames,
+                                  std::string& pData) const
+{
+  bool is64 = is64Bits();
+  uint64_t func_bit = (Thumb == m_Arch) ? 0x1 : 0x0;
+
+  StringTable strtab;
+  std::vector<Symbol> symbols(1);
+  Symbol null_sym = { 0, 0, 0, 0, 0 };
+  symbols[0] = null_sym;
+  for (size_t n = 0; n < pNames.size(); ++n) {
+    Symbol sym = { strtab.add(pNames[n]), (STB_GLOBAL << 4) | STT_FUNC, 1,
+                   (4 * n) | func_bit, 4 };
+    symbols.push_back(sym);
+  }
+
+  StringTable shstrtab;
+  std::vector<Section> sections(1);
+  Section null_sect = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  sections[0] = null_sect;
+
+  std::string out;
+  out.assign(is64 ? 64 : 52, '\0');
+  Align(out, TextAlign);
+  Section text = { shstrtab.add(".text"), SHT_PROGBITS,
+                   SHF_ALLOC | SHF_EXECINSTR, out.size(), 4 * pNames.size(),
+                   0, 0, TextAlign, 0 };
+  sections.push_back(text);
+  out.append(4 * pNames.size(), '\0');
+
+  FinishObject(out, m_Arch, is64, sections, shstrtab, strtab, symbols);
+
+  pData.swap(out);
+}
+
+void SyntheticInputs::createArchive(const ImageList& pMembers,
+                                    std::string& pData) const
+{
+  // the armap lists the global symbols defined by each member
+  std::vector<std::string> names;
+  std::vector<unsigned int> owners;
+  for (unsigned int m = 0; m < pMembers.size(); ++m) {
+    unsigned int index = 0;
+    sscanf(pMembers[m].name.c_str(), "m%u.o", &index);
+    for (unsigned int s = 0; s < m_Scale.numOfSymbols; ++s) {
+      names.push_back(symbolName(index, s));
+      owners.push_back(m);
+    }
+  }
+
+  std::string armap_names;
+  for (size_t i = 0; i < names.size(); ++i) {
+    armap_names.append(names[i]);
+    armap_names.push_back('\0');
+  }
+  size_t armap_size = 4 + 4 * names.size() + armap_names.size();
+
+  // the offsets of the member headers
+  std::vector<uint32_t> offsets;
+  size_t offset = 8 + 60 + armap_size + (armap_size & 1);
+  for (size_t m = 0; m < pMembers.size(); ++m) {
+    offsets.push_back(offset);
+    offset += 60 + pMembers[m].data.size();
+    offset += (offset & 1);
+  }
+
+  std::string out("!<arch>\n");
+  char header[61];
+  snprintf(header, sizeof(header), "%-16s%-12s%-6s%-6s%-8s%-10u`\n",
+           "/", "0", "0", "0", "0", static_cast<unsigned int>(armap_size));
+  out.append(header, 60);
+
+  // the armap is big-endian
+  uint32_t count = names.size();
+  for (int shift = 24; shift >= 0; shift -= 8)
+    Write8(out, (count >> shift) & 0xff);
+  for (size_t i = 0; i < names.size(); ++i) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+      Write8(out, (offsets[owners[i]] >> shift) & 0xff);
+  }
+  out.append(armap_names);
+  Align(out, 2, '\n');
+
+  for (size_t m = 0; m < pMembers.size(); ++m) {
+    assert(out.size() == offsets[m]);
+    std::string name = pMembers[m].name + "/";
+    snprintf(header, sizeof(header), "%-16s%-12s%-6s%-6s%-8s%-10u`\n",
+             name.c_str(), "0", "0", "0", "644",
+             static_cast<unsigned int>(pMembers[m].data.size()));
+    out.append(header, 60);
+    out.append(pMembers[m].data);
+    Align(out, 2, '\n');
+  }
+
+  pData.swap(out);
+}
+
@@ -0,0 +1,109 @@
+//===- SyntheticInputs.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_SYNTHETIC_INPUTS_H
+#define MCLD_UNITTEST_SYNTHETIC_INPUTS_H
+
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+namespace test {
+
+/** \class SyntheticInputs
+ *  \brief SyntheticInputs generates the relocatable objects and archives of
+ *  a synthetic program at a given scale.
+ *
+ *  Every object defines numOfSymbols global functions, spread over
+ *  numOfSections "-ffunction-sections" style text sections, and a .data
+ *  section. Its numOfRelocs relocations call the functions of the following
+ *  objects, and one in eight of them is an absolute data relocation. The
+ *  last numOfArchives * numOfMembers objects are put into archives, and are
+ *  pulled in by the references of the other objects. Object 0 defines
+ *  _start.
+ *
+ *  The objects are little-endian ELF for x86-32, x86-64, ARM, Thumb, Mips
+ *  and Hexagon. The Thumb objects are ARM objects whose functions are Thumb
+ *  code, called by BL. They are deterministic, so a link of the same scale
+ *  is reproducible.
+ */
+class SyntheticInputs
+{
+public:
+  enum Arch {
+    X86_32,
+    X86_64,
+    ARM,
+    Thumb,
+    Mips,
+    Hexagon
+  };
+
+  struct Scale
+  {
+    unsigned int numOfObjects;   ///< including the archive members
+    unsigned int numOfSymbols;   ///< defined symbols per object
+    unsigned int numOfRelocs;    ///< relocations per object
+    unsigned int numOfSections;  ///< text sections per object
+    unsigned int numOfArchives;
+    unsigned int numOfMembers;   ///< members per archive
+  };
+
+  /// Image - an object or an archive
+  struct Image
+  {
+    std::string name;
+    std::string data;
+  };
+
+  typedef std::vector<Image> ImageList;
+
+public:
+  SyntheticInputs(Arch pArch, const Scale& pScale);
+
+  /// generate - generate the inputs. The objects which are not archive
+  /// members are put into pObjects.
+  void generate(ImageList& pObjects, ImageList& pArchives) const;
+
+  /// createObject - generate the object pIndex
+  void createObject(unsigned int pIndex, std::string& pData) const;
+
+  /// createStubs - generate an object defining the functions pNames, to
+  /// resolve the undefined references of a recorded object
+  void createStubs(const std::vector<std::string>& pNames,
+                   std::string& pData) const;
+
+  /// createArchive - put pMembers into a GNU archive with an armap
+  void createArchive(const ImageList& pMembers, std::string& pData) const;
+
+  /// triple - the target triple to link the inputs for
+  const char* triple() const;
+
+  static const char* getName(Arch pArch);
+
+  /// symbolName - the name of the symbol pSymbol defined by object pObject
+  static std::string symbolName(unsigned int pObject, unsigned int pSymbol);
+
+private:
+  bool is64Bits() const { return (X86_64 == m_Arch); }
+
+  /// isRela - are the relocations of the objects in .rela sections?
+  bool isRela() const { return (X86_64 == m_Arch || Hexagon == m_Arch); }
+
+private:
+  Arch m_Arch;
+  Scale m_Scale;
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+
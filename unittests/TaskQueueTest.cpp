@@ -0,0 +1,106 @@
+//===- TaskQueueTest.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/TaskQueue.h>
+#include "TaskQueueTest.h"
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// Appender - append its id to the log when it runs
+class Appender : public TaskQueue::Task
+{
+public:
+  Appender(std::vector<int>& pLog, int pID)
+    : m_pLog(&pLog), m_ID(pID) { }
+
+  void run() { m_pLog->push_back(m_ID); }
+
+private:
+  std::vector<int>* m_pLog;
+  int m_ID;
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+TaskQueueTest::TaskQueueTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+TaskQueueTest::~TaskQueueTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void TaskQueueTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void TaskQueueTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( TaskQueueTest, serial) {
+  std::vector<int> log;
+  Appender first(log, 1), second(log, 2);
+
+  TaskQueue queue(false);
+  ASSERT_FALSE(queue.isAsync());
+  queue.post(first);
+  ASSERT_EQ(1u, log.size());
+  queue.post(second);
+  queue.wait();
+  ASSERT_EQ(2u, queue.numOfPosted());
+  ASSERT_EQ(1, log[0]);
+  ASSERT_EQ(2, log[1]);
+}
+
+TEST_F( TaskQueueTest, in_order) {
+  std::vector<int> log;
+  std::vector<Appender> tasks;
+  tasks.reserve(1000);
+  for (int i = 0; i < 1000; ++i)
+    tasks.push_back(Appender(log, i));
+
+  TaskQueue queue;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    queue.post(tasks[i]);
+    if (500 == i) {
+      queue.wait(501);
+      ASSERT_TRUE(log.size() >= 501);
+      ASSERT_EQ(500, log[500]);
+    }
+  }
+  queue.wait();
+
+  ASSERT_EQ(1000u, log.size());
+  for (int i = 0; i < 1000; ++i)
+    ASSERT_EQ(i, log[i]);
+}
+
+TEST_F( TaskQueueTest, destroy) {
+  std::vector<int> log;
+  Appender first(log, 1), second(log, 2);
+  {
+    TaskQueue queue;
+    queue.post(first);
+    queue.post(second);
+  }
+  // the destructor finishes the posted tasks
+  ASSERT_EQ(2u, log.size());
+}
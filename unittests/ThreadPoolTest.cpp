@@ -0,0 +1,145 @@
+//===- ThreadPoolTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/ThreadPool.h>
+#include "ThreadPoolTest.h"
+
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+struct Doubler
+{
+  std::vector<size_t>* values;
+
+  void operator()(size_t pIdx) { (*values)[pIdx] = pIdx * 2; }
+};
+
+struct Record
+{
+  int key;
+  size_t order;
+
+  bool operator<(const Record& pOther) const { return key < pOther.key; }
+};
+
+struct RecordKey
+{
+  uint32_t operator()(const Record& pRecord) const { return pRecord.key; }
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+ThreadPoolTest::ThreadPoolTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ThreadPoolTest::~ThreadPoolTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void ThreadPoolTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ThreadPoolTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ThreadPoolTest, size) {
+  ThreadPool serial(1);
+  ASSERT_EQ(1u, serial.size());
+  ASSERT_TRUE(serial.isSerial());
+
+  ThreadPool automatic(0);
+  ASSERT_TRUE(automatic.size() >= 1);
+}
+
+TEST_F( ThreadPoolTest, parallel_for) {
+  for (unsigned int threads = 1; threads <= 4; ++threads) {
+    ThreadPool pool(threads);
+    std::vector<size_t> values(10000, 0);
+    Doubler body = { &values };
+    parallel_for(pool, 0, values.size(), body);
+    for (size_t i = 0; i < values.size(); ++i)
+      ASSERT_EQ(i * 2, values[i]);
+  }
+}
+
+TEST_F( ThreadPoolTest, parallel_for_homes) {
+  for (unsigned int threads = 1; threads <= 4; ++threads) {
+    ThreadPool pool(threads, true);
+    ASSERT_TRUE(pool.isSerial() || pool.hasAffinity());
+    ASSERT_EQ(0u, pool.currentThread());
+
+    std::vector<size_t> values(10000, 0);
+    ThreadPool::HomeList homes(values.size());
+    for (size_t i = 0; i < homes.size(); ++i)
+      homes[i] = (0 == i % 3000) ? ThreadPool::NoHome : (i / 700);
+    Doubler body = { &values };
+    parallel_for(pool, 0, values.size(), body, homes);
+    for (size_t i = 0; i < values.size(); ++i)
+      ASSERT_EQ(i * 2, values[i]);
+  }
+}
+
+TEST_F( ThreadPoolTest, parallel_sort_is_stable) {
+  std::vector<Record> input(20000);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i].key = std::rand() % 100;
+    input[i].order = i;
+  }
+
+  std::vector<Record> expected(input);
+  std::stable_sort(expected.begin(), expected.end());
+
+  for (unsigned int threads = 1; threads <= 4; ++threads) {
+    ThreadPool pool(threads);
+    std::vector<Record> result(input);
+    parallel_sort(pool, result.begin(), result.end());
+    for (size_t i = 0; i < result.size(); ++i) {
+      ASSERT_EQ(expected[i].key, result[i].key);
+      ASSERT_EQ(expected[i].order, result[i].order);
+    }
+  }
+}
+
+
+TEST_F( ThreadPoolTest, parallel_radix_sort_is_stable) {
+  std::vector<Record> input(50000);
+  for (size_t i = 0; i < input.size(); ++i) {
+    // the keys of the high bytes only, and of all bytes
+    input[i].key = (0 == i % 2) ? (std::rand() % 1000) << 20 : std::rand();
+    input[i].order = i;
+  }
+
+  std::vector<Record> expected(input);
+  std::stable_sort(expected.begin(), expected.end());
+
+  for (unsigned int threads = 1; threads <= 4; ++threads) {
+    ThreadPool pool(threads);
+    std::vector<Record> result(input);
+    parallel_radix_sort(pool, result, RecordKey());
+    for (size_t i = 0; i < result.size(); ++i) {
+      ASSERT_EQ(expected[i].key, result[i].key);
+      ASSERT_EQ(expected[i].order, result[i].order);
+    }
+  }
+}
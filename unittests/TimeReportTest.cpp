@@ -0,0 +1,105 @@
+//===- TimeReportTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/TimeReport.h>
+#include "TimeReportTest.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcld::test;
+
+// Constructor can do set-up work for all test here.
+TimeReportTest::TimeReportTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+TimeReportTest::~TimeReportTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void TimeReportTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void TimeReportTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( TimeReportTest, nested_phases) {
+  TimeReport report;
+  // added in the order of their ends, as TimeScope does
+  report.add("normalize", "", 1000, 3000);
+  report.add("mergeSections", "", 3000, 4000);
+  report.add("resolve", "", 1000, 5000);
+  report.add("emit", "", 5000, 6000);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  report.print(os);
+  os.flush();
+
+  // resolve encloses normalize and mergeSections
+  size_t resolve = text.find("  resolve\n");
+  size_t normalize = text.find("    normalize\n");
+  size_t merge = text.find("    mergeSections\n");
+  size_t emit = text.find("  emit\n");
+  ASSERT_NE(std::string::npos, resolve);
+  ASSERT_NE(std::string::npos, normalize);
+  ASSERT_NE(std::string::npos, merge);
+  ASSERT_NE(std::string::npos, emit);
+  ASSERT_TRUE(resolve < normalize);
+  ASSERT_TRUE(normalize < merge);
+  ASSERT_TRUE(merge < emit);
+  // the total is the sum of the outermost phases
+  ASSERT_NE(std::string::npos, text.find("5.000 ms"));
+}
+
+TEST_F( TimeReportTest, work_is_summed_up) {
+  TimeReport report;
+  report.add("read input", "a.o", 1000, 2000);
+  report.add("read input", "b.o", 2000, 4000);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  report.print(os);
+  os.flush();
+
+  ASSERT_NE(std::string::npos, text.find("3.000        2  read input"));
+}
+
+TEST_F( TimeReportTest, trace_events) {
+  TimeReport report;
+  report.add("read input", "dir/\"quoted\".o", 1000, 2000);
+
+  std::string json;
+  llvm::raw_string_ostream os(json);
+  report.writeTrace(os);
+  os.flush();
+
+  ASSERT_EQ(0u, json.find("{\"traceEvents\":["));
+  ASSERT_NE(std::string::npos, json.find("\"name\":\"read input\""));
+  ASSERT_NE(std::string::npos, json.find("\"dur\":1000"));
+  ASSERT_NE(std::string::npos,
+            json.find("\"detail\":\"dir/\\\"quoted\\\".o\""));
+  ASSERT_EQ(json.size() - 3, json.rfind("]}\n"));
+}
+
+TEST_F( TimeReportTest, null_scope) {
+  // a scope of no report does nothing
+  TimeScope scope(NULL, "nothing");
+}
+
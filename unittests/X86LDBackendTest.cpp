@@ -0,0 +1,168 @@
+//===- X86LDBackendTest.cpp -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <../lib/Target/X86/X86LDBackend.h>
+#include "X86LDBackendTest.h"
+
+#include <cstring>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+typedef X86_64GNULDBackend Backend;
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+X86LDBackendTest::X86LDBackendTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+X86LDBackendTest::~X86LDBackendTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void X86LDBackendTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void X86LDBackendTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( X86LDBackendTest, rewrite_gotpcrelx) {
+  // mov foo@GOTPCREL(%rip), %rax  =>  lea foo(%rip), %rax
+  uint8_t mov[] = { 0x8b, 0x05 };
+  ASSERT_TRUE(Backend::RewriteGOTPCRELX(mov, false));
+  ASSERT_EQ(0x8du, mov[0]);
+  ASSERT_EQ(0x05u, mov[1]);
+
+  // call *foo@GOTPCREL(%rip)  =>  addr32 call foo
+  uint8_t call[] = { 0xff, 0x15 };
+  ASSERT_FALSE(Backend::RewriteGOTPCRELX(call, false));
+  ASSERT_EQ(0xffu, call[0]);
+  ASSERT_EQ(0x15u, call[1]);
+  ASSERT_TRUE(Backend::RewriteGOTPCRELX(call, true));
+  ASSERT_EQ(0x67u, call[0]);
+  ASSERT_EQ(0xe8u, call[1]);
+
+  // add foo@GOTPCREL(%rip), %rax is kept
+  uint8_t add[] = { 0x03, 0x05 };
+  ASSERT_FALSE(Backend::RewriteGOTPCRELX(add, true));
+  ASSERT_EQ(0x03u, add[0]);
+}
+
+TEST_F( X86LDBackendTest, rewrite_tlsgd) {
+  uint8_t insn[] = { 0x66, 0x48, 0x8d, 0x3d, 0x11, 0x22, 0x33, 0x44,
+                     0x66, 0x66, 0x48, 0xe8 };
+  const uint8_t le[] = { 0x64, 0x48, 0x8b, 0x04, 0x25, 0x00, 0x00, 0x00,
+                         0x00, 0x48, 0x8d, 0x80 };
+  ASSERT_TRUE(Backend::RewriteTLSGDtoLE(insn));
+  ASSERT_EQ(0, memcmp(le, insn, sizeof(le)));
+
+  // the lea without the data16 prefix is not the GD code sequence
+  uint8_t bad[] = { 0x90, 0x48, 0x8d, 0x3d, 0x11, 0x22, 0x33, 0x44,
+                    0x66, 0x66, 0x48, 0xe8 };
+  ASSERT_FALSE(Backend::RewriteTLSGDtoLE(bad));
+  ASSERT_EQ(0x90u, bad[0]);
+}
+
+TEST_F( X86LDBackendTest, rewrite_tlsld) {
+  uint8_t insn[] = { 0x48, 0x8d, 0x3d, 0x11, 0x22, 0x33, 0x44, 0xe8,
+                     0x55, 0x66, 0x77, 0x88 };
+  const uint8_t le[] = { 0x66, 0x66, 0x66, 0x64, 0x48, 0x8b, 0x04, 0x25,
+                         0x00, 0x00, 0x00, 0x00 };
+  ASSERT_TRUE(Backend::RewriteTLSLDtoLE(insn));
+  ASSERT_EQ(0, memcmp(le, insn, sizeof(le)));
+
+  // the lea is not followed by a call
+  uint8_t bad[] = { 0x48, 0x8d, 0x3d, 0x11, 0x22, 0x33, 0x44, 0xe9,
+                    0x55, 0x66, 0x77, 0x88 };
+  ASSERT_FALSE(Backend::RewriteTLSLDtoLE(bad));
+  ASSERT_EQ(0x48u, bad[0]);
+}
+
+TEST_F( X86LDBackendTest, rewrite_tlsie) {
+  // mov x@gottpoff(%rip), %rax  =>  mov $x@tpoff, %rax
+  uint8_t mov[] = { 0x48, 0x8b, 0x05 };
+  ASSERT_TRUE(Backend::RewriteTLSIEtoLE(mov));
+  ASSERT_EQ(0x48u, mov[0]);
+  ASSERT_EQ(0xc7u, mov[1]);
+  ASSERT_EQ(0xc0u, mov[2]);
+
+  // mov x@gottpoff(%rip), %r11  =>  mov $x@tpoff, %r11
+  uint8_t mov_r11[] = { 0x4c, 0x8b, 0x1d };
+  ASSERT_TRUE(Backend::RewriteTLSIEtoLE(mov_r11));
+  ASSERT_EQ(0x49u, mov_r11[0]);
+  ASSERT_EQ(0xc7u, mov_r11[1]);
+  ASSERT_EQ(0xc3u, mov_r11[2]);
+
+  // add x@gottpoff(%rip), %rcx  =>  add $x@tpoff, %rcx
+  uint8_t add[] = { 0x48, 0x03, 0x0d };
+  ASSERT_TRUE(Backend::RewriteTLSIEtoLE(add));
+  ASSERT_EQ(0x48u, add[0]);
+  ASSERT_EQ(0x81u, add[1]);
+  ASSERT_EQ(0xc1u, add[2]);
+
+  // the operand is not %rip-relative
+  uint8_t bad[] = { 0x48, 0x8b, 0x04 };
+  ASSERT_FALSE(Backend::RewriteTLSIEtoLE(bad));
+  ASSERT_EQ(0x8bu, bad[1]);
+  ASSERT_EQ(0x04u, bad[2]);
+}
+
+TEST_F( X86LDBackendTest, rewrite_tlsdesc) {
+  // lea x@tlsdesc(%rip), %rax  =>  mov $x@tpoff, %rax
+  uint8_t le[] = { 0x48, 0x8d, 0x05 };
+  ASSERT_TRUE(Backend::RewriteTLSDESCtoLE(le));
+  ASSERT_EQ(0x48u, le[0]);
+  ASSERT_EQ(0xc7u, le[1]);
+  ASSERT_EQ(0xc0u, le[2]);
+
+  // lea x@tlsdesc(%rip), %r10  =>  mov $x@tpoff, %r10
+  uint8_t le_r10[] = { 0x4c, 0x8d, 0x15 };
+  ASSERT_TRUE(Backend::RewriteTLSDESCtoLE(le_r10));
+  ASSERT_EQ(0x49u, le_r10[0]);
+  ASSERT_EQ(0xc7u, le_r10[1]);
+  ASSERT_EQ(0xc2u, le_r10[2]);
+
+  // lea x@tlsdesc(%rip), %r10  =>  mov x@gottpoff(%rip), %r10
+  uint8_t ie[] = { 0x4c, 0x8d, 0x15 };
+  ASSERT_TRUE(Backend::RewriteTLSDESCtoIE(ie));
+  ASSERT_EQ(0x4cu, ie[0]);
+  ASSERT_EQ(0x8bu, ie[1]);
+  ASSERT_EQ(0x15u, ie[2]);
+
+  // a mov is not the load of a descriptor
+  uint8_t bad[] = { 0x48, 0x8b, 0x05 };
+  ASSERT_FALSE(Backend::RewriteTLSDESCtoLE(bad));
+  ASSERT_FALSE(Backend::RewriteTLSDESCtoIE(bad));
+  ASSERT_EQ(0x8bu, bad[1]);
+  ASSERT_EQ(0x05u, bad[2]);
+}
+
+TEST_F( X86LDBackendTest, rewrite_tlsdesc_call) {
+  // call *x@tlsdesc(%rax)  =>  xchg %ax, %ax
+  uint8_t call[] = { 0xff, 0x10 };
+  ASSERT_TRUE(Backend::RewriteTLSDESCCall(call));
+  ASSERT_EQ(0x66u, call[0]);
+  ASSERT_EQ(0x90u, call[1]);
+
+  uint8_t bad[] = { 0xff, 0x15 };
+  ASSERT_FALSE(Backend::RewriteTLSDESCCall(bad));
+  ASSERT_EQ(0xffu, bad[0]);
+  ASSERT_EQ(0x15u, bad[1]);
+}
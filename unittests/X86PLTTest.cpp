@@ -0,0 +1,162 @@
+//===- X86PLTTest.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LinkerConfig.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/MC/ZOption.h>
+#include <../lib/Target/X86/X86GOT.h>
+#include <../lib/Target/X86/X86GOTPLT.h>
+#include <../lib/Target/X86/X86PLT.h>
+#include "X86PLTTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+/// the addresses of the sections of the testcases
+const uint64_t PLTAddr = 0x1000;
+const uint64_t GOTAddr = 0x3000;
+const uint64_t GOTPLTAddr = 0x3100;
+
+uint32_t Read32(const uint8_t* pData)
+{
+  return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) |
+         ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+X86PLTTest::X86PLTTest()
+  : m_pConfig(NULL), m_pPLTSection(NULL), m_pGOTSection(NULL),
+    m_pGOTPLTSection(NULL), m_pGOT(NULL), m_pGOTPLT(NULL), m_pPLT(NULL)
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+X86PLTTest::~X86PLTTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void X86PLTTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void X86PLTTest::TearDown()
+{
+  delete m_pPLT;
+  delete m_pGOTPLT;
+  delete m_pGOT;
+  if (NULL != m_pPLTSection) {
+    LDSection::Destroy(m_pPLTSection);
+    LDSection::Destroy(m_pGOTSection);
+    LDSection::Destroy(m_pGOTPLTSection);
+  }
+  delete m_pConfig;
+}
+
+void X86PLTTest::createPLT(bool pNow)
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  if (pNow) {
+    ZOption now;
+    now.setKind(ZOption::Now);
+    m_pConfig->options().addZOption(now);
+  }
+
+  m_pPLTSection = LDSection::Create(".plt", LDFileFormat::Target, 0, 0);
+  m_pPLTSection->setAddr(PLTAddr);
+  m_pGOTSection = LDSection::Create(".got", LDFileFormat::Target, 0, 0);
+  m_pGOTSection->setAddr(GOTAddr);
+  m_pGOTPLTSection = LDSection::Create(".got.plt", LDFileFormat::Target, 0, 0);
+  m_pGOTPLTSection->setAddr(GOTPLTAddr);
+
+  m_pGOT = new X86_64GOT(*m_pGOTSection);
+  m_pGOTPLT = new X86_64GOTPLT(*m_pGOTPLTSection);
+  m_pPLT = new X86_64PLT(*m_pPLTSection, *m_pGOT, *m_pGOTPLT, *m_pConfig);
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( X86PLTTest, lazy_size) {
+  createPLT(false);
+  ASSERT_TRUE(m_pPLT->isLazy());
+  ASSERT_EQ(16u, m_pPLT->getPLT0Size());
+
+  m_pPLT->reserveEntry(2);
+  m_pPLT->finalizeSectionSize();
+  ASSERT_EQ(2u, m_pPLT->numOfPLT1());
+  ASSERT_EQ(48u, m_pPLTSection->size());
+}
+
+TEST_F( X86PLTTest, nonlazy_size) {
+  // -z now drops PLT0
+  createPLT(true);
+  ASSERT_FALSE(m_pPLT->isLazy());
+  ASSERT_EQ(0u, m_pPLT->getPLT0Size());
+
+  m_pPLT->reserveEntry(2);
+  m_pPLT->finalizeSectionSize();
+  ASSERT_EQ(2u, m_pPLT->numOfPLT1());
+  ASSERT_EQ(32u, m_pPLTSection->size());
+}
+
+TEST_F( X86PLTTest, lazy_plt1) {
+  // each entry jumps through its .got.plt entry after GOT0, and otherwise
+  // pushes its index and jumps to PLT0
+  createPLT(false);
+  m_pPLT->reserveEntry(2);
+  m_pPLT->finalizeSectionSize();
+  m_pPLT->applyPLT1();
+
+  const uint8_t* data = m_pPLT->getPLT1Value();
+  ASSERT_TRUE(NULL != data);
+  for (uint32_t i = 0; i < 2; ++i, data += 16) {
+    uint64_t entry = PLTAddr + 16 + i * 16;
+    ASSERT_EQ(0xffu, data[0]);
+    ASSERT_EQ(0x25u, data[1]);
+    ASSERT_EQ((uint32_t)(GOTPLTAddr + 24 + i * 8 - (entry + 6)),
+              Read32(data + 2));
+    ASSERT_EQ(0x68u, data[6]);
+    ASSERT_EQ(i, Read32(data + 7));
+    ASSERT_EQ(0xe9u, data[11]);
+    ASSERT_EQ((uint32_t)(PLTAddr - (entry + 16)), Read32(data + 12));
+  }
+}
+
+TEST_F( X86PLTTest, nonlazy_plt1) {
+  // each entry jumps through the .got entry of its symbol and is padded by
+  // nops
+  createPLT(true);
+  m_pPLT->reserveEntry(2);
+  m_pPLT->consume()->setGOTOffset(0x8);
+  m_pPLT->consume()->setGOTOffset(0x20);
+  m_pPLT->finalizeSectionSize();
+  m_pPLT->applyPLT1();
+
+  const uint8_t* data = m_pPLT->getPLT1Value();
+  ASSERT_TRUE(NULL != data);
+  ASSERT_EQ(0xffu, data[0]);
+  ASSERT_EQ(0x25u, data[1]);
+  ASSERT_EQ((uint32_t)(GOTAddr + 0x8 - (PLTAddr + 6)), Read32(data + 2));
+
+  data += 16;
+  ASSERT_EQ(0xffu, data[0]);
+  ASSERT_EQ(0x25u, data[1]);
+  ASSERT_EQ((uint32_t)(GOTAddr + 0x20 - (PLTAddr + 16 + 6)),
+            Read32(data + 2));
+
+  for (size_t i = 6; i < 16; ++i)
+    ASSERT_EQ(x86_64_nonlazy_plt1[i], data[i]);
+}
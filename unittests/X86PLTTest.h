@@ -0,0 +1,58 @@
+//===- X86PLTTest.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_UNITTEST_X86_PLT_TEST_H
+#define MCLD_UNITTEST_X86_PLT_TEST_H
+
+#include <gtest.h>
+
+namespace mcld {
+
+class LDSection;
+class LinkerConfig;
+class X86_64GOT;
+class X86_64GOTPLT;
+class X86_64PLT;
+
+namespace test {
+
+class X86PLTTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  X86PLTTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~X86PLTTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// createPLT - create the .plt of an executable and its .got and .got.plt.
+  /// The PLT is not lazy if pNow, as with -z now.
+  void createPLT(bool pNow);
+
+protected:
+  LinkerConfig* m_pConfig;
+  LDSection* m_pPLTSection;
+  LDSection* m_pGOTSection;
+  LDSection* m_pGOTPLTSection;
+  X86_64GOT* m_pGOT;
+  X86_64GOTPLT* m_pGOTPLT;
+  X86_64PLT* m_pPLT;
+};
+
+} // namespace of test
+} // namespace of mcld
+
+#endif
+